@@ -45,6 +45,16 @@ static const char* const kShipInstructColName = "l_shipinstruct";
 static const char* const kShipModeColName = "l_shipmode";
 static const char* const kCommentColName = "l_comment";
 
+static const char* const kOOrderKeyColName = "o_orderkey";
+static const char* const kOCustKeyColName = "o_custkey";
+static const char* const kOOrderStatusColName = "o_orderstatus";
+static const char* const kOTotalPriceColName = "o_totalprice";
+static const char* const kOOrderDateColName = "o_orderdate";
+static const char* const kOOrderPriorityColName = "o_orderpriority";
+static const char* const kOClerkColName = "o_clerk";
+static const char* const kOShipPriorityColName = "o_shippriority";
+static const char* const kOCommentColName = "o_comment";
+
 static const client::KuduColumnStorageAttributes::EncodingType kPlainEncoding =
   client::KuduColumnStorageAttributes::PLAIN_ENCODING;
 
@@ -76,6 +86,18 @@ enum {
   kCommentColIdx
 };
 
+enum {
+  kOOrderKeyColIdx = 0,
+  kOCustKeyColIdx,
+  kOOrderStatusColIdx,
+  kOTotalPriceColIdx,
+  kOOrderDateColIdx,
+  kOOrderPriorityColIdx,
+  kOClerkColIdx,
+  kOShipPriorityColIdx,
+  kOCommentColIdx
+};
+
 inline client::KuduSchema CreateLineItemSchema() {
   client::KuduSchemaBuilder b;
   client::KuduSchema s;
@@ -104,6 +126,25 @@ inline client::KuduSchema CreateLineItemSchema() {
   return s;
 }
 
+inline client::KuduSchema CreateOrdersSchema() {
+  client::KuduSchemaBuilder b;
+  client::KuduSchema s;
+
+  b.AddColumn(kOOrderKeyColName)->Type(kInt64)->NotNull()->PrimaryKey();
+  b.AddColumn(kOCustKeyColName)->Type(kInt32)->NotNull();
+  b.AddColumn(kOOrderStatusColName)->Type(kString)->NotNull();
+  b.AddColumn(kOTotalPriceColName)->Type(kDouble)->NotNull();
+  b.AddColumn(kOOrderDateColName)->Type(kString)->NotNull();
+  b.AddColumn(kOOrderPriorityColName)->Type(kString)->NotNull();
+  b.AddColumn(kOClerkColName)->Type(kString)->NotNull();
+  b.AddColumn(kOShipPriorityColName)->Type(kInt32)->NotNull();
+  b.AddColumn(kOCommentColName)->Type(kString)->NotNull()
+      ->Compression(client::KuduColumnStorageAttributes::LZ4);
+
+  CHECK_OK(b.Build(&s));
+  return s;
+}
+
 inline std::vector<std::string> GetTpchQ1QueryColumns() {
   return { kShipDateColName,
            kReturnFlagColName,
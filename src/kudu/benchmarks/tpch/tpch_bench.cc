@@ -0,0 +1,180 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Benchmark of analytic scans running TPC-H queries over the C++ client.
+//
+// Unless the tables already exist, this utility first generates the ORDERS
+// and LINEITEM tables at the given scale factor and loads them; it then runs
+// each of the given queries, up to tpch_num_query_iterations times, and logs
+// their results and timings.
+//
+// The queries read the tables with columnar scans and push the predicates Kudu
+// can evaluate down to the tablet servers, so their timings track the
+// efficiency of the scan path end to end. See tpch_queries.h for the supported
+// queries.
+//
+// Usage:
+//   tpch_bench -tpch_scale_factor=1 -tpch_queries=1,6 -tpch_num_query_iterations=3
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/benchmarks/tpch/tpch_dbgen.h"
+#include "kudu/benchmarks/tpch/tpch_queries.h"
+#include "kudu/client/client.h"
+#include "kudu/client/shared_ptr.h" // IWYU pragma: keep
+#include "kudu/gutil/strings/numbers.h"
+#include "kudu/gutil/strings/split.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/master/mini_master.h"
+#include "kudu/mini-cluster/internal_mini_cluster.h"
+#include "kudu/util/env.h"
+#include "kudu/util/flags.h"
+#include "kudu/util/logging.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/status.h"
+#include "kudu/util/stopwatch.h"
+
+DEFINE_double(tpch_scale_factor, 0.1,
+              "Scale factor of the generated data: there are 1.5 million orders and "
+              "about 6 million line items per unit");
+DEFINE_uint32(tpch_seed, 1, "Seed of the generated data");
+DEFINE_string(tpch_queries, "1,4,6,12", "Comma-separated list of the TPC-H queries to run");
+DEFINE_int32(tpch_num_query_iterations, 3, "Number of times each query is run");
+DEFINE_int32(tpch_num_load_threads, 4, "Number of threads loading the generated data");
+DEFINE_int32(tpch_num_buckets, 8,
+             "Number of hash buckets the tables are partitioned into on their order keys");
+DEFINE_bool(use_mini_cluster, true,
+            "Create a mini cluster for the work to be performed against.");
+DEFINE_string(mini_cluster_base_dir, "/tmp/tpch",
+              "If using a mini cluster, directory for master/ts data.");
+DEFINE_int32(mini_cluster_num_tablet_servers, 1,
+             "If using a mini cluster, number of tablet servers.");
+DEFINE_string(master_addresses, "localhost",
+              "Comma-separated addresses of the masters of the cluster to operate on");
+
+using kudu::client::KuduClient;
+using kudu::client::KuduClientBuilder;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tpch {
+
+static Status ParseQueries(vector<int>* queries) {
+  const vector<string> query_strs =
+      strings::Split(FLAGS_tpch_queries, ",", strings::SkipEmpty());
+  for (const auto& query_str : query_strs) {
+    int query;
+    if (!SimpleAtoi(query_str, &query) ||
+        std::find(SupportedQueries().begin(), SupportedQueries().end(), query) ==
+            SupportedQueries().end()) {
+      return Status::InvalidArgument("unsupported TPC-H query", query_str);
+    }
+    queries->push_back(query);
+  }
+  return Status::OK();
+}
+
+static Status RunBenchmark(const vector<string>& master_addresses) {
+  vector<int> queries;
+  RETURN_NOT_OK(ParseQueries(&queries));
+
+  client::sp::shared_ptr<KuduClient> client;
+  RETURN_NOT_OK(KuduClientBuilder()
+                .master_server_addrs(master_addresses)
+                .default_admin_operation_timeout(MonoDelta::FromSeconds(60))
+                .default_rpc_timeout(MonoDelta::FromSeconds(60))
+                .Build(&client));
+  bool exists;
+  RETURN_NOT_OK(client->TableExists(kLineItemTableName, &exists));
+  if (exists) {
+    LOG(INFO) << "Data already in place";
+  } else {
+    RETURN_NOT_OK(CreateTables(client.get(), FLAGS_tpch_num_buckets));
+    DataGenerator generator(FLAGS_tpch_scale_factor, FLAGS_tpch_seed);
+    LOG_TIMING(INFO, Substitute("loading $0 orders", generator.num_orders())) {
+      RETURN_NOT_OK(LoadTables(client.get(), generator, FLAGS_tpch_num_load_threads));
+    }
+  }
+
+  for (int query : queries) {
+    double min_secs = 0;
+    double total_secs = 0;
+    QueryResult result;
+    for (int i = 0; i < FLAGS_tpch_num_query_iterations; i++) {
+      Stopwatch sw;
+      sw.start();
+      RETURN_NOT_OK_PREPEND(RunQuery(client.get(), query, &result),
+                            Substitute("failed to run Q$0", query));
+      sw.stop();
+      const double secs = sw.elapsed().wall_seconds();
+      LOG(INFO) << Substitute("Q$0 iteration #$1: $2 seconds, $3 rows scanned",
+                              query, i, secs, result.rows_scanned);
+      min_secs = i == 0 ? secs : std::min(min_secs, secs);
+      total_secs += secs;
+    }
+    LOG(INFO) << Substitute("Q$0 result:", query);
+    for (const auto& row : result.rows) {
+      LOG(INFO) << row;
+    }
+    if (FLAGS_tpch_num_query_iterations > 0) {
+      LOG(INFO) << Substitute("Q$0: min $1 seconds, average $2 seconds", query, min_secs,
+                              total_secs / FLAGS_tpch_num_query_iterations);
+    }
+  }
+  return Status::OK();
+}
+
+} // namespace tpch
+} // namespace kudu
+
+int main(int argc, char** argv) {
+  kudu::ParseCommandLineFlags(&argc, &argv, true);
+  kudu::InitGoogleLoggingSafe(argv[0]);
+
+  unique_ptr<kudu::cluster::InternalMiniCluster> cluster;
+  vector<string> master_addresses;
+  if (FLAGS_use_mini_cluster) {
+    kudu::Env* env = kudu::Env::Default();
+    kudu::Status s = env->CreateDir(FLAGS_mini_cluster_base_dir);
+    CHECK(s.IsAlreadyPresent() || s.ok()) << s.ToString();
+    kudu::cluster::InternalMiniClusterOptions options;
+    options.cluster_root = FLAGS_mini_cluster_base_dir;
+    options.num_tablet_servers = FLAGS_mini_cluster_num_tablet_servers;
+    cluster.reset(new kudu::cluster::InternalMiniCluster(env, options));
+    CHECK_OK(cluster->StartSync());
+    master_addresses.push_back(cluster->mini_master()->bound_rpc_addr_str());
+  } else {
+    master_addresses = strings::Split(FLAGS_master_addresses, ",", strings::SkipEmpty());
+  }
+
+  CHECK_OK(kudu::tpch::RunBenchmark(master_addresses));
+
+  if (cluster) {
+    cluster->Shutdown();
+  }
+  return 0;
+}
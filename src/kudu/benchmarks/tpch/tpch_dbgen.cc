@@ -0,0 +1,322 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/benchmarks/tpch/tpch_dbgen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/benchmarks/tpch/tpch-schemas.h"
+#include "kudu/client/client.h"
+#include "kudu/client/schema.h"
+#include "kudu/client/shared_ptr.h" // IWYU pragma: keep
+#include "kudu/client/write_op.h"
+#include "kudu/common/partial_row.h"
+#include "kudu/gutil/stl_util.h"
+#include "kudu/gutil/stringprintf.h"
+#include "kudu/util/hash_util.h"
+#include "kudu/util/random.h"
+
+using kudu::client::KuduClient;
+using kudu::client::KuduError;
+using kudu::client::KuduInsert;
+using kudu::client::KuduSchema;
+using kudu::client::KuduSession;
+using kudu::client::KuduTable;
+using kudu::client::KuduTableCreator;
+using std::string;
+using std::thread;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+namespace tpch {
+
+const char* const kLineItemTableName = "lineitem";
+const char* const kOrdersTableName = "orders";
+
+string DateToString(int days) {
+  // See http://howardhinnant.github.io/date_algorithms.html#civil_from_days.
+  const int z = days + 719468;
+  const int era = (z >= 0 ? z : z - 146096) / 146097;
+  const int doe = z - era * 146097;
+  const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const int mp = (5 * doy + 2) / 153;
+  const int day = doy - (153 * mp + 2) / 5 + 1;
+  const int month = mp < 10 ? mp + 3 : mp - 9;
+  const int year = yoe + era * 400 + (month <= 2);
+  return StringPrintf("%04d-%02d-%02d", year, month, day);
+}
+
+int DaysFromCivil(int year, int month, int day) {
+  // See http://howardhinnant.github.io/date_algorithms.html#days_from_civil.
+  year -= month <= 2;
+  const int era = (year >= 0 ? year : year - 399) / 400;
+  const int yoe = year - era * 400;
+  const int doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+namespace {
+
+// The dates of the specification: the orders are placed between the start
+// and the end dates, and the line items received by the current date are
+// returned or accepted.
+const int kStartDate = DaysFromCivil(1992, 1, 1);
+const int kCurrentDate = DaysFromCivil(1995, 6, 17);
+const int kEndDate = DaysFromCivil(1998, 12, 31);
+
+const char* const kPriorities[] = {
+  "1-URGENT", "2-HIGH", "3-MEDIUM", "4-NOT SPECIFIED", "5-LOW"
+};
+const char* const kShipInstructs[] = {
+  "DELIVER IN PERSON", "COLLECT COD", "NONE", "TAKE BACK RETURN"
+};
+const char* const kShipModes[] = {
+  "REG AIR", "AIR", "RAIL", "SHIP", "TRUCK", "MAIL", "FOB"
+};
+const char* const kWords[] = {
+  "furiously", "quickly", "carefully", "blithely", "slyly", "final", "regular",
+  "special", "pending", "express", "ironic", "bold", "even", "silent", "packages",
+  "deposits", "requests", "accounts", "instructions", "theodolites", "pinto",
+  "beans", "foxes", "ideas", "dependencies", "excuses", "sleep", "wake", "cajole",
+  "haggle", "nag", "use", "boost", "affix", "detect", "integrate", "among", "about",
+};
+
+// Returns a random value in [min, max].
+int64_t UniformIn(Random* rng, int64_t min, int64_t max) {
+  return min + static_cast<int64_t>(rng->Uniform64(max - min + 1));
+}
+
+template<size_t N>
+const char* Pick(Random* rng, const char* const (&values)[N]) {
+  return values[rng->Uniform(N)];
+}
+
+string RandomText(Random* rng, int min_length, int max_length) {
+  const size_t length = UniformIn(rng, min_length, max_length);
+  string text;
+  while (text.size() < length) {
+    if (!text.empty()) {
+      text += ' ';
+    }
+    text += Pick(rng, kWords);
+  }
+  text.resize(length);
+  return text;
+}
+
+// The retail price of a part, as of the P_RETAILPRICE column of PART.
+double RetailPrice(int32_t partkey) {
+  return (90000 + ((partkey / 10) % 20001) + 100 * (partkey % 1000)) / 100.0;
+}
+
+template<typename T>
+T Scale(double scale_factor, int64_t count) {
+  return std::max<T>(1, static_cast<T>(std::llround(scale_factor * count)));
+}
+
+// Returns the status of the first failed operation of 'session', prepended
+// with 'msg'.
+Status FirstPendingError(KuduSession* session, const string& msg) {
+  vector<KuduError*> errors;
+  ElementDeleter d(&errors);
+  bool overflowed;
+  session->GetPendingErrors(&errors, &overflowed);
+  if (errors.empty()) {
+    return Status::OK();
+  }
+  return errors[0]->status().CloneAndPrepend(msg);
+}
+
+Status CreateTable(KuduClient* client, const string& table_name, const KuduSchema& schema,
+                   const string& orderkey_col_name, int num_buckets) {
+  bool exists;
+  RETURN_NOT_OK(client->TableExists(table_name, &exists));
+  if (exists) {
+    return Status::OK();
+  }
+  unique_ptr<KuduTableCreator> table_creator(client->NewTableCreator());
+  return table_creator->table_name(table_name)
+      .schema(&schema)
+      .add_hash_partitions({ orderkey_col_name }, num_buckets)
+      .num_replicas(1)
+      .Create();
+}
+
+// Loads the orders whose keys are in [first, last], and their line items.
+Status LoadOrders(KuduClient* client, const DataGenerator& generator,
+                  int64_t first, int64_t last) {
+  client::sp::shared_ptr<KuduTable> orders;
+  RETURN_NOT_OK(client->OpenTable(kOrdersTableName, &orders));
+  client::sp::shared_ptr<KuduTable> lineitem;
+  RETURN_NOT_OK(client->OpenTable(kLineItemTableName, &lineitem));
+  client::sp::shared_ptr<KuduSession> session = client->NewSession();
+  RETURN_NOT_OK(session->SetFlushMode(KuduSession::AUTO_FLUSH_BACKGROUND));
+  session->SetTimeoutMillis(60000);
+
+  DataGenerator::Order order;
+  for (int64_t orderkey = first; orderkey <= last; orderkey++) {
+    generator.GenerateOrder(orderkey, &order);
+    unique_ptr<KuduInsert> insert(orders->NewInsert());
+    DataGenerator::OrderToRow(order, insert->mutable_row());
+    RETURN_NOT_OK(session->Apply(insert.release()));
+    for (const auto& item : order.lineitems) {
+      insert.reset(lineitem->NewInsert());
+      DataGenerator::LineItemToRow(item, insert->mutable_row());
+      RETURN_NOT_OK(session->Apply(insert.release()));
+    }
+  }
+  const Status s = session->Flush();
+  RETURN_NOT_OK(FirstPendingError(session.get(), "failed to load the tables"));
+  return s;
+}
+
+} // anonymous namespace
+
+DataGenerator::DataGenerator(double scale_factor, uint32_t seed)
+    : seed_(seed),
+      num_orders_(Scale<int64_t>(scale_factor, 1500000)),
+      num_customers_(Scale<int32_t>(scale_factor, 150000)),
+      num_parts_(Scale<int32_t>(scale_factor, 200000)),
+      num_suppliers_(Scale<int32_t>(scale_factor, 10000)),
+      num_clerks_(Scale<int32_t>(scale_factor, 1000)) {
+}
+
+void DataGenerator::GenerateOrder(int64_t orderkey, Order* order) const {
+  Random rng(seed_ ^ static_cast<uint32_t>(
+      HashUtil::FastHash64(&orderkey, sizeof(orderkey), /*seed=*/0)));
+  const int orderdate = UniformIn(&rng, kStartDate, kEndDate - 151);
+  order->orderkey = orderkey;
+  order->custkey = UniformIn(&rng, 1, num_customers_);
+  order->orderdate = DateToString(orderdate);
+  order->orderpriority = Pick(&rng, kPriorities);
+  order->clerk = StringPrintf("Clerk#%09d", static_cast<int>(UniformIn(&rng, 1, num_clerks_)));
+  order->shippriority = 0;
+  order->comment = RandomText(&rng, 19, 78);
+  order->totalprice = 0;
+  order->lineitems.resize(UniformIn(&rng, 1, 7));
+
+  size_t num_shipped = 0;
+  for (size_t i = 0; i < order->lineitems.size(); i++) {
+    LineItem* item = &order->lineitems[i];
+    item->orderkey = orderkey;
+    item->linenumber = i + 1;
+    item->partkey = UniformIn(&rng, 1, num_parts_);
+    item->suppkey = UniformIn(&rng, 1, num_suppliers_);
+    item->quantity = UniformIn(&rng, 1, 50);
+    item->extendedprice = item->quantity * RetailPrice(item->partkey);
+    item->discount = UniformIn(&rng, 0, 10) / 100.0;
+    item->tax = UniformIn(&rng, 0, 8) / 100.0;
+    const int shipdate = orderdate + UniformIn(&rng, 1, 121);
+    const int receiptdate = shipdate + UniformIn(&rng, 1, 30);
+    item->shipdate = DateToString(shipdate);
+    item->commitdate = DateToString(orderdate + UniformIn(&rng, 30, 90));
+    item->receiptdate = DateToString(receiptdate);
+    if (receiptdate <= kCurrentDate) {
+      item->returnflag = rng.OneIn(2) ? "R" : "A";
+    } else {
+      item->returnflag = "N";
+    }
+    item->linestatus = shipdate > kCurrentDate ? "O" : "F";
+    item->shipinstruct = Pick(&rng, kShipInstructs);
+    item->shipmode = Pick(&rng, kShipModes);
+    item->comment = RandomText(&rng, 10, 43);
+
+    order->totalprice += item->extendedprice * (1 + item->tax) * (1 - item->discount);
+    if (item->linestatus == "F") {
+      num_shipped++;
+    }
+  }
+  if (num_shipped == order->lineitems.size()) {
+    order->orderstatus = "F";
+  } else if (num_shipped == 0) {
+    order->orderstatus = "O";
+  } else {
+    order->orderstatus = "P";
+  }
+}
+
+void DataGenerator::OrderToRow(const Order& order, KuduPartialRow* row) {
+  CHECK_OK(row->SetInt64(kOOrderKeyColIdx, order.orderkey));
+  CHECK_OK(row->SetInt32(kOCustKeyColIdx, order.custkey));
+  CHECK_OK(row->SetStringCopy(kOOrderStatusColIdx, order.orderstatus));
+  CHECK_OK(row->SetDouble(kOTotalPriceColIdx, order.totalprice));
+  CHECK_OK(row->SetStringCopy(kOOrderDateColIdx, order.orderdate));
+  CHECK_OK(row->SetStringCopy(kOOrderPriorityColIdx, order.orderpriority));
+  CHECK_OK(row->SetStringCopy(kOClerkColIdx, order.clerk));
+  CHECK_OK(row->SetInt32(kOShipPriorityColIdx, order.shippriority));
+  CHECK_OK(row->SetStringCopy(kOCommentColIdx, order.comment));
+}
+
+void DataGenerator::LineItemToRow(const LineItem& item, KuduPartialRow* row) {
+  CHECK_OK(row->SetInt64(kOrderKeyColIdx, item.orderkey));
+  CHECK_OK(row->SetInt32(kLineNumberColIdx, item.linenumber));
+  CHECK_OK(row->SetInt32(kPartKeyColIdx, item.partkey));
+  CHECK_OK(row->SetInt32(kSuppKeyColIdx, item.suppkey));
+  CHECK_OK(row->SetInt32(kQuantityColIdx, item.quantity));
+  CHECK_OK(row->SetDouble(kExtendedPriceColIdx, item.extendedprice));
+  CHECK_OK(row->SetDouble(kDiscountColIdx, item.discount));
+  CHECK_OK(row->SetDouble(kTaxColIdx, item.tax));
+  CHECK_OK(row->SetStringCopy(kReturnFlagColIdx, item.returnflag));
+  CHECK_OK(row->SetStringCopy(kLineStatusColIdx, item.linestatus));
+  CHECK_OK(row->SetStringCopy(kShipDateColIdx, item.shipdate));
+  CHECK_OK(row->SetStringCopy(kCommitDateColIdx, item.commitdate));
+  CHECK_OK(row->SetStringCopy(kReceiptDateColIdx, item.receiptdate));
+  CHECK_OK(row->SetStringCopy(kShipInstructColIdx, item.shipinstruct));
+  CHECK_OK(row->SetStringCopy(kShipModeColIdx, item.shipmode));
+  CHECK_OK(row->SetStringCopy(kCommentColIdx, item.comment));
+}
+
+Status CreateTables(KuduClient* client, int num_buckets) {
+  RETURN_NOT_OK(CreateTable(client, kOrdersTableName, CreateOrdersSchema(),
+                            kOOrderKeyColName, num_buckets));
+  return CreateTable(client, kLineItemTableName, CreateLineItemSchema(),
+                     kOrderKeyColName, num_buckets);
+}
+
+Status LoadTables(KuduClient* client, const DataGenerator& generator, int num_threads) {
+  const int64_t num_orders = generator.num_orders();
+  const int64_t orders_per_thread = (num_orders + num_threads - 1) / num_threads;
+  vector<Status> statuses(num_threads);
+  vector<thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    const int64_t first = 1 + i * orders_per_thread;
+    const int64_t last = std::min(num_orders, first + orders_per_thread - 1);
+    threads.emplace_back([&, i, first, last]() {
+      statuses[i] = LoadOrders(client, generator, first, last);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (const auto& s : statuses) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
+} // namespace tpch
+} // namespace kudu
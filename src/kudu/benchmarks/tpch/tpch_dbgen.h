@@ -0,0 +1,120 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class KuduPartialRow;
+
+namespace client {
+class KuduClient;
+} // namespace client
+
+namespace tpch {
+
+// The names of the tables the generated data is loaded into.
+extern const char* const kLineItemTableName;
+extern const char* const kOrdersTableName;
+
+// Returns the date 'days' days after 1970-01-01, formatted as YYYY-MM-DD as
+// the date columns of the TPC-H tables are.
+std::string DateToString(int days);
+
+// Returns the number of days between 1970-01-01 and the given date.
+int DaysFromCivil(int year, int month, int day);
+
+// Generates the ORDERS and LINEITEM tables of TPC-H at a given scale factor,
+// following the distributions of the columns the reference dbgen tool
+// generates, with a few simplifications: the keys of the orders are dense,
+// the comments are random words rather than grammatical sentences, and the
+// customers, parts and suppliers are picked uniformly.
+//
+// The data of each order is derived from the seed and the key of the order
+// only, so that disjoint ranges of orders may be generated concurrently, and
+// regenerated to compute the expected results of the queries.
+class DataGenerator {
+ public:
+  struct LineItem {
+    int64_t orderkey;
+    int32_t linenumber;
+    int32_t partkey;
+    int32_t suppkey;
+    int32_t quantity;
+    double extendedprice;
+    double discount;
+    double tax;
+    std::string returnflag;
+    std::string linestatus;
+    std::string shipdate;
+    std::string commitdate;
+    std::string receiptdate;
+    std::string shipinstruct;
+    std::string shipmode;
+    std::string comment;
+  };
+
+  struct Order {
+    int64_t orderkey;
+    int32_t custkey;
+    std::string orderstatus;
+    double totalprice;
+    std::string orderdate;
+    std::string orderpriority;
+    std::string clerk;
+    int32_t shippriority;
+    std::string comment;
+    std::vector<LineItem> lineitems;
+  };
+
+  DataGenerator(double scale_factor, uint32_t seed);
+
+  // The number of orders at the scale factor, whose keys go from 1 to
+  // num_orders() included. There are four line items per order on average.
+  int64_t num_orders() const { return num_orders_; }
+
+  // Generates the order with the key 'orderkey' and its line items.
+  void GenerateOrder(int64_t orderkey, Order* order) const;
+
+  // Sets the columns of the row of the ORDERS or LINEITEM table.
+  static void OrderToRow(const Order& order, KuduPartialRow* row);
+  static void LineItemToRow(const LineItem& lineitem, KuduPartialRow* row);
+
+ private:
+  const uint32_t seed_;
+  const int64_t num_orders_;
+  const int32_t num_customers_;
+  const int32_t num_parts_;
+  const int32_t num_suppliers_;
+  const int32_t num_clerks_;
+};
+
+// Creates the ORDERS and LINEITEM tables, hash partitioned on the order keys
+// into 'num_buckets' buckets, unless they already exist.
+Status CreateTables(client::KuduClient* client, int num_buckets);
+
+// Generates the orders and their line items with 'generator', writing them
+// into the tables with 'num_threads' threads.
+Status LoadTables(client::KuduClient* client, const DataGenerator& generator, int num_threads);
+
+} // namespace tpch
+} // namespace kudu
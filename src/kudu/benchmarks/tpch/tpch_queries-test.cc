@@ -0,0 +1,159 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/benchmarks/tpch/tpch_queries.h"
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "kudu/benchmarks/tpch/tpch_dbgen.h"
+#include "kudu/client/client.h"
+#include "kudu/client/shared_ptr.h" // IWYU pragma: keep
+#include "kudu/gutil/strings/numbers.h"
+#include "kudu/gutil/strings/split.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/mini-cluster/internal_mini_cluster.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+using kudu::client::KuduClient;
+using kudu::cluster::InternalMiniCluster;
+using kudu::cluster::InternalMiniClusterOptions;
+using std::map;
+using std::pair;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tpch {
+
+class TpchQueriesTest : public KuduTest {
+ public:
+  TpchQueriesTest()
+      : generator_(/*scale_factor=*/0.002, /*seed=*/SeedRandom()) {
+  }
+
+  void SetUp() override {
+    KuduTest::SetUp();
+    cluster_.reset(new InternalMiniCluster(env_, InternalMiniClusterOptions()));
+    ASSERT_OK(cluster_->Start());
+    ASSERT_OK(cluster_->CreateClient(nullptr, &client_));
+    ASSERT_OK(CreateTables(client_.get(), /*num_buckets=*/2));
+    ASSERT_OK(LoadTables(client_.get(), generator_, /*num_threads=*/2));
+  }
+
+  void TearDown() override {
+    cluster_->Shutdown();
+    KuduTest::TearDown();
+  }
+
+ protected:
+  // Calls 'f' on every generated order.
+  template<typename F>
+  void ForEachOrder(const F& f) const {
+    DataGenerator::Order order;
+    for (int64_t orderkey = 1; orderkey <= generator_.num_orders(); orderkey++) {
+      generator_.GenerateOrder(orderkey, &order);
+      f(order);
+    }
+  }
+
+  const DataGenerator generator_;
+  unique_ptr<InternalMiniCluster> cluster_;
+  client::sp::shared_ptr<KuduClient> client_;
+};
+
+TEST_F(TpchQueriesTest, TestQueries) {
+  // The number of line items and the total quantity per group of Q1.
+  map<pair<string, string>, pair<int64_t, int64_t>> q1;
+  map<string, int64_t> q4;
+  double q6 = 0;
+  map<string, std::array<int64_t, 2>> q12;
+  ForEachOrder([&](const DataGenerator::Order& order) {
+    bool late = false;
+    for (const auto& item : order.lineitems) {
+      if (item.shipdate <= "1998-09-02") {
+        auto& group = q1[{ item.returnflag, item.linestatus }];
+        group.first++;
+        group.second += item.quantity;
+      }
+      late |= item.commitdate < item.receiptdate;
+      if (item.shipdate >= "1994-01-01" && item.shipdate < "1995-01-01" &&
+          item.discount >= 0.05 && item.discount <= 0.07 && item.quantity < 24) {
+        q6 += item.extendedprice * item.discount;
+      }
+      if ((item.shipmode == "MAIL" || item.shipmode == "SHIP") &&
+          item.commitdate < item.receiptdate && item.shipdate < item.commitdate &&
+          item.receiptdate >= "1994-01-01" && item.receiptdate < "1995-01-01") {
+        const bool high = order.orderpriority == "1-URGENT" || order.orderpriority == "2-HIGH";
+        q12[item.shipmode][high ? 0 : 1]++;
+      }
+    }
+    if (late && order.orderdate >= "1993-07-01" && order.orderdate < "1993-10-01") {
+      q4[order.orderpriority]++;
+    }
+  });
+
+  QueryResult result;
+  ASSERT_OK(RunQuery(client_.get(), 1, &result));
+  ASSERT_EQ(q1.size(), result.rows.size());
+  int i = 0;
+  for (const auto& [key, group] : q1) {
+    const vector<string> cols = strings::Split(result.rows[i++], "|");
+    ASSERT_EQ(10, cols.size());
+    EXPECT_EQ(key.first, cols[0]);
+    EXPECT_EQ(key.second, cols[1]);
+    EXPECT_EQ(std::to_string(group.second), cols[2]);
+    EXPECT_EQ(std::to_string(group.first), cols[9]);
+  }
+
+  ASSERT_OK(RunQuery(client_.get(), 4, &result));
+  vector<string> expected;
+  for (const auto& [priority, count] : q4) {
+    expected.emplace_back(Substitute("$0|$1", priority, count));
+  }
+  EXPECT_EQ(expected, result.rows);
+
+  ASSERT_OK(RunQuery(client_.get(), 6, &result));
+  ASSERT_EQ(1, result.rows.size());
+  double revenue;
+  ASSERT_TRUE(safe_strtod(result.rows[0], &revenue));
+  EXPECT_NEAR(q6, revenue, 0.01);
+
+  ASSERT_OK(RunQuery(client_.get(), 12, &result));
+  expected.clear();
+  for (const char* mode : { "MAIL", "SHIP" }) {
+    expected.emplace_back(Substitute("$0|$1|$2", mode, q12[mode][0], q12[mode][1]));
+  }
+  EXPECT_EQ(expected, result.rows);
+
+  Status s = RunQuery(client_.get(), 2, &result);
+  ASSERT_TRUE(s.IsNotSupported()) << s.ToString();
+}
+
+} // namespace tpch
+} // namespace kudu
@@ -0,0 +1,450 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/benchmarks/tpch/tpch_queries.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "kudu/benchmarks/tpch/tpch-schemas.h"
+#include "kudu/benchmarks/tpch/tpch_dbgen.h"
+#include "kudu/client/client.h"
+#include "kudu/client/columnar_scan_batch.h"
+#include "kudu/client/scan_predicate.h"
+#include "kudu/client/shared_ptr.h" // IWYU pragma: keep
+#include "kudu/client/value.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/slice.h"
+
+DECLARE_bool(tpch_cache_blocks_when_scanning);
+
+using kudu::client::KuduClient;
+using kudu::client::KuduColumnarScanBatch;
+using kudu::client::KuduPredicate;
+using kudu::client::KuduScanner;
+using kudu::client::KuduTable;
+using kudu::client::KuduValue;
+using std::map;
+using std::pair;
+using std::string;
+using std::unique_ptr;
+using std::unordered_map;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tpch {
+
+namespace {
+
+typedef vector<unique_ptr<KuduPredicate>> Predicates;
+
+// Accesses the values of a fixed-length column of a columnar batch.
+template<typename T>
+class FixedColumn {
+ public:
+  Status Init(const KuduColumnarScanBatch& batch, int idx) {
+    Slice data;
+    RETURN_NOT_OK(batch.GetFixedLengthColumn(idx, &data));
+    data_ = data.data();
+    return Status::OK();
+  }
+
+  T operator[](int row) const {
+    return UnalignedLoad<T>(data_ + row * sizeof(T));
+  }
+
+ private:
+  const uint8_t* data_ = nullptr;
+};
+
+// Accesses the values of a variable-length column of a columnar batch.
+class StringColumn {
+ public:
+  Status Init(const KuduColumnarScanBatch& batch, int idx) {
+    Slice offsets;
+    RETURN_NOT_OK(batch.GetVariableLengthColumn(idx, &offsets, &data_));
+    offsets_ = offsets.data();
+    return Status::OK();
+  }
+
+  Slice operator[](int row) const {
+    const uint32_t start = UnalignedLoad<uint32_t>(offsets_ + row * sizeof(uint32_t));
+    const uint32_t end = UnalignedLoad<uint32_t>(offsets_ + (row + 1) * sizeof(uint32_t));
+    return Slice(data_.data() + start, end - start);
+  }
+
+ private:
+  const uint8_t* offsets_ = nullptr;
+  Slice data_;
+};
+
+// Scans 'table' with the columnar layout, projecting 'columns' and pushing
+// down 'preds', and calls 'f' on each batch.
+Status ScanColumnar(KuduTable* table,
+                    const vector<string>& columns,
+                    Predicates preds,
+                    const std::function<Status(const KuduColumnarScanBatch&)>& f,
+                    QueryResult* result) {
+  KuduScanner scanner(table);
+  RETURN_NOT_OK(scanner.SetProjectedColumnNames(columns));
+  for (auto& pred : preds) {
+    RETURN_NOT_OK(scanner.AddConjunctPredicate(pred.release()));
+  }
+  RETURN_NOT_OK(scanner.SetRowFormatFlags(KuduScanner::COLUMNAR_LAYOUT));
+  RETURN_NOT_OK(scanner.SetCacheBlocks(FLAGS_tpch_cache_blocks_when_scanning));
+  RETURN_NOT_OK(scanner.Open());
+  KuduColumnarScanBatch batch;
+  while (scanner.HasMoreRows()) {
+    RETURN_NOT_OK(scanner.NextBatch(&batch));
+    result->rows_scanned += batch.NumRows();
+    RETURN_NOT_OK(f(batch));
+  }
+  return Status::OK();
+}
+
+// Adds to 'preds' a predicate comparing the column 'col_name' of 'table' to
+// 'value', taking ownership of 'value'.
+void AddComparison(KuduTable* table, const string& col_name, KuduPredicate::ComparisonOp op,
+                   KuduValue* value, Predicates* preds) {
+  preds->emplace_back(table->NewComparisonPredicate(col_name, op, value));
+}
+
+// Returns the single character of a flag column, e.g. l_returnflag.
+Status GetFlag(const Slice& value, char* flag) {
+  if (PREDICT_FALSE(value.size() != 1)) {
+    return Status::Corruption("unexpected flag", value.ToString());
+  }
+  *flag = static_cast<char>(value[0]);
+  return Status::OK();
+}
+
+// Q1, the pricing summary report query:
+//
+// select l_returnflag, l_linestatus, sum(l_quantity) as sum_qty,
+//   sum(l_extendedprice) as sum_base_price,
+//   sum(l_extendedprice * (1 - l_discount)) as sum_disc_price,
+//   sum(l_extendedprice * (1 - l_discount) * (1 + l_tax)) as sum_charge,
+//   avg(l_quantity) as avg_qty, avg(l_extendedprice) as avg_price,
+//   avg(l_discount) as avg_disc, count(*) as count_order
+// from lineitem
+// where l_shipdate <= date '1998-12-01' - interval '90' day
+// group by l_returnflag, l_linestatus
+// order by l_returnflag, l_linestatus
+Status Q1(KuduTable* lineitem, QueryResult* result) {
+  struct Group {
+    int64_t sum_qty = 0;
+    double sum_base_price = 0;
+    double sum_disc_price = 0;
+    double sum_charge = 0;
+    double sum_disc = 0;
+    int64_t count = 0;
+  };
+  map<pair<char, char>, Group> groups;
+
+  Predicates preds;
+  AddComparison(lineitem, kShipDateColName, KuduPredicate::LESS_EQUAL,
+                KuduValue::CopyString("1998-09-02"), &preds);
+  RETURN_NOT_OK(ScanColumnar(
+      lineitem,
+      { kReturnFlagColName, kLineStatusColName, kQuantityColName, kExtendedPriceColName,
+        kDiscountColName, kTaxColName },
+      std::move(preds),
+      [&](const KuduColumnarScanBatch& batch) {
+        StringColumn returnflag;
+        StringColumn linestatus;
+        FixedColumn<int32_t> quantity;
+        FixedColumn<double> extendedprice;
+        FixedColumn<double> discount;
+        FixedColumn<double> tax;
+        RETURN_NOT_OK(returnflag.Init(batch, 0));
+        RETURN_NOT_OK(linestatus.Init(batch, 1));
+        RETURN_NOT_OK(quantity.Init(batch, 2));
+        RETURN_NOT_OK(extendedprice.Init(batch, 3));
+        RETURN_NOT_OK(discount.Init(batch, 4));
+        RETURN_NOT_OK(tax.Init(batch, 5));
+        for (int i = 0; i < batch.NumRows(); i++) {
+          pair<char, char> key;
+          RETURN_NOT_OK(GetFlag(returnflag[i], &key.first));
+          RETURN_NOT_OK(GetFlag(linestatus[i], &key.second));
+          Group& group = groups[key];
+          const double disc_price = extendedprice[i] * (1 - discount[i]);
+          group.sum_qty += quantity[i];
+          group.sum_base_price += extendedprice[i];
+          group.sum_disc_price += disc_price;
+          group.sum_charge += disc_price * (1 + tax[i]);
+          group.sum_disc += discount[i];
+          group.count++;
+        }
+        return Status::OK();
+      },
+      result));
+
+  for (const auto& [key, group] : groups) {
+    result->rows.emplace_back(StringPrintf(
+        "%c|%c|%" PRId64 "|%.2f|%.2f|%.2f|%.2f|%.2f|%.2f|%" PRId64,
+        key.first, key.second, group.sum_qty, group.sum_base_price, group.sum_disc_price,
+        group.sum_charge, static_cast<double>(group.sum_qty) / group.count,
+        group.sum_base_price / group.count, group.sum_disc / group.count, group.count));
+  }
+  return Status::OK();
+}
+
+// Q4, the order priority checking query:
+//
+// select o_orderpriority, count(*) as order_count
+// from orders
+// where o_orderdate >= date '1993-07-01'
+//   and o_orderdate < date '1993-07-01' + interval '3' month
+//   and exists (select * from lineitem
+//               where l_orderkey = o_orderkey and l_commitdate < l_receiptdate)
+// group by o_orderpriority
+// order by o_orderpriority
+Status Q4(KuduTable* orders, KuduTable* lineitem, QueryResult* result) {
+  // The priorities of the orders placed in the quarter which are not known to
+  // have a late line item yet.
+  unordered_map<int64_t, string> priorities;
+  Predicates preds;
+  AddComparison(orders, kOOrderDateColName, KuduPredicate::GREATER_EQUAL,
+                KuduValue::CopyString("1993-07-01"), &preds);
+  AddComparison(orders, kOOrderDateColName, KuduPredicate::LESS,
+                KuduValue::CopyString("1993-10-01"), &preds);
+  RETURN_NOT_OK(ScanColumnar(
+      orders, { kOOrderKeyColName, kOOrderPriorityColName },
+      std::move(preds),
+      [&](const KuduColumnarScanBatch& batch) {
+        FixedColumn<int64_t> orderkey;
+        StringColumn orderpriority;
+        RETURN_NOT_OK(orderkey.Init(batch, 0));
+        RETURN_NOT_OK(orderpriority.Init(batch, 1));
+        for (int i = 0; i < batch.NumRows(); i++) {
+          priorities.emplace(orderkey[i], orderpriority[i].ToString());
+        }
+        return Status::OK();
+      },
+      result));
+
+  map<string, int64_t> counts;
+  RETURN_NOT_OK(ScanColumnar(
+      lineitem,
+      { kOrderKeyColName, kCommitDateColName, kReceiptDateColName },
+      Predicates(),
+      [&](const KuduColumnarScanBatch& batch) {
+        FixedColumn<int64_t> orderkey;
+        StringColumn commitdate;
+        StringColumn receiptdate;
+        RETURN_NOT_OK(orderkey.Init(batch, 0));
+        RETURN_NOT_OK(commitdate.Init(batch, 1));
+        RETURN_NOT_OK(receiptdate.Init(batch, 2));
+        for (int i = 0; i < batch.NumRows(); i++) {
+          if (commitdate[i].compare(receiptdate[i]) >= 0) {
+            continue;
+          }
+          auto it = priorities.find(orderkey[i]);
+          if (it != priorities.end()) {
+            counts[it->second]++;
+            priorities.erase(it);
+          }
+        }
+        return Status::OK();
+      },
+      result));
+
+  for (const auto& [priority, count] : counts) {
+    result->rows.emplace_back(Substitute("$0|$1", priority, count));
+  }
+  return Status::OK();
+}
+
+// Q6, the forecasting revenue change query:
+//
+// select sum(l_extendedprice * l_discount) as revenue
+// from lineitem
+// where l_shipdate >= date '1994-01-01'
+//   and l_shipdate < date '1994-01-01' + interval '1' year
+//   and l_discount between 0.06 - 0.01 and 0.06 + 0.01
+//   and l_quantity < 24
+Status Q6(KuduTable* lineitem, QueryResult* result) {
+  Predicates preds;
+  AddComparison(lineitem, kShipDateColName, KuduPredicate::GREATER_EQUAL,
+                KuduValue::CopyString("1994-01-01"), &preds);
+  AddComparison(lineitem, kShipDateColName, KuduPredicate::LESS,
+                KuduValue::CopyString("1995-01-01"), &preds);
+  AddComparison(lineitem, kDiscountColName, KuduPredicate::GREATER_EQUAL,
+                KuduValue::FromDouble(0.05), &preds);
+  AddComparison(lineitem, kDiscountColName, KuduPredicate::LESS_EQUAL,
+                KuduValue::FromDouble(0.07), &preds);
+  AddComparison(lineitem, kQuantityColName, KuduPredicate::LESS, KuduValue::FromInt(24), &preds);
+  double revenue = 0;
+  RETURN_NOT_OK(ScanColumnar(
+      lineitem, { kExtendedPriceColName, kDiscountColName },
+      std::move(preds),
+      [&](const KuduColumnarScanBatch& batch) {
+        FixedColumn<double> extendedprice;
+        FixedColumn<double> discount;
+        RETURN_NOT_OK(extendedprice.Init(batch, 0));
+        RETURN_NOT_OK(discount.Init(batch, 1));
+        for (int i = 0; i < batch.NumRows(); i++) {
+          revenue += extendedprice[i] * discount[i];
+        }
+        return Status::OK();
+      },
+      result));
+  result->rows.emplace_back(StringPrintf("%.2f", revenue));
+  return Status::OK();
+}
+
+// Q12, the shipping modes and order priority query:
+//
+// select l_shipmode,
+//   sum(case when o_orderpriority = '1-URGENT' or o_orderpriority = '2-HIGH'
+//       then 1 else 0 end) as high_line_count,
+//   sum(case when o_orderpriority <> '1-URGENT' and o_orderpriority <> '2-HIGH'
+//       then 1 else 0 end) as low_line_count
+// from orders, lineitem
+// where o_orderkey = l_orderkey
+//   and l_shipmode in ('MAIL', 'SHIP')
+//   and l_commitdate < l_receiptdate
+//   and l_shipdate < l_commitdate
+//   and l_receiptdate >= date '1994-01-01'
+//   and l_receiptdate < date '1994-01-01' + interval '1' year
+// group by l_shipmode
+// order by l_shipmode
+Status Q12(KuduTable* orders, KuduTable* lineitem, QueryResult* result) {
+  static const char* const kShipModes[] = { "MAIL", "SHIP" };
+
+  // The number of matching line items of each order, per ship mode.
+  unordered_map<int64_t, std::array<int64_t, 2>> lines_per_order;
+  int64_t min_orderkey = INT64_MAX;
+  int64_t max_orderkey = INT64_MIN;
+  Predicates preds;
+  vector<KuduValue*> shipmodes;
+  for (const char* mode : kShipModes) {
+    shipmodes.push_back(KuduValue::CopyString(mode));
+  }
+  preds.emplace_back(lineitem->NewInListPredicate(kShipModeColName, &shipmodes));
+  AddComparison(lineitem, kReceiptDateColName, KuduPredicate::GREATER_EQUAL,
+                KuduValue::CopyString("1994-01-01"), &preds);
+  AddComparison(lineitem, kReceiptDateColName, KuduPredicate::LESS,
+                KuduValue::CopyString("1995-01-01"), &preds);
+  RETURN_NOT_OK(ScanColumnar(
+      lineitem,
+      { kOrderKeyColName, kShipModeColName, kShipDateColName, kCommitDateColName,
+        kReceiptDateColName },
+      std::move(preds),
+      [&](const KuduColumnarScanBatch& batch) {
+        FixedColumn<int64_t> orderkey;
+        StringColumn shipmode;
+        StringColumn shipdate;
+        StringColumn commitdate;
+        StringColumn receiptdate;
+        RETURN_NOT_OK(orderkey.Init(batch, 0));
+        RETURN_NOT_OK(shipmode.Init(batch, 1));
+        RETURN_NOT_OK(shipdate.Init(batch, 2));
+        RETURN_NOT_OK(commitdate.Init(batch, 3));
+        RETURN_NOT_OK(receiptdate.Init(batch, 4));
+        for (int i = 0; i < batch.NumRows(); i++) {
+          if (commitdate[i].compare(receiptdate[i]) >= 0 ||
+              shipdate[i].compare(commitdate[i]) >= 0) {
+            continue;
+          }
+          const int64_t key = orderkey[i];
+          auto& lines = lines_per_order.emplace(key, std::array<int64_t, 2>{}).first->second;
+          lines[shipmode[i] == kShipModes[0] ? 0 : 1]++;
+          min_orderkey = std::min(min_orderkey, key);
+          max_orderkey = std::max(max_orderkey, key);
+        }
+        return Status::OK();
+      },
+      result));
+
+  int64_t high_line_count[2] = { 0, 0 };
+  int64_t low_line_count[2] = { 0, 0 };
+  if (!lines_per_order.empty()) {
+    preds.clear();
+    AddComparison(orders, kOOrderKeyColName, KuduPredicate::GREATER_EQUAL,
+                  KuduValue::FromInt(min_orderkey), &preds);
+    AddComparison(orders, kOOrderKeyColName, KuduPredicate::LESS_EQUAL,
+                  KuduValue::FromInt(max_orderkey), &preds);
+    RETURN_NOT_OK(ScanColumnar(
+        orders, { kOOrderKeyColName, kOOrderPriorityColName },
+        std::move(preds),
+        [&](const KuduColumnarScanBatch& batch) {
+          FixedColumn<int64_t> orderkey;
+          StringColumn orderpriority;
+          RETURN_NOT_OK(orderkey.Init(batch, 0));
+          RETURN_NOT_OK(orderpriority.Init(batch, 1));
+          for (int i = 0; i < batch.NumRows(); i++) {
+            const auto it = lines_per_order.find(orderkey[i]);
+            if (it == lines_per_order.end()) {
+              continue;
+            }
+            const Slice priority = orderpriority[i];
+            int64_t* counts = priority == "1-URGENT" || priority == "2-HIGH"
+                ? high_line_count : low_line_count;
+            counts[0] += it->second[0];
+            counts[1] += it->second[1];
+          }
+          return Status::OK();
+        },
+        result));
+  }
+  for (int i = 0; i < 2; i++) {
+    result->rows.emplace_back(
+        Substitute("$0|$1|$2", kShipModes[i], high_line_count[i], low_line_count[i]));
+  }
+  return Status::OK();
+}
+
+} // anonymous namespace
+
+const vector<int>& SupportedQueries() {
+  static const vector<int> kQueries = { 1, 4, 6, 12 };
+  return kQueries;
+}
+
+Status RunQuery(KuduClient* client, int query, QueryResult* result) {
+  *result = QueryResult();
+  client::sp::shared_ptr<KuduTable> orders;
+  RETURN_NOT_OK(client->OpenTable(kOrdersTableName, &orders));
+  client::sp::shared_ptr<KuduTable> lineitem;
+  RETURN_NOT_OK(client->OpenTable(kLineItemTableName, &lineitem));
+  switch (query) {
+    case 1: return Q1(lineitem.get(), result);
+    case 4: return Q4(orders.get(), lineitem.get(), result);
+    case 6: return Q6(lineitem.get(), result);
+    case 12: return Q12(orders.get(), lineitem.get(), result);
+    default:
+      return Status::NotSupported(Substitute("TPC-H query $0 is not supported", query));
+  }
+}
+
+} // namespace tpch
+} // namespace kudu
@@ -0,0 +1,56 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+namespace client {
+class KuduClient;
+} // namespace client
+
+namespace tpch {
+
+struct QueryResult {
+  // The rows of the result, in the order of the query, with their columns
+  // separated by '|'.
+  std::vector<std::string> rows;
+
+  // The number of rows returned by the scans of the query, i.e. once the
+  // predicates pushed down to the tablet servers are evaluated.
+  int64_t rows_scanned = 0;
+};
+
+// The TPC-H queries RunQuery() implements: those over the ORDERS and LINEITEM
+// tables only, namely Q1, Q4, Q6 and Q12.
+const std::vector<int>& SupportedQueries();
+
+// Runs the TPC-H query number 'query', with the validation parameters of the
+// specification, against the tables of the client's cluster.
+//
+// The tables are read with columnar scans, pushing down the predicates Kudu
+// can evaluate; the rest of the query, i.e. the predicates comparing columns,
+// the joins and the aggregations, is evaluated by the client.
+Status RunQuery(client::KuduClient* client, int query, QueryResult* result);
+
+} // namespace tpch
+} // namespace kudu
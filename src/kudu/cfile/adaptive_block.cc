@@ -0,0 +1,240 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/adaptive_block.h"
+
+#include <limits>
+#include <ostream>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/type_encodings.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace cfile {
+
+namespace {
+
+// The encodings tried for each block, in order of preference: when two
+// candidates produce blocks of the same size, the one listed first wins.
+//
+// BIT_SHUFFLE, when it applies, comes first so that it's the candidate which
+// decides how many values fit: it never accepts more values than the others
+// can hold. Otherwise PLAIN_ENCODING does.
+constexpr EncodingType kCandidateEncodings[] = {
+  BIT_SHUFFLE,
+  PLAIN_ENCODING,
+  RLE,
+  FRAME_OF_REFERENCE,
+  XOR_ENCODING,
+  PREFIX_ENCODING,
+};
+
+bool IsCandidateEncoding(EncodingType encoding) {
+  for (EncodingType e : kCandidateEncodings) {
+    if (e == encoding) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t TotalSize(const vector<Slice>& slices) {
+  size_t size = 0;
+  for (const Slice& s : slices) {
+    size += s.size();
+  }
+  return size;
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////
+// Encoding
+////////////////////////////////////////////////////////////
+
+AdaptiveBlockBuilder::AdaptiveBlockBuilder(const TypeInfo* typeinfo,
+                                           const WriterOptions* options)
+    : chosen_(nullptr),
+      count_(0) {
+  for (EncodingType encoding : kCandidateEncodings) {
+    const TypeEncodingInfo* info;
+    if (!TypeEncodingInfo::Get(typeinfo, encoding, &info).ok()) {
+      continue;
+    }
+    unique_ptr<BlockBuilder> builder;
+    CHECK_OK(info->CreateBlockBuilder(&builder, options));
+    candidates_.push_back({ encoding, std::move(builder), true });
+  }
+  CHECK(!candidates_.empty()) << "no candidate encodings for type " << typeinfo->name();
+}
+
+bool AdaptiveBlockBuilder::IsBlockFull() const {
+  return candidates_[0].builder->IsBlockFull();
+}
+
+int AdaptiveBlockBuilder::Add(const uint8_t* vals, size_t count) {
+  DCHECK(chosen_ == nullptr);
+  const int added = candidates_[0].builder->Add(vals, count);
+  if (added == 0) {
+    return 0;
+  }
+  for (size_t i = 1; i < candidates_.size(); i++) {
+    Candidate* c = &candidates_[i];
+    if (c->complete && c->builder->Add(vals, added) != added) {
+      // The candidate ran out of room before the block did: it can't be
+      // picked for this block anymore.
+      c->complete = false;
+    }
+  }
+  count_ += added;
+  return added;
+}
+
+void AdaptiveBlockBuilder::Finish(rowid_t ordinal_pos, vector<Slice>* slices) {
+  vector<Slice> best_slices;
+  size_t best_size = std::numeric_limits<size_t>::max();
+  for (const Candidate& c : candidates_) {
+    if (!c.complete) {
+      continue;
+    }
+    vector<Slice> candidate_slices;
+    c.builder->Finish(ordinal_pos, &candidate_slices);
+    const size_t size = TotalSize(candidate_slices);
+    if (size < best_size) {
+      best_size = size;
+      best_slices = std::move(candidate_slices);
+      chosen_ = &c;
+    }
+  }
+  DCHECK(chosen_ != nullptr);
+
+  header_buffer_.resize(kHeaderSize);
+  InlineEncodeFixed32(&header_buffer_[0], chosen_->encoding);
+  best_slices.insert(best_slices.begin(), Slice(header_buffer_));
+  *slices = std::move(best_slices);
+}
+
+void AdaptiveBlockBuilder::Reset() {
+  for (Candidate& c : candidates_) {
+    c.builder->Reset();
+    c.complete = true;
+  }
+  chosen_ = nullptr;
+  count_ = 0;
+}
+
+Status AdaptiveBlockBuilder::GetFirstKey(void* key) const {
+  if (chosen_ == nullptr) {
+    return candidates_[0].builder->GetFirstKey(key);
+  }
+  return chosen_->builder->GetFirstKey(key);
+}
+
+Status AdaptiveBlockBuilder::GetLastKey(void* key) const {
+  if (chosen_ == nullptr) {
+    return candidates_[0].builder->GetLastKey(key);
+  }
+  return chosen_->builder->GetLastKey(key);
+}
+
+////////////////////////////////////////////////////////////
+// Decoding
+////////////////////////////////////////////////////////////
+
+AdaptiveBlockDecoder::AdaptiveBlockDecoder(const TypeInfo* typeinfo,
+                                           scoped_refptr<BlockHandle> block,
+                                           CFileIterator* parent_cfile_iter)
+    : typeinfo_(typeinfo),
+      block_(std::move(block)),
+      parent_cfile_iter_(parent_cfile_iter),
+      parsed_(false) {
+}
+
+Status AdaptiveBlockDecoder::ParseHeader() {
+  CHECK(!parsed_);
+  const Slice data = block_->data();
+  if (PREDICT_FALSE(data.size() < AdaptiveBlockBuilder::kHeaderSize)) {
+    return Status::Corruption(
+        Substitute("not enough bytes for header: adaptive block header "
+                   "size ($0) less than expected header length ($1)",
+                   data.size(), AdaptiveBlockBuilder::kHeaderSize));
+  }
+
+  const uint32_t encoding_val = DecodeFixed32(data.data());
+  if (PREDICT_FALSE(!EncodingType_IsValid(encoding_val) ||
+                    !IsCandidateEncoding(static_cast<EncodingType>(encoding_val)))) {
+    return Status::Corruption(
+        Substitute("invalid encoding $0 in adaptive block header", encoding_val));
+  }
+  const EncodingType encoding = static_cast<EncodingType>(encoding_val);
+  const TypeEncodingInfo* info;
+  Status s = TypeEncodingInfo::Get(typeinfo_, encoding, &info);
+  if (PREDICT_FALSE(!s.ok())) {
+    return Status::Corruption("bad encoding in adaptive block header", s.ToString());
+  }
+  RETURN_NOT_OK(info->CreateBlockDecoder(
+      &data_decoder_,
+      block_->SubrangeBlock(AdaptiveBlockBuilder::kHeaderSize,
+                            data.size() - AdaptiveBlockBuilder::kHeaderSize),
+      parent_cfile_iter_));
+  RETURN_NOT_OK(data_decoder_->ParseHeader());
+  parsed_ = true;
+  return Status::OK();
+}
+
+Status AdaptiveBlockDecoder::CopyNextAndEval(size_t* n,
+                                             ColumnMaterializationContext* ctx,
+                                             SelectionVectorView* sel,
+                                             ColumnDataView* dst) {
+  DCHECK(parsed_);
+  ctx->SetDecoderEvalSupported();
+  RETURN_NOT_OK(data_decoder_->CopyNextValues(n, dst));
+  if (*n == 0) {
+    return Status::OK();
+  }
+
+  if (!eval_sel_) {
+    eval_sel_.reset(new SelectionVector(data_decoder_->Count()));
+  }
+  eval_sel_->Resize(*n);
+  eval_sel_->SetAllTrue();
+  ColumnBlock block(dst->type_info(), nullptr, dst->data(), *n, nullptr);
+  ctx->pred()->Evaluate(block, eval_sel_.get());
+  for (size_t i = 0; i < *n; i++) {
+    if (sel->TestBit(i) && !eval_sel_->IsRowSelected(i)) {
+      sel->ClearBit(i);
+    }
+  }
+  return Status::OK();
+}
+
+} // namespace cfile
+} // namespace kudu
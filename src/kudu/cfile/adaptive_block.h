@@ -0,0 +1,175 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Adaptive encoding: every data block is encoded with each of the candidate
+// encodings that apply to the column's type, and the smallest result is
+// kept. The block layout is:
+//
+//   encoding (32-bit fixed): the EncodingType of the embedded block
+//   the block, as written by that encoding's BlockBuilder
+//
+// Encodings which keep per-file state (i.e. dictionary encoding) can't vary
+// from block to block, so they are never candidates.
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/cfile/block_handle.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowid.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class ColumnDataView;
+class ColumnMaterializationContext;
+class SelectionVector;
+class SelectionVectorView;
+class TypeInfo;
+
+namespace cfile {
+
+class CFileIterator;
+struct WriterOptions;
+
+class AdaptiveBlockBuilder final : public BlockBuilder {
+ public:
+  AdaptiveBlockBuilder(const TypeInfo* typeinfo, const WriterOptions* options);
+
+  bool IsBlockFull() const override;
+
+  int Add(const uint8_t* vals, size_t count) override;
+
+  // Finishes every candidate which holds the whole block and returns the
+  // smallest result.
+  void Finish(rowid_t ordinal_pos, std::vector<Slice>* slices) override;
+
+  void Reset() override;
+
+  size_t Count() const override {
+    return count_;
+  }
+
+  Status GetFirstKey(void* key) const override;
+
+  Status GetLastKey(void* key) const override;
+
+  // Returns the encoding picked by the last call to Finish().
+  EncodingType chosen_encoding() const {
+    DCHECK(chosen_ != nullptr);
+    return chosen_->encoding;
+  }
+
+  static const size_t kHeaderSize = sizeof(uint32_t);
+
+ private:
+  struct Candidate {
+    EncodingType encoding;
+    std::unique_ptr<BlockBuilder> builder;
+
+    // Whether the builder holds every value added to the current block.
+    bool complete;
+  };
+
+  // The first candidate determines how many values fit in the block: the
+  // others are only handed the values it accepted.
+  std::vector<Candidate> candidates_;
+  const Candidate* chosen_;
+  size_t count_;
+
+  // Buffer used in Finish() for holding the encoded header.
+  faststring header_buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdaptiveBlockBuilder);
+};
+
+class AdaptiveBlockDecoder final : public BlockDecoder {
+ public:
+  AdaptiveBlockDecoder(const TypeInfo* typeinfo,
+                       scoped_refptr<BlockHandle> block,
+                       CFileIterator* parent_cfile_iter);
+
+  Status ParseHeader() override;
+
+  void SeekToPositionInBlock(uint pos) override {
+    data_decoder_->SeekToPositionInBlock(pos);
+  }
+
+  Status SeekAtOrAfterValue(const void* value, bool* exact_match) override {
+    return data_decoder_->SeekAtOrAfterValue(value, exact_match);
+  }
+
+  void SeekForward(int* n) override {
+    data_decoder_->SeekForward(n);
+  }
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) override {
+    return data_decoder_->CopyNextValues(n, dst);
+  }
+
+  // Not every candidate encoding can evaluate predicates while decoding,
+  // but a column must do so consistently, so the predicate is always
+  // evaluated here on the decoded values.
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override;
+
+  bool HasNext() const override {
+    return data_decoder_->HasNext();
+  }
+
+  size_t Count() const override {
+    return data_decoder_->Count();
+  }
+
+  size_t GetCurrentIndex() const override {
+    return data_decoder_->GetCurrentIndex();
+  }
+
+  rowid_t GetFirstRowId() const override {
+    return data_decoder_->GetFirstRowId();
+  }
+
+ private:
+  const TypeInfo* typeinfo_;
+  scoped_refptr<BlockHandle> block_;
+  CFileIterator* parent_cfile_iter_;
+  bool parsed_;
+
+  std::unique_ptr<BlockDecoder> data_decoder_;
+
+  // Scratch space for CopyNextAndEval(), allocated on first use.
+  std::unique_ptr<SelectionVector> eval_sel_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdaptiveBlockDecoder);
+};
+
+} // namespace cfile
+} // namespace kudu
@@ -318,10 +318,31 @@ Status BinaryPlainBlockDecoder::HandleBatch(size_t* n, ColumnDataView* dst, Cell
 }
 
 Status BinaryPlainBlockDecoder::CopyNextValues(size_t* n, ColumnDataView* dst) {
+  DCHECK(parsed_);
+  CHECK_EQ(dst->type_info()->physical_type(), BINARY);
+  DCHECK_LE(*n, dst->nrows());
+  DCHECK_EQ(dst->stride(), sizeof(Slice));
+  if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+    *n = 0;
+    return Status::OK();
+  }
+  const size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+
+  // The cells point straight into the block, which 'dst' keeps alive, so
+  // there's nothing to copy. Each offset is the end of one cell and the start
+  // of the next, so it only needs to be loaded once.
   dst->memory()->RetainReference(block_);
-  return HandleBatch(n, dst, [&](size_t /*i*/, Slice elem, Slice* out) {
-                               *out = elem;
-  });
+  Slice* out = reinterpret_cast<Slice*>(dst->data());
+  const uint8_t* base = data_.data();
+  uint32_t start = offset(cur_idx_);
+  for (size_t i = 0; i < max_fetch; i++) {
+    const uint32_t end = offset(cur_idx_ + i + 1);
+    out[i] = Slice(base + start, end - start);
+    start = end;
+  }
+  cur_idx_ += max_fetch;
+  *n = max_fetch;
+  return Status::OK();
 }
 
 Status BinaryPlainBlockDecoder::CopyNextAndEval(size_t* n,
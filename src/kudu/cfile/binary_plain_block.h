@@ -126,6 +126,9 @@ class BinaryPlainBlockDecoder final : public BlockDecoder {
   void SeekToPositionInBlock(uint pos) override;
   Status SeekAtOrAfterValue(const void *value,
                             bool *exact_match) override;
+  // The Slices handed out point directly into the block's data rather than
+  // being copied into 'dst''s arena: 'dst''s RowBlockMemory retains a
+  // reference to the block instead.
   Status CopyNextValues(size_t *n, ColumnDataView *dst) override;
   Status CopyNextAndEval(size_t* n,
                          ColumnMaterializationContext* ctx,
@@ -28,8 +28,11 @@
 
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/cfile_util.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/port.h"
@@ -449,6 +452,74 @@ Status BinaryPrefixBlockDecoder::CopyNextValues(size_t *n, ColumnDataView *dst)
   return Status::OK();
 }
 
+Status BinaryPrefixBlockDecoder::CopyNextAndEval(size_t* n,
+                                                 ColumnMaterializationContext* ctx,
+                                                 SelectionVectorView* sel,
+                                                 ColumnDataView* dst) {
+  DCHECK(parsed_);
+  CHECK_EQ(dst->type_info()->physical_type(), BINARY);
+
+  DCHECK_EQ(dst->stride(), sizeof(Slice));
+  DCHECK_LE(*n, dst->nrows());
+
+  ctx->SetDecoderEvalSupported();
+  if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+    *n = 0;
+    return Status::OK();
+  }
+
+  Arena* out_arena = dst->arena();
+  Slice* out = reinterpret_cast<Slice*>(dst->data());
+  const size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+
+  // 'cur_val_' always holds the value at 'cur_idx_'. The result of evaluating
+  // it, and its copy in the output arena, are kept until it changes.
+  bool evaluated = false;
+  bool matches = false;
+  bool copied = false;
+  Slice copy;
+  for (size_t i = 0; i < max_fetch; i++) {
+    if (sel->TestBit(i)) {
+      if (!evaluated) {
+        Slice cur(cur_val_);
+        matches = ctx->pred()->EvaluateCell<BINARY>(static_cast<const void*>(&cur));
+        evaluated = true;
+      }
+      if (matches) {
+        if (!copied) {
+          const uint8_t* out_data = out_arena->AddSlice(cur_val_);
+          if (PREDICT_FALSE(out_data == nullptr)) {
+            return Status::IOError(
+                "Out of memory",
+                StringPrintf("Failed to allocate %d bytes in output arena",
+                             static_cast<int>(cur_val_.size())));
+          }
+          copy = Slice(out_data, cur_val_.size());
+          copied = true;
+        }
+        out[i] = copy;
+      } else {
+        sel->ClearBit(i);
+      }
+    }
+
+    cur_idx_++;
+    if (cur_idx_ < num_elems_) {
+      bool unchanged;
+      RETURN_NOT_OK(ParseNextValue(&unchanged));
+      if (!unchanged) {
+        evaluated = false;
+        copied = false;
+      }
+    } else {
+      next_ptr_ = nullptr;
+    }
+  }
+
+  *n = max_fetch;
+  return Status::OK();
+}
+
 // Decode the lengths pointed to by 'ptr', doing bounds checking.
 //
 // Returns a pointer to where the value itself starts.
@@ -520,7 +591,10 @@ inline Status BinaryPrefixBlockDecoder::ParseNextIntoArena(Slice prev_val,
 // Parses the data pointed to by next_ptr_ and stores it in cur_val_
 // Advances next_ptr_ to point to the following values.
 // Does not modify cur_idx_
-inline Status BinaryPrefixBlockDecoder::ParseNextValue() {
+//
+// If 'unchanged' is not null, sets it to whether the new value is identical
+// to the previous one.
+inline Status BinaryPrefixBlockDecoder::ParseNextValue(bool* unchanged) {
   RETURN_NOT_OK(CheckNextPtr());
 
   uint32_t shared, non_shared;
@@ -536,6 +610,9 @@ inline Status BinaryPrefixBlockDecoder::ParseNextValue() {
   DCHECK_LE(shared, cur_val_.size())
     << "Specified longer shared amount than previous key length";
 
+  if (unchanged) {
+    *unchanged = non_shared == 0 && shared == cur_val_.size();
+  }
   cur_val_.resize(shared);
   cur_val_.append(val_delta, non_shared);
 
@@ -93,6 +93,15 @@ class BinaryPrefixBlockDecoder final : public BlockDecoder {
                             bool *exact_match) override;
   Status CopyNextValues(size_t *n, ColumnDataView *dst) override;
 
+  // Evaluate the predicate on each value as it is decoded, only copying the
+  // values which satisfy it into the destination arena. Runs of identical
+  // values (entries which share their entire prefix with the previous entry)
+  // are evaluated and copied once.
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override;
+
   bool HasNext() const override {
     DCHECK(parsed_);
     return cur_idx_ < num_elems_;
@@ -120,7 +129,7 @@ class BinaryPrefixBlockDecoder final : public BlockDecoder {
  private:
   Status SkipForward(int n);
   Status CheckNextPtr();
-  Status ParseNextValue();
+  Status ParseNextValue(bool* unchanged = nullptr);
   Status ParseNextIntoArena(Slice prev_val, Arena *dst, Slice *copied);
 
   const uint8_t *DecodeEntryLengths(const uint8_t *ptr,
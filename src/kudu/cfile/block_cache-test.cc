@@ -17,19 +17,41 @@
 
 #include "kudu/cfile/block_cache.h"
 
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/util/cache.h"
+#include "kudu/util/env.h"
 #include "kudu/util/mem_tracker.h"
+#include "kudu/util/metrics.h"
 #include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
 
 DECLARE_double(cache_memtracker_approximation_ratio);
+DECLARE_string(block_cache_eviction_policy);
+DECLARE_double(block_cache_compressed_capacity_ratio);
+DECLARE_double(block_cache_index_capacity_ratio);
+
+METRIC_DECLARE_entity(server);
+METRIC_DEFINE_counter(server, test_block_cache_hits, "Test Block Cache Hits",
+                      kudu::MetricUnit::kCacheHits, "Test", kudu::MetricLevel::kInfo);
+METRIC_DEFINE_counter(server, test_block_cache_misses, "Test Block Cache Misses",
+                      kudu::MetricUnit::kCacheQueries, "Test", kudu::MetricLevel::kInfo);
+METRIC_DEFINE_gauge_int64(server, test_block_cache_usage, "Test Block Cache Usage",
+                          kudu::MetricUnit::kBytes, "Test", kudu::MetricLevel::kInfo);
 
 namespace kudu {
 namespace cfile {
@@ -85,6 +107,196 @@ TEST(TestBlockCache, TestBasics) {
   ASSERT_FALSE(cache.Lookup(key1, Cache::EXPECT_IN_CACHE, &retrieved_handle));
 }
 
+// The blocks inserted with an attribution should be accounted to it until
+// they're evicted.
+TEST(TestBlockCache, TestAttribution) {
+  constexpr int64_t kCapacity = 1024 * 1024;
+  constexpr int64_t kBlockSize = 4096;
+  MetricRegistry registry;
+  scoped_refptr<MetricEntity> entity(METRIC_ENTITY_server.Instantiate(&registry, "test"));
+  scoped_refptr<AtomicGauge<int64_t>> usage(
+      METRIC_test_block_cache_usage.Instantiate(entity, 0));
+  scoped_refptr<BlockCacheAttribution> attribution(new BlockCacheAttribution(
+      METRIC_test_block_cache_hits.Instantiate(entity),
+      METRIC_test_block_cache_misses.Instantiate(entity),
+      usage));
+  {
+    BlockCache cache(kCapacity);
+    BlockCache::FileId id(1234);
+    const auto insert = [&](int64_t i) {
+      BlockCache::PendingEntry data = cache.Allocate(
+          BlockCache::CacheKey(id, i * kBlockSize), kBlockSize);
+      ASSERT_TRUE(data.valid());
+      memset(data.val_ptr(), 0, kBlockSize);
+      BlockCacheHandle handle;
+      cache.Insert(&data, &handle, attribution.get());
+    };
+
+    for (int64_t i = 0; i < 10; i++) {
+      NO_FATALS(insert(i));
+    }
+    ASSERT_EQ(10 * kBlockSize, usage->value());
+    ASSERT_FALSE(attribution->HasOneRef());
+
+    // Evict most of the blocks by inserting many more: the usage shouldn't
+    // exceed the capacity of the cache.
+    for (int64_t i = 10; i < 4 * kCapacity / kBlockSize; i++) {
+      NO_FATALS(insert(i));
+    }
+    ASSERT_GT(usage->value(), 0);
+    ASSERT_LE(usage->value(), kCapacity);
+  }
+  // Once the cache is destroyed, none of the blocks is attributed anymore.
+  ASSERT_EQ(0, usage->value());
+  ASSERT_TRUE(attribution->HasOneRef());
+}
+
+// Data blocks should not evict index blocks when the index partition is
+// enabled, however many of them are inserted.
+TEST(TestBlockCache, TestIndexPartition) {
+  FLAGS_cache_memtracker_approximation_ratio = 0;
+  FLAGS_block_cache_index_capacity_ratio = 0.5;
+  constexpr size_t kCapacity = 1024 * 1024;
+  constexpr size_t kBlockSize = 4096;
+  BlockCache cache(kCapacity);
+  BlockCache::FileId id(1234);
+
+  const auto insert = [&](const BlockCache::CacheKey& key, BlockCache::BlockType type) {
+    BlockCache::PendingEntry data = cache.Allocate(key, kBlockSize, type);
+    ASSERT_TRUE(data.valid());
+    memset(data.val_ptr(), 0, kBlockSize);
+    BlockCacheHandle handle;
+    cache.Insert(&data, &handle);
+  };
+
+  BlockCache::CacheKey index_key(id, 0);
+  insert(index_key, BlockCache::BlockType::INDEX);
+  for (size_t i = 1; i <= 4 * kCapacity / kBlockSize; i++) {
+    insert(BlockCache::CacheKey(id, i * kBlockSize), BlockCache::BlockType::DATA);
+  }
+
+  BlockCacheHandle handle;
+  ASSERT_TRUE(cache.Lookup(index_key, Cache::EXPECT_IN_CACHE, &handle,
+                           BlockCache::BlockType::INDEX));
+  // The index block is only found in its own partition.
+  ASSERT_FALSE(cache.Lookup(index_key, Cache::EXPECT_IN_CACHE, &handle,
+                            BlockCache::BlockType::DATA));
+  // The earliest data blocks were evicted to make room for the later ones.
+  ASSERT_FALSE(cache.Lookup(BlockCache::CacheKey(id, kBlockSize),
+                            Cache::EXPECT_IN_CACHE, &handle));
+
+  FLAGS_block_cache_index_capacity_ratio = 0;
+}
+
+TEST(TestBlockCache, TestCompressedPartition) {
+  FLAGS_cache_memtracker_approximation_ratio = 0;
+  constexpr size_t kCapacity = 1024 * 1024;
+  constexpr size_t kBlockSize = 4096;
+  {
+    BlockCache cache(kCapacity);
+    ASSERT_FALSE(cache.caches_compressed_blocks());
+  }
+  FLAGS_block_cache_compressed_capacity_ratio = 0.5;
+  BlockCache cache(kCapacity);
+  ASSERT_TRUE(cache.caches_compressed_blocks());
+  BlockCache::FileId id(1234);
+
+  // Fill the compressed partition: the data partition is left alone.
+  BlockCache::CacheKey data_key(id, 0);
+  {
+    BlockCache::PendingEntry data = cache.Allocate(data_key, kBlockSize);
+    ASSERT_TRUE(data.valid());
+    memset(data.val_ptr(), 0, kBlockSize);
+    BlockCacheHandle handle;
+    cache.Insert(&data, &handle);
+  }
+  for (size_t i = 1; i <= 4 * kCapacity / kBlockSize; i++) {
+    BlockCache::PendingEntry data = cache.Allocate(BlockCache::CacheKey(id, i * kBlockSize),
+                                                   kBlockSize,
+                                                   BlockCache::BlockType::COMPRESSED);
+    ASSERT_TRUE(data.valid());
+    memset(data.val_ptr(), 0, kBlockSize);
+    BlockCacheHandle handle;
+    cache.Insert(&data, &handle);
+  }
+
+  BlockCacheHandle handle;
+  ASSERT_TRUE(cache.Lookup(data_key, Cache::EXPECT_IN_CACHE, &handle));
+  ASSERT_FALSE(cache.Lookup(data_key, Cache::EXPECT_IN_CACHE, &handle,
+                            BlockCache::BlockType::COMPRESSED));
+  ASSERT_FALSE(cache.Lookup(BlockCache::CacheKey(id, kBlockSize), Cache::EXPECT_IN_CACHE,
+                            &handle, BlockCache::BlockType::COMPRESSED));
+  ASSERT_TRUE(cache.Lookup(BlockCache::CacheKey(id, 4 * kCapacity), Cache::EXPECT_IN_CACHE,
+                           &handle, BlockCache::BlockType::COMPRESSED));
+
+  FLAGS_block_cache_compressed_capacity_ratio = 0;
+}
+
+class BlockCacheManifestTest : public KuduTest {
+};
+
+TEST_F(BlockCacheManifestTest, TestSaveAndLoad) {
+  FLAGS_block_cache_index_capacity_ratio = 0.5;
+  BlockCache cache(1024 * 1024);
+  BlockCache::FileId id(1234);
+  std::set<std::pair<uint64_t, uint64_t>> expected;
+  for (int i = 0; i < 10; i++) {
+    BlockCache::CacheKey key(id, i);
+    BlockCache::PendingEntry data =
+        cache.Allocate(key, 16, i % 2 ? BlockCache::BlockType::INDEX
+                                      : BlockCache::BlockType::DATA);
+    ASSERT_TRUE(data.valid());
+    BlockCacheHandle handle;
+    cache.Insert(&data, &handle);
+    expected.emplace(key.file_id_, key.offset_);
+  }
+
+  const std::string path = GetTestPath("manifest");
+  std::vector<BlockCache::CacheKey> keys;
+  ASSERT_TRUE(BlockCache::LoadManifest(env_, path, &keys).IsNotFound());
+  ASSERT_OK(cache.SaveManifest(env_, path));
+  ASSERT_OK(BlockCache::LoadManifest(env_, path, &keys));
+  std::set<std::pair<uint64_t, uint64_t>> loaded;
+  for (const auto& key : keys) {
+    loaded.emplace(key.file_id_, key.offset_);
+  }
+  // The keys of both partitions are saved.
+  ASSERT_EQ(expected, loaded);
+
+  // Saving the manifest doesn't evict anything.
+  BlockCacheHandle handle;
+  ASSERT_TRUE(cache.Lookup(BlockCache::CacheKey(id, 0), Cache::EXPECT_IN_CACHE, &handle));
+
+  // A truncated manifest is detected.
+  ASSERT_OK(WriteStringToFile(env_, "123", path));
+  ASSERT_TRUE(BlockCache::LoadManifest(env_, path, &keys).IsCorruption());
+
+  FLAGS_block_cache_index_capacity_ratio = 0;
+}
+
+TEST(TestBlockCache, TestSegmentedLRUEvictionPolicy) {
+  if (BlockCache::GetConfiguredCacheMemoryTypeOrDie() != Cache::MemoryType::DRAM) {
+    GTEST_SKIP() << "SLRU eviction policy requires the DRAM block cache";
+  }
+  FLAGS_block_cache_eviction_policy = "slru";
+  ASSERT_EQ(Cache::EvictionPolicy::SLRU, BlockCache::GetConfiguredEvictionPolicyOrDie());
+
+  BlockCache cache(512 * 1024 * 1024);
+  std::shared_ptr<MemTracker> mem_tracker;
+  ASSERT_TRUE(MemTracker::FindTracker("block_cache-sharded_slru_cache", &mem_tracker));
+
+  BlockCache::CacheKey key(BlockCache::FileId(1234), 1);
+  size_t data_size = strlen(DATA_TO_CACHE) + 1;
+  BlockCache::PendingEntry data = cache.Allocate(key, data_size);
+  memcpy(data.val_ptr(), DATA_TO_CACHE, data_size);
+  BlockCacheHandle inserted_handle;
+  cache.Insert(&data, &inserted_handle);
+
+  BlockCacheHandle retrieved_handle;
+  ASSERT_TRUE(cache.Lookup(key, Cache::EXPECT_IN_CACHE, &retrieved_handle));
+  ASSERT_EQ(0, memcmp(retrieved_handle.data().data(), DATA_TO_CACHE, data_size));
+}
+
 
 } // namespace cfile
 } // namespace kudu
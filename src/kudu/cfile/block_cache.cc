@@ -19,9 +19,12 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -31,11 +34,16 @@
 #include "kudu/util/block_cache_metrics.h"
 #include "kudu/util/cache.h"
 #include "kudu/util/cache_metrics.h"
+#include "kudu/util/env.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
+#include "kudu/util/metrics.h"
 #include "kudu/util/process_memory.h"
 #include "kudu/util/slice.h"
+#include "kudu/util/status.h"
 #include "kudu/util/string_case.h"
+#include "kudu/util/tiered_cache.h"
 
 DEFINE_int64(block_cache_capacity_mb, 512, "block cache capacity in MB");
 TAG_FLAG(block_cache_capacity_mb, stable);
@@ -57,8 +65,65 @@ DEFINE_string(block_cache_type, "DRAM",
               "libmemkind 1.8.0 or newer must be available on the system; "
               "otherwise Kudu will crash.");
 
+DEFINE_string(block_cache_eviction_policy, "LRU",
+              "Which eviction policy to use for the block cache. Valid choices "
+              "are 'LRU', 'SLRU' or 'CLOCK'. LRU, the default, evicts the least "
+              "recently used blocks. SLRU (segmented LRU) protects blocks which "
+              "have been read more than once from being evicted by blocks which "
+              "have been read only once, so large scans which populate the cache "
+              "don't flush out the frequently accessed blocks. CLOCK approximates "
+              "LRU, but lets concurrent cache lookups proceed without excluding "
+              "each other. SLRU and CLOCK are only supported with the DRAM block "
+              "cache.");
+TAG_FLAG(block_cache_eviction_policy, advanced);
+TAG_FLAG(block_cache_eviction_policy, experimental);
+
+DEFINE_double(block_cache_index_capacity_ratio, 0,
+              "The fraction of the block cache capacity reserved for index and "
+              "bloom filter blocks. These blocks are then cached separately from "
+              "data blocks, so that reading many data blocks (e.g., by large "
+              "scans) doesn't evict them. Their hits and misses are reported by "
+              "the block_cache_index_* metrics. If 0, all blocks share the cache.");
+TAG_FLAG(block_cache_index_capacity_ratio, advanced);
+TAG_FLAG(block_cache_index_capacity_ratio, experimental);
+
+DEFINE_int64(block_cache_nvm_tier_capacity_mb, 0,
+             "If positive, the DRAM block cache is backed by a second, NVM tier "
+             "of this capacity: data blocks evicted from DRAM are moved to the "
+             "NVM tier rather than dropped, and blocks found there are moved "
+             "back to DRAM in the background. The NVM tier is stored under "
+             "--nvm_cache_path, which may also be on a fast local SSD. Lookups "
+             "served by the NVM tier count as block cache misses.");
+TAG_FLAG(block_cache_nvm_tier_capacity_mb, advanced);
+TAG_FLAG(block_cache_nvm_tier_capacity_mb, experimental);
+
+DEFINE_double(block_cache_compressed_capacity_ratio, 0,
+              "The fraction of the block cache capacity reserved for data blocks "
+              "of compressed CFiles, cached as they're stored on disk. Blocks "
+              "read from disk are cached in this partition, and only the blocks "
+              "read again while cached here are decompressed into the rest of "
+              "the cache, so compressed data takes less room in the cache. "
+              "Which codecs are worth it is set by "
+              "--cfile_cache_compressed_min_decompression_mbps. Hits and misses "
+              "are reported by the block_cache_compressed_* metrics. If 0, "
+              "blocks are only cached decompressed.");
+TAG_FLAG(block_cache_compressed_capacity_ratio, advanced);
+TAG_FLAG(block_cache_compressed_capacity_ratio, experimental);
+
+static bool ValidateBlockCachePartitionRatio(const char* flagname, double value) {
+  if (value < 0 || value >= 1) {
+    LOG(ERROR) << Substitute("$0 must be at least 0 and less than 1 (got $1)",
+                             flagname, value);
+    return false;
+  }
+  return true;
+}
+
 using strings::Substitute;
 
+DEFINE_validator(block_cache_index_capacity_ratio, &ValidateBlockCachePartitionRatio);
+DEFINE_validator(block_cache_compressed_capacity_ratio, &ValidateBlockCachePartitionRatio);
+
 template <class T> class scoped_refptr;
 
 namespace kudu {
@@ -69,15 +134,25 @@ namespace cfile {
 
 namespace {
 
-Cache* CreateCache(int64_t capacity) {
+Cache* CreateCache(int64_t capacity, const std::string& id) {
   const auto mem_type = BlockCache::GetConfiguredCacheMemoryTypeOrDie();
+  const auto eviction_policy = BlockCache::GetConfiguredEvictionPolicyOrDie();
   switch (mem_type) {
     case Cache::MemoryType::DRAM:
-      return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::DRAM>(
-          capacity, "block_cache");
+      switch (eviction_policy) {
+        case Cache::EvictionPolicy::SLRU:
+          return NewCache<Cache::EvictionPolicy::SLRU, Cache::MemoryType::DRAM>(
+              capacity, id);
+        case Cache::EvictionPolicy::CLOCK:
+          return NewCache<Cache::EvictionPolicy::CLOCK, Cache::MemoryType::DRAM>(
+              capacity, id);
+        default:
+          return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::DRAM>(
+              capacity, id);
+      }
     case Cache::MemoryType::NVM:
       return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::NVM>(
-          capacity, "block_cache");
+          capacity, id);
     default:
       LOG(FATAL) << "unsupported LRU cache memory type: " << mem_type;
       return nullptr;
@@ -118,6 +193,21 @@ bool ValidateBlockCacheCapacity() {
 
 GROUP_FLAG_VALIDATOR(block_cache_capacity_mb, ValidateBlockCacheCapacity);
 
+bool ValidateBlockCachePartitionRatios() {
+  if (FLAGS_block_cache_index_capacity_ratio +
+      FLAGS_block_cache_compressed_capacity_ratio >= 1) {
+    LOG(ERROR) << Substitute("--block_cache_index_capacity_ratio ($0) and "
+                             "--block_cache_compressed_capacity_ratio ($1) must "
+                             "add up to less than 1",
+                             FLAGS_block_cache_index_capacity_ratio,
+                             FLAGS_block_cache_compressed_capacity_ratio);
+    return false;
+  }
+  return true;
+}
+
+GROUP_FLAG_VALIDATOR(block_cache_partition_ratios, ValidateBlockCachePartitionRatios);
+
 Cache::MemoryType BlockCache::GetConfiguredCacheMemoryTypeOrDie() {
     ToUpperCase(FLAGS_block_cache_type, &FLAGS_block_cache_type);
   if (FLAGS_block_cache_type == "NVM") {
@@ -132,22 +222,63 @@ Cache::MemoryType BlockCache::GetConfiguredCacheMemoryTypeOrDie() {
   __builtin_unreachable();
 }
 
+Cache::EvictionPolicy BlockCache::GetConfiguredEvictionPolicyOrDie() {
+  ToUpperCase(FLAGS_block_cache_eviction_policy, &FLAGS_block_cache_eviction_policy);
+  if (FLAGS_block_cache_eviction_policy == "LRU") {
+    return Cache::EvictionPolicy::LRU;
+  }
+  Cache::EvictionPolicy policy;
+  if (FLAGS_block_cache_eviction_policy == "SLRU") {
+    policy = Cache::EvictionPolicy::SLRU;
+  } else if (FLAGS_block_cache_eviction_policy == "CLOCK") {
+    policy = Cache::EvictionPolicy::CLOCK;
+  } else {
+    LOG(FATAL) << "Unknown block cache eviction policy: '"
+               << FLAGS_block_cache_eviction_policy
+               << "' (expected 'LRU', 'SLRU' or 'CLOCK')";
+    __builtin_unreachable();
+  }
+  if (GetConfiguredCacheMemoryTypeOrDie() != Cache::MemoryType::DRAM) {
+    LOG(FATAL) << "The " << FLAGS_block_cache_eviction_policy << " block cache "
+               << "eviction policy is only supported with the DRAM block cache";
+  }
+  return policy;
+}
+
 BlockCache::BlockCache()
     : BlockCache(FLAGS_block_cache_capacity_mb * 1024 * 1024) {
 }
 
-BlockCache::BlockCache(size_t capacity)
-    : cache_(CreateCache(capacity)) {
+BlockCache::BlockCache(size_t capacity) {
+  const size_t index_capacity = capacity * FLAGS_block_cache_index_capacity_ratio;
+  const size_t compressed_capacity = capacity * FLAGS_block_cache_compressed_capacity_ratio;
+  cache_.reset(CreateCache(capacity - index_capacity - compressed_capacity, "block_cache"));
+  if (FLAGS_block_cache_nvm_tier_capacity_mb > 0) {
+    if (GetConfiguredCacheMemoryTypeOrDie() != Cache::MemoryType::DRAM) {
+      LOG(FATAL) << "--block_cache_nvm_tier_capacity_mb requires the DRAM block cache";
+    }
+    std::unique_ptr<Cache> nvm_tier(NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::NVM>(
+        FLAGS_block_cache_nvm_tier_capacity_mb * 1024 * 1024, "block_cache_nvm_tier"));
+    cache_.reset(new TieredCache(std::move(cache_), std::move(nvm_tier)));
+    cache_is_tiered_ = true;
+  }
+  if (index_capacity > 0) {
+    index_cache_.reset(CreateCache(index_capacity, "index_block_cache"));
+  }
+  if (compressed_capacity > 0) {
+    compressed_cache_.reset(CreateCache(compressed_capacity, "compressed_block_cache"));
+  }
 }
 
-BlockCache::PendingEntry BlockCache::Allocate(const CacheKey& key, size_t block_size) {
+BlockCache::PendingEntry BlockCache::Allocate(const CacheKey& key, size_t block_size,
+                                              BlockType block_type) {
   Slice key_slice(reinterpret_cast<const uint8_t*>(&key), sizeof(key));
-  return PendingEntry(cache_->Allocate(key_slice, block_size));
+  return PendingEntry(cache_for(block_type)->Allocate(key_slice, block_size));
 }
 
 bool BlockCache::Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
-                        BlockCacheHandle* handle) {
-  auto h(cache_->Lookup(
+                        BlockCacheHandle* handle, BlockType block_type) {
+  auto h(cache_for(block_type)->Lookup(
       Slice(reinterpret_cast<const uint8_t*>(&key), sizeof(key)), behavior));
   if (h) {
     handle->SetHandle(std::move(h));
@@ -156,16 +287,106 @@ bool BlockCache::Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
   return false;
 }
 
-void BlockCache::Insert(BlockCache::PendingEntry* entry, BlockCacheHandle* inserted) {
-  auto h(cache_->Insert(std::move(entry->handle_),
-                        /* eviction_callback= */ nullptr));
+void BlockCache::Insert(BlockCache::PendingEntry* entry, BlockCacheHandle* inserted,
+                        BlockCacheAttribution* attribution) {
+  Cache* cache = entry->handle_.get_deleter().cache();
+  DCHECK(cache == cache_.get() || cache == index_cache_.get() ||
+         cache == compressed_cache_.get());
+  if (cache_is_tiered_ && cache == cache_.get()) {
+    attribution = nullptr;
+  }
+  if (attribution) {
+    // Released once the entry is evicted.
+    attribution->AddRef();
+  }
+  auto h(cache->Insert(std::move(entry->handle_), attribution));
   inserted->SetHandle(std::move(h));
+  if (attribution) {
+    attribution->RecordInsert(inserted->data().size());
+  }
+}
+
+BlockCacheAttribution::BlockCacheAttribution(scoped_refptr<Counter> hits,
+                                             scoped_refptr<Counter> misses,
+                                             scoped_refptr<AtomicGauge<int64_t>> usage)
+    : hits_(std::move(hits)),
+      misses_(std::move(misses)),
+      usage_(std::move(usage)) {
+}
+
+BlockCacheAttribution::~BlockCacheAttribution() = default;
+
+void BlockCacheAttribution::RecordHit() {
+  hits_->Increment();
+}
+
+void BlockCacheAttribution::RecordMiss() {
+  misses_->Increment();
+}
+
+void BlockCacheAttribution::RecordInsert(size_t size) {
+  usage_->IncrementBy(size);
+}
+
+void BlockCacheAttribution::EvictedEntry(Slice /* key */, Slice value) {
+  usage_->DecrementBy(value.size());
+  // Drop the reference of the entry, taken when it was inserted.
+  Release();
+}
+
+Status BlockCache::SaveManifest(Env* env, const std::string& path) {
+  faststring manifest;
+  const Cache::InvalidationControl ctl(
+      [&manifest](Slice key, Slice /* value */) {
+        DCHECK_EQ(sizeof(CacheKey), key.size());
+        manifest.append(key.data(), key.size());
+        // Keep the entry.
+        return true;
+      });
+  for (Cache* cache : { cache_.get(), index_cache_.get(), compressed_cache_.get() }) {
+    if (cache) {
+      cache->Invalidate(ctl);
+    }
+  }
+  const std::string tmp_path = path + ".tmp";
+  RETURN_NOT_OK_PREPEND(WriteStringToFileSync(env, manifest, tmp_path),
+                        "unable to write block cache manifest");
+  return env->RenameFile(tmp_path, path);
+}
+
+Status BlockCache::LoadManifest(Env* env, const std::string& path,
+                                std::vector<CacheKey>* keys) {
+  faststring manifest;
+  RETURN_NOT_OK(ReadFileToString(env, path, &manifest));
+  if (PREDICT_FALSE(manifest.size() % sizeof(CacheKey) != 0)) {
+    return Status::Corruption(Substitute("block cache manifest $0 has bad size $1",
+                                         path, manifest.size()));
+  }
+  const size_t num_keys = manifest.size() / sizeof(CacheKey);
+  keys->clear();
+  keys->reserve(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    CacheKey key(BlockId(0), 0);
+    memcpy(&key, manifest.data() + i * sizeof(CacheKey), sizeof(CacheKey));
+    keys->push_back(key);
+  }
+  return Status::OK();
 }
 
 void BlockCache::StartInstrumentation(const scoped_refptr<MetricEntity>& metric_entity,
                                       Cache::ExistingMetricsPolicy metrics_policy) {
   std::unique_ptr<BlockCacheMetrics> metrics(new BlockCacheMetrics(metric_entity));
   cache_->SetMetrics(std::move(metrics), metrics_policy);
+  if (index_cache_) {
+    std::unique_ptr<IndexBlockCacheMetrics> index_metrics(
+        new IndexBlockCacheMetrics(metric_entity));
+    index_cache_->SetMetrics(std::move(index_metrics), metrics_policy);
+  }
+  if (compressed_cache_) {
+    std::unique_ptr<CompressedBlockCacheMetrics> compressed_metrics(
+        new CompressedBlockCacheMetrics(metric_entity));
+    compressed_cache_->SetMetrics(std::move(compressed_metrics), metrics_policy);
+  }
 }
 
 } // namespace cfile
@@ -19,33 +19,70 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "kudu/fs/block_id.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/singleton.h"
 #include "kudu/util/cache.h"
 #include "kudu/util/slice.h"
 
-template <class T> class scoped_refptr;
-
 namespace kudu {
 
+class Counter;
+class Env;
 class MetricEntity;
+template<typename T>
+class AtomicGauge;
 
 namespace cfile {
 
+class BlockCacheAttribution;
 class BlockCacheHandle;
 
 // Wrapper around kudu::Cache specifically for caching blocks of CFiles.
 // Provides a singleton and LRU cache for CFile blocks.
+//
+// Index blocks may be kept in a partition of their own, with a share of the
+// capacity set by --block_cache_index_capacity_ratio, so that scans reading
+// lots of data blocks can't evict them.
+//
+// Similarly, --block_cache_compressed_capacity_ratio sets aside a partition
+// for data blocks of compressed CFiles kept as they're stored on disk. The
+// data partition then only holds the decompressed copies of the blocks which
+// were read again while in the compressed partition.
 class BlockCache {
  public:
+  // The types of blocks which are cached in separate partitions when the
+  // index partition is enabled.
+  enum class BlockType {
+    // Column data blocks, including delta and dictionary blocks.
+    DATA,
+
+    // B-tree index blocks, bloom filter blocks and the other per-file
+    // blocks used to avoid reading data blocks. These are small and read
+    // on every point lookup, so they're worth more per byte than data
+    // blocks.
+    INDEX,
+
+    // Data blocks of compressed CFiles, as read from disk. Blocks of this
+    // type are only cached if the compressed partition is enabled.
+    COMPRESSED,
+  };
+
   // Parse the gflag which configures the block cache. FATALs if the flag is
   // invalid.
   static Cache::MemoryType GetConfiguredCacheMemoryTypeOrDie();
 
+  // Parse the gflag which configures the block cache's eviction policy.
+  // FATALs if the flag is invalid, or if the policy isn't supported by the
+  // configured type of block cache.
+  static Cache::EvictionPolicy GetConfiguredEvictionPolicyOrDie();
+
   // BlockId refers to the unique identifier for a Kudu block, that is, for an
   // entire CFile. This is different than the block cache's notion of a block,
   // which is just a portion of a CFile.
@@ -127,7 +164,7 @@ class BlockCache {
   //
   // Returns true to indicate that the entry was found, false otherwise.
   bool Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
-              BlockCacheHandle* handle);
+              BlockCacheHandle* handle, BlockType block_type = BlockType::DATA);
 
   // Pass a metric entity to the cache to start recording metrics.
   // This should be called before the block cache starts serving blocks.
@@ -156,11 +193,30 @@ class BlockCache {
   //   cache->Insert(&entry, &bch);
 
   // Allocate a new entry to be inserted into the cache.
-  PendingEntry Allocate(const CacheKey& key, size_t block_size);
+  PendingEntry Allocate(const CacheKey& key, size_t block_size,
+                        BlockType block_type = BlockType::DATA);
 
-  // Insert the given block into the cache. 'inserted' is set to refer to the
-  // entry in the cache.
-  void Insert(PendingEntry* entry, BlockCacheHandle* inserted);
+  // Insert the given block into the cache, in the partition it was allocated
+  // from. 'inserted' is set to refer to the entry in the cache.
+  //
+  // If 'attribution' isn't null, the block is attributed to it for as long
+  // as it's cached.
+  void Insert(PendingEntry* entry, BlockCacheHandle* inserted,
+              BlockCacheAttribution* attribution = nullptr);
+
+  // Writes the keys of the cached blocks, in all partitions, into the file at
+  // 'path', replacing it atomically. The blocks can then be read back into
+  // the cache after a restart, from the keys returned by LoadManifest().
+  Status SaveManifest(Env* env, const std::string& path);
+
+  // Reads the keys saved into the file at 'path' by SaveManifest().
+  static Status LoadManifest(Env* env, const std::string& path,
+                             std::vector<CacheKey>* keys);
+
+  // Returns true if the block cache has a partition for compressed blocks.
+  bool caches_compressed_blocks() const {
+    return compressed_cache_ != nullptr;
+  }
 
  private:
   friend class Singleton<BlockCache>;
@@ -168,7 +224,67 @@ class BlockCache {
 
   DISALLOW_COPY_AND_ASSIGN(BlockCache);
 
+  // Returns the partition caching blocks of the given type.
+  Cache* cache_for(BlockType block_type) const {
+    switch (block_type) {
+      case BlockType::INDEX:
+        return index_cache_ ? index_cache_.get() : cache_.get();
+      case BlockType::COMPRESSED:
+        DCHECK(compressed_cache_);
+        return compressed_cache_.get();
+      default:
+        return cache_.get();
+    }
+  }
+
   std::unique_ptr<Cache> cache_;
+
+  // The partition for index blocks, or nullptr if they share 'cache_' with
+  // the data blocks.
+  std::unique_ptr<Cache> index_cache_;
+
+  // The partition for compressed blocks, or nullptr if compressed blocks
+  // aren't cached.
+  std::unique_ptr<Cache> compressed_cache_;
+
+  // Whether 'cache_' is tiered, in which case its entries can't have eviction
+  // callbacks, and so can't be attributed.
+  bool cache_is_tiered_ = false;
+};
+
+// Attributes the use of the block cache to a set of CFiles, e.g. those of a
+// tablet: counts the lookups of their blocks which hit or missed the cache,
+// and the bytes of their blocks held by the cache.
+//
+// Each cached block holds a reference to the attribution of its file until
+// it's evicted, so the attribution may outlive the files.
+class BlockCacheAttribution : public Cache::EvictionCallback,
+                              public RefCountedThreadSafe<BlockCacheAttribution> {
+ public:
+  BlockCacheAttribution(scoped_refptr<Counter> hits,
+                        scoped_refptr<Counter> misses,
+                        scoped_refptr<AtomicGauge<int64_t>> usage);
+
+  void RecordHit();
+  void RecordMiss();
+
+  // Cache::EvictionCallback implementation.
+  void EvictedEntry(Slice key, Slice value) override;
+
+ private:
+  friend class BlockCache;
+  friend class RefCountedThreadSafe<BlockCacheAttribution>;
+
+  ~BlockCacheAttribution() override;
+
+  // Records the insertion of a block of 'size' bytes into the cache.
+  void RecordInsert(size_t size);
+
+  const scoped_refptr<Counter> hits_;
+  const scoped_refptr<Counter> misses_;
+  const scoped_refptr<AtomicGauge<int64_t>> usage_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockCacheAttribution);
 };
 
 // Scoped reference to a block from the block cache.
@@ -49,6 +49,7 @@ DEFINE_double(min_compression_ratio, 0.9,
               "extra space if the codec encounters portions of data that are "
               "not easily compressible.");
 TAG_FLAG(min_compression_ratio, experimental);
+TAG_FLAG(min_compression_ratio, runtime);
 
 namespace kudu {
 namespace cfile {
@@ -179,13 +180,11 @@ Status CompressedBlockDecoder::UncompressIntoBuffer(uint8_t* dst) {
 
   Slice compressed = data_;
   compressed.remove_prefix(header_length());
-  if (uncompressed_size_ == compressed.size() && cfile_version_ > 1) {
-    // TODO(perf): we could potentially avoid this memcpy and instead
-    // just use the data in place. However, it's a bit tricky, since the
-    // block cache expects that the stored pointer for the block is at
-    // the beginning of block data, not the compression header. Copying
-    // is simple to implement and at least several times faster than
-    // executing a codec, so this optimization is still worthwhile.
+  if (stored_uncompressed()) {
+    // The block cache expects that the stored pointer for the block is at
+    // the beginning of block data, not the compression header, so blocks
+    // destined for the cache are still copied. Readers which don't cache
+    // the block use it in place instead: see CFileReader::ReadBlock().
     memcpy(dst, compressed.data(), uncompressed_size_);
   } else {
     RETURN_NOT_OK(codec_->Uncompress(compressed, dst, uncompressed_size_));
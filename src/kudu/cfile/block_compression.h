@@ -108,6 +108,23 @@ class CompressedBlockDecoder {
     return uncompressed_size_;
   }
 
+  // Returns true if the writer stored the block as-is because the codec
+  // couldn't compress it well enough (see FLAGS_min_compression_ratio).
+  // The data of such a block can be used in place, without running the
+  // codec or copying it.
+  //
+  // REQUIRES: Init() has been called and returned successfully.
+  bool stored_uncompressed() const {
+    DCHECK_GE(uncompressed_size_, 0) << "must Init()";
+    return cfile_version_ > 1 &&
+        uncompressed_size_ == data_.size() - header_length();
+  }
+
+  // Returns the offset of the block's data past the compression header.
+  size_t header_length() const {
+    return cfile_version_ == 1 ? kHeaderLengthV1 : kHeaderLengthV2;
+  }
+
   // Uncompress into the provided 'dst' buffer, which must be at least as
   // large as the 'uncompressed_size()'.
   //
@@ -120,10 +137,6 @@ class CompressedBlockDecoder {
   static constexpr size_t kHeaderLengthV1 = 8;
   static constexpr size_t kHeaderLengthV2 = 4;
 
-  size_t header_length() const {
-    return cfile_version_ == 1 ? kHeaderLengthV1 : kHeaderLengthV2;
-  }
-
   const CompressionCodec* const codec_;
   const int cfile_version_;
   const Slice data_;
@@ -28,6 +28,9 @@
 #include "kudu/gutil/ref_counted.h"
 
 namespace kudu {
+
+class MappedFileRange;
+
 namespace cfile {
 
 // When blocks are read, they are sometimes resident in the block cache, and sometimes skip the
@@ -50,6 +53,13 @@ class BlockHandle final : public RefCountedThreadSafe<BlockHandle> {
     return { new BlockHandle(std::move(handle)) };
   }
 
+  // Refers to 'data' within the file mapping 'range', which the handle keeps
+  // mapped.
+  static scoped_refptr<BlockHandle> WithMappedData(const Slice& data,
+                                                   std::shared_ptr<const MappedFileRange> range) {
+    return { new BlockHandle(data, std::move(range)) };
+  }
+
   Slice data() const { return data_; }
 
   scoped_refptr<BlockHandle> SubrangeBlock(size_t offset, size_t len) {
@@ -79,6 +89,11 @@ class BlockHandle final : public RefCountedThreadSafe<BlockHandle> {
         ref_(std::move(dblk_data)) {
   }
 
+  BlockHandle(Slice data, std::shared_ptr<const MappedFileRange> range)
+      : data_(data),
+        ref_(std::move(range)) {
+  }
+
   BlockHandle(scoped_refptr<BlockHandle> other, size_t offset, size_t len)
       : data_(other->data()),
         ref_(std::move(other)) {
@@ -95,7 +110,8 @@ class BlockHandle final : public RefCountedThreadSafe<BlockHandle> {
   }
 
   Slice data_;
-  boost::variant<Uninitialized, OwnedData, BlockCacheHandle, scoped_refptr<BlockHandle>> ref_;
+  boost::variant<Uninitialized, OwnedData, BlockCacheHandle, scoped_refptr<BlockHandle>,
+                 std::shared_ptr<const MappedFileRange>> ref_;
 
   DISALLOW_COPY_AND_ASSIGN(BlockHandle);
 };
@@ -26,6 +26,7 @@
 #include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 
+#include "kudu/cfile/block_cache.h"
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/block_pointer.h"
 #include "kudu/cfile/cfile.pb.h"
@@ -325,7 +326,8 @@ Status BloomFileReader::CheckKeyPresent(const BloomKeyProbe &probe,
   if (bblk_ptr != bci->cur_block_pointer) {
     scoped_refptr<BlockHandle> dblk_data;
     RETURN_NOT_OK(reader_->ReadBlock(io_context, bblk_ptr,
-                                     CFileReader::CACHE_BLOCK, &dblk_data));
+                                     CFileReader::CACHE_BLOCK, &dblk_data,
+                                     BlockCache::BlockType::INDEX));
 
     // Parse the header in the block.
     BloomBlockHeaderPB hdr;
@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <cstring>
 #include <cstdint>
+#include <memory>
 #include <ostream>
 #include <vector>
 
@@ -37,8 +38,11 @@
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/block_encodings.h"
 #include "kudu/cfile/cfile_util.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/rowid.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
@@ -334,6 +338,65 @@ class BShufBlockDecoder final : public BlockDecoder {
     return CopyNextValuesToArray(n, dst->data());
   }
 
+  // Evaluate the predicate on the unshuffled values before copying them out.
+  // The values are evaluated as a whole batch so that the vectorized
+  // ColumnPredicate kernels apply, and they are only materialized into 'dst'
+  // if at least one of the rows survives.
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override {
+    DCHECK(parsed_);
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+
+    ctx->SetDecoderEvalSupported();
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    // The unshuffled values can be evaluated in place unless they were stored
+    // with a narrower width and must first be expanded to the full type.
+    const bool eval_in_place = size_of_elem_ == size_of_type;
+    size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    uint8_t* cells;
+    if (eval_in_place) {
+      cells = &decoded_[cur_idx_ * size_of_type];
+    } else {
+      RETURN_NOT_OK(CopyNextValuesToArray(&max_fetch, dst->data()));
+      cells = dst->data();
+    }
+
+    if (!eval_sel_) {
+      eval_sel_.reset(new SelectionVector(num_elems_));
+    }
+    eval_sel_->Resize(max_fetch);
+    eval_sel_->SetAllTrue();
+    ColumnBlock block(dst->type_info(), nullptr, cells, max_fetch, nullptr);
+    ctx->pred()->Evaluate(block, eval_sel_.get());
+
+    bool any_selected = false;
+    for (size_t i = 0; i < max_fetch; i++) {
+      if (!sel->TestBit(i)) {
+        continue;
+      }
+      if (eval_sel_->IsRowSelected(i)) {
+        any_selected = true;
+      } else {
+        sel->ClearBit(i);
+      }
+    }
+
+    if (eval_in_place) {
+      if (any_selected) {
+        memcpy(dst->data(), cells, max_fetch * size_of_type);
+      }
+      cur_idx_ += max_fetch;
+    }
+    *n = max_fetch;
+    return Status::OK();
+  }
+
   // Copy the codewords to a temporary buffer.
   // This API provides a more convenient way for the dictionary decoder to copy out
   // integer codewords and then look up the strings. If we use the CopyNextValuesToArray()
@@ -419,6 +482,9 @@ class BShufBlockDecoder final : public BlockDecoder {
 
   size_t cur_idx_;
   faststring decoded_;
+
+  // Scratch space for CopyNextAndEval(), allocated on first use.
+  std::unique_ptr<SelectionVector> eval_sel_;
 };
 
 template<>
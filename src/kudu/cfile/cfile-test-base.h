@@ -354,7 +354,10 @@ class CFileTestBase : public KuduTest {
   enum Flags {
     NO_FLAGS = 0,
     WRITE_VALIDX = 1,
-    SMALL_BLOCKSIZE = 1 << 1
+    SMALL_BLOCKSIZE = 1 << 1,
+    WRITE_ZONE_MAP = 1 << 2,
+    WRITE_BLOOM_FILTER = 1 << 3,
+    WRITE_SECONDARY_INDEX = 1 << 4
   };
 
   template<class DataGeneratorType>
@@ -373,6 +376,15 @@ class CFileTestBase : public KuduTest {
     if (flags & WRITE_VALIDX) {
       opts.write_validx = true;
     }
+    if (flags & WRITE_ZONE_MAP) {
+      opts.write_zone_map = true;
+    }
+    if (flags & WRITE_BLOOM_FILTER) {
+      opts.write_bloom_filter = true;
+    }
+    if (flags & WRITE_SECONDARY_INDEX) {
+      opts.write_secondary_index = true;
+    }
     if (flags & SMALL_BLOCKSIZE) {
       // Use a smaller block size to exercise multi-level indexing.
       opts.storage_attributes.cfile_block_size = 1024;
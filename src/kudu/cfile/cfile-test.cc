@@ -16,6 +16,7 @@
 // under the License.
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -40,9 +41,11 @@
 #include "kudu/cfile/cfile_reader.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h"
+#include "kudu/cfile/column_bloom_filter.h"
 #include "kudu/cfile/index_btree.h"
 #include "kudu/cfile/type_encodings.h"
 #include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock-test-util.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
@@ -66,6 +69,7 @@
 #include "kudu/util/cache.h"
 #include "kudu/util/compression/compression.pb.h"
 #include "kudu/util/env.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/int128.h"
 #include "kudu/util/int128_util.h"
 #include "kudu/util/mem_tracker.h"
@@ -81,8 +85,12 @@ namespace kudu {
 class Arena;
 }  // namespace kudu
 
+DECLARE_bool(cfile_map_uncompressed_files);
 DECLARE_bool(cfile_write_checksums);
+DECLARE_bool(cfile_use_zone_maps);
 DECLARE_bool(cfile_verify_checksums);
+DECLARE_int32(cfile_prefetch_max_blocks);
+DECLARE_int32(cfile_prefetch_stall_threshold_us);
 DECLARE_string(block_cache_type);
 DECLARE_bool(force_block_cache_capacity);
 DECLARE_int64(block_cache_capacity_mb);
@@ -110,6 +118,65 @@ namespace cfile {
 
 class TestCFile : public CFileTestBase {
  protected:
+  // Materializes a batch starting in the middle of a block in which only a
+  // few rows are selected, so that only their values are decoded.
+  template <class DataGeneratorType>
+  void TestSparseScan(EncodingType encoding) {
+    BlockId block_id;
+    DataGeneratorType generator;
+    WriteTestFile(&generator, encoding, NO_COMPRESSION, 10000, SMALL_BLOCKSIZE, &block_id);
+
+    unique_ptr<ReadableBlock> block;
+    ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+    unique_ptr<CFileReader> reader;
+    ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+
+    const size_t kStart = 1234;
+    const size_t kBatch = 5000;
+    ASSERT_OK(iter->SeekToOrdinal(kStart));
+    ScopedColumnBlock<DataGeneratorType::kDataType> out(kBatch);
+    SelectionVector sel(kBatch);
+    sel.SetAllFalse();
+    for (size_t i = 0; i < kBatch; i += 97) {
+      sel.SetRowSelected(i);
+      if (i + 1 < kBatch) {
+        sel.SetRowSelected(i + 1);
+      }
+    }
+    ColumnMaterializationContext ctx = CreateNonDecoderEvalContext(&out, &sel);
+    ctx.SetSelectedRowsOnly();
+    size_t n = kBatch;
+    ASSERT_OK(iter->CopyNextValues(&n, &ctx));
+    ASSERT_EQ(kBatch, n);
+
+    DataGeneratorType expected;
+    for (size_t i = 0; i < kBatch; i++) {
+      if (!sel.IsRowSelected(i)) {
+        continue;
+      }
+      const size_t ord = kStart + i;
+      if (DataGeneratorType::has_nulls()) {
+        ASSERT_EQ(expected.TestValueShouldBeNull(ord), out.is_null(i)) << ord;
+        if (out.is_null(i)) {
+          continue;
+        }
+      }
+      ASSERT_EQ(expected.BuildTestValue(0, ord), out[i]) << ord;
+    }
+
+    // The next batch is read from where the sparse one ended.
+    n = 10;
+    sel.SetAllTrue();
+    ColumnMaterializationContext next_ctx = CreateNonDecoderEvalContext(&out, &sel);
+    ASSERT_OK(iter->CopyNextValues(&n, &next_ctx));
+    ASSERT_EQ(10, n);
+    if (!DataGeneratorType::has_nulls()) {
+      ASSERT_EQ(expected.BuildTestValue(0, kStart + kBatch), out[0]);
+    }
+  }
+
   template <class DataGeneratorType>
   void TestReadWriteFixedSizeTypes(EncodingType encoding) {
     BlockId block_id;
@@ -540,32 +607,102 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestWrite1MLowCardinalityStringsDictEncodi
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestReadWriteUInt32) {
   RETURN_IF_NO_NVM_CACHE(GetParam());
-  for (auto enc : { PLAIN_ENCODING, RLE }) {
+  for (auto enc : { PLAIN_ENCODING, RLE, DICT_ENCODING }) {
     TestReadWriteFixedSizeTypes<UInt32DataGenerator<false>>(enc);
   }
 }
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestReadWriteInt32) {
   RETURN_IF_NO_NVM_CACHE(GetParam());
-  for (auto enc : { PLAIN_ENCODING, RLE }) {
+  for (auto enc : { PLAIN_ENCODING, RLE, DICT_ENCODING }) {
     TestReadWriteFixedSizeTypes<Int32DataGenerator<false>>(enc);
   }
 }
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestReadWriteUInt64) {
   RETURN_IF_NO_NVM_CACHE(GetParam());
-  for (auto enc : { PLAIN_ENCODING, RLE, BIT_SHUFFLE }) {
+  for (auto enc : { PLAIN_ENCODING, RLE, BIT_SHUFFLE, DICT_ENCODING }) {
     TestReadWriteFixedSizeTypes<UInt64DataGenerator<false>>(enc);
   }
 }
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestReadWriteInt64) {
   RETURN_IF_NO_NVM_CACHE(GetParam());
-  for (auto enc : { PLAIN_ENCODING, RLE, BIT_SHUFFLE }) {
+  for (auto enc : { PLAIN_ENCODING, RLE, BIT_SHUFFLE, DICT_ENCODING }) {
     TestReadWriteFixedSizeTypes<Int64DataGenerator<false>>(enc);
   }
 }
 
+TEST_P(TestCFileBothCacheMemoryTypes, TestSparseScan) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+  for (auto enc : { PLAIN_ENCODING, BIT_SHUFFLE, RLE, DICT_ENCODING }) {
+    TestSparseScan<UInt32DataGenerator<false>>(enc);
+    TestSparseScan<UInt32DataGenerator<true>>(enc);
+  }
+}
+
+// Reading blocks ahead mustn't change what's read, including after seeking
+// backwards.
+TEST_P(TestCFileBothCacheMemoryTypes, TestReadWithPrefetch) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+  FLAGS_cfile_prefetch_max_blocks = 8;
+  // Every read counts as a stall, so that the scans read as far ahead as
+  // they can.
+  FLAGS_cfile_prefetch_stall_threshold_us = -1;
+  for (auto enc : { PLAIN_ENCODING, BIT_SHUFFLE }) {
+    TestReadWriteFixedSizeTypes<UInt32DataGenerator<false>>(enc);
+  }
+}
+
+// Low-cardinality values, so that a dictionary-encoded file stays in
+// codeword mode.
+class LowCardinalityUInt32DataGenerator : public DataGenerator<UINT32, false> {
+ public:
+  uint32_t BuildTestValue(size_t /*block_index*/, size_t value) override {
+    return value % 7;
+  }
+};
+
+TEST_P(TestCFileBothCacheMemoryTypes, TestIntDictEncodingDecoderEval) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+  constexpr int kNumRows = 10000;
+  BlockId block_id;
+  LowCardinalityUInt32DataGenerator generator;
+  WriteTestFile(&generator, DICT_ENCODING, NO_COMPRESSION, kNumRows, NO_FLAGS, &block_id);
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+  ASSERT_EQ(DICT_ENCODING, reader->footer().encoding());
+  ASSERT_TRUE(reader->footer().has_dict_block_ptr());
+
+  unique_ptr<CFileIterator> iter;
+  ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+  ASSERT_OK(iter->SeekToOrdinal(0));
+
+  uint32_t lower = 2;
+  uint32_t upper = 4;
+  ColumnPredicate pred = ColumnPredicate::Range(ColumnSchema("c", UINT32), &lower, &upper);
+  ScopedColumnBlock<UINT32> out(kNumRows);
+  SelectionVector sel(kNumRows);
+  sel.SetAllTrue();
+  ColumnMaterializationContext ctx(0, &pred, &out, &sel);
+  size_t n = kNumRows;
+  ASSERT_OK(iter->CopyNextValues(&n, &ctx));
+  ASSERT_EQ(kNumRows, n);
+  ASSERT_TRUE(ctx.DecoderEvalNotDisabled());
+
+  for (int i = 0; i < kNumRows; i++) {
+    const uint32_t expected = i % 7;
+    const bool matches = expected >= lower && expected < upper;
+    ASSERT_EQ(matches, sel.IsRowSelected(i)) << i;
+    if (matches) {
+      ASSERT_EQ(expected, out[i]) << i;
+    }
+  }
+}
+
 TEST_P(TestCFileBothCacheMemoryTypes, TestReadWriteInt128) {
   RETURN_IF_NO_NVM_CACHE(GetParam());
   TestReadWriteFixedSizeTypes<Int128DataGenerator<false>>(PLAIN_ENCODING);
@@ -862,6 +999,250 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestDefaultColumnIter) {
   }
 }
 
+TEST_P(TestCFileBothCacheMemoryTypes, TestZoneMapPruning) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+
+  // Values are 10 * ordinal, so each block covers a narrow, distinct range.
+  const int kNumEntries = 10000;
+  BlockId block_id;
+  UInt32DataGenerator<false> generator;
+  WriteTestFile(&generator, PLAIN_ENCODING, NO_COMPRESSION, kNumEntries,
+                SMALL_BLOCKSIZE | WRITE_ZONE_MAP, &block_id);
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+  ASSERT_TRUE(reader->footer().has_zone_map_block_ptr());
+  unique_ptr<CFileIterator> iter;
+  ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+
+  ColumnSchema col("c", UINT32);
+  uint32_t lower = 50000;
+  uint32_t upper = 50100;
+  auto range = ColumnPredicate::Range(col, &lower, &upper);
+  uint32_t missing = 50005;
+  auto equality = ColumnPredicate::Equality(col, &missing);
+
+  bool can_skip;
+  ASSERT_OK(iter->CanSkipRows(range, 0, 1000, &can_skip));
+  ASSERT_TRUE(can_skip);
+  ASSERT_OK(iter->CanSkipRows(range, 9000, 1000, &can_skip));
+  ASSERT_TRUE(can_skip);
+  ASSERT_OK(iter->CanSkipRows(range, 4900, 200, &can_skip));
+  ASSERT_FALSE(can_skip);
+  ASSERT_OK(iter->CanSkipRows(range, 0, kNumEntries, &can_skip));
+  ASSERT_FALSE(can_skip);
+
+  // The zone map only bounds values: a value inside a block's range can't
+  // be ruled out even if it's absent.
+  ASSERT_OK(iter->CanSkipRows(equality, 4990, 20, &can_skip));
+  ASSERT_FALSE(can_skip);
+  ASSERT_OK(iter->CanSkipRows(equality, 0, 100, &can_skip));
+  ASSERT_TRUE(can_skip);
+
+  // IS NOT NULL can't prune a column without nulls.
+  ASSERT_OK(iter->CanSkipRows(ColumnPredicate::IsNotNull(col), 0, kNumEntries, &can_skip));
+  ASSERT_FALSE(can_skip);
+
+  // Pruning can be turned off at runtime.
+  FLAGS_cfile_use_zone_maps = false;
+  ASSERT_OK(iter->CanSkipRows(range, 0, 1000, &can_skip));
+  ASSERT_FALSE(can_skip);
+}
+
+TEST_P(TestCFileBothCacheMemoryTypes, TestNoZoneMapByDefault) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+  BlockId block_id;
+  UInt32DataGenerator<false> generator;
+  WriteTestFile(&generator, PLAIN_ENCODING, NO_COMPRESSION, 1000, NO_FLAGS, &block_id);
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+  ASSERT_FALSE(reader->footer().has_zone_map_block_ptr());
+  unique_ptr<CFileIterator> iter;
+  ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+
+  uint32_t value = 5000;
+  bool can_skip;
+  ASSERT_OK(iter->CanSkipRows(ColumnPredicate::Equality(ColumnSchema("c", UINT32), &value),
+                              0, 1000, &can_skip));
+  ASSERT_FALSE(can_skip);
+}
+
+TEST_P(TestCFileBothCacheMemoryTypes, TestColumnBloomFilterPruning) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+  BlockId block_id;
+  // Writes the values 0, 10, 20, ..., 9990.
+  UInt32DataGenerator<false> generator;
+  WriteTestFile(&generator, PLAIN_ENCODING, NO_COMPRESSION, 1000, WRITE_BLOOM_FILTER, &block_id);
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+  ASSERT_TRUE(reader->footer().has_bloom_filter_block_ptr());
+  ASSERT_FALSE(reader->footer().has_zone_map_block_ptr());
+
+  ColumnSchema col("c", UINT32);
+  int num_skipped = 0;
+  for (uint32_t i = 0; i < 1000; i++) {
+    // Each iterator is only ever checked against one predicate, since the
+    // bloom filter's verdict is cached by predicate.
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    uint32_t present = i * 10;
+    ColumnPredicate present_pred = ColumnPredicate::Equality(col, &present);
+    bool can_skip;
+    ASSERT_OK(iter->CanSkipRows(present_pred, 0, 1000, &can_skip));
+    ASSERT_FALSE(can_skip) << present;
+
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    uint32_t absent = i * 10 + 5;
+    ColumnPredicate absent_pred = ColumnPredicate::Equality(col, &absent);
+    ASSERT_OK(iter->CanSkipRows(absent_pred, 0, 1000, &can_skip));
+    num_skipped += can_skip;
+  }
+  // The filter targets a 1% false positive rate.
+  ASSERT_GT(num_skipped, 900);
+
+  // An IN-list can be ruled out only if none of its values may be present.
+  unique_ptr<CFileIterator> iter;
+  ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+  vector<uint32_t> in_values = { 25, 50 };
+  vector<const void*> in_ptrs = { &in_values[0], &in_values[1] };
+  ColumnPredicate in_pred = ColumnPredicate::InList(col, &in_ptrs);
+  bool can_skip;
+  ASSERT_OK(iter->CanSkipRows(in_pred, 0, 1000, &can_skip));
+  ASSERT_FALSE(can_skip);
+
+  // Range predicates aren't helped by the bloom filter.
+  ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+  uint32_t lower = 20000;
+  ColumnPredicate range_pred = ColumnPredicate::Range(col, &lower, nullptr);
+  ASSERT_OK(iter->CanSkipRows(range_pred, 0, 1000, &can_skip));
+  ASSERT_FALSE(can_skip);
+}
+
+// -0.0 and +0.0 are equal, so a filter built over either must match a
+// predicate on the other.
+template<DataType Type>
+void TestBloomFilterSignedZeros() {
+  typedef typename DataTypeTraits<Type>::cpp_type CppType;
+  const TypeInfo* typeinfo = GetTypeInfo(Type);
+  ColumnSchema col("c", Type);
+  const CppType pos_zero = 0;
+  const CppType neg_zero = -pos_zero;
+  ASSERT_TRUE(std::signbit(neg_zero));
+
+  for (CppType written : { pos_zero, neg_zero }) {
+    ColumnBloomFilterBuilder builder(typeinfo);
+    const CppType values[] = { written, 1.5 };
+    builder.AddValues(values, 2);
+    faststring data;
+    ASSERT_OK(builder.Finish(&data));
+    unique_ptr<ColumnBloomFilter> filter;
+    ASSERT_OK(ColumnBloomFilter::Parse(typeinfo, Slice(data), &filter));
+
+    for (CppType queried : { pos_zero, neg_zero }) {
+      SCOPED_TRACE(Substitute("written $0, queried $1",
+                              std::signbit(written) ? "-0.0" : "+0.0",
+                              std::signbit(queried) ? "-0.0" : "+0.0"));
+      ASSERT_TRUE(filter->MayMatch(ColumnPredicate::Equality(col, &queried)));
+      vector<const void*> in_ptrs = { &queried };
+      ASSERT_TRUE(filter->MayMatch(ColumnPredicate::InList(col, &in_ptrs)));
+    }
+  }
+}
+
+TEST(TestColumnBloomFilter, TestSignedZeros) {
+  NO_FATALS(TestBloomFilterSignedZeros<FLOAT>());
+  NO_FATALS(TestBloomFilterSignedZeros<DOUBLE>());
+}
+
+TEST_P(TestCFileBothCacheMemoryTypes, TestSecondaryIndexPruning) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+  BlockId block_id;
+  // Writes the values 0, 10, 20, ..., 999990, which span several chunks of
+  // the index.
+  UInt32DataGenerator<false> generator;
+  WriteTestFile(&generator, PLAIN_ENCODING, NO_COMPRESSION, 100000, WRITE_SECONDARY_INDEX,
+                &block_id);
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+  ASSERT_TRUE(reader->footer().has_secondary_index_block_ptr());
+  ASSERT_FALSE(reader->footer().has_zone_map_block_ptr());
+
+  // Each iterator is only checked against one predicate, since the lookups
+  // are cached by predicate.
+  ColumnSchema col("c", UINT32);
+  bool can_skip;
+  {
+    // Only the batch holding row 54321 may match.
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    uint32_t value = 543210;
+    ColumnPredicate pred = ColumnPredicate::Equality(col, &value);
+    ASSERT_OK(iter->CanSkipRows(pred, 54000, 1000, &can_skip));
+    ASSERT_FALSE(can_skip);
+    ASSERT_OK(iter->CanSkipRows(pred, 54322, 1000, &can_skip));
+    ASSERT_TRUE(can_skip);
+    ASSERT_OK(iter->CanSkipRows(pred, 0, 54321, &can_skip));
+    ASSERT_TRUE(can_skip);
+  }
+  {
+    // An absent value rules out every batch.
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    uint32_t value = 543215;
+    ColumnPredicate pred = ColumnPredicate::Equality(col, &value);
+    ASSERT_OK(iter->CanSkipRows(pred, 0, 100000, &can_skip));
+    ASSERT_TRUE(can_skip);
+  }
+  {
+    // The values in [1000, 1500) are in rows 100 to 149.
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    uint32_t lower = 1000;
+    uint32_t upper = 1500;
+    ColumnPredicate pred = ColumnPredicate::Range(col, &lower, &upper);
+    ASSERT_OK(iter->CanSkipRows(pred, 0, 100, &can_skip));
+    ASSERT_TRUE(can_skip);
+    ASSERT_OK(iter->CanSkipRows(pred, 149, 10, &can_skip));
+    ASSERT_FALSE(can_skip);
+    ASSERT_OK(iter->CanSkipRows(pred, 150, 1000, &can_skip));
+    ASSERT_TRUE(can_skip);
+  }
+  {
+    // The values of an IN-list are in rows 1 and 3000.
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    vector<uint32_t> in_values = { 10, 15, 30000 };
+    vector<const void*> in_ptrs = { &in_values[0], &in_values[1], &in_values[2] };
+    ColumnPredicate pred = ColumnPredicate::InList(col, &in_ptrs);
+    ASSERT_OK(iter->CanSkipRows(pred, 0, 1000, &can_skip));
+    ASSERT_FALSE(can_skip);
+    ASSERT_OK(iter->CanSkipRows(pred, 2, 2998, &can_skip));
+    ASSERT_TRUE(can_skip);
+    ASSERT_OK(iter->CanSkipRows(pred, 2999, 2, &can_skip));
+    ASSERT_FALSE(can_skip);
+  }
+  {
+    // Wide ranges aren't looked up, since they'd read most of the index.
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    uint32_t lower = 100000;
+    ColumnPredicate pred = ColumnPredicate::Range(col, &lower, nullptr);
+    ASSERT_OK(iter->CanSkipRows(pred, 0, 1000, &can_skip));
+    ASSERT_FALSE(can_skip);
+  }
+}
+
 TEST_P(TestCFileBothCacheMemoryTypes, TestAppendRaw) {
   RETURN_IF_NO_NVM_CACHE(GetParam());
   TestReadWriteRawBlocks(NO_COMPRESSION, 1000);
@@ -918,6 +1299,30 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestDataCorruption) {
   }
 }
 
+TEST_P(TestCFileBothCacheMemoryTypes, TestMappedFiles) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+  FLAGS_cfile_map_uncompressed_files = true;
+  FLAGS_cfile_write_checksums = true;
+  FLAGS_cfile_verify_checksums = true;
+
+  // The blocks of uncompressed files are read from the mapping.
+  TestReadWriteFixedSizeTypes<UInt32DataGenerator<false>>(BIT_SHUFFLE);
+  TestReadWriteStrings(PLAIN_ENCODING);
+  for (auto compression : { NO_COMPRESSION, LZ4 }) {
+    SCOPED_TRACE(CompressionType_Name(compression));
+    TestReadWriteRawBlocks(compression, 1000);
+
+    UInt32DataGenerator<false> generator;
+    BlockId block_id;
+    WriteTestFile(&generator, PLAIN_ENCODING, compression, 1000, NO_FLAGS, &block_id);
+    unique_ptr<ReadableBlock> block;
+    ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+    unique_ptr<CFileReader> reader;
+    ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+    ASSERT_EQ(compression == NO_COMPRESSION, reader->is_mapped());
+  }
+}
+
 TEST_P(TestCFileBothCacheMemoryTypes, TestNullInts) {
   RETURN_IF_NO_NVM_CACHE(GetParam());
 
@@ -928,6 +1333,8 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestNullInts) {
   TestNullTypes(&generator, BIT_SHUFFLE, LZ4);
   TestNullTypes(&generator, RLE, NO_COMPRESSION);
   TestNullTypes(&generator, RLE, LZ4);
+  TestNullTypes(&generator, DICT_ENCODING, NO_COMPRESSION);
+  TestNullTypes(&generator, DICT_ENCODING, LZ4);
 }
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestNullFloats) {
@@ -1126,5 +1533,38 @@ TEST_P(TestCFileDifferentCodecs, TestUncompressible) {
   }
 }
 
+// Blocks which the codec couldn't compress are stored as-is; check that
+// reading them in place (when not caching) yields the same data as copying
+// them into the cache.
+TEST_P(TestCFileDifferentCodecs, TestReadUncompressedBlocksInPlace) {
+  auto codec = GetParam();
+  BlockId block_id;
+  {
+    RandomInt32DataGenerator int_gen;
+    WriteTestFile(&int_gen, PLAIN_ENCODING, codec, 100000, NO_FLAGS, &block_id);
+  }
+
+  unique_ptr<ReadableBlock> source;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &source));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(source), ReaderOptions(), &reader));
+
+  unique_ptr<IndexTreeIterator> iter;
+  iter.reset(IndexTreeIterator::Create(nullptr, reader.get(), reader->posidx_root()));
+  ASSERT_OK(iter->SeekToFirst());
+  int num_blocks = 0;
+  do {
+    scoped_refptr<BlockHandle> in_place;
+    scoped_refptr<BlockHandle> cached;
+    ASSERT_OK(reader->ReadBlock(nullptr, iter->GetCurrentBlockPointer(),
+                                CFileReader::DONT_CACHE_BLOCK, &in_place));
+    ASSERT_OK(reader->ReadBlock(nullptr, iter->GetCurrentBlockPointer(),
+                                CFileReader::CACHE_BLOCK, &cached));
+    ASSERT_EQ(cached->data(), in_place->data());
+    num_blocks++;
+  } while (iter->Next().ok());
+  ASSERT_GT(num_blocks, 1);
+}
+
 } // namespace cfile
 } // namespace kudu
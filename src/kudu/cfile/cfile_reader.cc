@@ -19,8 +19,10 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <ostream>
+#include <unordered_set>
 #include <utility>
 
 #include <gflags/gflags.h>
@@ -34,8 +36,11 @@
 #include "kudu/cfile/cfile.pb.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h" // for kMagicString
+#include "kudu/cfile/column_bloom_filter.h"
+#include "kudu/cfile/column_secondary_index.h"
 #include "kudu/cfile/index_btree.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/cfile/zone_map.h"
 #include "kudu/common/column_materialization_context.h"
 #include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
@@ -47,6 +52,8 @@
 #include "kudu/fs/error_manager.h"
 #include "kudu/fs/io_context.h"
 #include "kudu/gutil/basictypes.h"
+#include "kudu/gutil/dynamic_annotations.h"
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stringprintf.h"
@@ -58,17 +65,20 @@
 #include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/crc.h"
 #include "kudu/util/debug/trace_event.h"
+#include "kudu/util/env.h"
 #include "kudu/util/fault_injection.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/malloc.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/memory/overwrite.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/object_pool.h"
 #include "kudu/util/pb_util.h"
 #include "kudu/util/rle-encoding.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
+#include "kudu/util/threadpool.h"
 #include "kudu/util/trace.h"
 
 DEFINE_bool(cfile_lazy_open, true,
@@ -85,6 +95,89 @@ DEFINE_double(cfile_inject_corruption, 0,
               "with a corruption status");
 TAG_FLAG(cfile_inject_corruption, hidden);
 
+DEFINE_bool(cfile_use_zone_maps, true,
+            "Whether scans use cfile zone maps, when present, to skip rows "
+            "which can't match a predicate.");
+TAG_FLAG(cfile_use_zone_maps, advanced);
+TAG_FLAG(cfile_use_zone_maps, runtime);
+
+DEFINE_bool(cfile_use_column_bloom_filters, true,
+            "Whether scans use cfile column bloom filters, when present, to "
+            "skip files which can't match an equality or IN-list predicate.");
+TAG_FLAG(cfile_use_column_bloom_filters, advanced);
+TAG_FLAG(cfile_use_column_bloom_filters, runtime);
+
+DEFINE_bool(cfile_use_secondary_indexes, true,
+            "Whether scans use cfile secondary indexes, when present, to skip "
+            "rows which can't match a selective predicate.");
+TAG_FLAG(cfile_use_secondary_indexes, advanced);
+TAG_FLAG(cfile_use_secondary_indexes, runtime);
+
+DEFINE_double(cfile_secondary_index_max_selectivity, 0.05,
+              "The maximum fraction of the entries of a cfile's secondary "
+              "index which a lookup may read. Predicates matching more values "
+              "than that are evaluated by scanning the column instead.");
+TAG_FLAG(cfile_secondary_index_max_selectivity, advanced);
+TAG_FLAG(cfile_secondary_index_max_selectivity, runtime);
+
+DEFINE_int32(cfile_cache_compressed_min_decompression_mbps, 1000,
+             "If the block cache has a partition for compressed blocks (see "
+             "--block_cache_compressed_capacity_ratio), the minimum estimated "
+             "decompression speed, in MB per second, of the codecs whose data "
+             "blocks are cached compressed. Blocks of files compressed with "
+             "slower codecs are cached decompressed, as decompressing them on "
+             "every cache hit would cost more than reading them again.");
+TAG_FLAG(cfile_cache_compressed_min_decompression_mbps, advanced);
+TAG_FLAG(cfile_cache_compressed_min_decompression_mbps, runtime);
+
+DEFINE_bool(cfile_map_uncompressed_files, false,
+            "Whether the blocks of uncompressed cfiles are read in place from a "
+            "memory mapping of the files, rather than copied from the files into "
+            "the block cache. Since the page cache already caches their data, this "
+            "saves the copies and the memory of the block cache for these files, "
+            "e.g. on servers with fast local storage and much memory. Each opened "
+            "file is mapped in full, so the maximum number of memory mappings of "
+            "the process (vm.max_map_count on Linux) must account for the number "
+            "of cfiles. Encrypted files are never mapped. Only affects the files "
+            "opened since.");
+TAG_FLAG(cfile_map_uncompressed_files, experimental);
+TAG_FLAG(cfile_map_uncompressed_files, runtime);
+
+DEFINE_double(cfile_sparse_scan_max_selectivity, 0.1,
+              "The maximum fraction of the rows of a batch which may remain "
+              "selected by the predicates of a scan for the other columns of "
+              "the batch to be materialized sparsely, decoding only the runs "
+              "of selected rows and seeking over the others. If 0, columns "
+              "are always decoded in full.");
+TAG_FLAG(cfile_sparse_scan_max_selectivity, advanced);
+TAG_FLAG(cfile_sparse_scan_max_selectivity, runtime);
+
+DEFINE_int32(cfile_prefetch_max_blocks, 0,
+             "The maximum number of data blocks that a cached scan of a "
+             "cfile reads ahead of its position into the block cache, from "
+             "the index block it's currently reading. The number of blocks "
+             "read ahead grows up to this number while scans have to wait "
+             "for reads, and shrinks back when they don't. If 0, scans "
+             "don't read ahead.");
+TAG_FLAG(cfile_prefetch_max_blocks, advanced);
+TAG_FLAG(cfile_prefetch_max_blocks, experimental);
+TAG_FLAG(cfile_prefetch_max_blocks, runtime);
+
+DEFINE_int32(cfile_prefetch_threads, 8,
+             "The maximum number of threads reading cfile data blocks ahead "
+             "of scans. See --cfile_prefetch_max_blocks.");
+TAG_FLAG(cfile_prefetch_threads, advanced);
+TAG_FLAG(cfile_prefetch_threads, experimental);
+
+DEFINE_int32(cfile_prefetch_stall_threshold_us, 500,
+             "The duration, in microseconds, above which a scan reading a "
+             "cfile data block is considered to have waited for the read, "
+             "which makes it read further ahead. See "
+             "--cfile_prefetch_max_blocks.");
+TAG_FLAG(cfile_prefetch_stall_threshold_us, advanced);
+TAG_FLAG(cfile_prefetch_stall_threshold_us, experimental);
+TAG_FLAG(cfile_prefetch_stall_threshold_us, runtime);
+
 using kudu::fault_injection::MaybeTrue;
 using kudu::fs::ErrorHandlerType;
 using kudu::fs::IOContext;
@@ -101,6 +194,7 @@ namespace cfile {
 
 const char* CFILE_CACHE_MISS_BYTES_METRIC_NAME = "cfile_cache_miss_bytes";
 const char* CFILE_CACHE_HIT_BYTES_METRIC_NAME = "cfile_cache_hit_bytes";
+const char* CFILE_DECODE_NANOS_METRIC_NAME = "cfile_decode_nanos";
 
 // Magic+Length: 8-byte magic, followed by 4-byte header size
 static const size_t kMagicAndLengthSize = 12;
@@ -140,6 +234,7 @@ CFileReader::CFileReader(ReaderOptions options,
   file_size_(file_size),
   codec_(nullptr),
   do_verify_checksum_(false),
+  block_cache_attribution_(std::move(options.block_cache_attribution)),
   mem_consumption_(std::move(options.parent_mem_tracker),
                    memory_footprint()) {
 }
@@ -195,6 +290,8 @@ Status CFileReader::InitOnce(const IOContext* io_context) {
                                       footer_->encoding(),
                                       &type_encoding_info_));
 
+  MaybeMapFile();
+
   VLOG(2) << "Initialized CFile reader. "
           << "Header: " << SecureDebugString(*header_)
           << " Footer: " << SecureDebugString(*footer_)
@@ -206,6 +303,24 @@ Status CFileReader::InitOnce(const IOContext* io_context) {
   return Status::OK();
 }
 
+void CFileReader::MaybeMapFile() {
+  // The blocks of compressed files are decompressed anyway: only those of
+  // uncompressed files can be read in place.
+  if (!FLAGS_cfile_map_uncompressed_files || codec_ != nullptr) {
+    return;
+  }
+  unique_ptr<MappedFileRange> mapped_file;
+  Status s = block_->Map(0, file_size_, &mapped_file);
+  if (PREDICT_FALSE(!s.ok())) {
+    // Read the blocks of the file as if it weren't to be mapped.
+    if (!s.IsNotSupported()) {
+      LOG(WARNING) << Substitute("unable to map CFile $0: $1", ToString(), s.ToString());
+    }
+    return;
+  }
+  mapped_file_ = std::move(mapped_file);
+}
+
 Status CFileReader::Init(const IOContext* io_context) {
   RETURN_NOT_OK_PREPEND(init_once_.Init([this, io_context] { return InitOnce(io_context); }),
                         Substitute("failed to init CFileReader for block $0",
@@ -352,6 +467,41 @@ Status CFileReader::VerifyChecksum(ArrayView<const Slice> data, const Slice& che
 
 namespace {
 
+// The number of consecutive reads which don't wait after which a scan reads
+// one block less ahead.
+constexpr int kPrefetchFastReadsBeforeShrink = 64;
+
+// The pool of the threads which read data blocks ahead of scans.
+ThreadPool* PrefetchPool() {
+  static ThreadPool* pool = []() {
+    unique_ptr<ThreadPool> pool;
+    CHECK_OK(ThreadPoolBuilder("cfile-prefetch")
+             .set_min_threads(0)
+             .set_max_threads(std::max(1, FLAGS_cfile_prefetch_threads))
+             .Build(&pool));
+    ANNOTATE_LEAKING_OBJECT_PTR(pool.get());
+    return pool.release();
+  }();
+  return pool;
+}
+
+// Returns the approximate single-core decompression speed of 'type', in MB
+// per second, for typical column data.
+int EstimatedDecompressionMBps(CompressionType type) {
+  switch (type) {
+    case LZ4:
+      return 4000;
+    case SNAPPY:
+      return 1500;
+    case ZSTD:
+      return 1000;
+    case ZLIB:
+      return 300;
+    default:
+      return 0;
+  }
+}
+
 // ScratchMemory acts as a holder for the destination buffer for a block read.
 // The buffer itself could either be allocated on the heap or be the value of
 // a pending block cache entry.
@@ -381,10 +531,11 @@ class ScratchMemory {
   // no capacity and cannot evict to make room, this will fall back
   // to allocating from the heap. In that case, IsFromCache() will
   // return false.
-  void TryAllocateFromCache(BlockCache* cache, const BlockCache::CacheKey& key, int size) {
+  void TryAllocateFromCache(BlockCache* cache, const BlockCache::CacheKey& key, int size,
+                            BlockCache::BlockType block_type) {
     DCHECK(!from_cache_.valid());
     DCHECK(!ptr_);
-    from_cache_ = cache->Allocate(key, size);
+    from_cache_ = cache->Allocate(key, size, block_type);
     if (!from_cache_.valid()) {
       return AllocateFromHeap(size);
     }
@@ -441,7 +592,8 @@ class ScratchMemory {
 Status CFileReader::ReadBlock(const IOContext* io_context,
                               const BlockPointer& ptr,
                               CacheControl cache_control,
-                              scoped_refptr<BlockHandle>* ret) const {
+                              scoped_refptr<BlockHandle>* ret,
+                              BlockCache::BlockType block_type) const {
   DCHECK(init_once_.init_succeeded());
 
   if (PREDICT_FALSE(ptr.offset() == 0 ||
@@ -450,19 +602,43 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
         "bad offset $0 in file of size $1", ptr.ToString(), file_size_));
   }
 
+  if (mapped_file_) {
+    return ReadMappedBlock(io_context, ptr, ret);
+  }
+
   BlockCacheHandle bc_handle;
   Cache::CacheBehavior cache_behavior = cache_control == CACHE_BLOCK ?
       Cache::EXPECT_IN_CACHE : Cache::NO_EXPECT_IN_CACHE;
   BlockCache* cache = BlockCache::GetSingleton();
   BlockCache::CacheKey key(block_->id(), ptr.offset());
-  if (cache->Lookup(key, cache_behavior, &bc_handle)) {
+  if (cache->Lookup(key, cache_behavior, &bc_handle, block_type)) {
     TRACE_COUNTER_INCREMENT("cfile_cache_hit", 1);
     TRACE_COUNTER_INCREMENT(CFILE_CACHE_HIT_BYTES_METRIC_NAME, ptr.size());
+    if (block_cache_attribution_) {
+      block_cache_attribution_->RecordHit();
+    }
     *ret = BlockHandle::WithDataFromCache(std::move(bc_handle));
     // Cache hit
     return Status::OK();
   }
 
+  // The data blocks of files with a codec which decompresses fast enough are
+  // first cached compressed. They're decompressed into the data partition
+  // only once read again while in the compressed partition.
+  const bool cache_compressed = block_type == BlockCache::BlockType::DATA &&
+      codec_ != nullptr && cache->caches_compressed_blocks() &&
+      EstimatedDecompressionMBps(codec_->type()) >=
+      FLAGS_cfile_cache_compressed_min_decompression_mbps;
+  if (cache_compressed &&
+      cache->Lookup(key, cache_behavior, &bc_handle, BlockCache::BlockType::COMPRESSED)) {
+    TRACE_COUNTER_INCREMENT("cfile_compressed_cache_hit", 1);
+    TRACE_COUNTER_INCREMENT(CFILE_CACHE_HIT_BYTES_METRIC_NAME, ptr.size());
+    if (block_cache_attribution_) {
+      block_cache_attribution_->RecordHit();
+    }
+    return DecompressCachedBlock(key, std::move(bc_handle), cache_control, ret);
+  }
+
   // Cache miss: need to read ourselves.
   // We issue trace events only in the cache miss case since we expect the
   // tracing overhead to be small compared to the IO (even if it's a memcpy
@@ -471,6 +647,9 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
                "cfile", ToString());
   TRACE_COUNTER_INCREMENT("cfile_cache_miss", 1);
   TRACE_COUNTER_INCREMENT(CFILE_CACHE_MISS_BYTES_METRIC_NAME, ptr.size());
+  if (block_cache_attribution_) {
+    block_cache_attribution_->RecordMiss();
+  }
 
   uint32_t data_size = ptr.size();
   if (has_checksum()) {
@@ -486,7 +665,9 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
   // then we should allocate our scratch memory directly from the cache.
   // This avoids an extra memory copy in the case of an NVM cache.
   if (codec_ == nullptr && cache_control == CACHE_BLOCK) {
-    scratch.TryAllocateFromCache(cache, key, data_size);
+    scratch.TryAllocateFromCache(cache, key, data_size, block_type);
+  } else if (cache_compressed && cache_control == CACHE_BLOCK) {
+    scratch.TryAllocateFromCache(cache, key, data_size, BlockCache::BlockType::COMPRESSED);
   } else {
     scratch.AllocateFromHeap(data_size);
   }
@@ -512,6 +693,14 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
     }
   }
 
+  // A block read for the first time is only cached compressed, and returned
+  // decompressed from the heap.
+  if (scratch.IsFromCache() && cache_compressed) {
+    cache->Insert(scratch.mutable_pending_entry(), &bc_handle, block_cache_attribution_.get());
+    ignore_result(scratch.release());
+    return DecompressCachedBlock(key, std::move(bc_handle), DONT_CACHE_BLOCK, ret);
+  }
+
   // Decompress the block
   if (codec_ != nullptr) {
     // Init the decompressor and get the size required for the uncompressed buffer.
@@ -524,11 +713,21 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
     }
     int uncompressed_size = uncompressor.uncompressed_size();
 
+    // The writer stores blocks which don't compress well as-is. Unless the
+    // block needs its own buffer in the cache, refer to the data in place:
+    // there's nothing to decompress, and nothing to copy.
+    if (uncompressor.stored_uncompressed() && cache_control != CACHE_BLOCK) {
+      *ret = BlockHandle::WithOwnedData(scratch.as_slice())->SubrangeBlock(
+          uncompressor.header_length(), uncompressed_size);
+      ignore_result(scratch.release());
+      return Status::OK();
+    }
+
     // If we plan to put the uncompressed block in the cache, we should
     // decompress directly into the cache's memory (to avoid a memcpy for NVM).
     ScratchMemory decompressed_scratch;
     if (cache_control == CACHE_BLOCK) {
-      decompressed_scratch.TryAllocateFromCache(cache, key, uncompressed_size);
+      decompressed_scratch.TryAllocateFromCache(cache, key, uncompressed_size, block_type);
     } else {
       decompressed_scratch.AllocateFromHeap(uncompressed_size);
     }
@@ -554,7 +753,7 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
   // of what the user requested. The scratch memory includes both the
   // generated key and the data read from disk.
   if (cache_control == CACHE_BLOCK && scratch.IsFromCache()) {
-    cache->Insert(scratch.mutable_pending_entry(), &bc_handle);
+    cache->Insert(scratch.mutable_pending_entry(), &bc_handle, block_cache_attribution_.get());
     *ret = BlockHandle::WithDataFromCache(std::move(bc_handle));
   } else {
     // We get here by either not intending to cache the block or
@@ -573,6 +772,114 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
   return Status::OK();
 }
 
+Status CFileReader::ReadMappedBlock(const IOContext* io_context,
+                                    const BlockPointer& ptr,
+                                    scoped_refptr<BlockHandle>* ret) const {
+  TRACE_COUNTER_INCREMENT("cfile_mapped_reads", 1);
+  Slice block(mapped_file_->data().data() + ptr.offset(), ptr.size());
+  if (has_checksum()) {
+    if (PREDICT_FALSE(block.size() < kChecksumSize)) {
+      return Status::Corruption("invalid data size for block pointer",
+                                ptr.ToString());
+    }
+    block.truncate(block.size() - kChecksumSize);
+    if (do_verify_checksum()) {
+      const Slice checksum(block.data() + block.size(), kChecksumSize);
+      if (auto s = VerifyChecksum(ArrayView<const Slice>(&block, 1), checksum);
+          PREDICT_FALSE(!s.ok())) {
+        RETURN_NOT_OK_HANDLE_CORRUPTION(
+            s.CloneAndPrepend(Substitute("checksum error on CFile block $0 at $1",
+                                         block_id().ToString(), ptr.ToString())),
+            HandleCorruption(io_context));
+      }
+    }
+  }
+  *ret = BlockHandle::WithMappedData(block, mapped_file_);
+  return Status::OK();
+}
+
+Status CFileReader::WarmBlockCache(const IOContext* io_context,
+                                   const std::unordered_set<uint64_t>& offsets,
+                                   const std::function<Status(size_t)>& before_read) {
+  RETURN_NOT_OK(Init(io_context));
+  BlockPointer root;
+  if (has_posidx()) {
+    root = posidx_root();
+  } else if (has_validx()) {
+    root = validx_root();
+  } else {
+    return Status::OK();
+  }
+
+  // Walk the leaves of the index: this reads the index blocks into the cache
+  // as a side effect.
+  IndexTreeIterator iter(io_context, this, root);
+  RETURN_NOT_OK(iter.SeekToFirst());
+  size_t num_prefetched = 0;
+  while (true) {
+    const BlockPointer& ptr = iter.GetCurrentBlockPointer();
+    if (ContainsKey(offsets, ptr.offset())) {
+      RETURN_NOT_OK(before_read(ptr.size()));
+      scoped_refptr<BlockHandle> block;
+      RETURN_NOT_OK(ReadBlock(io_context, ptr, CACHE_BLOCK, &block));
+      // All the requested blocks were found: no need to read further.
+      if (++num_prefetched == offsets.size()) {
+        break;
+      }
+    }
+    if (!iter.HasNext()) {
+      break;
+    }
+    RETURN_NOT_OK(iter.Next());
+  }
+  return Status::OK();
+}
+
+Status CFileReader::DecompressCachedBlock(const BlockCache::CacheKey& key,
+                                          BlockCacheHandle compressed,
+                                          CacheControl cache_control,
+                                          scoped_refptr<BlockHandle>* ret) const {
+  const Slice block = compressed.data();
+  CompressedBlockDecoder uncompressor(codec_, cfile_version_, block);
+  if (auto s = uncompressor.Init(); PREDICT_FALSE(!s.ok())) {
+    LOG(WARNING) << Substitute(
+        "unable to validate compressed block $0 of size $1 at offset $2: $3",
+        block_id().ToString(), block.size(), key.offset_, s.ToString());
+    return s;
+  }
+  const int uncompressed_size = uncompressor.uncompressed_size();
+  if (uncompressor.stored_uncompressed()) {
+    // Nothing to decompress: refer to the compressed entry in place.
+    *ret = BlockHandle::WithDataFromCache(std::move(compressed))->SubrangeBlock(
+        uncompressor.header_length(), uncompressed_size);
+    return Status::OK();
+  }
+
+  BlockCache* cache = BlockCache::GetSingleton();
+  ScratchMemory scratch;
+  if (cache_control == CACHE_BLOCK) {
+    scratch.TryAllocateFromCache(cache, key, uncompressed_size, BlockCache::BlockType::DATA);
+  } else {
+    scratch.AllocateFromHeap(uncompressed_size);
+  }
+  if (auto s = uncompressor.UncompressIntoBuffer(scratch.get()); PREDICT_FALSE(!s.ok())) {
+    LOG(WARNING) << Substitute(
+        "unable to uncompress block $0 of size $1 at offset $2: $3",
+        block_id().ToString(), block.size(), key.offset_, s.ToString());
+    return s;
+  }
+
+  if (scratch.IsFromCache()) {
+    BlockCacheHandle bc_handle;
+    cache->Insert(scratch.mutable_pending_entry(), &bc_handle, block_cache_attribution_.get());
+    *ret = BlockHandle::WithDataFromCache(std::move(bc_handle));
+  } else {
+    *ret = BlockHandle::WithOwnedData(scratch.as_slice());
+  }
+  ignore_result(scratch.release());
+  return Status::OK();
+}
+
 Status CFileReader::CountRows(rowid_t* count) const {
   *count = footer().num_values();
   return Status::OK();
@@ -665,18 +972,27 @@ Status DefaultColumnValueIterator::Scan(ColumnMaterializationContext* ctx) {
       sel_view.ClearBits(dst->nrows());
       return Status::OK();
     }
+    const void* cell = value_;
+    Slice dst_slice;
     if (typeinfo_->physical_type() == BINARY) {
       const Slice* src_slice = reinterpret_cast<const Slice*>(value_);
-      Slice dst_slice;
       if (PREDICT_FALSE(!dst->arena()->RelocateSlice(*src_slice, &dst_slice))) {
         return Status::IOError("out of memory copying slice", src_slice->ToString());
       }
-      for (size_t i = 0; i < dst->nrows(); ++i) {
-        dst->SetCellValue(i, &dst_slice);
-      }
-    } else {
-      for (size_t i = 0; i < dst->nrows(); ++i) {
-        dst->SetCellValue(i, value_);
+      cell = &dst_slice;
+    }
+    // Fill the cells by doubling the filled prefix with every copy, rather
+    // than copying the value cell by cell: scans of the rowsets flushed before
+    // the column was added materialize the default for all of their rows.
+    const size_t nrows = dst->nrows();
+    if (nrows > 0) {
+      const size_t stride = dst->stride();
+      uint8_t* data = dst->data();
+      memcpy(data, cell, stride);
+      for (size_t filled = 1; filled < nrows;) {
+        const size_t n = std::min(filled, nrows - filled);
+        memcpy(data + filled * stride, data, n * stride);
+        filled += n;
       }
     }
   } else {
@@ -705,10 +1021,23 @@ CFileIterator::CFileIterator(CFileReader* reader,
     cache_control_(cache_control),
     last_prepare_idx_(-1),
     last_prepare_count_(-1),
-    io_context_(io_context) {
+    io_context_(io_context),
+    zone_map_loaded_(false),
+    bloom_filter_pred_(nullptr),
+    bloom_filter_may_match_(true),
+    secondary_index_pred_(nullptr),
+    secondary_index_usable_(false),
+    prefetch_depth_(1),
+    prefetch_fast_reads_(0),
+    prefetched_up_to_(0) {
 }
 
 CFileIterator::~CFileIterator() {
+  if (prefetch_token_) {
+    // Drops the reads which haven't started, and waits for the others since
+    // they use 'reader_' and 'io_context_'.
+    prefetch_token_->Shutdown();
+  }
 }
 
 Status CFileIterator::SeekToOrdinal(rowid_t ord_idx) {
@@ -966,8 +1295,17 @@ Status DecodeNullInfo(scoped_refptr<BlockHandle>* data_block_handle,
 Status CFileIterator::ReadCurrentDataBlock(const IndexTreeIterator& idx_iter,
                                            PreparedBlock* prep_block) {
   prep_block->dblk_ptr_ = idx_iter.GetCurrentBlockPointer();
-  RETURN_NOT_OK(reader_->ReadBlock(
-      io_context_, prep_block->dblk_ptr_, cache_control_, &prep_block->dblk_handle_));
+  const int max_prefetch = FLAGS_cfile_prefetch_max_blocks;
+  if (max_prefetch > 0 && cache_control_ == CFileReader::CACHE_BLOCK) {
+    MonoTime start = MonoTime::Now();
+    RETURN_NOT_OK(reader_->ReadBlock(
+        io_context_, prep_block->dblk_ptr_, cache_control_, &prep_block->dblk_handle_));
+    AdaptPrefetchDepth(MonoTime::Now() - start, max_prefetch);
+    MaybePrefetch(idx_iter, prep_block->dblk_ptr_);
+  } else {
+    RETURN_NOT_OK(reader_->ReadBlock(
+        io_context_, prep_block->dblk_ptr_, cache_control_, &prep_block->dblk_handle_));
+  }
 
   uint32_t num_rows_in_block = 0;
   scoped_refptr<BlockHandle> data_block = prep_block->dblk_handle_;
@@ -1006,6 +1344,53 @@ Status CFileIterator::ReadCurrentDataBlock(const IndexTreeIterator& idx_iter,
   return Status::OK();
 }
 
+void CFileIterator::AdaptPrefetchDepth(const MonoDelta& read_time, int max_depth) {
+  if (read_time.ToMicroseconds() > FLAGS_cfile_prefetch_stall_threshold_us) {
+    // The read wasn't ahead of the scan: read further ahead.
+    prefetch_depth_ = std::min(prefetch_depth_ * 2, max_depth);
+    prefetch_fast_reads_ = 0;
+  } else if (++prefetch_fast_reads_ >= kPrefetchFastReadsBeforeShrink) {
+    prefetch_depth_ = std::max(prefetch_depth_ - 1, 1);
+    prefetch_fast_reads_ = 0;
+  }
+  prefetch_depth_ = std::min(prefetch_depth_, max_depth);
+}
+
+void CFileIterator::MaybePrefetch(const IndexTreeIterator& idx_iter,
+                                  const BlockPointer& current) {
+  if (current.offset() < prefetched_up_to_) {
+    // The scan went back, so what's been read ahead is behind it.
+    prefetched_up_to_ = 0;
+  }
+  vector<BlockPointer> ptrs;
+  if (!idx_iter.GetNextBlockPointers(prefetch_depth_, &ptrs).ok()) {
+    return;
+  }
+  for (const BlockPointer& ptr : ptrs) {
+    if (ptr.offset() <= prefetched_up_to_) {
+      continue;
+    }
+    if (!prefetch_token_) {
+      prefetch_token_ = PrefetchPool()->NewToken(ThreadPool::ExecutionMode::CONCURRENT);
+    }
+    CFileReader* reader = reader_;
+    const IOContext* io_context = io_context_;
+    Status s = prefetch_token_->Submit([reader, io_context, ptr]() {
+      scoped_refptr<BlockHandle> handle;
+      Status s = reader->ReadBlock(io_context, ptr, CFileReader::CACHE_BLOCK, &handle);
+      if (PREDICT_FALSE(!s.ok())) {
+        // The scan gets the error when it reaches the block.
+        VLOG(1) << "Unable to read ahead block " << ptr.ToString() << " of cfile "
+                << reader->block_id().ToString() << ": " << s.ToString();
+      }
+    });
+    if (PREDICT_FALSE(!s.ok())) {
+      return;
+    }
+    prefetched_up_to_ = ptr.offset();
+  }
+}
+
 Status CFileIterator::QueueCurrentDataBlock(const IndexTreeIterator& idx_iter) {
   pblock_pool_scoped_ptr b = prepared_block_pool_.make_scoped_ptr(
     prepared_block_pool_.Construct());
@@ -1114,8 +1499,138 @@ Status CFileIterator::FinishBatch() {
   return Status::OK();
 }
 
+Status CFileIterator::CanSkipRows(const ColumnPredicate& pred,
+                                  rowid_t start_idx,
+                                  size_t nrows,
+                                  bool* can_skip) {
+  *can_skip = false;
+  if (!FLAGS_cfile_use_zone_maps && !FLAGS_cfile_use_column_bloom_filters &&
+      !FLAGS_cfile_use_secondary_indexes) {
+    return Status::OK();
+  }
+  if (!zone_map_loaded_) {
+    RETURN_NOT_OK(reader_->Init(io_context_));
+    if (reader_->footer().has_zone_map_block_ptr()) {
+      BlockPointer bp(reader_->footer().zone_map_block_ptr());
+      scoped_refptr<BlockHandle> zone_map_handle;
+      RETURN_NOT_OK_PREPEND(
+          reader_->ReadBlock(io_context_, bp, cache_control_, &zone_map_handle,
+                             BlockCache::BlockType::INDEX),
+          "couldn't read zone map block");
+      RETURN_NOT_OK_PREPEND(ZoneMap::Parse(reader_->type_info(),
+                                           zone_map_handle->data(),
+                                           &zone_map_),
+                            Substitute("couldn't parse zone map in block $0 ($1)",
+                                       reader_->block_id().ToString(),
+                                       bp.ToString()));
+    }
+    if (reader_->footer().has_bloom_filter_block_ptr()) {
+      BlockPointer bp(reader_->footer().bloom_filter_block_ptr());
+      scoped_refptr<BlockHandle> bloom_handle;
+      RETURN_NOT_OK_PREPEND(
+          reader_->ReadBlock(io_context_, bp, cache_control_, &bloom_handle,
+                             BlockCache::BlockType::INDEX),
+          "couldn't read column bloom filter block");
+      RETURN_NOT_OK_PREPEND(ColumnBloomFilter::Parse(reader_->type_info(),
+                                                     bloom_handle->data(),
+                                                     &bloom_filter_),
+                            Substitute("couldn't parse column bloom filter in block $0 ($1)",
+                                       reader_->block_id().ToString(),
+                                       bp.ToString()));
+    }
+    if (reader_->footer().has_secondary_index_block_ptr()) {
+      BlockPointer bp(reader_->footer().secondary_index_block_ptr());
+      scoped_refptr<BlockHandle> directory_handle;
+      RETURN_NOT_OK_PREPEND(
+          reader_->ReadBlock(io_context_, bp, cache_control_, &directory_handle,
+                             BlockCache::BlockType::INDEX),
+          "couldn't read secondary index directory block");
+      RETURN_NOT_OK_PREPEND(ColumnSecondaryIndex::Parse(reader_->type_info(),
+                                                        directory_handle->data(),
+                                                        &secondary_index_),
+                            Substitute("couldn't parse secondary index in block $0 ($1)",
+                                       reader_->block_id().ToString(),
+                                       bp.ToString()));
+    }
+    zone_map_loaded_ = true;
+  }
+  if (bloom_filter_ && FLAGS_cfile_use_column_bloom_filters) {
+    if (bloom_filter_pred_ != &pred) {
+      bloom_filter_may_match_ = bloom_filter_->MayMatch(pred);
+      bloom_filter_pred_ = &pred;
+    }
+    if (!bloom_filter_may_match_) {
+      *can_skip = true;
+      return Status::OK();
+    }
+  }
+  if (secondary_index_ && FLAGS_cfile_use_secondary_indexes) {
+    if (secondary_index_pred_ != &pred) {
+      RETURN_NOT_OK(LookupSecondaryIndex(pred));
+      secondary_index_pred_ = &pred;
+    }
+    if (secondary_index_usable_) {
+      const auto& rowids = secondary_index_rowids_;
+      auto it = std::lower_bound(rowids.begin(), rowids.end(), start_idx);
+      if (it == rowids.end() || *it >= start_idx + nrows) {
+        *can_skip = true;
+        return Status::OK();
+      }
+    }
+  }
+  if (zone_map_ && FLAGS_cfile_use_zone_maps) {
+    *can_skip = !zone_map_->MayMatch(pred, start_idx, nrows);
+  }
+  return Status::OK();
+}
+
+Status CFileIterator::LookupSecondaryIndex(const ColumnPredicate& pred) {
+  secondary_index_usable_ = false;
+  secondary_index_rowids_.clear();
+  ColumnSecondaryIndex::Lookup lookup;
+  if (!secondary_index_->PrepareLookup(pred, &lookup)) {
+    return Status::OK();
+  }
+  // A single chunk is always worth reading, since it's cheaper than reading
+  // the column.
+  rowid_t num_rows;
+  RETURN_NOT_OK(reader_->CountRows(&num_rows));
+  const double max_entries = num_rows * FLAGS_cfile_secondary_index_max_selectivity;
+  if (lookup.chunks.size() > 1 &&
+      lookup.chunks.size() * secondary_index_->entries_per_chunk() > max_entries) {
+    return Status::OK();
+  }
+  for (size_t chunk : lookup.chunks) {
+    const BlockPointer& bp = secondary_index_->chunk_ptr(chunk);
+    scoped_refptr<BlockHandle> chunk_handle;
+    RETURN_NOT_OK_PREPEND(
+        reader_->ReadBlock(io_context_, bp, cache_control_, &chunk_handle,
+                           BlockCache::BlockType::INDEX),
+        "couldn't read secondary index block");
+    RETURN_NOT_OK_PREPEND(ColumnSecondaryIndex::AddMatches(lookup, chunk_handle->data(),
+                                                           &secondary_index_rowids_),
+                          Substitute("couldn't parse secondary index in block $0 ($1)",
+                                     reader_->block_id().ToString(),
+                                     bp.ToString()));
+  }
+  auto& rowids = secondary_index_rowids_;
+  std::sort(rowids.begin(), rowids.end());
+  rowids.erase(std::unique(rowids.begin(), rowids.end()), rowids.end());
+  secondary_index_usable_ = true;
+  return Status::OK();
+}
+
 Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
   CHECK(seeked_) << "not seeked";
+  TRACE_COUNTER_SCOPE_LATENCY_NS(CFILE_DECODE_NANOS_METRIC_NAME);
+
+  // If only the values of the selected rows are needed and few of them are,
+  // skip decoding the others.
+  const double max_selectivity = FLAGS_cfile_sparse_scan_max_selectivity;
+  if (ctx->selected_rows_only() && max_selectivity > 0 &&
+      ctx->sel()->CountSelected() <= max_selectivity * last_prepare_count_) {
+    return ScanSparse(ctx);
+  }
 
   // Use views to advance the block and selection vector as we read into them.
   ColumnDataView remaining_dst(ctx->block());
@@ -1130,10 +1645,25 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
     if (nwords > 0) {
       codewords_matching_pred_.reset(new SelectionVector(nwords));
       codewords_matching_pred_->SetAllFalse();
-      for (size_t i = 0; i < nwords; i++) {
-        Slice cur_string = dict_decoder_->string_at_index(i);
-        if (ctx->pred()->EvaluateCell<BINARY>(static_cast<const void*>(&cur_string))) {
-          BitmapSet(codewords_matching_pred_->mutable_bitmap(), i);
+      const DataType physical_type = reader_->type_info()->physical_type();
+      if (physical_type == BINARY) {
+        for (size_t i = 0; i < nwords; i++) {
+          Slice cur_string = dict_decoder_->string_at_index(i);
+          if (ctx->pred()->EvaluateCell<BINARY>(static_cast<const void*>(&cur_string))) {
+            BitmapSet(codewords_matching_pred_->mutable_bitmap(), i);
+          }
+        }
+      } else {
+        // Dictionaries of fixed-width values hold each value's raw bytes,
+        // which may not be suitably aligned to evaluate in place.
+        alignas(16) uint8_t cell[16];
+        for (size_t i = 0; i < nwords; i++) {
+          Slice cur_value = dict_decoder_->string_at_index(i);
+          DCHECK_LE(cur_value.size(), sizeof(cell));
+          memcpy(cell, cur_value.data(), cur_value.size());
+          if (ctx->pred()->EvaluateCell(physical_type, cell)) {
+            BitmapSet(codewords_matching_pred_->mutable_bitmap(), i);
+          }
         }
       }
     }
@@ -1230,6 +1760,95 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
   return Status::OK();
 }
 
+Status CFileIterator::ScanSparse(ColumnMaterializationContext* ctx) {
+  ColumnDataView dst(ctx->block());
+  const uint8_t* sel = ctx->sel()->bitmap();
+  const bool dst_nullable = ctx->block()->is_nullable();
+  const size_t end = last_prepare_count_;
+  DCHECK_LE(end, ctx->block()->nrows());
+  size_t row = 0;
+  for (PreparedBlock* pb : prepared_blocks_) {
+    if (row == end) {
+      break;
+    }
+    if (pb->needs_rewind_) {
+      SeekToPositionInBlock(pb, pb->rewind_idx_);
+    }
+    pb->needs_rewind_ = true;
+    const size_t block_end = row + std::min<size_t>(end - row,
+                                                    pb->num_rows_in_block_ - pb->idx_in_block_);
+    while (row < block_end) {
+      size_t run_start;
+      if (!BitmapFindFirstSet(sel, row, block_end, &run_start)) {
+        run_start = block_end;
+      }
+      if (run_start > row) {
+        // The values of unselected rows are never read: leave them empty.
+        const size_t nskip = run_start - row;
+        memset(dst.data(), 0, dst.stride() * nskip);
+        if (dst_nullable) {
+          dst.SetNullBits(nskip, false);
+        }
+        dst.Advance(nskip);
+        row = run_start;
+        if (row == block_end) {
+          break;
+        }
+        SeekToPositionInBlock(pb, pb->idx_in_block_ + nskip);
+      }
+      size_t run_end;
+      if (!BitmapFindFirstZero(sel, row, block_end, &run_end)) {
+        run_end = block_end;
+      }
+      RETURN_NOT_OK(CopyNextRowsFromBlock(pb, run_end - row, dst_nullable, &dst));
+      row = run_end;
+    }
+  }
+  DCHECK_EQ(end, row) << "Should have fetched exactly the number of prepared rows";
+  return Status::OK();
+}
+
+Status CFileIterator::CopyNextRowsFromBlock(PreparedBlock* pb, size_t nrows, bool dst_nullable,
+                                            ColumnDataView* dst) {
+  if (!reader_->is_nullable()) {
+    size_t n = nrows;
+    RETURN_NOT_OK(pb->dblk_->CopyNextValues(&n, dst));
+    if (PREDICT_FALSE(n != nrows)) {
+      return Status::Corruption(Substitute(
+          "data block yielded $0 values instead of $1", n, nrows));
+    }
+    if (dst_nullable) {
+      dst->SetNullBits(nrows, true);
+    }
+    pb->idx_in_block_ += nrows;
+    dst->Advance(nrows);
+    return Status::OK();
+  }
+
+  DCHECK(dst_nullable);
+  size_t count = nrows;
+  while (count > 0) {
+    bool not_null = false;
+    size_t nblock = pb->rle_decoder_.GetNextRun(&not_null, count);
+    DCHECK_LE(nblock, count);
+    if (PREDICT_FALSE(nblock == 0)) {
+      return Status::Corruption(Substitute(
+          "unexpected EOF on NULL bitmap read; "
+          "expected at least $0 more rows", count));
+    }
+    if (not_null) {
+      size_t n = nblock;
+      RETURN_NOT_OK(pb->dblk_->CopyNextValues(&n, dst));
+      DCHECK_EQ(nblock, n);
+    }
+    dst->SetNullBits(nblock, not_null);
+    count -= nblock;
+    pb->idx_in_block_ += nblock;
+    dst->Advance(nblock);
+  }
+  return Status::OK();
+}
+
 Status CFileIterator::CopyNextValues(size_t* n, ColumnMaterializationContext* ctx) {
   RETURN_NOT_OK(PrepareBatch(n));
   RETURN_NOT_OK(Scan(ctx));
@@ -18,12 +18,15 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <glog/logging.h>
 
+#include "kudu/cfile/block_cache.h"
 #include "kudu/cfile/block_encodings.h"
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/block_pointer.h"
@@ -45,10 +48,15 @@
 
 namespace kudu {
 
+class ColumnDataView;
 class ColumnMaterializationContext;
+class ColumnPredicate;
 class CompressionCodec;
 class EncodedKey;
+class MappedFileRange;
 class SelectionVector;
+class MonoDelta;
+class ThreadPoolToken;
 class TypeInfo;
 
 namespace fs {
@@ -61,8 +69,11 @@ namespace cfile {
 
 class BinaryPlainBlockDecoder;
 class CFileIterator;
+class ColumnBloomFilter;
+class ColumnSecondaryIndex;
 class IndexTreeIterator;
 class TypeEncodingInfo;
+class ZoneMap;
 struct ReaderOptions;
 
 class CFileReader {
@@ -102,11 +113,23 @@ class CFileReader {
 
   // Reads the data block pointed to by `ptr`. Will pull the data block from
   // the block cache if it exists, and reads from the filesystem block
-  // otherwise.
+  // otherwise. 'block_type' selects the block cache partition.
+  //
+  // If the file is mapped (see --cfile_map_uncompressed_files), the block
+  // refers to the mapping instead, and the block cache isn't used.
   Status ReadBlock(const fs::IOContext* io_context,
                    const BlockPointer& ptr,
                    CacheControl cache_control,
-                   scoped_refptr<BlockHandle>* ret) const;
+                   scoped_refptr<BlockHandle>* ret,
+                   BlockCache::BlockType block_type = BlockCache::BlockType::DATA) const;
+
+  // Reads the data blocks starting at 'offsets' into the block cache, along
+  // with the index blocks leading to them. Offsets at which no data block
+  // starts are ignored. 'before_read' is called with the size of each data
+  // block before reading it: if it returns an error, stops and returns it.
+  Status WarmBlockCache(const fs::IOContext* io_context,
+                        const std::unordered_set<uint64_t>& offsets,
+                        const std::function<Status(size_t)>& before_read);
 
   // Return the number of rows in this cfile.
   // This is assumed to be reasonably fast (i.e does not scan
@@ -158,6 +181,13 @@ class CFileReader {
     return footer().compression() != NO_COMPRESSION;
   }
 
+  // Whether the blocks of the file are read in place from a mapping of the
+  // file.
+  bool is_mapped() const {
+    DCHECK(init_once_.init_succeeded());
+    return mapped_file_ != nullptr;
+  }
+
   // Advanced access to the cfile. This is used by the
   // delta reader code. TODO: think about reorganizing this:
   // delta files can probably be done more cleanly.
@@ -192,9 +222,25 @@ class CFileReader {
   // Callback used in 'init_once_' to initialize this cfile.
   Status InitOnce(const fs::IOContext* io_context);
 
+  // Decompresses the block cached in 'compressed', which is stored under 'key'
+  // in the compressed partition of the block cache. The result is cached in
+  // the data partition if 'cache_control' is CACHE_BLOCK.
+  Status DecompressCachedBlock(const BlockCache::CacheKey& key,
+                               BlockCacheHandle compressed,
+                               CacheControl cache_control,
+                               scoped_refptr<BlockHandle>* ret) const;
+
   Status ReadAndParseHeader();
   Status ReadAndParseFooter();
 
+  // Maps the file if it should be, so that its blocks are read in place.
+  void MaybeMapFile();
+
+  // Implements ReadBlock() for a mapped file.
+  Status ReadMappedBlock(const fs::IOContext* io_context,
+                         const BlockPointer& ptr,
+                         scoped_refptr<BlockHandle>* ret) const;
+
   // Return true if the file has checksum on the header, footer, and data blocks.
   bool has_checksum() const;
 
@@ -222,6 +268,13 @@ class CFileReader {
 
   bool do_verify_checksum_;
 
+  // The mapping of the whole file, if its blocks are read in place.
+  std::shared_ptr<const MappedFileRange> mapped_file_;
+
+  // The attribution of the blocks of this file read through the block cache,
+  // or nullptr.
+  const scoped_refptr<BlockCacheAttribution> block_cache_attribution_;
+
   KuduOnceLambda init_once_;
 
   ScopedTrackedConsumption mem_consumption_;
@@ -280,6 +333,20 @@ class ColumnIterator {
   // batch left off.
   virtual Status FinishBatch() = 0;
 
+  // Sets '*can_skip' to true if per-block statistics prove that no row in
+  // [start_idx, start_idx + nrows) satisfies 'pred', in which case those rows
+  // need not be read at all. The statistics describe the base data only, so
+  // the caller must not skip rows which may have been updated.
+  //
+  // Iterators without such statistics always set '*can_skip' to false.
+  virtual Status CanSkipRows(const ColumnPredicate& /*pred*/,
+                             rowid_t /*start_idx*/,
+                             size_t /*nrows*/,
+                             bool* can_skip) {
+    *can_skip = false;
+    return Status::OK();
+  }
+
   virtual const IteratorStats& io_statistics() const = 0;
 };
 
@@ -386,6 +453,13 @@ class CFileIterator final : public ColumnIterator {
   // batch left off.
   Status FinishBatch() override;
 
+  // Consults the cfile's column bloom filter, secondary index and zone map,
+  // if it has them. They're read and parsed on the first call.
+  Status CanSkipRows(const ColumnPredicate& pred,
+                     rowid_t start_idx,
+                     size_t nrows,
+                     bool* can_skip) override;
+
   // Return true if the next call to PrepareBatch will return at least one row.
   bool HasNext() const;
 
@@ -456,6 +530,15 @@ class CFileIterator final : public ColumnIterator {
   // Seek the given PreparedBlock to the given index within it.
   void SeekToPositionInBlock(PreparedBlock* pb, uint32_t idx_in_block);
 
+  // Like Scan(), when only the values of the rows selected in the context are
+  // needed: only decodes the runs of selected rows, seeking over the others
+  // and leaving their cells empty.
+  Status ScanSparse(ColumnMaterializationContext* ctx);
+
+  // Copies the next 'nrows' values of 'pb' into 'dst', advancing both.
+  Status CopyNextRowsFromBlock(PreparedBlock* pb, size_t nrows, bool dst_nullable,
+                               ColumnDataView* dst);
+
   // Read the data block currently pointed to by idx_iter_
   // into the given PreparedBlock structure.
   //
@@ -463,10 +546,22 @@ class CFileIterator final : public ColumnIterator {
   Status ReadCurrentDataBlock(const IndexTreeIterator& idx_iter,
                               PreparedBlock* prep_block);
 
+  // Adjusts the number of blocks read ahead of the scan given the time
+  // 'read_time' it took to read the current block, up to 'max_depth'.
+  void AdaptPrefetchDepth(const MonoDelta& read_time, int max_depth);
+
+  // Reads the data blocks which follow 'current' in the index block of
+  // 'idx_iter' into the block cache in the background, if they haven't been
+  // already.
+  void MaybePrefetch(const IndexTreeIterator& idx_iter, const BlockPointer& current);
+
   // Read the data block currently pointed to by idx_iter_, and enqueue
   // it onto the end of the prepared_blocks_ deque.
   Status QueueCurrentDataBlock(const IndexTreeIterator& idx_iter);
 
+  // Looks up the rows which may match 'pred' in 'secondary_index_'.
+  Status LookupSecondaryIndex(const ColumnPredicate& pred);
+
   // Fully initialize the underlying cfile reader if needed, and clear any
   // seek-related state.
   Status PrepareForNewSeek();
@@ -483,6 +578,28 @@ class CFileIterator final : public ColumnIterator {
   // Set containing the codewords that match the predicate in a dictionary.
   std::unique_ptr<SelectionVector> codewords_matching_pred_;
 
+  // Per-block statistics, loaded by the first call to CanSkipRows().
+  std::unique_ptr<ZoneMap> zone_map_;
+  bool zone_map_loaded_;
+
+  // Filter over all the values in the file, loaded along with 'zone_map_'.
+  std::unique_ptr<ColumnBloomFilter> bloom_filter_;
+
+  // The bloom filter's verdict is the same for every batch, so it's cached
+  // for the last predicate it was checked against.
+  const ColumnPredicate* bloom_filter_pred_;
+  bool bloom_filter_may_match_;
+
+  // Index over all the values in the file, loaded along with 'zone_map_'.
+  std::unique_ptr<ColumnSecondaryIndex> secondary_index_;
+
+  // The sorted ordinals of the rows which may match the last predicate the
+  // secondary index was looked up for, if 'secondary_index_usable_' is true,
+  // i.e. if the index could serve the predicate cheaply enough.
+  const ColumnPredicate* secondary_index_pred_;
+  bool secondary_index_usable_;
+  std::vector<rowid_t> secondary_index_rowids_;
+
   // The currently in-use index iterator. This is equal to either
   // posidx_iter_.get(), validx_iter_.get(), or NULL if not seeked.
   IndexTreeIterator* seeked_;
@@ -513,6 +630,18 @@ class CFileIterator final : public ColumnIterator {
 
   const fs::IOContext* io_context_;
 
+  // Token of the reads of blocks ahead of the scan, created by the first one.
+  std::unique_ptr<ThreadPoolToken> prefetch_token_;
+
+  // The number of blocks read ahead of the scan.
+  int prefetch_depth_;
+
+  // The number of consecutive reads which didn't wait.
+  int prefetch_fast_reads_;
+
+  // The offset of the last block read ahead, or 0 if none.
+  uint64_t prefetched_up_to_;
+
   // a temporary buffer for encoding
   faststring tmp_buf_;
 };
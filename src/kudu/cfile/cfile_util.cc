@@ -46,6 +46,9 @@ WriterOptions::WriterOptions()
     block_restart_interval(16),
     write_posidx(false),
     write_validx(false),
+    write_zone_map(false),
+    write_bloom_filter(false),
+    write_secondary_index(false),
     optimize_index_keys(true),
     validx_key_encoder(std::nullopt) {
 }
@@ -22,7 +22,9 @@
 #include <optional>
 #include <memory>
 
+#include "kudu/cfile/block_cache.h"
 #include "kudu/common/schema.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
@@ -73,6 +75,18 @@ struct WriterOptions {
   // Whether the file needs a value index
   bool write_validx;
 
+  // Whether to store per-block statistics (a zone map) that let readers
+  // skip blocks which can't match a predicate. Ignored if
+  // --cfile_write_zone_maps is false.
+  bool write_zone_map;
+
+  // Whether to write a bloom filter over all the non-null values in the file.
+  bool write_bloom_filter;
+
+  // Whether to write a secondary index mapping the values in the file to
+  // their row ordinals. Ignored for types the index doesn't support.
+  bool write_secondary_index;
+
   // Whether to optimize index keys by storing shortest separating prefixes
   // instead of entire keys.
   bool optimize_index_keys;
@@ -102,6 +116,11 @@ struct ReaderOptions {
   //
   // Default: the root tracker.
   std::shared_ptr<MemTracker> parent_mem_tracker;
+
+  // The attribution of this reader's use of the block cache, if any.
+  //
+  // Default: nullptr
+  scoped_refptr<BlockCacheAttribution> block_cache_attribution;
 };
 
 // Dumps the contents of a cfile to 'out'; 'reader' and 'iterator'
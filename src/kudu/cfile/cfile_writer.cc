@@ -32,8 +32,11 @@
 #include "kudu/cfile/block_pointer.h"
 #include "kudu/cfile/cfile.pb.h"
 #include "kudu/cfile/cfile_util.h"
+#include "kudu/cfile/column_bloom_filter.h"
+#include "kudu/cfile/column_secondary_index.h"
 #include "kudu/cfile/index_btree.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/cfile/zone_map.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/key_encoder.h"
 #include "kudu/common/schema.h"
@@ -61,6 +64,30 @@ DEFINE_bool(cfile_write_checksums, true,
             "Write CRC32 checksums for each block");
 TAG_FLAG(cfile_write_checksums, evolving);
 
+DEFINE_bool(cfile_write_zone_maps, true,
+            "Whether to store per-block min/max values and null counts for "
+            "non-key columns, which allow scans to skip blocks that can't "
+            "match a predicate.");
+TAG_FLAG(cfile_write_zone_maps, advanced);
+
+DEFINE_bool(cfile_auto_dict_encode_integers, true,
+            "Whether 32- and 64-bit integer columns with AUTO_ENCODING use "
+            "dictionary encoding rather than the type's default encoding. "
+            "Files whose dictionary fills up fall back to storing the values "
+            "directly. Doesn't apply to columns with a value index.");
+TAG_FLAG(cfile_auto_dict_encode_integers, advanced);
+TAG_FLAG(cfile_auto_dict_encode_integers, runtime);
+
+DEFINE_bool(cfile_auto_adaptive_encoding, false,
+            "Whether columns with AUTO_ENCODING use ADAPTIVE_ENCODING, which "
+            "encodes every block with each applicable encoding and keeps the "
+            "smallest result. This makes flushes and compactions more "
+            "CPU-intensive in exchange for smaller files. Takes precedence "
+            "over --cfile_auto_dict_encode_integers.");
+TAG_FLAG(cfile_auto_adaptive_encoding, advanced);
+TAG_FLAG(cfile_auto_adaptive_encoding, experimental);
+TAG_FLAG(cfile_auto_adaptive_encoding, runtime);
+
 using google::protobuf::RepeatedPtrField;
 using kudu::fs::BlockCreationTransaction;
 using kudu::fs::BlockManager;
@@ -81,6 +108,32 @@ const size_t kChecksumSize = sizeof(uint32_t);
 
 static const size_t kMinBlockSize = 512;
 
+// Picks the encoding to use for a column with AUTO_ENCODING.
+//
+// Low-cardinality integer columns compress far better with a dictionary,
+// and high-cardinality ones degrade gracefully because the dictionary
+// builder falls back to bitshuffle once the dictionary is full. Value-indexed
+// (i.e. sorted key) columns keep the default, since a unique sorted column
+// never benefits from a dictionary.
+static EncodingType ResolveAutoEncoding(const TypeInfo* typeinfo,
+                                        const WriterOptions& options) {
+  if (FLAGS_cfile_auto_adaptive_encoding) {
+    return ADAPTIVE_ENCODING;
+  }
+  if (FLAGS_cfile_auto_dict_encode_integers && !options.write_validx) {
+    switch (typeinfo->physical_type()) {
+      case INT32:
+      case UINT32:
+      case INT64:
+      case UINT64:
+        return DICT_ENCODING;
+      default:
+        break;
+    }
+  }
+  return TypeEncodingInfo::GetDefaultEncoding(typeinfo);
+}
+
 ////////////////////////////////////////////////////////////
 // CFileWriter
 ////////////////////////////////////////////////////////////
@@ -98,6 +151,9 @@ CFileWriter::CFileWriter(WriterOptions options,
     typeinfo_(typeinfo),
     state_(kWriterInitialized) {
   EncodingType encoding = options_.storage_attributes.encoding;
+  if (encoding == AUTO_ENCODING) {
+    encoding = ResolveAutoEncoding(typeinfo_, options_);
+  }
   Status s = TypeEncodingInfo::Get(typeinfo_, encoding, &type_encoding_info_);
   if (!s.ok()) {
     // TODO: we should somehow pass some contextual info about the
@@ -138,6 +194,19 @@ CFileWriter::CFileWriter(WriterOptions options,
 
     validx_builder_.reset(new IndexTreeBuilder(&options_, this));
   }
+
+  if (options_.write_zone_map && FLAGS_cfile_write_zone_maps) {
+    zone_map_builder_.reset(new ZoneMapBuilder(typeinfo_));
+  }
+
+  if (options_.write_bloom_filter) {
+    bloom_filter_builder_.reset(new ColumnBloomFilterBuilder(typeinfo_));
+  }
+
+  if (options_.write_secondary_index &&
+      ColumnSecondaryIndexBuilder::SupportsType(typeinfo_)) {
+    secondary_index_builder_.reset(new ColumnSecondaryIndexBuilder(typeinfo_));
+  }
 }
 
 CFileWriter::~CFileWriter() {
@@ -150,7 +219,9 @@ Status CFileWriter::Start() {
 
   if (compression_ != NO_COMPRESSION) {
     const CompressionCodec* codec;
-    RETURN_NOT_OK(GetCompressionCodec(compression_, &codec));
+    RETURN_NOT_OK(GetCompressionCodec(compression_,
+                                      options_.storage_attributes.compression_level,
+                                      &codec));
     block_compressor_.reset(new CompressedBlockBuilder(codec));
   }
 
@@ -237,6 +308,37 @@ Status CFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction)
     footer.mutable_validx_info()->CopyFrom(validx_info);
   }
 
+  if (zone_map_builder_ != nullptr) {
+    faststring zone_map;
+    zone_map_builder_->Finish(&zone_map);
+    BlockPointer ptr;
+    RETURN_NOT_OK_PREPEND(AddBlock({ Slice(zone_map) }, &ptr, "zone map block"),
+                          "Couldn't write zone map");
+    ptr.CopyToPB(footer.mutable_zone_map_block_ptr());
+  }
+
+  if (bloom_filter_builder_ != nullptr) {
+    faststring bloom_filter;
+    RETURN_NOT_OK_PREPEND(bloom_filter_builder_->Finish(&bloom_filter),
+                          "Couldn't build bloom filter");
+    BlockPointer ptr;
+    RETURN_NOT_OK_PREPEND(AddBlock({ Slice(bloom_filter) }, &ptr, "bloom filter block"),
+                          "Couldn't write bloom filter");
+    ptr.CopyToPB(footer.mutable_bloom_filter_block_ptr());
+  }
+
+  if (secondary_index_builder_ != nullptr) {
+    faststring directory;
+    RETURN_NOT_OK_PREPEND(secondary_index_builder_->Finish(
+        [this](const Slice& chunk, BlockPointer* ptr) {
+          return AddBlock({ chunk }, ptr, "secondary index block");
+        }, &directory), "Couldn't write secondary index");
+    BlockPointer ptr;
+    RETURN_NOT_OK_PREPEND(AddBlock({ Slice(directory) }, &ptr, "secondary index directory"),
+                          "Couldn't write secondary index directory");
+    ptr.CopyToPB(footer.mutable_secondary_index_block_ptr());
+  }
+
   // Optionally append extra information to the end of cfile.
   // Example: dictionary block for dictionary encoding
   RETURN_NOT_OK(data_block_->AppendExtraInfo(this, &footer));
@@ -305,6 +407,15 @@ Status CFileWriter::AppendEntries(const void *entries, size_t count) {
     int n = data_block_->Add(ptr, rem);
     DCHECK_GE(n, 0);
 
+    if (zone_map_builder_ != nullptr) {
+      zone_map_builder_->AddValues(ptr, n);
+    }
+    if (bloom_filter_builder_ != nullptr) {
+      bloom_filter_builder_->AddValues(ptr, n);
+    }
+    if (secondary_index_builder_ != nullptr) {
+      secondary_index_builder_->AddValues(ptr, n, value_count_);
+    }
     ptr += typeinfo_->size() * n;
     rem -= n;
     value_count_ += n;
@@ -336,6 +447,15 @@ Status CFileWriter::AppendNullableEntries(const uint8_t *bitmap,
         DCHECK_GE(n, 0);
 
         non_null_bitmap_builder_->AddRun(true, n);
+        if (zone_map_builder_ != nullptr) {
+          zone_map_builder_->AddValues(ptr, n);
+        }
+        if (bloom_filter_builder_ != nullptr) {
+          bloom_filter_builder_->AddValues(ptr, n);
+        }
+        if (secondary_index_builder_ != nullptr) {
+          secondary_index_builder_->AddValues(ptr, n, value_count_);
+        }
         ptr += n * typeinfo_->size();
         value_count_ += n;
         rem -= n;
@@ -347,6 +467,9 @@ Status CFileWriter::AppendNullableEntries(const uint8_t *bitmap,
       } while (rem > 0);
     } else {
       non_null_bitmap_builder_->AddRun(false, nitems);
+      if (zone_map_builder_ != nullptr) {
+        zone_map_builder_->AddNulls(nitems);
+      }
       ptr += nitems * typeinfo_->size();
       value_count_ += nitems;
     }
@@ -406,6 +529,9 @@ Status CFileWriter::FinishCurDataBlock() {
   if (is_nullable_) {
     non_null_bitmap_builder_->Reset();
   }
+  if (zone_map_builder_ != nullptr) {
+    zone_map_builder_->FinishBlock();
+  }
 
   if (validx_builder_ != nullptr) {
     RETURN_NOT_OK(data_block_->GetLastKey(key_tmp_space));
@@ -43,10 +43,13 @@ namespace cfile {
 
 class BlockBuilder;
 class BlockPointer;
+class ColumnBloomFilterBuilder;
+class ColumnSecondaryIndexBuilder;
 class CompressedBlockBuilder;
 class FileMetadataPairPB;
 class IndexTreeBuilder;
 class TypeEncodingInfo;
+class ZoneMapBuilder;
 
 // Magic used in header/footer
 extern const char kMagicStringV1[];
@@ -227,6 +230,9 @@ class CFileWriter {
   std::unique_ptr<IndexTreeBuilder> validx_builder_;
   std::unique_ptr<NullBitmapBuilder> non_null_bitmap_builder_;
   std::unique_ptr<CompressedBlockBuilder> block_compressor_;
+  std::unique_ptr<ZoneMapBuilder> zone_map_builder_;
+  std::unique_ptr<ColumnBloomFilterBuilder> bloom_filter_builder_;
+  std::unique_ptr<ColumnSecondaryIndexBuilder> secondary_index_builder_;
 
   enum State {
     kWriterInitialized,
@@ -0,0 +1,154 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/column_bloom_filter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/types.h"
+#include "kudu/util/block_bloom_filter.pb.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/hash.pb.h"
+#include "kudu/util/hash_util.h"
+#include "kudu/util/pb_util.h"
+
+DEFINE_double(cfile_column_bloom_filter_fpp, 0.01,
+              "The target false positive probability of the bloom filters "
+              "built for columns with the bloom_filter storage attribute.");
+TAG_FLAG(cfile_column_bloom_filter_fpp, advanced);
+
+using std::unique_ptr;
+
+namespace kudu {
+namespace cfile {
+
+namespace {
+
+constexpr HashAlgorithm kHashAlgorithm = FAST_HASH;
+constexpr uint32_t kHashSeed = 0;
+
+// Don't bother compacting the hash buffer until it's at least this large.
+constexpr size_t kMinCompactThreshold = 64 * 1024;
+
+// Floating point values are hashed by value rather than by representation,
+// since -0.0 and +0.0 compare equal even though their bytes differ.
+template<typename T>
+uint32_t HashFloatingPoint(const void* cell) {
+  T value = *reinterpret_cast<const T*>(cell);
+  if (value == 0) {
+    value = 0;
+  }
+  return HashUtil::ComputeHash32(Slice(reinterpret_cast<const uint8_t*>(&value), sizeof(value)),
+                                 kHashAlgorithm, kHashSeed);
+}
+
+uint32_t HashCell(const TypeInfo* typeinfo, const void* cell) {
+  switch (typeinfo->physical_type()) {
+    case BINARY:
+      return HashUtil::ComputeHash32(*reinterpret_cast<const Slice*>(cell),
+                                     kHashAlgorithm, kHashSeed);
+    case FLOAT:
+      return HashFloatingPoint<float>(cell);
+    case DOUBLE:
+      return HashFloatingPoint<double>(cell);
+    default:
+      return HashUtil::ComputeHash32(Slice(reinterpret_cast<const uint8_t*>(cell),
+                                           typeinfo->size()),
+                                     kHashAlgorithm, kHashSeed);
+  }
+}
+
+} // anonymous namespace
+
+ColumnBloomFilterBuilder::ColumnBloomFilterBuilder(const TypeInfo* typeinfo)
+    : typeinfo_(typeinfo),
+      compact_threshold_(kMinCompactThreshold) {
+}
+
+void ColumnBloomFilterBuilder::AddValues(const void* cells, size_t count) {
+  const uint8_t* cell = reinterpret_cast<const uint8_t*>(cells);
+  for (size_t i = 0; i < count; i++) {
+    hashes_.push_back(HashCell(typeinfo_, cell));
+    cell += typeinfo_->size();
+  }
+  if (hashes_.size() >= compact_threshold_) {
+    Compact();
+    compact_threshold_ = std::max(kMinCompactThreshold, hashes_.size() * 2);
+  }
+}
+
+void ColumnBloomFilterBuilder::Compact() {
+  std::sort(hashes_.begin(), hashes_.end());
+  hashes_.erase(std::unique(hashes_.begin(), hashes_.end()), hashes_.end());
+}
+
+Status ColumnBloomFilterBuilder::Finish(faststring* dst) {
+  Compact();
+  const int log_space_bytes = BlockBloomFilter::MinLogSpace(
+      std::max<size_t>(1, hashes_.size()), FLAGS_cfile_column_bloom_filter_fpp);
+  BlockBloomFilter filter(DefaultBlockBloomFilterBufferAllocator::GetSingleton());
+  RETURN_NOT_OK(filter.Init(log_space_bytes, kHashAlgorithm, kHashSeed));
+  for (uint32_t hash : hashes_) {
+    filter.Insert(hash);
+  }
+  BlockBloomFilterPB pb;
+  filter.CopyToPB(&pb);
+  pb_util::SerializeToString(pb, dst);
+  return Status::OK();
+}
+
+ColumnBloomFilter::ColumnBloomFilter(const TypeInfo* typeinfo)
+    : typeinfo_(typeinfo),
+      filter_(DefaultBlockBloomFilterBufferAllocator::GetSingleton()) {
+}
+
+Status ColumnBloomFilter::Parse(const TypeInfo* typeinfo, const Slice& data,
+                                unique_ptr<ColumnBloomFilter>* filter) {
+  BlockBloomFilterPB pb;
+  if (PREDICT_FALSE(!pb.ParseFromArray(data.data(), data.size()))) {
+    return Status::Corruption("unable to parse column bloom filter");
+  }
+  unique_ptr<ColumnBloomFilter> f(new ColumnBloomFilter(typeinfo));
+  RETURN_NOT_OK_PREPEND(f->filter_.InitFromPB(pb), "invalid column bloom filter");
+  *filter = std::move(f);
+  return Status::OK();
+}
+
+bool ColumnBloomFilter::MayContain(const void* cell) const {
+  return filter_.Find(HashCell(typeinfo_, cell));
+}
+
+bool ColumnBloomFilter::MayMatch(const ColumnPredicate& pred) const {
+  switch (pred.predicate_type()) {
+    case PredicateType::Equality:
+      return MayContain(pred.raw_lower());
+    case PredicateType::InList:
+      return std::any_of(pred.raw_values().begin(), pred.raw_values().end(),
+                         [this](const void* value) { return MayContain(value); });
+    default:
+      return true;
+  }
+}
+
+} // namespace cfile
+} // namespace kudu
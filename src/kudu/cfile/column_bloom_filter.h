@@ -0,0 +1,95 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/block_bloom_filter.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class ColumnPredicate;
+class TypeInfo;
+
+namespace cfile {
+
+// Builds a bloom filter over all the non-null values written to a cfile, so
+// that scans with equality or IN-list predicates on the column can rule out
+// the whole file.
+//
+// This is unrelated to the BloomFile written for the encoded primary key:
+// the filter is stored as a single BlockBloomFilterPB in a block of the
+// column's own cfile.
+//
+// Values are hashed as they're appended, and the filter is sized once the
+// number of distinct hashes is known.
+class ColumnBloomFilterBuilder {
+ public:
+  explicit ColumnBloomFilterBuilder(const TypeInfo* typeinfo);
+
+  // Accounts for 'count' contiguous non-null cells starting at 'cells'.
+  void AddValues(const void* cells, size_t count);
+
+  // Builds the filter and serializes it into 'dst'.
+  Status Finish(faststring* dst);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ColumnBloomFilterBuilder);
+
+  // Sorts and de-duplicates 'hashes_'.
+  void Compact();
+
+  const TypeInfo* typeinfo_;
+
+  // Hashes of the values appended so far. Compacted whenever its size
+  // doubles, so it stays proportional to the number of distinct values.
+  std::vector<uint32_t> hashes_;
+  size_t compact_threshold_;
+};
+
+// Read-side counterpart of ColumnBloomFilterBuilder.
+class ColumnBloomFilter {
+ public:
+  // Parses the serialized filter in 'data'.
+  static Status Parse(const TypeInfo* typeinfo, const Slice& data,
+                      std::unique_ptr<ColumnBloomFilter>* filter);
+
+  // Returns false if it's certain that no value in the file satisfies 'pred'.
+  // Only Equality and InList predicates can be ruled out; returns true for
+  // any other predicate type.
+  bool MayMatch(const ColumnPredicate& pred) const;
+
+ private:
+  explicit ColumnBloomFilter(const TypeInfo* typeinfo);
+
+  bool MayContain(const void* cell) const;
+
+  const TypeInfo* typeinfo_;
+  BlockBloomFilter filter_;
+
+  DISALLOW_COPY_AND_ASSIGN(ColumnBloomFilter);
+};
+
+} // namespace cfile
+} // namespace kudu
@@ -0,0 +1,286 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/column_secondary_index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <ostream>
+
+#include <glog/logging.h>
+
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/types.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/hash_util.h"
+
+using std::numeric_limits;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+namespace cfile {
+
+namespace {
+
+// The number of entries in each chunk block.
+constexpr uint32_t kEntriesPerChunk = 4096;
+
+// The serialized size of an entry in a chunk: the key and the row ordinal.
+constexpr size_t kEntrySize = sizeof(uint64_t) + sizeof(rowid_t);
+
+constexpr uint64_t kHashSeed = 0;
+
+// Returns the key of 'cell'. For integer types, the order of the keys is the
+// order of the values: signed values are offset by flipping their sign bit.
+uint64_t CellToKey(const TypeInfo* typeinfo, const void* cell) {
+  constexpr uint64_t kSignBit = 1ULL << 63;
+  switch (typeinfo->physical_type()) {
+    case INT8:
+      return static_cast<uint64_t>(*static_cast<const int8_t*>(cell)) ^ kSignBit;
+    case INT16:
+      return static_cast<uint64_t>(*static_cast<const int16_t*>(cell)) ^ kSignBit;
+    case INT32:
+      return static_cast<uint64_t>(*static_cast<const int32_t*>(cell)) ^ kSignBit;
+    case INT64:
+      return static_cast<uint64_t>(*static_cast<const int64_t*>(cell)) ^ kSignBit;
+    case UINT8:
+      return *static_cast<const uint8_t*>(cell);
+    case UINT16:
+      return *static_cast<const uint16_t*>(cell);
+    case UINT32:
+      return *static_cast<const uint32_t*>(cell);
+    case UINT64:
+      return *static_cast<const uint64_t*>(cell);
+    case BINARY: {
+      const Slice* s = static_cast<const Slice*>(cell);
+      return HashUtil::FastHash64(s->data(), s->size(), kHashSeed);
+    }
+    default:
+      LOG(FATAL) << "unsupported type for a secondary index: " << typeinfo->name();
+      return 0;
+  }
+}
+
+} // anonymous namespace
+
+bool ColumnSecondaryIndexBuilder::SupportsType(const TypeInfo* typeinfo) {
+  switch (typeinfo->physical_type()) {
+    case INT8:
+    case INT16:
+    case INT32:
+    case INT64:
+    case UINT8:
+    case UINT16:
+    case UINT32:
+    case UINT64:
+    case BINARY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ColumnSecondaryIndexBuilder::ColumnSecondaryIndexBuilder(const TypeInfo* typeinfo)
+    : typeinfo_(typeinfo) {
+  DCHECK(SupportsType(typeinfo_));
+}
+
+void ColumnSecondaryIndexBuilder::AddValues(const void* cells, size_t count,
+                                            rowid_t first_rowid) {
+  const uint8_t* cell = reinterpret_cast<const uint8_t*>(cells);
+  for (size_t i = 0; i < count; i++) {
+    entries_.emplace_back(CellToKey(typeinfo_, cell), first_rowid + i);
+    cell += typeinfo_->size();
+  }
+}
+
+Status ColumnSecondaryIndexBuilder::Finish(
+    const std::function<Status(const Slice&, BlockPointer*)>& add_chunk,
+    faststring* directory) {
+  // The entries were appended in row order, so sorting keeps the entries of
+  // each key in row order as well.
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+  const size_t num_chunks = (entries_.size() + kEntriesPerChunk - 1) / kEntriesPerChunk;
+  directory->clear();
+  PutVarint32(directory, kEntriesPerChunk);
+  PutVarint32(directory, num_chunks);
+
+  faststring chunk;
+  for (size_t begin = 0; begin < entries_.size(); begin += kEntriesPerChunk) {
+    const size_t end = std::min<size_t>(entries_.size(), begin + kEntriesPerChunk);
+    chunk.clear();
+    PutVarint32(&chunk, end - begin);
+    for (size_t i = begin; i < end; i++) {
+      PutFixed64(&chunk, entries_[i].first);
+      PutFixed32(&chunk, entries_[i].second);
+    }
+    BlockPointer ptr;
+    RETURN_NOT_OK(add_chunk(Slice(chunk), &ptr));
+    PutFixed64(directory, entries_[begin].first);
+    ptr.EncodeTo(directory);
+  }
+  entries_.clear();
+  entries_.shrink_to_fit();
+  return Status::OK();
+}
+
+ColumnSecondaryIndex::ColumnSecondaryIndex(const TypeInfo* typeinfo)
+    : typeinfo_(typeinfo),
+      entries_per_chunk_(0) {
+}
+
+Status ColumnSecondaryIndex::Parse(const TypeInfo* typeinfo, const Slice& data,
+                                   unique_ptr<ColumnSecondaryIndex>* index) {
+  if (!ColumnSecondaryIndexBuilder::SupportsType(typeinfo)) {
+    return Status::Corruption("secondary index on a column of unsupported type",
+                              typeinfo->name());
+  }
+  unique_ptr<ColumnSecondaryIndex> idx(new ColumnSecondaryIndex(typeinfo));
+  const uint8_t* p = data.data();
+  const uint8_t* limit = data.data() + data.size();
+  uint32_t num_chunks;
+  p = GetVarint32Ptr(p, limit, &idx->entries_per_chunk_);
+  if (p) {
+    p = GetVarint32Ptr(p, limit, &num_chunks);
+  }
+  if (PREDICT_FALSE(!p || idx->entries_per_chunk_ == 0)) {
+    return Status::Corruption("bad secondary index directory header");
+  }
+  idx->chunk_first_keys_.reserve(num_chunks);
+  idx->chunk_ptrs_.reserve(num_chunks);
+  for (uint32_t i = 0; i < num_chunks; i++) {
+    if (PREDICT_FALSE(limit - p < static_cast<ptrdiff_t>(sizeof(uint64_t)))) {
+      return Status::Corruption("truncated secondary index directory");
+    }
+    const uint64_t first_key = DecodeFixed64(p);
+    if (PREDICT_FALSE(!idx->chunk_first_keys_.empty() &&
+                      first_key < idx->chunk_first_keys_.back())) {
+      return Status::Corruption("secondary index chunks out of order");
+    }
+    idx->chunk_first_keys_.push_back(first_key);
+    p += sizeof(uint64_t);
+    uint64_t offset;
+    uint32_t size;
+    p = GetVarint64Ptr(p, limit, &offset);
+    if (p) {
+      p = GetVarint32Ptr(p, limit, &size);
+    }
+    if (PREDICT_FALSE(!p)) {
+      return Status::Corruption("bad block pointer in secondary index directory");
+    }
+    BlockPointer ptr(offset, size);
+    idx->chunk_ptrs_.push_back(ptr);
+  }
+  *index = std::move(idx);
+  return Status::OK();
+}
+
+bool ColumnSecondaryIndex::PrepareLookup(const ColumnPredicate& pred, Lookup* lookup) const {
+  lookup->key_ranges.clear();
+  lookup->chunks.clear();
+  const bool ordered = typeinfo_->physical_type() != BINARY;
+  switch (pred.predicate_type()) {
+    case PredicateType::Equality: {
+      const uint64_t key = CellToKey(typeinfo_, pred.raw_lower());
+      lookup->key_ranges.emplace_back(key, key);
+      break;
+    }
+    case PredicateType::InList:
+      for (const void* value : pred.raw_values()) {
+        const uint64_t key = CellToKey(typeinfo_, value);
+        lookup->key_ranges.emplace_back(key, key);
+      }
+      break;
+    case PredicateType::Range: {
+      if (!ordered) {
+        return false;
+      }
+      const uint64_t lower = pred.raw_lower() ? CellToKey(typeinfo_, pred.raw_lower()) : 0;
+      uint64_t upper = numeric_limits<uint64_t>::max();
+      if (pred.raw_upper()) {
+        // The upper bound is exclusive, and the keys of consecutive values
+        // are consecutive.
+        upper = CellToKey(typeinfo_, pred.raw_upper());
+        if (upper == 0) {
+          return true;
+        }
+        upper--;
+      }
+      if (lower <= upper) {
+        lookup->key_ranges.emplace_back(lower, upper);
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+  // Sorted, so that matching a key takes a binary search.
+  std::sort(lookup->key_ranges.begin(), lookup->key_ranges.end());
+  for (const auto& range : lookup->key_ranges) {
+    AddChunks(range.first, range.second, &lookup->chunks);
+  }
+  std::sort(lookup->chunks.begin(), lookup->chunks.end());
+  lookup->chunks.erase(std::unique(lookup->chunks.begin(), lookup->chunks.end()),
+                       lookup->chunks.end());
+  return true;
+}
+
+void ColumnSecondaryIndex::AddChunks(uint64_t lower, uint64_t upper,
+                                     vector<size_t>* chunks) const {
+  const auto& keys = chunk_first_keys_;
+  // The chunk before the first one starting at or after 'lower' may end with
+  // keys in the range, and so may all the chunks starting up to 'upper'.
+  size_t begin = std::lower_bound(keys.begin(), keys.end(), lower) - keys.begin();
+  if (begin > 0) {
+    begin--;
+  }
+  const size_t end = std::upper_bound(keys.begin(), keys.end(), upper) - keys.begin();
+  for (size_t i = begin; i < end; i++) {
+    chunks->push_back(i);
+  }
+}
+
+Status ColumnSecondaryIndex::AddMatches(const Lookup& lookup, const Slice& data,
+                                        vector<rowid_t>* rowids) {
+  const uint8_t* p = data.data();
+  const uint8_t* limit = data.data() + data.size();
+  uint32_t num_entries;
+  p = GetVarint32Ptr(p, limit, &num_entries);
+  if (PREDICT_FALSE(!p || limit - p != static_cast<ptrdiff_t>(num_entries * kEntrySize))) {
+    return Status::Corruption("bad secondary index chunk");
+  }
+  const auto& ranges = lookup.key_ranges;
+  for (uint32_t i = 0; i < num_entries; i++, p += kEntrySize) {
+    const uint64_t key = DecodeFixed64(p);
+    // The last range starting at or before 'key'. Only point ranges may
+    // overlap, so it's the only one which may contain the key.
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), key,
+                               [](uint64_t k, const auto& r) { return k < r.first; });
+    if (it != ranges.begin() && key <= std::prev(it)->second) {
+      rowids->push_back(DecodeFixed32(p + sizeof(uint64_t)));
+    }
+  }
+  return Status::OK();
+}
+
+} // namespace cfile
+} // namespace kudu
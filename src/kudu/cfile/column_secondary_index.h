@@ -0,0 +1,128 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "kudu/cfile/block_pointer.h"
+#include "kudu/common/rowid.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class ColumnPredicate;
+class TypeInfo;
+
+namespace cfile {
+
+// Builds a secondary index over the non-null values written to a cfile: the
+// (value, row ordinal) pairs of the file, sorted by value. Scans with a
+// selective predicate on the column look up the rows which may match and
+// skip the batches which contain none of them, without reading the column.
+//
+// Values of integer types are indexed by an order-preserving key, so that
+// the index serves range predicates as well as equality and IN-list ones.
+// Binary values are indexed by a 64-bit hash, which only serves equality and
+// IN-list predicates, and may yield false positives.
+//
+// The sorted entries are written in chunk blocks of a fixed number of
+// entries, plus a directory block with the first key and the location of
+// each chunk, so that a lookup only reads the chunks it needs.
+class ColumnSecondaryIndexBuilder {
+ public:
+  // Returns true if values of the given type can be indexed.
+  static bool SupportsType(const TypeInfo* typeinfo);
+
+  explicit ColumnSecondaryIndexBuilder(const TypeInfo* typeinfo);
+
+  // Accounts for 'count' contiguous non-null cells starting at 'cells', the
+  // first of which is at ordinal 'first_rowid' in the file.
+  void AddValues(const void* cells, size_t count, rowid_t first_rowid);
+
+  // Sorts the entries and writes the chunks with 'add_chunk', which appends
+  // a block to the file and returns its location. Serializes the directory
+  // into 'directory', which the caller is in charge of writing.
+  Status Finish(const std::function<Status(const Slice&, BlockPointer*)>& add_chunk,
+                faststring* directory);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ColumnSecondaryIndexBuilder);
+
+  const TypeInfo* typeinfo_;
+
+  // The (key, row ordinal) pairs of the values appended so far.
+  std::vector<std::pair<uint64_t, rowid_t>> entries_;
+};
+
+// Read-side counterpart of ColumnSecondaryIndexBuilder. Only the directory is
+// held in memory: the caller reads the chunks a lookup needs.
+class ColumnSecondaryIndex {
+ public:
+  // The ranges of keys which may satisfy a predicate, and the chunks which
+  // may hold entries in those ranges.
+  struct Lookup {
+    std::vector<std::pair<uint64_t, uint64_t>> key_ranges;
+    std::vector<size_t> chunks;
+  };
+
+  // Parses the serialized directory in 'data'.
+  static Status Parse(const TypeInfo* typeinfo, const Slice& data,
+                      std::unique_ptr<ColumnSecondaryIndex>* index);
+
+  // Prepares the lookup of the rows which may satisfy 'pred'. Returns false
+  // if the index can't serve predicates of this type.
+  bool PrepareLookup(const ColumnPredicate& pred, Lookup* lookup) const;
+
+  // Appends to 'rowids' the row ordinals of the entries of the serialized
+  // chunk 'data' whose key is in the ranges of 'lookup'.
+  static Status AddMatches(const Lookup& lookup, const Slice& data,
+                           std::vector<rowid_t>* rowids);
+
+  // The location of the chunk at 'idx' in the directory.
+  const BlockPointer& chunk_ptr(size_t idx) const {
+    return chunk_ptrs_[idx];
+  }
+
+  // The number of entries in each chunk, except maybe the last one.
+  uint32_t entries_per_chunk() const {
+    return entries_per_chunk_;
+  }
+
+ private:
+  explicit ColumnSecondaryIndex(const TypeInfo* typeinfo);
+
+  // Adds the chunks which may hold keys in [lower, upper] to 'chunks'.
+  void AddChunks(uint64_t lower, uint64_t upper, std::vector<size_t>* chunks) const;
+
+  const TypeInfo* typeinfo_;
+  uint32_t entries_per_chunk_;
+  std::vector<uint64_t> chunk_first_keys_;
+  std::vector<BlockPointer> chunk_ptrs_;
+
+  DISALLOW_COPY_AND_ASSIGN(ColumnSecondaryIndex);
+};
+
+} // namespace cfile
+} // namespace kudu
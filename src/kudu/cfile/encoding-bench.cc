@@ -0,0 +1,364 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Micro benchmark of the encodings of cfiles: for every type and encoding
+// TypeEncodingInfo supports, and a few distributions of the values, measures
+// the throughput of encoding the values into a cfile, of decoding them back,
+// and of evaluating a predicate on them while decoding them.
+//
+// The values are written and read through CFileWriter and CFileIterator so
+// that the dictionary encodings, whose dictionaries live outside of the data
+// blocks, and the null bitmaps are covered as well. The results are logged,
+// and written as CSV into --encoding_bench_results_file if set, to track
+// regressions across runs.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/cfile/cfile-test-base.h"
+#include "kudu/cfile/cfile_reader.h"
+#include "kudu/cfile/cfile_writer.h"
+#include "kudu/cfile/type_encodings.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/columnblock-test-util.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/fs/block_id.h"
+#include "kudu/fs/block_manager.h"
+#include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/bitmap.h"
+#include "kudu/util/env.h"
+#include "kudu/util/int128.h"
+#include "kudu/util/random.h"
+#include "kudu/util/random_util.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/stopwatch.h"
+#include "kudu/util/test_macros.h"
+
+DEFINE_int32(encoding_bench_num_rows, 100000,
+             "Number of values to encode and decode per type, encoding and "
+             "distribution");
+DEFINE_int32(encoding_bench_cardinality, 16,
+             "Number of distinct values of the low cardinality distribution");
+DEFINE_int32(encoding_bench_run_length, 100,
+             "Length of the runs of identical values of the runs distribution");
+DEFINE_string(encoding_bench_results_file, "",
+              "If set, the results are written as CSV into this file");
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace cfile {
+
+namespace {
+
+enum class Distribution {
+  // Increasing values.
+  SORTED,
+  // Uniformly random values.
+  RANDOM,
+  // Random values among --encoding_bench_cardinality distinct ones.
+  LOW_CARDINALITY,
+  // Runs of --encoding_bench_run_length identical random values.
+  RUNS,
+  // Random values, about half of them null.
+  NULLS,
+};
+
+const char* DistributionName(Distribution dist) {
+  switch (dist) {
+    case Distribution::SORTED: return "sorted";
+    case Distribution::RANDOM: return "random";
+    case Distribution::LOW_CARDINALITY: return "low_cardinality";
+    case Distribution::RUNS: return "runs";
+    case Distribution::NULLS: return "nulls";
+  }
+  LOG(FATAL) << "unknown distribution";
+  return "";
+}
+
+struct BenchResult {
+  DataType type;
+  EncodingType encoding;
+  Distribution dist;
+  size_t num_rows;
+  uint64_t encoded_bytes;
+  double encode_rows_per_sec;
+  double decode_rows_per_sec;
+  double eval_rows_per_sec;
+  // Whether the predicate was evaluated by the decoder rather than after
+  // decoding the values.
+  bool decoder_eval;
+
+  static string CsvHeader() {
+    return "type,encoding,distribution,rows,encoded_bytes,encode_rows_per_sec,"
+           "decode_rows_per_sec,eval_rows_per_sec,decoder_eval";
+  }
+
+  string ToCsv() const {
+    return Substitute("$0,$1,$2,$3,$4,$5,$6,$7,$8",
+                      DataType_Name(type), EncodingType_Name(encoding), DistributionName(dist),
+                      num_rows, encoded_bytes, StringPrintf("%.0f", encode_rows_per_sec),
+                      StringPrintf("%.0f", decode_rows_per_sec),
+                      StringPrintf("%.0f", eval_rows_per_sec), decoder_eval);
+  }
+};
+
+// Generates the values of a column of type 'Type' following a distribution.
+template<DataType Type>
+class ValueGenerator {
+ public:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+
+  ValueGenerator(Distribution dist, size_t num_rows)
+      : values_(num_rows),
+        non_null_bitmap_(BitmapSize(num_rows), 0xff) {
+    Random rng(SeedRandom());
+    uint64_t run_value = 0;
+    if (Type == BINARY) {
+      strings_.resize(num_rows);
+    }
+    for (size_t i = 0; i < num_rows; i++) {
+      uint64_t v;
+      switch (dist) {
+        case Distribution::SORTED:
+          v = Type == BOOL ? (i >= num_rows / 2) : i;
+          break;
+        case Distribution::RANDOM:
+          v = rng.Next64();
+          break;
+        case Distribution::LOW_CARDINALITY:
+          v = rng.Uniform(FLAGS_encoding_bench_cardinality);
+          break;
+        case Distribution::RUNS:
+          if (i % FLAGS_encoding_bench_run_length == 0) {
+            run_value = rng.Next64();
+          }
+          v = run_value;
+          break;
+        case Distribution::NULLS:
+          v = rng.Next64();
+          BitmapChange(non_null_bitmap_.data(), i, rng.OneIn(2));
+          break;
+      }
+      values_[i] = Convert(v, i);
+    }
+  }
+
+  const CppType* values() const { return values_.data(); }
+  const uint8_t* non_null_bitmap() const { return non_null_bitmap_.data(); }
+
+  // Returns a predicate selecting about a tenth of the values.
+  ColumnPredicate MakePredicate(const ColumnSchema& col) {
+    vector<CppType> sorted(values_);
+    std::sort(sorted.begin(), sorted.end());
+    lower_ = sorted[sorted.size() * 45 / 100];
+    upper_ = sorted[sorted.size() * 55 / 100];
+    if (Type == BOOL || !(lower_ < upper_)) {
+      return ColumnPredicate::Equality(col, &lower_);
+    }
+    return ColumnPredicate::Range(col, &lower_, &upper_);
+  }
+
+ private:
+  CppType Convert(uint64_t v, size_t i) {
+    if constexpr (Type == BINARY) {
+      strings_[i] = StringPrintf("%016" PRIx64, v);
+      return Slice(strings_[i]);
+    } else if constexpr (Type == BOOL) {
+      return v & 1;
+    } else {
+      return static_cast<CppType>(v);
+    }
+  }
+
+  vector<CppType> values_;
+  vector<uint8_t> non_null_bitmap_;
+  // The data of the values of BINARY columns.
+  vector<string> strings_;
+  // The bounds of the predicate.
+  CppType lower_;
+  CppType upper_;
+};
+
+class EncodingBench : public CFileTestBase {
+ protected:
+  void TearDown() override {
+    if (!FLAGS_encoding_bench_results_file.empty()) {
+      string csv = BenchResult::CsvHeader() + "\n";
+      for (const auto& result : results_) {
+        csv += result.ToCsv() + "\n";
+      }
+      ASSERT_OK(WriteStringToFile(env_, csv, FLAGS_encoding_bench_results_file));
+    }
+    CFileTestBase::TearDown();
+  }
+
+  template<DataType Type>
+  void BenchEncodings() {
+    for (EncodingType encoding : { PLAIN_ENCODING, PREFIX_ENCODING, RLE, DICT_ENCODING,
+                                   BIT_SHUFFLE, FRAME_OF_REFERENCE, XOR_ENCODING,
+                                   ADAPTIVE_ENCODING }) {
+      const TypeEncodingInfo* tei;
+      if (!TypeEncodingInfo::Get(GetTypeInfo(Type), encoding, &tei).ok()) {
+        continue;
+      }
+      for (Distribution dist : { Distribution::SORTED, Distribution::RANDOM,
+                                 Distribution::LOW_CARDINALITY, Distribution::RUNS,
+                                 Distribution::NULLS }) {
+        NO_FATALS(Bench<Type>(encoding, dist));
+      }
+    }
+  }
+
+  template<DataType Type>
+  void Bench(EncodingType encoding, Distribution dist) {
+    const size_t num_rows = FLAGS_encoding_bench_num_rows;
+    const bool nullable = dist == Distribution::NULLS;
+    ValueGenerator<Type> gen(dist, num_rows);
+    BenchResult result = { Type, encoding, dist, num_rows };
+
+    // Encode the values, in batches of the size compactions write.
+    unique_ptr<fs::WritableBlock> sink;
+    ASSERT_OK(fs_manager_->CreateNewBlock({}, &sink));
+    const BlockId block_id = sink->id();
+    WriterOptions opts;
+    opts.storage_attributes.encoding = encoding;
+    opts.storage_attributes.compression = NO_COMPRESSION;
+    Stopwatch sw;
+    sw.start();
+    {
+      CFileWriter w(opts, GetTypeInfo(Type), nullable, std::move(sink));
+      ASSERT_OK(w.Start());
+      constexpr size_t kBatchSize = 100;
+      for (size_t i = 0; i < num_rows; i += kBatchSize) {
+        const size_t n = std::min(kBatchSize, num_rows - i);
+        if (nullable) {
+          // Copy the bits of the batch for them to start at the first bit.
+          uint8_t bitmap[(kBatchSize + 7) / 8];
+          BitmapCopy(bitmap, 0, gen.non_null_bitmap(), i, n);
+          ASSERT_OK(w.AppendNullableEntries(bitmap, gen.values() + i, n));
+        } else {
+          ASSERT_OK(w.AppendEntries(gen.values() + i, n));
+        }
+      }
+      ASSERT_OK(w.Finish());
+    }
+    sw.stop();
+    result.encode_rows_per_sec = num_rows / sw.elapsed().wall_seconds();
+
+    unique_ptr<fs::ReadableBlock> source;
+    ASSERT_OK(fs_manager_->OpenBlock(block_id, &source));
+    unique_ptr<CFileReader> reader;
+    ASSERT_OK(CFileReader::Open(std::move(source), ReaderOptions(), &reader));
+    result.encoded_bytes = reader->file_size();
+
+    // Read the blocks once before timing, so that both measurements are of
+    // decoding cached blocks.
+    size_t decoded;
+    NO_FATALS(Scan<Type>(reader.get(), nullptr, &decoded, nullptr));
+    ASSERT_EQ(num_rows, decoded);
+
+    sw.start();
+    NO_FATALS(Scan<Type>(reader.get(), nullptr, &decoded, nullptr));
+    sw.stop();
+    result.decode_rows_per_sec = num_rows / sw.elapsed().wall_seconds();
+
+    const ColumnSchema col("c", Type, nullable);
+    const ColumnPredicate pred = gen.MakePredicate(col);
+    sw.start();
+    NO_FATALS(Scan<Type>(reader.get(), &pred, &decoded, &result.decoder_eval));
+    sw.stop();
+    result.eval_rows_per_sec = num_rows / sw.elapsed().wall_seconds();
+
+    LOG(INFO) << result.ToCsv();
+    results_.emplace_back(result);
+  }
+
+  // Scans all the values of the cfile, evaluating 'pred' if set either while
+  // decoding them or after decoding them, as MaterializingIterator does.
+  template<DataType Type>
+  static void Scan(CFileReader* reader, const ColumnPredicate* pred, size_t* decoded,
+                   bool* decoder_eval) {
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    ASSERT_OK(iter->SeekToOrdinal(0));
+    ScopedColumnBlock<Type> cb(8192);
+    SelectionVector sel(cb.nrows());
+    ColumnMaterializationContext ctx(0, pred, &cb, &sel);
+    if (!pred) {
+      ctx.SetDecoderEvalNotSupported();
+    }
+    *decoded = 0;
+    while (iter->HasNext()) {
+      size_t n = cb.nrows();
+      sel.SetAllTrue();
+      ASSERT_OK_FAST(iter->CopyNextValues(&n, &ctx));
+      if (pred && ctx.DecoderEvalNotSupported()) {
+        pred->Evaluate(cb, &sel);
+      }
+      *decoded += n;
+      cb.memory()->Reset();
+    }
+    if (decoder_eval) {
+      *decoder_eval = !ctx.DecoderEvalNotSupported();
+    }
+  }
+
+  vector<BenchResult> results_;
+};
+
+} // anonymous namespace
+
+TEST_F(EncodingBench, BenchAllEncodings) {
+  NO_FATALS(BenchEncodings<BOOL>());
+  NO_FATALS(BenchEncodings<INT8>());
+  NO_FATALS(BenchEncodings<UINT8>());
+  NO_FATALS(BenchEncodings<INT16>());
+  NO_FATALS(BenchEncodings<UINT16>());
+  NO_FATALS(BenchEncodings<INT32>());
+  NO_FATALS(BenchEncodings<UINT32>());
+  NO_FATALS(BenchEncodings<INT64>());
+  NO_FATALS(BenchEncodings<UINT64>());
+  NO_FATALS(BenchEncodings<INT128>());
+  NO_FATALS(BenchEncodings<FLOAT>());
+  NO_FATALS(BenchEncodings<DOUBLE>());
+  NO_FATALS(BenchEncodings<BINARY>());
+}
+
+} // namespace cfile
+} // namespace kudu
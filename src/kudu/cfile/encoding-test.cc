@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
 #include <limits>
@@ -36,16 +37,23 @@
 
 #include "kudu/cfile/binary_plain_block.h"
 #include "kudu/cfile/binary_prefix_block.h"
+#include "kudu/cfile/adaptive_block.h"
 #include "kudu/cfile/block_encodings.h"
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/cfile_util.h"
+#include "kudu/cfile/frame_of_reference_block.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/cfile/xor_block.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock-test-util.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/rowblock_memory.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
+#include "kudu/gutil/casts.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -634,6 +642,114 @@ class TestEncoding : public KuduTest {
     }
   }
 
+  // Decode all of 'block' with CopyNextAndEval() in randomly sized batches,
+  // and check that the resulting selection vector and the selected values
+  // match evaluating 'pred' on the 'inserted' values.
+  //
+  // Decoders which don't support decoder-level evaluation are checked by
+  // evaluating 'pred' after decoding, as MaterializingIterator does.
+  template <DataType Type>
+  void VerifyDecoderEval(EncodingType encoding,
+                         scoped_refptr<BlockHandle> block,
+                         const vector<typename TypeTraits<Type>::cpp_type>& inserted,
+                         const ColumnPredicate& pred) {
+    typedef typename TypeTraits<Type>::cpp_type CppType;
+    SCOPED_TRACE(pred.ToString());
+
+    auto bd = CreateBlockDecoderOrDie(Type, encoding, std::move(block));
+    ASSERT_OK(bd->ParseHeader());
+
+    const size_t num_rows = inserted.size();
+    vector<CppType> decoded(num_rows);
+    ColumnBlock dst_block(GetTypeInfo(Type), nullptr, &decoded[0], num_rows, &memory_);
+
+    // Deselect some rows up front: they must remain deselected.
+    Random rng(SeedRandom());
+    SelectionVector sel(num_rows);
+    sel.SetAllTrue();
+    vector<bool> initially_selected(num_rows, true);
+    for (size_t i = 0; i < num_rows; i++) {
+      if (rng.OneIn(5)) {
+        sel.SetRowUnselected(i);
+        initially_selected[i] = false;
+      }
+    }
+
+    ColumnMaterializationContext ctx(0, &pred, &dst_block, &sel);
+    SelectionVectorView sel_view(&sel);
+    size_t dec_count = 0;
+    while (bd->HasNext()) {
+      size_t n = std::min(num_rows - dec_count, static_cast<size_t>(rng.Uniform(100) + 1));
+      ColumnDataView dst_data(&dst_block, dec_count);
+      ASSERT_OK(bd->CopyNextAndEval(&n, &ctx, &sel_view, &dst_data));
+      ASSERT_GT(n, 0);
+      dec_count += n;
+      sel_view.Advance(n);
+    }
+    ASSERT_EQ(num_rows, dec_count);
+    if (ctx.DecoderEvalNotSupported()) {
+      pred.Evaluate(dst_block, &sel);
+    }
+
+    const DataType physical_type = GetTypeInfo(Type)->physical_type();
+    for (size_t i = 0; i < num_rows; i++) {
+      bool expected = initially_selected[i] && pred.EvaluateCell(physical_type, &inserted[i]);
+      ASSERT_EQ(expected, sel.IsRowSelected(i)) << "row " << i;
+      if (expected) {
+        ASSERT_TRUE(inserted[i] == decoded[i]) << "row " << i;
+      }
+    }
+  }
+
+  template <DataType IntType>
+  void TestIntBlockDecoderEval(EncodingType encoding) {
+    typedef typename DataTypeTraits<IntType>::cpp_type CppType;
+
+    // Runs of identical values exercise the per-run evaluation of RLE blocks.
+    vector<CppType> to_insert;
+    for (int i = 0; i < 10000; i++) {
+      to_insert.push_back(static_cast<CppType>((i / 7) % 10));
+    }
+    auto ibb = CreateBlockBuilderOrDie(IntType, encoding);
+    ibb->Add(reinterpret_cast<const uint8_t *>(&to_insert[0]), to_insert.size());
+    scoped_refptr<BlockHandle> block = FinishAndMakeContiguous(ibb.get(), 12345);
+
+    ColumnSchema col("c", IntType);
+    const CppType lower = 3;
+    const CppType upper = 6;
+    const CppType missing = 42;
+    for (const auto& pred : { ColumnPredicate::Range(col, &lower, &upper),
+                              ColumnPredicate::Equality(col, &lower),
+                              ColumnPredicate::Equality(col, &missing) }) {
+      NO_FATALS(VerifyDecoderEval<IntType>(encoding, block, to_insert, pred));
+    }
+  }
+
+  void TestBinaryBlockDecoderEval(EncodingType encoding) {
+    // Repeat each value a few times so that prefix blocks contain entries
+    // which share their whole prefix with the previous entry.
+    auto formatter = [](int i) { return StringPrintf("hello %04d", i / 3); };
+    const int kNumItems = 10000;
+    auto sbb = CreateBlockBuilderOrDie(BINARY, encoding);
+    scoped_refptr<BlockHandle> block = CreateBinaryBlock(sbb.get(), kNumItems, formatter);
+
+    vector<string> strings;
+    for (int i = 0; i < kNumItems; i++) {
+      strings.emplace_back(formatter(i));
+    }
+    vector<Slice> inserted(strings.begin(), strings.end());
+
+    ColumnSchema col("c", STRING);
+    const Slice lower("hello 0100");
+    const Slice upper("hello 0200");
+    const Slice missing("goodbye");
+    for (const auto& pred : { ColumnPredicate::Range(col, &lower, &upper),
+                              ColumnPredicate::Equality(col, &lower),
+                              ColumnPredicate::Equality(col, &missing) }) {
+      NO_FATALS(VerifyDecoderEval<BINARY>(encoding, block, inserted, pred));
+    }
+  }
+
   // Test encoding and decoding BOOL datatypes
   void TestBoolBlockRoundTrip(EncodingType encoding) {
     const uint32_t kOrdinalPosBase = 12345;
@@ -803,6 +919,201 @@ TEST_F(TestEncoding, TestRleIntBlockEncoder) {
   ASSERT_EQ(14UL, block->data().size());
 }
 
+// Test that the frame-of-reference encoding picks the delta representation for
+// steadily increasing values, and the plain offsets when that's narrower.
+TEST_F(TestEncoding, TestFrameOfReferenceBlockEncoder) {
+  constexpr int kNumInts = 10000;
+  constexpr size_t kHeaderSize = FrameOfReferenceBlockBuilder<INT64>::kHeaderSize;
+  auto ibb = CreateBlockBuilderOrDie(INT64, FRAME_OF_REFERENCE);
+
+  // Timestamp-like values: a large base, increasing by 1000 +/- 7 each row.
+  // The deltas fit in 4 bits, while the range of the values needs 24 bits.
+  Random rand(SeedRandom());
+  vector<int64_t> ints;
+  int64_t val = 1600000000000000L;
+  for (int i = 0; i < kNumInts; i++) {
+    ints.push_back(val);
+    val += 1000 + static_cast<int64_t>(rand.Uniform(15)) - 7;
+  }
+  ibb->Add(reinterpret_cast<const uint8_t *>(ints.data()), kNumInts);
+  scoped_refptr<BlockHandle> block = FinishAndMakeContiguous(ibb.get(), 12345);
+  LOG(INFO) << "FOR Encoded size for 10k increasing ints: " << block->data().size();
+  ASSERT_EQ(kHeaderSize + ((kNumInts - 1) * 4 + 7) / 8 + 8, block->data().size());
+
+  auto ibd = CreateBlockDecoderOrDie(INT64, FRAME_OF_REFERENCE, std::move(block));
+  ASSERT_OK(ibd->ParseHeader());
+  vector<int64_t> decoded(kNumInts);
+  ColumnBlock cb(GetTypeInfo(INT64), nullptr, &decoded[0], kNumInts, &memory_);
+  ColumnDataView cdv(&cb);
+  size_t n = kNumInts;
+  ASSERT_OK(ibd->CopyNextValues(&n, &cdv));
+  ASSERT_EQ(kNumInts, n);
+  ASSERT_EQ(ints, decoded);
+
+  // Alternating values have wide deltas but a narrow range, so they should be
+  // stored as offsets from the minimum, using a single bit each.
+  ibb->Reset();
+  for (int i = 0; i < kNumInts; i++) {
+    ints[i] = -1000000 + (i % 2);
+  }
+  ibb->Add(reinterpret_cast<const uint8_t *>(ints.data()), kNumInts);
+  block = FinishAndMakeContiguous(ibb.get(), 12345);
+  ASSERT_EQ(kHeaderSize + (kNumInts + 7) / 8 + 8, block->data().size());
+
+  // Identical values don't need any bits at all.
+  ibb->Reset();
+  ints.assign(100, 42);
+  ibb->Add(reinterpret_cast<const uint8_t *>(ints.data()), ints.size());
+  block = FinishAndMakeContiguous(ibb.get(), 12345);
+  ASSERT_EQ(kHeaderSize + 8, block->data().size());
+}
+
+TEST_F(TestEncoding, TestFrameOfReferenceEmptyBlockEncodeDecode) {
+  TestEmptyBlockEncodeDecode(INT64, FRAME_OF_REFERENCE);
+}
+
+TEST_F(TestEncoding, TestXorFloatBlockEncoder) {
+  const int kSize = 10000;
+  Random rng(SeedRandom());
+  vector<float> floats(kSize);
+  for (int i = 0; i < kSize; i++) {
+    floats[i] = static_cast<float>(rng.Next()) + static_cast<float>(rng.Next()) / INT_MAX;
+  }
+  TestEncodeDecodeTemplateBlockEncoder<FLOAT>(floats.data(), kSize, XOR_ENCODING);
+}
+
+TEST_F(TestEncoding, TestXorDoubleBlockEncoder) {
+  const int kSize = 10000;
+  Random rng(SeedRandom());
+  vector<double> doubles(kSize);
+  for (int i = 0; i < kSize; i++) {
+    doubles[i] = static_cast<double>(rng.Next64()) + static_cast<double>(rng.Next()) / INT_MAX;
+  }
+  TestEncodeDecodeTemplateBlockEncoder<DOUBLE>(doubles.data(), kSize, XOR_ENCODING);
+}
+
+// Test that metric-like values take a fraction of their plain size, and that
+// values which don't compare equal to themselves still round-trip bit for bit.
+TEST_F(TestEncoding, TestXorDoubleBlockSizeAndSpecialValues) {
+  constexpr int kNumDoubles = 10000;
+  constexpr size_t kHeaderSize = XorBlockBuilder<DOUBLE>::kHeaderSize;
+  auto bb = CreateBlockBuilderOrDie(DOUBLE, XOR_ENCODING);
+
+  // A gauge which changes every 10 readings among a few nearby values.
+  Random rand(SeedRandom());
+  vector<double> doubles;
+  double val = 0;
+  for (int i = 0; i < kNumDoubles; i++) {
+    if (i % 10 == 0) {
+      val = 100 + rand.Uniform(4) * 0.5;
+    }
+    doubles.push_back(val);
+  }
+  bb->Add(reinterpret_cast<const uint8_t*>(doubles.data()), kNumDoubles);
+  scoped_refptr<BlockHandle> block = FinishAndMakeContiguous(bb.get(), 12345);
+  LOG(INFO) << "XOR encoded size for 10k gauge doubles: " << block->data().size();
+  ASSERT_LT(block->data().size(), kNumDoubles * sizeof(double) / 8);
+
+  // Identical values take a single bit each after the first one.
+  bb->Reset();
+  doubles.assign(100, 42.0);
+  bb->Add(reinterpret_cast<const uint8_t*>(doubles.data()), doubles.size());
+  block = FinishAndMakeContiguous(bb.get(), 12345);
+  ASSERT_EQ(kHeaderSize + 8 + (99 + 7) / 8 + 8, block->data().size());
+
+  bb->Reset();
+  doubles = { 1.0, std::numeric_limits<double>::quiet_NaN(),
+              -std::numeric_limits<double>::infinity(), -0.0, 0.0,
+              std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::max() };
+  bb->Add(reinterpret_cast<const uint8_t*>(doubles.data()), doubles.size());
+  block = FinishAndMakeContiguous(bb.get(), 12345);
+  const Slice encoded = block->data();
+  auto bd = CreateBlockDecoderOrDie(DOUBLE, XOR_ENCODING, std::move(block));
+  ASSERT_OK(bd->ParseHeader());
+  vector<double> decoded(doubles.size());
+  ColumnBlock cb(GetTypeInfo(DOUBLE), nullptr, &decoded[0], decoded.size(), &memory_);
+  ColumnDataView cdv(&cb);
+  size_t n = decoded.size();
+  ASSERT_OK(bd->CopyNextValues(&n, &cdv));
+  ASSERT_EQ(doubles.size(), n);
+  ASSERT_EQ(0, memcmp(doubles.data(), decoded.data(), n * sizeof(double)));
+
+  // A block cut short is reported as corrupt rather than read past its end.
+  const uint8_t kPadding[xor_internal::kPaddingBytes] = {};
+  faststring truncated;
+  truncated.append(encoded.data(), encoded.size() - sizeof(kPadding) - 2);
+  truncated.append(kPadding, sizeof(kPadding));
+  XorBlockDecoder<DOUBLE> truncated_bd(MakeContiguous({ Slice(truncated) }));
+  ASSERT_TRUE(truncated_bd.ParseHeader().IsCorruption());
+}
+
+TEST_F(TestEncoding, TestXorEmptyBlockEncodeDecode) {
+  TestEmptyBlockEncodeDecode(FLOAT, XOR_ENCODING);
+  TestEmptyBlockEncodeDecode(DOUBLE, XOR_ENCODING);
+}
+
+// Test that the adaptive encoding keeps whichever candidate encoding produces
+// the smallest block, and that blocks round-trip whatever was picked.
+TEST_F(TestEncoding, TestAdaptiveBlockEncoderPicksSmallest) {
+  constexpr int kNumInts = 10000;
+  auto bb = CreateBlockBuilderOrDie(INT64, ADAPTIVE_ENCODING);
+  auto* abb = down_cast<AdaptiveBlockBuilder*>(bb.get());
+
+  auto encode_and_check = [&](const vector<int64_t>& ints, EncodingType expected) {
+    SCOPED_TRACE(EncodingType_Name(expected));
+    bb->Reset();
+    ASSERT_EQ(ints.size(),
+              static_cast<size_t>(bb->Add(reinterpret_cast<const uint8_t*>(ints.data()),
+                                          ints.size())));
+    scoped_refptr<BlockHandle> block = FinishAndMakeContiguous(bb.get(), 12345);
+    ASSERT_EQ(expected, abb->chosen_encoding());
+
+    // The block is no larger than the chosen encoding on its own would be.
+    auto single = CreateBlockBuilderOrDie(INT64, expected);
+    single->Add(reinterpret_cast<const uint8_t*>(ints.data()), ints.size());
+    scoped_refptr<BlockHandle> single_block = FinishAndMakeContiguous(single.get(), 12345);
+    ASSERT_EQ(single_block->data().size() + AdaptiveBlockBuilder::kHeaderSize,
+              block->data().size());
+
+    auto bd = CreateBlockDecoderOrDie(INT64, ADAPTIVE_ENCODING, std::move(block));
+    ASSERT_OK(bd->ParseHeader());
+    ASSERT_EQ(12345U, bd->GetFirstRowId());
+    vector<int64_t> decoded(ints.size());
+    ColumnBlock cb(GetTypeInfo(INT64), nullptr, &decoded[0], ints.size(), &memory_);
+    ColumnDataView cdv(&cb);
+    size_t n = ints.size();
+    ASSERT_OK(bd->CopyNextValues(&n, &cdv));
+    ASSERT_EQ(ints.size(), n);
+    ASSERT_EQ(ints, decoded);
+  };
+
+  // Long runs of repeated values.
+  vector<int64_t> ints;
+  for (int i = 0; i < kNumInts; i++) {
+    ints.push_back(i / 1000);
+  }
+  NO_FATALS(encode_and_check(ints, RLE));
+
+  // Timestamp-like values, increasing by 1000 +/- 7 each row.
+  Random rand(SeedRandom());
+  ints.clear();
+  int64_t val = 1600000000000000L;
+  for (int i = 0; i < kNumInts; i++) {
+    ints.push_back(val);
+    val += 1000 + static_cast<int64_t>(rand.Uniform(15)) - 7;
+  }
+  NO_FATALS(encode_and_check(ints, FRAME_OF_REFERENCE));
+}
+
+TEST_F(TestEncoding, TestAdaptiveEmptyBlockEncodeDecode) {
+  TestEmptyBlockEncodeDecode(INT64, ADAPTIVE_ENCODING);
+  TestEmptyBlockEncodeDecode(BINARY, ADAPTIVE_ENCODING);
+}
+
+TEST_F(TestEncoding, TestAdaptiveBitMapRoundTrip) {
+  TestBoolBlockRoundTrip(ADAPTIVE_ENCODING);
+}
+
 TEST_F(TestEncoding, TestPlainBitMapRoundTrip) {
   TestBoolBlockRoundTrip(PLAIN_ENCODING);
 }
@@ -841,6 +1152,30 @@ TEST_F(TestEncoding, TestBinaryPlainBlockBuilderRoundTrip) {
   TestBinaryBlockRoundTrip(PLAIN_ENCODING);
 }
 
+// Test that decoded plain-encoded strings point into the block itself rather
+// than into copies in the destination's arena.
+TEST_F(TestEncoding, TestBinaryPlainBlockDecodeIsZeroCopy) {
+  constexpr int kCount = 1000;
+  auto sbb = CreateBlockBuilderOrDie(BINARY, PLAIN_ENCODING);
+  scoped_refptr<BlockHandle> block = CreateBinaryBlock(
+      sbb.get(), kCount, [](int i) { return StringPrintf("payload-%d", i); });
+  const Slice block_data = block->data();
+
+  auto sbd = CreateBlockDecoderOrDie(BINARY, PLAIN_ENCODING, block);
+  ASSERT_OK(sbd->ParseHeader());
+  vector<Slice> decoded(kCount);
+  ColumnBlock cb(GetTypeInfo(BINARY), nullptr, &decoded[0], kCount, &memory_);
+  ColumnDataView cdv(&cb);
+  size_t n = kCount;
+  ASSERT_OK(sbd->CopyNextValues(&n, &cdv));
+  ASSERT_EQ(kCount, n);
+  for (int i = 0; i < kCount; i++) {
+    ASSERT_EQ(StringPrintf("payload-%d", i), decoded[i].ToString());
+    ASSERT_GE(decoded[i].data(), block_data.data());
+    ASSERT_LE(decoded[i].data() + decoded[i].size(), block_data.data() + block_data.size());
+  }
+}
+
 // Test empty block encode/decode
 TEST_F(TestEncoding, TestBinaryPlainEmptyBlockEncodeDecode) {
   TestEmptyBlockEncodeDecode(BINARY, PLAIN_ENCODING);
@@ -859,6 +1194,23 @@ TEST_F(TestEncoding, TestBinaryPrefixBlockBuilderTruncation) {
   TestBinaryBlockTruncation<BinaryPrefixBlockDecoder>(PREFIX_ENCODING);
 }
 
+// Test evaluating predicates on binary blocks while decoding them.
+TEST_F(TestEncoding, TestBinaryPrefixBlockDecoderEval) {
+  TestBinaryBlockDecoderEval(PREFIX_ENCODING);
+}
+
+TEST_F(TestEncoding, TestBinaryPlainBlockDecoderEval) {
+  TestBinaryBlockDecoderEval(PLAIN_ENCODING);
+}
+
+TEST_F(TestEncoding, TestBinaryAdaptiveBlockBuilderRoundTrip) {
+  TestBinaryBlockRoundTrip(ADAPTIVE_ENCODING);
+}
+
+TEST_F(TestEncoding, TestBinaryAdaptiveBlockDecoderEval) {
+  TestBinaryBlockDecoderEval(ADAPTIVE_ENCODING);
+}
+
 class IntEncodingTest : public TestEncoding, public ::testing::WithParamInterface<EncodingType> {
  public:
   template <DataType IntType>
@@ -877,9 +1229,15 @@ class IntEncodingTest : public TestEncoding, public ::testing::WithParamInterfac
   void DoIntRoundTripTest() {
     TestIntBlockRoundTrip<IntType>(GetParam());
   }
+
+  template <DataType IntType>
+  void DoIntDecoderEvalTest() {
+    TestIntBlockDecoderEval<IntType>(GetParam());
+  }
 };
 INSTANTIATE_TEST_SUITE_P(Encodings, IntEncodingTest,
-                         ::testing::Values(RLE, PLAIN_ENCODING, BIT_SHUFFLE));
+                         ::testing::Values(RLE, PLAIN_ENCODING, BIT_SHUFFLE,
+                                           FRAME_OF_REFERENCE, ADAPTIVE_ENCODING));
 
 TEST_P(IntEncodingTest, TestSeekAllTypes) {
   this->template DoIntSeekTest<UINT8>(100, 1000, true);
@@ -920,6 +1278,17 @@ TEST_P(IntEncodingTest, TestRoundTrip) {
   // this->template DoIntRoundTripTest<INT128>();
 }
 
+TEST_P(IntEncodingTest, TestDecoderEvalAllTypes) {
+  this->template DoIntDecoderEvalTest<UINT8>();
+  this->template DoIntDecoderEvalTest<INT8>();
+  this->template DoIntDecoderEvalTest<UINT16>();
+  this->template DoIntDecoderEvalTest<INT16>();
+  this->template DoIntDecoderEvalTest<UINT32>();
+  this->template DoIntDecoderEvalTest<INT32>();
+  this->template DoIntDecoderEvalTest<UINT64>();
+  this->template DoIntDecoderEvalTest<INT64>();
+}
+
 #ifdef NDEBUG
 TEST_P(IntEncodingTest, IntSeekBenchmark) {
   this->template DoIntSeekTest<INT32>(32768, 10000, false);
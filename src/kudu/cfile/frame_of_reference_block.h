@@ -0,0 +1,466 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/cfile/block_handle.h"
+#include "kudu/cfile/cfile_util.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowid.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace cfile {
+
+struct WriterOptions;
+
+// Helpers shared by the frame-of-reference builder and decoder.
+namespace for_internal {
+
+// The header is followed by the bit-packed values, which are in turn followed
+// by this many bytes of zero padding. The padding allows both the encoder and
+// the decoder to always access the packed values with 64-bit loads and
+// stores, regardless of their bit width.
+constexpr int kPaddingBytes = sizeof(uint64_t);
+
+// Set in the <flags> header field if the block stores the deltas between
+// consecutive values rather than the values themselves.
+constexpr uint8_t kDeltaFlag = 1;
+
+// Any width in (56, 64) is rounded up to 64: a 64-bit load starting at the
+// byte containing the first bit of a value can then always reach its last bit.
+inline int RoundUpBitWidth(int bit_width) {
+  return bit_width > 56 ? 64 : bit_width;
+}
+
+// Return the number of bits needed to represent 'val'.
+inline int BitWidth(uint64_t val) {
+  return val == 0 ? 0 : 64 - __builtin_clzll(val);
+}
+
+// Return the number of bytes taken by 'n' values packed with 'bit_width' bits
+// each, not including the trailing padding.
+inline size_t PackedSize(size_t n, int bit_width) {
+  return (n * bit_width + 7) / 8;
+}
+
+// Pack the 'n' values in 'vals' with 'bit_width' bits each into 'dst', which
+// must have room for PackedSize() plus kPaddingBytes bytes, all zeroed.
+inline void Pack(const uint64_t* vals, size_t n, int bit_width, uint8_t* dst) {
+  if (bit_width == 0) return;
+  uint64_t bit_pos = 0;
+  for (size_t i = 0; i < n; i++, bit_pos += bit_width) {
+    uint8_t* p = dst + (bit_pos >> 3);
+    UnalignedStore<uint64_t>(p, UnalignedLoad<uint64_t>(p) | (vals[i] << (bit_pos & 7)));
+  }
+}
+
+// Unpack 'n' values of 'bit_width' bits each from 'src', adding 'reference'
+// to each one and storing the results in 'dst'.
+//
+// There are no branches or loop-carried dependencies here, so the compiler is
+// able to unroll and vectorize this loop.
+template<typename UnsignedType>
+void Unpack(const uint8_t* __restrict__ src,
+            size_t n,
+            int bit_width,
+            UnsignedType reference,
+            UnsignedType* __restrict__ dst) {
+  const uint64_t mask = bit_width == 64 ? ~0ULL : (1ULL << bit_width) - 1;
+  for (size_t i = 0; i < n; i++) {
+    const uint64_t bit_pos = i * bit_width;
+    const uint64_t word = UnalignedLoad<uint64_t>(src + (bit_pos >> 3));
+    dst[i] = static_cast<UnsignedType>(reference + ((word >> (bit_pos & 7)) & mask));
+  }
+}
+
+} // namespace for_internal
+
+// FrameOfReferenceBlockBuilder encodes integer blocks by subtracting the
+// minimum value of the block (the "frame of reference") from each value and
+// bit-packing the results using as few bits as the range of the block needs.
+//
+// For columns whose values are (nearly) sorted, such as timestamps and
+// auto-incrementing ids, it's usually cheaper to store the differences between
+// consecutive values instead. The builder computes the packed width for both
+// representations and picks the narrower one on a per-block basis.
+//
+// The block format is as follows:
+//
+// 1. Header: (26 bytes total)
+//
+//    <first_ordinal> [32-bit]
+//      The ordinal offset of the first element in the block.
+//
+//    <num_elements> [32-bit]
+//      The number of elements encoded in the block.
+//
+//    <bit_width> [8-bit]
+//      The number of bits used to store each packed value. This is at most
+//      56 or exactly 64.
+//
+//    <flags> [8-bit]
+//      If kDeltaFlag is set, the packed values are the differences between
+//      consecutive elements, and the first element is stored in the header.
+//
+//    <reference> [64-bit]
+//      The value added back to each unpacked value: the minimum element, or
+//      the minimum delta if kDeltaFlag is set.
+//
+//    <first_value> [64-bit]
+//      The first element of the block. Only meaningful if kDeltaFlag is set.
+//
+//   NOTE: all on-disk ints are encoded little-endian. Values are stored in
+//   the unsigned representation of their type, and all arithmetic on them
+//   wraps around at the width of the type.
+//
+// 2. Element data
+//
+//    The packed values, <bit_width> bits each, using the LSB-first bit order,
+//    followed by kPaddingBytes bytes of zeroes. With kDeltaFlag, there is one
+//    less packed value than <num_elements>.
+//
+template<DataType IntType>
+class FrameOfReferenceBlockBuilder final : public BlockBuilder {
+ public:
+  explicit FrameOfReferenceBlockBuilder(const WriterOptions* options)
+      : count_(0),
+        options_(options) {
+    Reset();
+  }
+
+  void Reset() override {
+    auto block_size = options_->storage_attributes.cfile_block_size;
+    count_ = 0;
+    data_.clear();
+    data_.reserve(block_size);
+    buffer_.clear();
+    finished_ = false;
+    rem_elem_capacity_ = block_size / kCppTypeSize;
+  }
+
+  bool IsBlockFull() const override {
+    return rem_elem_capacity_ == 0;
+  }
+
+  int Add(const uint8_t* vals_void, size_t count) override {
+    DCHECK(!finished_);
+    int to_add = std::min<int>(rem_elem_capacity_, count);
+    data_.append(vals_void, to_add * kCppTypeSize);
+    count_ += to_add;
+    rem_elem_capacity_ -= to_add;
+    return to_add;
+  }
+
+  size_t Count() const override {
+    return count_;
+  }
+
+  Status GetFirstKey(void* key) const override {
+    DCHECK(finished_);
+    if (count_ == 0) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &first_key_, kCppTypeSize);
+    return Status::OK();
+  }
+
+  Status GetLastKey(void* key) const override {
+    DCHECK(finished_);
+    if (count_ == 0) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &last_key_, kCppTypeSize);
+    return Status::OK();
+  }
+
+  void Finish(rowid_t ordinal_pos, std::vector<Slice>* slices) override {
+    using for_internal::BitWidth;
+    using for_internal::RoundUpBitWidth;
+
+    if (count_ > 0) {
+      first_key_ = cell(0);
+      last_key_ = cell(count_ - 1);
+    }
+
+    // Compute the frame of reference for the values themselves...
+    UnsignedType min_val = 0;
+    UnsignedType max_val = 0;
+    if (count_ > 0) {
+      CppType min_signed = cell(0);
+      CppType max_signed = cell(0);
+      for (uint32_t i = 1; i < count_; i++) {
+        min_signed = std::min(min_signed, cell(i));
+        max_signed = std::max(max_signed, cell(i));
+      }
+      min_val = static_cast<UnsignedType>(min_signed);
+      max_val = static_cast<UnsignedType>(max_signed);
+    }
+    const int for_width = RoundUpBitWidth(
+        BitWidth(static_cast<UnsignedType>(max_val - min_val)));
+
+    // ... and for the deltas between consecutive values.
+    SignedType min_delta = 0;
+    SignedType max_delta = 0;
+    for (uint32_t i = 1; i < count_; i++) {
+      SignedType d = delta(i);
+      if (i == 1 || d < min_delta) min_delta = d;
+      if (i == 1 || d > max_delta) max_delta = d;
+    }
+    const int delta_width = RoundUpBitWidth(BitWidth(static_cast<UnsignedType>(
+        static_cast<UnsignedType>(max_delta) - static_cast<UnsignedType>(min_delta))));
+
+    const bool use_delta = count_ > 1 && delta_width < for_width;
+    const int bit_width = use_delta ? delta_width : for_width;
+    const UnsignedType reference = use_delta ? static_cast<UnsignedType>(min_delta) : min_val;
+    const size_t num_packed = use_delta ? count_ - 1 : count_;
+
+    std::vector<uint64_t> offsets(num_packed);
+    for (size_t i = 0; i < num_packed; i++) {
+      UnsignedType v = use_delta ? static_cast<UnsignedType>(delta(i + 1))
+                                 : static_cast<UnsignedType>(cell(i));
+      offsets[i] = static_cast<UnsignedType>(v - reference);
+    }
+
+    const size_t packed_size = for_internal::PackedSize(num_packed, bit_width);
+    buffer_.resize(kHeaderSize + packed_size + for_internal::kPaddingBytes);
+    memset(&buffer_[kHeaderSize], 0, packed_size + for_internal::kPaddingBytes);
+    InlineEncodeFixed32(&buffer_[0], ordinal_pos);
+    InlineEncodeFixed32(&buffer_[4], count_);
+    buffer_[8] = bit_width;
+    buffer_[9] = use_delta ? for_internal::kDeltaFlag : 0;
+    InlineEncodeFixed64(&buffer_[10], reference);
+    InlineEncodeFixed64(&buffer_[18],
+                        count_ > 0 ? static_cast<UnsignedType>(cell(0)) : 0);
+    for_internal::Pack(offsets.data(), num_packed, bit_width, &buffer_[kHeaderSize]);
+
+    finished_ = true;
+    *slices = { Slice(buffer_) };
+  }
+
+  // Length of the header.
+  static constexpr size_t kHeaderSize = 26;
+
+ private:
+  typedef typename TypeTraits<IntType>::cpp_type CppType;
+  typedef typename std::make_unsigned<CppType>::type UnsignedType;
+  typedef typename std::make_signed<CppType>::type SignedType;
+
+  enum {
+    kCppTypeSize = TypeTraits<IntType>::size
+  };
+
+  CppType cell(int idx) const {
+    DCHECK_GE(idx, 0);
+    return UnalignedLoad<CppType>(&data_[idx * kCppTypeSize]);
+  }
+
+  // The (wrapped-around) difference between the values at 'idx' and 'idx - 1',
+  // interpreted as a signed number.
+  SignedType delta(int idx) const {
+    return static_cast<SignedType>(static_cast<UnsignedType>(
+        static_cast<UnsignedType>(cell(idx)) - static_cast<UnsignedType>(cell(idx - 1))));
+  }
+
+  faststring data_;
+  faststring buffer_;
+  uint32_t count_;
+  int rem_elem_capacity_;
+  bool finished_;
+  CppType first_key_;
+  CppType last_key_;
+  const WriterOptions* options_;
+};
+
+// Decoder for blocks written by FrameOfReferenceBlockBuilder. The whole block
+// is unpacked when the header is parsed, after which seeks and copies operate
+// on the plain values.
+template<DataType IntType>
+class FrameOfReferenceBlockDecoder final : public BlockDecoder {
+ public:
+  explicit FrameOfReferenceBlockDecoder(scoped_refptr<BlockHandle> block)
+      : block_(std::move(block)),
+        data_(block_->data()),
+        parsed_(false),
+        ordinal_pos_base_(0),
+        num_elems_(0),
+        cur_idx_(0) {
+  }
+
+  Status ParseHeader() override {
+    CHECK(!parsed_);
+    const size_t header_size = FrameOfReferenceBlockBuilder<IntType>::kHeaderSize;
+    if (data_.size() < header_size) {
+      return Status::Corruption(strings::Substitute(
+          "not enough bytes for header: frame-of-reference block header "
+          "size ($0) less than expected header length ($1)",
+          data_.size(), header_size));
+    }
+
+    ordinal_pos_base_ = DecodeFixed32(&data_[0]);
+    num_elems_ = DecodeFixed32(&data_[4]);
+    const int bit_width = data_[8];
+    const bool use_delta = data_[9] & for_internal::kDeltaFlag;
+    const UnsignedType reference = static_cast<UnsignedType>(DecodeFixed64(&data_[10]));
+    const UnsignedType first_value = static_cast<UnsignedType>(DecodeFixed64(&data_[18]));
+
+    if (bit_width > kCppTypeSize * 8 || (bit_width > 56 && bit_width != 64)) {
+      return Status::Corruption(strings::Substitute("invalid bit width: $0", bit_width));
+    }
+    if (PREDICT_FALSE(use_delta && num_elems_ == 0)) {
+      return Status::Corruption("delta-encoded block with no elements");
+    }
+    const size_t num_packed = use_delta ? num_elems_ - 1 : num_elems_;
+    const size_t expected_size = header_size +
+        for_internal::PackedSize(num_packed, bit_width) + for_internal::kPaddingBytes;
+    if (data_.size() != expected_size) {
+      return Status::Corruption(strings::Substitute(
+          "frame-of-reference block size ($0) does not match expected size ($1)",
+          data_.size(), expected_size));
+    }
+
+    decoded_.resize(num_elems_);
+    if (num_elems_ > 0) {
+      const uint8_t* packed = &data_[header_size];
+      if (use_delta) {
+        decoded_[0] = first_value;
+        for_internal::Unpack<UnsignedType>(packed, num_packed, bit_width, reference,
+                                           &decoded_[1]);
+        for (size_t i = 1; i < num_elems_; i++) {
+          decoded_[i] = static_cast<UnsignedType>(decoded_[i] + decoded_[i - 1]);
+        }
+      } else {
+        for_internal::Unpack<UnsignedType>(packed, num_packed, bit_width, reference,
+                                           &decoded_[0]);
+      }
+    }
+
+    parsed_ = true;
+    return Status::OK();
+  }
+
+  void SeekToPositionInBlock(uint pos) override {
+    CHECK(parsed_) << "Must call ParseHeader()";
+    DCHECK_LE(pos, num_elems_);
+    cur_idx_ = pos;
+  }
+
+  Status SeekAtOrAfterValue(const void* value_void, bool* exact) override {
+    DCHECK(parsed_);
+    const CppType target = UnalignedLoad<CppType>(value_void);
+    uint32_t left = 0;
+    uint32_t right = num_elems_;
+    while (left != right) {
+      uint32_t mid = left + (right - left) / 2;
+      CppType mid_key = value_at(mid);
+      if (mid_key == target) {
+        cur_idx_ = mid;
+        *exact = true;
+        return Status::OK();
+      }
+      if (mid_key > target) {
+        right = mid;
+      } else {
+        left = mid + 1;
+      }
+    }
+
+    *exact = false;
+    cur_idx_ = left;
+    if (cur_idx_ == num_elems_) {
+      return Status::NotFound("after last key in block");
+    }
+    return Status::OK();
+  }
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) override {
+    DCHECK(parsed_);
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+    DCHECK_LE(*n, dst->nrows());
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    memcpy(dst->data(), &decoded_[cur_idx_], max_fetch * kCppTypeSize);
+    *n = max_fetch;
+    cur_idx_ += max_fetch;
+    return Status::OK();
+  }
+
+  bool HasNext() const override {
+    return cur_idx_ < num_elems_;
+  }
+
+  size_t Count() const override {
+    return num_elems_;
+  }
+
+  size_t GetCurrentIndex() const override {
+    DCHECK(parsed_) << "must parse header first";
+    return cur_idx_;
+  }
+
+  rowid_t GetFirstRowId() const override {
+    return ordinal_pos_base_;
+  }
+
+ private:
+  typedef typename TypeTraits<IntType>::cpp_type CppType;
+  typedef typename std::make_unsigned<CppType>::type UnsignedType;
+
+  enum {
+    kCppTypeSize = TypeTraits<IntType>::size
+  };
+
+  CppType value_at(size_t idx) const {
+    return static_cast<CppType>(decoded_[idx]);
+  }
+
+  scoped_refptr<BlockHandle> block_;
+  Slice data_;
+  bool parsed_;
+
+  rowid_t ordinal_pos_base_;
+  uint32_t num_elems_;
+  size_t cur_idx_;
+
+  // The values of the block, in their unsigned representation.
+  std::vector<UnsignedType> decoded_;
+};
+
+} // namespace cfile
+} // namespace kudu
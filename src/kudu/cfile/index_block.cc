@@ -17,6 +17,7 @@
 
 #include "kudu/cfile/index_block.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <string>
@@ -30,6 +31,8 @@
 #include "kudu/util/pb_util.h"
 #include "kudu/util/protobuf_util.h"
 
+using std::vector;
+
 namespace kudu {
 namespace cfile {
 
@@ -311,6 +314,19 @@ const BlockPointer &IndexBlockIterator::GetCurrentBlockPointer() const {
   return cur_ptr_;
 }
 
+Status IndexBlockIterator::GetNextBlockPointers(size_t max,
+                                                vector<BlockPointer>* ptrs) const {
+  CHECK(seeked_) << "not seeked";
+  const size_t end = std::min(reader_->Count(), cur_idx_ + 1 + max);
+  for (size_t idx = cur_idx_ + 1; idx < end; idx++) {
+    Slice key;
+    BlockPointer ptr;
+    RETURN_NOT_OK(reader_->ReadEntry(idx, &key, &ptr));
+    ptrs->emplace_back(ptr);
+  }
+  return Status::OK();
+}
+
 const Slice IndexBlockIterator::GetCurrentKey() const {
   CHECK(seeked_) << "not seeked";
   return cur_key_;
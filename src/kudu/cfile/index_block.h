@@ -169,6 +169,10 @@ class IndexBlockIterator {
 
   const Slice GetCurrentKey() const;
 
+  // Appends the block pointers of up to 'max' entries following the current
+  // one to 'ptrs', without moving the iterator.
+  Status GetNextBlockPointers(size_t max, std::vector<BlockPointer>* ptrs) const;
+
  private:
   const IndexBlockReader *reader_;
   size_t cur_idx_;
@@ -25,6 +25,7 @@
 
 #include <glog/logging.h>
 
+#include "kudu/cfile/block_cache.h"
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/block_pointer.h"
 #include "kudu/cfile/cfile.pb.h"
@@ -257,6 +258,11 @@ const BlockPointer &IndexTreeIterator::GetCurrentBlockPointer() const {
   return seeked_indexes_.back()->iter.GetCurrentBlockPointer();
 }
 
+Status IndexTreeIterator::GetNextBlockPointers(size_t max,
+                                               vector<BlockPointer>* ptrs) const {
+  return seeked_indexes_.back()->iter.GetNextBlockPointers(max, ptrs);
+}
+
 IndexBlockIterator *IndexTreeIterator::BottomIter() {
   return &seeked_indexes_.back()->iter;
 }
@@ -299,7 +305,8 @@ Status IndexTreeIterator::LoadBlock(const BlockPointer &block,
   }
 
   RETURN_NOT_OK(reader_->ReadBlock(io_context_, block,
-                                   CFileReader::CACHE_BLOCK, &seeked->data));
+                                   CFileReader::CACHE_BLOCK, &seeked->data,
+                                   BlockCache::BlockType::INDEX));
   seeked->block_ptr = block;
 
   // Parse the new block.
@@ -93,6 +93,11 @@ class IndexTreeIterator {
   const Slice GetCurrentKey() const;
   const BlockPointer &GetCurrentBlockPointer() const;
 
+  // Appends the block pointers of up to 'max' blocks following the current
+  // one, within the same leaf index block, to 'ptrs'. Doesn't move the
+  // iterator nor read any index block.
+  Status GetNextBlockPointers(size_t max, std::vector<BlockPointer>* ptrs) const;
+
   static IndexTreeIterator* Create(
     const fs::IOContext* io_context,
     const CFileReader* reader,
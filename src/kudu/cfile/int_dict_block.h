@@ -0,0 +1,414 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Dictionary encoding for fixed-width integers. This mirrors the binary
+// dictionary encoding in binary_dict_block.h: there is one dictionary block
+// per cfile, and each data block is a header followed by either
+// bitshuffled codewords (kCodeWordMode) or, once the dictionary is full,
+// the bitshuffled values themselves (kPlainBinaryMode).
+//
+// The dictionary block is a BinaryPlainBlock whose entries are the raw
+// little-endian bytes of each distinct value, so that CFileIterator can load
+// and evaluate predicates against it the same way as for strings.
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/binary_dict_block.h"
+#include "kudu/cfile/binary_plain_block.h"
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/cfile/block_handle.h"
+#include "kudu/cfile/block_pointer.h"
+#include "kudu/cfile/bshuf_block.h"
+#include "kudu/cfile/cfile.pb.h"
+#include "kudu/cfile/cfile_reader.h"
+#include "kudu/cfile/cfile_writer.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowid.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/casts.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/bitmap.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace cfile {
+
+template<DataType Type>
+class IntDictBlockBuilder final : public BlockBuilder {
+ public:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+
+  explicit IntDictBlockBuilder(const WriterOptions* options)
+      : finished_(false),
+        options_(options),
+        dict_block_(options_),
+        mode_(kCodeWordMode),
+        first_key_(0) {
+    data_builder_.reset(new BShufBlockBuilder<UINT32>(options_));
+    Reset();
+  }
+
+  // The current block is full when its data exceeds the block size, or when
+  // the dictionary does while still in codeword mode. In the latter case all
+  // subsequent blocks store their values directly.
+  bool IsBlockFull() const override {
+    if (data_builder_->IsBlockFull()) return true;
+    if (dict_block_.IsBlockFull() && (mode_ == kCodeWordMode)) return true;
+    return false;
+  }
+
+  Status AppendExtraInfo(CFileWriter* c_writer, CFileFooterPB* footer) override {
+    std::vector<Slice> dict_v;
+    dict_block_.Finish(0, &dict_v);
+
+    BlockPointer ptr;
+    Status s = c_writer->AppendDictBlock(std::move(dict_v), &ptr, "Append dictionary block");
+    if (!s.ok()) {
+      LOG(WARNING) << "Unable to append block to file: " << s.ToString();
+      return s;
+    }
+    ptr.CopyToPB(footer->mutable_dict_block_ptr());
+    return Status::OK();
+  }
+
+  int Add(const uint8_t* vals, size_t count) override {
+    if (mode_ != kCodeWordMode) {
+      DCHECK_EQ(mode_, kPlainBinaryMode);
+      return data_builder_->Add(vals, count);
+    }
+    DCHECK(!finished_);
+    DCHECK_GT(count, 0);
+
+    const CppType* src = reinterpret_cast<const CppType*>(vals);
+    if (data_builder_->Count() == 0) {
+      first_key_ = src[0];
+    }
+    size_t i;
+    for (i = 0; i < count; i++) {
+      uint32_t codeword;
+      auto it = dictionary_.find(src[i]);
+      if (PREDICT_TRUE(it != dictionary_.end())) {
+        codeword = it->second;
+      } else if (PREDICT_FALSE(!AddToDict(src[i], &codeword))) {
+        break;
+      }
+      if (PREDICT_FALSE(data_builder_->Add(reinterpret_cast<const uint8_t*>(&codeword), 1) == 0)) {
+        break;
+      }
+    }
+    return i;
+  }
+
+  void Finish(rowid_t ordinal_pos, std::vector<Slice>* slices) override {
+    finished_ = true;
+
+    header_buffer_.resize(sizeof(int32_t));
+    InlineEncodeFixed32(&header_buffer_[0], mode_);
+
+    std::vector<Slice> data_slices;
+    data_builder_->Finish(ordinal_pos, &data_slices);
+    data_slices.insert(data_slices.begin(), Slice(header_buffer_));
+    *slices = std::move(data_slices);
+  }
+
+  void Reset() override {
+    if (mode_ == kCodeWordMode && dict_block_.IsBlockFull()) {
+      mode_ = kPlainBinaryMode;
+      data_builder_.reset(new BShufBlockBuilder<Type>(options_));
+    } else {
+      data_builder_->Reset();
+    }
+    finished_ = false;
+  }
+
+  size_t Count() const override {
+    return data_builder_->Count();
+  }
+
+  Status GetFirstKey(void* key) const override {
+    if (mode_ == kCodeWordMode) {
+      CHECK(finished_);
+      memcpy(key, &first_key_, sizeof(CppType));
+      return Status::OK();
+    }
+    DCHECK_EQ(mode_, kPlainBinaryMode);
+    return data_builder_->GetFirstKey(key);
+  }
+
+  Status GetLastKey(void* key) const override {
+    if (mode_ == kCodeWordMode) {
+      CHECK(finished_);
+      uint32_t last_codeword;
+      RETURN_NOT_OK(data_builder_->GetLastKey(&last_codeword));
+      Slice value;
+      RETURN_NOT_OK(dict_block_.GetKeyAtIdx(&value, last_codeword));
+      DCHECK_EQ(sizeof(CppType), value.size());
+      memcpy(key, value.data(), sizeof(CppType));
+      return Status::OK();
+    }
+    DCHECK_EQ(mode_, kPlainBinaryMode);
+    return data_builder_->GetLastKey(key);
+  }
+
+ private:
+  ATTRIBUTE_COLD
+  bool AddToDict(CppType val, uint32_t* codeword) {
+    Slice val_slice(reinterpret_cast<const uint8_t*>(&val), sizeof(val));
+    if (PREDICT_FALSE(dict_block_.Add(reinterpret_cast<const uint8_t*>(&val_slice), 1) == 0)) {
+      // The dictionary block is full
+      return false;
+    }
+    *codeword = dict_block_.Count() - 1;
+    dictionary_.emplace(val, *codeword);
+    return true;
+  }
+
+  // Buffer used in Finish() for holding the encoded header.
+  faststring header_buffer_;
+  bool finished_;
+  const WriterOptions* options_;
+
+  std::unique_ptr<BlockBuilder> data_builder_;
+
+  // The dictionary block and its index. Shared by all the data blocks of the
+  // cfile, so they should NOT be cleared in Reset().
+  BinaryPlainBlockBuilder dict_block_;
+  std::unordered_map<CppType, uint32_t> dictionary_;
+
+  DictEncodingMode mode_;
+
+  // First key when mode_ = kCodeWordMode
+  CppType first_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(IntDictBlockBuilder);
+};
+
+template<DataType Type>
+class IntDictBlockDecoder final : public BlockDecoder {
+ public:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+
+  IntDictBlockDecoder(scoped_refptr<BlockHandle> block, CFileIterator* iter)
+      : block_(std::move(block)),
+        data_(block_->data()),
+        parsed_(false),
+        dict_decoder_(iter->GetDictDecoder()),
+        parent_cfile_iter_(iter) {
+  }
+
+  Status ParseHeader() override {
+    CHECK(!parsed_);
+
+    if (data_.size() < kMinHeaderSize) {
+      return Status::Corruption(
+          strings::Substitute("not enough bytes for header: dictionary block header "
+                              "size ($0) less than minimum possible header length ($1)",
+                              data_.size(), kMinHeaderSize));
+    }
+
+    bool valid = tight_enum_test_cast<DictEncodingMode>(DecodeFixed32(&data_[0]), &mode_);
+    if (PREDICT_FALSE(!valid)) {
+      return Status::Corruption("header Mode information corrupted");
+    }
+    auto sub_block = block_->SubrangeBlock(4, data_.size() - 4);
+
+    if (mode_ == kCodeWordMode) {
+      if (PREDICT_FALSE(dict_decoder_ == nullptr)) {
+        return Status::Corruption("dictionary encoded block without a dictionary");
+      }
+      data_decoder_.reset(new BShufBlockDecoder<UINT32>(std::move(sub_block)));
+    } else {
+      data_decoder_.reset(new BShufBlockDecoder<Type>(std::move(sub_block)));
+    }
+
+    RETURN_NOT_OK(data_decoder_->ParseHeader());
+    parsed_ = true;
+    return Status::OK();
+  }
+
+  void SeekToPositionInBlock(uint pos) override {
+    data_decoder_->SeekToPositionInBlock(pos);
+  }
+
+  // In codeword mode, relies on the values having been appended in sorted
+  // order, which makes both the dictionary and the codewords sorted.
+  Status SeekAtOrAfterValue(const void* value_void, bool* exact) override {
+    if (mode_ != kCodeWordMode) {
+      return data_decoder_->SeekAtOrAfterValue(value_void, exact);
+    }
+    DCHECK(value_void != nullptr);
+    const CppType target = UnalignedLoad<CppType>(value_void);
+    uint32_t left = 0;
+    uint32_t right = dict_decoder_->Count();
+    while (left != right) {
+      uint32_t mid = left + (right - left) / 2;
+      if (ValueAtIndex(mid) < target) {
+        left = mid + 1;
+      } else {
+        right = mid;
+      }
+    }
+    if (left == dict_decoder_->Count()) {
+      // The value is larger than any in the dictionary, so it can't be in
+      // this data block either.
+      data_decoder_->SeekToPositionInBlock(data_decoder_->Count() - 1);
+      return Status::NotFound("after last key in dictionary");
+    }
+    *exact = ValueAtIndex(left) == target;
+    bool tmp;
+    return data_decoder_->SeekAtOrAfterValue(&left, &tmp);
+  }
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) override {
+    if (mode_ == kCodeWordMode) {
+      return CopyNextDecodeValues(n, dst);
+    }
+    return data_decoder_->CopyNextValues(n, dst);
+  }
+
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override {
+    ctx->SetDecoderEvalSupported();
+    if (mode_ != kCodeWordMode) {
+      return data_decoder_->CopyNextAndEval(n, ctx, sel, dst);
+    }
+
+    // Predicates that have no matching words should return no data.
+    SelectionVector* codewords_matching_pred = parent_cfile_iter_->GetCodeWordsMatchingPredicate();
+    CHECK(codewords_matching_pred != nullptr);
+    if (!codewords_matching_pred->AnySelected()) {
+      int skip = static_cast<int>(*n);
+      data_decoder_->SeekForward(&skip);
+      *n = static_cast<size_t>(skip);
+      sel->ClearBits(*n);
+      return Status::OK();
+    }
+
+    // IsNotNull predicates should return all data.
+    if (ctx->pred()->predicate_type() == PredicateType::IsNotNull) {
+      return CopyNextDecodeValues(n, dst);
+    }
+
+    RETURN_NOT_OK(CopyNextCodeWords(n));
+    const uint32_t* codewords = reinterpret_cast<const uint32_t*>(codeword_buf_.data());
+    CppType* out = reinterpret_cast<CppType*>(dst->data());
+    for (size_t i = 0; i < *n; i++) {
+      if (!sel->TestBit(i)) {
+        continue;
+      }
+      if (BitmapTest(codewords_matching_pred->bitmap(), codewords[i])) {
+        out[i] = ValueAtIndex(codewords[i]);
+      } else {
+        sel->ClearBit(i);
+      }
+    }
+    return Status::OK();
+  }
+
+  bool HasNext() const override {
+    return data_decoder_->HasNext();
+  }
+
+  size_t Count() const override {
+    return data_decoder_->Count();
+  }
+
+  size_t GetCurrentIndex() const override {
+    return data_decoder_->GetCurrentIndex();
+  }
+
+  rowid_t GetFirstRowId() const override {
+    return data_decoder_->GetFirstRowId();
+  }
+
+  static const size_t kMinHeaderSize = sizeof(uint32_t) * 1;
+
+ private:
+  CppType ValueAtIndex(uint32_t codeword) const {
+    Slice value = dict_decoder_->string_at_index(codeword);
+    DCHECK_EQ(sizeof(CppType), value.size());
+    return UnalignedLoad<CppType>(value.data());
+  }
+
+  // Copies the next '*n' codewords into 'codeword_buf_'.
+  Status CopyNextCodeWords(size_t* n) {
+    codeword_buf_.resize(*n * sizeof(uint32_t));
+    BShufBlockDecoder<UINT32>* d_bptr = down_cast<BShufBlockDecoder<UINT32>*>(data_decoder_.get());
+    return d_bptr->CopyNextValuesToArray(n, codeword_buf_.data());
+  }
+
+  Status CopyNextDecodeValues(size_t* n, ColumnDataView* dst) {
+    DCHECK(parsed_);
+    DCHECK_LE(*n, dst->nrows());
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+
+    RETURN_NOT_OK(CopyNextCodeWords(n));
+    const uint32_t* codewords = reinterpret_cast<const uint32_t*>(codeword_buf_.data());
+    CppType* out = reinterpret_cast<CppType*>(dst->data());
+    for (size_t i = 0; i < *n; i++) {
+      out[i] = ValueAtIndex(codewords[i]);
+    }
+    return Status::OK();
+  }
+
+  scoped_refptr<BlockHandle> block_;
+  Slice data_;
+  bool parsed_;
+
+  // Dictionary block decoder, owned by the parent CFileIterator.
+  BinaryPlainBlockDecoder* dict_decoder_;
+
+  std::unique_ptr<BlockDecoder> data_decoder_;
+
+  // Parent CFileIterator, which also holds the codewords matching the
+  // predicate, if any.
+  CFileIterator* parent_cfile_iter_;
+
+  DictEncodingMode mode_;
+
+  // Buffer to hold the codewords of the values being decoded.
+  faststring codeword_buf_;
+
+  DISALLOW_COPY_AND_ASSIGN(IntDictBlockDecoder);
+};
+
+} // namespace cfile
+} // namespace kudu
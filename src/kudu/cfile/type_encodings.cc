@@ -21,15 +21,19 @@
 #include <unordered_map>
 #include <utility>
 
+#include "kudu/cfile/adaptive_block.h" // IWYU pragma: keep
 #include "kudu/cfile/binary_dict_block.h" // IWYU pragma: keep
 #include "kudu/cfile/binary_plain_block.h" // IWYU pragma: keep
 #include "kudu/cfile/binary_prefix_block.h" // IWYU pragma: keep
 #include "kudu/cfile/block_encodings.h"
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/bshuf_block.h" // IWYU pragma: keep
+#include "kudu/cfile/frame_of_reference_block.h" // IWYU pragma: keep
+#include "kudu/cfile/int_dict_block.h" // IWYU pragma: keep
 #include "kudu/cfile/plain_bitmap_block.h" // IWYU pragma: keep
 #include "kudu/cfile/plain_block.h" // IWYU pragma: keep
 #include "kudu/cfile/rle_block.h" // IWYU pragma: keep
+#include "kudu/cfile/xor_block.h" // IWYU pragma: keep
 #include "kudu/common/types.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
@@ -119,10 +123,48 @@ struct DataTypeEncodingTraits<BINARY, DICT_ENCODING>
   }
 };
 
+// Template for dictionary encoding of fixed-width integers
+template<DataType IntType>
+struct DataTypeEncodingTraits<IntType, DICT_ENCODING>
+    : public EncodingTraits<IntDictBlockBuilder<IntType>, IntDictBlockDecoder<IntType>> {
+  static Status CreateBlockDecoder(unique_ptr<BlockDecoder>* bd,
+                                   scoped_refptr<BlockHandle> block,
+                                   CFileIterator* parent_cfile_iter) {
+    bd->reset(new IntDictBlockDecoder<IntType>(std::move(block), parent_cfile_iter));
+    return Status::OK();
+  }
+};
+
 template<DataType IntType>
 struct DataTypeEncodingTraits<IntType, RLE>
     : public EncodingTraits<RleIntBlockBuilder<IntType>, RleIntBlockDecoder<IntType>> {};
 
+template<DataType IntType>
+struct DataTypeEncodingTraits<IntType, FRAME_OF_REFERENCE>
+    : public EncodingTraits<FrameOfReferenceBlockBuilder<IntType>,
+                            FrameOfReferenceBlockDecoder<IntType>> {};
+
+template<DataType FloatType>
+struct DataTypeEncodingTraits<FloatType, XOR_ENCODING>
+    : public EncodingTraits<XorBlockBuilder<FloatType>, XorBlockDecoder<FloatType>> {};
+
+// Adaptive encoding applies to every type: it picks among the other
+// encodings registered for the type.
+template<DataType Type>
+struct DataTypeEncodingTraits<Type, ADAPTIVE_ENCODING> {
+  static Status CreateBlockBuilder(unique_ptr<BlockBuilder>* bb, const WriterOptions* options) {
+    bb->reset(new AdaptiveBlockBuilder(GetTypeInfo(Type), options));
+    return Status::OK();
+  }
+
+  static Status CreateBlockDecoder(unique_ptr<BlockDecoder>* bd,
+                                   scoped_refptr<BlockHandle> block,
+                                   CFileIterator* parent_cfile_iter) {
+    bd->reset(new AdaptiveBlockDecoder(GetTypeInfo(Type), std::move(block), parent_cfile_iter));
+    return Status::OK();
+  }
+};
+
 template<typename TypeEncodingTraitsClass>
 TypeEncodingInfo::TypeEncodingInfo(TypeEncodingTraitsClass /*t*/)
     : encoding_type_(TypeEncodingTraitsClass::kEncodingType),
@@ -180,38 +222,65 @@ class TypeEncodingResolver {
     AddMapping<UINT8, BIT_SHUFFLE>();
     AddMapping<UINT8, PLAIN_ENCODING>();
     AddMapping<UINT8, RLE>();
+    AddMapping<UINT8, FRAME_OF_REFERENCE>();
+    AddMapping<UINT8, ADAPTIVE_ENCODING>();
     AddMapping<INT8, BIT_SHUFFLE>();
     AddMapping<INT8, PLAIN_ENCODING>();
     AddMapping<INT8, RLE>();
+    AddMapping<INT8, FRAME_OF_REFERENCE>();
+    AddMapping<INT8, ADAPTIVE_ENCODING>();
     AddMapping<UINT16, BIT_SHUFFLE>();
     AddMapping<UINT16, PLAIN_ENCODING>();
     AddMapping<UINT16, RLE>();
+    AddMapping<UINT16, FRAME_OF_REFERENCE>();
+    AddMapping<UINT16, ADAPTIVE_ENCODING>();
     AddMapping<INT16, BIT_SHUFFLE>();
     AddMapping<INT16, PLAIN_ENCODING>();
     AddMapping<INT16, RLE>();
+    AddMapping<INT16, FRAME_OF_REFERENCE>();
+    AddMapping<INT16, ADAPTIVE_ENCODING>();
     AddMapping<UINT32, BIT_SHUFFLE>();
     AddMapping<UINT32, RLE>();
     AddMapping<UINT32, PLAIN_ENCODING>();
+    AddMapping<UINT32, FRAME_OF_REFERENCE>();
+    AddMapping<UINT32, ADAPTIVE_ENCODING>();
+    AddMapping<UINT32, DICT_ENCODING>();
     AddMapping<INT32, BIT_SHUFFLE>();
     AddMapping<INT32, PLAIN_ENCODING>();
     AddMapping<INT32, RLE>();
+    AddMapping<INT32, FRAME_OF_REFERENCE>();
+    AddMapping<INT32, ADAPTIVE_ENCODING>();
+    AddMapping<INT32, DICT_ENCODING>();
     AddMapping<UINT64, BIT_SHUFFLE>();
     AddMapping<UINT64, PLAIN_ENCODING>();
     AddMapping<UINT64, RLE>();
+    AddMapping<UINT64, FRAME_OF_REFERENCE>();
+    AddMapping<UINT64, ADAPTIVE_ENCODING>();
+    AddMapping<UINT64, DICT_ENCODING>();
     AddMapping<INT64, BIT_SHUFFLE>();
     AddMapping<INT64, PLAIN_ENCODING>();
     AddMapping<INT64, RLE>();
+    AddMapping<INT64, FRAME_OF_REFERENCE>();
+    AddMapping<INT64, ADAPTIVE_ENCODING>();
+    AddMapping<INT64, DICT_ENCODING>();
     AddMapping<FLOAT, BIT_SHUFFLE>();
     AddMapping<FLOAT, PLAIN_ENCODING>();
+    AddMapping<FLOAT, XOR_ENCODING>();
+    AddMapping<FLOAT, ADAPTIVE_ENCODING>();
     AddMapping<DOUBLE, BIT_SHUFFLE>();
     AddMapping<DOUBLE, PLAIN_ENCODING>();
+    AddMapping<DOUBLE, XOR_ENCODING>();
+    AddMapping<DOUBLE, ADAPTIVE_ENCODING>();
     AddMapping<BINARY, DICT_ENCODING>();
     AddMapping<BINARY, PLAIN_ENCODING>();
     AddMapping<BINARY, PREFIX_ENCODING>();
+    AddMapping<BINARY, ADAPTIVE_ENCODING>();
     AddMapping<BOOL, RLE>();
     AddMapping<BOOL, PLAIN_ENCODING>();
+    AddMapping<BOOL, ADAPTIVE_ENCODING>();
     AddMapping<INT128, BIT_SHUFFLE>();
     AddMapping<INT128, PLAIN_ENCODING>();
+    AddMapping<INT128, ADAPTIVE_ENCODING>();
     // TODO: Add 128 bit support to RLE
     // AddMapping<INT128, RLE>();
   }
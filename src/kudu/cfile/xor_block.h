@@ -0,0 +1,466 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/cfile/block_handle.h"
+#include "kudu/cfile/cfile_util.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowid.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace cfile {
+
+struct WriterOptions;
+
+// Helpers shared by the XOR builder and decoder.
+namespace xor_internal {
+
+// The bit stream is followed by this many bytes of zero padding, so that the
+// decoder can always read it with 64-bit loads.
+constexpr int kPaddingBytes = sizeof(uint64_t);
+
+// The control bits preceding each value but the first, in the order they are
+// written: a single 0 bit if the value is the same as the previous one, 1 then
+// 0 if its XOR with the previous one fits in the window of meaningful bits of
+// the previous XOR, or 1 then 1 if a new window follows.
+constexpr uint64_t kReuseWindow = 0b01;
+constexpr uint64_t kNewWindow = 0b11;
+
+// Appends values of up to 64 bits to a buffer, LSB-first.
+class BitWriter {
+ public:
+  explicit BitWriter(faststring* buf)
+      : buf_(buf),
+        acc_(0),
+        num_bits_(0) {
+  }
+
+  // Append the 'num_bits' low bits of 'v', which must not have any higher
+  // bit set. 'num_bits' must be at most 64.
+  void Put(uint64_t v, int num_bits) {
+    if (num_bits == 0) return;
+    acc_ |= v << num_bits_;
+    const int total = num_bits_ + num_bits;
+    if (total < 64) {
+      num_bits_ = total;
+      return;
+    }
+    AppendBytes(acc_, sizeof(acc_));
+    acc_ = num_bits_ == 0 ? 0 : v >> (64 - num_bits_);
+    num_bits_ = total - 64;
+  }
+
+  // Append the pending bits, followed by the padding.
+  void Flush() {
+    AppendBytes(acc_, (num_bits_ + 7) / 8);
+    AppendBytes(0, kPaddingBytes);
+    acc_ = 0;
+    num_bits_ = 0;
+  }
+
+ private:
+  void AppendBytes(uint64_t v, int n) {
+    uint8_t bytes[sizeof(uint64_t)];
+    InlineEncodeFixed64(bytes, v);
+    buf_->append(bytes, n);
+  }
+
+  faststring* buf_;
+  uint64_t acc_;
+  int num_bits_;
+};
+
+// Reads the values written by BitWriter from a bit stream followed by
+// kPaddingBytes bytes. Reading past the end of the stream returns zeroes and
+// marks the reader as overflowed.
+class BitReader {
+ public:
+  BitReader(const uint8_t* src, size_t num_bits)
+      : src_(src),
+        limit_(num_bits),
+        pos_(0),
+        overflowed_(false) {
+  }
+
+  // Read the next 'num_bits' bits, at most 64.
+  uint64_t Get(int num_bits) {
+    if (num_bits > 56) {
+      const uint64_t lo = Get(32);
+      return lo | (Get(num_bits - 32) << 32);
+    }
+    if (PREDICT_FALSE(pos_ + num_bits > limit_)) {
+      overflowed_ = true;
+      return 0;
+    }
+    const uint64_t word = UnalignedLoad<uint64_t>(src_ + (pos_ >> 3));
+    const uint64_t v = (word >> (pos_ & 7)) & ((1ULL << num_bits) - 1);
+    pos_ += num_bits;
+    return v;
+  }
+
+  bool overflowed() const {
+    return overflowed_;
+  }
+
+ private:
+  const uint8_t* const src_;
+  const uint64_t limit_;
+  uint64_t pos_;
+  bool overflowed_;
+};
+
+} // namespace xor_internal
+
+// XorBlockBuilder encodes FLOAT and DOUBLE blocks as in the Gorilla time
+// series database: each value is XORed with the previous one, and only the
+// bits in which they differ are stored. Consecutive readings of a metric
+// share their sign, exponent and high mantissa bits, so their XORs are mostly
+// made of leading and trailing zero bits, which are omitted.
+//
+// The block format is as follows:
+//
+// 1. Header: (8 bytes total)
+//
+//    <first_ordinal> [32-bit]
+//      The ordinal offset of the first element in the block.
+//
+//    <num_elements> [32-bit]
+//      The number of elements encoded in the block.
+//
+//   NOTE: all on-disk ints are encoded little-endian.
+//
+// 2. Element data
+//
+//    A bit stream, LSB-first, followed by kPaddingBytes bytes of zeroes. The
+//    stream starts with the bits of the first element. It then holds, for
+//    each following element, the control bits described above, followed with
+//    kNewWindow by the number of leading zero bits of the XOR with the
+//    previous element and the number of meaningful bits minus 1, both in
+//    kLengthBits bits (5 for FLOAT, 6 for DOUBLE), and with either window by
+//    the meaningful bits of the XOR.
+//
+template<DataType Type>
+class XorBlockBuilder final : public BlockBuilder {
+ public:
+  explicit XorBlockBuilder(const WriterOptions* options)
+      : count_(0),
+        options_(options) {
+    Reset();
+  }
+
+  void Reset() override {
+    auto block_size = options_->storage_attributes.cfile_block_size;
+    count_ = 0;
+    data_.clear();
+    data_.reserve(block_size);
+    buffer_.clear();
+    finished_ = false;
+    rem_elem_capacity_ = block_size / kCppTypeSize;
+  }
+
+  bool IsBlockFull() const override {
+    return rem_elem_capacity_ == 0;
+  }
+
+  int Add(const uint8_t* vals_void, size_t count) override {
+    DCHECK(!finished_);
+    int to_add = std::min<int>(rem_elem_capacity_, count);
+    data_.append(vals_void, to_add * kCppTypeSize);
+    count_ += to_add;
+    rem_elem_capacity_ -= to_add;
+    return to_add;
+  }
+
+  size_t Count() const override {
+    return count_;
+  }
+
+  Status GetFirstKey(void* key) const override {
+    DCHECK(finished_);
+    if (count_ == 0) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &data_[0], kCppTypeSize);
+    return Status::OK();
+  }
+
+  Status GetLastKey(void* key) const override {
+    DCHECK(finished_);
+    if (count_ == 0) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &data_[(count_ - 1) * kCppTypeSize], kCppTypeSize);
+    return Status::OK();
+  }
+
+  void Finish(rowid_t ordinal_pos, std::vector<Slice>* slices) override {
+    buffer_.resize(kHeaderSize);
+    InlineEncodeFixed32(&buffer_[0], ordinal_pos);
+    InlineEncodeFixed32(&buffer_[4], count_);
+
+    xor_internal::BitWriter writer(&buffer_);
+    if (count_ > 0) {
+      UnsignedType prev = bits(0);
+      writer.Put(prev, kBits);
+      // The window of meaningful bits of the last XOR written with
+      // kNewWindow, empty until then.
+      int lead = 0;
+      int len = 0;
+      for (uint32_t i = 1; i < count_; i++) {
+        const UnsignedType cur = bits(i);
+        const UnsignedType x = cur ^ prev;
+        prev = cur;
+        if (x == 0) {
+          writer.Put(0, 1);
+          continue;
+        }
+        const int x_lead = __builtin_clzll(x) - (64 - kBits);
+        const int x_trail = __builtin_ctzll(x);
+        if (len > 0 && x_lead >= lead && x_trail >= kBits - lead - len) {
+          writer.Put(xor_internal::kReuseWindow, 2);
+        } else {
+          lead = x_lead;
+          len = kBits - x_lead - x_trail;
+          writer.Put(xor_internal::kNewWindow, 2);
+          writer.Put(lead, kLengthBits);
+          writer.Put(len - 1, kLengthBits);
+        }
+        writer.Put(x >> (kBits - lead - len), len);
+      }
+    }
+    writer.Flush();
+
+    finished_ = true;
+    *slices = { Slice(buffer_) };
+  }
+
+  // Length of the header.
+  static constexpr size_t kHeaderSize = 8;
+
+ private:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+  typedef typename std::conditional<sizeof(CppType) == 4, uint32_t, uint64_t>::type UnsignedType;
+  static_assert(Type == FLOAT || Type == DOUBLE, "XOR encoding is for floating point types");
+
+  enum {
+    kCppTypeSize = TypeTraits<Type>::size
+  };
+
+  static constexpr int kBits = kCppTypeSize * 8;
+  static constexpr int kLengthBits = Type == FLOAT ? 5 : 6;
+
+  // The bits of the value at 'idx'.
+  UnsignedType bits(int idx) const {
+    DCHECK_GE(idx, 0);
+    return UnalignedLoad<UnsignedType>(&data_[idx * kCppTypeSize]);
+  }
+
+  faststring data_;
+  faststring buffer_;
+  uint32_t count_;
+  int rem_elem_capacity_;
+  bool finished_;
+  const WriterOptions* options_;
+};
+
+// Decoder for blocks written by XorBlockBuilder. The whole block is decoded
+// in a single pass when the header is parsed, after which seeks and copies
+// operate on the plain values.
+template<DataType Type>
+class XorBlockDecoder final : public BlockDecoder {
+ public:
+  explicit XorBlockDecoder(scoped_refptr<BlockHandle> block)
+      : block_(std::move(block)),
+        data_(block_->data()),
+        parsed_(false),
+        ordinal_pos_base_(0),
+        num_elems_(0),
+        cur_idx_(0) {
+  }
+
+  Status ParseHeader() override {
+    CHECK(!parsed_);
+    const size_t header_size = XorBlockBuilder<Type>::kHeaderSize;
+    if (data_.size() < header_size + xor_internal::kPaddingBytes) {
+      return Status::Corruption(strings::Substitute(
+          "not enough bytes for header: XOR block size ($0) less than expected "
+          "minimum length ($1)", data_.size(), header_size + xor_internal::kPaddingBytes));
+    }
+
+    ordinal_pos_base_ = DecodeFixed32(&data_[0]);
+    num_elems_ = DecodeFixed32(&data_[4]);
+    const size_t stream_size = data_.size() - header_size - xor_internal::kPaddingBytes;
+    // Each value takes at least one bit, except the first one which takes
+    // them all.
+    if (PREDICT_FALSE(num_elems_ > 0 && num_elems_ - 1 > stream_size * 8)) {
+      return Status::Corruption(strings::Substitute(
+          "XOR block of $0 bytes can't hold $1 elements", data_.size(), num_elems_));
+    }
+
+    decoded_.resize(num_elems_);
+    if (num_elems_ > 0) {
+      xor_internal::BitReader reader(&data_[header_size], stream_size * 8);
+      UnsignedType prev = static_cast<UnsignedType>(reader.Get(kBits));
+      decoded_[0] = prev;
+      int lead = 0;
+      int len = 0;
+      for (size_t i = 1; i < num_elems_; i++) {
+        if (reader.Get(1) != 0) {
+          if (reader.Get(1) != 0) {
+            lead = static_cast<int>(reader.Get(kLengthBits));
+            len = static_cast<int>(reader.Get(kLengthBits)) + 1;
+            if (PREDICT_FALSE(lead + len > kBits)) {
+              return Status::Corruption(strings::Substitute(
+                  "invalid window in XOR block: $0 leading and $1 meaningful bits",
+                  lead, len));
+            }
+          } else if (PREDICT_FALSE(len == 0)) {
+            return Status::Corruption("XOR block reuses a window before defining one");
+          }
+          prev ^= static_cast<UnsignedType>(reader.Get(len) << (kBits - lead - len));
+        }
+        decoded_[i] = prev;
+      }
+      if (PREDICT_FALSE(reader.overflowed())) {
+        return Status::Corruption(strings::Substitute(
+            "XOR block of $0 bytes is too short for its $1 elements",
+            data_.size(), num_elems_));
+      }
+    }
+
+    parsed_ = true;
+    return Status::OK();
+  }
+
+  void SeekToPositionInBlock(uint pos) override {
+    CHECK(parsed_) << "Must call ParseHeader()";
+    DCHECK_LE(pos, num_elems_);
+    cur_idx_ = pos;
+  }
+
+  Status SeekAtOrAfterValue(const void* value_void, bool* exact) override {
+    DCHECK(parsed_);
+    const CppType target = UnalignedLoad<CppType>(value_void);
+    uint32_t left = 0;
+    uint32_t right = num_elems_;
+    while (left != right) {
+      uint32_t mid = left + (right - left) / 2;
+      CppType mid_key = value_at(mid);
+      if (mid_key == target) {
+        cur_idx_ = mid;
+        *exact = true;
+        return Status::OK();
+      }
+      if (mid_key > target) {
+        right = mid;
+      } else {
+        left = mid + 1;
+      }
+    }
+
+    *exact = false;
+    cur_idx_ = left;
+    if (cur_idx_ == num_elems_) {
+      return Status::NotFound("after last key in block");
+    }
+    return Status::OK();
+  }
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) override {
+    DCHECK(parsed_);
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+    DCHECK_LE(*n, dst->nrows());
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    memcpy(dst->data(), &decoded_[cur_idx_], max_fetch * kCppTypeSize);
+    *n = max_fetch;
+    cur_idx_ += max_fetch;
+    return Status::OK();
+  }
+
+  bool HasNext() const override {
+    return cur_idx_ < num_elems_;
+  }
+
+  size_t Count() const override {
+    return num_elems_;
+  }
+
+  size_t GetCurrentIndex() const override {
+    DCHECK(parsed_) << "must parse header first";
+    return cur_idx_;
+  }
+
+  rowid_t GetFirstRowId() const override {
+    return ordinal_pos_base_;
+  }
+
+ private:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+  typedef typename std::conditional<sizeof(CppType) == 4, uint32_t, uint64_t>::type UnsignedType;
+
+  enum {
+    kCppTypeSize = TypeTraits<Type>::size
+  };
+
+  static constexpr int kBits = kCppTypeSize * 8;
+  static constexpr int kLengthBits = Type == FLOAT ? 5 : 6;
+
+  CppType value_at(size_t idx) const {
+    CppType v;
+    memcpy(&v, &decoded_[idx], kCppTypeSize);
+    return v;
+  }
+
+  scoped_refptr<BlockHandle> block_;
+  Slice data_;
+  bool parsed_;
+
+  rowid_t ordinal_pos_base_;
+  uint32_t num_elems_;
+  size_t cur_idx_;
+
+  // The bits of the values of the block.
+  std::vector<UnsignedType> decoded_;
+};
+
+} // namespace cfile
+} // namespace kudu
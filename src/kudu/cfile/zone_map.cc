@@ -0,0 +1,269 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/zone_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <type_traits>
+
+#include <glog/logging.h>
+
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/pb_util.h"
+
+using std::optional;
+using std::unique_ptr;
+using strings::Substitute;
+
+namespace kudu {
+namespace cfile {
+
+ZoneMapBuilder::ZoneMapBuilder(const TypeInfo* typeinfo)
+    : typeinfo_(typeinfo),
+      num_rows_(0),
+      null_count_(0),
+      has_values_(false),
+      has_min_(true),
+      has_max_(true) {
+}
+
+void ZoneMapBuilder::AddValues(const void* cells, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  num_rows_ += count;
+
+  switch (typeinfo_->physical_type()) {
+    case BOOL: AddValuesTyped<BOOL>(cells, count); break;
+    case INT8: AddValuesTyped<INT8>(cells, count); break;
+    case UINT8: AddValuesTyped<UINT8>(cells, count); break;
+    case INT16: AddValuesTyped<INT16>(cells, count); break;
+    case UINT16: AddValuesTyped<UINT16>(cells, count); break;
+    case INT32: AddValuesTyped<INT32>(cells, count); break;
+    case UINT32: AddValuesTyped<UINT32>(cells, count); break;
+    case INT64: AddValuesTyped<INT64>(cells, count); break;
+    case UINT64: AddValuesTyped<UINT64>(cells, count); break;
+    case INT128: AddValuesTyped<INT128>(cells, count); break;
+    case FLOAT: AddValuesTyped<FLOAT>(cells, count); break;
+    case DOUBLE: AddValuesTyped<DOUBLE>(cells, count); break;
+    case BINARY: AddBinaryValues(cells, count); break;
+    default:
+      LOG(FATAL) << "unexpected physical type: " << typeinfo_->physical_type();
+  }
+  has_values_ = true;
+}
+
+template<DataType PhysicalType>
+void ZoneMapBuilder::AddValuesTyped(const void* cells, size_t count) {
+  using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
+  const cpp_type* values = reinterpret_cast<const cpp_type*>(cells);
+
+  if constexpr (std::is_floating_point<cpp_type>::value) {
+    // NaN doesn't order against other values, so a block containing one
+    // can't be bounded.
+    if (!has_min_) {
+      return;
+    }
+    for (size_t i = 0; i < count; i++) {
+      if (PREDICT_FALSE(std::isnan(values[i]))) {
+        has_min_ = false;
+        has_max_ = false;
+        return;
+      }
+    }
+  }
+
+  cpp_type min_val = values[0];
+  cpp_type max_val = values[0];
+  for (size_t i = 1; i < count; i++) {
+    min_val = std::min(min_val, values[i]);
+    max_val = std::max(max_val, values[i]);
+  }
+  if (has_values_) {
+    cpp_type cur;
+    memcpy(&cur, min_.data(), sizeof(cur));
+    min_val = std::min(min_val, cur);
+    memcpy(&cur, max_.data(), sizeof(cur));
+    max_val = std::max(max_val, cur);
+  }
+  min_.assign_copy(reinterpret_cast<const uint8_t*>(&min_val), sizeof(min_val));
+  max_.assign_copy(reinterpret_cast<const uint8_t*>(&max_val), sizeof(max_val));
+}
+
+void ZoneMapBuilder::AddBinaryValues(const void* cells, size_t count) {
+  const Slice* values = reinterpret_cast<const Slice*>(cells);
+  const Slice* min_val = &values[0];
+  const Slice* max_val = &values[0];
+  for (size_t i = 1; i < count; i++) {
+    if (values[i].compare(*min_val) < 0) {
+      min_val = &values[i];
+    } else if (values[i].compare(*max_val) > 0) {
+      max_val = &values[i];
+    }
+  }
+
+  // A prefix of the minimum is still a lower bound, so long values may be
+  // truncated. The stored minimum may itself be such a prefix: any value
+  // which doesn't sort below it is no smaller than the true minimum either.
+  if (!has_values_ || min_val->compare(Slice(min_)) < 0) {
+    min_.assign_copy(min_val->data(),
+                     std::min(min_val->size(), kZoneMapMaxBinaryValueLength));
+  }
+  if (has_max_ && (!has_values_ || max_val->compare(Slice(max_)) > 0)) {
+    if (max_val->size() > kZoneMapMaxBinaryValueLength) {
+      has_max_ = false;
+    } else {
+      max_.assign_copy(max_val->data(), max_val->size());
+    }
+  }
+}
+
+void ZoneMapBuilder::FinishBlock() {
+  if (num_rows_ == 0) {
+    return;
+  }
+  ZoneMapEntryPB* entry = pb_.add_entries();
+  entry->set_num_rows(num_rows_);
+  if (null_count_ > 0) {
+    entry->set_null_count(null_count_);
+  }
+  if (has_values_ && has_min_) {
+    entry->set_min_value(min_.data(), min_.size());
+  }
+  if (has_values_ && has_max_) {
+    entry->set_max_value(max_.data(), max_.size());
+  }
+
+  num_rows_ = 0;
+  null_count_ = 0;
+  has_values_ = false;
+  has_min_ = true;
+  has_max_ = true;
+}
+
+void ZoneMapBuilder::Finish(faststring* dst) const {
+  pb_util::SerializeToString(pb_, dst);
+}
+
+Status ZoneMap::Parse(const TypeInfo* typeinfo, const Slice& data,
+                      unique_ptr<ZoneMap>* zone_map) {
+  unique_ptr<ZoneMap> zm(new ZoneMap(typeinfo));
+  if (PREDICT_FALSE(!zm->pb_.ParseFromArray(data.data(), data.size()))) {
+    return Status::Corruption("unable to parse zone map");
+  }
+
+  const bool fixed_width = typeinfo->physical_type() != BINARY;
+  zm->first_row_idx_.reserve(zm->pb_.entries_size());
+  rowid_t first_row_idx = 0;
+  for (const auto& entry : zm->pb_.entries()) {
+    if (PREDICT_FALSE(entry.null_count() > entry.num_rows())) {
+      return Status::Corruption(Substitute("zone map entry has $0 nulls out of $1 rows",
+                                           entry.null_count(), entry.num_rows()));
+    }
+    if (fixed_width &&
+        PREDICT_FALSE((entry.has_min_value() && entry.min_value().size() != typeinfo->size()) ||
+                      (entry.has_max_value() && entry.max_value().size() != typeinfo->size()))) {
+      return Status::Corruption("zone map entry has bad value size");
+    }
+    zm->first_row_idx_.push_back(first_row_idx);
+    first_row_idx += entry.num_rows();
+  }
+  zm->num_rows_ = first_row_idx;
+  *zone_map = std::move(zm);
+  return Status::OK();
+}
+
+bool ZoneMap::MayMatch(const ColumnPredicate& pred, rowid_t start_idx, size_t nrows) const {
+  if (nrows == 0) {
+    return false;
+  }
+  const rowid_t end_idx = start_idx + nrows;
+  if (PREDICT_FALSE(end_idx > num_rows_)) {
+    // The range isn't fully described by the zone map; be conservative.
+    return true;
+  }
+  // Find the block containing 'start_idx' and check it and every following
+  // block which overlaps the range.
+  auto it = std::upper_bound(first_row_idx_.begin(), first_row_idx_.end(), start_idx);
+  DCHECK(it != first_row_idx_.begin());
+  for (size_t idx = std::distance(first_row_idx_.begin(), it) - 1;
+       idx < first_row_idx_.size() && first_row_idx_[idx] < end_idx;
+       idx++) {
+    if (EntryMayMatch(pred, pb_.entries(idx))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ZoneMap::EntryMayMatch(const ColumnPredicate& pred, const ZoneMapEntryPB& entry) const {
+  const uint32_t non_null_count = entry.num_rows() - entry.null_count();
+  switch (pred.predicate_type()) {
+    case PredicateType::None:
+      return false;
+    case PredicateType::IsNull:
+      return entry.null_count() > 0;
+    case PredicateType::IsNotNull:
+    case PredicateType::ArrayContains:
+      // The bounds of the cells of ARRAY columns say nothing about their elements.
+      return non_null_count > 0;
+    default:
+      break;
+  }
+  // All the remaining predicate types only match non-null values.
+  if (non_null_count == 0) {
+    return false;
+  }
+  if (!entry.has_min_value() && !entry.has_max_value()) {
+    return true;
+  }
+
+  Slice min_slice(entry.min_value());
+  Slice max_slice(entry.max_value());
+  const void* lower = nullptr;
+  const void* upper = nullptr;
+  if (typeinfo_->physical_type() == BINARY) {
+    lower = entry.has_min_value() ? &min_slice : nullptr;
+    upper = entry.has_max_value() ? &max_slice : nullptr;
+  } else {
+    lower = entry.has_min_value() ? min_slice.data() : nullptr;
+    upper = entry.has_max_value() ? max_slice.data() : nullptr;
+  }
+
+  // Intersect the predicate with the block's value range: if the result
+  // can't match anything, neither can the block.
+  Arena arena(128);
+  optional<ColumnPredicate> bounds =
+      ColumnPredicate::InclusiveRange(pred.column(), lower, upper, &arena);
+  if (!bounds) {
+    return true;
+  }
+  ColumnPredicate merged = pred;
+  merged.Merge(*bounds);
+  return merged.predicate_type() != PredicateType::None;
+}
+
+} // namespace cfile
+} // namespace kudu
@@ -0,0 +1,133 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kudu/cfile/cfile.pb.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowid.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class ColumnPredicate;
+class TypeInfo;
+
+namespace cfile {
+
+// Values longer than this are not stored verbatim in a zone map: the
+// minimum is truncated to a prefix and the maximum is dropped.
+constexpr size_t kZoneMapMaxBinaryValueLength = 64;
+
+// Accumulates per-block statistics (row count, null count and min/max value)
+// while a cfile is being written.
+//
+// The writer feeds every cell of the current data block through AddValues()
+// or AddNulls(), then calls FinishBlock() when the data block is flushed.
+class ZoneMapBuilder {
+ public:
+  explicit ZoneMapBuilder(const TypeInfo* typeinfo);
+
+  // Accounts for 'count' contiguous non-null cells starting at 'cells'.
+  void AddValues(const void* cells, size_t count);
+
+  // Accounts for 'count' null cells.
+  void AddNulls(size_t count) {
+    num_rows_ += count;
+    null_count_ += count;
+  }
+
+  // Appends an entry for the current block to the zone map and resets the
+  // per-block state.
+  void FinishBlock();
+
+  // Returns the number of blocks recorded so far.
+  int num_entries() const {
+    return pb_.entries_size();
+  }
+
+  // Serializes the zone map of all finished blocks into 'dst'.
+  void Finish(faststring* dst) const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ZoneMapBuilder);
+
+  template<DataType PhysicalType>
+  void AddValuesTyped(const void* cells, size_t count);
+
+  void AddBinaryValues(const void* cells, size_t count);
+
+  const TypeInfo* typeinfo_;
+  ZoneMapPB pb_;
+
+  // State for the block currently being written.
+  uint32_t num_rows_;
+  uint32_t null_count_;
+  bool has_values_;
+  bool has_min_;
+  bool has_max_;
+  faststring min_;
+  faststring max_;
+};
+
+// Read-only view of a cfile's zone map, used to skip ranges of rows which
+// cannot satisfy a predicate.
+class ZoneMap {
+ public:
+  // Parses the serialized zone map in 'data'.
+  static Status Parse(const TypeInfo* typeinfo, const Slice& data,
+                      std::unique_ptr<ZoneMap>* zone_map);
+
+  // Returns false if it's certain that no row with ordinal in
+  // [start_idx, start_idx + nrows) satisfies 'pred', true otherwise.
+  bool MayMatch(const ColumnPredicate& pred, rowid_t start_idx, size_t nrows) const;
+
+  // Returns the number of blocks described by the zone map.
+  size_t num_entries() const {
+    return pb_.entries_size();
+  }
+
+ private:
+  explicit ZoneMap(const TypeInfo* typeinfo)
+      : typeinfo_(typeinfo),
+        num_rows_(0) {
+  }
+
+  // Whether any row described by 'entry' may satisfy 'pred'.
+  bool EntryMayMatch(const ColumnPredicate& pred, const ZoneMapEntryPB& entry) const;
+
+  const TypeInfo* typeinfo_;
+  ZoneMapPB pb_;
+
+  // The ordinal of the first row of each block.
+  std::vector<rowid_t> first_row_idx_;
+
+  // The total number of rows described by the zone map.
+  rowid_t num_rows_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZoneMap);
+};
+
+} // namespace cfile
+} // namespace kudu
@@ -0,0 +1,206 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/client/array_cell.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+
+#include <glog/logging.h>
+
+#include "kudu/client/schema-internal.h"
+#include "kudu/client/value-internal.h"
+#include "kudu/client/value.h"
+#include "kudu/common/array_cell.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+
+using strings::Substitute;
+
+namespace kudu {
+namespace client {
+
+////////////////////////////////////////////////////////////
+// KuduArrayCellBuilder
+////////////////////////////////////////////////////////////
+
+class KuduArrayCellBuilder::Data {
+ public:
+  explicit Data(DataType element_type)
+      : element_type(element_type),
+        builder(element_type) {
+  }
+
+  const DataType element_type;
+  ArrayCellBuilder builder;
+};
+
+KuduArrayCellBuilder::KuduArrayCellBuilder(KuduColumnSchema::DataType element_type) {
+  const DataType type = ToInternalDataType(element_type, KuduColumnTypeAttributes());
+  CHECK(IsArrayElementTypeSupported(type))
+      << "unsupported array element type: " << KuduColumnSchema::DataTypeToString(element_type);
+  data_ = new Data(type);
+}
+
+KuduArrayCellBuilder::~KuduArrayCellBuilder() {
+  delete data_;
+}
+
+Status KuduArrayCellBuilder::Append(const KuduValue& value) {
+  void* element;
+  RETURN_NOT_OK(value.data_->CheckTypeAndGetPointer(
+      "array element", data_->element_type, ColumnTypeAttributes(), &element));
+  data_->builder.Append(element);
+  return Status::OK();
+}
+
+void KuduArrayCellBuilder::AppendNull() {
+  data_->builder.AppendNull();
+}
+
+int KuduArrayCellBuilder::num_elements() const {
+  return data_->builder.num_elements();
+}
+
+Slice KuduArrayCellBuilder::Finish() {
+  return data_->builder.Finish();
+}
+
+void KuduArrayCellBuilder::Reset() {
+  data_->builder.Reset();
+}
+
+////////////////////////////////////////////////////////////
+// KuduArrayCellView
+////////////////////////////////////////////////////////////
+
+class KuduArrayCellView::Data {
+ public:
+  Data() : initialized(false) {}
+
+  // Returns an error unless the element at index 'idx' is non-null, and of
+  // one of the given physical types.
+  Status CheckElement(int idx, std::initializer_list<DataType> types) const {
+    if (PREDICT_FALSE(!initialized)) {
+      return Status::IllegalState("array view is not initialized");
+    }
+    if (PREDICT_FALSE(idx < 0 || idx >= view.num_elements())) {
+      return Status::InvalidArgument(Substitute("index $0 out of bounds for array of $1 elements",
+                                                idx, view.num_elements()));
+    }
+    const DataType physical_type = GetTypeInfo(view.element_type())->physical_type();
+    if (PREDICT_FALSE(std::find(types.begin(), types.end(), physical_type) == types.end())) {
+      return Status::InvalidArgument(Substitute("invalid getter for array of $0",
+                                                GetTypeInfo(view.element_type())->name()));
+    }
+    if (PREDICT_FALSE(view.is_null(idx))) {
+      return Status::NotFound(Substitute("array element $0 is NULL", idx));
+    }
+    return Status::OK();
+  }
+
+  bool initialized;
+  ArrayCellView view;
+};
+
+KuduArrayCellView::KuduArrayCellView()
+    : data_(new Data) {
+}
+
+KuduArrayCellView::~KuduArrayCellView() {
+  delete data_;
+}
+
+Status KuduArrayCellView::Init(const Slice& cell) {
+  data_->initialized = false;
+  RETURN_NOT_OK(data_->view.Init(cell));
+  data_->initialized = true;
+  return Status::OK();
+}
+
+KuduColumnSchema::DataType KuduArrayCellView::element_type() const {
+  DCHECK(data_->initialized);
+  return FromInternalDataType(data_->view.element_type());
+}
+
+int KuduArrayCellView::num_elements() const {
+  return data_->initialized ? data_->view.num_elements() : 0;
+}
+
+bool KuduArrayCellView::IsNull(int idx) const {
+  DCHECK(data_->initialized);
+  return data_->view.is_null(idx);
+}
+
+Status KuduArrayCellView::GetBool(int idx, bool* val) const {
+  RETURN_NOT_OK(data_->CheckElement(idx, { BOOL }));
+  data_->view.GetElement(idx, val);
+  return Status::OK();
+}
+
+Status KuduArrayCellView::GetInt(int idx, int64_t* val) const {
+  RETURN_NOT_OK(data_->CheckElement(idx, { INT8, INT16, INT32, INT64 }));
+  switch (GetTypeInfo(data_->view.element_type())->physical_type()) {
+    case INT8: {
+      int8_t v;
+      data_->view.GetElement(idx, &v);
+      *val = v;
+      break;
+    }
+    case INT16: {
+      int16_t v;
+      data_->view.GetElement(idx, &v);
+      *val = v;
+      break;
+    }
+    case INT32: {
+      int32_t v;
+      data_->view.GetElement(idx, &v);
+      *val = v;
+      break;
+    }
+    default:
+      data_->view.GetElement(idx, val);
+      break;
+  }
+  return Status::OK();
+}
+
+Status KuduArrayCellView::GetDouble(int idx, double* val) const {
+  RETURN_NOT_OK(data_->CheckElement(idx, { FLOAT, DOUBLE }));
+  if (data_->view.element_type() == FLOAT) {
+    float v;
+    data_->view.GetElement(idx, &v);
+    *val = v;
+  } else {
+    data_->view.GetElement(idx, val);
+  }
+  return Status::OK();
+}
+
+Status KuduArrayCellView::GetSlice(int idx, Slice* val) const {
+  RETURN_NOT_OK(data_->CheckElement(idx, { BINARY }));
+  data_->view.GetElement(idx, val);
+  return Status::OK();
+}
+
+} // namespace client
+} // namespace kudu
@@ -0,0 +1,145 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#ifndef KUDU_CLIENT_ARRAY_CELL_H
+#define KUDU_CLIENT_ARRAY_CELL_H
+
+// NOTE: using stdint.h instead of cstdint because this file is supposed
+//       to be processed by a compiler lacking C++11 support.
+#include <stdint.h>
+
+#ifdef KUDU_HEADERS_NO_STUBS
+#include "kudu/gutil/macros.h"
+#else
+#include "kudu/client/stubs.h"
+#endif
+#include "kudu/client/schema.h"
+#include "kudu/util/kudu_export.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace client {
+
+class KuduValue;
+
+/// @brief Builds the values of ARRAY columns.
+///
+/// The values built are set with KuduPartialRow::SetArray(), and are used as
+/// read or write defaults of ARRAY columns.
+///
+/// @note This class is not thread-safe.
+class KUDU_EXPORT KuduArrayCellBuilder {
+ public:
+  /// @param [in] element_type
+  ///   The type of the elements of the array: BOOL, INT8, INT16, INT32,
+  ///   INT64, FLOAT, DOUBLE, UNIXTIME_MICROS, DATE, STRING or BINARY.
+  explicit KuduArrayCellBuilder(KuduColumnSchema::DataType element_type);
+
+  ~KuduArrayCellBuilder();
+
+  /// Append an element to the array.
+  ///
+  /// @param [in] value
+  ///   The value of the element, which is copied.
+  /// @return Operation result status. Returns Status::InvalidArgument if the
+  ///   value can't be converted to the element type.
+  Status Append(const KuduValue& value) WARN_UNUSED_RESULT;
+
+  /// Append a null element to the array.
+  void AppendNull();
+
+  /// @return The number of elements appended so far.
+  int num_elements() const;
+
+  /// @return The encoded array of the elements appended since the builder was
+  ///   created or reset. The data is owned by the builder, and remains valid
+  ///   until the builder is modified or destroyed.
+  Slice Finish();
+
+  /// Discard the elements appended so far.
+  void Reset();
+
+ private:
+  class KUDU_NO_EXPORT Data;
+
+  // Owned.
+  Data* data_;
+
+  DISALLOW_COPY_AND_ASSIGN(KuduArrayCellBuilder);
+};
+
+/// @brief A view of the value of an ARRAY column, e.g. as returned by
+///   KuduScanBatch::RowPtr::GetArray().
+///
+/// The view points into the value, which must outlive it.
+///
+/// @note This class is not thread-safe.
+class KUDU_EXPORT KuduArrayCellView {
+ public:
+  KuduArrayCellView();
+  ~KuduArrayCellView();
+
+  /// Parse an encoded array.
+  ///
+  /// @param [in] cell
+  ///   The encoded array.
+  /// @return Operation result status. Returns Status::Corruption if 'cell'
+  ///   isn't a valid array.
+  Status Init(const Slice& cell) WARN_UNUSED_RESULT;
+
+  /// @return The type of the elements of the array.
+  KuduColumnSchema::DataType element_type() const;
+
+  /// @return The number of elements of the array.
+  int num_elements() const;
+
+  /// @param [in] idx
+  ///   The index of the element.
+  /// @return @c true iff the element at index 'idx' is null.
+  bool IsNull(int idx) const;
+
+  /// @name Getters of the elements.
+  ///
+  /// GetInt() reads the elements of the integer, UNIXTIME_MICROS and DATE
+  /// types, GetDouble() those of the FLOAT and DOUBLE types, and GetSlice()
+  /// those of the STRING and BINARY types, pointing into the array.
+  ///
+  /// @param [in] idx
+  ///   The index of the element.
+  /// @param [out] val
+  ///   The value of the element.
+  /// @return Operation result status. Return a bad Status if the element is
+  ///   null, or if the type of the elements does not match.
+  ///@{
+  Status GetBool(int idx, bool* val) const WARN_UNUSED_RESULT;
+  Status GetInt(int idx, int64_t* val) const WARN_UNUSED_RESULT;
+  Status GetDouble(int idx, double* val) const WARN_UNUSED_RESULT;
+  Status GetSlice(int idx, Slice* val) const WARN_UNUSED_RESULT;
+  ///@}
+
+ private:
+  class KUDU_NO_EXPORT Data;
+
+  // Owned.
+  Data* data_;
+
+  DISALLOW_COPY_AND_ASSIGN(KuduArrayCellView);
+};
+
+} // namespace client
+} // namespace kudu
+#endif /* KUDU_CLIENT_ARRAY_CELL_H */
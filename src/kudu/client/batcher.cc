@@ -17,16 +17,18 @@
 
 #include "kudu/client/batcher.h"
 
+#include <cinttypes>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <ostream>
 #include <string>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/client/callbacks.h"
@@ -48,6 +50,7 @@
 #include "kudu/common/wire_protocol.pb.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/connection.h"
 #include "kudu/rpc/request_tracker.h"
@@ -59,8 +62,12 @@
 #include "kudu/security/token.pb.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/tserver/tserver_service.proxy.h" // IWYU pragma: keep
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/random.h"
+#include "kudu/util/random_util.h"
 
 namespace kudu {
 namespace rpc {
@@ -85,13 +92,18 @@ using kudu::TxnId;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
-using std::unordered_map;
 using std::vector;
 using strings::Substitute;
 
+DEFINE_double(client_write_trace_sampling_rate, 0,
+              "Fraction of the write RPCs to sample for tracing. The write "
+              "requests of the sampled RPCs carry a trace id, under which the "
+              "client logs their latency and the replicas log the traces of "
+              "their ops.");
+TAG_FLAG(client_write_trace_sampling_rate, experimental);
+
 namespace kudu {
 
-class RowOperationsPB;
 class Schema;
 
 namespace client {
@@ -211,10 +223,13 @@ struct InFlightOp {
 // Keeps a reference on the owning batcher while alive.
 class WriteRpc : public RetriableRpc<RemoteTabletServer, WriteRequestPB, WriteResponsePB> {
  public:
+  // If not null, 'encoded_rows' holds the rows of 'ops' already encoded, and
+  // is swapped into the request.
   WriteRpc(const scoped_refptr<Batcher>& batcher,
            const scoped_refptr<MetaCacheServerPicker>& replica_picker,
            const scoped_refptr<RequestTracker>& request_tracker,
            vector<InFlightOp*> ops,
+           RowOperationsPB* encoded_rows,
            const MonoTime& deadline,
            shared_ptr<Messenger> messenger,
            const string& tablet_id,
@@ -266,12 +281,16 @@ class WriteRpc : public RetriableRpc<RemoteTabletServer, WriteRequestPB, WriteRe
 
   // The id of the tablet being written to.
   string tablet_id_;
+
+  // The time the RPC was created at, set only if it's sampled for tracing.
+  MonoTime start_time_;
 };
 
 WriteRpc::WriteRpc(const scoped_refptr<Batcher>& batcher,
                    const scoped_refptr<MetaCacheServerPicker>& replica_picker,
                    const scoped_refptr<RequestTracker>& request_tracker,
                    vector<InFlightOp*> ops,
+                   RowOperationsPB* encoded_rows,
                    const MonoTime& deadline,
                    shared_ptr<Messenger> messenger,
                    const string& tablet_id,
@@ -303,6 +322,19 @@ WriteRpc::WriteRpc(const scoped_refptr<Batcher>& batcher,
     req_.set_txn_id(batcher->txn_id());
   }
 
+  const double sampling_rate = FLAGS_client_write_trace_sampling_rate;
+  if (PREDICT_FALSE(sampling_rate > 0)) {
+    static ThreadSafeRandom rng(GetRandomSeed32());
+    if (rng.NextDoubleFraction() < sampling_rate) {
+      uint64_t trace_id;
+      do {
+        trace_id = rng.Next64();
+      } while (trace_id == 0);
+      req_.set_trace_id(trace_id);
+      start_time_ = MonoTime::Now();
+    }
+  }
+
   // Set up schema
   CHECK_OK(SchemaToPB(*schema, req_.mutable_schema(),
                       SCHEMA_PB_WITHOUT_STORAGE_ATTRIBUTES |
@@ -312,8 +344,11 @@ WriteRpc::WriteRpc(const scoped_refptr<Batcher>& batcher,
   // Pick up the authz token for the table.
   FetchCachedAuthzToken();
   RowOperationsPB* requested = req_.mutable_row_operations();
+  if (encoded_rows) {
+    requested->Swap(encoded_rows);
+  }
 
-  // Add the rows
+  // Add the rows, unless they were encoded already.
   int ctr = 0;
   RowOperationsPBEncoder enc(requested);
   for (InFlightOp* op : ops_) {
@@ -328,7 +363,9 @@ WriteRpc::WriteRpc(const scoped_refptr<Batcher>& batcher,
         << " not in partition " << partition_schema.PartitionDebugString(partition, *schema);
 #endif
 
-    enc.Add(ToInternalWriteType(op->write_op->type()), op->write_op->row());
+    if (!encoded_rows) {
+      enc.Add(ToInternalWriteType(op->write_op->type()), op->write_op->row());
+    }
 
     // Set the state now, even though we haven't yet sent it -- at this point
     // there is no return, and we're definitely going to send it. If we waited
@@ -440,6 +477,12 @@ void WriteRpc::Finish(const Status& status) {
                    ops_.size(), tablet_id_, num_attempts()));
     KLOG_EVERY_N_SECS(WARNING, 1) << final_status.ToString();
   }
+  if (PREDICT_FALSE(req_.has_trace_id())) {
+    LOG(INFO) << Substitute("Sampled write $0 of $1 ops to tablet $2 took $3 in $4 attempt(s): $5",
+                            StringPrintf("%016" PRIx64, req_.trace_id()), ops_.size(),
+                            tablet_id_, (MonoTime::Now() - start_time_).ToString(),
+                            num_attempts(), final_status.ToString());
+  }
   batcher_->ProcessWriteResponse(*this, final_status);
 }
 
@@ -749,6 +792,22 @@ Status Batcher::Add(KuduWriteOperation* write_op) {
   InFlightOp* op = arena_.NewObject<InFlightOp>();
   op->write_op.reset(write_op);
   op->state = InFlightOp::kLookingUpTablet;
+  const auto* table = write_op->table();
+  DCHECK(table);
+  PartitionKey partition_key = table->partition_schema().EncodeKey(write_op->row());
+
+  // If the tablet is in the cache, buffer the op right away: this spares the
+  // lookup callback and its reference to the batcher on every row.
+  if (PREDICT_TRUE(client_->data_->meta_cache_->FastLookupTabletByKey(
+          table, partition_key, MetaCache::LookupType::kPoint, &op->tablet).ok())) {
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      AddInFlightOpUnlocked(op);
+      BufferOpUnlocked(op);
+    }
+    buffer_bytes_used_ += write_op->SizeInBuffer();
+    return Status::OK();
+  }
 
   AddInFlightOp(op);
   VLOG(3) << "Looking up tablet for " << op->ToString();
@@ -759,11 +818,9 @@ Status Batcher::Add(KuduWriteOperation* write_op) {
   MonoTime deadline = ComputeDeadlineUnlocked();
   ++outstanding_lookups_;
   scoped_refptr<Batcher> self(this);
-  const auto* table = write_op->table();
-  DCHECK(table);
   client_->data_->meta_cache_->LookupTabletByKey(
       table,
-      table->partition_schema().EncodeKey(write_op->row()),
+      std::move(partition_key),
       deadline,
       MetaCache::LookupType::kPoint,
       &op->tablet,
@@ -774,9 +831,13 @@ Status Batcher::Add(KuduWriteOperation* write_op) {
 }
 
 void Batcher::AddInFlightOp(InFlightOp* op) {
-  DCHECK_EQ(op->state, InFlightOp::kLookingUpTablet);
-
   std::lock_guard<simple_spinlock> l(lock_);
+  AddInFlightOpUnlocked(op);
+}
+
+void Batcher::AddInFlightOpUnlocked(InFlightOp* op) {
+  DCHECK(lock_.is_locked());
+  DCHECK_EQ(op->state, InFlightOp::kLookingUpTablet);
   CHECK_EQ(state_, kGatheringOps);
   InsertOrDie(&ops_, op);
   op->sequence_number_ = next_op_sequence_number_++;
@@ -840,42 +901,55 @@ void Batcher::TabletLookupFinished(InFlightOp* op, const Status& s) {
     return;
   }
 
-  {
-    std::lock_guard<simple_spinlock> l2(op->lock_);
-    CHECK_EQ(op->state, InFlightOp::kLookingUpTablet);
-    CHECK(op->tablet != NULL);
+  BufferOpUnlocked(op);
+  l.unlock();
+
+  FlushBuffersIfReady();
+}
 
-    op->state = InFlightOp::kBufferedToTabletServer;
+void Batcher::BufferOpUnlocked(InFlightOp* op) {
+  DCHECK(lock_.is_locked());
+  std::lock_guard<simple_spinlock> l(op->lock_);
+  CHECK_EQ(op->state, InFlightOp::kLookingUpTablet);
+  CHECK(op->tablet != NULL);
 
-    vector<InFlightOp*>& to_ts = per_tablet_ops_[op->tablet.get()];
-    to_ts.push_back(op);
+  op->state = InFlightOp::kBufferedToTabletServer;
 
-    // "Reverse bubble sort" the operation into the right spot in the tablet server's
-    // buffer, based on the sequence numbers of the ops.
-    //
-    // There is a rare race (KUDU-743) where two operations in the same batch can get
-    // their order inverted with respect to the order that the user originally performed
-    // the operations. This loop re-sequences them back into the correct order. In
-    // the common case, it will break on the first iteration, so we expect the loop to be
-    // constant time, with worst case O(n). This is usually much better than something
-    // like a priority queue which would have O(lg n) in every case and a more complex
-    // code path.
-    for (int i = to_ts.size() - 1; i > 0; --i) {
-      if (to_ts[i]->sequence_number_ < to_ts[i - 1]->sequence_number_) {
-        std::swap(to_ts[i], to_ts[i - 1]);
-      } else {
-        break;
-      }
+  TabletBuffer& buffer = per_tablet_ops_[op->tablet.get()];
+  vector<InFlightOp*>& to_ts = buffer.ops;
+  to_ts.push_back(op);
+
+  // "Reverse bubble sort" the operation into the right spot in the tablet server's
+  // buffer, based on the sequence numbers of the ops.
+  //
+  // There is a rare race (KUDU-743) where two operations in the same batch can get
+  // their order inverted with respect to the order that the user originally performed
+  // the operations. This loop re-sequences them back into the correct order. In
+  // the common case, it will break on the first iteration, so we expect the loop to be
+  // constant time, with worst case O(n). This is usually much better than something
+  // like a priority queue which would have O(lg n) in every case and a more complex
+  // code path.
+  for (int i = to_ts.size() - 1; i > 0; --i) {
+    if (to_ts[i]->sequence_number_ < to_ts[i - 1]->sequence_number_) {
+      std::swap(to_ts[i], to_ts[i - 1]);
+      buffer.encoded_in_order = false;
+    } else {
+      break;
     }
   }
 
-  l.unlock();
-
-  FlushBuffersIfReady();
+  // Encode the row while it's still hot in the cache, rather than when
+  // flushing the whole batch.
+  if (PREDICT_TRUE(buffer.encoded_in_order)) {
+    RowOperationsPBEncoder enc(&buffer.encoded_rows);
+    enc.Add(ToInternalWriteType(op->write_op->type()), op->write_op->row());
+  } else {
+    buffer.encoded_rows.Clear();
+  }
 }
 
 void Batcher::FlushBuffersIfReady() {
-  unordered_map<RemoteTablet*, vector<InFlightOp*> > ops_copy;
+  OpsMap ops_copy;
 
   // We're only ready to flush if:
   // 1. The batcher is in the flushing state (i.e. FlushAsync was called).
@@ -898,17 +972,16 @@ void Batcher::FlushBuffersIfReady() {
   }
 
   // Now flush the ops for each tablet.
-  for (const OpsMap::value_type& e : ops_copy) {
+  for (OpsMap::value_type& e : ops_copy) {
     RemoteTablet* tablet = e.first;
-    const vector<InFlightOp*>& ops = e.second;
-
     VLOG(3) << "FlushBuffersIfReady: already in flushing state, immediately flushing to "
             << tablet->tablet_id();
-    FlushBuffer(tablet, ops);
+    FlushBuffer(tablet, &e.second);
   }
 }
 
-void Batcher::FlushBuffer(RemoteTablet* tablet, const vector<InFlightOp*>& ops) {
+void Batcher::FlushBuffer(RemoteTablet* tablet, TabletBuffer* buffer) {
+  const vector<InFlightOp*>& ops = buffer->ops;
   CHECK(!ops.empty());
 
   // Create and send an RPC that aggregates the ops. The RPC is freed when
@@ -927,6 +1000,7 @@ void Batcher::FlushBuffer(RemoteTablet* tablet, const vector<InFlightOp*>& ops)
                                server_picker,
                                client_->data_->request_tracker_,
                                ops,
+                               buffer->encoded_in_order ? &buffer->encoded_rows : nullptr,
                                deadline_,
                                client_->data_->messenger_,
                                tablet->tablet_id(),
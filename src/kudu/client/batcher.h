@@ -28,6 +28,7 @@
 #include "kudu/client/client.h"
 #include "kudu/client/shared_ptr.h" // IWYU pragma: keep
 #include "kudu/client/write_op.h"
+#include "kudu/common/row_operations.pb.h"
 #include "kudu/common/txn_id.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
@@ -145,6 +146,13 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
 
   // Add an op to the in-flight set and increment the ref-count.
   void AddInFlightOp(InFlightOp* op);
+  void AddInFlightOpUnlocked(InFlightOp* op);
+
+  // Buffers an op whose tablet was looked up to be sent to the tablet, encoding
+  // its row right away if it comes in sequence order.
+  //
+  // REQUIRES: lock_ is held.
+  void BufferOpUnlocked(InFlightOp* op);
 
   void RemoveInFlightOp(InFlightOp* op);
 
@@ -160,7 +168,8 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
 
   void CheckForFinishedFlush();
   void FlushBuffersIfReady();
-  void FlushBuffer(RemoteTablet* tablet, const std::vector<InFlightOp*>& ops);
+  struct TabletBuffer;
+  void FlushBuffer(RemoteTablet* tablet, TabletBuffer* buffer);
 
   // Cleans up an RPC response, scooping out any errors and passing them up
   // to the batcher.
@@ -210,8 +219,19 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
 
   // All buffered or in-flight ops.
   google::dense_hash_set<InFlightOp*> ops_;
+  // The ops buffered for a tablet, in sequence order.
+  struct TabletBuffer {
+    std::vector<InFlightOp*> ops;
+
+    // The rows of 'ops', encoded as the ops were buffered so that the buffer
+    // is sent as-is. Only valid while 'encoded_in_order' is true: an op
+    // buffered out of sequence order, e.g. after its tablet lookup went to
+    // the master, invalidates it, and the rows are encoded at flush time.
+    RowOperationsPB encoded_rows;
+    bool encoded_in_order = true;
+  };
   // Each tablet's buffered ops.
-  typedef std::unordered_map<RemoteTablet*, std::vector<InFlightOp*> > OpsMap;
+  typedef std::unordered_map<RemoteTablet*, TabletBuffer> OpsMap;
   OpsMap per_tablet_ops_;
 
   // When each operation is added to the batcher, it is assigned a sequence number
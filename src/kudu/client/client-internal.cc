@@ -42,7 +42,9 @@
 #include "kudu/client/master_proxy_rpc.h"
 #include "kudu/client/master_rpc.h"
 #include "kudu/client/meta_cache.h"
+#include "kudu/client/scanner-internal.h"
 #include "kudu/client/schema.h"
+#include "kudu/client/table_locations_watcher.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/partition.h"
 #include "kudu/common/schema.h"
@@ -69,7 +71,10 @@
 #include "kudu/util/net/sockaddr.h"
 #include "kudu/util/openssl_util.h"
 #include "kudu/util/thread_restrictions.h"
+#include "kudu/util/threadpool.h"
 
+DECLARE_bool(client_prefetch_table_locations);
+DECLARE_int32(client_async_scan_max_threads);
 DECLARE_int32(dns_resolver_max_threads_num);
 DECLARE_uint32(dns_resolver_cache_capacity_mb);
 DECLARE_uint32(dns_resolver_cache_ttl_sec);
@@ -112,6 +117,7 @@ using std::set;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::weak_ptr;
 using std::vector;
 using strings::Substitute;
 
@@ -172,8 +178,12 @@ KuduClient::Data::Data()
           FLAGS_dns_resolver_max_threads_num,
           FLAGS_dns_resolver_cache_capacity_mb * 1024 * 1024,
           MonoDelta::FromSeconds(FLAGS_dns_resolver_cache_ttl_sec))),
+      scan_hedging_policy_(new internal::ScanHedgingPolicy),
       hive_metastore_sasl_enabled_(false),
       latest_observed_timestamp_(KuduClient::kNoTimestamp) {
+  CHECK_OK(ThreadPoolBuilder("client-scan")
+           .set_max_threads(FLAGS_client_async_scan_max_threads)
+           .Build(&scan_pool_));
 }
 
 KuduClient::Data::~Data() {
@@ -184,6 +194,7 @@ KuduClient::Data::~Data() {
   // fix urgently, because typically once a client is shutting down, latency
   // jitter on the reactor is not a big deal (and DNS resolutions are not in flight).
   ThreadRestrictions::ScopedAllowWait allow_wait;
+  scan_pool_->Shutdown();
   dns_resolver_.reset();
 }
 
@@ -227,7 +238,8 @@ RemoteTabletServer* KuduClient::Data::SelectTServer(
       break;
     }
     case CLOSEST_REPLICA:
-    case FIRST_REPLICA: {
+    case FIRST_REPLICA:
+    case LEAST_LOADED_REPLICA: {
       rt->GetRemoteTabletServers(candidates);
       // Exclude all the blacklisted candidates.
       vector<RemoteTabletServer*> filtered;
@@ -244,6 +256,22 @@ RemoteTabletServer* KuduClient::Data::SelectTServer(
         }
         break;
       }
+      static const size_t kRandomSelection = GetReplicaRandomSelection();
+      if (selection == LEAST_LOADED_REPLICA) {
+        // Pick the replica with the lowest load score. Start from a random
+        // replica so that ties, e.g. between servers without recent RPCs,
+        // don't always go to the same one.
+        double best_score = 0;
+        for (size_t i = 0; i < filtered.size(); i++) {
+          RemoteTabletServer* rts = filtered[(kRandomSelection + i) % filtered.size()];
+          const double score = rts->LoadScore();
+          if (ret == nullptr || score < best_score) {
+            ret = rts;
+            best_score = score;
+          }
+        }
+        break;
+      }
       // Choose a replica as follows:
       // 1. If there is a replica local to the client according to its IP and
       //    assigned location, pick it. If there are multiple, pick a random one.
@@ -273,7 +301,6 @@ RemoteTabletServer* KuduClient::Data::SelectTServer(
           same_location.push_back(rts);
         }
       }
-      static const size_t kRandomSelection = GetReplicaRandomSelection();
       if (!local.empty()) {
         ret = local[kRandomSelection % local.size()];
       } else if (!same_location.empty()) {
@@ -658,6 +685,12 @@ Status KuduClient::Data::OpenTable(KuduClient* client,
   // current range partitions of a table for up to the ttl.
   meta_cache_->ClearNonCoveredRangeEntries(table_id);
 
+  if (FLAGS_client_prefetch_table_locations) {
+    // This only spares lookups later on: the table can be used in any case.
+    WARN_NOT_OK(meta_cache_->PrefetchTableLocations(table->get(), deadline),
+                "failed to prefetch tablet locations");
+  }
+
   return Status::OK();
 }
 
@@ -955,6 +988,29 @@ string KuduClient::Data::cluster_id() const {
   return cluster_id_;
 }
 
+shared_ptr<internal::TableLocationsWatch> KuduClient::Data::WatchTableLocations(
+    KuduClient* client, const string& table_id) {
+  {
+    std::lock_guard<simple_spinlock> l(locations_watches_lock_);
+    auto watch = FindWithDefault(locations_watches_, table_id, {}).lock();
+    if (watch) {
+      return watch;
+    }
+  }
+  // Start the watch outside of the lock: if another thread raced with this
+  // one, the watch it started is used and this one is stopped.
+  auto watch = std::make_shared<internal::TableLocationsWatch>(
+      std::make_shared<internal::TableLocationsWatcher>(client, table_id));
+  std::lock_guard<simple_spinlock> l(locations_watches_lock_);
+  auto& entry = locations_watches_[table_id];
+  auto other = entry.lock();
+  if (other) {
+    return other;
+  }
+  entry = watch;
+  return watch;
+}
+
 shared_ptr<master::MasterServiceProxy> KuduClient::Data::master_proxy() const {
   std::lock_guard<simple_spinlock> l(leader_master_lock_);
   return master_proxy_;
@@ -23,6 +23,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -45,6 +46,7 @@ namespace kudu {
 
 class DnsResolver;
 class Sockaddr;
+class ThreadPool;
 
 namespace security {
 class SignedTokenPB;
@@ -80,6 +82,8 @@ class ConnectToClusterRpc;
 class MetaCache;
 class RemoteTablet;
 class RemoteTabletServer;
+class ScanHedgingPolicy;
+class TableLocationsWatch;
 } // namespace internal
 
 class KuduClient::Data {
@@ -267,6 +271,11 @@ class KuduClient::Data {
   void StoreAuthzToken(const std::string& table_id,
                        const security::SignedTokenPB& token);
 
+  // Returns a watch of the locations of the tablets of the given table,
+  // shared with the other KuduTable objects of the table that are alive.
+  std::shared_ptr<internal::TableLocationsWatch> WatchTableLocations(
+      KuduClient* client, const std::string& table_id);
+
   std::shared_ptr<master::MasterServiceProxy> master_proxy() const;
   std::shared_ptr<transactions::TxnManagerServiceProxy> txn_manager_proxy() const;
 
@@ -304,6 +313,12 @@ class KuduClient::Data {
   std::shared_ptr<rpc::Messenger> messenger_;
   scoped_refptr<internal::MetaCache> meta_cache_;
 
+  // Decides when the scanners of this client hedge their RPCs.
+  std::unique_ptr<internal::ScanHedgingPolicy> scan_hedging_policy_;
+
+  // Runs the steps of KuduScanner::NextBatchAsync() calls which may block.
+  std::unique_ptr<ThreadPool> scan_pool_;
+
   // Authorization tokens stored for each table, indexed by table ID. Note that
   // these may be expired, and it is up to the user of a token to refresh it
   // upon learning of its expiration.
@@ -363,6 +378,14 @@ class KuduClient::Data {
 
   AtomicInt<uint64_t> latest_observed_timestamp_;
 
+  // The watches of the locations of tables, indexed by table ID: a table is
+  // watched for as long as one of its KuduTable objects is alive.
+  //
+  // Protected by 'locations_watches_lock_'.
+  std::unordered_map<std::string, std::weak_ptr<internal::TableLocationsWatch>>
+      locations_watches_;
+  simple_spinlock locations_watches_lock_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Data);
 };
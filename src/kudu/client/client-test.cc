@@ -47,6 +47,7 @@
 #include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
 
+#include "kudu/client/arrow_c_data.h"
 #include "kudu/client/batcher.h"
 #include "kudu/client/callbacks.h"
 #include "kudu/client/client-internal.h"
@@ -116,6 +117,7 @@
 #include "kudu/util/array_view.h"
 #include "kudu/util/async_util.h"
 #include "kudu/util/barrier.h"
+#include "kudu/util/bitmap.h"
 #include "kudu/util/countdown_latch.h"
 #include "kudu/util/locks.h"  // IWYU pragma: keep
 #include "kudu/util/metrics.h"
@@ -140,6 +142,7 @@ class PartitionKey;
 DECLARE_bool(allow_unsafe_replication_factor);
 DECLARE_bool(catalog_manager_support_live_row_count);
 DECLARE_bool(catalog_manager_support_on_disk_size);
+DECLARE_bool(client_prefetch_table_locations);
 DECLARE_bool(client_use_unix_domain_sockets);
 DECLARE_bool(enable_rowset_compaction);
 DECLARE_bool(enable_txn_system_client_init);
@@ -157,6 +160,9 @@ DECLARE_bool(rpc_trace_negotiation);
 DECLARE_bool(scanner_inject_service_unavailable_on_continue_scan);
 DECLARE_bool(txn_manager_enabled);
 DECLARE_bool(txn_manager_lazily_initialized);
+DECLARE_double(client_scan_hedge_percentile);
+DECLARE_double(client_scan_max_hedge_ratio);
+DECLARE_double(client_write_trace_sampling_rate);
 DECLARE_int32(client_tablet_locations_by_id_ttl_ms);
 DECLARE_int32(check_expired_table_interval_seconds);
 DECLARE_int32(flush_threshold_mb);
@@ -660,6 +666,14 @@ class ClientTest : public KuduTest {
 
       ASSERT_TRUE(ContainsKey(metrics, "bytes_read"));
       ASSERT_GT(metrics["bytes_read"], 0);
+
+      // The blocks of the flushed rows are decoded, but there are neither
+      // deltas to apply nor predicates to evaluate.
+      ASSERT_TRUE(ContainsKey(metrics, "cfile_decode_nanos"));
+      ASSERT_GT(metrics["cfile_decode_nanos"], 0);
+      ASSERT_TRUE(ContainsKey(metrics, "delta_apply_nanos"));
+      ASSERT_TRUE(ContainsKey(metrics, "predicate_eval_nanos"));
+      ASSERT_EQ(0, metrics["predicate_eval_nanos"]);
     }
   }
 
@@ -1206,6 +1220,92 @@ TEST_F(ClientTest, TestConfiguringScannerLimits) {
   ASSERT_EQ(kLimit, count);
 }
 
+// Test that a scanner prefetching its batches returns every row, and that it
+// may be closed while prefetching.
+TEST_F(ClientTest, TestScanPrefetching) {
+  const int64_t kNumRows = 1000;
+  NO_FATALS(InsertTestRows(client_table_.get(), kNumRows));
+
+  KuduScanner scanner(client_table_.get());
+  ASSERT_OK(scanner.SetPrefetching(true));
+  ASSERT_OK(scanner.SetBatchSizeBytes(100));
+  ASSERT_OK(scanner.Open());
+  int64_t count = 0;
+  KuduScanBatch batch;
+  while (scanner.HasMoreRows()) {
+    ASSERT_OK(scanner.NextBatch(&batch));
+    count += batch.NumRows();
+  }
+  ASSERT_EQ(kNumRows, count);
+
+  KuduScanner closed_scanner(client_table_.get());
+  ASSERT_OK(closed_scanner.SetPrefetching(true));
+  ASSERT_OK(closed_scanner.SetBatchSizeBytes(100));
+  ASSERT_OK(closed_scanner.Open());
+  ASSERT_OK(closed_scanner.NextBatch(&batch));
+  ASSERT_TRUE(closed_scanner.HasMoreRows());
+  closed_scanner.Close();
+}
+
+// Test that one thread can drive many scans with NextBatchAsync().
+TEST_F(ClientTest, TestNextBatchAsync) {
+  const int64_t kNumRows = 1000;
+  const int kNumScanners = 10;
+  NO_FATALS(InsertTestRows(client_table_.get(), kNumRows));
+
+  // Counts the rows of a scan, fetching each batch from the callback of the
+  // previous one.
+  class AsyncScan : public KuduStatusCallback {
+   public:
+    explicit AsyncScan(KuduTable* table) : scanner_(table) {}
+
+    Status Start(bool prefetching) {
+      RETURN_NOT_OK(scanner_.SetPrefetching(prefetching));
+      RETURN_NOT_OK(scanner_.SetBatchSizeBytes(100));
+      RETURN_NOT_OK(scanner_.Open());
+      Run(Status::OK());
+      return Status::OK();
+    }
+
+    void Run(const Status& s) override {
+      if (!s.ok()) {
+        done_.StatusCB(s);
+        return;
+      }
+      num_rows_ += batch_.NumRows();
+      if (scanner_.HasMoreRows()) {
+        scanner_.NextBatchAsync(&batch_, this);
+        return;
+      }
+      done_.StatusCB(Status::OK());
+    }
+
+    Status Wait() {
+      return done_.Wait();
+    }
+
+    int64_t num_rows() const {
+      return num_rows_;
+    }
+
+   private:
+    KuduScanner scanner_;
+    KuduScanBatch batch_;
+    int64_t num_rows_ = 0;
+    Synchronizer done_;
+  };
+
+  vector<unique_ptr<AsyncScan>> scans;
+  for (int i = 0; i < kNumScanners; i++) {
+    scans.emplace_back(new AsyncScan(client_table_.get()));
+    ASSERT_OK(scans.back()->Start(i % 2 == 0));
+  }
+  for (const auto& scan : scans) {
+    ASSERT_OK(scan->Wait());
+    ASSERT_EQ(kNumRows, scan->num_rows());
+  }
+}
+
 // Test various scanner limits.
 TEST_F(ClientTest, TestRandomizedLimitScans) {
   const string kTableName = "table";
@@ -1421,6 +1521,114 @@ TEST_F(ClientTest, TestColumnarScan) {
   ASSERT_EQ(num_rows, total_rows);
 }
 
+// Test that the exported Arrow arrays hold the data of the batches, and
+// outlive them.
+TEST_F(ClientTest, TestColumnarScanExportToArrow) {
+  const int kNumRows = 1000;
+  FLAGS_scanner_batch_size_rows = 100;
+  NO_FATALS(InsertTestRows(client_table_.get(), kNumRows));
+  KuduScanner scanner(client_table_.get());
+  ASSERT_OK(scanner.SetRowFormatFlags(KuduScanner::COLUMNAR_LAYOUT));
+  ASSERT_OK(scanner.Open());
+
+  vector<ArrowArray> arrays;
+  vector<ArrowSchema> schemas;
+  KuduColumnarScanBatch batch;
+  while (scanner.HasMoreRows()) {
+    ASSERT_OK(scanner.NextBatch(&batch));
+    ArrowArray array;
+    ArrowSchema schema;
+    ASSERT_OK(batch.ExportToArrow(&array, &schema));
+    ASSERT_EQ(0, batch.NumRows());
+    arrays.emplace_back(array);
+    schemas.emplace_back(schema);
+  }
+
+  int total_rows = 0;
+  for (int b = 0; b < arrays.size(); b++) {
+    ArrowSchema* schema = &schemas[b];
+    ASSERT_STREQ("+s", schema->format);
+    ASSERT_EQ(4, schema->n_children);
+    ASSERT_STREQ("key", schema->children[0]->name);
+    ASSERT_STREQ("i", schema->children[0]->format);
+    ASSERT_EQ(0, schema->children[0]->flags);
+    ASSERT_STREQ("string_val", schema->children[2]->name);
+    ASSERT_STREQ("u", schema->children[2]->format);
+    ASSERT_EQ(ARROW_FLAG_NULLABLE, schema->children[2]->flags);
+
+    ArrowArray* array = &arrays[b];
+    ASSERT_EQ(4, array->n_children);
+    const auto* keys = static_cast<const int32_t*>(array->children[0]->buffers[1]);
+    const auto* int_vals = static_cast<const int32_t*>(array->children[1]->buffers[1]);
+    const ArrowArray* strings = array->children[2];
+    ASSERT_EQ(3, strings->n_buffers);
+    ASSERT_NE(nullptr, strings->buffers[0]);
+    const auto* offsets = static_cast<const int32_t*>(strings->buffers[1]);
+    const auto* chars = static_cast<const char*>(strings->buffers[2]);
+    for (int i = 0; i < array->length; i++) {
+      const int row_idx = total_rows + i;
+      EXPECT_EQ(row_idx, keys[i]);
+      EXPECT_EQ(row_idx * 2, int_vals[i]);
+      EXPECT_EQ(Substitute("hello $0", row_idx),
+                string(chars + offsets[i], offsets[i + 1] - offsets[i]));
+    }
+    total_rows += array->length;
+
+    array->release(array);
+    ASSERT_EQ(nullptr, array->release);
+    schema->release(schema);
+    ASSERT_EQ(nullptr, schema->release);
+  }
+  ASSERT_EQ(kNumRows, total_rows);
+}
+
+// Test that the columns of successive batches can be appended to the same
+// Arrow buffers.
+TEST_F(ClientTest, TestColumnarScanCopyToArrowBuffers) {
+  const int kNumRows = 1000;
+  FLAGS_scanner_batch_size_rows = 100;
+  NO_FATALS(InsertTestRows(client_table_.get(), kNumRows));
+  KuduScanner scanner(client_table_.get());
+  ASSERT_OK(scanner.SetRowFormatFlags(KuduScanner::COLUMNAR_LAYOUT));
+  ASSERT_OK(scanner.Open());
+
+  vector<int32_t> keys(kNumRows);
+  vector<uint8_t> key_validity(BitmapSize(kNumRows));
+  vector<int32_t> offsets(kNumRows + 1);
+  vector<uint8_t> validity(BitmapSize(kNumRows));
+  vector<uint8_t> chars(kNumRows * 16);
+  KuduColumnarScanBatch batch;
+  int64_t total_rows = 0;
+  while (scanner.HasMoreRows()) {
+    ASSERT_OK(scanner.NextBatch(&batch));
+    ASSERT_OK(batch.CopyColumnToArrowBuffers(0, total_rows, key_validity.data(), keys.data(),
+                                             nullptr, 0));
+    if (batch.NumRows() > 0) {
+      // The string column is nullable, and its data doesn't fit in 1 byte.
+      Status s = batch.CopyColumnToArrowBuffers(2, total_rows, nullptr, offsets.data(),
+                                                chars.data(), chars.size());
+      ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+      s = batch.CopyColumnToArrowBuffers(2, total_rows, validity.data(), offsets.data(),
+                                         chars.data(), 1);
+      ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    }
+    ASSERT_OK(batch.CopyColumnToArrowBuffers(2, total_rows, validity.data(), offsets.data(),
+                                             chars.data(), chars.size()));
+    total_rows += batch.NumRows();
+  }
+  ASSERT_EQ(kNumRows, total_rows);
+
+  ASSERT_EQ(0, offsets[0]);
+  for (int i = 0; i < kNumRows; i++) {
+    EXPECT_EQ(i, keys[i]);
+    EXPECT_TRUE(BitmapTest(key_validity.data(), i));
+    EXPECT_TRUE(BitmapTest(validity.data(), i));
+    EXPECT_EQ(Substitute("hello $0", i),
+              string(reinterpret_cast<const char*>(chars.data()) + offsets[i],
+                     offsets[i + 1] - offsets[i]));
+  }
+}
+
 const KuduScanner::ReadMode read_modes[] = {
     KuduScanner::READ_LATEST,
     KuduScanner::READ_AT_SNAPSHOT,
@@ -2384,6 +2592,38 @@ TEST_F(ClientTest, TestMinMaxRangeBounds) {
       .Create());
 }
 
+TEST_F(ClientTest, TestPrefetchTableLocations) {
+  constexpr const int kNumTablets = 20;
+  shared_ptr<KuduTable> table;
+  {
+    vector<unique_ptr<KuduPartialRow>> rows;
+    for (int i = 1; i < kNumTablets; ++i) {
+      unique_ptr<KuduPartialRow> row(schema_.NewRow());
+      ASSERT_OK(row->SetInt32(0, i * 10));
+      rows.emplace_back(std::move(row));
+    }
+    ASSERT_OK(CreateTable("prefetched", 1, std::move(rows), {}, &table));
+  }
+  // Make sure every tablet has a leader.
+  NO_FATALS(InsertTestRows(table.get(), kNumTablets * 10));
+
+  FLAGS_client_prefetch_table_locations = true;
+  shared_ptr<KuduClient> client;
+  ASSERT_OK(cluster_->CreateClient(nullptr, &client));
+  const int lookups_before = CountMasterLookupRPCs();
+  ASSERT_OK(client->OpenTable("prefetched", &table));
+
+  // A single lookup fetched the locations of all the tablets.
+  ASSERT_EQ(1, CountMasterLookupRPCs() - lookups_before);
+  for (int i = 0; i < kNumTablets; ++i) {
+    unique_ptr<KuduPartialRow> row(schema_.NewRow());
+    ASSERT_OK(row->SetInt32(0, i * 10));
+    ASSERT_OK(client->data_->meta_cache_->FastLookupTabletByKey(
+        table.get(), table->partition_schema().EncodeKey(*row),
+        internal::MetaCache::LookupType::kPoint, nullptr));
+  }
+}
+
 TEST_F(ClientTest, TestMetaCacheExpiry) {
   FLAGS_table_locations_ttl_ms = 25;
   auto& meta_cache = client_->data_->meta_cache_;
@@ -2658,6 +2898,56 @@ TEST_F(ClientTest, TestMetaCacheLookupNoLeaders) {
   ASSERT_TRUE(has_leader());
 }
 
+TEST_F(ClientTest, TestLeastLoadedReplicaSelection) {
+  const int kNumRows = 100;
+  shared_ptr<KuduTable> table;
+  ASSERT_OK(CreateTable("least_loaded", 3, {}, {}, &table));
+  NO_FATALS(InsertTestRows(table.get(), kNumRows));
+  ASSERT_EQ(kNumRows, CountRowsFromClient(table.get(),
+                                          KuduClient::LEAST_LOADED_REPLICA,
+                                          KuduScanner::READ_LATEST));
+
+  scoped_refptr<internal::RemoteTablet> rt;
+  vector<internal::RemoteTabletServer*> tservers;
+  ASSERT_EVENTUALLY([&] {
+    rt = MetaCacheLookup(table.get(), {});
+    ASSERT_TRUE(rt);
+    rt->GetRemoteTabletServers(&tservers);
+    if (tservers.size() != 3) {
+      rt->MarkStale();
+    }
+    ASSERT_EQ(3, tservers.size());
+  });
+
+  // Make all the servers but one look slow: the remaining one is picked.
+  for (int i = 0; i < 2; i++) {
+    tservers[i]->StartRpc();
+    tservers[i]->FinishRpc(MonoDelta::FromSeconds(10));
+  }
+  set<string> blacklist;
+  vector<internal::RemoteTabletServer*> candidates;
+  ASSERT_EQ(tservers[2], client_->data_->SelectTServer(
+      rt, KuduClient::LEAST_LOADED_REPLICA, blacklist, &candidates));
+
+  // RPCs in flight count towards the load too.
+  for (int i = 0; i < 10; i++) {
+    tservers[2]->StartRpc();
+  }
+  tservers[2]->FinishRpc(MonoDelta::FromSeconds(2));
+  internal::RemoteTabletServer* picked = client_->data_->SelectTServer(
+      rt, KuduClient::LEAST_LOADED_REPLICA, blacklist, &candidates);
+  ASSERT_TRUE(picked == tservers[0] || picked == tservers[1]);
+  for (int i = 0; i < 9; i++) {
+    tservers[2]->FinishRpc(MonoDelta::FromMilliseconds(1));
+  }
+
+  // Blacklisted servers aren't picked, however idle.
+  blacklist.insert(tservers[2]->permanent_uuid());
+  picked = client_->data_->SelectTServer(
+      rt, KuduClient::LEAST_LOADED_REPLICA, blacklist, &candidates);
+  ASSERT_TRUE(picked == tservers[0] || picked == tservers[1]);
+}
+
 TEST_F(ClientTest, TestGetTabletServerBlacklist) {
   shared_ptr<KuduTable> table;
   ASSERT_OK(CreateTable("blacklist",
@@ -2716,6 +3006,7 @@ TEST_F(ClientTest, TestGetTabletServerBlacklist) {
   selections.push_back(KuduClient::LEADER_ONLY);
   selections.push_back(KuduClient::CLOSEST_REPLICA);
   selections.push_back(KuduClient::FIRST_REPLICA);
+  selections.push_back(KuduClient::LEAST_LOADED_REPLICA);
   for (KuduClient::ReplicaSelection selection : selections) {
     Status s = client_->data_->GetTabletServer(client_.get(), rt, selection,
                                                blacklist, &candidates, &rts);
@@ -3133,6 +3424,15 @@ static void DoVerifyMetrics(const KuduSession* session,
   ASSERT_EQ(delete_ignore_errors, metrics["delete_ignore_errors"]);
 }
 
+// Test that the writes sampled for tracing, whose trace ids are replicated
+// along with their ops, are applied as the others.
+TEST_F(ClientTest, TestSampledWriteTraces) {
+  constexpr int kNumRows = 100;
+  FLAGS_client_write_trace_sampling_rate = 1;
+  NO_FATALS(InsertTestRows(client_table_.get(), kNumRows));
+  ASSERT_EQ(kNumRows, CountRowsFromClient(client_table_.get()));
+}
+
 TEST_F(ClientTest, TestInsertIgnore) {
   shared_ptr<KuduSession> session = client_->NewSession();
   session->SetTimeoutMillis(10000);
@@ -3602,6 +3902,36 @@ TEST_F(ClientTest, TestMultipleMultiRowManualBatches) {
             "int32 non_null_with_default=12345)", rows[0]);
 }
 
+// Test that the ops of a batch are applied in order when some of them are
+// routed with cached tablet locations and others wait for a master lookup.
+TEST_F(ClientTest, TestBatchOrderWithColdMetaCache) {
+  constexpr const int kNumBatches = 10;
+  constexpr const int kRowsPerBatch = 50;
+  shared_ptr<KuduSession> session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(KuduSession::MANUAL_FLUSH));
+  for (int batch = 0; batch < kNumBatches; batch++) {
+    client_->data_->meta_cache_->ClearCache();
+    for (int i = 0; i < kRowsPerBatch; i++) {
+      const int key = batch * kRowsPerBatch + i;
+      ASSERT_OK(ApplyInsertToSession(session.get(), client_table_, key, 1, "row"));
+      ASSERT_OK(ApplyUpdateToSession(session.get(), client_table_, key, key));
+    }
+    FlushSessionOrDie(session);
+  }
+
+  // Every row has the value of its update.
+  vector<string> expected_rows;
+  for (int key = 0; key < kNumBatches * kRowsPerBatch; key++) {
+    expected_rows.emplace_back(Substitute(
+        R"((int32 key=$0, int32 int_val=$0, string string_val="row", )"
+        "int32 non_null_with_default=12345)", key));
+  }
+  std::sort(expected_rows.begin(), expected_rows.end());
+  vector<string> rows;
+  ASSERT_OK(ScanTableToStrings(client_table_.get(), &rows, ScannedRowsOrder::kSorted));
+  ASSERT_EQ(expected_rows, rows);
+}
+
 // Test a batch where one of the inserted rows succeeds while another fails.
 // 1. Insert duplicate keys.
 TEST_F(ClientTest, TestBatchWithPartialErrorOfDuplicateKeys) {
@@ -5676,6 +6006,35 @@ TEST_F(ClientTest, TestReplicatedMultiTabletTableFailover) {
   }
 }
 
+// Test that hedging the RPCs opening scans of replicated tablets doesn't
+// change what the scans return.
+TEST_F(ClientTest, TestReplicatedMultiTabletTableHedgedScans) {
+  const string kReplicatedTable = "replicated_hedged_scans";
+  const int kNumRowsToWrite = 100;
+  const int kNumReplicas = 3;
+  const int kNumScans = AllowSlowTests() ? 200 : 60;
+
+  shared_ptr<KuduTable> table;
+  ASSERT_OK(CreateTable(kReplicatedTable,
+                        kNumReplicas,
+                        GenerateSplitRows(),
+                        {},
+                        &table));
+  NO_FATALS(InsertTestRows(table.get(), kNumRowsToWrite));
+
+  // Hedge nearly every RPC once enough latencies have been observed.
+  FLAGS_client_scan_hedge_percentile = 1;
+  FLAGS_client_scan_max_hedge_ratio = 1;
+  for (int i = 0; i < kNumScans; i++) {
+    ASSERT_EQ(kNumRowsToWrite, CountRowsFromClient(table.get(),
+                                                   KuduClient::CLOSEST_REPLICA,
+                                                   KuduScanner::READ_LATEST));
+    ASSERT_EQ(kNumRowsToWrite, CountRowsFromClient(table.get(),
+                                                   KuduClient::FIRST_REPLICA,
+                                                   KuduScanner::READ_AT_SNAPSHOT));
+  }
+}
+
 // This test that we can keep writing to a tablet when the leader
 // tablet dies.
 TEST_F(ClientTest, TestReplicatedTabletWritesWithLeaderElection) {
@@ -6080,7 +6439,7 @@ TEST_F(ClientTest, TestCreateTableWithInvalidEncodings) {
   KuduSchema schema;
   KuduSchemaBuilder schema_builder;
   schema_builder.AddColumn("key")->Type(KuduColumnSchema::INT32)->NotNull()->PrimaryKey()
-      ->Encoding(KuduColumnStorageAttributes::DICT_ENCODING);
+      ->Encoding(KuduColumnStorageAttributes::PREFIX_ENCODING);
   ASSERT_OK(schema_builder.Build(&schema));
   Status s = table_creator->table_name("foobar")
       .schema(&schema)
@@ -6089,7 +6448,7 @@ TEST_F(ClientTest, TestCreateTableWithInvalidEncodings) {
   ASSERT_TRUE(s.IsNotSupported()) << s.ToString();
   ASSERT_STR_CONTAINS(s.ToString(),
                       "invalid encoding for column 'key': encoding "
-                      "DICT_ENCODING not supported for type INT32");
+                      "PREFIX_ENCODING not supported for type INT32");
 }
 
 TEST_F(ClientTest, TestCreateTableWithTooManyColumns) {
@@ -7438,6 +7797,32 @@ TEST_F(ClientTest, TestPartitioner) {
     ASSERT_NEAR(counts_by_partition[i], expected_per_partition, fuzziness);
   }
 
+  // Partitioning a batch of rows, sorted or not, should give the same
+  // results as partitioning the rows one at a time.
+  {
+    vector<unique_ptr<KuduPartialRow>> rows;
+    vector<const KuduPartialRow*> batch;
+    for (int i = 0; i < 1000; i++) {
+      rows.emplace_back(table->schema().NewRow());
+      ASSERT_OK(rows.back()->SetInt32(0, i * 10));
+      batch.emplace_back(rows.back().get());
+    }
+    for (bool shuffle : { false, true }) {
+      if (shuffle) {
+        std::mt19937 gen(SeedRandom());
+        std::shuffle(batch.begin(), batch.end(), gen);
+      }
+      vector<int> partitions;
+      ASSERT_OK(part->PartitionRows(batch, &partitions));
+      ASSERT_EQ(batch.size(), partitions.size());
+      for (size_t i = 0; i < batch.size(); i++) {
+        int part_index;
+        ASSERT_OK(part->PartitionRow(*batch[i], &part_index));
+        ASSERT_EQ(part_index, partitions[i]);
+      }
+    }
+  }
+
   // Drop the first and third range partition.
   unique_ptr<KuduTableAlterer> alterer(client_->NewTableAlterer(kTableName));
   alterer->DropRangePartition(schema_.NewRow(), new KuduPartialRow(*split_rows[0]));
@@ -7470,6 +7855,15 @@ TEST_F(ClientTest, TestPartitioner) {
   ASSERT_OK(row->SetInt32(0, 8000));
   ASSERT_OK(part->PartitionRow(*row, &part_index));
   ASSERT_EQ(-1, part_index);
+
+  unique_ptr<KuduPartialRow> covered_row(table->schema().NewRow());
+  ASSERT_OK(covered_row->SetInt32(0, 5000));
+  vector<int> partitions;
+  ASSERT_OK(part->PartitionRows({ row.get(), covered_row.get(), row.get() }, &partitions));
+  ASSERT_EQ(3, partitions.size());
+  ASSERT_EQ(-1, partitions[0]);
+  ASSERT_GE(partitions[1], 0);
+  ASSERT_EQ(-1, partitions[2]);
 }
 
 TEST_F(ClientTest, TestInvalidPartitionerBuilder) {
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <memory>
@@ -31,6 +32,7 @@
 #include <type_traits>
 #include <vector>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <google/protobuf/stubs/common.h>
 
@@ -56,6 +58,7 @@
 #include "kudu/client/table-internal.h"
 #include "kudu/client/table_alterer-internal.h"
 #include "kudu/client/table_creator-internal.h"
+#include "kudu/client/table_locations_watcher.h"
 #include "kudu/client/table_statistics-internal.h"
 #include "kudu/client/tablet-internal.h"
 #include "kudu/client/tablet_server-internal.h"
@@ -75,6 +78,7 @@
 #include "kudu/common/wire_protocol.pb.h"
 #include "kudu/consensus/metadata.pb.h"
 #include "kudu/gutil/casts.h"
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/numbers.h"
@@ -95,6 +99,7 @@
 #include "kudu/util/async_util.h"
 #include "kudu/util/debug-util.h"
 #include "kudu/util/init.h"
+#include "kudu/util/int128.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/logging_callback.h"
 #include "kudu/util/monotime.h"
@@ -102,8 +107,11 @@
 #include "kudu/util/oid_generator.h"
 #include "kudu/util/openssl_util.h"
 #include "kudu/util/scoped_cleanup.h"
+#include "kudu/util/threadpool.h"
 #include "kudu/util/version_info.h"
 
+DECLARE_bool(client_watch_table_locations);
+
 using kudu::client::internal::AsyncLeaderMasterRpc;
 using kudu::client::internal::MetaCache;
 using kudu::client::sp::shared_ptr;
@@ -515,6 +523,10 @@ Status KuduTransaction::Commit() {
   return data_->Commit(KuduTransaction::Data::CommitMode::WAIT_FOR_COMPLETION);
 }
 
+Status KuduTransaction::CommitAndWaitForTimestamp() {
+  return data_->Commit(KuduTransaction::Data::CommitMode::WAIT_FOR_COMMIT_TIMESTAMP);
+}
+
 Status KuduTransaction::StartCommit() {
   return data_->Commit(KuduTransaction::Data::CommitMode::START_ONLY);
 }
@@ -779,12 +791,18 @@ Status KuduClient::GetTableStatistics(const string& table_name,
   if (resp.has_error()) {
     return StatusFromPB(resp.error().status());
   }
+  map<string, master::ColumnStatisticsPB> column_statistics;
+  for (auto& stats : *resp.mutable_column_statistics()) {
+    string column_name = stats.column_name();
+    column_statistics.emplace(std::move(column_name), std::move(stats));
+  }
   unique_ptr<KuduTableStatistics> table_statistics(new KuduTableStatistics);
   table_statistics->data_ = new KuduTableStatistics::Data(
       resp.has_on_disk_size() ? optional<int64_t>(resp.on_disk_size()) : nullopt,
       resp.has_live_row_count() ? optional<int64_t>(resp.live_row_count()) : nullopt,
       resp.has_disk_size_limit() ? optional<int64_t>(resp.disk_size_limit()) : nullopt,
-      resp.has_row_count_limit() ? optional<int64_t>(resp.row_count_limit()) : nullopt);
+      resp.has_row_count_limit() ? optional<int64_t>(resp.row_count_limit()) : nullopt,
+      std::move(column_statistics));
 
   *statistics = table_statistics.release();
   return Status::OK();
@@ -1196,6 +1214,74 @@ int64_t KuduTableStatistics::live_row_count_limit() const {
   return data_->live_row_count_limit_ ? *data_->live_row_count_limit_ : -1;
 }
 
+namespace {
+
+// Returns the minimum or maximum 'value' of the column statistics 'stats', in the
+// in-memory format of the physical type of the column, or null if it can't be
+// represented.
+KuduValue* ColumnStatisticsValue(const master::ColumnStatisticsPB& stats, const string& value) {
+  // Reads a value of type T from 'value', if of the right size.
+  auto read = [&value](auto* dst) {
+    if (value.size() != sizeof(*dst)) {
+      return false;
+    }
+    memcpy(dst, value.data(), sizeof(*dst));
+    return true;
+  };
+  switch (stats.type()) {
+    case INT8: { int8_t v; return read(&v) ? KuduValue::FromInt(v) : nullptr; }
+    case INT16: { int16_t v; return read(&v) ? KuduValue::FromInt(v) : nullptr; }
+    case INT32:
+    case DATE: { int32_t v; return read(&v) ? KuduValue::FromInt(v) : nullptr; }
+    case INT64:
+    case UNIXTIME_MICROS: { int64_t v; return read(&v) ? KuduValue::FromInt(v) : nullptr; }
+    case FLOAT: { float v; return read(&v) ? KuduValue::FromFloat(v) : nullptr; }
+    case DOUBLE: { double v; return read(&v) ? KuduValue::FromDouble(v) : nullptr; }
+    case BOOL: { bool v; return read(&v) ? KuduValue::FromBool(v) : nullptr; }
+    case DECIMAL32: {
+      int32_t v;
+      return read(&v) ? KuduValue::FromDecimal(v, stats.type_attributes().scale()) : nullptr;
+    }
+    case DECIMAL64: {
+      int64_t v;
+      return read(&v) ? KuduValue::FromDecimal(v, stats.type_attributes().scale()) : nullptr;
+    }
+    case DECIMAL128: {
+      int128_t v;
+      return read(&v) ? KuduValue::FromDecimal(v, stats.type_attributes().scale()) : nullptr;
+    }
+    default: return nullptr;
+  }
+}
+
+} // anonymous namespace
+
+Status KuduTableStatistics::GetColumnStatistics(const string& column_name,
+                                                int64_t* null_count,
+                                                int64_t* distinct_count,
+                                                KuduValue** min_value,
+                                                KuduValue** max_value) const {
+  const auto* stats = FindOrNull(data_->column_statistics_, column_name);
+  if (!stats) {
+    return Status::NotFound(Substitute("no statistics for column $0", column_name));
+  }
+  if (null_count) {
+    *null_count = stats->null_count();
+  }
+  if (distinct_count) {
+    *distinct_count = stats->distinct_count();
+  }
+  if (min_value) {
+    *min_value = stats->has_min_value() ? ColumnStatisticsValue(*stats, stats->min_value())
+                                        : nullptr;
+  }
+  if (max_value) {
+    *max_value = stats->has_max_value() ? ColumnStatisticsValue(*stats, stats->max_value())
+                                        : nullptr;
+  }
+  return Status::OK();
+}
+
 std::string KuduTableStatistics::ToString() const {
   return data_->ToString();
 }
@@ -1215,6 +1301,9 @@ KuduTable::KuduTable(const shared_ptr<KuduClient>& client,
                      const map<string, string>& extra_configs)
   : data_(new KuduTable::Data(client, name, id, num_replicas, owner, comment,
                               schema, partition_schema, extra_configs)) {
+  if (FLAGS_client_watch_table_locations) {
+    data_->locations_watch_ = client->data_->WatchTableLocations(client.get(), id);
+  }
 }
 
 KuduTable::~KuduTable() {
@@ -1378,6 +1467,19 @@ KuduPredicate* KuduTable::NewInListPredicate(const Slice& col_name,
   });
 }
 
+KuduPredicate* KuduTable::NewArrayContainsPredicate(const Slice& col_name,
+                                                    vector<KuduValue*>* values) {
+  // We always take ownership of values; this ensures cleanup if the predicate is invalid.
+  auto cleanup = MakeScopedCleanup([&]() {
+    STLDeleteElements(values);
+  });
+  return data_->MakePredicate(col_name, [&](const ColumnSchema& col_schema) {
+    // Ownership of values is passed to the valid returned predicate.
+    cleanup.cancel();
+    return new KuduPredicate(new ArrayContainsPredicateData(col_schema, values));
+  });
+}
+
 KuduPredicate* KuduTable::NewIsNotNullPredicate(const Slice& col_name) {
   return data_->MakePredicate(col_name, [&](const ColumnSchema& col_schema) {
     return new KuduPredicate(new IsNotNullPredicateData(col_schema));
@@ -1899,6 +2001,11 @@ Status KuduScanner::SetDiffScan(uint64_t start_timestamp, uint64_t end_timestamp
   return data_->mutable_configuration()->SetDiffScan(start_timestamp, end_timestamp);
 }
 
+Status KuduScanner::SetPrefetching(bool prefetching) {
+  data_->prefetching_ = prefetching;
+  return Status::OK();
+}
+
 Status KuduScanner::SetSelection(KuduClient::ReplicaSelection selection) {
   if (data_->open_) {
     return Status::IllegalState("Replica selection must be set before Open()");
@@ -2109,9 +2216,20 @@ void KuduScanner::Close() {
     closer->controller.set_timeout(data_->configuration().timeout());
     // CloseCallback::Callback() deletes the closer.
     CloseCallback* closer_raw = closer.release();
-    data_->proxy_->ScanAsync(data_->next_req_, &closer_raw->response, &closer_raw->controller,
-                             [closer_raw]() { closer_raw->Callback(); });
+    auto send_close = [closer_raw, proxy = data_->proxy_, req = data_->next_req_]() {
+      proxy->ScanAsync(req, &closer_raw->response, &closer_raw->controller,
+                       [closer_raw]() { closer_raw->Callback(); });
+    };
+    if (data_->pending_rpc_) {
+      // Close the scanner once the RPC sent ahead has finished, without
+      // waiting for it. The callback keeps the RPC's buffers alive until then.
+      auto* rpc = data_->pending_rpc_.get();
+      rpc->OnFinished([send_close, rpc_ref = std::move(data_->pending_rpc_)]() { send_close(); });
+    } else {
+      send_close();
+    }
   }
+  data_->pending_rpc_.reset();
   data_->proxy_.reset();
   data_->open_ = false;
   return;
@@ -2145,11 +2263,6 @@ Status KuduScanner::NextBatch(KuduColumnarScanBatch* batch) {
 }
 
 Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
-
-  // TODO: do some double-buffering here -- when we return this batch
-  // we should already have fired off the RPC for the next batch, but
-  // need to do some swapping of the response objects around to avoid
-  // stomping on the memory the user is looking at.
   CHECK(data_->open_);
 
   batch_data->Clear();
@@ -2163,6 +2276,7 @@ Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
     CHECK(data_->proxy_);
     VLOG(2) << "Extracting data from " << data_->DebugString();
     data_->data_in_open_ = false;
+    data_->MaybePrefetch();
     return batch_data->Reset(&data_->controller_,
                              data_->configuration().projection(),
                              data_->configuration().client_projection(),
@@ -2175,19 +2289,26 @@ Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
     CHECK(data_->proxy_);
     VLOG(2) << "Continuing " << data_->DebugString();
 
+    // Any retries get the full timeout, even if the RPC for this batch was
+    // sent ahead.
     MonoTime batch_deadline = MonoTime::Now() + data_->configuration().timeout();
-    data_->PrepareRequest(KuduScanner::Data::CONTINUE);
+    bool allow_time_for_failover = data_->configuration().is_fault_tolerant();
+    ScanRpcStatus result;
+    if (data_->pending_rpc_) {
+      result = data_->TakePendingScanRpc();
+    } else {
+      data_->PrepareRequest(KuduScanner::Data::CONTINUE);
+      result = data_->SendScanRpc(batch_deadline, allow_time_for_failover);
+    }
 
     while (true) {
-      bool allow_time_for_failover = data_->configuration().is_fault_tolerant();
-      ScanRpcStatus result = data_->SendScanRpc(batch_deadline, allow_time_for_failover);
-
       // Success case.
       if (result.result == ScanRpcStatus::OK) {
         if (data_->last_response_.has_last_primary_key()) {
           data_->last_primary_key_ = data_->last_response_.last_primary_key();
         }
         data_->scan_attempts_ = 0;
+        data_->MaybePrefetch();
         return batch_data->Reset(&data_->controller_,
                                  data_->configuration().projection(),
                                  data_->configuration().client_projection(),
@@ -2215,6 +2336,7 @@ Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
 
       if (blacklist.empty() && !needs_reopen) {
         // If we didn't blacklist the current server, we can just retry again.
+        result = data_->SendScanRpc(batch_deadline, allow_time_for_failover);
         continue;
       }
       // If we blacklisted the current server, and it's not fault-tolerant, we can't
@@ -2243,6 +2365,54 @@ Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
   }
 }
 
+void KuduScanner::NextBatchAsync(KuduScanBatch* batch, KuduStatusCallback* cb) {
+  NextBatchAsync(batch->data_, cb);
+}
+
+void KuduScanner::NextBatchAsync(KuduColumnarScanBatch* batch, KuduStatusCallback* cb) {
+  NextBatchAsync(batch->data_, cb);
+}
+
+void KuduScanner::NextBatchAsync(internal::ScanBatchDataInterface* batch_data,
+                                 KuduStatusCallback* cb) {
+  CHECK(data_->open_);
+  const auto run_on_pool = [this, batch_data, cb]() {
+    Status s = data_->table_->client()->data_->scan_pool_->Submit(
+        [this, batch_data, cb]() { cb->Run(NextBatch(batch_data)); });
+    if (PREDICT_FALSE(!s.ok())) {
+      cb->Run(s.CloneAndPrepend("couldn't fetch the next batch"));
+    }
+  };
+
+  if (data_->short_circuit_ || data_->data_in_open_) {
+    // The batch is in hand.
+    cb->Run(NextBatch(batch_data));
+    return;
+  }
+  if (!data_->last_response_.has_more_results()) {
+    if (data_->MoreTablets()) {
+      run_on_pool();
+    } else {
+      cb->Run(NextBatch(batch_data));
+    }
+    return;
+  }
+
+  // More data is available in this tablet: taking a successful response
+  // doesn't block, so it's done on the reactor thread which received it.
+  if (!data_->pending_rpc_) {
+    data_->SendPendingScanRpc(MonoTime::Now() + data_->configuration().timeout());
+  }
+  auto* rpc = data_->pending_rpc_.get();
+  rpc->OnFinished([this, rpc, batch_data, cb, run_on_pool]() {
+    if (rpc->succeeded()) {
+      cb->Run(NextBatch(batch_data));
+    } else {
+      run_on_pool();
+    }
+  });
+}
+
 Status KuduScanner::GetCurrentServer(KuduTabletServer** server) {
   CHECK(data_->open_);
   internal::RemoteTabletServer* rts = data_->ts_;
@@ -2281,6 +2451,18 @@ const KuduTablet& KuduScanToken::tablet() const {
   return data_->tablet();
 }
 
+int64_t KuduScanToken::EstimatedOnDiskSize() const {
+  return data_->EstimatedOnDiskSize();
+}
+
+int64_t KuduScanToken::EstimatedLiveRowCount() const {
+  return data_->EstimatedLiveRowCount();
+}
+
+int KuduScanToken::EstimatedNumRowSets() const {
+  return data_->EstimatedNumRowSets();
+}
+
 Status KuduScanToken::Serialize(string* buf) const {
   return data_->Serialize(buf);
 }
@@ -2500,5 +2682,10 @@ Status KuduPartitioner::PartitionRow(const KuduPartialRow& row, int* partition)
   return data_->PartitionRow(row, partition);
 }
 
+Status KuduPartitioner::PartitionRows(const vector<const KuduPartialRow*>& rows,
+                                      vector<int>* partitions) {
+  return data_->PartitionRows(rows, partitions);
+}
+
 } // namespace client
 } // namespace kudu
@@ -125,6 +125,7 @@ class RemoteTabletServer;
 class ReplicaController;
 class RetrieveAuthzTokenRpc;
 class ScanBatchDataInterface;
+class TableLocationsWatcher;
 class TabletInfoProvider;
 class WriteRpc;
 template <class ReqClass, class RespClass>
@@ -469,6 +470,25 @@ class KUDU_EXPORT KuduTransaction :
   ///   first failed stage of the transaction's commit sequence.
   Status Commit() WARN_UNUSED_RESULT;
 
+  /// Commit the transaction, waiting only for its commit timestamp to be
+  /// persisted rather than for the commit phase to finalize.
+  ///
+  /// As @c KuduTransaction::Commit(), this method flushes all transactional
+  /// sessions created off this transaction handle and initiates committing
+  /// the transaction. Once the commit timestamp of the transaction is
+  /// persisted, the transaction is bound to commit, and the participants
+  /// finalize the commit in the background: the method returns then, sparing
+  /// the latency of the last round of RPCs to the participants. Scans at or
+  /// after the commit timestamp wait for the participants to finalize the
+  /// commit, so the writes of the transaction are visible to the subsequent
+  /// reads as with @c KuduTransaction::Commit().
+  ///
+  /// @return Returns @c Status::OK() if the commit timestamp of the
+  ///   transaction was persisted. Otherwise returns the non-OK status of the
+  ///   very first failed stage of the transaction's commit sequence, e.g.
+  ///   @c Status::Aborted() if the transaction was aborted.
+  Status CommitAndWaitForTimestamp() WARN_UNUSED_RESULT;
+
   /// Start committing this transaction, but don't wait for the commit phase
   /// to finalize.
   ///
@@ -948,7 +968,12 @@ class KUDU_EXPORT KuduClient : public sp::enable_shared_from_this<KuduClient> {
                       ///< client, followed by all other replicas. If there are
                       ///< multiple closest replicas, one is chosen randomly.
 
-    FIRST_REPLICA     ///< Select the first replica in the list.
+    FIRST_REPLICA,    ///< Select the first replica in the list.
+
+    LEAST_LOADED_REPLICA  ///< Select the replica expected to respond the
+                          ///< soonest, according to the latencies of the
+                          ///< recent RPCs the client sent to its tablet server
+                          ///< and the number of those still in flight.
   };
 
   /// @return @c true iff client is configured to talk to multiple
@@ -1077,6 +1102,7 @@ class KUDU_EXPORT KuduClient : public sp::enable_shared_from_this<KuduClient> {
   friend class internal::RemoteTablet;
   friend class internal::RemoteTabletServer;
   friend class internal::RetrieveAuthzTokenRpc;
+  friend class internal::TableLocationsWatcher;
   friend class internal::TabletInfoProvider;
   friend class internal::WriteRpc;
   friend class kudu::AuthzTokenTest;
@@ -1580,6 +1606,37 @@ class KUDU_EXPORT KuduTableStatistics {
   /// but it should also support database level row count limit.
   int64_t live_row_count_limit() const;
 
+  /// Get the statistics of a column of the table.
+  ///
+  /// The statistics of the columns are only computed by the tablet servers
+  /// running with --tablet_compute_column_stats, when they flush the rows
+  /// written and compact them. They are approximate: the rows not flushed yet,
+  /// and the updates and deletes since the rows were flushed, aren't accounted
+  /// for.
+  ///
+  /// @note It is experimental and may change or disappear in future.
+  ///
+  /// @param [in] column_name
+  ///   The name of the column.
+  /// @param [out] null_count
+  ///   The number of null cells of the column. May be null.
+  /// @param [out] distinct_count
+  ///   The estimated number of distinct non-null values of the column.
+  ///   May be null.
+  /// @param [out] min_value
+  ///   The minimum non-null value of the column, or null if unknown, e.g.
+  ///   for the columns of variable-length types. The caller takes ownership
+  ///   of the value. May be null.
+  /// @param [out] max_value
+  ///   The maximum non-null value of the column, as for @c min_value.
+  /// @return Operation result status. Returns Status::NotFound if there are
+  ///   no statistics for the column.
+  Status GetColumnStatistics(const std::string& column_name,
+                             int64_t* null_count,
+                             int64_t* distinct_count,
+                             KuduValue** min_value = NULL,
+                             KuduValue** max_value = NULL) const;
+
   /// Stringify this Statistics.
   ///
   /// @return A string describing this statistics
@@ -1815,6 +1872,30 @@ class KUDU_EXPORT KuduTable : public sp::enable_shared_from_this<KuduTable> {
   KuduPredicate* NewInListPredicate(const Slice& col_name,
                                     std::vector<KuduValue*>* values);
 
+  /// Create a new array contains predicate which can be used for scanners
+  /// on this table.
+  ///
+  /// The array contains predicate applies to ARRAY columns: a row is filtered
+  /// from the scan unless the array of the column has at least one non-null
+  /// element equal to each of the values. Rows where the array is null are
+  /// filtered as well.
+  ///
+  /// The values must correspond to the element type of the column, as the
+  /// values of an IN list predicate do to the type of its column.
+  ///
+  /// @param [in] col_name
+  ///   Name of the column to which the predicate applies.
+  /// @param [in] values
+  ///   Vector of values the array must contain. Must not be empty.
+  /// @return Raw pointer to an array contains predicate. The caller owns the
+  ///   predicate until it is passed into KuduScanner::AddConjunctPredicate().
+  ///   The returned predicate takes ownership of the values vector and its
+  ///   elements. In the case of an error (e.g. an invalid column name), a
+  ///   non-NULL value is still returned. The error will be returned when
+  ///   attempting to add this predicate to a KuduScanner.
+  KuduPredicate* NewArrayContainsPredicate(const Slice& col_name,
+                                           std::vector<KuduValue*>* values);
+
   /// Create a new IS NOT NULL predicate which can be used for scanners on this
   /// table.
   ///
@@ -3009,6 +3090,40 @@ class KUDU_EXPORT KuduScanner {
   /// @return Operation result status.
   Status NextBatch(KuduColumnarScanBatch* batch);
 
+  /// Fetch the next batch of results for this scanner asynchronously.
+  ///
+  /// Like NextBatch(KuduScanBatch*), but returns right away and runs
+  /// @c cb once @c batch holds the next batch of results. The batches
+  /// continuing the scan of a tablet are fetched without blocking any
+  /// thread, so that one thread may drive many concurrent scans. The steps
+  /// which may block, like opening the next tablet or retrying after errors,
+  /// run on a thread pool of the client.
+  ///
+  /// @note The callback may run on this thread, on a reactor thread or on a
+  ///   thread of the client's pool, so it should not block. No other method
+  ///   of the scanner may be called, and neither the scanner nor @c batch may
+  ///   be destroyed, before the callback has run. The callback may call
+  ///   NextBatchAsync() again.
+  ///
+  /// @param [out] batch
+  ///   Placeholder for the result.
+  /// @param [in] cb
+  ///   Callback reporting on the outcome of the call. The caller retains
+  ///   ownership of the callback, which must stay alive until it has run.
+  void NextBatchAsync(KuduScanBatch* batch, KuduStatusCallback* cb);
+
+  /// Fetch the next batch of columnar results for this scanner asynchronously.
+  ///
+  /// Like NextBatchAsync(KuduScanBatch*, KuduStatusCallback*), for scans
+  /// configured with the COLUMNAR_LAYOUT RowFormatFlag.
+  ///
+  /// @param [out] batch
+  ///   Placeholder for the result.
+  /// @param [in] cb
+  ///   Callback reporting on the outcome of the call. The caller retains
+  ///   ownership of the callback, which must stay alive until it has run.
+  void NextBatchAsync(KuduColumnarScanBatch* batch, KuduStatusCallback* cb);
+
   /// Get the KuduTabletServer that is currently handling the scan.
   ///
   /// More concretely, this is the server that handled the most recent
@@ -3030,6 +3145,18 @@ class KUDU_EXPORT KuduScanner {
   /// @return Operation result status.
   Status SetBatchSizeBytes(uint32_t batch_size);
 
+  /// Set whether the next batch of results is prefetched.
+  ///
+  /// With prefetching, as soon as a batch is returned, the request for the
+  /// following batch of the same tablet is sent, so that its round trip to
+  /// the tablet server overlaps with the processing of the batch. This costs
+  /// the memory of a second batch. Prefetching is disabled by default.
+  ///
+  /// @param [in] prefetching
+  ///   Whether to prefetch the next batch.
+  /// @return Operation result status.
+  Status SetPrefetching(bool prefetching);
+
   /// Set the replica selection policy while scanning.
   ///
   /// @param [in] selection
@@ -3197,6 +3324,8 @@ class KUDU_EXPORT KuduScanner {
 
   Status NextBatch(internal::ScanBatchDataInterface* batch);
 
+  void NextBatchAsync(internal::ScanBatchDataInterface* batch, KuduStatusCallback* cb);
+
   friend class KuduScanToken;
   friend class FlexPartitioningTest;
   FRIEND_TEST(ClientTest, TestBlockScannerHijackingAttempts);
@@ -3257,6 +3386,26 @@ class KUDU_EXPORT KuduScanToken {
   /// @return Tablet that this scan will retrieve rows from.
   const KuduTablet& tablet() const;
 
+  /// The estimates below come from the statistics the leader replica of the
+  /// tablet last reported to the master, so they may lag behind the actual
+  /// contents of the tablet. They are meant for query engines to balance the
+  /// tokens between their tasks.
+  ///
+  /// @return The estimated size on disk of the data this token scans, in
+  ///   bytes, or -1 if unknown. If the token scans only a part of the tablet
+  ///   (see KuduScanTokenBuilder::SetSplitSizeBytes()), this is the size of
+  ///   that part.
+  int64_t EstimatedOnDiskSize() const;
+
+  /// @return The estimated number of live rows this token scans, or -1 if
+  ///   unknown. If the token scans only a part of the tablet, the row count of
+  ///   the tablet is scaled down to the size of that part.
+  int64_t EstimatedLiveRowCount() const;
+
+  /// @return The number of rowsets of the tablet this token scans, or -1 if
+  ///   unknown.
+  int EstimatedNumRowSets() const;
+
   /// Serialize the token into a string.
   ///
   /// The resulting string can be deserialized with
@@ -3519,6 +3668,24 @@ class KUDU_EXPORT KuduPartitioner {
   ///   provided row does not have all columns of the partition key
   ///   set.
   Status PartitionRow(const KuduPartialRow& row, int* partition);
+
+  /// Determine the partition indexes that the given rows fall into.
+  ///
+  /// The result is the same as calling @c PartitionRow for each row, but
+  /// partitioning a batch of rows costs less per row: the memory used to
+  /// encode the partition keys is reused across the rows, and the partition
+  /// of a row is found without a lookup if it is the same as that of the
+  /// previous row, e.g. in batches sorted by primary key.
+  ///
+  /// @param [in] rows
+  ///   The rows to be partitioned.
+  /// @param [out] partitions
+  ///   The resulting partition indexes, in the same order as the rows. As for
+  ///   @c PartitionRow, -1 for a row falling into a non-covered range.
+  ///
+  /// @return Status::OK if successful.
+  Status PartitionRows(const std::vector<const KuduPartialRow*>& rows,
+                       std::vector<int>* partitions);
  private:
   class KUDU_NO_EXPORT Data;
 
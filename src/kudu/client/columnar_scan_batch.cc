@@ -17,15 +17,185 @@
 
 #include "kudu/client/columnar_scan_batch.h"
 
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kudu/client/arrow_c_data.h"
 #include "kudu/client/scanner-internal.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
 #include "kudu/common/wire_protocol.pb.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/rpc_controller.h"
+#include "kudu/util/bitmap.h"
+#include "kudu/util/int128.h"
+#include "kudu/util/slice.h"
 
-namespace kudu {
-class Slice;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
 
+namespace kudu {
 namespace client {
 
+namespace {
+
+// The data of an exported batch, shared by the exported struct array and its
+// children, which consumers may move out of it.
+struct ExportedColumns {
+  // The data of the batch, which owns the sidecars holding the columns.
+  shared_ptr<const void> data;
+
+  // The buffers of the columns whose data is converted.
+  vector<unique_ptr<uint8_t[]>> converted;
+};
+
+// The private data of an exported array.
+struct ExportedArray {
+  shared_ptr<ExportedColumns> columns;
+  vector<const void*> buffers;
+  vector<ArrowArray> children;
+  vector<ArrowArray*> child_ptrs;
+};
+
+// The private data of an exported schema.
+struct ExportedSchema {
+  string format;
+  string name;
+  vector<ArrowSchema> children;
+  vector<ArrowSchema*> child_ptrs;
+};
+
+// The offsets of an empty variable-length column, which Arrow requires even
+// when there's no cell.
+const int32_t kEmptyOffsets[] = { 0 };
+
+void ReleaseArray(ArrowArray* array) {
+  auto* exported = static_cast<ExportedArray*>(array->private_data);
+  for (auto* child : exported->child_ptrs) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+  }
+  delete exported;
+  array->release = nullptr;
+}
+
+void ReleaseSchema(ArrowSchema* schema) {
+  auto* exported = static_cast<ExportedSchema*>(schema->private_data);
+  for (auto* child : exported->child_ptrs) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+  }
+  delete exported;
+  schema->release = nullptr;
+}
+
+// Sets 'array' to the exported array described by 'exported', which it takes
+// ownership of.
+void InitArray(int64_t length, int64_t null_count, unique_ptr<ExportedArray> exported,
+               ArrowArray* array) {
+  array->length = length;
+  array->null_count = null_count;
+  array->offset = 0;
+  array->n_buffers = exported->buffers.size();
+  array->n_children = exported->child_ptrs.size();
+  array->buffers = exported->buffers.data();
+  array->children = exported->child_ptrs.empty() ? nullptr : exported->child_ptrs.data();
+  array->dictionary = nullptr;
+  array->release = &ReleaseArray;
+  array->private_data = exported.release();
+}
+
+// Sets 'schema' to the exported schema described by 'exported', which it takes
+// ownership of.
+void InitSchema(int64_t flags, unique_ptr<ExportedSchema> exported, ArrowSchema* schema) {
+  schema->format = exported->format.c_str();
+  schema->name = exported->name.c_str();
+  schema->metadata = nullptr;
+  schema->flags = flags;
+  schema->n_children = exported->child_ptrs.size();
+  schema->children = exported->child_ptrs.empty() ? nullptr : exported->child_ptrs.data();
+  schema->dictionary = nullptr;
+  schema->release = &ReleaseSchema;
+  schema->private_data = exported.release();
+}
+
+// Returns the Arrow format string of the type of 'col'.
+Status ArrowFormat(const ColumnSchema& col, string* format) {
+  switch (col.type_info()->type()) {
+    case BOOL: *format = "b"; break;
+    case INT8: *format = "c"; break;
+    case INT16: *format = "s"; break;
+    case INT32: *format = "i"; break;
+    case INT64: *format = "l"; break;
+    case FLOAT: *format = "f"; break;
+    case DOUBLE: *format = "g"; break;
+    case STRING: *format = "u"; break;
+    case VARCHAR: *format = "u"; break;
+    case JSON: *format = "u"; break;
+    case BINARY: *format = "z"; break;
+    case UNIXTIME_MICROS: *format = "tsu:UTC"; break;
+    case DATE: *format = "tdD"; break;
+    case DECIMAL32:
+    case DECIMAL64:
+    case DECIMAL128:
+      *format = Substitute("d:$0,$1", col.type_attributes().precision,
+                           col.type_attributes().scale);
+      break;
+    default:
+      return Status::NotSupported("column type can't be exported to Arrow", col.ToString());
+  }
+  return Status::OK();
+}
+
+// Widens the 'num_rows' decimals of type 'T' in 'data' to the 128-bit decimals
+// of Arrow.
+template<class T>
+unique_ptr<uint8_t[]> WidenDecimals(const Slice& data, int num_rows) {
+  unique_ptr<uint8_t[]> buf(new uint8_t[num_rows * sizeof(int128_t)]);
+  for (int i = 0; i < num_rows; i++) {
+    const int128_t val = UnalignedLoad<T>(data.data() + i * sizeof(T));
+    memcpy(&buf[i * sizeof(int128_t)], &val, sizeof(val));
+  }
+  return buf;
+}
+
+// Packs the 'num_rows' booleans in 'data' into a bitmap.
+unique_ptr<uint8_t[]> PackBooleans(const Slice& data, int num_rows) {
+  const size_t size = BitmapSize(num_rows);
+  unique_ptr<uint8_t[]> buf(new uint8_t[size]);
+  memset(buf.get(), 0, size);
+  for (int i = 0; i < num_rows; i++) {
+    if (data[i]) {
+      BitmapSet(buf.get(), i);
+    }
+  }
+  return buf;
+}
+
+// Sets the 'num_rows' offsets of 'dst' following the offset at index 0 to the
+// 'num_rows' + 1 offsets in 'src', rebased on 'base'. The loop has no
+// dependency between iterations, so that the compiler vectorizes it.
+void RebaseOffsets(const uint8_t* src, int num_rows, int32_t base, int32_t* dst) {
+  const uint32_t first = UnalignedLoad<uint32_t>(src);
+  for (int i = 1; i <= num_rows; i++) {
+    dst[i] = base + static_cast<int32_t>(
+        UnalignedLoad<uint32_t>(src + i * sizeof(uint32_t)) - first);
+  }
+}
+
+} // anonymous namespace
+
 KuduColumnarScanBatch::KuduColumnarScanBatch()
     : data_(new KuduColumnarScanBatch::Data()) {
 }
@@ -55,5 +225,177 @@ Status KuduColumnarScanBatch::GetNonNullBitmapForColumn(int idx, Slice* data) co
   return data_->controller_.GetInboundSidecar(col.non_null_bitmap_sidecar(), data);
 }
 
+Status KuduColumnarScanBatch::ExportToArrow(ArrowArray* array, ArrowSchema* schema) {
+  if (PREDICT_FALSE(data_->projection_ == nullptr)) {
+    return Status::IllegalState("batch has no data");
+  }
+  const Schema& projection = *data_->projection_;
+  const int num_rows = NumRows();
+  const int num_cols = projection.num_columns();
+
+  auto columns = std::make_shared<ExportedColumns>();
+  unique_ptr<ExportedArray> exported_array(new ExportedArray);
+  exported_array->columns = columns;
+  exported_array->buffers.emplace_back(nullptr);
+  exported_array->children.resize(num_cols);
+  unique_ptr<ExportedSchema> exported_schema(new ExportedSchema);
+  exported_schema->format = "+s";
+  exported_schema->children.resize(num_cols);
+
+  // The children are only initialized once all the columns are exported, so
+  // that nothing leaks if one of them can't be.
+  vector<unique_ptr<ExportedArray>> child_arrays(num_cols);
+  vector<unique_ptr<ExportedSchema>> child_schemas(num_cols);
+  for (int i = 0; i < num_cols; i++) {
+    const ColumnSchema& col = projection.column(i);
+    child_schemas[i].reset(new ExportedSchema);
+    child_schemas[i]->name = col.name();
+    RETURN_NOT_OK(ArrowFormat(col, &child_schemas[i]->format));
+
+    child_arrays[i].reset(new ExportedArray);
+    ExportedArray* child = child_arrays[i].get();
+    child->columns = columns;
+    Slice non_null_bitmap;
+    if (col.is_nullable()) {
+      RETURN_NOT_OK(GetNonNullBitmapForColumn(i, &non_null_bitmap));
+      child->buffers.emplace_back(non_null_bitmap.data());
+    } else {
+      child->buffers.emplace_back(nullptr);
+    }
+
+    if (col.type_info()->physical_type() == BINARY) {
+      Slice offsets;
+      Slice data;
+      RETURN_NOT_OK(GetVariableLengthColumn(i, &offsets, &data));
+      child->buffers.emplace_back(num_rows == 0 ? kEmptyOffsets : offsets.data());
+      child->buffers.emplace_back(data.data());
+      continue;
+    }
+    Slice data;
+    RETURN_NOT_OK(GetFixedLengthColumn(i, &data));
+    switch (col.type_info()->type()) {
+      case BOOL:
+        columns->converted.emplace_back(PackBooleans(data, num_rows));
+        child->buffers.emplace_back(columns->converted.back().get());
+        break;
+      case DECIMAL32:
+        columns->converted.emplace_back(WidenDecimals<int32_t>(data, num_rows));
+        child->buffers.emplace_back(columns->converted.back().get());
+        break;
+      case DECIMAL64:
+        columns->converted.emplace_back(WidenDecimals<int64_t>(data, num_rows));
+        child->buffers.emplace_back(columns->converted.back().get());
+        break;
+      default:
+        child->buffers.emplace_back(data.data());
+        break;
+    }
+  }
+
+  for (int i = 0; i < num_cols; i++) {
+    const ColumnSchema& col = projection.column(i);
+    ArrowArray* child_array = &exported_array->children[i];
+    InitArray(num_rows, col.is_nullable() ? -1 : 0, std::move(child_arrays[i]), child_array);
+    exported_array->child_ptrs.emplace_back(child_array);
+    ArrowSchema* child_schema = &exported_schema->children[i];
+    InitSchema(col.is_nullable() ? ARROW_FLAG_NULLABLE : 0, std::move(child_schemas[i]),
+               child_schema);
+    exported_schema->child_ptrs.emplace_back(child_schema);
+  }
+  InitArray(num_rows, 0, std::move(exported_array), array);
+  InitSchema(0, std::move(exported_schema), schema);
+
+  // Hand the data over to the exported array.
+  columns->data = shared_ptr<const Data>(data_);
+  data_ = new KuduColumnarScanBatch::Data();
+  return Status::OK();
+}
+
+Status KuduColumnarScanBatch::CopyColumnToArrowBuffers(
+    int idx, int64_t dst_row, uint8_t* validity, void* values,
+    uint8_t* varlen_data, size_t varlen_data_capacity) const {
+  if (PREDICT_FALSE(data_->projection_ == nullptr)) {
+    return Status::IllegalState("batch has no data");
+  }
+  RETURN_NOT_OK(data_->CheckColumnIndex(idx));
+  const ColumnSchema& col = data_->projection_->column(idx);
+  const int num_rows = NumRows();
+  if (PREDICT_FALSE(dst_row < 0)) {
+    return Status::InvalidArgument("negative destination row", std::to_string(dst_row));
+  }
+  Slice non_null_bitmap;
+  if (col.is_nullable()) {
+    if (PREDICT_FALSE(validity == nullptr)) {
+      return Status::InvalidArgument("no validity bitmap for nullable column", col.name());
+    }
+    RETURN_NOT_OK(GetNonNullBitmapForColumn(idx, &non_null_bitmap));
+  }
+
+  if (col.type_info()->physical_type() == BINARY) {
+    auto* dst_offsets = static_cast<int32_t*>(values) + dst_row;
+    const int32_t base = dst_row == 0 ? 0 : *dst_offsets;
+    if (num_rows == 0) {
+      *dst_offsets = base;
+      return Status::OK();
+    }
+    Slice offsets;
+    Slice data;
+    RETURN_NOT_OK(GetVariableLengthColumn(idx, &offsets, &data));
+    const uint32_t first = UnalignedLoad<uint32_t>(offsets.data());
+    const uint32_t last = UnalignedLoad<uint32_t>(offsets.data() + num_rows * sizeof(uint32_t));
+    const size_t size = last - first;
+    if (PREDICT_FALSE(base < 0 || base + size > varlen_data_capacity)) {
+      return Status::InvalidArgument(
+          Substitute("variable-length data buffer too small for column $0", col.name()),
+          Substitute("$0 bytes needed at offset $1, capacity is $2 bytes",
+                     size, base, varlen_data_capacity));
+    }
+    if (PREDICT_FALSE(base + size > static_cast<size_t>(std::numeric_limits<int32_t>::max()))) {
+      return Status::InvalidArgument(
+          "variable-length data too large for Arrow offsets", col.name());
+    }
+    *dst_offsets = base;
+    RebaseOffsets(offsets.data(), num_rows, base, dst_offsets);
+    memcpy(varlen_data + base, data.data() + first, size);
+  } else if (num_rows > 0) {
+    Slice data;
+    RETURN_NOT_OK(GetFixedLengthColumn(idx, &data));
+    auto* dst = static_cast<uint8_t*>(values);
+    switch (col.type_info()->type()) {
+      case BOOL:
+        for (int i = 0; i < num_rows; i++) {
+          BitmapChange(dst, dst_row + i, data[i]);
+        }
+        break;
+      case DECIMAL32:
+        for (int i = 0; i < num_rows; i++) {
+          const int128_t val = UnalignedLoad<int32_t>(data.data() + i * sizeof(int32_t));
+          memcpy(dst + (dst_row + i) * sizeof(int128_t), &val, sizeof(val));
+        }
+        break;
+      case DECIMAL64:
+        for (int i = 0; i < num_rows; i++) {
+          const int128_t val = UnalignedLoad<int64_t>(data.data() + i * sizeof(int64_t));
+          memcpy(dst + (dst_row + i) * sizeof(int128_t), &val, sizeof(val));
+        }
+        break;
+      default: {
+        const size_t cell_size = col.type_info()->size();
+        memcpy(dst + dst_row * cell_size, data.data(), num_rows * cell_size);
+        break;
+      }
+    }
+  }
+
+  if (validity != nullptr && num_rows > 0) {
+    if (col.is_nullable()) {
+      BitmapCopy(validity, dst_row, non_null_bitmap.data(), 0, num_rows);
+    } else {
+      BitmapChangeBits(validity, dst_row, num_rows, true);
+    }
+  }
+  return Status::OK();
+}
+
 } // namespace client
 } // namespace kudu
@@ -17,6 +17,10 @@
 #ifndef KUDU_CLIENT_COLUMNAR_SCAN_BATCH_H
 #define KUDU_CLIENT_COLUMNAR_SCAN_BATCH_H
 
+#include <stdint.h>
+
+#include <cstddef>
+
 #ifdef KUDU_HEADERS_NO_STUBS
 #include "kudu/gutil/macros.h"
 #else
@@ -26,6 +30,9 @@
 #include "kudu/util/kudu_export.h"
 #include "kudu/util/status.h"
 
+struct ArrowArray;
+struct ArrowSchema;
+
 namespace kudu {
 class Slice;
 
@@ -104,6 +111,65 @@ class KUDU_EXPORT KuduColumnarScanBatch {
   /// @return Operation result status.
   Status GetNonNullBitmapForColumn(int idx, Slice* data) const;
 
+  /// Export the batch as an Apache Arrow struct array, with a child array per
+  /// projected column, through the Arrow C data interface (see arrow_c_data.h).
+  ///
+  /// The data of the batch is handed over to the exported array rather than
+  /// copied: it remains valid until the release callback of the array is
+  /// called, and the batch is empty until the scanner fills it again. Only
+  /// the BOOL columns, which are packed into bitmaps, and the DECIMAL columns
+  /// of less than 128 bits, which are widened, are converted as Arrow requires.
+  /// STRING, VARCHAR and JSON columns are exported as UTF-8 strings, and
+  /// UNIXTIME_MICROS columns as UTC timestamps with microsecond precision.
+  ///
+  /// @note As for the other accessors, no alignment of the buffers is
+  ///   guaranteed.
+  ///
+  /// @param [out] array
+  ///   The exported array. Must be released by the caller with its release
+  ///   callback.
+  /// @param [out] schema
+  ///   The type of the exported array, naming its children after the columns.
+  ///   Must be released by the caller with its release callback.
+  /// @return Operation result status. Neither 'array' nor 'schema' are set
+  ///   on failure.
+  Status ExportToArrow(struct ArrowArray* array, struct ArrowSchema* schema);
+
+  /// Copy the column with index 'idx' into buffers supplied by the application,
+  /// laid out as the buffers of the Apache Arrow array ExportToArrow() would
+  /// export the column as, e.g. the buffers of an array being built.
+  ///
+  /// The cells of the batch are written after the first 'dst_row' cells of the
+  /// buffers, so that the columns of successive batches can be appended to the
+  /// same buffers, converting them only once.
+  ///
+  /// @param [in] idx
+  ///   The column index.
+  /// @param [in] dst_row
+  ///   The index in the buffers of the cell the first cell of the batch is
+  ///   copied to.
+  /// @param [out] validity
+  ///   The validity bitmap, with room for at least dst_row + NumRows() bits.
+  ///   May be null if the column is not nullable; otherwise its bits are all
+  ///   set for such a column.
+  /// @param [out] values
+  ///   For fixed-length columns, the values buffer, with room for at least
+  ///   dst_row + NumRows() cells of the Arrow type of the column. For
+  ///   variable-length columns, the int32 offsets buffer, with room for at
+  ///   least dst_row + NumRows() + 1 offsets: unless 'dst_row' is 0, the offset
+  ///   at index 'dst_row' must already be set to the end of the data appended
+  ///   so far.
+  /// @param [out] varlen_data
+  ///   For variable-length columns, the data buffer the cells are appended to,
+  ///   at the offset at index 'dst_row'. Ignored for fixed-length columns.
+  /// @param [in] varlen_data_capacity
+  ///   The size of the buffer pointed to by 'varlen_data'.
+  /// @return Operation result status. Returns Status::InvalidArgument if
+  ///   'varlen_data' is too small, or if 'validity' is null for a nullable
+  ///   column. Nothing is written on failure.
+  Status CopyColumnToArrowBuffers(int idx, int64_t dst_row, uint8_t* validity, void* values,
+                                  uint8_t* varlen_data, size_t varlen_data_capacity) const;
+
  private:
   class KUDU_NO_EXPORT Data;
 
@@ -17,10 +17,13 @@
 
 #include "kudu/client/meta_cache.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <ostream>
 #include <set>
 #include <string>
@@ -49,6 +52,7 @@
 #include "kudu/rpc/rpc.h"
 #include "kudu/rpc/rpc_controller.h"
 #include "kudu/security/token.pb.h"
+#include "kudu/tablet/metadata.pb.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/tserver/tserver_admin.proxy.h"
 #include "kudu/tserver/tserver_service.proxy.h"
@@ -71,13 +75,16 @@ using kudu::master::GetTabletLocationsResponsePB;
 using kudu::master::MasterServiceProxy;
 using kudu::master::TabletLocationsPB;
 using kudu::master::TSInfoPB;
+using kudu::master::WatchTableLocationsResponsePB;
 using kudu::pb_util::SecureShortDebugString;
 using kudu::rpc::BackoffType;
 using kudu::rpc::CredentialsPolicy;
 using kudu::rpc::RpcController;
 using kudu::security::SignedTokenPB;
+using kudu::tablet::ReportedTabletStatsPB;
 using kudu::tserver::TabletServerAdminServiceProxy;
 using kudu::tserver::TabletServerServiceProxy;
+using std::optional;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -101,6 +108,23 @@ DEFINE_int32(client_tablet_locations_by_id_ttl_ms, 60 * 60 * 1000, // 60 minutes
 TAG_FLAG(client_tablet_locations_by_id_ttl_ms, advanced);
 TAG_FLAG(client_tablet_locations_by_id_ttl_ms, runtime);
 
+DEFINE_int32(client_replica_latency_decay_ms, 10000,
+              "The time constant, in milliseconds, with which the latencies of "
+              "the RPCs to a tablet server decay in the load the client assigns "
+              "it for the LEAST_LOADED_REPLICA selection. A server which got "
+              "slow is tried again once its latencies decayed enough.");
+TAG_FLAG(client_replica_latency_decay_ms, advanced);
+TAG_FLAG(client_replica_latency_decay_ms, runtime);
+
+DEFINE_bool(client_prefetch_table_locations, false,
+            "Whether the client fetches the locations of all the tablets of a "
+            "table when opening it, rather than as they're first needed. The "
+            "locations are fetched with a request to the master per 1000 "
+            "tablets.");
+TAG_FLAG(client_prefetch_table_locations, advanced);
+TAG_FLAG(client_prefetch_table_locations, experimental);
+TAG_FLAG(client_prefetch_table_locations, runtime);
+
 DEFINE_bool(prevent_kudu_3461_infinite_recursion, true,
             "Whether or not to prevent infinite recursion caused due to stale "
             "client metacache as described in KUDU-3461. Used for testing only!");
@@ -111,7 +135,10 @@ namespace client {
 namespace internal {
 
 RemoteTabletServer::RemoteTabletServer(const master::TSInfoPB& pb)
-  : uuid_(pb.permanent_uuid()) {
+  : uuid_(pb.permanent_uuid()),
+    num_inflight_rpcs_(0),
+    ewma_latency_us_(0),
+    latency_update_time_(MonoTime::Now()) {
   Update(pb);
 }
 
@@ -246,6 +273,47 @@ void RemoteTabletServer::GetHostPorts(vector<HostPort>* host_ports) const {
   *host_ports = rpc_hostports_;
 }
 
+namespace {
+// Returns the weight left to the latencies recorded 'elapsed' ago.
+double LatencyDecayWeight(const MonoDelta& elapsed) {
+  return std::exp(-elapsed.ToMilliseconds() /
+                  static_cast<double>(std::max(FLAGS_client_replica_latency_decay_ms, 1)));
+}
+} // anonymous namespace
+
+void RemoteTabletServer::StartRpc() {
+  num_inflight_rpcs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RemoteTabletServer::FinishRpc(const MonoDelta& latency) {
+  num_inflight_rpcs_.fetch_sub(1, std::memory_order_relaxed);
+  const double latency_us = latency.ToMicroseconds();
+  const MonoTime now = MonoTime::Now();
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (latency_us > ewma_latency_us_) {
+    // Take latency peaks at once, so that a server which got slow is
+    // avoided right away.
+    ewma_latency_us_ = latency_us;
+  } else {
+    const double w = LatencyDecayWeight(now - latency_update_time_);
+    ewma_latency_us_ = ewma_latency_us_ * w + latency_us * (1 - w);
+  }
+  latency_update_time_ = now;
+}
+
+double RemoteTabletServer::LoadScore() const {
+  double ewma_latency_us;
+  MonoTime latency_update_time;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    ewma_latency_us = ewma_latency_us_;
+    latency_update_time = latency_update_time_;
+  }
+  const double decayed_latency_us =
+      ewma_latency_us * LatencyDecayWeight(MonoTime::Now() - latency_update_time);
+  return decayed_latency_us * (num_inflight_rpcs_.load(std::memory_order_relaxed) + 1);
+}
+
 ////////////////////////////////////////////////////////////
 
 
@@ -278,11 +346,21 @@ Status RemoteTablet::Refresh(
   // Adopt the data from the successful response.
   std::lock_guard<simple_spinlock> l(lock_);
   replicas_ = std::move(replicas);
+  if (locs_pb.has_stats()) {
+    stats_ = locs_pb.stats();
+  } else {
+    stats_.reset();
+  }
 
   stale_ = false;
   return Status::OK();
 }
 
+optional<ReportedTabletStatsPB> RemoteTablet::stats() const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return stats_;
+}
+
 void RemoteTablet::MarkStale() {
   VLOG(2) << Substitute("Marking tablet stale, tablet id $0", tablet_id_);
   stale_ = true;
@@ -1256,7 +1334,6 @@ Status MetaCache::ProcessGetTableLocationsResponse(const KuduTable* table,
 bool MetaCache::LookupEntryByKeyFastPath(const KuduTable* table,
                                          const PartitionKey& partition_key,
                                          MetaCacheEntry* entry) {
-  SCOPED_LOG_SLOW_EXECUTION(WARNING, 50, "looking up entry by key");
   shared_lock<rw_spinlock> l(lock_.get_lock());
   const TabletMap* tablets = FindOrNull(tablets_by_table_and_key_, table->id());
   if (PREDICT_FALSE(!tablets)) {
@@ -1301,23 +1378,34 @@ Status MetaCache::DoFastPathLookup(const KuduTable* table,
                                    MetaCache::LookupType lookup_type,
                                    scoped_refptr<RemoteTablet>* remote_tablet) {
   static const string err_str = "No tablet covering the requested range partition";
-  MetaCacheEntry entry;
-  while (PREDICT_TRUE(LookupEntryByKeyFastPath(table, *partition_key, &entry))
-         && (entry.is_non_covered_range() || entry.tablet()->HasLeader())) {
+  // This is on the path of every write and scan, so the entries are looked up
+  // in place under a single acquisition of the lock, without copying them.
+  shared_lock<rw_spinlock> l(lock_.get_lock());
+  const TabletMap* tablets = FindOrNull(tablets_by_table_and_key_, table->id());
+  if (PREDICT_FALSE(!tablets)) {
+    VLOG(2) << Substitute("No cache available for table $0", table->name());
+    return Status::Incomplete("");
+  }
+  while (true) {
+    const MetaCacheEntry* e = FindFloorOrNull(*tablets, *partition_key);
+    if (PREDICT_FALSE(!e || e->stale() || !e->Contains(*partition_key) ||
+                      (!e->is_non_covered_range() && !e->tablet()->HasLeader()))) {
+      break;
+    }
     VLOG(4) << Substitute("Fast lookup: found $0 for $1",
-                          entry.DebugString(table),
+                          e->DebugString(table),
                           DebugLowerBoundPartitionKey(table, *partition_key));
-    if (!entry.is_non_covered_range()) {
+    if (!e->is_non_covered_range()) {
       if (remote_tablet) {
-        *remote_tablet = entry.tablet();
+        *remote_tablet = e->tablet();
       }
       return Status::OK();
     }
-    if (lookup_type == LookupType::kPoint || entry.upper_bound_partition_key().empty()) {
+    if (lookup_type == LookupType::kPoint || e->upper_bound_partition_key().empty()) {
       VLOG(2) << Substitute(err_str);
-      return Status::NotFound(err_str, entry.DebugString(table));
+      return Status::NotFound(err_str, e->DebugString(table));
     }
-    *partition_key = entry.upper_bound_partition_key();
+    *partition_key = e->upper_bound_partition_key();
   }
   VLOG(2) << Substitute("Fastpath lookup failed with incomplete status");
   return Status::Incomplete("");
@@ -1325,7 +1413,6 @@ Status MetaCache::DoFastPathLookup(const KuduTable* table,
 
 bool MetaCache::LookupEntryByIdFastPath(const string& tablet_id,
                                         MetaCacheEntry* entry) {
-  SCOPED_LOG_SLOW_EXECUTION(WARNING, 50, "looking up entry by ID");
   shared_lock<rw_spinlock> l(lock_.get_lock());
   const auto* cache_entry = FindOrNull(entry_by_tablet_id_, tablet_id);
   if (PREDICT_FALSE(!cache_entry)) {
@@ -1354,6 +1441,44 @@ Status MetaCache::DoFastPathLookupById(const string& tablet_id,
   return Status::Incomplete("");
 }
 
+Status MetaCache::ProcessWatchTableLocationsResponse(
+    const string& table_id, const WatchTableLocationsResponsePB& resp) {
+  SCOPED_LOG_SLOW_EXECUTION(WARNING, 50, "processing watched table locations");
+  std::lock_guard<percpu_rwlock> l(lock_);
+  if (resp.full_refresh_required()) {
+    // The master no longer knows which tablets changed: look all of them up
+    // again once they are next used.
+    VLOG(3) << "Marking the tablets of table " << table_id << " as stale";
+    const TabletMap* tablets = FindOrNull(tablets_by_table_and_key_, table_id);
+    if (tablets) {
+      for (const auto& e : *tablets) {
+        if (!e.second.is_non_covered_range()) {
+          e.second.tablet()->MarkStale();
+        }
+      }
+    }
+    return Status::OK();
+  }
+  const auto& ts_infos = resp.ts_infos();
+  for (const auto& ts_info : ts_infos) {
+    UpdateTabletServerUnlocked(ts_info);
+  }
+  for (const auto& tablet : resp.tablet_locations()) {
+    const auto& tablet_id = tablet.tablet_id();
+    scoped_refptr<RemoteTablet> remote = FindPtrOrNull(tablets_by_id_, tablet_id);
+    if (!remote) {
+      // Not cached: there is nothing to refresh.
+      continue;
+    }
+    VLOG(3) << "Refreshing watched tablet " << tablet_id << ": "
+            << SecureShortDebugString(tablet);
+    RETURN_NOT_OK_PREPEND(remote->Refresh(ts_cache_, tablet, ts_infos),
+                          Substitute("failed to refresh locations for tablet $0",
+                                     tablet_id));
+  }
+  return Status::OK();
+}
+
 void MetaCache::ClearNonCoveredRangeEntries(const std::string& table_id) {
   VLOG(3) << "Clearing non-covered range entries of table " << table_id;
   std::lock_guard<percpu_rwlock> l(lock_);
@@ -1488,6 +1613,35 @@ void MetaCache::LookupTabletByKey(const KuduTable* table,
   rpc->SendRpcSlowPath();
 }
 
+Status MetaCache::PrefetchTableLocations(const KuduTable* table, const MonoTime& deadline) {
+  // Walk the partition key space tablet by tablet: the lookups missing the
+  // cache fetch the locations of the next kFetchTabletsPerRangeLookup tablets
+  // from the master at once, the others are served from the cache.
+  PartitionKey partition_key;
+  int num_tablets = 0;
+  while (true) {
+    scoped_refptr<RemoteTablet> remote_tablet;
+    Synchronizer sync;
+    LookupTabletByKey(table, partition_key, deadline, LookupType::kLowerBound,
+                      &remote_tablet, sync.AsStatusCallback());
+    const Status s = sync.Wait();
+    if (s.IsNotFound()) {
+      // No tablets past 'partition_key'.
+      break;
+    }
+    RETURN_NOT_OK_PREPEND(s, Substitute("failed to prefetch locations of table $0",
+                                        table->name()));
+    num_tablets++;
+    partition_key = remote_tablet->partition().end();
+    if (partition_key.empty()) {
+      break;
+    }
+  }
+  VLOG(1) << Substitute("Prefetched locations of $0 tablets of table $1",
+                        num_tablets, table->name());
+  return Status::OK();
+}
+
 void MetaCache::LookupTabletById(KuduClient* client,
                                  const string& tablet_id,
                                  const MonoTime& deadline,
@@ -40,6 +40,7 @@
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/rpc/rpc.h"
+#include "kudu/tablet/metadata.pb.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/net/net_util.h"
@@ -61,6 +62,7 @@ class GetTableLocationsResponsePB;
 class GetTabletLocationsResponsePB;
 class TSInfoPB;
 class TabletLocationsPB;
+class WatchTableLocationsResponsePB;
 } // namespace master
 
 namespace client {
@@ -117,6 +119,17 @@ class RemoteTabletServer {
   // If no location is assigned, the returned string will be empty.
   std::string location() const;
 
+  // Track the load of this server as seen by the client: StartRpc() and
+  // FinishRpc() bracket each RPC sent to it which counts towards the load.
+  void StartRpc();
+  void FinishRpc(const MonoDelta& latency);
+
+  // Returns the expected cost of sending an RPC to this server, for the
+  // LEAST_LOADED_REPLICA selection: the peak EWMA of the latencies of its
+  // recent RPCs, decaying with time, scaled by the number of RPCs in flight.
+  // A server with no RPCs recorded has no cost.
+  double LoadScore() const;
+
  private:
   // Internal callback for DNS resolution.
   void DnsResolutionFinished(const HostPort& hp,
@@ -140,6 +153,14 @@ class RemoteTabletServer {
   std::shared_ptr<tserver::TabletServerServiceProxy> proxy_;
   std::shared_ptr<tserver::TabletServerAdminServiceProxy> admin_proxy_;
 
+  // The number of RPCs in flight to this server.
+  std::atomic<int32_t> num_inflight_rpcs_;
+
+  // The EWMA of the latencies of the RPCs to this server, in microseconds, as
+  // of 'latency_update_time_'. Protected by 'lock_'.
+  double ewma_latency_us_;
+  MonoTime latency_update_time_;
+
   DISALLOW_COPY_AND_ASSIGN(RemoteTabletServer);
 };
 
@@ -266,6 +287,11 @@ class RemoteTablet : public RefCountedThreadSafe<RemoteTablet> {
     return partition_;
   }
 
+  // Returns the statistics last reported to the master by the leader replica
+  // of the tablet, or nullopt if the master had none when the locations of the
+  // tablet were last refreshed.
+  std::optional<tablet::ReportedTabletStatsPB> stats() const;
+
   // Mark the specified tablet server as the leader of the consensus configuration in the cache.
   void MarkTServerAsLeader(const RemoteTabletServer* server);
 
@@ -284,8 +310,9 @@ class RemoteTablet : public RefCountedThreadSafe<RemoteTablet> {
 
   std::atomic<bool> stale_;
 
-  mutable simple_spinlock lock_; // Protects replicas_.
+  mutable simple_spinlock lock_; // Protects replicas_ and stats_.
   std::vector<RemoteReplica> replicas_;
+  std::optional<tablet::ReportedTabletStatsPB> stats_;
 
   DISALLOW_COPY_AND_ASSIGN(RemoteTablet);
 };
@@ -459,6 +486,11 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
                            const MonoDelta& timeout,
                            std::vector<RangeWithRemoteTablet>* range_tablets);
 
+  // Look up the locations of all the tablets of the given table, caching them.
+  // The locations are fetched from the master in batches of
+  // kFetchTabletsPerRangeLookup tablets.
+  Status PrefetchTableLocations(const KuduTable* table, const MonoTime& deadline);
+
   // Look up the locations of the given tablet, storing the result in
   // 'remote_tablet' if not null, and calling 'lookup_complete_cb' once the
   // lookup is complete. Only tablets with non-failed LEADERs are considered.
@@ -490,6 +522,12 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
                                           MetaCacheEntry* cache_entry,
                                           int max_returned_locations);
 
+  // Process the response to a WatchTableLocations RPC for the given table,
+  // refreshing the cached locations of the tablets whose locations changed.
+  Status ProcessWatchTableLocationsResponse(
+      const std::string& table_id,
+      const master::WatchTableLocationsResponsePB& resp);
+
   // Clears the non-covered range entries from a table's meta cache.
   void ClearNonCoveredRangeEntries(const std::string& table_id);
 
@@ -507,6 +545,10 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
   bool AcquireMasterLookupPermit();
   void ReleaseMasterLookupPermit();
 
+  ReplicaController::Visibility replica_visibility() const {
+    return replica_visibility_;
+  }
+
   // Return stringified representation of the given partition key, using "<start>" if empty.
   static std::string DebugLowerBoundPartitionKey(const KuduTable* table,
                                                  const PartitionKey& partition_key);
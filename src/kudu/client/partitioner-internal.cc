@@ -17,8 +17,12 @@
 
 #include "kudu/client/partitioner-internal.h"
 
+#include <iterator>
 #include <map>
 #include <string>
+#include <vector>
+
+#include <glog/logging.h>
 
 #include "kudu/client/client-internal.h"
 #include "kudu/client/client.h"
@@ -32,6 +36,7 @@
 
 using std::string;
 using std::unique_ptr;
+using std::vector;
 
 namespace kudu {
 namespace client {
@@ -78,8 +83,31 @@ Status KuduPartitionerBuilder::Data::Build(KuduPartitioner** partitioner) {
 
 Status KuduPartitioner::Data::PartitionRow(
     const KuduPartialRow& row, int* partition) {
-  auto partition_key = table_->data_->partition_schema_.EncodeKey(row);
-  *partition = FindFloorOrDie(partitions_by_start_key_, partition_key);
+  table_->data_->partition_schema_.EncodeKey(row, &key_);
+  *partition = FindFloorOrDie(partitions_by_start_key_, key_);
+  return Status::OK();
+}
+
+Status KuduPartitioner::Data::PartitionRows(
+    const vector<const KuduPartialRow*>& rows, vector<int>* partitions) {
+  const auto& partition_schema = table_->data_->partition_schema_;
+  partitions->resize(rows.size());
+
+  // The keys of the partition of the previous row are in [floor->first,
+  // next->first), or at or after floor->first if 'next' is the end.
+  const auto end = partitions_by_start_key_.end();
+  auto floor = end;
+  auto next = end;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    partition_schema.EncodeKey(*rows[i], &key_);
+    if (floor == end || key_ < floor->first || (next != end && key_ >= next->first)) {
+      next = partitions_by_start_key_.upper_bound(key_);
+      // The sentinel for the beginning of the table precedes all the keys.
+      DCHECK(next != partitions_by_start_key_.begin());
+      floor = std::prev(next);
+    }
+    (*partitions)[i] = floor->second;
+  }
   return Status::OK();
 }
 
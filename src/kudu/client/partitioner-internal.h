@@ -19,6 +19,7 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "kudu/client/client.h"
 #include "kudu/client/shared_ptr.h" // IWYU pragma: keep
@@ -68,9 +69,15 @@ class KuduPartitioner::Data {
  public:
   Status PartitionRow(const KuduPartialRow& row, int* partition);
 
+  Status PartitionRows(const std::vector<const KuduPartialRow*>& rows,
+                       std::vector<int>* partitions);
+
   sp::shared_ptr<KuduTable> table_;
   std::map<PartitionKey, int> partitions_by_start_key_;
   int num_partitions_ = 0;
+
+  // The partition key of the last partitioned row, kept to reuse its memory.
+  PartitionKey key_;
 };
 
 
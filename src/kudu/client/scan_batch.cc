@@ -181,6 +181,14 @@ Status KuduScanBatch::RowPtr::GetVarchar(const Slice& col_name, Slice* val) cons
   return Get<TypeTraits<VARCHAR> >(col_name, val);
 }
 
+Status KuduScanBatch::RowPtr::GetArray(const Slice& col_name, Slice* val) const {
+  return Get<TypeTraits<ARRAY> >(col_name, val);
+}
+
+Status KuduScanBatch::RowPtr::GetJson(const Slice& col_name, Slice* val) const {
+  return Get<TypeTraits<JSON> >(col_name, val);
+}
+
 Status KuduScanBatch::RowPtr::GetBool(int col_idx, bool* val) const {
   return Get<TypeTraits<BOOL> >(col_idx, val);
 }
@@ -230,6 +238,14 @@ Status KuduScanBatch::RowPtr::GetVarchar(int col_idx, Slice* val) const {
   return Get<TypeTraits<VARCHAR> >(col_idx, val);
 }
 
+Status KuduScanBatch::RowPtr::GetArray(int col_idx, Slice* val) const {
+  return Get<TypeTraits<ARRAY> >(col_idx, val);
+}
+
+Status KuduScanBatch::RowPtr::GetJson(int col_idx, Slice* val) const {
+  return Get<TypeTraits<JSON> >(col_idx, val);
+}
+
 template<typename T>
 Status KuduScanBatch::RowPtr::Get(const Slice& col_name, typename T::cpp_type* val) const {
   int col_idx;
@@ -305,6 +321,12 @@ Status KuduScanBatch::RowPtr::Get<TypeTraits<BINARY> >(const Slice& col_name, Sl
 template
 Status KuduScanBatch::RowPtr::Get<TypeTraits<VARCHAR> >(const Slice& col_name, Slice* val) const;
 
+template
+Status KuduScanBatch::RowPtr::Get<TypeTraits<ARRAY> >(const Slice& col_name, Slice* val) const;
+
+template
+Status KuduScanBatch::RowPtr::Get<TypeTraits<JSON> >(const Slice& col_name, Slice* val) const;
+
 template
 Status KuduScanBatch::RowPtr::Get<TypeTraits<BOOL> >(int col_idx, bool* val) const;
 
@@ -344,6 +366,12 @@ Status KuduScanBatch::RowPtr::Get<TypeTraits<BINARY> >(int col_idx, Slice* val)
 template
 Status KuduScanBatch::RowPtr::Get<TypeTraits<VARCHAR> >(int col_idx, Slice* val) const;
 
+template
+Status KuduScanBatch::RowPtr::Get<TypeTraits<ARRAY> >(int col_idx, Slice* val) const;
+
+template
+Status KuduScanBatch::RowPtr::Get<TypeTraits<JSON> >(int col_idx, Slice* val) const;
+
 template
 Status KuduScanBatch::RowPtr::Get<TypeTraits<DECIMAL32> >(int col_idx, int32_t* val) const;
 
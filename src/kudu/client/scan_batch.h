@@ -333,6 +333,54 @@ class KUDU_EXPORT KuduScanBatch::RowPtr {
   Status GetVarchar(int col_idx, Slice* val) const WARN_UNUSED_RESULT;
   ///@}
 
+  /// @name Getters for ARRAY columns.
+  ///@{
+
+  /// Get the encoded value of an ARRAY column, which can be read with
+  /// KuduArrayCellView.
+  ///
+  /// @param [in] col_name
+  ///   Name of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  ///   Note that the method does not copy the value. Callers should copy
+  ///   the resulting Slice if necessary.
+  /// @return Operation result status. Return a bad Status if the type does
+  ///   not match, or if the value is @c NULL.
+  Status GetArray(const Slice& col_name, Slice* val) const WARN_UNUSED_RESULT;
+
+  /// @param [in] col_idx
+  ///   The index of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  /// @return Operation result status.
+  Status GetArray(int col_idx, Slice* val) const WARN_UNUSED_RESULT;
+  ///@}
+
+  /// @name Getters for JSON columns.
+  ///@{
+
+  /// Get the UTF-8 text of the JSON document in a JSON column, or of its
+  /// value at the path the scan projects the column to, if any.
+  ///
+  /// @param [in] col_name
+  ///   Name of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  ///   Note that the method does not copy the value. Callers should copy
+  ///   the resulting Slice if necessary.
+  /// @return Operation result status. Return a bad Status if the type does
+  ///   not match, or if the value is @c NULL.
+  Status GetJson(const Slice& col_name, Slice* val) const WARN_UNUSED_RESULT;
+
+  /// @param [in] col_idx
+  ///   The index of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  /// @return Operation result status.
+  Status GetJson(int col_idx, Slice* val) const WARN_UNUSED_RESULT;
+  ///@}
+
   /// Get the column's row data.
   ///
   /// @note Should be avoided unless absolutely necessary.
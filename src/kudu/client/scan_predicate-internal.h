@@ -179,6 +179,30 @@ class InListPredicateData : public KuduPredicate::Data {
   std::vector<KuduValue*> vals_;
 };
 
+// A predicate for selecting the arrays which contain all the given values.
+class ArrayContainsPredicateData : public KuduPredicate::Data {
+ public:
+  ArrayContainsPredicateData(ColumnSchema col, std::vector<KuduValue*>* values);
+
+  virtual ~ArrayContainsPredicateData();
+
+  Status AddToScanSpec(ScanSpec* spec, Arena* arena) override;
+
+  ArrayContainsPredicateData* Clone() const override {
+    std::vector<KuduValue*> values;
+    values.reserve(vals_.size());
+    for (KuduValue* val : vals_) {
+      values.push_back(val->Clone());
+    }
+
+    return new ArrayContainsPredicateData(col_, &values);
+  }
+
+ private:
+  ColumnSchema col_;
+  std::vector<KuduValue*> vals_;
+};
+
 // A predicate for selecting non-null values.
 class IsNotNullPredicateData : public KuduPredicate::Data {
  public:
@@ -153,6 +153,42 @@ Status InListPredicateData::AddToScanSpec(ScanSpec* spec, Arena* /*arena*/) {
   return Status::OK();
 }
 
+ArrayContainsPredicateData::ArrayContainsPredicateData(ColumnSchema col,
+                                                       vector<KuduValue*>* values)
+    : col_(move(col)) {
+  vals_.swap(*values);
+}
+
+ArrayContainsPredicateData::~ArrayContainsPredicateData() {
+  STLDeleteElements(&vals_);
+}
+
+Status ArrayContainsPredicateData::AddToScanSpec(ScanSpec* spec, Arena* /*arena*/) {
+  if (col_.type_info()->type() != ARRAY) {
+    return Status::InvalidArgument(Substitute(
+        "array contains predicate on column '$0' of type $1",
+        col_.name(), col_.type_info()->name()));
+  }
+  if (vals_.empty()) {
+    return Status::InvalidArgument("no values for array contains predicate", col_.name());
+  }
+  vector<const void*> vals_list;
+  vals_list.reserve(vals_.size());
+  for (auto value : vals_) {
+    void* val_void;
+    // As for IN list predicates, the pointers remain owned by the KuduValues.
+    RETURN_NOT_OK(value->data_->CheckTypeAndGetPointer(col_.name(),
+                                                       col_.type_attributes().element_type,
+                                                       ColumnTypeAttributes(),
+                                                       &val_void));
+    vals_list.push_back(val_void);
+  }
+
+  spec->AddPredicate(ColumnPredicate::ArrayContains(col_, &vals_list));
+
+  return Status::OK();
+}
+
 // Helper function to add Bloom filters of different types to the scan spec.
 // "func" is a functor that provides access to the underlying BlockBloomFilter ptr.
 template<typename BloomFilterType, typename BloomFilterPtrFuncType>
@@ -253,6 +253,11 @@ Status KuduScanToken::Data::PBIntoScanner(KuduClient* client,
       RETURN_NOT_OK_LOG(configuration->SetSelection(KuduClient::ReplicaSelection::FIRST_REPLICA),
                         ERROR, "set replica selection FIRST_REPLICA failed");
       break;
+    case kudu::ReplicaSelection::LEAST_LOADED_REPLICA:
+      RETURN_NOT_OK_LOG(configuration->SetSelection(
+                            KuduClient::ReplicaSelection::LEAST_LOADED_REPLICA),
+                        ERROR, "set replica selection LEAST_LOADED_REPLICA failed");
+      break;
     default:
       return Status::NotSupported("unsupported ReplicaSelection policy");
   }
@@ -428,6 +433,9 @@ Status KuduScanTokenBuilder::Data::Build(vector<KuduScanToken*>* tokens) {
     case KuduClient::ReplicaSelection::FIRST_REPLICA:
       pb.set_replica_selection(kudu::ReplicaSelection::FIRST_REPLICA);
       break;
+    case KuduClient::ReplicaSelection::LEAST_LOADED_REPLICA:
+      pb.set_replica_selection(kudu::ReplicaSelection::LEAST_LOADED_REPLICA);
+      break;
     default:
       return Status::InvalidArgument("replica_selection is invalid.");
   }
@@ -561,6 +569,26 @@ Status KuduScanTokenBuilder::Data::Build(vector<KuduScanToken*>* tokens) {
       message.set_upper_bound_primary_key(range.stop_primary_key());
     }
 
+    // Estimate the cost of the scan from the statistics of the tablet. When
+    // the tablet is split, the tablet server estimated the size of each range:
+    // the row count is scaled down by the fraction of the tablet it covers.
+    const auto stats = tablet->stats();
+    if (stats) {
+      uint64_t on_disk_size = stats->on_disk_size();
+      uint64_t live_row_count = stats->live_row_count();
+      if (split_size_bytes_ && range.size_bytes() < on_disk_size) {
+        live_row_count = static_cast<uint64_t>(
+            static_cast<double>(live_row_count) * range.size_bytes() / on_disk_size);
+        on_disk_size = range.size_bytes();
+      }
+      message.set_estimated_on_disk_size(on_disk_size);
+      if (stats->has_live_row_count()) {
+        message.set_estimated_live_row_count(live_row_count);
+      }
+      if (stats->has_num_rowsets()) {
+        message.set_estimated_num_rowsets(stats->num_rowsets());
+      }
+    }
 
     // Set the tablet metadata so that a call to the master is not needed to
     // locate the tablet to scan when opening the scanner.
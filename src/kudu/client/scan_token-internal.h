@@ -45,6 +45,18 @@ class KuduScanToken::Data {
 
   Status Serialize(std::string* buf) const;
 
+  int64_t EstimatedOnDiskSize() const {
+    return message_.has_estimated_on_disk_size() ? message_.estimated_on_disk_size() : -1;
+  }
+
+  int64_t EstimatedLiveRowCount() const {
+    return message_.has_estimated_live_row_count() ? message_.estimated_live_row_count() : -1;
+  }
+
+  int EstimatedNumRowSets() const {
+    return message_.has_estimated_num_rowsets() ? message_.estimated_num_rowsets() : -1;
+  }
+
   static Status DeserializeIntoScanner(KuduClient* client,
                                        const std::string& serialized_token,
                                        KuduScanner** scanner);
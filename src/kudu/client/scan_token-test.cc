@@ -789,6 +789,46 @@ TEST_F(ScanTokenTest, TestScanTokensWithQueryId) {
   }
 }
 
+// Test that the scan tokens carry the cost estimates computed from the
+// statistics the tablet servers report to the master.
+TEST_F(ScanTokenTest, TestScanTokenCostEstimates) {
+  int64_t insert_rows_num = 0;
+  {
+    TestWorkload workload(cluster_.get(), TestWorkload::PartitioningType::HASH);
+    workload.set_table_name("test_table");
+    workload.set_num_tablets(2);
+    workload.set_num_replicas(1);
+    workload.Setup();
+    workload.Start();
+    ASSERT_EVENTUALLY([&]() { ASSERT_GE(workload.rows_inserted(), kRecordCount); });
+    workload.StopAndJoin();
+    insert_rows_num = workload.rows_inserted();
+  }
+
+  // The statistics are only reported periodically: use a new client every
+  // time so that the table locations are fetched from the master again.
+  ASSERT_EVENTUALLY([&]() {
+    shared_ptr<KuduClient> client;
+    ASSERT_OK(cluster_->CreateClient(nullptr, &client));
+    shared_ptr<KuduTable> table;
+    ASSERT_OK(client->OpenTable("test_table", &table));
+    vector<KuduScanToken*> tokens;
+    ElementDeleter deleter(&tokens);
+    KuduScanTokenBuilder builder(table.get());
+    ASSERT_OK(builder.Build(&tokens));
+    ASSERT_EQ(2, tokens.size());
+
+    int64_t live_row_count = 0;
+    for (const auto* token : tokens) {
+      ASSERT_GT(token->EstimatedOnDiskSize(), 0);
+      ASSERT_GE(token->EstimatedLiveRowCount(), 0);
+      ASSERT_GE(token->EstimatedNumRowSets(), 0);
+      live_row_count += token->EstimatedLiveRowCount();
+    }
+    ASSERT_EQ(insert_rows_num, live_row_count);
+  });
+}
+
 TEST_F(ScanTokenTest, TestScanTokensWithNonCoveringRange) {
   // Create schema
   KuduSchema schema;
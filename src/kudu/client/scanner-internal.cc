@@ -19,6 +19,9 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <type_traits>
@@ -26,6 +29,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/message.h>
 
@@ -52,9 +56,15 @@
 #include "kudu/tserver/tserver_service.proxy.h" // IWYU pragma: keep
 #include "kudu/util/async_util.h"
 #include "kudu/util/bitmap.h"
+#include "kudu/util/condition_variable.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/hdr_histogram.h"
 #include "kudu/util/hexdump.h"
+#include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/monotime.h"
+#include "kudu/util/mutex.h"
 #include "kudu/util/stopwatch.h"
 
 using google::protobuf::FieldDescriptor;
@@ -65,25 +75,167 @@ using kudu::rpc::RpcController;
 using kudu::security::SignedTokenPB;
 using kudu::tserver::NewScanRequestPB;
 using kudu::tserver::RowFormatFlags;
+using kudu::tserver::ScanRequestPB;
 using kudu::tserver::ScanResponsePB;
 using kudu::tserver::TabletServerFeatures;
+using kudu::tserver::TabletServerServiceProxy;
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
 
+DEFINE_double(client_scan_hedge_percentile, 0,
+              "If greater than 0, the percentile of the latencies of the RPCs "
+              "opening scans after which a scanner which got no response yet "
+              "sends the same RPC to another replica, taking the first "
+              "successful response. Doesn't apply to LEADER_ONLY scans. "
+              "0 disables hedging.");
+TAG_FLAG(client_scan_hedge_percentile, advanced);
+TAG_FLAG(client_scan_hedge_percentile, experimental);
+TAG_FLAG(client_scan_hedge_percentile, runtime);
+
+DEFINE_double(client_scan_max_hedge_ratio, 0.05,
+              "The maximum ratio of hedged RPCs to RPCs opening scans. See "
+              "--client_scan_hedge_percentile.");
+TAG_FLAG(client_scan_max_hedge_ratio, advanced);
+TAG_FLAG(client_scan_max_hedge_ratio, experimental);
+TAG_FLAG(client_scan_max_hedge_ratio, runtime);
+
+DEFINE_int32(client_async_scan_max_threads, 4,
+             "The maximum number of threads of a client running the steps of "
+             "KuduScanner::NextBatchAsync() calls which may block, such as "
+             "opening the next tablet or retrying after errors. Batches "
+             "continuing the scan of a tablet are fetched on the reactor "
+             "threads.");
+TAG_FLAG(client_async_scan_max_threads, advanced);
+
 namespace kudu {
 
 namespace client {
 
 using internal::RemoteTabletServer;
 
+namespace internal {
+
+namespace {
+// The highest latency tracked for hedging: 60 seconds, in microseconds.
+constexpr uint64_t kMaxHedgedLatencyUs = 60 * 1000 * 1000;
+
+// The number of latencies to observe before hedging any RPC.
+constexpr uint64_t kMinHedgingSamples = 100;
+} // anonymous namespace
+
+ScanHedgingPolicy::ScanHedgingPolicy()
+    : latencies_(kMaxHedgedLatencyUs, 2),
+      num_hedges_(0) {
+}
+
+bool ScanHedgingPolicy::GetHedgeDelay(MonoDelta* delay) const {
+  const double percentile = FLAGS_client_scan_hedge_percentile;
+  if (percentile <= 0 || latencies_.TotalCount() < kMinHedgingSamples) {
+    return false;
+  }
+  *delay = MonoDelta::FromMicroseconds(latencies_.ValueAtPercentile(std::min(percentile, 100.0)));
+  return true;
+}
+
+void ScanHedgingPolicy::RecordLatency(const MonoDelta& latency) {
+  latencies_.Increment(latency.ToMicroseconds());
+}
+
+bool ScanHedgingPolicy::AdmitHedge() {
+  const double max_hedges = FLAGS_client_scan_max_hedge_ratio * latencies_.TotalCount();
+  int64_t num_hedges = num_hedges_.load(std::memory_order_relaxed);
+  do {
+    if (num_hedges + 1 > max_hedges) {
+      return false;
+    }
+  } while (!num_hedges_.compare_exchange_weak(num_hedges, num_hedges + 1,
+                                              std::memory_order_relaxed));
+  return true;
+}
+
+} // namespace internal
+
+namespace {
+
+// One of the attempts of a hedged scan RPC.
+struct HedgedScanAttempt {
+  RemoteTabletServer* ts = nullptr;
+  shared_ptr<TabletServerServiceProxy> proxy;
+  RpcController controller;
+  ScanResponsePB resp;
+  bool sent = false;
+  bool done = false;
+
+  bool succeeded() const {
+    return done && controller.status().ok() && !resp.has_error();
+  }
+};
+
+// The state of a hedged scan RPC, shared with the callbacks of its attempts:
+// it outlives the scanner if the attempt whose response wasn't taken is still
+// in flight.
+struct HedgedScan {
+  explicit HedgedScan(MonoDelta close_timeout)
+      : cond(&lock),
+        close_timeout(close_timeout) {
+  }
+
+  // Closes the scanner opened by the attempt 'idx', whose response wasn't taken.
+  //
+  // REQUIRES: 'lock' is held, the attempt is done.
+  void CloseLosingScanner(int idx) {
+    const HedgedScanAttempt& attempt = attempts[idx];
+    if (!attempt.succeeded() || !attempt.resp.has_more_results()) {
+      return;
+    }
+    struct Closer {
+      ScanRequestPB req;
+      ScanResponsePB resp;
+      RpcController controller;
+    };
+    Closer* closer = new Closer;
+    closer->req.set_scanner_id(attempt.resp.scanner_id());
+    closer->req.set_call_seq_id(1);
+    closer->req.set_batch_size_bytes(0);
+    closer->req.set_close_scanner(true);
+    closer->controller.set_timeout(close_timeout);
+    attempt.proxy->ScanAsync(closer->req, &closer->resp, &closer->controller,
+                             [closer]() { delete closer; });
+  }
+
+  void OnAttemptDone(int idx) {
+    MutexLock l(lock);
+    attempts[idx].done = true;
+    if (winner >= 0 && winner != idx) {
+      CloseLosingScanner(idx);
+    }
+    cond.Broadcast();
+  }
+
+  Mutex lock;
+  ConditionVariable cond;
+  const MonoDelta close_timeout;
+
+  // The first attempt is sent to the replica picked for the scan, the second
+  // one to another replica if the first one is slow.
+  HedgedScanAttempt attempts[2];
+
+  // The index of the attempt whose response is taken, or -1 while undecided.
+  int winner = -1;
+};
+
+} // anonymous namespace
+
 KuduScanner::Data::Data(KuduTable* table)
   : configuration_(table),
     open_(false),
     data_in_open_(false),
     short_circuit_(false),
+    prefetching_(false),
     table_(DCHECK_NOTNULL(table)->shared_from_this()),
     scan_attempts_(0),
     num_rows_returned_(0) {
@@ -315,6 +467,10 @@ ScanRpcStatus KuduScanner::Data::AnalyzeResponse(const Status& rpc_status,
       return ScanRpcStatus{ScanRpcStatus::SCANNER_EXPIRED, server_status};
     case tserver::TabletServerErrorPB::TABLET_NOT_RUNNING:
       return ScanRpcStatus{ScanRpcStatus::TABLET_NOT_RUNNING, server_status};
+    case tserver::TabletServerErrorPB::NOT_THE_LEADER:
+      // Returned by a leader which couldn't confirm its leadership in time to
+      // serve a READ_LATEST scan; another replica may serve it.
+      return ScanRpcStatus{ScanRpcStatus::TABLET_NOT_RUNNING, server_status};
     case tserver::TabletServerErrorPB::TABLET_FAILED: // fall-through
     case tserver::TabletServerErrorPB::TABLET_NOT_FOUND:
       return ScanRpcStatus{ScanRpcStatus::TABLET_NOT_FOUND, server_status};
@@ -337,42 +493,49 @@ Status KuduScanner::Data::ReopenCurrentTablet(const MonoTime& deadline,
                     blacklist);
 }
 
-ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
-                                             bool allow_time_for_failover) {
+MonoTime KuduScanner::Data::ComputeRpcDeadline(const MonoTime& overall_deadline,
+                                               bool allow_time_for_failover) const {
   // The user has specified a timeout which should apply to the total time for each call
   // to NextBatch(). However, for fault-tolerant scans, or for when we are first opening
   // a scanner, it's preferable to set a shorter timeout (the "default RPC timeout") for
   // each individual RPC call. This gives us time to fail over to a different server
   // if the first server we try happens to be hung.
-  MonoTime rpc_deadline;
   if (allow_time_for_failover) {
-    rpc_deadline = MonoTime::Now() + table_->client()->default_rpc_timeout();
-    rpc_deadline = std::min(overall_deadline, rpc_deadline);
-  } else {
-    rpc_deadline = overall_deadline;
+    return std::min(overall_deadline, MonoTime::Now() + table_->client()->default_rpc_timeout());
   }
+  return overall_deadline;
+}
 
+void KuduScanner::Data::PrepareController(const MonoTime& rpc_deadline,
+                                          RpcController* controller) {
   // Capture previously sent Bloom filter predicate feature flag so that we don't have to make
   // expensive call to determine the flag on scan continuations.
   bool prev_bloom_filter_feature = ContainsKey(controller_.required_server_features(),
                                                TabletServerFeatures::BLOOM_FILTER_PREDICATE_V2);
 
-  controller_.Reset();
-  controller_.set_deadline(rpc_deadline);
+  controller->Reset();
+  controller->set_deadline(rpc_deadline);
   if (!configuration_.spec().predicates().empty()) {
-    controller_.RequireServerFeature(TabletServerFeatures::COLUMN_PREDICATES);
+    controller->RequireServerFeature(TabletServerFeatures::COLUMN_PREDICATES);
     if (prev_bloom_filter_feature ||
         (next_req_.has_new_scan_request() &&
          configuration().spec().ContainsBloomFilterPredicate())) {
-      controller_.RequireServerFeature(TabletServerFeatures::BLOOM_FILTER_PREDICATE_V2);
+      controller->RequireServerFeature(TabletServerFeatures::BLOOM_FILTER_PREDICATE_V2);
     }
   }
   if (configuration().row_format_flags() & KuduScanner::PAD_UNIXTIME_MICROS_TO_16_BYTES) {
-    controller_.RequireServerFeature(TabletServerFeatures::PAD_UNIXTIME_MICROS_TO_16_BYTES);
+    controller->RequireServerFeature(TabletServerFeatures::PAD_UNIXTIME_MICROS_TO_16_BYTES);
   }
   if (configuration().row_format_flags() & KuduScanner::COLUMNAR_LAYOUT) {
-    controller_.RequireServerFeature(TabletServerFeatures::COLUMNAR_LAYOUT_FEATURE);
+    controller->RequireServerFeature(TabletServerFeatures::COLUMNAR_LAYOUT_FEATURE);
   }
+}
+
+ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
+                                             bool allow_time_for_failover,
+                                             RemoteTabletServer* hedge_ts) {
+  const MonoTime rpc_deadline = ComputeRpcDeadline(overall_deadline, allow_time_for_failover);
+  PrepareController(rpc_deadline, &controller_);
 
   if (next_req_.has_new_scan_request()) {
     // Only new scan requests require authz tokens. Scan continuations rely on
@@ -386,11 +549,33 @@ ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
       VLOG(1) << "no authz token for table " << table_->id();
     }
   }
-  ScanRpcStatus scan_status = AnalyzeResponse(
-      proxy_->Scan(next_req_,
-                   &last_response_,
-                   &controller_),
-      rpc_deadline, overall_deadline);
+  auto* hedging_policy = table_->client()->data_->scan_hedging_policy_.get();
+  const bool track_latency =
+      next_req_.has_new_scan_request() && FLAGS_client_scan_hedge_percentile > 0;
+  const MonoTime start = MonoTime::Now();
+  RemoteTabletServer* rpc_ts = ts_;
+  rpc_ts->StartRpc();
+  Status rpc_status;
+  MonoDelta hedge_delay;
+  if (hedge_ts != nullptr && track_latency && hedging_policy->GetHedgeDelay(&hedge_delay)) {
+    rpc_status = SendHedgedScanRpc(rpc_deadline, hedge_delay, hedge_ts);
+  } else {
+    rpc_status = proxy_->Scan(next_req_, &last_response_, &controller_);
+  }
+  // If the RPC was hedged and the other replica answered first, this is a
+  // lower bound of the latency of this one, still in flight.
+  rpc_ts->FinishRpc(MonoTime::Now() - start);
+  ScanRpcStatus scan_status = FinishScanRpc(rpc_status, rpc_deadline, overall_deadline);
+  if (scan_status.result == ScanRpcStatus::OK && track_latency) {
+    hedging_policy->RecordLatency(MonoTime::Now() - start);
+  }
+  return scan_status;
+}
+
+ScanRpcStatus KuduScanner::Data::FinishScanRpc(const Status& rpc_status,
+                                               const MonoTime& rpc_deadline,
+                                               const MonoTime& overall_deadline) {
+  ScanRpcStatus scan_status = AnalyzeResponse(rpc_status, rpc_deadline, overall_deadline);
   if (scan_status.result == ScanRpcStatus::OK) {
     UpdateResourceMetrics();
     num_rows_returned_ += last_response_.has_data() ? last_response_.data().num_rows() : 0;
@@ -400,6 +585,146 @@ ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
   return scan_status;
 }
 
+void KuduScanner::Data::PendingScanRpc::Finish() {
+  ts->FinishRpc(MonoTime::Now() - start);
+  status = controller.status();
+  std::function<void()> cb;
+  {
+    std::lock_guard<simple_spinlock> l(lock);
+    finished = true;
+    cb = std::move(on_finished);
+  }
+  latch.CountDown();
+  // The callback may destroy this object.
+  if (cb) {
+    cb();
+  }
+}
+
+void KuduScanner::Data::PendingScanRpc::OnFinished(std::function<void()> cb) {
+  {
+    std::lock_guard<simple_spinlock> l(lock);
+    if (!finished) {
+      on_finished = std::move(cb);
+      return;
+    }
+  }
+  cb();
+}
+
+void KuduScanner::Data::SendPendingScanRpc(const MonoTime& batch_deadline) {
+  DCHECK(!pending_rpc_);
+  DCHECK(last_response_.has_more_results());
+  PrepareRequest(CONTINUE);
+  auto rpc = std::make_shared<PendingScanRpc>();
+  rpc->ts = ts_;
+  rpc->batch_deadline = batch_deadline;
+  rpc->rpc_deadline = ComputeRpcDeadline(batch_deadline, configuration_.is_fault_tolerant());
+  PrepareController(rpc->rpc_deadline, &rpc->controller);
+  rpc->start = MonoTime::Now();
+  rpc->ts->StartRpc();
+  pending_rpc_ = rpc;
+  // 'pending_rpc_' isn't released before the RPC has finished.
+  PendingScanRpc* rpc_raw = rpc.get();
+  proxy_->ScanAsync(next_req_, &rpc->response, &rpc->controller,
+                    [rpc_raw]() { rpc_raw->Finish(); });
+}
+
+ScanRpcStatus KuduScanner::Data::TakePendingScanRpc() {
+  DCHECK(pending_rpc_);
+  shared_ptr<PendingScanRpc> rpc = std::move(pending_rpc_);
+  // Don't wait if the RPC has finished, as on the reactor thread of
+  // NextBatchAsync() callbacks.
+  if (rpc->latch.count() > 0) {
+    rpc->latch.Wait();
+  }
+  last_response_.Swap(&rpc->response);
+  controller_.Swap(&rpc->controller);
+  return FinishScanRpc(rpc->status, rpc->rpc_deadline, rpc->batch_deadline);
+}
+
+void KuduScanner::Data::MaybePrefetch() {
+  if (prefetching_ && !pending_rpc_ && last_response_.has_more_results()) {
+    SendPendingScanRpc(MonoTime::Now() + configuration_.timeout());
+  }
+}
+
+Status KuduScanner::Data::SendHedgedScanRpc(const MonoTime& rpc_deadline,
+                                           const MonoDelta& hedge_delay,
+                                           RemoteTabletServer* hedge_ts) {
+  auto scan = std::make_shared<HedgedScan>(configuration_.timeout());
+  // The request is serialized when sent, so both attempts may send next_req_.
+  auto send = [&](int idx, RemoteTabletServer* ts, shared_ptr<TabletServerServiceProxy> proxy) {
+    HedgedScanAttempt* attempt = &scan->attempts[idx];
+    attempt->ts = ts;
+    attempt->proxy = std::move(proxy);
+    attempt->controller.set_deadline(rpc_deadline);
+    for (uint32_t feature : controller_.required_server_features()) {
+      attempt->controller.RequireServerFeature(feature);
+    }
+    attempt->sent = true;
+    attempt->proxy->ScanAsync(next_req_, &attempt->resp, &attempt->controller,
+                              [scan, idx]() { scan->OnAttemptDone(idx); });
+  };
+
+  const MonoTime hedge_time = MonoTime::Now() + hedge_delay;
+  send(0, ts_, proxy_);
+  bool first_done;
+  {
+    MutexLock l(scan->lock);
+    while (!scan->attempts[0].done && scan->cond.WaitUntil(hedge_time)) {
+    }
+    first_done = scan->attempts[0].done;
+  }
+  auto* hedging_policy = table_->client()->data_->scan_hedging_policy_.get();
+  if (!first_done && hedging_policy->AdmitHedge()) {
+    Synchronizer sync;
+    hedge_ts->InitProxy(table_->client(), sync.AsStatusCallback());
+    Status s = sync.Wait();
+    if (s.ok()) {
+      VLOG(1) << Substitute("Hedging scan of tablet $0 on $1 after $2 with $3",
+                            remote_->tablet_id(), ts_->ToString(), hedge_delay.ToString(),
+                            hedge_ts->ToString());
+      send(1, hedge_ts, hedge_ts->proxy());
+    } else {
+      VLOG(1) << "Not hedging scan: " << s.ToString();
+    }
+  }
+
+  int winner;
+  {
+    MutexLock l(scan->lock);
+    while (true) {
+      // Take the first successful response, or the first attempt's one if
+      // none succeeded.
+      const auto& attempts = scan->attempts;
+      winner = attempts[0].succeeded() ? 0 : (attempts[1].succeeded() ? 1 : -1);
+      if (winner < 0 && attempts[0].done && (!attempts[1].sent || attempts[1].done)) {
+        winner = 0;
+      }
+      if (winner >= 0) {
+        break;
+      }
+      scan->cond.Wait();
+    }
+    scan->winner = winner;
+    const int loser = 1 - winner;
+    if (scan->attempts[loser].done) {
+      scan->CloseLosingScanner(loser);
+    }
+  }
+
+  // The attempt taken is done, so its callback won't access it anymore.
+  HedgedScanAttempt* taken = &scan->attempts[winner];
+  controller_.Swap(&taken->controller);
+  last_response_.Swap(&taken->resp);
+  if (winner == 1) {
+    ts_ = taken->ts;
+    proxy_ = std::move(taken->proxy);
+  }
+  return controller_.status();
+}
+
 Status KuduScanner::Data::OpenTablet(const PartitionKey& partition_key,
                                      const MonoTime& deadline,
                                      set<string>* blacklist) {
@@ -559,7 +884,18 @@ Status KuduScanner::Data::OpenTablet(const PartitionKey& partition_key,
     proxy_ = ts_->proxy();
 
     bool allow_time_for_failover = candidates.size() > blacklist->size() + 1;
-    ScanRpcStatus scan_status = SendScanRpc(deadline, allow_time_for_failover);
+
+    // Scans of any replica may be hedged by another one.
+    RemoteTabletServer* hedge_ts = nullptr;
+    if (configuration_.selection() != KuduClient::LEADER_ONLY) {
+      for (RemoteTabletServer* candidate : candidates) {
+        if (candidate != ts && !ContainsKey(*blacklist, candidate->permanent_uuid())) {
+          hedge_ts = candidate;
+          break;
+        }
+      }
+    }
+    ScanRpcStatus scan_status = SendScanRpc(deadline, allow_time_for_failover, hedge_ts);
     if (scan_status.result == ScanRpcStatus::OK) {
       last_error_ = Status::OK();
       scan_attempts_ = 0;
@@ -17,8 +17,10 @@
 #ifndef KUDU_CLIENT_SCANNER_INTERNAL_H
 #define KUDU_CLIENT_SCANNER_INTERNAL_H
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <ostream>
 #include <set>
@@ -40,11 +42,16 @@
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/rpc/rpc_controller.h"
 #include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/hdr_histogram.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
 
+class MonoDelta;
 class MonoTime;
 class PartitionKey;
 class Schema;
@@ -60,6 +67,34 @@ class KuduSchema;
 namespace internal {
 class RemoteTablet;
 class RemoteTabletServer;
+
+// Decides when the scanners of a client hedge the RPCs opening their scans:
+// once such an RPC got no response within the --client_scan_hedge_percentile
+// percentile of the latencies observed so far, the same request is sent to
+// another replica and the first successful response is taken. The hedged RPCs
+// are limited to --client_scan_max_hedge_ratio of the RPCs.
+//
+// This class is thread-safe.
+class ScanHedgingPolicy {
+ public:
+  ScanHedgingPolicy();
+
+  // Returns whether the next RPC opening a scan may be hedged, setting 'delay'
+  // to how long to wait for its response before hedging it if so.
+  bool GetHedgeDelay(MonoDelta* delay) const;
+
+  // Records the latency of a successful RPC opening a scan.
+  void RecordLatency(const MonoDelta& latency);
+
+  // Returns whether an RPC may be hedged within the budget, counting it if so.
+  bool AdmitHedge();
+
+ private:
+  HdrHistogram latencies_;
+  std::atomic<int64_t> num_hedges_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScanHedgingPolicy);
+};
 } // namespace internal
 
 // The result of KuduScanner::Data::AnalyzeResponse.
@@ -132,7 +167,13 @@ class KuduScanner::Data {
   // will use 'overall_deadline' as its deadline.
   //
   // The RPC and TS proxy should already have been prepared in next_req_, proxy_, etc.
-  ScanRpcStatus SendScanRpc(const MonoTime& overall_deadline, bool allow_time_for_failover);
+  //
+  // If 'hedge_ts' isn't null, the RPC may be hedged by sending it to 'hedge_ts' as
+  // well, per the client's ScanHedgingPolicy. In that case, ts_ and proxy_ are
+  // switched to 'hedge_ts' if its response is the one taken.
+  ScanRpcStatus SendScanRpc(const MonoTime& overall_deadline,
+                            bool allow_time_for_failover,
+                            internal::RemoteTabletServer* hedge_ts = nullptr);
 
   // Called when KuduScanner::NextBatch or KuduScanner::Data::OpenTablet result in an RPC or
   // server error.
@@ -150,6 +191,62 @@ class KuduScanner::Data {
                      std::set<std::string>* blacklist,
                      bool* needs_reopen);
 
+  // Sends the RPC in next_req_ to proxy_ like SendScanRpc(), hedging it by
+  // sending it to 'hedge_ts' too if it got no response after 'hedge_delay'.
+  // Returns the status of the RPC whose response was taken.
+  Status SendHedgedScanRpc(const MonoTime& rpc_deadline,
+                           const MonoDelta& hedge_delay,
+                           internal::RemoteTabletServer* hedge_ts);
+
+  // A CONTINUE scan RPC sent ahead of the NextBatch() call taking its
+  // response, to prefetch the next batch or by NextBatchAsync().
+  struct PendingScanRpc {
+    PendingScanRpc() : latch(1) {}
+
+    // Called on the reactor thread once the RPC has finished.
+    void Finish();
+
+    // Runs 'cb' once the RPC has finished: right away on this thread if it
+    // already has, otherwise on the reactor thread finishing it.
+    void OnFinished(std::function<void()> cb);
+
+    // Whether the RPC has finished with a response free of errors.
+    //
+    // REQUIRES: the RPC has finished.
+    bool succeeded() const {
+      return status.ok() && !response.has_error();
+    }
+
+    internal::RemoteTabletServer* ts = nullptr;
+    tserver::ScanResponsePB response;
+    rpc::RpcController controller;
+    MonoTime start;
+    MonoTime rpc_deadline;
+    MonoTime batch_deadline;
+    // The status of the RPC, set once finished.
+    Status status;
+    CountDownLatch latch;
+
+    // Protects 'finished' and 'on_finished'.
+    simple_spinlock lock;
+    bool finished = false;
+    std::function<void()> on_finished;
+  };
+
+  // Sends the CONTINUE request for the next batch of the current tablet to
+  // proxy_ without waiting for its response, as 'pending_rpc_'.
+  //
+  // REQUIRES: last_response_ has more results, 'pending_rpc_' is null.
+  void SendPendingScanRpc(const MonoTime& batch_deadline);
+
+  // Waits for 'pending_rpc_' to finish and takes its response into
+  // last_response_ and controller_, returning its outcome like SendScanRpc().
+  ScanRpcStatus TakePendingScanRpc();
+
+  // Sends the RPC for the next batch ahead of the NextBatch() call, if
+  // prefetching is enabled and the current tablet has more results.
+  void MaybePrefetch();
+
   // Opens the next tablet in the scan, or returns Status::NotFound if there are
   // no more tablets to scan.
   //
@@ -235,6 +332,13 @@ class KuduScanner::Data {
   // RPC controller for the last in-flight RPC.
   rpc::RpcController controller_;
 
+  // Whether the RPC for the next batch is sent as soon as a batch is
+  // returned. See KuduScanner::SetPrefetching().
+  bool prefetching_;
+
+  // The CONTINUE RPC sent ahead for the next batch, if any.
+  std::shared_ptr<PendingScanRpc> pending_rpc_;
+
   // The table we're scanning.
   sp::shared_ptr<KuduTable> table_;
 
@@ -287,6 +391,21 @@ class KuduScanner::Data {
                                 const MonoTime& overall_deadline,
                                 const MonoTime& rpc_deadline);
 
+  // Returns the deadline of a scan RPC of a batch due by 'overall_deadline'.
+  // See SendScanRpc().
+  MonoTime ComputeRpcDeadline(const MonoTime& overall_deadline,
+                              bool allow_time_for_failover) const;
+
+  // Resets 'controller' for a scan RPC of next_req_ due by 'rpc_deadline',
+  // requiring the server features it needs.
+  void PrepareController(const MonoTime& rpc_deadline, rpc::RpcController* controller);
+
+  // Analyzes the response of the scan RPC whose response was just taken into
+  // last_response_ and controller_, accounting for it if it succeeded.
+  ScanRpcStatus FinishScanRpc(const Status& rpc_status,
+                              const MonoTime& rpc_deadline,
+                              const MonoTime& overall_deadline);
+
   // Add additional details to the status message, such as number of retries,
   // original cause of the error, etc. Returns a cloned object.
   Status EnrichStatusMessage(Status s) const;
@@ -396,9 +515,9 @@ class KuduColumnarScanBatch::Data : public internal::ScanBatchDataInterface {
   ColumnarRowBlockPB resp_data_;
 
   // The projection being scanned.
-  const Schema* projection_;
+  const Schema* projection_ = nullptr;
   // The KuduSchema version of 'projection_'
-  const KuduSchema* client_projection_;
+  const KuduSchema* client_projection_ = nullptr;
 };
 
 
@@ -48,12 +48,15 @@ class KuduColumnTypeAttributes::Data {
   Data(int8_t precision, int8_t scale, uint16_t length)
       : precision(precision),
         scale(scale),
-        length(length) {
+        length(length),
+        element_type(kudu::UNKNOWN_DATA) {
   }
 
   int8_t precision;
   int8_t scale;
   uint16_t length;
+  // The type of the elements of ARRAY columns.
+  kudu::DataType element_type;
 };
 
 class KuduColumnSpec::Data {
@@ -78,6 +81,7 @@ class KuduColumnSpec::Data {
   std::optional<int8_t> precision;
   std::optional<int8_t> scale;
   std::optional<uint16_t> length;
+  std::optional<KuduColumnSchema::DataType> element_type;
   std::optional<KuduColumnStorageAttributes::EncodingType> encoding;
   std::optional<KuduColumnStorageAttributes::CompressionType> compression;
   std::optional<int32_t> block_size;
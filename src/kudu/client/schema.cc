@@ -29,6 +29,7 @@
 #include "kudu/client/schema-internal.h"
 #include "kudu/client/value-internal.h"
 #include "kudu/client/value.h"
+#include "kudu/common/array_cell.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/partial_row.h"
 #include "kudu/common/schema.h"
@@ -81,6 +82,9 @@ kudu::EncodingType ToInternalEncodingType(KuduColumnStorageAttributes::EncodingT
     case KuduColumnStorageAttributes::GROUP_VARINT: return kudu::GROUP_VARINT;
     case KuduColumnStorageAttributes::RLE: return kudu::RLE;
     case KuduColumnStorageAttributes::BIT_SHUFFLE: return kudu::BIT_SHUFFLE;
+    case KuduColumnStorageAttributes::FRAME_OF_REFERENCE: return kudu::FRAME_OF_REFERENCE;
+    case KuduColumnStorageAttributes::ADAPTIVE_ENCODING: return kudu::ADAPTIVE_ENCODING;
+    case KuduColumnStorageAttributes::XOR_ENCODING: return kudu::XOR_ENCODING;
     default: LOG(FATAL) << "Unexpected encoding type: " << type;
   }
 }
@@ -94,6 +98,9 @@ KuduColumnStorageAttributes::EncodingType FromInternalEncodingType(kudu::Encodin
     case kudu::GROUP_VARINT: return KuduColumnStorageAttributes::GROUP_VARINT;
     case kudu::RLE: return KuduColumnStorageAttributes::RLE;
     case kudu::BIT_SHUFFLE: return KuduColumnStorageAttributes::BIT_SHUFFLE;
+    case kudu::FRAME_OF_REFERENCE: return KuduColumnStorageAttributes::FRAME_OF_REFERENCE;
+    case kudu::ADAPTIVE_ENCODING: return KuduColumnStorageAttributes::ADAPTIVE_ENCODING;
+    case kudu::XOR_ENCODING: return KuduColumnStorageAttributes::XOR_ENCODING;
     default: LOG(FATAL) << "Unexpected internal encoding type: " << type;
   }
 }
@@ -105,6 +112,7 @@ kudu::CompressionType ToInternalCompressionType(KuduColumnStorageAttributes::Com
     case KuduColumnStorageAttributes::SNAPPY: return kudu::SNAPPY;
     case KuduColumnStorageAttributes::LZ4: return kudu::LZ4;
     case KuduColumnStorageAttributes::ZLIB: return kudu::ZLIB;
+    case KuduColumnStorageAttributes::ZSTD: return kudu::ZSTD;
     default: LOG(FATAL) << "Unexpected compression type" << type;
   }
 }
@@ -117,6 +125,7 @@ KuduColumnStorageAttributes::CompressionType FromInternalCompressionType(
     case kudu::SNAPPY: return KuduColumnStorageAttributes::SNAPPY;
     case kudu::LZ4: return KuduColumnStorageAttributes::LZ4;
     case kudu::ZLIB: return KuduColumnStorageAttributes::ZLIB;
+    case kudu::ZSTD: return KuduColumnStorageAttributes::ZSTD;
     default: LOG(FATAL) << "Unexpected internal compression type: " << type;
   }
 }
@@ -137,6 +146,8 @@ kudu::DataType ToInternalDataType(KuduColumnSchema::DataType type,
     case KuduColumnSchema::STRING: return kudu::STRING;
     case KuduColumnSchema::BINARY: return kudu::BINARY;
     case KuduColumnSchema::BOOL: return kudu::BOOL;
+    case KuduColumnSchema::ARRAY: return kudu::ARRAY;
+    case KuduColumnSchema::JSON: return kudu::JSON;
     case KuduColumnSchema::DECIMAL:
       if (attributes.precision() <= kMaxDecimal32Precision) {
         return kudu::DECIMAL32;
@@ -169,6 +180,8 @@ KuduColumnSchema::DataType FromInternalDataType(kudu::DataType type) {
     case kudu::DECIMAL32: return KuduColumnSchema::DECIMAL;
     case kudu::DECIMAL64: return KuduColumnSchema::DECIMAL;
     case kudu::DECIMAL128: return KuduColumnSchema::DECIMAL;
+    case kudu::ARRAY: return KuduColumnSchema::ARRAY;
+    case kudu::JSON: return KuduColumnSchema::JSON;
     default: LOG(FATAL) << "Unexpected internal data type: " << type;
   }
 }
@@ -244,6 +257,12 @@ Status KuduColumnStorageAttributes::StringToEncodingType(
     *type = KuduColumnStorageAttributes::DICT_ENCODING;
   } else if (encoding_uc == "BIT_SHUFFLE") {
     *type = KuduColumnStorageAttributes::BIT_SHUFFLE;
+  } else if (encoding_uc == "FRAME_OF_REFERENCE") {
+    *type = KuduColumnStorageAttributes::FRAME_OF_REFERENCE;
+  } else if (encoding_uc == "ADAPTIVE_ENCODING") {
+    *type = KuduColumnStorageAttributes::ADAPTIVE_ENCODING;
+  } else if (encoding_uc == "XOR_ENCODING") {
+    *type = KuduColumnStorageAttributes::XOR_ENCODING;
   } else if (encoding_uc == "GROUP_VARINT") {
     *type = KuduColumnStorageAttributes::GROUP_VARINT;
   } else {
@@ -268,6 +287,8 @@ Status KuduColumnStorageAttributes::StringToCompressionType(
     *type = KuduColumnStorageAttributes::LZ4;
   } else if (compression_uc == "ZLIB") {
     *type = KuduColumnStorageAttributes::ZLIB;
+  } else if (compression_uc == "ZSTD") {
+    *type = KuduColumnStorageAttributes::ZSTD;
   } else {
     return Status::InvalidArgument(Substitute(
         "compression type $0 is not supported", compression));
@@ -333,6 +354,11 @@ KuduColumnSpec* KuduColumnSpec::Length(uint16_t length) {
   return this;
 }
 
+KuduColumnSpec* KuduColumnSpec::ArrayElementType(KuduColumnSchema::DataType element_type) {
+  data_->element_type = element_type;
+  return this;
+}
+
 KuduColumnSpec* KuduColumnSpec::PrimaryKey() {
   data_->primary_key = true;
   data_->primary_key_unique = true;
@@ -448,6 +474,24 @@ Status KuduColumnSpec::ToColumnSchema(KuduColumnSchema* col) const {
                                 data_->type.value()), data_->name);
       }
       break;
+    case KuduColumnSchema::ARRAY:
+      if (!data_->element_type) {
+        return Status::InvalidArgument("no element type provided for ARRAY column",
+                                       data_->name);
+      }
+      if (!IsArrayElementTypeSupported(
+              ToInternalDataType(data_->element_type.value(), KuduColumnTypeAttributes()))) {
+        return Status::InvalidArgument(
+            strings::Substitute("arrays of $0 are not supported",
+                                KuduColumnSchema::DataTypeToString(data_->element_type.value())),
+            data_->name);
+      }
+      if (data_->precision || data_->scale || data_->length) {
+        return Status::InvalidArgument(
+            strings::Substitute("precision, scale and length are not valid on a $0 column",
+                                data_->type.value()), data_->name);
+      }
+      break;
     default:
       if (data_->precision) {
         return Status::InvalidArgument(
@@ -465,12 +509,21 @@ Status KuduColumnSpec::ToColumnSchema(KuduColumnSchema* col) const {
                                 data_->type.value()), data_->name);
       }
   }
+  if (data_->element_type && data_->type.value() != KuduColumnSchema::ARRAY) {
+    return Status::InvalidArgument(
+        strings::Substitute("element type is not valid on a $0 column",
+                            data_->type.value()), data_->name);
+  }
 
   int8_t precision = data_->precision ? data_->precision.value() : 0;
   int8_t scale = data_->scale ? data_->scale.value() : kDefaultDecimalScale;
   uint16_t length = data_->length ? data_->length.value() : 0;
 
   KuduColumnTypeAttributes type_attrs(precision, scale, length);
+  if (data_->element_type) {
+    type_attrs.data_->element_type =
+        ToInternalDataType(data_->element_type.value(), KuduColumnTypeAttributes());
+  }
   DataType internal_type = ToInternalDataType(data_->type.value(), type_attrs);
   bool nullable = data_->nullable ? data_->nullable.value() : true;
   bool immutable = data_->immutable ? data_->immutable.value() : false;
@@ -479,6 +532,7 @@ Status KuduColumnSpec::ToColumnSchema(KuduColumnSchema* col) const {
   // TODO(unknown): distinguish between DEFAULT NULL and no default?
   if (data_->default_val) {
     ColumnTypeAttributes internal_type_attrs(precision, scale);
+    internal_type_attrs.element_type = type_attrs.data_->element_type;
     RETURN_NOT_OK(data_->default_val.value()->data_->CheckTypeAndGetPointer(
         data_->name, internal_type, internal_type_attrs,  &default_val));
   }
@@ -767,6 +821,10 @@ string KuduColumnSchema::DataTypeToString(DataType type) {
       return "VARCHAR";
     case SERIAL:
       return "SERIAL";
+    case ARRAY:
+      return "ARRAY";
+    case JSON:
+      return "JSON";
   }
   LOG(FATAL) << "Unhandled type " << type;
 }
@@ -803,6 +861,10 @@ string KuduColumnSchema::DataTypeToString(DataType type) {
     *type = DATE;
   } else if (type_uc == "SERIAL") {
     *type = SERIAL;
+  } else if (type_uc == "ARRAY") {
+    *type = ARRAY;
+  } else if (type_uc == "JSON") {
+    *type = JSON;
   } else {
     return Status::InvalidArgument(Substitute(
         "data type $0 is not supported", type_str));
@@ -827,6 +889,7 @@ KuduColumnSchema::KuduColumnSchema(const string &name,
   type_attr_private.precision = type_attributes.precision();
   type_attr_private.scale = type_attributes.scale();
   type_attr_private.length = type_attributes.length();
+  type_attr_private.element_type = type_attributes.data_->element_type;
   col_ = new ColumnSchema(name, ToInternalDataType(type, type_attributes),
                           is_nullable,
                           is_immutable,
@@ -894,8 +957,15 @@ KuduColumnSchema::DataType KuduColumnSchema::type() const {
 
 KuduColumnTypeAttributes KuduColumnSchema::type_attributes() const {
   ColumnTypeAttributes type_attributes = DCHECK_NOTNULL(col_)->type_attributes();
-  return KuduColumnTypeAttributes(type_attributes.precision, type_attributes.scale,
-                                  type_attributes.length);
+  KuduColumnTypeAttributes attrs(type_attributes.precision, type_attributes.scale,
+                                 type_attributes.length);
+  attrs.data_->element_type = type_attributes.element_type;
+  return attrs;
+}
+
+KuduColumnSchema::DataType KuduColumnSchema::array_element_type() const {
+  DCHECK_EQ(kudu::ARRAY, DCHECK_NOTNULL(col_)->type_info()->type());
+  return FromInternalDataType(col_->type_attributes().element_type);
 }
 
 KuduColumnStorageAttributes KuduColumnSchema::storage_attributes() const {
@@ -991,6 +1061,7 @@ KuduColumnSchema KuduSchema::Column(size_t idx) const {
 #pragma GCC diagnostic pop
   KuduColumnTypeAttributes type_attrs(col.type_attributes().precision, col.type_attributes().scale,
                                       col.type_attributes().length);
+  type_attrs.data_->element_type = col.type_attributes().element_type;
   return KuduColumnSchema(col.name(), FromInternalDataType(col.type_info()->type()),
                           col.is_nullable(), col.is_immutable(), col.is_auto_incrementing(),
                           col.read_default_value(), attrs, type_attrs, col.comment());
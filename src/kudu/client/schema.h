@@ -137,6 +137,9 @@ class KUDU_EXPORT KuduColumnStorageAttributes {
     RLE = 4,
     DICT_ENCODING = 5,
     BIT_SHUFFLE = 6,
+    FRAME_OF_REFERENCE = 7,
+    ADAPTIVE_ENCODING = 8,
+    XOR_ENCODING = 9,
 
     /// @deprecated GROUP_VARINT is not supported for valid types, and
     /// will fall back to another encoding on the server side.
@@ -150,6 +153,7 @@ class KUDU_EXPORT KuduColumnStorageAttributes {
     SNAPPY = 2,
     LZ4 = 3,
     ZLIB = 4,
+    ZSTD = 5,
   };
 
 
@@ -230,7 +234,9 @@ class KUDU_EXPORT KuduColumnSchema {
     VARCHAR = 11,
     TIMESTAMP = UNIXTIME_MICROS, //!< deprecated, use UNIXTIME_MICROS
     DATE = 12,
-    SERIAL = 13
+    SERIAL = 13,
+    ARRAY = 14,
+    JSON = 15
   };
 
   /// @param [in] type
@@ -312,6 +318,10 @@ class KUDU_EXPORT KuduColumnSchema {
   /// @return Type attributes of the column schema.
   KuduColumnTypeAttributes type_attributes() const;
 
+  /// @return The type of the elements of an ARRAY column. Must not be called
+  ///   for columns of other types.
+  DataType array_element_type() const;
+
   /// @return Storage attributes of the column schema.
   KuduColumnStorageAttributes storage_attributes() const;
 
@@ -475,6 +485,21 @@ class KUDU_EXPORT KuduColumnSpec {
   KuduColumnSpec* Length(uint16_t length);
   ///@}
 
+  /// @name Operation only relevant for ARRAY columns.
+
+  ///@{
+  /// Set the type of the elements of an ARRAY column.
+  ///
+  /// The elements may be of the BOOL, INT8, INT16, INT32, INT64, FLOAT,
+  /// DOUBLE, UNIXTIME_MICROS, DATE, STRING and BINARY types. The element type
+  /// must be provided for ARRAY columns.
+  ///
+  /// @param [in] element_type
+  ///   Desired element type to set.
+  /// @return Pointer to the modified object.
+  KuduColumnSpec* ArrayElementType(KuduColumnSchema::DataType element_type);
+  ///@}
+
   /// @name Operations only relevant for Create Table
 
   ///@{
@@ -37,6 +37,10 @@ namespace kudu {
 
 namespace client {
 
+namespace internal {
+class TableLocationsWatch;
+} // namespace internal
+
 class KuduTable::Data {
  public:
   Data(sp::shared_ptr<KuduClient> client,
@@ -68,6 +72,10 @@ class KuduTable::Data {
 
   sp::shared_ptr<KuduClient> client_;
 
+  // Keeps the locations of the tablets of the table watched, if the client
+  // watches them.
+  std::shared_ptr<internal::TableLocationsWatch> locations_watch_;
+
   const std::string name_;
   const std::string id_;
   const int num_replicas_;
@@ -0,0 +1,192 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/client/table_locations_watcher.h"
+
+#include <functional>
+#include <ostream>
+#include <utility>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/client/client-internal.h"
+#include "kudu/client/client.h"
+#include "kudu/client/meta_cache.h"
+#include "kudu/client/replica_controller-internal.h"
+#include "kudu/common/wire_protocol.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/master/master.proxy.h"
+#include "kudu/rpc/messenger.h"
+#include "kudu/rpc/rpc_header.pb.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/status.h"
+
+DEFINE_bool(client_watch_table_locations, false,
+            "Whether the client watches the locations of the tablets of the "
+            "tables it opens, so that the master pushes the changes of their "
+            "leaders and replicas rather than the client finding out about them "
+            "after RPCs to the tablet servers fail.");
+TAG_FLAG(client_watch_table_locations, experimental);
+
+DEFINE_uint32(client_watch_table_locations_max_wait_ms, 30 * 1000,
+              "Maximum time in milliseconds the master may wait for the locations "
+              "of a table to change before responding to a watch RPC of the client.");
+TAG_FLAG(client_watch_table_locations_max_wait_ms, advanced);
+
+using kudu::master::MasterErrorPB;
+using kudu::rpc::CredentialsPolicy;
+using kudu::rpc::ErrorStatusPB;
+using std::string;
+
+namespace kudu {
+namespace client {
+namespace internal {
+
+// The delay before retrying a failed watch RPC.
+static const MonoDelta kRetryDelay = MonoDelta::FromSeconds(1);
+
+TableLocationsWatcher::TableLocationsWatcher(KuduClient* client, string table_id)
+    : client_(client),
+      table_id_(std::move(table_id)),
+      messenger_(client->data_->messenger_),
+      stopped_(false),
+      rpc_in_flight_(false) {
+  req_.mutable_table()->set_table_id(table_id_);
+  if (client->data_->meta_cache_->replica_visibility() ==
+      ReplicaController::Visibility::ALL) {
+    req_.set_replica_type_filter(master::ANY_REPLICA);
+  }
+}
+
+void TableLocationsWatcher::Start() {
+  SendWatch();
+}
+
+void TableLocationsWatcher::Stop() {
+  std::lock_guard<std::mutex> l(lock_);
+  stopped_ = true;
+  if (rpc_in_flight_) {
+    // Don't wait for the master to respond.
+    controller_.Cancel();
+  }
+}
+
+void TableLocationsWatcher::SendWatch() {
+  std::lock_guard<std::mutex> l(lock_);
+  SendWatchUnlocked();
+}
+
+void TableLocationsWatcher::SendWatchUnlocked() {
+  if (stopped_) {
+    return;
+  }
+  const auto proxy = client_->data_->master_proxy();
+  if (!proxy) {
+    SendWatchLaterUnlocked();
+    return;
+  }
+  MonoDelta timeout = client_->default_rpc_timeout();
+  if (version_) {
+    req_.set_known_version(*version_);
+    req_.set_max_wait_ms(FLAGS_client_watch_table_locations_max_wait_ms);
+    timeout += MonoDelta::FromMilliseconds(FLAGS_client_watch_table_locations_max_wait_ms);
+  }
+  controller_.Reset();
+  controller_.set_timeout(timeout);
+  resp_.Clear();
+  rpc_in_flight_ = true;
+  auto self = shared_from_this();
+  proxy->WatchTableLocationsAsync(req_, &resp_, &controller_,
+                                  [self]() { self->WatchDone(); });
+}
+
+void TableLocationsWatcher::WatchDone() {
+  std::lock_guard<std::mutex> l(lock_);
+  rpc_in_flight_ = false;
+  if (stopped_) {
+    return;
+  }
+  Status s = controller_.status();
+  if (!s.ok()) {
+    const auto* err = controller_.error_response();
+    if (err && err->code() == ErrorStatusPB::ERROR_NO_SUCH_METHOD) {
+      LOG(WARNING) << "master does not support watching table locations: "
+                   << s.ToString();
+      return;
+    }
+    VLOG(1) << "failed to watch the locations of table " << table_id_ << ": " << s.ToString();
+    SendWatchLaterUnlocked();
+    return;
+  }
+  if (resp_.has_error()) {
+    s = StatusFromPB(resp_.error().status());
+    VLOG(1) << "failed to watch the locations of table " << table_id_ << ": " << s.ToString();
+    if (resp_.error().code() == MasterErrorPB::NOT_THE_LEADER ||
+        resp_.error().code() == MasterErrorPB::CATALOG_MANAGER_NOT_INITIALIZED) {
+      // Look for the new leader master before retrying, and start over: the
+      // versions of its locations are unrelated to those of the previous one.
+      version_.reset();
+      client_->data_->ConnectToClusterAsync(
+          client_, MonoTime::Now() + client_->default_admin_operation_timeout(),
+          [](const Status& /* s */) {}, CredentialsPolicy::ANY_CREDENTIALS);
+    }
+    if (resp_.error().code() != MasterErrorPB::TABLE_NOT_FOUND) {
+      SendWatchLaterUnlocked();
+    }
+    return;
+  }
+
+  if (version_) {
+    s = client_->data_->meta_cache_->ProcessWatchTableLocationsResponse(table_id_, resp_);
+    if (!s.ok()) {
+      LOG(WARNING) << "failed to update the locations of table " << table_id_ << ": "
+                   << s.ToString();
+    }
+  }
+  version_ = resp_.version();
+  SendWatchUnlocked();
+}
+
+void TableLocationsWatcher::SendWatchLaterUnlocked() {
+  auto messenger = messenger_.lock();
+  if (!messenger) {
+    return;
+  }
+  auto self = shared_from_this();
+  messenger->ScheduleOnReactor(
+      [self](const Status& s) {
+        if (s.ok()) {
+          self->SendWatch();
+        }
+      },
+      kRetryDelay);
+}
+
+TableLocationsWatch::TableLocationsWatch(std::shared_ptr<TableLocationsWatcher> watcher)
+    : watcher_(std::move(watcher)) {
+  watcher_->Start();
+}
+
+TableLocationsWatch::~TableLocationsWatch() {
+  watcher_->Stop();
+}
+
+} // namespace internal
+} // namespace client
+} // namespace kudu
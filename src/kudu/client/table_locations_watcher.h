@@ -0,0 +1,110 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/master/master.pb.h"
+#include "kudu/rpc/rpc_controller.h"
+
+namespace kudu {
+
+namespace rpc {
+class Messenger;
+} // namespace rpc
+
+namespace client {
+
+class KuduClient;
+
+namespace internal {
+
+// Watches the locations of the tablets of a table with WatchTableLocations
+// RPCs to the leader master, applying the changes the master pushes to the
+// meta cache of the client. This way, the cached locations are updated once
+// leaders change or replicas move, rather than after RPCs to the tablet
+// servers fail.
+//
+// Changes of locations between the time the client first looked them up and
+// the first watch RPC are not pushed: they are handled as without a watcher.
+//
+// This class is thread-safe.
+class TableLocationsWatcher : public std::enable_shared_from_this<TableLocationsWatcher> {
+ public:
+  TableLocationsWatcher(KuduClient* client, std::string table_id);
+
+  // Starts watching the locations.
+  void Start();
+
+  // Stops watching the locations. Once this returns, the watcher no longer
+  // accesses the client, which may then be destroyed.
+  void Stop();
+
+ private:
+  // Sends the next watch RPC, unless stopped.
+  void SendWatch();
+
+  // Same as above, but the caller must hold 'lock_'.
+  void SendWatchUnlocked();
+
+  // Handles the response to the watch RPC.
+  void WatchDone();
+
+  // Sends the next watch RPC after a delay, unless stopped.
+  void SendWatchLaterUnlocked();
+
+  KuduClient* const client_;
+  const std::string table_id_;
+  const std::weak_ptr<rpc::Messenger> messenger_;
+
+  // Protects the fields below, and the accesses to 'client_'.
+  std::mutex lock_;
+  bool stopped_;
+  bool rpc_in_flight_;
+
+  // The version of the locations the client knows about, set once the master
+  // first responded.
+  std::optional<int64_t> version_;
+
+  rpc::RpcController controller_;
+  master::WatchTableLocationsRequestPB req_;
+  master::WatchTableLocationsResponsePB resp_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableLocationsWatcher);
+};
+
+// Keeps the locations of a table watched for as long as it's alive, so that
+// all the KuduTable objects of a table share the same watcher.
+class TableLocationsWatch {
+ public:
+  explicit TableLocationsWatch(std::shared_ptr<TableLocationsWatcher> watcher);
+  ~TableLocationsWatch();
+
+ private:
+  const std::shared_ptr<TableLocationsWatcher> watcher_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableLocationsWatch);
+};
+
+} // namespace internal
+} // namespace client
+} // namespace kudu
@@ -17,12 +17,15 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "kudu/client/client.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/master/master.pb.h"
 
 namespace kudu {
 namespace client {
@@ -35,11 +38,13 @@ class KuduTableStatistics::Data {
   Data(std::optional<int64_t> on_disk_size,
        std::optional<int64_t> live_row_count,
        std::optional<int64_t> on_disk_size_limit,
-       std::optional<int64_t> live_row_count_limit)
+       std::optional<int64_t> live_row_count_limit,
+       std::map<string, master::ColumnStatisticsPB> column_statistics)
       : on_disk_size_(on_disk_size),
         live_row_count_(live_row_count),
         on_disk_size_limit_(on_disk_size_limit),
-        live_row_count_limit_(live_row_count_limit) {
+        live_row_count_limit_(live_row_count_limit),
+        column_statistics_(std::move(column_statistics)) {
   }
 
   ~Data() {
@@ -62,6 +67,9 @@ class KuduTableStatistics::Data {
   const std::optional<int64_t> on_disk_size_limit_;
   const std::optional<int64_t> live_row_count_limit_;
 
+  // The statistics of the columns, by column name.
+  const std::map<string, master::ColumnStatisticsPB> column_statistics_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Data);
 };
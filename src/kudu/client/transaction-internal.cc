@@ -191,7 +191,7 @@ Status KuduTransaction::Data::Commit(CommitMode mode) {
   // In case of 'asynchronous' commit mode, make sure no transactional session
   // contains pending operations.
   for (auto& session : txn_sessions_) {
-    if (mode == CommitMode::WAIT_FOR_COMPLETION) {
+    if (mode != CommitMode::START_ONLY) {
       RETURN_NOT_OK(session->Flush());
     } else {
       if (session->HasPendingOperations()) {
@@ -219,8 +219,10 @@ Status KuduTransaction::Data::Commit(CommitMode mode) {
   if (resp.has_error()) {
     return StatusFromPB(resp.error().status());
   }
-  if (mode == CommitMode::WAIT_FOR_COMPLETION) {
-    RETURN_NOT_OK(WaitForTxnCommitToFinalize(c.get(), deadline, txn_id_));
+  if (mode != CommitMode::START_ONLY) {
+    RETURN_NOT_OK(WaitForTxnCommitToFinalize(
+        c.get(), deadline, txn_id_,
+        /*commit_timestamp_suffices=*/mode == CommitMode::WAIT_FOR_COMMIT_TIMESTAMP));
   }
   return Status::OK();
 }
@@ -329,7 +331,8 @@ Status KuduTransaction::Data::IsCommitCompleteImpl(
     const MonoTime& deadline,
     const TxnId& txn_id,
     bool* is_complete,
-    Status* completion_status) {
+    Status* completion_status,
+    bool commit_timestamp_suffices) {
   DCHECK(client);
   GetTransactionStateResponsePB resp;
   {
@@ -364,6 +367,15 @@ Status KuduTransaction::Data::IsCommitCompleteImpl(
       *completion_status = Status::Aborted("transaction has been aborted");
       break;
     case TxnStatePB::FINALIZE_IN_PROGRESS:
+      // The commit timestamp is durable: the transaction is bound to commit,
+      // even if the participants haven't finalized it yet. The participants
+      // don't let anyone read at or after the commit timestamp until then.
+      if (commit_timestamp_suffices) {
+        *is_complete = true;
+        *completion_status = Status::OK();
+        break;
+      }
+      [[fallthrough]];
     case TxnStatePB::COMMIT_IN_PROGRESS:
       *is_complete = false;
       *completion_status = Status::Incomplete("commit is still in progress");
@@ -397,7 +409,8 @@ Status KuduTransaction::Data::IsCommitCompleteImpl(
 }
 
 Status KuduTransaction::Data::WaitForTxnCommitToFinalize(
-    KuduClient* client, const MonoTime& deadline, const TxnId& txn_id) {
+    KuduClient* client, const MonoTime& deadline, const TxnId& txn_id,
+    bool commit_timestamp_suffices) {
   return RetryFunc(
       deadline,
       "waiting for transaction commit to be completed",
@@ -406,7 +419,7 @@ Status KuduTransaction::Data::WaitForTxnCommitToFinalize(
         bool is_complete = false;
         Status status;
         const auto s = KuduTransaction::Data::IsCommitCompleteImpl(
-            client, deadline, txn_id, &is_complete, &status);
+            client, deadline, txn_id, &is_complete, &status, commit_timestamp_suffices);
         if (!s.ok()) {
           *retry = false;
           return s;
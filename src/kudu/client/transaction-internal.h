@@ -69,6 +69,11 @@ class KuduTransaction::Data {
 
     // Start the commit phase and wait until it succeeds or fails.
     WAIT_FOR_COMPLETION,
+
+    // Start the commit phase and wait until the commit timestamp of the
+    // transaction is durable, leaving the participants to finalize the commit
+    // in the background.
+    WAIT_FOR_COMMIT_TIMESTAMP,
   };
 
   Status Commit(CommitMode mode);
@@ -87,10 +92,15 @@ class KuduTransaction::Data {
       const MonoTime& deadline,
       const TxnId& txn_id,
       bool* is_complete,
-      Status* completion_status);
+      Status* completion_status,
+      bool commit_timestamp_suffices = false);
 
+  // Waits for the commit of the transaction to finalize or, if
+  // 'commit_timestamp_suffices' is true, only for its commit timestamp to be
+  // durable.
   static Status WaitForTxnCommitToFinalize(
-      KuduClient* client, const MonoTime& deadline, const TxnId& txn_id);
+      KuduClient* client, const MonoTime& deadline, const TxnId& txn_id,
+      bool commit_timestamp_suffices = false);
 
   // The self-rescheduling task to send KeepTransactionAlive() RPC periodically
   // for a transaction. The task re-schedules itself as needed.
@@ -23,6 +23,7 @@
 
 #include "kudu/client/value-internal.h"
 #include "kudu/client/value.h"
+#include "kudu/common/array_cell.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
@@ -30,6 +31,7 @@
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/decimal_util.h"
 #include "kudu/util/int128.h"
+#include "kudu/util/json_path.h"
 #include "kudu/util/status.h"
 
 using std::string;
@@ -159,6 +161,18 @@ Status KuduValue::Data::CheckTypeAndGetPointer(const string& col_name,
       RETURN_NOT_OK(CheckAndPointToString(col_name, val_void));
       break;
 
+    case kudu::ARRAY:
+      RETURN_NOT_OK(CheckAndPointToString(col_name, val_void));
+      RETURN_NOT_OK_PREPEND(ValidateArrayCell(slice_val_, type_attributes.element_type),
+                            Substitute("invalid value for column $0", col_name));
+      break;
+
+    case kudu::JSON:
+      RETURN_NOT_OK(CheckAndPointToString(col_name, val_void));
+      RETURN_NOT_OK_PREPEND(ValidateJson(slice_val_),
+                            Substitute("invalid value for column $0", col_name));
+      break;
+
     default:
       return Status::InvalidArgument(Substitute("cannot determine value for column $0 (type $1)",
                                                 col_name, ti->name()));
@@ -78,9 +78,11 @@ class KUDU_EXPORT KuduValue {
 
   ~KuduValue();
  private:
+  friend class ArrayContainsPredicateData;
   friend class ComparisonPredicateData;
   friend class InBloomFilterPredicateData;
   friend class InListPredicateData;
+  friend class KuduArrayCellBuilder;
   friend class KuduColumnSpec;
 
   class KUDU_NO_EXPORT Data;
@@ -31,6 +31,9 @@
 #include <gtest/gtest.h>
 
 #include "kudu/clock/mock_ntp.h"
+#if defined(KUDU_HAS_SYSTEM_TIME_SOURCE)
+#include "kudu/clock/system_ntp.h"
+#endif
 #include "kudu/clock/test/mini_chronyd.h"
 #include "kudu/clock/time_service.h"
 #include "kudu/common/timestamp.h"
@@ -58,6 +61,7 @@
 #include "kudu/util/test_util.h"
 
 DECLARE_bool(inject_unsync_time_errors);
+DECLARE_int32(system_ntp_refresh_interval_ms);
 DECLARE_string(builtin_ntp_servers);
 DECLARE_string(cloud_curl_dns_servers_for_testing);
 DECLARE_string(time_source);
@@ -660,6 +664,39 @@ TEST_F(HybridClockTest, TestNtpDiagnostics) {
 }
 #endif // #if defined(KUDU_HAS_SYSTEM_TIME_SOURCE) ...
 
+#if defined(KUDU_HAS_SYSTEM_TIME_SOURCE)
+// Test that the readings of the 'system' time source in between the refreshes
+// of the NTP state have their error extrapolated from the last refresh.
+TEST_F(ClockTest, SystemNtpCachedReadings) {
+  clock::SystemNtp ntp(metric_entity_);
+  const auto s = ntp.Init();
+  if (!s.ok()) {
+    GTEST_SKIP() << "the system clock isn't synchronized: " << s.ToString();
+  }
+  for (const auto refresh_interval_ms : { 0, 60 * 60 * 1000 }) {
+    SCOPED_TRACE(refresh_interval_ms);
+    FLAGS_system_ntp_refresh_interval_ms = refresh_interval_ms;
+    uint64_t prev_now_usec = 0;
+    uint64_t prev_error_usec = 0;
+    for (int i = 0; i < 1000; i++) {
+      uint64_t now_usec;
+      uint64_t error_usec;
+      ASSERT_OK(ntp.WalltimeWithError(&now_usec, &error_usec));
+      if (i > 0) {
+        // Without refreshes, the extrapolated error only grows. The clock
+        // isn't expected to step back while the test runs.
+        if (refresh_interval_ms > 0) {
+          ASSERT_GE(error_usec, prev_error_usec);
+        }
+        ASSERT_GE(now_usec, prev_now_usec);
+      }
+      prev_now_usec = now_usec;
+      prev_error_usec = error_usec;
+    }
+  }
+}
+#endif // #if defined(KUDU_HAS_SYSTEM_TIME_SOURCE) ...
+
 // The boolean parameter is to specify whether the wall clock protection is
 // enabled or not ('true' -- enabled, 'false' -- disabled).
 class HybridClockJumpProtectionTest : public ClockTest,
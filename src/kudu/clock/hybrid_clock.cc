@@ -290,15 +290,23 @@ Status HybridClock::GetGlobalLatest(Timestamp* t) {
 }
 
 Status HybridClock::NowWithError(Timestamp* timestamp, uint64_t* max_error_usec) {
+  // Read the time source before taking the lock: it's the costly part, and
+  // it's thread-safe.
+  uint64_t now_usec;
+  uint64_t error_usec;
+  RETURN_NOT_OK(WalltimeWithError(&now_usec, &error_usec));
   std::lock_guard<decltype(lock_)> lock(lock_);
-  return NowWithErrorUnlocked(timestamp, max_error_usec);
+  return NowWithErrorUnlocked(now_usec, error_usec, timestamp, max_error_usec);
 }
 
 Status HybridClock::Update(const Timestamp& to_update) {
   Timestamp now;
   uint64_t error_ignored;
+  uint64_t now_usec;
+  uint64_t error_usec;
+  RETURN_NOT_OK(WalltimeWithError(&now_usec, &error_usec));
   std::lock_guard<decltype(lock_)> lock(lock_);
-  RETURN_NOT_OK(NowWithErrorUnlocked(&now, &error_ignored));
+  RETURN_NOT_OK(NowWithErrorUnlocked(now_usec, error_usec, &now, &error_ignored));
 
   // If the incoming message is in the past relative to our current
   // physical clock, there's nothing to do.
@@ -406,15 +414,13 @@ bool HybridClock::IsAfter(Timestamp t) {
   return t.value() < now.value();
 }
 
-Status HybridClock::NowWithErrorUnlocked(Timestamp* timestamp,
+Status HybridClock::NowWithErrorUnlocked(uint64_t now_usec,
+                                         uint64_t error_usec,
+                                         Timestamp* timestamp,
                                          uint64_t* max_error_usec) {
   DCHECK(lock_.is_locked());
   DCHECK_EQ(state_, kInitialized) << "Clock not initialized. Must call Init() first.";
 
-  uint64_t now_usec;
-  uint64_t error_usec;
-  RETURN_NOT_OK(WalltimeWithError(&now_usec, &error_usec));
-
   // If the physical time from the system clock is higher than our last-returned
   // time, we should use the physical timestamp.
   const uint64_t candidate_phys_timestamp = now_usec << kBitsToShift;
@@ -422,6 +428,9 @@ Status HybridClock::NowWithErrorUnlocked(Timestamp* timestamp,
     // If enabled, perform an extra sanity check to make sure wall clock time
     // hasn't jumped too far compared with monotonic clock time.
     if (is_wall_clock_jump_check_enabled_) {
+      // NOTE: the wall clock was read before taking 'lock_', so the
+      // monotonic clock reading lags behind it by the time spent waiting for
+      // the lock, which is negligible compared with the threshold.
       const int64_t now_mono_time_usec = GetMonoTimeMicrosRaw();
       if (PREDICT_TRUE(prev_mono_time_usec_ != 0)) {
         DCHECK_GE(now_mono_time_usec, prev_mono_time_usec_);
@@ -223,8 +223,13 @@ class HybridClock : public Clock {
   // servers for the built-in NTP client is sourced from --builtin_ntp_servers.
   Status InitWithTimeSource(TimeSource time_source);
 
-  // Variant of NowWithError() that requires 'lock_' to be held already.
-  Status NowWithErrorUnlocked(Timestamp* timestamp, uint64_t* max_error_usec);
+  // Variant of NowWithError() that requires 'lock_' to be held already, with
+  // the reading of the time source 'now_usec' and 'error_usec' taken by the
+  // caller, usually before acquiring 'lock_'.
+  Status NowWithErrorUnlocked(uint64_t now_usec,
+                              uint64_t error_usec,
+                              Timestamp* timestamp,
+                              uint64_t* max_error_usec);
 
   // Variant of NowWithError() that calls LOG(FATAL) if the clock is
   // unsynchronized or synchronized but the error is too high.
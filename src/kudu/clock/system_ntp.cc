@@ -20,20 +20,24 @@
 #include <sys/time.h>
 #include <sys/timex.h>
 
+#include <atomic>
 #include <cerrno>
 #include <functional>
 #include <limits>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <vector>
 
-#include <gflags/gflags_declare.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/walltime.h"
 #include "kudu/util/errno.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/jsonwriter.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/metrics.h"
@@ -41,6 +45,18 @@
 #include "kudu/util/status.h"
 #include "kudu/util/subprocess.h"
 
+DEFINE_int32(system_ntp_refresh_interval_ms, 100,
+             "Interval in milliseconds at which the 'system' time source "
+             "refreshes the maximum clock error from the kernel NTP discipline "
+             "with ntp_adjtime(). In between, clock readings come from "
+             "clock_gettime(), which doesn't enter the kernel, their maximum "
+             "error extrapolated from the last refresh with the frequency "
+             "tolerance of the clock. A change of the clock synchronization "
+             "status is noticed up to this long after it happened. "
+             "If 0, every clock reading calls ntp_adjtime().");
+TAG_FLAG(system_ntp_refresh_interval_ms, advanced);
+TAG_FLAG(system_ntp_refresh_interval_ms, runtime);
+
 DECLARE_bool(inject_unsync_time_errors);
 
 using std::string;
@@ -124,6 +140,9 @@ void TryRun(vector<string> cmd, vector<string>* log) {
 
 SystemNtp::SystemNtp(const scoped_refptr<MetricEntity>& metric_entity)
     : skew_ppm_(std::numeric_limits<int64_t>::max()),
+      cache_seq_(0),
+      cache_refresh_mono_usec_(0),
+      cache_refresh_error_usec_(0),
       metric_entity_(metric_entity) {
 }
 
@@ -154,11 +173,19 @@ Status SystemNtp::WalltimeWithError(uint64_t* now_usec, uint64_t* error_usec) {
   if (PREDICT_FALSE(FLAGS_inject_unsync_time_errors)) {
     return NtpStateToStatus(TIME_ERROR);
   }
+  if (PREDICT_TRUE(ReadCachedWalltimeWithError(now_usec, error_usec))) {
+    return Status::OK();
+  }
+  // Read the monotonic clock before the NTP state, so that the error
+  // extrapolated from the state is rather overestimated than underestimated.
+  const int64_t refresh_mono_usec = GetMonoTimeMicros();
+
   // Read the clock and convert its state into status. This will return an error
   // if the clock is not synchronized.
 #ifdef __APPLE__
   ntptimeval t;
-  RETURN_NOT_OK(NtpStateToStatus(ntp_gettime(&t)));
+  const int rc = ntp_gettime(&t);
+  RETURN_NOT_OK(NtpStateToStatus(rc));
   uint64_t now = static_cast<uint64_t>(t.time.tv_sec) * 1000000 +
       t.time.tv_nsec / 1000;
 #else
@@ -175,9 +202,57 @@ Status SystemNtp::WalltimeWithError(uint64_t* now_usec, uint64_t* error_usec) {
 #endif
   *error_usec = t.maxerror;
   *now_usec = now;
+  // Only extrapolate from a regular state: around leap seconds, keep asking
+  // the kernel.
+  if (rc == TIME_OK) {
+    CacheMaxError(refresh_mono_usec, t.maxerror);
+  }
   return Status::OK();
 }
 
+bool SystemNtp::ReadCachedWalltimeWithError(uint64_t* now_usec, uint64_t* error_usec) const {
+  const int64_t refresh_interval_usec =
+      static_cast<int64_t>(FLAGS_system_ntp_refresh_interval_ms) * 1000;
+  if (refresh_interval_usec <= 0) {
+    return false;
+  }
+  // The cached state is consistent if the sequence number is even, i.e. not
+  // being updated, and didn't change while reading the state.
+  const uint64_t seq = cache_seq_.load(std::memory_order_acquire);
+  if (seq == 0 || (seq & 1) != 0) {
+    return false;
+  }
+  const int64_t refresh_mono_usec = cache_refresh_mono_usec_.load(std::memory_order_relaxed);
+  const uint64_t refresh_error_usec = cache_refresh_error_usec_.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (cache_seq_.load(std::memory_order_relaxed) != seq) {
+    return false;
+  }
+  const int64_t elapsed_usec = GetMonoTimeMicros() - refresh_mono_usec;
+  if (elapsed_usec < 0 || elapsed_usec >= refresh_interval_usec) {
+    return false;
+  }
+  *now_usec = GetCurrentTimeMicros();
+  // As the kernel does, grow the maximum error with the frequency tolerance
+  // of the clock, rounding up.
+  *error_usec = refresh_error_usec + (elapsed_usec * skew_ppm_ + 999999) / 1000000;
+  return true;
+}
+
+void SystemNtp::CacheMaxError(int64_t refresh_mono_usec, uint64_t error_usec) {
+  // Only one thread needs to refresh the cached state.
+  std::unique_lock<simple_spinlock> l(cache_lock_, std::try_to_lock);
+  if (!l.owns_lock()) {
+    return;
+  }
+  const uint64_t seq = cache_seq_.load(std::memory_order_relaxed);
+  cache_seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  cache_refresh_mono_usec_.store(refresh_mono_usec, std::memory_order_relaxed);
+  cache_refresh_error_usec_.store(error_usec, std::memory_order_relaxed);
+  cache_seq_.store(seq + 2, std::memory_order_release);
+}
+
 void SystemNtp::DumpDiagnostics(vector<string>* log) const {
   LOG_STRING(ERROR, log) << "Dumping NTP diagnostics";
 
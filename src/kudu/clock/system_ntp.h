@@ -16,6 +16,7 @@
 // under the License.
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -23,6 +24,7 @@
 #include "kudu/clock/time_service.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/util/locks.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/status.h"
 
@@ -38,6 +40,11 @@ namespace clock {
 // (implemented, for example, by chronyd, ntpd, etc.) to keep the system clock
 // synchronized with reference NTP time servers.
 //
+// The maximum error reported by the kernel is only refreshed every
+// --system_ntp_refresh_interval_ms: in between, the time is read with
+// clock_gettime() through the vDSO, and the error is extrapolated from the
+// last refresh, without a syscall nor a lock.
+//
 // [1] https://man7.org/linux/man-pages/man3/ntp_adjtime.3.html
 // [2] https://man7.org/linux/man-pages/man3/ntp_gettime.3.html
 class SystemNtp : public TimeService {
@@ -59,10 +66,27 @@ class SystemNtp : public TimeService {
   // invocation of ntp_gettime()/ntp_adjtime() NTP kernel API call.
   static std::string ClockNtpStatusForMetrics();
 
+  // Reads the current time, extrapolating its maximum error from the cached
+  // NTP state. Returns false if there is no cached state recent enough.
+  bool ReadCachedWalltimeWithError(uint64_t* now_usec, uint64_t* error_usec) const;
+
+  // Caches the maximum error 'error_usec' reported by the kernel, as of the
+  // monotonic time 'refresh_mono_usec'.
+  void CacheMaxError(int64_t refresh_mono_usec, uint64_t error_usec);
+
   // The maximum possible clock frequency skew rate reported by the kernel,
   // parts-per-million (PPM).
   int64_t skew_ppm_;
 
+  // The NTP state cached by CacheMaxError(), read with a seqlock: the sequence
+  // number is odd while the state is being updated, and 0 until first cached.
+  std::atomic<uint64_t> cache_seq_;
+  std::atomic<int64_t> cache_refresh_mono_usec_;
+  std::atomic<uint64_t> cache_refresh_error_usec_;
+
+  // Serializes the updates of the cached state.
+  simple_spinlock cache_lock_;
+
   // Metric entity. Used to fetch information on NTP-related metrics upon
   // calling DumpDiagnostics().
   scoped_refptr<MetricEntity> metric_entity_;
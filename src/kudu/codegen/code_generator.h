@@ -18,6 +18,8 @@
 #ifndef KUDU_CODEGEN_CODE_GENERATOR_H
 #define KUDU_CODEGEN_CODE_GENERATOR_H
 
+#include <vector>
+
 #include "kudu/gutil/macros.h"
 #include "kudu/util/status.h"
 
@@ -30,7 +32,10 @@ class Schema;
 
 namespace codegen {
 
+class PersistentCodeCache;
+class PredicateEvaluatorFunctions;
 class RowProjectorFunctions;
+struct PredicateShape;
 
 // CodeGenerator is a top-level class that manages a per-module
 // LLVM context, ExecutionEngine initialization, native target loading,
@@ -67,10 +72,22 @@ class CodeGenerator {
   Status CompileRowProjector(const Schema& base, const Schema& proj,
                              scoped_refptr<RowProjectorFunctions>* out);
 
+  // Attempts to initialize the function evaluating predicates of the given
+  // shapes by compiling it. Writes to 'out' upon success.
+  Status CompilePredicateEvaluator(const std::vector<PredicateShape>& shapes,
+                                   scoped_refptr<PredicateEvaluatorFunctions>* out);
+
+  // Makes the compilations load the code persisted in 'cache' rather than
+  // compile it when possible, and persist the code they compile. Must be
+  // called before any compilation. Requires that 'cache' outlives this object.
+  void set_persistent_cache(PersistentCodeCache* cache) {
+    persistent_cache_ = cache;
+  }
+
  private:
   static void GlobalInit();
 
-  // TODO static ObjectCache shared b/w engines
+  PersistentCodeCache* persistent_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(CodeGenerator);
 };
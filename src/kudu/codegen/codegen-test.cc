@@ -21,6 +21,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 // IWYU pragma: no_include "testing/base/public/gunit.h"
@@ -32,7 +33,9 @@
 
 #include "kudu/codegen/code_generator.h"
 #include "kudu/codegen/compilation_manager.h"
+#include "kudu/codegen/predicate_evaluator.h"
 #include "kudu/codegen/row_projector.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/row.h"
 #include "kudu/common/rowblock.h"
@@ -40,6 +43,9 @@
 #include "kudu/common/schema.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/singleton.h"
+#include "kudu/gutil/strings/util.h"
+#include "kudu/util/env.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/logging_test_util.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/random.h"
@@ -49,12 +55,14 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+using std::pair;
 using std::string;
 using std::unique_ptr;
 using std::vector;
 
 DECLARE_bool(codegen_dump_mc);
 DECLARE_int32(codegen_cache_capacity);
+DECLARE_string(codegen_persistent_cache_dir);
 
 namespace kudu {
 
@@ -116,6 +124,9 @@ class CodegenTest : public KuduTest {
   // of the codegen projection and the non-codegen projection
   template<bool READ>
   void TestProjection(const Schema* proj);
+  // Same as above, for the codegen projection 'with'.
+  template<bool READ>
+  void CheckProjection(CodegenRP* with, const Schema* proj);
   // Generates a new row projector for the given projection schema.
   Status Generate(const Schema* proj, unique_ptr<CodegenRP>* out);
 
@@ -216,6 +227,11 @@ template<bool READ>
 void CodegenTest::TestProjection(const Schema* proj) {
   unique_ptr<CodegenRP> with;
   ASSERT_OK(Generate(proj, &with));
+  CheckProjection<READ>(with.get(), proj);
+}
+
+template<bool READ>
+void CodegenTest::CheckProjection(CodegenRP* with, const Schema* proj) {
   NoCodegenRP without(&base_, proj);
   ASSERT_OK(without.Init());
 
@@ -226,7 +242,7 @@ void CodegenTest::TestProjection(const Schema* proj) {
   RowBlock rb_without(proj, kNumTestRows, &projections_mem_);
 
   projections_mem_.Reset();
-  ProjectTestRows<READ>(with.get(), &rb_with);
+  ProjectTestRows<READ>(with, &rb_with);
   ProjectTestRows<READ>(&without, &rb_without);
   CheckRowBlocksEqual(&rb_with, &rb_without, "Codegen", "Expected");
 }
@@ -391,6 +407,97 @@ TEST_F(CodegenTest, TestDumpMC) {
 #endif  // #if defined(__powerpc__) ... #elif defined(__aarch64__) ... #else ...
 }
 
+// Compares the compiled evaluation of conjunctions of predicates with their
+// evaluation one by one.
+TEST_F(CodegenTest, TestPredicateEvaluation) {
+  const Schema schema({ ColumnSchema("a", INT32, /*is_nullable=*/true),
+                        ColumnSchema("b", UINT64),
+                        ColumnSchema("c", INT8) }, 0);
+  constexpr int kNumRows = 1000;
+  RowBlockMemory mem;
+  RowBlock block(&schema, kNumRows, &mem);
+  Random rng(SeedRandom());
+  for (int i = 0; i < kNumRows; i++) {
+    RowBlockRow row = block.row(i);
+    const bool a_null = rng.OneIn(5);
+    row.cell(0).set_null(a_null);
+    if (!a_null) {
+      *reinterpret_cast<int32_t*>(row.mutable_cell_ptr(0)) =
+          static_cast<int32_t>(rng.Uniform(20)) - 10;
+    }
+    *reinterpret_cast<uint64_t*>(row.mutable_cell_ptr(1)) = rng.Uniform(20);
+    *reinterpret_cast<int8_t*>(row.mutable_cell_ptr(2)) =
+        static_cast<int8_t>(rng.Uniform(10)) - 5;
+  }
+
+  const int32_t a_lower = -5;
+  const int32_t a_upper = 5;
+  const uint64_t b_lower = 10;
+  const int8_t c_value = 2;
+  const int8_t c_upper = 0;
+  const vector<vector<pair<int, ColumnPredicate>>> conjunctions = {
+    { { 0, ColumnPredicate::Range(schema.column(0), &a_lower, &a_upper) },
+      { 2, ColumnPredicate::Equality(schema.column(2), &c_value) } },
+    { { 0, ColumnPredicate::IsNotNull(schema.column(0)) },
+      { 1, ColumnPredicate::Range(schema.column(1), &b_lower, nullptr) } },
+    { { 0, ColumnPredicate::IsNull(schema.column(0)) },
+      { 1, ColumnPredicate::Range(schema.column(1), nullptr, &b_lower) },
+      { 2, ColumnPredicate::Range(schema.column(2), nullptr, &c_upper) } },
+  };
+  codegen::CodeGenerator generator;
+  for (const auto& preds : conjunctions) {
+    for (const auto& col_idx_and_pred : preds) {
+      ASSERT_TRUE(codegen::PredicateEvaluator::CanCompile(col_idx_and_pred.second));
+    }
+    scoped_refptr<codegen::PredicateEvaluatorFunctions> functions;
+    ASSERT_OK(generator.CompilePredicateEvaluator(
+        codegen::PredicateEvaluator::Shapes(preds), &functions));
+    codegen::PredicateEvaluator evaluator(preds, functions);
+
+    // Some rows are already unselected, and must remain so.
+    SelectionVector expected(kNumRows);
+    expected.SetAllTrue();
+    block.selection_vector()->SetAllTrue();
+    for (int i = 0; i < kNumRows; i += 7) {
+      expected.SetRowUnselected(i);
+      block.selection_vector()->SetRowUnselected(i);
+    }
+    for (const auto& col_idx_and_pred : preds) {
+      col_idx_and_pred.second.Evaluate(block.column_block(col_idx_and_pred.first), &expected);
+    }
+    evaluator.Evaluate(&block);
+    ASSERT_GT(expected.CountSelected(), 0);
+    for (int i = 0; i < kNumRows; i++) {
+      ASSERT_EQ(expected.IsRowSelected(i), block.selection_vector()->IsRowSelected(i))
+          << "row " << i << ": " << schema.DebugRow(block.row(i));
+    }
+  }
+
+  // Predicates which only differ by their bounds share their code, unlike
+  // those which differ by type or by the presence of a bound.
+  const int32_t other_lower = 0;
+  faststring key1;
+  faststring key2;
+  ASSERT_OK(codegen::PredicateEvaluatorFunctions::EncodeKey(
+      codegen::PredicateEvaluator::Shapes(conjunctions[0]), &key1));
+  ASSERT_OK(codegen::PredicateEvaluatorFunctions::EncodeKey(
+      codegen::PredicateEvaluator::Shapes({
+          { 0, ColumnPredicate::Range(schema.column(0), &other_lower, &a_upper) },
+          { 2, ColumnPredicate::Equality(schema.column(2), &c_upper) } }), &key2));
+  ASSERT_EQ(key1.ToString(), key2.ToString());
+  key2.clear();
+  ASSERT_OK(codegen::PredicateEvaluatorFunctions::EncodeKey(
+      codegen::PredicateEvaluator::Shapes({
+          { 0, ColumnPredicate::Range(schema.column(0), &other_lower, nullptr) },
+          { 2, ColumnPredicate::Equality(schema.column(2), &c_upper) } }), &key2));
+  ASSERT_NE(key1.ToString(), key2.ToString());
+
+  // Predicates on strings are left to be evaluated one by one.
+  const Slice str("x");
+  ASSERT_FALSE(codegen::PredicateEvaluator::CanCompile(
+      ColumnPredicate::Equality(ColumnSchema("s", STRING), &str)));
+}
+
 // Basic test for the CompilationManager code cache.
 // This runs a bunch of compilation tasks and ensures that the cache
 // sometimes hits on the second attempt for the same projection.
@@ -433,4 +540,52 @@ TEST_F(CodegenTest, TestCodeCache) {
   }
 }
 
+// The generated code is persisted when --codegen_persistent_cache_dir is
+// set, and the code persisted by a previous compilation manager is in its
+// cache from the start.
+TEST_F(CodegenTest, TestPersistentCodeCache) {
+  const string dir = GetTestPath("code_cache");
+  FLAGS_codegen_persistent_cache_dir = dir;
+  Schema ints;
+  ASSERT_OK(CreatePartialSchema({ kI32Col, kI32NullValCol, kI32NullCol }, &ints));
+  // The code for defaults can't be persisted.
+  Schema with_defaults;
+  ASSERT_OK(CreatePartialSchema({ kKeyCol, kI32RCol }, &with_defaults));
+  const int32_t kValue = 42;
+  const vector<codegen::PredicateEvaluator::ColumnIdxAndPredicate> preds = {
+    { kI32Col, ColumnPredicate::Equality(base_.column(kI32Col), &kValue) } };
+
+  for (int run = 0; run < 2; run++) {
+    SCOPED_TRACE(run);
+    // Start over with a new compilation manager, as a restarted server would.
+    Singleton<CompilationManager>::UnsafeReset();
+    CompilationManager* cm = CompilationManager::GetSingleton();
+    cm->Wait();
+
+    unique_ptr<CodegenRP> projector;
+    unique_ptr<CodegenRP> defaults_projector;
+    unique_ptr<codegen::PredicateEvaluator> evaluator;
+    const bool hit = cm->RequestRowProjector(&base_, &ints, &projector);
+    ASSERT_EQ(run == 1, hit);
+    ASSERT_EQ(run == 1, cm->RequestPredicateEvaluator(preds, &evaluator));
+    ASSERT_FALSE(cm->RequestRowProjector(&base_, &with_defaults, &defaults_projector));
+    cm->Wait();
+    if (!hit) {
+      ASSERT_TRUE(cm->RequestRowProjector(&base_, &ints, &projector));
+    }
+    ASSERT_OK(projector->Init());
+    CheckProjection<true>(projector.get(), &ints);
+    CheckProjection<false>(projector.get(), &ints);
+  }
+
+  vector<string> children;
+  ASSERT_OK(env_->GetChildren(dir, &children));
+  int num_objects = 0;
+  for (const string& child : children) {
+    if (HasSuffixString(child, ".o")) num_objects++;
+  }
+  ASSERT_EQ(2, num_objects);
+  Singleton<CompilationManager>::UnsafeReset();
+}
+
 } // namespace kudu
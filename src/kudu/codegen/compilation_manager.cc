@@ -17,11 +17,15 @@
 
 #include "kudu/codegen/compilation_manager.h"
 
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -29,10 +33,14 @@
 #include "kudu/codegen/code_cache.h"
 #include "kudu/codegen/code_generator.h"
 #include "kudu/codegen/jit_wrapper.h"
+#include "kudu/codegen/persistent_code_cache.h"
+#include "kudu/codegen/predicate_evaluator.h"
 #include "kudu/codegen/row_projector.h"
 #include "kudu/common/schema.h"
 #include "kudu/gutil/casts.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/env.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
@@ -45,7 +53,9 @@
 
 using std::make_shared;
 using std::shared_ptr;
+using std::string;
 using std::unique_ptr;
+using std::vector;
 
 DEFINE_bool(codegen_time_compilation, false, "Whether to print time that each code "
             "generation request took.");
@@ -60,6 +70,17 @@ DEFINE_int32(codegen_queue_capacity, 100, "Number of tasks which may be put in t
              "generation task queue.");
 TAG_FLAG(codegen_queue_capacity, experimental);
 
+DEFINE_string(codegen_persistent_cache_dir, "",
+              "Directory where the object code of the generated functions is persisted, "
+              "so that it's loaded rather than compiled again after a restart. If empty, "
+              "the generated code isn't persisted.");
+TAG_FLAG(codegen_persistent_cache_dir, experimental);
+
+DEFINE_int32(codegen_persistent_cache_capacity, 1000,
+             "Maximum number of generated functions whose object code is persisted in "
+             "--codegen_persistent_cache_dir.");
+TAG_FLAG(codegen_persistent_cache_capacity, experimental);
+
 METRIC_DEFINE_gauge_int64(server, code_cache_hits, "Codegen Cache Hits",
                           kudu::MetricUnit::kCacheHits,
                           "Number of codegen cache hits since start",
@@ -71,59 +92,69 @@ METRIC_DEFINE_gauge_int64(server, code_cache_queries, "Codegen Cache Queries",
                           "since start",
                           kudu::MetricLevel::kDebug,
                           kudu::EXPOSE_AS_COUNTER);
+METRIC_DEFINE_gauge_int64(server, code_cache_queue_length, "Codegen Queue Length",
+                          kudu::MetricUnit::kTasks,
+                          "Number of code generation tasks waiting to be run",
+                          kudu::MetricLevel::kDebug);
+METRIC_DEFINE_gauge_int64(server, code_cache_persistent_loads, "Codegen Persistent Cache Loads",
+                          kudu::MetricUnit::kEntries,
+                          "Number of generated functions whose object code was loaded "
+                          "from the persistent code cache instead of being compiled "
+                          "since start",
+                          kudu::MetricLevel::kDebug,
+                          kudu::EXPOSE_AS_COUNTER);
+
+using strings::Substitute;
+
 namespace kudu {
 namespace codegen {
 
 namespace {
 
-// A CompilationTask is a task which, given a pair of schemas and a cache to
-// refer to, will generate code pertaining to the two schemas and store it in
-// the cache when run.
+// A CompilationTask is a task which, given a cache key and a function
+// generating the code for it, will generate the code and store it in the
+// cache when run.
 class CompilationTask {
  public:
-  // Requires that the cache and generator are valid for the lifetime
-  // of this object.
-  CompilationTask(const Schema& base, const Schema& proj, CodeCache* cache,
-                  CodeGenerator* generator)
-    : base_(base),
-      proj_(proj),
-      cache_(cache),
-      generator_(generator) {}
+  typedef std::function<Status(scoped_refptr<JITWrapper>*)> CompileFunction;
+
+  // Requires that the cache is valid for the lifetime of this object.
+  // 'description' names what's compiled, for logging.
+  CompilationTask(string key, string description, CompileFunction compile,
+                  CodeCache* cache)
+    : key_(std::move(key)),
+      description_(std::move(description)),
+      compile_(std::move(compile)),
+      cache_(cache) {}
 
   // Can only be run once.
   void Run() {
     // We need to fail softly because the user could have just given
-    // a malformed projection schema pair, but could be long gone by
-    // now so there's nowhere to return the status to.
-    WARN_NOT_OK(RunWithStatus(),
-                "Failed compilation of row projector from base schema " +
-                base_.ToString() + " to projection schema " +
-                proj_.ToString());
+    // a malformed request, but could be long gone by now so there's
+    // nowhere to return the status to.
+    WARN_NOT_OK(RunWithStatus(), "Failed compilation of " + description_);
   }
 
  private:
   Status RunWithStatus() {
-    faststring key;
-    RETURN_NOT_OK(RowProjectorFunctions::EncodeKey(base_, proj_, &key));
-
     // Check again to make sure we didn't compile it already.
-    // This can occur if we request the same schema pair while the
+    // This can occur if we request the same code while the
     // first one's compiling.
-    if (cache_->Lookup(key)) return Status::OK();
+    if (cache_->Lookup(key_)) return Status::OK();
 
-    scoped_refptr<RowProjectorFunctions> functions;
-    LOG_TIMING_IF(INFO, FLAGS_codegen_time_compilation, "code-generating row projector") {
-      RETURN_NOT_OK(generator_->CompileRowProjector(base_, proj_, &functions));
+    scoped_refptr<JITWrapper> functions;
+    LOG_TIMING_IF(INFO, FLAGS_codegen_time_compilation, "code-generating " + description_) {
+      RETURN_NOT_OK(compile_(&functions));
     }
 
     RETURN_NOT_OK(cache_->AddEntry(functions));
     return Status::OK();
   }
 
-  Schema base_;
-  Schema proj_;
+  const string key_;
+  const string description_;
+  const CompileFunction compile_;
   CodeCache* const cache_;
-  CodeGenerator* const generator_;
 
   DISALLOW_COPY_AND_ASSIGN(CompilationTask);
 };
@@ -133,7 +164,8 @@ class CompilationTask {
 CompilationManager::CompilationManager()
   : cache_(FLAGS_codegen_cache_capacity),
     hit_counter_(0),
-    query_counter_(0) {
+    query_counter_(0),
+    queue_length_(0) {
   CHECK_OK(ThreadPoolBuilder("compiler_manager_pool")
            .set_min_threads(0)
            .set_max_threads(1)
@@ -147,6 +179,21 @@ CompilationManager::CompilationManager()
   CHECK(std::atexit(&CompilationManager::Shutdown) == 0)
     << "Compilation manager shutdown must be registered successfully with "
     << "std::atexit to be used.";
+
+  if (!FLAGS_codegen_persistent_cache_dir.empty()) {
+    Status s = PersistentCodeCache::Open(Env::Default(), FLAGS_codegen_persistent_cache_dir,
+                                         FLAGS_codegen_persistent_cache_capacity,
+                                         &persistent_cache_);
+    if (s.ok()) {
+      generator_.set_persistent_cache(persistent_cache_.get());
+      WARN_NOT_OK(pool_->Submit([this]() { this->LoadPersistedCode(); }),
+                  "Could not load the persisted code");
+    } else {
+      persistent_cache_.reset();
+      LOG(WARNING) << "Could not open the persistent code cache, generated code won't be "
+                   << "persisted: " << s.ToString();
+    }
+  }
 }
 
 CompilationManager::~CompilationManager() {}
@@ -172,6 +219,14 @@ Status CompilationManager::StartInstrumentation(const scoped_refptr<MetricEntity
   metric_entity->NeverRetire(
       METRIC_code_cache_queries.InstantiateFunctionGauge(
           metric_entity, [this]() { return this->query_counter_.Load(kMemOrderNoBarrier); }));
+  metric_entity->NeverRetire(
+      METRIC_code_cache_queue_length.InstantiateFunctionGauge(
+          metric_entity, [this]() { return this->queue_length_.Load(kMemOrderNoBarrier); }));
+  metric_entity->NeverRetire(
+      METRIC_code_cache_persistent_loads.InstantiateFunctionGauge(
+          metric_entity, [this]() {
+            return this->persistent_cache_ ? this->persistent_cache_->loads() : 0;
+          }));
   return Status::OK();
 }
 
@@ -189,10 +244,19 @@ bool CompilationManager::RequestRowProjector(const Schema* base_schema,
 
   // If not cached, add a request to compilation pool
   if (!cached) {
-    shared_ptr<CompilationTask> task(make_shared<CompilationTask>(
-        *base_schema, *projection, &cache_, &generator_));
-    WARN_NOT_OK_EVERY_N_SECS(pool_->Submit([task]() { task->Run(); }),
-                    "RowProjector compilation request submit failed", 10);
+    Schema base = *base_schema;
+    Schema proj = *projection;
+    CodeGenerator* generator = &generator_;
+    SubmitCompilation(
+        key.ToString(),
+        "row projector from base schema " + base.ToString() +
+        " to projection schema " + proj.ToString(),
+        [base, proj, generator](scoped_refptr<JITWrapper>* out) {
+          scoped_refptr<RowProjectorFunctions> functions;
+          RETURN_NOT_OK(generator->CompileRowProjector(base, proj, &functions));
+          *out = functions.get();
+          return Status::OK();
+        });
     return false;
   }
 
@@ -202,5 +266,114 @@ bool CompilationManager::RequestRowProjector(const Schema* base_schema,
   return true;
 }
 
+bool CompilationManager::RequestPredicateEvaluator(
+    vector<PredicateEvaluator::ColumnIdxAndPredicate> preds,
+    unique_ptr<PredicateEvaluator>* out) {
+  vector<PredicateShape> shapes = PredicateEvaluator::Shapes(preds);
+  faststring key;
+  Status s = PredicateEvaluatorFunctions::EncodeKey(shapes, &key);
+  WARN_NOT_OK(s, "PredicateEvaluator compilation request encode key failed");
+  if (!s.ok()) return false;
+  query_counter_.Increment();
+
+  scoped_refptr<PredicateEvaluatorFunctions> cached(
+    down_cast<PredicateEvaluatorFunctions*>(cache_.Lookup(key).get()));
+
+  // If not cached, add a request to compilation pool
+  if (!cached) {
+    string description = "predicate evaluator for";
+    for (const auto& col_idx_and_pred : preds) {
+      description += " " + col_idx_and_pred.second.ToString();
+    }
+    CodeGenerator* generator = &generator_;
+    SubmitCompilation(
+        key.ToString(), std::move(description),
+        [shapes, generator](scoped_refptr<JITWrapper>* out) {
+          scoped_refptr<PredicateEvaluatorFunctions> functions;
+          RETURN_NOT_OK(generator->CompilePredicateEvaluator(shapes, &functions));
+          *out = functions.get();
+          return Status::OK();
+        });
+    return false;
+  }
+
+  hit_counter_.Increment();
+
+  out->reset(new PredicateEvaluator(std::move(preds), std::move(cached)));
+  return true;
+}
+
+void CompilationManager::SubmitCompilation(
+    string key, string description,
+    std::function<Status(scoped_refptr<JITWrapper>*)> compile) {
+  shared_ptr<CompilationTask> task(make_shared<CompilationTask>(
+      std::move(key), std::move(description), std::move(compile), &cache_));
+  queue_length_.Increment();
+  Status s = pool_->Submit([this, task]() {
+    this->queue_length_.IncrementBy(-1);
+    task->Run();
+  });
+  if (!s.ok()) {
+    queue_length_.IncrementBy(-1);
+    WARN_NOT_OK_EVERY_N_SECS(s, "Compilation request submit failed", 10);
+  }
+}
+
+void CompilationManager::LoadPersistedCode() {
+  vector<string> keys = persistent_cache_->StoredKeys();
+  // Past the capacity of the code cache, the code loaded would only evict
+  // the code loaded before.
+  if (keys.size() > static_cast<size_t>(FLAGS_codegen_cache_capacity)) {
+    keys.resize(FLAGS_codegen_cache_capacity);
+  }
+  int num_loaded = 0;
+  LOG_TIMING_IF(INFO, FLAGS_codegen_time_compilation, "loading persisted code") {
+    for (const string& key : keys) {
+      scoped_refptr<JITWrapper> functions;
+      Status s = LoadFromKey(key, &functions);
+      if (s.ok()) {
+        s = cache_.AddEntry(functions);
+      }
+      if (!s.ok()) {
+        VLOG(1) << "Could not load persisted code: " << s.ToString();
+        continue;
+      }
+      num_loaded++;
+    }
+  }
+  LOG(INFO) << Substitute("Loaded $0 of $1 persisted generated functions into the code cache",
+                          num_loaded, keys.size());
+}
+
+Status CompilationManager::LoadFromKey(const string& key, scoped_refptr<JITWrapper>* out) {
+  JITWrapper::JITWrapperType type;
+  if (key.size() < sizeof(type)) {
+    return Status::Corruption("key too short");
+  }
+  memcpy(&type, key.data(), sizeof(type));
+  // The persistent cache provides the object code when the functions are
+  // compiled again from what the key encodes.
+  switch (type) {
+    case JITWrapper::ROW_PROJECTOR: {
+      Schema base;
+      Schema proj;
+      RETURN_NOT_OK(RowProjectorFunctions::DecodeKey(key, &base, &proj));
+      scoped_refptr<RowProjectorFunctions> functions;
+      RETURN_NOT_OK(generator_.CompileRowProjector(base, proj, &functions));
+      *out = functions.get();
+      return Status::OK();
+    }
+    case JITWrapper::PREDICATE_EVALUATOR: {
+      vector<PredicateShape> shapes;
+      RETURN_NOT_OK(PredicateEvaluatorFunctions::DecodeKey(key, &shapes));
+      scoped_refptr<PredicateEvaluatorFunctions> functions;
+      RETURN_NOT_OK(generator_.CompilePredicateEvaluator(shapes, &functions));
+      *out = functions.get();
+      return Status::OK();
+    }
+  }
+  return Status::Corruption("unknown type of generated code");
+}
+
 } // namespace codegen
 } // namespace kudu
@@ -17,10 +17,14 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "kudu/codegen/code_generator.h"
 #include "kudu/codegen/code_cache.h"
+#include "kudu/codegen/predicate_evaluator.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/singleton.h"
@@ -35,6 +39,8 @@ class ThreadPool;
 
 namespace codegen {
 
+class JITWrapper;
+class PersistentCodeCache;
 class RowProjector;
 
 // The compilation manager is a top-level class which manages the actual
@@ -56,6 +62,11 @@ class RowProjector;
 // unnecessary dependencies on state and lifetime of top-level and
 // intermediary classes which should not be aware of the code generation's
 // use in the first place.
+//
+// If --codegen_persistent_cache_dir is set, the compiled code is also
+// persisted there (see PersistentCodeCache), and the code persisted by a
+// previous run is loaded into the cache at startup, so that a restarted
+// server doesn't fall back to the interpreted paths while it compiles again.
 class CompilationManager {
  public:
   // Waits for all async tasks to finish.
@@ -76,6 +87,16 @@ class CompilationManager {
                            const Schema* projection,
                            std::unique_ptr<RowProjector>* out);
 
+  // If a codegenned evaluator for predicates of the same shapes as 'preds'
+  // (see PredicateShape) is ready, then an evaluator of 'preds' is written
+  // to 'out' and true is returned. Otherwise, this enqueues a compilation
+  // task for the shapes and returns false, like RequestRowProjector().
+  // Requires that PredicateEvaluator::CanCompile() is true for every
+  // predicate.
+  bool RequestPredicateEvaluator(
+      std::vector<PredicateEvaluator::ColumnIdxAndPredicate> preds,
+      std::unique_ptr<PredicateEvaluator>* out);
+
   // Waits for all asynchronous compilation tasks to finish.
   void Wait();
 
@@ -91,12 +112,29 @@ class CompilationManager {
 
   static void Shutdown();
 
+  // Loads the code stored in the persistent cache into the code cache.
+  // Runs in the thread pool.
+  void LoadPersistedCode();
+
+  // Rebuilds the JITWrapper for the cache key 'key' of persisted code,
+  // loading its code from the persistent cache.
+  Status LoadFromKey(const std::string& key, scoped_refptr<JITWrapper>* out);
+
+  // Enqueues the compilation of the code with the given cache key by
+  // 'compile' in the thread pool. 'description' is used for logging.
+  void SubmitCompilation(std::string key, std::string description,
+                         std::function<Status(scoped_refptr<JITWrapper>*)> compile);
+
+  // Declared first, since the generator and the compilation tasks use it.
+  std::unique_ptr<PersistentCodeCache> persistent_cache_;
   CodeGenerator generator_;
   CodeCache cache_;
   std::unique_ptr<ThreadPool> pool_;
 
   AtomicInt<int64_t> hit_counter_;
   AtomicInt<int64_t> query_counter_;
+  // The number of compilation tasks waiting in the pool's queue.
+  AtomicInt<int64_t> queue_length_;
 
   static const int kThreadTimeoutMs = 100;
 
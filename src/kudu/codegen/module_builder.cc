@@ -58,6 +58,7 @@
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 
+#include "kudu/codegen/persistent_code_cache.h"
 #include "kudu/codegen/precompiled.ll.h"
 #include "kudu/gutil/basictypes.h"
 #include "kudu/gutil/map-util.h"
@@ -143,7 +144,9 @@ bool ModuleContains(const Module& m, const Function* fptr) {
 ModuleBuilder::ModuleBuilder()
   : state_(kUninitialized),
     context_(new LLVMContext()),
-    builder_(*context_) {}
+    builder_(*context_),
+    target_(nullptr),
+    persistent_cache_(nullptr) {}
 
 ModuleBuilder::~ModuleBuilder() {}
 
@@ -225,6 +228,12 @@ void ModuleBuilder::AddJITPromise(llvm::Function* llvm_f,
   futures_.push_back(fut);
 }
 
+void ModuleBuilder::SetPersistentCache(PersistentCodeCache* cache, const string& key) {
+  CHECK_EQ(state_, kBuilding);
+  persistent_cache_ = cache;
+  module_->setModuleIdentifier(key);
+}
+
 namespace {
 
 void DoOptimizations(Module* module,
@@ -345,10 +354,19 @@ Status ModuleBuilder::Compile(unique_ptr<ExecutionEngine>* out) {
   }
   module->setDataLayout(target_->createDataLayout());
 
-  DoOptimizations(module, GetFunctionNames());
-  SetFunctionAttributes(module);
+  // The IR only needs to be optimized if it's compiled: the engine won't look
+  // at it if the persistent cache provides its object code.
+  const bool cached = persistent_cache_ &&
+      persistent_cache_->Contains(module->getModuleIdentifier());
+  if (!cached) {
+    DoOptimizations(module, GetFunctionNames());
+    SetFunctionAttributes(module);
+  }
+  if (persistent_cache_) {
+    local_engine->setObjectCache(persistent_cache_);
+  }
 
-  // Compile the module
+  // Compile the module, or load its object code from the persistent cache
   local_engine->finalizeObject();
 
   // Satisfy the promises
@@ -44,6 +44,8 @@ class Value;
 namespace kudu {
 namespace codegen {
 
+class PersistentCodeCache;
+
 // A ModuleBuilder provides an interface to generate code for procedures
 // given a CodeGenerator to refer to. Builder can be used to create multiple
 // functions. It is intended to make building functions easier than using
@@ -103,6 +105,13 @@ class ModuleBuilder {
     AddJITPromise(llvm_f, reinterpret_cast<FunctionAddress*>(actual_f));
   }
 
+  // Makes the module compiled for the JITWrapper with cache key 'key', so
+  // that Compile() loads its object code from 'cache' if stored, and stores
+  // it otherwise. Only code whose compilation doesn't depend on this process'
+  // address space may be stored: see PersistentCodeCache.
+  // Requires that 'cache' outlives this ModuleBuilder.
+  void SetPersistentCache(PersistentCodeCache* cache, const std::string& key);
+
   // Compiles all promised functions. Builder may not be used after
   // this method, only destructed. Upon success, releases ownership
   // of the execution engine through the 'out' parameter.
@@ -142,6 +151,7 @@ class ModuleBuilder {
   std::unique_ptr<llvm::Module> module_;
   LLVMBuilder builder_;
   llvm::TargetMachine* target_; // not owned
+  PersistentCodeCache* persistent_cache_; // not owned
 
   DISALLOW_COPY_AND_ASSIGN(ModuleBuilder);
 };
@@ -0,0 +1,264 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/codegen/persistent_code_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+#include <glog/logging.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include "kudu/codegen/precompiled.ll.h"
+#include "kudu/gutil/strings/escaping.h"
+#include "kudu/gutil/strings/join.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/strings/util.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/crc.h"
+#include "kudu/util/env.h"
+#include "kudu/util/env_util.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/hash_util.h"
+#include "kudu/util/logging.h"
+#include "kudu/util/path_util.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/version_info.h"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace codegen {
+
+namespace {
+
+// Starts every stored file. To be bumped whenever the layout of the files
+// changes.
+const char kMagic[] = "kudujit1";
+constexpr size_t kMagicLen = sizeof(kMagic) - 1;
+
+const char kObjectSuffix[] = ".o";
+
+// Identifies the build and the CPU that compiled objects are valid for: the
+// revision of the server, the precompiled functions the generated code calls
+// into, the LLVM version, and the targeted CPU along with its features.
+string Fingerprint() {
+  vector<string> features;
+  llvm::StringMap<bool> cpu_features;
+  llvm::sys::getHostCPUFeatures(cpu_features);
+  for (const auto& entry : cpu_features) {
+    features.emplace_back(Substitute("$0$1", entry.second ? "+" : "-",
+                                     entry.first().data()));
+  }
+  // The iteration order of a StringMap is unspecified.
+  std::sort(features.begin(), features.end());
+  return Substitute("$0;$1;llvm $2;$3;$4",
+                    VersionInfo::GetGitHash(),
+                    HashUtil::FastHash64(precompiled_ll_data, precompiled_ll_len, 0),
+                    LLVM_VERSION_STRING,
+                    llvm::sys::getHostCPUName().str(),
+                    JoinStrings(features, ","));
+}
+
+} // anonymous namespace
+
+PersistentCodeCache::PersistentCodeCache(Env* env, string dir, size_t capacity)
+    : env_(env),
+      dir_(std::move(dir)),
+      capacity_(capacity),
+      fingerprint_(Fingerprint()),
+      loads_(0) {
+}
+
+PersistentCodeCache::~PersistentCodeCache() {}
+
+Status PersistentCodeCache::Open(Env* env, const string& dir, size_t capacity,
+                                 unique_ptr<PersistentCodeCache>* out) {
+  RETURN_NOT_OK_PREPEND(env_util::CreateDirIfMissing(env, dir),
+                        "could not create the persistent code cache directory");
+  unique_ptr<PersistentCodeCache> cache(new PersistentCodeCache(env, dir, capacity));
+  RETURN_NOT_OK(cache->Load());
+  *out = std::move(cache);
+  return Status::OK();
+}
+
+Status PersistentCodeCache::Load() {
+  vector<string> children;
+  RETURN_NOT_OK(env_->GetChildren(dir_, &children));
+  std::sort(children.begin(), children.end());
+  for (const string& child : children) {
+    if (child == "." || child == "..") continue;
+    const string path = JoinPathSegments(dir_, child);
+    string contents;
+    string key;
+    string object;
+    Status s;
+    if (child.find(kTmpInfix) != string::npos) {
+      // Left over by a crash while writing a file.
+      s = Status::Incomplete("partially written file");
+    } else if (!HasSuffixString(child, kObjectSuffix)) {
+      continue;
+    } else if (objects_.size() >= capacity_) {
+      s = Status::ServiceUnavailable("the cache is at capacity");
+    } else {
+      s = ReadFileToString(env_, path, &contents);
+      if (s.ok()) {
+        s = ParseFile(contents, &key, &object);
+      }
+      if (s.ok() && KeyPath(key) != path) {
+        s = Status::Corruption("file name doesn't match the key");
+      }
+    }
+    if (!s.ok()) {
+      // The file is of no use to this server: remove it so that the objects
+      // of past builds don't pile up.
+      VLOG(1) << "Removing " << path << " from the persistent code cache: " << s.ToString();
+      WARN_NOT_OK(env_->DeleteFile(path), "could not remove file from the persistent code cache");
+      continue;
+    }
+    objects_.emplace(std::move(key), std::move(object));
+  }
+  LOG(INFO) << "Loaded " << objects_.size() << " objects from the persistent code cache in "
+            << dir_;
+  return Status::OK();
+}
+
+vector<string> PersistentCodeCache::StoredKeys() const {
+  vector<string> keys;
+  std::lock_guard<simple_spinlock> l(lock_);
+  keys.reserve(objects_.size());
+  for (const auto& entry : objects_) {
+    keys.push_back(entry.first);
+  }
+  return keys;
+}
+
+bool PersistentCodeCache::Contains(const Slice& key) const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return objects_.count(key.ToString()) > 0;
+}
+
+void PersistentCodeCache::notifyObjectCompiled(const llvm::Module* module,
+                                               llvm::MemoryBufferRef obj) {
+  const string& key = module->getModuleIdentifier();
+  if (key.empty()) return;
+  string object(obj.getBufferStart(), obj.getBufferSize());
+  bool full;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    full = objects_.size() >= capacity_;
+    if (!full && !objects_.emplace(key, object).second) return;
+  }
+  if (full) {
+    KLOG_EVERY_N_SECS(INFO, 60) << "Not storing compiled code: the persistent code "
+                                << "cache is at capacity (" << capacity_ << " objects)";
+    return;
+  }
+  WARN_NOT_OK(WriteFile(key, object), "could not store compiled code");
+}
+
+unique_ptr<llvm::MemoryBuffer> PersistentCodeCache::getObject(const llvm::Module* module) {
+  const string& key = module->getModuleIdentifier();
+  if (key.empty()) return nullptr;
+  string object;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    auto it = objects_.find(key);
+    if (it == objects_.end()) return nullptr;
+    object = it->second;
+  }
+  loads_.Increment();
+  return llvm::MemoryBuffer::getMemBufferCopy(object, KeyPath(key));
+}
+
+// A stored file is laid out as follows:
+//
+//   the magic string
+//   (fixed32) the CRC32C checksum of the rest of the file
+//   (varint32) length of the fingerprint, followed by the fingerprint
+//   (varint32) length of the key, followed by the key
+//   the object code, until the end of the file
+Status PersistentCodeCache::ParseFile(const Slice& contents, string* key,
+                                      string* object) const {
+  Slice data = contents;
+  if (data.size() < kMagicLen + sizeof(uint32_t) ||
+      memcmp(data.data(), kMagic, kMagicLen) != 0) {
+    return Status::Corruption("bad magic");
+  }
+  data.remove_prefix(kMagicLen);
+  const uint32_t crc = DecodeFixed32(data.data());
+  data.remove_prefix(sizeof(uint32_t));
+  if (crc::Crc32c(data.data(), data.size()) != crc) {
+    return Status::Corruption("checksum mismatch");
+  }
+  Slice fingerprint;
+  Slice key_slice;
+  if (!GetLengthPrefixedSlice(&data, &fingerprint) ||
+      !GetLengthPrefixedSlice(&data, &key_slice)) {
+    return Status::Corruption("truncated header");
+  }
+  if (fingerprint != Slice(fingerprint_)) {
+    return Status::NotSupported("compiled by another build or for another CPU",
+                                fingerprint.ToString());
+  }
+  *key = key_slice.ToString();
+  *object = data.ToString();
+  return Status::OK();
+}
+
+Status PersistentCodeCache::WriteFile(const string& key, const string& object) const {
+  faststring body;
+  PutLengthPrefixedSlice(&body, Slice(fingerprint_));
+  PutLengthPrefixedSlice(&body, Slice(key));
+  body.append(object);
+
+  faststring contents;
+  contents.append(kMagic, kMagicLen);
+  PutFixed32(&contents, crc::Crc32c(body.data(), body.size()));
+  contents.append(body.data(), body.size());
+
+  // Write a temporary file first, so that a crash can't leave a partially
+  // written file behind under the final name.
+  const string path = KeyPath(key);
+  const string tmp_path = path + kTmpInfix;
+  RETURN_NOT_OK(WriteStringToFileSync(env_, Slice(contents), tmp_path));
+  Status s = env_->RenameFile(tmp_path, path);
+  if (!s.ok()) {
+    WARN_NOT_OK(env_->DeleteFile(tmp_path), "could not remove temporary file");
+  }
+  return s;
+}
+
+string PersistentCodeCache::KeyPath(const string& key) const {
+  const uint64_t hash = HashUtil::FastHash64(key.data(), key.size(), 0);
+  return JoinPathSegments(dir_, Substitute("$0$1", b2a_hex(
+      reinterpret_cast<const char*>(&hash), sizeof(hash)), kObjectSuffix));
+}
+
+} // namespace codegen
+} // namespace kudu
@@ -0,0 +1,122 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <llvm/ExecutionEngine/ObjectCache.h>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/atomic.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/status.h"
+
+namespace llvm {
+class MemoryBuffer;
+class MemoryBufferRef;
+class Module;
+} // namespace llvm
+
+namespace kudu {
+
+class Env;
+class Slice;
+
+namespace codegen {
+
+// Stores the object code of compiled modules on disk, so that a restarted
+// server loads the code it had compiled before instead of compiling it again.
+//
+// This plugs into the MCJIT as its llvm::ObjectCache: modules are identified
+// by the CodeCache key of the JITWrapper they are compiled for (see
+// ModuleBuilder::SetPersistentCache()). The object code of a module is saved
+// once compiled, and handed back to the MCJIT instead of being compiled when a
+// module with the same key is built again.
+//
+// Each object is stored in its own file, along with its key and a fingerprint
+// of the build and the CPU it was compiled by and for. The files written by
+// other builds or for other CPUs are ignored.
+//
+// Only code which doesn't depend on the address space of the process which
+// compiled it (e.g. code which doesn't embed pointers to default values) may
+// be stored.
+//
+// This class is thread-safe.
+class PersistentCodeCache : public llvm::ObjectCache {
+ public:
+  // Opens the cache in 'dir', creating the directory if it doesn't exist,
+  // and loads the objects compiled by this build for this CPU. At most
+  // 'capacity' objects are kept: the objects compiled past that are not
+  // stored.
+  static Status Open(Env* env, const std::string& dir, size_t capacity,
+                     std::unique_ptr<PersistentCodeCache>* out);
+
+  ~PersistentCodeCache() override;
+
+  // Returns the keys of the stored objects.
+  std::vector<std::string> StoredKeys() const;
+
+  // Returns true if an object is stored for the module with the given key.
+  bool Contains(const Slice& key) const;
+
+  // The number of objects handed back to the MCJIT instead of being compiled.
+  int64_t loads() const { return loads_.Load(kMemOrderNoBarrier); }
+
+  // llvm::ObjectCache implementation.
+  void notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef obj) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) override;
+
+ private:
+  PersistentCodeCache(Env* env, std::string dir, size_t capacity);
+
+  // Loads the objects stored in the directory.
+  Status Load();
+
+  // Parses the contents of a stored file into its key and object, returning
+  // an error if it's corrupt or was written by another build or for another
+  // CPU.
+  Status ParseFile(const Slice& contents, std::string* key, std::string* object) const;
+
+  // Writes the file storing 'object' for 'key'.
+  Status WriteFile(const std::string& key, const std::string& object) const;
+
+  // The path of the file storing the object of 'key'.
+  std::string KeyPath(const std::string& key) const;
+
+  Env* const env_;
+  const std::string dir_;
+  const size_t capacity_;
+
+  // Identifies the build and the CPU which the stored objects are valid for.
+  const std::string fingerprint_;
+
+  mutable simple_spinlock lock_;
+  // The stored objects, by key.
+  std::unordered_map<std::string, std::string> objects_;
+
+  AtomicInt<int64_t> loads_;
+
+  DISALLOW_COPY_AND_ASSIGN(PersistentCodeCache);
+};
+
+} // namespace codegen
+} // namespace kudu
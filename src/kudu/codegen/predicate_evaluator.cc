@@ -0,0 +1,453 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/codegen/predicate_evaluator.h"
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <glog/logging.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/IR/Argument.h>
+#include <llvm/IR/Attributes.h>
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Type.h>
+#include <llvm/IR/Value.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "kudu/codegen/module_builder.h"
+#include "kudu/codegen/persistent_code_cache.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/strings/strcat.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+
+namespace llvm {
+class LLVMContext;
+} // namespace llvm
+
+using llvm::Argument;
+using llvm::BasicBlock;
+using llvm::Function;
+using llvm::FunctionType;
+using llvm::LLVMContext;
+using llvm::PHINode;
+using llvm::PointerType;
+using llvm::Type;
+using llvm::Value;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+DECLARE_bool(codegen_dump_functions);
+
+namespace kudu {
+namespace codegen {
+
+namespace {
+
+// Returns the width in bits of the integer physical type 't', or 0 if values
+// of the type can't be compared by the compiled code. Sets 'is_signed'.
+int IntegerWidth(DataType t, bool* is_signed) {
+  *is_signed = true;
+  switch (t) {
+    case UINT8: *is_signed = false; [[fallthrough]];
+    case INT8: return 8;
+    case UINT16: *is_signed = false; [[fallthrough]];
+    case INT16: return 16;
+    case UINT32: *is_signed = false; [[fallthrough]];
+    case INT32: return 32;
+    case UINT64: *is_signed = false; [[fallthrough]];
+    case INT64: return 64;
+    default: return 0;
+  }
+}
+
+// Generates a function of the form:
+// void(i8** col_data, i8** non_null_bitmaps, i8** bounds, i64 nrows, i8* sel)
+// which clears the selection bits of the rows not satisfying all the
+// predicates of the given shapes. See PredicateEvaluatorFunctions::EvalFunction.
+//
+// The loop over the rows is branch-free: the results of the predicates are
+// combined with bitwise ANDs and the selection bitmap is updated with a
+// select, so the cost doesn't depend on the selectivity of the predicates.
+Function* MakeEvaluation(const string& name,
+                         ModuleBuilder* mbuilder,
+                         const vector<PredicateShape>& shapes) {
+  ModuleBuilder::LLVMBuilder* builder = mbuilder->builder();
+  LLVMContext& context = builder->getContext();
+
+  Type* i8_ty = Type::getInt8Ty(context);
+  Type* i64_ty = Type::getInt64Ty(context);
+  Type* i8_ptr_ty = Type::getInt8PtrTy(context);
+  Type* i8_ptr_ptr_ty = PointerType::getUnqual(i8_ptr_ty);
+  vector<Type*> argtypes = { i8_ptr_ptr_ty, i8_ptr_ptr_ty, i8_ptr_ptr_ty, i64_ty, i8_ptr_ty };
+  FunctionType* fty = FunctionType::get(Type::getVoidTy(context), argtypes, false);
+  Function* f = mbuilder->Create(fty, name);
+
+  Function::arg_iterator it = f->arg_begin();
+  Argument* col_data = &*it++;
+  Argument* non_null_bitmaps = &*it++;
+  Argument* bounds = &*it++;
+  Argument* nrows = &*it++;
+  Argument* sel = &*it++;
+  DCHECK(it == f->arg_end());
+  col_data->setName("col_data");
+  non_null_bitmaps->setName("non_null_bitmaps");
+  bounds->setName("bounds");
+  nrows->setName("nrows");
+  sel->setName("sel");
+  // The selection bitmap is the only memory written, and it doesn't alias
+  // the column data.
+  f->addParamAttr(4, llvm::Attribute::NoAlias);
+
+  // In the entry block, load the pointers to the data, bitmaps and bounds of
+  // each predicate.
+  BasicBlock* entry = BasicBlock::Create(context, "entry", f);
+  BasicBlock* loop = BasicBlock::Create(context, "loop", f);
+  BasicBlock* exit = BasicBlock::Create(context, "exit", f);
+  builder->SetInsertPoint(entry);
+
+  struct PredicateValues {
+    Type* cell_ty = nullptr;
+    Value* data = nullptr;
+    Value* non_null_bitmap = nullptr;
+    Value* lower = nullptr;
+    Value* upper = nullptr;
+  };
+  vector<PredicateValues> values(shapes.size());
+  for (size_t p = 0; p < shapes.size(); p++) {
+    const PredicateShape& shape = shapes[p];
+    PredicateValues& v = values[p];
+    if (shape.nullable) {
+      Value* slot = builder->CreateConstInBoundsGEP1_64(i8_ptr_ty, non_null_bitmaps, p);
+      v.non_null_bitmap = builder->CreateLoad(i8_ptr_ty, slot, StrCat("non_null_bitmap", p));
+    }
+    if (shape.predicate_type != PredicateType::Equality &&
+        shape.predicate_type != PredicateType::Range) {
+      continue;
+    }
+    bool is_signed;
+    v.cell_ty = Type::getIntNTy(context, IntegerWidth(shape.physical_type, &is_signed));
+    Type* cell_ptr_ty = PointerType::getUnqual(v.cell_ty);
+    Value* data_slot = builder->CreateConstInBoundsGEP1_64(i8_ptr_ty, col_data, p);
+    v.data = builder->CreateBitCast(builder->CreateLoad(i8_ptr_ty, data_slot), cell_ptr_ty,
+                                    StrCat("data", p));
+    if (shape.has_lower) {
+      Value* slot = builder->CreateConstInBoundsGEP1_64(i8_ptr_ty, bounds, 2 * p);
+      Value* ptr = builder->CreateBitCast(builder->CreateLoad(i8_ptr_ty, slot), cell_ptr_ty);
+      v.lower = builder->CreateLoad(v.cell_ty, ptr, StrCat("lower", p));
+    }
+    if (shape.has_upper) {
+      Value* slot = builder->CreateConstInBoundsGEP1_64(i8_ptr_ty, bounds, 2 * p + 1);
+      Value* ptr = builder->CreateBitCast(builder->CreateLoad(i8_ptr_ty, slot), cell_ptr_ty);
+      v.upper = builder->CreateLoad(v.cell_ty, ptr, StrCat("upper", p));
+    }
+  }
+  builder->CreateCondBr(builder->CreateICmpEQ(nrows, builder->getInt64(0)), exit, loop);
+
+  // The loop over the rows:
+  //
+  // loop:
+  //   %i = phi i64 [ 0, %entry ], [ %next, %loop ]
+  //   %byte_idx = lshr i64 %i, 3
+  //   %bit_idx = and i64 %i, 7
+  //   <for each predicate>
+  //     <if the column is nullable>
+  //       %non_null = <bit %bit_idx of byte %byte_idx of the non-null bitmap>
+  //     <if the predicate compares values>
+  //       %cell = load <type>, <type>* getelementptr (%data, %i)
+  //       %result = and (icmp <op> %cell, %bound)..., %non_null
+  //     %match = and i1 %match, %result
+  //   %sel_byte = load i8, i8* getelementptr (%sel, %byte_idx)
+  //   %cleared = and i8 %sel_byte, ~(1 << %bit_idx)
+  //   store i8 (select i1 %match, %sel_byte, %cleared), getelementptr (%sel, %byte_idx)
+  //   %next = add i64 %i, 1
+  //   br (icmp ult %next, %nrows), %loop, %exit
+  builder->SetInsertPoint(loop);
+  PHINode* i = builder->CreatePHI(i64_ty, 2, "i");
+  i->addIncoming(builder->getInt64(0), entry);
+  Value* byte_idx = builder->CreateLShr(i, 3, "byte_idx");
+  Value* bit_idx = builder->CreateTrunc(builder->CreateAnd(i, 7), i8_ty, "bit_idx");
+  Value* match = builder->getInt1(true);
+  for (size_t p = 0; p < shapes.size(); p++) {
+    const PredicateShape& shape = shapes[p];
+    const PredicateValues& v = values[p];
+    Value* non_null = builder->getInt1(true);
+    if (shape.nullable) {
+      Value* byte = builder->CreateLoad(
+          i8_ty, builder->CreateInBoundsGEP(i8_ty, v.non_null_bitmap, byte_idx));
+      non_null = builder->CreateTrunc(builder->CreateLShr(byte, bit_idx),
+                                      builder->getInt1Ty(), StrCat("non_null", p));
+    }
+    Value* result = nullptr;
+    switch (shape.predicate_type) {
+      case PredicateType::IsNotNull:
+        result = non_null;
+        break;
+      case PredicateType::IsNull:
+        result = builder->CreateNot(non_null);
+        break;
+      case PredicateType::Equality:
+      case PredicateType::Range: {
+        bool is_signed;
+        IntegerWidth(shape.physical_type, &is_signed);
+        Value* cell = builder->CreateLoad(
+            v.cell_ty, builder->CreateInBoundsGEP(v.cell_ty, v.data, i), StrCat("cell", p));
+        result = non_null;
+        if (shape.predicate_type == PredicateType::Equality) {
+          result = builder->CreateAnd(result, builder->CreateICmpEQ(cell, v.lower));
+          break;
+        }
+        if (v.lower) {
+          Value* ge = is_signed ? builder->CreateICmpSGE(cell, v.lower)
+                                : builder->CreateICmpUGE(cell, v.lower);
+          result = builder->CreateAnd(result, ge);
+        }
+        if (v.upper) {
+          Value* lt = is_signed ? builder->CreateICmpSLT(cell, v.upper)
+                                : builder->CreateICmpULT(cell, v.upper);
+          result = builder->CreateAnd(result, lt);
+        }
+        break;
+      }
+      default:
+        LOG(FATAL) << "unsupported predicate type for codegen";
+    }
+    match = builder->CreateAnd(match, result, StrCat("match", p));
+  }
+  Value* sel_ptr = builder->CreateInBoundsGEP(i8_ty, sel, byte_idx);
+  Value* sel_byte = builder->CreateLoad(i8_ty, sel_ptr, "sel_byte");
+  Value* mask = builder->CreateNot(builder->CreateShl(builder->getInt8(1), bit_idx));
+  Value* cleared = builder->CreateAnd(sel_byte, mask, "cleared");
+  builder->CreateStore(builder->CreateSelect(match, sel_byte, cleared), sel_ptr);
+  Value* next = builder->CreateAdd(i, builder->getInt64(1), "next");
+  i->addIncoming(next, loop);
+  builder->CreateCondBr(builder->CreateICmpULT(next, nrows), loop, exit);
+
+  builder->SetInsertPoint(exit);
+  builder->CreateRetVoid();
+
+  if (FLAGS_codegen_dump_functions) {
+    LOG(INFO) << "Dumping predicate evaluation:";
+    f->print(llvm::errs(), nullptr);
+  }
+
+  return f;
+}
+
+// Convenience method which appends to a faststring
+template<typename T>
+void AddNext(faststring* fs, const T& val) {
+  fs->append(&val, sizeof(T));
+}
+
+// Reads a value appended by AddNext() from the start of 'in' and consumes
+// it. Returns false if 'in' is too short.
+template<typename T>
+bool GetNext(Slice* in, T* val) {
+  if (in->size() < sizeof(T)) return false;
+  memcpy(val, in->data(), sizeof(T));
+  in->remove_prefix(sizeof(T));
+  return true;
+}
+
+// Reads a boolean appended by AddNext().
+bool GetNextBool(Slice* in, bool* val) {
+  uint8_t byte;
+  if (!GetNext(in, &byte) || byte > 1) return false;
+  *val = byte;
+  return true;
+}
+
+} // anonymous namespace
+
+PredicateEvaluatorFunctions::PredicateEvaluatorFunctions(vector<PredicateShape> shapes,
+                                                         EvalFunction eval_f,
+                                                         unique_ptr<JITCodeOwner> owner)
+  : JITWrapper(std::move(owner)),
+    shapes_(std::move(shapes)),
+    eval_f_(eval_f) {
+  CHECK(eval_f != nullptr)
+    << "Promise to compile evaluation function not fulfilled by ModuleBuilder";
+}
+
+Status PredicateEvaluatorFunctions::Create(const vector<PredicateShape>& shapes,
+                                           scoped_refptr<PredicateEvaluatorFunctions>* out,
+                                           llvm::TargetMachine** tm,
+                                           PersistentCodeCache* persistent_cache) {
+  if (shapes.empty()) {
+    return Status::InvalidArgument("no predicate to compile");
+  }
+  for (const auto& shape : shapes) {
+    bool is_signed;
+    const bool compares = shape.predicate_type == PredicateType::Equality ||
+                          shape.predicate_type == PredicateType::Range;
+    if ((compares && IntegerWidth(shape.physical_type, &is_signed) == 0) ||
+        (!compares && shape.predicate_type != PredicateType::IsNotNull &&
+         shape.predicate_type != PredicateType::IsNull)) {
+      return Status::NotSupported("predicate can't be compiled");
+    }
+  }
+
+  ModuleBuilder builder;
+  RETURN_NOT_OK(builder.Init());
+  if (persistent_cache) {
+    faststring key;
+    RETURN_NOT_OK(EncodeKey(shapes, &key));
+    builder.SetPersistentCache(persistent_cache, key.ToString());
+  }
+  Function* eval = MakeEvaluation("PredEval", &builder, shapes);
+
+  EvalFunction eval_f;
+  builder.AddJITPromise(eval, &eval_f);
+
+  unique_ptr<JITCodeOwner> owner;
+  RETURN_NOT_OK(builder.Compile(&owner));
+
+  if (tm) {
+    *tm = builder.GetTargetMachine();
+  }
+  out->reset(new PredicateEvaluatorFunctions(shapes, eval_f, std::move(owner)));
+  return Status::OK();
+}
+
+Status PredicateEvaluatorFunctions::EncodeOwnKey(faststring* out) {
+  return EncodeKey(shapes_, out);
+}
+
+// The key of a list of predicate shapes is the following, in sequence:
+//
+// (1 byte) unique type identifier for PredicateEvaluatorFunctions
+// (8 bytes) number, as unsigned long, of predicates
+// (11 bytes each) predicate shapes, in order
+//   4 bytes for the physical type
+//   1 byte for nullability
+//   4 bytes for the predicate type
+//   1 byte for the presence of a lower bound
+//   1 byte for the presence of an upper bound
+Status PredicateEvaluatorFunctions::EncodeKey(const vector<PredicateShape>& shapes,
+                                              faststring* out) {
+  AddNext(out, JITWrapper::PREDICATE_EVALUATOR);
+  AddNext(out, shapes.size());
+  for (const auto& shape : shapes) {
+    AddNext(out, shape.physical_type);
+    AddNext(out, shape.nullable);
+    AddNext(out, shape.predicate_type);
+    AddNext(out, shape.has_lower);
+    AddNext(out, shape.has_upper);
+  }
+  return Status::OK();
+}
+
+Status PredicateEvaluatorFunctions::DecodeKey(const Slice& key, vector<PredicateShape>* shapes) {
+  const Status bad_key = Status::Corruption("bad predicate evaluator key");
+  Slice in = key;
+  JITWrapper::JITWrapperType type;
+  size_t num_shapes;
+  if (!GetNext(&in, &type) || type != JITWrapper::PREDICATE_EVALUATOR ||
+      !GetNext(&in, &num_shapes)) {
+    return bad_key;
+  }
+  shapes->clear();
+  for (size_t i = 0; i < num_shapes; i++) {
+    PredicateShape shape;
+    if (!GetNext(&in, &shape.physical_type) || !DataType_IsValid(shape.physical_type) ||
+        !GetNextBool(&in, &shape.nullable) ||
+        !GetNext(&in, &shape.predicate_type) ||
+        !GetNextBool(&in, &shape.has_lower) ||
+        !GetNextBool(&in, &shape.has_upper)) {
+      return bad_key;
+    }
+    shapes->push_back(shape);
+  }
+  if (!in.empty()) return bad_key;
+  return Status::OK();
+}
+
+bool PredicateEvaluator::CanCompile(const ColumnPredicate& pred) {
+  bool is_signed;
+  switch (pred.predicate_type()) {
+    case PredicateType::Equality:
+    case PredicateType::Range:
+      return IntegerWidth(pred.column().type_info()->physical_type(), &is_signed) != 0;
+    case PredicateType::IsNotNull:
+    case PredicateType::IsNull:
+      return true;
+    default:
+      return false;
+  }
+}
+
+vector<PredicateShape> PredicateEvaluator::Shapes(const vector<ColumnIdxAndPredicate>& preds) {
+  vector<PredicateShape> shapes;
+  shapes.reserve(preds.size());
+  for (const auto& col_idx_and_pred : preds) {
+    const ColumnPredicate& pred = col_idx_and_pred.second;
+    shapes.push_back({ pred.column().type_info()->physical_type(),
+                       pred.column().is_nullable(),
+                       pred.predicate_type(),
+                       pred.raw_lower() != nullptr,
+                       pred.raw_upper() != nullptr });
+  }
+  return shapes;
+}
+
+PredicateEvaluator::PredicateEvaluator(vector<ColumnIdxAndPredicate> preds,
+                                       scoped_refptr<PredicateEvaluatorFunctions> functions)
+  : preds_(std::move(preds)),
+    functions_(std::move(functions)) {
+  bounds_.reserve(2 * preds_.size());
+  for (const auto& col_idx_and_pred : preds_) {
+    const ColumnPredicate& pred = col_idx_and_pred.second;
+    DCHECK(CanCompile(pred));
+    bounds_.push_back(pred.raw_lower());
+    bounds_.push_back(pred.raw_upper());
+  }
+}
+
+void PredicateEvaluator::Evaluate(RowBlock* block) const {
+  if (block->nrows() == 0) {
+    return;
+  }
+  vector<const uint8_t*> col_data;
+  vector<const uint8_t*> non_null_bitmaps;
+  col_data.reserve(preds_.size());
+  non_null_bitmaps.reserve(preds_.size());
+  for (const auto& col_idx_and_pred : preds_) {
+    ColumnBlock cb = block->column_block(col_idx_and_pred.first);
+    DCHECK_EQ(cb.is_nullable(), col_idx_and_pred.second.column().is_nullable());
+    col_data.push_back(cb.data());
+    non_null_bitmaps.push_back(cb.is_nullable() ? cb.non_null_bitmap() : nullptr);
+  }
+  functions_->eval()(col_data.data(), non_null_bitmaps.data(), bounds_.data(),
+                     block->nrows(), block->selection_vector()->mutable_bitmap());
+}
+
+} // namespace codegen
+} // namespace kudu
@@ -0,0 +1,140 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef KUDU_CODEGEN_PREDICATE_EVALUATOR_H
+#define KUDU_CODEGEN_PREDICATE_EVALUATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "kudu/codegen/jit_wrapper.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/status.h"
+
+namespace llvm {
+class TargetMachine;
+} // namespace llvm
+
+namespace kudu {
+
+class RowBlock;
+class Slice;
+class faststring;
+
+namespace codegen {
+
+class PersistentCodeCache;
+
+// What the code of a compiled predicate depends on: the bounds of the
+// predicates are arguments of the compiled function, so that predicates which
+// only differ by their bounds share their code.
+struct PredicateShape {
+  DataType physical_type;
+  bool nullable;
+  PredicateType predicate_type;
+  bool has_lower;
+  bool has_upper;
+};
+
+// The JITWrapper for codegen::PredicateEvaluator functions. Contains the
+// compiled function, which evaluates the conjunction of a list of predicates
+// over the columns of a block in a single pass.
+class PredicateEvaluatorFunctions : public JITWrapper {
+ public:
+  // Compiles the evaluation function for predicates of the given shapes.
+  // Writes the llvm::TargetMachine* used to 'tm' (if not NULL) and the
+  // function to 'out' upon success. If 'persistent_cache' is not NULL, the
+  // code is loaded from it if stored there, and stored there otherwise.
+  static Status Create(const std::vector<PredicateShape>& shapes,
+                       scoped_refptr<PredicateEvaluatorFunctions>* out,
+                       llvm::TargetMachine** tm = nullptr,
+                       PersistentCodeCache* persistent_cache = nullptr);
+
+  // Unselects, in the selection bitmap 'sel', the rows among the first
+  // 'nrows' which don't satisfy all the predicates. The arrays have an entry
+  // per predicate: the cells of its column, the non-null bitmap of its column
+  // (or NULL if not nullable), and its lower and upper bounds (or NULL if
+  // missing) at 2 * i and 2 * i + 1.
+  typedef void(*EvalFunction)(const uint8_t* const* col_data,
+                              const uint8_t* const* non_null_bitmaps,
+                              const void* const* bounds,
+                              uint64_t nrows,
+                              uint8_t* sel);
+  EvalFunction eval() const { return eval_f_; }
+
+  Status EncodeOwnKey(faststring* out) override;
+
+  static Status EncodeKey(const std::vector<PredicateShape>& shapes, faststring* out);
+
+  // Decodes a key written by EncodeKey() back into the shapes it encodes.
+  static Status DecodeKey(const Slice& key, std::vector<PredicateShape>* shapes);
+
+ private:
+  PredicateEvaluatorFunctions(std::vector<PredicateShape> shapes,
+                              EvalFunction eval_f,
+                              std::unique_ptr<JITCodeOwner> owner);
+
+  const std::vector<PredicateShape> shapes_;
+  const EvalFunction eval_f_;
+};
+
+// Evaluates a conjunction of column predicates over row blocks with a
+// compiled kernel, instead of a pass over the block per predicate.
+//
+// Only comparisons of integer columns and null checks are compiled: see
+// CanCompile().
+class PredicateEvaluator {
+ public:
+  // A predicate and the index of its column in the evaluated blocks.
+  typedef std::pair<int, ColumnPredicate> ColumnIdxAndPredicate;
+
+  // Returns whether 'pred' can be part of a compiled evaluator.
+  static bool CanCompile(const ColumnPredicate& pred);
+
+  // Returns the shapes of 'preds' to compile.
+  static std::vector<PredicateShape> Shapes(const std::vector<ColumnIdxAndPredicate>& preds);
+
+  // Requires that 'functions' were compiled for the shapes of 'preds', whose
+  // bounds must outlive this object.
+  PredicateEvaluator(std::vector<ColumnIdxAndPredicate> preds,
+                     scoped_refptr<PredicateEvaluatorFunctions> functions);
+
+  // Unselects the rows of 'block' which don't satisfy all the predicates.
+  void Evaluate(RowBlock* block) const;
+
+  const std::vector<ColumnIdxAndPredicate>& predicates() const { return preds_; }
+
+ private:
+  const std::vector<ColumnIdxAndPredicate> preds_;
+  const scoped_refptr<PredicateEvaluatorFunctions> functions_;
+
+  // The bounds of the predicates, in the order the compiled function takes.
+  std::vector<const void*> bounds_;
+
+  DISALLOW_COPY_AND_ASSIGN(PredicateEvaluator);
+};
+
+} // namespace codegen
+} // namespace kudu
+
+#endif
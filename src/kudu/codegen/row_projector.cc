@@ -18,6 +18,7 @@
 #include "kudu/codegen/row_projector.h"
 
 #include <algorithm>
+#include <cstring>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -39,12 +40,16 @@
 
 #include "kudu/codegen/jit_wrapper.h"
 #include "kudu/codegen/module_builder.h"
+#include "kudu/codegen/persistent_code_cache.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/row.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/strcat.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
 namespace llvm {
@@ -273,7 +278,8 @@ RowProjectorFunctions::RowProjectorFunctions(const Schema& base_schema,
 Status RowProjectorFunctions::Create(const Schema& base_schema,
                                      const Schema& projection,
                                      scoped_refptr<RowProjectorFunctions>* out,
-                                     llvm::TargetMachine** tm) {
+                                     llvm::TargetMachine** tm,
+                                     PersistentCodeCache* persistent_cache) {
   ModuleBuilder builder;
   RETURN_NOT_OK(builder.Init());
 
@@ -282,6 +288,14 @@ Status RowProjectorFunctions::Create(const Schema& base_schema,
   kudu::RowProjector no_codegen(&base_schema, &projection);
   RETURN_NOT_OK(no_codegen.Init());
 
+  // The code filling defaults embeds the addresses of the default values,
+  // which are only valid in this process: it can't be persisted.
+  if (persistent_cache && no_codegen.projection_defaults().empty()) {
+    faststring key;
+    RETURN_NOT_OK(EncodeKey(base_schema, projection, &key));
+    builder.SetPersistentCache(persistent_cache, key.ToString());
+  }
+
   // Build the functions for code gen. No need to mangle for uniqueness;
   // in the rare case we have two projectors in one module, LLVM takes
   // care of uniquifying when making a GlobalValue.
@@ -310,6 +324,28 @@ template<typename T>
 void AddNext(faststring* fs, const T& val) {
   fs->append(&val, sizeof(T));
 }
+
+// Reads a value appended by AddNext() from the start of 'in' and consumes
+// it. Returns false if 'in' is too short.
+template<typename T>
+bool GetNext(Slice* in, T* val) {
+  if (in->size() < sizeof(T)) return false;
+  memcpy(val, in->data(), sizeof(T));
+  in->remove_prefix(sizeof(T));
+  return true;
+}
+
+// Reads the type and the nullability of a column appended to 'in' by
+// EncodeKey() below.
+bool GetNextColumn(Slice* in, DataType* type, bool* nullable) {
+  uint8_t nullable_byte;
+  if (!GetNext(in, type) || !GetNext(in, &nullable_byte) ||
+      !DataType_IsValid(*type) || nullable_byte > 1) {
+    return false;
+  }
+  *nullable = nullable_byte;
+  return true;
+}
 } // anonymous namespace
 
 // Allocates space for and generates a key for a pair of schemas. The key
@@ -369,6 +405,62 @@ Status RowProjectorFunctions::EncodeKey(const Schema& base, const Schema& proj,
   return Status::OK();
 }
 
+Status RowProjectorFunctions::DecodeKey(const Slice& key, Schema* base, Schema* proj) {
+  const Status bad_key = Status::Corruption("bad row projector key");
+  Slice in = key;
+  JITWrapper::JITWrapperType type;
+  size_t num_base_cols;
+  if (!GetNext(&in, &type) || type != JITWrapper::ROW_PROJECTOR ||
+      !GetNext(&in, &num_base_cols)) {
+    return bad_key;
+  }
+  // Only the types matter to the code: the columns are given placeholder
+  // names, the names of the base columns they're mapped to in the projection.
+  vector<ColumnSchema> base_cols;
+  for (size_t i = 0; i < num_base_cols; i++) {
+    DataType col_type;
+    bool nullable;
+    if (!GetNextColumn(&in, &col_type, &nullable)) return bad_key;
+    base_cols.emplace_back(strings::Substitute("c$0", i), col_type, nullable);
+  }
+  size_t num_proj_cols;
+  if (!GetNext(&in, &num_proj_cols)) return bad_key;
+  vector<std::pair<DataType, bool>> proj_types;
+  for (size_t i = 0; i < num_proj_cols; i++) {
+    DataType col_type;
+    bool nullable;
+    if (!GetNextColumn(&in, &col_type, &nullable)) return bad_key;
+    proj_types.emplace_back(col_type, nullable);
+  }
+  size_t num_mappings;
+  if (!GetNext(&in, &num_mappings)) return bad_key;
+  vector<std::string> proj_names(num_proj_cols);
+  for (size_t i = 0; i < num_mappings; i++) {
+    kudu::RowProjector::ProjectionIdxMapping map;
+    if (!GetNext(&in, &map) || map.first >= num_proj_cols || map.second >= num_base_cols) {
+      return bad_key;
+    }
+    proj_names[map.first] = base_cols[map.second].name();
+  }
+  if (!in.empty() || num_mappings != num_proj_cols) {
+    // The keys of projections with defaults embed the addresses of the
+    // default values in the process which encoded them.
+    return Status::NotSupported("row projector key with defaults");
+  }
+  vector<ColumnSchema> proj_cols;
+  for (size_t i = 0; i < num_proj_cols; i++) {
+    proj_cols.emplace_back(proj_names[i], proj_types[i].first, proj_types[i].second);
+  }
+  RETURN_NOT_OK(base->Reset(std::move(base_cols), 0));
+  RETURN_NOT_OK(proj->Reset(std::move(proj_cols), 0));
+
+  // Make sure the schemas generate the same code as the ones encoded.
+  faststring encoded;
+  RETURN_NOT_OK(EncodeKey(*base, *proj, &encoded));
+  if (Slice(encoded) != key) return bad_key;
+  return Status::OK();
+}
+
 RowProjector::RowProjector(const Schema* base_schema, const Schema* projection,
                            scoped_refptr<RowProjectorFunctions> functions)
   : projector_(base_schema, projection),
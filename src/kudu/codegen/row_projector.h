@@ -42,10 +42,13 @@ class TargetMachine;
 namespace kudu {
 
 class Arena;
+class Slice;
 class faststring;
 
 namespace codegen {
 
+class PersistentCodeCache;
+
 // The JITWrapper for codegen::RowProjector functions. Contains
 // the compiled functions themselves as well as the schemas used
 // to generate them.
@@ -55,9 +58,12 @@ class RowProjectorFunctions : public JITWrapper {
   // and projection.
   // Writes the llvm::TargetMachine* used to 'tm' (if not NULL)
   // and the functions to 'out' upon success.
+  // If 'persistent_cache' is not NULL, the code is loaded from it if stored
+  // there, and stored there otherwise, unless the projection has defaults.
   static Status Create(const Schema& base_schema, const Schema& projection,
                        scoped_refptr<RowProjectorFunctions>* out,
-                       llvm::TargetMachine** tm = NULL);
+                       llvm::TargetMachine** tm = NULL,
+                       PersistentCodeCache* persistent_cache = NULL);
 
   const Schema& base_schema() { return base_schema_; }
   const Schema& projection() { return projection_; }
@@ -73,6 +79,11 @@ class RowProjectorFunctions : public JITWrapper {
   static Status EncodeKey(const Schema& base, const Schema& proj,
                           faststring* out);
 
+  // Decodes a key written by EncodeKey() into schemas which generate the same
+  // code, e.g. to compile again the code persisted for it. This isn't
+  // supported for projections with defaults.
+  static Status DecodeKey(const Slice& key, Schema* base, Schema* proj);
+
  private:
   RowProjectorFunctions(const Schema& base_schema, const Schema& projection,
                         ProjectionFunction read_f, ProjectionFunction write_f,
@@ -0,0 +1,120 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/common/array_cell.h"
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+
+using std::string;
+
+namespace kudu {
+
+TEST(ArrayCellTest, TestFixedSizeElements) {
+  ArrayCellBuilder builder(INT32);
+  int32_t values[] = { 1, -7, 42 };
+  builder.Append(&values[0]);
+  builder.AppendNull();
+  builder.Append(&values[1]);
+  builder.Append(&values[2]);
+  Slice cell = builder.Finish();
+  ASSERT_OK(ValidateArrayCell(cell, INT32));
+
+  ArrayCellView view;
+  ASSERT_OK(view.Init(cell));
+  ASSERT_EQ(INT32, view.element_type());
+  ASSERT_EQ(4, view.num_elements());
+  ASSERT_FALSE(view.is_null(0));
+  ASSERT_TRUE(view.is_null(1));
+  int32_t value;
+  view.GetElement(3, &value);
+  ASSERT_EQ(42, value);
+
+  ASSERT_TRUE(view.Contains(&values[1]));
+  int32_t absent = 0;
+  ASSERT_FALSE(view.Contains(&absent));
+
+  string str;
+  view.AppendDebugString(&str);
+  ASSERT_EQ("[1, NULL, -7, 42]", str);
+
+  // The element type must match that of the column.
+  Status s = ValidateArrayCell(cell, INT64);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+}
+
+TEST(ArrayCellTest, TestBinaryElements) {
+  ArrayCellBuilder builder(STRING);
+  Slice values[] = { "foo", "", "barbaz" };
+  for (const auto& value : values) {
+    builder.Append(&value);
+  }
+  builder.AppendNull();
+  Slice cell = builder.Finish();
+
+  ArrayCellView view;
+  ASSERT_OK(view.Init(cell));
+  ASSERT_EQ(4, view.num_elements());
+  Slice value;
+  view.GetElement(2, &value);
+  ASSERT_EQ("barbaz", value.ToString());
+  ASSERT_TRUE(view.Contains(&values[1]));
+  Slice absent("ba");
+  ASSERT_FALSE(view.Contains(&absent));
+
+  string str;
+  view.AppendDebugString(&str);
+  ASSERT_EQ(R"(["foo", "", "barbaz", NULL])", str);
+
+  // Reusing the builder yields an empty array.
+  builder.Reset();
+  ASSERT_OK(view.Init(builder.Finish()));
+  ASSERT_EQ(0, view.num_elements());
+}
+
+TEST(ArrayCellTest, TestCorruptCells) {
+  ArrayCellBuilder builder(BINARY);
+  Slice values[] = { "a", "bcd" };
+  for (const auto& value : values) {
+    builder.Append(&value);
+  }
+  const string cell = builder.Finish().ToString();
+
+  ArrayCellView view;
+  // Truncated cells.
+  for (size_t size = 0; size < cell.size(); size++) {
+    Status s = view.Init(Slice(cell.data(), size));
+    ASSERT_TRUE(s.IsCorruption()) << size << ": " << s.ToString();
+  }
+  // Trailing garbage.
+  Status s = view.Init(cell + "x");
+  ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+
+  // An unsupported element type.
+  string bad_type = cell;
+  bad_type[0] = static_cast<char>(DECIMAL128);
+  s = view.Init(bad_type);
+  ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+}
+
+} // namespace kudu
@@ -0,0 +1,254 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/common/array_cell.h"
+
+#include <cstring>
+
+#include <glog/logging.h>
+
+#include "kudu/common/types.h"
+#include "kudu/gutil/endian.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/bitmap.h"
+
+using std::string;
+using strings::Substitute;
+
+namespace kudu {
+
+namespace {
+
+// The size of the element type and of the number of elements at the start of
+// every cell.
+constexpr size_t kHeaderSize = 1 + sizeof(uint32_t);
+
+} // anonymous namespace
+
+bool IsArrayElementTypeSupported(DataType type) {
+  switch (type) {
+    case BOOL:
+    case INT8:
+    case INT16:
+    case INT32:
+    case INT64:
+    case FLOAT:
+    case DOUBLE:
+    case UNIXTIME_MICROS:
+    case DATE:
+    case STRING:
+    case BINARY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ArrayCellBuilder::ArrayCellBuilder(DataType element_type)
+    : type_info_(GetTypeInfo(element_type)),
+      is_binary_(type_info_->physical_type() == BINARY) {
+  DCHECK(IsArrayElementTypeSupported(element_type)) << DataType_Name(element_type);
+  Reset();
+}
+
+void ArrayCellBuilder::Append(const void* value) {
+  if (num_elements_ % 8 == 0) {
+    non_null_bitmap_.push_back(0);
+  }
+  BitmapSet(non_null_bitmap_.data(), num_elements_);
+  if (is_binary_) {
+    const Slice* s = reinterpret_cast<const Slice*>(value);
+    values_.append(s->data(), s->size());
+    uint8_t offset[sizeof(uint32_t)];
+    LittleEndian::Store32(offset, values_.size());
+    offsets_.append(offset, sizeof(offset));
+  } else {
+    values_.append(value, type_info_->size());
+  }
+  num_elements_++;
+}
+
+void ArrayCellBuilder::AppendNull() {
+  if (num_elements_ % 8 == 0) {
+    non_null_bitmap_.push_back(0);
+  }
+  if (is_binary_) {
+    uint8_t offset[sizeof(uint32_t)];
+    LittleEndian::Store32(offset, values_.size());
+    offsets_.append(offset, sizeof(offset));
+  } else {
+    const size_t size = values_.size();
+    values_.resize(size + type_info_->size());
+    memset(values_.data() + size, 0, type_info_->size());
+  }
+  num_elements_++;
+}
+
+Slice ArrayCellBuilder::Finish() {
+  cell_.clear();
+  cell_.push_back(static_cast<uint8_t>(type_info_->type()));
+  uint8_t num_elements[sizeof(uint32_t)];
+  LittleEndian::Store32(num_elements, num_elements_);
+  cell_.append(num_elements, sizeof(num_elements));
+  cell_.append(non_null_bitmap_.data(), non_null_bitmap_.size());
+  if (is_binary_) {
+    cell_.append(offsets_.data(), offsets_.size());
+  }
+  cell_.append(values_.data(), values_.size());
+  return Slice(cell_);
+}
+
+void ArrayCellBuilder::Reset() {
+  num_elements_ = 0;
+  non_null_bitmap_.clear();
+  values_.clear();
+  offsets_.clear();
+  if (is_binary_) {
+    // The offset of the first element.
+    offsets_.resize(sizeof(uint32_t));
+    LittleEndian::Store32(offsets_.data(), 0);
+  }
+}
+
+ArrayCellView::ArrayCellView()
+    : type_info_(nullptr),
+      is_binary_(false),
+      element_size_(0),
+      num_elements_(0),
+      non_null_bitmap_(nullptr),
+      offsets_(nullptr),
+      values_(nullptr) {
+}
+
+Status ArrayCellView::Init(const Slice& cell) {
+  if (PREDICT_FALSE(cell.size() < kHeaderSize)) {
+    return Status::Corruption(Substitute("array cell of $0 bytes is too short", cell.size()));
+  }
+  const DataType element_type = static_cast<DataType>(cell[0]);
+  if (PREDICT_FALSE(!IsArrayElementTypeSupported(element_type))) {
+    return Status::Corruption(Substitute("array cell has bad element type $0",
+                                         static_cast<int>(cell[0])));
+  }
+  type_info_ = GetTypeInfo(element_type);
+  is_binary_ = type_info_->physical_type() == BINARY;
+  element_size_ = is_binary_ ? 0 : type_info_->size();
+  num_elements_ = LittleEndian::Load32(cell.data() + 1);
+
+  const uint64_t bitmap_size = BitmapSize(num_elements_);
+  const uint64_t offsets_size =
+      is_binary_ ? (static_cast<uint64_t>(num_elements_) + 1) * sizeof(uint32_t) : 0;
+  const uint64_t values_offset = kHeaderSize + bitmap_size + offsets_size;
+  if (PREDICT_FALSE(values_offset > cell.size())) {
+    return Status::Corruption(Substitute("array cell of $0 bytes is too short for $1 elements",
+                                         cell.size(), num_elements_));
+  }
+  non_null_bitmap_ = cell.data() + kHeaderSize;
+  offsets_ = is_binary_ ? non_null_bitmap_ + bitmap_size : nullptr;
+  values_ = cell.data() + values_offset;
+
+  const uint64_t values_size = cell.size() - values_offset;
+  if (is_binary_) {
+    uint32_t prev_offset = 0;
+    for (uint32_t i = 0; i <= num_elements_; i++) {
+      const uint32_t offset = LittleEndian::Load32(offsets_ + i * sizeof(uint32_t));
+      if (PREDICT_FALSE(offset < prev_offset || offset > values_size ||
+                        (i == 0 && offset != 0))) {
+        return Status::Corruption(Substitute("array cell has bad offset $0 for element $1",
+                                             offset, i));
+      }
+      prev_offset = offset;
+    }
+    if (PREDICT_FALSE(prev_offset != values_size)) {
+      return Status::Corruption(Substitute("array cell has $0 bytes of data, expected $1",
+                                           values_size, prev_offset));
+    }
+  } else if (PREDICT_FALSE(values_size != static_cast<uint64_t>(num_elements_) * element_size_)) {
+    return Status::Corruption(Substitute("array cell has $0 bytes of values for $1 elements",
+                                         values_size, num_elements_));
+  }
+  return Status::OK();
+}
+
+DataType ArrayCellView::element_type() const {
+  return type_info_->type();
+}
+
+bool ArrayCellView::is_null(uint32_t idx) const {
+  DCHECK_LT(idx, num_elements_);
+  return !BitmapTest(non_null_bitmap_, idx);
+}
+
+Slice ArrayCellView::binary_element(uint32_t idx) const {
+  const uint32_t begin = LittleEndian::Load32(offsets_ + idx * sizeof(uint32_t));
+  const uint32_t end = LittleEndian::Load32(offsets_ + (idx + 1) * sizeof(uint32_t));
+  return Slice(values_ + begin, end - begin);
+}
+
+void ArrayCellView::GetElement(uint32_t idx, void* dst) const {
+  DCHECK(!is_null(idx));
+  if (is_binary_) {
+    *reinterpret_cast<Slice*>(dst) = binary_element(idx);
+  } else {
+    memcpy(dst, fixed_element(idx), element_size_);
+  }
+}
+
+bool ArrayCellView::Contains(const void* value) const {
+  for (uint32_t i = 0; i < num_elements_; i++) {
+    if (is_null(i)) {
+      continue;
+    }
+    if (is_binary_) {
+      const Slice element = binary_element(i);
+      if (type_info_->Compare(&element, value) == 0) {
+        return true;
+      }
+    } else if (type_info_->Compare(fixed_element(i), value) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ArrayCellView::AppendDebugString(string* str) const {
+  str->push_back('[');
+  for (uint32_t i = 0; i < num_elements_; i++) {
+    if (i > 0) {
+      str->append(", ");
+    }
+    if (is_null(i)) {
+      str->append("NULL");
+      continue;
+    }
+    alignas(Slice) uint8_t element[kLargestTypeSize];
+    GetElement(i, element);
+    type_info_->AppendDebugStringForValue(element, str);
+  }
+  str->push_back(']');
+}
+
+Status ValidateArrayCell(const Slice& cell, DataType element_type) {
+  ArrayCellView view;
+  RETURN_NOT_OK(view.Init(cell));
+  if (PREDICT_FALSE(view.element_type() != element_type)) {
+    return Status::InvalidArgument(Substitute("expected an array of $0, got an array of $1",
+                                              GetTypeInfo(element_type)->name(),
+                                              GetTypeInfo(view.element_type())->name()));
+  }
+  return Status::OK();
+}
+
+} // namespace kudu
@@ -0,0 +1,138 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class TypeInfo;
+
+// ARRAY cells are stored as BINARY cells, in the following format:
+//
+//   uint8                element type, a DataType
+//   uint32               number of elements 'n', little-endian
+//   uint8[(n + 7) / 8]   non-null bitmap of the elements: a set bit indicates
+//                        a non-null element
+//   for fixed-size element types:
+//     n values           in their in-memory format, zeroed if null
+//   for STRING and BINARY elements:
+//     uint32[n + 1]      little-endian offsets of the elements in the data
+//                        which follows, the last being the size of the data
+//     data               the values of the elements, one after the other
+//
+// Since the element type is part of the cell, cells can be validated and
+// printed without the schema of their column.
+
+// Returns true if arrays of elements of 'type' are supported.
+bool IsArrayElementTypeSupported(DataType type);
+
+// Builds ARRAY cells.
+class ArrayCellBuilder {
+ public:
+  // 'element_type' must be supported as per IsArrayElementTypeSupported().
+  explicit ArrayCellBuilder(DataType element_type);
+
+  // Appends an element. 'value' points to a value in the in-memory format of
+  // the element type, i.e. a Slice for STRING and BINARY elements.
+  void Append(const void* value);
+
+  // Appends a null element.
+  void AppendNull();
+
+  // Returns the cell of the elements appended since the builder was created
+  // or last reset. The cell remains valid until the builder is modified.
+  Slice Finish();
+
+  // Discards the elements appended so far.
+  void Reset();
+
+  uint32_t num_elements() const { return num_elements_; }
+
+ private:
+  const TypeInfo* const type_info_;
+  const bool is_binary_;
+  uint32_t num_elements_;
+
+  // The non-null bitmap, the values of fixed-size elements and the offsets
+  // and data of STRING and BINARY elements appended so far.
+  faststring non_null_bitmap_;
+  faststring values_;
+  faststring offsets_;
+
+  faststring cell_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArrayCellBuilder);
+};
+
+// A view of an ARRAY cell, which must outlive the view.
+class ArrayCellView {
+ public:
+  ArrayCellView();
+
+  // Parses 'cell', returning Status::Corruption if it isn't a valid ARRAY
+  // cell.
+  Status Init(const Slice& cell);
+
+  DataType element_type() const;
+
+  uint32_t num_elements() const { return num_elements_; }
+
+  bool is_null(uint32_t idx) const;
+
+  // Copies the element at index 'idx', which must not be null, into 'dst',
+  // with room for a value of the element type. STRING and BINARY elements are
+  // returned as a Slice pointing into the cell.
+  void GetElement(uint32_t idx, void* dst) const;
+
+  // Returns true if one of the non-null elements equals 'value', a value of
+  // the element type in its in-memory format.
+  bool Contains(const void* value) const;
+
+  // Appends the elements, e.g. '[1, NULL, 3]', to 'str'.
+  void AppendDebugString(std::string* str) const;
+
+ private:
+  // Returns a pointer to the element at index 'idx' of a fixed-size type.
+  const uint8_t* fixed_element(uint32_t idx) const {
+    return values_ + static_cast<size_t>(idx) * element_size_;
+  }
+
+  // Returns the element at index 'idx' of a STRING or BINARY array.
+  Slice binary_element(uint32_t idx) const;
+
+  const TypeInfo* type_info_;
+  bool is_binary_;
+  size_t element_size_;
+  uint32_t num_elements_;
+  const uint8_t* non_null_bitmap_;
+  const uint8_t* offsets_;
+  const uint8_t* values_;
+};
+
+// Validates that 'cell' is a valid ARRAY cell of elements of 'element_type'.
+Status ValidateArrayCell(const Slice& cell, DataType element_type);
+
+} // namespace kudu
@@ -38,7 +38,8 @@ class ColumnMaterializationContext {
       pred_(pred),
       block_(block),
       sel_(sel),
-      decoder_eval_status_(kNotSet) {
+      decoder_eval_status_(kNotSet),
+      selected_rows_only_(false) {
       if (!pred_ || !sel || !block) {
         decoder_eval_status_ = kDecoderEvalNotSupported;
       }
@@ -79,6 +80,18 @@ class ColumnMaterializationContext {
     return pred_ && pred_->predicate_type() == PredicateType::IsNull;
   }
 
+  // Whether only the values of the rows selected in sel() are needed, so
+  // that the values of the others may be left unset. Only valid without a
+  // predicate, since evaluating it sets the selection.
+  bool selected_rows_only() const {
+    return selected_rows_only_;
+  }
+
+  void SetSelectedRowsOnly() {
+    DCHECK(pred_ == nullptr && sel_ != nullptr);
+    selected_rows_only_ = true;
+  }
+
   // A context should not switch from supporting decoder-level eval to not
   // supporting it, or vice versa.
   //
@@ -139,6 +152,8 @@ class ColumnMaterializationContext {
   SelectionVector* const sel_;
 
   DecoderEvalStatus decoder_eval_status_;
+
+  bool selected_rows_only_;
 };
 
 } // namespace kudu
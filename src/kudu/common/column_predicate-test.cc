@@ -25,12 +25,14 @@
 #include <optional>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/common/array_cell.h"
 #include "kudu/common/columnblock-test-util.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/rowblock.h"
@@ -39,6 +41,7 @@
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/walltime.h"
+#include "kudu/util/bitmap.h"
 #include "kudu/util/block_bloom_filter.h"
 #include "kudu/util/hash.pb.h"
 #include "kudu/util/hash_util.h"
@@ -50,6 +53,7 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+using std::string;
 using std::vector;
 
 namespace kudu {
@@ -1303,6 +1307,64 @@ TEST_F(TestColumnPredicate, TestInList) {
   }
 }
 
+TEST_F(TestColumnPredicate, TestArrayContains) {
+  ColumnSchema column("c", ARRAY, /*is_nullable=*/true,
+                      /*is_immutable=*/false, /*is_auto_incrementing=*/false,
+                      /*read_default=*/nullptr, /*write_default=*/nullptr,
+                      ColumnStorageAttributes(), ColumnTypeAttributes(INT32));
+  int32_t one = 1;
+  int32_t two = 2;
+  int32_t three = 3;
+
+  // Build the arrays [1, 2], [2, NULL, 3], [] and NULL.
+  vector<string> cells;
+  ArrayCellBuilder builder(INT32);
+  builder.Append(&one);
+  builder.Append(&two);
+  cells.emplace_back(builder.Finish().ToString());
+  builder.Reset();
+  builder.Append(&two);
+  builder.AppendNull();
+  builder.Append(&three);
+  cells.emplace_back(builder.Finish().ToString());
+  builder.Reset();
+  cells.emplace_back(builder.Finish().ToString());
+
+  ScopedColumnBlock<ARRAY> block(cells.size() + 1);
+  for (int i = 0; i < cells.size(); i++) {
+    block[i] = Slice(cells[i]);
+    block.SetCellIsNull(i, false);
+  }
+  const auto evaluate = [&] (const ColumnPredicate& pred) {
+    SelectionVector sel(block.nrows());
+    sel.SetAllTrue();
+    pred.Evaluate(block, &sel);
+    return sel.CountSelected();
+  };
+
+  vector<const void*> values = { &two };
+  ColumnPredicate contains_two = ColumnPredicate::ArrayContains(column, &values);
+  ASSERT_EQ(PredicateType::ArrayContains, contains_two.predicate_type());
+  ASSERT_EQ(2, evaluate(contains_two));
+  ASSERT_EQ("c CONTAINS (2)", contains_two.ToString());
+
+  // Merged predicates require the arrays to contain the values of both.
+  values = { &three, &two, &three };
+  ColumnPredicate contains_two_three = ColumnPredicate::ArrayContains(column, &values);
+  ASSERT_EQ(1, evaluate(contains_two_three));
+  values = { &one };
+  ColumnPredicate merged = ColumnPredicate::ArrayContains(column, &values);
+  merged.Merge(contains_two_three);
+  ASSERT_EQ(3, merged.raw_values().size());
+  ASSERT_EQ(0, evaluate(merged));
+
+  merged = contains_two;
+  merged.Merge(ColumnPredicate::IsNotNull(column));
+  ASSERT_EQ(contains_two, merged);
+  merged.Merge(ColumnPredicate::IsNull(column));
+  ASSERT_EQ(PredicateType::None, merged.predicate_type());
+}
+
 // Test that column predicate comparison works correctly: ordered by predicate
 // type first, then size of the column type.
 TEST_F(TestColumnPredicate, TestSelectivity) {
@@ -1552,11 +1614,88 @@ using test_types = ::testing::Types<
   DataTypeTraits<INT16>,
   DataTypeTraits<INT32>,
   DataTypeTraits<INT64>,
+  DataTypeTraits<INT128>,
   DataTypeTraits<FLOAT>,
   DataTypeTraits<DOUBLE>>;
 
 TYPED_TEST_SUITE(RangePredicateBenchmark, test_types);
 
+// Test that evaluating a predicate on a whole block gives the same result as
+// evaluating it cell by cell. This covers both the vectorized and scalar
+// evaluation paths, as well as the transition between them for blocks whose
+// size isn't a multiple of the vector width. With sparse selections, this
+// covers the evaluation of only the selected rows.
+template<class T>
+class EvaluatePredicateTest : public KuduTest {};
+TYPED_TEST_SUITE(EvaluatePredicateTest, test_types);
+
+TYPED_TEST(EvaluatePredicateTest, TestMatchesEvaluateCell) {
+  using cpp_type = typename TypeParam::cpp_type;
+  constexpr auto kColType = TypeParam::physical_type;
+  Random rng(SeedRandom());
+
+  const cpp_type minus_two = -2;
+  const cpp_type minus_one = -1;
+  const cpp_type zero = 0;
+  const cpp_type one = 1;
+  const cpp_type two = 2;
+
+  for (int num_rows : { 7, 64, 100, 1000, 4096 }) {
+    for (bool nullable : { false, true }) {
+      ColumnSchema cs("c", kColType, nullable);
+      vector<const void*> in_list = { &minus_two, &zero, &one };
+      vector<ColumnPredicate> preds = {
+        ColumnPredicate::Equality(cs, &zero),
+        ColumnPredicate::Range(cs, &minus_one, &two),
+        ColumnPredicate::Range(cs, nullptr, &one),
+        ColumnPredicate::Range(cs, &zero, nullptr),
+        ColumnPredicate::InList(cs, &in_list),
+        ColumnPredicate::IsNotNull(cs),
+      };
+
+      ScopedColumnBlock<kColType> b(num_rows);
+      for (int i = 0; i < num_rows; i++) {
+        b[i] = static_cast<cpp_type>(static_cast<int>(rng.Uniform(5)) - 2);
+        if constexpr (std::is_floating_point<cpp_type>::value) {
+          if (rng.OneIn(20)) {
+            b[i] = std::nan("");
+          }
+        }
+        if (nullable) {
+          b.SetCellIsNull(i, rng.OneIn(10));
+        }
+      }
+
+      for (const auto& pred : preds) {
+        for (bool sparse : { false, true }) {
+          SCOPED_TRACE(pred.ToString());
+          SCOPED_TRACE(sparse ? "sparse" : "dense");
+          SelectionVector sel(num_rows);
+          sel.SetAllTrue();
+          // Deselect some rows up front to check that the predicate results are
+          // combined with the existing selection. With a sparse selection, only
+          // a few rows remain selected.
+          for (int i = 0; i < num_rows; i++) {
+            if (sparse ? !rng.OneIn(200) : rng.OneIn(4)) {
+              BitmapClear(sel.mutable_bitmap(), i);
+            }
+          }
+          vector<bool> expected(num_rows);
+          for (int i = 0; i < num_rows; i++) {
+            expected[i] = sel.IsRowSelected(i) &&
+                          !(nullable && b.is_null(i)) &&
+                          pred.EvaluateCell<kColType>(b.cell_ptr(i));
+          }
+          pred.Evaluate(b, &sel);
+          for (int i = 0; i < num_rows; i++) {
+            ASSERT_EQ(expected[i], sel.IsRowSelected(i)) << "row " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
 TYPED_TEST(RangePredicateBenchmark, TestEquals) {
   const typename TypeParam::cpp_type ref_val = 0;
   RangePredicateBenchmark<TypeParam>::DoTest(
@@ -1576,6 +1715,15 @@ TYPED_TEST(RangePredicateBenchmark, TestRange) {
       [&](const ColumnSchema& cs) { return ColumnPredicate::Range(cs, &lower, &upper); });
 }
 
+TYPED_TEST(RangePredicateBenchmark, TestInList) {
+  const typename TypeParam::cpp_type zero = 0;
+  const typename TypeParam::cpp_type two = 2;
+  RangePredicateBenchmark<TypeParam>::DoTest([&](const ColumnSchema& cs) {
+    vector<const void*> values = { &zero, &two };
+    return ColumnPredicate::InList(cs, &values);
+  });
+}
+
 // IS NULL and IS NOT NULL predicates don't look at the data itself, so no need
 // to type-parameterize them.
 class NullPredicateBenchmark : public ColumnPredicateBenchmark<DataTypeTraits<INT32>> {};
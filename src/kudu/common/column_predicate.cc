@@ -17,21 +17,30 @@
 
 #include "kudu/common/column_predicate.h"
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #include <algorithm>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <type_traits>
 
+#include "kudu/common/array_cell.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/key_util.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
+#include "kudu/gutil/bits.h"
+#include "kudu/gutil/cpu.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/alignment.h"
 #include "kudu/util/bitmap.h"
+#include "kudu/util/int128.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/memory/arena.h"
 
@@ -90,22 +99,24 @@ ColumnPredicate ColumnPredicate::InList(ColumnSchema column,
                                         vector<const void*>* values) {
   CHECK(values != nullptr);
 
-  // Sort values and remove duplicates.
-  std::sort(values->begin(), values->end(),
-            [&] (const void* a, const void* b) {
-              return column.type_info()->Compare(a, b) < 0;
-            });
-  values->erase(std::unique(values->begin(), values->end(),
-                            [&] (const void* a, const void* b) {
-                              return column.type_info()->Compare(a, b) == 0;
-                            }),
-                values->end());
-
   ColumnPredicate pred(PredicateType::InList, move(column), values);
+  pred.SortAndDedupValues(pred.column_.type_info());
   pred.Simplify();
   return pred;
 }
 
+ColumnPredicate ColumnPredicate::ArrayContains(ColumnSchema column,
+                                               vector<const void*>* values) {
+  CHECK(values != nullptr);
+  CHECK(!values->empty());
+  CHECK_EQ(ARRAY, column.type_info()->type());
+
+  const TypeInfo* element_type_info = GetTypeInfo(column.type_attributes().element_type);
+  ColumnPredicate pred(PredicateType::ArrayContains, move(column), values);
+  pred.SortAndDedupValues(element_type_info);
+  return pred;
+}
+
 ColumnPredicate ColumnPredicate::InBloomFilter(ColumnSchema column,
                                                std::vector<BlockBloomFilter*> bfs,
                                                const void* lower,
@@ -189,6 +200,18 @@ void ColumnPredicate::SetToNone() {
   upper_ = nullptr;
 }
 
+void ColumnPredicate::SortAndDedupValues(const TypeInfo* type_info) {
+  std::sort(values_.begin(), values_.end(),
+            [&] (const void* a, const void* b) {
+              return type_info->Compare(a, b) < 0;
+            });
+  values_.erase(std::unique(values_.begin(), values_.end(),
+                            [&] (const void* a, const void* b) {
+                              return type_info->Compare(a, b) == 0;
+                            }),
+                values_.end());
+}
+
 // TODO(granthenke): For decimal columns, use column_.type_attributes().precision
 // to calculate the "true" max/min values for improved simplification.
 void ColumnPredicate::Simplify() {
@@ -198,6 +221,7 @@ void ColumnPredicate::Simplify() {
     case PredicateType::Equality:
     case PredicateType::IsNotNull: return;
     case PredicateType::IsNull: return;
+    case PredicateType::ArrayContains: return;
     case PredicateType::Range: {
       DCHECK(lower_ != nullptr || upper_ != nullptr);
       if (lower_ != nullptr && upper_ != nullptr) {
@@ -315,6 +339,10 @@ void ColumnPredicate::Merge(const ColumnPredicate& other) {
       MergeIntoBloomFilter(other);
       return;
     };
+    case PredicateType::ArrayContains: {
+      MergeIntoArrayContains(other);
+      return;
+    };
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -379,6 +407,8 @@ void ColumnPredicate::MergeIntoRange(const ColumnPredicate& other) {
       predicate_type_ = PredicateType::InList;
       Simplify();
       return;
+    case PredicateType::ArrayContains:
+      LOG(FATAL) << "range and array contains predicates on the same column";
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -422,6 +452,8 @@ void ColumnPredicate::MergeIntoEquality(const ColumnPredicate& other) {
       }
       return;
     };
+    case PredicateType::ArrayContains:
+      LOG(FATAL) << "equality and array contains predicates on the same column";
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -572,6 +604,8 @@ void ColumnPredicate::MergeIntoInList(const ColumnPredicate &other) {
       Simplify();
       return;
     };
+    case PredicateType::ArrayContains:
+      LOG(FATAL) << "in-list and array contains predicates on the same column";
   }
   LOG(FATAL) << "unknown predicate type";
 }
@@ -628,10 +662,34 @@ void ColumnPredicate::MergeIntoBloomFilter(const ColumnPredicate &other) {
       bloom_filters_.clear();
       Simplify();
       return;
+    case PredicateType::ArrayContains:
+      LOG(FATAL) << "bloom filter and array contains predicates on the same column";
   }
   LOG(FATAL) << "unknown predicate type";
 }
 
+void ColumnPredicate::MergeIntoArrayContains(const ColumnPredicate& other) {
+  CHECK(predicate_type_ == PredicateType::ArrayContains);
+  DCHECK(!values_.empty());
+
+  switch (other.predicate_type()) {
+    case PredicateType::None:
+    case PredicateType::IsNull:
+      SetToNone();
+      values_.clear();
+      return;
+    case PredicateType::IsNotNull:
+      return;
+    case PredicateType::ArrayContains:
+      // The arrays must contain the values of both predicates.
+      values_.insert(values_.end(), other.values_.begin(), other.values_.end());
+      SortAndDedupValues(GetTypeInfo(column_.type_attributes().element_type));
+      return;
+    default:
+      LOG(FATAL) << "array contains predicates may only be merged with null predicates";
+  }
+}
+
 namespace {
 
 // Optimized predicate evaluation for primitive types.
@@ -647,16 +705,24 @@ namespace {
 // This technique can't safely be applied to cells like BINARY since these
 // consist of pointers, and following a junk pointer might crash the process.
 //
-// Returns the number of elements of 'cb' that were processed. This function
-// only processes multiples of 8, so if cb.nrows() is not a multiple of 8, the
-// last few elements may need to be processed by the caller.
+// Evaluation starts at row 'start_idx', which must be a multiple of 8.
+//
+// Returns the number of elements of 'cb' that were processed, including the
+// first 'start_idx'. This function only processes multiples of 8, so if
+// cb.nrows() is not a multiple of 8, the last few elements may need to be
+// processed by the caller.
 template <DataType PhysicalType, typename P>
 ATTRIBUTE_NOINLINE
-int ApplyPredicatePrimitive(const ColumnBlock& block, uint8_t* __restrict__ sel_bitmap, P p) {
+int ApplyPredicatePrimitive(const ColumnBlock& block,
+                            int start_idx,
+                            uint8_t* __restrict__ sel_bitmap,
+                            P p) {
   using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
-  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
+  DCHECK_EQ(0, start_idx % 8);
+  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data()) + start_idx;
+  const int start_chunk = start_idx / 8;
   const int n_chunks = block.nrows() / 8;
-  for (int i = 0; i < n_chunks; i++) {
+  for (int i = start_chunk; i < n_chunks; i++) {
     uint8_t res_8 = 0;
     for (int j = 0; j < 8; j++) {
       res_8 |= p(data++) << j;
@@ -664,20 +730,409 @@ int ApplyPredicatePrimitive(const ColumnBlock& block, uint8_t* __restrict__ sel_
     sel_bitmap[i] &= res_8;
   }
   if (block.is_nullable()) {
-    for (int i = 0; i < n_chunks; i++) {
+    for (int i = start_chunk; i < n_chunks; i++) {
       sel_bitmap[i] &= block.non_null_bitmap()[i];
     }
   }
-  return n_chunks * 8;
+  return std::max(start_idx, n_chunks * 8);
 }
 
+// The maximum number of values in an IN list which is evaluated by comparing
+// each cell against every value, rather than by binary search.
+constexpr int kMaxVectorizedInListValues = 8;
+
+// The comparison operation to evaluate with ApplyPredicateVectorized().
+enum class VectorizedOp {
+  kLessThan,
+  kGreaterOrEqual,
+  kRange,
+  kEquality,
+  kInList,
+};
+
+// AVX2-optimized predicate evaluation for primitive types.
+//
+// These kernels compare a full vector of cells at a time and write the
+// results directly into the selection vector one 64-bit word at a time. Like
+// ApplyPredicatePrimitive(), they evaluate null and deselected cells as well,
+// relying on the final AND against the non-null bitmap and the existing
+// selection vector to discard those results.
+//
+// The comparisons mirror DataTypeTraits<>::Compare() exactly, including its
+// handling of NaN for floating point types: NaN is never less than anything,
+// and so it compares as equal to every value.
+//
+// These are disabled on GCC4 because it doesn't support per-function
+// enabling of intrinsics.
+#if defined(__x86_64__) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define KUDU_HAVE_AVX2_PREDICATES 1
+
+const bool kHasAvx2 = base::CPU().has_avx2();
 
+// Per-type AVX2 primitives. Only types with a specialization are evaluated
+// with AVX2; the remaining types always use the scalar implementation.
+template <DataType PhysicalType>
+struct Avx2Ops {
+  static constexpr bool kSupported = false;
+};
+
+template <>
+struct Avx2Ops<INT8> {
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 32;
+  using vec = __m256i;
+  __attribute__((target("avx2")))
+  static vec Load(const int8_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  __attribute__((target("avx2")))
+  static vec Set1(int8_t v) { return _mm256_set1_epi8(v); }
+  __attribute__((target("avx2")))
+  static vec Lt(vec a, vec b) { return _mm256_cmpgt_epi8(b, a); }
+  __attribute__((target("avx2")))
+  static vec NotLt(vec a, vec b) {
+    return _mm256_xor_si256(Lt(a, b), _mm256_set1_epi8(-1));
+  }
+  __attribute__((target("avx2")))
+  static vec Eq(vec a, vec b) { return _mm256_cmpeq_epi8(a, b); }
+  __attribute__((target("avx2")))
+  static vec And(vec a, vec b) { return _mm256_and_si256(a, b); }
+  __attribute__((target("avx2")))
+  static vec Or(vec a, vec b) { return _mm256_or_si256(a, b); }
+  __attribute__((target("avx2")))
+  static uint64_t MoveMask(vec v) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+  }
+};
+
+template <>
+struct Avx2Ops<INT16> {
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 16;
+  using vec = __m256i;
+  __attribute__((target("avx2")))
+  static vec Load(const int16_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  __attribute__((target("avx2")))
+  static vec Set1(int16_t v) { return _mm256_set1_epi16(v); }
+  __attribute__((target("avx2")))
+  static vec Lt(vec a, vec b) { return _mm256_cmpgt_epi16(b, a); }
+  __attribute__((target("avx2")))
+  static vec NotLt(vec a, vec b) {
+    return _mm256_xor_si256(Lt(a, b), _mm256_set1_epi16(-1));
+  }
+  __attribute__((target("avx2")))
+  static vec Eq(vec a, vec b) { return _mm256_cmpeq_epi16(a, b); }
+  __attribute__((target("avx2")))
+  static vec And(vec a, vec b) { return _mm256_and_si256(a, b); }
+  __attribute__((target("avx2")))
+  static vec Or(vec a, vec b) { return _mm256_or_si256(a, b); }
+  __attribute__((target("avx2")))
+  static uint64_t MoveMask(vec v) {
+    // Narrow the 16-bit lane masks down to bytes. The pack operates within each
+    // 128-bit half, so the permute is needed to bring the two halves of results
+    // into the low 128 bits in order.
+    __m256i packed = _mm256_packs_epi16(v, _mm256_setzero_si256());
+    packed = _mm256_permute4x64_epi64(packed, 0xD8);
+    return static_cast<uint16_t>(_mm256_movemask_epi8(packed));
+  }
+};
+
+template <>
+struct Avx2Ops<INT32> {
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 8;
+  using vec = __m256i;
+  __attribute__((target("avx2")))
+  static vec Load(const int32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  __attribute__((target("avx2")))
+  static vec Set1(int32_t v) { return _mm256_set1_epi32(v); }
+  __attribute__((target("avx2")))
+  static vec Lt(vec a, vec b) { return _mm256_cmpgt_epi32(b, a); }
+  __attribute__((target("avx2")))
+  static vec NotLt(vec a, vec b) {
+    return _mm256_xor_si256(Lt(a, b), _mm256_set1_epi32(-1));
+  }
+  __attribute__((target("avx2")))
+  static vec Eq(vec a, vec b) { return _mm256_cmpeq_epi32(a, b); }
+  __attribute__((target("avx2")))
+  static vec And(vec a, vec b) { return _mm256_and_si256(a, b); }
+  __attribute__((target("avx2")))
+  static vec Or(vec a, vec b) { return _mm256_or_si256(a, b); }
+  __attribute__((target("avx2")))
+  static uint64_t MoveMask(vec v) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(v));
+  }
+};
+
+template <>
+struct Avx2Ops<INT64> {
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 4;
+  using vec = __m256i;
+  __attribute__((target("avx2")))
+  static vec Load(const int64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  __attribute__((target("avx2")))
+  static vec Set1(int64_t v) { return _mm256_set1_epi64x(v); }
+  __attribute__((target("avx2")))
+  static vec Lt(vec a, vec b) { return _mm256_cmpgt_epi64(b, a); }
+  __attribute__((target("avx2")))
+  static vec NotLt(vec a, vec b) {
+    return _mm256_xor_si256(Lt(a, b), _mm256_set1_epi64x(-1));
+  }
+  __attribute__((target("avx2")))
+  static vec Eq(vec a, vec b) { return _mm256_cmpeq_epi64(a, b); }
+  __attribute__((target("avx2")))
+  static vec And(vec a, vec b) { return _mm256_and_si256(a, b); }
+  __attribute__((target("avx2")))
+  static vec Or(vec a, vec b) { return _mm256_or_si256(a, b); }
+  __attribute__((target("avx2")))
+  static uint64_t MoveMask(vec v) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(v));
+  }
+};
+
+// Each 128-bit lane holds a cell, as its low and high 64-bit halves. The
+// comparisons are done on the halves, and their results combined so that both
+// halves of a lane hold the result for the cell.
+template <>
+struct Avx2Ops<INT128> {
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 2;
+  using vec = __m256i;
+  __attribute__((target("avx2")))
+  static vec Load(const int128_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  __attribute__((target("avx2")))
+  static vec Set1(int128_t v) {
+    const int64_t lo = static_cast<int64_t>(static_cast<uint64_t>(v));
+    const int64_t hi = static_cast<int64_t>(v >> 64);
+    return _mm256_set_epi64x(hi, lo, hi, lo);
+  }
+  __attribute__((target("avx2")))
+  static vec Lt(vec a, vec b) {
+    // The low halves are compared as unsigned integers, by flipping their
+    // sign bits before the signed comparison.
+    const vec flip = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    const vec lt = _mm256_cmpgt_epi64(b, a);
+    const vec lt_unsigned = _mm256_cmpgt_epi64(_mm256_xor_si256(b, flip),
+                                               _mm256_xor_si256(a, flip));
+    const vec eq = _mm256_cmpeq_epi64(a, b);
+    // In the high half of each lane:
+    // hi(a) < hi(b) || (hi(a) == hi(b) && lo(a) < lo(b)).
+    const vec res = _mm256_or_si256(lt, _mm256_and_si256(eq, _mm256_slli_si256(lt_unsigned, 8)));
+    return _mm256_shuffle_epi32(res, 0xEE);
+  }
+  __attribute__((target("avx2")))
+  static vec NotLt(vec a, vec b) {
+    return _mm256_xor_si256(Lt(a, b), _mm256_set1_epi64x(-1));
+  }
+  __attribute__((target("avx2")))
+  static vec Eq(vec a, vec b) {
+    const vec eq = _mm256_cmpeq_epi64(a, b);
+    return _mm256_and_si256(eq, _mm256_shuffle_epi32(eq, 0x4E));
+  }
+  __attribute__((target("avx2")))
+  static vec And(vec a, vec b) { return _mm256_and_si256(a, b); }
+  __attribute__((target("avx2")))
+  static vec Or(vec a, vec b) { return _mm256_or_si256(a, b); }
+  __attribute__((target("avx2")))
+  static uint64_t MoveMask(vec v) {
+    // Both halves of a lane hold the same result: keep one bit per lane.
+    const uint64_t mask = _mm256_movemask_pd(_mm256_castsi256_pd(v));
+    return (mask & 1) | ((mask >> 1) & 2);
+  }
+};
+
+template <>
+struct Avx2Ops<FLOAT> {
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 8;
+  using vec = __m256;
+  __attribute__((target("avx2")))
+  static vec Load(const float* p) { return _mm256_loadu_ps(p); }
+  __attribute__((target("avx2")))
+  static vec Set1(float v) { return _mm256_set1_ps(v); }
+  __attribute__((target("avx2")))
+  static vec Lt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  __attribute__((target("avx2")))
+  static vec NotLt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_NLT_UQ); }
+  __attribute__((target("avx2")))
+  static vec Eq(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_UQ); }
+  __attribute__((target("avx2")))
+  static vec And(vec a, vec b) { return _mm256_and_ps(a, b); }
+  __attribute__((target("avx2")))
+  static vec Or(vec a, vec b) { return _mm256_or_ps(a, b); }
+  __attribute__((target("avx2")))
+  static uint64_t MoveMask(vec v) { return _mm256_movemask_ps(v); }
+};
+
+template <>
+struct Avx2Ops<DOUBLE> {
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 4;
+  using vec = __m256d;
+  __attribute__((target("avx2")))
+  static vec Load(const double* p) { return _mm256_loadu_pd(p); }
+  __attribute__((target("avx2")))
+  static vec Set1(double v) { return _mm256_set1_pd(v); }
+  __attribute__((target("avx2")))
+  static vec Lt(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  __attribute__((target("avx2")))
+  static vec NotLt(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_NLT_UQ); }
+  __attribute__((target("avx2")))
+  static vec Eq(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_EQ_UQ); }
+  __attribute__((target("avx2")))
+  static vec And(vec a, vec b) { return _mm256_and_pd(a, b); }
+  __attribute__((target("avx2")))
+  static vec Or(vec a, vec b) { return _mm256_or_pd(a, b); }
+  __attribute__((target("avx2")))
+  static uint64_t MoveMask(vec v) { return _mm256_movemask_pd(v); }
+};
+
+// Evaluate 'OP' against the cells of 'block' using AVX2 instructions.
+//
+// For kLessThan and kEquality, 'values[0]' is the operand; for kGreaterOrEqual
+// and kRange, 'values[0]' is the lower bound and, for kRange, 'values[1]' is
+// the upper bound. For kInList, 'values' holds 'n_values' values, at most
+// kMaxVectorizedInListValues.
+//
+// Returns the number of rows processed. This is always a multiple of 64: the
+// remaining rows must be processed by the caller.
+template <DataType PhysicalType, VectorizedOp OP>
+__attribute__((target("avx2")))
+ATTRIBUTE_NOINLINE
+int ApplyPredicateAvx2(const ColumnBlock& block,
+                       uint8_t* __restrict__ sel_bitmap,
+                       const typename DataTypeTraits<PhysicalType>::cpp_type* values,
+                       int n_values) {
+  using Ops = Avx2Ops<PhysicalType>;
+  using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
+  using vec = typename Ops::vec;
+  static_assert(64 % Ops::kLanes == 0, "lanes must evenly divide a word");
+  DCHECK_LE(n_values, kMaxVectorizedInListValues);
+
+  vec operands[kMaxVectorizedInListValues];
+  for (int i = 0; i < n_values; i++) {
+    operands[i] = Ops::Set1(values[i]);
+  }
+
+  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
+  const uint8_t* non_null_bitmap = block.is_nullable() ? block.non_null_bitmap() : nullptr;
+  const int n_words = block.nrows() / 64;
+  for (int w = 0; w < n_words; w++) {
+    uint64_t res = 0;
+    for (int i = 0; i < 64; i += Ops::kLanes) {
+      vec cells = Ops::Load(data + i);
+      vec match;
+      if constexpr (OP == VectorizedOp::kLessThan) {
+        match = Ops::Lt(cells, operands[0]);
+      } else if constexpr (OP == VectorizedOp::kGreaterOrEqual) {
+        match = Ops::NotLt(cells, operands[0]);
+      } else if constexpr (OP == VectorizedOp::kRange) {
+        match = Ops::And(Ops::NotLt(cells, operands[0]), Ops::Lt(cells, operands[1]));
+      } else if constexpr (OP == VectorizedOp::kEquality) {
+        match = Ops::Eq(cells, operands[0]);
+      } else {
+        match = Ops::Eq(cells, operands[0]);
+        for (int v = 1; v < n_values; v++) {
+          match = Ops::Or(match, Ops::Eq(cells, operands[v]));
+        }
+      }
+      res |= Ops::MoveMask(match) << i;
+    }
+    data += 64;
+
+    uint8_t* sel_word = sel_bitmap + w * 8;
+    uint64_t sel = UnalignedLoad<uint64_t>(sel_word) & res;
+    if (non_null_bitmap) {
+      sel &= UnalignedLoad<uint64_t>(non_null_bitmap + w * 8);
+    }
+    UnalignedStore<uint64_t>(sel_word, sel);
+  }
+  return n_words * 64;
+}
+#endif // defined(__x86_64__) && ...
+
+// Evaluate 'OP' on as many rows of 'block' as possible using vectorized
+// instructions. See ApplyPredicateAvx2() for the meaning of 'values' and
+// 'n_values'.
+//
+// Returns the number of rows processed. If the CPU or the physical type
+// doesn't support vectorized evaluation, or if the selection is sparse enough
+// for ApplyPredicate() to only evaluate the selected rows, returns 0.
+template <DataType PhysicalType, VectorizedOp OP>
+int ApplyPredicateVectorized(const ColumnBlock& block,
+                             SelectionVector* sel,
+                             const typename DataTypeTraits<PhysicalType>::cpp_type* values,
+                             int n_values = 1) {
+#ifdef KUDU_HAVE_AVX2_PREDICATES
+  if constexpr (Avx2Ops<PhysicalType>::kSupported) {
+    if (kHasAvx2 && !sel->IsSparse()) {
+      return ApplyPredicateAvx2<PhysicalType, OP>(block, sel->mutable_bitmap(), values, n_values);
+    }
+  }
+#endif
+  return 0;
+}
+
+// Evaluate 'p' on the selected rows of 'block' only, visiting the set bits of
+// the selection vector a 64-bit word at a time and clearing those of the rows
+// which don't pass. Unlike the dense evaluation above, the cost is
+// proportional to the number of selected rows, which makes it cheaper for
+// sparse selections: see SelectionVector::IsSparse().
 template <DataType PhysicalType, typename P>
-void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p) {
+void ApplyPredicateSparse(const ColumnBlock& block, SelectionVector* sel, P p) {
   using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
-  int start_idx = 0;
-  if (std::is_fundamental<cpp_type>::value) {
-    start_idx = ApplyPredicatePrimitive<PhysicalType>(block, sel->mutable_bitmap(), p);
+  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
+  uint8_t* sel_bitmap = sel->mutable_bitmap();
+  const size_t n_rows = block.nrows();
+  const auto passes = [&](size_t row) {
+    return !(block.is_nullable() && block.is_null(row)) && p(&data[row]);
+  };
+
+  const size_t n_words = n_rows / 64;
+  for (size_t i = 0; i < n_words; i++) {
+    const uint64_t word = UnalignedLoad<uint64_t>(sel_bitmap + i * 8);
+    uint64_t rejected = 0;
+    for (uint64_t rem = word; rem != 0; rem &= rem - 1) {
+      const int bit = Bits::FindLSBSetNonZero64(rem);
+      if (!passes(i * 64 + bit)) {
+        rejected |= uint64_t{1} << bit;
+      }
+    }
+    if (rejected != 0) {
+      UnalignedStore<uint64_t>(sel_bitmap + i * 8, word & ~rejected);
+    }
+  }
+  for (size_t row = n_words * 64; row < n_rows; row++) {
+    if (BitmapTest(sel_bitmap, row) && !passes(row)) {
+      BitmapClear(sel_bitmap, row);
+    }
+  }
+}
+
+// Evaluate 'p' on the rows of 'block' starting at 'start_idx', which must be
+// a multiple of 8. The rows before 'start_idx' are assumed to have already
+// been evaluated, for example by ApplyPredicateVectorized().
+//
+// If the selection is sparse, only the selected rows are evaluated.
+template <DataType PhysicalType, typename P>
+void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p, int start_idx = 0) {
+  using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
+  if (start_idx == block.nrows()) return;
+  if (start_idx == 0 && sel->IsSparse()) {
+    ApplyPredicateSparse<PhysicalType>(block, sel, p);
+    return;
+  }
+  if (std::is_fundamental<cpp_type>::value || PhysicalType == INT128) {
+    start_idx = ApplyPredicatePrimitive<PhysicalType>(block, start_idx, sel->mutable_bitmap(), p);
     if (PREDICT_TRUE(start_idx == block.nrows())) return;
     // If we couldn't process the whole block unrolled by 8, fall through to the
     // remainder.
@@ -705,9 +1160,18 @@ void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p) {
 
 template<bool IS_NOT_NULL>
 void ApplyNullPredicate(const ColumnBlock& block, uint8_t* __restrict__ sel_vec) {
+  const uint8_t* __restrict__ non_null_bitmap = block.non_null_bitmap();
   int n_bytes = KUDU_ALIGN_UP(block.nrows(), 8) / 8;
-  for (int i = 0; i < n_bytes; i++) {
-    uint8_t non_null_byte = block.non_null_bitmap()[i];
+  // Process whole 64-bit words first, then the trailing bytes.
+  int n_words = n_bytes / 8;
+  for (int i = 0; i < n_words; i++) {
+    uint64_t non_null_word = UnalignedLoad<uint64_t>(non_null_bitmap + i * 8);
+    if (!IS_NOT_NULL) non_null_word = ~non_null_word;
+    UnalignedStore<uint64_t>(sel_vec + i * 8,
+                             UnalignedLoad<uint64_t>(sel_vec + i * 8) & non_null_word);
+  }
+  for (int i = n_words * 8; i < n_bytes; i++) {
+    uint8_t non_null_byte = non_null_bitmap[i];
     if (!IS_NOT_NULL) non_null_byte = ~non_null_byte;
     sel_vec[i] &= non_null_byte;
   }
@@ -726,26 +1190,35 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       cpp_type local_upper = upper_ ? *static_cast<const cpp_type*>(upper_) : cpp_type();
 
       if (lower_ == nullptr) {
+        int start_idx = ApplyPredicateVectorized<PhysicalType, VectorizedOp::kLessThan>(
+            block, sel, &local_upper);
         ApplyPredicate<PhysicalType>(block, sel, [local_upper] (const void* cell) {
             return traits::Compare(cell, &local_upper) < 0;
-        });
+        }, start_idx);
       } else if (upper_ == nullptr) {
+        int start_idx = ApplyPredicateVectorized<PhysicalType, VectorizedOp::kGreaterOrEqual>(
+            block, sel, &local_lower);
         ApplyPredicate<PhysicalType>(block, sel, [local_lower] (const void* cell) {
             return traits::Compare(cell, &local_lower) >= 0;
-        });
+        }, start_idx);
       } else {
+        const cpp_type bounds[] = { local_lower, local_upper };
+        int start_idx = ApplyPredicateVectorized<PhysicalType, VectorizedOp::kRange>(
+            block, sel, bounds, 2);
         ApplyPredicate<PhysicalType>(block, sel, [local_lower, local_upper] (const void* cell) {
             return traits::Compare(cell, &local_upper) < 0 &&
                    traits::Compare(cell, &local_lower) >= 0;
-        });
+        }, start_idx);
       }
       return;
     };
     case PredicateType::Equality: {
       cpp_type local_lower = lower_ ? *static_cast<const cpp_type*>(lower_) : cpp_type();
+      int start_idx = ApplyPredicateVectorized<PhysicalType, VectorizedOp::kEquality>(
+          block, sel, &local_lower);
       ApplyPredicate<PhysicalType>(block, sel, [local_lower] (const void* cell) {
             return traits::Compare(cell, &local_lower) == 0;
-      });
+      }, start_idx);
       return;
     };
     case PredicateType::IsNotNull: {
@@ -762,12 +1235,27 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       return;
     }
     case PredicateType::InList: {
+      int start_idx = 0;
+      // Short IN lists of integers are cheaper to evaluate by comparing each
+      // cell against every value than by binary search. This isn't done for
+      // floating point types since a NaN in the list breaks the equivalence
+      // with binary search.
+      if constexpr (std::is_integral<cpp_type>::value || PhysicalType == INT128) {
+        if (values_.size() <= kMaxVectorizedInListValues) {
+          cpp_type local_values[kMaxVectorizedInListValues];
+          for (size_t i = 0; i < values_.size(); i++) {
+            local_values[i] = *static_cast<const cpp_type*>(values_[i]);
+          }
+          start_idx = ApplyPredicateVectorized<PhysicalType, VectorizedOp::kInList>(
+              block, sel, local_values, values_.size());
+        }
+      }
       ApplyPredicate<PhysicalType>(block, sel, [this] (const void* cell) {
         return std::binary_search(values_.begin(), values_.end(), cell,
                                   [] (const void* lhs, const void* rhs) {
                                     return traits::Compare(lhs, rhs) < 0;
                                   });
-      });
+      }, start_idx);
       return;
     };
     case PredicateType::None: LOG(FATAL) << "NONE predicate evaluation";
@@ -777,10 +1265,28 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       });
       return;
     };
+    case PredicateType::ArrayContains: {
+      if constexpr (PhysicalType == BINARY) {
+        ApplyPredicate<PhysicalType>(block, sel, [this] (const void* cell) {
+            return EvaluateCellForArrayContains(cell);
+        });
+        return;
+      }
+      LOG(FATAL) << "array contains predicate on a column which is not an ARRAY";
+    };
   }
   LOG(FATAL) << "unknown predicate type";
 }
 
+bool ColumnPredicate::EvaluateCellForArrayContains(const void* cell) const {
+  ArrayCellView array;
+  if (PREDICT_FALSE(!array.Init(*reinterpret_cast<const Slice*>(cell)).ok())) {
+    return false;
+  }
+  return std::all_of(values_.begin(), values_.end(),
+                     [&] (const void* value) { return array.Contains(value); });
+}
+
 bool ColumnPredicate::EvaluateCell(DataType type, const void* cell) const {
   switch (type) {
     case BOOL: return EvaluateCell<BOOL>(cell);
@@ -858,6 +1364,22 @@ string ColumnPredicate::ToString() const {
     case PredicateType::InBloomFilter: {
       return strings::Substitute("`$0` IS InBloomFilter", column_.name());
     };
+    case PredicateType::ArrayContains: {
+      const TypeInfo* element_type_info = GetTypeInfo(column_.type_attributes().element_type);
+      string ss;
+      ss.append(column_.name());
+      ss.append(" CONTAINS (");
+      ss.append(KUDU_REDACT(JoinMapped(values_,
+                                       [&] (const void* value) {
+                                         string str;
+                                         element_type_info->AppendDebugStringForValue(value,
+                                                                                      &str);
+                                         return str;
+                                       },
+                                       ", ")));
+      ss.append(")");
+      return ss;
+    };
     default:
       LOG(FATAL) << "unknown predicate type";
   }
@@ -899,6 +1421,16 @@ bool ColumnPredicate::operator==(const ColumnPredicate& other) const {
         if (column_.type_info()->Compare(values_[i], other.values_[i]) != 0) return false;
       }
       return true;
+    case PredicateType::ArrayContains: {
+      if (values_.size() != other.values_.size()) {
+        return false;
+      }
+      const TypeInfo* element_type_info = GetTypeInfo(column_.type_attributes().element_type);
+      for (int i = 0; i < values_.size(); i++) {
+        if (element_type_info->Compare(values_[i], other.values_[i]) != 0) return false;
+      }
+      return true;
+    }
     case PredicateType::None:
     case PredicateType::IsNotNull:
     case PredicateType::IsNull:
@@ -934,6 +1466,7 @@ int SelectivityRank(const ColumnPredicate& predicate) {
     case PredicateType::InList: rank = 3; break;
     case PredicateType::Range: rank = 4; break;
     case PredicateType::InBloomFilter: rank = 5; break;
+    case PredicateType::ArrayContains: rank = 5; break;
     case PredicateType::IsNotNull: rank = 6; break;
     default: LOG(FATAL) << "unknown predicate type";
   }
@@ -63,6 +63,10 @@ enum class PredicateType {
   // A predicate which evaluates to true if the column value is present in
   // a bloom filter.
   InBloomFilter,
+
+  // A predicate on an ARRAY column which evaluates to true if the array
+  // contains each of a list of values.
+  ArrayContains,
 };
 
 // A predicate which can be evaluated over a block of column values.
@@ -145,6 +149,12 @@ class ColumnPredicate {
                                        const void* lower = nullptr,
                                        const void* upper = nullptr);
 
+  // Create a new predicate on the ARRAY column which matches the arrays
+  // containing each of the values, which are of the type of the elements.
+  //
+  // The values are not copied, and must outlive the returned predicate.
+  static ColumnPredicate ArrayContains(ColumnSchema column, std::vector<const void*>* values);
+
   // Creates a new predicate which matches no values.
   static ColumnPredicate None(ColumnSchema column);
 
@@ -215,6 +225,9 @@ class ColumnPredicate {
       case PredicateType::InBloomFilter: {
         return EvaluateCellForBloomFilter<PhysicalType>(cell);
       };
+      case PredicateType::ArrayContains: {
+        return EvaluateCellForArrayContains(cell);
+      };
       default:
         LOG(FATAL) << "unknown predicate type";
     }
@@ -253,8 +266,8 @@ class ColumnPredicate {
     return column_;
   }
 
-  // Returns the list of values if this is an in-list predicate.
-  // The values are guaranteed to be unique and in sorted order.
+  // Returns the list of values if this is an in-list or an array contains
+  // predicate. The values are guaranteed to be unique and in sorted order.
   const std::vector<const void*>& raw_values() const {
     return values_;
   }
@@ -316,6 +329,13 @@ class ColumnPredicate {
   // Merge another predicate into this InList predicate.
   void MergeIntoInList(const ColumnPredicate& other);
 
+  // Merge another predicate into this ArrayContains predicate.
+  void MergeIntoArrayContains(const ColumnPredicate& other);
+
+  // Sorts 'values_', values of the type of 'type_info', and removes the
+  // duplicates.
+  void SortAndDedupValues(const TypeInfo* type_info);
+
   // Templated evaluation to inline the dispatch of comparator. Templating this
   // allows dispatch to occur only once per batch.
   template <DataType PhysicalType>
@@ -353,6 +373,9 @@ class ColumnPredicate {
     return true;
   }
 
+  // Evaluate the ArrayContains predicate on a single ARRAY cell.
+  bool EvaluateCellForArrayContains(const void* cell) const;
+
   // For a Range type predicate, this helper function checks
   // whether a given value is in the range.
   bool CheckValueInRange(const void* value) const;
@@ -378,7 +401,8 @@ class ColumnPredicate {
   // The exclusive upper bound value if this is a Range predicate.
   const void* upper_;
 
-  // The list of values to check column against if this is an InList predicate.
+  // The list of values to check column against if this is an InList predicate,
+  // or the values the arrays must contain if this is an ArrayContains predicate.
   std::vector<const void*> values_;
 
   // The list of bloom filters in this predicate.
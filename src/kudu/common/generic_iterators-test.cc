@@ -62,6 +62,7 @@
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
+#include "kudu/util/threadpool.h"
 
 DEFINE_int32(num_lists, 3, "Number of lists to merge");
 DEFINE_int32(num_rows, 1000, "Number of entries per list");
@@ -512,6 +513,63 @@ TEST(TestMergeIterator, TestDeDupGhostRows) {
                       /*include_deleted_rows=*/true));
 }
 
+// Test that runs of rows of a sub-iterator which sort before the rows of the
+// other sub-iterators are merged correctly, including across deselected rows
+// and block boundaries.
+TEST(TestMergeIterator, TestMergeInterleavedRuns) {
+  const int kRunLength = 10;
+  const int kNumIters = 3;
+  const int kNumRuns = 4;
+  vector<vector<int64_t>> ints(kNumIters);
+  vector<int64_t> expected;
+  for (int run = 0; run < kNumIters * kNumRuns; run++) {
+    for (int i = 0; i < kRunLength; i++) {
+      const int64_t val = run * kRunLength + i;
+      ints[run % kNumIters].emplace_back(val);
+      // The odd rows of the second sub-iterator are deselected.
+      if (run % kNumIters != 1 || val % 2 == 0) {
+        expected.emplace_back(val);
+      }
+    }
+  }
+  vector<unique_ptr<SelectionVector>> svs;
+  vector<IterWithBounds> input;
+  for (int i = 0; i < kNumIters; i++) {
+    unique_ptr<VectorIterator> vec(new VectorIterator(ints[i]));
+    vec->set_block_size(7);
+    if (i == 1) {
+      svs.emplace_back(new SelectionVector(ints[i].size()));
+      for (int j = 0; j < ints[i].size(); j++) {
+        if (ints[i][j] % 2 == 0) {
+          svs.back()->SetRowSelected(j);
+        } else {
+          svs.back()->SetRowUnselected(j);
+        }
+      }
+      vec->set_selection_vector(svs.back().get());
+    }
+    IterWithBounds iwb;
+    iwb.iter = NewMaterializingIterator(std::move(vec));
+    input.emplace_back(std::move(iwb));
+  }
+  unique_ptr<RowwiseIterator> merger(NewMergeIterator(
+      MergeIteratorOptions(/*include_deleted_rows=*/false), std::move(input)));
+  ASSERT_OK(merger->Init(nullptr));
+
+  vector<int64_t> merged;
+  RowBlockMemory mem;
+  RowBlock dst(&kIntSchema, 16, &mem);
+  while (merger->HasNext()) {
+    ASSERT_OK(merger->NextBlock(&dst));
+    for (int i = 0; i < dst.nrows(); i++) {
+      if (dst.selection_vector()->IsRowSelected(i)) {
+        merged.emplace_back(*kIntSchema.ExtractColumnFromRow<INT64>(dst.row(i), kValColIdx));
+      }
+    }
+  }
+  ASSERT_EQ(expected, merged);
+}
+
 // Test that the MaterializingIterator properly evaluates predicates when they apply
 // to single columns.
 TEST(TestMaterializingIterator, TestMaterializingPredicatePushdown) {
@@ -543,6 +601,61 @@ TEST(TestMaterializingIterator, TestMaterializingPredicatePushdown) {
   ASSERT_FALSE(dst.selection_vector()->IsRowSelected(30));
 }
 
+// Test that the parallel union returns the selected rows of all its
+// sub-iterators, and that it may be destroyed before it's fully consumed.
+TEST(TestParallelUnionIterator, TestParallelUnion) {
+  const int kNumLists = 5;
+  const int kRowsPerList = 1000;
+  unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("test").set_max_threads(3).Build(&pool));
+
+  for (bool consume_all : { true, false }) {
+    SCOPED_TRACE(consume_all);
+    vector<IterWithBounds> iters;
+    for (int i = 0; i < kNumLists; i++) {
+      vector<int64_t> ints(kRowsPerList);
+      for (int j = 0; j < kRowsPerList; j++) {
+        ints[j] = i * kRowsPerList + j;
+      }
+      unique_ptr<VectorIterator> colwise(new VectorIterator(ints));
+      colwise->set_block_size(64);
+      IterWithBounds iwb;
+      iwb.iter = NewMaterializingIterator(std::move(colwise));
+      iters.emplace_back(std::move(iwb));
+    }
+    unique_ptr<RowwiseIterator> union_iter(
+        NewParallelUnionIterator(std::move(iters), pool.get(), 3));
+    ScanSpec spec;
+    TestIntRangePredicate pred(100, 4900);
+    spec.AddPredicate(pred.pred_);
+    ASSERT_OK(union_iter->Init(&spec));
+    ASSERT_EQ(0, spec.predicates().size());
+
+    RowBlockMemory mem(1024);
+    RowBlock dst(&kIntSchema, 50, &mem);
+    vector<int64_t> results;
+    while (union_iter->HasNext()) {
+      ASSERT_OK(union_iter->NextBlock(&dst));
+      for (size_t i = 0; i < dst.nrows(); i++) {
+        if (dst.selection_vector()->IsRowSelected(i)) {
+          results.push_back(*kIntSchema.ExtractColumnFromRow<INT64>(dst.row(i), kValColIdx));
+        }
+      }
+      if (!consume_all && results.size() > 1000) {
+        break;
+      }
+    }
+    if (!consume_all) {
+      continue;
+    }
+    std::sort(results.begin(), results.end());
+    ASSERT_EQ(4800, results.size());
+    for (int i = 0; i < results.size(); i++) {
+      ASSERT_EQ(100 + i, results[i]);
+    }
+  }
+}
+
 // Test that PredicateEvaluatingIterator will properly evaluate predicates on its
 // input.
 TEST(TestPredicateEvaluatingIterator, TestPredicateEvaluation) {
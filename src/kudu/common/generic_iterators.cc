@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <iterator>
 #include <memory>
@@ -55,16 +56,25 @@
 #include "kudu/common/rowblock_memory.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/types.h"
 #include "kudu/gutil/casts.h"
+#include "kudu/gutil/endian.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/condition_variable.h"
+#include "kudu/util/int128.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/memory/arena.h"
+#include "kudu/util/mutex.h"
 #include "kudu/util/object_pool.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/threadpool.h"
+#include "kudu/util/trace.h"
 
 namespace boost {
 namespace heap {
@@ -89,6 +99,9 @@ TAG_FLAG(materializing_iterator_decoder_eval, hidden);
 TAG_FLAG(materializing_iterator_decoder_eval, runtime);
 
 namespace kudu {
+
+const char* PREDICATE_EVAL_NANOS_METRIC_NAME = "predicate_eval_nanos";
+
 namespace {
 void AddIterStats(const RowwiseIterator& iter,
                   vector<IteratorStats>* stats) {
@@ -114,6 +127,43 @@ typedef std::pair<int32_t, ColumnPredicate> ColumnIdxAndPredicate;
 // TODO(todd): this should be sized by # bytes, not # rows.
 static const int kMergeRowBuffer = 1024;
 
+namespace {
+
+uint64_t FlipSignBit(int64_t v) {
+  return static_cast<uint64_t>(v) ^ (1ULL << 63);
+}
+
+// Returns a prefix of the first key column of 'row', normalized so that rows
+// whose prefixes differ compare like their prefixes. Rows with equal prefixes
+// must be compared in full.
+uint64_t NormalizedKeyPrefix(const RowBlockRow& row) {
+  const uint8_t* cell = row.cell_ptr(0);
+  switch (row.schema()->column(0).type_info()->physical_type()) {
+    case INT8: return FlipSignBit(UnalignedLoad<int8_t>(cell));
+    case INT16: return FlipSignBit(UnalignedLoad<int16_t>(cell));
+    case INT32: return FlipSignBit(UnalignedLoad<int32_t>(cell));
+    case INT64: return FlipSignBit(UnalignedLoad<int64_t>(cell));
+    case INT128:
+      return FlipSignBit(static_cast<int64_t>(UnalignedLoad<int128_t>(cell) >> 64));
+    case UINT8: return UnalignedLoad<uint8_t>(cell);
+    case UINT16: return UnalignedLoad<uint16_t>(cell);
+    case UINT32: return UnalignedLoad<uint32_t>(cell);
+    case UINT64: return UnalignedLoad<uint64_t>(cell);
+    case BINARY: {
+      // The first bytes, zero-padded: a string sorts before its extensions
+      // with zeroes, but those have the same prefix.
+      const Slice* slice = reinterpret_cast<const Slice*>(cell);
+      uint8_t buf[sizeof(uint64_t)] = {};
+      memcpy(buf, slice->data(), std::min(slice->size(), sizeof(buf)));
+      return BigEndian::Load64(buf);
+    }
+    default:
+      return 0;
+  }
+}
+
+} // anonymous namespace
+
 // MergeIterState wraps a RowwiseIterator for use by the MergeIterator.
 class MergeIterState : public boost::intrusive::list_base_hook<> {
  public:
@@ -136,6 +186,15 @@ class MergeIterState : public boost::intrusive::list_base_hook<> {
     return decoded_bounds_->lower;
   }
 
+  // Compares the next row with the next row of 'other', starting with their
+  // normalized key prefixes.
+  int CompareNextRows(const MergeIterState& other) const {
+    if (next_key_prefix_ != other.next_key_prefix_) {
+      return next_key_prefix_ < other.next_key_prefix_ ? -1 : 1;
+    }
+    return schema().Compare(next_row(), other.next_row());
+  }
+
   // Fetches the last row from the iterator's current block, or the iterator's
   // absolute upper bound if a block has not yet been pulled.
   //
@@ -164,6 +223,7 @@ class MergeIterState : public boost::intrusive::list_base_hook<> {
           iwb_.encoded_bounds->first, &decoded_bounds_->lower, &decoded_bounds_memory->arena));
       RETURN_NOT_OK(schema().DecodeRowKey(
           iwb_.encoded_bounds->second, &decoded_bounds_->upper, &decoded_bounds_memory->arena));
+      next_key_prefix_ = NormalizedKeyPrefix(decoded_bounds_->lower);
     } else {
       RETURN_NOT_OK(PullNextBlock());
     }
@@ -201,11 +261,17 @@ class MergeIterState : public boost::intrusive::list_base_hook<> {
   // Pulls the next block from the underlying iterator.
   Status PullNextBlock();
 
-  // Copies as many rows as possible from the current block of buffered rows to
-  // 'dst' (starting at 'dst_offset').
+  // Copies as many rows as possible, up to 'max_rows', from the current block of
+  // buffered rows to 'dst' (starting at 'dst_offset').
   //
   // If successful, 'num_rows_copied' will be set to the number of rows copied.
-  Status CopyBlock(RowBlock* dst, size_t dst_offset, size_t* num_rows_copied);
+  Status CopyBlock(RowBlock* dst, size_t dst_offset, size_t max_rows,
+                   size_t* num_rows_copied);
+
+  // Returns the number of rows of the current block, starting with the next
+  // row, which sort before 'bound'. Deselected rows are counted as long as a
+  // selected row before 'bound' follows them.
+  size_t NumRowsBefore(const RowBlockRow& bound) const;
 
   // Returns true if the current block in the underlying iterator is exhausted.
   bool IsBlockExhausted() const {
@@ -247,9 +313,19 @@ class MergeIterState : public boost::intrusive::list_base_hook<> {
   // The memory backing the rows was allocated out of the arena.
   unique_ptr<RowBlock> read_block_;
 
+  // Points the iterator at the row 'idx' of the current block.
+  void SetNextRow(size_t idx) {
+    next_row_idx_ = idx;
+    next_row_.Reset(read_block_.get(), idx);
+    next_key_prefix_ = NormalizedKeyPrefix(next_row_);
+  }
+
   // The row currently pointed to by the iterator.
   RowBlockRow next_row_;
 
+  // The normalized key prefix of next_row().
+  uint64_t next_key_prefix_ = 0;
+
   // The last row available in read_block_.
   RowBlockRow last_row_;
 
@@ -269,8 +345,7 @@ Status MergeIterState::Advance(size_t num_rows, bool* pulled_new_block) {
   size_t idx;
   if (!IsBlockExhausted() &&
       read_block_->selection_vector()->FindFirstRowSelected(next_row_idx_, &idx)) {
-    next_row_idx_ = idx;
-    next_row_.Reset(read_block_.get(), next_row_idx_);
+    SetNextRow(idx);
     *pulled_new_block = false;
     return Status::OK();
   }
@@ -307,8 +382,9 @@ Status MergeIterState::PullNextBlock() {
     // Seek next_row_ and last_row_ to the first and last selected rows
     // respectively (which could be identical).
 
-    CHECK(selection->FindFirstRowSelected(0, &next_row_idx_));
-    next_row_.Reset(read_block_.get(), next_row_idx_);
+    size_t first_idx;
+    CHECK(selection->FindFirstRowSelected(0, &first_idx));
+    SetNextRow(first_idx);
 
     // We use a signed size_t type to avoid underflowing when finding last_row_.
     //
@@ -330,13 +406,14 @@ Status MergeIterState::PullNextBlock() {
   return Status::OK();
 }
 
-Status MergeIterState::CopyBlock(RowBlock* dst, size_t dst_offset,
+Status MergeIterState::CopyBlock(RowBlock* dst, size_t dst_offset, size_t max_rows,
                                  size_t* num_rows_copied) {
   DCHECK(read_block_);
   DCHECK(!IsBlockExhausted());
 
-  size_t num_rows_to_copy = std::min(remaining_in_block(),
-                                     dst->nrows() - dst_offset);
+  size_t num_rows_to_copy = std::min({ remaining_in_block(),
+                                       dst->nrows() - dst_offset,
+                                       max_rows });
   VLOG(3) << Substitute(
       "Copying $0 rows from RowBlock (s:$1,o:$2) to RowBlock (s:$3,o:$4): $5",
       num_rows_to_copy, read_block_->nrows(), next_row_idx_, dst->nrows(),
@@ -347,6 +424,158 @@ Status MergeIterState::CopyBlock(RowBlock* dst, size_t dst_offset,
   return Status::OK();
 }
 
+size_t MergeIterState::NumRowsBefore(const RowBlockRow& bound) const {
+  DCHECK(!IsBlockExhausted());
+  const Schema& s = schema();
+  if (s.Compare(last_row_, bound) < 0) {
+    return remaining_in_block();
+  }
+
+  // The rows of the block are sorted, and 'last_row_' isn't before 'bound', so
+  // a selected row at or after 'bound' is found before running off the block.
+  const SelectionVector* selection = read_block_->selection_vector();
+  size_t idx = next_row_idx_;
+  RowBlockRow row;
+  while (true) {
+    row.Reset(read_block_.get(), idx);
+    if (s.Compare(row, bound) >= 0) {
+      break;
+    }
+    CHECK(selection->FindFirstRowSelected(idx + 1, &idx));
+  }
+  return idx - next_row_idx_;
+}
+
+// A tournament tree of MergeIterStates, ordered by their next rows. Each leaf
+// holds a sub-iterator or is empty, and each internal node holds the leaf of
+// the winner of its subtree, i.e. the sub-iterator with the smallest next row.
+//
+// Once the next row of a sub-iterator changes, its winners are replayed along
+// its path to the root, which takes log2(capacity) comparisons: a skew heap
+// needs about twice as many to pop and push it back. Since the comparisons
+// are against the siblings' winners rather than the losers of each match, a
+// sub-iterator whose next row isn't the smallest may join or leave the tree
+// just as cheaply.
+class MergeStateTournamentTree {
+ public:
+  // Sets the tree up for at most 'capacity' sub-iterators.
+  void Init(size_t capacity) {
+    num_leaves_ = 1;
+    while (num_leaves_ < capacity) {
+      num_leaves_ *= 2;
+    }
+    leaves_.assign(num_leaves_, nullptr);
+    winners_.assign(num_leaves_, 0);
+    free_leaves_.clear();
+    for (size_t i = num_leaves_; i > 0; i--) {
+      free_leaves_.emplace_back(i - 1);
+    }
+    for (size_t node = num_leaves_ - 1; node >= 1; node--) {
+      winners_[node] = Winner(NodeWinner(2 * node), NodeWinner(2 * node + 1));
+    }
+    size_ = 0;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Returns the sub-iterator with the smallest next row.
+  MergeIterState* top() const {
+    DCHECK(!empty());
+    return leaves_[top_leaf()];
+  }
+
+  // Returns the sub-iterator with the smallest next row other than top(), or
+  // null if there's none.
+  const MergeIterState* runner_up() const {
+    const MergeIterState* best = nullptr;
+    for (size_t node = top_leaf() + num_leaves_; node > 1; node /= 2) {
+      const MergeIterState* s = leaves_[NodeWinner(node ^ 1)];
+      if (s && (!best || s->CompareNextRows(*best) < 0)) {
+        best = s;
+      }
+    }
+    return best;
+  }
+
+  void push(MergeIterState* state) {
+    DCHECK(!free_leaves_.empty());
+    const size_t leaf = free_leaves_.back();
+    free_leaves_.pop_back();
+    leaves_[leaf] = state;
+    size_++;
+    Replay(leaf);
+  }
+
+  // Removes top(), without accessing it.
+  void pop() {
+    const size_t leaf = top_leaf();
+    leaves_[leaf] = nullptr;
+    free_leaves_.emplace_back(leaf);
+    size_--;
+    Replay(leaf);
+  }
+
+  // Restores the order of the tree once the next row of top() has changed.
+  void update_top() {
+    Replay(top_leaf());
+  }
+
+  // Calls 'f' on each sub-iterator of the tree, in no particular order.
+  template<class F>
+  void ForEach(const F& f) const {
+    for (const MergeIterState* s : leaves_) {
+      if (s) {
+        f(s);
+      }
+    }
+  }
+
+ private:
+  size_t top_leaf() const {
+    return num_leaves_ == 1 ? 0 : winners_[1];
+  }
+
+  // Returns the winner leaf of the subtree rooted at 'node', where nodes
+  // [num_leaves_, 2 * num_leaves_) are the leaves.
+  size_t NodeWinner(size_t node) const {
+    return node >= num_leaves_ ? node - num_leaves_ : winners_[node];
+  }
+
+  // Returns the leaf with the smallest next row among 'a' and 'b', empty
+  // leaves coming last. Ties go to 'a'.
+  size_t Winner(size_t a, size_t b) const {
+    const MergeIterState* sa = leaves_[a];
+    const MergeIterState* sb = leaves_[b];
+    if (!sb) {
+      return a;
+    }
+    return (!sa || sb->CompareNextRows(*sa) < 0) ? b : a;
+  }
+
+  void Replay(size_t leaf) {
+    for (size_t node = (leaf + num_leaves_) / 2; node >= 1; node /= 2) {
+      winners_[node] = Winner(NodeWinner(2 * node), NodeWinner(2 * node + 1));
+    }
+  }
+
+  // A power of 2.
+  size_t num_leaves_ = 1;
+  std::vector<MergeIterState*> leaves_;
+
+  // The winner leaf of each internal node, the root being node 1 and the
+  // children of node N being nodes 2N and 2N+1. Node 0 is unused.
+  std::vector<size_t> winners_;
+
+  std::vector<size_t> free_leaves_;
+  size_t size_ = 0;
+};
+
 // An iterator which merges the results of other iterators, comparing
 // based on keys.
 //
@@ -489,12 +718,17 @@ class MergeIterator : public RowwiseIterator {
   Status NextBlock(RowBlock* dst) override;
 
  private:
-  // Materializes as much of the next block's worth of data into 'dst' at offset
-  // 'dst_row_idx' as possible. Only permitted when there's only one
-  // sub-iterator in the hot heap.
+  // Materializes as much of the next 'num_rows' rows of the top hot sub-iterator
+  // into 'dst' at offset 'dst_row_idx' as possible. Only permitted when these
+  // rows sort before the rows of all the other sub-iterators, as returned by
+  // NumRowsBeforeOtherStates().
   //
   // On success, the selection vector in 'dst' and 'dst_row_idx' are both updated.
-  Status MaterializeBlock(RowBlock* dst, size_t* dst_row_idx);
+  Status MaterializeBlock(RowBlock* dst, size_t* dst_row_idx, size_t num_rows);
+
+  // Returns the number of rows of the top hot sub-iterator's current block
+  // which sort before the next rows of all the other sub-iterators.
+  size_t NumRowsBeforeOtherStates() const;
 
   // Finds the next row and materializes it into 'dst' at offset 'dst_row_idx'.
   //
@@ -559,13 +793,16 @@ class MergeIterator : public RowwiseIterator {
     bool operator()(const MergeIterState* a, const MergeIterState* b) const {
       // This is counter-intuitive, but it's because boost::heap defaults to
       // a max-heap; the comparator must be inverted to yield a min-heap.
-      return a->schema().Compare(a->next_row(), b->next_row()) > 0;
+      return a->CompareNextRows(*b) > 0;
     }
   };
   typedef boost::heap::skew_heap<
       MergeIterState*, boost::heap::compare<MergeIterStateComparator>> MergeStateMinHeap;
 
-  // The min-heaps as described in the algorithm above.
+  // The HOT and COLD sets as described in the algorithm above. HOT is a
+  // tournament tree rather than a min-heap: its top changes with nearly every
+  // row, and replaying that is cheaper than reheaping. COLD changes once per
+  // block at most.
   //
   // Note that none of these containers "own" the objects they contain: the
   // MergeIterStates are all owned by states_. Care must be taken to remove
@@ -582,7 +819,7 @@ class MergeIterator : public RowwiseIterator {
   // do not offer ordered iteration.
   //
   // 1. https://www.boost.org/doc/libs/1_69_0/doc/html/heap/data_structures.html
-  MergeStateMinHeap hot_;
+  MergeStateTournamentTree hot_;
   MergeStateMinHeap cold_;
 };
 
@@ -641,6 +878,7 @@ Status MergeIterator::Init(ScanSpec *spec) {
       [](MergeIterState* s) { delete s; });
 
   // Establish the merge window and initialize the ordered iterator containers.
+  hot_.Init(states_.size());
   for (auto& s : states_) {
     cold_.push(&s);
   }
@@ -679,9 +917,9 @@ Status MergeIterator::AdvanceAndReheap(MergeIterState* state,
   DCHECK_EQ(state, hot_.top());
   bool pulled_new_block = false;
   RETURN_NOT_OK(state->Advance(num_rows_to_advance, &pulled_new_block));
-  hot_.pop();
 
   if (state->IsFullyExhausted()) {
+    hot_.pop();
     DestroySubIterator(state);
 
     // This sub-iterator's removal means the end of the merge window may have shifted.
@@ -689,6 +927,7 @@ Status MergeIterator::AdvanceAndReheap(MergeIterState* state,
   } else if (pulled_new_block) {
     // This sub-iterator has a new block, which means the end of the merge window
     // may have shifted.
+    hot_.pop();
     if (!hot_.empty() &&
         schema_->Compare(hot_.top()->last_row(), state->next_row()) < 0) {
       // The new block lies beyond the new end of the merge window.
@@ -703,7 +942,7 @@ Status MergeIterator::AdvanceAndReheap(MergeIterState* state,
   } else {
     // The sub-iterator's block's upper bound remains the same; the merge window
     // has not changed.
-    hot_.push(state);
+    hot_.update_top();
   }
   return Status::OK();
 }
@@ -775,17 +1014,20 @@ Status MergeIterator::NextBlock(RowBlock* dst) {
       break;
     }
 
-    // If there's just one hot sub-iterator, we can copy its entire block
-    // instead of copying row-by-row.
+    // If the next rows of the top hot sub-iterator sort before those of all
+    // the other sub-iterators, we can copy them column by column instead of
+    // copying row-by-row. When there's just one hot sub-iterator, that's its
+    // entire block.
     //
-    // When N sub-iterators fully overlap, there'll only be one hot sub-iterator
-    // when consuming the very last row. A block copy for this case is more
-    // overhead than just copying out the last row.
+    // When N sub-iterators fully overlap, there's a single such row most of
+    // the time. A block copy for this case is more overhead than just copying
+    // out the row.
     //
     // TODO(adar): this can be further optimized by "attaching" data to 'dst'
     // rather than copying it.
-    if (hot_.size() == 1 && hot_.top()->remaining_in_block() > 1) {
-      RETURN_NOT_OK(MaterializeBlock(dst, &dst_row_idx));
+    const size_t num_rows = NumRowsBeforeOtherStates();
+    if (num_rows > 1) {
+      RETURN_NOT_OK(MaterializeBlock(dst, &dst_row_idx, num_rows));
     } else {
       RETURN_NOT_OK(MaterializeOneRow(dst, &dst_row_idx));
     }
@@ -798,12 +1040,11 @@ Status MergeIterator::NextBlock(RowBlock* dst) {
   return Status::OK();
 }
 
-Status MergeIterator::MaterializeBlock(RowBlock* dst, size_t* dst_row_idx) {
-  DCHECK_EQ(1, hot_.size());
-
+Status MergeIterator::MaterializeBlock(RowBlock* dst, size_t* dst_row_idx,
+                                       size_t num_rows) {
   MergeIterState* state = hot_.top();
   size_t num_rows_copied;
-  RETURN_NOT_OK(state->CopyBlock(dst, *dst_row_idx, &num_rows_copied));
+  RETURN_NOT_OK(state->CopyBlock(dst, *dst_row_idx, num_rows, &num_rows_copied));
   RETURN_NOT_OK(AdvanceAndReheap(state, num_rows_copied));
 
   // CopyBlock() already updated dst's SelectionVector.
@@ -811,85 +1052,60 @@ Status MergeIterator::MaterializeBlock(RowBlock* dst, size_t* dst_row_idx) {
   return Status::OK();
 }
 
+size_t MergeIterator::NumRowsBeforeOtherStates() const {
+  const MergeIterState* top = hot_.top();
+  if (hot_.size() == 1) {
+    // The rows of the cold sub-iterators are past the end of the merge window.
+    return top->remaining_in_block();
+  }
+
+  // The smallest next row of the other sub-iterators. The cold ones can't
+  // come first, but checking is cheaper than relying on it.
+  const RowBlockRow* bound = &DCHECK_NOTNULL(hot_.runner_up())->next_row();
+  if (!cold_.empty() && schema_->Compare(cold_.top()->next_row(), *bound) < 0) {
+    bound = &cold_.top()->next_row();
+  }
+  return top->NumRowsBefore(*bound);
+}
+
 // TODO(todd): this is an obvious spot to add codegen - there's a ton of branching
 // and such around the comparisons. A simple experiment indicated there's some
 // 2x to be gained.
 Status MergeIterator::MaterializeOneRow(RowBlock* dst, size_t* dst_row_idx) {
-  // We need a vector to track the iterators whose next_row() contains the
-  // smallest row key at a given moment during the merge because there may be
-  // multiple deleted rows with the same row key across multiple rowsets, and up
-  // to one live instance, that we have to deduplicate.
-  vector<MergeIterState*> smallest;
-  smallest.reserve(hot_.size());
-
-  // Find the set of sub-iterators whose matching next row keys are the smallest
-  // across all sub-iterators.
-  //
-  // Note: heap ordered iteration isn't the same as a total ordering. For
-  // example, the two absolute smallest keys might be in the same sub-iterator
-  // rather than in the first two sub-iterators yielded via ordered iteration.
-  // However, the goal here is to identify a group of matching keys for the
-  // purpose of deduplication, and we're guaranteed that such matching keys
-  // cannot exist in the same sub-iterator (i.e. the same rowset).
-  for (auto iter = hot_.ordered_begin(); iter != hot_.ordered_end(); ++iter) {
-    MergeIterState* state = *iter;
-    if (!smallest.empty() &&
-        schema_->Compare(state->next_row(), smallest[0]->next_row()) != 0) {
-      break;
-    }
-    smallest.emplace_back(state);
-  }
+  MergeIterState* state = hot_.top();
+  VLOG(3) << Substitute("Copying row $0 from $1", *dst_row_idx, state->ToString());
+  RowBlockRow dst_row = dst->row(*dst_row_idx);
+  RETURN_NOT_OK(CopyRow(state->next_row(), &dst_row, dst->arena()));
+  RETURN_NOT_OK(AdvanceAndReheap(state, /*num_rows_to_advance=*/1));
 
-  MergeIterState* row_to_return_iter = nullptr;
   if (!opts_.include_deleted_rows) {
     // Since deleted rows are not included here, there can only be a single
-    // instance of any given row key in 'smallest'.
-    CHECK_EQ(1, smallest.size()) << "expected only a single smallest row";
-    row_to_return_iter = smallest[0];
+    // instance of any given row key.
+    DCHECK(hot_.empty() || schema_->Compare(hot_.top()->next_row(), dst_row) != 0)
+        << "expected only a single smallest row";
   } else {
-    // Deduplicate any deleted rows. Row instance de-duplication criteria:
+    // There may be multiple deleted instances of the row across multiple
+    // rowsets, and up to one live instance, that we have to deduplicate. Since
+    // a row key can't repeat within a rowset, they're the next smallest rows.
+    //
+    // Row instance de-duplication criteria:
     // 1. If there is a non-deleted instance, return that instance.
     // 2. If all rows are deleted, any instance will suffice because we
     //    don't guarantee that we will return valid field values for deleted
     //    rows.
-    int live_rows_found = 0;
-    for (const auto& s : smallest) {
-      bool is_deleted =
-          *schema_->ExtractColumnFromRow<IS_DELETED>(
-              s->next_row(), schema_->first_is_deleted_virtual_column_idx());
-      if (!is_deleted) {
+    const size_t is_deleted_idx = schema_->first_is_deleted_virtual_column_idx();
+    bool is_deleted = *schema_->ExtractColumnFromRow<IS_DELETED>(dst_row, is_deleted_idx);
+    while (!hot_.empty() && schema_->Compare(hot_.top()->next_row(), dst_row) == 0) {
+      state = hot_.top();
+      if (!*schema_->ExtractColumnFromRow<IS_DELETED>(state->next_row(), is_deleted_idx)) {
+        DCHECK(is_deleted) << "expected at most one live row";
         // We found the single live instance of the row.
-        row_to_return_iter = s;
-#ifndef NDEBUG
-        live_rows_found++; // In DEBUG mode, do a sanity-check count of the live rows.
-#else
-        break; // In RELEASE mode, short-circuit the loop.
-#endif
+        RETURN_NOT_OK(CopyRow(state->next_row(), &dst_row, dst->arena()));
+        is_deleted = false;
       }
-    }
-    DCHECK_LE(live_rows_found, 1) << "expected at most one live row";
-
-    // If all instances of a given row are deleted then return an arbitrary
-    // deleted instance.
-    if (row_to_return_iter == nullptr) {
-      row_to_return_iter = smallest[0];
-      DCHECK(*schema_->ExtractColumnFromRow<IS_DELETED>(
-          row_to_return_iter->next_row(), schema_->first_is_deleted_virtual_column_idx()))
-          << "expected deleted row";
+      RETURN_NOT_OK(AdvanceAndReheap(state, /*num_rows_to_advance=*/1));
     }
   }
-  VLOG(3) << Substitute("Copying row $0 from $1",
-                        *dst_row_idx, row_to_return_iter->ToString());
-  RowBlockRow dst_row = dst->row(*dst_row_idx);
-  RETURN_NOT_OK(CopyRow(row_to_return_iter->next_row(), &dst_row, dst->arena()));
-
-  // Advance all matching sub-iterators and remove any that are exhausted.
-  // Since we're advancing iterators of the same row starting with hot_.top(),
-  // each of these calls is effectively being called on hot_.top(), since the
-  // reheaping will put each top iterator farther down the hot heap.
-  for (auto& s : smallest) {
-    RETURN_NOT_OK(AdvanceAndReheap(s, /*num_rows_to_advance=*/1));
-  }
 
   dst->selection_vector()->SetRowSelected(*dst_row_idx);
   (*dst_row_idx)++;
@@ -1107,6 +1323,351 @@ unique_ptr<RowwiseIterator> NewUnionIterator(vector<IterWithBounds> iters) {
   return unique_ptr<RowwiseIterator>(new UnionIterator(std::move(iters)));
 }
 
+////////////////////////////////////////////////////////////
+// ParallelUnionIterator
+////////////////////////////////////////////////////////////
+
+// An iterator which unions the results of other iterators like the
+// UnionIterator, but reads from several of them at once on a thread pool.
+//
+// Each task of the pool reads a block from a sub-iterator which no other task
+// is reading from, into one of a fixed number of buffered blocks. NextBlock()
+// copies the rows of the buffered blocks out in the order they were read, and
+// hands the consumed blocks back to the tasks. No task runs while all the
+// blocks are buffered, so an idle scan doesn't hold on to the threads of the
+// pool.
+class ParallelUnionIterator : public RowwiseIterator {
+ public:
+  // Constructs a ParallelUnionIterator of the given iterators, reading from up
+  // to 'parallelism' of them at once on 'pool'.
+  //
+  // The iterators must have matching schemas and should not yet be initialized.
+  ParallelUnionIterator(vector<IterWithBounds> iters, ThreadPool* pool, int parallelism);
+
+  // Waits for the tasks reading from the sub-iterators.
+  ~ParallelUnionIterator() override;
+
+  Status Init(ScanSpec* spec) override;
+
+  bool HasNext() const override;
+
+  string ToString() const override;
+
+  const Schema& schema() const override {
+    CHECK(initted_);
+    return *CHECK_NOTNULL(schema_.get());
+  }
+
+  void GetIteratorStats(vector<IteratorStats>* stats) const override;
+
+  Status NextBlock(RowBlock* dst) override;
+
+ private:
+  // The number of rows of the buffered blocks.
+  static constexpr size_t kRowsPerBuffer = 128;
+
+  // A block read from a sub-iterator.
+  struct Buffer {
+    explicit Buffer(const Schema* schema)
+        : block(schema, kRowsPerBuffer, &memory) {
+    }
+    RowBlockMemory memory;
+    RowBlock block;
+  };
+
+  // A task reading a block. It's accounted for until it runs, or until it's
+  // dropped by the pool when shutting down.
+  class ReadTask {
+   public:
+    ReadTask(ParallelUnionIterator* parent, size_t iter_idx, Buffer* buffer)
+        : parent_(parent),
+          iter_idx_(iter_idx),
+          buffer_(buffer),
+          ran_(false) {
+    }
+
+    ~ReadTask() {
+      if (!ran_) {
+        parent_->FinishTask(iter_idx_, buffer_, Status::Aborted("the thread pool is shut down"),
+                            /*has_next=*/false);
+      }
+    }
+
+    void Run() {
+      ran_ = true;
+      parent_->ReadBlock(iter_idx_, buffer_);
+    }
+
+   private:
+    ParallelUnionIterator* const parent_;
+    const size_t iter_idx_;
+    Buffer* const buffer_;
+    bool ran_;
+
+    DISALLOW_COPY_AND_ASSIGN(ReadTask);
+  };
+
+  typedef vector<std::shared_ptr<ReadTask>> ReadTasks;
+
+  // Reads the next block of the sub-iterator 'iter_idx' into 'buffer'.
+  void ReadBlock(size_t iter_idx, Buffer* buffer);
+
+  // Hands the sub-iterator 'iter_idx' and 'buffer' back once a task is done
+  // with them, with status 's'.
+  void FinishTask(size_t iter_idx, Buffer* buffer, const Status& s, bool has_next);
+
+  // Creates the tasks to read from the sub-iterators, while there are free
+  // buffers and sub-iterators which aren't being read from. The tasks must be
+  // submitted with SubmitTasks() once the lock is released.
+  void CreateTasksUnlocked(ReadTasks* tasks);
+
+  // Submits 'tasks' to the pool. Doesn't access this iterator, which may be
+  // destroyed once the tasks are done.
+  static void SubmitTasks(ThreadPool* pool, ReadTasks tasks);
+
+  // Returns true once there's a buffered block, an error, or nothing left to read.
+  bool CanConsumeUnlocked() const {
+    return !ready_.empty() || !status_.ok() ||
+        (runnable_.empty() && num_running_tasks_ == 0);
+  }
+
+  unique_ptr<Schema> schema_;
+  bool initted_;
+
+  vector<IterWithBounds> iters_;
+  ThreadPool* const pool_;
+  const int parallelism_;
+
+  // The copies of the scan spec, one per sub-iterator.
+  ObjectPool<ScanSpec> scan_spec_copies_;
+
+  // The buffered blocks, either free or read.
+  vector<unique_ptr<Buffer>> buffers_;
+
+  mutable Mutex lock_;
+  // Signaled when a task finishes.
+  mutable ConditionVariable cond_;
+
+  // Protected by 'lock_'.
+  //
+  // The indexes of the sub-iterators which have rows left and aren't being
+  // read from.
+  deque<size_t> runnable_;
+  // The blocks which can be read into.
+  vector<Buffer*> free_;
+  // The blocks read, in order. The front one is being consumed from
+  // 'next_row_idx_' onward.
+  deque<Buffer*> ready_;
+  size_t next_row_idx_;
+  // The tasks created and not finished yet.
+  int num_running_tasks_;
+  // The first error of a task, returned by NextBlock().
+  Status status_;
+  // Set when the iterator is destroyed: no task is created from then on.
+  bool stopping_;
+};
+
+ParallelUnionIterator::ParallelUnionIterator(vector<IterWithBounds> iters,
+                                             ThreadPool* pool,
+                                             int parallelism)
+    : initted_(false),
+      iters_(std::move(iters)),
+      pool_(DCHECK_NOTNULL(pool)),
+      parallelism_(parallelism),
+      cond_(&lock_),
+      next_row_idx_(0),
+      num_running_tasks_(0),
+      stopping_(false) {
+  CHECK_GT(iters_.size(), 0);
+  CHECK_GT(parallelism_, 0);
+}
+
+ParallelUnionIterator::~ParallelUnionIterator() {
+  MutexLock l(lock_);
+  stopping_ = true;
+  while (num_running_tasks_ > 0) {
+    cond_.Wait();
+  }
+}
+
+Status ParallelUnionIterator::Init(ScanSpec* spec) {
+  CHECK(!initted_);
+  for (auto& i : iters_) {
+    ScanSpec* spec_copy = spec != nullptr ? scan_spec_copies_.Construct(*spec) : nullptr;
+    RETURN_NOT_OK(InitAndMaybeWrap(&i.iter, spec_copy));
+    i.encoded_bounds.reset();
+  }
+  // Since we handle predicates in all the wrapped iterators, we can clear
+  // them here.
+  if (spec != nullptr) {
+    spec->RemovePredicates();
+  }
+
+  schema_.reset(new Schema(iters_.front().iter->schema()));
+#ifndef NDEBUG
+  for (const auto& i : iters_) {
+    if (i.iter->schema() != *schema_) {
+      return Status::InvalidArgument(
+          Substitute("Schemas do not match: $0 vs. $1",
+                     schema_->ToString(), i.iter->schema().ToString()));
+    }
+  }
+#endif
+  // Two blocks per task, so that a task may read a block while the previous
+  // one is being consumed.
+  for (int i = 0; i < 2 * parallelism_; i++) {
+    buffers_.emplace_back(new Buffer(schema_.get()));
+  }
+  initted_ = true;
+
+  ReadTasks tasks;
+  {
+    MutexLock l(lock_);
+    for (size_t i = 0; i < iters_.size(); i++) {
+      if (iters_[i].iter->HasNext()) {
+        runnable_.push_back(i);
+      }
+    }
+    for (const auto& buffer : buffers_) {
+      free_.push_back(buffer.get());
+    }
+    CreateTasksUnlocked(&tasks);
+  }
+  SubmitTasks(pool_, std::move(tasks));
+  return Status::OK();
+}
+
+void ParallelUnionIterator::CreateTasksUnlocked(ReadTasks* tasks) {
+  lock_.AssertAcquired();
+  while (!stopping_ && status_.ok() && num_running_tasks_ < parallelism_ &&
+         !runnable_.empty() && !free_.empty()) {
+    tasks->emplace_back(std::make_shared<ReadTask>(this, runnable_.front(), free_.back()));
+    runnable_.pop_front();
+    free_.pop_back();
+    num_running_tasks_++;
+  }
+}
+
+void ParallelUnionIterator::SubmitTasks(ThreadPool* pool, ReadTasks tasks) {
+  for (auto& task : tasks) {
+    // If the pool is shut down, the task is dropped and reports it.
+    WARN_NOT_OK(pool->Submit([task]() { task->Run(); }),
+                "could not read from the rowsets in parallel");
+    task.reset();
+  }
+}
+
+void ParallelUnionIterator::ReadBlock(size_t iter_idx, Buffer* buffer) {
+  RowwiseIterator* iter = iters_[iter_idx].iter.get();
+  buffer->memory.Reset();
+  buffer->block.Resize(kRowsPerBuffer);
+  Status s = iter->NextBlock(&buffer->block);
+  FinishTask(iter_idx, buffer, s, s.ok() && iter->HasNext());
+}
+
+void ParallelUnionIterator::FinishTask(size_t iter_idx, Buffer* buffer, const Status& s,
+                                       bool has_next) {
+  ThreadPool* pool = pool_;
+  ReadTasks tasks;
+  {
+    MutexLock l(lock_);
+    if (PREDICT_FALSE(!s.ok())) {
+      if (status_.ok()) {
+        status_ = s;
+      }
+      free_.push_back(buffer);
+    } else if (buffer->block.nrows() > 0) {
+      ready_.push_back(buffer);
+    } else {
+      free_.push_back(buffer);
+    }
+    if (has_next) {
+      runnable_.push_back(iter_idx);
+    }
+    // The tasks created here keep the iterator alive, and this one is done
+    // with it once the lock is released.
+    CreateTasksUnlocked(&tasks);
+    num_running_tasks_--;
+    cond_.Broadcast();
+  }
+  SubmitTasks(pool, std::move(tasks));
+}
+
+bool ParallelUnionIterator::HasNext() const {
+  CHECK(initted_);
+  MutexLock l(lock_);
+  while (!CanConsumeUnlocked()) {
+    cond_.Wait();
+  }
+  // An error is returned by the next call to NextBlock().
+  return !ready_.empty() || !status_.ok();
+}
+
+Status ParallelUnionIterator::NextBlock(RowBlock* dst) {
+  CHECK(initted_);
+  DCHECK_SCHEMA_EQ(*dst->schema(), schema());
+  if (dst->arena()) {
+    dst->arena()->Reset();
+  }
+
+  Buffer* buffer;
+  {
+    MutexLock l(lock_);
+    while (!CanConsumeUnlocked()) {
+      cond_.Wait();
+    }
+    RETURN_NOT_OK(status_);
+    if (ready_.empty()) {
+      dst->Resize(0);
+      return Status::OK();
+    }
+    // The tasks only append to 'ready_', so the front block may be copied
+    // from without the lock.
+    buffer = ready_.front();
+  }
+
+  const size_t num_rows = std::min(buffer->block.nrows() - next_row_idx_,
+                                   dst->row_capacity());
+  dst->Resize(num_rows);
+  RETURN_NOT_OK(buffer->block.CopyTo(dst, next_row_idx_, 0, num_rows));
+  next_row_idx_ += num_rows;
+
+  if (next_row_idx_ == buffer->block.nrows()) {
+    ReadTasks tasks;
+    {
+      MutexLock l(lock_);
+      ready_.pop_front();
+      free_.push_back(buffer);
+      next_row_idx_ = 0;
+      CreateTasksUnlocked(&tasks);
+    }
+    SubmitTasks(pool_, std::move(tasks));
+  }
+  return Status::OK();
+}
+
+string ParallelUnionIterator::ToString() const {
+  return Substitute("ParallelUnion($0)", JoinMapped(iters_, [](const IterWithBounds& i) {
+      return i.iter->ToString();
+    }, ","));
+}
+
+void ParallelUnionIterator::GetIteratorStats(vector<IteratorStats>* stats) const {
+  CHECK(initted_);
+  stats->clear();
+  stats->resize(schema_->num_columns());
+  for (const auto& i : iters_) {
+    AddIterStats(*i.iter, stats);
+  }
+}
+
+unique_ptr<RowwiseIterator> NewParallelUnionIterator(vector<IterWithBounds> iters,
+                                                     ThreadPool* pool,
+                                                     int parallelism) {
+  return unique_ptr<RowwiseIterator>(
+      new ParallelUnionIterator(std::move(iters), pool, parallelism));
+}
+
 ////////////////////////////////////////////////////////////
 // MaterializingIterator
 ////////////////////////////////////////////////////////////
@@ -1301,6 +1862,7 @@ Status MaterializingIterator::MaterializeBlock(RowBlock *dst) {
 
     RETURN_NOT_OK(iter_->MaterializeColumn(&ctx));
     if (ctx.DecoderEvalNotSupported() && !disableable_predicate_disabled) {
+      TRACE_COUNTER_SCOPE_LATENCY_NS(PREDICATE_EVAL_NANOS_METRIC_NAME);
       predicate.Evaluate(dst_col, dst->selection_vector());
     }
     if (disableable_predicate_enabled) {
@@ -1327,6 +1889,9 @@ Status MaterializingIterator::MaterializeBlock(RowBlock *dst) {
                                      nullptr,
                                      &dst_col,
                                      dst->selection_vector());
+    // The predicates are all evaluated, so the rows they filtered out are
+    // never read.
+    ctx.SetSelectedRowsOnly();
     RETURN_NOT_OK(iter_->MaterializeColumn(&ctx));
   }
 
@@ -1484,7 +2049,10 @@ Status PredicateEvaluatingIterator::NextBlock(RowBlock *dst) {
     auto num_rows_before = effectiveness_ctx ?
                            dst->selection_vector()->CountSelected() : 0;
 
-    predicate.Evaluate(dst->column_block(col_idx), dst->selection_vector());
+    {
+      TRACE_COUNTER_SCOPE_LATENCY_NS(PREDICATE_EVAL_NANOS_METRIC_NAME);
+      predicate.Evaluate(dst->column_block(col_idx), dst->selection_vector());
+    }
 
     if (effectiveness_ctx) {
       auto num_rows_rejected = num_rows_before - dst->selection_vector()->CountSelected();
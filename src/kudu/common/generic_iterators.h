@@ -29,6 +29,7 @@ namespace kudu {
 
 class ColumnPredicate;
 class ScanSpec;
+class ThreadPool;
 
 // Encapsulates a rowwise-iterator along with the (encoded) lower and upper
 // bounds for the rowset that the iterator belongs to.
@@ -62,6 +63,15 @@ std::unique_ptr<RowwiseIterator> NewMergeIterator(
 // The iterators must have matching schemas and should not yet be initialized.
 std::unique_ptr<RowwiseIterator> NewUnionIterator(std::vector<IterWithBounds> iters);
 
+// Constructs a union of the given iterators which reads from up to
+// 'parallelism' of them at once on 'pool'. The rows are returned in the order
+// they're read, rather than iterator after iterator.
+//
+// The iterators must have matching schemas and should not yet be initialized.
+std::unique_ptr<RowwiseIterator> NewParallelUnionIterator(std::vector<IterWithBounds> iters,
+                                                          ThreadPool* pool,
+                                                          int parallelism);
+
 // Constructs a MaterializingIterator of the given ColumnwiseIterator.
 std::unique_ptr<RowwiseIterator> NewMaterializingIterator(
     std::unique_ptr<ColumnwiseIterator> iter);
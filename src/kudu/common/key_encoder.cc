@@ -79,6 +79,11 @@ const KeyEncoder<Buffer>& GetKeyEncoder(const TypeInfo* typeinfo) {
 
 // Returns true if the type is allowed in keys.
 bool IsTypeAllowableInKey(const TypeInfo* typeinfo) {
+  // ARRAY cells are stored as BINARY, but don't sort as their elements would,
+  // and equal JSON documents may be written differently.
+  if (typeinfo->type() == ARRAY || typeinfo->type() == JSON) {
+    return false;
+  }
   return Singleton<EncoderResolver<faststring>>::get()->HasKeyEncoderForType(
       typeinfo->physical_type());
 }
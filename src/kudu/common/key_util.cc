@@ -248,6 +248,7 @@ int PushUpperBoundKeyPredicates(ColIdxIter first,
         break;
       case PredicateType::IsNotNull: // Fallthrough intended
       case PredicateType::IsNull:
+      case PredicateType::ArrayContains:
         break_loop = true;
         break;
       case PredicateType::InList:
@@ -311,6 +312,7 @@ int PushLowerBoundKeyPredicates(ColIdxIter first,
         break;
       case PredicateType::IsNotNull: // Fallthrough intended
       case PredicateType::IsNull:
+      case PredicateType::ArrayContains:
         break_loop = true;
         break;
       case PredicateType::InList:
@@ -24,6 +24,7 @@
 
 #include <glog/logging.h>
 
+#include "kudu/common/array_cell.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/key_encoder.h"
 #include "kudu/common/row.h"
@@ -35,6 +36,7 @@
 #include "kudu/util/char_util.h"
 #include "kudu/util/decimal_util.h"
 #include "kudu/util/int128.h"
+#include "kudu/util/json_path.h"
 #include "kudu/util/logging.h"
 #ifndef NDEBUG
 #include "kudu/util/memory/overwrite.h"
@@ -205,6 +207,14 @@ Status KuduPartialRow::Set(int32_t column_idx, const uint8_t* val) {
       RETURN_NOT_OK(SetVarchar(column_idx, *reinterpret_cast<const Slice*>(val)));
       break;
     }
+    case ARRAY: {
+      RETURN_NOT_OK(SetArray(column_idx, *reinterpret_cast<const Slice*>(val)));
+      break;
+    }
+    case JSON: {
+      RETURN_NOT_OK(SetJson(column_idx, *reinterpret_cast<const Slice*>(val)));
+      break;
+    }
     case UNIXTIME_MICROS: {
       RETURN_NOT_OK(SetUnixTimeMicros(column_idx, *reinterpret_cast<const int64_t*>(val)));
       break;
@@ -246,6 +256,12 @@ void KuduPartialRow::DeallocateStringIfSet(int col_idx, const ColumnSchema& col)
       case VARCHAR:
         dst = schema_->ExtractColumnFromRow<VARCHAR>(row, col_idx);
         break;
+      case ARRAY:
+        dst = schema_->ExtractColumnFromRow<ARRAY>(row, col_idx);
+        break;
+      case JSON:
+        dst = schema_->ExtractColumnFromRow<JSON>(row, col_idx);
+        break;
       case STRING:
         dst = schema_->ExtractColumnFromRow<STRING>(row, col_idx);
         break;
@@ -388,6 +404,36 @@ Status KuduPartialRow::SetVarchar(int col_idx, const Slice& val) {
   return SetSliceCopy<TypeTraits<VARCHAR> >(col_idx, val);
 }
 
+Status KuduPartialRow::SetArray(const Slice& col_name, const Slice& val) {
+  int col_idx;
+  RETURN_NOT_OK(schema_->FindColumn(col_name, &col_idx));
+  return SetArray(col_idx, val);
+}
+Status KuduPartialRow::SetArray(int col_idx, const Slice& val) {
+  const auto& col = schema_->column(col_idx);
+  // Mismatches of the column type are reported by Set().
+  if (col.type_info()->type() == ARRAY) {
+    RETURN_NOT_OK_PREPEND(ValidateArrayCell(val, col.type_attributes().element_type),
+                          Substitute("invalid value for column '$0'", col.name()));
+  }
+  return SetSliceCopy<TypeTraits<ARRAY> >(col_idx, val);
+}
+
+Status KuduPartialRow::SetJson(const Slice& col_name, const Slice& val) {
+  int col_idx;
+  RETURN_NOT_OK(schema_->FindColumn(col_name, &col_idx));
+  return SetJson(col_idx, val);
+}
+Status KuduPartialRow::SetJson(int col_idx, const Slice& val) {
+  const auto& col = schema_->column(col_idx);
+  // Mismatches of the column type are reported by Set().
+  if (col.type_info()->type() == JSON) {
+    RETURN_NOT_OK_PREPEND(ValidateJson(val),
+                          Substitute("invalid value for column '$0'", col.name()));
+  }
+  return SetSliceCopy<TypeTraits<JSON> >(col_idx, val);
+}
+
 Status KuduPartialRow::SetBinaryCopy(const Slice& col_name, const Slice& val) {
   return SetSliceCopy<TypeTraits<BINARY> >(col_name, val);
 }
@@ -447,6 +493,8 @@ Status KuduPartialRow::SetSliceCopy(int col_idx, const Slice& val) {
       break;
     case STRING:
     case BINARY:
+    case ARRAY:
+    case JSON:
       auto relocated = new uint8_t[val.size()];
       memcpy(relocated, val.data(), val.size());
       relocated_val = Slice(relocated, val.size());
@@ -750,6 +798,16 @@ Status KuduPartialRow::GetVarchar(const Slice& col_name, Slice* val) const {
   RETURN_NOT_OK(schema_->FindColumn(col_name, &col_idx));
   return GetVarchar(col_idx, val);
 }
+Status KuduPartialRow::GetArray(const Slice& col_name, Slice* val) const {
+  int col_idx;
+  RETURN_NOT_OK(schema_->FindColumn(col_name, &col_idx));
+  return GetArray(col_idx, val);
+}
+Status KuduPartialRow::GetJson(const Slice& col_name, Slice* val) const {
+  int col_idx;
+  RETURN_NOT_OK(schema_->FindColumn(col_name, &col_idx));
+  return GetJson(col_idx, val);
+}
 
 Status KuduPartialRow::GetBool(int col_idx, bool* val) const {
   return Get<TypeTraits<BOOL> >(col_idx, val);
@@ -819,6 +877,12 @@ Status KuduPartialRow::GetBinary(int col_idx, Slice* val) const {
 Status KuduPartialRow::GetVarchar(int col_idx, Slice* val) const {
   return Get<TypeTraits<VARCHAR> >(col_idx, val);
 }
+Status KuduPartialRow::GetArray(int col_idx, Slice* val) const {
+  return Get<TypeTraits<ARRAY> >(col_idx, val);
+}
+Status KuduPartialRow::GetJson(int col_idx, Slice* val) const {
+  return Get<TypeTraits<JSON> >(col_idx, val);
+}
 
 template<typename T>
 Status KuduPartialRow::Get(const Slice& col_name,
@@ -244,6 +244,48 @@ class KUDU_EXPORT KuduPartialRow {
   /// @return Operation result status.
   Status SetVarchar(int col_idx, const Slice& val) WARN_UNUSED_RESULT;
 
+  /// @name Setters for ARRAY columns (copying).
+  ///@{
+
+  /// Set the value of an ARRAY column, copying the specified data immediately.
+  ///
+  /// @param [in] col_name
+  ///   Name of the target column.
+  /// @param [in] val
+  ///   The array, encoded with KuduArrayCellBuilder. The element type of the
+  ///   array must match that of the column.
+  /// @return Operation result status.
+  Status SetArray(const Slice& col_name, const Slice& val) WARN_UNUSED_RESULT;
+
+  /// @param [in] col_idx
+  ///   The index of the target column.
+  /// @param [in] val
+  ///   The array, encoded with KuduArrayCellBuilder.
+  /// @return Operation result status.
+  Status SetArray(int col_idx, const Slice& val) WARN_UNUSED_RESULT;
+  ///@}
+
+  /// @name Setters for JSON columns (copying).
+  ///@{
+
+  /// Set the value of a JSON column, copying the specified data immediately.
+  ///
+  /// @param [in] col_name
+  ///   Name of the target column.
+  /// @param [in] val
+  ///   The UTF-8 text of the JSON document.
+  /// @return Operation result status. Returns Status::Corruption if the
+  ///   value is not a valid JSON document.
+  Status SetJson(const Slice& col_name, const Slice& val) WARN_UNUSED_RESULT;
+
+  /// @param [in] col_idx
+  ///   The index of the target column.
+  /// @param [in] val
+  ///   The UTF-8 text of the JSON document.
+  /// @return Operation result status.
+  Status SetJson(int col_idx, const Slice& val) WARN_UNUSED_RESULT;
+  ///@}
+
   /// @name Setters for binary/string columns by name (copying).
   ///@{
 
@@ -597,6 +639,49 @@ class KUDU_EXPORT KuduPartialRow {
   Status GetVarchar(int col_idx, Slice* val) const WARN_UNUSED_RESULT;
   ///@}
 
+  /// @name Getters for ARRAY columns.
+  ///@{
+
+  /// Get the encoded value of an ARRAY column, which can be read with
+  /// KuduArrayCellView.
+  ///
+  /// @param [in] col_name
+  ///   Name of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  ///   Note that the method does not copy the value.
+  /// @return Operation result status.
+  Status GetArray(const Slice& col_name, Slice* val) const WARN_UNUSED_RESULT;
+
+  /// @param [in] col_idx
+  ///   The index of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  /// @return Operation result status.
+  Status GetArray(int col_idx, Slice* val) const WARN_UNUSED_RESULT;
+  ///@}
+
+  /// @name Getters for JSON columns.
+  ///@{
+
+  /// Get the UTF-8 text of the JSON document in a JSON column.
+  ///
+  /// @param [in] col_name
+  ///   Name of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  ///   Note that the method does not copy the value.
+  /// @return Operation result status.
+  Status GetJson(const Slice& col_name, Slice* val) const WARN_UNUSED_RESULT;
+
+  /// @param [in] col_idx
+  ///   The index of the column.
+  /// @param [out] val
+  ///   Pointer to the placeholder to put the resulting value.
+  /// @return Operation result status.
+  Status GetJson(int col_idx, Slice* val) const WARN_UNUSED_RESULT;
+  ///@}
+
   //------------------------------------------------------------
   // Key-encoding related functions
   //------------------------------------------------------------
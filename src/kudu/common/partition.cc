@@ -420,18 +420,16 @@ void PartitionSchema::EncodeKeyImpl(const Row& row,
                                     string* hash_buf) const {
   DCHECK(range_buf);
   DCHECK(hash_buf);
-  string range_key;
-  EncodeColumns(row, range_schema_.column_ids, &range_key);
+  range_buf->clear();
+  EncodeColumns(row, range_schema_.column_ids, range_buf);
 
-  const auto& hash_schema = GetHashSchemaForRange(range_key);
+  const auto& hash_schema = GetHashSchemaForRange(*range_buf);
   const auto& hash_encoder = GetKeyEncoder<string>(GetTypeInfo(UINT32));
-  string hash_key;
+  hash_buf->clear();
   for (const auto& hash_dimension : hash_schema) {
     const auto bucket = HashValueForRow(row, hash_dimension);
-    hash_encoder.Encode(&bucket, &hash_key);
+    hash_encoder.Encode(&bucket, hash_buf);
   }
-  *range_buf = std::move(range_key);
-  *hash_buf = std::move(hash_key);
 }
 
 PartitionKey PartitionSchema::EncodeKey(const KuduPartialRow& row) const {
@@ -448,6 +446,10 @@ PartitionKey PartitionSchema::EncodeKey(const ConstContiguousRow& row) const {
   return PartitionKey(std::move(encoded_hash), std::move(encoded_range));
 }
 
+void PartitionSchema::EncodeKey(const KuduPartialRow& row, PartitionKey* key) const {
+  EncodeKeyImpl(row, key->mutable_range_key(), key->mutable_hash_key());
+}
+
 Status PartitionSchema::EncodeRangeKey(const KuduPartialRow& row,
                                        const Schema& schema,
                                        string* key) const {
@@ -349,6 +349,10 @@ class PartitionSchema {
   PartitionKey EncodeKey(const KuduPartialRow& row) const;
   PartitionKey EncodeKey(const ConstContiguousRow& row) const;
 
+  // Same as above, but encodes the partition key into 'key', reusing its
+  // memory: useful to encode the keys of many rows in turn.
+  void EncodeKey(const KuduPartialRow& row, PartitionKey* key) const;
+
   // Creates the set of table partitions for a partition schema and collection
   // of split rows and split bounds.
   //
@@ -612,7 +616,8 @@ class PartitionSchema {
   bool RangePartitionContainsRowImpl(const Partition& partition,
                                      const Row& row) const;
 
-  // Private templated helper for EncodeKey.
+  // Private templated helper for EncodeKey. Overwrites the contents of
+  // 'range_buf' and 'hash_buf'.
   template<typename Row>
   void EncodeKeyImpl(const Row& row,
                      std::string* range_buf,
@@ -28,6 +28,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -51,6 +52,8 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+DECLARE_uint32(partition_pruner_max_enumerated_values);
+
 using std::count_if;
 using std::get;
 using std::make_tuple;
@@ -1258,6 +1261,87 @@ TEST_F(PartitionPrunerTest, TestKudu2173) {
                   2));
 }
 
+TEST_F(PartitionPrunerTest, TestInListRangePruning) {
+  // CREATE TABLE t
+  // (a INT8, b INT8, PRIMARY KEY (a, b))
+  // PARTITION BY RANGE (a) SPLIT ROWS [(10), (20), (30)]
+  //              HASH (b) INTO 3 BUCKETS;
+  Schema schema({ ColumnSchema("a", INT8),
+                  ColumnSchema("b", INT8) },
+                { ColumnId(0), ColumnId(1) },
+                2);
+
+  PartitionSchemaPB pb;
+  CreatePartitionSchemaPB({"a"}, { {{"b"}, 3, 0} }, &pb);
+  PartitionSchema partition_schema;
+  ASSERT_OK(PartitionSchema::FromPB(pb, schema, &partition_schema));
+
+  vector<KuduPartialRow> splits;
+  for (int8_t split : { 10, 20, 30 }) {
+    splits.emplace_back(&schema);
+    ASSERT_OK(splits.back().SetInt8("a", split));
+  }
+  vector<Partition> partitions;
+  ASSERT_OK(partition_schema.CreatePartitions(splits, {}, schema, &partitions));
+  ASSERT_EQ(12, partitions.size());
+
+  // Applies the specified predicates to a scan and checks that the expected
+  // number of partitions are pruned.
+  const auto check = [&] (const vector<ColumnPredicate>& predicates,
+                          size_t remaining_tablets,
+                          size_t pruner_ranges) {
+    ScanSpec spec;
+    for (const auto& pred : predicates) {
+      spec.AddPredicate(pred);
+    }
+    CheckPrunedPartitions(schema, partition_schema, partitions, spec,
+                          remaining_tablets, pruner_ranges);
+  };
+
+  constexpr int8_t zero = 0;
+  constexpr int8_t five = 5;
+  constexpr int8_t twenty = 20;
+  constexpr int8_t twenty_five = 25;
+  vector<const void*> a_values = { &five, &twenty_five };
+
+  // a IN (5, 25): the range partition in between is pruned.
+  NO_FATALS(check({ ColumnPredicate::InList(schema.column(0), &a_values) },
+                  6, 6));
+
+  // a IN (5, 25)
+  // b = 0
+  NO_FATALS(check({ ColumnPredicate::InList(schema.column(0), &a_values),
+                    ColumnPredicate::Equality(schema.column(1), &zero) },
+                  2, 2));
+
+  // a IN (5, 25)
+  // a < 20
+  NO_FATALS(check({ ColumnPredicate::InList(schema.column(0), &a_values),
+                    ColumnPredicate::Range(schema.column(0), nullptr, &twenty) },
+                  3, 3));
+
+  // Beyond the maximum number of values, the pruner falls back to the range
+  // between the smallest and the largest value.
+  FLAGS_partition_pruner_max_enumerated_values = 1;
+
+  // a IN (5, 25)
+  NO_FATALS(check({ ColumnPredicate::InList(schema.column(0), &a_values) },
+                  9, 3));
+
+  // a IN (5, 25)
+  // b = 0
+  NO_FATALS(check({ ColumnPredicate::InList(schema.column(0), &a_values),
+                    ColumnPredicate::Equality(schema.column(1), &zero) },
+                  3, 1));
+
+  // a IN (5, 25)
+  // b IN (0, 5): the hash dimension isn't pruned either.
+  vector<const void*> b_values = { &zero, &five };
+  NO_FATALS(check({ ColumnPredicate::InList(schema.column(0), &a_values),
+                    ColumnPredicate::InList(schema.column(1), &b_values) },
+                  9, 3));
+}
+
 // TODO(aserbin): re-enable this scenario once varying hash dimensions per range
 //                are supported
 TEST_F(PartitionPrunerTest, DISABLED_TestHashSchemasPerRangePruning) {
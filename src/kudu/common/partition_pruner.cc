@@ -27,6 +27,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/common/column_predicate.h"
@@ -43,9 +44,20 @@
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/array_view.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/slice.h"
 
+DEFINE_uint32(partition_pruner_max_enumerated_values, 1024,
+              "The maximum number of combinations of the values of the in-list "
+              "predicates on the columns of a hash dimension, and of the values "
+              "of an in-list predicate on the range column, the partition pruner "
+              "enumerates to prune partitions. Beyond that, the hash dimension "
+              "or the range column is pruned as if it were constrained by a "
+              "range, which is cheaper to compute but may scan more tablets.");
+TAG_FLAG(partition_pruner_max_enumerated_values, advanced);
+TAG_FLAG(partition_pruner_max_enumerated_values, runtime);
+
 using std::distance;
 using std::find;
 using std::iota;
@@ -266,8 +278,10 @@ vector<PartitionPruner::PartitionKeyRange> PartitionPruner::ConstructPartitionKe
   // The list of hash buckets bitset per hash component
   vector<vector<bool>> hash_bucket_bitsets;
   hash_bucket_bitsets.reserve(hash_schema.size());
+  const uint64_t max_combinations = FLAGS_partition_pruner_max_enumerated_values;
   for (const auto& hash_dimension : hash_schema) {
     bool can_prune = true;
+    uint64_t num_combinations = 1;
     for (const auto& column_id : hash_dimension.column_ids) {
       const ColumnSchema& column = schema.column_by_id(column_id);
       const ColumnPredicate* predicate = FindOrNull(scan_spec.predicates(), column.name());
@@ -277,6 +291,16 @@ vector<PartitionPruner::PartitionKeyRange> PartitionPruner::ConstructPartitionKe
         can_prune = false;
         break;
       }
+      // Enumerating the combinations of the values of the columns costs as
+      // much as their product: give up on pruning this dimension rather than
+      // spend more time computing the buckets than scanning them.
+      if (predicate->predicate_type() == PredicateType::InList) {
+        num_combinations *= predicate->raw_values().size();
+        if (num_combinations > max_combinations) {
+          can_prune = false;
+          break;
+        }
+      }
     }
     if (can_prune) {
       auto hash_bucket_bitset = PruneHashComponent(
@@ -364,6 +388,43 @@ vector<PartitionPruner::PartitionKeyRange> PartitionPruner::ConstructPartitionKe
   return partition_key_ranges;
 }
 
+bool PartitionPruner::SplitRangeBoundsByValues(const Schema& schema,
+                                               const ScanSpec& scan_spec,
+                                               const vector<ColumnId>& range_columns,
+                                               const RangeBounds& scan_range,
+                                               vector<RangeBounds>* ranges) {
+  DCHECK(ranges);
+  DCHECK(ranges->empty());
+  if (range_columns.size() != 1) {
+    return false;
+  }
+  const ColumnSchema& column = schema.column_by_id(range_columns[0]);
+  const ColumnPredicate* predicate = FindOrNull(scan_spec.predicates(), column.name());
+  if (predicate == nullptr ||
+      predicate->predicate_type() != PredicateType::InList ||
+      predicate->raw_values().size() > FLAGS_partition_pruner_max_enumerated_values) {
+    return false;
+  }
+
+  // The values of an in-list predicate are sorted and unique, and so are
+  // their encoded keys. Since the key of the only range column is encoded as
+  // the last column, the smallest key after 'key' is 'key' followed by a nul
+  // character.
+  const KeyEncoder<string>& encoder = GetKeyEncoder<string>(column.type_info());
+  for (const void* value : predicate->raw_values()) {
+    string lower;
+    encoder.Encode(value, /*is_last=*/true, &lower);
+    if ((!scan_range.lower.empty() && lower < scan_range.lower) ||
+        (!scan_range.upper.empty() && lower >= scan_range.upper)) {
+      continue;
+    }
+    string upper = lower;
+    upper.push_back('\0');
+    ranges->emplace_back(RangeBounds{ std::move(lower), std::move(upper) });
+  }
+  return true;
+}
+
 // NOTE: the lower ranges are inclusive, the upper ranges are exclusive.
 void PartitionPruner::PrepareRangeSet(
     const string& scan_lower_bound,
@@ -551,6 +612,11 @@ void PartitionPruner::Init(const Schema& schema,
   //    Until this becomes a problem in practice, we'll continue always pruning,
   //    since it is precisely these highly-hash-partitioned tables which get the
   //    most benefit from pruning.
+  //
+  // 4) If the only range column is constrained by an in-list predicate, a set
+  //    of partition key ranges is built for each of its values, rather than
+  //    for the range between the smallest and the largest ones, so that the
+  //    range partitions between the values are pruned as well.
 
   // Build the range portion of the partition key by using
   // the lower and upper bounds specified by the scan.
@@ -573,35 +639,46 @@ void PartitionPruner::Init(const Schema& schema,
     }
   }
 
-  if (partition_schema.ranges_with_custom_hash_schemas().empty()) {
+  vector<RangeBounds> scan_ranges;
+  if (!SplitRangeBoundsByValues(schema, scan_spec, range_columns,
+                                {scan_range_lower_bound, scan_range_upper_bound},
+                                &scan_ranges)) {
+    scan_ranges.push_back({ std::move(scan_range_lower_bound),
+                            std::move(scan_range_upper_bound) });
+  }
+
+  if (partition_schema.ranges_with_custom_hash_schemas().empty() &&
+      scan_ranges.size() == 1) {
     auto partition_key_ranges = ConstructPartitionKeyRanges(
-        schema, scan_spec, partition_schema.hash_schema_,
-        {scan_range_lower_bound, scan_range_upper_bound});
+        schema, scan_spec, partition_schema.hash_schema_, scan_ranges.front());
     partition_key_ranges_.resize(partition_key_ranges.size());
     move(partition_key_ranges.rbegin(), partition_key_ranges.rend(),
          partition_key_ranges_.begin());
   } else {
-    // Build the preliminary set of ranges: that's to convey information on
-    // range-specific hash schemas since some ranges in the table can have
-    // custom (i.e. different from the table-wide) hash schemas.
-    PartitionSchema::RangesWithHashSchemas preliminary_ranges;
-    PartitionPruner::PrepareRangeSet(
-        scan_range_lower_bound,
-        scan_range_upper_bound,
-        partition_schema.hash_schema(),
-        partition_schema.ranges_with_custom_hash_schemas(),
-        &preliminary_ranges);
-
-    // Construct partition key ranges from the ranges and their respective hash
-    // schemas that falls within the scan's bounds.
-    for (size_t i = 0; i < preliminary_ranges.size(); ++i) {
-      const auto& hash_schema = preliminary_ranges[i].hash_schema;
-      RangeBounds range_bounds {preliminary_ranges[i].lower, preliminary_ranges[i].upper};
-      auto partition_key_ranges = ConstructPartitionKeyRanges(
-          schema, scan_spec, hash_schema, range_bounds);
-      partition_key_ranges_.resize(partition_key_ranges_.size() + partition_key_ranges.size());
-      move(partition_key_ranges.begin(), partition_key_ranges.end(),
-           partition_key_ranges_.rbegin());
+    for (const auto& scan_range : scan_ranges) {
+      // Build the preliminary set of ranges: that's to convey information on
+      // range-specific hash schemas since some ranges in the table can have
+      // custom (i.e. different from the table-wide) hash schemas.
+      PartitionSchema::RangesWithHashSchemas preliminary_ranges;
+      PartitionPruner::PrepareRangeSet(
+          scan_range.lower,
+          scan_range.upper,
+          partition_schema.hash_schema(),
+          partition_schema.ranges_with_custom_hash_schemas(),
+          &preliminary_ranges);
+
+      // Construct partition key ranges from the ranges and their respective
+      // hash schemas that falls within the scan's bounds.
+      for (size_t i = 0; i < preliminary_ranges.size(); ++i) {
+        const auto& hash_schema = preliminary_ranges[i].hash_schema;
+        RangeBounds range_bounds {preliminary_ranges[i].lower, preliminary_ranges[i].upper};
+        auto partition_key_ranges = ConstructPartitionKeyRanges(
+            schema, scan_spec, hash_schema, range_bounds);
+        partition_key_ranges_.resize(
+            partition_key_ranges_.size() + partition_key_ranges.size());
+        move(partition_key_ranges.begin(), partition_key_ranges.end(),
+             partition_key_ranges_.rbegin());
+      }
     }
     // Reverse the order of the partition key ranges, so that it is efficient
     // to remove the partition key ranges from the vector in ascending order.
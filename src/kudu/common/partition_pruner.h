@@ -99,6 +99,17 @@ class PartitionPruner {
                                  std::vector<const void*>* predicate_values_selected,
                                  std::vector<bool>* hash_bucket_bitset);
 
+  // If the range schema has a single column constrained by an in-list
+  // predicate, splits 'scan_range' into the point ranges of the predicate's
+  // values which fall within it, and returns true. Otherwise, or if that would
+  // be more than --partition_pruner_max_enumerated_values ranges, returns
+  // false, leaving 'ranges' empty.
+  static bool SplitRangeBoundsByValues(const Schema& schema,
+                                       const ScanSpec& scan_spec,
+                                       const std::vector<ColumnId>& range_columns,
+                                       const RangeBounds& scan_range,
+                                       std::vector<RangeBounds>* ranges);
+
   // Given the range bounds and the hash schema, constructs a set of partition
   // key ranges.
   static std::vector<PartitionKeyRange> ConstructPartitionKeyRanges(
@@ -120,6 +120,42 @@ TEST_F(TestRowChangeList, TestEncodeDecodeUpdates) {
             RowChangeList(Slice(buf)).ToString(Schema()));
 }
 
+TEST_F(TestRowChangeList, TestMergeUpdates) {
+  faststring older_buf;
+  RowChangeListEncoder older(&older_buf);
+  Slice older1("older1");
+  uint32_t older3 = 1;
+  older.AddColumnUpdate(schema_.column(0), schema_.column_id(0), &older1);
+  older.AddColumnUpdate(schema_.column(2), schema_.column_id(2), &older3);
+
+  faststring newer_buf;
+  RowChangeListEncoder newer(&newer_buf);
+  Slice newer2("newer2");
+  uint32_t newer3 = 2;
+  newer.AddColumnUpdate(schema_.column(1), schema_.column_id(1), &newer2);
+  newer.AddColumnUpdate(schema_.column(2), schema_.column_id(2), &newer3);
+  newer.AddColumnUpdate(schema_.column(3), schema_.column_id(3), nullptr);
+
+  faststring buf;
+  RowChangeListEncoder merged(&buf);
+  ASSERT_OK(RowChangeListDecoder::MergeUpdates(RowChangeList(older_buf),
+                                               RowChangeList(newer_buf),
+                                               &merged));
+  EXPECT_EQ(R"(SET col1="older1", col2="newer2", col3=2, col4=NULL)",
+            merged.as_changelist().ToString(schema_));
+
+  // Only updates can be merged.
+  faststring delete_buf;
+  RowChangeListEncoder del(&delete_buf);
+  del.SetToDelete();
+  faststring invalid_buf;
+  RowChangeListEncoder invalid(&invalid_buf);
+  Status s = RowChangeListDecoder::MergeUpdates(RowChangeList(older_buf),
+                                                RowChangeList(delete_buf),
+                                                &invalid);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+}
+
 TEST_F(TestRowChangeList, TestDeletes) {
   faststring buf;
   RowChangeListEncoder rcl(&buf);
@@ -20,6 +20,7 @@
 #include <cstring>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "kudu/common/common.pb.h"
 #include "kudu/common/columnblock.h"
@@ -317,6 +318,40 @@ Status RowChangeListDecoder::RemoveColumnIdsFromChangeList(const RowChangeList&
   return Status::OK();
 }
 
+Status RowChangeListDecoder::MergeUpdates(const RowChangeList& older,
+                                          const RowChangeList& newer,
+                                          RowChangeListEncoder* out) {
+  RowChangeListDecoder newer_decoder(newer);
+  RETURN_NOT_OK(newer_decoder.Init());
+  if (PREDICT_FALSE(!newer_decoder.is_update())) {
+    return Status::InvalidArgument("can only merge updates", newer.ToString(Schema()));
+  }
+  std::vector<DecodedUpdate> newer_updates;
+  while (newer_decoder.HasNext()) {
+    newer_updates.emplace_back();
+    RETURN_NOT_OK(newer_decoder.DecodeNext(&newer_updates.back()));
+  }
+
+  RowChangeListDecoder older_decoder(older);
+  RETURN_NOT_OK(older_decoder.Init());
+  if (PREDICT_FALSE(!older_decoder.is_update())) {
+    return Status::InvalidArgument("can only merge updates", older.ToString(Schema()));
+  }
+  out->SetToUpdate();
+  while (older_decoder.HasNext()) {
+    DecodedUpdate dec;
+    RETURN_NOT_OK(older_decoder.DecodeNext(&dec));
+    if (std::none_of(newer_updates.begin(), newer_updates.end(),
+                     [&](const DecodedUpdate& u) { return u.col_id == dec.col_id; })) {
+      out->EncodeColumnMutationRaw(dec.col_id, dec.null, dec.raw_value);
+    }
+  }
+  for (const auto& dec : newer_updates) {
+    out->EncodeColumnMutationRaw(dec.col_id, dec.null, dec.raw_value);
+  }
+  return Status::OK();
+}
+
 Status RowChangeListDecoder::DecodeNext(DecodedUpdate* dec) {
   DCHECK_NE(type_, RowChangeList::kUninitialized) << "Must call Init()";
   // Decode the column id.
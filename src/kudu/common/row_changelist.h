@@ -384,6 +384,15 @@ class RowChangeListDecoder {
                                               const std::vector<ColumnId>& column_ids,
                                               RowChangeListEncoder* out);
 
+  // Encodes into 'out' the UPDATE which has the same effect as applying the
+  // UPDATE 'older' and then the UPDATE 'newer': the columns updated by both
+  // are set to their values in 'newer'.
+  // 'out' must be valid for the duration of this method, but not have been
+  // previously initialized.
+  static Status MergeUpdates(const RowChangeList& older,
+                             const RowChangeList& newer,
+                             RowChangeListEncoder* out);
+
   struct DecodedUpdate {
     // The updated column ID.
     ColumnId col_id;
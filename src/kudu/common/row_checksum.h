@@ -0,0 +1,53 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/faststring.h"
+
+namespace kudu {
+
+class RowBlockRow;
+class Schema;
+
+namespace crc {
+class Crc;
+} // namespace crc
+
+// Computes the CRC32C of rows as the checksum scans of the tablet servers do:
+// every cell in 'projection' order is prefixed with its index in the projection
+// and, if nullable, whether it's set. The checksum of a set of rows is the sum
+// of the CRCs of its rows, so that it doesn't depend on their order and the
+// checksums of disjoint sets of rows add up.
+class RowChecksummer {
+ public:
+  RowChecksummer();
+
+  // Returns the CRC32C of the cells of the first projection.num_columns()
+  // columns of 'row', which must have the types of the columns of 'projection'.
+  uint32_t RowCrc32(const Schema& projection, const RowBlockRow& row);
+
+ private:
+  crc::Crc* const crc_;
+  faststring tmp_buf_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowChecksummer);
+};
+
+} // namespace kudu
@@ -1032,4 +1032,45 @@ TEST_F(RowOperationsTest, SchemasDoNotMatch) {
   ASSERT_FALSE(BitmapTest(ops[0].isset_bitmap, 2));
 }
 
+// Rows with every column set to a non-null value are decoded at once when the
+// client and tablet schemas have the same layout. Check they decode the same
+// as the other rows, within the same batch.
+TEST_F(RowOperationsTest, DecodeFullRows) {
+  Schema client_schema({ ColumnSchema("key", INT32),
+                         ColumnSchema("int_val", INT32),
+                         ColumnSchema("string_val", STRING, true) },
+                       1);
+  RowOperationsPB pb;
+  RowOperationsPBEncoder enc(&pb);
+  for (int i = 0; i < 4; i++) {
+    KuduPartialRow row(&client_schema);
+    ASSERT_OK(row.SetInt32("key", i));
+    ASSERT_OK(row.SetInt32("int_val", i * 10));
+    if (i == 1) {
+      ASSERT_OK(row.SetNull("string_val"));
+    } else if (i != 2) {
+      ASSERT_OK(row.SetStringCopy("string_val", Substitute("val$0", i)));
+    }
+    enc.Add(RowOperationsPB::INSERT, row);
+  }
+
+  arena_.Reset();
+  RowOperationsPBDecoder decoder(&pb, &client_schema, &schema_, &arena_);
+  vector<DecodedRowOperation> ops;
+  ASSERT_OK(decoder.DecodeOperations<DecoderMode::WRITE_OPS>(&ops));
+  ASSERT_EQ(4, ops.size());
+  EXPECT_EQ(R"(INSERT (int32 key=0, int32 int_val=0, string string_val="val0"))",
+            ops[0].ToString(schema_));
+  EXPECT_EQ("INSERT (int32 key=1, int32 int_val=10, string string_val=NULL)",
+            ops[1].ToString(schema_));
+  EXPECT_EQ("INSERT (int32 key=2, int32 int_val=20, string string_val=NULL)",
+            ops[2].ToString(schema_));
+  EXPECT_EQ(R"(INSERT (int32 key=3, int32 int_val=30, string string_val="val3"))",
+            ops[3].ToString(schema_));
+  for (int col_idx = 0; col_idx < 3; col_idx++) {
+    ASSERT_TRUE(BitmapTest(ops[0].isset_bitmap, col_idx));
+  }
+  ASSERT_FALSE(BitmapTest(ops[2].isset_bitmap, 2));
+}
+
 } // namespace kudu
@@ -26,6 +26,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/common/array_cell.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/partial_row.h"
 #include "kudu/common/row.h"
@@ -37,6 +38,7 @@
 #include "kudu/util/bitmap.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/json_path.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/safe_math.h"
@@ -220,7 +222,8 @@ RowOperationsPBDecoder::RowOperationsPBDecoder(const RowOperationsPB* pb,
     dst_arena_(dst_arena),
     bm_size_(BitmapSize(client_schema_->num_columns())),
     tablet_row_size_(ContiguousRowHelper::row_size(*tablet_schema_)),
-    src_(pb->rows().data(), pb->rows().size()) {
+    src_(pb->rows().data(), pb->rows().size()),
+    same_row_layout_(false) {
 }
 
 RowOperationsPBDecoder::~RowOperationsPBDecoder() {
@@ -267,26 +270,7 @@ Status RowOperationsPBDecoder::GetColumnSlice(const ColumnSchema& col,
   }
   // Find the data
   if (col.type_info()->physical_type() == BINARY) {
-    // The Slice in the protobuf has a pointer relative to the indirect data,
-    // not a real pointer. Need to fix that.
-    auto ptr_slice = reinterpret_cast<const Slice*>(src_.data());
-    auto offset_in_indirect = reinterpret_cast<uintptr_t>(ptr_slice->data());
-    bool overflowed = false;
-    size_t max_offset = AddWithOverflowCheck(offset_in_indirect, ptr_slice->size(), &overflowed);
-    if (PREDICT_FALSE(overflowed || max_offset > pb_->indirect_data().size())) {
-      return Status::Corruption("Bad indirect slice");
-    }
-
-    // Check that no individual cell is larger than the specified max.
-    if (PREDICT_FALSE(row_status && ptr_slice->size() > FLAGS_max_cell_size_bytes)) {
-      *row_status = Status::InvalidArgument(Substitute(
-          "value too large for column '$0' ($1 bytes, maximum is $2 bytes)",
-          col.name(), ptr_slice->size(), FLAGS_max_cell_size_bytes));
-      // After one row's column size has been found to exceed the limit and has been recorded
-      // in 'row_status', we will consider it OK and continue to consume data in order to properly
-      // validate subsequent columns and rows.
-    }
-    *slice = Slice(&pb_->indirect_data()[offset_in_indirect], ptr_slice->size());
+    RETURN_NOT_OK(GetIndirectSlice(col, src_.data(), slice, row_status));
   } else {
     *slice = Slice(src_.data(), size);
   }
@@ -294,6 +278,50 @@ Status RowOperationsPBDecoder::GetColumnSlice(const ColumnSchema& col,
   return Status::OK();
 }
 
+Status RowOperationsPBDecoder::GetIndirectSlice(const ColumnSchema& col,
+                                                const uint8_t* cell,
+                                                Slice* slice,
+                                                Status* row_status) {
+  // The Slice in the protobuf has a pointer relative to the indirect data,
+  // not a real pointer. Need to fix that.
+  auto ptr_slice = reinterpret_cast<const Slice*>(cell);
+  auto offset_in_indirect = reinterpret_cast<uintptr_t>(ptr_slice->data());
+  bool overflowed = false;
+  size_t max_offset = AddWithOverflowCheck(offset_in_indirect, ptr_slice->size(), &overflowed);
+  if (PREDICT_FALSE(overflowed || max_offset > pb_->indirect_data().size())) {
+    return Status::Corruption("Bad indirect slice");
+  }
+
+  // Check that no individual cell is larger than the specified max.
+  if (PREDICT_FALSE(row_status && ptr_slice->size() > FLAGS_max_cell_size_bytes)) {
+    *row_status = Status::InvalidArgument(Substitute(
+        "value too large for column '$0' ($1 bytes, maximum is $2 bytes)",
+        col.name(), ptr_slice->size(), FLAGS_max_cell_size_bytes));
+    // After one row's column size has been found to exceed the limit and has been recorded
+    // in 'row_status', we will consider it OK and continue to consume data in order to properly
+    // validate subsequent columns and rows.
+  }
+  *slice = Slice(&pb_->indirect_data()[offset_in_indirect], ptr_slice->size());
+
+  // Check that ARRAY cells are well-formed, since the tablet servers parse
+  // them to evaluate predicates. As above, the data is consumed regardless.
+  if (row_status && row_status->ok() && col.type_info()->type() == ARRAY) {
+    Status s = ValidateArrayCell(*slice, col.type_attributes().element_type);
+    if (PREDICT_FALSE(!s.ok())) {
+      *row_status = s.CloneAndPrepend(Substitute("invalid value for column '$0'", col.name()));
+    }
+  }
+  // Likewise for the documents of JSON columns, which scans may extract
+  // paths from.
+  if (row_status && row_status->ok() && col.type_info()->type() == JSON) {
+    Status s = ValidateJson(*slice);
+    if (PREDICT_FALSE(!s.ok())) {
+      *row_status = s.CloneAndPrepend(Substitute("invalid value for column '$0'", col.name()));
+    }
+  }
+  return Status::OK();
+}
+
 Status RowOperationsPBDecoder::ReadColumn(const ColumnSchema& col,
                                           uint8_t* dst,
                                           Status* row_status) {
@@ -439,6 +467,18 @@ Status RowOperationsPBDecoder::DecodeInsertOrUpsert(const uint8_t* prototype_row
   if (PREDICT_FALSE(!tablet_row_storage || !tablet_isset_bitmap)) {
     return Status::RuntimeError("Out of memory");
   }
+
+  // Most writes set every column of the rows, none to null: such rows need
+  // neither the defaults nor the per-column projection. The bitmaps are
+  // checked a word at a time.
+  const size_t num_columns = client_schema_->num_columns();
+  if (same_row_layout_ &&
+      BitmapIsAllSet(client_isset_map, 0, num_columns) &&
+      (!client_null_map || BitmapIsAllZero(client_null_map, 0, num_columns))) {
+    memcpy(tablet_isset_bitmap, client_isset_map, bm_size_);
+    op->isset_bitmap = tablet_isset_bitmap;
+    return DecodeFullRow(tablet_row_storage, op);
+  }
   // Initialize the bitmap since some columns might be lost in the client schema,
   // in which case the original value of the lost columns might be set to default
   // value by upsert request.
@@ -555,6 +595,7 @@ Status RowOperationsPBDecoder::DecodeInsertOrUpsert(const uint8_t* prototype_row
         (*auto_incrementing_counter)++;
         memcpy(tablet_row.mutable_cell_ptr(tablet_col_idx), auto_incrementing_counter, 8);
         BitmapChange(tablet_isset_bitmap, client_col_idx, true);
+        op->auto_incrementing_value_assigned = true;
       } else if (PREDICT_FALSE(!(col.is_nullable() || col.has_write_default()))) {
         // Otherwise, the column must either be nullable or have a default (which
         // was already set in the prototype row).
@@ -569,6 +610,37 @@ Status RowOperationsPBDecoder::DecodeInsertOrUpsert(const uint8_t* prototype_row
   return Status::OK();
 }
 
+Status RowOperationsPBDecoder::DecodeFullRow(uint8_t* tablet_row_storage,
+                                             DecodedRowOperation* op) {
+  DCHECK(same_row_layout_);
+  const size_t cells_size = tablet_schema_->byte_size();
+  if (PREDICT_FALSE(src_.size() < cells_size)) {
+    return Status::Corruption("Not enough data for row");
+  }
+  memcpy(tablet_row_storage, src_.data(), cells_size);
+  src_.remove_prefix(cells_size);
+  if (tablet_schema_->has_nullables()) {
+    // None of the cells is null.
+    memset(tablet_row_storage + cells_size, 0,
+           ContiguousRowHelper::non_null_bitmap_size(*tablet_schema_));
+  }
+
+  ContiguousRow tablet_row(tablet_schema_, tablet_row_storage);
+  for (size_t col_idx : binary_col_idxs_) {
+    const ColumnSchema& col = tablet_schema_->column(col_idx);
+    uint8_t* cell = tablet_row.mutable_cell_ptr(col_idx);
+    Slice slice;
+    Status row_status;
+    RETURN_NOT_OK(GetIndirectSlice(col, cell, &slice, &row_status));
+    if (PREDICT_FALSE(!row_status.ok())) {
+      op->SetFailureStatusOnce(row_status);
+    }
+    memcpy(cell, &slice, sizeof(slice));
+  }
+  op->row_data = tablet_row_storage;
+  return Status::OK();
+}
+
 Status RowOperationsPBDecoder::DecodeUpdateOrDelete(const ClientServerMapping& mapping,
                                                     DecodedRowOperation* op) {
   const uint8_t* client_isset_map = nullptr;
@@ -774,6 +846,23 @@ Status RowOperationsPBDecoder::DecodeOperations(vector<DecodedRowOperation>* ops
     RETURN_NOT_OK(mapping.CheckAllRequiredColumnsPresent());
   }
 
+  // Check whether the rows of the client have the layout of the tablet's,
+  // i.e. they have the same columns of the same types in the same order.
+  same_row_layout_ = client_schema_->num_columns() == tablet_schema_->num_columns() &&
+      !tablet_schema_->has_auto_incrementing();
+  for (size_t idx = 0; same_row_layout_ && idx < client_schema_->num_columns(); idx++) {
+    same_row_layout_ = GetTabletColIdx(mapping, idx) == idx &&
+        client_schema_->column(idx).type_info() == tablet_schema_->column(idx).type_info();
+  }
+  binary_col_idxs_.clear();
+  if (same_row_layout_) {
+    for (size_t idx = 0; idx < tablet_schema_->num_columns(); idx++) {
+      if (tablet_schema_->column(idx).type_info()->physical_type() == BINARY) {
+        binary_col_idxs_.push_back(idx);
+      }
+    }
+  }
+
   // Make a "prototype row" which has all the defaults filled in. We can copy
   // this to create a starting point for each row as we decode it, with
   // all the defaults in place without having to loop.
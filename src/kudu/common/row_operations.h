@@ -98,6 +98,12 @@ struct DecodedRowOperation {
   // - UPDATE_IGNORE op on a row to update an immutable column.
   bool error_ignored = false;
 
+  // For INSERT or INSERT_IGNORE into a table with a non-unique primary key,
+  // true if the decoder assigned the next value of the auto-incrementing
+  // counter to the row. The counter being larger than the auto-incrementing
+  // value of any row of the tablet, the key of the row is then unique.
+  bool auto_incrementing_value_assigned = false;
+
   // Stringifies, including redaction when appropriate.
   std::string ToString(const Schema& schema) const;
 
@@ -135,6 +141,11 @@ class RowOperationsPBDecoder {
   // and if column data validate error (i.e. column size exceed the limit), only
   // set bad Status to 'row_status', and return Status::OK.
   Status GetColumnSlice(const ColumnSchema& col, Slice* slice, Status* row_status);
+  // Resolve the encoded cell 'cell' of the BINARY column 'col', whose slice
+  // points relative to the indirect data of the protobuf, to the slice of its
+  // data, performing the same validation as above.
+  Status GetIndirectSlice(const ColumnSchema& col, const uint8_t* cell,
+                          Slice* slice, Status* row_status);
   // Same as above, but store result in 'dst'.
   Status ReadColumn(const ColumnSchema& col, uint8_t* dst, Status* row_status);
   // Some column which is non-nullable has allocated a cell to row data in
@@ -151,6 +162,12 @@ class RowOperationsPBDecoder {
                               const ClientServerMapping& mapping,
                               DecodedRowOperation* op,
                               int64_t* auto_incrementing_counter);
+
+  // Decode the cells of a row for which the client set every column to a
+  // non-null value into 'tablet_row_storage', when the row layouts of the
+  // client and tablet schemas are the same: the cells are then encoded as in
+  // a ContiguousRow, and are copied at once rather than one by one.
+  Status DecodeFullRow(uint8_t* tablet_row_storage, DecodedRowOperation* op);
   //------------------------------------------------------------
   // Serialization/deserialization support
   //------------------------------------------------------------
@@ -182,6 +199,13 @@ class RowOperationsPBDecoder {
   const size_t tablet_row_size_;
   Slice src_;
 
+  // Whether the client and tablet schemas have the same columns in the same
+  // order, and the tablet schema has no auto-incrementing column, so that the
+  // rows with every column set can be decoded with DecodeFullRow().
+  bool same_row_layout_;
+  // The indexes of the BINARY columns, whose cells DecodeFullRow() resolves.
+  std::vector<size_t> binary_col_idxs_;
+
   DISALLOW_COPY_AND_ASSIGN(RowOperationsPBDecoder);
 };
 
@@ -89,4 +89,18 @@ TEST(TestSelectionVector, TestGetSelectedRows) {
   ASSERT_EQ(expected, sel.indexes());
 }
 
+TEST(TestSelectionVector, TestIsSparse) {
+  SelectionVector sv(4096);
+  sv.SetAllFalse();
+  ASSERT_TRUE(sv.IsSparse());
+  for (int i = 0; i < 63; i++) {
+    sv.SetRowSelected(i * 64);
+  }
+  ASSERT_TRUE(sv.IsSparse());
+  sv.SetRowSelected(1);
+  ASSERT_FALSE(sv.IsSparse());
+  sv.SetAllTrue();
+  ASSERT_FALSE(sv.IsSparse());
+}
+
 } // namespace kudu
@@ -121,6 +121,10 @@ size_t SelectionVector::CountSelected() const {
   return Bits::Count(&bitmap_[0], n_bytes_);
 }
 
+bool SelectionVector::IsSparse() const {
+  return CountSelected() * kSparseRatio < n_rows_;
+}
+
 bool SelectionVector::AnySelected() const {
   size_t rem = n_bytes_;
   const uint32_t *p32 = reinterpret_cast<const uint32_t *>(
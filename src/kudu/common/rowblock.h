@@ -79,6 +79,11 @@ class SelectionVector {
   // This is equivalent to (CountSelected() > 0), but faster.
   bool AnySelected() const;
 
+  // Return true if so few rows are selected that visiting the selected rows
+  // one by one is cheaper than passing over every row, as is the case after
+  // a highly selective predicate: fewer than one in kSparseRatio rows.
+  bool IsSparse() const;
+
   bool IsRowSelected(size_t row) const {
     DCHECK_LT(row, n_rows_);
     return BitmapTest(&bitmap_[0], row);
@@ -98,7 +103,7 @@ class SelectionVector {
   //
   // Returns true if at least one row is selected and writes its index to 'row';
   // returns false otherwise.
-  bool FindFirstRowSelected(size_t row_offset, size_t* row) {
+  bool FindFirstRowSelected(size_t row_offset, size_t* row) const {
     DCHECK_LT(row_offset, n_rows_);
     DCHECK(row);
     return BitmapFindFirstSet(&bitmap_[0], row_offset, n_rows_, row);
@@ -156,6 +161,7 @@ class SelectionVector {
   }
 
  private:
+  static constexpr size_t kSparseRatio = 64;
 
   // Pads any non-byte-aligned bits at the end of the SelectionVector with zeroes.
   //
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <unordered_set>
 
+#include "kudu/common/array_cell.h"
 #include "kudu/common/row.h"
 #include "kudu/common/rowblock.h" // IWYU pragma: keep
 #include "kudu/gutil/map-util.h"
@@ -89,6 +90,8 @@ bool ColumnTypeAttributes::EqualsForType(ColumnTypeAttributes other,
       return precision == other.precision && scale == other.scale;
     case VARCHAR:
       return length == other.length;
+    case ARRAY:
+      return element_type == other.element_type;
     default:
       return true; // true because unhandled types don't use ColumnTypeAttributes.
   }
@@ -102,6 +105,8 @@ string ColumnTypeAttributes::ToStringForType(DataType type) const {
       return Substitute("($0, $1)", precision, scale);
     case VARCHAR:
       return Substitute("($0)", length);
+    case ARRAY:
+      return Substitute("($0)", DataType_Name(element_type));
     default:
       return "";
   }
@@ -110,10 +115,15 @@ string ColumnTypeAttributes::ToStringForType(DataType type) const {
 string ColumnStorageAttributes::ToString() const {
   const string cfile_block_size_str =
       cfile_block_size == 0 ? "" : Substitute(" $0", cfile_block_size);
-  return Substitute("$0 $1$2",
+  const string compression_level_str =
+      compression_level == 0 ? "" : Substitute("($0)", compression_level);
+  return Substitute("$0 $1$2$3$4$5",
                     EncodingType_Name(encoding),
                     CompressionType_Name(compression),
-                    cfile_block_size_str);
+                    compression_level_str,
+                    cfile_block_size_str,
+                    bloom_filter ? " BLOOM_FILTER" : "",
+                    secondary_index ? " SECONDARY_INDEX" : "");
 }
 
 Status ColumnSchema::ApplyDelta(const ColumnSchemaDelta& col_delta) {
@@ -289,6 +299,12 @@ Status Schema::Reset(vector<ColumnSchema> cols,
         "Bad schema", Substitute("Nullable key columns are not supported: $0",
                                  cols_[i].name()));
     }
+    if (PREDICT_FALSE(cols_[i].type_info()->type() == ARRAY ||
+                      cols_[i].type_info()->type() == JSON)) {
+      return Status::InvalidArgument(
+        "Bad schema", Substitute("$0 key columns are not supported: $1",
+                                 cols_[i].type_info()->name(), cols_[i].name()));
+    }
     if (cols_[i].is_auto_incrementing()) {
       // Schemas can have at most one auto-incrementing column
       DCHECK_EQ(auto_incrementing_col_idx, kColumnNotFound);
@@ -322,6 +338,12 @@ Status Schema::Reset(vector<ColumnSchema> cols,
     if (!InsertIfNotPresent(&name_to_index_, col.name(), i++)) {
       return Status::InvalidArgument("Duplicate column name", col.name());
     }
+    if (col.type_info()->type() == ARRAY &&
+        PREDICT_FALSE(!IsArrayElementTypeSupported(col.type_attributes().element_type))) {
+      return Status::InvalidArgument(Substitute(
+          "ARRAY column $0 has unsupported element type $1",
+          col.name(), DataType_Name(col.type_attributes().element_type)));
+    }
 
     col_offsets_.push_back(off);
     off += col.type_info()->size();
@@ -100,19 +100,29 @@ struct ColumnTypeAttributes {
   ColumnTypeAttributes()
       : precision(0),
         scale(0),
-        length(0) {
+        length(0),
+        element_type(UNKNOWN_DATA) {
   }
 
   ColumnTypeAttributes(int8_t precision, int8_t scale)
       : precision(precision),
         scale(scale),
-        length(0) {
+        length(0),
+        element_type(UNKNOWN_DATA) {
   }
 
   explicit ColumnTypeAttributes(uint16_t length)
       : precision(0),
         scale(0),
-        length(length) {
+        length(length),
+        element_type(UNKNOWN_DATA) {
+  }
+
+  explicit ColumnTypeAttributes(DataType element_type)
+      : precision(0),
+        scale(0),
+        length(0),
+        element_type(element_type) {
   }
 
   // Does `other` represent equivalent attributes for `type`?
@@ -133,6 +143,9 @@ struct ColumnTypeAttributes {
   // MySQL and less for other major RDBMS implementations. The length refers to
   // the number of characters/symbols (not bytes).
   uint16_t length;
+
+  // The type of the elements of ARRAY columns.
+  DataType element_type;
 };
 
 // Class for storing column attributes such as compression and
@@ -147,13 +160,19 @@ struct ColumnStorageAttributes {
   ColumnStorageAttributes()
     : encoding(AUTO_ENCODING),
       compression(DEFAULT_COMPRESSION),
-      cfile_block_size(0) {
+      cfile_block_size(0),
+      compression_level(0),
+      bloom_filter(false),
+      secondary_index(false) {
   }
 
   ColumnStorageAttributes(EncodingType enc, CompressionType cmp)
     : encoding(enc),
       compression(cmp),
-      cfile_block_size(0) {
+      cfile_block_size(0),
+      compression_level(0),
+      bloom_filter(false),
+      secondary_index(false) {
   }
 
   std::string ToString() const;
@@ -164,6 +183,18 @@ struct ColumnStorageAttributes {
   // The preferred block size for cfile blocks. If 0, uses the
   // server-wide default.
   int32_t cfile_block_size;
+
+  // The compression level for codecs which support one (e.g. ZSTD).
+  // If 0, uses the server-wide default for the codec.
+  int32_t compression_level;
+
+  // Whether to write a bloom filter over the column's values. Ignored for
+  // key columns, which are covered by the rowset's key bloom filter.
+  bool bloom_filter;
+
+  // Whether to write a secondary index over the column's values. Ignored for
+  // key columns, whose rows are found through the rowset's key index.
+  bool secondary_index;
 };
 
 // A struct representing changes to a ColumnSchema.
@@ -22,10 +22,13 @@
 #include <unordered_map>
 #include <utility>
 
+#include "kudu/common/array_cell.h"
 #include "kudu/gutil/singleton.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/walltime.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
 
 using std::string;
 using std::unique_ptr;
@@ -97,6 +100,8 @@ class TypeInfoResolver {
     AddMapping<DECIMAL128>();
     AddMapping<IS_DELETED>();
     AddMapping<VARCHAR>();
+    AddMapping<ARRAY>();
+    AddMapping<JSON>();
   }
 
   template<DataType type> void AddMapping() {
@@ -129,4 +134,15 @@ void DataTypeTraits<DATE>::AppendDebugStringForValue(const void* val, string* st
   }
 }
 
+void DataTypeTraits<ARRAY>::AppendDebugStringForValue(const void* val, string* str) {
+  const Slice* cell = reinterpret_cast<const Slice*>(val);
+  ArrayCellView view;
+  Status s = view.Init(*cell);
+  if (!s.ok()) {
+    str->append(Substitute("invalid array cell: $0", s.ToString()));
+    return;
+  }
+  view.AppendDebugString(str);
+}
+
 } // namespace kudu
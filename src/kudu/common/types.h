@@ -668,6 +668,29 @@ struct DataTypeTraits<VARCHAR> : public DerivedTypeTraits<BINARY>{
   }
 };
 
+// The cells of ARRAY columns are BINARY cells in the format described in
+// common/array_cell.h.
+template<>
+struct DataTypeTraits<ARRAY> : public DerivedTypeTraits<BINARY>{
+  static const char* name() {
+    return "array";
+  }
+  static void AppendDebugStringForValue(const void* val, std::string* str);
+};
+
+// The cells of JSON columns are BINARY cells holding the UTF-8 text of a
+// JSON document, validated when written.
+template<>
+struct DataTypeTraits<JSON> : public DerivedTypeTraits<BINARY>{
+  static const char* name() {
+    return "json";
+  }
+  static void AppendDebugStringForValue(const void *val, std::string *str) {
+    const Slice *s = reinterpret_cast<const Slice *>(val);
+    str->append(reinterpret_cast<const char*>(s->data()), s->size());
+  }
+};
+
 // Instantiate this template to get static access to the type traits.
 template<DataType datatype>
 struct TypeTraits : public DataTypeTraits<datatype> {
@@ -754,6 +777,8 @@ class Variant {
       case STRING: // Fallthrough intended.
       case VARCHAR:
       case BINARY:
+      case ARRAY:
+      case JSON:
         {
           const Slice *str = static_cast<const Slice *>(value);
           // In the case that str->size() == 0, then the 'Clear()' above has already
@@ -821,7 +846,9 @@ class Variant {
       case DOUBLE:       return (&numeric_.double_val);
       case STRING:
       case VARCHAR:
-      case BINARY:       return &vstr_;
+      case BINARY:
+      case ARRAY:
+      case JSON:         return &vstr_;
       default: LOG(FATAL) << "Unknown data type: " << type_;
     }
     CHECK(false) << "not reached!";
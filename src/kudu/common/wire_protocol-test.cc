@@ -851,6 +851,46 @@ TEST_F(WireProtocolTest, TestColumnPredicateInList) {
   }
 }
 
+TEST_F(WireProtocolTest, TestColumnPredicateArrayContains) {
+  ColumnSchema key("key", INT32);
+  ColumnSchema col("col", ARRAY, /*is_nullable=*/true,
+                   /*is_immutable=*/false, /*is_auto_incrementing=*/false,
+                   /*read_default=*/nullptr, /*write_default=*/nullptr,
+                   ColumnStorageAttributes(), ColumnTypeAttributes(STRING));
+  Schema schema({ key, col }, 1);
+  RowBlockMemory mem(1024);
+  optional<ColumnPredicate> predicate;
+
+  { // col CONTAINS ('a', 'b')
+    Slice a("a");
+    Slice b("b");
+    vector<const void*> values { &b, &a };
+    ColumnPredicate cp = ColumnPredicate::ArrayContains(col, &values);
+    ColumnPredicatePB pb;
+    NO_FATALS(ColumnPredicateToPB(cp, &pb));
+    ASSERT_EQ(2, pb.array_contains().values_size());
+
+    ASSERT_OK(ColumnPredicateFromPB(schema, &mem.arena, pb, &predicate));
+    ASSERT_EQ(cp, *predicate);
+  }
+
+  { // Array contains predicates only apply to ARRAY columns.
+    ColumnPredicatePB pb;
+    pb.set_column("key");
+    *pb.mutable_array_contains()->mutable_values()->Add() = string("\0\0\0\0", 4);
+    Status s = ColumnPredicateFromPB(schema, &mem.arena, pb, &predicate);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+
+  { // Comparisons of arrays are not supported.
+    ColumnPredicatePB pb;
+    pb.set_column("col");
+    *pb.mutable_equality()->mutable_value() = "a";
+    Status s = ColumnPredicateFromPB(schema, &mem.arena, pb, &predicate);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+}
+
 class BFWireProtocolTest : public KuduTest {
  public:
   BFWireProtocolTest()
@@ -33,6 +33,7 @@
 #include <google/protobuf/map.h>
 #include <google/protobuf/stubs/common.h>
 
+#include "kudu/common/array_cell.h"
 #include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
@@ -52,6 +53,7 @@
 #include "kudu/util/bitmap.h"
 #include "kudu/util/block_bloom_filter.h"
 #include "kudu/util/faststring.h"
+#include "kudu/util/json_path.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/net/sockaddr.h"
@@ -243,11 +245,22 @@ void ColumnSchemaToPB(const ColumnSchema& col_schema, ColumnSchemaPB *pb, int fl
     pb->mutable_type_attributes()->set_scale(col_schema.type_attributes().scale);
   } else if (type == DataType::VARCHAR) {
     pb->mutable_type_attributes()->set_length(col_schema.type_attributes().length);
+  } else if (type == DataType::ARRAY) {
+    pb->mutable_type_attributes()->set_element_type(col_schema.type_attributes().element_type);
   }
   if (!(flags & SCHEMA_PB_WITHOUT_STORAGE_ATTRIBUTES)) {
     pb->set_encoding(col_schema.attributes().encoding);
     pb->set_compression(col_schema.attributes().compression);
     pb->set_cfile_block_size(col_schema.attributes().cfile_block_size);
+    if (col_schema.attributes().compression_level != 0) {
+      pb->set_compression_level(col_schema.attributes().compression_level);
+    }
+    if (col_schema.attributes().bloom_filter) {
+      pb->set_bloom_filter(true);
+    }
+    if (col_schema.attributes().secondary_index) {
+      pb->set_secondary_index(true);
+    }
   }
   if (col_schema.has_read_default()) {
     if (col_schema.type_info()->physical_type() == BINARY) {
@@ -320,6 +333,34 @@ Status ColumnSchemaFromPB(const ColumnSchemaPB& pb, optional<ColumnSchema>* col_
     if (typeAttributesPB.has_length()) {
       type_attributes.length = typeAttributesPB.length();
     }
+    if (typeAttributesPB.has_element_type()) {
+      type_attributes.element_type = typeAttributesPB.element_type();
+    }
+  }
+  if (pb.type() == DataType::ARRAY) {
+    if (!IsArrayElementTypeSupported(type_attributes.element_type)) {
+      return Status::InvalidArgument(Substitute(
+          "ARRAY column $0 has unsupported element type $1",
+          pb.name(), DataType_Name(type_attributes.element_type)));
+    }
+    if (read_default_ptr) {
+      RETURN_NOT_OK_PREPEND(ValidateArrayCell(read_default, type_attributes.element_type),
+                            Substitute("invalid read default for column $0", pb.name()));
+    }
+    if (write_default_ptr) {
+      RETURN_NOT_OK_PREPEND(ValidateArrayCell(write_default, type_attributes.element_type),
+                            Substitute("invalid write default for column $0", pb.name()));
+    }
+  }
+  if (pb.type() == DataType::JSON) {
+    if (read_default_ptr) {
+      RETURN_NOT_OK_PREPEND(ValidateJson(read_default),
+                            Substitute("invalid read default for column $0", pb.name()));
+    }
+    if (write_default_ptr) {
+      RETURN_NOT_OK_PREPEND(ValidateJson(write_default),
+                            Substitute("invalid write default for column $0", pb.name()));
+    }
   }
 
   ColumnStorageAttributes attributes;
@@ -332,6 +373,15 @@ Status ColumnSchemaFromPB(const ColumnSchemaPB& pb, optional<ColumnSchema>* col_
   if (pb.has_cfile_block_size()) {
     attributes.cfile_block_size = pb.cfile_block_size();
   }
+  if (pb.has_compression_level()) {
+    attributes.compression_level = pb.compression_level();
+  }
+  if (pb.has_bloom_filter()) {
+    attributes.bloom_filter = pb.bloom_filter();
+  }
+  if (pb.has_secondary_index()) {
+    attributes.secondary_index = pb.secondary_index();
+  }
 
   // According to the URL below, the default value for strings that are optional
   // in protobuf is the empty string. So, it's safe to use pb.comment() directly
@@ -545,6 +595,15 @@ void ColumnPredicateToPB(const ColumnPredicate& predicate,
       }
       return;
     };
+    case PredicateType::ArrayContains: {
+      const ColumnSchema element_col(predicate.column().name(),
+                                     predicate.column().type_attributes().element_type);
+      auto* values = pb->mutable_array_contains()->mutable_values();
+      for (const void* value : predicate.raw_values()) {
+        CopyPredicateBoundToPB(element_col, value, values->Add());
+      }
+      return;
+    };
     case PredicateType::None: LOG(FATAL) << "None predicate may not be converted to protobuf";
     case PredicateType::InBloomFilter: {
       auto* bloom_filter_pred = pb->mutable_in_bloom_filter();
@@ -583,6 +642,18 @@ Status ColumnPredicateFromPB(const Schema& schema,
   }
   const ColumnSchema& col = schema.column(idx);
 
+  // The cells of ARRAY columns may only be tested for NULL or for the elements
+  // they contain: comparing their encoded values is meaningless.
+  const bool is_array = col.type_info()->type() == ARRAY;
+  if (is_array != (pb.predicate_case() == ColumnPredicatePB::kArrayContains) &&
+      pb.predicate_case() != ColumnPredicatePB::kIsNotNull &&
+      pb.predicate_case() != ColumnPredicatePB::kIsNull) {
+    return Status::InvalidArgument(
+        is_array ? "Unsupported predicate type for ARRAY column"
+                 : "ArrayContains predicate on a column which is not an ARRAY",
+        col.name());
+  }
+
   switch (pb.predicate_case()) {
     case ColumnPredicatePB::kRange: {
       const auto& range = pb.range();
@@ -633,6 +704,22 @@ Status ColumnPredicateFromPB(const Schema& schema,
       *predicate = ColumnPredicate::IsNull(col);
       break;
     };
+    case ColumnPredicatePB::kArrayContains: {
+      const auto& array_contains = pb.array_contains();
+      if (array_contains.values_size() == 0) {
+        return Status::InvalidArgument("Invalid array contains predicate on column: no values",
+                                       col.name());
+      }
+      const ColumnSchema element_col(col.name(), col.type_attributes().element_type);
+      vector<const void*> values;
+      for (const string& pb_value : array_contains.values()) {
+        const void* value = nullptr;
+        RETURN_NOT_OK(CopyPredicateBoundFromPB(element_col, pb_value, arena, &value));
+        values.push_back(value);
+      }
+      *predicate = ColumnPredicate::ArrayContains(col, &values);
+      break;
+    };
     case ColumnPredicatePB::kInBloomFilter: {
       const auto& in_bloom_filter = pb.in_bloom_filter();
       vector<BlockBloomFilter*> bloom_filters;
@@ -697,7 +784,12 @@ Status ParseBoolConfig(const string& name, const string& value, bool* result) {
 Status ExtraConfigPBFromPBMap(const Map<string, string>& configs, TableExtraConfigPB* pb) {
   static const unordered_set<string> kSupportedConfigs({kTableHistoryMaxAgeSec,
                                                         kTableMaintenancePriority,
-                                                        kTableDisableCompaction});
+                                                        kTableDisableCompaction,
+                                                        kTableCompactionPolicy,
+                                                        kTableAutoRangePartitionIntervalSec,
+                                                        kTableAutoRangePartitionRetentionSec,
+                                                        kTableRowTtlColumn,
+                                                        kTableRowTtlSec});
   TableExtraConfigPB result;
   for (const auto& config : configs) {
     const string& name = config.first;
@@ -725,6 +817,48 @@ Status ExtraConfigPBFromPBMap(const Map<string, string>& configs, TableExtraConf
         RETURN_NOT_OK(ParseBoolConfig(name, value, &disable_compaction));
         result.set_disable_compaction(disable_compaction);
       }
+    } else if (name == kTableCompactionPolicy) {
+      if (!value.empty()) {
+        string policy_name;
+        ToUpperCase(value, &policy_name);
+        TableExtraConfigPB::CompactionPolicy policy;
+        if (!TableExtraConfigPB::CompactionPolicy_Parse(policy_name, &policy) ||
+            policy == TableExtraConfigPB::UNKNOWN_COMPACTION_POLICY) {
+          return Status::InvalidArgument(Substitute("unable to parse $0", name), value);
+        }
+        result.set_compaction_policy(policy);
+      }
+    } else if (name == kTableAutoRangePartitionIntervalSec) {
+      if (!value.empty()) {
+        int32_t interval_sec;
+        RETURN_NOT_OK(ParseInt32Config(name, value, &interval_sec));
+        if (interval_sec <= 0) {
+          return Status::InvalidArgument(Substitute("$0 must be positive", name), value);
+        }
+        result.set_auto_range_partition_interval_sec(interval_sec);
+      }
+    } else if (name == kTableAutoRangePartitionRetentionSec) {
+      if (!value.empty()) {
+        int32_t retention_sec;
+        RETURN_NOT_OK(ParseInt32Config(name, value, &retention_sec));
+        if (retention_sec <= 0) {
+          return Status::InvalidArgument(Substitute("$0 must be positive", name), value);
+        }
+        result.set_auto_range_partition_retention_sec(retention_sec);
+      }
+    } else if (name == kTableRowTtlColumn) {
+      if (!value.empty()) {
+        result.set_row_ttl_column(value);
+      }
+    } else if (name == kTableRowTtlSec) {
+      if (!value.empty()) {
+        int32_t row_ttl_sec;
+        RETURN_NOT_OK(ParseInt32Config(name, value, &row_ttl_sec));
+        if (row_ttl_sec <= 0) {
+          return Status::InvalidArgument(Substitute("$0 must be positive", name), value);
+        }
+        result.set_row_ttl_sec(row_ttl_sec);
+      }
     } else {
       LOG(FATAL) << "Unknown extra configuration property: " << name;
     }
@@ -744,6 +878,24 @@ Status ExtraConfigPBToPBMap(const TableExtraConfigPB& pb, Map<string, string>* c
   if (pb.has_disable_compaction()) {
     result[kTableDisableCompaction] = std::to_string(pb.disable_compaction());
   }
+  if (pb.has_compaction_policy()) {
+    result[kTableCompactionPolicy] =
+        TableExtraConfigPB::CompactionPolicy_Name(pb.compaction_policy());
+  }
+  if (pb.has_auto_range_partition_interval_sec()) {
+    result[kTableAutoRangePartitionIntervalSec] =
+        std::to_string(pb.auto_range_partition_interval_sec());
+  }
+  if (pb.has_auto_range_partition_retention_sec()) {
+    result[kTableAutoRangePartitionRetentionSec] =
+        std::to_string(pb.auto_range_partition_retention_sec());
+  }
+  if (pb.has_row_ttl_column()) {
+    result[kTableRowTtlColumn] = pb.row_ttl_column();
+  }
+  if (pb.has_row_ttl_sec()) {
+    result[kTableRowTtlSec] = std::to_string(pb.row_ttl_sec());
+  }
   *configs = std::move(result);
   return Status::OK();
 }
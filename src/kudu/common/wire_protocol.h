@@ -60,6 +60,13 @@ class TableExtraConfigPB;
 static const std::string kTableHistoryMaxAgeSec = "kudu.table.history_max_age_sec";
 static const std::string kTableMaintenancePriority = "kudu.table.maintenance_priority";
 static const std::string kTableDisableCompaction = "kudu.table.disable_compaction";
+static const std::string kTableCompactionPolicy = "kudu.table.compaction_policy";
+static const std::string kTableAutoRangePartitionIntervalSec =
+    "kudu.table.auto_range_partition_interval_sec";
+static const std::string kTableAutoRangePartitionRetentionSec =
+    "kudu.table.auto_range_partition_retention_sec";
+static const std::string kTableRowTtlColumn = "kudu.table.row_ttl_column";
+static const std::string kTableRowTtlSec = "kudu.table.row_ttl_sec";
 
 // Convert the given C++ Status object into the equivalent Protobuf.
 void StatusToPB(const Status& status, AppStatusPB* pb);
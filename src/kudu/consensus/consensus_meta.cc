@@ -320,7 +320,8 @@ Status ConsensusMetadata::Flush(FlushMode flush_mode) {
       // filesystems such as XFS will not commit as often and need the fsync to
       // avoid significant data loss when a crash happens.
       FLAGS_log_force_fsync_all || cmeta_force_fsync ? pb_util::SYNC : pb_util::NO_SYNC,
-      pb_util::SENSITIVE),
+      pb_util::SENSITIVE,
+      fs_manager_->consensus_metadata_dir_syncer()),
           Substitute("Unable to write consensus meta file for tablet $0 to path $1",
                      tablet_id_, meta_file_path));
   return UpdateOnDiskSize();
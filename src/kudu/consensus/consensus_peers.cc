@@ -18,12 +18,14 @@
 #include "kudu/consensus/consensus_peers.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <gflags/gflags.h>
@@ -37,12 +39,15 @@
 #include "kudu/consensus/consensus_queue.h"
 #include "kudu/consensus/metadata.pb.h"
 #include "kudu/consensus/opid_util.h"
+#include "kudu/consensus/ref_counted_replicate.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/periodic.h"
 #include "kudu/rpc/response_callback.h"
 #include "kudu/rpc/rpc_controller.h"
+#include "kudu/rpc/rpc_sidecar.h"
+#include "kudu/rpc/transfer.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/util/fault_injection.h"
 #include "kudu/util/flag_tags.h"
@@ -50,6 +55,8 @@
 #include "kudu/util/monotime.h"
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/scoped_cleanup.h"
+#include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/threadpool.h"
 
@@ -80,6 +87,31 @@ DEFINE_bool(enable_tablet_copy, true,
             "replica. For testing purposes only.");
 TAG_FLAG(enable_tablet_copy, unsafe);
 
+DEFINE_bool(consensus_send_serialized_ops, false,
+            "Whether leaders send the ops of their requests to peers as the bytes "
+            "the ops were serialized to once, rather than serializing the ops again "
+            "in the request to each peer. This trades the memory of a serialized copy "
+            "of the ops being replicated for the CPU of serializing them.");
+TAG_FLAG(consensus_send_serialized_ops, experimental);
+TAG_FLAG(consensus_send_serialized_ops, runtime);
+
+DEFINE_int32(consensus_max_inflight_requests_per_peer, 1,
+             "The maximum number of update requests a leader has in flight to each "
+             "peer. With more than one, the ops of the next request are sent to a peer "
+             "before the previous request is acknowledged, hiding the round trip to "
+             "the peer from the throughput of replication.");
+TAG_FLAG(consensus_max_inflight_requests_per_peer, experimental);
+TAG_FLAG(consensus_max_inflight_requests_per_peer, runtime);
+
+DEFINE_int32(raft_safe_time_propagation_interval_ms, 0,
+             "If positive and lower than --raft_heartbeat_interval_ms, the interval "
+             "(in milliseconds) at which leaders heartbeat idle peers instead. Since "
+             "heartbeats carry the leader's safe time, this bounds how stale the safe "
+             "time of followers gets, and so the staleness of the bounded staleness scans "
+             "they serve without waiting. Followers still detect leader failures based on "
+             "--raft_heartbeat_interval_ms.");
+TAG_FLAG(raft_safe_time_propagation_interval_ms, experimental);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 using kudu::pb_util::SecureShortDebugString;
@@ -98,6 +130,32 @@ using strings::Substitute;
 namespace kudu {
 namespace consensus {
 
+namespace {
+
+// An op sent as a serialized field of a ConsensusRequestPB. Holds a reference
+// to the op, so that the serialized bytes outlive the call they're sent with.
+class SerializedOpField : public rpc::RpcSidecar {
+ public:
+  explicit SerializedOpField(ReplicateRefPtr msg)
+      : msg_(std::move(msg)),
+        field_(msg_->SerializedAsField(ConsensusRequestPB::kOpsFieldNumber)) {
+  }
+
+  void AppendSlices(rpc::TransferPayload* payload) const override {
+    payload->push_back(field_);
+  }
+
+  size_t TotalSize() const override {
+    return field_.size();
+  }
+
+ private:
+  const ReplicateRefPtr msg_;
+  const Slice field_;
+};
+
+} // anonymous namespace
+
 // The number of retries between failed requests whose failure is logged.
 constexpr auto kNumRetriesBetweenLoggingFailedRequest = 5;
 
@@ -134,14 +192,24 @@ Peer::Peer(RaftPeerPB peer_pb,
       peer_proxy_factory_(peer_proxy_factory),
       queue_(queue),
       failed_attempts_(0),
+      last_sent_committed_index_(kMinimumOpIdIndex),
       messenger_(peer_proxy_factory_->messenger()),
       raft_pool_token_(raft_pool_token),
-      request_pending_(false),
+      num_requests_pending_(0),
+      tablet_copy_pending_(false),
       closed_(false),
       has_sent_first_request_(false) {
   CreateProxyIfNeeded();
 }
 
+int32_t Peer::HeartbeatIntervalMs() {
+  if (FLAGS_raft_safe_time_propagation_interval_ms > 0) {
+    return std::min(FLAGS_raft_safe_time_propagation_interval_ms,
+                    FLAGS_raft_heartbeat_interval_ms);
+  }
+  return FLAGS_raft_heartbeat_interval_ms;
+}
+
 void Peer::Init() {
   {
     std::lock_guard<simple_spinlock> l(peer_lock_);
@@ -158,23 +226,23 @@ void Peer::Init() {
           p->SignalRequest(true);
         }
       },
-      MonoDelta::FromMilliseconds(FLAGS_raft_heartbeat_interval_ms));
+      MonoDelta::FromMilliseconds(HeartbeatIntervalMs()));
   heartbeater_->Start();
 }
 
 Status Peer::SignalRequest(bool even_if_queue_empty) {
-  // This is a best effort logic in checking for 'closed_' and
-  // 'request_pending_': it's not necessary to block if some other thread has
-  // taken 'peer_lock_' and about to update 'closed_'/'request_pending_' since
-  // the implementation of SendNextRequest() checks for 'closed_' and
-  // 'request_pending_' on its own.
+  // This is a best effort logic in checking for 'closed_' and the pending
+  // requests: it's not necessary to block if some other thread has taken
+  // 'peer_lock_' and about to update these fields since the implementation of
+  // SendNextRequest() checks for them on its own.
   if (PREDICT_FALSE(closed_)) {
     return Status::IllegalState("Peer was closed.");
   }
 
-  // Only allow one request at a time. No sense waking up the
-  // raft thread pool if the task will just abort anyway.
-  if (request_pending_) {
+  // No sense waking up the raft thread pool if the task will just abort
+  // anyway because no more requests are allowed in flight.
+  if (tablet_copy_pending_ ||
+      num_requests_pending_ >= std::max(1, FLAGS_consensus_max_inflight_requests_per_peer)) {
     return Status::OK();
   }
 
@@ -194,10 +262,13 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
     return;
   }
 
-  // Only allow one request at a time.
-  if (request_pending_) {
+  // Only allow up to the configured number of requests at a time.
+  if (tablet_copy_pending_ ||
+      num_requests_pending_ >= std::max(1, FLAGS_consensus_max_inflight_requests_per_peer)) {
     return;
   }
+  // Whether this request is sent while other requests are in flight.
+  const bool pipelined = num_requests_pending_ > 0;
 
   // For the first request sent by the peer, we send it even if the queue is empty,
   // which it will always appear to be for the first request, since this is the
@@ -220,14 +291,26 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
     return;
   }
 
-  // The peer has no pending request nor is sending: send the request.
+  // The requests in flight already assert the liveness of the leader: only
+  // send a pipelined request if it has something to replicate.
+  if (pipelined) {
+    even_if_queue_empty = false;
+  }
+
+  UpdateCall* call = TakeFreeCallUnlocked();
+  bool call_sent = false;
+  SCOPED_CLEANUP({
+    if (!call_sent) {
+      ReleaseCallUnlocked(call);
+    }
+  });
+
+  // The peer has room for another request: send the request.
   bool needs_tablet_copy = false;
-  int64_t commit_index_before = request_.has_committed_index() ?
-      request_.committed_index() : kMinimumOpIdIndex;
-  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request_,
-                                    &replicate_msg_refs_, &needs_tablet_copy);
-  int64_t commit_index_after = request_.has_committed_index() ?
-      request_.committed_index() : kMinimumOpIdIndex;
+  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &call->request,
+                                    &call->msg_refs, &needs_tablet_copy, pipelined);
+  int64_t commit_index = call->request.has_committed_index() ?
+      call->request.committed_index() : kMinimumOpIdIndex;
 
   if (PREDICT_FALSE(!s.ok())) {
     VLOG_WITH_PREFIX_UNLOCKED(1) << s.ToString();
@@ -243,15 +326,17 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
   }
 
   if (PREDICT_FALSE(needs_tablet_copy)) {
+    // Pipelined requests are only built for peers whose last exchange was OK.
+    DCHECK(!pipelined);
     Status s = PrepareTabletCopyRequest();
     if (s.ok()) {
-      controller_.Reset();
-      request_pending_ = true;
+      tc_controller_.Reset();
+      tablet_copy_pending_ = true;
       l.unlock();
       // Capture a shared_ptr reference into the RPC callback so that we're guaranteed
       // that this object outlives the RPC.
       shared_ptr<Peer> s_this = shared_from_this();
-      proxy_->StartTabletCopyAsync(tc_request_, &tc_response_, &controller_,
+      proxy_->StartTabletCopyAsync(tc_request_, &tc_response_, &tc_controller_,
                                    [s_this]() {
                                      s_this->ProcessTabletCopyResponse();
                                    });
@@ -262,7 +347,7 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
     return;
   }
 
-  bool req_has_ops = request_.ops_size() > 0 || (commit_index_after > commit_index_before);
+  bool req_has_ops = call->request.ops_size() > 0 || (commit_index > last_sent_committed_index_);
   // If the queue is empty, check if we were told to send a status-only
   // message, if not just return.
   if (PREDICT_FALSE(!req_has_ops && !even_if_queue_empty)) {
@@ -273,33 +358,62 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
     // If we're actually sending ops there's no need to heartbeat for a while.
     heartbeater_->Snooze();
   }
-
-  if (!has_sent_first_request_) {
-    // Set the 'immutable' fields in the request only once upon first request.
-    request_.set_tablet_id(tablet_id_);
-    request_.set_caller_uuid(leader_uuid_);
-    request_.set_dest_uuid(peer_pb_.permanent_uuid());
-    has_sent_first_request_ = true;
-  }
+  last_sent_committed_index_ = std::max(last_sent_committed_index_, commit_index);
+  has_sent_first_request_ = true;
 
   MAYBE_FAULT(FLAGS_fault_crash_on_leader_request_fraction);
 
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Sending to peer " << peer_pb().permanent_uuid() << ": "
-      << SecureShortDebugString(request_);
-
-  controller_.Reset();
-  request_pending_ = true;
+      << SecureShortDebugString(call->request);
+
+  call->controller.Reset();
+  if (FLAGS_consensus_send_serialized_ops && proxy_->SupportsSerializedOps()) {
+    // The ops are shared with the requests to the other peers: rather than
+    // serializing them in each request, send the bytes they were serialized
+    // to once. The ops remain referenced by 'call->msg_refs'.
+    DCHECK_LE(call->request.ops_size(), call->msg_refs.size());
+    for (int i = 0; i < call->request.ops_size(); i++) {
+      DCHECK_EQ(&call->request.ops(i), call->msg_refs[i]->get());
+      call->controller.AddSerializedRequestField(
+          std::make_unique<SerializedOpField>(call->msg_refs[i]));
+    }
+    call->request.mutable_ops()->ExtractSubrange(0, call->request.ops_size(), nullptr);
+  }
+  call->send_time = MonoTime::Now();
+  num_requests_pending_++;
+  call_sent = true;
   l.unlock();
 
   // Capture a shared_ptr reference into the RPC callback so that we're guaranteed
   // that this object outlives the RPC.
   shared_ptr<Peer> s_this = shared_from_this();
-  proxy_->UpdateAsync(request_, &response_, &controller_,
-                      [s_this]() {
-                        s_this->ProcessResponse();
+  proxy_->UpdateAsync(call->request, &call->response, &call->controller,
+                      [s_this, call]() {
+                        s_this->ProcessResponse(call);
                       });
 }
 
+Peer::UpdateCall* Peer::TakeFreeCallUnlocked() {
+  DCHECK(peer_lock_.is_locked());
+  if (!free_calls_.empty()) {
+    UpdateCall* call = free_calls_.back();
+    free_calls_.pop_back();
+    return call;
+  }
+  calls_.emplace_back(new UpdateCall);
+  UpdateCall* call = calls_.back().get();
+  // Set the 'immutable' fields in the request only once upon creation.
+  call->request.set_tablet_id(tablet_id_);
+  call->request.set_caller_uuid(leader_uuid_);
+  call->request.set_dest_uuid(peer_pb_.permanent_uuid());
+  return call;
+}
+
+void Peer::ReleaseCallUnlocked(UpdateCall* call) {
+  DCHECK(peer_lock_.is_locked());
+  free_calls_.push_back(call);
+}
+
 void Peer::StartElection() {
   if (PREDICT_FALSE(!CreateProxyIfNeeded())) {
     return;
@@ -332,44 +446,45 @@ void Peer::StartElection() {
     });
 }
 
-void Peer::ProcessResponse() {
+void Peer::ProcessResponse(UpdateCall* call) {
   // Note: This method runs on the reactor thread.
   std::unique_lock<simple_spinlock> lock(peer_lock_);
   if (PREDICT_FALSE(closed_)) {
     return;
   }
-  CHECK(request_pending_);
+  CHECK_GT(num_requests_pending_, 0);
+  const ConsensusResponsePB& response = call->response;
 
   MAYBE_FAULT(FLAGS_fault_crash_after_leader_request_fraction);
 
   // Process RpcController errors.
-  const auto controller_status = controller_.status();
+  const auto controller_status = call->controller.status();
   if (!controller_status.ok()) {
     auto ps = controller_status.IsRemoteError() ?
         PeerStatus::REMOTE_ERROR : PeerStatus::RPC_LAYER_ERROR;
     queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), ps, controller_status);
-    ProcessResponseErrorUnlocked(controller_status);
+    ProcessResponseErrorUnlocked(call, controller_status);
     return;
   }
 
   // Process CANNOT_PREPARE.
   // TODO(todd): there is no integration test coverage of this code path. Likely a bug in
   // this path is responsible for KUDU-1779.
-  if (response_.status().has_error() &&
-      response_.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE) {
-    Status response_status = StatusFromPB(response_.status().error().status());
+  if (response.status().has_error() &&
+      response.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE) {
+    Status response_status = StatusFromPB(response.status().error().status());
     queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), PeerStatus::CANNOT_PREPARE,
                              response_status);
-    ProcessResponseErrorUnlocked(response_status);
+    ProcessResponseErrorUnlocked(call, response_status);
     return;
   }
 
   // Process tserver-level errors.
-  if (response_.has_error()) {
-    Status response_status = StatusFromPB(response_.error().status());
+  if (response.has_error()) {
+    Status response_status = StatusFromPB(response.error().status());
     PeerStatus ps;
-    TabletServerErrorPB resp_error = response_.error();
-    switch (response_.error().code()) {
+    TabletServerErrorPB resp_error = response.error();
+    switch (response.error().code()) {
       // We treat WRONG_SERVER_UUID as failed.
       case TabletServerErrorPB::WRONG_SERVER_UUID: [[fallthrough]];
       case TabletServerErrorPB::TABLET_FAILED:
@@ -383,7 +498,7 @@ void Peer::ProcessResponse() {
         ps = PeerStatus::REMOTE_ERROR;
     }
     queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), ps, response_status);
-    ProcessResponseErrorUnlocked(response_status);
+    ProcessResponseErrorUnlocked(call, response_status);
     return;
   }
 
@@ -395,31 +510,33 @@ void Peer::ProcessResponse() {
   // Capture a weak_ptr reference into the submitted functor so that we can
   // safely handle the functor outliving its peer.
   weak_ptr<Peer> w_this = shared_from_this();
-  Status s = raft_pool_token_->Submit([w_this]() {
+  Status s = raft_pool_token_->Submit([w_this, call]() {
     if (auto p = w_this.lock()) {
-      p->DoProcessResponse();
+      p->DoProcessResponse(call);
     }
   });
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX_UNLOCKED(WARNING) << Substitute(
         "unable to process peer response: $0: $1",
-         s.ToString(), SecureShortDebugString(response_));
-    request_pending_ = false;
+         s.ToString(), SecureShortDebugString(response));
+    num_requests_pending_--;
+    ReleaseCallUnlocked(call);
   }
 }
 
-void Peer::DoProcessResponse() {
+void Peer::DoProcessResponse(UpdateCall* call) {
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Response from peer " << peer_pb().permanent_uuid() << ": "
-      << SecureShortDebugString(response_);
+      << SecureShortDebugString(call->response);
 
   const auto send_more_immediately =
-      queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), response_);
+      queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), call->response, call->send_time);
 
   {
     std::unique_lock<simple_spinlock> lock(peer_lock_);
-    CHECK(request_pending_);
+    CHECK_GT(num_requests_pending_, 0);
     failed_attempts_ = 0;
-    request_pending_ = false;
+    num_requests_pending_--;
+    ReleaseCallUnlocked(call);
   }
 
   if (send_more_immediately) {
@@ -442,11 +559,11 @@ void Peer::ProcessTabletCopyResponse() {
   if (PREDICT_FALSE(closed_)) {
     return;
   }
-  CHECK(request_pending_);
-  request_pending_ = false;
+  CHECK(tablet_copy_pending_);
+  tablet_copy_pending_ = false;
 
   // If the response is OK, or ALREADY_INPROGRESS, then consider the RPC successful.
-  const auto controller_status = controller_.status();
+  const auto controller_status = tc_controller_.status();
   bool success =
     controller_status.ok() &&
     (!tc_response_.has_error() ||
@@ -466,14 +583,15 @@ void Peer::ProcessTabletCopyResponse() {
   }
 }
 
-void Peer::ProcessResponseErrorUnlocked(const Status& status) {
+void Peer::ProcessResponseErrorUnlocked(UpdateCall* call, const Status& status) {
   DCHECK(peer_lock_.is_locked());
   failed_attempts_++;
   string resp_err_info;
-  if (response_.has_error()) {
+  const ConsensusResponsePB& response = call->response;
+  if (response.has_error()) {
     resp_err_info = Substitute(" Error code: $0 ($1).",
-                               TabletServerErrorPB::Code_Name(response_.error().code()),
-                               response_.error().code());
+                               TabletServerErrorPB::Code_Name(response.error().code()),
+                               response.error().code());
   }
   // We log the warning at the first failure, then every
   // 'kNumRetriesBetweenLoggingFailedRequest' retries.
@@ -491,7 +609,8 @@ void Peer::ProcessResponseErrorUnlocked(const Status& status) {
                  failed_attempts_,
                  kNumRetriesBetweenLoggingFailedRequest);
   }
-  request_pending_ = false;
+  num_requests_pending_--;
+  ReleaseCallUnlocked(call);
 }
 
 bool Peer::CreateProxyIfNeeded() {
@@ -534,9 +653,6 @@ Peer::~Peer() {
   if (heartbeater_) {
     heartbeater_->Stop();
   }
-
-  // We don't own the ops (the queue does).
-  request_.mutable_ops()->ExtractSubrange(0, request_.ops_size(), nullptr);
 }
 
 RpcPeerProxy::RpcPeerProxy(HostPort hostport,
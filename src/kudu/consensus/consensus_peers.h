@@ -33,6 +33,7 @@
 #include "kudu/rpc/rpc_controller.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/make_shared.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/status.h"
 
@@ -52,13 +53,15 @@ class PeerProxyFactory;
 
 // A remote peer in consensus.
 //
-// Leaders use peers to update the remote replicas. Each peer
-// may have at most one outstanding request at a time. If a
-// request is signaled when there is already one outstanding,
-// the request will be generated once the outstanding one finishes.
+// Leaders use peers to update the remote replicas. Each peer may have up to
+// --consensus_max_inflight_requests_per_peer outstanding update requests at a
+// time, the ops of each following those of the previous ones. If a request is
+// signaled when the window is full, the request will be generated once an
+// outstanding one finishes. Upon a failed request, the peer is caught up one
+// request at a time again, starting over from the peer's last received op.
 //
 // Peers are owned by the consensus implementation and do not keep
-// state aside from the most recent request and response.
+// state aside from the requests in flight and their responses.
 //
 // Peers are also responsible for sending periodic heartbeats
 // to assert liveness of the leader. The peer constructs a heartbeater
@@ -86,7 +89,7 @@ class Peer :
   // This method is ad hoc, using this instance's PeerProxy to send the
   // StartElection request.
   //
-  // The StartElection RPC does not count as the single outstanding request
+  // The StartElection RPC does not count as one of the outstanding requests
   // that this class tracks.
   void StartElection();
 
@@ -131,17 +134,48 @@ class Peer :
        PeerProxyFactory* peer_proxy_factory);
 
  private:
+  // Returns the interval at which idle peers are heartbeated, in milliseconds.
+  static int32_t HeartbeatIntervalMs();
+
   void SendNextRequest(bool even_if_queue_empty);
 
-  // Signals that a response was received from the peer.
+  // An update request to the peer, along with its response and the state
+  // which has to outlive the RPC.
+  struct UpdateCall {
+    ~UpdateCall() {
+      // We don't own the ops (the queue does).
+      request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
+    }
+
+    ConsensusRequestPB request;
+    ConsensusResponsePB response;
+    rpc::RpcController controller;
+
+    // The time at which the request was sent.
+    MonoTime send_time;
+
+    // Reference-counted pointers to any ReplicateMsgs which are in-flight to
+    // the peer. We may have loaded these messages from the LogCache, in which
+    // case we are potentially sharing the same object as other peers. Since
+    // the PB request itself can't hold reference counts, this holds them.
+    std::vector<ReplicateRefPtr> msg_refs;
+  };
+
+  // Returns a call which isn't in flight, creating one if needed.
+  UpdateCall* TakeFreeCallUnlocked();
+
+  // Marks 'call' as no longer in flight.
+  void ReleaseCallUnlocked(UpdateCall* call);
+
+  // Signals that a response was received from the peer for 'call'.
   //
   // This method is called from the reactor thread and calls
   // DoProcessResponse() on raft_pool_token_ to do any work that requires IO or
   // lock-taking.
-  void ProcessResponse();
+  void ProcessResponse(UpdateCall* call);
 
   // Run on 'raft_pool_token'. Does response handling that requires IO or may block.
-  void DoProcessResponse();
+  void DoProcessResponse(UpdateCall* call);
 
   // Fetch the desired tablet copy request from the queue and set up
   // tc_request_ appropriately.
@@ -153,8 +187,8 @@ class Peer :
   // Handle RPC callback from initiating tablet copy.
   void ProcessTabletCopyResponse();
 
-  // Signals there was an error sending the request to the peer.
-  void ProcessResponseErrorUnlocked(const Status& status);
+  // Signals there was an error sending the request of 'call' to the peer.
+  void ProcessResponseErrorUnlocked(UpdateCall* call, const Status& status);
 
   // Sets 'proxy_' if needed. Returns 'false' if 'proxy_' is not set and a new
   // proxy could not be created. Otherwise returns 'true'.
@@ -183,21 +217,19 @@ class Peer :
   PeerMessageQueue* queue_;
   uint64_t failed_attempts_;
 
-  // The latest consensus update request and response.
-  ConsensusRequestPB request_;
-  ConsensusResponsePB response_;
+  // All the update calls ever created for the peer, and those of them which
+  // aren't in flight. Protected by 'peer_lock_'.
+  std::vector<std::unique_ptr<UpdateCall>> calls_;
+  std::vector<UpdateCall*> free_calls_;
+
+  // The committed index sent in the latest update request. Protected by
+  // 'peer_lock_'.
+  int64_t last_sent_committed_index_;
 
-  // The latest tablet copy request and response.
+  // The latest tablet copy request and response, and the controller of its RPC.
   StartTabletCopyRequestPB tc_request_;
   StartTabletCopyResponsePB tc_response_;
-
-  // Reference-counted pointers to any ReplicateMsgs which are in-flight to the peer. We
-  // may have loaded these messages from the LogCache, in which case we are potentially
-  // sharing the same object as other peers. Since the PB request_ itself can't hold
-  // reference counts, this holds them.
-  std::vector<ReplicateRefPtr> replicate_msg_refs_;
-
-  rpc::RpcController controller_;
+  rpc::RpcController tc_controller_;
 
   std::shared_ptr<rpc::Messenger> messenger_;
 
@@ -210,15 +242,19 @@ class Peer :
   std::shared_ptr<rpc::PeriodicTimer> heartbeater_;
 
   // Lock that protects Peer state changes, initialization, etc. It's necessary
-  // to hold 'peer_lock_' if setting 'request_pending_', 'closed_', and
-  // 'has_sent_first_request_' fields below. To read 'has_sent_first_request_',
-  // it's necessary to hold 'peer_lock_'. To read the 'closed_' and
-  // 'request_pending_' fields, there is no need to hold 'peer_lock_' unless
-  // it's necessary to block the threads which might be setting these fields
-  // concurrently.
+  // to hold 'peer_lock_' if setting 'num_requests_pending_',
+  // 'tablet_copy_pending_', 'closed_', and 'has_sent_first_request_' fields
+  // below. To read 'has_sent_first_request_', it's necessary to hold
+  // 'peer_lock_'. To read the other fields, there is no need to hold
+  // 'peer_lock_' unless it's necessary to block the threads which might be
+  // setting these fields concurrently.
   simple_spinlock peer_lock_;
 
-  std::atomic<bool> request_pending_;
+  // The number of update requests in flight to the peer.
+  std::atomic<int> num_requests_pending_;
+  // Whether a tablet copy request is in flight to the peer. No update
+  // requests are sent meanwhile.
+  std::atomic<bool> tablet_copy_pending_;
   std::atomic<bool> closed_;
   bool has_sent_first_request_;
 };
@@ -257,6 +293,11 @@ class PeerProxy {
 
   // Remote endpoint or description of the peer.
   virtual std::string PeerName() const = 0;
+
+  // Whether the ops of the requests passed to UpdateAsync() may be moved out
+  // of the requests and into their RPC controllers as serialized request
+  // fields instead (see rpc::RpcController::AddSerializedRequestField()).
+  virtual bool SupportsSerializedOps() const { return false; }
 };
 
 // A peer proxy factory. Usually just obtains peers through the rpc implementation
@@ -299,6 +340,8 @@ class RpcPeerProxy : public PeerProxy {
 
   std::string PeerName() const override;
 
+  bool SupportsSerializedOps() const override { return true; }
+
  private:
   const HostPort hostport_;
   std::unique_ptr<ConsensusServiceProxy> consensus_proxy_;
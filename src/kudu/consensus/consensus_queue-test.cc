@@ -527,6 +527,78 @@ TEST_F(ConsensusQueueTest, TestGetPagedMessages) {
   ASSERT_FALSE(send_more_immediately);
 }
 
+// Tests that pipelined requests carry the ops following those of the requests
+// in flight, and that a failed exchange makes the queue start over from the
+// peer's last received op.
+TEST_F(ConsensusQueueTest, TestPipelinedRequests) {
+  queue_->SetLeaderMode(kMinimumOpIdIndex, kMinimumTerm, BuildRaftConfigPBForTests(2));
+
+  // Size the batches so that requests carry 10 ops each (see
+  // TestGetPagedMessages).
+  ConsensusRequestPB page_size_estimator;
+  page_size_estimator.set_caller_term(14);
+  page_size_estimator.set_committed_index(0);
+  page_size_estimator.set_all_replicated_index(0);
+  page_size_estimator.set_last_idx_appended_to_leader(0);
+  page_size_estimator.mutable_preceding_id()->CopyFrom(MinimumOpId());
+  const int kOpsPerRequest = 10;
+  for (int i = 0; i < kOpsPerRequest; i++) {
+    page_size_estimator.mutable_ops()->AddAllocated(
+        CreateDummyReplicate(0, 0, clock_->Now(), 0).release());
+  }
+  FLAGS_consensus_max_batch_size_bytes =
+      static_cast<int32_t>(page_size_estimator.ByteSizeLong());
+
+  ConsensusRequestPB requests[3];
+  ConsensusResponsePB response;
+  response.set_responder_uuid(kPeerUuid);
+  bool send_more_immediately = false;
+  UpdatePeerWatermarkToOp(&requests[0], &response, MinimumOpId(), MinimumOpId(),
+                          &send_more_immediately);
+  AppendReplicateMessagesToQueue(queue_.get(), clock_.get(), 1, 30);
+
+  SCOPED_CLEANUP({
+    // Extract the ops from the requests to avoid double free.
+    for (auto& request : requests) {
+      request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
+    }
+  });
+
+  vector<ReplicateRefPtr> refs[3];
+  bool needs_tablet_copy;
+
+  // The last exchange with the peer failed: it isn't sent pipelined requests.
+  Status s = queue_->RequestForPeer(kPeerUuid, &requests[1], &refs[1], &needs_tablet_copy,
+                                    /*pipelined=*/true);
+  ASSERT_TRUE(s.IsIncomplete()) << s.ToString();
+
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &requests[0], &refs[0], &needs_tablet_copy));
+  ASSERT_EQ(kOpsPerRequest, requests[0].ops_size());
+  ASSERT_EQ(1, requests[0].ops(0).id().index());
+  SetLastReceivedAndLastCommitted(&response, requests[0].ops(kOpsPerRequest - 1).id());
+  ASSERT_TRUE(queue_->ResponseFromPeer(response.responder_uuid(), response));
+
+  // With the peer in sync, the ops of the next requests follow each other
+  // without waiting for the responses.
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &requests[1], &refs[1], &needs_tablet_copy));
+  ASSERT_EQ(11, requests[1].ops(0).id().index());
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &requests[2], &refs[2], &needs_tablet_copy,
+                                   /*pipelined=*/true));
+  ASSERT_EQ(kOpsPerRequest, requests[2].ops_size());
+  ASSERT_EQ(21, requests[2].ops(0).id().index());
+  ASSERT_OPID_EQ(requests[1].ops(kOpsPerRequest - 1).id(), requests[2].preceding_id());
+
+  // Once the requests in flight failed, the peer is caught up from the op
+  // following the last one it received.
+  queue_->UpdatePeerStatus(kPeerUuid, PeerStatus::RPC_LAYER_ERROR,
+                           Status::NetworkError("injected"));
+  s = queue_->RequestForPeer(kPeerUuid, &requests[2], &refs[2], &needs_tablet_copy,
+                             /*pipelined=*/true);
+  ASSERT_TRUE(s.IsIncomplete()) << s.ToString();
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &requests[1], &refs[1], &needs_tablet_copy));
+  ASSERT_EQ(11, requests[1].ops(0).id().index());
+}
+
 TEST_F(ConsensusQueueTest, TestPeersDontAckBeyondWatermarks) {
   queue_->SetLeaderMode(kMinimumOpIdIndex, kMinimumTerm, BuildRaftConfigPBForTests(3));
   AppendReplicateMessagesToQueue(queue_.get(), clock_.get(), 1, 100);
@@ -593,6 +665,46 @@ TEST_F(ConsensusQueueTest, TestPeersDontAckBeyondWatermarks) {
   request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
 }
 
+// Test that the leader lease starts at the latest time a majority of the
+// voters accepted a request sent since, once an op of the term is committed.
+TEST_F(ConsensusQueueTest, TestLeaderLeaseStartTime) {
+  queue_->SetLeaderMode(kMinimumOpIdIndex, kMinimumTerm, BuildRaftConfigPBForTests(3));
+  queue_->TrackPeer(MakePeer("peer-1", RaftPeerPB::VOTER));
+  queue_->TrackPeer(MakePeer("peer-2", RaftPeerPB::VOTER));
+
+  // This adds messages 0.1 -> 0.6, 1.7 -> 1.10 to the queue.
+  AppendReplicateMessagesToQueue(queue_.get(), clock_.get(), 1, 10);
+  WaitForLocalPeerToAckIndex(10);
+  ASSERT_EQ(MonoTime::Min(), queue_->GetLeaderLeaseStartTime());
+
+  ConsensusResponsePB response;
+  response.set_responder_term(1);
+  SetLastReceivedAndLastCommitted(&response, MakeOpId(1, 10), MinimumOpId().index());
+
+  // Once 'peer-1' accepted a request, a majority withholds its votes and an op
+  // of the current term is committed.
+  const MonoTime first_send_time = MonoTime::Now();
+  response.set_responder_uuid("peer-1");
+  queue_->ResponseFromPeer(response.responder_uuid(), response, first_send_time);
+  ASSERT_EQ(10, queue_->GetCommittedIndex());
+  ASSERT_EQ(first_send_time, queue_->GetLeaderLeaseStartTime());
+
+  // A response to a request sent earlier doesn't move the lease backwards.
+  queue_->ResponseFromPeer(response.responder_uuid(), response,
+                           first_send_time - MonoDelta::FromSeconds(1));
+  ASSERT_EQ(first_send_time, queue_->GetLeaderLeaseStartTime());
+
+  // The lease is extended by the latest request accepted by a majority.
+  const MonoTime second_send_time = first_send_time + MonoDelta::FromMilliseconds(10);
+  response.set_responder_uuid("peer-2");
+  queue_->ResponseFromPeer(response.responder_uuid(), response, second_send_time);
+  ASSERT_EQ(second_send_time, queue_->GetLeaderLeaseStartTime());
+
+  // A revoked lease isn't held anymore in the current term.
+  queue_->RevokeLeaderLease();
+  ASSERT_EQ(MonoTime::Min(), queue_->GetLeaderLeaseStartTime());
+}
+
 TEST_F(ConsensusQueueTest, TestQueueAdvancesCommittedIndex) {
   queue_->SetLeaderMode(kMinimumOpIdIndex, kMinimumTerm, BuildRaftConfigPBForTests(5));
   // Track 4 additional peers (in addition to the local peer)
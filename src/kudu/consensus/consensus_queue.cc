@@ -27,6 +27,7 @@
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <gflags/gflags.h>
 
@@ -144,10 +145,12 @@ const char* PeerStatusToString(PeerStatus p) {
 PeerMessageQueue::TrackedPeer::TrackedPeer(RaftPeerPB peer_pb)
     : peer_pb(std::move(peer_pb)),
       next_index(kInvalidOpIdIndex),
+      next_pipelined_index(kInvalidOpIdIndex),
       last_received(MinimumOpId()),
       last_known_committed_index(MinimumOpId().index()),
       last_exchange_status(PeerStatus::NEW),
       last_communication_time(MonoTime::Now()),
+      last_accepted_request_time(MonoTime::Min()),
       wal_catchup_possible(true),
       remote_server_quiescing(false),
       last_overall_health_status(HealthReportPB::UNKNOWN),
@@ -205,6 +208,7 @@ PeerMessageQueue::PeerMessageQueue(const scoped_refptr<MetricEntity>& metric_ent
   queue_state_.last_idx_appended_to_leader = 0;
   queue_state_.mode = NON_LEADER;
   queue_state_.majority_size_ = -1;
+  queue_state_.leader_lease_revoked = false;
   queue_state_.last_appended = std::move(last_locally_replicated);
   queue_state_.committed_index = last_locally_committed.index();
   queue_state_.state = kQueueOpen;
@@ -220,6 +224,11 @@ void PeerMessageQueue::SetLeaderMode(int64_t committed_index,
     CHECK_GT(current_term, queue_state_.current_term) << "Terms should only increase";
     queue_state_.first_index_in_current_term.reset();
     queue_state_.current_term = current_term;
+    queue_state_.leader_lease_revoked = false;
+    // Requests accepted in former terms don't count towards the lease.
+    for (const PeersMap::value_type& entry : peers_map_) {
+      entry.second->last_accepted_request_time = MonoTime::Min();
+    }
   }
 
   queue_state_.committed_index = committed_index;
@@ -643,7 +652,8 @@ HealthReportPB::HealthStatus PeerMessageQueue::PeerHealthStatus(const TrackedPee
 Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         ConsensusRequestPB* request,
                                         vector<ReplicateRefPtr>* msg_refs,
-                                        bool* needs_tablet_copy) {
+                                        bool* needs_tablet_copy,
+                                        bool pipelined) {
   // Maintain a thread-safe copy of necessary members.
   OpId preceding_id;
   int64_t current_term;
@@ -664,6 +674,15 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     // Clear the requests without deleting the entries, as they may be in use by other peers.
     request->mutable_ops()->ExtractSubrange(0, request->ops_size(), nullptr);
 
+    if (pipelined) {
+      if (peer->last_exchange_status != PeerStatus::OK) {
+        return Status::Incomplete(Substitute("not pipelining requests to peer $0: $1",
+                                             uuid, PeerStatusToString(peer->last_exchange_status)));
+      }
+      // Continue from the ops of the requests in flight.
+      peer_copy.next_index = std::max(peer->next_index, peer->next_pipelined_index);
+    }
+
     // This is initialized to the queue's last appended op but gets set to the id of the
     // log entry preceding the first one in 'messages' if messages are found for the peer.
     preceding_id = queue_state_.last_appended;
@@ -679,6 +698,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   // Always trigger a health status update check at the end of this function.
   bool wal_catchup_progress = false;
   bool wal_catchup_failure = false;
+  int64_t next_pipelined_index = kInvalidOpIdIndex;
   SCOPED_CLEANUP({
       std::lock_guard<simple_spinlock> lock(queue_lock_);
       TrackedPeer* peer = FindPtrOrNull(peers_map_, uuid);
@@ -689,6 +709,9 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
       }
       if (wal_catchup_progress) peer->wal_catchup_possible = true;
       if (wal_catchup_failure) peer->wal_catchup_possible = false;
+      if (next_pipelined_index != kInvalidOpIdIndex) {
+        peer->next_pipelined_index = next_pipelined_index;
+      }
       UpdatePeerHealthUnlocked(peer);
     });
 
@@ -768,6 +791,9 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     for (const ReplicateRefPtr& msg : messages) {
       request->mutable_ops()->AddAllocated(msg->get());
     }
+    if (!messages.empty()) {
+      next_pipelined_index = messages.back()->get()->id().index() + 1;
+    }
     msg_refs->swap(messages);
   }
 
@@ -963,6 +989,9 @@ void PeerMessageQueue::UpdatePeerStatus(const string& peer_uuid,
     return;
   }
   peer->last_exchange_status = ps;
+  if (ps != PeerStatus::OK) {
+    peer->next_pipelined_index = kInvalidOpIdIndex;
+  }
 
   if (ps != PeerStatus::RPC_LAYER_ERROR) {
     // So long as we got _any_ response from the follower, we consider it a 'communication'.
@@ -1023,6 +1052,8 @@ void PeerMessageQueue::UpdateExchangeStatus(TrackedPeer* peer,
     *lmp_mismatch = false;
     return;
   }
+  // The requests still in flight to the peer can't be relied upon anymore.
+  peer->next_pipelined_index = kInvalidOpIdIndex;
 
   switch (status.error().code()) {
     case ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH:
@@ -1140,7 +1171,8 @@ void PeerMessageQueue::TransferLeadershipIfNeeded(const TrackedPeer& peer,
 }
 
 bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
-                                        const ConsensusResponsePB& response) {
+                                        const ConsensusResponsePB& response,
+                                        MonoTime request_send_time) {
   DCHECK(response.IsInitialized()) << "Error: Uninitialized: "
       << response.InitializationErrorString() << ". Response: " << SecureShortDebugString(response);
   CHECK(!response.has_error());
@@ -1184,6 +1216,14 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
     // offset between the local leader and the remote peer.
     UpdateExchangeStatus(peer, prev_peer_state, response, &send_more_immediately);
 
+    // A peer which accepted the request withholds its vote from now on.
+    if (request_send_time.Initialized() && !status.has_error() &&
+        (!response.has_responder_term() ||
+         response.responder_term() == queue_state_.current_term) &&
+        request_send_time > peer->last_accepted_request_time) {
+      peer->last_accepted_request_time = request_send_time;
+    }
+
     // If the peer is hosted on a server that is quiescing, note that now.
     peer->remote_server_quiescing = response.has_server_quiescing() &&
                                     response.server_quiescing();
@@ -1345,6 +1385,27 @@ int64_t PeerMessageQueue::GetCommittedIndex() const {
   return queue_state_.committed_index;
 }
 
+void PeerMessageQueue::EnableLogCacheReadAhead(unique_ptr<ThreadPoolToken> token) {
+  log_cache_.EnableReadAhead(std::move(token));
+}
+
+Status PeerMessageQueue::ReadCommittedOps(int64_t after_op_index,
+                                          int64_t max_size_bytes,
+                                          vector<ReplicateRefPtr>* ops) {
+  ops->clear();
+  const int64_t committed_index = GetCommittedIndex();
+  if (after_op_index >= committed_index) {
+    return Status::OK();
+  }
+  OpId preceding_op;
+  RETURN_NOT_OK(log_cache_.ReadOps(after_op_index, max_size_bytes, ops, &preceding_op));
+  // Leave out the ops which aren't committed yet.
+  while (!ops->empty() && ops->back()->get()->id().index() > committed_index) {
+    ops->pop_back();
+  }
+  return Status::OK();
+}
+
 bool PeerMessageQueue::IsCommittedIndexInCurrentTerm() const {
   std::lock_guard<simple_spinlock> lock(queue_lock_);
   return queue_state_.first_index_in_current_term.has_value() &&
@@ -1356,6 +1417,41 @@ bool PeerMessageQueue::IsInLeaderMode() const {
   return queue_state_.mode == Mode::LEADER;
 }
 
+MonoTime PeerMessageQueue::GetLeaderLeaseStartTime() const {
+  std::lock_guard<simple_spinlock> lock(queue_lock_);
+  if (queue_state_.mode != Mode::LEADER ||
+      queue_state_.leader_lease_revoked ||
+      !queue_state_.first_index_in_current_term.has_value() ||
+      queue_state_.committed_index < *queue_state_.first_index_in_current_term) {
+    return MonoTime::Min();
+  }
+  vector<MonoTime> times;
+  for (const auto& peer : queue_state_.active_config->peers()) {
+    if (peer.member_type() != RaftPeerPB::VOTER) {
+      continue;
+    }
+    if (peer.permanent_uuid() == local_peer_pb_.permanent_uuid()) {
+      // The leader doesn't vote for other candidates in its own term.
+      times.emplace_back(MonoTime::Max());
+      continue;
+    }
+    const TrackedPeer* tracked = FindPtrOrNull(peers_map_, peer.permanent_uuid());
+    times.emplace_back(tracked ? tracked->last_accepted_request_time : MonoTime::Min());
+  }
+  const int majority_size = queue_state_.majority_size_;
+  if (majority_size <= 0 || times.size() < static_cast<size_t>(majority_size)) {
+    return MonoTime::Min();
+  }
+  std::nth_element(times.begin(), times.begin() + majority_size - 1, times.end(),
+                   std::greater<MonoTime>());
+  return times[majority_size - 1];
+}
+
+void PeerMessageQueue::RevokeLeaderLease() {
+  std::lock_guard<simple_spinlock> lock(queue_lock_);
+  queue_state_.leader_lease_revoked = true;
+}
+
 int64_t PeerMessageQueue::GetMajorityReplicatedIndexForTests() const {
   std::lock_guard<simple_spinlock> lock(queue_lock_);
   return queue_state_.majority_replicated_index;
@@ -108,9 +108,8 @@ const char* PeerStatusToString(PeerStatus p);
 // This also takes care of pushing requests to peers as new operations are
 // added, and notifying RaftConsensus when the commit index advances.
 //
-// TODO(todd): Right now this class is able to track one outstanding operation
-// per peer. If we want to have more than one outstanding RPC we need to
-// modify it.
+// A peer may have more than one request in flight: see the 'pipelined'
+// argument of RequestForPeer().
 class PeerMessageQueue {
  public:
   struct TrackedPeer {
@@ -140,6 +139,12 @@ class PeerMessageQueue {
     // This corresponds to "nextIndex" as specified in Raft.
     int64_t next_index;
 
+    // The index following the last op sent to this peer in a request which
+    // may still be in flight: pipelined requests continue from there instead
+    // of from 'next_index'. Reset upon a failed exchange with the peer, since
+    // the requests in flight then can't be relied upon.
+    int64_t next_pipelined_index;
+
     // The last operation that we've sent to this peer and that
     // it acked. Used for watermark movement.
     OpId last_received;
@@ -162,6 +167,13 @@ class PeerMessageQueue {
     // successful communication ever took place.
     MonoTime last_communication_time;
 
+    // The time at which the latest request the peer accepted from this leader
+    // in the current term was sent. Upon accepting a request, a peer withholds
+    // its vote from other candidates for the minimum election timeout, which
+    // is what leader leases rely upon. MonoTime::Min() if the peer hasn't
+    // accepted any request yet.
+    MonoTime last_accepted_request_time;
+
     // Set to false if it is determined that the remote peer has fallen behind
     // the local peer's WAL.
     bool wal_catchup_possible;
@@ -272,10 +284,17 @@ class PeerMessageQueue {
   // instance of ConsensusRequestPB to RequestForPeer(): the buffer will
   // replace the old entries with new ones without de-allocating the old
   // ones if they are still required.
+  //
+  // If 'pipelined' is true, the request is meant to be sent while other
+  // requests to the peer are still in flight: its ops follow those of the
+  // previous requests rather than starting at the peer's 'next_index'.
+  // Returns Status::Incomplete if the last exchange with the peer failed, in
+  // which case the peer has to be caught up with non-pipelined requests first.
   Status RequestForPeer(const std::string& uuid,
                         ConsensusRequestPB* request,
                         std::vector<ReplicateRefPtr>* msg_refs,
-                        bool* needs_tablet_copy);
+                        bool* needs_tablet_copy,
+                        bool pipelined = false);
 
   // Fill in a StartTabletCopyRequest for the specified peer.
   // If that peer should not initiate Tablet Copy, returns a non-OK status.
@@ -296,8 +315,12 @@ class PeerMessageQueue {
   // Returns true iff there are more requests pending in the queue for this
   // peer and another request should be sent immediately, with no intervening
   // delay.
+  //
+  // 'request_send_time' is the time at which the request was sent, if known.
+  // It's used to extend the leader lease: see GetLeaderLeaseStartTime().
   bool ResponseFromPeer(const std::string& peer_uuid,
-                        const ConsensusResponsePB& response);
+                        const ConsensusResponsePB& response,
+                        MonoTime request_send_time = MonoTime());
 
   // Called by the consensus implementation to update the queue's watermarks
   // based on information provided by the leader. This is used for metrics and
@@ -323,12 +346,39 @@ class PeerMessageQueue {
   // this index have been committed.
   int64_t GetCommittedIndex() const;
 
+  // Reads the committed ops following 'after_op_index' from the log cache, in
+  // op order, limited in size as LogCache::ReadOps() does. 'ops' is left empty
+  // if no op following 'after_op_index' is committed yet.
+  //
+  // These may be read from disk, so this must not be called with important
+  // locks held.
+  Status ReadCommittedOps(int64_t after_op_index,
+                          int64_t max_size_bytes,
+                          std::vector<ReplicateRefPtr>* ops);
+
   // Return true if the committed index falls within the current term.
   bool IsCommittedIndexInCurrentTerm() const;
 
+  // Enables reading ahead the ops read from the log on 'token'.
+  // See LogCache::EnableReadAhead().
+  void EnableLogCacheReadAhead(std::unique_ptr<ThreadPoolToken> token);
+
   // Whether the queue run in the leader mode.
   bool IsInLeaderMode() const;
 
+  // Returns the latest time such that a majority of the voters accepted a
+  // request from this leader sent at or after that time in the current term;
+  // this leader's lease lasts for the minimum election timeout from then on.
+  // Returns MonoTime::Min() if there is no such time, if the queue
+  // isn't in leader mode, if no op of the current term is committed yet, or
+  // if the lease was revoked in the current term.
+  MonoTime GetLeaderLeaseStartTime() const;
+
+  // Revokes the leader lease until the term changes. This must be called
+  // before letting another replica run an election ignoring this leader, e.g.
+  // when transferring the leadership.
+  void RevokeLeaderLease();
+
   // Returns the current majority replicated index, for tests.
   int64_t GetMajorityReplicatedIndexForTests() const;
 
@@ -433,6 +483,9 @@ class PeerMessageQueue {
     // The size of the majority for the queue.
     int majority_size_;
 
+    // Whether the leader lease was revoked in the current term.
+    bool leader_lease_revoked;
+
     State state;
 
     // The current mode of the queue.
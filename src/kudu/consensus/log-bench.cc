@@ -0,0 +1,342 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Benchmark of the latency of the appends to the WAL across durability modes.
+//
+// Unlike benchmarks/wal_hiccup, which writes a synthetic file pattern, this
+// goes through the real Log: concurrent writers append batches of write ops
+// which are group committed, compressed with --log_compression_codec, and
+// written into segments which are preallocated and rolled over as they fill
+// up. Each writer appends one batch at a time and measures how long its batch
+// takes to be durable as per the mode, as a replica waits for its WAL before
+// acknowledging writes.
+//
+// The modes are the combinations of the fsync policy (none, one fsync per
+// group, or fsyncs shared across the logs of the filesystem) and of the I/O
+// path (pwritev(2), or io_uring(7) where the kernel supports it). For each
+// mode, the distribution of the latencies of the batches is reported along
+// with the group commit and sync latencies of the log, and the batches slower
+// than --log_bench_hiccup_threshold_ms are reported as hiccups. The results
+// are logged, and written as CSV into --log_bench_results_file if set.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/row_operations.pb.h"
+#include "kudu/common/wire_protocol-test-util.h"
+#include "kudu/consensus/consensus.pb.h"
+#include "kudu/consensus/log-test-base.h"
+#include "kudu/consensus/log.h"
+#include "kudu/consensus/opid.pb.h"
+#include "kudu/consensus/ref_counted_replicate.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/split.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/async_util.h"
+#include "kudu/util/env.h"
+#include "kudu/util/hdr_histogram.h"
+#include "kudu/util/io_uring.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/random.h"
+#include "kudu/util/random_util.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DEFINE_string(log_bench_modes, "",
+              "Comma-separated list of the modes to benchmark, among 'none', 'fsync' "
+              "and 'shared_fsync', each optionally suffixed with '+io_uring'. "
+              "All of them if empty");
+DEFINE_int32(log_bench_num_writers, 4, "Number of threads appending to the log");
+DEFINE_int32(log_bench_batches_per_writer, 2000, "Number of batches each writer appends");
+DEFINE_int32(log_bench_ops_per_batch, 5, "Number of write ops per batch");
+DEFINE_int32(log_bench_payload_bytes, 1024,
+             "Size of the random, hence incompressible, payload of each write op");
+DEFINE_int32(log_bench_segment_size_mb, 8, "Size of the segments of the log");
+DEFINE_int32(log_bench_hiccup_threshold_ms, 50,
+             "Latency above which the append of a batch is reported as a hiccup");
+DEFINE_string(log_bench_results_file, "",
+              "If set, the results are written as CSV into this file");
+
+DECLARE_bool(env_use_io_uring);
+
+METRIC_DECLARE_histogram(log_entry_batches_per_group);
+METRIC_DECLARE_histogram(log_group_commit_latency);
+METRIC_DECLARE_histogram(log_roll_latency);
+METRIC_DECLARE_histogram(log_sync_latency);
+
+using kudu::consensus::make_scoped_refptr_replicate;
+using kudu::consensus::ReplicateMsg;
+using kudu::consensus::ReplicateRefPtr;
+using kudu::consensus::WRITE_OP;
+using std::string;
+using std::thread;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace log {
+
+namespace {
+
+struct Mode {
+  enum Sync {
+    // The segments are written but not synced.
+    NONE,
+    // Each group of batches is fsynced.
+    FSYNC,
+    // The fsyncs are shared across the logs of the filesystem.
+    SHARED_FSYNC,
+  };
+  Sync sync;
+  bool io_uring;
+
+  string name() const {
+    static const char* const kSyncNames[] = { "none", "fsync", "shared_fsync" };
+    return Substitute("$0$1", kSyncNames[sync], io_uring ? "+io_uring" : "");
+  }
+};
+
+// The latencies above which the measurements are clamped.
+const uint64_t kMaxLatencyUs = 60 * 1000 * 1000;
+
+struct Hiccup {
+  // The time since the start of the run the batch was appended at.
+  double start_secs;
+  uint64_t latency_us;
+};
+
+struct BenchResult {
+  string mode;
+  int64_t num_batches;
+  double elapsed_secs;
+  uint64_t batch_p50_us;
+  uint64_t batch_p99_us;
+  uint64_t batch_p999_us;
+  uint64_t batch_max_us;
+  uint64_t group_commit_p99_us;
+  uint64_t sync_p99_us;
+  double batches_per_group;
+  int64_t num_rolls;
+  size_t num_hiccups;
+
+  static string CsvHeader() {
+    return "mode,batches,batches_per_sec,batch_p50_us,batch_p99_us,batch_p999_us,"
+           "batch_max_us,group_commit_p99_us,sync_p99_us,batches_per_group,rolls,hiccups";
+  }
+
+  string ToCsv() const {
+    return Substitute("$0,$1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11",
+                      mode, num_batches, StringPrintf("%.0f", num_batches / elapsed_secs),
+                      batch_p50_us, batch_p99_us, batch_p999_us, batch_max_us,
+                      group_commit_p99_us, sync_p99_us,
+                      StringPrintf("%.2f", batches_per_group), num_rolls, num_hiccups);
+  }
+};
+
+} // anonymous namespace
+
+class LogBench : public LogTestBase {
+ protected:
+  void TearDown() override {
+    if (!FLAGS_log_bench_results_file.empty()) {
+      string csv = BenchResult::CsvHeader() + "\n";
+      for (const auto& result : results_) {
+        csv += result.ToCsv() + "\n";
+      }
+      ASSERT_OK(WriteStringToFile(env_, csv, FLAGS_log_bench_results_file));
+    }
+    LogTestBase::TearDown();
+  }
+
+  static Status ParseModes(vector<Mode>* modes) {
+    const bool io_uring_supported = IoUring::ForCurrentThread() != nullptr;
+    if (FLAGS_log_bench_modes.empty()) {
+      for (bool io_uring : { false, true }) {
+        if (io_uring && !io_uring_supported) {
+          LOG(WARNING) << "io_uring is not supported: skipping the io_uring modes";
+          continue;
+        }
+        for (auto sync : { Mode::NONE, Mode::FSYNC, Mode::SHARED_FSYNC }) {
+          modes->push_back({ sync, io_uring });
+        }
+      }
+      return Status::OK();
+    }
+    const vector<string> names = strings::Split(FLAGS_log_bench_modes, ",",
+                                                strings::SkipEmpty());
+    for (const auto& name : names) {
+      bool found = false;
+      for (bool io_uring : { false, true }) {
+        for (auto sync : { Mode::NONE, Mode::FSYNC, Mode::SHARED_FSYNC }) {
+          const Mode mode = { sync, io_uring };
+          if (mode.name() == name) {
+            if (io_uring && !io_uring_supported) {
+              return Status::NotSupported("io_uring is not supported", name);
+            }
+            modes->push_back(mode);
+            found = true;
+          }
+        }
+      }
+      if (!found) {
+        return Status::InvalidArgument("unknown mode", name);
+      }
+    }
+    return Status::OK();
+  }
+
+  void RunMode(const Mode& mode) {
+    FLAGS_env_use_io_uring = mode.io_uring;
+    options_.segment_size_mb = FLAGS_log_bench_segment_size_mb;
+    options_.force_fsync_all = mode.sync != Mode::NONE;
+    options_.share_fsyncs = mode.sync == Mode::SHARED_FSYNC;
+    // Measure each mode with metrics of its own.
+    metric_entity_tablet_ = METRIC_ENTITY_tablet.Instantiate(metric_registry_.get(),
+                                                             mode.name());
+    current_index_ = kStartIndex;
+    ASSERT_OK(BuildLog());
+
+    HdrHistogram batch_hist(kMaxLatencyUs, 2);
+    vector<Hiccup> hiccups;
+    vector<Status> statuses(FLAGS_log_bench_num_writers);
+    const MonoTime start = MonoTime::Now();
+    vector<thread> writers;
+    for (int i = 0; i < FLAGS_log_bench_num_writers; i++) {
+      writers.emplace_back([&, i]() {
+        statuses[i] = WriteBatches(start, &batch_hist, &hiccups);
+      });
+    }
+    for (auto& t : writers) {
+      t.join();
+    }
+    const double elapsed_secs = (MonoTime::Now() - start).ToSeconds();
+    for (const auto& s : statuses) {
+      ASSERT_OK(s);
+    }
+    ASSERT_OK(log_->Close());
+
+    BenchResult result;
+    result.mode = mode.name();
+    result.num_batches = batch_hist.TotalCount();
+    result.elapsed_secs = elapsed_secs;
+    result.batch_p50_us = batch_hist.ValueAtPercentile(50);
+    result.batch_p99_us = batch_hist.ValueAtPercentile(99);
+    result.batch_p999_us = batch_hist.ValueAtPercentile(99.9);
+    result.batch_max_us = batch_hist.MaxValue();
+    result.group_commit_p99_us = METRIC_log_group_commit_latency.Instantiate(
+        metric_entity_tablet_)->histogram()->ValueAtPercentile(99);
+    result.sync_p99_us = METRIC_log_sync_latency.Instantiate(
+        metric_entity_tablet_)->histogram()->ValueAtPercentile(99);
+    result.batches_per_group = METRIC_log_entry_batches_per_group.Instantiate(
+        metric_entity_tablet_)->histogram()->MeanValue();
+    result.num_rolls = METRIC_log_roll_latency.Instantiate(metric_entity_tablet_)->TotalCount();
+    result.num_hiccups = hiccups.size();
+    LOG(INFO) << BenchResult::CsvHeader() << "\n" << result.ToCsv();
+
+    // Report the worst hiccups, in the order they happened.
+    std::sort(hiccups.begin(), hiccups.end(), [](const Hiccup& a, const Hiccup& b) {
+      return a.latency_us > b.latency_us;
+    });
+    hiccups.resize(std::min<size_t>(hiccups.size(), 10));
+    std::sort(hiccups.begin(), hiccups.end(), [](const Hiccup& a, const Hiccup& b) {
+      return a.start_secs < b.start_secs;
+    });
+    for (const auto& hiccup : hiccups) {
+      LOG(INFO) << Substitute("$0: hiccup of $1 ms at $2 s", mode.name(),
+                              hiccup.latency_us / 1000, StringPrintf("%.3f", hiccup.start_secs));
+    }
+    results_.push_back(std::move(result));
+
+    log_.reset();
+    ASSERT_OK(Log::DeleteOnDiskData(fs_manager_.get(), kTestTablet));
+  }
+
+ private:
+  // Appends --log_bench_batches_per_writer batches one after the other,
+  // recording their latencies into 'hist' and their hiccups into 'hiccups'.
+  Status WriteBatches(const MonoTime& start, HdrHistogram* hist, vector<Hiccup>* hiccups) {
+    Random rng(SeedRandom());
+    const string payload = RandomString(FLAGS_log_bench_payload_bytes, &rng);
+    for (int i = 0; i < FLAGS_log_bench_batches_per_writer; i++) {
+      vector<ReplicateRefPtr> batch;
+      for (int j = 0; j < FLAGS_log_bench_ops_per_batch; j++) {
+        ReplicateRefPtr replicate = make_scoped_refptr_replicate(new ReplicateMsg);
+        replicate->get()->set_op_type(WRITE_OP);
+        replicate->get()->set_timestamp(clock_->Now().ToUint64());
+        tserver::WriteRequestPB* request = replicate->get()->mutable_write_request();
+        request->set_tablet_id(kTestTablet);
+        AddTestRowToPB(RowOperationsPB::INSERT, schema_, static_cast<int32_t>(rng.Next()), 0,
+                       payload, request->mutable_row_operations());
+        batch.push_back(std::move(replicate));
+      }
+
+      Synchronizer s;
+      const MonoTime batch_start = MonoTime::Now();
+      {
+        // Assign the indexes and append under the lock, so that the order of
+        // the indexes matches the order of the log.
+        std::lock_guard<simple_spinlock> l(lock_);
+        for (auto& replicate : batch) {
+          consensus::OpId* op_id = replicate->get()->mutable_id();
+          op_id->set_term(1);
+          op_id->set_index(current_index_++);
+        }
+        RETURN_NOT_OK(log_->AsyncAppendReplicates(batch, s.AsStatusCallback()));
+      }
+      RETURN_NOT_OK(s.Wait());
+      const uint64_t latency_us = std::min<uint64_t>(
+          (MonoTime::Now() - batch_start).ToMicroseconds(), kMaxLatencyUs);
+      hist->Increment(latency_us);
+      if (latency_us > FLAGS_log_bench_hiccup_threshold_ms * 1000) {
+        std::lock_guard<simple_spinlock> l(lock_);
+        hiccups->push_back({ (batch_start - start).ToSeconds(), latency_us });
+      }
+    }
+    return Status::OK();
+  }
+
+  // Protects 'current_index_', the order of the appends and the hiccups.
+  simple_spinlock lock_;
+  vector<BenchResult> results_;
+};
+
+TEST_F(LogBench, BenchDurabilityModes) {
+  vector<Mode> modes;
+  ASSERT_OK(ParseModes(&modes));
+  for (const auto& mode : modes) {
+    NO_FATALS(RunMode(mode));
+  }
+}
+
+} // namespace log
+} // namespace kudu
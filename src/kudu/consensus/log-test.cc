@@ -66,6 +66,7 @@ DEFINE_int32(num_batches, 10000,
 
 DECLARE_int32(log_min_segments_to_retain);
 DECLARE_int32(log_max_segments_to_retain);
+DECLARE_int32(log_max_recycled_segments);
 DECLARE_double(log_inject_io_error_on_preallocate_fraction);
 DECLARE_int64(fs_wal_dir_reserved_bytes);
 DECLARE_int64(disk_reserved_bytes_free_for_testing);
@@ -250,6 +251,25 @@ TEST_P(LogTestOptionalCompression, TestFsync) {
   ASSERT_OK(log_->Close());
 }
 
+#if defined(__linux__)
+// Tests that the fsyncs of the log may be served by syncfs(2) calls shared
+// with the logs of other tablets.
+TEST_P(LogTestOptionalCompression, TestSharedFsyncs) {
+  options_.force_fsync_all = true;
+  options_.share_fsyncs = true;
+  ASSERT_OK(BuildLog());
+  auto* shared_sync = SharedLogSync::ForDir(env_, fs_manager_->GetWalsRootDir());
+  const int64_t initial_syncs = shared_sync->num_filesystem_syncs();
+
+  OpId opid = MakeOpId(0, 1);
+  ASSERT_OK(AppendNoOps(&opid, 10));
+  ASSERT_GT(shared_sync->num_filesystem_syncs(), initial_syncs);
+
+  ASSERT_OK(log_->Close());
+  NO_FATALS(CheckRightNumberOfSegmentFiles(1));
+}
+#endif
+
 // Regression test for part of KUDU-735:
 // if a log is not preallocated, we should properly track its on-disk size as we append to
 // it.
@@ -609,6 +629,67 @@ TEST_P(LogTestOptionalCompression, TestGCWithLogRunning) {
   }
 }
 
+// Tests that the files of GC'd segments are recycled by new segments.
+TEST_P(LogTestOptionalCompression, TestRecycleGCedSegments) {
+  FLAGS_log_min_segments_to_retain = 1;
+  FLAGS_log_max_recycled_segments = 2;
+  ASSERT_OK(BuildLog());
+
+  const string log_dir = JoinPathSegments(fs_manager_->GetWalsRootDir(), kTestTablet);
+  auto num_recycled_files = [&]() {
+    vector<string> files;
+    CHECK_OK(env_->GetChildren(log_dir, &files));
+    return std::count_if(files.begin(), files.end(), [](const string& f) {
+      return f.find(".recycled") != string::npos;
+    });
+  };
+
+  vector<LogAnchor*> anchors;
+  ElementDeleter deleter(&anchors);
+  const int kNumOpsPerSegment = 5;
+  OpId op_id = MakeOpId(1, 1);
+  ASSERT_OK(AppendMultiSegmentSequence(4, kNumOpsPerSegment, &op_id, &anchors));
+  for (auto* anchor : anchors) {
+    ASSERT_OK(log_anchor_registry_->Unregister(anchor));
+  }
+
+  // Only two of the GC'd segments' files are kept.
+  int num_gced_segments;
+  ASSERT_OK(log_->GC(RetentionIndexes(op_id.index(), op_id.index()), &num_gced_segments));
+  ASSERT_EQ(3, num_gced_segments);
+  NO_FATALS(CheckRightNumberOfSegmentFiles(1));
+  ASSERT_EQ(2, num_recycled_files());
+
+  // New segments reuse the recycled files.
+  const int64_t first_new_index = op_id.index();
+  ASSERT_OK(RollLog());
+  ASSERT_OK(AppendMultiSegmentSequence(2, kNumOpsPerSegment, &op_id, nullptr));
+  ASSERT_EQ(0, num_recycled_files());
+  NO_FATALS(CheckRightNumberOfSegmentFiles(3));
+
+  // The entries of the reused files can't be read back as part of the new
+  // segments, whether the log is running or reopened.
+  for (int i = 0; i < 2; i++) {
+    vector<ReplicateMsg*> repls;
+    ElementDeleter d(&repls);
+    ASSERT_OK(log_->reader()->ReadReplicatesInRange(
+        first_new_index, op_id.index() - 1, LogReader::kNoSizeLimit, &repls));
+    ASSERT_EQ(2 * kNumOpsPerSegment, repls.size());
+    ASSERT_EQ(first_new_index, repls.front()->id().index());
+    SegmentSequence segments;
+    log_->reader()->GetSegmentsSnapshot(&segments);
+    for (const auto& segment : segments) {
+      if (segment->HasFooter()) {
+        ASSERT_EQ(kNumOpsPerSegment, segment->footer().num_entries());
+      }
+    }
+    ASSERT_OK(log_->Close());
+    if (i == 0) {
+      ASSERT_OK(BuildLog());
+    }
+  }
+}
+
 // Test that, when we are set to retain a given number of log segments,
 // we also retain any relevant log index chunks, even if those operations
 // are not necessary for recovery.
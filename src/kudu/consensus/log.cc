@@ -17,6 +17,7 @@
 
 #include "kudu/consensus/log.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdint>
 #include <functional>
@@ -43,6 +44,7 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/strings/util.h"
 #include "kudu/gutil/walltime.h"
 #include "kudu/util/async_util.h"
 #include "kudu/util/compression/compression_codec.h"
@@ -80,6 +82,15 @@ TAG_FLAG(log_max_segments_to_retain, runtime);
 TAG_FLAG(log_max_segments_to_retain, advanced);
 TAG_FLAG(log_max_segments_to_retain, experimental);
 
+DEFINE_int32(log_max_recycled_segments, 0,
+             "The maximum number of GC'd log segment files to keep per tablet "
+             "to be reused by new segments, instead of deleting them and "
+             "allocating new files. Reusing files avoids the filesystem metadata "
+             "updates and extent allocations of new segments, which can show up "
+             "as latency spikes of the syncs of the log. If 0, GC'd segment "
+             "files are deleted.");
+TAG_FLAG(log_max_recycled_segments, runtime);
+TAG_FLAG(log_max_recycled_segments, experimental);
 
 // Group commit configuration.
 // -----------------------------
@@ -87,6 +98,23 @@ DEFINE_int32(group_commit_queue_size_bytes, 4 * 1024 * 1024,
              "Maximum size of the group commit queue in bytes");
 TAG_FLAG(group_commit_queue_size_bytes, advanced);
 
+DEFINE_int32(log_group_commit_target_latency_us, 0,
+             "Target latency of a group commit, in microseconds. If positive, "
+             "when entries are appended concurrently, the log append thread "
+             "holds a group open to collect more entries for as long as the "
+             "average time to write and sync a group stays under the target, "
+             "so that more entries share an fsync. If 0, a group is written as "
+             "soon as entries are available.");
+TAG_FLAG(log_group_commit_target_latency_us, experimental);
+TAG_FLAG(log_group_commit_target_latency_us, runtime);
+
+DEFINE_bool(log_group_commit_pipeline, false,
+            "Whether to sync each group commit group from a separate thread, "
+            "so that the entries of the next group are compressed while the "
+            "current one is synced.");
+TAG_FLAG(log_group_commit_pipeline, experimental);
+TAG_FLAG(log_group_commit_pipeline, runtime);
+
 
 DEFINE_int32(log_thread_idle_threshold_ms, 1000,
              "Number of milliseconds after which the log append thread decides that a "
@@ -187,6 +215,16 @@ using strings::Substitute;
 namespace kudu {
 namespace log {
 
+namespace {
+
+// Appended to the path of a GC'd segment to name its recycled file. Contains
+// kTmpInfix so that leftover recycled files are cleaned up at startup.
+string RecycledSegmentSuffix() {
+  return Substitute("$0.recycled", kTmpInfix);
+}
+
+} // anonymous namespace
+
 string LogContext::LogPrefix() const {
   return Substitute("T $0 P $1: ", tablet_id, fs_manager->uuid());
 }
@@ -215,6 +253,11 @@ string LogContext::LogPrefix() const {
 //    This is done in GoIdle().
 //
 // See the implementation comments in Wake() and GoIdle() for details.
+//
+// If --log_group_commit_pipeline is set, the sync of a group runs on a second
+// single-threaded pool, while the task compresses the group queued behind it.
+// The group in flight is completed (its callbacks run) before the next group
+// is written, so groups still complete in order.
 class Log::AppendThread {
  public:
   explicit AppendThread(Log* log);
@@ -248,9 +291,23 @@ class Log::AppendThread {
   // a new task was enqueued just as we were trying to go idle.
   bool GoIdle();
 
+  // If --log_group_commit_target_latency_us is set and the last group was
+  // made of concurrent appends, collects more batches into 'entry_batches' for
+  // as long as the target latency allows.
+  void MaybeHoldGroup(vector<unique_ptr<LogEntryBatch>>* entry_batches);
+
   // Handle the actual appending of a group of entries.
   void HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_batches);
 
+  // Waits for the sync of the group in flight on 'sync_pool_', if any, and
+  // completes it.
+  void FinishSync();
+
+  // Completes a group written at 'start' and synced with status 's', running
+  // the callbacks of its batches.
+  void CompleteGroup(vector<unique_ptr<LogEntryBatch>> entry_batches,
+                     const Status& s, MonoTime start);
+
   string LogPrefix() const;
 
   Log* const log_;
@@ -268,6 +325,23 @@ class Log::AppendThread {
   // Pool with a single thread, which handles shutting down the thread
   // when idle.
   unique_ptr<ThreadPool> append_pool_;
+
+  // Pool with a single thread syncing the group in flight, if pipelining.
+  unique_ptr<ThreadPool> sync_pool_;
+
+  // The group in flight: written, and being synced on 'sync_pool_'. Along with
+  // the time it started being written and the status of its sync, set by the
+  // sync task.
+  vector<unique_ptr<LogEntryBatch>> syncing_batches_;
+  MonoTime syncing_start_;
+  Status sync_status_;
+
+  // The number of batches in the last group.
+  size_t last_group_size_ = 0;
+
+  // Moving average of the time taken to write and sync a group, excluding
+  // the time it was held open, in microseconds.
+  int64_t avg_commit_us_ = 0;
 };
 
 
@@ -287,6 +361,10 @@ Status Log::AppendThread::Init() {
                 // handles waiting for work while idle.
                 .set_idle_timeout(MonoDelta::FromSeconds(0))
                 .Build(&append_pool_));
+  RETURN_NOT_OK(ThreadPoolBuilder("wal-sync")
+                .set_min_threads(0)
+                .set_max_threads(1)
+                .Build(&sync_pool_));
   return Status::OK();
 }
 
@@ -348,29 +426,75 @@ void Log::AppendThread::ProcessQueue() {
   DCHECK_EQ(ANNOTATE_UNPROTECTED_READ(thread_state_), ACTIVE);
   VLOG_WITH_PREFIX(2) << "WAL Appender going active";
   while (true) {
-    MonoTime deadline = MonoTime::Now() +
-        MonoDelta::FromMilliseconds(FLAGS_log_thread_idle_threshold_ms);
     vector<unique_ptr<LogEntryBatch>> entry_batches;
-    Status s = log_->entry_queue()->BlockingDrainTo(&entry_batches, deadline);
-    if (PREDICT_FALSE(s.IsAborted())) {
-      break;
-    } else if (PREDICT_FALSE(s.IsTimedOut())) {
-      if (GoIdle()) break;
-      continue;
+    if (!syncing_batches_.empty()) {
+      // Only the batches already queued are worth writing behind the group in
+      // flight: otherwise, complete it rather than delaying its callbacks.
+      Status s = log_->entry_queue()->BlockingDrainTo(&entry_batches, MonoTime::Now());
+      if (PREDICT_FALSE(!s.ok())) {
+        FinishSync();
+        if (s.IsAborted()) break;
+        continue;
+      }
+    } else {
+      MonoTime deadline = MonoTime::Now() +
+          MonoDelta::FromMilliseconds(FLAGS_log_thread_idle_threshold_ms);
+      Status s = log_->entry_queue()->BlockingDrainTo(&entry_batches, deadline);
+      if (PREDICT_FALSE(s.IsAborted())) {
+        break;
+      } else if (PREDICT_FALSE(s.IsTimedOut())) {
+        if (GoIdle()) break;
+        continue;
+      }
+      MaybeHoldGroup(&entry_batches);
     }
     HandleBatches(std::move(entry_batches));
   }
+  DCHECK(syncing_batches_.empty());
   log_->SetActiveSegmentIdle();
   VLOG_WITH_PREFIX(2) << "WAL Appender going idle";
 }
 
+void Log::AppendThread::MaybeHoldGroup(vector<unique_ptr<LogEntryBatch>>* entry_batches) {
+  const int32_t target_us = FLAGS_log_group_commit_target_latency_us;
+  // A lone appender has nothing to share its fsync with.
+  if (target_us <= 0 || last_group_size_ <= 1) {
+    return;
+  }
+  const int64_t hold_us = target_us - avg_commit_us_;
+  if (hold_us <= 0) {
+    return;
+  }
+  const MonoTime start = MonoTime::Now();
+  const MonoTime deadline = start + MonoDelta::FromMicroseconds(hold_us);
+  while (log_->entry_queue()->BlockingDrainTo(entry_batches, deadline).ok()) {
+  }
+  if (log_->ctx_.metrics) {
+    log_->ctx_.metrics->group_commit_hold_time->Increment(
+        (MonoTime::Now() - start).ToMicroseconds());
+  }
+}
+
 void Log::AppendThread::HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_batches) {
   if (log_->ctx_.metrics) {
+    int64_t group_bytes = 0;
+    for (const auto& entry_batch : entry_batches) {
+      group_bytes += entry_batch->total_size_bytes();
+    }
     log_->ctx_.metrics->entry_batches_per_group->Increment(entry_batches.size());
+    log_->ctx_.metrics->bytes_per_group->Increment(group_bytes);
   }
   TRACE_EVENT1("log", "batch", "batch_size", entry_batches.size());
+  last_group_size_ = entry_batches.size();
+  const MonoTime start = MonoTime::Now();
 
-  SCOPED_LATENCY_METRIC(log_->ctx_.metrics, group_commit_latency);
+  // Compress the batches while the group in flight is synced.
+  if (!syncing_batches_.empty()) {
+    for (auto& entry_batch : entry_batches) {
+      log_->PrecompressBatch(entry_batch.get());
+    }
+  }
+  FinishSync();
 
   bool is_all_commits = true;
   for (auto& entry_batch : entry_batches) {
@@ -391,8 +515,28 @@ void Log::AppendThread::HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_ba
 
   Status s;
   if (!is_all_commits) {
+    if (FLAGS_log_group_commit_pipeline) {
+      syncing_batches_ = std::move(entry_batches);
+      syncing_start_ = start;
+      CHECK_OK(sync_pool_->Submit([this]() { sync_status_ = log_->Sync(); }));
+      return;
+    }
     s = log_->Sync();
   }
+  CompleteGroup(std::move(entry_batches), s, start);
+}
+
+void Log::AppendThread::FinishSync() {
+  if (syncing_batches_.empty()) {
+    return;
+  }
+  sync_pool_->Wait();
+  CompleteGroup(std::move(syncing_batches_), sync_status_, syncing_start_);
+  syncing_batches_.clear();
+}
+
+void Log::AppendThread::CompleteGroup(vector<unique_ptr<LogEntryBatch>> entry_batches,
+                                      const Status& s, MonoTime start) {
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX(ERROR) << "Error syncing log: " << s.ToString();
     for (const auto& entry_batch : entry_batches) {
@@ -401,6 +545,11 @@ void Log::AppendThread::HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_ba
   } else {
     VLOG_WITH_PREFIX(2) << "Synchronized " << entry_batches.size() << " entry batches";
   }
+  const int64_t commit_us = (MonoTime::Now() - start).ToMicroseconds();
+  avg_commit_us_ = avg_commit_us_ == 0 ? commit_us : (avg_commit_us_ * 7 + commit_us) / 8;
+  if (log_->ctx_.metrics) {
+    log_->ctx_.metrics->group_commit_latency->Increment(commit_us);
+  }
   TRACE_EVENT0("log", "Callbacks");
   SCOPED_WATCH_STACK(100);
   for (auto& entry_batch : entry_batches) {
@@ -418,6 +567,9 @@ void Log::AppendThread::Shutdown() {
     append_pool_->Wait();
     append_pool_->Shutdown();
   }
+  if (sync_pool_) {
+    sync_pool_->Shutdown();
+  }
 }
 
 string Log::AppendThread::LogPrefix() const {
@@ -451,6 +603,11 @@ Status SegmentAllocator::Init(
   RETURN_NOT_OK_PREPEND(GetCompressionCodec(
       GetCompressionCodecType(FLAGS_log_compression_codec), &codec_),
                         "could not instantiate compression codec");
+  if (opts_->force_fsync_all && opts_->share_fsyncs) {
+    shared_sync_ = SharedLogSync::ForDir(ctx_->fs_manager->env(),
+                                         ctx_->fs_manager->GetWalsRootDir());
+  }
+  RETURN_NOT_OK(DeleteRecycledSegments());
   active_segment_sequence_number_ = sequence_number;
   RETURN_NOT_OK(ThreadPoolBuilder("log-alloc")
       .set_max_threads(1)
@@ -511,7 +668,11 @@ Status SegmentAllocator::Sync() {
 
   if (opts_->force_fsync_all) {
     LOG_SLOW_EXECUTION(WARNING, 50, Substitute("$0Fsync log took a long time", LogPrefix())) {
-      RETURN_NOT_OK(active_segment_->Sync());
+      if (shared_sync_) {
+        RETURN_NOT_OK(shared_sync_->Sync());
+      } else {
+        RETURN_NOT_OK(active_segment_->Sync());
+      }
       if (hooks_) {
         RETURN_NOT_OK_PREPEND(hooks_->PostSyncIfFsyncEnabled(),
                               "PostSyncIfFsyncEnabled hook failed");
@@ -548,9 +709,12 @@ Status SegmentAllocator::FinishCurrentSegment(
   // which point all of the segment's preallocated space has been consumed. In
   // some cases (e.g. Log::Close), a segment may be finished prematurely. If we
   // detect that, let's return any excess preallocated space back to the
-  // filesystem by truncating off the end of the segment.
-  if (opts_->preallocate_segments &&
-      active_segment_->written_offset() < max_segment_size_) {
+  // filesystem by truncating off the end of the segment. The same goes for
+  // the zeroed space of a recycled segment file, which also keeps the footer
+  // at the end of the file where readers look for it.
+  uint64_t file_size;
+  RETURN_NOT_OK(active_segment_->file()->Size(&file_size));
+  if (active_segment_->written_offset() < file_size) {
     RETURN_NOT_OK(active_segment_->file()->Truncate(
         active_segment_->written_offset()));
   }
@@ -633,6 +797,34 @@ Status SegmentAllocator::AllocateNewSegment() {
     allocation_state_ = kAllocationFinished;
   });
 
+  Env* env = ctx_->fs_manager->GetEnv();
+  RWFileOptions opts;
+  opts.is_sensitive = true;
+  string recycled_path;
+  {
+    std::lock_guard<simple_spinlock> l(recycle_lock_);
+    if (!recycled_segment_paths_.empty()) {
+      recycled_path = std::move(recycled_segment_paths_.back());
+      recycled_segment_paths_.pop_back();
+    }
+  }
+  if (!recycled_path.empty()) {
+    // The file was zeroed and its space allocated when it was recycled: it
+    // only has to be reopened.
+    unique_ptr<RWFile> segment_file;
+    opts.mode = Env::MUST_EXIST;
+    Status s = env->NewRWFile(opts, recycled_path, &segment_file);
+    if (s.ok()) {
+      next_segment_path_ = std::move(recycled_path);
+      next_segment_file_.reset(segment_file.release());
+      VLOG_WITH_PREFIX(1) << "Reusing recycled WAL segment: " << next_segment_path_;
+      return Status::OK();
+    }
+    WARN_NOT_OK(s, Substitute("could not reopen recycled WAL segment $0", recycled_path));
+    WARN_NOT_OK(env->DeleteFile(recycled_path), "could not delete recycled WAL segment");
+    opts.mode = Env::CREATE_OR_OPEN_WITH_TRUNCATE;
+  }
+
   // We could create the new segment file through the cache, but that's tricky
   // because of the file rename that'll happen later. So instead, we'll create
   // it outside the cache now, then reopen via the cache when we switch to it.
@@ -640,9 +832,6 @@ Status SegmentAllocator::AllocateNewSegment() {
   string path_tmpl = JoinPathSegments(ctx_->log_dir, tmp_suffix);
   VLOG_WITH_PREFIX(2) << "Creating temp. file for place holder segment, template: " << path_tmpl;
   unique_ptr<RWFile> segment_file;
-  Env* env = ctx_->fs_manager->GetEnv();
-  RWFileOptions opts;
-  opts.is_sensitive = true;
   RETURN_NOT_OK_PREPEND(env->NewTempRWFile(
       opts, path_tmpl, &next_segment_path_, &segment_file),
                         "could not create next WAL segment");
@@ -666,6 +855,75 @@ Status SegmentAllocator::AllocateNewSegment() {
   return Status::OK();
 }
 
+Status SegmentAllocator::MaybeRecycleSegment(
+    const scoped_refptr<ReadableLogSegment>& segment, bool* recycled) {
+  *recycled = false;
+  const int32_t max_recycled = FLAGS_log_max_recycled_segments;
+  // The file is about to be renamed and overwritten: no reader may be left.
+  if (max_recycled <= 0 || !segment->HasOneRef()) {
+    return Status::OK();
+  }
+  {
+    std::lock_guard<simple_spinlock> l(recycle_lock_);
+    if (recycled_segment_paths_.size() >= static_cast<size_t>(max_recycled)) {
+      return Status::OK();
+    }
+  }
+  const string& path = segment->path();
+  const string recycled_path = path + RecycledSegmentSuffix();
+  if (ctx_->file_cache) {
+    ctx_->file_cache->Invalidate(path);
+  }
+  Env* env = ctx_->fs_manager->GetEnv();
+  RETURN_NOT_OK_PREPEND(env->RenameFile(path, recycled_path),
+                        "could not rename WAL segment to recycle");
+  *recycled = true;
+  auto delete_recycled = MakeScopedCleanup([&]() {
+    WARN_NOT_OK(env->DeleteFile(recycled_path), "could not delete recycled WAL segment");
+  });
+
+  // Segment entries aren't tied to the segment they're written to, so the old
+  // entries must be wiped out: after a crash, the entries past the end of the
+  // reusing segment would otherwise be read as part of it. Zeroing the file
+  // past 'max_segment_size_' also allocates all the space a new segment needs.
+  unique_ptr<RWFile> file;
+  RWFileOptions opts;
+  opts.mode = Env::MUST_EXIST;
+  opts.is_sensitive = true;
+  RETURN_NOT_OK(env->NewRWFile(opts, recycled_path, &file));
+  uint64_t size;
+  RETURN_NOT_OK(file->Size(&size));
+  const uint64_t length = std::max<uint64_t>(size, max_segment_size_);
+  const string zeros(std::min<uint64_t>(length, 1024 * 1024), '\0');
+  for (uint64_t offset = 0; offset < length;) {
+    const uint64_t n = std::min<uint64_t>(zeros.size(), length - offset);
+    RETURN_NOT_OK(file->Write(offset, Slice(zeros.data(), n)));
+    offset += n;
+  }
+  RETURN_NOT_OK(file->Sync());
+  RETURN_NOT_OK(file->Close());
+  delete_recycled.cancel();
+
+  VLOG_WITH_PREFIX(1) << "Recycled WAL segment " << path << " into " << recycled_path;
+  std::lock_guard<simple_spinlock> l(recycle_lock_);
+  recycled_segment_paths_.emplace_back(recycled_path);
+  return Status::OK();
+}
+
+Status SegmentAllocator::DeleteRecycledSegments() {
+  Env* env = ctx_->fs_manager->GetEnv();
+  vector<string> children;
+  RETURN_NOT_OK(env->GetChildren(ctx_->log_dir, &children));
+  const string suffix = RecycledSegmentSuffix();
+  for (const auto& child : children) {
+    if (HasSuffixString(child, suffix)) {
+      RETURN_NOT_OK_PREPEND(env->DeleteFile(JoinPathSegments(ctx_->log_dir, child)),
+                            "could not delete recycled WAL segment");
+    }
+  }
+  return Status::OK();
+}
+
 Status SegmentAllocator::SwitchToAllocatedSegment(
     scoped_refptr<ReadableLogSegment>* new_readable_segment) {
   // Increment "next" log segment seqno.
@@ -923,7 +1181,12 @@ Status Log::WriteBatch(LogEntryBatch* entry_batch) {
     SCOPED_LATENCY_METRIC(ctx_.metrics, append_latency);
     SCOPED_WATCH_STACK(500);
 
-    RETURN_NOT_OK(active_segment->WriteEntryBatch(entry_batch_data, segment_allocator_.codec_));
+    if (entry_batch->compressed_) {
+      RETURN_NOT_OK(active_segment->WriteCompressedEntryBatch(
+          Slice(entry_batch->compressed_buffer_), entry_batch_data.size()));
+    } else {
+      RETURN_NOT_OK(active_segment->WriteEntryBatch(entry_batch_data, segment_allocator_.codec_));
+    }
 
     // Update the reader on how far it can read the active segment.
     reader_->UpdateLastSegmentOffset(active_segment->written_offset());
@@ -943,6 +1206,17 @@ Status Log::WriteBatch(LogEntryBatch* entry_batch) {
   return Status::OK();
 }
 
+void Log::PrecompressBatch(LogEntryBatch* entry_batch) {
+  const CompressionCodec* codec = segment_allocator_.codec_;
+  if (!codec || entry_batch->type_ == FLUSH_MARKER) {
+    return;
+  }
+  // If the compression fails, the write compresses the batch again and
+  // surfaces the error.
+  entry_batch->compressed_ = WritableLogSegment::CompressEntryBatch(
+      entry_batch->data(), *codec, &entry_batch->compressed_buffer_).ok();
+}
+
 Status Log::UpdateIndexForBatch(const LogEntryBatch& batch,
                                 int64_t start_offset) {
   if (batch.type_ != REPLICATE) {
@@ -1071,6 +1345,14 @@ Status Log::GC(RetentionIndexes retention_indexes, int32_t* num_gced) {
                              segment->footer().min_replicate_index(),
                              segment->footer().max_replicate_index());
       }
+      bool recycled = false;
+      WARN_NOT_OK(segment_allocator_.MaybeRecycleSegment(segment, &recycled),
+                  Substitute("$0could not recycle log segment $1", LogPrefix(), segment->path()));
+      if (recycled) {
+        LOG_WITH_PREFIX(INFO) << "Recycled log segment in path: " << segment->path() << ops_str;
+        (*num_gced)++;
+        continue;
+      }
       LOG_WITH_PREFIX(INFO) << "Deleting log segment in path: " << segment->path() << ops_str;
       if (PREDICT_TRUE(ctx_.file_cache)) {
         // Note: the segment files will only be deleted from disk when
@@ -65,6 +65,7 @@ class LogEntryBatch;
 class LogFaultHooks;
 class LogIndex;
 class LogReader;
+class SharedLogSync;
 struct LogEntryBatchLogicalSize;
 struct RetentionIndexes;
 
@@ -146,6 +147,17 @@ class SegmentAllocator {
   // last-written OpId.
   void UpdateFooterForBatch(const LogEntryBatch& batch);
 
+  // Keeps the file of the GC'd 'segment' to be reused by a future segment
+  // allocation instead of deleting it, if --log_max_recycled_segments allows
+  // for it and nothing else references 'segment'. The file is renamed out of
+  // the way and zeroed, so that the entries it contains can't be mistaken for
+  // entries of the reusing segment.
+  //
+  // Sets 'recycled' to whether the file was kept; if not, it's up to the
+  // caller to delete it.
+  Status MaybeRecycleSegment(const scoped_refptr<ReadableLogSegment>& segment,
+                             bool* recycled);
+
   // Shuts down the allocator threadpool. Note that this _doesn't_ close the
   // current active segment.
   void StopAllocationThread();
@@ -189,9 +201,14 @@ class SegmentAllocator {
 
   // Creates a temporary file, populating 'next_segment_file_' and
   // 'next_segment_path_', and pre-allocating 'max_segment_size_' bytes if
-  // pre-allocation is enabled.
+  // pre-allocation is enabled. A recycled segment file is reused instead, if
+  // there is one.
   Status AllocateNewSegment();
 
+  // Deletes the recycled segment files left in the log directory by a
+  // previous instance of the log: they may not have been fully zeroed.
+  Status DeleteRecycledSegments();
+
   // Swaps in the next segment file as the new active segment.
   //
   // 'new_readable_segment' contains the newly active segment, reopened for reading.
@@ -226,6 +243,10 @@ class SegmentAllocator {
   // The codec used to compress entries, or nullptr if not configured.
   const CompressionCodec* codec_ = nullptr;
 
+  // Serves the fsyncs of the active segment along with the ones of the logs of
+  // the other tablets, if LogOptions::share_fsyncs is set.
+  SharedLogSync* shared_sync_ = nullptr;
+
   // The schema and schema version to be used for the next segment.
   mutable rw_spinlock schema_lock_;
   Schema schema_;
@@ -252,6 +273,11 @@ class SegmentAllocator {
 
   // The sequence number of the 'active' log segment.
   uint64_t active_segment_sequence_number_ = 0;
+
+  // Protects recycled_segment_paths_.
+  simple_spinlock recycle_lock_;
+  // The paths of the zeroed files of GC'd segments, ready to be reused.
+  std::vector<std::string> recycled_segment_paths_;
 };
 
 // Log interface, inspired by Raft's (logcabin) Log. Provides durability to
@@ -459,6 +485,11 @@ class Log : public RefCountedThreadSafe<Log> {
   // Writes serialized contents of 'entry' to the log. This is not thread-safe.
   Status WriteBatch(LogEntryBatch* entry_batch);
 
+  // Compresses the contents of 'entry_batch' ahead of its write, so that
+  // WriteBatch() only has to write them. Unlike WriteBatch(), may run
+  // concurrently with Sync().
+  void PrecompressBatch(LogEntryBatch* entry_batch);
+
   // Update footer_builder_ to reflect the log indexes seen in 'batch'.
   void UpdateFooterForBatch(LogEntryBatch* batch);
 
@@ -616,6 +647,11 @@ class LogEntryBatch {
   // 'Serialize()'
   faststring buffer_;
 
+  // If 'compressed_' is set, holds the contents of 'buffer_' compressed with
+  // the codec of the log ahead of the write, which then only has to write it.
+  faststring compressed_buffer_;
+  bool compressed_ = false;
+
   // Tracks whether this batch was successfully append to the log.
   Status append_status_;
 
@@ -55,6 +55,7 @@
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
+#include "kudu/util/threadpool.h"
 
 using std::atomic;
 using std::shared_ptr;
@@ -187,6 +188,48 @@ TEST_F(LogCacheTest, TestAppendAndGetMessages) {
 }
 
 
+// Test that the ops following those read from the log are read ahead, and
+// that the read-aheads are dropped once the ops are truncated.
+TEST_F(LogCacheTest, TestReadAhead) {
+  unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("read-ahead").Build(&pool));
+  // The token of the cache must be destroyed before the pool.
+  SCOPED_CLEANUP({ cache_.reset(); });
+  cache_->EnableReadAhead(pool->NewToken(ThreadPool::ExecutionMode::CONCURRENT));
+
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 100, 1024));
+  log_->WaitUntilAllFlushed();
+  cache_->EvictThroughOp(100);
+  ASSERT_EQ(0, cache_->metrics_.log_cache_num_ops->value());
+
+  // Read the ops in batches, as a follower catching up would.
+  int64_t after_index = 0;
+  while (after_index < 100) {
+    vector<ReplicateRefPtr> messages;
+    OpId preceding;
+    ASSERT_OK(cache_->ReadOps(after_index, 10 * 1024, &messages, &preceding));
+    ASSERT_EQ(after_index, preceding.index());
+    ASSERT_FALSE(messages.empty());
+    for (const auto& msg : messages) {
+      ASSERT_EQ(++after_index, msg->get()->id().index());
+    }
+  }
+  // The batches following the first were read ahead.
+  ASSERT_GT(cache_->metrics_.log_cache_read_ahead_hits->value(), 0);
+  ASSERT_TRUE(cache_->read_aheads_.empty());
+
+  // Truncating drops the ops read ahead.
+  {
+    vector<ReplicateRefPtr> messages;
+    OpId preceding;
+    ASSERT_OK(cache_->ReadOps(0, 10 * 1024, &messages, &preceding));
+  }
+  pool->Wait();
+  ASSERT_FALSE(cache_->read_aheads_.empty());
+  cache_->TruncateOpsAfter(50);
+  ASSERT_TRUE(cache_->read_aheads_.empty());
+}
+
 // Ensure that the cache always yields at least one message,
 // even if that message is larger than the batch size. This ensures
 // that we don't get "stuck" in the case that a large message enters
@@ -19,6 +19,7 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <string>
@@ -37,14 +38,17 @@
 #include "kudu/consensus/ref_counted_replicate.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/mathlimits.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/human_readable.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/countdown_latch.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/mem_tracker.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/threadpool.h"
 
 DEFINE_int32(log_cache_size_limit_mb, 128,
              "The total per-tablet size of consensus entries which may be kept in memory. "
@@ -58,7 +62,15 @@ DEFINE_int32(global_log_cache_size_limit_mb, 1024,
              "caching log entries across all tablets is kept under this threshold.");
 TAG_FLAG(global_log_cache_size_limit_mb, advanced);
 
+DEFINE_bool(log_cache_read_ahead, true,
+            "Whether to read ahead the consensus entries following those read from the log "
+            "rather than the log cache, e.g. for a follower catching up, so that they're "
+            "read and decompressed by the time they're needed.");
+TAG_FLAG(log_cache_read_ahead, advanced);
+TAG_FLAG(log_cache_read_ahead, runtime);
+
 using kudu::pb_util::SecureShortDebugString;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 using strings::Substitute;
@@ -74,6 +86,11 @@ METRIC_DEFINE_gauge_int64(tablet, log_cache_size, "Log Cache Memory Usage",
                           MetricUnit::kBytes,
                           "Amount of memory in use for caching the local log.",
                           kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, log_cache_read_ahead_hits, "Log Cache Read-Ahead Hits",
+                      MetricUnit::kRequests,
+                      "Number of reads of operations from the log which were served by "
+                      "operations read ahead rather than by reading the log.",
+                      kudu::MetricLevel::kDebug);
 
 static const char kParentMemTrackerId[] = "log_cache";
 
@@ -85,6 +102,7 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
       local_uuid_(std::move(local_uuid)),
       tablet_id_(std::move(tablet_id)),
       next_sequential_op_index_(0),
+      num_truncations_(0),
       min_pinned_op_index_(0),
       metrics_(metric_entity) {
 
@@ -112,7 +130,22 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
               { make_scoped_refptr_replicate(zero_op), zero_op->SpaceUsedLong() });
 }
 
+struct LogCache::ReadAhead {
+  ReadAhead() : done(1) {}
+
+  // Counted down once the ops are read.
+  CountDownLatch done;
+
+  // The result of reading the ops, and the ops read.
+  Status status;
+  vector<ReplicateRefPtr> ops;
+};
+
 LogCache::~LogCache() {
+  // Wait for the read-aheads in flight, which access the cache.
+  if (read_ahead_token_) {
+    read_ahead_token_->Shutdown();
+  }
   tracker_->Release(tracker_->consumption());
   cache_.clear();
 }
@@ -129,12 +162,22 @@ void LogCache::TruncateOpsAfter(int64_t index) {
   TruncateOpsAfterUnlocked(index);
 }
 
+void LogCache::EnableReadAhead(std::unique_ptr<ThreadPoolToken> token) {
+  DCHECK(!read_ahead_token_);
+  read_ahead_token_ = std::move(token);
+}
+
 void LogCache::TruncateOpsAfterUnlocked(int64_t index) {
   int64_t first_to_truncate = index + 1;
   // If the index is not consecutive then it must be lower than or equal
   // to the last index, i.e. we're overwriting.
   CHECK_LE(first_to_truncate, next_sequential_op_index_);
 
+  // The ops read ahead may have been truncated. Those in flight complete
+  // regardless, but aren't read.
+  read_aheads_.clear();
+  ++num_truncations_;
+
   // Now remove the overwritten operations.
   for (int64_t i = first_to_truncate; i < next_sequential_op_index_; ++i) {
     auto it = cache_.find(i);
@@ -299,6 +342,8 @@ Status LogCache::ReadOps(int64_t after_op_index,
   int64_t remaining_space = max_size_bytes;
   int64_t next_index = after_op_index + 1;
 
+  // Whether the last ops were read from the log.
+  bool read_from_log = false;
   std::unique_lock<simple_spinlock> l(lock_);
   while (remaining_space > 0 && next_index < next_sequential_op_index_) {
     // If the messages the peer needs haven't been loaded into the queue yet,
@@ -313,30 +358,51 @@ Status LogCache::ReadOps(int64_t after_op_index,
         // Read up to the next entry that's in the cache
         up_to = iter->first - 1;
       }
+      shared_ptr<ReadAhead> read_ahead;
+      auto read_ahead_iter = read_aheads_.find(next_index);
+      if (read_ahead_iter != read_aheads_.end()) {
+        read_ahead = std::move(read_ahead_iter->second);
+        read_aheads_.erase(read_ahead_iter);
+      }
       l.unlock();
 
-      vector<ReplicateMsg*> raw_replicate_ptrs;
-      RETURN_NOT_OK_PREPEND(
-          log_->reader()->ReadReplicatesInRange(
-              next_index, up_to, remaining_space, &raw_replicate_ptrs),
-          Substitute("failed to read ops $0..$1", next_index, up_to));
+      vector<ReplicateRefPtr> msgs;
+      if (read_ahead) {
+        read_ahead->done.Wait();
+        if (read_ahead->status.ok() && !read_ahead->ops.empty()) {
+          msgs = std::move(read_ahead->ops);
+          metrics_.log_cache_read_ahead_hits->Increment();
+        }
+      }
+      if (msgs.empty()) {
+        vector<ReplicateMsg*> raw_replicate_ptrs;
+        RETURN_NOT_OK_PREPEND(
+            log_->reader()->ReadReplicatesInRange(
+                next_index, up_to, remaining_space, &raw_replicate_ptrs),
+            Substitute("failed to read ops $0..$1", next_index, up_to));
+        msgs.reserve(raw_replicate_ptrs.size());
+        for (auto* msg : raw_replicate_ptrs) {
+          msgs.push_back(make_scoped_refptr_replicate(msg));
+        }
+      }
       VLOG_WITH_PREFIX_UNLOCKED(2) <<
-          Substitute("read $0 ops from log ($1..$2)", raw_replicate_ptrs.size(),
-          next_index, next_index + raw_replicate_ptrs.size() - 1);
-      for (auto* msg : raw_replicate_ptrs) {
-        CHECK_EQ(next_index, msg->id().index());
-        if (remaining_space > 0) {
-          messages->push_back(make_scoped_refptr_replicate(msg));
-          remaining_space -= TotalByteSizeForMessage(*msg);
-          ++next_index;
-        } else {
-          delete msg;
+          Substitute("read $0 ops from log ($1..$2)", msgs.size(),
+          next_index, next_index + msgs.size() - 1);
+      for (auto& msg : msgs) {
+        if (remaining_space <= 0) {
+          break;
         }
+        CHECK_EQ(next_index, msg->get()->id().index());
+        remaining_space -= TotalByteSizeForMessage(*msg->get());
+        messages->push_back(std::move(msg));
+        ++next_index;
       }
+      read_from_log = true;
 
       // Acquire the lock again before going to the next iteration.
       l.lock();
     } else {
+      read_from_log = false;
       // Pull contiguous messages from the cache until the size limit is achieved.
       for (; iter != cache_.end(); ++iter) {
         const ReplicateRefPtr& msg = iter->second.msg;
@@ -354,9 +420,51 @@ Status LogCache::ReadOps(int64_t after_op_index,
       }
     }
   }
+
+  // If reading from the log, the reader is likely to read the following ops
+  // next, so read them ahead, unless they're cached.
+  if (read_from_log && read_ahead_token_ && FLAGS_log_cache_read_ahead &&
+      next_index < next_sequential_op_index_) {
+    MessageCache::const_iterator iter = cache_.lower_bound(next_index);
+    if (iter == cache_.end() || iter->first != next_index) {
+      const int64_t up_to = iter == cache_.end() ? next_sequential_op_index_ - 1
+                                                 : iter->first - 1;
+      const int64_t num_truncations = num_truncations_;
+      l.unlock();
+      ScheduleReadAhead(next_index, up_to, max_size_bytes - remaining_space, num_truncations);
+    }
+  }
   return Status::OK();
 }
 
+void LogCache::ScheduleReadAhead(int64_t first_index, int64_t up_to, int64_t max_size_bytes,
+                                 int64_t num_truncations) {
+  auto read_ahead = std::make_shared<ReadAhead>();
+  Status s = read_ahead_token_->Submit([this, read_ahead, first_index, up_to, max_size_bytes]() {
+    vector<ReplicateMsg*> raw_replicate_ptrs;
+    read_ahead->status = log_->reader()->ReadReplicatesInRange(
+        first_index, up_to, max_size_bytes, &raw_replicate_ptrs);
+    read_ahead->ops.reserve(raw_replicate_ptrs.size());
+    for (auto* msg : raw_replicate_ptrs) {
+      read_ahead->ops.push_back(make_scoped_refptr_replicate(msg));
+    }
+    read_ahead->done.CountDown();
+  });
+  if (PREDICT_FALSE(!s.ok())) {
+    // The token is shut down.
+    return;
+  }
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (num_truncations != num_truncations_) {
+    // The ops to read ahead may have been truncated since.
+    return;
+  }
+  if (read_aheads_.size() >= kMaxReadAheads && !ContainsKey(read_aheads_, first_index)) {
+    read_aheads_.erase(read_aheads_.begin());
+  }
+  read_aheads_[first_index] = std::move(read_ahead);
+}
+
 
 void LogCache::EvictThroughOp(int64_t index) {
   std::lock_guard<simple_spinlock> lock(lock_);
@@ -481,7 +589,8 @@ void LogCache::DumpToHtml(std::ostream& out) const {
   x.Instantiate(metric_entity, 0)
 LogCache::Metrics::Metrics(const scoped_refptr<MetricEntity>& metric_entity)
     : log_cache_num_ops(INSTANTIATE_METRIC(METRIC_log_cache_num_ops)),
-      log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)) {
+      log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)),
+      log_cache_read_ahead_hits(METRIC_log_cache_read_ahead_hits.Instantiate(metric_entity)) {
 }
 #undef INSTANTIATE_METRIC
 
@@ -37,6 +37,7 @@
 namespace kudu {
 
 class MemTracker;
+class ThreadPoolToken;
 
 namespace log {
 class Log;
@@ -80,13 +81,24 @@ class LogCache {
   // The index of this OpId will match 'after_op_index'.
   //
   // If the ops being requested are not available in the cache, this will synchronously
-  // read these ops from disk. Therefore, this function may take a substantial amount
-  // of time and should not be called with important locks held, etc.
+  // read these ops from disk, unless they were read ahead (see EnableReadAhead()).
+  // Therefore, this function may take a substantial amount of time and should not be
+  // called with important locks held, etc.
   Status ReadOps(int64_t after_op_index,
                  int64_t max_size_bytes,
                  std::vector<ReplicateRefPtr>* messages,
                  OpId* preceding_op);
 
+  // Enables reading ahead from the log: once ReadOps() read ops from the log
+  // rather than the cache, the ops following them are read and decompressed
+  // on 'token', as many bytes as were returned, so that they're ready by the
+  // time the same reader asks for them. This way, a peer catching up from the
+  // log waits for the disk less, and for as long as it takes to send a batch
+  // to it at most.
+  //
+  // Must be called once, before any call to ReadOps().
+  void EnableReadAhead(std::unique_ptr<ThreadPoolToken> token);
+
   // Append the operations into the log and the cache.
   // When the messages have completed writing into the on-disk log, fires 'callback'.
   //
@@ -142,6 +154,7 @@ class LogCache {
  private:
   FRIEND_TEST(LogCacheTest, TestAppendAndGetMessages);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimit);
+  FRIEND_TEST(LogCacheTest, TestReadAhead);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
   FRIEND_TEST(LogCacheTest, TestTruncation);
   friend class LogCacheTest;
@@ -157,6 +170,19 @@ class LogCache {
     size_t mem_usage;
   };
 
+  // The ops read ahead from the log, following the ops read by a reader.
+  struct ReadAhead;
+
+  // The maximum number of read-aheads kept at a time, i.e. of readers reading
+  // from the log concurrently whose next ops are ready.
+  static constexpr const size_t kMaxReadAheads = 4;
+
+  // Reads ahead the ops with indexes 'first_index' to 'up_to', 'max_size_bytes'
+  // at most. 'num_truncations' is the value of 'num_truncations_' the range
+  // was found not to be cached with: they aren't kept if truncated since.
+  void ScheduleReadAhead(int64_t first_index, int64_t up_to, int64_t max_size_bytes,
+                         int64_t num_truncations);
+
   // Try to evict the oldest operations from the queue, stopping either when
   // 'bytes_to_evict' bytes have been evicted, or the op with index
   // 'stop_after_index' has been evicted, whichever comes first.
@@ -199,6 +225,19 @@ class LogCache {
   // start with this log index, or go backward (but never skip forward).
   int64_t next_sequential_op_index_;
 
+  // The number of truncations of the cache, guarding the read-aheads.
+  int64_t num_truncations_;
+
+  // The read-aheads, by the index of their first op, as set to read ahead
+  // ops by ScheduleReadAhead() and until taken by ReadOps(). Only the oldest are
+  // dropped once there are kMaxReadAheads of them: those of following ops
+  // take over once readers catch up. Cleared when truncating.
+  // Protected by lock_.
+  std::map<int64_t, std::shared_ptr<ReadAhead>> read_aheads_;
+
+  // The token to read ahead on, if enabled.
+  std::unique_ptr<ThreadPoolToken> read_ahead_token_;
+
   // Any operation with an index >= min_pinned_op_ may not be
   // evicted from the cache. This is used to prevent ops from being evicted
   // until they successfully have been appended to the underlying log.
@@ -226,6 +265,9 @@ class LogCache {
 
     // Keeps track of the memory consumed by the cache, in bytes.
     scoped_refptr<AtomicGauge<int64_t>> log_cache_size;
+
+    // Counts the batches of ops read ahead from the log which were then read.
+    scoped_refptr<Counter> log_cache_read_ahead_hits;
   };
   Metrics metrics_;
 
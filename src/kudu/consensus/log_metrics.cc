@@ -54,6 +54,19 @@ METRIC_DEFINE_histogram(tablet, log_entry_batches_per_group, "Log Group Commit B
                         kudu::MetricLevel::kDebug,
                         1024, 2);
 
+METRIC_DEFINE_histogram(tablet, log_bytes_per_group, "Log Group Commit Bytes",
+                        kudu::MetricUnit::kBytes,
+                        "Number of bytes of log entry batches in a group commit group",
+                        kudu::MetricLevel::kDebug,
+                        64 * 1024 * 1024LU, 2);
+
+METRIC_DEFINE_histogram(tablet, log_group_commit_hold_time, "Log Group Commit Hold Time",
+                        kudu::MetricUnit::kMicroseconds,
+                        "Microseconds a group commit group was held open to collect "
+                        "more log entry batches (see --log_group_commit_target_latency_us)",
+                        kudu::MetricLevel::kDebug,
+                        60000000LU, 2);
+
 namespace kudu {
 namespace log {
 
@@ -64,7 +77,9 @@ LogMetrics::LogMetrics(const scoped_refptr<MetricEntity>& metric_entity)
       MINIT(append_latency),
       MINIT(group_commit_latency),
       MINIT(roll_latency),
-      MINIT(entry_batches_per_group) {
+      MINIT(entry_batches_per_group),
+      MINIT(bytes_per_group),
+      MINIT(group_commit_hold_time) {
 }
 #undef MINIT
 
@@ -23,6 +23,7 @@
 #include <mutex>
 #include <ostream>
 #include <type_traits>
+#include <unordered_map>
 
 #include <glog/logging.h>
 
@@ -57,6 +58,7 @@ METRIC_DEFINE_histogram(tablet, log_reader_read_batch_latency, "Log Read Latency
                         kudu::MetricLevel::kInfo,
                         60000000LU, 2);
 
+using kudu::consensus::CommitMsg;
 using kudu::consensus::OpId;
 using kudu::consensus::ReplicateMsg;
 using kudu::pb_util::SecureDebugString;
@@ -64,6 +66,7 @@ using kudu::pb_util::SecureShortDebugString;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::unordered_map;
 using std::vector;
 using strings::Substitute;
 
@@ -355,6 +358,46 @@ Status LogReader::ReadReplicatesInRange(int64_t starting_at,
   return Status::OK();
 }
 
+Status LogReader::ReadCommitsInRange(int64_t starting_at,
+                                     int64_t up_to,
+                                     unordered_map<int64_t, CommitMsg>* commits) const {
+  DCHECK_GT(starting_at, 0);
+  DCHECK_GE(up_to, starting_at);
+  DCHECK(log_index_) << "Require an index to random-read logs";
+
+  // The COMMIT of an op is always logged after its REPLICATE, so the segments
+  // preceding the one of the REPLICATE of 'starting_at' can't contain any of
+  // the commits.
+  LogIndexEntry index_entry;
+  RETURN_NOT_OK_PREPEND(log_index_->GetEntry(starting_at, &index_entry),
+                        Substitute("Failed to read log index for op $0", starting_at));
+  SegmentSequence segments;
+  GetSegmentsSnapshot(&segments);
+
+  unordered_map<int64_t, CommitMsg> commits_tmp;
+  for (const auto& segment : segments) {
+    if (segment->header().sequence_number() < index_entry.segment_sequence_number) {
+      continue;
+    }
+    LogEntries entries;
+    RETURN_NOT_OK_PREPEND(segment->ReadEntries(&entries),
+                          Substitute("Failed to read log segment $0", segment->path()));
+    for (auto& entry : entries) {
+      if (!entry->has_commit()) {
+        continue;
+      }
+      int64_t index = entry->commit().commited_op_id().index();
+      if (index < starting_at || index > up_to) {
+        continue;
+      }
+      commits_tmp[index].Swap(entry->mutable_commit());
+    }
+  }
+
+  commits->swap(commits_tmp);
+  return Status::OK();
+}
+
 Status LogReader::LookupOpId(int64_t op_index, OpId* op_id) const {
   LogIndexEntry index_entry;
   RETURN_NOT_OK_PREPEND(log_index_->GetEntry(op_index, &index_entry),
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <gtest/gtest_prod.h>
@@ -41,6 +42,7 @@ class MetricEntity;
 class faststring;
 
 namespace consensus {
+class CommitMsg;
 class OpId;
 class ReplicateMsg;
 } // namespace consensus
@@ -113,6 +115,21 @@ class LogReader : public enable_make_shared<LogReader> {
       std::vector<consensus::ReplicateMsg*>* replicates) const;
   static const int64_t kNoSizeLimit;
 
+  // Reads the CommitMsgs of the ops from 'starting_at' to 'up_to' both
+  // inclusive which were logged so far, keyed by the index of their op. The
+  // ops whose commits aren't logged yet, e.g. since they're still being
+  // applied, are missing from 'commits'.
+  //
+  // Since the commits aren't indexed, this reads all the segments following
+  // the one of the REPLICATE of 'starting_at': this is much more expensive
+  // than ReadReplicatesInRange().
+  //
+  // Requires that a LogIndex was passed into LogReader::Open().
+  Status ReadCommitsInRange(
+      int64_t starting_at,
+      int64_t up_to,
+      std::unordered_map<int64_t, consensus::CommitMsg>* commits) const;
+
   // Look up the OpId for the given operation index.
   // Returns a bad Status if the log index fails to load (eg. due to an IO error).
   Status LookupOpId(int64_t op_index, consensus::OpId* op_id) const;
@@ -21,6 +21,8 @@
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -61,6 +63,16 @@ DEFINE_bool(log_async_preallocate_segments, true,
             "Whether the WAL segments preallocation should happen asynchronously");
 TAG_FLAG(log_async_preallocate_segments, advanced);
 
+DEFINE_bool(log_share_fsyncs_across_tablets, false,
+            "Whether to coalesce the fsyncs of the WALs of all tablets: "
+            "concurrent syncs are served by a single syncfs(2) call of the "
+            "filesystem of the WALs, instead of an fsync per segment. Only "
+            "takes effect with --log_force_fsync_all, and on Linux. Requires "
+            "Linux 5.8 or later for writeback errors to be reported, and the "
+            "WAL directory to be on a filesystem of its own, since the files "
+            "of any other users of that filesystem get synced as well.");
+TAG_FLAG(log_share_fsyncs_across_tablets, experimental);
+
 DEFINE_double(fault_crash_before_write_log_segment_header, 0.0,
               "Fraction of the time we will crash just before writing the log segment header");
 TAG_FLAG(fault_crash_before_write_log_segment_header, unsafe);
@@ -103,7 +115,8 @@ LogOptions::LogOptions()
 : segment_size_mb(FLAGS_log_segment_size_mb),
   force_fsync_all(FLAGS_log_force_fsync_all),
   preallocate_segments(FLAGS_log_preallocate_segments),
-  async_preallocate_segments(FLAGS_log_async_preallocate_segments) {
+  async_preallocate_segments(FLAGS_log_async_preallocate_segments),
+  share_fsyncs(FLAGS_log_share_fsyncs_across_tablets) {
 }
 
 ////////////////////////////////////////////////////////////
@@ -821,24 +834,32 @@ Status WritableLogSegment::WriteFooter(const LogSegmentFooterPB& footer) {
 
 Status WritableLogSegment::WriteEntryBatch(const Slice& data,
                                            const CompressionCodec* codec) {
-  DCHECK(is_header_written_);
-  DCHECK(!is_footer_written_);
-  uint8_t header_buf[kEntryHeaderSizeV2];
-
   const uint32_t uncompressed_len = data.size();
 
   // If necessary, compress the data.
-  Slice data_to_write;
   if (codec) {
     DCHECK_NE(header_.compression_codec(), NO_COMPRESSION);
-    compress_buf_.resize(codec->MaxCompressedLength(uncompressed_len));
-    size_t compressed_len;
-    RETURN_NOT_OK(codec->Compress(data, &compress_buf_[0], &compressed_len));
-    compress_buf_.resize(compressed_len);
-    data_to_write = Slice(compress_buf_.data(), compress_buf_.size());
-  } else {
-    data_to_write = data;
+    RETURN_NOT_OK(CompressEntryBatch(data, *codec, &compress_buf_));
+    return WriteCompressedEntryBatch(Slice(compress_buf_), uncompressed_len);
   }
+  return WriteCompressedEntryBatch(data, uncompressed_len);
+}
+
+Status WritableLogSegment::CompressEntryBatch(const Slice& data,
+                                              const CompressionCodec& codec,
+                                              faststring* out) {
+  out->resize(codec.MaxCompressedLength(data.size()));
+  size_t compressed_len;
+  RETURN_NOT_OK(codec.Compress(data, out->data(), &compressed_len));
+  out->resize(compressed_len);
+  return Status::OK();
+}
+
+Status WritableLogSegment::WriteCompressedEntryBatch(const Slice& data_to_write,
+                                                     uint32_t uncompressed_len) {
+  DCHECK(is_header_written_);
+  DCHECK(!is_footer_written_);
+  uint8_t header_buf[kEntryHeaderSizeV2];
 
   // Fill in the header.
   InlineEncodeFixed32(&header_buf[0], data_to_write.size());
@@ -860,6 +881,62 @@ void WritableLogSegment::GoIdle() {
   compress_buf_.shrink_to_fit();
 }
 
+////////////////////////////////////////////////////////////
+// SharedLogSync
+////////////////////////////////////////////////////////////
+
+SharedLogSync* SharedLogSync::ForDir(Env* env, const string& wals_root_dir) {
+  static std::mutex instances_lock;
+  static auto* instances = new std::unordered_map<string, unique_ptr<SharedLogSync>>();
+  std::lock_guard<std::mutex> l(instances_lock);
+  auto& instance = (*instances)[wals_root_dir];
+  if (!instance) {
+    instance.reset(new SharedLogSync(env, wals_root_dir));
+  }
+  return instance.get();
+}
+
+SharedLogSync::SharedLogSync(Env* env, string dir)
+    : env_(env),
+      dir_(std::move(dir)) {
+}
+
+Status SharedLogSync::Sync() {
+  std::unique_lock<std::mutex> l(lock_);
+  const uint64_t ticket = ++requested_;
+  while (true) {
+    if (!error_.ok()) {
+      return error_;
+    }
+    if (served_ >= ticket) {
+      return Status::OK();
+    }
+    if (!syncing_) {
+      // Become the leader of the next round, which serves all the syncs
+      // requested until now.
+      syncing_ = true;
+      const uint64_t round = requested_;
+      l.unlock();
+      Status s = env_->SyncFileSystem(dir_);
+      l.lock();
+      syncing_ = false;
+      num_filesystem_syncs_++;
+      if (PREDICT_FALSE(!s.ok()) && error_.ok()) {
+        error_ = s.CloneAndPrepend("could not sync the filesystem of the WALs");
+      }
+      served_ = round;
+      cond_.notify_all();
+      continue;
+    }
+    cond_.wait(l);
+  }
+}
+
+int64_t SharedLogSync::num_filesystem_syncs() const {
+  std::lock_guard<std::mutex> l(lock_);
+  return num_filesystem_syncs_;
+}
+
 bool IsLogFileName(const string& fname) {
   if (HasPrefixString(fname, ".")) {
     // Hidden file or ./..
@@ -17,9 +17,11 @@
 #pragma once
 
 #include <cstddef>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -71,6 +73,10 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // Whether to serve the fsyncs of the log through the SharedLogSync of its
+  // filesystem, alongside the logs of the other tablets.
+  bool share_fsyncs;
+
   LogOptions();
 };
 
@@ -428,6 +434,17 @@ class WritableLogSegment {
   // Write a compressed entry to the log.
   Status WriteEntryBatch(const Slice& data, const CompressionCodec* codec);
 
+  // Compresses the data of a batch with 'codec' into 'out', so that it may be
+  // written by WriteCompressedEntryBatch(). Doesn't touch any segment, so may
+  // run concurrently with its writes and syncs.
+  static Status CompressEntryBatch(const Slice& data, const CompressionCodec& codec,
+                                   faststring* out);
+
+  // Like WriteEntryBatch(), but for data already compressed by
+  // CompressEntryBatch() with the codec of the segment, from
+  // 'uncompressed_len' bytes.
+  Status WriteCompressedEntryBatch(const Slice& compressed_data, uint32_t uncompressed_len);
+
   // Makes sure the I/O buffers belonging to the underlying file handle are flushed.
   Status Sync() {
     return file_->Sync();
@@ -502,6 +519,53 @@ class WritableLogSegment {
   DISALLOW_COPY_AND_ASSIGN(WritableLogSegment);
 };
 
+// Coalesces the fsyncs of the logs of all the tablets whose WALs share a root
+// directory: concurrent syncs are served by a single syncfs(2) of its
+// filesystem instead of an fsync per segment, so that small writes spread
+// across many tablets cost few device cache flushes.
+//
+// A sync is served by the first syncfs(2) which starts after it's requested.
+// Once a syncfs(2) fails, all later syncs fail as well, since the writeback
+// errors it reports may belong to any of the files.
+//
+// This class is thread-safe.
+class SharedLogSync {
+ public:
+  // Returns the instance for the WALs under 'wals_root_dir', creating it if
+  // needed. Instances live until the end of the process.
+  static SharedLogSync* ForDir(Env* env, const std::string& wals_root_dir);
+
+  // Makes all the data written to the filesystem so far durable.
+  Status Sync();
+
+  // The number of syncfs(2) calls made so far.
+  int64_t num_filesystem_syncs() const;
+
+ private:
+  SharedLogSync(Env* env, std::string dir);
+
+  Env* const env_;
+  const std::string dir_;
+
+  mutable std::mutex lock_;
+  std::condition_variable cond_;
+
+  // The number of syncs requested so far, and the number of these which were
+  // served. Sync requests are numbered in order.
+  uint64_t requested_ = 0;
+  uint64_t served_ = 0;
+
+  // Whether a syncfs(2) is ongoing.
+  bool syncing_ = false;
+
+  // The first error returned by syncfs(2), if any.
+  Status error_;
+
+  int64_t num_filesystem_syncs_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedLogSync);
+};
+
 // Checks if 'fname' is a correctly formatted name of log segment file.
 bool IsLogFileName(const std::string& fname);
 
@@ -50,6 +50,7 @@
 #include "kudu/util/countdown_latch.h"
 #include "kudu/util/fault_injection.h"
 #include "kudu/util/locks.h"
+#include "kudu/util/metrics.h"
 #include "kudu/util/random.h"
 #include "kudu/util/status.h"
 #include "kudu/util/status_callback.h"
@@ -63,9 +64,13 @@ DEFINE_int32(num_batches_per_thread, 2000, "Number of batches per thread");
 DEFINE_int32(num_ops_per_batch_avg, 5, "Target average number of ops per batch");
 DEFINE_bool(verify_log, true, "Whether to verify the log by reading it after the writes complete");
 
+DECLARE_bool(log_group_commit_pipeline);
+DECLARE_int32(log_group_commit_target_latency_us);
 DECLARE_int32(log_thread_idle_threshold_ms);
 DECLARE_int32(log_inject_thread_lifecycle_latency_ms);
 
+METRIC_DECLARE_histogram(log_bytes_per_group);
+
 using kudu::consensus::OpId;
 using kudu::consensus::ReplicateRefPtr;
 using kudu::consensus::ReplicateMsg;
@@ -261,5 +266,19 @@ TEST_F(MultiThreadedLogTest, TestAppendThreadStartStopRaces) {
   NO_FATALS(VerifyLog());
 }
 
+// Appends with groups held open to collect more batches and synced while the
+// next group is compressed, and verifies that the log is still written in
+// order.
+TEST_F(MultiThreadedLogTest, TestAppendsWithPipelinedGroupCommit) {
+  FLAGS_log_group_commit_pipeline = true;
+  FLAGS_log_group_commit_target_latency_us = 1000;
+  options_.segment_size_mb = 1;
+  ASSERT_OK(BuildLog());
+  NO_FATALS(Run());
+  ASSERT_OK(log_->Close());
+  NO_FATALS(VerifyLog());
+  ASSERT_GT(METRIC_log_bytes_per_group.Instantiate(metric_entity_tablet_)->TotalCount(), 0);
+}
+
 } // namespace log
 } // namespace kudu
@@ -132,6 +132,18 @@ DEFINE_bool(raft_prepare_replacement_before_eviction, true,
 TAG_FLAG(raft_prepare_replacement_before_eviction, advanced);
 TAG_FLAG(raft_prepare_replacement_before_eviction, experimental);
 
+DEFINE_bool(raft_enable_leader_leases, false,
+            "When enabled, leaders track whether they hold a lease on their "
+            "leadership, based on the followers withholding their votes from other "
+            "candidates for the minimum election timeout after accepting a request. "
+            "That withholding isn't persisted, so replicas which restart withhold "
+            "their votes for the minimum election timeout after they start, and the "
+            "flag must be set on all the replicas of the tablets. Elections ignoring "
+            "the live leader, other than the ones of leadership transfers, must not "
+            "be used along with leases.");
+TAG_FLAG(raft_enable_leader_leases, experimental);
+TAG_FLAG(raft_enable_leader_leases, runtime);
+
 DECLARE_int32(memory_limit_warn_threshold_percentage);
 
 // Metrics
@@ -284,6 +296,10 @@ Status RaftConsensus::Start(const ConsensusBootstrapInfo& info,
       info.last_id,
       info.last_committed_id,
       server_ctx_.allow_status_msg_for_failed_peer));
+  // The ops that peers catching up read from the log are read ahead of their
+  // requests on another thread of the pool, rather than once they're needed
+  // on the thread sending their requests.
+  queue->EnableLogCacheReadAhead(raft_pool->NewToken(ThreadPool::ExecutionMode::CONCURRENT));
 
   // A manager for the set of peers that actually send the operations both remotely
   // and to the local wal.
@@ -381,6 +397,13 @@ Status RaftConsensus::Start(const ConsensusBootstrapInfo& info,
     // Now assume non-leader replica duties.
     RETURN_NOT_OK(BecomeReplicaUnlocked(fd_initial_delta));
 
+    // Before restarting, the replica might have accepted requests from a leader
+    // which counts on it to withhold its votes while the leader holds a lease.
+    // There was no leader before the first term, hence no lease.
+    if (FLAGS_raft_enable_leader_leases && CurrentTermUnlocked() > 0) {
+      WithholdVotes();
+    }
+
     SetStateUnlocked(kRunning);
   }
 
@@ -632,6 +655,9 @@ Status RaftConsensus::BeginLeaderTransferPeriodUnlocked(
         Substitute("leadership transfer for $0 already in progress",
                    options_.tablet_id));
   }
+  // The successor runs an election ignoring this leader: the lease can't be
+  // relied upon anymore in this term.
+  queue_->RevokeLeaderLease();
   queue_->BeginWatchForSuccessor(successor_uuid);
   transfer_period_timer_->Start();
   return Status::OK();
@@ -2537,6 +2563,46 @@ MonoDelta RaftConsensus::MinimumElectionTimeout() {
   return MonoDelta::FromMilliseconds(failure_timeout);
 }
 
+MonoDelta RaftConsensus::LeaderLeaseDuration() {
+  // Account for the monotonic clocks of the leader and the followers ticking
+  // at rates differing by up to 10%.
+  return MonoDelta::FromNanoseconds(MinimumElectionTimeout().ToNanoseconds() * 9 / 10);
+}
+
+bool RaftConsensus::HasLeaderLease() const {
+  if (!FLAGS_raft_enable_leader_leases || leader_transfer_in_progress_) {
+    return false;
+  }
+  const MonoTime lease_start = queue_->GetLeaderLeaseStartTime();
+  if (lease_start == MonoTime::Min()) {
+    return false;
+  }
+  return lease_start == MonoTime::Max() ||
+      MonoTime::Now() < lease_start + LeaderLeaseDuration();
+}
+
+Status RaftConsensus::WaitForLeaderLease(const MonoTime& deadline) const {
+  DCHECK(FLAGS_raft_enable_leader_leases);
+  // The lease is normally renewed by every heartbeat, so polling doesn't
+  // need to be any finer than a fraction of the heartbeat interval.
+  const MonoDelta max_wait = MonoDelta::FromMilliseconds(
+      std::max(1, FLAGS_raft_heartbeat_interval_ms / 10));
+  MonoDelta wait = MonoDelta::FromMilliseconds(1);
+  while (!HasLeaderLease()) {
+    if (role() != RaftPeerPB::LEADER) {
+      return Status::IllegalState("replica is not the leader of the tablet",
+                                  peer_uuid());
+    }
+    const MonoTime now = MonoTime::Now();
+    if (now >= deadline) {
+      return Status::TimedOut("timed out waiting for the leader lease", peer_uuid());
+    }
+    SleepFor(std::min(wait, deadline - now));
+    wait = std::min(wait + wait, max_wait);
+  }
+  return Status::OK();
+}
+
 void RaftConsensus::SetLeaderUuidUnlocked(const string& uuid) {
   DCHECK(lock_.is_locked());
   failed_elections_since_stable_leader_ = 0;
@@ -2830,6 +2896,12 @@ log::RetentionIndexes RaftConsensus::GetRetentionIndexes() {
                                queue_->GetAllReplicatedIndex()); // for peers
 }
 
+Status RaftConsensus::ReadCommittedOps(int64_t after_op_index,
+                                       int64_t max_size_bytes,
+                                       std::vector<ReplicateRefPtr>* ops) {
+  return queue_->ReadCommittedOps(after_op_index, max_size_bytes, ops);
+}
+
 void RaftConsensus::MarkDirty(const string& reason) {
   WARN_NOT_OK(raft_pool_token_->Submit([=]() { this->mark_dirty_clbk_(reason); }),
               LogPrefixThreadSafe() + "Unable to run MarkDirty callback");
@@ -267,6 +267,23 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   // that the term has not changed in the meantime.
   Status CheckLeadershipAndBindTerm(const scoped_refptr<ConsensusRound>& round);
 
+  // Returns whether this replica holds the leader lease, i.e. whether no other
+  // replica may have been elected leader in a newer term. While holding the
+  // lease, the leader may serve reads of the latest data without replicating
+  // anything. Always false unless --raft_enable_leader_leases is set.
+  //
+  // The lease relies upon the followers withholding their votes for the
+  // minimum election timeout after accepting a request from the leader, and
+  // again after they start, since the withholding isn't persisted. It's not
+  // safe with elections which ignore the live leader, except for those which
+  // this leader triggers while transferring the leadership.
+  bool HasLeaderLease() const;
+
+  // Waits until this replica holds the leader lease. Returns IllegalState if
+  // the replica stops being the leader first, and TimedOut if 'deadline'
+  // passes first. Must only be called with --raft_enable_leader_leases set.
+  Status WaitForLeaderLease(const MonoTime& deadline) const;
+
   // Messages sent from LEADER to FOLLOWERS and LEARNERS to update their
   // state machines. This is equivalent to "AppendEntries()" in Raft
   // terminology.
@@ -403,6 +420,12 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   // GCing these before the peer has caught up.
   log::RetentionIndexes GetRetentionIndexes();
 
+  // Reads the committed ops following 'after_op_index', in op order.
+  // See PeerMessageQueue::ReadCommittedOps().
+  Status ReadCommittedOps(int64_t after_op_index,
+                          int64_t max_size_bytes,
+                          std::vector<ReplicateRefPtr>* ops);
+
   // Return the on-disk size of the consensus metadata, in bytes.
   int64_t MetadataOnDiskSize() const;
 
@@ -421,6 +444,7 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   FRIEND_TEST(RaftConsensusQuorumTest, TestLeaderElectionWithQuiescedQuorum);
   FRIEND_TEST(RaftConsensusQuorumTest, TestReplicasEnforceTheLogMatchingProperty);
   FRIEND_TEST(RaftConsensusQuorumTest, TestRequestVote);
+  FRIEND_TEST(RaftConsensusQuorumTest, TestWithholdVotesAfterStartWithLeaderLeases);
 
   // RaftConsensus lifecycle states.
   //
@@ -487,6 +511,10 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   // jitter, election timeouts may be longer than this.
   static MonoDelta MinimumElectionTimeout();
 
+  // Return the duration of the leader lease: the minimum election timeout,
+  // less a margin for the clock rates of the replicas to differ.
+  static MonoDelta LeaderLeaseDuration();
+
   // Initializes the RaftConsensus object, including loading the consensus
   // metadata.
   Status Init();
@@ -75,6 +75,7 @@
 
 DECLARE_int32(raft_heartbeat_interval_ms);
 DECLARE_bool(enable_leader_failure_detection);
+DECLARE_bool(raft_enable_leader_leases);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -1193,5 +1194,41 @@ TEST_F(RaftConsensusQuorumTest, TestRequestVote) {
   LOG(INFO) << "Follower rejected old heartbeat, as expected: " << SecureShortDebugString(res);
 }
 
+// Test that, with leader leases, a replica starting in a term which may have
+// had a leader withholds its vote for the minimum election timeout: it might
+// have accepted requests from a leader holding a lease before restarting.
+TEST_F(RaftConsensusQuorumTest, TestWithholdVotesAfterStartWithLeaderLeases) {
+  FLAGS_raft_enable_leader_leases = true;
+  ASSERT_OK(BuildConfig(3));
+
+  const int kPeerIndex = 1;
+  shared_ptr<RaftConsensus> peer;
+  ASSERT_OK(peers_->GetPeerByIdx(kPeerIndex, &peer));
+  peer->consensus_metadata_for_tests()->set_current_term(1);
+  ASSERT_OK(StartPeers());
+
+  VoteRequestPB request;
+  request.set_tablet_id(kTestTablet);
+  request.set_candidate_uuid(fs_managers_[0]->uuid());
+  request.set_candidate_term(2);
+  request.mutable_candidate_status()->mutable_last_received()->CopyFrom(MinimumOpId());
+
+  VoteResponsePB response;
+  ASSERT_OK(peer->RequestVote(&request,
+                              TabletVotingState(nullopt, tablet::TABLET_DATA_READY),
+                              &response));
+  ASSERT_FALSE(response.vote_granted());
+  ASSERT_EQ(ConsensusErrorPB::LEADER_IS_ALIVE, response.consensus_error().code());
+
+  // Once the minimum election timeout has passed, the replica votes again.
+  SleepFor(RaftConsensus::MinimumElectionTimeout());
+  response.Clear();
+  ASSERT_OK(peer->RequestVote(&request,
+                              TabletVotingState(nullopt, tablet::TABLET_DATA_READY),
+                              &response));
+  ASSERT_TRUE(response.vote_granted());
+  NO_FATALS(AssertDurableTermAndVote(kPeerIndex, 2, fs_managers_[0]->uuid()));
+}
+
 }  // namespace consensus
 }  // namespace kudu
@@ -16,8 +16,15 @@
 // under the License.
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
 #include "kudu/consensus/consensus.pb.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
 
 namespace kudu {
 namespace consensus {
@@ -31,8 +38,29 @@ class RefCountedReplicate : public RefCountedThreadSafe<RefCountedReplicate> {
     return msg_.get();
   }
 
+  // Returns the message serialized as the length-delimited field with number
+  // 'field_number' of an enclosing message, e.g. as one of the ops of a
+  // ConsensusRequestPB. The message is serialized once, on the first call:
+  // it must not be modified afterwards, and 'field_number' must be the same
+  // across calls.
+  Slice SerializedAsField(uint32_t field_number) {
+    std::call_once(serialize_once_, [&]() {
+      const size_t size = msg_->ByteSizeLong();
+      // The tag of a length-delimited field, i.e. of wire type 2.
+      PutVarint32(&serialized_field_, (field_number << 3) | 2);
+      PutVarint32(&serialized_field_, size);
+      const size_t header_size = serialized_field_.size();
+      serialized_field_.resize(header_size + size);
+      msg_->SerializeWithCachedSizesToArray(serialized_field_.data() + header_size);
+    });
+    return Slice(serialized_field_);
+  }
+
  private:
   std::unique_ptr<ReplicateMsg> msg_;
+
+  std::once_flag serialize_once_;
+  faststring serialized_field_;
 };
 
 typedef scoped_refptr<RefCountedReplicate> ReplicateRefPtr;
@@ -17,10 +17,15 @@
 
 #include "kudu/fs/block_manager.h"
 
+#include <memory>
+
 #include <gflags/gflags.h>
 
+#include "kudu/fs/block_id.h"
 #include "kudu/gutil/macros.h"
+#include "kudu/util/env.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/status.h"
 
 // The default value is optimized for throughput in the case that
 // there are multiple drives backing the tablet. By asynchronously
@@ -49,5 +54,10 @@ namespace fs {
 BlockManagerOptions::BlockManagerOptions()
   : read_only(false) {}
 
+Status ReadableBlock::Map(uint64_t /* offset */, size_t /* length */,
+                          std::unique_ptr<MappedFileRange>* /* range */) const {
+  return Status::NotSupported("mapping is not supported", id().ToString());
+}
+
 } // namespace fs
 } // namespace kudu
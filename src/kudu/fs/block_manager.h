@@ -30,6 +30,7 @@
 namespace kudu {
 
 class BlockId;
+class MappedFileRange;
 class MemTracker;
 class Slice;
 template <typename T>
@@ -163,16 +164,41 @@ class ReadableBlock : public Block {
   // If an error was encountered, returns a non-OK status.
   virtual Status ReadV(uint64_t offset, ArrayView<Slice> results) const = 0;
 
+  // Maps 'length' bytes of the block beginning at 'offset' into memory, so
+  // that they may be read in place rather than copied, returning an error if
+  // fewer bytes exist. The range stays mapped until 'range' is destroyed, even
+  // if the block is closed.
+  //
+  // Returns Status::NotSupported if the block can't be mapped, e.g. because
+  // it is encrypted.
+  virtual Status Map(uint64_t offset, size_t length,
+                     std::unique_ptr<MappedFileRange>* range) const;
+
   // Returns the memory usage of this object including the object itself.
   virtual size_t memory_footprint() const = 0;
 };
 
+// How the data of a new block is expected to be used, for its placement
+// within its DataDirGroup. See --fs_data_dirs_fast_media.
+enum class BlockTemperature {
+  // No particular expectation.
+  DEFAULT,
+
+  // Data which is likely to be read and rewritten soon, e.g. the output of
+  // MemRowSet flushes: prefers directories on fast media.
+  HOT,
+
+  // Data which is likely to stay around untouched, e.g. the output of
+  // compactions: prefers directories which aren't on fast media.
+  COLD,
+};
+
 // Provides options and hints for block placement. This is used for identifying
-// the correct DataDirGroups to place blocks. In the future this may also be
-// used to specify directories based on block type (e.g. to prefer bloom block
-// placement into SSD-backed directories).
+// the correct DataDirGroups to place blocks, and the directory of the group to
+// place blocks into.
 struct CreateBlockOptions {
   const std::string tablet_id;
+  BlockTemperature temperature = BlockTemperature::DEFAULT;
 };
 
 // Block manager creation options.
@@ -282,6 +308,11 @@ class BlockManager : public RefCountedThreadSafe<BlockManager> {
   // because those ids' blocks were on a data directory that failed).
   virtual void NotifyBlockId(BlockId block_id) = 0;
 
+  // Hints that the given blocks are about to be read, so that the files
+  // backing them may be reopened ahead of time if they were closed to respect
+  // the limit on open files. Blocks which don't exist are ignored.
+  virtual void PrefetchBlocks(const std::vector<BlockId>& block_ids) = 0;
+
   // Exposes the FsErrorManager used to handle fs errors.
   virtual scoped_refptr<FsErrorManager> error_manager() = 0;
 
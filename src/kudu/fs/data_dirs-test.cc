@@ -45,6 +45,7 @@
 #include "kudu/util/env.h"
 #include "kudu/util/env_util.h"
 #include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/path_util.h"
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
@@ -67,6 +68,7 @@ DECLARE_int64(disk_reserved_bytes_free_for_testing);
 DECLARE_int64(fs_data_dirs_reserved_bytes);
 DECLARE_string(env_inject_eio_globs);
 DECLARE_string(env_inject_full_globs);
+DECLARE_string(fs_data_dirs_fast_media);
 
 METRIC_DECLARE_gauge_uint64(data_dirs_failed);
 
@@ -381,6 +383,54 @@ TEST_F(DataDirsTest, TestLoadBalancingDistribution) {
 
 }
 
+TEST_F(DataDirsTest, TestFastMediaPlacement) {
+  // Reopen the directories with the first two on fast media.
+  const vector<string> dir_names = GetDirNames(kNumDirs);
+  FLAGS_fs_data_dirs_fast_media = JoinStrings({ dir_names[0], dir_names[1] }, ",");
+  FLAGS_fs_target_data_dirs_per_tablet = 3;
+  dd_manager_.reset();
+  ASSERT_OK(DataDirManager::OpenExistingForTests(
+      env_, dir_names, DataDirManagerOptions(), &dd_manager_));
+  int num_fast_dirs = 0;
+  for (const auto& dd : dd_manager_->dirs()) {
+    if (dd->is_fast_media()) {
+      num_fast_dirs++;
+    }
+  }
+  ASSERT_EQ(2, num_fast_dirs);
+
+  // Every group gets a fast directory, which hot blocks go to, and cold
+  // blocks don't.
+  for (int tablet_idx = 0; tablet_idx < 10; tablet_idx++) {
+    const string tablet_id = Substitute("$0-$1", test_tablet_name_, tablet_idx);
+    ASSERT_OK(dd_manager_->CreateDataDirGroup(tablet_id));
+    for (int i = 0; i < 10; i++) {
+      Dir* dd;
+      ASSERT_OK(dd_manager_->GetDirAddIfNecessary(
+          CreateBlockOptions({ tablet_id, BlockTemperature::HOT }), &dd));
+      ASSERT_TRUE(dd->is_fast_media()) << dd->dir();
+      ASSERT_OK(dd_manager_->GetDirAddIfNecessary(
+          CreateBlockOptions({ tablet_id, BlockTemperature::COLD }), &dd));
+      ASSERT_FALSE(dd->is_fast_media()) << dd->dir();
+    }
+  }
+}
+
+TEST_F(DataDirsTest, TestWriteCost) {
+  Dir* dd = dd_manager_->dirs()[0].get();
+  ASSERT_EQ(0, dd->write_cost_us());
+  {
+    Dir::ScopedWrite write(dd, 1024);
+    SleepFor(MonoDelta::FromMilliseconds(10));
+  }
+  const int64_t cost = dd->write_cost_us();
+  ASSERT_GE(cost, 10000);
+
+  // Writes in flight make it costlier.
+  Dir::ScopedWrite write(dd, 1024);
+  ASSERT_EQ(2 * cost, dd->write_cost_us());
+}
+
 TEST_F(DataDirsTest, TestLoadBalancingBias) {
   // Shows that block placement will tend to favor directories with less load.
   // First add a set of tablets for skew. Then add more tablets and check that
@@ -43,7 +43,10 @@
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/split.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/strings/util.h"
+#include "kudu/util/env.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/metrics.h"
@@ -102,6 +105,24 @@ DEFINE_bool(fs_data_dirs_consider_available_space, true,
 TAG_FLAG(fs_data_dirs_consider_available_space, runtime);
 TAG_FLAG(fs_data_dirs_consider_available_space, evolving);
 
+DEFINE_bool(fs_data_dirs_consider_write_load, false,
+            "Whether to consider how fast the data directories currently "
+            "write, as measured from the latency of their recent writes and "
+            "the number of writes in flight, when selecting a data directory "
+            "during data block creation. Directories which write markedly "
+            "faster are preferred over those with more available space.");
+TAG_FLAG(fs_data_dirs_consider_write_load, runtime);
+TAG_FLAG(fs_data_dirs_consider_write_load, experimental);
+
+DEFINE_string(fs_data_dirs_fast_media, "",
+              "Comma-separated list of the data directories, among "
+              "--fs_data_dirs, which are on fast media, e.g. SSDs or NVMe "
+              "devices. The blocks written by MemRowSet flushes favor these "
+              "directories, and the blocks written by compactions favor the "
+              "others, within the directory group of their tablet. New "
+              "directory groups include one of these directories, if possible.");
+TAG_FLAG(fs_data_dirs_fast_media, experimental);
+
 DEFINE_uint64(fs_max_thread_count_per_data_dir, 8,
               "Maximum work thread per data directory.");
 TAG_FLAG(fs_max_thread_count_per_data_dir, advanced);
@@ -196,10 +217,31 @@ Status DataDirGroup::CopyToPB(const UuidByUuidIndexMap& uuid_by_uuid_idx,
 // DataDir
 ////////////////////////////////////////////////////////////
 
+namespace {
+
+// Returns whether 'dir', a canonicalized data directory, is under one of
+// --fs_data_dirs_fast_media.
+bool IsFastMediaDir(Env* env, const string& dir) {
+  for (const auto& root : strings::Split(FLAGS_fs_data_dirs_fast_media, ",",
+                                         strings::SkipEmpty())) {
+    string canonicalized;
+    if (!env->Canonicalize(root.ToString(), &canonicalized).ok()) {
+      canonicalized = root.ToString();
+    }
+    if (dir == canonicalized || HasPrefixString(dir, canonicalized + "/")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // anonymous namespace
+
 DataDir::DataDir(Env* env, DirMetrics* metrics, FsType fs_type, std::string dir,
                  std::unique_ptr<DirInstanceMetadataFile> metadata_file,
                  std::unique_ptr<ThreadPool> pool)
-    : Dir(env, metrics, fs_type, std::move(dir), std::move(metadata_file), std::move(pool)) {}
+    : Dir(env, metrics, fs_type, dir, std::move(metadata_file), std::move(pool)),
+      is_fast_media_(IsFastMediaDir(env, dir)) {}
 
 std::unique_ptr<Dir> DataDirManager::CreateNewDir(
     Env* env, DirMetrics* metrics, FsType fs_type,
@@ -472,16 +514,47 @@ Status DataDirManager::GetDirForBlock(const CreateBlockOptions& opts, Dir** dir,
                    opts.tablet_id, num_total, num_failed, num_full),
         "", ENOSPC);
   }
+  // Keep to the directories on the media suiting the block, if the group
+  // has any to spare.
+  if (opts.temperature != BlockTemperature::DEFAULT) {
+    const bool want_fast = opts.temperature == BlockTemperature::HOT;
+    vector<Dir*> suiting_dirs;
+    for (Dir* candidate : candidate_dirs) {
+      if (candidate->is_fast_media() == want_fast) {
+        suiting_dirs.emplace_back(candidate);
+      }
+    }
+    if (!suiting_dirs.empty()) {
+      candidate_dirs = std::move(suiting_dirs);
+    }
+  }
   if (candidate_dirs.size() == 1) {
     *dir = candidate_dirs[0];
     return Status::OK();
   }
-  // Pick two randomly and select the one with more space.
+  // Pick two randomly and select the one which writes markedly faster, if
+  // considering it, or else the one with more space.
   shuffle(candidate_dirs.begin(), candidate_dirs.end(),
           default_random_engine(rng_.Next()));
+  Dir* first = candidate_dirs[0];
+  Dir* second = candidate_dirs[1];
+  if (PREDICT_FALSE(FLAGS_fs_data_dirs_consider_write_load)) {
+    const int64_t first_cost = first->write_cost_us();
+    const int64_t second_cost = second->write_cost_us();
+    // Differences of less than a quarter are likely noise.
+    if (first_cost > 0 && second_cost > 0) {
+      if (first_cost * 4 < second_cost * 3) {
+        *dir = first;
+        return Status::OK();
+      }
+      if (second_cost * 4 < first_cost * 3) {
+        *dir = second;
+        return Status::OK();
+      }
+    }
+  }
   *dir = PREDICT_TRUE(FLAGS_fs_data_dirs_consider_available_space) &&
-         candidate_dirs[0]->available_bytes() > candidate_dirs[1]->available_bytes() ?
-           candidate_dirs[0] : candidate_dirs[1];
+         first->available_bytes() > second->available_bytes() ? first : second;
   return Status::OK();
 }
 
@@ -589,6 +662,26 @@ void DataDirManager::GetDirsForGroupUnlocked(int target_size,
       candidate_indices.push_back(uuid_idx);
     }
   }
+  // Start with the fast directory with the fewest tablets, if the group has
+  // no fast directory yet.
+  if (group_indices->size() < target_size &&
+      std::none_of(group_indices->begin(), group_indices->end(), [&](int uuid_idx) {
+        return FindOrDie(dir_by_uuid_idx_, uuid_idx)->is_fast_media();
+      })) {
+    auto fastest = candidate_indices.end();
+    for (auto it = candidate_indices.begin(); it != candidate_indices.end(); ++it) {
+      if (FindOrDie(dir_by_uuid_idx_, *it)->is_fast_media() &&
+          (fastest == candidate_indices.end() ||
+           FindOrDie(tablets_by_uuid_idx_map_, *it).size() <
+               FindOrDie(tablets_by_uuid_idx_map_, *fastest).size())) {
+        fastest = it;
+      }
+    }
+    if (fastest != candidate_indices.end()) {
+      group_indices->push_back(*fastest);
+      candidate_indices.erase(fastest);
+    }
+  }
   while (group_indices->size() < target_size && !candidate_indices.empty()) {
     shuffle(candidate_indices.begin(), candidate_indices.end(), default_random_engine(rng_.Next()));
     if (candidate_indices.size() == 1) {
@@ -98,6 +98,11 @@ class DataDir : public Dir {
 
   int available_space_cache_secs() const override;
   int reserved_bytes() const override;
+  bool is_fast_media() const override { return is_fast_media_; }
+
+ private:
+  // Whether the directory is under one of --fs_data_dirs_fast_media.
+  const bool is_fast_media_;
 };
 
 struct DataDirManagerOptions : public DirManagerOptions {
@@ -221,9 +226,12 @@ class DataDirManager : public DirManager,
                  CanonicalizedRootsList canonicalized_data_roots);
 
   // Returns a random directory in the data dir group specified in 'opts',
-  // giving preference to those with more free space. If there is no room in
-  // the group, returns an IOError with the ENOSPC posix code and returns the
-  // new target size for the data dir group.
+  // giving preference to those with more free space or, if
+  // --fs_data_dirs_consider_write_load is set, to those which write faster.
+  // The temperature of the block in 'opts' restricts the choice to the
+  // directories on fast media or to the others, when the group has both. If
+  // there is no room in the group, returns an IOError with the ENOSPC posix
+  // code and returns the new target size for the data dir group.
   Status GetDirForBlock(const CreateBlockOptions& opts, Dir** dir,
                         int* new_target_group_size) const;
 
@@ -237,6 +245,10 @@ class DataDirManager : public DirManager,
   // resulting behavior fills directories that have fewer tablets stored on
   // them while not completely neglecting those with more tablets.
   //
+  // If some directories are on fast media (see --fs_data_dirs_fast_media) and
+  // none of the group is, one of them is selected first, so that the blocks
+  // of the group preferring fast media have somewhere to go.
+  //
   // 'group_indices' is an in/out parameter that stores the list of UUID
   // indices to be added; UUID indices that are already in 'group_indices' are
   // not considered. Although this function does not itself change
@@ -85,7 +85,9 @@ Dir::Dir(Env* env,
       pool_(std::move(pool)),
       is_shutdown_(false),
       is_full_(false),
-      available_bytes_(0) {
+      available_bytes_(0),
+      write_latency_us_per_mb_(0),
+      writes_in_flight_(0) {
 }
 
 Dir::~Dir() {
@@ -115,6 +117,32 @@ void Dir::WaitOnClosures() {
   pool_->Wait();
 }
 
+Dir::ScopedWrite::ScopedWrite(Dir* dir, int64_t bytes)
+    : dir_(dir),
+      bytes_(bytes),
+      start_(MonoTime::Now()) {
+  dir_->writes_in_flight_.fetch_add(1, std::memory_order_relaxed);
+}
+
+Dir::ScopedWrite::~ScopedWrite() {
+  static constexpr int64_t kMiB = 1024 * 1024;
+  // The weight of the previous estimate, out of 8: the estimate follows the
+  // trend of the last few dozen writes.
+  static constexpr int64_t kPrevWeight = 7;
+  dir_->writes_in_flight_.fetch_sub(1, std::memory_order_relaxed);
+  const int64_t latency_us = (MonoTime::Now() - start_).ToMicroseconds();
+  const int64_t sample = latency_us * kMiB / std::max(bytes_, kMiB);
+  const int64_t prev = dir_->write_latency_us_per_mb_.load(std::memory_order_relaxed);
+  const int64_t next = prev == 0 ? sample : (prev * kPrevWeight + sample) / 8;
+  // 0 stands for an unknown estimate.
+  dir_->write_latency_us_per_mb_.store(std::max<int64_t>(next, 1), std::memory_order_relaxed);
+}
+
+int64_t Dir::write_cost_us() const {
+  return write_latency_us_per_mb_.load(std::memory_order_relaxed) *
+      (1 + writes_in_flight_.load(std::memory_order_relaxed));
+}
+
 Status Dir::RefreshAvailableSpace(RefreshMode mode) {
   switch (mode) {
     case RefreshMode::EXPIRED_ONLY: {
@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -159,6 +160,31 @@ class Dir {
   // value of -1 means 1% of the disk space in a directory will be reserved.
   virtual int reserved_bytes() const = 0;
 
+  // Whether the directory is on fast media, e.g. an SSD, as opposed to
+  // spinning disks.
+  virtual bool is_fast_media() const = 0;
+
+  // Tracks a write of 'bytes' to the directory, or a sync of its writes, for
+  // as long as it's in scope. See write_cost_us().
+  class ScopedWrite {
+   public:
+    ScopedWrite(Dir* dir, int64_t bytes);
+    ~ScopedWrite();
+
+   private:
+    Dir* const dir_;
+    const int64_t bytes_;
+    const MonoTime start_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedWrite);
+  };
+
+  // An estimate of how long the directory currently takes to write a MiB, in
+  // microseconds: the latency of its recent writes, smoothed and scaled by
+  // the number of writes in flight. Writes and syncs of less than a MiB count
+  // as a MiB. Returns 0 if no write was tracked yet.
+  int64_t write_cost_us() const;
+
  private:
   Env* env_;
   DirMetrics* metrics_;
@@ -177,6 +203,11 @@ class Dir {
   // The available bytes of this dir, updated by RefreshAvailableSpace.
   int64_t available_bytes_;
 
+  // See write_cost_us(). Updated without synchronization: concurrent writes
+  // may lose each other's samples, which is fine for an estimate.
+  std::atomic<int64_t> write_latency_us_per_mb_;
+  std::atomic<int> writes_in_flight_;
+
   DISALLOW_COPY_AND_ASSIGN(Dir);
 };
 
@@ -453,6 +453,9 @@ class FileReadableBlock : public ReadableBlock {
 
   Status ReadV(uint64_t offset, ArrayView<Slice> results) const override;
 
+  Status Map(uint64_t offset, size_t length,
+             unique_ptr<MappedFileRange>* range) const override;
+
   size_t memory_footprint() const override;
 
   void HandleError(const Status& s) const;
@@ -547,6 +550,22 @@ Status FileReadableBlock::ReadV(uint64_t offset, ArrayView<Slice> results) const
   return Status::OK();
 }
 
+Status FileReadableBlock::Map(uint64_t offset, size_t length,
+                              unique_ptr<MappedFileRange>* range) const {
+  DCHECK(!closed_.Load());
+
+  uint64_t size;
+  RETURN_NOT_OK(Size(&size));
+  if (PREDICT_FALSE(size < offset + length)) {
+    return Status::IOError("Out-of-bounds mapping",
+                           Substitute("mapping of [$0-$1) in block of size $2",
+                                      offset, offset + length, size));
+  }
+  RETURN_NOT_OK_HANDLE_ERROR(reader_->Map(offset + reader_->GetEncryptionHeaderSize(),
+                                          length, range));
+  return Status::OK();
+}
+
 size_t FileReadableBlock::memory_footprint() const {
   DCHECK(reader_);
   return kudu_malloc_usable_size(this) + reader_->memory_footprint();
@@ -991,6 +1010,21 @@ Status FileBlockManager::GetAllBlockIds(vector<BlockId>* block_ids) {
   return Status::OK();
 }
 
+void FileBlockManager::PrefetchBlocks(const vector<BlockId>& block_ids) {
+  if (!file_cache_ || !file_cache_->prefetch_enabled()) {
+    return;
+  }
+  vector<string> paths;
+  paths.reserve(block_ids.size());
+  for (const auto& block_id : block_ids) {
+    string path;
+    if (FindBlockPath(block_id, &path)) {
+      paths.emplace_back(std::move(path));
+    }
+  }
+  file_cache_->Prefetch(paths);
+}
+
 void FileBlockManager::NotifyBlockId(BlockId /* block_id */) {
   // Since the FileBlockManager doesn't keep a record of blocks, this does
   // nothing. This opens it up for block ID reuse if, say, a directory were
@@ -100,6 +100,8 @@ class FileBlockManager : public BlockManager {
 
   void NotifyBlockId(BlockId block_id) override;
 
+  void PrefetchBlocks(const std::vector<BlockId>& block_ids) override;
+
   scoped_refptr<FsErrorManager> error_manager() override { return error_manager_; }
 
   std::string tenant_id() const override { return tenant_id_; }
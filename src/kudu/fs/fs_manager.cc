@@ -51,6 +51,7 @@
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/strings/util.h"
 #include "kudu/gutil/walltime.h"
+#include "kudu/util/dir_syncer.h"
 #include "kudu/util/env_util.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
@@ -73,6 +74,14 @@ DEFINE_bool(cmeta_fsync_override_on_xfs, true,
 TAG_FLAG(cmeta_fsync_override_on_xfs, experimental);
 TAG_FLAG(cmeta_fsync_override_on_xfs, advanced);
 
+DEFINE_bool(fs_group_metadata_dir_syncs, true,
+            "Whether the writers of tablet superblocks and of consensus metadata "
+            "files share the fsyncs of the directories of these files, so that "
+            "writing the files of many tablets at once, e.g. when tablets are "
+            "opened or after elections, issues fewer fsyncs.");
+TAG_FLAG(fs_group_metadata_dir_syncs, advanced);
+TAG_FLAG(fs_group_metadata_dir_syncs, runtime);
+
 DEFINE_bool(enable_data_block_fsync, true,
             "Whether to enable fsync() of data blocks, metadata, and their parent directories. "
             "Disabling this flag may cause data loss in the event of a system crash.");
@@ -205,6 +214,8 @@ const char *FsManager::kTabletMetadataDirName = "tablet-meta";
 const char *FsManager::kDataDirName = "data";
 const char *FsManager::kInstanceMetadataFileName = "instance";
 const char *FsManager::kConsensusMetadataDirName = "consensus-meta";
+const char *FsManager::kBlockCacheManifestFileName = "block-cache-manifest";
+const char *FsManager::kHotTabletsFileName = "hot-tablets";
 
 FsManagerOpts::FsManagerOpts()
   : wal_root(FLAGS_fs_wal_dir),
@@ -386,6 +397,8 @@ Status FsManager::Init() {
   }
 
   initted_ = true;
+  tablet_metadata_dir_syncer_.reset(new DirSyncer(env_, GetTabletMetadataDir()));
+  consensus_metadata_dir_syncer_.reset(new DirSyncer(env_, GetConsensusMetadataDir()));
   return Status::OK();
 }
 
@@ -1279,6 +1292,16 @@ string FsManager::GetTabletMetadataPath(const string& tablet_id) const {
   return JoinPathSegments(GetTabletMetadataDir(), tablet_id);
 }
 
+DirSyncer* FsManager::tablet_metadata_dir_syncer() const {
+  DCHECK(initted_);
+  return FLAGS_fs_group_metadata_dir_syncs ? tablet_metadata_dir_syncer_.get() : nullptr;
+}
+
+DirSyncer* FsManager::consensus_metadata_dir_syncer() const {
+  DCHECK(initted_);
+  return FLAGS_fs_group_metadata_dir_syncs ? consensus_metadata_dir_syncer_.get() : nullptr;
+}
+
 bool FsManager::IsValidTabletId(const string& fname) {
   // Prevent warning logs for hidden files or ./..
   if (PREDICT_FALSE(HasPrefixString(fname, "."))) {
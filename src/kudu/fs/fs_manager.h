@@ -57,6 +57,7 @@ DECLARE_bool(enable_data_block_fsync);
 namespace kudu {
 
 class BlockId;
+class DirSyncer;
 class FileCache;
 class InstanceMetadataPB;
 class InstanceMetadataPB_TenantMetadataPB;
@@ -313,6 +314,26 @@ class FsManager {
     return JoinPathSegments(GetConsensusMetadataDir(), tablet_id);
   }
 
+  // Return the syncers of the directories of the tablet superblocks and of the
+  // consensus metadata, shared by the writers of their files, or null if the
+  // fsyncs of these directories aren't grouped.
+  DirSyncer* tablet_metadata_dir_syncer() const;
+  DirSyncer* consensus_metadata_dir_syncer() const;
+
+  // Return the path where the keys of the blocks in the block cache are
+  // saved, to warm the block cache up across restarts.
+  std::string GetBlockCacheManifestPath() const {
+    DCHECK(initted_);
+    return JoinPathSegments(canonicalized_metadata_fs_root_.path, kBlockCacheManifestFileName);
+  }
+
+  // Return the path where the ids of the tablets most recently accessed are
+  // saved, to open them first across restarts.
+  std::string GetHotTabletsPath() const {
+    DCHECK(initted_);
+    return JoinPathSegments(canonicalized_metadata_fs_root_.path, kHotTabletsFileName);
+  }
+
   // Get env to do read/write.
   // Different tenant owns different env.
   // Return nullptr if search fail when '--enable_multi_tenancy' enabled.
@@ -625,6 +646,8 @@ class FsManager {
   static const char *kWalDirName;
   static const char *kInstanceMetadataFileName;
   static const char *kConsensusMetadataDirName;
+  static const char *kBlockCacheManifestFileName;
+  static const char *kHotTabletsFileName;
 
   typedef rw_spinlock LockType;
 
@@ -680,6 +703,10 @@ class FsManager {
   // Cache whether or not the metadata directory is on an XFS directory.
   bool meta_on_xfs_;
 
+  // Group the fsyncs of the metadata directories. Constructed during Init().
+  std::unique_ptr<DirSyncer> tablet_metadata_dir_syncer_;
+  std::unique_ptr<DirSyncer> consensus_metadata_dir_syncer_;
+
   DISALLOW_COPY_AND_ASSIGN(FsManager);
 };
 
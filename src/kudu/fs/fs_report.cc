@@ -262,6 +262,7 @@ void FsReport::Stats::MergeFrom(const FsReport::Stats& other) {
   live_block_bytes_aligned += other.live_block_bytes_aligned;
   lbm_container_count += other.lbm_container_count;
   lbm_full_container_count += other.lbm_full_container_count;
+  lbm_indexed_container_count += other.lbm_indexed_container_count;
 }
 
 string FsReport::Stats::ToString() const {
@@ -269,9 +270,9 @@ string FsReport::Stats::ToString() const {
       "Total live blocks: $0\n"
       "Total live bytes: $1\n"
       "Total live bytes (after alignment): $2\n"
-      "Total number of LBM containers: $3 ($4 full)\n",
+      "Total number of LBM containers: $3 ($4 full, $5 loaded from the index)\n",
       live_block_count, live_block_bytes, live_block_bytes_aligned,
-      lbm_container_count, lbm_full_container_count);
+      lbm_container_count, lbm_full_container_count, lbm_indexed_container_count);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
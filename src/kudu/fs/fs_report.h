@@ -246,6 +246,10 @@ struct FsReport {
 
     // Total number of full LBM containers.
     int64_t lbm_full_container_count = 0;
+
+    // Number of LBM containers whose records were loaded from the container
+    // index of their data directory, rather than read in full.
+    int64_t lbm_indexed_container_count = 0;
   };
   Stats stats;
 
@@ -80,10 +80,16 @@ using strings::Substitute;
 
 DECLARE_bool(cache_force_single_shard);
 DECLARE_bool(crash_on_eio);
+DECLARE_bool(enable_data_block_fsync);
+DECLARE_bool(log_block_manager_container_index);
+DECLARE_bool(log_block_manager_drop_written_pages);
 DECLARE_double(env_inject_eio);
 DECLARE_double(log_container_excess_space_before_cleanup_fraction);
+DECLARE_double(log_container_live_data_before_compact_ratio);
 DECLARE_double(log_container_live_metadata_before_compact_ratio);
 DECLARE_int32(fs_target_data_dirs_per_tablet);
+DECLARE_int64(log_block_manager_write_behind_bytes);
+DECLARE_int64(log_container_data_compact_max_bytes_per_sec);
 DECLARE_int64(log_container_max_blocks);
 DECLARE_string(block_manager);
 DECLARE_string(block_manager_preflush_control);
@@ -92,6 +98,8 @@ DECLARE_uint64(log_container_preallocate_bytes);
 DECLARE_uint64(log_container_max_size);
 DECLARE_uint64(log_container_metadata_max_size);
 DECLARE_bool(log_container_metadata_runtime_compact);
+DECLARE_uint64(log_container_metadata_compact_min_bytes);
+DECLARE_bool(log_container_data_runtime_compact);
 DECLARE_double(log_container_metadata_size_before_compact_ratio);
 DEFINE_int32(startup_benchmark_batch_count_for_testing, 1000,
              "Batch operation (create and delete blocks) count to do startup benchmark.");
@@ -114,6 +122,9 @@ METRIC_DECLARE_counter(block_manager_total_blocks_deleted);
 METRIC_DECLARE_gauge_uint64(log_block_manager_bytes_under_management);
 METRIC_DECLARE_gauge_uint64(log_block_manager_blocks_under_management);
 METRIC_DECLARE_counter(log_block_manager_holes_punched);
+METRIC_DECLARE_counter(log_block_manager_containers_compacted);
+METRIC_DECLARE_counter(log_block_manager_bytes_relocated);
+METRIC_DECLARE_counter(log_block_manager_metadata_files_compacted);
 METRIC_DECLARE_gauge_uint64(log_block_manager_containers);
 METRIC_DECLARE_gauge_uint64(log_block_manager_full_containers);
 METRIC_DECLARE_gauge_uint64(log_block_manager_dead_containers_deleted);
@@ -878,6 +889,43 @@ TEST_P(LogBlockManagerTest, TestAppendExceedsPreallocation) {
   ASSERT_OK(writer->Append("hello world"));
 }
 
+// Flushing blocks as they're written and dropping them from the page cache
+// once closed doesn't change what's read back.
+TEST_P(LogBlockManagerTest, TestWriteBehindAndDropWrittenPages) {
+  SetEncryptionFlags(GetParam());
+  FLAGS_enable_data_block_fsync = true;
+  FLAGS_log_block_manager_drop_written_pages = true;
+  FLAGS_log_block_manager_write_behind_bytes = 4096;
+
+  const string kChunk(1000, 'x');
+  vector<BlockId> ids;
+  unique_ptr<BlockCreationTransaction> transaction = bm_->NewCreationTransaction();
+  for (int i = 0; i < 5; i++) {
+    unique_ptr<WritableBlock> writer;
+    ASSERT_OK(bm_->CreateBlock(test_block_opts_, &writer));
+    for (int j = 0; j <= i * 5; j++) {
+      ASSERT_OK(writer->Append(kChunk));
+    }
+    ASSERT_OK(writer->Finalize());
+    ids.emplace_back(writer->id());
+    transaction->AddCreatedBlock(std::move(writer));
+  }
+  ASSERT_OK(transaction->CommitCreatedBlocks());
+
+  for (int i = 0; i < ids.size(); i++) {
+    unique_ptr<ReadableBlock> block;
+    ASSERT_OK(bm_->OpenBlock(ids[i], &block));
+    uint64_t size;
+    ASSERT_OK(block->Size(&size));
+    ASSERT_EQ((i * 5 + 1) * kChunk.size(), size);
+    string data(size, '\0');
+    ASSERT_OK(block->Read(0, Slice(&data[0], size)));
+    for (int j = 0; j <= i * 5; j++) {
+      ASSERT_EQ(kChunk, data.substr(j * kChunk.size(), kChunk.size()));
+    }
+  }
+}
+
 TEST_P(LogBlockManagerTest, TestPreallocationAndTruncation) {
   SetEncryptionFlags(GetParam());
   // Ensure preallocation window is greater than the container size itself.
@@ -1376,6 +1424,218 @@ TEST_F(LogBlockManagerTest, TestContainerBlockLimitingByMetadataSizeWithCompacti
   ASSERT_TRUE(exist_larger_one);
 }
 
+TEST_P(LogBlockManagerTest, TestCompactMetadataWithoutSizeLimit) {
+  SetEncryptionFlags(GetParam());
+  const int kNumBlocks = 1000;
+  FLAGS_log_container_metadata_runtime_compact = true;
+  FLAGS_log_container_metadata_max_size = 0;
+  FLAGS_log_container_metadata_compact_min_bytes = 16 * 1024;
+
+  MetricRegistry registry;
+  scoped_refptr<MetricEntity> entity = METRIC_ENTITY_server.Instantiate(&registry, "test");
+  ASSERT_OK(ReopenBlockManager(entity));
+
+  vector<BlockId> ids;
+  for (int i = 0; i < kNumBlocks; i++) {
+    unique_ptr<WritableBlock> block;
+    ASSERT_OK(bm_->CreateBlock(test_block_opts_, &block));
+    ASSERT_OK(block->Append("aaaa"));
+    ASSERT_OK(block->Close());
+    ids.push_back(block->id());
+  }
+  string metadata_file;
+  NO_FATALS(GetOnlyContainerMetadataFile(&metadata_file));
+  uint64_t size_before;
+  ASSERT_OK(env_->GetFileSize(metadata_file, &size_before));
+
+  // Deleting most of the blocks leaves the metadata file mostly made of dead
+  // records: it gets compacted in the background.
+  {
+    shared_ptr<BlockDeletionTransaction> deletion_transaction = bm_->NewDeletionTransaction();
+    for (int i = kNumBlocks / 10; i < kNumBlocks; i++) {
+      deletion_transaction->AddDeletedBlock(ids[i]);
+    }
+    ASSERT_OK(deletion_transaction->CommitDeletedBlocks(nullptr));
+  }
+  dd_manager_->WaitOnClosures();
+  NO_FATALS(CheckCounterMetric(entity, 1, &METRIC_log_block_manager_metadata_files_compacted));
+  uint64_t size_after;
+  ASSERT_OK(env_->GetFileSize(metadata_file, &size_after));
+  ASSERT_LT(size_after, size_before / 2);
+
+  // The live blocks survive a restart.
+  ASSERT_OK(ReopenBlockManager());
+  vector<BlockId> live_ids;
+  ASSERT_OK(bm_->GetAllBlockIds(&live_ids));
+  ASSERT_EQ(kNumBlocks / 10, live_ids.size());
+}
+
+TEST_P(LogBlockManagerTest, TestCompactSparseContainerData) {
+  SetEncryptionFlags(GetParam());
+  const int kNumBlocks = 10;
+  const int kBlockSize = 8192;
+  FLAGS_log_container_max_blocks = kNumBlocks;
+  FLAGS_log_container_data_runtime_compact = true;
+  FLAGS_log_container_live_data_before_compact_ratio = 0.5;
+  FLAGS_log_container_data_compact_max_bytes_per_sec = 0;
+
+  MetricRegistry registry;
+  scoped_refptr<MetricEntity> entity = METRIC_ENTITY_server.Instantiate(&registry, "test");
+  ASSERT_OK(ReopenBlockManager(entity));
+
+  // Fill a container with blocks of distinct contents.
+  vector<BlockId> ids;
+  vector<string> contents;
+  for (int i = 0; i < kNumBlocks; i++) {
+    unique_ptr<WritableBlock> block;
+    ASSERT_OK(bm_->CreateBlock(test_block_opts_, &block));
+    contents.emplace_back(kBlockSize, 'a' + i);
+    ASSERT_OK(block->Append(contents.back()));
+    ASSERT_OK(block->Close());
+    ids.push_back(block->id());
+  }
+  NO_FATALS(AssertNumContainers(1));
+
+  auto check_block = [&](const ReadableBlock& block, int i) {
+    uint8_t buf[kBlockSize];
+    ASSERT_OK(block.Read(0, Slice(buf, kBlockSize)));
+    ASSERT_EQ(contents[i], Slice(buf, kBlockSize).ToString());
+  };
+  auto check_live_blocks = [&]() {
+    for (int i = 0; i < 2; i++) {
+      unique_ptr<ReadableBlock> block;
+      ASSERT_OK(bm_->OpenBlock(ids[i], &block));
+      NO_FATALS(check_block(*block, i));
+    }
+    for (int i = 2; i < kNumBlocks; i++) {
+      unique_ptr<ReadableBlock> block;
+      ASSERT_TRUE(bm_->OpenBlock(ids[i], &block).IsNotFound());
+    }
+  };
+
+  // Reading a block while it's relocated keeps working.
+  unique_ptr<ReadableBlock> reader;
+  ASSERT_OK(bm_->OpenBlock(ids[0], &reader));
+
+  // Make the container sparse: its blocks get copied into a new container.
+  {
+    shared_ptr<BlockDeletionTransaction> deletion_transaction = bm_->NewDeletionTransaction();
+    for (int i = 2; i < kNumBlocks; i++) {
+      deletion_transaction->AddDeletedBlock(ids[i]);
+    }
+    ASSERT_OK(deletion_transaction->CommitDeletedBlocks(nullptr));
+  }
+  ASSERT_EVENTUALLY([&]() {
+    NO_FATALS(CheckCounterMetric(entity, 1, &METRIC_log_block_manager_containers_compacted));
+  });
+  NO_FATALS(CheckCounterMetric(entity, 2 * kBlockSize,
+                               &METRIC_log_block_manager_bytes_relocated));
+  NO_FATALS(check_live_blocks());
+  NO_FATALS(check_block(*reader, 0));
+
+  // Once the last reader of the sparse container is gone, it's deleted.
+  NO_FATALS(AssertNumContainers(2));
+  reader.reset();
+  dd_manager_->WaitOnClosures();
+  NO_FATALS(AssertNumContainers(1));
+
+  // The relocated blocks survive a restart.
+  ASSERT_OK(ReopenBlockManager());
+  NO_FATALS(check_live_blocks());
+}
+
+TEST_P(LogBlockManagerTest, TestContainerIndex) {
+  SetEncryptionFlags(GetParam());
+  FLAGS_log_block_manager_container_index = true;
+  const int kNumBlocks = 20;
+  ASSERT_OK(ReopenBlockManager());
+
+  vector<BlockId> live_ids;
+  vector<BlockId> deleted_ids;
+  auto create_blocks = [&](int num_blocks) {
+    vector<BlockId> ids;
+    for (int i = 0; i < num_blocks; i++) {
+      unique_ptr<WritableBlock> block;
+      ASSERT_OK(bm_->CreateBlock(test_block_opts_, &block));
+      ASSERT_OK(block->Append(block->id().ToString()));
+      ASSERT_OK(block->Close());
+      ids.push_back(block->id());
+    }
+    // Delete every other block.
+    shared_ptr<BlockDeletionTransaction> deletion_transaction = bm_->NewDeletionTransaction();
+    for (int i = 0; i < ids.size(); i++) {
+      if (i % 2) {
+        deletion_transaction->AddDeletedBlock(ids[i]);
+        deleted_ids.push_back(ids[i]);
+      } else {
+        live_ids.push_back(ids[i]);
+      }
+    }
+    ASSERT_OK(deletion_transaction->CommitDeletedBlocks(nullptr));
+  };
+  auto check_blocks = [&]() {
+    for (const auto& id : live_ids) {
+      unique_ptr<ReadableBlock> block;
+      ASSERT_OK(bm_->OpenBlock(id, &block));
+      const string expected = id.ToString();
+      string data(expected.size(), '\0');
+      ASSERT_OK(block->Read(0, Slice(&data[0], data.size())));
+      ASSERT_EQ(expected, data);
+    }
+    for (const auto& id : deleted_ids) {
+      unique_ptr<ReadableBlock> block;
+      ASSERT_TRUE(bm_->OpenBlock(id, &block).IsNotFound());
+    }
+    vector<BlockId> ids;
+    ASSERT_OK(bm_->GetAllBlockIds(&ids));
+    ASSERT_EQ(live_ids.size(), ids.size());
+  };
+  NO_FATALS(create_blocks(kNumBlocks));
+
+  // The containers are loaded from the index written at shutdown.
+  FsReport report;
+  ASSERT_OK(ReopenBlockManager(nullptr, &report));
+  NO_FATALS(AssertEmptyReport(report));
+  ASSERT_GT(report.stats.lbm_container_count, 0);
+  ASSERT_EQ(report.stats.lbm_container_count, report.stats.lbm_indexed_container_count);
+  ASSERT_EQ(live_ids.size(), report.stats.live_block_count);
+  NO_FATALS(check_blocks());
+
+  // Without an index written at shutdown, the records written since the
+  // previous index was written are replayed on top of it.
+  NO_FATALS(create_blocks(kNumBlocks));
+  {
+    shared_ptr<BlockDeletionTransaction> deletion_transaction = bm_->NewDeletionTransaction();
+    deletion_transaction->AddDeletedBlock(live_ids.front());
+    ASSERT_OK(deletion_transaction->CommitDeletedBlocks(nullptr));
+    deleted_ids.push_back(live_ids.front());
+    live_ids.erase(live_ids.begin());
+  }
+  FLAGS_log_block_manager_container_index = false;
+  bm_.reset();
+  FLAGS_log_block_manager_container_index = true;
+  ASSERT_OK(ReopenBlockManager(nullptr, &report));
+  NO_FATALS(AssertEmptyReport(report));
+  ASSERT_GT(report.stats.lbm_indexed_container_count, 0);
+  ASSERT_EQ(live_ids.size(), report.stats.live_block_count);
+  NO_FATALS(check_blocks());
+
+  // New blocks don't reuse the IDs of the blocks loaded from the index.
+  NO_FATALS(create_blocks(2));
+  NO_FATALS(check_blocks());
+
+  // A corrupt index is ignored.
+  bm_.reset();
+  for (const auto& dir : dd_manager_->GetDirs()) {
+    ASSERT_OK(WriteStringToFile(
+        env_, "garbage", JoinPathSegments(dir, LogBlockManager::kContainerIndexFileName)));
+  }
+  ASSERT_OK(ReopenBlockManager(nullptr, &report));
+  NO_FATALS(AssertEmptyReport(report));
+  ASSERT_EQ(0, report.stats.lbm_indexed_container_count);
+  NO_FATALS(check_blocks());
+}
+
 TEST_P(LogBlockManagerTest, TestMisalignedBlocksFuzz) {
   SetEncryptionFlags(GetParam());
   FLAGS_log_container_preallocate_bytes = 0;
@@ -39,6 +39,7 @@
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <google/protobuf/message.h>
 
 #include "kudu/fs/block_manager_metrics.h"
 #include "kudu/fs/data_dirs.h"
@@ -58,6 +59,7 @@
 #include "kudu/gutil/walltime.h"
 #include "kudu/util/alignment.h"
 #include "kudu/util/array_view.h"
+#include "kudu/util/crc.h"
 #include "kudu/util/env.h"
 #include "kudu/util/fault_injection.h"
 #include "kudu/util/file_cache.h"
@@ -66,6 +68,7 @@
 #include "kudu/util/locks.h"
 #include "kudu/util/malloc.h"
 #include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/path_util.h"
 #include "kudu/util/pb_util.h"
 #include "kudu/util/random.h"
@@ -95,11 +98,25 @@ TAG_FLAG(log_container_metadata_max_size, experimental);
 TAG_FLAG(log_container_metadata_max_size, runtime);
 
 DEFINE_bool(log_container_metadata_runtime_compact, false,
-            "Whether to enable metadata file compaction at runtime.");
+            "Whether to enable metadata file compaction at runtime. The "
+            "metadata files of the containers whose ratio of live blocks dips "
+            "below --log_container_live_metadata_before_compact_ratio are "
+            "rewritten in the background once they're large enough: see "
+            "--log_container_metadata_size_before_compact_ratio and "
+            "--log_container_metadata_compact_min_bytes.");
 TAG_FLAG(log_container_metadata_runtime_compact, advanced);
 TAG_FLAG(log_container_metadata_runtime_compact, experimental);
 TAG_FLAG(log_container_metadata_runtime_compact, runtime);
 
+DEFINE_uint64(log_container_metadata_compact_min_bytes, 1024 * 1024,
+              "Minimum size of a log container's metadata file before it's "
+              "considered for compaction at runtime, if "
+              "--log_container_metadata_max_size is unlimited. Otherwise, "
+              "--log_container_metadata_size_before_compact_ratio applies.");
+TAG_FLAG(log_container_metadata_compact_min_bytes, advanced);
+TAG_FLAG(log_container_metadata_compact_min_bytes, experimental);
+TAG_FLAG(log_container_metadata_compact_min_bytes, runtime);
+
 DEFINE_int64(log_container_max_blocks, -1,
              "Maximum number of blocks (soft) of a log container. Use 0 for "
              "no limit. Use -1 for no limit except in the case of a kernel "
@@ -148,6 +165,63 @@ DEFINE_bool(log_block_manager_delete_dead_container, true,
 TAG_FLAG(log_block_manager_delete_dead_container, advanced);
 TAG_FLAG(log_block_manager_delete_dead_container, experimental);
 
+DEFINE_bool(log_block_manager_drop_written_pages, false,
+            "Whether to drop the data of newly written blocks from the page "
+            "cache once it's synced to disk. The blocks are written by "
+            "flushes, compactions and tablet copies, which would otherwise "
+            "evict the pages scans read from the page cache. Only effective "
+            "if --enable_data_block_fsync is true.");
+TAG_FLAG(log_block_manager_drop_written_pages, advanced);
+TAG_FLAG(log_block_manager_drop_written_pages, experimental);
+TAG_FLAG(log_block_manager_drop_written_pages, runtime);
+
+DEFINE_int64(log_block_manager_write_behind_bytes, 0,
+             "The number of bytes appended to a block after which the log "
+             "block manager asks the kernel to start writing them out, so "
+             "that large blocks don't accumulate dirty pages until they're "
+             "closed and then stall on writing them all out at once. If 0, "
+             "blocks are only flushed as per --block_manager_preflush_control.");
+TAG_FLAG(log_block_manager_write_behind_bytes, advanced);
+TAG_FLAG(log_block_manager_write_behind_bytes, experimental);
+TAG_FLAG(log_block_manager_write_behind_bytes, runtime);
+
+DEFINE_bool(log_container_data_runtime_compact, false,
+            "Whether to compact the data of sparse log containers at runtime: "
+            "the live blocks of full containers whose ratio of live data "
+            "dips below --log_container_live_data_before_compact_ratio are "
+            "rewritten into other containers in the background, after which "
+            "the sparse containers are deleted. Useful on filesystems which "
+            "don't reliably support hole punching, or to restore the read "
+            "locality of heavily fragmented containers.");
+TAG_FLAG(log_container_data_runtime_compact, advanced);
+TAG_FLAG(log_container_data_runtime_compact, experimental);
+TAG_FLAG(log_container_data_runtime_compact, runtime);
+
+DEFINE_double(log_container_live_data_before_compact_ratio, 0.20,
+              "Ratio of live data in a full log container below which its data "
+              "is compacted, if --log_container_data_runtime_compact is enabled.");
+TAG_FLAG(log_container_live_data_before_compact_ratio, advanced);
+TAG_FLAG(log_container_live_data_before_compact_ratio, experimental);
+TAG_FLAG(log_container_live_data_before_compact_ratio, runtime);
+
+DEFINE_int64(log_container_data_compact_max_bytes_per_sec, 32 * 1024 * 1024,
+             "Maximum rate, in bytes per second, at which the live blocks of "
+             "sparse log containers are rewritten when compacting their data. "
+             "Use 0 for no limit.");
+TAG_FLAG(log_container_data_compact_max_bytes_per_sec, advanced);
+TAG_FLAG(log_container_data_compact_max_bytes_per_sec, experimental);
+TAG_FLAG(log_container_data_compact_max_bytes_per_sec, runtime);
+
+DEFINE_bool(log_block_manager_container_index, false,
+            "Whether to summarize the log containers of each data directory "
+            "in an index file at shutdown, so that the next startup loads the "
+            "containers from the index and only reads the metadata records "
+            "written since, instead of reading all of their metadata. The "
+            "containers whose metadata files were rewritten since are read "
+            "in full.");
+TAG_FLAG(log_block_manager_container_index, advanced);
+TAG_FLAG(log_block_manager_container_index, experimental);
+
 DEFINE_int32(log_container_metadata_rewrite_inject_latency_ms, 0,
              "Amount of latency in ms to inject when rewrite metadata file. "
              "Only for testing.");
@@ -189,6 +263,41 @@ METRIC_DEFINE_counter(server, log_block_manager_dead_containers_deleted,
                       "Number of full (but dead) block containers that were deleted",
                       kudu::MetricLevel::kDebug);
 
+METRIC_DEFINE_gauge_uint64(server, log_block_manager_sparse_containers,
+                           "Number of Sparse Block Containers",
+                           kudu::MetricUnit::kLogBlockContainers,
+                           "Number of full log block containers whose ratio of live data "
+                           "is below --log_container_live_data_before_compact_ratio",
+                           kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_counter(server, log_block_manager_containers_compacted,
+                      "Number of Block Containers Compacted",
+                      kudu::MetricUnit::kLogBlockContainers,
+                      "Number of sparse log block containers whose live blocks were "
+                      "rewritten into other containers since service start",
+                      kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_counter(server, log_block_manager_bytes_relocated,
+                      "Bytes Relocated by Container Compaction",
+                      kudu::MetricUnit::kBytes,
+                      "Number of bytes of live blocks rewritten into other log block "
+                      "containers by container compaction since service start",
+                      kudu::MetricLevel::kDebug);
+
+METRIC_DEFINE_counter(server, log_block_manager_metadata_files_compacted,
+                      "Number of Container Metadata Files Compacted",
+                      kudu::MetricUnit::kLogBlockContainers,
+                      "Number of log block container metadata files rewritten at "
+                      "runtime to drop the records of deleted blocks since service start",
+                      kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_counter(server, log_block_manager_metadata_bytes_reclaimed,
+                      "Bytes Reclaimed by Container Metadata Compaction",
+                      kudu::MetricUnit::kBytes,
+                      "Number of bytes of log block container metadata files reclaimed "
+                      "by compacting them at runtime since service start",
+                      kudu::MetricLevel::kDebug);
+
 METRIC_DEFINE_gauge_uint64(server, log_block_manager_total_containers_startup,
                            "Total number of Log Block Containers during startup",
                            kudu::MetricUnit::kLogBlockContainers,
@@ -266,6 +375,12 @@ struct LogBlockManagerMetrics {
 
   scoped_refptr<Counter> holes_punched;
   scoped_refptr<Counter> dead_containers_deleted;
+
+  scoped_refptr<Counter> containers_compacted;
+  scoped_refptr<Counter> bytes_relocated;
+
+  scoped_refptr<Counter> metadata_files_compacted;
+  scoped_refptr<Counter> metadata_bytes_reclaimed;
 };
 
 #define MINIT(x) x(METRIC_log_block_manager_##x.Instantiate(metric_entity))
@@ -279,7 +394,11 @@ LogBlockManagerMetrics::LogBlockManagerMetrics(const scoped_refptr<MetricEntity>
     GINIT(total_containers_startup),
     GINIT(processed_containers_startup),
     MINIT(holes_punched),
-    MINIT(dead_containers_deleted) {
+    MINIT(dead_containers_deleted),
+    MINIT(containers_compacted),
+    MINIT(bytes_relocated),
+    MINIT(metadata_files_compacted),
+    MINIT(metadata_bytes_reclaimed) {
 }
 #undef GINIT
 
@@ -385,6 +504,17 @@ class LogWritableBlock final : public WritableBlock {
 
   int64_t block_length() const { return block_length_; }
 
+  // Makes this block a copy of 'original', written by container data
+  // compaction: once closed, the copy takes the place of 'original' in the
+  // block manager, if 'original' hasn't been deleted in the meantime.
+  void set_original(LogBlockRefPtr original) { original_ = std::move(original); }
+  const LogBlockRefPtr& original() const { return original_; }
+
+  // Once a copy of an original block is closed, the LogBlock of the copy, and
+  // whether it took the place of the original.
+  const LogBlockRefPtr& relocated() const { return relocated_; }
+  bool replaced_original() const { return replaced_original_; }
+
  private:
   // The owning container.
   LogBlockContainerRefPtr container_;
@@ -399,10 +529,19 @@ class LogWritableBlock final : public WritableBlock {
   // The block's length. Changes with each Append().
   int64_t block_length_;
 
+  // The length of the block's data which was last flushed by write-behind.
+  // See --log_block_manager_write_behind_bytes.
+  int64_t write_behind_length_;
+
   // The state of the block describing where it is in the write lifecycle,
   // for example, has it been synchronized to disk?
   WritableBlock::State state_;
 
+  // See set_original() and relocated().
+  LogBlockRefPtr original_;
+  LogBlockRefPtr relocated_;
+  bool replaced_original_;
+
   DISALLOW_COPY_AND_ASSIGN(LogWritableBlock);
 };
 
@@ -410,6 +549,22 @@ class LogWritableBlock final : public WritableBlock {
 // LogBlockContainer
 ////////////////////////////////////////////////////////////
 
+namespace {
+
+// Computes the CRC32C checksum of the bytes of the metadata file 'file' just
+// before 'offset', which identify the version of the file for the container
+// index: the last records before 'offset' include their own checksums.
+Status MetadataTailCrc32(RandomAccessFile* file, int64_t offset, uint32_t* crc32) {
+  static constexpr int64_t kTailBytes = 64;
+  const int64_t len = std::min(kTailBytes, offset);
+  uint8_t buf[kTailBytes];
+  RETURN_NOT_OK(file->Read(offset - len, Slice(buf, len)));
+  *crc32 = crc::Crc32c(buf, len);
+  return Status::OK();
+}
+
+} // anonymous namespace
+
 // A single block container belonging to the log-backed block manager.
 //
 // A container may only be used to write one WritableBlock at a given time.
@@ -445,8 +600,14 @@ class LogBlockContainer: public RefCountedThreadSafe<LogBlockContainer> {
   // The on-disk effects of this call are made durable only after SyncData().
   Status PunchHole(int64_t offset, int64_t length);
 
-  // Executes a hole punching operation at 'offset' with the given 'length'.
-  void ContainerDeletionAsync(int64_t offset, int64_t length);
+  // Queues holes to punch at 'intervals', the <offset, offset + length>
+  // pairs of deleted blocks, and punches them asynchronously.
+  //
+  // The holes queued until the punching task runs are coalesced together:
+  // when deleting many tablets at once, e.g. when dropping a table, the
+  // blocks of the tablets sharing the container are punched as a few large
+  // holes rather than holes for the blocks of each tablet.
+  void QueueHolesToPunch(const vector<std::pair<int64_t, int64_t>>& intervals);
 
   // Preallocate enough space to ensure that an append of 'next_append_length'
   // can be satisfied by this container. The offset of the beginning of this
@@ -469,6 +630,10 @@ class LogBlockContainer: public RefCountedThreadSafe<LogBlockContainer> {
   // See RWFile::ReadV().
   Status ReadVData(int64_t offset, ArrayView<Slice> results) const;
 
+  // Maps 'length' bytes of this container's data file beginning at 'offset'
+  // into memory. See RWFile::Map().
+  Status MapData(int64_t offset, size_t length, unique_ptr<MappedFileRange>* range) const;
+
   // Removes block ids from this container's metadata part according to 'lbs',
   // the block ids removed successfully are returned by 'deleted_block_ids', even if
   // returning non-OK status.
@@ -494,6 +659,11 @@ class LogBlockContainer: public RefCountedThreadSafe<LogBlockContainer> {
   // TODO(unknown): Add support to synchronize just a range.
   Status SyncData();
 
+  // Drops the clean pages of this container's data file from 'offset'
+  // through to 'length' from the page cache. Failures are only logged,
+  // since the pages are only a cache.
+  void DropDataCache(int64_t offset, int64_t length);
+
   // Synchronize this container's metadata part with the disk. On success,
   // guarantees that the metadata is made durable.
   //
@@ -536,6 +706,24 @@ class LogBlockContainer: public RefCountedThreadSafe<LogBlockContainer> {
       uint64_t* max_block_id,
       ProcessRecordType type) = 0;
 
+  // Like ProcessRecords(), but starts from the state summarized by 'entry',
+  // the entry of this container in the container index of its data
+  // directory, and only reads the records written past it.
+  //
+  // Returns Status::NotFound() if 'entry' doesn't match the metadata anymore,
+  // e.g. because it was rewritten since; nothing is processed then.
+  virtual Status ProcessRecordsFromIndex(
+      const ContainerIndexEntryPB& entry,
+      FsReport* report,
+      LogBlockManager::UntrackedBlockMap* live_blocks,
+      LogBlockManager::BlockRecordMap* live_block_records,
+      vector<LogBlockRefPtr>* dead_blocks,
+      uint64_t* max_block_id) = 0;
+
+  // Summarizes the state of this container into 'entry', for the container
+  // index of its data directory. The live blocks are left to the caller.
+  virtual Status FillIndexEntry(ContainerIndexEntryPB* entry) const = 0;
+
   // Updates internal bookkeeping state to reflect the creation of a block.
   void BlockCreated(const LogBlockRefPtr& block);
 
@@ -583,6 +771,7 @@ class LogBlockContainer: public RefCountedThreadSafe<LogBlockContainer> {
   // Simple accessors.
   LogBlockManager* block_manager() const { return block_manager_; }
   const string& id() const { return id_; }
+  const string& data_file_name() const { return data_file_->filename(); }
   int64_t next_block_offset() const { return next_block_offset_.Load(); }
   int64_t total_bytes() const { return total_bytes_.Load(); }
   int64_t total_blocks() const { return total_blocks_.Load(); }
@@ -630,6 +819,24 @@ class LogBlockContainer: public RefCountedThreadSafe<LogBlockContainer> {
   // Some work will be triggered after blocks have been removed from this container successfully.
   virtual void PostWorkOfBlocksDeleted() {}
 
+  // Whether the live data of this full container are a small enough part of
+  // its data file for it to be compacted. See
+  // --log_container_live_data_before_compact_ratio.
+  bool sparse() const {
+    return full() && live_blocks() > 0 &&
+        live_bytes_aligned() <
+            total_bytes() * FLAGS_log_container_live_data_before_compact_ratio;
+  }
+
+  // Tries to mark the compaction of this container's data as scheduled. Only
+  // one compaction may be scheduled at a time.
+  //
+  // If successful, returns true; otherwise returns false.
+  bool TrySetDataCompactionScheduled() {
+    return data_compaction_scheduled_.CompareAndSet(false, true);
+  }
+  void ClearDataCompactionScheduled() { data_compaction_scheduled_.Store(false); }
+
   static std::vector<BlockRecordPB> SortRecords(LogBlockManager::BlockRecordMap live_block_records);
 
  protected:
@@ -724,6 +931,15 @@ class LogBlockContainer: public RefCountedThreadSafe<LogBlockContainer> {
   // Whether or not this container has been marked as dead.
   AtomicBool dead_;
 
+  // Whether or not the compaction of this container's data is scheduled.
+  AtomicBool data_compaction_scheduled_;
+
+  // The holes queued to punch by QueueHolesToPunch(), and whether the task
+  // punching them is scheduled.
+  simple_spinlock holes_to_punch_lock_;
+  vector<std::pair<int64_t, int64_t>> holes_to_punch_;
+  bool hole_punching_scheduled_;
+
   // The metrics. Not owned by the log container; it has the same lifespan
   // as the block manager.
   const LogBlockManagerMetrics* metrics_;
@@ -815,6 +1031,16 @@ class LogBlockContainerNativeMeta final : public LogBlockContainer {
       uint64_t* max_block_id,
       ProcessRecordType type) override;
 
+  Status ProcessRecordsFromIndex(
+      const ContainerIndexEntryPB& entry,
+      FsReport* report,
+      LogBlockManager::UntrackedBlockMap* live_blocks,
+      LogBlockManager::BlockRecordMap* live_block_records,
+      vector<LogBlockRefPtr>* dead_blocks,
+      uint64_t* max_block_id) override;
+
+  Status FillIndexEntry(ContainerIndexEntryPB* entry) const override;
+
   bool full() const override {
     if (LogBlockContainer::full()) {
       return true;
@@ -850,13 +1076,28 @@ class LogBlockContainerNativeMeta final : public LogBlockContainer {
       vector<LogBlockRefPtr>* dead_blocks,
       ProcessRecordType type) override;
 
+  // Processes the records read by 'pb_reader' until the end of the metadata
+  // file. See ProcessRecords().
+  Status ProcessRemainingRecords(
+      ReadablePBContainerFile* pb_reader,
+      FsReport* report,
+      LogBlockManager::UntrackedBlockMap* live_blocks,
+      LogBlockManager::BlockRecordMap* live_block_records,
+      vector<LogBlockRefPtr>* dead_blocks,
+      uint64_t* max_block_id,
+      ProcessRecordType type);
+
   bool ShouldCompactUnlocked() const {
-    DCHECK_GT(FLAGS_log_container_metadata_max_size, 0);
     if (live_blocks() >=
         total_blocks() * FLAGS_log_container_live_metadata_before_compact_ratio) {
       return false;
     }
 
+    if (FLAGS_log_container_metadata_max_size <= 0) {
+      // Without a size limit, only the files large enough for their dead
+      // records to matter are worth rewriting.
+      return metadata_file_->Offset() >= FLAGS_log_container_metadata_compact_min_bytes;
+    }
     return metadata_file_->Offset() >= FLAGS_log_container_metadata_max_size *
                                            FLAGS_log_container_metadata_size_before_compact_ratio;
   }
@@ -910,6 +1151,8 @@ LogBlockContainer::LogBlockContainer(
       live_blocks_(0),
       blocks_being_written_(0),
       dead_(false),
+      data_compaction_scheduled_(false),
+      hole_punching_scheduled_(false),
       metrics_(block_manager->metrics()) {
   // If we have an encryption header, we need to align the next offset to the
   // next file system block.
@@ -1025,6 +1268,10 @@ void LogBlockContainerNativeMeta::CompactMetadata() {
   }
   VLOG(1) << "Compacted metadata file " << ToString()
           << " (saved " << file_bytes_delta << " bytes)";
+  if (metrics_) {
+    metrics_->metadata_files_compacted->Increment();
+    metrics_->metadata_bytes_reclaimed->IncrementBy(std::max<int64_t>(file_bytes_delta, 0));
+  }
 
   total_blocks_.Store(live_blocks.size());
   live_blocks_.Store(live_blocks.size());
@@ -1275,12 +1522,116 @@ Status LogBlockContainerNativeMeta::ProcessRecords(
       opts, metadata_path, &metadata_reader));
   ReadablePBContainerFile pb_reader(std::move(metadata_reader));
   RETURN_NOT_OK_HANDLE_ERROR(pb_reader.Open());
+  return ProcessRemainingRecords(&pb_reader, report, live_blocks, live_block_records,
+                                 dead_blocks, max_block_id, type);
+}
+
+Status LogBlockContainerNativeMeta::ProcessRecordsFromIndex(
+    const ContainerIndexEntryPB& entry,
+    FsReport* report,
+    LogBlockManager::UntrackedBlockMap* live_blocks,
+    LogBlockManager::BlockRecordMap* live_block_records,
+    vector<LogBlockRefPtr>* dead_blocks,
+    uint64_t* max_block_id) {
+  const int num_blocks = entry.block_ids_size();
+  if (PREDICT_FALSE(entry.offsets_size() != num_blocks || entry.lengths_size() != num_blocks)) {
+    return Status::NotFound("malformed container index entry");
+  }
+
+  // Check that the metadata file still begins with the summarized records.
+  string metadata_path = metadata_file_->filename();
+  unique_ptr<RandomAccessFile> metadata_reader;
+  RandomAccessFileOptions opts;
+  opts.is_sensitive = true;
+  RETURN_NOT_OK_HANDLE_ERROR(block_manager()->env()->NewRandomAccessFile(
+      opts, metadata_path, &metadata_reader));
+  uint64_t metadata_size;
+  RETURN_NOT_OK_HANDLE_ERROR(metadata_reader->Size(&metadata_size));
+  if (entry.metadata_offset() > metadata_size) {
+    return Status::NotFound("the metadata file is shorter than summarized");
+  }
+  uint32_t tail_crc32;
+  RETURN_NOT_OK_HANDLE_ERROR(MetadataTailCrc32(metadata_reader.get(), entry.metadata_offset(),
+                                               &tail_crc32));
+  if (tail_crc32 != entry.metadata_tail_crc32()) {
+    return Status::NotFound("the metadata file was rewritten");
+  }
+  ReadablePBContainerFile pb_reader(std::move(metadata_reader));
+  RETURN_NOT_OK_HANDLE_ERROR(pb_reader.Open());
+  Status s = pb_reader.Seek(entry.metadata_offset());
+  if (PREDICT_FALSE(!s.ok())) {
+    return Status::NotFound("bad metadata offset", s.ToString());
+  }
+
+  // Restore the summarized state.
+  live_blocks->reserve(num_blocks);
+  for (int i = 0; i < num_blocks; i++) {
+    const BlockId block_id(entry.block_ids(i));
+    LogBlockRefPtr lb = new LogBlock(this, block_id, entry.offsets(i), entry.lengths(i));
+    if (PREDICT_FALSE(!InsertIfNotPresent(live_blocks, block_id, std::move(lb)))) {
+      live_blocks->clear();
+      return Status::NotFound("duplicate block in container index entry",
+                              block_id.ToString());
+    }
+  }
+  live_block_records->reserve(num_blocks);
+  for (const auto& [block_id, lb] : *live_blocks) {
+    BlockCreated(lb);
+
+    BlockRecordPB& record = (*live_block_records)[block_id];
+    block_id.CopyToPB(record.mutable_block_id());
+    record.set_op_type(CREATE);
+    record.set_timestamp_us(0);
+    record.set_offset(lb->offset());
+    record.set_length(lb->length());
+  }
+  // BlockCreated() only accounted for the live blocks.
+  next_block_offset_.StoreMax(entry.next_block_offset());
+  total_bytes_.Store(entry.total_bytes());
+  total_blocks_.Store(entry.total_blocks());
+  *max_block_id = std::max(*max_block_id, entry.max_block_id());
+
+  // Replay the records written since.
+  return ProcessRemainingRecords(&pb_reader, report, live_blocks, live_block_records,
+                                 dead_blocks, max_block_id, ProcessRecordType::kReadAndUpdate);
+}
+
+Status LogBlockContainerNativeMeta::FillIndexEntry(ContainerIndexEntryPB* entry) const {
+  int64_t metadata_offset;
+  {
+    shared_lock<RWMutex> l(metadata_compact_lock_);
+    metadata_offset = metadata_file_->Offset();
+  }
+  unique_ptr<RandomAccessFile> metadata_reader;
+  RandomAccessFileOptions opts;
+  opts.is_sensitive = true;
+  RETURN_NOT_OK_HANDLE_ERROR(block_manager()->env()->NewRandomAccessFile(
+      opts, metadata_file_->filename(), &metadata_reader));
+  uint32_t tail_crc32;
+  RETURN_NOT_OK_HANDLE_ERROR(MetadataTailCrc32(metadata_reader.get(), metadata_offset,
+                                               &tail_crc32));
+  entry->set_id(id());
+  entry->set_metadata_offset(metadata_offset);
+  entry->set_metadata_tail_crc32(tail_crc32);
+  entry->set_next_block_offset(next_block_offset());
+  entry->set_total_bytes(total_bytes());
+  entry->set_total_blocks(total_blocks());
+  return Status::OK();
+}
 
+Status LogBlockContainerNativeMeta::ProcessRemainingRecords(
+    ReadablePBContainerFile* pb_reader,
+    FsReport* report,
+    LogBlockManager::UntrackedBlockMap* live_blocks,
+    LogBlockManager::BlockRecordMap* live_block_records,
+    vector<LogBlockRefPtr>* dead_blocks,
+    uint64_t* max_block_id,
+    ProcessRecordType type) {
   uint64_t data_file_size = 0;
   Status read_status;
   while (true) {
     BlockRecordPB record;
-    read_status = pb_reader.ReadNextPB(&record);
+    read_status = pb_reader->ReadNextPB(&record);
     if (!read_status.ok()) {
       break;
     }
@@ -1299,7 +1650,7 @@ Status LogBlockContainerNativeMeta::ProcessRecords(
     // format that can reliably detect this. Consider this a failed partial
     // write and truncate the metadata file to remove this partial record.
     report->partial_record_check->entries.emplace_back(ToString(),
-                                                       pb_reader.offset());
+                                                       pb_reader->offset());
     return Status::OK();
   }
   // If we've made it here, we've found (and are returning) an unrecoverable error.
@@ -1425,6 +1776,12 @@ Status LogBlockContainer::DoCloseBlocks(const vector<LogWritableBlock*>& blocks,
     if (mode == SYNC) {
       VLOG(3) << "Syncing data file " << data_file_->filename();
       RETURN_NOT_OK(SyncData());
+      if (FLAGS_log_block_manager_drop_written_pages && FLAGS_enable_data_block_fsync) {
+        // The blocks' data is now clean, so the pages can go.
+        for (const LogWritableBlock* block : blocks) {
+          DropDataCache(block->block_offset(), block->block_length());
+        }
+      }
     }
 
     // Append metadata only after data is synced so that there's
@@ -1477,15 +1834,18 @@ Status LogBlockContainer::WriteVData(int64_t offset, ArrayView<const Slice> data
   RETURN_NOT_OK_HANDLE_ERROR(read_only_status());
   DCHECK_GE(offset, next_block_offset());
 
-  RETURN_NOT_OK_HANDLE_ERROR(data_file_->WriteV(offset, data));
-
-  // This append may have changed the container size if:
-  // 1. It was large enough that it blew out the preallocated space.
-  // 2. Preallocation was disabled.
   size_t data_size = accumulate(data.begin(), data.end(), static_cast<size_t>(0),
                                 [&](int sum, const Slice& curr) {
                                   return sum + curr.size();
                                 });
+  {
+    Dir::ScopedWrite write(data_dir_, data_size);
+    RETURN_NOT_OK_HANDLE_ERROR(data_file_->WriteV(offset, data));
+  }
+
+  // This append may have changed the container size if:
+  // 1. It was large enough that it blew out the preallocated space.
+  // 2. Preallocation was disabled.
   if (offset + data_size > preallocated_offset_) {
     RETURN_NOT_OK_HANDLE_ERROR(data_dir_->RefreshAvailableSpace(Dir::RefreshMode::ALWAYS));
   }
@@ -1504,6 +1864,13 @@ Status LogBlockContainer::ReadVData(int64_t offset, ArrayView<Slice> results) co
   return Status::OK();
 }
 
+Status LogBlockContainer::MapData(int64_t offset, size_t length,
+                                  unique_ptr<MappedFileRange>* range) const {
+  DCHECK_GE(offset, 0);
+  RETURN_NOT_OK_HANDLE_ERROR(data_file_->Map(offset, length, range));
+  return Status::OK();
+}
+
 Status LogBlockContainer::FlushData(int64_t offset, int64_t length) {
   RETURN_NOT_OK_HANDLE_ERROR(read_only_status());
   DCHECK_GE(offset, 0);
@@ -1512,10 +1879,22 @@ Status LogBlockContainer::FlushData(int64_t offset, int64_t length) {
   return Status::OK();
 }
 
+void LogBlockContainer::DropDataCache(int64_t offset, int64_t length) {
+  DCHECK_GE(offset, 0);
+  DCHECK_GE(length, 0);
+  if (length == 0) {
+    // A length of 0 would drop the rest of the file.
+    return;
+  }
+  WARN_NOT_OK(data_file_->DropCache(offset, length),
+              Substitute("unable to drop cached pages of $0", data_file_->filename()));
+}
+
 Status LogBlockContainer::SyncData() {
   RETURN_NOT_OK_HANDLE_ERROR(read_only_status());
   if (FLAGS_enable_data_block_fsync) {
     if (metrics_) metrics_->generic_metrics.total_disk_sync->Increment();
+    Dir::ScopedWrite write(data_dir_, 0);
     RETURN_NOT_OK_HANDLE_ERROR(data_file_->Sync());
   }
   return Status::OK();
@@ -1538,18 +1917,22 @@ Status LogBlockContainerNativeMeta::RemoveBlockIdsFromMetadata(
     records.emplace_back(record);
     deleted_block_ids->emplace_back(lb->block_id());
   }
+  vector<const google::protobuf::Message*> msgs;
+  msgs.reserve(records.size());
+  for (const auto& r : records) {
+    msgs.emplace_back(&r);
+  }
 
-  int deleted_count = 0;
-  SCOPED_CLEANUP({
-    // Purge the blocks that failed to delete.
-    deleted_block_ids->resize(deleted_count);
-  });
-
+  // Append the records with a single write rather than a write per block,
+  // since deleting tablets deletes many blocks of each container at once.
+  // On failure, none of the blocks are deemed deleted, and so aren't punched
+  // out: those whose records were written are only deleted once reloaded.
   shared_lock<RWMutex> l(metadata_compact_lock_);
-  for (const auto& r : records) {
-    RETURN_NOT_OK_HANDLE_ERROR(metadata_file_->Append(r));
-    ++deleted_count;
+  Status s = metadata_file_->AppendBatch(msgs);
+  if (PREDICT_FALSE(!s.ok())) {
+    deleted_block_ids->clear();
   }
+  RETURN_NOT_OK_HANDLE_ERROR(s);
 
   return Status::OK();
 }
@@ -1566,6 +1949,11 @@ Status LogBlockContainerNativeMeta::AddBlockIdsToMetadata(
     block->id().CopyToPB(record.mutable_block_id());
     record.set_offset(block->block_offset());
     record.set_length(block->block_length());
+    if (block->original()) {
+      record.set_relocated(true);
+    } else {
+      record.clear_relocated();
+    }
     records.emplace_back(record);
   }
 
@@ -1761,18 +2149,41 @@ void LogBlockContainer::SetReadOnly(const Status& error) {
   read_only_status_ = error;
 }
 
-void LogBlockContainer::ContainerDeletionAsync(int64_t offset, int64_t length) {
-  if (dead()) {
-    // Don't bother punching holes; the container's destructor will delete the
-    // container's files outright.
-    return;
+void LogBlockContainer::QueueHolesToPunch(const vector<std::pair<int64_t, int64_t>>& intervals) {
+  {
+    std::lock_guard<simple_spinlock> l(holes_to_punch_lock_);
+    holes_to_punch_.insert(holes_to_punch_.end(), intervals.begin(), intervals.end());
+    if (hole_punching_scheduled_) {
+      return;
+    }
+    hole_punching_scheduled_ = true;
   }
 
-  VLOG(3) << "Freeing space belonging to container " << ToString();
-  Status s = PunchHole(offset, length);
-  if (s.ok() && metrics_) metrics_->holes_punched->Increment();
-  WARN_NOT_OK(s, Substitute("could not delete blocks in container $0",
-                            data_dir()->dir()));
+  scoped_refptr<LogBlockContainer> self(this);
+  ExecClosure([self]() {
+    vector<std::pair<int64_t, int64_t>> holes;
+    {
+      std::lock_guard<simple_spinlock> l(self->holes_to_punch_lock_);
+      holes.swap(self->holes_to_punch_);
+      self->hole_punching_scheduled_ = false;
+    }
+    if (self->dead()) {
+      // Don't bother punching holes; the container's destructor will delete the
+      // container's files outright.
+      return;
+    }
+
+    CHECK_OK_PREPEND(CoalesceIntervals<int64_t>(&holes),
+                     Substitute("could not coalesce hole punching for container: $0",
+                                self->ToString()));
+    VLOG(3) << "Freeing space belonging to container " << self->ToString();
+    for (const auto& hole : holes) {
+      Status s = self->PunchHole(hole.first, hole.second - hole.first);
+      if (s.ok() && self->metrics_) self->metrics_->holes_punched->Increment();
+      WARN_NOT_OK(s, Substitute("could not delete blocks in container $0",
+                                self->data_dir()->dir()));
+    }
+  });
 }
 
 ///////////////////////////////////////////////////////////
@@ -1897,16 +2308,7 @@ LogBlockDeletionTransaction::~LogBlockDeletionTransaction() {
       continue;
     }
 
-    CHECK_OK_PREPEND(CoalesceIntervals<int64_t>(&entry.second),
-                     Substitute("could not coalesce hole punching for container: $0",
-                                container->ToString()));
-
-    scoped_refptr<LogBlockContainer> self(container);
-    for (const auto& interval : entry.second) {
-      container->ExecClosure([self, interval]() {
-        self->ContainerDeletionAsync(interval.first, interval.second - interval.first);
-      });
-    }
+    container->QueueHolesToPunch(entry.second);
   }
 }
 
@@ -2028,7 +2430,9 @@ LogWritableBlock::LogWritableBlock(LogBlockContainerRefPtr container,
       block_id_(block_id),
       block_offset_(block_offset),
       block_length_(0),
-      state_(CLEAN) {
+      write_behind_length_(0),
+      state_(CLEAN),
+      replaced_original_(false) {
   DCHECK_GE(block_offset, 0);
   DCHECK_EQ(0, block_offset % container_->instance()->filesystem_block_size_bytes());
   container_->blocks_being_written_incr(1);
@@ -2053,9 +2457,15 @@ Status LogWritableBlock::Close() {
 }
 
 Status LogWritableBlock::Abort() {
-  // Only updates metrics and block state for read-only container.
-  if (container_->read_only()) {
+  // Only updates metrics and block state for read-only container, and for
+  // copies of blocks: their ID belongs to the original, which mustn't be
+  // deleted. The copied data is left as garbage in the container.
+  if (container_->read_only() || original_) {
     if (state_ != CLOSED) {
+      if (!container_->read_only() && (state_ == CLEAN || state_ == DIRTY)) {
+        // Hand the container back to other writers.
+        container_->FinalizeBlock(block_offset_, block_length_);
+      }
       state_ = CLOSED;
       if (container_->metrics()) {
         container_->metrics()->generic_metrics.blocks_open_writing->Decrement();
@@ -2063,6 +2473,9 @@ Status LogWritableBlock::Abort() {
             block_length_);
       }
     }
+    if (!container_->read_only()) {
+      return Status::OK();
+    }
     return container_->read_only_status().CloneAndPrepend(
         Substitute("container $0 is read-only", container_->ToString()));
   }
@@ -2141,6 +2554,13 @@ Status LogWritableBlock::AppendV(ArrayView<const Slice> data) {
 
   block_length_ += data_size;
   state_ = DIRTY;
+
+  const int64_t write_behind_bytes = FLAGS_log_block_manager_write_behind_bytes;
+  if (write_behind_bytes > 0 && block_length_ - write_behind_length_ >= write_behind_bytes) {
+    RETURN_NOT_OK(container_->FlushData(block_offset_ + write_behind_length_,
+                                        block_length_ - write_behind_length_));
+    write_behind_length_ = block_length_;
+  }
   return Status::OK();
 }
 
@@ -2198,6 +2618,13 @@ void LogWritableBlock::DoClose() {
     container_->FinalizeBlock(block_offset_, block_length_);
   }
 
+  if (original_) {
+    relocated_ = container_->block_manager()->CreateAndReplaceLogBlock(
+        original_, container_, block_offset_, block_length_, &replaced_original_);
+    container_->BlockCreated(relocated_);
+    state_ = CLOSED;
+    return;
+  }
   LogBlockRefPtr lb = container_->block_manager()->CreateAndAddLogBlock(
       container_, block_id_, block_offset_, block_length_);
   CHECK(lb);
@@ -2230,6 +2657,9 @@ class LogReadableBlock : public ReadableBlock {
 
   Status ReadV(uint64_t offset, ArrayView<Slice> results) const override;
 
+  Status Map(uint64_t offset, size_t length,
+             unique_ptr<MappedFileRange>* range) const override;
+
   size_t memory_footprint() const override;
 
  private:
@@ -2321,6 +2751,22 @@ Status LogReadableBlock::ReadV(uint64_t offset, ArrayView<Slice> results) const
   return Status::OK();
 }
 
+Status LogReadableBlock::Map(uint64_t offset, size_t length,
+                             unique_ptr<MappedFileRange>* range) const {
+  DCHECK(!closed_.Load());
+
+  uint64_t map_offset = log_block_->offset() + offset;
+  if (log_block_->length() < offset + length) {
+    return Status::IOError("Out-of-bounds mapping",
+                           Substitute("mapping of [$0-$1) in block [$2-$3)",
+                                      map_offset,
+                                      map_offset + length,
+                                      log_block_->offset(),
+                                      log_block_->offset() + log_block_->length()));
+  }
+  return log_block_->container()->MapData(map_offset, length, range);
+}
+
 size_t LogReadableBlock::memory_footprint() const {
   return kudu_malloc_usable_size(this);
 }
@@ -2335,6 +2781,7 @@ static const uint64_t kBlockMapChunk = 1 << 4;
 static const uint64_t kBlockMapMask = kBlockMapChunk - 1;
 const char* LogBlockManager::kContainerMetadataFileSuffix = ".metadata";
 const char* LogBlockManager::kContainerDataFileSuffix = ".data";
+const char* LogBlockManager::kContainerIndexFileName = "log_block_container_index";
 
 // These values were arrived at via experimentation. See commit 4923a74 for
 // more details.
@@ -2360,7 +2807,9 @@ LogBlockManager::LogBlockManager(Env* env,
     file_cache_(file_cache),
     buggy_el6_kernel_(IsBuggyEl6Kernel(env->GetKernelRelease())),
     next_block_id_(1),
-    tenant_id_(std::move(tenant_id)) {
+    tenant_id_(std::move(tenant_id)),
+    closing_(false),
+    opened_(false) {
   for (auto& mb : managed_block_shards_) {
     mb.lock = unique_ptr<simple_spinlock>(new simple_spinlock);
     mb.blocks_by_block_id
@@ -2385,10 +2834,23 @@ LogBlockManager::LogBlockManager(Env* env,
 
   if (opts_.metric_entity) {
     metrics_.reset(new internal::LogBlockManagerMetrics(opts_.metric_entity));
+    METRIC_log_block_manager_sparse_containers.InstantiateFunctionGauge(
+        opts_.metric_entity, [this]() { return this->CountSparseContainers(); })
+        ->AutoDetach(&metric_detacher_);
   }
 }
 
 LogBlockManager::~LogBlockManager() {
+  // Stop compacting containers before tearing anything down.
+  closing_ = true;
+  if (compaction_pool_) {
+    compaction_pool_->Shutdown();
+  }
+
+  if (opened_ && !opts_.read_only && FLAGS_log_block_manager_container_index) {
+    WriteContainerIndexes();
+  }
+
   // Release all of the memory accounted by the blocks.
   int64_t mem = 0;
   for (const auto& mb : managed_block_shards_) {
@@ -2532,7 +2994,7 @@ Status LogBlockManager::Open(FsReport* report, MergeReport need_merage,
     bool do_repair = true;
     for (const auto& container_result : container_results[i]) {
       RETURN_ON_NON_DISK_FAILURE(dd, container_result->status);
-      if (PREDICT_FALSE(!s.ok())) {
+      if (PREDICT_FALSE(!container_result->status.ok())) {
         // If open container error, do not try to repair.
         do_repair = false;
         break;
@@ -2593,6 +3055,30 @@ Status LogBlockManager::Open(FsReport* report, MergeReport need_merage,
     RETURN_NOT_OK(merged_report.LogAndCheckForFatalErrors());
   }
 
+  {
+    std::lock_guard<simple_spinlock> l(relocated_block_ids_lock_);
+    relocated_block_ids_.clear();
+  }
+
+  if (!opts_.read_only) {
+    RETURN_NOT_OK(ThreadPoolBuilder("lbm-compact")
+                      .set_max_threads(1)
+                      .Build(&compaction_pool_));
+    // Compact the containers which were left sparse by the previous run.
+    vector<LogBlockContainerRefPtr> containers;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      containers.reserve(all_containers_by_name_.size());
+      for (const auto& e : all_containers_by_name_) {
+        containers.emplace_back(e.second);
+      }
+    }
+    for (const auto& c : containers) {
+      MaybeScheduleDataCompaction(c.get());
+    }
+  }
+
+  opened_ = true;
   return Status::OK();
 }
 
@@ -2665,6 +3151,26 @@ void LogBlockManager::NotifyBlockId(BlockId block_id) {
   next_block_id_.StoreMax(block_id.id() + 1);
 }
 
+void LogBlockManager::PrefetchBlocks(const vector<BlockId>& block_ids) {
+  if (!file_cache_ || !file_cache_->prefetch_enabled()) {
+    return;
+  }
+  // Blocks often share containers.
+  set<string> data_file_names;
+  for (const auto& block_id : block_ids) {
+    LogBlockRefPtr lb;
+    {
+      auto index = block_id.id() & kBlockMapMask;
+      std::lock_guard<simple_spinlock> l(*managed_block_shards_[index].lock);
+      lb = FindPtrOrNull(*managed_block_shards_[index].blocks_by_block_id, block_id);
+    }
+    if (lb) {
+      data_file_names.emplace(lb->container()->data_file_name());
+    }
+  }
+  file_cache_->Prefetch(vector<string>(data_file_names.begin(), data_file_names.end()));
+}
+
 void LogBlockManager::AddNewContainerUnlocked(const LogBlockContainerRefPtr& container) {
   DCHECK(lock_.is_locked());
   InsertOrDie(&all_containers_by_name_, container->ToString(), container);
@@ -2711,7 +3217,11 @@ Status LogBlockManager::GetOrCreateContainer(const CreateBlockOptions& opts,
       error_manager_->RunErrorNotificationCb(ErrorHandlerType::NO_AVAILABLE_DISKS,
                                              opts.tablet_id,
                                              tenant_id()));
+  return GetOrCreateContainerInDir(dir, container);
+}
 
+Status LogBlockManager::GetOrCreateContainerInDir(Dir* dir,
+                                                  LogBlockContainerRefPtr* container) {
   {
     std::lock_guard<simple_spinlock> l(lock_);
     auto& d = available_containers_by_data_dir_[DCHECK_NOTNULL(dir)];
@@ -2839,6 +3349,37 @@ bool LogBlockManager::AddLogBlock(LogBlockRefPtr lb) {
   return true;
 }
 
+LogBlockRefPtr LogBlockManager::CreateAndReplaceLogBlock(const LogBlockRefPtr& original,
+                                                         LogBlockContainerRefPtr container,
+                                                         int64_t offset,
+                                                         int64_t length,
+                                                         bool* replaced) {
+  const BlockId& block_id = original->block_id();
+  LogBlockRefPtr lb(new LogBlock(std::move(container), block_id, offset, length));
+  int index = block_id.id() & kBlockMapMask;
+  {
+    std::lock_guard<simple_spinlock> l(*managed_block_shards_[index].lock);
+    auto& blocks_by_block_id = *managed_block_shards_[index].blocks_by_block_id;
+    auto it = blocks_by_block_id.find(block_id);
+    // The original may have been deleted while it was being copied, and its
+    // ID may even have been reused since.
+    *replaced = it != blocks_by_block_id.end() && it->second.get() == original.get();
+    if (*replaced) {
+      // The caller holds a reference to the original, so it isn't destroyed
+      // under the lock.
+      it->second = lb;
+    }
+  }
+  if (*replaced) {
+    VLOG(2) << Substitute("Relocated block: id $0, from container $1 to container $2",
+                          block_id.ToString(), original->container()->ToString(),
+                          lb->container()->ToString());
+    mem_tracker_->Consume(kudu_malloc_usable_size(lb.get()));
+    mem_tracker_->Release(kudu_malloc_usable_size(original.get()));
+  }
+  return lb;
+}
+
 Status LogBlockManager::RemoveLogBlocks(const vector<BlockId>& block_ids,
                                         vector<LogBlockRefPtr>* log_blocks,
                                         vector<BlockId>* deleted) {
@@ -2904,6 +3445,7 @@ Status LogBlockManager::RemoveLogBlocks(const vector<BlockId>& block_ids,
     // TODO(yingchun): Add some metrics to track the number of orphaned blocks.
     if (s.ok()) {
       container->PostWorkOfBlocksDeleted();
+      MaybeScheduleDataCompaction(container);
     } else {
       if (first_failure.ok()) {
         first_failure = s.CloneAndPrepend("Unable to append deletion record(s) to block metadata");
@@ -3002,43 +3544,61 @@ void LogBlockManager::OpenDataDir(
     }
   }
 
+  // Read the container index, if any: the containers it summarizes as of
+  // their current metadata are loaded from it.
+  ContainerIndex index;
+  if (FLAGS_log_block_manager_container_index) {
+    s = ReadContainerIndex(dir, &index);
+    if (!s.ok() && !s.IsNotFound()) {
+      HANDLE_DISK_FAILURE(s, error_manager_->RunErrorNotificationCb(
+          ErrorHandlerType::DISK_ERROR, dir, tenant_id()));
+      LOG(WARNING) << Substitute("Ignoring the container index of $0: $1",
+                                 dir->dir(), s.ToString());
+      index.clear();
+    }
+  }
+
+  // Open and load the containers asynchronously.
   for (const string& container_name : containers_seen) {
     // Add a new result for the container.
     results->emplace_back(new internal::LogBlockContainerLoadResult());
-    LogBlockContainerRefPtr container;
-    s = OpenContainer(dir, &results->back()->report, container_name, &container);
-    if (containers_processed) {
-      ++*containers_processed;
-      if (metrics_) {
-        metrics()->processed_containers_startup->Increment();
-      }
-    }
-    if (!s.ok()) {
-      if (s.IsAborted()) {
-        // Skip the container. Open() added a record of it to 'results->back()->report' for us.
-        continue;
-      }
-      if (opts_.read_only && s.IsNotFound()) {
-        // Skip the container while the operation is read-only and the files are away,
-        // especially for the kudu cli tool.
-        continue;
-      }
-      *result_status = s.CloneAndPrepend(
-          Substitute("Could not open container $0, directory: $1", container_name, dir->dir()));
-      return;
-    }
-
-    // Load the container's records asynchronously.
     auto* r = results->back().get();
-    dir->ExecClosure([this, dir, container, r]() {
-      this->LoadContainer(dir, container, r);
+    shared_ptr<ContainerIndexEntryPB> index_entry = FindWithDefault(index, container_name,
+                                                                    nullptr);
+    dir->ExecClosure([this, dir, container_name, index_entry, r, containers_processed]() {
+      this->LoadContainer(dir, container_name, index_entry, r, containers_processed);
     });
   }
 }
 
 void LogBlockManager::LoadContainer(Dir* dir,
-                                    LogBlockContainerRefPtr container,
-                                    internal::LogBlockContainerLoadResult* result) {
+                                    const string& container_name,
+                                    shared_ptr<ContainerIndexEntryPB> index_entry,
+                                    internal::LogBlockContainerLoadResult* result,
+                                    std::atomic<int>* containers_processed) {
+  LogBlockContainerRefPtr container;
+  Status s = OpenContainer(dir, &result->report, container_name, &container);
+  if (containers_processed) {
+    ++*containers_processed;
+    if (metrics_) {
+      metrics()->processed_containers_startup->Increment();
+    }
+  }
+  if (!s.ok()) {
+    if (s.IsAborted()) {
+      // Skip the container. Open() added a record of it to 'result->report' for us.
+      return;
+    }
+    if (opts_.read_only && s.IsNotFound()) {
+      // Skip the container while the operation is read-only and the files are away,
+      // especially for the kudu cli tool.
+      return;
+    }
+    result->status = s.CloneAndPrepend(
+        Substitute("Could not open container $0, directory: $1", container_name, dir->dir()));
+    return;
+  }
+
   // Process the records, building a container-local map for live blocks and
   // a list of dead blocks.
   //
@@ -3057,18 +3617,50 @@ void LogBlockManager::LoadContainer(Dir* dir,
   BlockRecordMap live_block_records;
   vector<LogBlockRefPtr> dead_blocks;
   uint64_t max_block_id = 0;
-  Status s = container->ProcessRecords(&result->report,
-                                       &live_blocks,
-                                       &live_block_records,
-                                       &dead_blocks,
-                                       &max_block_id,
-                                       LogBlockContainer::ProcessRecordType::kReadAndUpdate);
+  s = Status::NotFound("no container index entry");
+  if (index_entry) {
+    s = container->ProcessRecordsFromIndex(*index_entry,
+                                           &result->report,
+                                           &live_blocks,
+                                           &live_block_records,
+                                           &dead_blocks,
+                                           &max_block_id);
+    if (s.IsNotFound()) {
+      VLOG(1) << Substitute("Not loading container $0 from the index: $1",
+                            container->ToString(), s.ToString());
+    } else if (s.ok()) {
+      result->report.stats.lbm_indexed_container_count++;
+    }
+  }
+  if (s.IsNotFound()) {
+    s = container->ProcessRecords(&result->report,
+                                  &live_blocks,
+                                  &live_block_records,
+                                  &dead_blocks,
+                                  &max_block_id,
+                                  LogBlockContainer::ProcessRecordType::kReadAndUpdate);
+  }
   if (!s.ok()) {
     result->status = s.CloneAndPrepend(Substitute(
         "Could not process records in container $0", container->ToString()));
     return;
   }
 
+  // Note the blocks copied here by the data compaction of other containers,
+  // before they are found duplicated; see below.
+  {
+    vector<BlockId> relocated_block_ids;
+    for (const auto& e : live_block_records) {
+      if (e.second.relocated()) {
+        relocated_block_ids.emplace_back(e.first);
+      }
+    }
+    if (!relocated_block_ids.empty()) {
+      std::lock_guard<simple_spinlock> l(relocated_block_ids_lock_);
+      relocated_block_ids_.insert(relocated_block_ids.begin(), relocated_block_ids.end());
+    }
+  }
+
   // With deleted blocks out of the way, check for misaligned blocks.
   //
   // We could also enforce that the record's offset is aligned with the
@@ -3161,19 +3753,65 @@ void LogBlockManager::LoadContainer(Dir* dir,
   next_block_id_.StoreMax(max_block_id + 1);
 
   int64_t mem_usage = 0;
+  vector<LogBlockRefPtr> duplicates;
   for (UntrackedBlockMap::value_type& e : live_blocks) {
     int block_mem = kudu_malloc_usable_size(e.second.get());
-    if (!AddLogBlock(std::move(e.second))) {
-      // TODO(adar): track as an inconsistency?
-      LOG(FATAL) << "Found duplicate CREATE record for block " << e.first
-                 << " which already is alive from another container when "
-                 << " processing container " << container->ToString();
+    if (!AddLogBlock(e.second)) {
+      bool relocated;
+      {
+        std::lock_guard<simple_spinlock> l(relocated_block_ids_lock_);
+        relocated = ContainsKey(relocated_block_ids_, e.first);
+      }
+      if (!relocated) {
+        // TODO(adar): track as an inconsistency?
+        LOG(FATAL) << "Found duplicate CREATE record for block " << e.first
+                   << " which already is alive from another container when "
+                   << " processing container " << container->ToString();
+      }
+      // The block was copied by data compaction, which crashed before
+      // recording the deletion of the original. Both copies hold the same
+      // data: keep the one already added.
+      duplicates.emplace_back(std::move(e.second));
+      continue;
     }
     mem_usage += block_mem;
   }
 
   mem_tracker_->Consume(mem_usage);
 
+  if (!duplicates.empty()) {
+    LOG(INFO) << Substitute("Dropping $0 duplicate relocated blocks from container $1",
+                            duplicates.size(), container->ToString());
+    for (const auto& lb : duplicates) {
+      container->BlockDeleted(lb);
+      result->report.stats.live_block_bytes -= lb->length();
+      result->report.stats.live_block_bytes_aligned -= lb->fs_aligned_length();
+      result->report.stats.live_block_count--;
+    }
+    if (!opts_.read_only) {
+      vector<BlockId> deleted_block_ids;
+      WARN_NOT_OK(container->RemoveBlockIdsFromMetadata(duplicates, &deleted_block_ids),
+                  Substitute("could not delete duplicate blocks from container $0",
+                             container->ToString()));
+      // Only punch out the blocks whose deletion was recorded.
+      duplicates.resize(deleted_block_ids.size());
+      result->need_repunching_blocks.insert(result->need_repunching_blocks.end(),
+                                            duplicates.begin(), duplicates.end());
+
+      // Don't resurrect the blocks when compacting the container's metadata.
+      auto* records = FindOrNull(result->low_live_block_containers, container->ToString());
+      if (records) {
+        BlockIdSet deleted(deleted_block_ids.begin(), deleted_block_ids.end());
+        records->erase(std::remove_if(records->begin(), records->end(),
+                                      [&](const BlockRecordPB& r) {
+                                        return ContainsKey(deleted,
+                                                           BlockId::FromPB(r.block_id()));
+                                      }),
+                       records->end());
+      }
+    }
+  }
+
   int64_t container_count = 0;
   {
     std::lock_guard<simple_spinlock> l(lock_);
@@ -3188,6 +3826,197 @@ void LogBlockManager::LoadContainer(Dir* dir,
   }
 }
 
+void LogBlockManager::MaybeScheduleDataCompaction(LogBlockContainer* container) {
+  if (!compaction_pool_ || !FLAGS_log_container_data_runtime_compact ||
+      container->read_only() || container->dead() || !container->sparse() ||
+      !container->TrySetDataCompactionScheduled()) {
+    return;
+  }
+  LogBlockContainerRefPtr self(container);
+  Status s = compaction_pool_->Submit([this, self]() { this->CompactContainerData(self); });
+  if (!s.ok()) {
+    // The block manager is shutting down.
+    container->ClearDataCompactionScheduled();
+  }
+}
+
+void LogBlockManager::CompactContainerData(const LogBlockContainerRefPtr& container) {
+  int64_t bytes_relocated = 0;
+  Status s = DoCompactContainerData(container.get(), &bytes_relocated);
+  if (metrics()) {
+    metrics()->bytes_relocated->IncrementBy(bytes_relocated);
+  }
+  if (!s.ok()) {
+    WARN_NOT_OK(s, Substitute("could not compact the data of container $0",
+                              container->ToString()));
+    // Let a later deletion retry.
+    container->ClearDataCompactionScheduled();
+    return;
+  }
+  if (metrics()) {
+    metrics()->containers_compacted->Increment();
+  }
+  LOG(INFO) << Substitute("Compacted the data of container $0: relocated $1 bytes",
+                          container->ToString(), bytes_relocated);
+}
+
+Status LogBlockManager::DoCompactContainerData(LogBlockContainer* container,
+                                               int64_t* bytes_relocated) {
+  // The blocks are copied in batches, each batch being synced at once.
+  static constexpr int64_t kBatchBytes = 64 * 1024 * 1024;
+
+  // Gather the live blocks of the container, in the order of their data. As
+  // the container is full, no block is added to it in the meantime.
+  vector<LogBlockRefPtr> blocks;
+  for (const auto& mb : managed_block_shards_) {
+    std::lock_guard<simple_spinlock> l(*mb.lock);
+    for (const auto& e : *mb.blocks_by_block_id) {
+      if (e.second->container() == container) {
+        blocks.emplace_back(e.second);
+      }
+    }
+  }
+  std::sort(blocks.begin(), blocks.end(),
+            [](const LogBlockRefPtr& a, const LogBlockRefPtr& b) {
+              return a->offset() < b->offset();
+            });
+
+  // Paces the copy at --log_container_data_compact_max_bytes_per_sec.
+  const MonoTime start = MonoTime::Now();
+  int64_t bytes_copied = 0;
+  auto throttle = [&](int64_t bytes) {
+    bytes_copied += bytes;
+    const int64_t max_rate = FLAGS_log_container_data_compact_max_bytes_per_sec;
+    if (max_rate <= 0) {
+      return;
+    }
+    const MonoTime due = start + MonoDelta::FromSeconds(
+        static_cast<double>(bytes_copied) / max_rate);
+    const MonoTime now = MonoTime::Now();
+    if (now < due) {
+      SleepFor(due - now);
+    }
+  };
+
+  auto it = blocks.begin();
+  while (it != blocks.end()) {
+    vector<LogBlockRefPtr> batch;
+    int64_t batch_bytes = 0;
+    do {
+      batch_bytes += (*it)->length();
+      batch.emplace_back(std::move(*it++));
+    } while (it != blocks.end() && batch_bytes + (*it)->length() <= kBatchBytes);
+    RETURN_NOT_OK(RelocateBlocks(container, batch, throttle, bytes_relocated));
+  }
+  return Status::OK();
+}
+
+Status LogBlockManager::RelocateBlocks(LogBlockContainer* container,
+                                       const vector<LogBlockRefPtr>& blocks,
+                                       const std::function<void(int64_t)>& throttle,
+                                       int64_t* bytes_relocated) {
+  static constexpr int64_t kChunkBytes = 1024 * 1024;
+  unique_ptr<uint8_t[]> buf(new uint8_t[kChunkBytes]);
+
+  // Copy the data of the blocks.
+  vector<unique_ptr<LogWritableBlock>> copies;
+  for (const auto& lb : blocks) {
+    if (closing_) {
+      return Status::Aborted("the block manager is shutting down");
+    }
+    {
+      // Skip the blocks deleted in the meantime.
+      int index = lb->block_id().id() & kBlockMapMask;
+      std::lock_guard<simple_spinlock> l(*managed_block_shards_[index].lock);
+      if (FindPtrOrNull(*managed_block_shards_[index].blocks_by_block_id,
+                        lb->block_id()).get() != lb.get()) {
+        continue;
+      }
+    }
+    LogBlockContainerRefPtr dest;
+    RETURN_NOT_OK(GetOrCreateContainerInDir(container->data_dir(), &dest));
+    const int64_t offset = dest->next_block_offset();
+    unique_ptr<LogWritableBlock> copy(new LogWritableBlock(std::move(dest), lb->block_id(),
+                                                           offset));
+    copy->set_original(lb);
+    for (int64_t copied = 0; copied < lb->length();) {
+      Slice chunk(buf.get(), std::min(kChunkBytes, lb->length() - copied));
+      RETURN_NOT_OK(container->ReadData(lb->offset() + copied, chunk));
+      RETURN_NOT_OK(copy->Append(chunk));
+      copied += chunk.size();
+      throttle(chunk.size());
+    }
+    RETURN_NOT_OK(copy->Finalize());
+    copies.emplace_back(std::move(copy));
+  }
+
+  unordered_map<LogBlockContainer*, vector<LogWritableBlock*>> copies_by_container;
+  for (const auto& copy : copies) {
+    LookupOrInsert(&copies_by_container, copy->container(), {}).push_back(copy.get());
+  }
+  auto transaction = std::make_shared<LogBlockDeletionTransaction>(this);
+  for (const auto& [dest, dest_copies] : copies_by_container) {
+    // Each copy takes the place of its original once its data and its
+    // creation record are durable.
+    RETURN_NOT_OK(dest->DoCloseBlocks(dest_copies, LogBlockContainer::SyncMode::SYNC));
+
+    // Delete the originals which were replaced, and the copies of those which
+    // were deleted while being copied.
+    vector<LogBlockRefPtr> originals;
+    vector<LogBlockRefPtr> orphans;
+    for (const LogWritableBlock* copy : dest_copies) {
+      if (copy->replaced_original()) {
+        originals.emplace_back(copy->original());
+        *bytes_relocated += copy->block_length();
+      } else {
+        orphans.emplace_back(copy->relocated());
+      }
+    }
+    RETURN_NOT_OK(DeleteRelocatedBlocks(container, originals, transaction));
+    RETURN_NOT_OK(DeleteRelocatedBlocks(dest, orphans, transaction));
+  }
+  return Status::OK();
+}
+
+Status LogBlockManager::DeleteRelocatedBlocks(
+    LogBlockContainer* container,
+    const vector<LogBlockRefPtr>& blocks,
+    const shared_ptr<LogBlockDeletionTransaction>& transaction) {
+  if (blocks.empty()) {
+    return Status::OK();
+  }
+  for (const auto& lb : blocks) {
+    container->BlockDeleted(lb);
+  }
+  vector<BlockId> deleted_block_ids;
+  Status s = container->RemoveBlockIdsFromMetadata(blocks, &deleted_block_ids);
+  // Unlike regular deletions, these are synced: a crash must not leave a
+  // block live in two containers for longer than necessary.
+  if (s.ok()) {
+    s = container->SyncMetadata();
+  }
+  // Only punch out the blocks whose deletion was recorded.
+  for (size_t i = 0; i < deleted_block_ids.size(); i++) {
+    blocks[i]->RegisterDeletion(transaction);
+    transaction->AddBlock(blocks[i]);
+  }
+  RETURN_NOT_OK_PREPEND(s, Substitute("could not delete relocated blocks from container $0",
+                                      container->ToString()));
+  container->PostWorkOfBlocksDeleted();
+  return Status::OK();
+}
+
+uint64_t LogBlockManager::CountSparseContainers() const {
+  uint64_t count = 0;
+  std::lock_guard<simple_spinlock> l(lock_);
+  for (const auto& e : all_containers_by_name_) {
+    if (e.second->sparse()) {
+      count++;
+    }
+  }
+  return count;
+}
+
 void LogBlockManager::RepairTask(Dir* dir, internal::LogBlockContainerLoadResult* result) {
   result->status = Repair(dir,
                           &result->report,
@@ -3533,6 +4362,129 @@ Status LogBlockManager::RewriteMetadataFile(const LogBlockContainer& container,
   return Status::OK();
 }
 
+Status LogBlockManager::ReadContainerIndex(Dir* dir, ContainerIndex* index) {
+  const string index_file_name = JoinPathSegments(dir->dir(), kContainerIndexFileName);
+  unique_ptr<RandomAccessFile> index_file;
+  RandomAccessFileOptions opts;
+  opts.is_sensitive = true;
+  RETURN_NOT_OK(env_->NewRandomAccessFile(opts, index_file_name, &index_file));
+  ReadablePBContainerFile pb_reader(std::move(index_file));
+  RETURN_NOT_OK_PREPEND(pb_reader.Open(), "could not open container index");
+  while (true) {
+    auto entry = std::make_shared<ContainerIndexEntryPB>();
+    Status s = pb_reader.ReadNextPB(entry.get());
+    if (s.IsEndOfFile()) {
+      break;
+    }
+    RETURN_NOT_OK_PREPEND(s, "could not read container index");
+    const string id = entry->id();
+    if (PREDICT_FALSE(!EmplaceIfNotPresent(index, id, std::move(entry)))) {
+      return Status::Corruption("duplicate entry in container index", id);
+    }
+  }
+  return Status::OK();
+}
+
+void LogBlockManager::WriteContainerIndexes() {
+  // Containers may have outstanding tasks running on data directories, e.g.
+  // the deletion of dead containers: wait for their outcome.
+  dd_manager_->WaitOnClosures();
+
+  unordered_map<const LogBlockContainer*, vector<const LogBlock*>> blocks_by_container;
+  for (const auto& mb : managed_block_shards_) {
+    std::lock_guard<simple_spinlock> l(*mb.lock);
+    for (const auto& e : *mb.blocks_by_block_id) {
+      LookupOrInsert(&blocks_by_container, e.second->container(), {})
+          .push_back(e.second.get());
+    }
+  }
+  vector<LogBlockContainerRefPtr> containers;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    containers.reserve(all_containers_by_name_.size());
+    for (const auto& e : all_containers_by_name_) {
+      containers.emplace_back(e.second);
+    }
+  }
+
+  unordered_map<Dir*, vector<ContainerIndexEntryPB>> entries_by_dir;
+  for (const auto& container : containers) {
+    // The containers which can't be written to may be in any state on disk.
+    if (container->read_only() || container->dead()) {
+      continue;
+    }
+    ContainerIndexEntryPB entry;
+    Status s = container->FillIndexEntry(&entry);
+    if (!s.ok()) {
+      WARN_NOT_OK(s, Substitute("could not summarize container $0", container->ToString()));
+      continue;
+    }
+    entry.set_max_block_id(next_block_id_.Load());
+    const auto* blocks = FindOrNull(blocks_by_container, container.get());
+    if (blocks) {
+      entry.mutable_block_ids()->Reserve(blocks->size());
+      entry.mutable_offsets()->Reserve(blocks->size());
+      entry.mutable_lengths()->Reserve(blocks->size());
+      for (const LogBlock* lb : *blocks) {
+        entry.add_block_ids(lb->block_id().id());
+        entry.add_offsets(lb->offset());
+        entry.add_lengths(lb->length());
+      }
+    }
+    LookupOrInsert(&entries_by_dir, container->data_dir(), {}).emplace_back(std::move(entry));
+  }
+
+  for (const auto& dd : dd_manager_->dirs()) {
+    int uuid_idx;
+    CHECK(dd_manager_->FindUuidIndexByDir(dd.get(), &uuid_idx));
+    if (dd_manager_->IsDirFailed(uuid_idx)) {
+      continue;
+    }
+    // A directory without containers gets an empty index, replacing any
+    // previous one.
+    const auto* entries = FindOrNull(entries_by_dir, dd.get());
+    WARN_NOT_OK(WriteContainerIndex(dd.get(), entries ? *entries
+                                                      : vector<ContainerIndexEntryPB>()),
+                Substitute("could not write the container index of $0", dd->dir()));
+  }
+}
+
+Status LogBlockManager::WriteContainerIndex(Dir* dir,
+                                            const vector<ContainerIndexEntryPB>& entries) {
+  const string index_file_name = JoinPathSegments(dir->dir(), kContainerIndexFileName);
+
+  // As when rewriting metadata files, write a temporary file and rename it
+  // over the existing index. Any temporary files left behind are cleaned up
+  // by the FsManager at startup.
+  string tmpl = index_file_name + kTmpInfix + ".XXXXXX";
+  unique_ptr<RWFile> tmp_file;
+  string tmp_file_name;
+  RWFileOptions opts;
+  opts.is_sensitive = true;
+  RETURN_NOT_OK_PREPEND(env_->NewTempRWFile(opts, tmpl, &tmp_file_name, &tmp_file),
+                        "could not create temporary container index");
+  auto tmp_deleter = MakeScopedCleanup([&]() {
+    WARN_NOT_OK(env_->DeleteFile(tmp_file_name),
+                "Could not delete file " + tmp_file_name);
+  });
+  WritablePBContainerFile pb_file(std::move(tmp_file));
+  RETURN_NOT_OK_PREPEND(pb_file.CreateNew(ContainerIndexEntryPB()),
+                        "could not initialize temporary container index");
+  for (const auto& entry : entries) {
+    RETURN_NOT_OK_PREPEND(pb_file.Append(entry),
+                          "could not append to temporary container index");
+  }
+  RETURN_NOT_OK_PREPEND(pb_file.Sync(), "could not sync temporary container index");
+  RETURN_NOT_OK_PREPEND(pb_file.Close(), "could not close temporary container index");
+  RETURN_NOT_OK_PREPEND(env_->RenameFile(tmp_file_name, index_file_name),
+                        "could not rename temporary container index");
+  tmp_deleter.cancel();
+  RETURN_NOT_OK_PREPEND(env_->SyncDir(dir->dir()), "could not sync data directory");
+  VLOG(1) << Substitute("Wrote the container index of $0 ($1 containers)",
+                        dir->dir(), entries.size());
+  return Status::OK();
+}
+
 string LogBlockManager::ContainerPathForTests(internal::LogBlockContainer* container) {
   return container->ToString();
 }
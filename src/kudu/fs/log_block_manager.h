@@ -20,6 +20,7 @@
 #include <atomic>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -42,6 +43,7 @@
 #include "kudu/util/atomic.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/mem_tracker.h"
+#include "kudu/util/metrics.h"
 #include "kudu/util/oid_generator.h"
 #include "kudu/util/status.h"
 
@@ -49,6 +51,7 @@ namespace kudu {
 
 class Env;
 class FileCache;
+class ThreadPool;
 
 namespace fs {
 class Dir;
@@ -178,6 +181,7 @@ class LogBlockManager : public BlockManager {
  public:
   static const char* kContainerMetadataFileSuffix;
   static const char* kContainerDataFileSuffix;
+  static const char* kContainerIndexFileName;
 
   ~LogBlockManager() override;
 
@@ -199,6 +203,8 @@ class LogBlockManager : public BlockManager {
 
   void NotifyBlockId(BlockId block_id) override;
 
+  void PrefetchBlocks(const std::vector<BlockId>& block_ids) override;
+
   scoped_refptr<FsErrorManager> error_manager() override { return error_manager_; }
 
   std::string tenant_id() const override { return tenant_id_; }
@@ -216,6 +222,8 @@ class LogBlockManager : public BlockManager {
   FRIEND_TEST(LogBlockManagerTest, TestAbortBlock);
   FRIEND_TEST(LogBlockManagerTest, TestCloseFinalizedBlock);
   FRIEND_TEST(LogBlockManagerTest, TestCompactFullContainerMetadataAtStartup);
+  FRIEND_TEST(LogBlockManagerTest, TestCompactSparseContainerData);
+  FRIEND_TEST(LogBlockManagerTest, TestContainerIndex);
   FRIEND_TEST(LogBlockManagerTest, TestFinalizeBlock);
   FRIEND_TEST(LogBlockManagerTest, TestLIFOContainerSelection);
   FRIEND_TEST(LogBlockManagerTest, TestLookupBlockLimit);
@@ -300,6 +308,9 @@ class LogBlockManager : public BlockManager {
   Status GetOrCreateContainer(const CreateBlockOptions& opts,
                               LogBlockContainerRefPtr* container);
 
+  // Like GetOrCreateContainer(), but for a container in 'dir'.
+  Status GetOrCreateContainerInDir(Dir* dir, LogBlockContainerRefPtr* container);
+
   // Indicate that this container is no longer in use and can be handed out
   // to other writers.
   void MakeContainerAvailable(LogBlockContainerRefPtr container);
@@ -330,6 +341,17 @@ class LogBlockManager : public BlockManager {
   // Returns true if the LogBlock was successfully added, false if it was already present.
   bool AddLogBlock(LogBlockRefPtr lb);
 
+  // Creates a LogBlock for a copy of 'original' at 'offset' in 'container' and,
+  // if 'original' is still live, replaces it by the copy in in-memory data
+  // structures. '*replaced' is set to whether it was replaced.
+  //
+  // Returns the created LogBlock.
+  LogBlockRefPtr CreateAndReplaceLogBlock(const LogBlockRefPtr& original,
+                                          LogBlockContainerRefPtr container,
+                                          int64_t offset,
+                                          int64_t length,
+                                          bool* replaced);
+
   // Removes the given set of LogBlocks from in-memory data structures, and
   // adds the block deletion metadata to record the on-disk deletion.
   // The 'log_blocks' out parameter will be set with the LogBlocks that were
@@ -348,6 +370,43 @@ class LogBlockManager : public BlockManager {
   Status RemoveLogBlock(const BlockId& block_id,
                         LogBlockRefPtr* lb);
 
+  // Schedules the compaction of the data of 'container' if it's sparse. See
+  // --log_container_data_runtime_compact.
+  void MaybeScheduleDataCompaction(internal::LogBlockContainer* container);
+
+  // Simple wrapper of DoCompactContainerData(), used as a runnable function in
+  // 'compaction_pool_'.
+  void CompactContainerData(const LogBlockContainerRefPtr& container);
+
+  // Copies the live blocks of 'container' to other containers of its data
+  // directory, then deletes them from 'container', which dies once all of
+  // them are copied. The blocks are switched to their copies one by one, so
+  // they remain readable throughout.
+  //
+  // The number of bytes copied is written to 'bytes_relocated', even upon
+  // failure.
+  Status DoCompactContainerData(internal::LogBlockContainer* container,
+                                int64_t* bytes_relocated);
+
+  // Copies 'blocks' out of 'container', see DoCompactContainerData().
+  // 'throttle' is called with the number of bytes after each copied chunk.
+  Status RelocateBlocks(internal::LogBlockContainer* container,
+                        const std::vector<LogBlockRefPtr>& blocks,
+                        const std::function<void(int64_t)>& throttle,
+                        int64_t* bytes_relocated);
+
+  // Deletes 'blocks', which were removed from in-memory data structures
+  // already, from 'container': their deletion is recorded on disk, and
+  // their space is reclaimed once 'transaction' is destroyed.
+  Status DeleteRelocatedBlocks(
+      internal::LogBlockContainer* container,
+      const std::vector<LogBlockRefPtr>& blocks,
+      const std::shared_ptr<internal::LogBlockDeletionTransaction>& transaction);
+
+  // Returns the number of full containers whose live data are below
+  // --log_container_live_data_before_compact_ratio of their data file.
+  uint64_t CountSparseContainers() const;
+
   // Simple wrapper of Repair(), used as a runnable function in thread.
   void RepairTask(Dir* dir, internal::LogBlockContainerLoadResult* result);
 
@@ -414,11 +473,37 @@ class LogBlockManager : public BlockManager {
                    std::atomic<int>* containers_processed = nullptr,
                    std::atomic<int>* containers_total = nullptr);
 
-  // Reads records from one log block container in the data directory.
-  // The result details will be collected into 'result'.
+  // Opens the log block container 'container_name' in the data directory and
+  // reads its records, starting from 'index_entry' if not null. The result
+  // details will be collected into 'result'.
+  //
+  // If 'containers_processed' is not nullptr, it's incremented once the
+  // container is opened.
   void LoadContainer(Dir* dir,
-                     LogBlockContainerRefPtr container,
-                     internal::LogBlockContainerLoadResult* result);
+                     const std::string& container_name,
+                     std::shared_ptr<ContainerIndexEntryPB> index_entry,
+                     internal::LogBlockContainerLoadResult* result,
+                     std::atomic<int>* containers_processed);
+
+  // The entries of the container index of a data directory, by container ID.
+  typedef std::unordered_map<std::string,
+                             std::shared_ptr<ContainerIndexEntryPB>> ContainerIndex;
+
+  // Reads the container index of 'dir' into 'index'.
+  //
+  // Returns Status::NotFound() if the directory has no container index.
+  Status ReadContainerIndex(Dir* dir, ContainerIndex* index);
+
+  // Writes the container index of each healthy data directory, summarizing
+  // the current state of their containers. See
+  // --log_block_manager_container_index.
+  //
+  // Must not be called concurrently with block creations or deletions.
+  void WriteContainerIndexes();
+
+  // Writes 'entries' as the container index of 'dir', replacing the
+  // existing one, if any.
+  Status WriteContainerIndex(Dir* dir, const std::vector<ContainerIndexEntryPB>& entries);
 
   ObjectIdGenerator* oid_generator() { return &oid_generator_; }
 
@@ -519,6 +604,28 @@ class LogBlockManager : public BlockManager {
   // Which tenant this log block manager belongs to.
   std::string tenant_id_;
 
+  // Runs the compactions of the data of containers, one at a time.
+  //
+  // Null if the block manager is read-only.
+  std::unique_ptr<ThreadPool> compaction_pool_;
+
+  // Set when the block manager is being destroyed, so that ongoing
+  // compactions stop early.
+  std::atomic<bool> closing_;
+
+  // The IDs of blocks which are in a container as copies made by data
+  // compaction, whose duplicates, if any, are to be dropped.
+  //
+  // Only used during startup.
+  simple_spinlock relocated_block_ids_lock_;
+  BlockIdSet relocated_block_ids_;
+
+  // Whether Open() succeeded, i.e. whether the in-memory state reflects the
+  // containers on disk.
+  bool opened_;
+
+  FunctionGaugeDetacher metric_detacher_;
+
   DISALLOW_COPY_AND_ASSIGN(LogBlockManager);
 };
 
@@ -349,6 +349,10 @@ string column_to_field_type(const ColumnSchema& column) {
                                     column.type_attributes().length);
     case UNIXTIME_MICROS: return "timestamp";
     case DATE: return "date";
+    case JSON: return "string";
+    case ARRAY: return Substitute(
+        "array<$0>", column_to_field_type(ColumnSchema(column.name(),
+                                                       column.type_attributes().element_type)));
     default: LOG(FATAL) << "unhandled column type: " << column.TypeToString();
   }
   __builtin_unreachable();
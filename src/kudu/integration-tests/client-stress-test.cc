@@ -252,6 +252,9 @@ class ClientStressLowMemoryTest : public ClientStressTest {
     // will cause memory pressure. Since that's part of the point of the test,
     // we'll allow it.
     opts.extra_tserver_flags.push_back("--force_block_cache_capacity");
+    // Reject the writes rather than delaying them, which is what this test
+    // exercises.
+    opts.extra_tserver_flags.emplace_back("--tserver_memory_pressure_max_write_delay_ms=0");
     return opts;
   }
 };
@@ -1428,6 +1428,69 @@ TEST_F(RaftConsensusITest, TestReplicaBehaviorViaRPC) {
   }
 }
 
+// Test that, with leader leases enabled, a leader which can't reach a majority
+// stops serving READ_LATEST scans once its lease expires, even though it
+// still considers itself the leader.
+TEST_F(RaftConsensusITest, TestLeaderLeaseGatesReadLatestScans) {
+  const vector<string> kTsFlags = {
+    "--raft_enable_leader_leases=true",
+    "--raft_heartbeat_interval_ms=100",
+  };
+  NO_FATALS(BuildAndStart(kTsFlags));
+
+  const auto scan_latest = [&](TServerDetails* ts, ScanResponsePB* resp) {
+    ScanRequestPB req;
+    RpcController rpc;
+    rpc.set_timeout(MonoDelta::FromMilliseconds(500));
+    NewScanRequestPB* scan = req.mutable_new_scan_request();
+    scan->set_tablet_id(tablet_id_);
+    scan->set_read_mode(READ_LATEST);
+    ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+    ASSERT_OK(ts->tserver_proxy->Scan(req, resp, &rpc));
+  };
+
+  TServerDetails* leader;
+  ASSERT_OK(GetLeaderReplicaWithRetries(tablet_id_, &leader));
+  ASSERT_EVENTUALLY([&] {
+    ScanResponsePB resp;
+    NO_FATALS(scan_latest(leader, &resp));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp.error());
+  });
+
+  // Cut the leader off from its followers, and wait for its lease to expire.
+  vector<ExternalTabletServer*> followers;
+  for (const auto& e : tablet_servers_) {
+    if (e.first != leader->uuid()) {
+      followers.push_back(cluster_->tablet_server_by_uuid(e.first));
+    }
+  }
+  for (auto* ets : followers) {
+    ASSERT_OK(ets->Pause());
+  }
+  SleepFor(MonoDelta::FromSeconds(1));
+  {
+    ScanResponsePB resp;
+    NO_FATALS(scan_latest(leader, &resp));
+    ASSERT_TRUE(resp.has_error());
+    ASSERT_EQ(TabletServerErrorPB::NOT_THE_LEADER, resp.error().code());
+    const Status s = StatusFromPB(resp.error().status());
+    ASSERT_TRUE(s.IsTimedOut()) << s.ToString();
+  }
+
+  // Once the followers are back, whichever replica is the leader serves the
+  // scan again.
+  for (auto* ets : followers) {
+    ASSERT_OK(ets->Resume());
+  }
+  ASSERT_EVENTUALLY([&] {
+    TServerDetails* leader;
+    ASSERT_OK(GetLeaderReplicaWithRetries(tablet_id_, &leader));
+    ScanResponsePB resp;
+    NO_FATALS(scan_latest(leader, &resp));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp.error());
+  });
+}
+
 // Basic test of adding and removing servers from a configuration.
 TEST_F(RaftConsensusITest, TestAddRemoveServer) {
   const MonoDelta kTimeout = MonoDelta::FromSeconds(10);
@@ -307,6 +307,36 @@ TEST_F(TxnCommitITest, TestBasicCommits) {
   ASSERT_TRUE(is_complete);
 }
 
+// Test that committing a transaction can return as soon as its commit
+// timestamp is persisted, with the commit finalized in the background.
+TEST_F(TxnCommitITest, TestCommitAndWaitForTimestamp) {
+  // Delay writing the COMMITTED record, so the transaction is stuck in
+  // FINALIZE_IN_PROGRESS for a while.
+  FLAGS_txn_status_manager_inject_latency_finalize_commit_ms = 10000;
+  shared_ptr<KuduTransaction> txn;
+  shared_ptr<KuduSession> txn_session;
+  ASSERT_OK(BeginTransaction(&txn, &txn_session));
+  ASSERT_OK(InsertToSession(txn_session, initial_row_count_, kNumRowsPerTxn));
+  ASSERT_OK(txn->CommitAndWaitForTimestamp());
+
+  Status completion_status;
+  bool is_complete;
+  ASSERT_OK(txn->IsCommitComplete(&is_complete, &completion_status));
+  ASSERT_TRUE(completion_status.IsIncomplete()) << completion_status.ToString();
+  ASSERT_FALSE(is_complete);
+
+  ASSERT_EVENTUALLY([&] {
+    int num_rows = 0;
+    ASSERT_OK(CountRows(&num_rows));
+    ASSERT_EQ(initial_row_count_ + kNumRowsPerTxn, num_rows);
+  });
+  ASSERT_EVENTUALLY([&] {
+    ASSERT_OK(txn->IsCommitComplete(&is_complete, &completion_status));
+    ASSERT_OK(completion_status);
+    ASSERT_TRUE(is_complete);
+  });
+}
+
 TEST_F(TxnCommitITest, TestBasicAborts) {
   shared_ptr<KuduTransaction> txn;
   shared_ptr<KuduSession> txn_session;
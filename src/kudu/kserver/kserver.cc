@@ -56,6 +56,23 @@ static bool ValidateThreadPoolThreadLimit(const char* /*flagname*/, int32_t valu
 }
 DEFINE_validator(server_thread_pool_max_thread_count, &ValidateThreadPoolThreadLimit);
 
+DEFINE_int32(server_thread_pool_max_serial_batch_size, 1,
+             "Maximum number of the queued tasks of a tablet replica that a "
+             "thread of the server-wide apply, prepare and Raft thread pools "
+             "runs at once, in order. Larger batches reduce the contention on "
+             "the locks of the pools at high operation rates, at the expense of "
+             "the fairness between the replicas.");
+TAG_FLAG(server_thread_pool_max_serial_batch_size, experimental);
+
+static bool ValidateSerialBatchSize(const char* flagname, int32_t value) {
+  if (value < 1) {
+    LOG(ERROR) << strings::Substitute("Invalid value for --$0: must be at least 1", flagname);
+    return false;
+  }
+  return true;
+}
+DEFINE_validator(server_thread_pool_max_serial_batch_size, &ValidateSerialBatchSize);
+
 using std::string;
 using strings::Substitute;
 
@@ -151,6 +168,7 @@ Status KuduServer::Init() {
     };
     ThreadPoolBuilder builder("apply");
     builder.set_metrics(std::move(metrics));
+    builder.set_max_serial_batch_size(FLAGS_server_thread_pool_max_serial_batch_size);
     if (opts_.apply_queue_overload_threshold.Initialized()) {
       builder.set_queue_overload_threshold(opts_.apply_queue_overload_threshold);
     }
@@ -164,10 +182,12 @@ Status KuduServer::Init() {
                           server_wide_pool_limit);
   RETURN_NOT_OK(ThreadPoolBuilder("prepare")
                 .set_max_threads(server_wide_pool_limit)
+                .set_max_serial_batch_size(FLAGS_server_thread_pool_max_serial_batch_size)
                 .Build(&tablet_prepare_pool_));
   RETURN_NOT_OK(ThreadPoolBuilder("raft")
                 .set_trace_metric_prefix("raft")
                 .set_max_threads(server_wide_pool_limit)
+                .set_max_serial_batch_size(FLAGS_server_thread_pool_max_serial_batch_size)
                 .Build(&raft_pool_));
 
   num_raft_leaders_ = metric_entity_->FindOrCreateGauge(&METRIC_num_raft_leaders, 0);
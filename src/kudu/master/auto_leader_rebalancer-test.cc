@@ -62,6 +62,7 @@ using std::unique_ptr;
 using std::vector;
 
 DECLARE_bool(auto_leader_rebalancing_enabled);
+DECLARE_bool(auto_leader_rebalancing_weight_by_write_rate);
 DECLARE_bool(auto_rebalancing_enabled);
 DECLARE_int32(heartbeat_interval_ms);
 DECLARE_uint32(auto_leader_rebalancing_interval_seconds);
@@ -211,6 +212,39 @@ TEST_F(LeaderRebalancerTest, RestartTserver) {
   ASSERT_OK(CheckLeaderBalance());
 }
 
+// Same as above, but with the leaders weighted by the write rates of their
+// tablets while a workload writes to the table.
+TEST_F(LeaderRebalancerTest, RestartTserverWithWriteLoad) {
+  const int kNumTServers = 4;
+  const int kNumTablets = 59;
+  cluster_opts_.num_tablet_servers = kNumTServers;
+  FLAGS_leader_rebalancing_max_moves_per_round = 5;
+  FLAGS_auto_leader_rebalancing_weight_by_write_rate = true;
+  ASSERT_OK(CreateAndStartCluster());
+
+  CreateWorkloadTable(kNumTablets, /*num_replicas*/ 3);
+  workload_->Start();
+
+  master::Master* master = cluster_->mini_master()->master();
+  master::AutoLeaderRebalancerTask* leader_rebalancer =
+      master->catalog_manager()->auto_leader_rebalancer();
+  ASSERT_NE(leader_rebalancer, nullptr);
+
+  cluster_->mini_tablet_server(0)->Restart();
+  // To wait replica_rebalancer execute some runs and reach balanced.
+  SleepFor(MonoDelta::FromSeconds(10 * FLAGS_auto_rebalancing_interval_seconds));
+  constexpr const int32_t retries = 20;
+  for (int i = 0; i < retries; i++) {
+    leader_rebalancer->RunLeaderRebalancer();
+    if (CheckLeaderBalance().ok()) {
+      break;
+    }
+    SleepFor(MonoDelta::FromMilliseconds(FLAGS_heartbeat_interval_ms));
+  }
+  ASSERT_OK(CheckLeaderBalance());
+  workload_->StopAndJoin();
+}
+
 TEST_F(LeaderRebalancerTest, TestMaintenanceMode) {
   SKIP_IF_SLOW_NOT_ALLOWED();
   constexpr const int kNumTServers = 3;
@@ -18,6 +18,7 @@
 #include "kudu/master/auto_leader_rebalancer.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <map>
@@ -85,6 +86,15 @@ DEFINE_uint32(leader_rebalancing_max_moves_per_round, 10,
 TAG_FLAG(leader_rebalancing_max_moves_per_round, advanced);
 TAG_FLAG(leader_rebalancing_max_moves_per_round, runtime);
 
+DEFINE_bool(auto_leader_rebalancing_weight_by_write_rate, false,
+            "Whether the auto leader rebalancer balances the write load of the leaders "
+            "of each table among the tablet servers rather than their count. Each leader "
+            "is then weighted by 1 plus the ratio of the write rate of its tablet, as "
+            "reported in the tablet reports, to the average write rate of the tablets "
+            "of the table, so that a tablet server hosting hot leaders hosts fewer of them.");
+TAG_FLAG(auto_leader_rebalancing_weight_by_write_rate, experimental);
+TAG_FLAG(auto_leader_rebalancing_weight_by_write_rate, runtime);
+
 DECLARE_bool(auto_leader_rebalancing_enabled);
 
 namespace kudu {
@@ -146,6 +156,12 @@ Status AutoLeaderRebalancerTask::RunLeaderRebalanceForTable(
   vector<scoped_refptr<TabletInfo>> tablet_infos;
   table_info->GetAllTablets(&tablet_infos);
 
+  // tablet_id -> weight of its leader, or of its replicas
+  std::unordered_map<string, double> weight_by_tablet_id = GetTabletWeights(tablet_infos);
+  const auto weight = [&](const string& tablet_id) {
+    return FindWithDefault(weight_by_tablet_id, tablet_id, 1.0);
+  };
+
   // step 1. Get basic statistics
   for (const auto& tablet : tablet_infos) {
     TabletMetadataLock tablet_l(tablet.get(), LockMode::READ);
@@ -196,33 +212,52 @@ Status AutoLeaderRebalancerTask::RunLeaderRebalanceForTable(
   }
 
   // step 2.
-  // pick the servers which number of leaders greater than 1/3 of number of all replicas
-  // <uuid, number of replica, number of leader>
-  map<string, std::pair<int32_t, int32_t>> replica_and_leader_count_by_ts_uuid;
-  // uuid->leader should transfer count
-  map<string, int32_t> leader_transfer_source;
+  // pick the servers which load of leaders greater than 1/3 of load of all replicas.
+  // Unless weighted by write rate, the load of replicas is their number.
+  // <uuid, load of replicas, load of leaders>
+  map<string, std::pair<double, double>> replica_and_leader_load_by_ts_uuid;
+  // uuid->leader should transfer load
+  map<string, double> leader_transfer_source;
+  // The correction factor below: the average weight of a replica.
+  double replicas_load = 0;
+  int32_t replicas_count = 0;
+  for (const auto& e : tablet_ids_by_ts_uuid) {
+    for (const auto& tablet_id : e.second) {
+      replicas_load += weight(tablet_id);
+    }
+    replicas_count += e.second.size();
+  }
+  const double average_weight = replicas_count > 0 ? replicas_load / replicas_count : 1;
   for (const auto& uuid : tserver_uuids) {
     auto* tablet_ids_ptr = FindOrNull(tablet_ids_by_ts_uuid, uuid);
-    uint32_t replica_count = tablet_ids_ptr ? tablet_ids_ptr->size() : 0;
-    if (replica_count == 0) {
+    if (!tablet_ids_ptr || tablet_ids_ptr->empty()) {
       // means no replicas (and no leaders), maybe a tserver joined kudu cluster just now, skip it
       continue;
     }
-    auto* leader_tablet_ids_ptr = FindOrNull(leader_tablet_ids_by_ts_uuid, uuid);
-    uint32_t leader_count = leader_tablet_ids_ptr ? leader_tablet_ids_ptr->size() : 0;
-    replica_and_leader_count_by_ts_uuid.insert(
-        {uuid, std::pair<int32_t, int32_t>(replica_count, leader_count)});
+    double replica_load = 0;
+    for (const auto& tablet_id : *tablet_ids_ptr) {
+      replica_load += weight(tablet_id);
+    }
+    double leader_load = 0;
+    if (auto* leader_tablet_ids_ptr = FindOrNull(leader_tablet_ids_by_ts_uuid, uuid);
+        leader_tablet_ids_ptr) {
+      for (const auto& tablet_id : *leader_tablet_ids_ptr) {
+        leader_load += weight(tablet_id);
+      }
+    }
+    replica_and_leader_load_by_ts_uuid.insert(
+        {uuid, std::pair<double, double>(replica_load, leader_load)});
     VLOG(1) << Substitute(
-        "uuid: $0, replica_count: $1, leader_count: $2", uuid, replica_count, leader_count);
-
-    // Our target is every tserver' replicas, number of leader : number of follower is
-    // 1 : (replica_refactor -1). The constant 1 is a coarse-grained correction factor to help
-    // leader rebalancer to converge stable.
-    int32_t should_transfer_count = static_cast<int32_t>(leader_count) -
-                                    (static_cast<int32_t>(replica_count) / replication_factor + 1);
-    if (should_transfer_count > 0) {
-      leader_transfer_source.insert({uuid, should_transfer_count});
-      VLOG(1) << Substitute("$0 should transfer leader count: $1", uuid, should_transfer_count);
+        "uuid: $0, replica_load: $1, leader_load: $2", uuid, replica_load, leader_load);
+
+    // Our target is every tserver' replicas, load of leader : load of follower is
+    // 1 : (replica_refactor -1). The average weight of a replica is a coarse-grained
+    // correction factor to help leader rebalancer to converge stable.
+    double should_transfer_load = leader_load -
+        (std::floor(replica_load / replication_factor) + average_weight);
+    if (should_transfer_load > 0) {
+      leader_transfer_source.insert({uuid, should_transfer_load});
+      VLOG(1) << Substitute("$0 should transfer leader load: $1", uuid, should_transfer_load);
     }
   }
 
@@ -231,8 +266,8 @@ Status AutoLeaderRebalancerTask::RunLeaderRebalanceForTable(
   map<string, std::pair<string, string>> leader_transfer_tasks;
   for (const auto& from_info : leader_transfer_source) {
     string leader_uuid = from_info.first;
-    int32_t need_transfer_count = from_info.second;
-    int32_t pick_count = 0;
+    double need_transfer_load = from_info.second;
+    double picked_load = 0;
     vector<string>& uuid_leaders = leader_tablet_ids_by_ts_uuid[leader_uuid];
     std::shuffle(uuid_leaders.begin(), uuid_leaders.end(), random_generator_);
     // This loop would generate 'uuid_leaders.size()' leader transferring tasks at most.
@@ -251,16 +286,16 @@ Status AutoLeaderRebalancerTask::RunLeaderRebalanceForTable(
         if (ContainsKey(exclude_dest_uuids, uuid_followers[j])) {
           continue;
         }
-        std::pair<int32_t, int32_t>& replica_and_leader_count =
-            replica_and_leader_count_by_ts_uuid[uuid_followers[j]];
-        int32_t replica_count = replica_and_leader_count.first;
-        if (replica_count <= 0) {
+        std::pair<double, double>& replica_and_leader_load =
+            replica_and_leader_load_by_ts_uuid[uuid_followers[j]];
+        double replica_load = replica_and_leader_load.first;
+        if (replica_load <= 0) {
           dest_follower_uuid.clear();
           break;
         }
-        int32_t leader_count = replica_and_leader_count.second;
+        double leader_load = replica_and_leader_load.second;
         // double is not precise.
-        double score = static_cast<double>(leader_count) / replica_count;
+        double score = leader_load / replica_load;
         if (score < min_score) {
           min_score = score;
           dest_follower_uuid = uuid_followers[j];
@@ -269,24 +304,30 @@ Status AutoLeaderRebalancerTask::RunLeaderRebalanceForTable(
       if (dest_follower_uuid.empty()) {
         continue;
       }
-      std::pair<int32_t, int32_t>& replica_and_leader_count =
-          replica_and_leader_count_by_ts_uuid[leader_uuid];
-      int32_t replica_count = replica_and_leader_count.first;
-      int32_t leader_count = replica_and_leader_count.second;
-      double leader_score = static_cast<double>(leader_count) / replica_count;
+      std::pair<double, double>& replica_and_leader_load =
+          replica_and_leader_load_by_ts_uuid[leader_uuid];
+      double leader_score = replica_and_leader_load.second / replica_and_leader_load.first;
       if (min_score > leader_score) {
         // Skip it, because the transfer will cause more leader skew
         continue;
       }
+      const double tablet_weight = weight(tablet_id);
+      if (FLAGS_auto_leader_rebalancing_weight_by_write_rate &&
+          replica_and_leader_load_by_ts_uuid[dest_follower_uuid].second + tablet_weight >
+          replica_and_leader_load.second) {
+        // Skip it, because the leader is hot enough to make the destination
+        // busier than the source is.
+        continue;
+      }
 
       leader_transfer_tasks.insert(
           {tablet_id, std::pair<string, string>(leader_uuid, dest_follower_uuid)});
-      replica_and_leader_count_by_ts_uuid[leader_uuid].second--;
-      replica_and_leader_count_by_ts_uuid[dest_follower_uuid].second++;
+      replica_and_leader_load_by_ts_uuid[leader_uuid].second -= tablet_weight;
+      replica_and_leader_load_by_ts_uuid[dest_follower_uuid].second += tablet_weight;
       if (leader_transfer_tasks.size() >= FLAGS_leader_rebalancing_max_moves_per_round) {
         break;
       }
-      if (++pick_count == need_transfer_count) {
+      if ((picked_load += tablet_weight) >= need_transfer_load) {
         // Have picked enough leader transfer tasks for this tserver.
         break;
       }
@@ -362,6 +403,32 @@ Status AutoLeaderRebalancerTask::RunLeaderRebalanceForTable(
   return Status::OK();
 }
 
+std::unordered_map<string, double> AutoLeaderRebalancerTask::GetTabletWeights(
+    const vector<scoped_refptr<TabletInfo>>& tablet_infos) {
+  std::unordered_map<string, double> weight_by_tablet_id;
+  if (!FLAGS_auto_leader_rebalancing_weight_by_write_rate) {
+    return weight_by_tablet_id;
+  }
+  std::unordered_map<string, double> write_rate_by_tablet_id;
+  double total_write_rate = 0;
+  for (const auto& tablet : tablet_infos) {
+    const auto stats = tablet->GetStats();
+    if (stats.has_write_rate()) {
+      write_rate_by_tablet_id.emplace(tablet->id(), stats.write_rate());
+      total_write_rate += stats.write_rate();
+    }
+  }
+  if (total_write_rate <= 0) {
+    // No tablet of the table is written to: all leaders weigh the same.
+    return weight_by_tablet_id;
+  }
+  const double average_write_rate = total_write_rate / write_rate_by_tablet_id.size();
+  for (const auto& e : write_rate_by_tablet_id) {
+    weight_by_tablet_id.emplace(e.first, 1 + e.second / average_write_rate);
+  }
+  return weight_by_tablet_id;
+}
+
 Status AutoLeaderRebalancerTask::RunLeaderRebalancer() {
   MutexLock auto_lock(running_mutex_);
 
@@ -21,6 +21,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -42,6 +43,7 @@ namespace master {
 class CatalogManager;
 class TSManager;
 class TableInfo;
+class TabletInfo;
 
 // A CatalogManager background task which auto-rebalances tablets' leaders distribution
 // by transferring leadership between tablet replicas.
@@ -72,6 +74,12 @@ class AutoLeaderRebalancerTask {
   // Runs the main loop of the auto-leader-rebalancing thread.
   void RunLoop();
 
+  // Returns the weights of the leaders of the specified tablets, by tablet
+  // id, if --auto_leader_rebalancing_weight_by_write_rate is set: tablets
+  // without weight weigh 1.
+  static std::unordered_map<std::string, double> GetTabletWeights(
+      const std::vector<scoped_refptr<TabletInfo>>& tablet_infos);
+
   // Run Leader Rebalance for a table
   Status RunLeaderRebalanceForTable(
       const scoped_refptr<TableInfo>& table_info,
@@ -0,0 +1,82 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/master/auto_range_partitioning.h"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using std::nullopt;
+using std::vector;
+
+namespace kudu {
+namespace master {
+
+namespace {
+constexpr int64_t kInterval = 100;
+} // anonymous namespace
+
+TEST(AutoRangePartitioningTest, TestCreatesIntervalsAhead) {
+  vector<TimeRange> to_add;
+  vector<TimeRange> to_drop;
+  ComputeAutoRangePartitionChanges({}, 250, kInterval, nullopt, 2, &to_add, &to_drop);
+  const vector<TimeRange> expected = { { 200, 300 }, { 300, 400 }, { 400, 500 } };
+  ASSERT_EQ(expected, to_add);
+  ASSERT_TRUE(to_drop.empty());
+
+  // Once created, they're not created again.
+  ComputeAutoRangePartitionChanges(expected, 250, kInterval, nullopt, 2, &to_add, &to_drop);
+  ASSERT_TRUE(to_add.empty());
+
+  // Negative times are aligned downwards too.
+  ComputeAutoRangePartitionChanges({}, -50, kInterval, nullopt, 0, &to_add, &to_drop);
+  ASSERT_EQ(vector<TimeRange>({ { -100, 0 } }), to_add);
+}
+
+TEST(AutoRangePartitioningTest, TestLeavesOverlappingIntervals) {
+  vector<TimeRange> to_add;
+  vector<TimeRange> to_drop;
+  // The existing ranges are repeated for each hash bucket, and aren't
+  // aligned on the interval: [150, 320) covers [200, 300) and [300, 400).
+  const vector<TimeRange> existing = { { 150, 320 }, { 150, 320 } };
+  ComputeAutoRangePartitionChanges(existing, 250, kInterval, nullopt, 2, &to_add, &to_drop);
+  ASSERT_EQ(vector<TimeRange>({ { 400, 500 } }), to_add);
+
+  // Nothing is added past an unbounded range.
+  ComputeAutoRangePartitionChanges({ { 350, nullopt } }, 250, kInterval, nullopt, 2,
+                                   &to_add, &to_drop);
+  ASSERT_EQ(vector<TimeRange>({ { 200, 300 } }), to_add);
+}
+
+TEST(AutoRangePartitioningTest, TestDropsRangesPastRetention) {
+  vector<TimeRange> to_add;
+  vector<TimeRange> to_drop;
+  const vector<TimeRange> existing = {
+    { nullopt, 0 }, { 0, 100 }, { 100, 200 }, { 200, 300 }, { 300, 400 }, { 400, 500 },
+  };
+  ComputeAutoRangePartitionChanges(existing, 350, kInterval, 200, 1, &to_add, &to_drop);
+  ASSERT_TRUE(to_add.empty());
+  const vector<TimeRange> expected = { { nullopt, 0 }, { 0, 100 } };
+  ASSERT_EQ(expected, to_drop);
+}
+
+} // namespace master
+} // namespace kudu
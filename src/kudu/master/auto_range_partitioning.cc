@@ -0,0 +1,94 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/master/auto_range_partitioning.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "kudu/gutil/strings/substitute.h"
+
+using std::optional;
+using std::string;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace master {
+
+namespace {
+
+string BoundToString(const optional<int64_t>& bound, const char* unbounded) {
+  return bound ? std::to_string(*bound) : unbounded;
+}
+
+// Returns true if the ranges 'a' and 'b' have a time in common.
+bool Overlaps(const TimeRange& a, const TimeRange& b) {
+  return (!a.lower || !b.upper || *a.lower < *b.upper) &&
+         (!b.lower || !a.upper || *b.lower < *a.upper);
+}
+
+// Rounds 't' down to a multiple of 'interval', towards negative infinity.
+int64_t AlignDown(int64_t t, int64_t interval) {
+  int64_t aligned = t - t % interval;
+  return aligned > t ? aligned - interval : aligned;
+}
+
+} // anonymous namespace
+
+string TimeRange::ToString() const {
+  return Substitute("[$0, $1)", BoundToString(lower, "-inf"), BoundToString(upper, "+inf"));
+}
+
+void ComputeAutoRangePartitionChanges(const vector<TimeRange>& existing,
+                                      int64_t now_us,
+                                      int64_t interval_us,
+                                      optional<int64_t> retention_us,
+                                      int num_intervals_ahead,
+                                      vector<TimeRange>* to_add,
+                                      vector<TimeRange>* to_drop) {
+  DCHECK_GT(interval_us, 0);
+  DCHECK_GE(num_intervals_ahead, 0);
+  to_add->clear();
+  to_drop->clear();
+
+  vector<TimeRange> ranges(existing);
+  std::sort(ranges.begin(), ranges.end());
+  ranges.erase(std::unique(ranges.begin(), ranges.end()), ranges.end());
+
+  if (retention_us) {
+    const int64_t cutoff_us = now_us - *retention_us;
+    for (const auto& r : ranges) {
+      if (r.upper && *r.upper <= cutoff_us) {
+        to_drop->emplace_back(r);
+      }
+    }
+  }
+
+  const int64_t first_us = AlignDown(now_us, interval_us);
+  for (int i = 0; i <= num_intervals_ahead; i++) {
+    TimeRange r{ first_us + i * interval_us, first_us + (i + 1) * interval_us };
+    if (std::none_of(ranges.begin(), ranges.end(),
+                     [&](const TimeRange& e) { return Overlaps(e, r); })) {
+      to_add->emplace_back(r);
+    }
+  }
+}
+
+} // namespace master
+} // namespace kudu
@@ -0,0 +1,75 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kudu {
+namespace master {
+
+// The bounds of a range partition of a table range-partitioned on a single
+// UNIXTIME_MICROS column, in microseconds since the epoch. The lower bound is
+// inclusive and the upper bound exclusive; a missing bound is infinite.
+struct TimeRange {
+  std::optional<int64_t> lower;
+  std::optional<int64_t> upper;
+
+  bool operator==(const TimeRange& other) const {
+    return lower == other.lower && upper == other.upper;
+  }
+
+  bool operator<(const TimeRange& other) const {
+    if (lower != other.lower) {
+      // A missing lower bound sorts first.
+      return lower < other.lower;
+    }
+    if (upper != other.upper) {
+      // A missing upper bound sorts last.
+      return other.upper && (!upper || *upper < *other.upper);
+    }
+    return false;
+  }
+
+  std::string ToString() const;
+};
+
+// Computes the range partitions to add to and drop from a table whose range
+// partitions are 'existing', as of 'now_us', so that:
+//  - the interval of 'interval_us' containing 'now_us', and the
+//    'num_intervals_ahead' intervals after it, are covered by range
+//    partitions. The intervals are aligned on multiples of 'interval_us',
+//    and those already overlapping an existing range partition are left to
+//    it;
+//  - if 'retention_us' is set, the range partitions whose upper bound is at
+//    or before 'now_us - retention_us' are dropped.
+//
+// 'existing' may contain duplicates, e.g. the ranges of the tablets of
+// different hash buckets.
+void ComputeAutoRangePartitionChanges(const std::vector<TimeRange>& existing,
+                                      int64_t now_us,
+                                      int64_t interval_us,
+                                      std::optional<int64_t> retention_us,
+                                      int num_intervals_ahead,
+                                      std::vector<TimeRange>* to_add,
+                                      std::vector<TimeRange>* to_drop);
+
+} // namespace master
+} // namespace kudu
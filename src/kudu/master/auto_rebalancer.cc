@@ -52,6 +52,7 @@
 #include "kudu/rebalance/rebalancer.h"
 #include "kudu/rpc/messenger.h"
 #include "kudu/rpc/rpc_controller.h"
+#include "kudu/tablet/metadata.pb.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/util/cow_object.h"
 #include "kudu/util/monotime.h"
@@ -81,10 +82,12 @@ using kudu::consensus::MODIFY_PEER;
 using kudu::consensus::RaftPeerPB;
 using kudu::master::TSManager;
 using kudu::pb_util::SecureShortDebugString;
+using kudu::rebalance::BuildServerLoadMap;
 using kudu::rebalance::BuildTabletExtraInfoMap;
 using kudu::rebalance::ClusterInfo;
 using kudu::rebalance::ClusterLocalityInfo;
 using kudu::rebalance::ClusterRawInfo;
+using kudu::rebalance::FindLoadBalancingMoves;
 using kudu::rebalance::PlacementPolicyViolationInfo;
 using kudu::rebalance::Rebalancer;
 using kudu::rebalance::SelectReplicaToMove;
@@ -93,6 +96,7 @@ using kudu::rebalance::TabletExtraInfo;
 using kudu::rebalance::TabletsPlacementInfo;
 using kudu::rpc::MessengerBuilder;
 using kudu::rpc::RpcController;
+using kudu::tablet::ReportedTabletStatsPB;
 using strings::Substitute;
 
 using std::nullopt;
@@ -136,12 +140,87 @@ DEFINE_uint32(auto_rebalancing_wait_for_replica_moves_seconds, 1,
               "How long to wait before checking to see if the scheduled replica movement "
               "in this iteration of auto-rebalancing has completed.");
 
+DEFINE_double(auto_rebalancing_size_load_weight, 1.0,
+              "Weight of the on-disk size of a tablet in its load, as considered "
+              "by the auto-rebalancer to choose which replicas to move. The size "
+              "is relative to the one of an average tablet.");
+
+DEFINE_double(auto_rebalancing_write_load_weight, 1.0,
+              "Weight of the rate of rows written to a tablet in its load, as "
+              "considered by the auto-rebalancer to choose which replicas to "
+              "move. The rate is relative to the one of an average tablet.");
+
+DEFINE_double(auto_rebalancing_scan_load_weight, 1.0,
+              "Weight of the rate of scans started on a tablet in its load, as "
+              "considered by the auto-rebalancer to choose which replicas to "
+              "move. The rate is relative to the one of an average tablet.");
+
+DEFINE_double(auto_rebalancing_min_load_improvement, 2.0,
+              "Once the replica counts are balanced, the auto-rebalancer moves "
+              "replicas between tablet servers to even out their load if that "
+              "reduces the load difference between them by at least this much, "
+              "in units of the load of an average tablet. If not positive, "
+              "replicas are only moved to balance the replica counts.");
+
 DECLARE_bool(auto_rebalancing_enabled);
 
 namespace kudu {
 
 namespace master {
 
+namespace {
+
+// Returns the load of the tablets with the given stats, relative to the load
+// of an average tablet: the load of a tablet is the weighted average of its
+// on-disk size, write rate and scan rate, each relative to the one of an
+// average tablet.
+unordered_map<string, double> ComputeTabletLoads(
+    const unordered_map<string, ReportedTabletStatsPB>& stats_by_tablet_id) {
+  struct LoadFactor {
+    double weight;
+    std::function<double(const ReportedTabletStatsPB&)> value;
+    double mean;
+  };
+  vector<LoadFactor> factors = {
+    { FLAGS_auto_rebalancing_size_load_weight,
+      [](const ReportedTabletStatsPB& s) { return static_cast<double>(s.on_disk_size()); }, 0 },
+    { FLAGS_auto_rebalancing_write_load_weight,
+      [](const ReportedTabletStatsPB& s) { return s.write_rate(); }, 0 },
+    { FLAGS_auto_rebalancing_scan_load_weight,
+      [](const ReportedTabletStatsPB& s) { return s.scan_rate(); }, 0 },
+  };
+  unordered_map<string, double> load_by_tablet_id;
+  if (stats_by_tablet_id.empty()) {
+    return load_by_tablet_id;
+  }
+  double total_weight = 0;
+  for (auto& f : factors) {
+    for (const auto& [_, stats] : stats_by_tablet_id) {
+      f.mean += f.value(stats);
+    }
+    f.mean /= stats_by_tablet_id.size();
+    if (f.weight > 0 && f.mean > 0) {
+      total_weight += f.weight;
+    }
+  }
+  if (total_weight == 0) {
+    // Nothing tells the tablets apart.
+    return load_by_tablet_id;
+  }
+  for (const auto& [tablet_id, stats] : stats_by_tablet_id) {
+    double load = 0;
+    for (const auto& f : factors) {
+      if (f.weight > 0 && f.mean > 0) {
+        load += f.weight * f.value(stats) / f.mean;
+      }
+    }
+    EmplaceOrDie(&load_by_tablet_id, tablet_id, load / total_weight);
+  }
+  return load_by_tablet_id;
+}
+
+} // anonymous namespace
+
 AutoRebalancerTask::AutoRebalancerTask(CatalogManager* catalog_manager,
                                        TSManager* ts_manager)
     : catalog_manager_(catalog_manager),
@@ -279,6 +358,9 @@ Status AutoRebalancerTask::GetMoves(
   if (ts_id_by_location.size() == 1) {
     rebalance::TwoDimensionalGreedyAlgo algo;
     RETURN_NOT_OK(GetMovesUsingRebalancingAlgo(raw_info, &algo, CrossLocations::NO, &rep_moves));
+    if (rep_moves.empty()) {
+      GetLoadBalancingMoves(raw_info, &rep_moves);
+    }
     *replica_moves = std::move(rep_moves);
     return Status::OK();
   }
@@ -316,6 +398,13 @@ Status AutoRebalancerTask::GetMoves(
       RETURN_NOT_OK(GetMovesUsingRebalancingAlgo(
           location_raw_info, &algo, CrossLocations::NO, &rep_moves));
     }
+    if (rep_moves.empty()) {
+      for (const auto& elem : ts_id_by_location) {
+        ClusterRawInfo location_raw_info;
+        RETURN_NOT_OK(BuildClusterRawInfo(elem.first, &location_raw_info));
+        GetLoadBalancingMoves(location_raw_info, &rep_moves);
+      }
+    }
   }
   *replica_moves = std::move(rep_moves);
   return Status::OK();
@@ -343,6 +432,8 @@ Status AutoRebalancerTask::GetMovesUsingRebalancingAlgo(
 
   unordered_map<string, TabletExtraInfo> extra_info_by_tablet_id;
   BuildTabletExtraInfoMap(raw_info, &extra_info_by_tablet_id);
+  unordered_map<string, double> load_by_ts_id;
+  BuildServerLoadMap(raw_info, &load_by_ts_id);
 
   vector<TableReplicaMove> moves;
   ClusterInfo cluster_info;
@@ -366,13 +457,25 @@ Status AutoRebalancerTask::GetMovesUsingRebalancingAlgo(
 
     RETURN_NOT_OK(SelectReplicaToMove(move, extra_info_by_tablet_id,
                                       &random_generator_, std::move(tablet_ids),
-                                      &tablets_in_move, &rep_moves));
+                                      &tablets_in_move, &rep_moves, &load_by_ts_id));
   }
 
   *replica_moves = std::move(rep_moves);
   return Status::OK();
 }
 
+void AutoRebalancerTask::GetLoadBalancingMoves(
+    const ClusterRawInfo& raw_info,
+    vector<Rebalancer::ReplicaMove>* replica_moves) const {
+  if (FLAGS_auto_rebalancing_min_load_improvement <= 0) {
+    return;
+  }
+  const int max_moves =
+      FLAGS_auto_rebalancing_max_moves_per_server * raw_info.tserver_summaries.size();
+  FindLoadBalancingMoves(raw_info, FLAGS_auto_rebalancing_min_load_improvement,
+                         max_moves, replica_moves);
+}
+
 Status AutoRebalancerTask::GetTabletLeader(
     const string& tablet_id,
     string* leader_uuid,
@@ -503,6 +606,7 @@ Status AutoRebalancerTask::BuildClusterRawInfo(
   }
 
   table_summaries.reserve(table_infos.size());
+  unordered_map<string, ReportedTabletStatsPB> stats_by_tablet_id;
 
   for (const auto& table : table_infos) {
     TableMetadataLock table_l(table.get(), LockMode::READ);
@@ -524,6 +628,10 @@ Status AutoRebalancerTask::BuildClusterRawInfo(
     for (const auto& tablet : tablet_infos) {
       TabletMetadataLock tablet_l(tablet.get(), LockMode::READ);
 
+      if (const auto stats = tablet->GetStats(); stats.has_on_disk_size()) {
+        EmplaceOrDie(&stats_by_tablet_id, tablet->id(), stats);
+      }
+
       TabletSummary tablet_summary;
       tablet_summary.id = tablet->id();
       tablet_summary.table_id = table_summary.id;
@@ -600,6 +708,7 @@ Status AutoRebalancerTask::BuildClusterRawInfo(
     table_summaries.emplace_back(std::move(table_summary));
   }
 
+  raw_info->load_by_tablet_id = ComputeTabletLoads(stats_by_tablet_id);
   if (!location) {
     // Information on the whole cluster.
     raw_info->tserver_summaries = std::move(tserver_summaries);
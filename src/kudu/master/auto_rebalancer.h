@@ -102,6 +102,13 @@ class AutoRebalancerTask {
       CrossLocations cross_location,
       std::vector<rebalance::Rebalancer::ReplicaMove>* replica_moves);
 
+  // Adds to 'replica_moves' the moves which even out the load of the tservers
+  // in 'raw_info' without unbalancing their replica counts, as per the
+  // --auto_rebalancing_min_load_improvement flag.
+  void GetLoadBalancingMoves(
+      const rebalance::ClusterRawInfo& raw_info,
+      std::vector<rebalance::Rebalancer::ReplicaMove>* replica_moves) const;
+
   // Gets next set of replica moves for the auto-rebalancer task. The number of
   // moves that will be put into the parameter 'replica_moves' is limited by a
   // gflag that sets the maximum number of replica moves per server.
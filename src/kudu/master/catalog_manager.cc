@@ -42,6 +42,7 @@
 #include "kudu/master/catalog_manager.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <ctime>
@@ -98,6 +99,7 @@
 #include "kudu/hms/hms_catalog.h"
 #include "kudu/master/authz_provider.h"
 #include "kudu/master/auto_leader_rebalancer.h"
+#include "kudu/master/auto_range_partitioning.h"
 #include "kudu/master/auto_rebalancer.h"
 #include "kudu/master/default_authz_provider.h"
 #include "kudu/master/hms_notification_log_listener.h"
@@ -125,18 +127,23 @@
 #include "kudu/security/token_signing_key.h"
 #include "kudu/security/token_verifier.h" // IWYU pragma: keep
 #include "kudu/server/monitored_task.h"
+#include "kudu/tablet/column_stats.h"
 #include "kudu/tablet/metadata.pb.h"
 #include "kudu/tablet/ops/op_tracker.h"
 #include "kudu/tablet/tablet_replica.h"
 #include "kudu/tserver/tserver_admin.pb.h"
 #include "kudu/tserver/tserver_admin.proxy.h" // IWYU pragma: keep
 #include "kudu/util/cache_metrics.h"
+#include "kudu/util/compression/compression.pb.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/condition_variable.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/fault_injection.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
+#include "kudu/util/hyperloglog.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/mutex.h"
@@ -274,6 +281,19 @@ DEFINE_int32(table_locations_ttl_ms, 5 * 60 * 1000, // 5 minutes
 TAG_FLAG(table_locations_ttl_ms, advanced);
 TAG_FLAG(table_locations_ttl_ms, runtime);
 
+DEFINE_uint32(master_watch_table_locations_max_wait_ms, 60 * 1000,
+              "Maximum time in milliseconds the master waits for the locations "
+              "of a table to change before responding to a WatchTableLocations RPC.");
+TAG_FLAG(master_watch_table_locations_max_wait_ms, advanced);
+TAG_FLAG(master_watch_table_locations_max_wait_ms, runtime);
+
+DEFINE_uint32(master_table_locations_changes_to_retain, 1024,
+              "Number of the most recent changes of tablet locations the master "
+              "keeps per table for WatchTableLocations RPCs. Clients further "
+              "behind drop all the locations they cached for the table.");
+TAG_FLAG(master_table_locations_changes_to_retain, advanced);
+TAG_FLAG(master_table_locations_changes_to_retain, runtime);
+
 DEFINE_bool(catalog_manager_fail_ts_rpcs, false,
             "Whether all master->TS async calls should fail. Only for testing!");
 TAG_FLAG(catalog_manager_fail_ts_rpcs, hidden);
@@ -334,6 +354,15 @@ DEFINE_bool(catalog_manager_enable_chunked_tablet_reports, true,
 TAG_FLAG(catalog_manager_enable_chunked_tablet_reports, advanced);
 TAG_FLAG(catalog_manager_enable_chunked_tablet_reports, runtime);
 
+DEFINE_int32(catalog_manager_tablet_report_batch_size, 1000,
+             "Maximum number of tablets of a tablet report the catalog manager "
+             "locks and persists at once. Larger reports, e.g. the full reports "
+             "tablet servers send after a leader master election, are processed "
+             "in several batches. Only used if "
+             "--catalog_manager_enable_chunked_tablet_reports is set.");
+TAG_FLAG(catalog_manager_tablet_report_batch_size, advanced);
+TAG_FLAG(catalog_manager_tablet_report_batch_size, runtime);
+
 DEFINE_int64(on_disk_size_for_testing, 0,
              "Mock the on disk size of metrics for testing.");
 TAG_FLAG(on_disk_size_for_testing, hidden);
@@ -407,7 +436,8 @@ TAG_FLAG(metadata_for_deleted_table_and_tablet_reserved_secs, runtime);
 
 DEFINE_bool(enable_chunked_tablet_writes, true,
             "Whether to split tablet actions into chunks when persisting them in sys.catalog "
-            "table. If disabled, any update of the sys.catalog table will be rejected if exceeds "
+            "table, e.g. when creating a table with many tablets or cleaning up deleted ones. "
+            "If disabled, any update of the sys.catalog table will be rejected if exceeds "
             "--rpc_max_message_size.");
 TAG_FLAG(enable_chunked_tablet_writes, experimental);
 TAG_FLAG(enable_chunked_tablet_writes, runtime);
@@ -436,6 +466,50 @@ DEFINE_uint32(default_deleted_table_reserve_seconds, 0,
 TAG_FLAG(default_deleted_table_reserve_seconds, advanced);
 TAG_FLAG(default_deleted_table_reserve_seconds, runtime);
 
+DEFINE_bool(enable_auto_range_partitioning, true,
+            "Whether the leader master adds and drops the range partitions of "
+            "the tables configured with the 'kudu.table.auto_range_partition_interval_sec' "
+            "table property, as time goes by.");
+TAG_FLAG(enable_auto_range_partitioning, experimental);
+TAG_FLAG(enable_auto_range_partitioning, runtime);
+
+DEFINE_int32(auto_range_partitioning_check_period_sec, 60,
+             "How often, in seconds, the leader master checks whether range "
+             "partitions need to be added to or dropped from the tables with "
+             "automatic range partitioning.");
+TAG_FLAG(auto_range_partitioning_check_period_sec, experimental);
+TAG_FLAG(auto_range_partitioning_check_period_sec, runtime);
+
+DEFINE_int32(auto_range_partitions_ahead, 2,
+             "The number of range partitions created ahead of the one for the "
+             "current time, for the tables with automatic range partitioning. "
+             "Creating them early avoids hot-spotting the newest range partition "
+             "while its tablets are being created.");
+TAG_FLAG(auto_range_partitions_ahead, experimental);
+TAG_FLAG(auto_range_partitions_ahead, runtime);
+
+DEFINE_uint64(tablet_split_size_threshold_mb, 0,
+              "On-disk size in MiB from which a tablet is considered worth "
+              "splitting by the leader master, which reports it along with the "
+              "key to split it at. If 0, tablets are not considered for splitting "
+              "on account of their size.");
+TAG_FLAG(tablet_split_size_threshold_mb, experimental);
+TAG_FLAG(tablet_split_size_threshold_mb, runtime);
+
+DEFINE_double(tablet_split_write_rate_threshold, 0,
+              "Rate of rows written per second from which a tablet is considered "
+              "worth splitting by the leader master, which reports it along with "
+              "the key to split it at. If 0, tablets are not considered for "
+              "splitting on account of their write rate.");
+TAG_FLAG(tablet_split_write_rate_threshold, experimental);
+TAG_FLAG(tablet_split_write_rate_threshold, runtime);
+
+DEFINE_int32(tablet_split_check_period_sec, 60,
+             "How often, in seconds, the leader master looks for the tablets "
+             "worth splitting.");
+TAG_FLAG(tablet_split_check_period_sec, experimental);
+TAG_FLAG(tablet_split_check_period_sec, runtime);
+
 DECLARE_string(hive_metastore_uris);
 
 bool ValidateDeletedTableReserveSeconds()  {
@@ -785,6 +859,8 @@ void CatalogManagerBgTasks::Shutdown() {
 
 void CatalogManagerBgTasks::Run() {
   MonoTime last_tspk_run;
+  MonoTime last_auto_range_partitioning_run;
+  MonoTime last_tablet_split_check;
   while (!NoBarrier_Load(&closing_)) {
     {
       CatalogManager::ScopedLeaderSharedLock l(catalog_manager_);
@@ -835,6 +911,29 @@ void CatalogManagerBgTasks::Run() {
           }
         }
 
+        if (FLAGS_enable_auto_range_partitioning &&
+            (!last_auto_range_partitioning_run.Initialized() ||
+             MonoTime::Now() - last_auto_range_partitioning_run >
+                 MonoDelta::FromSeconds(FLAGS_auto_range_partitioning_check_period_sec))) {
+          Status s = catalog_manager_->ProcessAutoRangePartitions();
+          if (!s.ok()) {
+            LOG(WARNING) << "Error processing automatic range partitions: " << s.ToString();
+          }
+          last_auto_range_partitioning_run = MonoTime::Now();
+        }
+
+        if ((FLAGS_tablet_split_size_threshold_mb > 0 ||
+             FLAGS_tablet_split_write_rate_threshold > 0) &&
+            (!last_tablet_split_check.Initialized() ||
+             MonoTime::Now() - last_tablet_split_check >
+                 MonoDelta::FromSeconds(FLAGS_tablet_split_check_period_sec))) {
+          Status s = catalog_manager_->ProcessTabletSplitCandidates();
+          if (!s.ok()) {
+            LOG(WARNING) << "Error looking for tablets to split: " << s.ToString();
+          }
+          last_tablet_split_check = MonoTime::Now();
+        }
+
         // If this is the leader master, check if it's time to generate
         // and store a new TSK (Token Signing Key).
         Status s = catalog_manager_->TryGenerateNewTskUnlocked();
@@ -1385,7 +1484,7 @@ Status CatalogManager::InitTokenSigner() {
 void CatalogManager::PrepareForLeadershipTask() {
   {
     // Hack to block this function until InitSysCatalogAsync() is finished.
-    shared_lock<LockType> l(lock_);
+    shared_lock<rw_spinlock> l(lock_.get_lock());
   }
   const RaftConsensus* consensus = sys_catalog_->tablet_replica()->consensus();
   const int64_t term_before_wait = consensus->CurrentTerm();
@@ -1652,6 +1751,7 @@ Status CatalogManager::VisitTablesAndTabletsUnlocked() {
   TabletLoader tablet_loader(this);
   RETURN_NOT_OK_PREPEND(sys_catalog_->VisitTablets(&tablet_loader),
                         "Failed while visiting tablets in sys catalog");
+  tablet_loader.Finish();
   return Status::OK();
 }
 
@@ -1733,7 +1833,7 @@ void CatalogManager::Shutdown() {
   // tasks for those entries.
   vector<scoped_refptr<TableInfo>> copy;
   {
-    shared_lock<LockType> l(lock_);
+    shared_lock<rw_spinlock> l(lock_.get_lock());
     AppendValuesFromMap(table_ids_map_, &copy);
   }
   AbortAndWaitForAllTasks(copy);
@@ -1863,7 +1963,7 @@ Status ValidateClientSchema(const optional<string>& name,
   for (int i = 0; i < schema.num_key_columns(); i++) {
     if (!IsTypeAllowableInKey(schema.column(i).type_info())) {
       return Status::InvalidArgument(
-          "key column may not have type of BOOL, FLOAT, or DOUBLE");
+          "key column may not have type of BOOL, FLOAT, DOUBLE, ARRAY, or JSON");
     }
   }
 
@@ -1884,6 +1984,15 @@ Status ValidateClientSchema(const optional<string>& name,
     if (!s.ok()) {
       return s.CloneAndPrepend(Substitute("invalid encoding for column '$0'", col.name()));
     }
+
+    // Check the compression level up front: the tablet servers would only
+    // find out when flushing the column.
+    s = ValidateCompressionLevel(col.attributes().compression,
+                                 col.attributes().compression_level);
+    if (!s.ok()) {
+      return s.CloneAndPrepend(Substitute("invalid compression level for column '$0'",
+                                          col.name()));
+    }
   }
   return Status::OK();
 }
@@ -2161,11 +2270,19 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
   });
 
   // f. Write table and tablets to sys-catalog.
+  //
+  // The tablets of a table with many of them may not fit into a single write.
+  // In that case they're written in chunks, followed by the table: until the
+  // table is written, the tablets written so far are ignored when loading the
+  // sys-catalog, so a failure in between doesn't expose a partial table.
   {
     SysCatalogTable::Actions actions;
     actions.table_to_add = table;
     actions.tablets_to_add = tablets;
-    Status s = sys_catalog_->Write(std::move(actions));
+    const auto write_mode = FLAGS_enable_chunked_tablet_writes
+        ? SysCatalogTable::WriteMode::CHUNKED
+        : SysCatalogTable::WriteMode::ATOMIC;
+    Status s = sys_catalog_->Write(std::move(actions), write_mode);
     if (PREDICT_FALSE(!s.ok())) {
       s = s.CloneAndPrepend("an error occurred while writing to the sys-catalog");
       LOG(WARNING) << s.ToString();
@@ -2374,7 +2491,7 @@ Status CatalogManager::FindLockAndAuthorizeTable(
   // Set to true if the client-provided table name and ID refer to different tables.
   scoped_refptr<TableInfo> table_with_mismatched_name;
   {
-    shared_lock<LockType> l(lock_);
+    shared_lock<rw_spinlock> l(lock_.get_lock());
     if (table_identifier.has_table_id()) {
       table = FindPtrOrNull(table_ids_map_, table_identifier.table_id());
 
@@ -4043,7 +4160,7 @@ Status CatalogManager::ListTables(const ListTablesRequestPB* req,
     if (req->has_show_soft_deleted()) {
       show_soft_deleted = req->show_soft_deleted();
     }
-    shared_lock<LockType> l(lock_);
+    shared_lock<rw_spinlock> l(lock_.get_lock());
     if (show_soft_deleted) {
       for (const auto& entry : soft_deleted_table_names_map_) {
         tables_info.emplace_back(entry.second);
@@ -4195,6 +4312,51 @@ Status CatalogManager::GetTableStatistics(const GetTableStatisticsRequestPB* req
       resp->set_row_count_limit(TableInfo::TABLE_WRITE_DEFAULT_LIMIT);
     }
   }
+
+  // Aggregate the statistics of the columns the non-empty tablets reported.
+  Schema schema;
+  RETURN_NOT_OK(SchemaFromPB(l.data().pb.schema(), &schema));
+  vector<scoped_refptr<TabletInfo>> tablets;
+  table->GetAllTablets(&tablets);
+  unordered_map<int32_t, tablet::ColumnStatsPB> stats_by_column_id;
+  unordered_map<int32_t, int> num_merged_by_column_id;
+  int num_tablets = 0;
+  for (const auto& tablet_info : tablets) {
+    const auto stats = tablet_info->GetStats();
+    if (stats.num_rowsets() == 0) {
+      continue;
+    }
+    ++num_tablets;
+    RETURN_NOT_OK(tablet::MergeColumnStats(stats.column_stats(), schema,
+                                           &stats_by_column_id, &num_merged_by_column_id));
+  }
+  for (size_t col_idx = 0; num_tablets > 0 && col_idx < schema.num_columns(); ++col_idx) {
+    const int32_t column_id = schema.column_id(col_idx);
+    if (FindWithDefault(num_merged_by_column_id, column_id, 0) != num_tablets) {
+      continue;
+    }
+    const auto& column_stats = stats_by_column_id[column_id];
+    HyperLogLog ndv_sketch;
+    RETURN_NOT_OK(HyperLogLog::FromRegisters(column_stats.ndv_sketch(), &ndv_sketch));
+    const ColumnSchema& col = schema.column(col_idx);
+    auto* column_statistics = resp->add_column_statistics();
+    column_statistics->set_column_name(col.name());
+    column_statistics->set_type(col.type_info()->type());
+    if (col.type_info()->type() == DECIMAL32 ||
+        col.type_info()->type() == DECIMAL64 ||
+        col.type_info()->type() == DECIMAL128) {
+      auto* type_attributes = column_statistics->mutable_type_attributes();
+      type_attributes->set_precision(col.type_attributes().precision);
+      type_attributes->set_scale(col.type_attributes().scale);
+    }
+    column_statistics->set_null_count(column_stats.null_count());
+    column_statistics->set_distinct_count(
+        std::min<int64_t>(ndv_sketch.Estimate(), column_stats.value_count()));
+    if (column_stats.has_min_value()) {
+      column_statistics->set_min_value(column_stats.min_value());
+      column_statistics->set_max_value(column_stats.max_value());
+    }
+  }
   return Status::OK();
 }
 
@@ -4250,7 +4412,7 @@ bool CatalogManager::IsTableWriteDisabled(const scoped_refptr<TableInfo>& table,
 Status CatalogManager::GetTableInfo(const string& table_id, scoped_refptr<TableInfo> *table) {
   leader_lock_.AssertAcquiredForReading();
 
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   *table = FindPtrOrNull(table_ids_map_, table_id);
   return Status::OK();
 }
@@ -4259,7 +4421,7 @@ void CatalogManager::GetTableInfoByName(const string& table_name,
                                         scoped_refptr<TableInfo> *table) {
   leader_lock_.AssertAcquiredForReading();
 
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   *table = FindPtrOrNull(normalized_table_names_map_, table_name);
 }
 
@@ -4267,7 +4429,7 @@ void CatalogManager::GetAllTables(vector<scoped_refptr<TableInfo>>* tables) {
   leader_lock_.AssertAcquiredForReading();
 
   tables->clear();
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   AppendValuesFromMap(table_ids_map_, tables);
 }
 
@@ -4275,14 +4437,14 @@ void CatalogManager::GetAllTabletsForTests(vector<scoped_refptr<TabletInfo>>* ta
   leader_lock_.AssertAcquiredForReading();
 
   tablets->clear();
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   AppendValuesFromMap(tablet_map_, tablets);
 }
 
 Status CatalogManager::TableNameExists(const string& table_name, bool* exists) {
   leader_lock_.AssertAcquiredForReading();
 
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   scoped_refptr<TableInfo> table = FindTableWithNameUnlocked(table_name);
   *exists = (table != nullptr);
   return Status::OK();
@@ -4321,7 +4483,7 @@ Status CatalogManager::GetTabletReplica(const string& tablet_id,
                                         scoped_refptr<TabletReplica>* replica) const {
   // Note: CatalogManager has only one table, 'sys_catalog', with only
   // one tablet.
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   if (!sys_catalog_) {
     return Status::ServiceUnavailable("Systable not yet initialized");
   }
@@ -4337,7 +4499,7 @@ Status CatalogManager::GetTabletReplica(const string& tablet_id,
 void CatalogManager::GetTabletReplicas(vector<scoped_refptr<TabletReplica>>* replicas) const {
   // Note: CatalogManager has only one table, 'sys_catalog', with only
   // one tablet.
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   if (!sys_catalog_) {
     return;
   }
@@ -5259,6 +5421,31 @@ Status CatalogManager::ProcessTabletReport(
   // reported, and somehow mark any that have been "lost" (eg somehow the
   // tablet metadata got corrupted or something).
 
+  full_report_update->mutable_tablets()->Reserve(num_tablets);
+
+  // A report which isn't persisted atomically doesn't need to be processed
+  // atomically either: bound the number of tablets locked, and so the time
+  // the other reports of their replicas wait for them.
+  const int batch_size = FLAGS_catalog_manager_enable_chunked_tablet_reports
+      ? std::max(1, FLAGS_catalog_manager_tablet_report_batch_size)
+      : std::max(1, num_tablets);
+  for (int begin = 0; begin < num_tablets; begin += batch_size) {
+    RETURN_NOT_OK(ProcessTabletReportBatch(
+        ts_desc, full_report, begin, std::min(begin + batch_size, num_tablets),
+        full_report_update, rpc));
+  }
+  return Status::OK();
+}
+
+Status CatalogManager::ProcessTabletReportBatch(
+    TSDescriptor* ts_desc,
+    const TabletReportPB& full_report,
+    int begin,
+    int end,
+    TabletReportUpdatesPB* full_report_update,
+    RpcContext* rpc) {
+  leader_lock_.AssertAcquiredForReading();
+
   // Maps a tablet ID to its corresponding tablet report (owned by 'full_report').
   unordered_map<string, const ReportedTabletPB*> reports;
 
@@ -5288,13 +5475,13 @@ Status CatalogManager::ProcessTabletReport(
   TabletMetadataGroupLock tablets_lock(LockMode::RELEASED);
 
   // 1. Set up local state.
-  full_report_update->mutable_tablets()->Reserve(num_tablets);
   {
     // We only need to acquire lock_ for the tablet_map_ access, but since it's
     // acquired exclusively so rarely, it's probably cheaper to acquire and
     // hold it for all tablets here than to acquire/release it for each tablet.
-    shared_lock<LockType> l(lock_);
-    for (const ReportedTabletPB& report : full_report.updated_tablets()) {
+    shared_lock<rw_spinlock> l(lock_.get_lock());
+    for (int i = begin; i < end; ++i) {
+      const ReportedTabletPB& report = full_report.updated_tablets(i);
       const string& tablet_id = report.tablet_id();
 
       // 1a. Prepare an update entry for this tablet. Every tablet in the
@@ -5335,6 +5522,7 @@ Status CatalogManager::ProcessTabletReport(
   // appear in 'full_report', but that has no bearing on correctness.
   vector<scoped_refptr<TabletInfo>> mutated_tablets;
   unordered_set<string> mutated_table_ids;
+  vector<scoped_refptr<TabletInfo>> tablets_with_new_cstate;
   unordered_set<string> uuids_ignored_for_underreplication =
       master_->ts_manager()->GetUuidsToIgnoreForUnderreplication();
   for (const auto& e : tablet_infos) {
@@ -5492,6 +5680,7 @@ Status CatalogManager::ProcessTabletReport(
           peer.clear_health_report();
         }
         tablet_was_mutated = true;
+        tablets_with_new_cstate.push_back(tablet);
 
         // 7d(iii). Delete any replicas from the previous config that are not
         // in the new one.
@@ -5674,6 +5863,12 @@ Status CatalogManager::ProcessTabletReport(
     }
   }
 
+  // 17. Notify the watchers of the locations of the tablets whose consensus
+  // state changed.
+  for (const auto& tablet : tablets_with_new_cstate) {
+    tablet->table()->LocationsChanged(tablet->id());
+  }
+
   return Status::OK();
 }
 
@@ -5718,7 +5913,7 @@ std::shared_ptr<RaftConsensus> CatalogManager::master_consensus() const {
   // CatalogManager::InitSysCatalogAsync takes lock_ in exclusive mode in order
   // to initialize sys_catalog_, so it's sufficient to take lock_ in shared mode
   // here to protect access to sys_catalog_.
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   if (!sys_catalog_) {
     return nullptr;
   }
@@ -5775,7 +5970,7 @@ void CatalogManager::SendDeleteTabletRequest(const scoped_refptr<TabletInfo>& ta
 void CatalogManager::ExtractTabletsToProcess(
     vector<scoped_refptr<TabletInfo>>* tablets_to_process) {
 
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
 
   // TODO: At the moment we loop through all the tablets
   //       we can keep a set of tablets waiting for "assignment"
@@ -5807,7 +6002,7 @@ void CatalogManager::ExtractTabletsToProcess(
 void CatalogManager::ExtractDeletedTablesAndTablets(
     vector<scoped_refptr<TableInfo>>* deleted_tables,
     vector<scoped_refptr<TabletInfo>>* deleted_tablets) {
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   for (const auto& table_entry : table_ids_map_) {
     scoped_refptr<TableInfo> table = table_entry.second;
     TableMetadataLock table_lock(table.get(), LockMode::READ);
@@ -5825,6 +6020,218 @@ void CatalogManager::ExtractDeletedTablesAndTablets(
   }
 }
 
+namespace {
+
+// Decodes the value of the range partition column 'col_idx' of 'schema' from
+// 'range_key', a range partition key of a table partitioned on that single
+// UNIXTIME_MICROS column. An empty key is an infinite bound.
+Status DecodeTimeRangeBound(const PartitionSchema& partition_schema,
+                            const Schema& schema,
+                            int col_idx,
+                            const string& range_key,
+                            Arena* arena,
+                            optional<int64_t>* bound) {
+  if (range_key.empty()) {
+    bound->reset();
+    return Status::OK();
+  }
+  KuduPartialRow row(&schema);
+  Slice key(range_key);
+  RETURN_NOT_OK(partition_schema.DecodeRangeKey(&key, &row, arena));
+  int64_t micros;
+  RETURN_NOT_OK(row.GetUnixTimeMicros(col_idx, &micros));
+  *bound = micros;
+  return Status::OK();
+}
+
+// Adds a step of 'type' for 'range' to 'req', with the UNIXTIME_MICROS column
+// 'col_idx' of 'client_schema' as the range partition column.
+Status AddTimeRangeStep(AlterTableRequestPB::StepType type,
+                        const TimeRange& range,
+                        const Schema& client_schema,
+                        int col_idx,
+                        AlterTableRequestPB* req) {
+  KuduPartialRow lower(&client_schema);
+  if (range.lower) {
+    RETURN_NOT_OK(lower.SetUnixTimeMicros(col_idx, *range.lower));
+  }
+  KuduPartialRow upper(&client_schema);
+  if (range.upper) {
+    RETURN_NOT_OK(upper.SetUnixTimeMicros(col_idx, *range.upper));
+  }
+  auto* step = req->add_alter_schema_steps();
+  step->set_type(type);
+  RowOperationsPBEncoder encoder(type == AlterTableRequestPB::ADD_RANGE_PARTITION
+      ? step->mutable_add_range_partition()->mutable_range_bounds()
+      : step->mutable_drop_range_partition()->mutable_range_bounds());
+  encoder.Add(RowOperationsPB::RANGE_LOWER_BOUND, lower);
+  encoder.Add(RowOperationsPB::RANGE_UPPER_BOUND, upper);
+  return Status::OK();
+}
+
+} // anonymous namespace
+
+Status CatalogManager::ProcessAutoRangePartitions() {
+  leader_lock_.AssertAcquiredForReading();
+
+  vector<scoped_refptr<TableInfo>> tables;
+  {
+    shared_lock<rw_spinlock> l(lock_.get_lock());
+    for (const auto& table_entry : table_ids_map_) {
+      TableMetadataLock table_lock(table_entry.second.get(), LockMode::READ);
+      if (table_lock.data().is_running() && !table_lock.data().is_soft_deleted() &&
+          table_lock.data().pb.extra_config().has_auto_range_partition_interval_sec()) {
+        tables.emplace_back(table_entry.second);
+      }
+    }
+  }
+
+  Status first_error;
+  for (const auto& table : tables) {
+    Status s = RollAutoRangePartitions(table);
+    if (!s.ok()) {
+      LOG(WARNING) << Substitute("failed to roll the range partitions of table $0: $1",
+                                 table->ToString(), s.ToString());
+      if (first_error.ok()) {
+        first_error = s;
+      }
+    }
+  }
+  return first_error;
+}
+
+Status CatalogManager::RollAutoRangePartitions(const scoped_refptr<TableInfo>& table) {
+  AlterTableRequestPB req;
+  {
+    TableMetadataLock l(table.get(), LockMode::READ);
+    const auto& extra_config = l.data().pb.extra_config();
+    Schema schema;
+    RETURN_NOT_OK(SchemaFromPB(l.data().pb.schema(), &schema));
+    PartitionSchema partition_schema;
+    RETURN_NOT_OK(PartitionSchema::FromPB(l.data().pb.partition_schema(), schema,
+                                          &partition_schema));
+    const auto& range_column_ids = partition_schema.range_schema().column_ids;
+    const int col_idx = range_column_ids.size() == 1
+        ? schema.find_column_by_id(range_column_ids[0])
+        : static_cast<int>(Schema::kColumnNotFound);
+    if (col_idx == Schema::kColumnNotFound ||
+        schema.column(col_idx).type_info()->type() != UNIXTIME_MICROS) {
+      return Status::NotSupported(
+          "automatic range partitioning requires a single UNIXTIME_MICROS "
+          "range partition column");
+    }
+
+    // Collect the ranges of the table's tablets: with hash partitioning,
+    // each range is repeated for every bucket.
+    vector<TimeRange> existing;
+    Arena arena(256);
+    for (const auto& tablet_entry : table->tablet_map()) {
+      TabletMetadataLock tablet_lock(tablet_entry.second.get(), LockMode::READ);
+      if (tablet_lock.data().is_deleted()) {
+        continue;
+      }
+      Partition partition;
+      Partition::FromPB(tablet_lock.data().pb.partition(), &partition);
+      TimeRange range;
+      RETURN_NOT_OK(DecodeTimeRangeBound(partition_schema, schema, col_idx,
+                                         partition.begin().range_key(), &arena, &range.lower));
+      RETURN_NOT_OK(DecodeTimeRangeBound(partition_schema, schema, col_idx,
+                                         partition.end().range_key(), &arena, &range.upper));
+      existing.emplace_back(range);
+    }
+
+    constexpr int64_t kMicrosPerSecond = 1000L * 1000L;
+    optional<int64_t> retention_us;
+    if (extra_config.has_auto_range_partition_retention_sec()) {
+      retention_us = extra_config.auto_range_partition_retention_sec() * kMicrosPerSecond;
+    }
+    vector<TimeRange> to_add;
+    vector<TimeRange> to_drop;
+    ComputeAutoRangePartitionChanges(
+        existing, GetCurrentTimeMicros(),
+        extra_config.auto_range_partition_interval_sec() * kMicrosPerSecond,
+        retention_us, FLAGS_auto_range_partitions_ahead, &to_add, &to_drop);
+    if (to_add.empty() && to_drop.empty()) {
+      return Status::OK();
+    }
+
+    const Schema client_schema = schema.CopyWithoutColumnIds();
+    req.mutable_table()->set_table_id(table->id());
+    req.mutable_table()->set_table_name(l.data().name());
+    RETURN_NOT_OK(SchemaToPB(client_schema, req.mutable_schema()));
+    for (const auto& range : to_drop) {
+      LOG(INFO) << Substitute("dropping range partition $0 of table $1 past its retention",
+                              range.ToString(), table->ToString());
+      RETURN_NOT_OK(AddTimeRangeStep(AlterTableRequestPB::DROP_RANGE_PARTITION, range,
+                                     client_schema, col_idx, &req));
+    }
+    for (const auto& range : to_add) {
+      LOG(INFO) << Substitute("adding range partition $0 to table $1",
+                              range.ToString(), table->ToString());
+      RETURN_NOT_OK(AddTimeRangeStep(AlterTableRequestPB::ADD_RANGE_PARTITION, range,
+                                     client_schema, col_idx, &req));
+    }
+  }
+
+  AlterTableResponsePB resp;
+  return AlterTable(req, &resp, /*hms_notification_log_event_id=*/nullopt, /*user=*/nullopt);
+}
+
+Status CatalogManager::ProcessTabletSplitCandidates() {
+  leader_lock_.AssertAcquiredForReading();
+
+  vector<scoped_refptr<TableInfo>> tables;
+  {
+    shared_lock<rw_spinlock> l(lock_.get_lock());
+    for (const auto& table_entry : table_ids_map_) {
+      TableMetadataLock table_lock(table_entry.second.get(), LockMode::READ);
+      if (table_lock.data().is_running() && !table_lock.data().is_soft_deleted()) {
+        tables.emplace_back(table_entry.second);
+      }
+    }
+  }
+
+  const uint64_t size_threshold = FLAGS_tablet_split_size_threshold_mb * 1024 * 1024;
+  const double write_rate_threshold = FLAGS_tablet_split_write_rate_threshold;
+  for (const auto& table : tables) {
+    TableMetadataLock l(table.get(), LockMode::READ);
+    Schema schema;
+    RETURN_NOT_OK(SchemaFromPB(l.data().pb.schema(), &schema));
+    uint32_t num_candidates = 0;
+    for (const auto& tablet_entry : table->tablet_map()) {
+      const auto& tablet = tablet_entry.second;
+      TabletMetadataLock tablet_lock(tablet.get(), LockMode::READ);
+      if (tablet_lock.data().is_deleted()) {
+        continue;
+      }
+      // Without a split key, the leader replica deemed the tablet too small to
+      // be split, or couldn't find how to split it.
+      const auto stats = tablet->GetStats();
+      if (!stats.has_split_key()) {
+        continue;
+      }
+      const bool oversized = size_threshold > 0 && stats.on_disk_size() >= size_threshold;
+      const bool hot = write_rate_threshold > 0 && stats.write_rate() >= write_rate_threshold;
+      if (!oversized && !hot) {
+        continue;
+      }
+      ++num_candidates;
+      VLOG(1) << Substitute(
+          "tablet $0 of table $1 ($2 bytes, $3 rows written/s) could be split at key $4",
+          tablet->id(), table->ToString(), stats.on_disk_size(), stats.write_rate(),
+          KUDU_REDACT(schema.DebugEncodedRowKey(stats.split_key(), Schema::START_KEY)));
+    }
+    if (const auto* metrics = table->GetMetrics(); metrics) {
+      if (metrics->tablets_to_split->value() != num_candidates) {
+        LOG(INFO) << Substitute("table $0 has $1 tablet(s) worth splitting",
+                                table->ToString(), num_candidates);
+      }
+      metrics->tablets_to_split->set_value(num_candidates);
+    }
+  }
+  return Status::OK();
+}
+
 // Check if it's time to roll TokenSigner's key. There's a bit of subtlety here:
 // we shouldn't start exporting a key until it is properly persisted.
 // So, the protocol is:
@@ -6419,6 +6826,10 @@ Status CatalogManager::BuildLocationsForTablet(
 
   locs_pb->mutable_partition()->CopyFrom(tablet->metadata().state().pb.partition());
   locs_pb->set_tablet_id(tablet->id());
+  ReportedTabletStatsPB stats = tablet->GetStats();
+  if (stats.has_on_disk_size()) {
+    *locs_pb->mutable_stats() = std::move(stats);
+  }
 
   // No longer used; always set to false.
   locs_pb->set_deprecated_stale(false);
@@ -6438,7 +6849,7 @@ Status CatalogManager::GetTabletLocations(const string& tablet_id,
   locs_pb->mutable_interned_replicas()->Clear();
   scoped_refptr<TabletInfo> tablet_info;
   {
-    shared_lock<LockType> l(lock_);
+    shared_lock<rw_spinlock> l(lock_.get_lock());
     // It's OK to return NOT_FOUND back to the client, even with authorization enabled,
     // because tablet IDs are randomly generated and don't carry user data.
     if (!FindCopy(tablet_map_, tablet_id, &tablet_info)) {
@@ -6465,7 +6876,7 @@ Status CatalogManager::ReplaceTablet(const string& tablet_id, ReplaceTabletRespo
   // Lookup the tablet-to-be-replaced and get its table.
   scoped_refptr<TabletInfo> old_tablet;
   {
-    shared_lock<LockType> l(lock_);
+    shared_lock<rw_spinlock> l(lock_.get_lock());
     if (!FindCopy(tablet_map_, tablet_id, &old_tablet)) {
       return Status::NotFound(Substitute("Unknown tablet $0", tablet_id));
     }
@@ -6658,6 +7069,101 @@ Status CatalogManager::GetTableLocations(const GetTableLocationsRequestPB* req,
   return Status::OK();
 }
 
+Status CatalogManager::WatchTableLocations(const WatchTableLocationsRequestPB* req,
+                                           WatchTableLocationsResponsePB* resp,
+                                           rpc::RpcContext* rpc,
+                                           bool use_external_addr,
+                                           const optional<string>& user) {
+  leader_lock_.AssertAcquiredForReading();
+
+  scoped_refptr<TableInfo> table;
+  {
+    TableMetadataLock l;
+    auto authz_func = [&] (const string& username, const string& table_name,
+                           const string& owner) {
+      return SetupError(authz_provider_->AuthorizeGetTableMetadata(table_name, username,
+                                                                   username == owner),
+                        resp, MasterErrorPB::NOT_AUTHORIZED);
+    };
+    RETURN_NOT_OK(FindLockAndAuthorizeTable(
+        *req, resp, LockMode::READ, authz_func, user, &table, &l));
+    RETURN_NOT_OK(CheckIfTableDeletedOrNotRunning(&l, resp));
+  }
+
+  if (!req->has_known_version()) {
+    RespondToLocationsWatch(table, req, resp, rpc, use_external_addr);
+    return Status::OK();
+  }
+
+  // The watch is responded to exactly once: either by the watcher, when the
+  // locations change, or by the timer.
+  auto responded = std::make_shared<std::atomic<bool>>(false);
+  const int64_t watcher_id = table->AddLocationsWatcher(
+      req->known_version(),
+      [this, table, req, resp, rpc, use_external_addr, responded]() {
+        if (!responded->exchange(true)) {
+          RespondToLocationsWatch(table, req, resp, rpc, use_external_addr);
+        }
+      });
+  if (watcher_id < 0) {
+    RespondToLocationsWatch(table, req, resp, rpc, use_external_addr);
+    return Status::OK();
+  }
+  const auto wait_ms = std::min(req->max_wait_ms(),
+                                FLAGS_master_watch_table_locations_max_wait_ms);
+  master_->messenger()->ScheduleOnReactor(
+      [table, resp, rpc, watcher_id, responded](const Status& /* s */) {
+        table->RemoveLocationsWatcher(watcher_id);
+        if (!responded->exchange(true)) {
+          resp->set_version(table->locations_version());
+          rpc->RespondSuccess();
+        }
+      },
+      MonoDelta::FromMilliseconds(wait_ms));
+  return Status::OK();
+}
+
+void CatalogManager::RespondToLocationsWatch(const scoped_refptr<TableInfo>& table,
+                                             const WatchTableLocationsRequestPB* req,
+                                             WatchTableLocationsResponsePB* resp,
+                                             rpc::RpcContext* rpc,
+                                             bool use_external_addr) {
+  if (!req->has_known_version()) {
+    resp->set_version(table->locations_version());
+    rpc->RespondSuccess();
+    return;
+  }
+  int64_t version;
+  vector<string> tablet_ids;
+  if (!table->GetLocationsChanges(req->known_version(), &version, &tablet_ids)) {
+    resp->set_full_refresh_required(true);
+  }
+  resp->set_version(version);
+
+  TSInfosDict infos_dict(resp->GetArena());
+  for (const auto& tablet_id : tablet_ids) {
+    scoped_refptr<TabletInfo> tablet;
+    {
+      shared_lock<rw_spinlock> l(lock_.get_lock());
+      if (!FindCopy(tablet_map_, tablet_id, &tablet)) {
+        // The tablet was deleted: the clients find out once they use it.
+        continue;
+      }
+    }
+    TabletLocationsPB locs_pb;
+    if (BuildLocationsForTablet(tablet, req->replica_type_filter(), use_external_addr,
+                                &locs_pb, &infos_dict).ok()) {
+      *resp->add_tablet_locations() = std::move(locs_pb);
+    }
+  }
+  resp->mutable_ts_infos()->Reserve(infos_dict.ts_info_pbs().size());
+  for (auto* pb : infos_dict.ts_info_pbs()) {
+    DCHECK_EQ(pb->GetArena(), resp->GetArena());
+    resp->mutable_ts_infos()->AddAllocated(pb);
+  }
+  rpc->RespondSuccess();
+}
+
 void CatalogManager::DumpState(std::ostream* out) const {
   TableInfoMap ids_copy, names_copy;
   TabletInfoMap tablets_copy;
@@ -6665,7 +7171,7 @@ void CatalogManager::DumpState(std::ostream* out) const {
   // Copy the internal state so that, if the output stream blocks,
   // we don't end up holding the lock for a long time.
   {
-    shared_lock<LockType> l(lock_);
+    shared_lock<rw_spinlock> l(lock_.get_lock());
     ids_copy = table_ids_map_;
     names_copy = normalized_table_names_map_;
     tablets_copy = tablet_map_;
@@ -7053,7 +7559,7 @@ Status CatalogManager::GetTableStates(const TableIdentifierPB& table_identifier,
   scoped_refptr<TableInfo> table_info;
   *is_soft_deleted_table = false;
   // Confirm the table really exists in the system catalog.
-  shared_lock<LockType> l(lock_);
+  shared_lock<rw_spinlock> l(lock_.get_lock());
   scoped_refptr<TableInfo> table_by_name;
   scoped_refptr<TableInfo> table_by_id;
   if (table_identifier.has_table_name()) {
@@ -7306,7 +7812,10 @@ void PersistentTabletInfo::set_state(SysTabletsEntryPB::State state, const strin
 // TableInfo
 ////////////////////////////////////////////////////////////
 
-TableInfo::TableInfo(string table_id) : table_id_(std::move(table_id)) {}
+TableInfo::TableInfo(string table_id)
+    : table_id_(std::move(table_id)),
+      locations_version_(GetCurrentTimeMicros()) {
+}
 
 TableInfo::~TableInfo() {
   // Abort and wait for all pending tasks completed.
@@ -7543,6 +8052,78 @@ void TableInfo::GetAllTablets(vector<scoped_refptr<TabletInfo>>* ret) const {
   }
 }
 
+void TableInfo::LocationsChanged(const string& tablet_id) {
+  std::map<int64_t, std::function<void()>> watchers;
+  {
+    std::lock_guard<simple_spinlock> l(locations_lock_);
+    locations_changes_.emplace_back(++locations_version_, tablet_id);
+    while (locations_changes_.size() > FLAGS_master_table_locations_changes_to_retain) {
+      locations_changes_.pop_front();
+    }
+    watchers.swap(locations_watchers_);
+  }
+  for (auto& e : watchers) {
+    e.second();
+  }
+}
+
+int64_t TableInfo::locations_version() const {
+  std::lock_guard<simple_spinlock> l(locations_lock_);
+  return locations_version_;
+}
+
+bool TableInfo::GetLocationsChanges(int64_t since,
+                                    int64_t* version,
+                                    vector<string>* tablet_ids) const {
+  tablet_ids->clear();
+  std::lock_guard<simple_spinlock> l(locations_lock_);
+  *version = locations_version_;
+  if (since > locations_version_) {
+    return false;
+  }
+  if (since == locations_version_) {
+    return true;
+  }
+  // The changes are numbered consecutively: the ones after 'since' are known
+  // if the oldest one retained is at most the one right after it.
+  if (locations_changes_.empty() || locations_changes_.front().first > since + 1) {
+    return false;
+  }
+  unordered_set<string> seen;
+  for (auto it = locations_changes_.rbegin();
+       it != locations_changes_.rend() && it->first > since; ++it) {
+    if (seen.emplace(it->second).second) {
+      tablet_ids->emplace_back(it->second);
+    }
+  }
+  return true;
+}
+
+int64_t TableInfo::AddLocationsWatcher(int64_t version, std::function<void()> watcher) {
+  std::lock_guard<simple_spinlock> l(locations_lock_);
+  if (version != locations_version_) {
+    return -1;
+  }
+  const int64_t id = next_locations_watcher_id_++;
+  EmplaceOrDie(&locations_watchers_, id, std::move(watcher));
+  return id;
+}
+
+void TableInfo::RemoveLocationsWatcher(int64_t id) {
+  std::function<void()> watcher;
+  {
+    std::lock_guard<simple_spinlock> l(locations_lock_);
+    auto it = locations_watchers_.find(id);
+    if (it == locations_watchers_.end()) {
+      return;
+    }
+    // Destroy the watcher outside the lock: it may hold the last reference
+    // to objects which lock it again.
+    watcher = std::move(it->second);
+    locations_watchers_.erase(it);
+  }
+}
+
 void TableInfo::RegisterMetrics(MetricRegistry* metric_registry, const string& table_name) {
   if (metric_registry) {
     MetricEntity::AttributeMap attrs;
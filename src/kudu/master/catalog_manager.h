@@ -21,6 +21,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <iosfwd>
 #include <map>
@@ -367,6 +368,29 @@ class TableInfo : public RefCountedThreadSafe<TableInfo> {
   // Fills the vector with all tablets in partition key sorted order.
   void GetAllTablets(std::vector<scoped_refptr<TabletInfo>>* ret) const;
 
+  // Records that the locations of the tablet with ID 'tablet_id' changed,
+  // bumping the version of the locations of the table, and runs the watchers
+  // of the locations of the table.
+  void LocationsChanged(const std::string& tablet_id);
+
+  // Returns the current version of the locations of the table.
+  int64_t locations_version() const;
+
+  // Sets 'version' to the current version of the locations of the table, and
+  // 'tablet_ids' to the IDs of the tablets whose locations changed after
+  // version 'since'. Returns false if the changes after 'since' aren't known.
+  bool GetLocationsChanges(int64_t since,
+                           int64_t* version,
+                           std::vector<std::string>* tablet_ids) const;
+
+  // Registers 'watcher' to run once the locations of the table change after
+  // version 'version', and returns the ID of the registration. Returns -1
+  // without registering 'watcher' if they already changed.
+  int64_t AddLocationsWatcher(int64_t version, std::function<void()> watcher);
+
+  // Unregisters the watcher with the ID 'id', if it hasn't run yet.
+  void RemoveLocationsWatcher(int64_t id);
+
   // Access the persistent metadata. Typically you should use
   // TableMetadataLock to gain access to this data.
   const CowObject<PersistentTableInfo>& metadata() const { return metadata_; }
@@ -477,6 +501,22 @@ class TableInfo : public RefCountedThreadSafe<TableInfo> {
   scoped_refptr<MetricEntity> metric_entity_;
   std::unique_ptr<TableMetrics> metrics_;
 
+  // Protects the fields below.
+  mutable simple_spinlock locations_lock_;
+
+  // The version of the locations of the table. It starts from the time the
+  // TableInfo is created, so that versions handed out by a previous leader
+  // master are unlikely to be mistaken for current ones.
+  int64_t locations_version_;
+
+  // The most recent changes of locations, as (version, tablet ID) pairs in
+  // version order.
+  std::deque<std::pair<int64_t, std::string>> locations_changes_;
+
+  // The watchers of the locations of the table, by registration ID.
+  std::map<int64_t, std::function<void()>> locations_watchers_;
+  int64_t next_locations_watcher_id_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(TableInfo);
 };
 
@@ -768,6 +808,18 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
                            bool use_external_addr,
                            const std::optional<std::string>& user);
 
+  // Watch the locations of the table in the request. If 'user' is provided,
+  // checks that the user is authorized to get such information.
+  //
+  // On success, 'rpc' is responded to once the locations of the table change
+  // after the version in the request, or once the requested wait elapses: the
+  // caller must not respond to it. On failure, the caller must respond to it.
+  Status WatchTableLocations(const WatchTableLocationsRequestPB* req,
+                             WatchTableLocationsResponsePB* resp,
+                             rpc::RpcContext* rpc,
+                             bool use_external_addr,
+                             const std::optional<std::string>& user);
+
   // Dictionary mapping tablet servers to indexes, so that when a GetTableLocations
   // response returns many replicas mapping to the same UUID, they can be sent
   // only once in the returned protobuf and referred to by an index.
@@ -822,6 +874,12 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
 
   // Handle a tablet report from the given tablet server.
   //
+  // Unless --catalog_manager_enable_chunked_tablet_reports is off, the report
+  // is processed in batches of at most --catalog_manager_tablet_report_batch_size
+  // tablets, so that the reports of many tablet servers, e.g. the full reports
+  // following a leader master election, lock and persist few tablets at a
+  // time and are processed concurrently rather than serially.
+  //
   // The RPC context is provided for logging/tracing purposes,
   // but this function does not itself respond to the RPC.
   Status ProcessTabletReport(TSDescriptor* ts_desc,
@@ -972,8 +1030,10 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
   FRIEND_TEST(MasterTest, TestGetTableLocationsDuringRepeatedTableVisit);
   FRIEND_TEST(kudu::AuthzTokenTest, TestSingleMasterUnavailable);
 
-  // This test calls VisitTablesAndTablets() directly.
+  // These tests call VisitTablesAndTablets() directly.
   FRIEND_TEST(kudu::CreateTableStressTest, TestConcurrentCreateTableAndReloadMetadata);
+  FRIEND_TEST(MasterTest, TestVisitTablesAndTabletsInParallel);
+  FRIEND_TEST(MasterTest, TestTabletSplitCandidates);
 
   // This test exclusively acquires the leader_lock_ directly.
   FRIEND_TEST(kudu::client::ServiceUnavailableRetryClientTest, CreateTable);
@@ -1180,6 +1240,22 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
                                  TabletLocationsPB* locs_pb,
                                  TSInfosDict* ts_infos_dict);
 
+  // Handle the tablets of the tablet report in the range [begin, end).
+  Status ProcessTabletReportBatch(TSDescriptor* ts_desc,
+                                  const TabletReportPB& full_report,
+                                  int begin,
+                                  int end,
+                                  TabletReportUpdatesPB* full_report_update,
+                                  rpc::RpcContext* rpc);
+
+  // Fills 'resp' with the changes of the locations of 'table' after
+  // req->known_version() and responds to 'rpc'.
+  void RespondToLocationsWatch(const scoped_refptr<TableInfo>& table,
+                               const WatchTableLocationsRequestPB* req,
+                               WatchTableLocationsResponsePB* resp,
+                               rpc::RpcContext* rpc,
+                               bool use_external_addr);
+
   // Looks up the table, locks it with the provided lock mode, and, if 'user' is
   // provided, checks that the user is authorized to operate on the table.
   //
@@ -1319,6 +1395,20 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
   Status ProcessDeletedTablets(const std::vector<scoped_refptr<TabletInfo>>& tablets,
                                time_t current_timestamp);
 
+  // Task that adds range partitions ahead of time to the tables configured
+  // with automatic range partitioning, and drops those past their retention.
+  // Is called in a background thread.
+  Status ProcessAutoRangePartitions();
+
+  // Adds and drops the range partitions of 'table', as configured by its
+  // automatic range partitioning properties.
+  Status RollAutoRangePartitions(const scoped_refptr<TableInfo>& table);
+
+  // Task that finds the tablets large or hot enough to be split, as per the
+  // stats reported by their leader replicas, and the keys to split them at.
+  // Is called in a background thread.
+  Status ProcessTabletSplitCandidates();
+
   std::string GenerateId() { return oid_generator_.Next(); }
 
   // Conventional "T xxx P yyy: " prefix for logging.
@@ -1349,7 +1439,12 @@ class CatalogManager : public tserver::TabletReplicaLookupIf {
   // easy to make a "gettable set".
 
   // Lock protecting the various maps and sets below.
-  typedef rw_spinlock LockType;
+  //
+  // Every location lookup and tablet report takes it for reading, while the
+  // maps only change with DDL operations: per-CPU locks keep the readers from
+  // contending on a single cache line. Readers must take it with
+  // shared_lock<rw_spinlock> l(lock_.get_lock()).
+  typedef percpu_rwlock LockType;
   mutable LockType lock_;
 
   // Table maps: table-id -> TableInfo and normalized-table-name -> TableInfo
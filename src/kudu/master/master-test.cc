@@ -134,7 +134,10 @@ DECLARE_bool(master_support_authz_tokens);
 DECLARE_bool(mock_table_metrics_for_testing);
 DECLARE_bool(raft_prepare_replacement_before_eviction);
 DECLARE_double(sys_catalog_fail_during_write);
+DECLARE_double(tablet_split_write_rate_threshold);
 DECLARE_int32(catalog_manager_bg_task_wait_ms);
+DECLARE_int32(catalog_manager_load_tablets_threads);
+DECLARE_int32(catalog_manager_tablet_report_batch_size);
 DECLARE_int32(default_num_replicas);
 DECLARE_int32(metadata_for_deleted_table_and_tablet_reserved_secs);
 DECLARE_int32(diagnostics_log_stack_traces_interval_ms);
@@ -151,6 +154,7 @@ DECLARE_string(location_mapping_cmd);
 DECLARE_string(log_filename);
 DECLARE_string(tsk_private_key_password_cmd);
 DECLARE_string(webserver_doc_root);
+DECLARE_uint64(tablet_split_size_threshold_mb);
 
 METRIC_DECLARE_histogram(handler_latency_kudu_master_MasterService_GetTableSchema);
 
@@ -773,6 +777,56 @@ TEST_F(MasterTest, TestRegisterAndHeartbeat) {
   }
 }
 
+// Test that the reports of tablet servers are processed in batches, with an
+// update for every reported tablet.
+TEST_F(MasterTest, TestTabletReportInBatches) {
+  FLAGS_catalog_manager_tablet_report_batch_size = 2;
+  constexpr const int kNumTablets = 5;
+
+  TSToMasterCommonPB common;
+  common.mutable_ts_instance()->set_permanent_uuid("my-ts-uuid");
+  common.mutable_ts_instance()->set_instance_seqno(1);
+  {
+    TSHeartbeatRequestPB req;
+    TSHeartbeatResponsePB resp;
+    RpcController rpc;
+    req.mutable_common()->CopyFrom(common);
+    ServerRegistrationPB* reg = req.mutable_registration();
+    MakeHostPortPB("localhost", 1000, reg->add_rpc_addresses());
+    MakeHostPortPB("localhost", 2000, reg->add_http_addresses());
+    reg->set_software_version(VersionInfo::GetVersionInfo());
+    reg->set_start_time(10000);
+    req.mutable_replica_management_info()->set_replacement_scheme(
+        FLAGS_raft_prepare_replacement_before_eviction
+            ? ReplicaManagementInfoPB::PREPARE_REPLACEMENT_BEFORE_EVICTION
+            : ReplicaManagementInfoPB::EVICT_FIRST);
+    ASSERT_OK(proxy_->TSHeartbeat(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error());
+  }
+  {
+    TSHeartbeatRequestPB req;
+    TSHeartbeatResponsePB resp;
+    RpcController rpc;
+    req.mutable_common()->CopyFrom(common);
+    TabletReportPB* tr = req.mutable_tablet_report();
+    tr->set_is_incremental(false);
+    tr->set_sequence_number(0);
+    for (int i = 0; i < kNumTablets; i++) {
+      tr->add_updated_tablets()->set_tablet_id(Substitute("tablet-$0", i));
+    }
+    ASSERT_OK(proxy_->TSHeartbeat(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_FALSE(resp.tablet_report_deferred());
+    ASSERT_FALSE(resp.needs_full_tablet_report());
+    ASSERT_EQ(kNumTablets, resp.tablet_report().tablets_size());
+    for (int i = 0; i < kNumTablets; i++) {
+      ASSERT_EQ(Substitute("tablet-$0", i), resp.tablet_report().tablets(i).tablet_id());
+    }
+  }
+}
+
 TEST_F(MasterTest, TestCatalog) {
   const char *kTableName = "testtb";
   const char *kOtherTableName = "tbtest";
@@ -1957,7 +2011,7 @@ TEST_F(MasterTest, TestCreateTableInvalidKeyType) {
     Status s = CreateTable(kTableName, kTableSchema, vector<KuduPartialRow>());
     ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
     ASSERT_STR_CONTAINS(s.ToString(),
-        "key column may not have type of BOOL, FLOAT, or DOUBLE");
+        "key column may not have type of BOOL, FLOAT, DOUBLE, ARRAY, or JSON");
   }
 }
 
@@ -2006,6 +2060,46 @@ TEST_F(MasterTest, TestCreateTableInvalidSchema) {
             SecureShortDebugString(resp.error().status()));
 }
 
+TEST_F(MasterTest, TestCreateTableInvalidCompressionLevel) {
+  CreateTableRequestPB req;
+  CreateTableResponsePB resp;
+  RpcController controller;
+
+  req.set_name("table");
+  ColumnSchemaPB* col = req.mutable_schema()->add_columns();
+  col->set_name("key");
+  col->set_type(INT32);
+  col->set_is_key(true);
+  col = req.mutable_schema()->add_columns();
+  col->set_name("val");
+  col->set_type(STRING);
+  col->set_compression(ZSTD);
+  col->set_compression_level(1000);
+
+  ASSERT_OK(proxy_->CreateTable(req, &resp, &controller));
+  SCOPED_TRACE(SecureDebugString(resp));
+  ASSERT_TRUE(resp.has_error());
+  ASSERT_EQ(AppStatusPB::INVALID_ARGUMENT, resp.error().status().code());
+  ASSERT_STR_CONTAINS(resp.error().status().message(),
+                      "invalid compression level for column 'val'");
+
+  // The tablet servers may resolve the default codec to ZSTD, so the level
+  // is checked there too.
+  col->clear_compression();
+  resp.Clear();
+  controller.Reset();
+  ASSERT_OK(proxy_->CreateTable(req, &resp, &controller));
+  ASSERT_TRUE(resp.has_error());
+  ASSERT_EQ(AppStatusPB::INVALID_ARGUMENT, resp.error().status().code());
+
+  // Codecs without levels ignore it.
+  col->set_compression(LZ4);
+  resp.Clear();
+  controller.Reset();
+  ASSERT_OK(proxy_->CreateTable(req, &resp, &controller));
+  ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp.error());
+}
+
 TEST_F(MasterTest, TestVirtualColumns) {
   CreateTableRequestPB req;
   CreateTableResponsePB resp;
@@ -2107,6 +2201,87 @@ TEST_F(MasterTest, TestInvalidGetTableLocations) {
   }
 }
 
+// Test that WatchTableLocations RPCs are responded to once the locations of
+// the table change, or once the requested wait elapses.
+TEST_F(MasterTest, TestWatchTableLocations) {
+  const string kTableName = "test";
+  Schema schema({ ColumnSchema("key", INT32) }, 1);
+  ASSERT_OK(CreateTable(kTableName, schema));
+
+  scoped_refptr<TableInfo> table;
+  vector<scoped_refptr<TabletInfo>> tablets;
+  {
+    CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
+    vector<scoped_refptr<TableInfo>> tables;
+    master_->catalog_manager()->GetAllTables(&tables);
+    ASSERT_EQ(1, tables.size());
+    table = tables[0];
+    table->GetAllTablets(&tablets);
+    ASSERT_FALSE(tablets.empty());
+  }
+
+  WatchTableLocationsRequestPB req;
+  req.mutable_table()->set_table_name(kTableName);
+
+  // Without a known version, the master responds right away.
+  int64_t version;
+  {
+    WatchTableLocationsResponsePB resp;
+    RpcController controller;
+    ASSERT_OK(proxy_->WatchTableLocations(req, &resp, &controller));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_TRUE(resp.has_version());
+    version = resp.version();
+  }
+
+  // Without any change, the master responds once the wait elapses.
+  req.set_known_version(version);
+  req.set_max_wait_ms(100);
+  {
+    WatchTableLocationsResponsePB resp;
+    RpcController controller;
+    const MonoTime start = MonoTime::Now();
+    ASSERT_OK(proxy_->WatchTableLocations(req, &resp, &controller));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_GE((MonoTime::Now() - start).ToMilliseconds(), 100);
+    ASSERT_EQ(version, resp.version());
+    ASSERT_FALSE(resp.full_refresh_required());
+    ASSERT_EQ(0, resp.tablet_locations_size());
+  }
+
+  // A change of the locations of a tablet is responded to right away.
+  req.set_max_wait_ms(60 * 1000);
+  {
+    WatchTableLocationsResponsePB resp;
+    RpcController controller;
+    CountDownLatch done(1);
+    proxy_->WatchTableLocationsAsync(req, &resp, &controller,
+                                     [&done]() { done.CountDown(); });
+    ASSERT_FALSE(done.WaitFor(MonoDelta::FromMilliseconds(100)));
+    table->LocationsChanged(tablets[0]->id());
+    ASSERT_TRUE(done.WaitFor(MonoDelta::FromSeconds(10)));
+    ASSERT_OK(controller.status());
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_EQ(version + 1, resp.version());
+    ASSERT_FALSE(resp.full_refresh_required());
+  }
+
+  // The master doesn't know the changes since a version it never handed out.
+  req.set_known_version(version - 1);
+  {
+    WatchTableLocationsResponsePB resp;
+    RpcController controller;
+    ASSERT_OK(proxy_->WatchTableLocations(req, &resp, &controller));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_EQ(version + 1, resp.version());
+    ASSERT_TRUE(resp.full_refresh_required());
+  }
+}
+
 #ifndef __APPLE__
 // Test that, if the master's RPC service queue overflows, thread stack traces
 // are dumped to the diagnostics log.
@@ -2178,6 +2353,86 @@ TEST_F(MasterTest, TestShutdownDuringTableVisit) {
   // CatalogManager::PrepareForLeadershipTask().
 }
 
+// Tests that reloading the system catalog with several threads adding the
+// tablets to their tables restores all the tablets of every table.
+TEST_F(MasterTest, TestVisitTablesAndTabletsInParallel) {
+  constexpr int kNumTables = 10;
+  FLAGS_catalog_manager_load_tablets_threads = 4;
+  Schema schema({ ColumnSchema("key", INT32) }, 1);
+  for (int i = 0; i < kNumTables; i++) {
+    ASSERT_OK(CreateTable(Substitute("table-$0", i), schema));
+  }
+  ASSERT_OK(master_->catalog_manager()->VisitTablesAndTablets());
+
+  vector<scoped_refptr<TableInfo>> tables;
+  {
+    CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
+    master_->catalog_manager()->GetAllTables(&tables);
+  }
+  ASSERT_EQ(kNumTables, tables.size());
+  for (const auto& table : tables) {
+    // The tables are created by CreateTable() with two split rows.
+    ASSERT_EQ(3, table->num_tablets());
+  }
+}
+
+// Tests that the leader master picks the tablets worth splitting as per their
+// reported stats and the thresholds.
+TEST_F(MasterTest, TestTabletSplitCandidates) {
+  const char* kTableName = "test";
+  Schema schema({ ColumnSchema("key", INT32) }, 1);
+  ASSERT_OK(CreateTable(kTableName, schema));
+
+  vector<scoped_refptr<TableInfo>> tables;
+  {
+    CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
+    master_->catalog_manager()->GetAllTables(&tables);
+  }
+  ASSERT_EQ(1, tables.size());
+  const auto& table = tables[0];
+  vector<scoped_refptr<TabletInfo>> tablets;
+  table->GetAllTablets(&tablets);
+  ASSERT_EQ(3, tablets.size());
+
+  // A large tablet, a small but hot tablet, and a large tablet which its
+  // leader replica couldn't find a split key for.
+  constexpr uint64_t kMiB = 1024 * 1024;
+  const auto update_stats = [](TabletInfo* tablet, uint64_t on_disk_size,
+                               double write_rate, const string& split_key) {
+    tablet::ReportedTabletStatsPB stats;
+    stats.set_on_disk_size(on_disk_size);
+    stats.set_live_row_count(0);
+    stats.set_write_rate(write_rate);
+    if (!split_key.empty()) {
+      stats.set_split_key(split_key);
+    }
+    tablet->UpdateStats(std::move(stats));
+  };
+  update_stats(tablets[0].get(), 2 * kMiB, 0, "a");
+  update_stats(tablets[1].get(), 1, 1000, "b");
+  update_stats(tablets[2].get(), 2 * kMiB, 1000, "");
+
+  const auto process_candidates = [&] {
+    CatalogManager::ScopedLeaderSharedLock l(master_->catalog_manager());
+    RETURN_NOT_OK(l.first_failed_status());
+    return master_->catalog_manager()->ProcessTabletSplitCandidates();
+  };
+  const auto* metrics = table->GetMetrics();
+  ASSERT_NE(nullptr, metrics);
+
+  FLAGS_tablet_split_size_threshold_mb = 1;
+  ASSERT_OK(process_candidates());
+  ASSERT_EQ(1, metrics->tablets_to_split->value());
+
+  FLAGS_tablet_split_write_rate_threshold = 100;
+  ASSERT_OK(process_candidates());
+  ASSERT_EQ(2, metrics->tablets_to_split->value());
+
+  FLAGS_tablet_split_size_threshold_mb = 0;
+  ASSERT_OK(process_candidates());
+  ASSERT_EQ(1, metrics->tablets_to_split->value());
+}
+
 // Tests that the catalog manager handles spurious calls to ElectedAsLeaderCb()
 // (i.e. those without a term change) correctly by ignoring them. If they
 // aren't ignored, a concurrent GetTableLocations() call may trigger a
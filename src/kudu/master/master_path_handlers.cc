@@ -32,6 +32,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/common/common.pb.h"
@@ -67,6 +68,7 @@
 #include "kudu/tablet/metadata.pb.h"
 #include "kudu/util/cow_object.h"
 #include "kudu/util/easy_json.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/jsonwriter.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
@@ -89,6 +91,15 @@ using std::string;
 using std::vector;
 using strings::Substitute;
 
+DEFINE_int32(master_tables_page_cache_ttl_ms, 0,
+             "How long the list of tables of the /tables page of the web UI is "
+             "served from a cached rendering, in milliseconds, rather than "
+             "rendered anew by visiting every table for each request. Useful on "
+             "masters with many tables whose web UI is scraped frequently. "
+             "0 disables the cache.");
+TAG_FLAG(master_tables_page_cache_ttl_ms, advanced);
+TAG_FLAG(master_tables_page_cache_ttl_ms, runtime);
+
 namespace kudu {
 namespace master {
 
@@ -254,6 +265,15 @@ void MasterPathHandlers::HandleCatalogManager(const Webserver::WebRequest& req,
     return;
   }
 
+  const int32_t cache_ttl_ms = FLAGS_master_tables_page_cache_ttl_ms;
+  if (cache_ttl_ms <= 0) {
+    RenderTablesPage(output);
+    return;
+  }
+  tables_page_cache_.Get(MonoDelta::FromMilliseconds(cache_ttl_ms), output);
+}
+
+void MasterPathHandlers::RenderTablesPage(EasyJson* output) {
   std::vector<scoped_refptr<TableInfo>> tables;
   master_->catalog_manager()->GetAllTables(&tables);
   int num_running_tables = 0;
@@ -20,6 +20,7 @@
 #include <utility>
 
 #include "kudu/gutil/macros.h"
+#include "kudu/server/web_page_cache.h"
 #include "kudu/server/webserver.h"
 #include "kudu/util/openssl_util.h"
 #include "kudu/util/status.h"
@@ -36,7 +37,10 @@ class TSDescriptor;
 class MasterPathHandlers {
  public:
   explicit MasterPathHandlers(Master* master)
-    : master_(master) {
+    : master_(master),
+      tables_page_cache_([this](EasyJson* output) {
+        this->RenderTablesPage(output);
+      }) {
   }
 
   ~MasterPathHandlers();
@@ -48,6 +52,9 @@ class MasterPathHandlers {
                            Webserver::WebResponse* resp);
   void HandleCatalogManager(const Webserver::WebRequest& req,
                             Webserver::WebResponse* resp);
+  // Renders the list of tables of the /tables page into 'output'. The caller
+  // must hold the leader lock of the catalog manager.
+  void RenderTablesPage(EasyJson* output);
   void HandleTablePage(const Webserver::WebRequest& req,
                        Webserver::WebResponse* resp);
   void HandleMasters(const Webserver::WebRequest& req,
@@ -77,6 +84,11 @@ class MasterPathHandlers {
   void SetupLeaderMasterRedirect(const std::string& path, int redirects, EasyJson* output) const;
 
   Master* master_;
+
+  // The list of tables of the /tables page, cached for
+  // --master_tables_page_cache_ttl_ms.
+  WebPageCache tables_page_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(MasterPathHandlers);
 };
 
@@ -17,6 +17,7 @@
 
 #include "kudu/master/master_service.h"
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -73,6 +74,15 @@ DEFINE_int32(master_inject_latency_on_tablet_lookups_ms, 0,
 TAG_FLAG(master_inject_latency_on_tablet_lookups_ms, unsafe);
 TAG_FLAG(master_inject_latency_on_tablet_lookups_ms, hidden);
 
+DEFINE_int32(master_max_concurrent_full_tablet_reports, 16,
+             "Maximum number of full tablet reports the leader master processes "
+             "concurrently. The tablet servers whose full reports are beyond "
+             "this limit send them again in their next regular heartbeat, so "
+             "that the full reports sent to a newly elected leader master don't "
+             "starve its other RPCs. If not positive, there is no limit.");
+TAG_FLAG(master_max_concurrent_full_tablet_reports, advanced);
+TAG_FLAG(master_max_concurrent_full_tablet_reports, runtime);
+
 DEFINE_bool(master_support_connect_to_master_rpc, true,
             "Whether to support the ConnectToMaster() RPC. Used for testing "
             "version compatibility fallback in the client.");
@@ -173,7 +183,8 @@ bool StateChangeToTServerState(const TServerStateChangePB::StateChange& change,
 
 MasterServiceImpl::MasterServiceImpl(Master* server)
   : MasterServiceIf(server->metric_entity(), server->result_tracker()),
-    server_(server) {
+    server_(server),
+    num_full_tablet_reports_in_progress_(0) {
 }
 
 bool MasterServiceImpl::AuthorizeClient(const Message* /*req*/,
@@ -467,20 +478,36 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
     ts_desc->set_num_live_replicas_by_range_per_table(it->first, ranges);
   }
 
-  // 5. Only leaders handle tablet reports.
+  // 5. Only leaders handle tablet reports. Full reports beyond the limit of
+  //    concurrent ones are deferred to the next regular heartbeat.
   if (is_leader_master && req->has_tablet_report()) {
-    Status s = server_->catalog_manager()->ProcessTabletReport(
-        ts_desc.get(), req->tablet_report(), resp->mutable_tablet_report(), rpc);
-    if (!s.ok()) {
-      rpc->RespondFailure(s.CloneAndPrepend("Failed to process tablet report"));
-      return;
-    }
-    // If we previously needed a full tablet report for the tserver (e.g.
-    // because we need to recheck replica states after exiting from maintenance
-    // mode) and have just received a full report, mark that we no longer need
-    // a full tablet report.
-    if (!req->tablet_report().is_incremental()) {
-      ts_desc->UpdateNeedsFullTabletReport(false);
+    const bool is_full_report = !req->tablet_report().is_incremental();
+    const int32_t num_full_reports = is_full_report ? ++num_full_tablet_reports_in_progress_ : 0;
+    SCOPED_CLEANUP({
+      if (is_full_report) {
+        --num_full_tablet_reports_in_progress_;
+      }
+    });
+    const int32_t max_full_reports = FLAGS_master_max_concurrent_full_tablet_reports;
+    if (max_full_reports > 0 && num_full_reports > max_full_reports) {
+      VLOG(1) << Substitute("Deferring the full tablet report of $0: processing $1 others",
+                            ts_desc->ToString(), num_full_reports - 1);
+      resp->set_tablet_report_deferred(true);
+      resp->set_needs_full_tablet_report(true);
+    } else {
+      Status s = server_->catalog_manager()->ProcessTabletReport(
+          ts_desc.get(), req->tablet_report(), resp->mutable_tablet_report(), rpc);
+      if (!s.ok()) {
+        rpc->RespondFailure(s.CloneAndPrepend("Failed to process tablet report"));
+        return;
+      }
+      // If we previously needed a full tablet report for the tserver (e.g.
+      // because we need to recheck replica states after exiting from maintenance
+      // mode) and have just received a full report, mark that we no longer need
+      // a full tablet report.
+      if (is_full_report) {
+        ts_desc->UpdateNeedsFullTabletReport(false);
+      }
     }
   }
 
@@ -720,6 +747,30 @@ void MasterServiceImpl::GetTableLocations(const GetTableLocationsRequestPB* req,
   rpc->RespondSuccess();
 }
 
+void MasterServiceImpl::WatchTableLocations(const WatchTableLocationsRequestPB* req,
+                                            WatchTableLocationsResponsePB* resp,
+                                            rpc::RpcContext* rpc) {
+  Status s;
+  {
+    CatalogManager::ScopedLeaderSharedLock l(server_->catalog_manager());
+    if (!l.CheckIsInitializedAndIsLeaderOrRespond(resp, rpc)) {
+      return;
+    }
+
+    const auto use_external_addr = IsAddrOneOf(
+        rpc->local_address(), server_->rpc_proxied_addresses());
+    s = server_->catalog_manager()->WatchTableLocations(
+        req, resp, rpc, use_external_addr, rpc->remote_user().username());
+  }
+  if (s.ok()) {
+    // The catalog manager responds once the locations change.
+    return;
+  }
+
+  CheckRespErrorOrSetUnknown(s, resp);
+  rpc->RespondSuccess();
+}
+
 void MasterServiceImpl::GetTableSchema(const GetTableSchemaRequestPB* req,
                                        GetTableSchemaResponsePB* resp,
                                        rpc::RpcContext* rpc) {
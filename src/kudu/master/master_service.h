@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include "kudu/gutil/macros.h"
@@ -85,6 +86,8 @@ class ReplaceTabletRequestPB;
 class ReplaceTabletResponsePB;
 class TSHeartbeatRequestPB;
 class TSHeartbeatResponsePB;
+class WatchTableLocationsRequestPB;
+class WatchTableLocationsResponsePB;
 
 // Implementation of the master service. See master.proto for docs
 // on each RPC.
@@ -176,6 +179,10 @@ class MasterServiceImpl : public MasterServiceIf {
                          GetTableLocationsResponsePB* resp,
                          rpc::RpcContext* rpc) override;
 
+  void WatchTableLocations(const WatchTableLocationsRequestPB* req,
+                           WatchTableLocationsResponsePB* resp,
+                           rpc::RpcContext* rpc) override;
+
   void GetTableSchema(const GetTableSchemaRequestPB* req,
                       GetTableSchemaResponsePB* resp,
                       rpc::RpcContext* rpc) override;
@@ -209,6 +216,9 @@ class MasterServiceImpl : public MasterServiceIf {
  private:
   Master* server_;
 
+  // The number of full tablet reports being processed.
+  std::atomic<int32_t> num_full_tablet_reports_in_progress_;
+
   DISALLOW_COPY_AND_ASSIGN(MasterServiceImpl);
 };
 
@@ -21,7 +21,6 @@
 #include <limits>
 #include <map>
 #include <memory>
-#include <numeric>
 #include <optional>
 #include <ostream>
 #include <set>
@@ -182,6 +181,7 @@ PlacementPolicy::PlacementPolicy(TSDescriptorVector descs,
   for (auto& desc : descs) {
     EmplaceOrDie(&known_ts_ids_, desc->permanent_uuid());
     string location = desc->location() ? *desc->location() : "";
+    LookupOrEmplace(&num_live_replicas_by_location_, location, 0) += desc->num_live_replicas();
     LookupOrEmplace(&ltd_, std::move(location),
                     TSDescriptorVector()).emplace_back(std::move(desc));
   }
@@ -268,12 +268,8 @@ double PlacementPolicy::GetLocationLoad(
   // among tablet servers in the specified location.
   const auto& ts_descriptors = FindOrDie(ltd_, location);
   CHECK(!ts_descriptors.empty());
-  // Count the number of already existing replicas at the specified location.
-  auto num_live_replicas = accumulate(
-        ts_descriptors.begin(), ts_descriptors.end(), 0,
-        [](int val, const shared_ptr<TSDescriptor>& desc) {
-          return val + desc->num_live_replicas();
-        });
+  // The number of already existing replicas at the specified location.
+  auto num_live_replicas = FindOrDie(num_live_replicas_by_location_, location);
   // Add the number of to-be-replicas slated for the placement at the specified
   // location.
   const auto* location_rep_num_ptr = FindOrNull(locations_info, location);
@@ -205,6 +205,11 @@ class PlacementPolicy {
 
   // A set of known tablet server identifiers (derived from ltd_).
   std::unordered_set<std::string> known_ts_ids_;
+
+  // The number of live tablet replicas per location (derived from ltd_), so
+  // that the load of a location isn't summed up over its tablet servers every
+  // time a replica is placed.
+  std::unordered_map<std::string, int> num_live_replicas_by_location_;
 };
 
 } // namespace master
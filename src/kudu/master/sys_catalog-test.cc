@@ -31,6 +31,7 @@
 #include "kudu/common/schema.h"
 #include "kudu/common/wire_protocol.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/master/catalog_manager.h"
 #include "kudu/master/master.h"
 #include "kudu/master/master.pb.h"
@@ -58,7 +59,11 @@ using kudu::security::PrivateKey;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
 
+DECLARE_bool(rpc_max_message_size_enable_validation);
+DECLARE_int64(rpc_max_message_size);
 DECLARE_string(ipki_private_key_password_cmd);
 
 namespace google {
@@ -320,6 +325,51 @@ TEST_F(SysCatalogTest, TestSysCatalogTabletsOperations) {
   }
 }
 
+// Test that a table with more tablets than fit into a single write is written
+// in chunks, with all of its tablets.
+TEST_F(SysCatalogTest, TestChunkedWriteOfTableAndTablets) {
+  constexpr int kNumTablets = 1000;
+  FLAGS_rpc_max_message_size_enable_validation = false;
+  FLAGS_rpc_max_message_size = 32 * 1024;
+
+  scoped_refptr<TableInfo> table(new TableInfo("abc"));
+  vector<scoped_refptr<TabletInfo>> tablets;
+  for (int i = 0; i < kNumTablets; i++) {
+    tablets.emplace_back(CreateTablet(table, Substitute("tablet-$0", i),
+                                      Substitute("$0", i), Substitute("$0", i + 1)));
+  }
+
+  auto* sys_catalog = master_->catalog_manager()->sys_catalog();
+  {
+    TableMetadataLock l(table.get(), LockMode::WRITE);
+    l.mutable_data()->pb.set_name("testtb");
+    l.mutable_data()->pb.set_version(0);
+    l.mutable_data()->pb.set_num_replicas(1);
+    l.mutable_data()->pb.set_state(SysTablesEntryPB::RUNNING);
+    ASSERT_OK(SchemaToPB(Schema(), l.mutable_data()->pb.mutable_schema()));
+    TabletMetadataGroupLock tablets_lock(LockMode::RELEASED);
+    tablets_lock.AddMutableInfos(tablets);
+    tablets_lock.Lock(LockMode::WRITE);
+
+    SysCatalogTable::Actions actions;
+    actions.table_to_add = table;
+    actions.tablets_to_add = tablets;
+    // The write doesn't fit into a single request.
+    ASSERT_TRUE(sys_catalog->Write(actions).IsInvalidArgument());
+    ASSERT_OK(sys_catalog->Write(std::move(actions), SysCatalogTable::WriteMode::CHUNKED));
+    tablets_lock.Commit();
+    l.Commit();
+  }
+
+  TableInfoLoader table_loader;
+  ASSERT_OK(sys_catalog->VisitTables(&table_loader));
+  ASSERT_EQ(1, table_loader.tables.size());
+  ASSERT_TRUE(MetadatasEqual(table, table_loader.tables[0]));
+  TabletInfoLoader tablet_loader;
+  ASSERT_OK(sys_catalog->VisitTablets(&tablet_loader));
+  ASSERT_EQ(kNumTablets, tablet_loader.tablets.size());
+}
+
 // Verify that data mutations are not available from metadata() until commit.
 TEST_F(SysCatalogTest, TestTabletInfoCommit) {
   scoped_refptr<TabletInfo> tablet(new TabletInfo(nullptr, "123"));
@@ -576,40 +576,59 @@ Status SysCatalogTable::WaitUntilRunning() {
 }
 
 Status SysCatalogTable::SyncWrite(const WriteRequestPB& req) {
-  DCHECK(req.has_tablet_id());
-  DCHECK(req.has_schema());
+  return SyncWrites({ &req });
+}
+
+Status SysCatalogTable::SyncWrites(const vector<const WriteRequestPB*>& reqs) {
   MAYBE_RETURN_FAILURE(FLAGS_sys_catalog_fail_during_write,
                        Status::RuntimeError(kInjectedFailureStatusMsg));
-  const size_t request_size = req.ByteSizeLong();
-  if (request_size > GetMaxWriteRequestSize()) {
-    oversized_write_requests_->Increment();
-    return Status::InvalidArgument(
-        Substitute("write request ($0 bytes in size) is too large for current "
-                   "setting of the --rpc_max_message_size flag", request_size));
+  for (const auto* req : reqs) {
+    DCHECK(req->has_tablet_id());
+    DCHECK(req->has_schema());
+    const size_t request_size = req->ByteSizeLong();
+    if (request_size > GetMaxWriteRequestSize()) {
+      oversized_write_requests_->Increment();
+      return Status::InvalidArgument(
+          Substitute("write request ($0 bytes in size) is too large for current "
+                     "setting of the --rpc_max_message_size flag", request_size));
+    }
   }
-  CountDownLatch latch(1);
-  WriteResponsePB resp;
-  unique_ptr<tablet::OpCompletionCallback> op_callback(
-      new LatchOpCompletionCallback<WriteResponsePB>(&latch, &resp));
-  unique_ptr<tablet::WriteOpState> op_state(
-      new tablet::WriteOpState(tablet_replica_.get(),
-                               &req,
-                               nullptr, // No RequestIdPB
-                               &resp));
-  op_state->set_completion_callback(std::move(op_callback));
-
-  RETURN_NOT_OK(tablet_replica_->SubmitWrite(std::move(op_state)));
-  latch.Wait();
 
-  if (resp.has_error()) {
-    return StatusFromPB(resp.error().status());
+  // Submit all the writes before waiting for any of them, so that they are
+  // replicated in a pipeline rather than one round trip after another.
+  CountDownLatch latch(reqs.size());
+  vector<WriteResponsePB> resps(reqs.size());
+  Status submit_status;
+  for (size_t i = 0; i < reqs.size(); i++) {
+    unique_ptr<tablet::OpCompletionCallback> op_callback(
+        new LatchOpCompletionCallback<WriteResponsePB>(&latch, &resps[i]));
+    unique_ptr<tablet::WriteOpState> op_state(
+        new tablet::WriteOpState(tablet_replica_.get(),
+                                 reqs[i],
+                                 nullptr, // No RequestIdPB
+                                 &resps[i]));
+    op_state->set_completion_callback(std::move(op_callback));
+    submit_status = tablet_replica_->SubmitWrite(std::move(op_state));
+    if (PREDICT_FALSE(!submit_status.ok())) {
+      // The writes which weren't submitted never complete.
+      latch.CountDown(reqs.size() - i);
+      break;
+    }
   }
-  if (resp.per_row_errors_size() > 0) {
-    for (const auto& error : resp.per_row_errors()) {
-      LOG(WARNING) << Substitute(
-          "row $0: $1", error.row_index(), StatusFromPB(error.error()).ToString());
+  latch.Wait();
+  RETURN_NOT_OK(submit_status);
+
+  for (const auto& resp : resps) {
+    if (resp.has_error()) {
+      return StatusFromPB(resp.error().status());
+    }
+    if (resp.per_row_errors_size() > 0) {
+      for (const auto& error : resp.per_row_errors()) {
+        LOG(WARNING) << Substitute(
+            "row $0: $1", error.row_index(), StatusFromPB(error.error()).ToString());
+      }
+      return Status::Corruption("failed to write one or more rows");
     }
-    return Status::Corruption("failed to write one or more rows");
   }
   return Status::OK();
 }
@@ -631,34 +650,47 @@ Status SysCatalogTable::Write(Actions actions, WriteMode mode) {
   req.set_tablet_id(kSysCatalogTabletId);
   RETURN_NOT_OK(SchemaToPB(schema_, req.mutable_schema()));
 
-  if (actions.table_to_add) {
-    ReqAddTable(&req, actions.table_to_add);
-  }
-  if (actions.table_to_update) {
-    ReqUpdateTable(&req, actions.table_to_update);
-  }
-  if (actions.table_to_delete) {
-    ReqDeleteTable(&req, actions.table_to_delete);
-  }
-
   // There might be many updates on tablet metadata in a cluster, especially
   // in a big one. When persisting these, the write operations are broken into
-  // chunks if requested.
+  // chunks if requested. The full chunks are written before the rest of the
+  // actions, and the table entry comes last: if a chunk fails to be written,
+  // the table entry isn't written either.
   const size_t max_batch_size =
       (mode == WriteMode::ATOMIC) ? 0 : GetMaxWriteRequestSize();
+  vector<WriteRequestPB> chunks;
   RETURN_NOT_OK(ChunkedWrite(&SysCatalogTable::ReqAddTablets,
                              max_batch_size,
                              std::move(actions.tablets_to_add),
-                             &req));
+                             &req,
+                             &chunks));
   RETURN_NOT_OK(ChunkedWrite(&SysCatalogTable::ReqUpdateTablets,
                              max_batch_size,
                              std::move(actions.tablets_to_update),
-                             &req));
+                             &req,
+                             &chunks));
   RETURN_NOT_OK(ChunkedWrite(&SysCatalogTable::ReqDeleteTablets,
                              max_batch_size,
                              std::move(actions.tablets_to_delete),
-                             &req));
+                             &req,
+                             &chunks));
+  if (!chunks.empty()) {
+    vector<const WriteRequestPB*> chunk_ptrs;
+    chunk_ptrs.reserve(chunks.size());
+    for (const auto& chunk : chunks) {
+      chunk_ptrs.emplace_back(&chunk);
+    }
+    RETURN_NOT_OK(SyncWrites(chunk_ptrs));
+  }
 
+  if (actions.table_to_add) {
+    ReqAddTable(&req, actions.table_to_add);
+  }
+  if (actions.table_to_update) {
+    ReqUpdateTable(&req, actions.table_to_update);
+  }
+  if (actions.table_to_delete) {
+    ReqDeleteTable(&req, actions.table_to_delete);
+  }
   if (actions.hms_notification_log_event_id) {
     ReqSetNotificationLogEventId(&req, *actions.hms_notification_log_event_id);
   }
@@ -1106,17 +1138,19 @@ Status SysCatalogTable::ChunkedWrite(
     const Generator& generator,
     size_t max_chunk_size,
     vector<scoped_refptr<TabletInfo>> tablets_info,
-    WriteRequestPB* req) {
+    WriteRequestPB* req,
+    vector<WriteRequestPB>* chunks) {
   decltype(tablets_info) input(std::move(tablets_info));
   do {
     decltype(tablets_info) excess;
     generator(*this, max_chunk_size, std::move(input), &excess, req);
     if (!excess.empty()) {
-      // It's time to write a chunk of the generated data because
+      // It's time to cut a chunk of the generated data because
       // the generator returned some of the input elements back. Those extra
       // elements will go next batch if trying to stay under the specified
       // maximum size for the result request.
-      RETURN_NOT_OK(SyncWrite(*req));
+      chunks->emplace_back();
+      chunks->back().Swap(req);
       req->Clear();
       req->set_tablet_id(kSysCatalogTabletId);
       RETURN_NOT_OK(SchemaToPB(schema_, req->mutable_schema()));
@@ -236,7 +236,9 @@ class SysCatalogTable {
   // Persist the specified actions into the system tablet. Set the 'mode' to
   // WriteMode::CHUNKED to split requests larger than the maximum RPC size
   // into chunks if non-atomic update is acceptable. In case of chunked mode,
-  // no atomicity is guaranteed while persisting the specified actions.
+  // no atomicity is guaranteed while persisting the specified actions: the
+  // chunks of tablet actions are written concurrently, and the table actions
+  // are written only once all of them succeeded.
   Status Write(Actions actions, WriteMode mode = WriteMode::ATOMIC);
 
   // Scan of the table-related entries.
@@ -312,6 +314,11 @@ class SysCatalogTable {
   // Returns 'Status::OK()' if the WriteOp completed
   Status SyncWrite(const tserver::WriteRequestPB& req);
 
+  // Same as above, but for several WriteOps which are all submitted before
+  // waiting for their completion. Returns the first error if any of them
+  // failed, in which case the others may have been written nonetheless.
+  Status SyncWrites(const std::vector<const tserver::WriteRequestPB*>& reqs);
+
   void SysCatalogStateChanged(const std::string& tablet_id, const std::string& reason);
 
   Status SetupTablet(const scoped_refptr<tablet::TabletMetadata>& metadata);
@@ -391,11 +398,14 @@ class SysCatalogTable {
                              std::vector<scoped_refptr<TabletInfo>>*,
                              tserver::WriteRequestPB*)> Generator;
 
-  // A method for chunked write into the system tablet.
+  // A method for chunked write into the system tablet: the requests which
+  // reached 'max_chunk_size' are appended to 'chunks' for the caller to write,
+  // and the rest of the generated data is left in 'req'.
   Status ChunkedWrite(const Generator& generator,
                       size_t max_chunk_size,
                       std::vector<scoped_refptr<TabletInfo>> tablets_info,
-                      tserver::WriteRequestPB* req);
+                      tserver::WriteRequestPB* req,
+                      std::vector<tserver::WriteRequestPB>* chunks);
 
   // Overwrite (upsert) the latest event ID in the table with the provided ID.
   void ReqSetNotificationLogEventId(tserver::WriteRequestPB* req, int64_t event_id);
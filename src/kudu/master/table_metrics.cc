@@ -44,6 +44,12 @@ METRIC_DEFINE_gauge_uint32(table, schema_version, "Table Schema Version",
     kudu::MetricUnit::kUnits,
     "The table's schema version.",
     kudu::MetricLevel::kInfo);
+METRIC_DEFINE_gauge_uint32(table, tablets_to_split, "Tablets To Split",
+    kudu::MetricUnit::kTablets,
+    "Number of tablets of this table large or hot enough to be split, as per "
+    "the --tablet_split_size_threshold_mb and --tablet_split_write_rate_threshold "
+    "flags of the leader master.",
+    kudu::MetricLevel::kInfo);
 
 #define GINIT(x) x(METRIC_##x.Instantiate(entity, 0))
 #define HIDEINIT(x, v) x(METRIC_##x.InstantiateHidden(entity, v))
@@ -52,6 +58,7 @@ TableMetrics::TableMetrics(const scoped_refptr<MetricEntity>& entity)
     GINIT(live_row_count),
     GINIT(column_count),
     GINIT(schema_version),
+    GINIT(tablets_to_split),
     HIDEINIT(merged_entities_count_of_table, 1) {
 }
 #undef GINIT
@@ -17,24 +17,38 @@
 
 #include "kudu/master/tablet_loader.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <ostream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/common/common.pb.h"
 #include "kudu/common/partition.h"
 #include "kudu/gutil/map-util.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/master/catalog_manager.h"
 #include "kudu/master/master.pb.h"
 #include "kudu/util/cow_object.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/thread.h"
+
+DEFINE_int32(catalog_manager_load_tablets_threads, 1,
+             "Number of threads adding the tablets loaded from the system "
+             "catalog to their tables when the catalog manager becomes the "
+             "leader, the tablets of different tables being added "
+             "concurrently. Raising it shortens the time a new leader master "
+             "takes to serve requests with many tables.");
+TAG_FLAG(catalog_manager_load_tablets_threads, advanced);
 
 using kudu::pb_util::SecureDebugString;
 using kudu::pb_util::SecureShortDebugString;
@@ -46,7 +60,8 @@ namespace kudu {
 namespace master {
 
 TabletLoader::TabletLoader(CatalogManager* catalog_manager)
-    : catalog_manager_(catalog_manager) {
+    : catalog_manager_(catalog_manager),
+      num_tablets_(0) {
 }
 
 Status TabletLoader::VisitTablet(const string& table_id,
@@ -56,8 +71,16 @@ Status TabletLoader::VisitTablet(const string& table_id,
   scoped_refptr<TableInfo> table(FindPtrOrNull(
       catalog_manager_->table_ids_map_, table_id));
   if (table == nullptr) {
-    // Tables and tablets are always created/deleted in one operation, so
-    // this shouldn't be possible.
+    if (metadata.state() == SysTabletsEntryPB::PREPARING) {
+      // The tablets of a new table may be written in several chunks before
+      // the table itself: this tablet is left from a creation which failed
+      // before the table was written.
+      LOG(WARNING) << Substitute("ignoring tablet $0 of table $1 which was never created",
+                                 tablet_id, table_id);
+      return Status::OK();
+    }
+    // Tables and tablets are otherwise always created/deleted in one
+    // operation, so this shouldn't be possible.
     string msg = Substitute("missing table $0 required by tablet $1 (metadata: $2)",
                             table_id, tablet_id, SecureDebugString(metadata));
     LOG(ERROR) << msg;
@@ -85,16 +108,15 @@ Status TabletLoader::VisitTablet(const string& table_id,
   // Add the tablet to the tablet manager.
   catalog_manager_->tablet_map_[tablet->id()] = tablet;
 
-  // Add the tablet to the table.
+  // Batch the tablet to be added to the table by Finish(): adding the
+  // tablets of a table at once takes the lock of the table only once.
   bool is_deleted = l.mutable_data()->is_deleted();
   l.Commit();
+  num_tablets_++;
   if (!is_deleted) {
-    // Need to use a new tablet lock here because AddRemoveTablets() reads
-    // from clean state, which is uninitialized for these brand new tablets.
-    TabletMetadataLock l(tablet.get(), LockMode::READ);
-    table->AddRemoveTablets({ tablet }, {});
-    LOG(INFO) << Substitute("loaded metadata for tablet $0 (table $1)",
-                            tablet_id, table->ToString());
+    tablets_by_table_[table.get()].emplace_back(std::move(tablet));
+    VLOG(1) << Substitute("loaded metadata for tablet $0 (table $1)",
+                          tablet_id, table->ToString());
   }
 
   VLOG(2) << Substitute("metadata for tablet $0: $1",
@@ -102,6 +124,47 @@ Status TabletLoader::VisitTablet(const string& table_id,
   return Status::OK();
 }
 
+void TabletLoader::Finish() {
+  vector<std::pair<TableInfo*, vector<scoped_refptr<TabletInfo>>>> batches;
+  batches.reserve(tablets_by_table_.size());
+  for (auto& e : tablets_by_table_) {
+    batches.emplace_back(e.first, std::move(e.second));
+  }
+  tablets_by_table_.clear();
+
+  // Each thread adds the tablets of every 'num_threads'-th table.
+  const size_t num_threads = std::max<size_t>(1, std::min<size_t>(
+      FLAGS_catalog_manager_load_tablets_threads, batches.size()));
+  const auto add_tablets = [&](size_t first) {
+    for (size_t i = first; i < batches.size(); i += num_threads) {
+      const auto& tablets = batches[i].second;
+      // AddRemoveTablets() reads from the clean state of the tablets, so they
+      // must be locked for reading.
+      TabletMetadataGroupLock l(LockMode::READ);
+      l.AddInfos(tablets);
+      batches[i].first->AddRemoveTablets(tablets, {});
+    }
+  };
+  vector<scoped_refptr<Thread>> threads;
+  for (size_t i = 1; i < num_threads; i++) {
+    scoped_refptr<Thread> thread;
+    Status s = Thread::Create("catalog manager", Substitute("load-tablets-$0", i),
+                              [&, i]() { add_tablets(i); }, &thread);
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG(WARNING) << "failed to start thread to load tablets: " << s.ToString();
+      add_tablets(i);
+      continue;
+    }
+    threads.emplace_back(std::move(thread));
+  }
+  add_tablets(0);
+  for (const auto& thread : threads) {
+    thread->Join();
+  }
+  LOG(INFO) << Substitute("loaded metadata for $0 tablets, adding the live ones to $1 tables",
+                          num_tablets_, batches.size());
+}
+
 bool TabletLoader::ConvertFromLegacy(PartitionPB* p) {
   if (p->hash_buckets_size() == 0) {
     return false;
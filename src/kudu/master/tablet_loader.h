@@ -16,11 +16,15 @@
 // under the License.
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <gtest/gtest_prod.h>
 
 #include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/master/sys_catalog.h"
 #include "kudu/util/status.h"
 
@@ -32,11 +36,16 @@ namespace master {
 
 class CatalogManager;
 class SysTabletsEntryPB;
+class TableInfo;
+class TabletInfo;
 
 ////////////////////////////////////////////////////////////
 // Tablet Loader
 ////////////////////////////////////////////////////////////
 
+// Loads the tablets of the system catalog into the maps of the catalog
+// manager. The tablets are added to their tables in batches once all of
+// them are visited, so Finish() must be called after visiting the tablets.
 class TabletLoader : public TabletVisitor {
  public:
   explicit TabletLoader(CatalogManager* catalog_manager);
@@ -44,6 +53,12 @@ class TabletLoader : public TabletVisitor {
   Status VisitTablet(const std::string& table_id,
                      const std::string& tablet_id,
                      const SysTabletsEntryPB& metadata) override;
+
+  // Adds the visited tablets which aren't deleted to their tables, the
+  // tablets of different tables being added concurrently by up to
+  // --catalog_manager_load_tablets_threads threads.
+  void Finish();
+
  private:
   FRIEND_TEST(SysCatalogTest, TabletRangesConversionFromLegacyFormat);
 
@@ -60,6 +75,13 @@ class TabletLoader : public TabletVisitor {
 
   CatalogManager* catalog_manager_;
 
+  // The visited tablets which aren't deleted, by table. The tables are kept
+  // alive by the table map of the catalog manager.
+  std::unordered_map<TableInfo*, std::vector<scoped_refptr<TabletInfo>>> tablets_by_table_;
+
+  // The number of visited tablets.
+  int64_t num_tablets_;
+
   DISALLOW_COPY_AND_ASSIGN(TabletLoader);
 };
 
@@ -31,6 +31,7 @@
 #include <google/protobuf/any.pb.h>
 #include <gtest/gtest.h>
 
+#include "kudu/gutil/basictypes.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/join.h"
@@ -58,6 +59,7 @@ DECLARE_string(ranger_jar_path);
 DECLARE_string(ranger_java_extra_args);
 DECLARE_bool(ranger_logtostdout);
 DECLARE_bool(ranger_overwrite_log_config);
+DECLARE_uint32(ranger_authz_decision_cache_ttl_ms);
 
 using boost::hash_combine;
 using kudu::env_util::ListFilesInDir;
@@ -191,6 +193,42 @@ TEST_F(RangerClientTest, TestAuthorizeCreateTableAuthorized) {
   ASSERT_TRUE(authorized);
 }
 
+// The decisions for single actions are cached until the policies are refreshed.
+TEST_F(RangerClientTest, TestAuthorizeActionCachesDecisions) {
+  FLAGS_ranger_authz_decision_cache_ttl_ms = 60 * 1000;
+  RangerClient client(env_, METRIC_ENTITY_server.Instantiate(&metric_registry_,
+                                                             "ranger_client-cache-test"));
+  std::unique_ptr<MockSubprocessServer> server(new MockSubprocessServer());
+  auto* next_response = &server->next_response_;
+  client.ReplaceServerForTests(std::move(server));
+
+  next_response_ = next_response;
+  Allow("jdoe", ActionPB::ALTER, "foo", "bar");
+  const auto authorize = [&](ActionPB action, const string& table, bool* authorized) {
+    return client.AuthorizeAction("jdoe", action, "foo", table, /*is_owner=*/false,
+                                  /*requires_delegate_admin=*/false, authorized);
+  };
+  bool authorized;
+  ASSERT_OK(authorize(ActionPB::ALTER, "bar", &authorized));
+  ASSERT_TRUE(authorized);
+
+  // Once revoked, the action is still authorized from the cache, unlike other
+  // actions or tables.
+  next_response->clear();
+  ASSERT_OK(authorize(ActionPB::ALTER, "bar", &authorized));
+  ASSERT_TRUE(authorized);
+  ASSERT_OK(authorize(ActionPB::DROP, "bar", &authorized));
+  ASSERT_FALSE(authorized);
+  ASSERT_OK(authorize(ActionPB::ALTER, "baz", &authorized));
+  ASSERT_FALSE(authorized);
+
+  // Refreshing the policies invalidates the cached decisions, even if the
+  // mock subprocess fails to refresh them.
+  ignore_result(client.RefreshPolicies());
+  ASSERT_OK(authorize(ActionPB::ALTER, "bar", &authorized));
+  ASSERT_FALSE(authorized);
+}
+
 TEST_F(RangerClientTest, TestAuthorizeListNoTables) {
   unordered_map<string, bool> tables;
   ASSERT_OK(client_.AuthorizeActionMultipleTables("jdoe", ActionPB::METADATA, &tables));
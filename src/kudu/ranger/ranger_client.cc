@@ -41,6 +41,7 @@
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
 #include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/path_util.h"
 #include "kudu/util/scoped_cleanup.h"
@@ -108,6 +109,22 @@ DEFINE_bool(ranger_crash_master_on_subprocess_failure, true,
             "Whether to crash the Master if the Ranger subprocess crashes.");
 TAG_FLAG(ranger_crash_master_on_subprocess_failure, advanced);
 
+DEFINE_uint32(ranger_authz_decision_cache_ttl_ms, 0,
+              "Time in milliseconds for which the master caches the decision of "
+              "the Ranger subprocess for an action of a user on a table, so that "
+              "repeated checks, e.g. bursts of DDL or GetTableSchema requests, "
+              "don't each go through the subprocess. Changes of the policies "
+              "may take as long to be enforced, unless the policies are refreshed "
+              "explicitly. If 0, the decisions aren't cached.");
+TAG_FLAG(ranger_authz_decision_cache_ttl_ms, advanced);
+TAG_FLAG(ranger_authz_decision_cache_ttl_ms, experimental);
+
+DEFINE_uint32(ranger_authz_decision_cache_capacity_mb, 1,
+              "Capacity in MiB of the cache of the decisions of the Ranger "
+              "subprocess. See --ranger_authz_decision_cache_ttl_ms.");
+TAG_FLAG(ranger_authz_decision_cache_capacity_mb, advanced);
+TAG_FLAG(ranger_authz_decision_cache_capacity_mb, experimental);
+
 DECLARE_int32(max_log_files);
 DECLARE_uint32(max_log_size);
 DECLARE_uint32(subprocess_max_message_size_bytes);
@@ -415,8 +432,16 @@ RangerSubprocessMetrics::RangerSubprocessMetrics(const scoped_refptr<MetricEntit
 #undef CINIT
 
 RangerClient::RangerClient(Env* env, const scoped_refptr<MetricEntity>& metric_entity)
-    : env_(env), metric_entity_(metric_entity) {
+    : env_(env), metric_entity_(metric_entity), policies_epoch_(0) {
   DCHECK(metric_entity);
+  if (FLAGS_ranger_authz_decision_cache_ttl_ms > 0 &&
+      FLAGS_ranger_authz_decision_cache_capacity_mb > 0) {
+    decision_cache_.reset(new DecisionCache(
+        FLAGS_ranger_authz_decision_cache_capacity_mb * 1024 * 1024,
+        MonoDelta::FromMilliseconds(FLAGS_ranger_authz_decision_cache_ttl_ms),
+        /*scrubbing_period=*/{}, /*max_scrubbed_entries_per_pass_num=*/0,
+        "ranger-authz-decision-cache"));
+  }
 }
 
 Status RangerClient::Start() {
@@ -438,6 +463,22 @@ Status RangerClient::AuthorizeAction(const string& user_name, const ActionPB& ac
                                      bool requires_delegate_admin, bool* authorized,
                                      Scope scope) {
   DCHECK(subprocess_);
+  string cache_key;
+  if (decision_cache_) {
+    // The names are prefixed with their lengths to keep the keys unambiguous.
+    const int flags = (is_owner ? 1 : 0) | (requires_delegate_admin ? 2 : 0) |
+                      (scope == Scope::TABLE ? 4 : 0);
+    cache_key = Substitute("$0/$1/$2/$3:$4/$5:$6/$7:$8",
+                           policies_epoch_.load(), action, flags,
+                           user_name.size(), user_name, database.size(), database,
+                           table.size(), table);
+    auto handle = decision_cache_->Get(cache_key);
+    if (handle) {
+      *authorized = handle.value();
+      return Status::OK();
+    }
+  }
+
   RangerRequestListPB req_list;
   RangerResponseListPB resp_list;
   req_list.set_user(user_name);
@@ -457,6 +498,9 @@ Status RangerClient::AuthorizeAction(const string& user_name, const ActionPB& ac
 
   CHECK_EQ(1, resp_list.responses_size());
   *authorized = resp_list.responses().begin()->allowed();
+  if (decision_cache_) {
+    decision_cache_->Put(cache_key, std::make_unique<bool>(*authorized));
+  }
   return Status::OK();
 }
 
@@ -585,7 +629,11 @@ Status RangerClient::RefreshPolicies() {
 
   req_list.mutable_control_request()->set_refresh_policies(true);
 
-  RETURN_NOT_OK(subprocess_->Execute(req_list, &resp_list));
+  Status s = subprocess_->Execute(req_list, &resp_list);
+  // Whether or not the policies could be refreshed, the decisions made so far
+  // may be stale.
+  policies_epoch_++;
+  RETURN_NOT_OK(s);
 
   if (PREDICT_TRUE(!resp_list.control_response().success())) {
     string err = resp_list.control_response().error();
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -30,6 +32,7 @@
 #include "kudu/subprocess/subprocess_proxy.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/status.h"
+#include "kudu/util/ttl_cache.h"
 
 namespace kudu {
 
@@ -84,6 +87,10 @@ class RangerClient {
 
   // Authorizes an action on the table. Sets 'authorized' to true if it's
   // authorized, false otherwise.
+  //
+  // If --ranger_authz_decision_cache_ttl_ms is positive, the decisions are
+  // cached for that long, so that repeated checks of the same action by the
+  // same user don't go through the subprocess.
   Status AuthorizeAction(const std::string& user_name, const ActionPB& action,
                          const std::string& database, const std::string& table, bool is_owner,
                          bool requires_delegate_admin, bool* authorized,
@@ -111,8 +118,9 @@ class RangerClient {
                           Scope scope = Scope::TABLE) WARN_UNUSED_RESULT;
 
   // Refreshes policies in the Ranger subprocess. This does not invalidate the
-  // existing cache and doesn't fail if Ranger service is unavailable, it simply
-  // tries to refresh the policies from the server on a best effort basis.
+  // existing cache of the subprocess and doesn't fail if Ranger service is
+  // unavailable, it simply tries to refresh the policies from the server on a
+  // best effort basis. The decisions cached by this client are invalidated.
   Status RefreshPolicies() WARN_UNUSED_RESULT;
 
   // Replaces the subprocess server in the subprocess proxy.
@@ -125,9 +133,20 @@ class RangerClient {
   }
 
  private:
+  // Cache of the decisions of AuthorizeAction(), keyed by the arguments of
+  // the checks and the policies epoch they were made in.
+  typedef TTLCache<std::string, bool> DecisionCache;
+
   Env* env_;
   std::unique_ptr<RangerSubprocess> subprocess_;
   scoped_refptr<MetricEntity> metric_entity_;
+
+  // Null if the decisions aren't cached.
+  std::unique_ptr<DecisionCache> decision_cache_;
+
+  // Incremented whenever the policies are refreshed, so that the decisions
+  // cached beforehand are no longer looked up.
+  std::atomic<uint64_t> policies_epoch_;
 };
 
 // Validate Ranger configuration.
@@ -33,6 +33,7 @@
 #include "kudu/rebalance/rebalancer.h"
 #include "kudu/util/test_macros.h"
 
+using kudu::cluster_summary::HealthCheckResult;
 using kudu::cluster_summary::ReplicaSummary;
 using kudu::cluster_summary::ServerHealthSummary;
 using kudu::cluster_summary::TableSummary;
@@ -705,5 +706,52 @@ TEST_F(KsckResultsToClusterBalanceInfoTest, RangeRebalancingInfo) {
   NO_FATALS(RunTest(Rebalancer::Config(), test_configs));
 }
 
+// Once the replica counts are balanced, the replica whose move evens out the
+// load of the tservers the most is moved, provided the improvement is large
+// enough.
+TEST(LoadBalancingMovesTest, EvenOutLoad) {
+  const KsckResultsInput input = {
+    { { "ts_0" }, { "ts_1" }, },
+    {
+      { "tablet_a", "table_0", "", { { "ts_0", true }, }, },
+      { "tablet_b", "table_0", "", { { "ts_0", true }, }, },
+      { "tablet_c", "table_0", "", { { "ts_1", true }, }, },
+    },
+    { { "table_0", 1 }, },
+  };
+  ClusterRawInfo raw_info = GenerateRawClusterInfo(input);
+  for (auto& s : raw_info.tablet_summaries) {
+    s.result = HealthCheckResult::HEALTHY;
+  }
+  raw_info.load_by_tablet_id = { { "tablet_a", 5.0 } };
+
+  // Moving 'tablet_a' would only swap the loads of the tservers, while moving
+  // 'tablet_b' reduces their difference from 5 to 3.
+  {
+    vector<Rebalancer::ReplicaMove> moves;
+    FindLoadBalancingMoves(raw_info, 1.0, 10, &moves);
+    ASSERT_EQ(1, moves.size());
+    EXPECT_EQ("tablet_b", moves[0].tablet_uuid);
+    EXPECT_EQ("ts_0", moves[0].ts_uuid_from);
+    EXPECT_EQ("ts_1", moves[0].ts_uuid_to);
+  }
+  {
+    vector<Rebalancer::ReplicaMove> moves;
+    FindLoadBalancingMoves(raw_info, 3.0, 10, &moves);
+    EXPECT_TRUE(moves.empty());
+  }
+
+  // No move unbalances the replica counts, however uneven the load.
+  TabletSummary tablet_d = raw_info.tablet_summaries[2];
+  tablet_d.id = "tablet_d";
+  raw_info.tablet_summaries.emplace_back(std::move(tablet_d));
+  raw_info.load_by_tablet_id = { { "tablet_a", 5.0 }, { "tablet_b", 5.0 } };
+  {
+    vector<Rebalancer::ReplicaMove> moves;
+    FindLoadBalancingMoves(raw_info, 1.0, 10, &moves);
+    EXPECT_TRUE(moves.empty());
+  }
+}
+
 } // namespace rebalance
 } // namespace kudu
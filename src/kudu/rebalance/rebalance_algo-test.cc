@@ -38,6 +38,7 @@
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/random.h"
 #include "kudu/util/status.h"
+#include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
@@ -1215,6 +1216,60 @@ TEST(RebalanceAlgoUnitTest, RandomizedTest) {
   }
 }
 
+// Plan the moves to balance a large synthetic cluster, where a few tablet
+// servers were added to a cluster with balanced tables. Applying the moves
+// to the state of the cluster must not dominate the planning time.
+TEST(RebalanceAlgoUnitTest, LargeClusterPlanningBenchmark) {
+  const auto num_tservers = AllowSlowTests() ? 2000 : 200;
+  const auto num_new_tservers = num_tservers / 10;
+  const auto num_tables = AllowSlowTests() ? 500 : 50;
+  const auto max_moves = AllowSlowTests() ? 20000 : 2000;
+  Random r(SeedRandom());
+  vector<string> tserver_uuids;
+  tserver_uuids.reserve(num_tservers);
+  for (auto i = 0; i < num_tservers; i++) {
+    tserver_uuids.push_back(Substitute("$0", i));
+  }
+  vector<TablePerServerReplicas> table_replicas;
+  table_replicas.reserve(num_tables);
+  for (auto i = 0; i < num_tables; i++) {
+    vector<size_t> num_replicas_per_server(num_tservers, 0);
+    for (auto j = 0; j < num_tservers - num_new_tservers; j++) {
+      num_replicas_per_server[j] = 5 + r.Uniform(5);
+    }
+    table_replicas.push_back(TablePerServerReplicas{
+        Substitute("$0", i), "", std::move(num_replicas_per_server) });
+  }
+  const TestClusterConfig cfg{
+    kNoLocations,
+    std::move(tserver_uuids),
+    std::move(table_replicas),
+    {}  // This test measures the planning time, not the path to balance.
+  };
+  ClusterInfo ci;
+  ClusterConfigToClusterInfo(cfg, &ci);
+
+  TwoDimensionalGreedyAlgo algo;
+  vector<TableReplicaMove> moves;
+  LOG_TIMING(INFO, Substitute("planning up to $0 moves for $1 tablet servers and $2 tables",
+                              max_moves, num_tservers, num_tables)) {
+    ASSERT_OK(algo.GetNextMoves(ci, max_moves, &moves));
+  }
+  ASSERT_EQ(max_moves, moves.size());
+
+  // The moves start filling the new tablet servers up with replicas.
+  const auto& servers_by_total_replica_count = ci.balance.servers_by_total_replica_count;
+  const auto get_skew = [&]() {
+    return servers_by_total_replica_count.rbegin()->first -
+        servers_by_total_replica_count.begin()->first;
+  };
+  const auto initial_skew = get_skew();
+  for (const auto& move : moves) {
+    ASSERT_OK(TwoDimensionalGreedyAlgo::ApplyMove(move, &ci.balance));
+  }
+  EXPECT_GT(initial_skew, get_skew());
+}
+
 // Location-based rebalancing, the case of few moves because of slight (if any)
 // location load imbalance.
 TEST(RebalanceAlgoUnitTest, LocationBalancingFewMoves) {
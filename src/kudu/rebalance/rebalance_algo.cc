@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <iterator>
 #include <limits>
@@ -57,53 +58,96 @@ namespace rebalance {
 
 namespace {
 
-// Applies to 'm' a move of a replica from the tablet server with id 'src' to
-// the tablet server with id 'dst' by decrementing the count of 'src' and
-// incrementing the count of 'dst'.
-// Returns Status::NotFound if either 'src' or 'dst' is not present in 'm'.
-Status MoveOneReplica(const string& src,
-                      const string& dst,
-                      ServersByCountMap* m) {
-  bool found_src = false;
-  bool found_dst = false;
-  int32_t count_src = 0;
-  int32_t count_dst = 0;
-  for (auto it = m->begin(); it != m->end(); ) {
-    if (it->second != src && it->second != dst) {
-      ++it;
-      continue;
-    }
-    auto count = it->first;
-    if (it->second == src) {
-      found_src = true;
-      count_src = count;
-    } else {
-      DCHECK_EQ(dst, it->second);
-      found_dst = true;
-      count_dst = count;
+// Applies moves to a ClusterBalanceInfo in logarithmic time, indexing the
+// entries of its containers by tablet server and by table. Re-inserting the
+// nodes of the containers keeps the entries being moved at the end of the
+// range of entries with the same count or skew, as re-creating them would.
+class BalanceInfoIndex {
+ public:
+  explicit BalanceInfoIndex(ClusterBalanceInfo* balance_info)
+      : balance_info_(balance_info) {
+    IndexServers(&balance_info_->servers_by_total_replica_count, &servers_);
+    auto& table_info_by_skew = balance_info_->table_info_by_skew;
+    for (auto it = table_info_by_skew.begin(); it != table_info_by_skew.end(); ++it) {
+      auto& table_index = tables_[{ it->second.table_id, it->second.tag }];
+      table_index.it = it;
+      IndexServers(&it->second.servers_by_replica_count, &table_index.servers);
     }
-    it = m->erase(it);
   }
-  if (!found_src) {
-    if (found_dst) {
-      // Preserving the original data in the container.
-      m->emplace(count_dst, dst);
+
+  // Applies 'move' to the indexed balance info. Leaves it unchanged on error.
+  Status ApplyMove(const TableReplicaMove& move) {
+    if (move.from == move.to) {
+      return Status::InvalidArgument(Substitute(
+          "moving a replica of table $0 from tablet server $1 to itself",
+          move.table_id, move.from));
+    }
+    auto* table_index = FindOrNull(tables_, TableIdAndTag{ move.table_id, move.tag });
+    if (!table_index) {
+      return Status::NotFound(Substitute(
+          "missing table info for table $0", move.table_id));
+    }
+    for (const auto* servers : { &servers_, &table_index->servers }) {
+      for (const auto* uuid : { &move.from, &move.to }) {
+        if (!ContainsKey(*servers, *uuid)) {
+          return Status::NotFound(
+              Substitute("missing information on table $0: no per-server counts "
+                         "for replica", move.table_id), *uuid);
+        }
+      }
     }
-    return Status::NotFound("no per-server counts for replica", src);
+
+    // Update the total counts.
+    MoveOneReplica(move.from, move.to,
+                   &balance_info_->servers_by_total_replica_count, &servers_);
+
+    // Update the table counts and skew.
+    auto& table_info_by_skew = balance_info_->table_info_by_skew;
+    auto node = table_info_by_skew.extract(table_index->it);
+    auto& servers_by_replica_count = node.mapped().servers_by_replica_count;
+    MoveOneReplica(move.from, move.to, &servers_by_replica_count, &table_index->servers);
+    const auto max_count = servers_by_replica_count.rbegin()->first;
+    const auto min_count = servers_by_replica_count.begin()->first;
+    DCHECK_GE(max_count, min_count);
+    node.key() = max_count - min_count;
+    table_index->it = table_info_by_skew.insert(std::move(node));
+    return Status::OK();
   }
-  if (!found_dst) {
-    if (found_src) {
-      // Preserving the original data in the container.
-      m->emplace(count_src, src);
+
+ private:
+  typedef unordered_map<string, ServersByCountMap::iterator> ServerIndex;
+
+  struct TableIndex {
+    multimap<int32_t, TableBalanceInfo>::iterator it;
+    ServerIndex servers;
+  };
+
+  static void IndexServers(ServersByCountMap* m, ServerIndex* index) {
+    for (auto it = m->begin(); it != m->end(); ++it) {
+      (*index)[it->second] = it;
     }
-    return Status::NotFound("no per-server counts for replica", dst);
   }
 
-  // Moving replica from 'src' to 'dst', updating the counter correspondingly.
-  m->emplace(count_src - 1, src);
-  m->emplace(count_dst + 1, dst);
-  return Status::OK();
-}
+  // Moves a replica from the tablet server with id 'src' to the one with id
+  // 'dst' by decrementing the count of 'src' and incrementing the count of
+  // 'dst' in 'm'. Both must be in 'index'.
+  static void MoveOneReplica(const string& src,
+                             const string& dst,
+                             ServersByCountMap* m,
+                             ServerIndex* index) {
+    auto src_node = m->extract(FindOrDie(*index, src));
+    auto dst_node = m->extract(FindOrDie(*index, dst));
+    --src_node.key();
+    ++dst_node.key();
+    (*index)[src] = m->insert(std::move(src_node));
+    (*index)[dst] = m->insert(std::move(dst_node));
+  }
+
+  ClusterBalanceInfo* balance_info_;
+  ServerIndex servers_;
+  unordered_map<TableIdAndTag, TableIndex, TableIdAndTagHash, TableIdAndTagEqual> tables_;
+};
+
 } // anonymous namespace
 
 size_t TableIdAndTagHash::operator()(const TableIdAndTag& idt) const noexcept {
@@ -152,8 +196,10 @@ Status RebalancingAlgo::GetNextMoves(const ClusterInfo& cluster_info,
     return Status::OK();
   }
 
-  // Copy cluster_info so we can apply moves to the copy.
+  // Copy cluster_info so we can apply moves to the copy, indexing it once
+  // rather than looking up its entries for every move.
   ClusterInfo info(cluster_info);
+  BalanceInfoIndex index(&info.balance);
   for (decltype(max_moves_num) i = 0; i < max_moves_num; ++i) {
     optional<TableReplicaMove> move;
     RETURN_NOT_OK(GetNextMove(info, &move));
@@ -161,7 +207,7 @@ Status RebalancingAlgo::GetNextMoves(const ClusterInfo& cluster_info,
       // No replicas to move.
       break;
     }
-    RETURN_NOT_OK(ApplyMove(*move, &info.balance));
+    RETURN_NOT_OK(index.ApplyMove(*move));
     moves->push_back(std::move(*move));
   }
   return Status::OK();
@@ -169,48 +215,8 @@ Status RebalancingAlgo::GetNextMoves(const ClusterInfo& cluster_info,
 
 Status RebalancingAlgo::ApplyMove(const TableReplicaMove& move,
                                   ClusterBalanceInfo* balance_info) {
-  // Copy cluster_info so we can apply moves to the copy.
-  ClusterBalanceInfo info(*DCHECK_NOTNULL(balance_info));
-
-  // Update the total counts.
-  RETURN_NOT_OK_PREPEND(
-      MoveOneReplica(move.from, move.to, &info.servers_by_total_replica_count),
-      Substitute("missing information on table $0", move.table_id));
-
-  // Find the balance info for the table.
-  auto& table_info_by_skew = info.table_info_by_skew;
-  TableBalanceInfo table_info;
-  bool found_table_info = false;
-  for (auto it = table_info_by_skew.begin(); it != table_info_by_skew.end(); ) {
-    TableBalanceInfo& info = it->second;
-    if (info.table_id != move.table_id || info.tag != move.tag) {
-      ++it;
-      continue;
-    }
-    std::swap(info, table_info);
-    it = table_info_by_skew.erase(it);
-    found_table_info = true;
-    break;
-  }
-  if (!found_table_info) {
-    return Status::NotFound(Substitute(
-        "missing table info for table $0", move.table_id));
-  }
-
-  // Update the table counts.
-  RETURN_NOT_OK_PREPEND(
-      MoveOneReplica(move.from, move.to, &table_info.servers_by_replica_count),
-      Substitute("missing information on table $0", move.table_id));
-
-  const auto max_count = table_info.servers_by_replica_count.rbegin()->first;
-  const auto min_count = table_info.servers_by_replica_count.begin()->first;
-  DCHECK_GE(max_count, min_count);
-
-  const int32_t skew = max_count - min_count;
-  table_info_by_skew.emplace(skew, std::move(table_info));
-  *balance_info = std::move(info);
-
-  return Status::OK();
+  BalanceInfoIndex index(DCHECK_NOTNULL(balance_info));
+  return index.ApplyMove(move);
 }
 
 TwoDimensionalGreedyAlgo::TwoDimensionalGreedyAlgo(EqualSkewOption opt)
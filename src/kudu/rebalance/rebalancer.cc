@@ -18,6 +18,7 @@
 #include "kudu/rebalance/rebalancer.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <iterator>
@@ -551,8 +552,23 @@ void BuildTabletExtraInfoMap(
       }
     }
     const auto rf = FindOrDie(replication_factors_by_table, s.table_id);
+    const auto load = FindWithDefault(raw_info.load_by_tablet_id, s.id, 1.0);
     EmplaceOrDie(extra_info_by_tablet_id,
-                 s.id, TabletExtraInfo{rf, num_voters});
+                 s.id, TabletExtraInfo{rf, num_voters, load});
+  }
+}
+
+void BuildServerLoadMap(
+    const ClusterRawInfo& raw_info,
+    std::unordered_map<std::string, double>* load_by_ts_id) {
+  for (const auto& s : raw_info.tserver_summaries) {
+    (*load_by_ts_id)[s.uuid] = 0;
+  }
+  for (const auto& s : raw_info.tablet_summaries) {
+    const auto load = FindWithDefault(raw_info.load_by_tablet_id, s.id, 1.0);
+    for (const auto& rs : s.replicas) {
+      (*load_by_ts_id)[rs.ts_uuid] += load;
+    }
   }
 }
 
@@ -562,20 +578,40 @@ Status SelectReplicaToMove(
     std::mt19937* random_generator,
     vector<string> tablet_ids,
     unordered_set<string>* tablets_in_move,
-    vector<Rebalancer::ReplicaMove>* replica_moves) {
+    vector<Rebalancer::ReplicaMove>* replica_moves,
+    unordered_map<string, double>* load_by_ts_id) {
 
   // Shuffle the set of the tablet identifiers: that's to achieve even spread
   // of moves across tables with the same skew.
   std::shuffle(tablet_ids.begin(), tablet_ids.end(), *random_generator);
+
+  // Moving a replica with load w changes the load difference between the
+  // source and the destination tservers from d to d - 2w: prefer the replica
+  // which brings it the closest to 0. Among equally good ones, the first one
+  // is chosen.
+  const double load_diff = load_by_ts_id
+      ? FindWithDefault(*load_by_ts_id, move.from, 0.0) -
+        FindWithDefault(*load_by_ts_id, move.to, 0.0)
+      : 0;
   string move_tablet_id;
+  double move_load = 0;
+  double best_load_diff_after_move = numeric_limits<double>::max();
   for (const auto& tablet_id : tablet_ids) {
-    if (!ContainsKey(*tablets_in_move, tablet_id)) {
-      // For now, choose the very first tablet that does not have replicas
-      // in move. Later on, additional logic might be added to find
-      // the best candidate.
+    if (ContainsKey(*tablets_in_move, tablet_id)) {
+      continue;
+    }
+    const double load = FindOrDie(extra_info_by_tablet_id, tablet_id).load;
+    if (!load_by_ts_id) {
       move_tablet_id = tablet_id;
+      move_load = load;
       break;
     }
+    const double load_diff_after_move = std::abs(load_diff - 2 * load);
+    if (load_diff_after_move < best_load_diff_after_move) {
+      best_load_diff_after_move = load_diff_after_move;
+      move_tablet_id = tablet_id;
+      move_load = load;
+    }
   }
   if (move_tablet_id.empty()) {
     return Status::NotFound(Substitute(
@@ -596,6 +632,12 @@ Status SelectReplicaToMove(
   } else {
     move_info.ts_uuid_to = move.to;
   }
+  if (load_by_ts_id) {
+    (*load_by_ts_id)[move_info.ts_uuid_from] -= move_load;
+    if (!move_info.ts_uuid_to.empty()) {
+      (*load_by_ts_id)[move_info.ts_uuid_to] += move_load;
+    }
+  }
   replica_moves->emplace_back(std::move(move_info));
   // Mark the tablet as 'has a replica in move'.
   tablets_in_move->emplace(std::move(move_tablet_id));
@@ -603,5 +645,93 @@ Status SelectReplicaToMove(
   return Status::OK();
 }
 
+void FindLoadBalancingMoves(
+    const ClusterRawInfo& raw_info,
+    double min_load_improvement,
+    int max_moves,
+    vector<Rebalancer::ReplicaMove>* replica_moves) {
+  unordered_map<string, double> load_by_ts_id;
+  BuildServerLoadMap(raw_info, &load_by_ts_id);
+
+  // The replica counts, in total and per table, and the healthy tablets
+  // whose replicas are hosted by each tserver.
+  unordered_map<string, int> count_by_ts_id;
+  unordered_map<string, unordered_map<string, int>> count_by_table_and_ts_id;
+  unordered_map<string, vector<const cluster_summary::TabletSummary*>> tablets_by_ts_id;
+  for (const auto& s : raw_info.tablet_summaries) {
+    for (const auto& rs : s.replicas) {
+      ++count_by_ts_id[rs.ts_uuid];
+      ++count_by_table_and_ts_id[s.table_id][rs.ts_uuid];
+      if (s.result == HealthCheckResult::HEALTHY) {
+        tablets_by_ts_id[rs.ts_uuid].push_back(&s);
+      }
+    }
+  }
+
+  // Only the tservers of 'raw_info' take part in the moves, even if some
+  // tablets have replicas elsewhere.
+  vector<string> ts_ids_by_load;
+  ts_ids_by_load.reserve(raw_info.tserver_summaries.size());
+  for (const auto& s : raw_info.tserver_summaries) {
+    ts_ids_by_load.push_back(s.uuid);
+  }
+  std::sort(ts_ids_by_load.begin(), ts_ids_by_load.end(),
+            [&](const string& lhs, const string& rhs) {
+              return load_by_ts_id[lhs] > load_by_ts_id[rhs];
+            });
+
+  // Pair the most loaded tservers with the least loaded ones.
+  unordered_set<string> ts_ids_in_move;
+  int num_moves = 0;
+  for (const auto& from : ts_ids_by_load) {
+    if (num_moves >= max_moves) {
+      return;
+    }
+    if (ContainsKey(ts_ids_in_move, from)) {
+      continue;
+    }
+    for (auto to_it = ts_ids_by_load.rbegin(); to_it != ts_ids_by_load.rend(); ++to_it) {
+      const auto& to = *to_it;
+      const double load_diff = load_by_ts_id[from] - load_by_ts_id[to];
+      if (load_diff < min_load_improvement) {
+        // The remaining tservers are loaded even more.
+        break;
+      }
+      if (ContainsKey(ts_ids_in_move, to) || count_by_ts_id[from] <= count_by_ts_id[to]) {
+        continue;
+      }
+      const cluster_summary::TabletSummary* best = nullptr;
+      double best_improvement = min_load_improvement;
+      for (const auto* tablet : tablets_by_ts_id[from]) {
+        const auto& counts = count_by_table_and_ts_id[tablet->table_id];
+        if (FindWithDefault(counts, from, 0) <= FindWithDefault(counts, to, 0) ||
+            std::any_of(tablet->replicas.begin(), tablet->replicas.end(),
+                        [&](const cluster_summary::ReplicaSummary& rs) {
+                          return rs.ts_uuid == to;
+                        })) {
+          continue;
+        }
+        const double load = FindWithDefault(raw_info.load_by_tablet_id, tablet->id, 1.0);
+        const double improvement = load_diff - std::abs(load_diff - 2 * load);
+        if (improvement >= best_improvement) {
+          best_improvement = improvement;
+          best = tablet;
+        }
+      }
+      if (best) {
+        Rebalancer::ReplicaMove move_info;
+        move_info.tablet_uuid = best->id;
+        move_info.ts_uuid_from = from;
+        move_info.ts_uuid_to = to;
+        replica_moves->emplace_back(std::move(move_info));
+        ++num_moves;
+        ts_ids_in_move.emplace(from);
+        ts_ids_in_move.emplace(to);
+        break;
+      }
+    }
+  }
+}
+
 } // namespace rebalance
 } // namespace kudu
@@ -42,6 +42,11 @@ struct ClusterRawInfo {
   std::vector<cluster_summary::TableSummary> table_summaries;
   std::vector<cluster_summary::TabletSummary> tablet_summaries;
   std::unordered_set<std::string> tservers_in_maintenance_mode;
+
+  // The load of the tablets, by tablet ID, relative to the load of an average
+  // tablet. The load of a replica is the load of its tablet. If a tablet isn't
+  // in the map, its load is unknown: it's considered as an average one.
+  std::unordered_map<std::string, double> load_by_tablet_id;
 };
 
 // A class implementing logic for Kudu cluster rebalancing.
@@ -274,6 +279,8 @@ class Rebalancer {
 struct TabletExtraInfo {
   int replication_factor;
   int num_voters;
+  // The load of the tablet, as in ClusterRawInfo::load_by_tablet_id.
+  double load;
 };
 
 // Populate a 'tablet_id' --> 'target tablet replication factor' map.
@@ -281,10 +288,18 @@ void BuildTabletExtraInfoMap(
     const ClusterRawInfo& raw_info,
     std::unordered_map<std::string, TabletExtraInfo>* extra_info_by_tablet_id);
 
+// Populate a 'tserver UUID' --> 'sum of the loads of its replicas' map.
+void BuildServerLoadMap(
+    const ClusterRawInfo& raw_info,
+    std::unordered_map<std::string, double>* load_by_ts_id);
+
 // For a given table, find a tablet replica on a specified tserver to move
 // to another. Given the requested 'move', shuffle the table's tablet_ids
-// and select the first tablet that doesn't currently have any replicas in
-// 'tablets_in_move'. Add the tablet's id to 'tablets_in_move' and add
+// and, among the tablets that don't currently have any replicas in
+// 'tablets_in_move', select the one whose move evens out the load of the
+// source and destination tservers the most as per 'load_by_ts_id', or the
+// first one if 'load_by_ts_id' is null. Add the tablet's id to
+// 'tablets_in_move', update 'load_by_ts_id' with the move, and add
 // information about this move to 'replica_moves'. If the chosen tablet is
 // overreplicated, no destination tserver is specified, in case it is better
 // to just remove it from the replica distribution entirely.
@@ -294,6 +309,20 @@ Status SelectReplicaToMove(
     std::mt19937* random_generator,
     std::vector<std::string> tablet_ids,
     std::unordered_set<std::string>* tablets_in_move,
+    std::vector<Rebalancer::ReplicaMove>* replica_moves,
+    std::unordered_map<std::string, double>* load_by_ts_id = nullptr);
+
+// Find moves of replicas of healthy tablets which even out the load of the
+// tservers in 'raw_info' without making the distribution of the replica
+// counts any worse: a replica is only moved to a tserver which hosts fewer
+// replicas than the source tserver, both in total and of the replica's table.
+// A move must reduce the load difference between its source and destination
+// tservers by at least 'min_load_improvement'. No more than 'max_moves' moves
+// are added to 'replica_moves', and a tserver takes part in at most one move.
+void FindLoadBalancingMoves(
+    const ClusterRawInfo& raw_info,
+    double min_load_improvement,
+    int max_moves,
     std::vector<Rebalancer::ReplicaMove>* replica_moves);
 
 } // namespace rebalance
@@ -18,6 +18,7 @@
 #include "kudu/rpc/acceptor_pool.h"
 
 #include <functional>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -47,6 +48,7 @@ class Message;
 
 using google::protobuf::Message;
 using std::string;
+using std::unique_ptr;
 
 METRIC_DEFINE_counter(server, rpc_connections_accepted,
                       "RPC Connections Accepted",
@@ -69,6 +71,16 @@ DEFINE_int32(rpc_acceptor_listen_backlog, 128,
              "new inbound connection requests.");
 TAG_FLAG(rpc_acceptor_listen_backlog, advanced);
 
+DEFINE_bool(rpc_acceptor_reuseport_sharding, false,
+            "Whether each RPC acceptor thread accepts connections on a listening "
+            "socket of its own, all bound to the same address with SO_REUSEPORT. "
+            "The kernel then spreads the inbound connections across the acceptors "
+            "instead of having them contend on a single socket. Only applies to "
+            "IP addresses, and only matters with --rpc_num_acceptors_per_address "
+            "greater than 1.");
+TAG_FLAG(rpc_acceptor_reuseport_sharding, advanced);
+TAG_FLAG(rpc_acceptor_reuseport_sharding, experimental);
+
 namespace kudu {
 namespace rpc {
 
@@ -91,10 +103,27 @@ AcceptorPool::~AcceptorPool() {
 Status AcceptorPool::Start(int num_threads) {
   RETURN_NOT_OK(socket_.Listen(FLAGS_rpc_acceptor_listen_backlog));
 
+  if (FLAGS_rpc_acceptor_reuseport_sharding && bind_address_.is_ip()) {
+    // Bind to the actual address, in case the port was picked by the kernel.
+    Sockaddr bound_addr;
+    RETURN_NOT_OK(socket_.GetSocketAddress(&bound_addr));
+    for (int i = 1; i < num_threads; i++) {
+      unique_ptr<Socket> sock(new Socket);
+      RETURN_NOT_OK(sock->Init(bound_addr.family(), 0));
+      RETURN_NOT_OK(sock->SetReuseAddr(true));
+      RETURN_NOT_OK(sock->SetReusePort(true));
+      RETURN_NOT_OK_PREPEND(sock->Bind(bound_addr),
+                            "unable to bind an additional acceptor socket");
+      RETURN_NOT_OK(sock->Listen(FLAGS_rpc_acceptor_listen_backlog));
+      shard_sockets_.emplace_back(std::move(sock));
+    }
+  }
+
   for (int i = 0; i < num_threads; i++) {
+    Socket* sock = i == 0 || shard_sockets_.empty() ? &socket_ : shard_sockets_[i - 1].get();
     scoped_refptr<kudu::Thread> new_thread;
     Status s = kudu::Thread::Create("acceptor pool", "acceptor",
-                                    [this]() { this->RunThread(); }, &new_thread);
+                                    [this, sock]() { this->RunThread(sock); }, &new_thread);
     if (!s.ok()) {
       Shutdown();
       return s;
@@ -117,6 +146,11 @@ void AcceptorPool::Shutdown() {
   WARN_NOT_OK(socket_.Shutdown(true, true),
               strings::Substitute("Could not shut down acceptor socket on $0",
                                   bind_address_.ToString()));
+  for (const auto& sock : shard_sockets_) {
+    WARN_NOT_OK(sock->Shutdown(true, true),
+                strings::Substitute("Could not shut down acceptor socket on $0",
+                                    bind_address_.ToString()));
+  }
 #else
   // Calling shutdown on an accepting (non-connected) socket is illegal on most
   // platforms (but not Linux). Instead, the accepting threads are interrupted
@@ -140,6 +174,10 @@ void AcceptorPool::Shutdown() {
   // here, it would  necessary to wait until Messenger::Shutdown() is called for
   // the corresponding messenger object to close this socket.
   ignore_result(socket_.Close());
+  for (const auto& sock : shard_sockets_) {
+    ignore_result(sock->Close());
+  }
+  shard_sockets_.clear();
 }
 
 Sockaddr AcceptorPool::bind_address() const {
@@ -154,13 +192,13 @@ int64_t AcceptorPool::num_rpc_connections_accepted() const {
   return rpc_connections_accepted_->value();
 }
 
-void AcceptorPool::RunThread() {
+void AcceptorPool::RunThread(Socket* socket) {
   while (true) {
     Socket new_sock;
     Sockaddr remote;
-    VLOG(2) << "calling accept() on socket " << socket_.GetFd()
+    VLOG(2) << "calling accept() on socket " << socket->GetFd()
             << " listening on " << bind_address_.ToString();
-    Status s = socket_.Accept(&new_sock, &remote, Socket::FLAG_NONBLOCKING);
+    Status s = socket->Accept(&new_sock, &remote, Socket::FLAG_NONBLOCKING);
     if (!s.ok()) {
       if (Release_Load(&closing_)) {
         break;
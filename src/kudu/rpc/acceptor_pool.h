@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "kudu/gutil/atomicops.h"
@@ -47,6 +48,9 @@ class AcceptorPool {
   ~AcceptorPool();
 
   // Start listening and accepting connections.
+  //
+  // With --rpc_acceptor_reuseport_sharding, each thread but the first accepts
+  // on a socket of its own, bound to the same address with SO_REUSEPORT.
   Status Start(int num_threads);
   void Shutdown();
 
@@ -63,10 +67,13 @@ class AcceptorPool {
   int64_t num_rpc_connections_accepted() const;
 
  private:
-  void RunThread();
+  void RunThread(Socket* socket);
 
   Messenger *messenger_;
   Socket socket_;
+  // The additional listening sockets when sharding the accepts with
+  // SO_REUSEPORT, if any.
+  std::vector<std::unique_ptr<Socket>> shard_sockets_;
   Sockaddr bind_address_;
   std::vector<scoped_refptr<kudu::Thread> > threads_;
 
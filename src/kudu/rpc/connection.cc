@@ -214,6 +214,7 @@ Connection::Connection(ReactorThread *reactor_thread,
       credentials_policy_(policy),
       negotiation_complete_(false),
       is_confidential_(false),
+      body_codec_(nullptr),
       scheduled_for_shutdown_(false) {
 }
 
@@ -489,7 +490,7 @@ void Connection::QueueOutboundCall(shared_ptr<OutboundCall> call) {
 
   // Serialize the actual bytes to be put on the wire.
   TransferPayload tmp_slices;
-  call->SerializeTo(&tmp_slices);
+  call->SerializeTo(body_codec_, &tmp_slices);
 
   call->SetQueued();
 
@@ -45,6 +45,8 @@
 
 namespace kudu {
 
+class CompressionCodec;
+
 namespace rpc {
 
 class DumpConnectionsRequestPB;
@@ -167,6 +169,14 @@ class Connection : public RefCountedThreadSafe<Connection> {
   // Set/unset the 'confidentiality' property for this connection.
   void set_confidential(bool is_confidential);
 
+  // The codec to compress the bodies of the calls or responses sent over this
+  // connection, or nullptr if they're sent uncompressed.
+  const CompressionCodec* body_codec() const { return body_codec_; }
+
+  // Sets the codec returned by body_codec(). Must be set, if at all, before
+  // the connection is used to send calls or responses.
+  void set_body_codec(const CompressionCodec* codec) { body_codec_ = codec; }
+
   // Credentials policy to start connection negotiation.
   CredentialsPolicy credentials_policy() const { return credentials_policy_; }
 
@@ -411,6 +421,9 @@ class Connection : public RefCountedThreadSafe<Connection> {
   // is considered confidential.
   bool is_confidential_;
 
+  // See body_codec().
+  const CompressionCodec* body_codec_;
+
   // Whether the connection is scheduled for shutdown.
   bool scheduled_for_shutdown_;
 };
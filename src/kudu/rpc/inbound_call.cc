@@ -21,6 +21,7 @@
 #include <limits>
 #include <memory>
 #include <ostream>
+#include <vector>
 
 #include <boost/container/vector.hpp>
 #include <glog/logging.h>
@@ -36,6 +37,8 @@
 #include "kudu/rpc/serialization.h"
 #include "kudu/rpc/service_if.h"
 #include "kudu/rpc/transfer.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/net/sockaddr.h"
@@ -73,7 +76,9 @@ InboundCall::InboundCall(Connection* conn)
   RecordCallReceived();
 }
 
-InboundCall::~InboundCall() {}
+InboundCall::~InboundCall() {
+  TransferBufferPool::Release(std::move(response_msg_buf_));
+}
 
 Status InboundCall::ParseFrom(unique_ptr<InboundTransfer> transfer) {
   TRACE_EVENT_FLOW_BEGIN0("rpc", "InboundCall", this);
@@ -81,6 +86,13 @@ Status InboundCall::ParseFrom(unique_ptr<InboundTransfer> transfer) {
 
   TRACE_EVENT0("rpc", "InboundCall::ParseFrom");
   RETURN_NOT_OK(serialization::ParseMessage(transfer->data(), &header_, &serialized_request_));
+  if (header_.has_body_compression()) {
+    RETURN_NOT_OK(serialization::UncompressBody(header_.body_compression(),
+                                                serialized_request_,
+                                                header_.uncompressed_body_size(),
+                                                &uncompressed_body_));
+    serialized_request_ = Slice(uncompressed_body_);
+  }
 
   // Adopt the service/method info from the header as soon as it's available.
   if (PREDICT_FALSE(!header_.has_remote_method())) {
@@ -202,9 +214,37 @@ void InboundCall::SerializeResponseBuffer(const MessageLite& response,
     sidecar_byte_size += sidecar_bytes;
   }
 
+  // The message is prefixed by its varint32 length.
+  const size_t response_msg_buf_size = protobuf_msg_size + 5;
+  if (response_msg_buf_.capacity() < response_msg_buf_size) {
+    response_msg_buf_ = TransferBufferPool::Acquire(response_msg_buf_size);
+  }
   serialization::SerializeMessage(response, &response_msg_buf_,
                                   sidecar_byte_size, true);
   int64_t main_msg_size = sidecar_byte_size + response_msg_buf_.size();
+
+  response_compressed_body_buf_.clear();
+  const CompressionCodec* codec = conn_->body_codec();
+  if (codec) {
+    // The body to compress is what follows the varint delimiter of the message.
+    Slice msg(response_msg_buf_);
+    uint32_t body_size;
+    CHECK(GetVarint32(&msg, &body_size));
+    TransferPayload sidecar_slices;
+    for (const auto& car : outbound_sidecars_) {
+      car->AppendSlices(&sidecar_slices);
+    }
+    vector<Slice> body = { msg };
+    body.insert(body.end(), sidecar_slices.begin(), sidecar_slices.end());
+    if (serialization::CompressBody(*codec, body, body_size,
+                                    &response_compressed_body_buf_)) {
+      resp_hdr.set_body_compression(codec->type());
+      resp_hdr.set_uncompressed_body_size(body_size);
+      main_msg_size = response_compressed_body_buf_.size();
+    } else {
+      response_compressed_body_buf_.clear();
+    }
+  }
   serialization::SerializeHeader(resp_hdr, main_msg_size,
                                  &response_hdr_buf_);
 }
@@ -214,6 +254,10 @@ void InboundCall::SerializeResponseTo(TransferPayload* slices) const {
   DCHECK_GT(response_hdr_buf_.size(), 0);
   DCHECK_GT(response_msg_buf_.size(), 0);
   slices->push_back(Slice(response_hdr_buf_));
+  if (!response_compressed_body_buf_.empty()) {
+    slices->push_back(Slice(response_compressed_body_buf_));
+    return;
+  }
   slices->push_back(Slice(response_msg_buf_));
   for (auto& sidecar : outbound_sidecars_) {
     sidecar->AppendSlices(slices);
@@ -359,6 +403,8 @@ Status InboundCall::GetInboundSidecar(int idx, Slice* sidecar) const {
 
 void InboundCall::DiscardTransfer() {
   transfer_.reset();
+  uncompressed_body_.clear();
+  uncompressed_body_.shrink_to_fit();
 }
 
 size_t InboundCall::GetTransferSize() {
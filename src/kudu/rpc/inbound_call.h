@@ -253,7 +253,8 @@ class InboundCall {
   RequestHeader header_;
 
   // The serialized bytes of the request param protobuf. Set by ParseFrom().
-  // This references memory held by 'transfer_'.
+  // This references memory held by 'transfer_', or by 'uncompressed_body_' if
+  // the request was compressed.
   Slice serialized_request_;
 
   // The transfer that produced the call.
@@ -261,10 +262,18 @@ class InboundCall {
   // by 'serialized_request_' above.
   std::unique_ptr<InboundTransfer> transfer_;
 
+  // The uncompressed body of the request, if it was compressed.
+  faststring uncompressed_body_;
+
   // The buffers for serialized response. Set by SerializeResponseBuffer().
   faststring response_hdr_buf_;
   faststring response_msg_buf_;
 
+  // The compressed body of the response, if it's compressed, in which case
+  // it's sent instead of 'response_msg_buf_' and the sidecars. Set by
+  // SerializeResponseBuffer().
+  faststring response_compressed_body_buf_;
+
   // Vector of additional sidecars that are tacked on to the call's response
   // after serialization of the protobuf. See rpc/rpc_sidecar.h for more info.
   std::vector<std::unique_ptr<RpcSidecar>> outbound_sidecars_;
@@ -25,6 +25,7 @@
 #include <type_traits>
 #include <utility>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/map-util.h"
@@ -54,6 +55,8 @@
 #include "kudu/util/thread_restrictions.h"
 #include "kudu/util/threadpool.h"
 
+DECLARE_bool(rpc_acceptor_reuseport_sharding);
+
 using kudu::security::RpcAuthentication;
 using kudu::security::RpcEncryption;
 using std::string;
@@ -216,7 +219,7 @@ Status Messenger::AddAcceptorPool(const Sockaddr& accept_addr,
   Socket sock;
   RETURN_NOT_OK(sock.Init(accept_addr.family(), 0));
   RETURN_NOT_OK(sock.SetReuseAddr(true));
-  if (reuseport_) {
+  if (reuseport_ || (FLAGS_rpc_acceptor_reuseport_sharding && accept_addr.is_ip())) {
     RETURN_NOT_OK(sock.SetReusePort(true));
   }
   RETURN_NOT_OK(sock.Bind(accept_addr));
@@ -25,12 +25,14 @@
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <set>
 #include <string>
 #include <utility>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/client_negotiation.h"
@@ -44,6 +46,8 @@
 #include "kudu/rpc/user_credentials.h"
 #include "kudu/security/tls_context.h"
 #include "kudu/security/token.pb.h"
+#include "kudu/util/compression/compression.pb.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/errno.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
@@ -51,6 +55,7 @@
 #include "kudu/util/net/socket.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
+#include "kudu/util/string_case.h"
 #include "kudu/util/trace.h"
 
 DEFINE_bool(rpc_trace_negotiation, false,
@@ -72,8 +77,38 @@ DEFINE_bool(rpc_encrypt_loopback_connections, false,
             "an attacker.");
 TAG_FLAG(rpc_encrypt_loopback_connections, advanced);
 
+DEFINE_string(rpc_compression_codec, "no_compression",
+              "Codec used to compress the bodies of the RPC calls and responses "
+              "larger than --rpc_compression_min_bytes, including their sidecars, "
+              "sent over the connections negotiated from then on, if the remote "
+              "side supports it. One of 'no_compression', 'lz4', 'snappy', 'zlib' "
+              "or 'zstd'. Compression trades CPU for network bandwidth, which is "
+              "mostly worth it across slow or costly links.");
+TAG_FLAG(rpc_compression_codec, advanced);
+TAG_FLAG(rpc_compression_codec, experimental);
+TAG_FLAG(rpc_compression_codec, runtime);
+
+static bool ValidateCompressionCodec(const char* flagname, const string& value) {
+  string uvalue;
+  ToUpperCase(value, &uvalue);
+  if (uvalue != "NO_COMPRESSION" && uvalue != "LZ4" && uvalue != "SNAPPY" &&
+      uvalue != "ZLIB" && uvalue != "ZSTD") {
+    LOG(ERROR) << Substitute("$0: unknown compression codec '$1'", flagname, value);
+    return false;
+  }
+  return true;
+}
+DEFINE_validator(rpc_compression_codec, &ValidateCompressionCodec);
+
+DEFINE_bool(rpc_compress_loopback_connections, false,
+            "Whether to compress the RPC calls and responses sent on connections "
+            "that stay within a single host, when --rpc_compression_codec is set.");
+TAG_FLAG(rpc_compress_loopback_connections, advanced);
+TAG_FLAG(rpc_compress_loopback_connections, experimental);
+
 using kudu::security::RpcAuthentication;
 using kudu::security::RpcEncryption;
+using std::set;
 using std::string;
 using std::unique_ptr;
 using strings::Substitute;
@@ -96,6 +131,21 @@ std::ostream& operator<<(std::ostream& o, AuthenticationType authentication_type
   return o << AuthenticationTypeToString(authentication_type);
 }
 
+// Returns the codec to compress the bodies of what's sent on the connection
+// over 'socket' to a remote supporting the 'remote_features', or nullptr if they
+// shouldn't be compressed.
+static const CompressionCodec* NegotiatedBodyCodec(const set<RpcFeatureFlag>& remote_features,
+                                                   const Socket& socket) {
+  if (!ContainsKey(remote_features, BODY_COMPRESSION) ||
+      (socket.IsLoopbackConnection() && !FLAGS_rpc_compress_loopback_connections)) {
+    return nullptr;
+  }
+  const CompressionCodec* codec = nullptr;
+  WARN_NOT_OK(GetCompressionCodec(GetCompressionCodecType(FLAGS_rpc_compression_codec), &codec),
+              "unable to get the RPC compression codec");
+  return codec;
+}
+
 // Wait for the client connection to be established and become ready for writing.
 static Status WaitForClientConnect(Socket* socket, const MonoTime& deadline) {
   TRACE("Waiting for socket to connect");
@@ -227,7 +277,9 @@ static Status DoClientNegotiation(Connection* conn,
 
   // Transfer the negotiated socket and state back to the connection.
   conn->adopt_socket(client_negotiation.release_socket());
-  conn->set_remote_features(client_negotiation.take_server_features());
+  auto server_features = client_negotiation.take_server_features();
+  conn->set_body_codec(NegotiatedBodyCodec(server_features, *conn->socket()));
+  conn->set_remote_features(std::move(server_features));
   conn->set_confidential(client_negotiation.tls_negotiated() ||
       (conn->socket()->IsLoopbackConnection() && !FLAGS_rpc_encrypt_loopback_connections));
 
@@ -290,7 +342,9 @@ static Status DoServerNegotiation(Connection* conn,
 
   // Transfer the negotiated socket and state back to the connection.
   conn->adopt_socket(server_negotiation.release_socket());
-  conn->set_remote_features(server_negotiation.take_client_features());
+  auto client_features = server_negotiation.take_client_features();
+  conn->set_body_codec(NegotiatedBodyCodec(client_features, *conn->socket()));
+  conn->set_remote_features(std::move(client_features));
   conn->set_remote_user(server_negotiation.take_authenticated_user());
   conn->set_confidential(server_negotiation.tls_negotiated() ||
       (conn->socket()->IsLoopbackConnection() && !FLAGS_rpc_encrypt_loopback_connections));
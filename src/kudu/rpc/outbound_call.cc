@@ -43,6 +43,8 @@
 #include "kudu/rpc/rpc_sidecar.h"
 #include "kudu/rpc/serialization.h"
 #include "kudu/rpc/transfer.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/kernel_stack_watchdog.h"
 #include "kudu/util/net/sockaddr.h"
@@ -126,10 +128,15 @@ OutboundCall::~OutboundCall() {
   DVLOG(4) << "OutboundCall " << this << " destroyed with state_: " << StateName(state_);
 }
 
-void OutboundCall::SerializeTo(TransferPayload* slices) {
+void OutboundCall::SerializeTo(const CompressionCodec* codec, TransferPayload* slices) {
   DCHECK_LT(0, payload_->request_buf_.size())
       << "Must call SetRequestPayload() before SerializeTo()";
 
+  // The payload may have been sent on another connection before.
+  payload_->header_.clear_body_compression();
+  payload_->header_.clear_uncompressed_body_size();
+  payload_->compressed_body_buf_.clear();
+
   if (controller_->timeout().Initialized()) {
     payload_->header_.set_timeout_millis(controller_->timeout().ToMilliseconds());
   }
@@ -139,16 +146,37 @@ void OutboundCall::SerializeTo(TransferPayload* slices) {
   }
 
   DCHECK_LE(0, payload_->sidecar_byte_size_);
-  serialization::SerializeHeader(
-      payload_->header_, payload_->sidecar_byte_size_ + payload_->request_buf_.size(),
-      &payload_->header_buf_);
-
   slices->clear();
-  slices->push_back(payload_->header_buf_);
   slices->push_back(payload_->request_buf_);
+  for (auto& field : payload_->request_fields_) {
+    field->AppendSlices(slices);
+  }
   for (auto& sidecar : payload_->sidecars_) {
     sidecar->AppendSlices(slices);
   }
+
+  if (codec) {
+    // The body to compress is what follows the varint delimiter of the message.
+    Slice msg(payload_->request_buf_);
+    uint32_t body_size;
+    CHECK(GetVarint32(&msg, &body_size));
+    vector<Slice> body(slices->begin(), slices->end());
+    body[0] = msg;
+    if (serialization::CompressBody(*codec, body, body_size,
+                                    &payload_->compressed_body_buf_)) {
+      payload_->header_.set_body_compression(codec->type());
+      payload_->header_.set_uncompressed_body_size(body_size);
+      slices->clear();
+      slices->push_back(payload_->compressed_body_buf_);
+    }
+  }
+
+  size_t body_len = 0;
+  for (const auto& s : *slices) {
+    body_len += s.size();
+  }
+  serialization::SerializeHeader(payload_->header_, body_len, &payload_->header_buf_);
+  slices->insert(slices->begin(), Slice(payload_->header_buf_));
 }
 
 RequestPayload::RequestPayload(const RemoteMethod& remote_method) {
@@ -159,22 +187,32 @@ RequestPayload::RequestPayload(const RemoteMethod& remote_method) {
 unique_ptr<RequestPayload> RequestPayload::CreateRequestPayload(
     const RemoteMethod& remote_method,
     const Message& req,
-    vector<unique_ptr<RpcSidecar>>&& sidecars) {
+    vector<unique_ptr<RpcSidecar>>&& sidecars,
+    vector<unique_ptr<RpcSidecar>>&& request_fields) {
   auto payload = std::make_unique<RequestPayload>(remote_method);
-  payload->PopulateRequestPayload(req, std::move(sidecars));
+  payload->PopulateRequestPayload(req, std::move(sidecars), std::move(request_fields));
   return payload;
 }
 
 void RequestPayload::PopulateRequestPayload(const Message& req,
-    vector<unique_ptr<RpcSidecar>>&& sidecars) {
+    vector<unique_ptr<RpcSidecar>>&& sidecars,
+    vector<unique_ptr<RpcSidecar>>&& request_fields) {
   DCHECK_EQ(-1, sidecar_byte_size_);
 
   sidecars_ = move(sidecars);
   DCHECK_LE(sidecars_.size(), TransferLimits::kMaxSidecars);
 
+  // The serialized fields follow the serialized 'req': the server parses them
+  // as part of the request message, which ends where the sidecars start.
+  request_fields_ = move(request_fields);
+  request_fields_byte_size_ = 0;
+  for (const unique_ptr<RpcSidecar>& field : request_fields_) {
+    request_fields_byte_size_ += field->TotalSize();
+  }
+
   // Compute total size of sidecar payload so that extra space can be reserved as part of
   // the request body.
-  size_t message_size = req.ByteSizeLong();
+  size_t message_size = req.ByteSizeLong() + request_fields_byte_size_;
   CHECK_LE(message_size, std::numeric_limits<uint32_t>::max());
   sidecar_byte_size_ = 0;
   for (const unique_ptr<RpcSidecar>& car: sidecars_) {
@@ -184,12 +222,16 @@ void RequestPayload::PopulateRequestPayload(const Message& req,
     sidecar_byte_size_ += sidecar_bytes;
   }
 
-  serialization::SerializeMessage(req, &request_buf_, sidecar_byte_size_, true);
+  serialization::SerializeMessage(
+      req, &request_buf_, static_cast<int>(sidecar_byte_size_ + request_fields_byte_size_),
+      true);
 }
 
 void OutboundCall::SetRequestPayload(const Message& req,
-                                     vector<unique_ptr<RpcSidecar>>&& sidecars) {
-  DCHECK_NOTNULL(payload_)->PopulateRequestPayload(req, std::move(sidecars));
+                                     vector<unique_ptr<RpcSidecar>>&& sidecars,
+                                     vector<unique_ptr<RpcSidecar>>&& request_fields) {
+  DCHECK_NOTNULL(payload_)->PopulateRequestPayload(req, std::move(sidecars),
+                                                   std::move(request_fields));
 }
 
 Status OutboundCall::status() const {
@@ -373,6 +415,8 @@ void OutboundCall::SetSent() {
   // which allocated it -- this lets it keep to thread-local operations instead
   // of taking a mutex to put memory back on the global freelist.
   delete [] payload_->header_buf_.release();
+  payload_->compressed_body_buf_.clear();
+  payload_->compressed_body_buf_.shrink_to_fit();
 
   // payload_ is also done being used here, but since it was allocated by
   // the caller thread, we would rather let that thread free it whenever it
@@ -551,6 +595,13 @@ Status CallResponse::ParseFrom(unique_ptr<InboundTransfer> transfer) {
   CHECK(!parsed_);
   RETURN_NOT_OK(serialization::ParseMessage(transfer->data(), &header_,
                                             &serialized_response_));
+  if (header_.has_body_compression()) {
+    RETURN_NOT_OK(serialization::UncompressBody(header_.body_compression(),
+                                                serialized_response_,
+                                                header_.uncompressed_body_size(),
+                                                &uncompressed_body_));
+    serialized_response_ = Slice(uncompressed_body_);
+  }
 
   // Use information from header to extract the payload slices.
   RETURN_NOT_OK(RpcSidecar::ParseSidecars(header_.sidecar_offsets(),
@@ -50,6 +50,8 @@ class Message;
 } // namespace google
 
 namespace kudu {
+
+class CompressionCodec;
 namespace rpc {
 
 class CallResponse;
@@ -66,7 +68,8 @@ class RequestPayload {
   static std::unique_ptr<RequestPayload> CreateRequestPayload(
       const RemoteMethod& remote_method,
       const google::protobuf::Message& req,
-      std::vector<std::unique_ptr<RpcSidecar>>&& sidecars);
+      std::vector<std::unique_ptr<RpcSidecar>>&& sidecars,
+      std::vector<std::unique_ptr<RpcSidecar>>&& request_fields = {});
 
   // Creates an "empty" payload for the given remote method. Callers should
   // also call PopulateRequestPayload() to form a usable payload.
@@ -74,8 +77,13 @@ class RequestPayload {
 
   // Serializes the given 'req' and takes ownership of 'sidecars', populating
   // the header as necessary.
+  //
+  // 'request_fields' are serialized fields of 'req' which are sent right after
+  // it, as part of the request message (see
+  // RpcController::AddSerializedRequestField()).
   void PopulateRequestPayload(const google::protobuf::Message& req,
-      std::vector<std::unique_ptr<RpcSidecar>>&& sidecars);
+      std::vector<std::unique_ptr<RpcSidecar>>&& sidecars,
+      std::vector<std::unique_ptr<RpcSidecar>>&& request_fields = {});
  private:
   friend class OutboundCall;
 
@@ -87,11 +95,20 @@ class RequestPayload {
   RequestHeader header_;
   faststring header_buf_;
   faststring request_buf_;
+
+  // The compressed body of the request, sent instead of 'request_buf_', the
+  // fields and sidecars if the request is compressed.
+  faststring compressed_body_buf_;
+
   std::vector<std::unique_ptr<RpcSidecar>> sidecars_;
+  std::vector<std::unique_ptr<RpcSidecar>> request_fields_;
 
   // Total size in bytes of all sidecars in 'sidecars_'. Set in SetRequestPayload().
   // This cannot exceed TransferLimits::kMaxTotalSidecarBytes.
   int32_t sidecar_byte_size_ = -1;
+
+  // Total size in bytes of all the fields in 'request_fields_'.
+  size_t request_fields_byte_size_ = 0;
 };
 
 // Tracks the status of a call on the client side.
@@ -143,7 +160,8 @@ class OutboundCall {
   // Because the request data is fully serialized by this call, 'req' may be subsequently
   // mutated with no ill effects.
   void SetRequestPayload(const google::protobuf::Message& req,
-      std::vector<std::unique_ptr<RpcSidecar>>&& sidecars);
+      std::vector<std::unique_ptr<RpcSidecar>>&& sidecars,
+      std::vector<std::unique_ptr<RpcSidecar>>&& request_fields = {});
 
   // Assign the call ID for this call. This is called from the reactor
   // thread once a connection has been assigned. Must only be called once.
@@ -152,9 +170,10 @@ class OutboundCall {
     payload_->header_.set_call_id(call_id);
   }
 
-  // Serialize the call for the wire. Requires that SetRequestPayload()
-  // is called first. This is called from the Reactor thread.
-  void SerializeTo(TransferPayload* slices);
+  // Serialize the call for the wire, compressing its body with 'codec' unless
+  // it's nullptr. Requires that SetRequestPayload() is called first. This is
+  // called from the Reactor thread.
+  void SerializeTo(const CompressionCodec* codec, TransferPayload* slices);
 
   // Mark in the call that cancellation has been requested. If the call hasn't yet
   // started sending or has finished sending the RPC request but is waiting for a
@@ -203,6 +222,7 @@ class OutboundCall {
 
   void FreeSidecars() {
     DCHECK_NOTNULL(payload_)->sidecars_.clear();
+    payload_->request_fields_.clear();
   }
 
   std::string ToString() const;
@@ -377,13 +397,17 @@ class CallResponse {
   // This slice refers to memory allocated by transfer_
   Slice serialized_response_;
 
-  // Slices of data for rpc sidecars. They point into memory owned by transfer_.
+  // Slices of data for rpc sidecars. They point into memory owned by transfer_,
+  // or by uncompressed_body_ if the response was compressed.
   SidecarSliceVector sidecar_slices_;
 
   // The incoming transfer data - retained because serialized_response_
   // and sidecar_slices_ refer into its data.
   std::unique_ptr<InboundTransfer> transfer_;
 
+  // The uncompressed body of the response, if it was compressed.
+  faststring uncompressed_body_;
+
   DISALLOW_COPY_AND_ASSIGN(CallResponse);
 };
 
@@ -172,6 +172,8 @@ class MethodSubstitutions : public Substituter {
     m["metric_enum_key"] = Substitute("kMetricIndex$0", method_->name());
     bool track_result = static_cast<bool>(method_->options().GetExtension(track_rpc_result));
     m["track_result"] = track_result ? " true" : "false";
+    bool batch = static_cast<bool>(method_->options().GetExtension(batch_rpc));
+    m["batch"] = batch ? "true" : "false";
     m["authz_method"] = GetAuthzMethod(*method_).value_or("AuthorizeAllowAll");
   }
 
@@ -511,6 +513,7 @@ class CodeGenerator : public ::google::protobuf::compiler::CodeGenerator {
             "          ctx);\n"
             "    };\n"
             "    mi->track_result = $track_result$;\n"
+            "    mi->batch = $batch$;\n"
             "    mi->handler_latency_histogram =\n"
             "        METRIC_handler_latency_$rpc_full_name_plainchars$.Instantiate(entity);\n"
             "    mi->queue_overflow_rejections =\n"
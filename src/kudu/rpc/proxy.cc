@@ -200,7 +200,8 @@ void Proxy::AsyncRequest(const string& method,
   // payload.
   auto req_payload = RequestPayload::CreateRequestPayload(
       RemoteMethod{service_name_, method},
-      req, controller->ReleaseOutboundSidecars());
+      req, controller->ReleaseOutboundSidecars(),
+      controller->ReleaseSerializedRequestFields());
   if (!dns_resolver_) {
     // NOTE: we don't expect the user-provided callback to free sidecars, so
     // make sure the outbound call frees it for us.
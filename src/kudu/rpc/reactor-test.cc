@@ -17,6 +17,8 @@
 
 #include <functional>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -30,6 +32,8 @@
 #include "kudu/util/thread.h"
 
 using std::shared_ptr;
+using std::thread;
+using std::vector;
 
 namespace kudu {
 namespace rpc {
@@ -106,5 +110,30 @@ TEST_F(ReactorTest, TestReschedulesOnSameReactorThread) {
   latch_.Wait();
 }
 
+// Tasks scheduled concurrently by many threads, some of them racing with the
+// shutdown of the reactors, must each be either run or aborted exactly once.
+TEST_F(ReactorTest, TestConcurrentSchedulingAndShutdown) {
+  constexpr int kNumThreads = 8;
+  constexpr int kTasksPerThread = 1000;
+  latch_.Reset(kNumThreads * kTasksPerThread);
+
+  vector<thread> threads;
+  threads.reserve(kNumThreads);
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([this]() {
+      for (int j = 0; j < kTasksPerThread; j++) {
+        messenger_->ScheduleOnReactor([this](const Status& /*s*/) { latch_.CountDown(); },
+                                      MonoDelta::FromMilliseconds(0));
+      }
+    });
+  }
+  SleepFor(MonoDelta::FromMilliseconds(1));
+  messenger_->Shutdown();
+  for (auto& t : threads) {
+    t.join();
+  }
+  latch_.Wait();
+}
+
 } // namespace rpc
 } // namespace kudu
@@ -19,6 +19,7 @@
 
 #include <openssl/crypto.h>
 #include <openssl/err.h> // IWYU pragma: keep
+#include <sched.h>
 #include <sys/socket.h>
 
 #include <cerrno>
@@ -50,6 +51,7 @@
 #include "kudu/rpc/rpc_introspection.pb.h"
 #include "kudu/util/countdown_latch.h"
 #include "kudu/util/debug/sanitizer_scopes.h"
+#include "kudu/util/errno.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flags.h"
 #include "kudu/util/metrics.h"
@@ -103,6 +105,13 @@ TAG_FLAG(tcp_keepalive_probe_period_s, advanced);
 TAG_FLAG(tcp_keepalive_retry_period_s, advanced);
 TAG_FLAG(tcp_keepalive_retry_count, advanced);
 
+DEFINE_bool(rpc_pin_reactor_threads, false,
+            "Whether to pin each RPC reactor thread to a CPU of its own, picked "
+            "round-robin among the CPUs the process may run on. The connections of "
+            "a reactor and their buffers then stay on that CPU and its NUMA node.");
+TAG_FLAG(rpc_pin_reactor_threads, advanced);
+TAG_FLAG(rpc_pin_reactor_threads, experimental);
+
 METRIC_DEFINE_histogram(server, reactor_load_percent,
                         "Reactor Thread Load Percentage",
                         kudu::MetricUnit::kUnits,
@@ -149,6 +158,34 @@ void DoInitLibEv() {
   ev::set_syserr_cb(LibevSysErr);
 }
 
+#if defined(__linux__)
+// Pins the calling thread to the 'idx'-th CPU, modulo their count, among the
+// CPUs the thread may currently run on.
+Status PinCurrentThreadToCpu(int idx) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    int err = errno;
+    return Status::RuntimeError("sched_getaffinity() failed", ErrnoToString(err), err);
+  }
+  int target = idx % CPU_COUNT(&allowed);
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, &allowed) || target-- > 0) {
+      continue;
+    }
+    cpu_set_t pinned;
+    CPU_ZERO(&pinned);
+    CPU_SET(cpu, &pinned);
+    if (sched_setaffinity(0, sizeof(pinned), &pinned) != 0) {
+      int err = errno;
+      return Status::RuntimeError("sched_setaffinity() failed", ErrnoToString(err), err);
+    }
+    return Status::OK();
+  }
+  return Status::IllegalState("no CPU to pin the thread to");
+}
+#endif
+
 } // anonymous namespace
 
 ReactorThread::ReactorThread(Reactor* reactor, const MessengerBuilder& bld)
@@ -233,7 +270,7 @@ void ReactorThread::PollCompleteCb(struct ev_loop* loop) noexcept {
 }
 
 void ReactorThread::Shutdown(Messenger::ShutdownMode mode) {
-  CHECK(reactor_->closing()) << "Should be called after setting closing_ flag";
+  CHECK(reactor_->closing()) << "Should be called after marking the reactor as closing";
 
   VLOG(1) << name() << ": shutting down Reactor thread.";
   WakeThread();
@@ -502,6 +539,12 @@ void ReactorThread::RunThread() {
   ThreadRestrictions::SetWaitAllowed(false);
   ThreadRestrictions::SetIOAllowed(false);
   DVLOG(6) << "Calling ReactorThread::RunThread()...";
+#if defined(__linux__)
+  if (FLAGS_rpc_pin_reactor_threads) {
+    WARN_NOT_OK(PinCurrentThreadToCpu(reactor_->index_),
+                Substitute("$0: unable to pin reactor thread", name()));
+  }
+#endif
   loop_.run(0);
   VLOG(1) << name() << " thread exiting.";
 
@@ -738,7 +781,7 @@ DelayedTask::DelayedTask(std::function<void(const Status&)> func,
 void DelayedTask::Run(ReactorThread* thread) {
   DCHECK(thread_ == nullptr) << "Task has already been scheduled";
   DCHECK(thread->IsCurrentThread());
-  DCHECK(!is_linked()) << "Should not be linked on pending_tasks_ anymore";
+  DCHECK(!is_linked()) << "Should not be linked on the drained task list anymore";
 
   // Schedule the task to run later.
   thread_ = thread;
@@ -773,7 +816,8 @@ Reactor::Reactor(shared_ptr<Messenger> messenger,
                  int index, const MessengerBuilder& bld)
     : messenger_(std::move(messenger)),
       name_(StringPrintf("%s_R%03d", messenger_->name().c_str(), index)),
-      closing_(false),
+      index_(index),
+      pending_head_(nullptr),
       thread_(this, bld) {
   static std::once_flag libev_once;
   std::call_once(libev_once, DoInitLibEv);
@@ -785,22 +829,25 @@ Status Reactor::Init() {
 }
 
 void Reactor::Shutdown(Messenger::ShutdownMode mode) {
-  {
-    std::lock_guard<LockType> l(lock_);
-    if (closing_) {
-      return;
-    }
-    closing_ = true;
+  // Marking the reactor as closing also takes the tasks pending so far. No new
+  // tasks can get scheduled after this because ScheduleReactorTask() tests
+  // for the marker.
+  ReactorTask* head = pending_head_.exchange(ClosedMarker(), std::memory_order_acq_rel);
+  if (head == ClosedMarker()) {
+    return;
   }
 
   thread_.Shutdown(mode);
 
-  // Abort all pending tasks. No new tasks can get scheduled after this
-  // because ScheduleReactorTask() tests the closing_ flag set above.
+  // Abort all pending tasks, in the order they were scheduled.
+  boost::intrusive::list<ReactorTask> tasks;
+  for (; head != nullptr; head = head->next_pending_) {
+    tasks.push_front(*head);
+  }
   Status aborted = ShutdownError(true);
-  while (!pending_tasks_.empty()) {
-    ReactorTask& task = pending_tasks_.front();
-    pending_tasks_.pop_front();
+  while (!tasks.empty()) {
+    ReactorTask& task = tasks.front();
+    tasks.pop_front();
     task.Abort(aborted);
   }
 }
@@ -814,8 +861,7 @@ const string& Reactor::name() const {
 }
 
 bool Reactor::closing() const {
-  std::lock_guard<LockType> l(lock_);
-  return closing_;
+  return pending_head_.load(std::memory_order_acquire) == ClosedMarker();
 }
 
 // Task to call an arbitrary function within the reactor thread.
@@ -947,29 +993,37 @@ void Reactor::QueueCancellation(shared_ptr<OutboundCall> call) {
 }
 
 void Reactor::ScheduleReactorTask(ReactorTask* task) {
-  bool was_empty;
-  {
-    std::unique_lock<LockType> l(lock_);
-    if (closing_) {
-      // We guarantee the reactor lock is not taken when calling Abort().
-      l.unlock();
+  ReactorTask* head = pending_head_.load(std::memory_order_relaxed);
+  do {
+    if (PREDICT_FALSE(head == ClosedMarker())) {
       task->Abort(ShutdownError(false));
       return;
     }
-    was_empty = pending_tasks_.empty();
-    pending_tasks_.push_back(*task);
-  }
-  if (was_empty) {
+    task->next_pending_ = head;
+  } while (!pending_head_.compare_exchange_weak(
+      head, task, std::memory_order_release, std::memory_order_relaxed));
+
+  // Only the task pushed onto an empty stack needs to wake the reactor thread
+  // up: the others are drained along with it.
+  if (head == nullptr) {
     thread_.WakeThread();
   }
 }
 
 bool Reactor::DrainTaskQueue(boost::intrusive::list<ReactorTask>* tasks) { // NOLINT(*)
-  std::lock_guard<LockType> l(lock_);
-  if (closing_) {
-    return false;
+  // Unlike a plain exchange, don't overwrite the marker set by Shutdown().
+  ReactorTask* head = pending_head_.load(std::memory_order_relaxed);
+  do {
+    if (head == ClosedMarker()) {
+      return false;
+    }
+  } while (!pending_head_.compare_exchange_weak(
+      head, nullptr, std::memory_order_acquire, std::memory_order_relaxed));
+
+  // The stack has the most recently scheduled task on top: reverse it.
+  for (; head != nullptr; head = head->next_pending_) {
+    tasks->push_front(*head);
   }
-  tasks->swap(pending_tasks_);
   return true;
 }
 
@@ -16,6 +16,7 @@
 // under the License.
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <list>
@@ -33,7 +34,6 @@
 #include "kudu/rpc/connection_id.h"
 #include "kudu/rpc/messenger.h"
 #include "kudu/rpc/rpc_header.pb.h"
-#include "kudu/util/locks.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/random.h"
@@ -90,6 +90,11 @@ class ReactorTask : public boost::intrusive::list_base_hook<> {
   virtual ~ReactorTask();
 
  private:
+  friend class Reactor;
+
+  // The task pushed to the reactor's pending task stack right before this one.
+  ReactorTask* next_pending_ = nullptr;
+
   DISALLOW_COPY_AND_ASSIGN(ReactorTask);
 };
 
@@ -381,12 +386,17 @@ class Reactor {
   // called.
   // Does _not_ take ownership of 'task' -- the task should take care of
   // deleting itself after running if it is allocated on the heap.
+  //
+  // This method is lock-free: the reactor thread is only woken up by the
+  // task scheduled into an empty queue, so that the tasks scheduled while
+  // the reactor thread is busy are run in a single batch.
   void ScheduleReactorTask(ReactorTask* task);
 
   Status RunOnReactorThread(std::function<Status()> f);
 
   // If the Reactor is closing, returns false.
-  // Otherwise, drains the pending_tasks_ queue into the provided list.
+  // Otherwise, drains the pending tasks into the provided list, in the order
+  // they were scheduled.
   bool DrainTaskQueue(boost::intrusive::list<ReactorTask>* tasks);
 
   Messenger* messenger() const {
@@ -405,21 +415,27 @@ class Reactor {
 
  private:
   friend class ReactorThread;
-  typedef simple_spinlock LockType;
-  mutable LockType lock_;
+
+  // The value of 'pending_head_' once the reactor is shutting down.
+  static ReactorTask* ClosedMarker() {
+    return reinterpret_cast<ReactorTask*>(1);
+  }
 
   // parent messenger
   std::shared_ptr<Messenger> messenger_;
 
   const std::string name_;
 
-  // Whether the reactor is shutting down.
-  // Guarded by lock_.
-  bool closing_;
+  // Index of the reactor among the reactors of its messenger.
+  const int index_;
 
-  // Tasks to be run within the reactor thread.
-  // Guarded by lock_.
-  boost::intrusive::list<ReactorTask> pending_tasks_; // NOLINT(build/include_what_you_use)
+  // Tasks to be run within the reactor thread, as a stack linked through
+  // ReactorTask::next_pending_ with the most recently scheduled task on top.
+  // Any thread may push onto it, while only the reactor thread and Shutdown()
+  // take the whole stack at once, so it needs no lock. Set to ClosedMarker()
+  // once the reactor is shutting down, so that closing the reactor and taking
+  // its last pending tasks is a single atomic step.
+  std::atomic<ReactorTask*> pending_head_;
 
   ReactorThread thread_;
 
@@ -421,6 +421,7 @@ class RpcTestBase : public KuduTest {
       : n_acceptor_pool_threads_(2),
         n_server_reactor_threads_(3),
         n_worker_threads_(3),
+        n_max_worker_threads_(0),
         keepalive_time_ms_(1000),
         rpc_negotiation_timeout_ms_(3000),
         service_queue_length_(200),
@@ -661,6 +662,7 @@ static void DoTestSidecar(Proxy* p, int size1, int size2) {
     scoped_refptr<MetricEntity> metric_entity = server_messenger_->metric_entity();
     service_pool_ = new ServicePool(std::move(service), metric_entity, service_queue_length_);
     RETURN_NOT_OK(server_messenger_->RegisterService(service_name_, service_pool_));
+    service_pool_->set_max_threads(n_max_worker_threads_);
     return service_pool_->Init(n_worker_threads_);
   }
 
@@ -668,6 +670,7 @@ static void DoTestSidecar(Proxy* p, int size1, int size2) {
   int n_acceptor_pool_threads_;
   int n_server_reactor_threads_;
   int n_worker_threads_;
+  int n_max_worker_threads_;
   int keepalive_time_ms_;
   int rpc_negotiation_timeout_ms_;
   int service_queue_length_;
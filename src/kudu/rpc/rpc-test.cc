@@ -59,8 +59,11 @@
 #include "kudu/rpc/service_pool.h"
 #include "kudu/rpc/transfer.h"
 #include "kudu/security/test/test_certs.h"
+#include "kudu/util/coding.h"
 #include "kudu/util/countdown_latch.h"
+#include "kudu/util/crc.h"
 #include "kudu/util/env.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/net/sockaddr.h"
@@ -84,12 +87,22 @@ METRIC_DECLARE_counter(queue_overflow_rejections_kudu_rpc_test_CalculatorService
 METRIC_DECLARE_counter(timed_out_on_response_kudu_rpc_test_CalculatorService_Sleep);
 METRIC_DECLARE_histogram(handler_latency_kudu_rpc_test_CalculatorService_Sleep);
 METRIC_DECLARE_histogram(rpc_incoming_queue_time);
+METRIC_DECLARE_counter(rpc_service_threads_added);
+METRIC_DECLARE_counter(rpc_service_threads_removed);
+METRIC_DECLARE_gauge_int32(rpc_service_threads);
 
+DECLARE_bool(rpc_acceptor_reuseport_sharding);
+DECLARE_bool(rpc_compress_loopback_connections);
+DECLARE_bool(rpc_pin_reactor_threads);
 DECLARE_bool(rpc_reopen_outbound_connections);
+DECLARE_int32(rpc_compression_min_bytes);
 DECLARE_int32(rpc_negotiation_inject_delay_ms);
+DECLARE_int32(rpc_service_pool_grow_queue_time_ms);
+DECLARE_int32(rpc_service_pool_idle_thread_timeout_ms);
 DECLARE_int32(tcp_keepalive_probe_period_s);
 DECLARE_int32(tcp_keepalive_retry_period_s);
 DECLARE_int32(tcp_keepalive_retry_count);
+DECLARE_string(rpc_compression_codec);
 
 using std::tuple;
 using std::shared_ptr;
@@ -193,6 +206,24 @@ TEST_F(TestRpc, TestConnHeaderValidation) {
   ASSERT_OK(serialization::ValidateConnHeader(Slice(buf, conn_hdr_len)));
 }
 
+TEST_F(TestRpc, TestTransferBufferPool) {
+  // Buffers are handed out by power-of-two size classes, and reused.
+  faststring buf = TransferBufferPool::Acquire(5000);
+  ASSERT_EQ(8192, buf.capacity());
+  buf.append("abc", 3);
+  const uint8_t* data = buf.data();
+  TransferBufferPool::Release(std::move(buf));
+  faststring reused = TransferBufferPool::Acquire(6000);
+  ASSERT_EQ(data, reused.data());
+  ASSERT_EQ(0, reused.size());
+
+  // Buffers too large to be pooled are allocated to size, and not kept.
+  faststring large = TransferBufferPool::Acquire(3 * 1024 * 1024);
+  ASSERT_EQ(3 * 1024 * 1024, large.capacity());
+  TransferBufferPool::Release(std::move(large));
+  TransferBufferPool::Release(std::move(reused));
+}
+
 // Regression test for KUDU-2041
 TEST_P(TestRpc, TestNegotiationDeadlock) {
 
@@ -238,6 +269,26 @@ TEST_P(TestRpc, TestCall) {
   }
 }
 
+// Test making calls to a server whose accepts are sharded across several
+// SO_REUSEPORT sockets and whose reactor threads are pinned to CPUs.
+TEST_P(TestRpc, TestCallWithShardedAcceptorsAndPinnedReactors) {
+  FLAGS_rpc_acceptor_reuseport_sharding = true;
+  FLAGS_rpc_pin_reactor_threads = true;
+  n_acceptor_pool_threads_ = 4;
+  n_server_reactor_threads_ = 2;
+  Sockaddr server_addr = bind_addr();
+  ASSERT_OK(StartTestServer(&server_addr, enable_ssl()));
+
+  // Every client messenger opens a connection of its own.
+  for (int i = 0; i < 8; i++) {
+    shared_ptr<Messenger> client_messenger;
+    ASSERT_OK(CreateMessenger("Client", &client_messenger, 1, enable_ssl()));
+    Proxy p(client_messenger, server_addr, kRemoteHostName,
+            GenericCalculatorService::static_service_name());
+    ASSERT_OK(DoTestSyncCall(&p, GenericCalculatorService::kAddMethodName));
+  }
+}
+
 // Test for KUDU-2091 and KUDU-2220.
 TEST_P(TestRpc, TestCallWithChainCertAndChainCA) {
   // We're only interested in running this test with TLS enabled.
@@ -891,6 +942,106 @@ TEST_P(TestRpc, TestRpcSidecar) {
   DoTestOutgoingSidecarExpectOK(&p, 3000 * 1024, 2000 * 1024);
 }
 
+// Test sending pre-serialized fields of a request along with the request, and
+// that they don't get in the way of the sidecars of the request.
+TEST_P(TestRpc, TestSerializedRequestFields) {
+  // Set up server.
+  Sockaddr server_addr = bind_addr();
+  ASSERT_OK(StartTestServer(&server_addr, enable_ssl()));
+
+  // Set up client.
+  shared_ptr<Messenger> client_messenger;
+  ASSERT_OK(CreateMessenger("Client", &client_messenger, 1, enable_ssl()));
+  Proxy p(client_messenger, server_addr, kRemoteHostName,
+          GenericCalculatorService::static_service_name());
+
+  const vector<string> strings = { string(123, 'a'), string(456, 'b') };
+  PushStringsRequestPB request;
+  RpcController controller;
+  int idx;
+  ASSERT_OK(controller.AddOutboundSidecar(RpcSidecar::FromSlice(Slice(strings[0])), &idx));
+  request.add_sidecar_indexes(idx);
+  ASSERT_OK(controller.AddOutboundSidecar(RpcSidecar::FromSlice(Slice(strings[1])), &idx));
+  // Send the index of the second sidecar as a serialized 'sidecar_indexes'
+  // field, i.e. a varint field with number 1.
+  faststring field;
+  PutVarint32(&field, (1 << 3) | 0);
+  PutVarint32(&field, idx);
+  controller.AddSerializedRequestField(RpcSidecar::FromFaststring(std::move(field)));
+
+  PushStringsResponsePB resp;
+  ASSERT_OK(p.SyncRequest(GenericCalculatorService::kPushStringsMethodName,
+                          request, &resp, &controller));
+  ASSERT_EQ(strings.size(), resp.sizes_size());
+  for (int i = 0; i < strings.size(); i++) {
+    ASSERT_EQ(strings[i].size(), resp.sizes(i));
+    ASSERT_EQ(crc::Crc32c(strings[i].data(), strings[i].size()), resp.crcs(i));
+  }
+}
+
+// Test calls and responses whose bodies, with their sidecars, are compressed.
+TEST_P(TestRpc, TestCompressedBodies) {
+  FLAGS_rpc_compression_codec = "zstd";
+  FLAGS_rpc_compress_loopback_connections = true;
+  FLAGS_rpc_compression_min_bytes = 1024;
+
+  // Set up server.
+  Sockaddr server_addr = bind_addr();
+  ASSERT_OK(StartTestServer(&server_addr, enable_ssl()));
+
+  // Set up client.
+  shared_ptr<Messenger> client_messenger;
+  ASSERT_OK(CreateMessenger("Client", &client_messenger, 1, enable_ssl()));
+  Proxy p(client_messenger, server_addr, kRemoteHostName,
+          GenericCalculatorService::static_service_name());
+
+  // Small calls aren't compressed, large ones are.
+  ASSERT_OK(DoTestSyncCall(&p, GenericCalculatorService::kAddMethodName));
+  DoTestOutgoingSidecarExpectOK(&p, 123, 456);
+  DoTestOutgoingSidecarExpectOK(&p, 3000 * 1024, 2000 * 1024);
+  DoTestSidecar(&p, 123, 456);
+  DoTestSidecar(&p, 3000 * 1024, 2000 * 1024);
+}
+
+// Test sending a sidecar made of several slices of a buffer it keeps alive
+// until the call completes.
+TEST_P(TestRpc, TestAnchoredSlicesSidecar) {
+  // Set up server.
+  Sockaddr server_addr = bind_addr();
+  ASSERT_OK(StartTestServer(&server_addr, enable_ssl()));
+
+  // Set up client.
+  shared_ptr<Messenger> client_messenger;
+  ASSERT_OK(CreateMessenger("Client", &client_messenger, 1, enable_ssl()));
+  Proxy p(client_messenger, server_addr, kRemoteHostName,
+          GenericCalculatorService::static_service_name());
+
+  auto buf = std::make_shared<string>(string(1000, 'a') + string(2000, 'b'));
+  const string expected = buf->substr(500, 1000) + buf->substr(2000, 1000);
+  std::weak_ptr<string> weak_buf(buf);
+  {
+    PushStringsRequestPB request;
+    RpcController controller;
+    int idx;
+    SidecarSliceVector slices = { Slice(buf->data() + 500, 1000),
+                                  Slice(buf->data() + 2000, 1000) };
+    ASSERT_OK(controller.AddOutboundSidecar(
+        RpcSidecar::FromSlices(std::move(slices), std::move(buf)), &idx));
+    request.add_sidecar_indexes(idx);
+
+    PushStringsResponsePB resp;
+    ASSERT_OK(p.SyncRequest(GenericCalculatorService::kPushStringsMethodName,
+                            request, &resp, &controller));
+    ASSERT_EQ(1, resp.sizes_size());
+    ASSERT_EQ(expected.size(), resp.sizes(0));
+    ASSERT_EQ(crc::Crc32c(expected.data(), expected.size()), resp.crcs(0));
+  }
+  // The buffer is released along with the call.
+  ASSERT_EVENTUALLY([&] {
+    ASSERT_TRUE(weak_buf.expired());
+  });
+}
+
 // Test sending the maximum number of sidecars, each of them being a single
 // character. This makes sure we handle the limit of IOV_MAX iovecs per sendmsg
 // call.
@@ -1234,6 +1385,54 @@ TEST_P(TestRpc, TestRpcHandlerLatencyMetric) {
   ASSERT_TRUE(FindOrDie(metric_map, &METRIC_rpc_incoming_queue_time));
 }
 
+// Test that a service pool allowed more threads than it starts with adds
+// threads while calls wait in its queue, and removes them once idle.
+TEST_P(TestRpc, TestServicePoolGrowsAndShrinks) {
+  FLAGS_rpc_service_pool_grow_queue_time_ms = 1;
+  FLAGS_rpc_service_pool_idle_thread_timeout_ms = 500;
+  n_worker_threads_ = 1;
+  n_max_worker_threads_ = 4;
+  Sockaddr server_addr = bind_addr();
+  ASSERT_OK(StartTestServerWithGeneratedCode(&server_addr, enable_ssl()));
+
+  shared_ptr<Messenger> cm;
+  ASSERT_OK(CreateMessenger("client", &cm, 1/*n_reactors*/, enable_ssl()));
+  Proxy p(cm, server_addr, kRemoteHostName, CalculatorService::static_service_name());
+
+  const auto& entity = server_messenger_->metric_entity();
+  auto threads = METRIC_rpc_service_threads.Instantiate(entity, 0);
+  auto added = METRIC_rpc_service_threads_added.Instantiate(entity);
+  auto removed = METRIC_rpc_service_threads_removed.Instantiate(entity);
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_EQ(1, threads->value());
+  });
+
+  // Calls which block their service thread pile up in the queue of the single
+  // thread, so the pool grows to its maximum size.
+  constexpr int kNumCalls = 16;
+  SleepRequestPB req;
+  req.set_sleep_micros(100 * 1000);
+  vector<SleepResponsePB> resps(kNumCalls);
+  vector<RpcController> controllers(kNumCalls);
+  CountDownLatch latch(kNumCalls);
+  for (int i = 0; i < kNumCalls; i++) {
+    p.AsyncRequest("Sleep", req, &resps[i], &controllers[i],
+                   [&latch]() { latch.CountDown(); });
+  }
+  latch.Wait();
+  for (const auto& controller : controllers) {
+    ASSERT_OK(controller.status());
+  }
+  ASSERT_EQ(3, added->value());
+  ASSERT_EQ(4, threads->value());
+
+  // Once idle, the pool shrinks back to its initial size.
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_EQ(3, removed->value());
+    ASSERT_EQ(1, threads->value());
+  });
+}
+
 // Set of basic test scenarios for the per-RPC 'timed_out_on_response' metric.
 TEST_P(TestRpc, TimedOutOnResponseMetric) {
   constexpr uint64_t kSleepMicros = 20 * 1000;
@@ -57,6 +57,7 @@ void RpcController::Swap(RpcController* other) {
 
   std::swap(outbound_sidecars_, other->outbound_sidecars_);
   std::swap(outbound_sidecars_total_bytes_, other->outbound_sidecars_total_bytes_);
+  std::swap(serialized_request_fields_, other->serialized_request_fields_);
   std::swap(timeout_, other->timeout_);
   std::swap(credentials_policy_, other->credentials_policy_);
   std::swap(call_, other->call_);
@@ -163,9 +164,18 @@ Status RpcController::AddOutboundSidecar(unique_ptr<RpcSidecar> car, int* idx) {
   return Status::OK();
 }
 
+void RpcController::AddSerializedRequestField(unique_ptr<RpcSidecar> field) {
+  serialized_request_fields_.emplace_back(std::move(field));
+}
+
+std::vector<unique_ptr<RpcSidecar>> RpcController::ReleaseSerializedRequestFields() {
+  return std::move(serialized_request_fields_);
+}
+
 void RpcController::SetRequestParam(const google::protobuf::Message& req) {
   DCHECK(call_ != nullptr);
-  call_->SetRequestPayload(req, std::move(outbound_sidecars_));
+  call_->SetRequestPayload(req, std::move(outbound_sidecars_),
+                           std::move(serialized_request_fields_));
 }
 
 void RpcController::FreeOutboundSidecars() {
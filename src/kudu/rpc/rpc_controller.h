@@ -246,6 +246,16 @@ class RpcController {
   // exceed TransferLimits::kMaxTotalSidecarBytes.
   Status AddOutboundSidecar(std::unique_ptr<RpcSidecar> car, int* idx);
 
+  // Appends 'field' to the outbound request message. 'field' must hold fields
+  // of the request message serialized in the protobuf wire format: the server
+  // parses them along with the fields of the request passed to the proxy.
+  // This allows sending pre-serialized parts of a request, e.g. repeated
+  // fields sent in several requests, without copying them into each request.
+  void AddSerializedRequestField(std::unique_ptr<RpcSidecar> field);
+
+  // Releases the serialized request fields added to this controller.
+  std::vector<std::unique_ptr<RpcSidecar>> ReleaseSerializedRequestFields();
+
   // Cancel the call associated with the RpcController. This function should only be
   // called when there is an outstanding outbound call. It's always safe to call
   // Cancel() after you've sent a call, so long as you haven't called Reset() yet.
@@ -296,6 +306,9 @@ class RpcController {
   // of TransferLimits::kMaxTotalSidecarBytes.
   int32_t outbound_sidecars_total_bytes_ = 0;
 
+  // Owned by the controller until released and taken by a call.
+  std::vector<std::unique_ptr<RpcSidecar>> serialized_request_fields_;
+
   DISALLOW_COPY_AND_ASSIGN(RpcController);
 };
 
@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/container/vector.hpp>
@@ -30,6 +32,8 @@
 #include "kudu/util/faststring.h"
 #include "kudu/util/status.h"
 
+using std::shared_ptr;
+using std::string;
 using std::unique_ptr;
 using std::vector;
 
@@ -75,6 +79,46 @@ class FaststringSidecar : public RpcSidecar {
   vector<faststring> data_;
 };
 
+class StringSidecar : public RpcSidecar {
+ public:
+  explicit StringSidecar(string data) : data_(std::move(data)) { }
+
+  void AppendSlices(TransferPayload* payload) const override {
+    payload->push_back(Slice(data_));
+  }
+  size_t TotalSize() const override {
+    return data_.size();
+  }
+ private:
+  const string data_;
+};
+
+// Sidecar that references a series of slices, keeping the memory they point to
+// alive with an anchor until the sidecar is destroyed.
+class AnchoredSlicesSidecar : public RpcSidecar {
+ public:
+  AnchoredSlicesSidecar(SidecarSliceVector slices, shared_ptr<const void> anchor)
+      : slices_(std::move(slices)),
+        anchor_(std::move(anchor)) {
+  }
+
+  void AppendSlices(TransferPayload* payload) const override {
+    for (const auto& s : slices_) {
+      payload->push_back(s);
+    }
+  }
+  size_t TotalSize() const override {
+    size_t ret = 0;
+    for (const auto& s : slices_) {
+      ret += s.size();
+    }
+    return ret;
+  }
+ private:
+  const SidecarSliceVector slices_;
+  const shared_ptr<const void> anchor_;
+};
+
 unique_ptr<RpcSidecar> RpcSidecar::FromFaststring(faststring data) {
   return unique_ptr<RpcSidecar>(new FaststringSidecar(std::move(data)));
 }
@@ -87,6 +131,16 @@ unique_ptr<RpcSidecar> RpcSidecar::FromSlice(Slice slice) {
   return unique_ptr<RpcSidecar>(new SliceSidecar(slice));
 }
 
+unique_ptr<RpcSidecar> RpcSidecar::FromString(string data) {
+  return unique_ptr<RpcSidecar>(new StringSidecar(std::move(data)));
+}
+
+unique_ptr<RpcSidecar> RpcSidecar::FromSlices(SidecarSliceVector slices,
+                                              shared_ptr<const void> anchor) {
+  return unique_ptr<RpcSidecar>(
+      new AnchoredSlicesSidecar(std::move(slices), std::move(anchor)));
+}
+
 
 Status RpcSidecar::ParseSidecars(
     const ::google::protobuf::RepeatedField<::google::protobuf::uint32>& offsets,
@@ -18,6 +18,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <boost/container/small_vector.hpp>
@@ -59,6 +60,14 @@ class RpcSidecar {
   static std::unique_ptr<RpcSidecar> FromFaststring(faststring data);
   static std::unique_ptr<RpcSidecar> FromFaststrings(std::vector<faststring> data);
   static std::unique_ptr<RpcSidecar> FromSlice(Slice slice);
+  static std::unique_ptr<RpcSidecar> FromString(std::string data);
+
+  // Returns a sidecar made of 'slices', concatenated, which reference memory owned
+  // by 'anchor' (e.g. pinned cache entries or an arena) rather than a copy of it.
+  // The anchor is released along with the sidecar, once the call it is attached
+  // to completes.
+  static std::unique_ptr<RpcSidecar> FromSlices(SidecarSliceVector slices,
+                                                std::shared_ptr<const void> anchor);
 
   // Utility method to parse a series of sidecar slices into 'sidecars' from 'buffer' and
   // a set of offsets.
@@ -17,10 +17,12 @@
 
 #include "kudu/rpc/serialization.h"
 
+#include <cstring>
 #include <limits>
 #include <ostream>
+#include <vector>
 
-#include <gflags/gflags_declare.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/message_lite.h>
@@ -30,16 +32,25 @@
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/constants.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/faststring.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
+DEFINE_int32(rpc_compression_min_bytes, 32 * 1024,
+             "Minimum size of the body of an RPC call or response, including its "
+             "sidecars, for it to be compressed when --rpc_compression_codec is set.");
+TAG_FLAG(rpc_compression_min_bytes, advanced);
+TAG_FLAG(rpc_compression_min_bytes, runtime);
+
 DECLARE_int64(rpc_max_message_size);
 
 using google::protobuf::MessageLite;
 using google::protobuf::io::CodedInputStream;
 using google::protobuf::io::CodedOutputStream;
+using std::vector;
 using strings::Substitute;
 
 namespace kudu {
@@ -176,6 +187,60 @@ Status ParseMessage(const Slice& buf,
   return Status::OK();
 }
 
+bool CompressBody(const CompressionCodec& codec,
+                  const vector<Slice>& body,
+                  size_t body_size,
+                  faststring* compressed_buf) {
+  if (body_size < FLAGS_rpc_compression_min_bytes ||
+      body_size > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  const size_t max_len = codec.MaxCompressedLength(body_size);
+  const size_t delim_len = CodedOutputStream::VarintSize32(max_len);
+  compressed_buf->resize(delim_len + max_len);
+  size_t compressed_len;
+  Status s = codec.Compress(body, compressed_buf->data() + delim_len, &compressed_len);
+  if (PREDICT_FALSE(!s.ok())) {
+    KLOG_EVERY_N_SECS(WARNING, 10) << "unable to compress RPC body: " << s.ToString()
+                                   << THROTTLE_MSG;
+    return false;
+  }
+  // Don't bother sending compressed data unless it saves at least 1/8th.
+  if (compressed_len > body_size - body_size / 8) {
+    return false;
+  }
+  // Write the actual length right before the compressed data, whose varint may
+  // be shorter than the one we made room for.
+  const size_t actual_delim_len = CodedOutputStream::VarintSize32(compressed_len);
+  uint8_t* start = compressed_buf->data() + delim_len - actual_delim_len;
+  CodedOutputStream::WriteVarint32ToArray(compressed_len, start);
+  memmove(compressed_buf->data(), start, actual_delim_len + compressed_len);
+  compressed_buf->resize(actual_delim_len + compressed_len);
+  return true;
+}
+
+Status UncompressBody(CompressionType compression,
+                      const Slice& compressed_body,
+                      uint32_t uncompressed_size,
+                      faststring* uncompressed_buf) {
+  if (PREDICT_FALSE(uncompressed_size > FLAGS_rpc_max_message_size)) {
+    return Status::Corruption(Substitute(
+        "Invalid packet: uncompressed body of $0 bytes larger than the maximum "
+        "RPC message size ($1 bytes)", uncompressed_size, FLAGS_rpc_max_message_size));
+  }
+  const CompressionCodec* codec;
+  RETURN_NOT_OK_PREPEND(GetCompressionCodec(compression, &codec),
+                        "Invalid packet: unsupported body compression");
+  if (PREDICT_FALSE(!codec)) {
+    return Status::Corruption("Invalid packet: body compression without a codec");
+  }
+  uncompressed_buf->resize(uncompressed_size);
+  RETURN_NOT_OK_PREPEND(codec->Uncompress(compressed_body, uncompressed_buf->data(),
+                                          uncompressed_size),
+                        "Invalid packet: unable to uncompress body");
+  return Status::OK();
+}
+
 void SerializeConnHeader(uint8_t* buf) {
   memcpy(reinterpret_cast<char *>(buf), kMagicNumber, kMagicNumberLength);
   buf += kMagicNumberLength;
@@ -16,8 +16,12 @@
 // under the License.
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <vector>
+
+#include "kudu/util/compression/compression.pb.h"
 
 namespace google {
 namespace protobuf {
@@ -27,6 +31,7 @@ class MessageLite;
 
 namespace kudu {
 
+class CompressionCodec;
 class Status;
 class faststring;
 class Slice;
@@ -72,6 +77,26 @@ Status ParseMessage(const Slice& buf,
                     google::protobuf::MessageLite* parsed_header,
                     Slice* parsed_main_message);
 
+// Compresses 'body', the slices making the main body of a frame (i.e. the
+// message and its sidecars) of 'body_size' bytes in total, with 'codec' into
+// 'compressed_buf', prefixed with its varint length so that it can follow the
+// header of the frame.
+//
+// Returns false if the body should rather be sent as is, because it's smaller
+// than --rpc_compression_min_bytes or it doesn't compress.
+bool CompressBody(const CompressionCodec& codec,
+                  const std::vector<Slice>& body,
+                  size_t body_size,
+                  faststring* compressed_buf);
+
+// Uncompresses the main body of a frame parsed by ParseMessage(), compressed
+// with 'compression', into 'uncompressed_buf', which must then outlive any
+// use of the body.
+Status UncompressBody(CompressionType compression,
+                      const Slice& compressed_body,
+                      uint32_t uncompressed_size,
+                      faststring* uncompressed_buf);
+
 // Serialize the RPC connection header (magic number + flags).
 // buf must have 7 bytes available (kMagicNumberLength + kHeaderFlagsLength).
 void SerializeConnHeader(uint8_t* buf);
@@ -56,6 +56,10 @@ struct RpcMethodInfo : public RefCountedThreadSafe<RpcMethodInfo> {
   // Whether we should track this method's result, using ResultTracker.
   bool track_result;
 
+  // Whether this method does bulk work, and therefore has its calls queued
+  // in the service queue's batch class.
+  bool batch = false;
+
   // The authorization function for this RPC. If this function
   // returns false, the RPC has already been handled (i.e. rejected)
   // by the authorization function.
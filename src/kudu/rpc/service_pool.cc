@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/basictypes.h"
@@ -37,9 +38,12 @@
 #include "kudu/rpc/rpc_header.pb.h"
 #include "kudu/rpc/service_if.h"
 #include "kudu/rpc/service_queue.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/net/sockaddr.h"
+#include "kudu/util/profiler_tag.h"
 #include "kudu/util/status.h"
 #include "kudu/util/thread.h"
 #include "kudu/util/trace.h"
@@ -49,6 +53,21 @@ using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
 
+DEFINE_int32(rpc_service_pool_grow_queue_time_ms, 10,
+             "For service pools allowed more threads than they start with, the "
+             "time a call must have waited in the queue, with none of the threads "
+             "of its pool idle, for the pool to add a thread.");
+TAG_FLAG(rpc_service_pool_grow_queue_time_ms, advanced);
+TAG_FLAG(rpc_service_pool_grow_queue_time_ms, experimental);
+TAG_FLAG(rpc_service_pool_grow_queue_time_ms, runtime);
+
+DEFINE_int32(rpc_service_pool_idle_thread_timeout_ms, 10000,
+             "The time after which an idle thread added to a service pool past "
+             "the threads it starts with exits.");
+TAG_FLAG(rpc_service_pool_idle_thread_timeout_ms, advanced);
+TAG_FLAG(rpc_service_pool_idle_thread_timeout_ms, experimental);
+TAG_FLAG(rpc_service_pool_idle_thread_timeout_ms, runtime);
+
 METRIC_DEFINE_histogram(server, rpc_incoming_queue_time,
                         "RPC Queue Time",
                         kudu::MetricUnit::kMicroseconds,
@@ -69,6 +88,26 @@ METRIC_DEFINE_counter(server, rpcs_queue_overflow,
                       "Number of RPCs dropped because the service queue was full.",
                       kudu::MetricLevel::kWarn);
 
+METRIC_DEFINE_gauge_int32(server, rpc_service_threads,
+                          "RPC Service Threads",
+                          kudu::MetricUnit::kThreads,
+                          "Number of threads running in the RPC service pools.",
+                          kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_counter(server, rpc_service_threads_added,
+                      "RPC Service Threads Added",
+                      kudu::MetricUnit::kThreads,
+                      "Number of threads added to RPC service pools because "
+                      "their calls waited in the queue with all threads busy.",
+                      kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_counter(server, rpc_service_threads_removed,
+                      "RPC Service Threads Removed",
+                      kudu::MetricUnit::kThreads,
+                      "Number of threads added to RPC service pools which "
+                      "exited after being idle.",
+                      kudu::MetricLevel::kInfo);
+
 namespace kudu {
 namespace rpc {
 
@@ -80,7 +119,15 @@ ServicePool::ServicePool(unique_ptr<ServiceIf> service,
     incoming_queue_time_(METRIC_rpc_incoming_queue_time.Instantiate(entity)),
     rpcs_timed_out_in_queue_(METRIC_rpcs_timed_out_in_queue.Instantiate(entity)),
     rpcs_queue_overflow_(METRIC_rpcs_queue_overflow.Instantiate(entity)),
-    closing_(false) {
+    service_threads_(METRIC_rpc_service_threads.Instantiate(entity, 0)),
+    service_threads_added_(METRIC_rpc_service_threads_added.Instantiate(entity)),
+    service_threads_removed_(METRIC_rpc_service_threads_removed.Instantiate(entity)),
+    closing_(false),
+    min_threads_(0),
+    max_threads_(0),
+    extra_threads_cond_(&extra_threads_lock_),
+    num_extra_threads_(0),
+    stop_extra_threads_(false) {
 }
 
 ServicePool::~ServicePool() {
@@ -88,12 +135,13 @@ ServicePool::~ServicePool() {
 }
 
 Status ServicePool::Init(int num_threads) {
+  min_threads_ = num_threads;
   for (int i = 0; i < num_threads; i++) {
     scoped_refptr<kudu::Thread> new_thread;
     CHECK_OK(kudu::Thread::Create(
         Substitute("service pool $0", service_->service_name()),
         "rpc worker",
-        [this]() { this->RunThread(); }, &new_thread));
+        [this]() { this->RunThread(/*extra=*/false); }, &new_thread));
     threads_.push_back(new_thread);
   }
   return Status::OK();
@@ -102,6 +150,15 @@ Status ServicePool::Init(int num_threads) {
 void ServicePool::Shutdown() {
   service_queue_.Shutdown();
 
+  // The extra threads exit on their own once the queue is shut down.
+  {
+    MutexLock l(extra_threads_lock_);
+    stop_extra_threads_ = true;
+    while (num_extra_threads_ > 0) {
+      extra_threads_cond_.Wait();
+    }
+  }
+
   MutexLock lock(shutdown_lock_);
   if (closing_) return;
   closing_ = true;
@@ -120,8 +177,13 @@ void ServicePool::Shutdown() {
   service_->Shutdown();
 }
 
-void ServicePool::RejectTooBusy(InboundCall* c) {
-  string err_msg =
+void ServicePool::RejectTooBusy(InboundCall* c, QueueStatus queue_status) {
+  string err_msg = queue_status == QUEUE_OVERLOADED ?
+      Substitute("$0 request on $1 from $2 dropped due to backpressure. "
+                 "The service queue is overloaded; it only admits non-batch calls.",
+                 c->remote_method().method_name(),
+                 service_->service_name(),
+                 c->remote_address().ToString()) :
       Substitute("$0 request on $1 from $2 dropped due to backpressure. "
                  "The service queue is full; it has $3 items.",
                  c->remote_method().method_name(),
@@ -171,13 +233,13 @@ Status ServicePool::QueueInboundCall(unique_ptr<InboundCall> call) {
   // Queue message on service queue
   std::optional<InboundCall*> evicted;
   auto queue_status = service_queue_.Put(c, &evicted);
-  if (queue_status == QUEUE_FULL) {
-    RejectTooBusy(c);
+  if (queue_status == QUEUE_FULL || queue_status == QUEUE_OVERLOADED) {
+    RejectTooBusy(c, queue_status);
     return Status::OK();
   }
 
   if (PREDICT_TRUE(evicted)) {
-    RejectTooBusy(*evicted);
+    RejectTooBusy(*evicted, QUEUE_FULL);
   }
 
   if (PREDICT_TRUE(queue_status == QUEUE_SUCCESS)) {
@@ -198,14 +260,58 @@ Status ServicePool::QueueInboundCall(unique_ptr<InboundCall> call) {
   return status;
 }
 
-void ServicePool::RunThread() {
+void ServicePool::MaybeAddThread(const InboundCall& call) {
+  if (max_threads_ <= min_threads_) {
+    return;
+  }
+  const MonoTime now = MonoTime::Now();
+  if (now - call.GetTimeReceived() <
+          MonoDelta::FromMilliseconds(FLAGS_rpc_service_pool_grow_queue_time_ms) ||
+      service_queue_.estimated_idle_worker_count() > 0) {
+    return;
+  }
+
+  MutexLock l(extra_threads_lock_);
+  if (stop_extra_threads_ ||
+      min_threads_ + num_extra_threads_ >= max_threads_ ||
+      now < next_extra_thread_time_) {
+    return;
+  }
+  scoped_refptr<kudu::Thread> new_thread;
+  Status s = kudu::Thread::Create(
+      Substitute("service pool $0", service_->service_name()),
+      "rpc worker",
+      [this]() { this->RunThread(/*extra=*/true); }, &new_thread);
+  if (PREDICT_FALSE(!s.ok())) {
+    KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("Could not add a thread to service pool $0: $1",
+                                                service_->service_name(), s.ToString())
+                                  << THROTTLE_MSG;
+    return;
+  }
+  num_extra_threads_++;
+  next_extra_thread_time_ =
+      now + MonoDelta::FromMilliseconds(FLAGS_rpc_service_pool_grow_queue_time_ms);
+  service_threads_added_->Increment();
+  VLOG(1) << Substitute("Added a thread to service pool $0, which has $1 threads",
+                        service_->service_name(), min_threads_ + num_extra_threads_);
+}
+
+void ServicePool::RunThread(bool extra) {
+  service_threads_->Increment();
   while (true) {
     std::unique_ptr<InboundCall> incoming;
-    if (!service_queue_.BlockingGet(&incoming)) {
+    if (PREDICT_FALSE(extra)) {
+      MonoTime deadline = MonoTime::Now() +
+          MonoDelta::FromMilliseconds(FLAGS_rpc_service_pool_idle_thread_timeout_ms);
+      if (!service_queue_.BlockingGet(&incoming, deadline)) {
+        break;
+      }
+    } else if (!service_queue_.BlockingGet(&incoming)) {
       VLOG(1) << "ServicePool: messenger shutting down.";
-      return;
+      break;
     }
 
+    MaybeAddThread(*incoming);
     incoming->RecordHandlingStarted(incoming_queue_time_.get());
     ADOPT_TRACE(incoming->trace());
 
@@ -229,8 +335,24 @@ void ServicePool::RunThread() {
 
     // Release the InboundCall pointer -- when the call is responded to,
     // it will get deleted at that point.
+    ScopedProfilerTag tag(Substitute("rpc=$0", incoming->remote_method().method_name()));
     service_->Handle(incoming.release());
   }
+  service_threads_->Decrement();
+
+  if (extra) {
+    // The records of the consumers stay with the queue: free this one since
+    // the pool may add threads again and again.
+    service_queue_.ReleaseConsumer();
+    MutexLock l(extra_threads_lock_);
+    if (!stop_extra_threads_) {
+      service_threads_removed_->Increment();
+      VLOG(1) << Substitute("Removed an idle thread from service pool $0",
+                            service_->service_name());
+    }
+    num_extra_threads_--;
+    extra_threads_cond_.Signal();
+  }
 }
 
 const string& ServicePool::service_name() const {
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -27,11 +28,15 @@
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/rpc/rpc_service.h"
 #include "kudu/rpc/service_queue.h"
+#include "kudu/util/condition_variable.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/mutex.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
 
+template <class T>
+class AtomicGauge;
 class Counter;
 class Histogram;
 class MetricEntity;
@@ -64,6 +69,16 @@ class ServicePool : public RpcService {
     too_busy_hook_ = std::move(hook);
   }
 
+  // Allow the pool to grow up to 'max_threads' threads, past the threads it
+  // starts with, while its calls wait in the queue for more than
+  // --rpc_service_pool_grow_queue_time_ms with none of its threads idle. The
+  // added threads exit once idle for --rpc_service_pool_idle_thread_timeout_ms.
+  //
+  // Must be called before Init().
+  void set_max_threads(int max_threads) {
+    max_threads_ = max_threads;
+  }
+
   // Start up the thread pool.
   virtual Status Init(int num_threads);
 
@@ -89,8 +104,17 @@ class ServicePool : public RpcService {
   const std::string& service_name() const;
 
  private:
-  void RunThread();
-  void RejectTooBusy(InboundCall* c);
+  // Runs a thread of the pool. The threads added past those started by Init()
+  // are 'extra' ones, which exit once idle.
+  void RunThread(bool extra);
+
+  // Adds an extra thread to the pool if 'call', which was just taken from the
+  // queue, waited in it too long and there's room for one.
+  void MaybeAddThread(const InboundCall& call);
+
+  // Rejects 'c' because the service queue returned 'queue_status' for it or
+  // for the call which evicted it.
+  void RejectTooBusy(InboundCall* c, QueueStatus queue_status);
 
   std::unique_ptr<ServiceIf> service_;
   std::vector<scoped_refptr<kudu::Thread> > threads_;
@@ -98,10 +122,32 @@ class ServicePool : public RpcService {
   scoped_refptr<Histogram> incoming_queue_time_;
   scoped_refptr<Counter> rpcs_timed_out_in_queue_;
   scoped_refptr<Counter> rpcs_queue_overflow_;
+  scoped_refptr<AtomicGauge<int32_t>> service_threads_;
+  scoped_refptr<Counter> service_threads_added_;
+  scoped_refptr<Counter> service_threads_removed_;
 
   mutable Mutex shutdown_lock_;
   bool closing_;
 
+  // The number of threads started by Init(), and the maximum number of
+  // threads of the pool if greater.
+  int min_threads_;
+  int max_threads_;
+
+  // Protects the fields below, and is signaled when an extra thread exits.
+  Mutex extra_threads_lock_;
+  ConditionVariable extra_threads_cond_;
+
+  // The number of extra threads running.
+  int num_extra_threads_;
+
+  // Whether the pool is shutting down, so that no extra thread may be added.
+  bool stop_extra_threads_;
+
+  // No extra thread is added before this time, so that the last one added
+  // gets a chance to drain the queue first.
+  MonoTime next_extra_thread_time_;
+
   std::function<void(void)> too_busy_hook_;
 
   DISALLOW_COPY_AND_ASSIGN(ServicePool);
@@ -30,7 +30,9 @@
 
 #include "kudu/gutil/atomicops.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/rpc/inbound_call.h"
+#include "kudu/rpc/service_if.h"
 #include "kudu/rpc/service_queue.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/stopwatch.h"
@@ -50,6 +52,8 @@ DEFINE_int32(num_consumers, 20,
 DEFINE_int32(max_queue_size, 50,
              "Max queue length");
 
+DECLARE_int32(rpc_service_queue_codel_target_ms);
+
 namespace kudu {
 namespace rpc {
 
@@ -147,5 +151,127 @@ TEST(TestServiceQueue, LifoServiceQueuePerf) {
   LOG(INFO) << "Avg idle workers:     " << total_idle_workers / static_cast<double>(total_sample);
 }
 
+namespace {
+
+// Returns a new call, of a batch method if 'batch' is true.
+InboundCall* NewCall(bool batch) {
+  InboundCall* call = new InboundCall(nullptr);
+  call->RecordCallReceived();
+  if (batch) {
+    scoped_refptr<RpcMethodInfo> info(new RpcMethodInfo);
+    info->batch = true;
+    call->set_method_info(std::move(info));
+  }
+  return call;
+}
+
+// Takes the calls from 'queue' on a thread of its own, which is bound to it,
+// and returns whether each was a batch call.
+vector<bool> TakeCalls(LifoServiceQueue* queue, int num_calls) {
+  vector<bool> batch;
+  std::thread t([&]() {
+    for (int i = 0; i < num_calls; i++) {
+      unique_ptr<InboundCall> call;
+      CHECK(queue->BlockingGet(&call));
+      batch.push_back(call->method_info() != nullptr);
+    }
+  });
+  t.join();
+  return batch;
+}
+
+} // anonymous namespace
+
+TEST(TestServiceQueue, TestBatchCalls) {
+  LifoServiceQueue queue(10);
+  std::optional<InboundCall*> evicted;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(QUEUE_SUCCESS, queue.Put(NewCall(true), &evicted));
+  }
+  for (int i = 0; i < 6; i++) {
+    ASSERT_EQ(QUEUE_SUCCESS, queue.Put(NewCall(false), &evicted));
+  }
+  ASSERT_FALSE(evicted);
+
+  // The batch calls get one turn every 4 other calls.
+  vector<bool> expected = { false, false, false, false, true, false, false, true, true };
+  ASSERT_EQ(expected, TakeCalls(&queue, expected.size()));
+  queue.Shutdown();
+}
+
+TEST(TestServiceQueue, TestBatchCallsEvictedFirst) {
+  LifoServiceQueue queue(2);
+  std::optional<InboundCall*> evicted;
+  InboundCall* batch_call = NewCall(true);
+  ASSERT_EQ(QUEUE_SUCCESS, queue.Put(batch_call, &evicted));
+  ASSERT_EQ(QUEUE_SUCCESS, queue.Put(NewCall(false), &evicted));
+  ASSERT_FALSE(evicted);
+
+  // A non-batch call evicts the batch call, despite its later deadline.
+  ASSERT_EQ(QUEUE_SUCCESS, queue.Put(NewCall(false), &evicted));
+  ASSERT_TRUE(evicted);
+  ASSERT_EQ(batch_call, *evicted);
+  delete *evicted;
+
+  // A batch call can't evict non-batch calls.
+  unique_ptr<InboundCall> rejected(NewCall(true));
+  evicted.reset();
+  ASSERT_EQ(QUEUE_FULL, queue.Put(rejected.get(), &evicted));
+  ASSERT_FALSE(evicted);
+
+  ASSERT_EQ(vector<bool>({ false, false }), TakeCalls(&queue, 2));
+  queue.Shutdown();
+}
+
+TEST(TestServiceQueue, TestCodelAdmission) {
+  google::FlagSaver saver;
+  FLAGS_rpc_service_queue_codel_target_ms = 10;
+  LifoServiceQueue queue(10);
+  std::optional<InboundCall*> evicted;
+
+  // Have the calls wait past the target over a whole interval.
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(QUEUE_SUCCESS, queue.Put(NewCall(false), &evicted));
+    SleepFor(MonoDelta::FromMilliseconds(60));
+    ASSERT_EQ(vector<bool>({ false }), TakeCalls(&queue, 1));
+  }
+
+  // Only the non-batch calls are admitted.
+  unique_ptr<InboundCall> rejected(NewCall(true));
+  ASSERT_EQ(QUEUE_OVERLOADED, queue.Put(rejected.get(), &evicted));
+  ASSERT_EQ(QUEUE_SUCCESS, queue.Put(NewCall(false), &evicted));
+  ASSERT_FALSE(evicted);
+  ASSERT_EQ(vector<bool>({ false }), TakeCalls(&queue, 1));
+  queue.Shutdown();
+}
+
+TEST(TestServiceQueue, TestBlockingGetDeadline) {
+  LifoServiceQueue queue(10);
+  std::thread t([&]() {
+    // Nothing to take before the deadline.
+    unique_ptr<InboundCall> call;
+    const MonoDelta kWait = MonoDelta::FromMilliseconds(50);
+    MonoTime start = MonoTime::Now();
+    ASSERT_FALSE(queue.BlockingGet(&call, start + kWait));
+    ASSERT_GE(MonoTime::Now() - start, kWait);
+    ASSERT_EQ(nullptr, call.get());
+    ASSERT_EQ(0, queue.estimated_idle_worker_count());
+
+    // A call posted while waiting is taken.
+    std::thread producer([&]() {
+      SleepFor(MonoDelta::FromMilliseconds(10));
+      std::optional<InboundCall*> evicted;
+      CHECK_EQ(QUEUE_SUCCESS, queue.Put(NewCall(false), &evicted));
+    });
+    ASSERT_TRUE(queue.BlockingGet(&call, MonoTime::Now() + MonoDelta::FromSeconds(30)));
+    ASSERT_NE(nullptr, call.get());
+    producer.join();
+
+    queue.ReleaseConsumer();
+  });
+  t.join();
+  queue.Shutdown();
+}
+
 } // namespace rpc
 } // namespace kudu
@@ -17,29 +17,63 @@
 
 #include "kudu/rpc/service_queue.h"
 
+#include <algorithm>
 #include <mutex>
 #include <optional>
 #include <ostream>
 
+#include <gflags/gflags.h>
+
 #include "kudu/gutil/port.h"
+#include "kudu/util/flag_tags.h"
+
+DEFINE_int32(rpc_service_queue_batch_call_ratio, 4,
+             "When both batch calls (of RPC methods doing bulk work, like full "
+             "scans) and other calls wait in a service queue, the number of "
+             "other calls handled for each batch call.");
+TAG_FLAG(rpc_service_queue_batch_call_ratio, advanced);
+TAG_FLAG(rpc_service_queue_batch_call_ratio, experimental);
+TAG_FLAG(rpc_service_queue_batch_call_ratio, runtime);
+
+DEFINE_int32(rpc_service_queue_codel_target_ms, 0,
+             "If greater than 0, the queue delay above which a service queue "
+             "whose calls all waited at least that long over the last 100ms "
+             "rejects new batch calls as too busy, until the delays drop below "
+             "it again. 0 disables this admission control.");
+TAG_FLAG(rpc_service_queue_codel_target_ms, advanced);
+TAG_FLAG(rpc_service_queue_codel_target_ms, experimental);
+TAG_FLAG(rpc_service_queue_codel_target_ms, runtime);
 
 namespace kudu {
 namespace rpc {
 
+namespace {
+// The interval over which the queue delays are tracked, as recommended for
+// CoDel.
+const MonoDelta kCodelInterval = MonoDelta::FromMilliseconds(100);
+} // anonymous namespace
+
 __thread LifoServiceQueue::ConsumerState* LifoServiceQueue::tl_consumer_ = nullptr;
 
 LifoServiceQueue::LifoServiceQueue(int max_size)
    : shutdown_(false),
-     max_queue_size_(max_size) {
+     max_queue_size_(max_size),
+     num_calls_since_batch_call_(0),
+     overloaded_(false) {
   CHECK_GT(max_queue_size_, 0);
 }
 
 LifoServiceQueue::~LifoServiceQueue() {
-  DCHECK(queue_.empty())
+  DCHECK(queue_.empty() && batch_queue_.empty())
       << "ServiceQueue holds bare pointers at destruction time";
 }
 
 bool LifoServiceQueue::BlockingGet(std::unique_ptr<InboundCall>* out) {
+  return BlockingGet(out, MonoTime::Max());
+}
+
+bool LifoServiceQueue::BlockingGet(std::unique_ptr<InboundCall>* out,
+                                   const MonoTime& deadline) {
   auto consumer = tl_consumer_;
   if (PREDICT_FALSE(!consumer)) {
     consumer = tl_consumer_ = new ConsumerState(this);
@@ -50,19 +84,41 @@ bool LifoServiceQueue::BlockingGet(std::unique_ptr<InboundCall>* out) {
   while (true) {
     {
       std::lock_guard<simple_spinlock> l(lock_);
-      if (!queue_.empty()) {
-        auto it = queue_.begin();
+      if (!queue_.empty() || !batch_queue_.empty()) {
+        CallQueue* queue = PickQueueUnlocked();
+        auto it = queue->begin();
         out->reset(*it);
-        queue_.erase(it);
+        queue->erase(it);
+        if (FLAGS_rpc_service_queue_codel_target_ms > 0) {
+          MonoTime now = MonoTime::Now();
+          RecordQueueDelayUnlocked(now, now - (*out)->GetTimeReceived());
+        }
         return true;
       }
+      // The queue is drained: whatever stood in it is gone.
+      overloaded_ = false;
       if (PREDICT_FALSE(shutdown_)) {
         return false;
       }
       consumer->DCheckBoundInstance(this);
       waiting_consumers_.push_back(consumer);
     }
-    InboundCall* call = consumer->Wait();
+    InboundCall* call = nullptr;
+    if (deadline == MonoTime::Max()) {
+      call = consumer->Wait();
+    } else if (!consumer->WaitUntil(deadline, &call)) {
+      {
+        std::lock_guard<simple_spinlock> l(lock_);
+        auto it = std::find(waiting_consumers_.begin(), waiting_consumers_.end(), consumer);
+        if (it != waiting_consumers_.end()) {
+          waiting_consumers_.erase(it);
+          return false;
+        }
+      }
+      // A producer popped this consumer right as the deadline passed: it's
+      // about to post to it.
+      call = consumer->Wait();
+    }
     if (call != nullptr) {
       out->reset(call);
       return true;
@@ -79,12 +135,21 @@ QueueStatus LifoServiceQueue::Put(InboundCall* call,
     return QUEUE_SHUTDOWN;
   }
 
-  DCHECK(!(waiting_consumers_.size() > 0 && queue_.size() > 0));
+  const bool is_batch = IsBatchCall(call);
+  if (is_batch && overloaded_) {
+    return QUEUE_OVERLOADED;
+  }
+
+  DCHECK(!(waiting_consumers_.size() > 0 &&
+           (queue_.size() > 0 || batch_queue_.size() > 0)));
 
   // fast path
-  if (queue_.empty() && waiting_consumers_.size() > 0) {
+  if (queue_.empty() && batch_queue_.empty() && waiting_consumers_.size() > 0) {
     auto consumer = waiting_consumers_[waiting_consumers_.size() - 1];
     waiting_consumers_.pop_back();
+    if (FLAGS_rpc_service_queue_codel_target_ms > 0) {
+      RecordQueueDelayUnlocked(MonoTime::Now(), MonoDelta::FromNanoseconds(0));
+    }
     // Notify condition var(and wake up consumer thread) takes time,
     // so put it out of spinlock scope.
     l.unlock();
@@ -92,23 +157,72 @@ QueueStatus LifoServiceQueue::Put(InboundCall* call,
     return QUEUE_SUCCESS;
   }
 
-  if (PREDICT_FALSE(queue_.size() >= max_queue_size_)) {
-    // eviction
-    DCHECK_EQ(queue_.size(), max_queue_size_);
-    auto it = queue_.end();
+  if (PREDICT_FALSE(queue_.size() + batch_queue_.size() >= max_queue_size_)) {
+    // eviction: batch calls go first, then the calls of the same class as
+    // 'call' with later deadlines.
+    DCHECK_EQ(queue_.size() + batch_queue_.size(), max_queue_size_);
+    CallQueue* victims = batch_queue_.empty() ? &queue_ : &batch_queue_;
+    if (is_batch && victims != &batch_queue_) {
+      return QUEUE_FULL;
+    }
+    auto it = victims->end();
     --it;
-    if (DeadlineLess(*it, call)) {
+    if (is_batch == (victims == &batch_queue_) && DeadlineLess(*it, call)) {
       return QUEUE_FULL;
     }
 
     *evicted = *it;
-    queue_.erase(it);
+    victims->erase(it);
   }
 
-  queue_.insert(call);
+  (is_batch ? batch_queue_ : queue_).insert(call);
   return QUEUE_SUCCESS;
 }
 
+LifoServiceQueue::CallQueue* LifoServiceQueue::PickQueueUnlocked() {
+  DCHECK(!queue_.empty() || !batch_queue_.empty());
+  if (batch_queue_.empty()) {
+    return &queue_;
+  }
+  if (queue_.empty() ||
+      num_calls_since_batch_call_ >= FLAGS_rpc_service_queue_batch_call_ratio) {
+    num_calls_since_batch_call_ = 0;
+    return &batch_queue_;
+  }
+  num_calls_since_batch_call_++;
+  return &queue_;
+}
+
+void LifoServiceQueue::RecordQueueDelayUnlocked(MonoTime now, MonoDelta delay) {
+  if (!codel_min_delay_.Initialized() || delay < codel_min_delay_) {
+    codel_min_delay_ = delay;
+  }
+  if (!codel_interval_end_.Initialized()) {
+    codel_interval_end_ = now + kCodelInterval;
+  } else if (now >= codel_interval_end_) {
+    overloaded_ = codel_min_delay_ >
+        MonoDelta::FromMilliseconds(FLAGS_rpc_service_queue_codel_target_ms);
+    codel_min_delay_ = MonoDelta();
+    codel_interval_end_ = now + kCodelInterval;
+  }
+}
+
+void LifoServiceQueue::ReleaseConsumer() {
+  auto* consumer = tl_consumer_;
+  if (consumer == nullptr) {
+    return;
+  }
+  consumer->DCheckBoundInstance(this);
+  tl_consumer_ = nullptr;
+  std::lock_guard<simple_spinlock> l(lock_);
+  DCHECK(std::find(waiting_consumers_.begin(), waiting_consumers_.end(), consumer) ==
+         waiting_consumers_.end());
+  consumers_.erase(std::find_if(consumers_.begin(), consumers_.end(),
+                                [&](const std::unique_ptr<ConsumerState>& c) {
+                                  return c.get() == consumer;
+                                }));
+}
+
 void LifoServiceQueue::Shutdown() {
   std::lock_guard<simple_spinlock> l(lock_);
   shutdown_ = true;
@@ -122,7 +236,7 @@ void LifoServiceQueue::Shutdown() {
 
 bool LifoServiceQueue::empty() const {
   std::lock_guard<simple_spinlock> l(lock_);
-  return queue_.empty();
+  return queue_.empty() && batch_queue_.empty();
 }
 
 int LifoServiceQueue::max_size() const {
@@ -137,6 +251,10 @@ std::string LifoServiceQueue::ToString() const {
     ret.append(t->ToString());
     ret.append("\n");
   }
+  for (const auto* t : batch_queue_) {
+    ret.append(t->ToString());
+    ret.append(" (batch)\n");
+  }
   return ret;
 }
 
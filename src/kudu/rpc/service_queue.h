@@ -27,6 +27,7 @@
 #include "kudu/gutil/dynamic_annotations.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/rpc/inbound_call.h"
+#include "kudu/rpc/service_if.h"
 #include "kudu/util/condition_variable.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/monotime.h"
@@ -39,7 +40,8 @@ namespace rpc {
 enum QueueStatus {
   QUEUE_SUCCESS = 0,
   QUEUE_SHUTDOWN = 1,
-  QUEUE_FULL = 2
+  QUEUE_FULL = 2,
+  QUEUE_OVERLOADED = 3
 };
 
 // Blocking queue used for passing inbound RPC calls to the service handler pool.
@@ -52,6 +54,16 @@ enum QueueStatus {
 // can evict any call that does not have a deadline. This incentivizes clients to
 // provide accurate deadlines for their calls.
 //
+// The calls of methods with the 'batch_rpc' option (see RpcMethodInfo::batch)
+// are queued in a class of their own. When calls of both classes are queued,
+// the workers take one batch call every --rpc_service_queue_batch_call_ratio
+// calls of the other class, and a full queue evicts batch calls first.
+//
+// With --rpc_service_queue_codel_target_ms, the queue also tracks how long the
+// calls wait in it: once even the shortest wait over an interval exceeds the
+// target, a standing queue has built up and new batch calls are rejected until
+// the waits drop below the target again, CoDel style.
+//
 // In order to improve concurrent throughput, this class uses a LIFO design:
 // Each consumer thread has its own lock and condition variable. If a
 // consumer arrives and there is no work available in the queue, it will not
@@ -80,11 +92,23 @@ class LifoServiceQueue {
   // getting the element.
   bool BlockingGet(std::unique_ptr<InboundCall>* out);
 
+  // Like BlockingGet(), but also returns false if 'deadline' passes before an
+  // element can be taken.
+  bool BlockingGet(std::unique_ptr<InboundCall>* out, const MonoTime& deadline);
+
+  // Unbinds the calling consumer thread from the queue and frees its record,
+  // e.g. before the thread exits while the queue lives on.
+  //
+  // REQUIRES: the calling thread isn't waiting in BlockingGet().
+  void ReleaseConsumer();
+
   // Add a new call to the queue.
   // Returns:
   // - QUEUE_SHUTDOWN if Shutdown() has already been called.
   // - QUEUE_FULL if the queue is full and 'call' has a later deadline than any
-  //   RPC already in the queue.
+  //   RPC already in the queue which it could evict.
+  // - QUEUE_OVERLOADED if 'call' is a batch call and a standing queue has
+  //   built up.
   // - QUEUE_SUCCESS if 'call' was enqueued.
   //
   // In the case of a 'QUEUE_SUCCESS' response, the new element may have bumped
@@ -112,7 +136,7 @@ class LifoServiceQueue {
     // so this method won't try to traverse any actual nodes of the underlying
     // RB tree. Investigation of the libstdcxx implementation confirms that
     // size() is a simple field access of the _Rb_tree structure.
-    int ret = queue_.size();
+    int ret = queue_.size() + batch_queue_.size();
     ANNOTATE_IGNORE_READS_END();
     return ret;
   }
@@ -148,6 +172,24 @@ class LifoServiceQueue {
     }
   };
 
+  typedef std::multiset<InboundCall*, DeadlineLessStruct> CallQueue;
+
+  static bool IsBatchCall(InboundCall* call) {
+    const auto* info = call->method_info();
+    return info != nullptr && info->batch;
+  }
+
+  // Returns the queue to take the next call from.
+  //
+  // REQUIRES: the queues aren't both empty, lock_ is held.
+  CallQueue* PickQueueUnlocked();
+
+  // Records that a call waited 'delay' in the queue before being taken by a
+  // worker at 'now', updating 'overloaded_'.
+  //
+  // REQUIRES: lock_ is held.
+  void RecordQueueDelayUnlocked(MonoTime now, MonoDelta delay);
+
   // The thread-local record corresponding to a single consumer thread.
   // Threads push this record onto the waiting_consumers_ stack when
   // they are awaiting work. Producers pop the top waiting consumer and
@@ -180,6 +222,20 @@ class LifoServiceQueue {
       return ret;
     }
 
+    // Like Wait(), but returns false if nothing was posted by 'deadline'.
+    bool WaitUntil(const MonoTime& deadline, InboundCall** call) {
+      MutexLock l(lock_);
+      while (should_wake_ == false) {
+        if (!cond_.WaitUntil(deadline) && !should_wake_) {
+          return false;
+        }
+      }
+      should_wake_ = false;
+      *call = call_;
+      call_ = nullptr;
+      return true;
+    }
+
     void DCheckBoundInstance(LifoServiceQueue* q) {
       DCHECK_EQ(q, bound_queue_);
     }
@@ -204,9 +260,21 @@ class LifoServiceQueue {
   // Stack of consumer threads which are currently waiting for work.
   std::vector<ConsumerState*> waiting_consumers_;
 
-  // The actual queue. Work is only added to the queue when there were no
-  // consumers available for a "direct hand-off".
-  std::multiset<InboundCall*, DeadlineLessStruct> queue_;
+  // The actual queues, for the batch calls and for the others. Work is only
+  // added to the queues when there were no consumers available for a "direct
+  // hand-off".
+  CallQueue queue_;
+  CallQueue batch_queue_;
+
+  // The number of calls taken from 'queue_' since the last call taken from
+  // 'batch_queue_' while both had calls.
+  int num_calls_since_batch_call_;
+
+  // The shortest queue delay seen in the current CoDel interval, which ends
+  // at 'codel_interval_end_', and whether a standing queue has built up.
+  MonoDelta codel_min_delay_;
+  MonoTime codel_interval_end_;
+  bool overloaded_;
 
   // The total set of consumers who have ever accessed this queue.
   std::vector<std::unique_ptr<ConsumerState>> consumers_;
@@ -24,17 +24,22 @@
 #include <cstdint>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include <boost/container/vector.hpp>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/gutil/bits.h"
 #include "kudu/gutil/endian.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/constants.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/net/socket.h"
 
@@ -67,12 +72,20 @@ static bool ValidateMaxMessageSize(const char* flagname, int64_t value) {
 }
 DEFINE_validator(rpc_max_message_size, &ValidateMaxMessageSize);
 
+DEFINE_int64(rpc_transfer_buffer_pool_bytes, 32 * 1024 * 1024,
+             "Maximum number of bytes of RPC transfer buffers kept in a pool "
+             "for reuse once their call completed, split evenly between their "
+             "size classes. If 0, the buffers are not pooled.");
+TAG_FLAG(rpc_transfer_buffer_pool_bytes, advanced);
+TAG_FLAG(rpc_transfer_buffer_pool_bytes, runtime);
+
 namespace kudu {
 namespace rpc {
 
 using std::ostringstream;
 using std::set;
 using std::string;
+using std::vector;
 using strings::Substitute;
 
 #define RETURN_ON_ERROR_OR_SOCKET_NOT_READY(status)               \
@@ -86,6 +99,64 @@ using strings::Substitute;
     }                                                             \
   } while (0)
 
+namespace {
+
+// The pooled buffers range from 4KiB to 1MiB.
+constexpr int kMinPooledBufferShift = 12;
+constexpr int kMaxPooledBufferShift = 20;
+constexpr int kNumBufferSizeClasses = kMaxPooledBufferShift - kMinPooledBufferShift + 1;
+
+struct BufferSizeClass {
+  simple_spinlock lock;
+  vector<faststring> buffers;
+};
+
+BufferSizeClass* GetBufferSizeClass(int shift) {
+  // Leaked, so that buffers can be released during the static destruction.
+  static BufferSizeClass* size_classes = new BufferSizeClass[kNumBufferSizeClasses];
+  DCHECK_GE(shift, kMinPooledBufferShift);
+  DCHECK_LE(shift, kMaxPooledBufferShift);
+  return &size_classes[shift - kMinPooledBufferShift];
+}
+
+} // anonymous namespace
+
+faststring TransferBufferPool::Acquire(size_t size) {
+  if (size > (size_t{1} << kMaxPooledBufferShift) || FLAGS_rpc_transfer_buffer_pool_bytes <= 0) {
+    return faststring(size);
+  }
+  const int shift = std::max(kMinPooledBufferShift, Bits::Log2Ceiling64(size));
+  auto* size_class = GetBufferSizeClass(shift);
+  {
+    std::lock_guard<simple_spinlock> l(size_class->lock);
+    if (!size_class->buffers.empty()) {
+      faststring buf(std::move(size_class->buffers.back()));
+      size_class->buffers.pop_back();
+      return buf;
+    }
+  }
+  return faststring(size_t{1} << shift);
+}
+
+void TransferBufferPool::Release(faststring buf) {
+  const size_t capacity = buf.capacity();
+  if (capacity < (size_t{1} << kMinPooledBufferShift)) {
+    return;
+  }
+  const int shift = Bits::Log2Floor64(capacity);
+  if (shift > kMaxPooledBufferShift) {
+    return;
+  }
+  const size_t max_buffers =
+      (std::max<int64_t>(FLAGS_rpc_transfer_buffer_pool_bytes, 0) / kNumBufferSizeClasses) >> shift;
+  auto* size_class = GetBufferSizeClass(shift);
+  buf.clear();
+  std::lock_guard<simple_spinlock> l(size_class->lock);
+  if (size_class->buffers.size() < max_buffers) {
+    size_class->buffers.emplace_back(std::move(buf));
+  }
+}
+
 InboundTransfer::InboundTransfer()
     : total_length_(0),
       cur_offset_(0) {
@@ -99,6 +170,10 @@ InboundTransfer::InboundTransfer(faststring initial_buf)
   buf_.resize(std::max<size_t>(kMsgLengthPrefixLength, buf_.size()));
 }
 
+InboundTransfer::~InboundTransfer() {
+  TransferBufferPool::Release(std::move(buf_));
+}
+
 Status InboundTransfer::ReceiveBuffer(Socket* socket, faststring* extra_4) {
   static constexpr int kExtraReadLength = kMsgLengthPrefixLength;
   if (total_length_ == 0) {
@@ -136,6 +211,11 @@ Status InboundTransfer::ReceiveBuffer(Socket* socket, faststring* extra_4) {
       return Status::NetworkError(
           Substitute("RPC frame had invalid length of $0", total_length_));
     }
+    if (buf_.capacity() < total_length_ + kExtraReadLength) {
+      faststring buf = TransferBufferPool::Acquire(total_length_ + kExtraReadLength);
+      buf.append(buf_.data(), cur_offset_);
+      buf_ = std::move(buf);
+    }
     buf_.resize(total_length_ + kExtraReadLength);
 
     // Fall through to receive the message body, which is likely to be already
@@ -58,6 +58,25 @@ class TransferLimits {
 // is worth the cost.
 typedef boost::container::small_vector<Slice, 4> TransferPayload;
 
+// A process-wide pool of the buffers of received transfers and of serialized
+// responses, by power-of-two size classes, so that servers at high RPC rates
+// don't allocate and fault in new buffers for every call.
+//
+// This class is thread-safe.
+class TransferBufferPool {
+ public:
+  // Returns an empty buffer with a capacity of at least 'size' bytes, from the
+  // pool if possible.
+  static faststring Acquire(size_t size);
+
+  // Returns 'buf' to the pool, unless it is too small or too large to be
+  // pooled, or its size class is full.
+  static void Release(faststring buf);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(TransferBufferPool);
+};
+
 // This class is used internally by the RPC layer to represent an inbound
 // transfer in progress.
 //
@@ -69,6 +88,7 @@ class InboundTransfer {
 
   InboundTransfer();
   explicit InboundTransfer(faststring initial_buf);
+  ~InboundTransfer();
 
   // Read from the socket into our buffer.
   //
@@ -94,6 +114,7 @@ class InboundTransfer {
 
  private:
 
+  // Acquired from TransferBufferPool once the length of the transfer is known.
   faststring buf_;
 
   // 0 indicates not yet set
@@ -28,10 +28,14 @@
 #include <string>
 #include <utility>
 
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
 #include "kudu/gutil/strings/strip.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/security/cert.h"
 #include "kudu/security/tls_socket.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/net/socket.h"
 #include "kudu/util/openssl_util.h"
 #include "kudu/util/status.h"
@@ -45,6 +49,15 @@
 #define TLS1_3_VERSION 0x0304
 #endif
 
+DEFINE_bool(rpc_tls_enable_ktls, false,
+            "Whether to offload the encryption of TLS-secured RPC connections "
+            "to the kernel (kTLS) once they are negotiated. Only effective for "
+            "TLSv1.3 connections on Linux kernels and ciphers supporting kTLS, "
+            "with Kudu built against OpenSSL 3.2 or newer; other connections "
+            "keep encrypting in userspace.");
+TAG_FLAG(rpc_tls_enable_ktls, advanced);
+TAG_FLAG(rpc_tls_enable_ktls, experimental);
+
 using std::string;
 using std::unique_ptr;
 using strings::Substitute;
@@ -52,6 +65,32 @@ using strings::Substitute;
 namespace kudu {
 namespace security {
 
+#if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS) && OPENSSL_VERSION_NUMBER >= 0x30200000L
+namespace {
+
+// OpenSSL hands a connection's encryption over to the kernel only when new
+// keys are installed while the SSL instance is attached to a socket. Since the
+// handshake runs over memory BIOs, tunneled in the negotiation messages, the
+// keys are updated once the instance is attached to the socket: this offloads
+// the sending side, and the peer's reply to the update offloads the receiving
+// side.
+//
+// REQUIRES: the TLSv1.3 handshake is complete and 'ssl' is attached to a
+//           blocking socket.
+Status EnableKtls(SSL* ssl) {
+  SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+  if (SSL_key_update(ssl, SSL_KEY_UPDATE_REQUESTED) != 1 ||
+      SSL_do_handshake(ssl) != 1) {
+    return Status::RuntimeError("failed to update TLS keys", GetOpenSSLErrors());
+  }
+  VLOG(2) << "kTLS is " << (BIO_get_ktls_send(SSL_get_wbio(ssl)) ? "" : "not ")
+          << "used to send on the TLS connection";
+  return Status::OK();
+}
+
+} // anonymous namespace
+#endif
+
 void TlsHandshake::SetSSLVerify() {
   SCOPED_OPENSSL_NO_PENDING_ERRORS;
   CHECK(ssl_);
@@ -321,6 +360,12 @@ Status TlsHandshake::Finish(unique_ptr<Socket>* socket) {
     rbio_pending_data_.clear();
   }
 
+#if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS) && OPENSSL_VERSION_NUMBER >= 0x30200000L
+  if (FLAGS_rpc_tls_enable_ktls && SSL_version(ssl) == TLS1_3_VERSION) {
+    RETURN_NOT_OK_PREPEND(EnableKtls(ssl), "unable to offload TLS to the kernel");
+  }
+#endif
+
   // Transfer the SSL instance to the socket.
   socket->reset(new TlsSocket(fd, std::move(ssl_)));
 
@@ -31,6 +31,7 @@
 #include <thread>
 #include <vector>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -49,6 +50,8 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+DECLARE_bool(rpc_tls_enable_ktls);
+
 using std::string;
 using std::thread;
 using std::unique_ptr;
@@ -372,5 +375,33 @@ TEST_F(TlsSocketTest, TestNonBlockingWritev) {
   ASSERT_OK(client_sock->Close());
 }
 
+// Test that data goes through TLS connections whose encryption is offloaded
+// to the kernel, if the build and the kernel support it.
+TEST_F(TlsSocketTest, TestEchoWithKtls) {
+  FLAGS_rpc_tls_enable_ktls = true;
+  Random rng(GetRandomSeed32());
+
+  EchoServer server;
+  NO_FATALS(server.Start());
+
+  unique_ptr<Socket> client_sock;
+  NO_FATALS(ConnectClient(server.listen_addr(), &client_sock));
+
+  unique_ptr<uint8_t[]> buf(new uint8_t[kEchoChunkSize]);
+  unique_ptr<uint8_t[]> rbuf(new uint8_t[kEchoChunkSize]);
+  for (int i = 0; i < 3; i++) {
+    RandomString(buf.get(), kEchoChunkSize, &rng);
+    size_t n;
+    ASSERT_OK(client_sock->BlockingWrite(buf.get(), kEchoChunkSize, &n,
+                                         MonoTime::Now() + kTimeout));
+    ASSERT_OK(client_sock->BlockingRecv(rbuf.get(), kEchoChunkSize, &n,
+                                        MonoTime::Now() + kTimeout));
+    ASSERT_EQ(0, memcmp(buf.get(), rbuf.get(), kEchoChunkSize));
+  }
+
+  server.Stop();
+  ASSERT_OK(client_sock->Close());
+}
+
 } // namespace security
 } // namespace kudu
@@ -622,6 +622,46 @@ TEST_F(TokenTest, TestEndToEnd_Valid) {
   ASSERT_EQ(TokenVerificationResult::VALID, verifier.VerifyTokenSignature(signed_token, &token));
 }
 
+// Test that the tokens verified again are served from the cache of the
+// verifier, but only if presented with the same data and key.
+TEST_F(TokenTest, TestVerifyCachedToken) {
+  TokenSigner signer(kTokenValiditySeconds, kTokenValiditySeconds, 10);
+  {
+    unique_ptr<TokenSigningPrivateKey> key;
+    ASSERT_OK(signer.CheckNeedKey(&key));
+    ASSERT_NE(nullptr, key.get());
+    ASSERT_OK(signer.AddKey(std::move(key)));
+  }
+  TokenVerifier verifier;
+  ASSERT_OK(verifier.ImportKeys(signer.verifier().ExportKeys()));
+
+  SignedTokenPB signed_token = MakeUnsignedToken(WallTime_Now() + 600);
+  ASSERT_OK(signer.SignToken(&signed_token));
+  TokenPB first_token;
+  ASSERT_EQ(TokenVerificationResult::VALID,
+            verifier.VerifyTokenSignature(signed_token, &first_token));
+  TokenPB cached_token;
+  ASSERT_EQ(TokenVerificationResult::VALID,
+            verifier.VerifyTokenSignature(signed_token, &cached_token));
+  ASSERT_EQ(SecureDebugString(first_token), SecureDebugString(cached_token));
+
+  // The signature of a cached token doesn't make other data valid.
+  {
+    SignedTokenPB forged_token = signed_token;
+    forged_token.set_token_data(MakeUnsignedToken(WallTime_Now() + 1200).token_data());
+    TokenPB token;
+    ASSERT_EQ(TokenVerificationResult::INVALID_SIGNATURE,
+              verifier.VerifyTokenSignature(forged_token, &token));
+  }
+  {
+    SignedTokenPB forged_token = signed_token;
+    forged_token.set_signing_key_seq_num(signed_token.signing_key_seq_num() + 1);
+    TokenPB token;
+    ASSERT_EQ(TokenVerificationResult::UNKNOWN_SIGNING_KEY,
+              verifier.VerifyTokenSignature(forged_token, &token));
+  }
+}
+
 // Test all of the possible cases covered by token verification.
 // See TokenVerificationResult.
 TEST_F(TokenTest, TestEndToEnd_InvalidCases) {
@@ -25,15 +25,34 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/map-util.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/walltime.h"
 #include "kudu/security/token.pb.h"
 #include "kudu/security/token_signing_key.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/slice.h"
 #include "kudu/util/status.h"
+#include "kudu/util/ttl_cache.h"
+
+DEFINE_uint32(token_verifier_cache_capacity_mb, 1,
+              "Capacity of the cache of the tokens found valid by a server, in "
+              "MiB. The cached tokens presented again aren't verified again, "
+              "sparing the verification of their signature to the RPCs of the "
+              "clients reusing their tokens. Setting this to 0 disables the "
+              "cache.");
+TAG_FLAG(token_verifier_cache_capacity_mb, advanced);
+
+DEFINE_uint32(token_verifier_cache_ttl_sec, 60,
+              "For how long a token found valid is cached, in seconds. The "
+              "tokens expiring earlier are rejected once expired regardless.");
+TAG_FLAG(token_verifier_cache_ttl_sec, advanced);
 
 using std::lock_guard;
 using std::string;
@@ -44,7 +63,24 @@ using std::vector;
 namespace kudu {
 namespace security {
 
+struct TokenVerifier::VerifiedToken {
+  // The data of the signed token, to match the presented tokens against.
+  string token_data;
+  int64_t signing_key_seq_num;
+
+  // The token, as deserialized from 'token_data'.
+  TokenPB token;
+};
+
 TokenVerifier::TokenVerifier() {
+  if (FLAGS_token_verifier_cache_capacity_mb > 0 &&
+      FLAGS_token_verifier_cache_ttl_sec > 0) {
+    verified_tokens_.reset(new VerifiedTokenCache(
+        FLAGS_token_verifier_cache_capacity_mb * 1024 * 1024,
+        MonoDelta::FromSeconds(FLAGS_token_verifier_cache_ttl_sec),
+        /*scrubbing_period=*/{}, /*max_scrubbed_entries_per_pass_num=*/0,
+        "token-verifier-cache"));
+  }
 }
 
 TokenVerifier::~TokenVerifier() {
@@ -111,8 +147,22 @@ TokenVerificationResult TokenVerifier::VerifyTokenSignature(
     return TokenVerificationResult::INVALID_TOKEN;
   }
 
-  if (!token->ParseFromString(signed_token.token_data()) ||
-      !token->has_expire_unix_epoch_seconds()) {
+  // A token presented again with the same signature, key and data was already
+  // found to be properly signed.
+  bool signature_verified = false;
+  if (PREDICT_TRUE(verified_tokens_)) {
+    auto handle = verified_tokens_->Get(signed_token.signature());
+    if (handle &&
+        handle.value().signing_key_seq_num == signed_token.signing_key_seq_num() &&
+        handle.value().token_data == signed_token.token_data()) {
+      *token = handle.value().token;
+      signature_verified = true;
+    }
+  }
+
+  if (!signature_verified &&
+      (!token->ParseFromString(signed_token.token_data()) ||
+       !token->has_expire_unix_epoch_seconds())) {
     return TokenVerificationResult::INVALID_TOKEN;
   }
 
@@ -138,11 +188,18 @@ TokenVerificationResult TokenVerifier::VerifyTokenSignature(
     if (tsk->pb().expire_unix_epoch_seconds() < now) {
       return TokenVerificationResult::EXPIRED_SIGNING_KEY;
     }
-    if (!tsk->VerifySignature(signed_token)) {
+    if (!signature_verified && !tsk->VerifySignature(signed_token)) {
       return TokenVerificationResult::INVALID_SIGNATURE;
     }
   }
 
+  if (!signature_verified && PREDICT_TRUE(verified_tokens_)) {
+    unique_ptr<VerifiedToken> verified(new VerifiedToken {
+        signed_token.token_data(), signed_token.signing_key_seq_num(), *token });
+    const auto charge = sizeof(VerifiedToken) + signed_token.signature().size() +
+        signed_token.token_data().size() + token->SpaceUsedLong();
+    verified_tokens_->Put(signed_token.signature(), std::move(verified), charge);
+  }
   return TokenVerificationResult::VALID;
 }
 
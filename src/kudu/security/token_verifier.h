@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "kudu/gutil/macros.h"
@@ -28,6 +29,8 @@
 namespace kudu {
 
 class Status;
+template<typename K, typename V>
+class TTLCache;
 
 namespace security {
 
@@ -59,6 +62,11 @@ enum class TokenVerificationResult;
 // slow leak is not worrisome. If this class is adopted for any use cases
 // with frequent rotation, GC of expired tokens will need to be added.
 //
+// The tokens found valid are cached for --token_verifier_cache_ttl_sec, keyed
+// by their signature, so that the clients presenting the same token with every
+// RPC don't have it verified with every RPC. The expiration of a cached token
+// and of its signing key are still checked for every verification.
+//
 // This class is thread-safe.
 class TokenVerifier {
  public:
@@ -91,10 +99,18 @@ class TokenVerifier {
  private:
   typedef std::map<int64_t, std::unique_ptr<TokenSigningPublicKey>> KeysMap;
 
+  // A token whose signature was verified, as cached in 'verified_tokens_'.
+  struct VerifiedToken;
+  typedef TTLCache<std::string, VerifiedToken> VerifiedTokenCache;
+
   // Lock protecting keys_by_seq_
   mutable RWMutex lock_;
   KeysMap keys_by_seq_;
 
+  // The tokens recently found valid, keyed by their signature. Null if the
+  // cache is disabled.
+  std::unique_ptr<VerifiedTokenCache> verified_tokens_;
+
   DISALLOW_COPY_AND_ASSIGN(TokenVerifier);
 };
 
@@ -0,0 +1,214 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/server/continuous_profiler.h"
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/gutil/stringprintf.h"
+#include "kudu/util/debug-util.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/logging.h"
+#include "kudu/util/mutex.h"
+#include "kudu/util/os-util.h"
+#include "kudu/util/profiler_tag.h"
+#include "kudu/util/status.h"
+#include "kudu/util/thread.h"
+
+// GLog already implements symbolization. Just import their hidden symbol.
+namespace google {
+// Symbolizes a program counter.  On success, returns true and write the
+// symbol name to "out".  The symbol name is demangled if possible
+// (supports symbols generated by GCC 3.x or newer).  Otherwise,
+// returns false.
+bool Symbolize(void *pc, char *out, size_t out_size);
+}
+
+DEFINE_int32(continuous_profiler_interval_ms, 0,
+             "The interval at which the server samples the stacks of its threads which "
+             "used CPU, making a profile of the recent CPU usage available at "
+             "/pprof/continuous. If 0, the continuous profiler is disabled.");
+TAG_FLAG(continuous_profiler_interval_ms, experimental);
+
+DEFINE_int32(continuous_profiler_window_sec, 60,
+             "How long the samples of the continuous profiler are kept for.");
+TAG_FLAG(continuous_profiler_window_sec, experimental);
+
+using std::string;
+using std::vector;
+
+namespace kudu {
+namespace server {
+
+// The number of symbols above which the cache of symbols is cleared, to bound
+// its memory should the server load and unload many libraries.
+static const size_t kMaxCachedSymbols = 100000;
+
+ContinuousProfiler::ContinuousProfiler()
+    : stop_latch_(1) {
+}
+
+ContinuousProfiler::~ContinuousProfiler() {
+  Stop();
+}
+
+Status ContinuousProfiler::Start() {
+  return Thread::Create("server", "continuous-profiler",
+                        [this]() { this->RunThread(); }, &thread_);
+}
+
+void ContinuousProfiler::Stop() {
+  if (!thread_) return;
+  stop_latch_.CountDown();
+  thread_->Join();
+  thread_.reset();
+}
+
+void ContinuousProfiler::RunThread() {
+  const MonoDelta interval = MonoDelta::FromMilliseconds(FLAGS_continuous_profiler_interval_ms);
+  while (!stop_latch_.WaitFor(interval)) {
+    TakeSamples();
+  }
+}
+
+void ContinuousProfiler::TakeSamples() {
+  vector<pid_t> tids;
+  Status s = ListThreads(&tids);
+  if (!s.ok()) {
+    KLOG_EVERY_N_SECS(WARNING, 60) << "continuous profiler could not list threads: "
+                                   << s.ToString();
+    return;
+  }
+
+  // Only the threads which used CPU since the previous sample are worth
+  // interrupting to collect their stacks.
+  const int64_t self_tid = Thread::CurrentThreadId();
+  std::unordered_map<pid_t, int64_t> cpu_ns;
+  vector<pid_t> busy_tids;
+  vector<int64_t> busy_cpu_ns;
+  for (pid_t tid : tids) {
+    ThreadStats stats;
+    if (tid == self_tid || !GetThreadStats(tid, &stats).ok()) {
+      continue;
+    }
+    const int64_t ns = stats.user_ns + stats.kernel_ns;
+    cpu_ns.emplace(tid, ns);
+    const auto it = prev_cpu_ns_.find(tid);
+    if (it != prev_cpu_ns_.end() && ns > it->second) {
+      busy_tids.push_back(tid);
+      busy_cpu_ns.push_back(ns - it->second);
+    }
+  }
+  prev_cpu_ns_ = std::move(cpu_ns);
+  if (busy_tids.empty()) {
+    return;
+  }
+
+  vector<StackTraceCollector> collectors(busy_tids.size());
+  vector<StackTrace> stacks(busy_tids.size());
+  vector<Status> statuses(busy_tids.size());
+  for (size_t i = 0; i < busy_tids.size(); i++) {
+    statuses[i] = collectors[i].TriggerAsync(busy_tids[i], &stacks[i]);
+  }
+  const MonoTime deadline = MonoTime::Now() + MonoDelta::FromSeconds(1);
+  string folded;
+  string tag;
+  for (size_t i = 0; i < busy_tids.size(); i++) {
+    if (!statuses[i].AndThen([&] { return collectors[i].AwaitCollection(deadline); }).ok()) {
+      continue;
+    }
+    folded.clear();
+    if (ScopedProfilerTag::GetTagOfThread(busy_tids[i], &tag) && !tag.empty()) {
+      folded = tag;
+    }
+    // The frames of the stack are collected from the leaf, while the folded
+    // stacks start from the root.
+    const StackTrace& stack = stacks[i];
+    for (int f = stack.num_frames() - 1; f >= 0; f--) {
+      if (!folded.empty()) {
+        folded.push_back(';');
+      }
+      folded.append(Symbolize(stack.frame(f)));
+    }
+    if (!folded.empty()) {
+      AddSample(folded, busy_cpu_ns[i] / 1000);
+    }
+  }
+}
+
+const string& ContinuousProfiler::Symbolize(void* addr) {
+  auto it = symbols_.find(addr);
+  if (it != symbols_.end()) {
+    return it->second;
+  }
+  if (symbols_.size() >= kMaxCachedSymbols) {
+    symbols_.clear();
+  }
+  char buf[1024];
+  string symbol;
+  // Subtract 1 from the address before symbolizing, because the address on
+  // the stack is the return address of the call rather than the address of
+  // the call instruction itself.
+  if (google::Symbolize(static_cast<char*>(addr) - 1, buf, sizeof(buf))) {
+    symbol = buf;
+  } else {
+    symbol = StringPrintf("%p", addr);
+  }
+  return symbols_.emplace(addr, std::move(symbol)).first->second;
+}
+
+void ContinuousProfiler::AddSample(const string& stack, int64_t weight_us) {
+  const MonoTime now = MonoTime::Now();
+  MutexLock l(lock_);
+  if (buckets_.empty() || now - buckets_.back().start >= MonoDelta::FromSeconds(1)) {
+    const MonoTime window_start =
+        now - MonoDelta::FromSeconds(FLAGS_continuous_profiler_window_sec);
+    while (!buckets_.empty() && buckets_.front().start < window_start) {
+      buckets_.pop_front();
+    }
+    buckets_.emplace_back();
+    buckets_.back().start = now;
+  }
+  buckets_.back().weights[stack] += weight_us;
+}
+
+void ContinuousProfiler::WriteFoldedStacks(MonoDelta window, std::ostream* out) const {
+  const MonoTime window_start = MonoTime::Now() - window;
+  std::unordered_map<string, int64_t> weights;
+  {
+    MutexLock l(lock_);
+    for (const auto& bucket : buckets_) {
+      if (bucket.start < window_start) {
+        continue;
+      }
+      for (const auto& [stack, weight] : bucket.weights) {
+        weights[stack] += weight;
+      }
+    }
+  }
+  for (const auto& [stack, weight] : weights) {
+    *out << stack << " " << weight << "\n";
+  }
+}
+
+} // namespace server
+} // namespace kudu
@@ -0,0 +1,104 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/mutex.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class Thread;
+
+namespace server {
+
+// Continuously samples the stacks of the threads of the server, so that a
+// recent CPU profile is always available without having to start one.
+//
+// Every --continuous_profiler_interval_ms, the profiler reads the CPU time of
+// each of the threads of the process, and collects the stacks of those which
+// used CPU since the previous sample only, weighting each stack by the CPU
+// time the thread used. The stacks are prefixed with the tag the thread set
+// with ScopedProfilerTag, if any, so that the CPU time can be attributed to
+// tablets, RPC methods or maintenance ops.
+//
+// The samples of the last --continuous_profiler_window_sec are kept
+// aggregated in folded stacks, the input format of flamegraph.pl.
+class ContinuousProfiler {
+ public:
+  ContinuousProfiler();
+  ~ContinuousProfiler();
+
+  Status Start();
+  void Stop();
+
+  // Writes the samples of the last 'window' into 'out' as folded stacks, one
+  // "<tag>;<root frame>;...;<leaf frame> <CPU microseconds>" per line.
+  void WriteFoldedStacks(MonoDelta window, std::ostream* out) const;
+
+ private:
+  // The samples aggregated over one second.
+  struct Bucket {
+    MonoTime start;
+    std::unordered_map<std::string, int64_t> weights;
+  };
+
+  void RunThread();
+
+  // Samples the threads which used CPU since the previous call.
+  void TakeSamples();
+
+  // Returns the symbol of the frame at 'addr', caching it.
+  const std::string& Symbolize(void* addr);
+
+  // Adds 'weight_us' to the folded stack 'stack' in the current bucket,
+  // dropping the buckets out of the window.
+  void AddSample(const std::string& stack, int64_t weight_us);
+
+  CountDownLatch stop_latch_;
+  scoped_refptr<Thread> thread_;
+
+  // The CPU time in nanoseconds of each thread as of the previous sample.
+  // Accessed by the sampling thread only.
+  std::unordered_map<pid_t, int64_t> prev_cpu_ns_;
+
+  // The symbols of the frames sampled so far. Accessed by the sampling
+  // thread only.
+  std::unordered_map<void*, std::string> symbols_;
+
+  // Protects 'buckets_'.
+  mutable Mutex lock_;
+
+  // The buckets of the window, the most recent one last.
+  std::deque<Bucket> buckets_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContinuousProfiler);
+};
+
+} // namespace server
+} // namespace kudu
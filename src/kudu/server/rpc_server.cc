@@ -94,6 +94,15 @@ DEFINE_int32(rpc_num_service_threads, 10,
              "Number of RPC worker threads to run");
 TAG_FLAG(rpc_num_service_threads, advanced);
 
+DEFINE_int32(rpc_max_service_threads, 0,
+             "Maximum number of RPC worker threads of each service. If greater "
+             "than --rpc_num_service_threads, a service whose calls wait in its "
+             "queue with all its workers busy adds workers, up to this many, "
+             "which exit once idle again. See --rpc_service_pool_grow_queue_time_ms "
+             "and --rpc_service_pool_idle_thread_timeout_ms.");
+TAG_FLAG(rpc_max_service_threads, advanced);
+TAG_FLAG(rpc_max_service_threads, experimental);
+
 DEFINE_int32(rpc_service_queue_length, 50,
              "Default length of queue for incoming RPC requests");
 TAG_FLAG(rpc_service_queue_length, advanced);
@@ -135,6 +144,7 @@ RpcServerOptions::RpcServerOptions()
       rpc_proxy_advertised_addresses(FLAGS_rpc_proxy_advertised_addresses),
       num_acceptors_per_address(FLAGS_rpc_num_acceptors_per_address),
       num_service_threads(FLAGS_rpc_num_service_threads),
+      max_service_threads(FLAGS_rpc_max_service_threads),
       default_port(0),
       service_queue_length(FLAGS_rpc_service_queue_length),
       rpc_reuseport(FLAGS_rpc_reuseport) {
@@ -235,6 +245,7 @@ Status RpcServer::RegisterService(unique_ptr<rpc::ServiceIf> service) {
   scoped_refptr<rpc::ServicePool> service_pool =
     new rpc::ServicePool(std::move(service), messenger_->metric_entity(),
                          options_.service_queue_length);
+  service_pool->set_max_threads(options_.max_service_threads);
   RETURN_NOT_OK(service_pool->Init(options_.num_service_threads));
   auto* service_pool_raw_ptr = service_pool.get();
   service_pool->set_too_busy_hook([this, service_pool_raw_ptr]() {
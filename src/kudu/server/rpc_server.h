@@ -54,6 +54,7 @@ struct RpcServerOptions {
 
   uint32_t num_acceptors_per_address;
   uint32_t num_service_threads;
+  uint32_t max_service_threads;
   uint16_t default_port;
   size_t service_queue_length;
   bool rpc_reuseport;
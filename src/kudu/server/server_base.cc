@@ -56,6 +56,7 @@
 #include "kudu/rpc/service_pool.h"
 #include "kudu/security/init.h"
 #include "kudu/security/security_flags.h"
+#include "kudu/server/continuous_profiler.h"
 #include "kudu/server/default_path_handlers.h"
 #include "kudu/server/diagnostics_log.h"
 #include "kudu/server/generic_service.h"
@@ -303,6 +304,8 @@ TAG_FLAG(wall_clock_jump_threshold_sec, experimental);
 
 DECLARE_bool(use_hybrid_clock);
 DECLARE_int32(dns_resolver_max_threads_num);
+DECLARE_int32(continuous_profiler_interval_ms);
+DECLARE_int32(continuous_profiler_window_sec);
 DECLARE_uint32(dns_resolver_cache_capacity_mb);
 DECLARE_uint32(dns_resolver_cache_ttl_sec);
 DECLARE_int32(fs_data_dirs_available_space_cache_seconds);
@@ -1101,6 +1104,9 @@ void ServerBase::ShutdownImpl() {
   if (diag_log_) {
     diag_log_->Stop();
   }
+  if (profiler_) {
+    profiler_->Stop();
+  }
   if (excess_log_deleter_thread_) {
     excess_log_deleter_thread_->Join();
   }
@@ -1196,6 +1202,11 @@ Status ServerBase::Start() {
 
 
   RETURN_NOT_OK_PREPEND(StartMetricsLogging(), "Could not enable metrics logging");
+  if (FLAGS_continuous_profiler_interval_ms > 0) {
+    unique_ptr<ContinuousProfiler> profiler(new ContinuousProfiler());
+    RETURN_NOT_OK_PREPEND(profiler->Start(), "Could not start the continuous profiler");
+    profiler_ = std::move(profiler);
+  }
 
   result_tracker_->StartGCThread();
   RETURN_NOT_OK(StartExcessLogFileDeleterThread());
@@ -1212,6 +1223,20 @@ Status ServerBase::Start() {
     RegisterMetricsJsonHandler(web_server_.get(), metric_registry_.get());
     RegisterMetricsPrometheusHandler(web_server_.get(), metric_registry_.get());
     TracingPathHandlers::RegisterHandlers(web_server_.get());
+    web_server_->RegisterPrerenderedPathHandler(
+        "/pprof/continuous", "",
+        [this](const Webserver::WebRequest& req, Webserver::PrerenderedWebResponse* resp) {
+          if (!profiler_) {
+            resp->output << "The continuous profiler is disabled: "
+                         << "set --continuous_profiler_interval_ms to enable it.\n";
+            return;
+          }
+          const string secs_str = FindWithDefault(req.parsed_args, "seconds", "");
+          const int32_t seconds = ParseLeadingInt32Value(
+              secs_str.c_str(), FLAGS_continuous_profiler_window_sec);
+          profiler_->WriteFoldedStacks(MonoDelta::FromSeconds(seconds), &resp->output);
+        },
+        false, false);
     web_server_->set_footer_html(FooterHtml());
     web_server_->SetStartupComplete(true);
   }
@@ -69,6 +69,7 @@ class TokenVerifier;
 } // namespace security
 
 namespace server {
+class ContinuousProfiler;
 class DiagnosticsLog;
 class ServerStatusPB;
 class StartupPathHandler;
@@ -286,6 +287,7 @@ class ServerBase {
   ServerBaseOptions options_;
 
   std::unique_ptr<DiagnosticsLog> diag_log_;
+  std::unique_ptr<ContinuousProfiler> profiler_;
   scoped_refptr<Thread> excess_log_deleter_thread_;
 #ifdef TCMALLOC_ENABLED
   scoped_refptr<Thread> tcmalloc_memory_gc_thread_;
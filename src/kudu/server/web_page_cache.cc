@@ -0,0 +1,40 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/server/web_page_cache.h"
+
+#include <utility>
+
+namespace kudu {
+
+WebPageCache::WebPageCache(RenderFunc render)
+    : render_(std::move(render)) {
+}
+
+void WebPageCache::Get(const MonoDelta& max_age, EasyJson* output) {
+  std::lock_guard<std::mutex> l(lock_);
+  const MonoTime now = MonoTime::Now();
+  if (!render_time_.Initialized() || now - render_time_ > max_age) {
+    EasyJson page;
+    render_(&page);
+    page_ = std::move(page);
+    render_time_ = now;
+  }
+  output->CopyFrom(page_);
+}
+
+} // namespace kudu
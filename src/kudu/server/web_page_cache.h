@@ -0,0 +1,56 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <functional>
+#include <mutex>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/easy_json.h"
+#include "kudu/util/monotime.h"
+
+namespace kudu {
+
+// Caches the JSON output of an expensive web page, e.g. one iterating over
+// every tablet replica, so that frequent requests for it, like the scrapes of
+// a monitoring system, render it at most once per period. Cache hits only
+// copy the rendered JSON, without touching the state the page describes.
+//
+// This class is thread-safe.
+class WebPageCache {
+ public:
+  typedef std::function<void(EasyJson*)> RenderFunc;
+
+  explicit WebPageCache(RenderFunc render);
+
+  // Copies into 'output' the page rendered at most 'max_age' ago, rendering
+  // it anew first if needed. Concurrent requests for a stale page wait for
+  // a single rendering.
+  void Get(const MonoDelta& max_age, EasyJson* output);
+
+ private:
+  const RenderFunc render_;
+
+  // Protects the fields below, and serializes the renderings of the page.
+  std::mutex lock_;
+  EasyJson page_;
+  MonoTime render_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebPageCache);
+};
+
+} // namespace kudu
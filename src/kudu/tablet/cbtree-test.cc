@@ -88,6 +88,23 @@ class TestCBTree : public KuduTest {
   template<class Traits>
   void DoTestConcurrentInsert();
 
+  // Returns the number of entries of each leaf of 'tree', from left to right.
+  template<class Traits>
+  vector<int> LeafSizes(const CBTree<Traits>& tree) {
+    vector<int> sizes;
+    AtomicVersion version;
+    for (const LeafNode<Traits>* leaf = tree.TraverseToLeaf(Slice(""), &version);
+         leaf != nullptr;
+         leaf = leaf->next_) {
+      sizes.push_back(leaf->num_entries());
+    }
+    return sizes;
+  }
+
+  template<class Traits>
+  static int MaxLeafEntries() {
+    return LeafNode<Traits>::kMaxEntries;
+  }
 };
 
 // Ensure that the template magic to make the nodes sized
@@ -309,6 +326,39 @@ TEST_F(TestCBTree, TestInsertAndVerify) {
   }
 }
 
+// Keys inserted in increasing order should fill the leaves up rather than
+// leave them half empty.
+TEST_F(TestCBTree, TestSequentialInsertsFillLeaves) {
+  CBTree<SmallFanoutTraits> t;
+  char kbuf[64];
+  char vbuf[64];
+
+  const int n_keys = 1000;
+  for (int i = 0; i < n_keys; i++) {
+    snprintf(kbuf, sizeof(kbuf), "key_%08d", i);
+    snprintf(vbuf, sizeof(vbuf), "val_%d", i);
+    ASSERT_TRUE(t.Insert(Slice(kbuf), Slice(vbuf)));
+  }
+
+  const vector<int> sizes = LeafSizes(t);
+  const int max_entries = MaxLeafEntries<SmallFanoutTraits>();
+  ASSERT_EQ((n_keys + max_entries - 1) / max_entries, sizes.size());
+  for (size_t i = 0; i < sizes.size() - 1; i++) {
+    ASSERT_EQ(max_entries, sizes[i]) << "leaf " << i;
+  }
+
+  // Inserting in the middle of the full leaves still splits them.
+  snprintf(kbuf, sizeof(kbuf), "key_%08d_", 0);
+  ASSERT_TRUE(t.Insert(Slice(kbuf), Slice("val")));
+  ASSERT_EQ(sizes.size() + 1, LeafSizes(t).size());
+
+  for (int i = 0; i < n_keys; i++) {
+    snprintf(kbuf, sizeof(kbuf), "key_%08d", i);
+    snprintf(vbuf, sizeof(vbuf), "val_%d", i);
+    VerifyGet(t, Slice(kbuf), Slice(vbuf));
+  }
+}
+
 template<class TREE, class COLLECTION>
 static void InsertRandomKeys(TREE *t, int n_keys,
                              COLLECTION *inserted) {
@@ -63,11 +63,13 @@
 #include "kudu/util/test_util.h"
 
 DECLARE_int32(cfile_default_block_size);
+DECLARE_int32(cfile_set_parallel_seek_min_columns);
 
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::vector;
+using strings::Substitute;
 
 namespace kudu {
 namespace tablet {
@@ -365,7 +367,7 @@ TEST_F(TestCFileSet, TestPartiallyMaterialize) {
 
   shared_ptr<CFileSet> fileset;
   ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
-                           nullptr, &fileset));
+                           nullptr, nullptr, &fileset));
 
   unique_ptr<CFileSet::Iterator> iter(fileset->NewIterator(&schema_, nullptr));
   ASSERT_OK(iter->Init(nullptr));
@@ -446,7 +448,7 @@ TEST_F(TestCFileSet, TestIteratePartialSchema) {
 
   shared_ptr<CFileSet> fileset;
   ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
-                           nullptr, &fileset));
+                           nullptr, nullptr, &fileset));
 
   Schema new_schema;
   ASSERT_OK(schema_.CreateProjectionByNames({ "c0", "c2" }, &new_schema));
@@ -480,7 +482,7 @@ TEST_F(TestCFileSet, TestRangeScan) {
 
   shared_ptr<CFileSet> fileset;
   ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
-                           nullptr, &fileset));
+                           nullptr, nullptr, &fileset));
 
   // Create iterator.
   unique_ptr<CFileSet::Iterator> cfile_iter(fileset->NewIterator(&schema_, nullptr));
@@ -526,6 +528,36 @@ TEST_F(TestCFileSet, TestRangeScan) {
   EXPECT_EQ(1, stats[2].blocks_read);
 }
 
+// Test that point lookups return the same rows when their columns are seeked
+// in parallel.
+TEST_F(TestCFileSet, TestParallelSeek) {
+  const int kNumRows = 10000;
+  WriteTestRowSet(kNumRows);
+  FLAGS_cfile_set_parallel_seek_min_columns = 2;
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
+                           nullptr, nullptr, &fileset));
+  for (int32_t key : { 0, 4242, 2 * (kNumRows - 1) }) {
+    SCOPED_TRACE(key);
+    unique_ptr<CFileSet::Iterator> cfile_iter(fileset->NewIterator(&schema_, nullptr));
+    unique_ptr<RowwiseIterator> iter(NewMaterializingIterator(std::move(cfile_iter)));
+    Arena arena(1024);
+    ScanSpec spec;
+    auto pred = ColumnPredicate::Equality(schema_.column(0), &key);
+    spec.AddPredicate(pred);
+    spec.OptimizeScan(schema_, &arena, true);
+    ASSERT_OK(iter->Init(&spec));
+
+    vector<string> results;
+    ASSERT_OK(IterateToStringList(iter.get(), &results));
+    ASSERT_EQ(1, results.size());
+    const int idx = key / kRatio[0];
+    EXPECT_EQ(Substitute("(int32 c0=$0, int32 c1=$1, int32 c2=$2)",
+                         key, idx * kRatio[1], idx * kRatio[2]), results[0]);
+  }
+}
+
 // Several other black-box tests for range scans. These are similar to
 // TestRangeScan above, except don't inspect internal state.
 TEST_F(TestCFileSet, TestRangePredicates2) {
@@ -534,7 +566,7 @@ TEST_F(TestCFileSet, TestRangePredicates2) {
 
   shared_ptr<CFileSet> fileset;
   ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
-                           nullptr, &fileset));
+                           nullptr, nullptr, &fileset));
 
   // Range scan where rows match on both ends
   DoTestRangeScan(fileset, 2000, 2010);
@@ -595,7 +627,7 @@ TEST_F(TestCFileSet, TestBloomFilterPredicates) {
 
   shared_ptr<CFileSet> fileset;
   ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
-                           nullptr, &fileset));
+                           nullptr, nullptr, &fileset));
 
 
   // BloomFilter of column 0 contain.
@@ -644,7 +676,8 @@ TEST_F(TestCFileSet, TestInListPredicates) {
 
   shared_ptr<CFileSet> fileset;
   ASSERT_OK(CFileSet::Open(
-      rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(), nullptr, &fileset));
+      rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(), nullptr, nullptr,
+      &fileset));
 
   // Test different size and interval.
   DoTestInListScan(fileset, 1, 1);
@@ -660,7 +693,8 @@ TEST_F(TestCFileSet, TestKUDU3384) {
 
   shared_ptr<CFileSet> fileset;
   ASSERT_OK(CFileSet::Open(
-      rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(), nullptr, &fileset));
+      rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(), nullptr, nullptr,
+      &fileset));
 
   // Create iterator.
   unique_ptr<CFileSet::Iterator> cfile_iter(fileset->NewIterator(&schema_, nullptr));
@@ -725,6 +759,7 @@ class InListPredicateBenchmark : public KuduRowSetTest {
                              MemTracker::GetRootTracker(),
                              MemTracker::GetRootTracker(),
                              nullptr,
+                             nullptr,
                              &fileset));
     Stopwatch sw;
     sw.start();
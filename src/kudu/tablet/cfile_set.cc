@@ -17,7 +17,9 @@
 #include "kudu/tablet/cfile_set.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -35,10 +37,13 @@
 #include "kudu/common/columnblock.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/iterator_stats.h"
+#include "kudu/common/key_encoder.h"
 #include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
 #include "kudu/common/rowid.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/types.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
@@ -51,16 +56,54 @@
 #include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"
+#include "kudu/util/block_bloom_filter.h"
+#include "kudu/util/bloom_filter.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/mem_tracker.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
+#include "kudu/util/threadpool.h"
+#include "kudu/util/trace.h"
 
 DEFINE_bool(consult_bloom_filters, true, "Whether to consult bloom filters on row presence checks");
 TAG_FLAG(consult_bloom_filters, hidden);
 
+DEFINE_int64(rowset_split_key_sample_bytes, 1024 * 1024,
+             "The number of bytes of base data per key sampled from a rowset to "
+             "compute the split points of its key range, e.g. for scan tokens. "
+             "Fewer bytes per key make the split points more accurate, at the cost "
+             "of reading and keeping more keys.");
+TAG_FLAG(rowset_split_key_sample_bytes, advanced);
+TAG_FLAG(rowset_split_key_sample_bytes, experimental);
+
+DEFINE_int32(rowset_split_key_max_samples, 1024,
+             "The maximum number of keys sampled from a rowset to compute the split "
+             "points of its key range. See --rowset_split_key_sample_bytes.");
+TAG_FLAG(rowset_split_key_max_samples, advanced);
+TAG_FLAG(rowset_split_key_max_samples, experimental);
+
+DEFINE_int32(cfile_set_parallel_seek_min_columns, 0,
+             "The minimum number of projected columns above which a point lookup "
+             "in a rowset, i.e. an iteration over at most a few rows, seeks the "
+             "iterators of its columns in parallel rather than one after "
+             "another, so that the reads of wide rows which aren't in the block "
+             "cache wait for the disks concurrently. If 0, the columns are "
+             "always seeked one after another.");
+TAG_FLAG(cfile_set_parallel_seek_min_columns, advanced);
+TAG_FLAG(cfile_set_parallel_seek_min_columns, experimental);
+TAG_FLAG(cfile_set_parallel_seek_min_columns, runtime);
+
+DEFINE_int32(cfile_set_parallel_seek_threads, 16,
+             "The maximum number of threads seeking the columns of point "
+             "lookups in parallel. See --cfile_set_parallel_seek_min_columns.");
+TAG_FLAG(cfile_set_parallel_seek_threads, advanced);
+TAG_FLAG(cfile_set_parallel_seek_threads, experimental);
+
 DECLARE_bool(rowset_metadata_store_keys);
 
+using kudu::cfile::BlockCacheAttribution;
 using kudu::cfile::BloomFileReader;
 using kudu::cfile::CFileIterator;
 using kudu::cfile::CFileReader;
@@ -88,6 +131,7 @@ namespace tablet {
 
 static Status OpenReader(FsManager* fs,
                          shared_ptr<MemTracker> cfile_reader_tracker,
+                         scoped_refptr<BlockCacheAttribution> block_cache_attribution,
                          const BlockId& block_id,
                          const IOContext* io_context,
                          unique_ptr<CFileReader>* new_reader) {
@@ -96,6 +140,7 @@ static Status OpenReader(FsManager* fs,
 
   ReaderOptions opts;
   opts.parent_mem_tracker = std::move(cfile_reader_tracker);
+  opts.block_cache_attribution = std::move(block_cache_attribution);
   opts.io_context = io_context;
   return CFileReader::OpenNoInit(std::move(block),
                                  std::move(opts),
@@ -108,24 +153,31 @@ static Status OpenReader(FsManager* fs,
 
 CFileSet::CFileSet(shared_ptr<RowSetMetadata> rowset_metadata,
                    shared_ptr<MemTracker> bloomfile_tracker,
-                   shared_ptr<MemTracker> cfile_reader_tracker)
+                   shared_ptr<MemTracker> cfile_reader_tracker,
+                   scoped_refptr<BlockCacheAttribution> block_cache_attribution)
     : rowset_metadata_(std::move(rowset_metadata)),
       bloomfile_tracker_(std::move(bloomfile_tracker)),
-      cfile_reader_tracker_(std::move(cfile_reader_tracker)) {
+      cfile_reader_tracker_(std::move(cfile_reader_tracker)),
+      block_cache_attribution_(std::move(block_cache_attribution)) {
 }
 
 CFileSet::~CFileSet() {
+  if (key_filter_ && bloomfile_tracker_) {
+    bloomfile_tracker_->Release(key_filter_->GetSpaceUsed());
+  }
 }
 
 Status CFileSet::Open(shared_ptr<RowSetMetadata> rowset_metadata,
                       shared_ptr<MemTracker> bloomfile_tracker,
                       shared_ptr<MemTracker> cfile_reader_tracker,
+                      scoped_refptr<BlockCacheAttribution> block_cache_attribution,
                       const IOContext* io_context,
                       shared_ptr<CFileSet>* cfile_set) {
   auto cfs(CFileSet::make_shared(
       std::move(rowset_metadata),
       std::move(bloomfile_tracker),
-      std::move(cfile_reader_tracker)));
+      std::move(cfile_reader_tracker),
+      std::move(block_cache_attribution)));
   RETURN_NOT_OK(cfs->DoOpen(io_context));
 
   cfile_set->swap(cfs);
@@ -134,6 +186,10 @@ Status CFileSet::Open(shared_ptr<RowSetMetadata> rowset_metadata,
 
 Status CFileSet::DoOpen(const IOContext* io_context) {
   RETURN_NOT_OK(OpenBloomReader(io_context));
+  key_filter_ = rowset_metadata_->key_filter();
+  if (key_filter_ && bloomfile_tracker_) {
+    bloomfile_tracker_->Consume(key_filter_->GetSpaceUsed());
+  }
 
   // Lazily open the column data cfiles. Each one will be fully opened
   // later, when the first iterator seeks for the first time.
@@ -145,6 +201,7 @@ Status CFileSet::DoOpen(const IOContext* io_context) {
     unique_ptr<CFileReader> reader;
     RETURN_NOT_OK(OpenReader(rowset_metadata_->fs_manager(),
                              cfile_reader_tracker_,
+                             block_cache_attribution_,
                              rowset_metadata_->column_data_block_for_col_id(col_id),
                              io_context,
                              &reader));
@@ -157,6 +214,7 @@ Status CFileSet::DoOpen(const IOContext* io_context) {
   if (rowset_metadata_->has_adhoc_index_block()) {
     RETURN_NOT_OK(OpenReader(rowset_metadata_->fs_manager(),
                              cfile_reader_tracker_,
+                             block_cache_attribution_,
                              rowset_metadata_->adhoc_index_block(),
                              io_context,
                              &ad_hoc_idx_reader_));
@@ -196,6 +254,7 @@ Status CFileSet::OpenBloomReader(const IOContext* io_context) {
   ReaderOptions opts;
   opts.io_context = io_context;
   opts.parent_mem_tracker = bloomfile_tracker_;
+  opts.block_cache_attribution = block_cache_attribution_;
   Status s = BloomFileReader::OpenNoInit(std::move(block),
                                          std::move(opts),
                                          &bloom_reader_);
@@ -258,6 +317,69 @@ Status CFileSet::GetBounds(string* min_encoded_key,
   return Status::OK();
 }
 
+Status CFileSet::GetKeySamples(const IOContext* io_context,
+                               shared_ptr<const vector<string>>* keys) const {
+  {
+    std::lock_guard<simple_spinlock> l(key_samples_lock_);
+    if (key_samples_) {
+      *keys = key_samples_;
+      return Status::OK();
+    }
+  }
+
+  rowid_t count;
+  RETURN_NOT_OK(CountRows(io_context, &count));
+  auto samples = std::make_shared<vector<string>>();
+  if (count > 0) {
+    const int64_t sample_bytes = std::max<int64_t>(1, FLAGS_rowset_split_key_sample_bytes);
+    const int64_t max_samples = std::max<int64_t>(2, FLAGS_rowset_split_key_max_samples);
+    const int64_t num_samples = std::min<int64_t>(
+        std::min<int64_t>(count, max_samples),
+        std::max<int64_t>(2, OnDiskDataSize() / sample_bytes + 1));
+
+    // Without an ad-hoc index, the key index is the cfile of the only key
+    // column, whose values must be encoded.
+    unique_ptr<CFileIterator> key_iter;
+    RETURN_NOT_OK(NewKeyIterator(io_context, &key_iter));
+    const TypeInfo* type = key_index_reader()->type_info();
+    const KeyEncoder<faststring>* encoder = ad_hoc_idx_reader_ ?
+        nullptr : &GetKeyEncoder<faststring>(type);
+    RowBlockMemory mem;
+    uint8_t cell[kLargestTypeSize];
+    ColumnBlock cb(type, nullptr, cell, 1, &mem);
+    SelectionVector sel(1);
+    ColumnMaterializationContext ctx(0, nullptr, &cb, &sel);
+    faststring buf;
+    samples->reserve(num_samples);
+    for (int64_t i = 0; i < num_samples; i++) {
+      const rowid_t ordinal = num_samples == 1 ?
+          0 : static_cast<rowid_t>(i * (count - 1) / (num_samples - 1));
+      RETURN_NOT_OK(key_iter->SeekToOrdinal(ordinal));
+      size_t n = 1;
+      RETURN_NOT_OK(key_iter->CopyNextValues(&n, &ctx));
+      if (PREDICT_FALSE(n != 1)) {
+        return Status::Corruption(Substitute("could not read key at ordinal $0", ordinal),
+                                  ToString());
+      }
+      if (encoder) {
+        buf.clear();
+        encoder->Encode(cell, /*is_last=*/true, &buf);
+        samples->emplace_back(buf.ToString());
+      } else {
+        samples->emplace_back(reinterpret_cast<const Slice*>(cell)->ToString());
+      }
+      mem.Reset();
+    }
+  }
+
+  std::lock_guard<simple_spinlock> l(key_samples_lock_);
+  if (!key_samples_) {
+    key_samples_ = std::move(samples);
+  }
+  *keys = key_samples_;
+  return Status::OK();
+}
+
 uint64_t CFileSet::AdhocIndexOnDiskSize() const {
   if (ad_hoc_idx_reader_) {
     return ad_hoc_idx_reader_->file_size();
@@ -281,39 +403,46 @@ uint64_t CFileSet::OnDiskColumnDataSize(const ColumnId& col_id) const {
   return FindOrDie(readers_by_col_id_, col_id)->file_size();
 }
 
-Status CFileSet::FindRow(const RowSetKeyProbe &probe,
-                         const IOContext* io_context,
-                         optional<rowid_t>* idx,
-                         ProbeStats* stats) const {
-  if (FLAGS_consult_bloom_filters) {
-    // Fully open the BloomFileReader if it was lazily opened earlier.
-    //
-    // If it's already initialized, this is a no-op.
-    RETURN_NOT_OK(bloom_reader_->Init(io_context));
-
+Status CFileSet::MayContainKey(const RowSetKeyProbe& probe,
+                               const IOContext* io_context,
+                               bool* maybe_present,
+                               ProbeStats* stats) const {
+  *maybe_present = true;
+  if (!FLAGS_consult_bloom_filters) {
+    return Status::OK();
+  }
+  if (key_filter_) {
     stats->blooms_consulted++;
-    bool present;
-    Status s = bloom_reader_->CheckKeyPresent(probe.bloom_probe(), io_context, &present);
-    if (s.ok() && !present) {
-      idx->reset();
-      return Status::OK();
-    }
-    if (!s.ok()) {
-      KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("Unable to query bloom in $0: $1",
-          rowset_metadata_->bloom_block().ToString(), s.ToString());
-      if (PREDICT_FALSE(s.IsDiskFailure())) {
-        // If the bloom lookup failed because of a disk failure, return early
-        // since I/O to the tablet should be stopped.
-        return s;
-      }
-      // Continue with the slow path
-    }
+    *maybe_present = key_filter_->Find(probe.bloom_probe().initial_hash());
+    return Status::OK();
   }
 
-  stats->keys_consulted++;
-  unique_ptr<CFileIterator> key_iter;
-  RETURN_NOT_OK(NewKeyIterator(io_context, &key_iter));
+  // Fully open the BloomFileReader if it was lazily opened earlier.
+  //
+  // If it's already initialized, this is a no-op.
+  RETURN_NOT_OK(bloom_reader_->Init(io_context));
 
+  stats->blooms_consulted++;
+  bool present;
+  Status s = bloom_reader_->CheckKeyPresent(probe.bloom_probe(), io_context, &present);
+  if (s.ok()) {
+    *maybe_present = present;
+    return Status::OK();
+  }
+  KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("Unable to query bloom in $0: $1",
+      rowset_metadata_->bloom_block().ToString(), s.ToString());
+  if (PREDICT_FALSE(s.IsDiskFailure())) {
+    // If the bloom lookup failed because of a disk failure, return early
+    // since I/O to the tablet should be stopped.
+    return s;
+  }
+  // Continue with the slow path
+  return Status::OK();
+}
+
+Status CFileSet::SeekToKey(CFileIterator* key_iter,
+                           const RowSetKeyProbe& probe,
+                           optional<rowid_t>* idx) {
   bool exact;
   Status s = key_iter->SeekAtOrAfter(probe.encoded_key(), &exact);
   if (s.IsNotFound() || (s.ok() && !exact)) {
@@ -326,6 +455,56 @@ Status CFileSet::FindRow(const RowSetKeyProbe &probe,
   return Status::OK();
 }
 
+Status CFileSet::FindRow(const RowSetKeyProbe &probe,
+                         const IOContext* io_context,
+                         optional<rowid_t>* idx,
+                         ProbeStats* stats) const {
+  bool maybe_present;
+  RETURN_NOT_OK(MayContainKey(probe, io_context, &maybe_present, stats));
+  if (!maybe_present) {
+    idx->reset();
+    return Status::OK();
+  }
+
+  stats->keys_consulted++;
+  unique_ptr<CFileIterator> key_iter;
+  RETURN_NOT_OK(NewKeyIterator(io_context, &key_iter));
+  return SeekToKey(key_iter.get(), probe, idx);
+}
+
+Status CFileSet::FindRows(const vector<const RowSetKeyProbe*>& probes,
+                          const IOContext* io_context,
+                          vector<optional<rowid_t>>* idxs,
+                          const vector<ProbeStats*>& stats) const {
+  DCHECK_EQ(probes.size(), stats.size());
+  idxs->assign(probes.size(), std::nullopt);
+
+  // Run all of the keys through the bloom filter first, so the filter's
+  // blocks stay hot instead of alternating with the key index's.
+  vector<size_t> candidates;
+  candidates.reserve(probes.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    bool maybe_present;
+    RETURN_NOT_OK(MayContainKey(*probes[i], io_context, &maybe_present, stats[i]));
+    if (maybe_present) {
+      candidates.push_back(i);
+    }
+  }
+  if (candidates.empty()) {
+    return Status::OK();
+  }
+
+  // The keys are sorted, so a single iterator seeks forward through the key
+  // index, mostly within blocks the previous seek already loaded.
+  unique_ptr<CFileIterator> key_iter;
+  RETURN_NOT_OK(NewKeyIterator(io_context, &key_iter));
+  for (size_t i : candidates) {
+    stats[i]->keys_consulted++;
+    RETURN_NOT_OK(SeekToKey(key_iter.get(), *probes[i], &(*idxs)[i]));
+  }
+  return Status::OK();
+}
+
 Status CFileSet::CheckRowPresent(const RowSetKeyProbe& probe, const IOContext* io_context,
                                  bool* present, rowid_t* rowid, ProbeStats* stats) const {
   optional<rowid_t> opt_rowid;
@@ -519,6 +698,65 @@ Status CFileSet::Iterator::PushdownRangeScanPredicate(ScanSpec* spec) {
   return Status::OK();
 }
 
+namespace {
+
+// The maximum number of rows of an iteration considered a point lookup. See
+// --cfile_set_parallel_seek_min_columns.
+constexpr rowid_t kPointLookupMaxRows = 16;
+
+ThreadPool* ParallelSeekPool() {
+  static ThreadPool* pool = []() {
+    unique_ptr<ThreadPool> pool;
+    CHECK_OK(ThreadPoolBuilder("cfile-set-seek")
+             .set_min_threads(0)
+             .set_max_threads(std::max(1, FLAGS_cfile_set_parallel_seek_threads))
+             .Build(&pool));
+    ANNOTATE_LEAKING_OBJECT_PTR(pool.get());
+    return pool.release();
+  }();
+  return pool;
+}
+
+} // anonymous namespace
+
+Status CFileSet::Iterator::SeekColumnsInParallel() {
+  vector<ColumnIterator*> to_seek;
+  for (const auto& col_iter : col_iters_) {
+    if (!col_iter->seeked() || col_iter->GetCurrentOrdinal() != cur_idx_) {
+      to_seek.emplace_back(col_iter.get());
+    }
+  }
+  if (to_seek.size() < 2) {
+    return Status::OK();
+  }
+
+  // The first column is seeked on this thread while the others are seeked on
+  // the pool.
+  vector<Status> statuses(to_seek.size());
+  unique_ptr<ThreadPoolToken> token =
+      ParallelSeekPool()->NewToken(ThreadPool::ExecutionMode::CONCURRENT);
+  Trace* trace = Trace::CurrentTrace();
+  const rowid_t ord_idx = cur_idx_;
+  for (int i = 1; i < to_seek.size(); i++) {
+    ColumnIterator* col_iter = to_seek[i];
+    Status* s = &statuses[i];
+    Status submit_s = token->Submit([trace, col_iter, ord_idx, s]() {
+      ADOPT_TRACE(trace);
+      *s = col_iter->SeekToOrdinal(ord_idx);
+    });
+    if (PREDICT_FALSE(!submit_s.ok())) {
+      // Leave the column to PrepareColumn(), which seeks it when needed.
+      break;
+    }
+  }
+  statuses[0] = to_seek[0]->SeekToOrdinal(ord_idx);
+  token->Wait();
+  for (const auto& s : statuses) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
 void CFileSet::Iterator::Unprepare() {
   prepared_count_ = 0;
   prepared_iters_.clear();
@@ -534,6 +772,14 @@ Status CFileSet::Iterator::PrepareBatch(size_t *nrows) {
 
   prepared_count_ = *nrows;
 
+  // Point lookups of wide rows would otherwise wait for the reads of their
+  // columns one after another.
+  const int min_columns = FLAGS_cfile_set_parallel_seek_min_columns;
+  if (min_columns > 0 && col_iters_.size() >= min_columns && prepared_count_ > 0 &&
+      upper_bound_idx_ - lower_bound_idx_ <= kPointLookupMaxRows) {
+    RETURN_NOT_OK(SeekColumnsInParallel());
+  }
+
   // Lazily prepare the first column when it is materialized.
   return Status::OK();
 }
@@ -578,9 +824,23 @@ Status CFileSet::Iterator::InitializeSelectionVector(SelectionVector *sel_vec) {
 Status CFileSet::Iterator::MaterializeColumn(ColumnMaterializationContext *ctx) {
   CHECK_EQ(prepared_count_, ctx->block()->nrows());
   DCHECK_LT(ctx->col_idx(), col_iters_.size());
+  ColumnIterator* iter = col_iters_[ctx->col_idx()].get();
+
+  // If the column's zone map shows that no row in the batch can match the
+  // predicate, filter the whole batch without reading the column. This is
+  // only valid if the predicate is evaluated against the base data, i.e. if
+  // decoder-level evaluation hasn't been ruled out because of deltas.
+  if (ctx->DecoderEvalNotDisabled()) {
+    bool can_skip;
+    RETURN_NOT_OK(iter->CanSkipRows(*ctx->pred(), cur_idx_, prepared_count_, &can_skip));
+    if (can_skip) {
+      ctx->sel()->SetAllFalse();
+      ctx->SetDecoderEvalSupported();
+      return Status::OK();
+    }
+  }
 
   RETURN_NOT_OK(PrepareColumn(ctx));
-  ColumnIterator* iter = col_iters_[ctx->col_idx()].get();
 
   RETURN_NOT_OK(iter->Scan(ctx));
 
@@ -37,13 +37,16 @@
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/tablet/rowset_metadata.h" // IWYU pragma: keep
+#include "kudu/util/locks.h"
 #include "kudu/util/make_shared.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
 
+class BlockBloomFilter;
 class ColumnMaterializationContext;
 class MemTracker;
 class ScanSpec;
@@ -51,6 +54,7 @@ class SelectionVector;
 struct IteratorStats;
 
 namespace cfile {
+class BlockCacheAttribution;
 class BloomFileReader;
 }  // namespace cfile
 
@@ -77,9 +81,13 @@ class CFileSet :
  public:
   class Iterator;
 
+  //
+  // The use of the block cache by the files is attributed to
+  // 'block_cache_attribution', unless null.
   static Status Open(std::shared_ptr<RowSetMetadata> rowset_metadata,
                      std::shared_ptr<MemTracker> bloomfile_tracker,
                      std::shared_ptr<MemTracker> cfile_reader_tracker,
+                     scoped_refptr<cfile::BlockCacheAttribution> block_cache_attribution,
                      const fs::IOContext* io_context,
                      std::shared_ptr<CFileSet>* cfile_set);
 
@@ -94,6 +102,11 @@ class CFileSet :
   Status GetBounds(std::string* min_encoded_key,
                    std::string* max_encoded_key) const;
 
+  // See RowSet::GetKeySamples. The samples are read from the key index once,
+  // and kept from then on.
+  Status GetKeySamples(const fs::IOContext* io_context,
+                       std::shared_ptr<const std::vector<std::string>>* keys) const;
+
   // The on-disk size, in bytes, of this cfile set's ad hoc index.
   // Returns 0 if there is no ad hoc index.
   uint64_t AdhocIndexOnDiskSize() const;
@@ -116,6 +129,14 @@ class CFileSet :
                  std::optional<rowid_t>* idx,
                  ProbeStats* stats) const;
 
+  // Like FindRow(), for each of 'probes', which must be sorted by increasing
+  // key. Sets the i-th entry of 'idxs' for the i-th probe, accounting its
+  // work in 'stats[i]'.
+  Status FindRows(const std::vector<const RowSetKeyProbe*>& probes,
+                  const fs::IOContext* io_context,
+                  std::vector<std::optional<rowid_t>>* idxs,
+                  const std::vector<ProbeStats*>& stats) const;
+
   std::string ToString() const {
     return std::string("CFile base data in ") + rowset_metadata_->ToString();
   }
@@ -135,7 +156,8 @@ class CFileSet :
  protected:
   CFileSet(std::shared_ptr<RowSetMetadata> rowset_metadata,
            std::shared_ptr<MemTracker> bloomfile_tracker,
-           std::shared_ptr<MemTracker> cfile_reader_tracker);
+           std::shared_ptr<MemTracker> cfile_reader_tracker,
+           scoped_refptr<cfile::BlockCacheAttribution> block_cache_attribution);
 
  private:
   friend class Iterator;
@@ -145,6 +167,19 @@ class CFileSet :
 
   Status DoOpen(const fs::IOContext* io_context);
   Status OpenBloomReader(const fs::IOContext* io_context);
+
+  // Sets 'maybe_present' to false if the bloom filter of the rowset rules out
+  // the key of 'probe'.
+  Status MayContainKey(const RowSetKeyProbe& probe,
+                       const fs::IOContext* io_context,
+                       bool* maybe_present,
+                       ProbeStats* stats) const;
+
+  // Seeks 'key_iter' to the key of 'probe', setting 'idx' to its ordinal if
+  // it's present.
+  static Status SeekToKey(cfile::CFileIterator* key_iter,
+                          const RowSetKeyProbe& probe,
+                          std::optional<rowid_t>* idx);
   Status LoadMinMaxKeys(const fs::IOContext* io_context);
 
   Status NewColumnIterator(ColumnId col_id,
@@ -163,6 +198,7 @@ class CFileSet :
   std::shared_ptr<RowSetMetadata> rowset_metadata_;
   std::shared_ptr<MemTracker> bloomfile_tracker_;
   std::shared_ptr<MemTracker> cfile_reader_tracker_;
+  scoped_refptr<cfile::BlockCacheAttribution> block_cache_attribution_;
 
   std::string min_encoded_key_;
   std::string max_encoded_key_;
@@ -178,6 +214,14 @@ class CFileSet :
   // index pertains to more than one column, as in the case of composite keys.
   std::unique_ptr<cfile::CFileReader> ad_hoc_idx_reader_;
   std::unique_ptr<cfile::BloomFileReader> bloom_reader_;
+
+  // The in-memory filter of the keys, consulted instead of the bloom file if
+  // the rowset has one. Its memory is accounted to 'bloomfile_tracker_'.
+  std::shared_ptr<const BlockBloomFilter> key_filter_;
+
+  // The samples returned by GetKeySamples(), once read.
+  mutable simple_spinlock key_samples_lock_;
+  mutable std::shared_ptr<const std::vector<std::string>> key_samples_;
 };
 
 
@@ -226,6 +270,7 @@ class CFileSet::Iterator : public ColumnwiseIterator {
  private:
   DISALLOW_COPY_AND_ASSIGN(Iterator);
   FRIEND_TEST(TestCFileSet, TestRangeScan);
+  FRIEND_TEST(TestCFileSet, TestParallelSeek);
   friend class CFileSet;
 
   // 'projection' must remain valid for the lifetime of this object.
@@ -250,6 +295,10 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   // store it in member fields.
   Status PushdownRangeScanPredicate(ScanSpec *spec);
 
+  // Seeks the iterators of the columns which aren't positioned at the current
+  // row yet, in parallel. See --cfile_set_parallel_seek_min_columns.
+  Status SeekColumnsInParallel();
+
   void Unprepare();
 
   // Prepare the given column. The column must not have been prepared yet.
@@ -0,0 +1,99 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tablet/change_subscriptions.h"
+
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/flag_tags.h"
+
+DEFINE_int32(tablet_change_subscription_ttl_ms, 60 * 60 * 1000,
+             "Time in milliseconds after which a subscription to the changes of "
+             "a tablet replica expires if its consumer didn't read changes, "
+             "letting log GC remove the ops it didn't read yet.");
+TAG_FLAG(tablet_change_subscription_ttl_ms, advanced);
+TAG_FLAG(tablet_change_subscription_ttl_ms, runtime);
+
+using std::string;
+using strings::Substitute;
+
+namespace kudu {
+namespace tablet {
+
+ChangeSubscriptions::ChangeSubscriptions(
+    scoped_refptr<log::LogAnchorRegistry> log_anchor_registry)
+    : log_anchor_registry_(std::move(log_anchor_registry)) {
+}
+
+ChangeSubscriptions::~ChangeSubscriptions() {
+  for (auto& entry : subscriptions_) {
+    WARN_NOT_OK(log_anchor_registry_->Unregister(&entry.second->anchor),
+                "unable to unregister the log anchor of a change subscription");
+  }
+}
+
+Status ChangeSubscriptions::Checkpoint(const string& id, int64_t op_index) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  auto& subscription = subscriptions_[id];
+  if (!subscription) {
+    subscription.reset(new Subscription);
+  }
+  subscription->last_checkpoint_time = MonoTime::Now();
+  return log_anchor_registry_->RegisterOrUpdate(
+      op_index + 1, Substitute("change subscription $0", id), &subscription->anchor);
+}
+
+Status ChangeSubscriptions::Remove(const string& id) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  auto it = subscriptions_.find(id);
+  if (it == subscriptions_.end()) {
+    return Status::OK();
+  }
+  Status s = log_anchor_registry_->UnregisterIfAnchored(&it->second->anchor);
+  subscriptions_.erase(it);
+  return s;
+}
+
+void ChangeSubscriptions::RemoveExpired() {
+  const MonoTime expired_before =
+      MonoTime::Now() - MonoDelta::FromMilliseconds(FLAGS_tablet_change_subscription_ttl_ms);
+  std::lock_guard<simple_spinlock> l(lock_);
+  for (auto it = subscriptions_.begin(); it != subscriptions_.end();) {
+    if (it->second->last_checkpoint_time < expired_before) {
+      LOG(INFO) << Substitute("change subscription $0 expired", it->first);
+      WARN_NOT_OK(log_anchor_registry_->UnregisterIfAnchored(&it->second->anchor),
+                  "unable to unregister the log anchor of a change subscription");
+      it = subscriptions_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t ChangeSubscriptions::size() const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return subscriptions_.size();
+}
+
+} // namespace tablet
+} // namespace kudu
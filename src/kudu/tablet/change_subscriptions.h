@@ -0,0 +1,85 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "kudu/consensus/log_anchor_registry.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace tablet {
+
+// The subscriptions of the consumers of the changes of a tablet replica, as
+// streamed from its WAL. Each subscription anchors the WAL from the op
+// following its checkpoint on, so that log GC doesn't remove the ops its
+// consumer has yet to read. Subscriptions which aren't checkpointed for
+// --tablet_change_subscription_ttl_ms expire, so that consumers which went
+// away don't retain the WAL forever.
+//
+// The subscriptions aren't replicated: only the replica the consumer reads
+// from, i.e. the leader, anchors its WAL. Once another replica becomes the
+// leader, it may have garbage collected the ops following the checkpoint of
+// the consumer. Reading them then fails with a NotFound status, and the
+// consumer has to recover from the first op the new leader retains: it
+// checkpoints right before that op, which anchors the WAL from there on, then
+// reads a snapshot of the tablet at a timestamp past the last change it
+// applied, and skips the changes at timestamps up to the one of the snapshot.
+//
+// This class is thread-safe.
+class ChangeSubscriptions {
+ public:
+  explicit ChangeSubscriptions(scoped_refptr<log::LogAnchorRegistry> log_anchor_registry);
+  ~ChangeSubscriptions();
+
+  // Registers the subscription 'id' if needed, and sets its checkpoint to
+  // 'op_index': the ops following it are retained.
+  Status Checkpoint(const std::string& id, int64_t op_index);
+
+  // Removes the subscription 'id', if registered.
+  Status Remove(const std::string& id);
+
+  // Removes the subscriptions which expired.
+  void RemoveExpired();
+
+  // Returns the number of registered subscriptions.
+  size_t size() const;
+
+ private:
+  struct Subscription {
+    log::LogAnchor anchor;
+    MonoTime last_checkpoint_time;
+  };
+
+  const scoped_refptr<log::LogAnchorRegistry> log_anchor_registry_;
+
+  mutable simple_spinlock lock_;
+  std::unordered_map<std::string, std::unique_ptr<Subscription>> subscriptions_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChangeSubscriptions);
+};
+
+} // namespace tablet
+} // namespace kudu
@@ -0,0 +1,156 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tablet/column_stats.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <google/protobuf/repeated_field.h> // IWYU pragma: keep
+#include <gtest/gtest.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/schema.h"
+#include "kudu/tablet/metadata.pb.h"
+#include "kudu/util/hyperloglog.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+namespace kudu {
+namespace tablet {
+
+class ColumnStatsTest : public ::testing::Test {
+ public:
+  ColumnStatsTest() {
+    SchemaBuilder builder;
+    CHECK_OK(builder.AddKeyColumn("key", INT32));
+    CHECK_OK(builder.AddNullableColumn("val", STRING));
+    schema_ = builder.Build();
+  }
+
+ protected:
+  // Returns the statistics of the rows with the keys in [start, end), whose
+  // values are null for every other key and otherwise cycle through
+  // 'num_values' values.
+  vector<ColumnStatsPB> CollectStats(int32_t start, int32_t end, int num_values) {
+    RowBlockMemory mem;
+    RowBlock block(&schema_, end - start, &mem);
+    vector<string> values;
+    for (int32_t key = start; key < end; ++key) {
+      values.emplace_back(std::to_string(key % num_values));
+    }
+    ColumnBlock keys = block.column_block(0);
+    ColumnBlock vals = block.column_block(1);
+    for (int32_t i = 0; i < end - start; ++i) {
+      const int32_t key = start + i;
+      keys.SetCellValue(i, &key);
+      const bool is_null = key % 2 == 0;
+      vals.SetCellIsNull(i, is_null);
+      if (!is_null) {
+        Slice value(values[i]);
+        vals.SetCellValue(i, &value);
+      }
+    }
+    ColumnStatsCollector collector(&schema_);
+    collector.AddBlock(block);
+    return collector.GetStats();
+  }
+
+  Schema schema_;
+};
+
+TEST_F(ColumnStatsTest, CollectAndMerge) {
+  google::protobuf::RepeatedPtrField<ColumnStatsPB> stats;
+  for (const auto& column_stats : CollectStats(0, 1000, 100)) {
+    *stats.Add() = column_stats;
+  }
+  ASSERT_EQ(2, stats.size());
+  const auto& key_stats = stats.Get(0);
+  EXPECT_EQ(schema_.column_id(0), key_stats.column_id());
+  EXPECT_EQ(0, key_stats.null_count());
+  EXPECT_EQ(1000, key_stats.value_count());
+  int32_t min_key;
+  int32_t max_key;
+  ASSERT_EQ(sizeof(min_key), key_stats.min_value().size());
+  memcpy(&min_key, key_stats.min_value().data(), sizeof(min_key));
+  memcpy(&max_key, key_stats.max_value().data(), sizeof(max_key));
+  EXPECT_EQ(0, min_key);
+  EXPECT_EQ(999, max_key);
+
+  // Only the fixed-length columns have a minimum and a maximum.
+  const auto& val_stats = stats.Get(1);
+  EXPECT_EQ(500, val_stats.null_count());
+  EXPECT_EQ(500, val_stats.value_count());
+  EXPECT_FALSE(val_stats.has_min_value());
+  HyperLogLog sketch;
+  ASSERT_OK(HyperLogLog::FromRegisters(val_stats.ndv_sketch(), &sketch));
+  EXPECT_NEAR(50, sketch.Estimate(), 10);
+
+  // Merge the statistics of another range of keys, with the same values.
+  unordered_map<int32_t, ColumnStatsPB> stats_by_column_id;
+  unordered_map<int32_t, int> num_merged_by_column_id;
+  ASSERT_OK(MergeColumnStats(stats, schema_, &stats_by_column_id, &num_merged_by_column_id));
+  stats.Clear();
+  for (const auto& column_stats : CollectStats(-1000, 0, 100)) {
+    *stats.Add() = column_stats;
+  }
+  ASSERT_OK(MergeColumnStats(stats, schema_, &stats_by_column_id, &num_merged_by_column_id));
+  EXPECT_EQ(2, num_merged_by_column_id[schema_.column_id(0)]);
+  EXPECT_EQ(2, num_merged_by_column_id[schema_.column_id(1)]);
+
+  const auto& merged_key_stats = stats_by_column_id[schema_.column_id(0)];
+  EXPECT_EQ(2000, merged_key_stats.value_count());
+  memcpy(&min_key, merged_key_stats.min_value().data(), sizeof(min_key));
+  memcpy(&max_key, merged_key_stats.max_value().data(), sizeof(max_key));
+  EXPECT_EQ(-1000, min_key);
+  EXPECT_EQ(999, max_key);
+
+  const auto& merged_val_stats = stats_by_column_id[schema_.column_id(1)];
+  EXPECT_EQ(1000, merged_val_stats.null_count());
+  ASSERT_OK(HyperLogLog::FromRegisters(merged_val_stats.ndv_sketch(), &sketch));
+  // The negative keys have values of their own: "-1", "-3", ...
+  EXPECT_NEAR(100, sketch.Estimate(), 20);
+}
+
+TEST_F(ColumnStatsTest, SkipDroppedColumns) {
+  google::protobuf::RepeatedPtrField<ColumnStatsPB> stats;
+  for (const auto& column_stats : CollectStats(0, 10, 10)) {
+    *stats.Add() = column_stats;
+  }
+  SchemaBuilder builder(schema_);
+  ASSERT_OK(builder.RemoveColumn("val"));
+  const Schema altered_schema = builder.Build();
+
+  unordered_map<int32_t, ColumnStatsPB> stats_by_column_id;
+  ASSERT_OK(MergeColumnStats(stats, altered_schema, &stats_by_column_id));
+  ASSERT_EQ(1, stats_by_column_id.size());
+  EXPECT_EQ(1, stats_by_column_id.count(schema_.column_id(0)));
+}
+
+} // namespace tablet
+} // namespace kudu
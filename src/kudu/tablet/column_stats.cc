@@ -0,0 +1,182 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tablet/column_stats.h"
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include <glog/logging.h>
+#include <google/protobuf/repeated_field.h> // IWYU pragma: keep
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/hash_util.h"
+#include "kudu/util/slice.h"
+
+using std::string;
+using std::unordered_map;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tablet {
+
+namespace {
+
+// Whether the minimum and maximum values of a column of type 'type_info' are
+// tracked: the values of variable-length types could be arbitrarily large.
+bool TracksMinMax(const TypeInfo* type_info) {
+  return type_info->physical_type() != BINARY;
+}
+
+// Whether the cell at 'cell' of type 'type_info' is a floating point NaN,
+// which isn't ordered with respect to the other values.
+bool IsNaN(const TypeInfo* type_info, const void* cell) {
+  switch (type_info->physical_type()) {
+    case FLOAT: return std::isnan(*reinterpret_cast<const float*>(cell));
+    case DOUBLE: return std::isnan(*reinterpret_cast<const double*>(cell));
+    default: return false;
+  }
+}
+
+// Updates 'min_value' and 'max_value' with 'cell' of type 'type_info'.
+void UpdateMinMax(const TypeInfo* type_info, const void* cell,
+                  string* min_value, string* max_value) {
+  const size_t size = type_info->size();
+  if (min_value->empty() || type_info->Compare(cell, min_value->data()) < 0) {
+    min_value->assign(reinterpret_cast<const char*>(cell), size);
+  }
+  if (max_value->empty() || type_info->Compare(cell, max_value->data()) > 0) {
+    max_value->assign(reinterpret_cast<const char*>(cell), size);
+  }
+}
+
+} // anonymous namespace
+
+ColumnStatsCollector::ColumnStatsCollector(const Schema* schema)
+    : schema_(schema),
+      stats_(schema->num_columns()) {
+}
+
+void ColumnStatsCollector::AddBlock(const RowBlock& block) {
+  DCHECK_EQ(schema_->num_columns(), block.schema()->num_columns());
+  for (size_t col_idx = 0; col_idx < schema_->num_columns(); ++col_idx) {
+    const ColumnBlock column = block.column_block(col_idx);
+    const TypeInfo* type_info = column.type_info();
+    const bool is_binary = type_info->physical_type() == BINARY;
+    auto& stats = stats_[col_idx];
+    for (size_t i = 0; i < block.nrows(); ++i) {
+      if (column.is_nullable() && column.is_null(i)) {
+        ++stats.null_count;
+        continue;
+      }
+      ++stats.value_count;
+      const void* cell = column.cell_ptr(i);
+      if (is_binary) {
+        const auto* value = reinterpret_cast<const Slice*>(cell);
+        stats.ndv_sketch.AddHash(HashUtil::FastHash64(value->data(), value->size(), 0));
+        continue;
+      }
+      stats.ndv_sketch.AddHash(HashUtil::FastHash64(cell, type_info->size(), 0));
+      if (!IsNaN(type_info, cell)) {
+        UpdateMinMax(type_info, cell, &stats.min_value, &stats.max_value);
+      }
+    }
+  }
+}
+
+vector<ColumnStatsPB> ColumnStatsCollector::GetStats() const {
+  vector<ColumnStatsPB> result;
+  result.reserve(stats_.size());
+  for (size_t col_idx = 0; col_idx < stats_.size(); ++col_idx) {
+    const auto& stats = stats_[col_idx];
+    ColumnStatsPB pb;
+    pb.set_column_id(schema_->column_id(col_idx));
+    pb.set_null_count(stats.null_count);
+    pb.set_value_count(stats.value_count);
+    pb.set_ndv_sketch(stats.ndv_sketch.registers());
+    if (!stats.min_value.empty()) {
+      pb.set_min_value(stats.min_value);
+      pb.set_max_value(stats.max_value);
+    }
+    result.emplace_back(std::move(pb));
+  }
+  return result;
+}
+
+Status MergeColumnStats(const ColumnStatsPB& src,
+                        const TypeInfo* type_info,
+                        ColumnStatsPB* dst) {
+  if (!dst->has_column_id()) {
+    *dst = src;
+    return Status::OK();
+  }
+  DCHECK_EQ(src.column_id(), dst->column_id());
+  HyperLogLog dst_sketch;
+  RETURN_NOT_OK(HyperLogLog::FromRegisters(dst->ndv_sketch(), &dst_sketch));
+  HyperLogLog src_sketch;
+  RETURN_NOT_OK(HyperLogLog::FromRegisters(src.ndv_sketch(), &src_sketch));
+  RETURN_NOT_OK(dst_sketch.Merge(src_sketch));
+  dst->set_ndv_sketch(dst_sketch.registers());
+  dst->set_null_count(dst->null_count() + src.null_count());
+  dst->set_value_count(dst->value_count() + src.value_count());
+
+  if (TracksMinMax(type_info) && src.has_min_value()) {
+    if (src.min_value().size() != type_info->size() ||
+        src.max_value().size() != type_info->size()) {
+      return Status::Corruption(Substitute(
+          "invalid size of the minimum or maximum value of column $0", src.column_id()));
+    }
+    string min_value = dst->min_value();
+    string max_value = dst->max_value();
+    UpdateMinMax(type_info, src.min_value().data(), &min_value, &max_value);
+    UpdateMinMax(type_info, src.max_value().data(), &min_value, &max_value);
+    dst->set_min_value(std::move(min_value));
+    dst->set_max_value(std::move(max_value));
+  }
+  return Status::OK();
+}
+
+Status MergeColumnStats(const google::protobuf::RepeatedPtrField<ColumnStatsPB>& src,
+                        const Schema& schema,
+                        unordered_map<int32_t, ColumnStatsPB>* stats_by_column_id,
+                        unordered_map<int32_t, int>* num_merged_by_column_id) {
+  for (const auto& stats : src) {
+    const int col_idx = schema.find_column_by_id(ColumnId(stats.column_id()));
+    if (col_idx == Schema::kColumnNotFound) {
+      continue;
+    }
+    RETURN_NOT_OK_PREPEND(
+        MergeColumnStats(stats, schema.column(col_idx).type_info(),
+                         &(*stats_by_column_id)[stats.column_id()]),
+        Substitute("failed to merge the statistics of column $0",
+                   schema.column(col_idx).name()));
+    if (num_merged_by_column_id) {
+      ++(*num_merged_by_column_id)[stats.column_id()];
+    }
+  }
+  return Status::OK();
+}
+
+} // namespace tablet
+} // namespace kudu
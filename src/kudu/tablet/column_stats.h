@@ -0,0 +1,88 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/tablet/metadata.pb.h"
+#include "kudu/util/hyperloglog.h"
+#include "kudu/util/status.h"
+
+namespace google {
+namespace protobuf {
+template <typename Element> class RepeatedPtrField;
+} // namespace protobuf
+} // namespace google
+
+namespace kudu {
+
+class RowBlock;
+class Schema;
+class TypeInfo;
+
+namespace tablet {
+
+// Collects the statistics of the columns of the rows written to a rowset:
+// their null counts, a sketch of their number of distinct values and, for
+// fixed-length types, their minimum and maximum values.
+class ColumnStatsCollector {
+ public:
+  explicit ColumnStatsCollector(const Schema* schema);
+
+  // Adds the rows of 'block', which must have the schema of the collector.
+  void AddBlock(const RowBlock& block);
+
+  // Returns the statistics of the rows added so far, one per column.
+  std::vector<ColumnStatsPB> GetStats() const;
+
+ private:
+  struct Stats {
+    int64_t null_count = 0;
+    int64_t value_count = 0;
+    HyperLogLog ndv_sketch;
+    std::string min_value;
+    std::string max_value;
+  };
+
+  const Schema* const schema_;
+  std::vector<Stats> stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(ColumnStatsCollector);
+};
+
+// Merges the statistics 'src' of a column of type 'type_info' into 'dst', for
+// instance to combine the statistics of the column across rowsets or tablets.
+// 'dst' may be empty, to merge the first statistics into.
+Status MergeColumnStats(const ColumnStatsPB& src,
+                        const TypeInfo* type_info,
+                        ColumnStatsPB* dst);
+
+// Merges the statistics in 'src' into those in 'stats_by_column_id', with the
+// types of the columns in 'schema'. The statistics of the columns that aren't
+// in 'schema', e.g. the columns dropped since, are skipped. If not null,
+// 'num_merged_by_column_id' counts the statistics merged per column.
+Status MergeColumnStats(const google::protobuf::RepeatedPtrField<ColumnStatsPB>& src,
+                        const Schema& schema,
+                        std::unordered_map<int32_t, ColumnStatsPB>* stats_by_column_id,
+                        std::unordered_map<int32_t, int>* num_merged_by_column_id = nullptr);
+
+} // namespace tablet
+} // namespace kudu
@@ -0,0 +1,366 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Benchmark of the flushes and compactions of a tablet under a few ingest
+// patterns: writes rows into a local tablet replica with keys following the
+// pattern while a MaintenanceManager flushes and compacts it as a tablet
+// server would, and reports over time the write amplification of the
+// flushes and compactions, the average height of the rowset tree, the bytes
+// compacted, and the latencies of point lookups and short scans.
+//
+// The compaction policy is picked with --tablet_compaction_policy, so that
+// alternative policies can be compared on the same workloads. The results
+// are logged, and written as CSV into --compaction_bench_results_file if set.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/iterator.h"
+#include "kudu/common/partial_row.h"
+#include "kudu/common/row_operations.h"
+#include "kudu/common/row_operations.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/scan_spec.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/wire_protocol.h"
+#include "kudu/consensus/raft_consensus.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/tablet.h"
+#include "kudu/tablet/tablet_metrics.h"
+#include "kudu/tablet/tablet_replica-test-base.h"
+#include "kudu/tablet/tablet_replica.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/env.h"
+#include "kudu/util/hdr_histogram.h"
+#include "kudu/util/maintenance_manager.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/random.h"
+#include "kudu/util/random_util.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/stopwatch.h"
+#include "kudu/util/test_macros.h"
+
+DECLARE_int32(flush_threshold_mb);
+DECLARE_string(tablet_compaction_policy);
+
+DEFINE_int64(compaction_bench_num_rows, 200000,
+             "Number of rows to write per key pattern");
+DEFINE_int32(compaction_bench_batch_size, 100,
+             "Number of rows per write request");
+DEFINE_int32(compaction_bench_payload_length, 100,
+             "Length of the string payload of the rows");
+DEFINE_double(compaction_bench_late_fraction, 0.1,
+              "Fraction of the rows of the time-series pattern which arrive late");
+DEFINE_int64(compaction_bench_late_window, 100000,
+             "Maximum number of rows a late row of the time-series pattern "
+             "arrives after the rows of its time");
+DEFINE_int64(compaction_bench_report_every_rows, 50000,
+             "Number of rows written between two reports");
+DEFINE_int32(compaction_bench_settle_reports, 5,
+             "Number of reports, one per second, once all the rows are "
+             "written, to follow the compactions of the written rows");
+DEFINE_int32(compaction_bench_lookups, 1000,
+             "Number of point lookups of random written keys per report");
+DEFINE_int32(compaction_bench_scans, 100,
+             "Number of scans starting at random written keys per report");
+DEFINE_int32(compaction_bench_scan_rows, 1000,
+             "Number of rows read by each scan");
+DEFINE_int32(compaction_bench_flush_threshold_mb, 4,
+             "Size of the MemRowSet above which it is flushed, overriding "
+             "--flush_threshold_mb so that the tablet has many rowsets");
+DEFINE_int32(compaction_bench_maintenance_threads, 1,
+             "Number of threads of the maintenance manager");
+DEFINE_string(compaction_bench_results_file, "",
+              "If set, the results are written as CSV into this file");
+
+METRIC_DECLARE_entity(server);
+
+using kudu::consensus::ConsensusBootstrapInfo;
+using kudu::tserver::WriteRequestPB;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tablet {
+
+namespace {
+
+enum class KeyPattern {
+  // Increasing keys, as written by an auto-incrementing or time-ordered key.
+  SEQUENTIAL,
+  // Uniformly random keys.
+  RANDOM,
+  // Keys prefixed by increasing times, with
+  // --compaction_bench_late_fraction of the rows arriving late.
+  TIME_SERIES,
+};
+
+const char* KeyPatternName(KeyPattern pattern) {
+  switch (pattern) {
+    case KeyPattern::SEQUENTIAL: return "sequential";
+    case KeyPattern::RANDOM: return "random";
+    case KeyPattern::TIME_SERIES: return "time_series";
+  }
+  LOG(FATAL) << "unknown key pattern";
+  return "";
+}
+
+// The state of the tablet at some point of a run.
+struct Report {
+  KeyPattern pattern;
+  int64_t rows_written;
+  double elapsed_secs;
+  size_t num_rowsets;
+  double average_height;
+  uint64_t bytes_flushed;
+  uint64_t bytes_compacted;
+  // The bytes written by the flushes and the compactions per byte flushed.
+  double write_amplification;
+  uint64_t lookup_p50_us;
+  uint64_t lookup_p99_us;
+  uint64_t scan_p50_us;
+  uint64_t scan_p99_us;
+
+  static string CsvHeader() {
+    return "policy,pattern,rows_written,elapsed_secs,num_rowsets,average_height,"
+           "bytes_flushed,bytes_compacted,write_amplification,lookup_p50_us,"
+           "lookup_p99_us,scan_p50_us,scan_p99_us";
+  }
+
+  string ToCsv() const {
+    return Substitute("$0,$1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11,$12",
+                      FLAGS_tablet_compaction_policy, KeyPatternName(pattern), rows_written,
+                      StringPrintf("%.1f", elapsed_secs), num_rowsets,
+                      StringPrintf("%.2f", average_height), bytes_flushed, bytes_compacted,
+                      StringPrintf("%.2f", write_amplification), lookup_p50_us,
+                      lookup_p99_us, scan_p50_us, scan_p99_us);
+  }
+};
+
+// The latencies above which the measurements are clamped.
+const uint64_t kMaxLatencyUs = 60 * 1000 * 1000;
+
+Schema CreateSchema() {
+  return Schema({ ColumnSchema("key", INT64),
+                  ColumnSchema("val", INT64),
+                  ColumnSchema("payload", STRING) }, 1);
+}
+
+class CompactionBench : public TabletReplicaTestBase {
+ public:
+  CompactionBench()
+      : TabletReplicaTestBase(CreateSchema()),
+        rng_(SeedRandom()),
+        payload_(FLAGS_compaction_bench_payload_length, 'x') {
+  }
+
+  void SetUp() override {
+    FLAGS_flush_threshold_mb = FLAGS_compaction_bench_flush_threshold_mb;
+    NO_FATALS(TabletReplicaTestBase::SetUp());
+    ConsensusBootstrapInfo info;
+    ASSERT_OK(StartReplicaAndWaitUntilLeader(info));
+
+    MaintenanceManager::Options options;
+    options.num_threads = FLAGS_compaction_bench_maintenance_threads;
+    options.polling_interval_ms = 50;
+    options.history_size = 8;
+    maint_mgr_.reset(new MaintenanceManager(
+        options, "compaction-bench",
+        METRIC_ENTITY_server.Instantiate(&metric_registry_, "compaction-bench")));
+    ASSERT_OK(maint_mgr_->Start());
+    tablet_replica_->RegisterMaintenanceOps(maint_mgr_.get());
+  }
+
+  void TearDown() override {
+    tablet_replica_->UnregisterMaintenanceOps();
+    maint_mgr_->Shutdown();
+    TabletReplicaTestBase::TearDown();
+    if (!FLAGS_compaction_bench_results_file.empty()) {
+      string csv = Report::CsvHeader() + "\n";
+      for (const auto& report : reports_) {
+        csv += report.ToCsv() + "\n";
+      }
+      ASSERT_OK(WriteStringToFile(env_, csv, FLAGS_compaction_bench_results_file));
+    }
+  }
+
+ protected:
+  // Writes --compaction_bench_num_rows rows with keys following 'pattern',
+  // reporting every --compaction_bench_report_every_rows rows, and then a few
+  // more times while the maintenance manager compacts the written rows.
+  void Run(KeyPattern pattern) {
+    Stopwatch sw;
+    sw.start();
+    const int64_t num_rows = FLAGS_compaction_bench_num_rows;
+    vector<int64_t> batch;
+    for (int64_t i = 0; i < num_rows; i++) {
+      const int64_t key = NextKey(pattern, i);
+      keys_.push_back(key);
+      batch.push_back(key);
+      if (batch.size() == static_cast<size_t>(FLAGS_compaction_bench_batch_size) ||
+          i == num_rows - 1) {
+        ASSERT_OK(WriteRows(batch));
+        batch.clear();
+      }
+      if ((i + 1) % FLAGS_compaction_bench_report_every_rows == 0) {
+        NO_FATALS(AddReport(pattern, i + 1, sw.elapsed().wall_seconds()));
+      }
+    }
+    for (int i = 0; i < FLAGS_compaction_bench_settle_reports; i++) {
+      SleepFor(MonoDelta::FromSeconds(1));
+      NO_FATALS(AddReport(pattern, num_rows, sw.elapsed().wall_seconds()));
+    }
+  }
+
+ private:
+  int64_t NextKey(KeyPattern pattern, int64_t i) {
+    switch (pattern) {
+      case KeyPattern::SEQUENTIAL:
+        return i;
+      case KeyPattern::RANDOM:
+        return static_cast<int64_t>(rng_.Next64() >> 1);
+      case KeyPattern::TIME_SERIES: {
+        int64_t time = i;
+        if (rng_.NextDoubleFraction() < FLAGS_compaction_bench_late_fraction) {
+          time -= rng_.Uniform64(std::min(i, FLAGS_compaction_bench_late_window) + 1);
+        }
+        // The row index as a suffix keeps the keys unique.
+        return time * FLAGS_compaction_bench_num_rows + i;
+      }
+    }
+    LOG(FATAL) << "unknown key pattern";
+    return 0;
+  }
+
+  Status WriteRows(const vector<int64_t>& keys) {
+    WriteRequestPB req;
+    req.set_tablet_id(tablet()->tablet_id());
+    RETURN_NOT_OK(SchemaToPB(client_schema_, req.mutable_schema()));
+    RowOperationsPBEncoder enc(req.mutable_row_operations());
+    KuduPartialRow row(&client_schema_);
+    for (int64_t key : keys) {
+      RETURN_NOT_OK(row.SetInt64(0, key));
+      RETURN_NOT_OK(row.SetInt64(1, static_cast<int64_t>(rng_.Next64())));
+      RETURN_NOT_OK(row.SetStringNoCopy(2, payload_));
+      enc.Add(RowOperationsPB::UPSERT, row);
+    }
+    return ExecuteWrite(tablet_replica_.get(), req);
+  }
+
+  // Reads the rows from 'key' on, up to 'max_rows' of them.
+  Status ReadRows(int64_t key, int max_rows, bool point_lookup) {
+    unique_ptr<RowwiseIterator> iter;
+    RETURN_NOT_OK(tablet()->NewRowIterator(client_schema_, &iter));
+    ScanSpec spec;
+    const ColumnSchema& key_col = client_schema_.column(0);
+    spec.AddPredicate(point_lookup ? ColumnPredicate::Equality(key_col, &key)
+                                   : ColumnPredicate::Range(key_col, &key, nullptr));
+    RETURN_NOT_OK(iter->Init(&spec));
+    RowBlockMemory mem(32 * 1024);
+    RowBlock block(&iter->schema(), 100, &mem);
+    int rows_read = 0;
+    while (iter->HasNext() && rows_read < max_rows) {
+      mem.Reset();
+      RETURN_NOT_OK(iter->NextBlock(&block));
+      rows_read += block.selection_vector()->CountSelected();
+    }
+    if (point_lookup && rows_read != 1) {
+      return Status::Corruption(Substitute("found $0 rows of key $1", rows_read, key));
+    }
+    return Status::OK();
+  }
+
+  // Measures the latencies of the reads, and reports them with the state of
+  // the tablet.
+  void AddReport(KeyPattern pattern, int64_t rows_written, double elapsed_secs) {
+    HdrHistogram lookup_hist(kMaxLatencyUs, 2);
+    HdrHistogram scan_hist(kMaxLatencyUs, 2);
+    for (int i = 0; i < FLAGS_compaction_bench_lookups; i++) {
+      Stopwatch sw;
+      sw.start();
+      ASSERT_OK(ReadRows(keys_[rng_.Uniform64(keys_.size())], 1, true));
+      lookup_hist.Increment(std::min<uint64_t>(sw.elapsed().wall_micros(), kMaxLatencyUs));
+    }
+    for (int i = 0; i < FLAGS_compaction_bench_scans; i++) {
+      Stopwatch sw;
+      sw.start();
+      ASSERT_OK(ReadRows(keys_[rng_.Uniform64(keys_.size())],
+                         FLAGS_compaction_bench_scan_rows, false));
+      scan_hist.Increment(std::min<uint64_t>(sw.elapsed().wall_micros(), kMaxLatencyUs));
+    }
+
+    const TabletMetrics* metrics = tablet()->metrics();
+    Report report;
+    report.pattern = pattern;
+    report.rows_written = rows_written;
+    report.elapsed_secs = elapsed_secs;
+    report.num_rowsets = tablet()->num_rowsets();
+    report.average_height = metrics->average_diskrowset_height->value();
+    report.bytes_flushed = metrics->flush_mrs_bytes_written->value();
+    report.bytes_compacted = metrics->compact_rs_bytes_written->value();
+    report.write_amplification = report.bytes_flushed == 0 ? 0 :
+        static_cast<double>(report.bytes_flushed + report.bytes_compacted) /
+        report.bytes_flushed;
+    report.lookup_p50_us = lookup_hist.ValueAtPercentile(50);
+    report.lookup_p99_us = lookup_hist.ValueAtPercentile(99);
+    report.scan_p50_us = scan_hist.ValueAtPercentile(50);
+    report.scan_p99_us = scan_hist.ValueAtPercentile(99);
+    LOG(INFO) << Report::CsvHeader() << "\n" << report.ToCsv();
+    reports_.push_back(report);
+  }
+
+  Random rng_;
+  const string payload_;
+  unique_ptr<MaintenanceManager> maint_mgr_;
+  // The keys written so far, which the reads pick from.
+  vector<int64_t> keys_;
+  vector<Report> reports_;
+};
+
+} // anonymous namespace
+
+TEST_F(CompactionBench, Sequential) {
+  NO_FATALS(Run(KeyPattern::SEQUENTIAL));
+}
+
+TEST_F(CompactionBench, Random) {
+  NO_FATALS(Run(KeyPattern::RANDOM));
+}
+
+TEST_F(CompactionBench, TimeSeries) {
+  NO_FATALS(Run(KeyPattern::TIME_SERIES));
+}
+
+} // namespace tablet
+} // namespace kudu
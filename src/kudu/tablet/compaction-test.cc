@@ -55,6 +55,8 @@
 #include "kudu/gutil/casts.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/stl_util.h"
+#include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/local_tablet_writer.h"
@@ -90,6 +92,8 @@ DEFINE_uint32(merge_benchmark_num_rowsets, 3,
 DEFINE_uint32(merge_benchmark_num_rows_per_rowset, 500000,
               "Number of rowsets as input to the merge");
 
+DECLARE_int32(tablet_compaction_parallel_ranges);
+DECLARE_int64(budgeted_compaction_target_rowset_size);
 DECLARE_string(block_manager);
 
 using kudu::consensus::OpId;
@@ -1338,6 +1342,52 @@ TEST_F(TestCompaction, TestConcurrentCompactionRowSetPicking) {
   ASSERT_EQ(kExpectedRows, num_rows);
 }
 
+// Compactions split into key ranges merged in parallel should preserve the
+// rows and their history.
+TEST_F(TestCompaction, TestParallelRangeCompaction) {
+  FLAGS_tablet_compaction_parallel_ranges = 4;
+  FLAGS_budgeted_compaction_target_rowset_size = 1;
+
+  LocalTabletWriter writer(tablet().get(), &client_schema());
+  KuduPartialRow row(&client_schema());
+  const int kNumRowSets = 3;
+  const int kNumRowsPerRowSet = 100;
+
+  // Flush a few overlapping rowsets.
+  for (int i = 0; i < kNumRowSets; i++) {
+    for (int j = 0; j < kNumRowsPerRowSet; j++) {
+      const int64_t val = i + j * kNumRowSets;
+      ASSERT_OK(row.SetStringCopy("key", StringPrintf(kRowKeyFormat, val)));
+      ASSERT_OK(row.SetInt64("val", val));
+      ASSERT_OK(writer.Insert(row));
+    }
+    ASSERT_OK(tablet()->Flush());
+  }
+  vector<MvccSnapshot> snaps;
+  snaps.emplace_back(*tablet()->mvcc_manager());
+
+  // Update and delete some of the flushed rows.
+  for (int64_t val = 0; val < kNumRowSets * kNumRowsPerRowSet; val += 7) {
+    ASSERT_OK(row.SetStringCopy("key", StringPrintf(kRowKeyFormat, val)));
+    if (val % 2 == 0) {
+      ASSERT_OK(row.SetInt64("val", -val));
+      ASSERT_OK(writer.Update(row));
+    } else {
+      ASSERT_OK(writer.Delete(row));
+    }
+  }
+  snaps.emplace_back(*tablet()->mvcc_manager());
+
+  vector<vector<string>*> expected_rows;
+  ElementDeleter deleter(&expected_rows);
+  NO_FATALS(CollectRowsForSnapshots(tablet().get(), client_schema(), snaps, &expected_rows));
+
+  ASSERT_OK(tablet()->Compact(Tablet::FORCE_COMPACT_ALL));
+  ASSERT_GT(tablet()->num_rowsets(), 1);
+  NO_FATALS(VerifySnapshotsHaveSameResult(tablet().get(), client_schema(), snaps,
+                                          expected_rows));
+}
+
 TEST_F(TestCompaction, TestCompactionFreesDiskSpace) {
   {
     // We must force the LocalTabletWriter out of scope before measuring
@@ -31,6 +31,7 @@
 #include <glog/logging.h>
 
 #include "kudu/clock/hybrid_clock.h"
+#include "kudu/common/encoded_key.h"
 #include "kudu/common/generic_iterators.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/row.h"
@@ -48,6 +49,7 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/cfile_set.h"
 #include "kudu/tablet/delta_store.h"
 #include "kudu/tablet/delta_tracker.h"
 #include "kudu/tablet/diskrowset.h"
@@ -231,12 +233,21 @@ class MemRowSetCompactionInput : public CompactionInput {
 // CompactionInput yielding rows and mutations from an on-disk DiskRowSet.
 class DiskRowSetCompactionInput : public CompactionInput {
  public:
+  // 'base_cfile_iter' is the CFileSet iterator wrapped by 'base_iter'. The
+  // rows yielded are restricted to the encoded keys in
+  // [lower_bound_key, upper_bound_key), empty bounds being unbounded.
   DiskRowSetCompactionInput(unique_ptr<RowwiseIterator> base_iter,
+                            const CFileSet::Iterator* base_cfile_iter,
                             unique_ptr<DeltaIterator> redo_delta_iter,
-                            unique_ptr<DeltaIterator> undo_delta_iter)
+                            unique_ptr<DeltaIterator> undo_delta_iter,
+                            string lower_bound_key,
+                            string upper_bound_key)
       : base_iter_(std::move(base_iter)),
+        base_cfile_iter_(base_cfile_iter),
         redo_delta_iter_(std::move(redo_delta_iter)),
         undo_delta_iter_(std::move(undo_delta_iter)),
+        lower_bound_key_(std::move(lower_bound_key)),
+        upper_bound_key_(std::move(upper_bound_key)),
         mem_(32 * 1024),
         block_(&base_iter_->schema(), kRowsPerBlock, &mem_),
         redo_mutation_block_(kRowsPerBlock, static_cast<Mutation*>(nullptr)),
@@ -245,11 +256,27 @@ class DiskRowSetCompactionInput : public CompactionInput {
   Status Init() override {
     ScanSpec spec;
     spec.set_cache_blocks(false);
+    // The key bounds are pushed down into a range of row ordinals, so the
+    // rows come out contiguous from the first ordinal of the range, which is
+    // where the deltas start too.
+    Arena arena(256);
+    const Schema& schema = base_iter_->schema();
+    if (!lower_bound_key_.empty()) {
+      EncodedKey* key;
+      RETURN_NOT_OK(EncodedKey::DecodeEncodedString(schema, &arena, lower_bound_key_, &key));
+      spec.SetLowerBoundKey(key);
+    }
+    if (!upper_bound_key_.empty()) {
+      EncodedKey* key;
+      RETURN_NOT_OK(EncodedKey::DecodeEncodedString(schema, &arena, upper_bound_key_, &key));
+      spec.SetExclusiveUpperBoundKey(key);
+    }
     RETURN_NOT_OK(base_iter_->Init(&spec));
+    const rowid_t first_ordinal = base_cfile_iter_->cur_ordinal_idx();
     RETURN_NOT_OK(redo_delta_iter_->Init(&spec));
-    RETURN_NOT_OK(redo_delta_iter_->SeekToOrdinal(0));
+    RETURN_NOT_OK(redo_delta_iter_->SeekToOrdinal(first_ordinal));
     RETURN_NOT_OK(undo_delta_iter_->Init(&spec));
-    RETURN_NOT_OK(undo_delta_iter_->SeekToOrdinal(0));
+    RETURN_NOT_OK(undo_delta_iter_->SeekToOrdinal(first_ordinal));
     return Status::OK();
   }
 
@@ -301,9 +328,13 @@ class DiskRowSetCompactionInput : public CompactionInput {
  private:
   DISALLOW_COPY_AND_ASSIGN(DiskRowSetCompactionInput);
   unique_ptr<RowwiseIterator> base_iter_;
+  const CFileSet::Iterator* base_cfile_iter_;
   unique_ptr<DeltaIterator> redo_delta_iter_;
   unique_ptr<DeltaIterator> undo_delta_iter_;
 
+  const string lower_bound_key_;
+  const string upper_bound_key_;
+
   RowBlockMemory mem_;
 
   // The current block of data which has come from the input iterator
@@ -1062,8 +1093,41 @@ void SetHead(Mutation** current_head, Mutation* new_head) {
   *current_head = new_head;
 }
 
+// Returns true if 'row' is dropped by a compaction at 'snap' because it has
+// expired: its base data has expired, and no mutation of 'snap' changed it
+// since. The rows with previous ghosts are kept, so that their histories
+// remain intact.
+//
+// This only depends on the input row and on 'snap', so that both passes of a
+// compaction drop the same rows.
+bool IsRowExpired(const HistoryGcOpts& history_gc_opts,
+                  const MvccSnapshot& snap,
+                  const CompactionInputRow& row) {
+  if (row.previous_ghost != nullptr || !history_gc_opts.IsExpired(row.row)) {
+    return false;
+  }
+  for (const auto* mut = row.redo_head; mut != nullptr; mut = mut->acquire_next()) {
+    if (snap.IsApplied(mut->timestamp())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 } // anonymous namespace
 
+bool HistoryGcOpts::IsExpired(const RowBlockRow& row) const {
+  if (!gc_enabled_ || ttl_col_id_ == ColumnId(-1)) {
+    return false;
+  }
+  const int idx = row.schema()->find_column_by_id(ttl_col_id_);
+  if (idx == Schema::kColumnNotFound ||
+      (row.schema()->column(idx).is_nullable() && row.is_null(idx))) {
+    return false;
+  }
+  return *reinterpret_cast<const int64_t*>(row.cell_ptr(idx)) < expired_before_micros_;
+}
+
 string RowToString(const RowBlockRow& row, const Mutation* redo_head, const Mutation* undo_head) {
   return Substitute("RowIdxInBlock: $0; Base: $1; Undo Mutations: $2; Redo Mutations: $3;",
                     row.row_index(), row.schema()->DebugRow(row),
@@ -1094,10 +1158,22 @@ Status CompactionInput::Create(const DiskRowSet& rowset,
                                const MvccSnapshot& snap,
                                const IOContext* io_context,
                                unique_ptr<CompactionInput>* out) {
+  return Create(rowset, projection, snap, io_context, "", "", out);
+}
+
+Status CompactionInput::Create(const DiskRowSet& rowset,
+                               const Schema* projection,
+                               const MvccSnapshot& snap,
+                               const IOContext* io_context,
+                               const string& lower_bound_key,
+                               const string& upper_bound_key,
+                               unique_ptr<CompactionInput>* out) {
   CHECK(projection->has_column_ids());
 
-  unique_ptr<ColumnwiseIterator> base_cwise(rowset.base_data_->NewIterator(projection, io_context));
-  unique_ptr<RowwiseIterator> base_iter(NewMaterializingIterator(std::move(base_cwise)));
+  unique_ptr<CFileSet::Iterator> base_cfile_iter(
+      rowset.base_data_->NewIterator(projection, io_context));
+  const CFileSet::Iterator* base_cfile_iter_ptr = base_cfile_iter.get();
+  unique_ptr<RowwiseIterator> base_iter(NewMaterializingIterator(std::move(base_cfile_iter)));
 
   // Creates a DeltaIteratorMerger that will only include the relevant REDO deltas.
   RowIteratorOptions redo_opts;
@@ -1118,8 +1194,11 @@ Status CompactionInput::Create(const DiskRowSet& rowset,
       undo_opts, DeltaTracker::UNDOS_ONLY, &undo_deltas), "Could not open UNDOs");
 
   out->reset(new DiskRowSetCompactionInput(std::move(base_iter),
+                                           base_cfile_iter_ptr,
                                            std::move(redo_deltas),
-                                           std::move(undo_deltas)));
+                                           std::move(undo_deltas),
+                                           lower_bound_key,
+                                           upper_bound_key));
   return Status::OK();
 }
 
@@ -1161,6 +1240,42 @@ Status RowSetsInCompaction::CreateCompactionInput(const MvccSnapshot& snap,
   return Status::OK();
 }
 
+Status RowSetsInCompaction::CreateCompactionInput(const MvccSnapshot& snap,
+                                                  const Schema* schema,
+                                                  const IOContext* io_context,
+                                                  const string& lower_bound_key,
+                                                  const string& upper_bound_key,
+                                                  shared_ptr<CompactionInput>* out) const {
+  CHECK(schema->has_column_ids());
+
+  vector<shared_ptr<CompactionInput>> inputs;
+  for (const auto& rs : rowsets_) {
+    // Skip the rowsets which don't overlap with the range.
+    string min_key;
+    string max_key;
+    if (rs->GetBounds(&min_key, &max_key).ok() &&
+        ((!upper_bound_key.empty() && min_key >= upper_bound_key) ||
+         (!lower_bound_key.empty() && max_key < lower_bound_key))) {
+      continue;
+    }
+    unique_ptr<CompactionInput> input;
+    RETURN_NOT_OK_PREPEND(CompactionInput::Create(*down_cast<DiskRowSet*>(rs.get()), schema,
+                                                  snap, io_context, lower_bound_key,
+                                                  upper_bound_key, &input),
+                          Substitute("Could not create compaction input for rowset $0",
+                                     rs->ToString()));
+    inputs.push_back(shared_ptr<CompactionInput>(input.release()));
+  }
+
+  if (inputs.size() == 1) {
+    *out = std::move(inputs[0]);
+  } else {
+    out->reset(CompactionInput::Merge(inputs, schema));
+  }
+
+  return Status::OK();
+}
+
 void RowSetsInCompaction::DumpToLog() const {
   VLOG(1) << "Selected " << rowsets_.size() << " rowsets to compact:";
   // Dump the selected rowsets to the log, and collect corresponding iterators.
@@ -1373,6 +1488,11 @@ Status FlushCompactionInput(const string& tablet_id,
 
       DVLOG(4) << "Input Row: " << CompactionInputRowToString(*input_row);
 
+      if (IsRowExpired(history_gc_opts, snap, *input_row)) {
+        DVLOG(4) << "Dropping expired row";
+        continue;
+      }
+
       // Collect the new UNDO/REDO mutations.
       Mutation* new_undos_head = nullptr;
       Mutation* new_redos_head = nullptr;
@@ -1506,6 +1626,14 @@ Status ReupdateMissedDeltas(const IOContext* io_context,
     for (const auto& row : rows) {
       DVLOG(4) << "Revisiting row: " << CompactionInputRowToString(row);
 
+      // The flush has dropped the row if it expired: its missed deltas are
+      // dropped with it, and it doesn't take an output row either.
+      if (IsRowExpired(history_gc_opts, snap_to_exclude, row)) {
+        DVLOG(4) << "Skipping expired input row: " << schema->DebugRow(row.row)
+                 << " while reupdating missed deltas";
+        continue;
+      }
+
       bool is_garbage_collected = false;
       for (const auto* mut = row.redo_head;
            mut != nullptr;
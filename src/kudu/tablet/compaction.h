@@ -27,6 +27,7 @@
 #include <glog/logging.h>
 
 #include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/tablet/rowset.h"
@@ -79,10 +80,25 @@ class HistoryGcOpts {
     return ancient_history_mark_;
   }
 
+  // Returns options like these which also garbage-collect the expired rows:
+  // those whose non-nullable UNIXTIME_MICROS column 'ttl_col_id' is before
+  // 'expired_before_micros'.
+  HistoryGcOpts WithRowExpiry(ColumnId ttl_col_id, int64_t expired_before_micros) const {
+    return HistoryGcOpts(gc_enabled_, ancient_history_mark_, ttl_col_id, expired_before_micros);
+  }
+
+  // Returns true if the base data of 'row' has expired. Always returns false
+  // if row expiry isn't enabled, or if the row's schema has no TTL column.
+  bool IsExpired(const RowBlockRow& row) const;
+
  private:
-  HistoryGcOpts(bool gc_enabled, Timestamp ahm)
+  HistoryGcOpts(bool gc_enabled, Timestamp ahm,
+                ColumnId ttl_col_id = ColumnId(-1),
+                int64_t expired_before_micros = 0)
       : gc_enabled_(gc_enabled),
-        ancient_history_mark_(ahm) {
+        ancient_history_mark_(ahm),
+        ttl_col_id_(ttl_col_id),
+        expired_before_micros_(expired_before_micros) {
   }
 
   // Whether historical records prior to the ancient history mark should be
@@ -92,6 +108,13 @@ class HistoryGcOpts {
   // A timestamp prior to which no history will be preserved.
   // Ignored if 'enabled' != GC_ENABLED.
   const Timestamp ancient_history_mark_;
+
+  // The id of the column holding the time the rows expire from, or -1 if the
+  // rows don't expire.
+  const ColumnId ttl_col_id_;
+
+  // Rows expire once their TTL column is before this time.
+  const int64_t expired_before_micros_;
 };
 
 // Interface for an input feeding into a compaction or flush.
@@ -112,6 +135,17 @@ class CompactionInput {
                        const fs::IOContext* io_context,
                        std::unique_ptr<CompactionInput>* out);
 
+  // Like above, but only yields the rows whose encoded keys are in
+  // [lower_bound_key, upper_bound_key). An empty bound leaves that side of
+  // the range unbounded.
+  static Status Create(const DiskRowSet& rowset,
+                       const Schema* projection,
+                       const MvccSnapshot& snap,
+                       const fs::IOContext* io_context,
+                       const std::string& lower_bound_key,
+                       const std::string& upper_bound_key,
+                       std::unique_ptr<CompactionInput>* out);
+
   // Create an input which reads from the given memrowset, yielding base rows and updates
   // prior to the given snapshot.
   static CompactionInput* Create(const MemRowSet& memrowset,
@@ -164,6 +198,16 @@ class RowSetsInCompaction {
                                const fs::IOContext* io_context,
                                std::shared_ptr<CompactionInput>* out) const;
 
+  // Like above, but only for the rows whose encoded keys are in
+  // [lower_bound_key, upper_bound_key), where an empty bound leaves that side
+  // of the range unbounded. The rowsets must all be DiskRowSets.
+  Status CreateCompactionInput(const MvccSnapshot& snap,
+                               const Schema* schema,
+                               const fs::IOContext* io_context,
+                               const std::string& lower_bound_key,
+                               const std::string& upper_bound_key,
+                               std::shared_ptr<CompactionInput>* out) const;
+
   // Dump a log message indicating the chosen rowsets.
   void DumpToLog() const;
 
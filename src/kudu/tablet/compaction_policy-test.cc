@@ -33,6 +33,7 @@
 #include <glog/stl_logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/numbers.h"
 #include "kudu/gutil/strings/split.h"
@@ -56,6 +57,7 @@ using std::vector;
 DECLARE_double(compaction_minimum_improvement);
 DECLARE_double(compaction_small_rowset_tradeoff);
 DECLARE_int64(budgeted_compaction_target_rowset_size);
+DECLARE_int64(size_tiered_compaction_max_rowset_size);
 
 namespace kudu {
 namespace tablet {
@@ -637,5 +639,51 @@ TEST_F(TestCompactionPolicy, TestKUDU2704) {
   ASSERT_EQ(2, picked.size());
   ASSERT_GT(quality, 0.0);
 }
+
+// The size-tiered policy merges the rowsets of the smallest tier with enough
+// of them, even if they don't overlap, and leaves the other tiers alone.
+TEST_F(TestCompactionPolicy, TestSizeTieredSelection) {
+  constexpr auto kMiB = 1024 * 1024;
+  RowSetVector rowsets;
+  // Three rowsets of the second tier: not enough to be compacted.
+  for (auto i = 0; i < 3; i++) {
+    rowsets.emplace_back(new MockDiskRowSet(
+        StringPrintf("%010d", i * 2), StringPrintf("%010d", i * 2 + 1), 8 * kMiB));
+  }
+  // Six non-overlapping rowsets of the first tier, and a seventh one which
+  // overlaps the last two of them.
+  for (auto i = 10; i < 16; i++) {
+    rowsets.emplace_back(new MockDiskRowSet(
+        StringPrintf("%010d", i * 2), StringPrintf("%010d", i * 2 + 1), kMiB));
+  }
+  rowsets.emplace_back(new MockDiskRowSet("0000000028", "0000000031", kMiB));
+  // A rowset which reached the maximum size is never compacted again.
+  rowsets.emplace_back(new MockDiskRowSet(
+      "0000000028", "0000000031", FLAGS_size_tiered_compaction_max_rowset_size));
+
+  RowSetTree tree;
+  ASSERT_OK(tree.Reset(rowsets));
+  SizeTieredCompactionPolicy policy;
+  CompactionSelection picked;
+  double quality = 0.0;
+  ASSERT_OK(policy.PickRowSets(tree, &picked, &quality, /*log=*/nullptr));
+
+  // The four picked rowsets are the window of the first tier which overlaps
+  // the most.
+  ASSERT_EQ(4, picked.size());
+  ASSERT_GT(quality, 0.0);
+  for (auto i = 0; i < 5; i++) {
+    ASSERT_EQ(i >= 1 && i <= 4, ContainsKey(picked, rowsets[5 + i].get())) << i;
+  }
+  ASSERT_FALSE(ContainsKey(picked, rowsets[10].get()));
+
+  // Once no tier has enough rowsets, nothing is picked.
+  rowsets.resize(6);
+  ASSERT_OK(tree.Reset(rowsets));
+  picked.clear();
+  ASSERT_OK(policy.PickRowSets(tree, &picked, &quality, /*log=*/nullptr));
+  ASSERT_TRUE(picked.empty());
+  ASSERT_EQ(0.0, quality);
+}
 } // namespace tablet
 } // namespace kudu
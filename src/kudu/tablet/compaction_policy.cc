@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <functional>
 #include <limits>
+#include <map>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -117,6 +118,33 @@ DEFINE_bool(rowset_compaction_enforce_preset_factor, false,
 TAG_FLAG(rowset_compaction_enforce_preset_factor, experimental);
 TAG_FLAG(rowset_compaction_enforce_preset_factor, runtime);
 
+DEFINE_int32(size_tiered_compaction_fanout, 4,
+             "The number of rowsets of a tier merged together by a compaction "
+             "when the size-tiered compaction policy is used. The sizes of the "
+             "tiers grow by this factor, so each row is rewritten about "
+             "log_fanout(--size_tiered_compaction_max_rowset_size / "
+             "--size_tiered_compaction_base_rowset_size) times.");
+TAG_FLAG(size_tiered_compaction_fanout, advanced);
+TAG_FLAG(size_tiered_compaction_fanout, experimental);
+
+DEFINE_int64(size_tiered_compaction_base_rowset_size, 4 * 1024 * 1024,
+             "The size in bytes below which rowsets belong to the first tier "
+             "when the size-tiered compaction policy is used.");
+TAG_FLAG(size_tiered_compaction_base_rowset_size, advanced);
+TAG_FLAG(size_tiered_compaction_base_rowset_size, experimental);
+
+DEFINE_int64(size_tiered_compaction_max_rowset_size, 1024 * 1024 * 1024,
+             "The target size in bytes for DiskRowSets produced by flushes or "
+             "compactions when the size-tiered compaction policy is used. "
+             "Rowsets of at least this size aren't compacted any further.");
+TAG_FLAG(size_tiered_compaction_max_rowset_size, advanced);
+TAG_FLAG(size_tiered_compaction_max_rowset_size, experimental);
+
+DEFINE_validator(size_tiered_compaction_fanout,
+                 [](const char* /*flagname*/, int32_t value) { return value >= 2; });
+DEFINE_validator(size_tiered_compaction_base_rowset_size,
+                 [](const char* /*flagname*/, int64_t value) { return value > 0; });
+
 namespace kudu {
 namespace tablet {
 
@@ -616,5 +644,113 @@ Status BudgetedCompactionPolicy::PickRowSets(
   return Status::OK();
 }
 
+////////////////////////////////////////////////////////////
+// SizeTieredCompactionPolicy
+////////////////////////////////////////////////////////////
+
+SizeTieredCompactionPolicy::SizeTieredCompactionPolicy()
+    : fanout_(FLAGS_size_tiered_compaction_fanout),
+      base_size_bytes_(FLAGS_size_tiered_compaction_base_rowset_size) {
+}
+
+uint64_t SizeTieredCompactionPolicy::target_rowset_size() const {
+  CHECK_GT(FLAGS_size_tiered_compaction_max_rowset_size, 0);
+  return FLAGS_size_tiered_compaction_max_rowset_size;
+}
+
+int SizeTieredCompactionPolicy::TierOf(uint64_t size_bytes) const {
+  int tier = 0;
+  for (uint64_t tier_max = base_size_bytes_; size_bytes >= tier_max; tier_max *= fanout_) {
+    tier++;
+  }
+  return tier;
+}
+
+Status SizeTieredCompactionPolicy::PickRowSets(
+    const RowSetTree& tree,
+    CompactionSelection* picked,
+    double* quality,
+    std::vector<std::string>* log) {
+  DCHECK(picked);
+  DCHECK(quality);
+  *quality = 0.0;
+
+  vector<RowSetInfo> asc_min_key, asc_max_key;
+  RowSetInfo::ComputeCdfAndCollectOrdered(tree,
+                                          /*is_on_memory_budget=*/std::nullopt,
+                                          /*rowset_total_height=*/nullptr,
+                                          /*rowset_total_width=*/nullptr,
+                                          &asc_min_key,
+                                          &asc_max_key);
+
+  // Group the rowsets which may still grow by tier, in ascending order by min
+  // key.
+  const uint64_t max_size_bytes = target_rowset_size();
+  std::map<int, vector<const RowSetInfo*>> tiers;
+  for (const auto& rsi : asc_min_key) {
+    if (rsi.base_and_redos_size_bytes() < max_size_bytes) {
+      tiers[TierOf(rsi.base_and_redos_size_bytes())].push_back(&rsi);
+    }
+  }
+
+  // Merge rowsets of the smallest tier with enough of them: data is ingested
+  // into the first tier, so it's where the policy keeps the rowset count down.
+  const vector<const RowSetInfo*>* candidates = nullptr;
+  int tier = 0;
+  for (const auto& tier_and_rowsets : tiers) {
+    if (tier_and_rowsets.second.size() >= fanout_) {
+      tier = tier_and_rowsets.first;
+      candidates = &tier_and_rowsets.second;
+      break;
+    }
+  }
+  if (!candidates) {
+    if (log) {
+      LOG_STRING(INFO, log) << "No tier has " << fanout_ << " rowsets to compact";
+    }
+    return Status::OK();
+  }
+
+  // Out of the windows of 'fanout_' consecutive candidates by min key, pick
+  // the one whose compaction reduces the tablet's height the most.
+  double best_height_reduction = -1.0;
+  size_t best_start = 0;
+  for (size_t start = 0; start + fanout_ <= candidates->size(); start++) {
+    double sum_width = 0.0;
+    double union_max = 0.0;
+    for (size_t i = start; i < start + fanout_; i++) {
+      sum_width += (*candidates)[i]->width();
+      union_max = std::max(union_max, (*candidates)[i]->cdf_max_key());
+    }
+    const double height_reduction =
+        sum_width - (union_max - (*candidates)[start]->cdf_min_key());
+    if (height_reduction > best_height_reduction) {
+      best_height_reduction = height_reduction;
+      best_start = start;
+    }
+  }
+
+  for (size_t i = best_start; i < best_start + fanout_; i++) {
+    picked->insert((*candidates)[i]->rowset());
+  }
+  // Besides the reduction in height, account for the fraction of the
+  // tablet's rowsets the compaction gets rid of, so that compactions of
+  // non-overlapping rowsets are worth running too.
+  *quality = std::max(best_height_reduction, 0.0) +
+      static_cast<double>(fanout_ - 1) / asc_min_key.size();
+
+  if (VLOG_IS_ON(1) || log != nullptr) {
+    LOG_STRING(INFO, log) << "Size-tiered compaction selection (tier " << tier << "):";
+    for (const RowSetInfo& cand : asc_min_key) {
+      const char* checkbox = ContainsKey(*picked, cand.rowset()) ? "[x]" : "[ ]";
+      LOG_STRING(INFO, log) << "  " << checkbox << " " << cand.ToString();
+    }
+    LOG_STRING(INFO, log) << "Solution value: " << *quality;
+  }
+
+  DumpCompactionSVGToFile(asc_min_key, *picked);
+  return Status::OK();
+}
+
 } // namespace tablet
 } // namespace kudu
@@ -130,6 +130,37 @@ class BudgetedCompactionPolicy : public CompactionPolicy {
   const TabletMetrics* metrics_;
 };
 
+// A compaction policy that merges rowsets of similar sizes, in tiers of sizes
+// growing by a constant fanout: it picks the smallest tier holding at least
+// 'fanout' rowsets, and merges that many of its most overlapping rowsets
+// into a rowset of the next tier.
+//
+// Unlike BudgetedCompactionPolicy, which may repeatedly rewrite the same data
+// to reduce the tablet's height, every row is rewritten at most once per
+// tier, i.e. about log_fanout(max rowset size / flushed rowset size) times,
+// which bounds the write amplification of ingest-heavy tablets. In exchange,
+// the tablet's height may stay higher between compactions.
+class SizeTieredCompactionPolicy : public CompactionPolicy {
+ public:
+  SizeTieredCompactionPolicy();
+
+  Status PickRowSets(const RowSetTree& tree,
+                     CompactionSelection* picked,
+                     double* quality,
+                     std::vector<std::string>* log) override;
+
+  // Outputs don't roll until they reach the top tier, so that merged rowsets
+  // move up the tiers.
+  uint64_t target_rowset_size() const override;
+
+ private:
+  // Returns the tier of a rowset of 'size_bytes'.
+  int TierOf(uint64_t size_bytes) const;
+
+  const size_t fanout_;
+  const uint64_t base_size_bytes_;
+};
+
 } // namespace tablet
 } // namespace kudu
 #endif
@@ -57,7 +57,10 @@
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/status.h"
 
-//#define TRAVERSE_PREFETCH
+// Define the following to prefetch each node of a traversal as soon as its
+// pointer is found in its parent, so that the fetch of its cache lines overlaps
+// with the validation of the parent's version.
+#define TRAVERSE_PREFETCH
 #define SCAN_PREFETCH
 
 
@@ -74,11 +77,12 @@ namespace btree {
 // This default implementation should be reasonable for most usage.
 struct BTreeTraits {
   enum TraitConstants {
-    // Number of bytes used per internal node.
-    kInternalNodeSize = 4 * CACHELINE_SIZE,
+    // Number of bytes used per internal node. With 16-byte keys, this fits
+    // 15 children, as in Masstree.
+    kInternalNodeSize = 8 * CACHELINE_SIZE,
 
-    // Number of bytes used by a leaf node.
-    kLeafNodeSize = 4 * CACHELINE_SIZE,
+    // Number of bytes used by a leaf node, which fits 15 entries.
+    kLeafNodeSize = 8 * CACHELINE_SIZE,
 
     // Tests can set this trait to a non-zero value, which inserts
     // some pause-loops in key parts of the code to try to simulate
@@ -94,7 +98,7 @@ inline void PrefetchMemory(const T *addr) {
   // prefetch() call with an if statement fixed the errors. In the end, it was decided to add a
   // DCHECK() here, and wrap all uses of PrefetchMemory() with the null pointer guard.
   DCHECK(addr);
-  int size = std::min<int>(sizeof(T), 4 * CACHELINE_SIZE);
+  int size = std::min<int>(sizeof(T), 8 * CACHELINE_SIZE);
 
   for (int i = 0; i < size; i += CACHELINE_SIZE) {
     prefetch(reinterpret_cast<const char *>(addr) + i, PREFETCH_HINT_T0);
@@ -322,14 +326,15 @@ size_t FindInSliceArray(const InlineSlice<N, true> *array, ssize_t num_entries,
     return 0;
   }
 
+  // Long keys are first compared by the prefix stored along with their
+  // pointer, so most comparisons don't follow the pointer.
+  const uint64_t key_prefix = InlineSlice<N, true>::Prefix(key);
   size_t left = 0;
   size_t right = num_entries - 1;
 
   while (left < right) {
     int mid = (left + right + 1) / 2;
-    // TODO: inline slices with more than 8 bytes will store a prefix of the
-    // slice inline, which we could use to short circuit some of these comparisons.
-    int compare = array[mid].as_slice().compare(key);
+    int compare = array[mid].compare(key, key_prefix);
     if (compare < 0) { // mid < key
       left = mid;
     } else if (compare > 0) { // mid > search
@@ -340,7 +345,7 @@ size_t FindInSliceArray(const InlineSlice<N, true> *array, ssize_t num_entries,
     }
   }
 
-  int compare = array[left].as_slice().compare(key);
+  int compare = array[left].compare(key, key_prefix);
   *exact = compare == 0;
   if (compare < 0) { // key > left
     left++;
@@ -657,7 +662,9 @@ class PACKED InternalNode : public NodeBase<Traits> {
     return num_children_ - 1;
   }
 
-  typedef InlineSlice<sizeof(void*), true> KeyInlineSlice;
+  // Room for keys of up to 15 bytes inline, or for a pointer to a longer key
+  // along with its prefix.
+  typedef InlineSlice<sizeof(void*) + sizeof(uint64_t), true> KeyInlineSlice;
 
   enum SpaceConstants {
     constant_overhead = sizeof(NodeBase<Traits>) // base class
@@ -736,6 +743,17 @@ class LeafNode : public NodeBase<Traits> {
     return INSERT_SUCCESS;
   }
 
+  // Replace the value of the existing entry at the given index with
+  // a copy of 'val'.
+  void ReplaceValue(size_t idx, const Slice& val,
+                    typename Traits::ArenaType* arena) {
+    DCHECK(this->IsLocked());
+    DCHECK_LT(idx, num_entries_);
+
+    this->SetInserting();
+    vals_[idx].set(val, arena);
+  }
+
   // Find the index of the first key which is >= the given
   // search key.
   // If the comparison is equal, then sets *exact to true.
@@ -809,8 +827,11 @@ class LeafNode : public NodeBase<Traits> {
   friend class CBTree<Traits>;
   friend class InternalNode<Traits>;
   friend class CBTreeIterator<Traits>;
+  friend class TestCBTree;
 
-  typedef InlineSlice<sizeof(void*), true> KeyInlineSlice;
+  // Room for keys of up to 15 bytes inline, or for a pointer to a longer key
+  // along with its prefix.
+  typedef InlineSlice<sizeof(void*) + sizeof(uint64_t), true> KeyInlineSlice;
 
   // It is necessary to name this enum so that DCHECKs can use its
   // constants (the macros may attempt to specialize templates
@@ -893,6 +914,19 @@ class PreparedMutation {
     return v.as_slice();
   }
 
+  // Replace the existing value with a copy of 'val', allocated from the
+  // tree's arena.
+  //
+  // Unlike updates in place of current_mutable_value(), this doesn't modify
+  // the prior value: readers which got it before keep reading it whole, while
+  // readers which get the value from now on read the new one.
+  void ReplaceValue(const Slice& val) {
+    CHECK(prepared());
+    CHECK(exists());
+    CHECK(!tree_->frozen_);
+    leaf_->ReplaceValue(idx_, val, arena_);
+  }
+
   // Accessors
 
   bool prepared() const {
@@ -1144,6 +1178,7 @@ class CBTree {
  private:
   friend class PreparedMutation<Traits>;
   friend class CBTreeIterator<Traits>;
+  friend class TestCBTree;
 
   DISALLOW_COPY_AND_ASSIGN(CBTree);
 
@@ -1171,11 +1206,6 @@ class CBTree {
     NodeBase<Traits> *node_base = node.base_ptr();
 
     while (node.type() != NodePtr<Traits>::LEAF_NODE) {
-#ifdef TRAVERSE_PREFETCH
-      if (node.internal_node_ptr()) {
-        PrefetchMemory(node.internal_node_ptr());
-      }
-#endif
       retry_in_node:
       int num_children = node.internal_node_ptr()->num_children_;
       NodePtr<Traits> child = node.internal_node_ptr()->FindChild(key);
@@ -1185,6 +1215,13 @@ class CBTree {
 
       if (PREDICT_TRUE(!child.is_null())) {
         child_base = child.base_ptr();
+#ifdef TRAVERSE_PREFETCH
+        if (child.type() == NodePtr<Traits>::LEAF_NODE) {
+          PrefetchMemory(child.leaf_node_ptr());
+        } else {
+          PrefetchMemory(child.internal_node_ptr());
+        }
+#endif
         child_version = child_base->StableVersion();
       }
       AtomicVersion new_node_version = node_base->AcquireVersion();
@@ -1211,11 +1248,6 @@ class CBTree {
       node_base = child_base;
       version = child_version;
     }
-#ifdef TRAVERSE_PREFETCH
-    if (node.leaf_node_ptr()) {
-      PrefetchMemory(node.leaf_node_ptr());
-    }
-#endif
     *stable_version = version;
     return node.leaf_node_ptr();
   }
@@ -1471,6 +1503,24 @@ class CBTree {
   }
 
 
+  // Starts a new, empty right-most leaf after the full right-most leaf
+  // 'node', without moving any of its entries.
+  //
+  // N.B: the new node is initially locked, like in SplitLeafNode().
+  void AppendLeafNode(LeafNode<Traits> *node,
+                      LeafNode<Traits> **new_node) {
+    DCHECK(node->IsLocked());
+    DCHECK(node->next_ == nullptr);
+
+    LeafNode<Traits> *new_leaf = NewLeaf(true);
+
+    // Nothing moves out of the left node, but concurrent readers which didn't
+    // find a key past its end must still retry in the new leaf.
+    node->SetSplitting();
+    node->next_ = new_leaf;
+    *new_node = new_leaf;
+  }
+
   // Splits a leaf node which is full, adding the new sibling
   // node to the tree.
   // This recurses upward splitting internal nodes as necessary.
@@ -1486,6 +1536,22 @@ class CBTree {
 
     //DebugPrint();
 
+    // Keys inserted in increasing order (e.g. time series) always land past
+    // the end of the right-most leaf. Splitting that leaf in half would leave
+    // every leaf but the last half empty, and copy half of its entries on
+    // each split, so the new key starts a new leaf of its own instead.
+    if (node->next_ == nullptr && mutation->idx() == node->num_entries()) {
+      LeafNode<Traits> *new_leaf;
+      AppendLeafNode(node, &new_leaf);
+      DCHECK(new_leaf->IsLocked());
+      new_leaf->PrepareMutation(mutation);
+      CHECK_EQ(INSERT_SUCCESS, new_leaf->Insert(mutation, val))
+        << "new leaf did not have enough space for key "
+        << KUDU_REDACT(key.ToDebugString());
+      PropagateSplitUpward(node, new_leaf, new_leaf->GetKey(0));
+      return true;
+    }
+
     LeafNode<Traits> *new_leaf;
     SplitLeafNode(node, &new_leaf);
 
@@ -1584,9 +1650,13 @@ class CBTree {
     }
   }
 
+  // Nodes are aligned on cache lines so that they span as few of them as
+  // possible. The arena doesn't support alignments of more than 64 bytes.
+  static constexpr size_t kNodeAlignment = std::min<size_t>(CACHELINE_SIZE, 64);
+
   LeafNode<Traits> *NewLeaf(bool locked) {
     void *mem = CHECK_NOTNULL(arena_->AllocateBytesAligned(sizeof(LeafNode<Traits>),
-                                                           sizeof(AtomicVersion)));
+                                                           kNodeAlignment));
     return new (mem) LeafNode<Traits>(locked);
   }
 
@@ -1594,7 +1664,7 @@ class CBTree {
                                         NodePtr<Traits> lchild,
                                         NodePtr<Traits> rchild) {
     void *mem = CHECK_NOTNULL(arena_->AllocateBytesAligned(sizeof(InternalNode<Traits>),
-                                                           sizeof(AtomicVersion)));
+                                                           kNodeAlignment));
     return new (mem) InternalNode<Traits>(split_key, lchild, rchild, arena_.get());
   }
 
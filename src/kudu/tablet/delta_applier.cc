@@ -30,6 +30,7 @@
 #include "kudu/tablet/delta_store.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/util/status.h"
+#include "kudu/util/trace.h"
 
 using std::shared_ptr;
 using std::string;
@@ -43,6 +44,8 @@ struct IteratorStats;
 
 namespace tablet {
 
+const char* DELTA_APPLY_NANOS_METRIC_NAME = "delta_apply_nanos";
+
 // Construct. The base_iter and delta_iter should not be Initted.
 DeltaApplier::DeltaApplier(RowIteratorOptions opts,
                            shared_ptr<CFileSet::Iterator> base_iter,
@@ -124,6 +127,7 @@ Status DeltaApplier::InitializeSelectionVector(SelectionVector* sel_vec) {
     RETURN_NOT_OK(base_iter_->InitializeSelectionVector(sel_vec));
   }
   if (!opts_.include_deleted_rows) {
+    TRACE_COUNTER_SCOPE_LATENCY_NS(DELTA_APPLY_NANOS_METRIC_NAME);
     RETURN_NOT_OK(delta_iter_->ApplyDeletes(sel_vec));
   }
   return Status::OK();
@@ -135,6 +139,7 @@ Status DeltaApplier::MaterializeColumn(ColumnMaterializationContext* ctx) {
   if (delta_iter_->MayHaveDeltas()) {
     ctx->SetDecoderEvalNotSupported();
     RETURN_NOT_OK(base_iter_->MaterializeColumn(ctx));
+    TRACE_COUNTER_SCOPE_LATENCY_NS(DELTA_APPLY_NANOS_METRIC_NAME);
     RETURN_NOT_OK(delta_iter_->ApplyUpdates(ctx->col_idx(), ctx->block(), *ctx->sel()));
   } else {
     RETURN_NOT_OK(base_iter_->MaterializeColumn(ctx));
@@ -322,13 +322,9 @@ Status DeltaPreparer<Traits>::AddDelta(const DeltaKey& key, Slice val, bool* fin
 
         ColumnUpdate& cu = updates_by_col_[col_idx].back();
         cu.row_id = key.row_idx();
-        if (col_val == nullptr) {
-          cu.new_val_ptr = nullptr;
-        } else {
+        cu.is_null = col_val == nullptr;
+        if (!cu.is_null) {
           memcpy(cu.new_val_buf, col_val, col_size);
-          // NOTE: we're constructing a pointer here to an element inside the deque.
-          // This is safe because deques never invalidate pointers to their elements.
-          cu.new_val_ptr = cu.new_val_buf;
         }
         may_have_deltas_ = true;
       }
@@ -383,14 +379,43 @@ Status DeltaPreparer<Traits>::ApplyUpdates(size_t col_to_apply, ColumnBlock* dst
     return Status::OK();
   }
 
+  const UpdatesForColumn& updates = updates_by_col_[col_to_apply];
+  if (updates.empty() || !filter.AnySelected()) {
+    return Status::OK();
+  }
+
+  // Cells without indirect data are written in place, with a copy of their
+  // size known at compile time.
   const ColumnSchema* col_schema = &opts_.projection->column(col_to_apply);
-  for (const ColumnUpdate& cu : updates_by_col_[col_to_apply]) {
+  if (col_schema->type_info()->physical_type() != BINARY) {
+    switch (col_schema->type_info()->size()) {
+      case 1:
+        ApplyFixedSizeUpdates<1>(updates, prev_prepared_idx_, dst, filter);
+        return Status::OK();
+      case 2:
+        ApplyFixedSizeUpdates<2>(updates, prev_prepared_idx_, dst, filter);
+        return Status::OK();
+      case 4:
+        ApplyFixedSizeUpdates<4>(updates, prev_prepared_idx_, dst, filter);
+        return Status::OK();
+      case 8:
+        ApplyFixedSizeUpdates<8>(updates, prev_prepared_idx_, dst, filter);
+        return Status::OK();
+      case 16:
+        ApplyFixedSizeUpdates<16>(updates, prev_prepared_idx_, dst, filter);
+        return Status::OK();
+      default:
+        break;
+    }
+  }
+
+  for (const ColumnUpdate& cu : updates) {
     int32_t idx_in_block = cu.row_id - prev_prepared_idx_;
     DCHECK_GE(idx_in_block, 0);
     if (!filter.IsRowSelected(idx_in_block)) {
       continue;
     }
-    SimpleConstCell src(col_schema, cu.new_val_ptr);
+    SimpleConstCell src(col_schema, cu.is_null ? nullptr : cu.new_val_buf);
     ColumnBlock::Cell dst_cell = dst->cell(idx_in_block);
     RETURN_NOT_OK(CopyCell(src, &dst_cell, dst->arena()));
   }
@@ -398,6 +423,35 @@ Status DeltaPreparer<Traits>::ApplyUpdates(size_t col_to_apply, ColumnBlock* dst
   return Status::OK();
 }
 
+template<class Traits>
+template<size_t kSize>
+void DeltaPreparer<Traits>::ApplyFixedSizeUpdates(const UpdatesForColumn& updates,
+                                                  rowid_t first_row_id,
+                                                  ColumnBlock* dst,
+                                                  const SelectionVector& filter) {
+  DCHECK_EQ(kSize, dst->stride());
+  uint8_t* data = dst->data();
+  if (!dst->is_nullable()) {
+    for (const ColumnUpdate& cu : updates) {
+      const size_t idx_in_block = cu.row_id - first_row_id;
+      DCHECK(!cu.is_null);
+      if (filter.IsRowSelected(idx_in_block)) {
+        memcpy(data + idx_in_block * kSize, cu.new_val_buf, kSize);
+      }
+    }
+    return;
+  }
+  for (const ColumnUpdate& cu : updates) {
+    const size_t idx_in_block = cu.row_id - first_row_id;
+    if (filter.IsRowSelected(idx_in_block)) {
+      dst->SetCellIsNull(idx_in_block, cu.is_null);
+      if (!cu.is_null) {
+        memcpy(data + idx_in_block * kSize, cu.new_val_buf, kSize);
+      }
+    }
+  }
+}
+
 template<class Traits>
 Status DeltaPreparer<Traits>::ApplyDeletes(SelectionVector* sel_vec) {
   DCHECK(prepared_flags_ & DeltaIterator::PREPARE_FOR_APPLY);
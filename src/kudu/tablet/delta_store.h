@@ -501,6 +501,14 @@ class DeltaPreparer : public PreparedDeltas {
   // Update the deletion state of the current row being processed based on 'op'.
   void UpdateDeletionState(RowChangeList::ChangeType op);
 
+  // Writes the values of 'updates' to the cells of 'dst' selected by 'filter',
+  // for a column whose cells are 'kSize' bytes and have no indirect data.
+  template<size_t kSize>
+  static void ApplyFixedSizeUpdates(const UpdatesForColumn& updates,
+                                    rowid_t first_row_id,
+                                    ColumnBlock* dst,
+                                    const SelectionVector& filter);
+
   // Options with which the DeltaPreparer's iterator was constructed.
   const RowIteratorOptions opts_;
 
@@ -518,12 +526,15 @@ class DeltaPreparer : public PreparedDeltas {
 
   // State when prepared_flags_ & PREPARED_FOR_APPLY
   // ------------------------------------------------------------
+  //
+  // The updates are grouped per column into arrays of (row_id, value) sorted
+  // by row_id, so that they're applied to a ColumnBlock one column at a time.
   struct ColumnUpdate {
     rowid_t row_id;
-    void* new_val_ptr;
+    bool is_null;
     uint8_t new_val_buf[16];
   };
-  typedef std::deque<ColumnUpdate> UpdatesForColumn;
+  typedef std::vector<ColumnUpdate> UpdatesForColumn;
   std::vector<UpdatesForColumn> updates_by_col_;
 
   // A row whose last relevant mutation was DELETE (or REINSERT).
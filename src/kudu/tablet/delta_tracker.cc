@@ -44,6 +44,7 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/compaction.h"
 #include "kudu/tablet/delta_applier.h"
 #include "kudu/tablet/delta_iterator_merger.h"
 #include "kudu/tablet/delta_stats.h"
@@ -137,6 +138,7 @@ Status DeltaTracker::OpenDeltaReaders(vector<DeltaBlockIdAndStats> blocks,
     shared_ptr<DeltaFileReader> dfr;
     ReaderOptions options;
     options.parent_mem_tracker = mem_trackers_.tablet_tracker;
+    options.block_cache_attribution = mem_trackers_.block_cache_attribution;
     options.io_context = io_context;
     s = DeltaFileReader::OpenNoInit(std::move(block),
                                     type,
@@ -504,6 +506,22 @@ bool DeltaTracker::EstimateAllRedosAreAncient(Timestamp ancient_history_mark) {
       newest_redo->delta_stats().max_timestamp() < ancient_history_mark;
 }
 
+bool DeltaTracker::EstimateNoRedosSince(Timestamp timestamp) {
+  shared_ptr<DeltaStore> newest_redo;
+  std::lock_guard<rw_spinlock> lock(component_lock_);
+  const std::optional<Timestamp> dms_highest_timestamp =
+      dms_ ? dms_->highest_timestamp() : std::nullopt;
+  if (dms_highest_timestamp) {
+    return *dms_highest_timestamp < timestamp;
+  }
+  if (redo_delta_stores_.empty()) {
+    return true;
+  }
+  newest_redo = redo_delta_stores_.back();
+  return newest_redo->has_delta_stats() &&
+      newest_redo->delta_stats().max_timestamp() < timestamp;
+}
+
 Status DeltaTracker::EstimateBytesInPotentiallyAncientUndoDeltas(
     Timestamp ancient_history_mark,
     RowSet::EstimateType estimate_type,
@@ -775,6 +793,7 @@ Status DeltaTracker::CheckRowDeleted(rowid_t row_idx, const IOContext* io_contex
 
 Status DeltaTracker::FlushDMS(DeltaMemStore* dms,
                               const IOContext* io_context,
+                              const HistoryGcOpts& history_gc_opts,
                               shared_ptr<DeltaFileReader>* dfr,
                               MetadataFlushType flush_type) {
   // Open file for write.
@@ -790,7 +809,7 @@ Status DeltaTracker::FlushDMS(DeltaMemStore* dms,
                         Substitute("Unable to start writing to delta block $0",
                                    block_id.ToString()));
 
-  RETURN_NOT_OK(dms->FlushToFile(&dfw));
+  RETURN_NOT_OK(dms->FlushToFile(&dfw, history_gc_opts));
   RETURN_NOT_OK(dfw.Finish());
   unique_ptr<DeltaStats> stats = dfw.release_delta_stats();
   const auto bytes_written = dfw.written_size();
@@ -809,6 +828,7 @@ Status DeltaTracker::FlushDMS(DeltaMemStore* dms,
   RETURN_NOT_OK(fs->OpenBlock(block_id, &readable_block));
   ReaderOptions options;
   options.parent_mem_tracker = mem_trackers_.tablet_tracker;
+  options.block_cache_attribution = mem_trackers_.block_cache_attribution;
   options.io_context = io_context;
   RETURN_NOT_OK(DeltaFileReader::OpenNoInit(std::move(readable_block),
                                             REDO,
@@ -835,6 +855,12 @@ Status DeltaTracker::FlushDMS(DeltaMemStore* dms,
 }
 
 Status DeltaTracker::Flush(const IOContext* io_context, MetadataFlushType flush_type) {
+  return Flush(io_context, HistoryGcOpts::Disabled(), flush_type);
+}
+
+Status DeltaTracker::Flush(const IOContext* io_context,
+                           const HistoryGcOpts& history_gc_opts,
+                           MetadataFlushType flush_type) {
   std::lock_guard<Mutex> l(compact_flush_lock_);
   RETURN_NOT_OK(CheckWritableUnlocked());
 
@@ -873,7 +899,7 @@ Status DeltaTracker::Flush(const IOContext* io_context, MetadataFlushType flush_
   // TODO(todd): need another lock to prevent concurrent flushers
   // at some point.
   shared_ptr<DeltaFileReader> dfr;
-  Status s = FlushDMS(old_dms.get(), io_context, &dfr, flush_type);
+  Status s = FlushDMS(old_dms.get(), io_context, history_gc_opts, &dfr, flush_type);
   if (PREDICT_FALSE(!s.ok())) {
     // A failure here leaves a DeltaMemStore permanently in the store list.
     // This isn't allowed, and rolling back the store is difficult, so we leave
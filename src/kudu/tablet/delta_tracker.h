@@ -65,6 +65,7 @@ namespace tablet {
 
 class DeltaFileReader;
 class DeltaMemStore;
+class HistoryGcOpts;
 class OperationResultPB;
 class RowSetMetadata;
 class RowSetMetadataUpdate;
@@ -135,6 +136,12 @@ class DeltaTracker {
   // delta stores might become unrecoverable.
   Status Flush(const fs::IOContext* io_context, MetadataFlushType flush_type);
 
+  // Same as above, but the ancient updates of each row, per 'history_gc_opts',
+  // are coalesced in the flushed delta file.
+  Status Flush(const fs::IOContext* io_context,
+               const HistoryGcOpts& history_gc_opts,
+               MetadataFlushType flush_type);
+
   // Update the given row in the database.
   // Copies the data, as well as any referenced values into a local arena.
   // "result" tracks the status of the update as well as which data
@@ -186,6 +193,11 @@ class DeltaTracker {
   // initted, this will return a false negative.
   bool EstimateAllRedosAreAncient(Timestamp ancient_history_mark);
 
+  // Returns whether there are no redos (DMS or newest redo delta file) at or
+  // after 'timestamp'. Like EstimateAllRedosAreAncient(), this returns a false
+  // negative if the newest redo file has not yet been initted.
+  bool EstimateNoRedosSince(Timestamp timestamp);
+
   // See RowSet::InitUndoDeltas().
   Status InitUndoDeltas(Timestamp ancient_history_mark,
                         MonoTime deadline,
@@ -310,6 +322,7 @@ class DeltaTracker {
 
   Status FlushDMS(DeltaMemStore* dms,
                   const fs::IOContext* io_context,
+                  const HistoryGcOpts& history_gc_opts,
                   std::shared_ptr<DeltaFileReader>* dfr,
                   MetadataFlushType flush_type);
 
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -62,6 +63,7 @@
 #include "kudu/util/test_util.h"
 
 DECLARE_int32(deltafile_default_block_size);
+DECLARE_uint32(deltafile_undo_timestamp_index_rows_per_range);
 DEFINE_int32(first_row_to_update, 10000, "the first row to update");
 DEFINE_int32(last_row_to_update, 100000, "the last row to update");
 DEFINE_int32(n_verify, 1, "number of times to verify the updates"
@@ -395,6 +397,110 @@ TEST_F(TestDeltaFile, TestLazyInit) {
   ASSERT_EQ(bytes_read_after_init, bytes_read);
 }
 
+// A delta file which updates none of the projected columns isn't read when
+// its deltas are only prepared for applying.
+TEST_F(TestDeltaFile, TestSkipsDeltasForUnprojectedColumns) {
+  WriteTestFile();
+
+  for (bool projects_updated_column : { false, true }) {
+    SCOPED_TRACE(projects_updated_column);
+    unique_ptr<ReadableBlock> block;
+    ASSERT_OK(fs_manager_->OpenBlock(test_block_, &block));
+    size_t bytes_read = 0;
+    unique_ptr<ReadableBlock> count_block(
+        new CountingReadableBlock(std::move(block), &bytes_read));
+    shared_ptr<DeltaFileReader> reader;
+    ASSERT_OK(DeltaFileReader::Open(std::move(count_block), REDO, ReaderOptions(), &reader));
+
+    const Schema other_col_projection({ ColumnSchema("other", UINT32) },
+                                      { ColumnId(1000) }, 0);
+    RowIteratorOptions opts;
+    opts.snap_to_include = MvccSnapshot::CreateSnapshotIncludingAllOps();
+    opts.projection = projects_updated_column ? &schema_ : &other_col_projection;
+    unique_ptr<DeltaIterator> it;
+    ASSERT_OK(reader->NewDeltaIterator(opts, &it));
+    ASSERT_OK(it->Init(nullptr));
+    ASSERT_OK(it->SeekToOrdinal(FLAGS_first_row_to_update));
+    const size_t bytes_read_after_seek = bytes_read;
+
+    ASSERT_OK(it->PrepareBatch(100, DeltaIterator::PREPARE_FOR_APPLY));
+    ASSERT_EQ(projects_updated_column, it->MayHaveDeltas());
+    ASSERT_EQ(projects_updated_column, bytes_read > bytes_read_after_seek);
+  }
+}
+
+// Batches of rows whose UNDO deltas all precede the snapshot of a scan aren't
+// read from a delta file when prepared for applying.
+TEST_F(TestDeltaFile, TestSkipsUndosPrecedingSnapshot) {
+  FLAGS_deltafile_default_block_size = 256;
+  FLAGS_deltafile_undo_timestamp_index_rows_per_range = 100;
+
+  // Every row is updated at timestamp 10, and rows 5000 to 5009 again later.
+  unique_ptr<WritableBlock> block;
+  ASSERT_OK(fs_manager_->CreateNewBlock({}, &block));
+  test_block_ = block->id();
+  {
+    DeltaFileWriter dfw(std::move(block));
+    ASSERT_OK(dfw.Start());
+    unique_ptr<DeltaStats> stats(new DeltaStats);
+    faststring buf;
+    for (uint32_t i = 0; i < 10000; i++) {
+      for (int timestamp : { 100, 10 }) {
+        if (timestamp == 100 && (i < 5000 || i >= 5010)) {
+          continue;
+        }
+        buf.clear();
+        RowChangeListEncoder update(&buf);
+        uint32_t new_val = i + timestamp;
+        update.AddColumnUpdate(schema_.column(0), schema_.column_id(0), &new_val);
+        DeltaKey key(i, Timestamp(timestamp));
+        RowChangeList rcl(buf);
+        ASSERT_OK_FAST(dfw.AppendDelta<UNDO>(key, rcl));
+        ASSERT_OK_FAST(stats->UpdateStats(key.timestamp(), rcl));
+      }
+    }
+    dfw.WriteDeltaStats(std::move(stats));
+    ASSERT_OK(dfw.Finish());
+  }
+
+  ASSERT_OK(fs_manager_->OpenBlock(test_block_, &block));
+  size_t bytes_read = 0;
+  unique_ptr<ReadableBlock> count_block(
+      new CountingReadableBlock(std::move(block), &bytes_read));
+  shared_ptr<DeltaFileReader> reader;
+  ASSERT_OK(DeltaFileReader::Open(std::move(count_block), UNDO, ReaderOptions(), &reader));
+
+  RowIteratorOptions opts;
+  opts.snap_to_include = MvccSnapshot(Timestamp(50));
+  opts.projection = &schema_;
+  unique_ptr<DeltaIterator> it;
+  ASSERT_OK(reader->NewDeltaIterator(opts, &it));
+  ASSERT_OK(it->Init(nullptr));
+  ASSERT_OK(it->SeekToOrdinal(4800));
+
+  RowBlockMemory mem;
+  RowBlock row_block(&schema_, 100, &mem);
+  for (uint32_t start_row = 4800; start_row < 5300; start_row += row_block.nrows()) {
+    SCOPED_TRACE(start_row);
+    row_block.ZeroMemory();
+    const size_t bytes_read_before = bytes_read;
+    ASSERT_OK(it->PrepareBatch(row_block.nrows(), DeltaIterator::PREPARE_FOR_APPLY));
+    const bool has_undos_to_apply = start_row == 5000;
+    ASSERT_EQ(has_undos_to_apply, bytes_read > bytes_read_before);
+    ASSERT_EQ(has_undos_to_apply, it->MayHaveDeltas());
+
+    SelectionVector sv(row_block.nrows());
+    sv.SetAllTrue();
+    ColumnBlock dst_col = row_block.column_block(0);
+    ASSERT_OK(it->ApplyUpdates(0, &dst_col, sv));
+    for (int i = 0; i < row_block.nrows(); i++) {
+      const uint32_t row = start_row + i;
+      const uint32_t expected_val = (row >= 5000 && row < 5010) ? row + 100 : 0;
+      ASSERT_EQ(expected_val, *schema_.ExtractColumnFromRow<UINT32>(row_block.row(i), 0));
+    }
+  }
+}
+
 // Check that, if a delta file is opened but no deltas are written,
 // Finish() will return Status::Aborted().
 TEST_F(TestDeltaFile, TestEmptyFileIsAborted) {
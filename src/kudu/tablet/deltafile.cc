@@ -17,6 +17,7 @@
 
 #include "kudu/tablet/deltafile.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <ostream>
@@ -63,6 +64,13 @@ DEFINE_string(deltafile_default_compression_codec, "lz4",
               "The compression codec used when writing deltafiles.");
 TAG_FLAG(deltafile_default_compression_codec, experimental);
 
+DEFINE_uint32(deltafile_undo_timestamp_index_rows_per_range, 1024,
+              "Number of rows of the ranges for which the UNDO delta files record the max "
+              "timestamp of their deltas, so that scans of older snapshots skip the ranges "
+              "whose deltas all precede their snapshot. 0 disables the index.");
+TAG_FLAG(deltafile_undo_timestamp_index_rows_per_range, advanced);
+TAG_FLAG(deltafile_undo_timestamp_index_rows_per_range, experimental);
+
 
 using kudu::cfile::BinaryPlainBlockDecoder;
 using kudu::cfile::BlockPointer;
@@ -87,10 +95,12 @@ class MemTracker;
 namespace tablet {
 
 const char* const DeltaFileReader::kDeltaStatsEntryName = "deltafilestats";
+const char* const DeltaFileReader::kTimestampIndexEntryName = "deltafiletsindex";
 
 DeltaFileWriter::DeltaFileWriter(unique_ptr<WritableBlock> block)
+    : rows_per_range_(FLAGS_deltafile_undo_timestamp_index_rows_per_range)
 #ifndef NDEBUG
-   : has_appended_(false)
+      , has_appended_(false)
 #endif
 { // NOLINT(*)
   cfile::WriterOptions opts;
@@ -141,9 +151,32 @@ Status DeltaFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transact
   if (writer_->written_value_count() == 0) {
     return Status::Aborted("no deltas written");
   }
+  if (!range_max_timestamps_.empty()) {
+    DeltaTimestampIndexPB index_pb;
+    index_pb.set_rows_per_range(rows_per_range_);
+    for (const auto& range : range_max_timestamps_) {
+      index_pb.add_range_idx(range.first);
+      index_pb.add_max_timestamp(range.second.ToUint64());
+    }
+    faststring buf;
+    pb_util::SerializeToString(index_pb, &buf);
+    writer_->AddMetadataPair(DeltaFileReader::kTimestampIndexEntryName, buf.ToString());
+  }
   return writer_->FinishAndReleaseBlock(transaction);
 }
 
+void DeltaFileWriter::UpdateTimestampIndex(const DeltaKey& key) {
+  if (rows_per_range_ == 0) {
+    return;
+  }
+  const uint32_t range_idx = key.row_idx() / rows_per_range_;
+  if (range_max_timestamps_.empty() || range_max_timestamps_.back().first != range_idx) {
+    range_max_timestamps_.emplace_back(range_idx, key.timestamp());
+  } else if (range_max_timestamps_.back().second < key.timestamp()) {
+    range_max_timestamps_.back().second = key.timestamp();
+  }
+}
+
 Status DeltaFileWriter::DoAppendDelta(const DeltaKey &key,
                                       const RowChangeList &delta) {
   Slice delta_slice(delta.slice());
@@ -193,6 +226,7 @@ Status DeltaFileWriter::AppendDelta<UNDO>(
   last_key_ = key;
 #endif
 
+  UpdateTimestampIndex(key);
   return DoAppendDelta(key, delta);
 }
 
@@ -254,7 +288,8 @@ DeltaFileReader::DeltaFileReader(unique_ptr<CFileReader> cf_reader,
                                  DeltaType delta_type)
     : reader_(cf_reader.release()),
       delta_stats_(std::move(delta_stats)),
-      delta_type_(delta_type) {}
+      delta_type_(delta_type),
+      rows_per_range_(0) {}
 
 Status DeltaFileReader::Init(const IOContext* io_context) {
   return init_once_.Init([this, io_context] { return InitOnce(io_context); });
@@ -274,9 +309,61 @@ Status DeltaFileReader::InitOnce(const IOContext* io_context) {
   if (!has_delta_stats()) {
     RETURN_NOT_OK(ReadDeltaStats());
   }
+  if (delta_type_ == UNDO) {
+    RETURN_NOT_OK(ReadTimestampIndex());
+  }
   return Status::OK();
 }
 
+Status DeltaFileReader::ReadTimestampIndex() {
+  string index_pb_buf;
+  if (!reader_->GetMetadataEntry(kTimestampIndexEntryName, &index_pb_buf)) {
+    // The file was written without an index.
+    return Status::OK();
+  }
+
+  DeltaTimestampIndexPB index_pb;
+  if (!index_pb.ParseFromString(index_pb_buf)) {
+    return Status::Corruption("unable to parse the delta timestamp index protobuf");
+  }
+  if (index_pb.rows_per_range() == 0 ||
+      index_pb.range_idx_size() != index_pb.max_timestamp_size()) {
+    return Status::Corruption("invalid delta timestamp index",
+                              pb_util::SecureShortDebugString(index_pb));
+  }
+  rows_per_range_ = index_pb.rows_per_range();
+  range_max_timestamps_.reserve(index_pb.range_idx_size());
+  for (int i = 0; i < index_pb.range_idx_size(); i++) {
+    range_max_timestamps_.emplace_back(index_pb.range_idx(i),
+                                       Timestamp(index_pb.max_timestamp(i)));
+  }
+  return Status::OK();
+}
+
+bool DeltaFileReader::MayHaveUndosToApply(rowid_t start_row, rowid_t stop_row,
+                                          const MvccSnapshot& snap) const {
+  DCHECK(init_once_.init_succeeded());
+  DCHECK_EQ(UNDO, delta_type_);
+  if (rows_per_range_ == 0) {
+    return true;
+  }
+  const uint32_t start_range = start_row / rows_per_range_;
+  const uint32_t stop_range = stop_row / rows_per_range_;
+  auto it = std::lower_bound(
+      range_max_timestamps_.begin(), range_max_timestamps_.end(), start_range,
+      [](const std::pair<uint32_t, Timestamp>& range, uint32_t range_idx) {
+        return range.first < range_idx;
+      });
+  for (; it != range_max_timestamps_.end() && it->first <= stop_range; ++it) {
+    // All the deltas of the range are older than its max timestamp, so none
+    // of them is to be applied if all such ops are applied in the snapshot.
+    if (snap.MayHaveNonAppliedOpsAtOrBefore(it->second)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Status DeltaFileReader::ReadDeltaStats() {
   string filestats_pb_buf;
   if (!reader_->GetMetadataEntry(kDeltaStatsEntryName, &filestats_pb_buf)) {
@@ -424,6 +511,8 @@ DeltaFileIterator<Type>::DeltaFileIterator(shared_ptr<DeltaFileReader> dfr,
       prepared_(false),
       exhausted_(false),
       initted_(false),
+      may_have_deltas_for_apply_(true),
+      needs_index_seek_(false),
       cache_blocks_(CFileReader::CACHE_BLOCK),
       delta_blocks_mem_size_(0) {
 }
@@ -460,6 +549,16 @@ Status DeltaFileIterator<Type>::SeekToOrdinal(rowid_t idx) {
     return Status::OK();
   }
 
+  // The delta stats tell which columns the file updates, so a scan needn't
+  // decode the file's deltas if it projects none of them.
+  const DeltaStats& stats = dfr_->delta_stats();
+  const Schema* projection = preparer_.opts().projection;
+  may_have_deltas_for_apply_ = stats.delete_count() > 0 || stats.reinsert_count() > 0 ||
+                               !projection->has_column_ids();
+  for (size_t i = 0; !may_have_deltas_for_apply_ && i < projection->num_columns(); i++) {
+    may_have_deltas_for_apply_ = stats.update_count_for_col_id(projection->column_id(i)) > 0;
+  }
+
   if (!index_iter_) {
     index_iter_.reset(IndexTreeIterator::Create(
         preparer_.opts().io_context,
@@ -467,6 +566,14 @@ Status DeltaFileIterator<Type>::SeekToOrdinal(rowid_t idx) {
         dfr_->cfile_reader()->validx_root()));
   }
 
+  RETURN_NOT_OK(SeekIndexToRow(idx));
+  preparer_.Seek(idx);
+  prepared_ = false;
+  return Status::OK();
+}
+
+template<DeltaType Type>
+Status DeltaFileIterator<Type>::SeekIndexToRow(rowid_t idx) {
   tmp_buf_.clear();
   DeltaKey(idx, Timestamp(0)).EncodeTo(&tmp_buf_);
   Slice key_slice(tmp_buf_);
@@ -482,11 +589,10 @@ Status DeltaFileIterator<Type>::SeekToOrdinal(rowid_t idx) {
   }
   RETURN_NOT_OK(s);
 
-  preparer_.Seek(idx);
-  prepared_ = false;
   delta_blocks_.clear();
   delta_blocks_mem_size_ = 0;
   exhausted_ = false;
+  needs_index_seek_ = false;
   return Status::OK();
 }
 
@@ -555,9 +661,34 @@ Status DeltaFileIterator<Type>::PrepareBatch(size_t nrows, int prepare_flags) {
 
   CHECK_GT(nrows, 0);
 
+  if (prepare_flags == PREPARE_FOR_APPLY && !may_have_deltas_for_apply_) {
+    TRACE_COUNTER_INCREMENT("delta_batches_skipped_by_column", 1);
+    prepared_ = true;
+    preparer_.Start(nrows, prepare_flags);
+    preparer_.Finish(nrows);
+    return Status::OK();
+  }
+
   rowid_t start_row = preparer_.cur_prepared_idx();
   rowid_t stop_row = start_row + nrows - 1;
 
+  // Scans of older snapshots needn't read the UNDO deltas of the rows which
+  // weren't mutated since their snapshot.
+  if (Type == UNDO && prepare_flags == PREPARE_FOR_APPLY &&
+      !dfr_->MayHaveUndosToApply(start_row, stop_row, preparer_.opts().snap_to_include)) {
+    TRACE_COUNTER_INCREMENT("delta_batches_skipped_by_timestamp", 1);
+    needs_index_seek_ = HasNext();
+    delta_blocks_.clear();
+    delta_blocks_mem_size_ = 0;
+    prepared_ = true;
+    preparer_.Start(nrows, prepare_flags);
+    preparer_.Finish(nrows);
+    return Status::OK();
+  }
+  if (needs_index_seek_) {
+    RETURN_NOT_OK(SeekIndexToRow(start_row));
+  }
+
   // Remove blocks from our list which are no longer relevant to the range
   // being prepared.
   while (!delta_blocks_.empty() &&
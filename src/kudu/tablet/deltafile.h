@@ -35,6 +35,7 @@
 #include "kudu/cfile/cfile_reader.h"
 #include "kudu/cfile/cfile_writer.h"
 #include "kudu/common/rowid.h"
+#include "kudu/common/timestamp.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -117,6 +118,9 @@ class DeltaFileWriter {
  private:
   Status DoAppendDelta(const DeltaKey &key, const RowChangeList &delta);
 
+  // Accounts for the UNDO delta with the given key in 'range_max_timestamps_'.
+  void UpdateTimestampIndex(const DeltaKey& key);
+
   std::unique_ptr<DeltaStats> delta_stats_;
   std::unique_ptr<cfile::CFileWriter> writer_;
 
@@ -124,6 +128,14 @@ class DeltaFileWriter {
   // of the deltas
   faststring tmp_buf_;
 
+  // The number of rows of the ranges of the timestamp index, or 0 if no index
+  // is written.
+  const uint32_t rows_per_range_;
+
+  // The ranges of rows with UNDO deltas, in ascending order, along with the
+  // max timestamp of their deltas. Written to the file as its timestamp index.
+  std::vector<std::pair<uint32_t, Timestamp>> range_max_timestamps_;
+
   #ifndef NDEBUG
   // The index of the previously written row.
   // This is used in debug mode to make sure that rows are appended
@@ -139,6 +151,7 @@ class DeltaFileReader : public DeltaStore,
                         public std::enable_shared_from_this<DeltaFileReader> {
  public:
   static const char * const kDeltaStatsEntryName;
+  static const char * const kTimestampIndexEntryName;
 
   // Fully open a delta file using a previously opened block.
   //
@@ -200,6 +213,13 @@ class DeltaFileReader : public DeltaStore,
   bool IsRelevantForSnapshots(const std::optional<MvccSnapshot>& snap_to_exclude,
                               const MvccSnapshot& snap_to_include) const;
 
+  // Returns true if this UNDO delta file may include deltas for the rows
+  // 'start_row' through 'stop_row' which need to be applied when scanning
+  // 'snap', i.e. unless its timestamp index tells they all precede 'snap'.
+  // The file must be initialized.
+  bool MayHaveUndosToApply(rowid_t start_row, rowid_t stop_row,
+                           const MvccSnapshot& snap) const;
+
   // Clone this DeltaFileReader for testing and validation purposes (such as
   // while in DEBUG mode). The resulting object will not be Initted().
   Status CloneForDebugging(FsManager* fs_manager,
@@ -225,6 +245,9 @@ class DeltaFileReader : public DeltaStore,
 
   Status ReadDeltaStats();
 
+  // Reads the timestamp index of the file, if any, into 'range_max_timestamps_'.
+  Status ReadTimestampIndex();
+
   std::shared_ptr<cfile::CFileReader> reader_;
 
   // TODO(awong): it'd be nice to not heap-allocate this and other usages of
@@ -235,6 +258,13 @@ class DeltaFileReader : public DeltaStore,
   // The type of this delta, i.e. UNDO or REDO.
   const DeltaType delta_type_;
 
+  // The timestamp index of an UNDO delta file, read on initialization: the
+  // ranges of rows with deltas, in ascending order, along with the max
+  // timestamp of their deltas. Empty if the file has no such index, e.g. if
+  // written before the index was introduced.
+  uint32_t rows_per_range_;
+  std::vector<std::pair<uint32_t, Timestamp>> range_max_timestamps_;
+
   KuduOnceLambda init_once_;
 };
 
@@ -342,6 +372,10 @@ class DeltaFileIterator : public DeltaIterator {
   // onto the end of the delta_blocks_ queue.
   Status ReadCurrentBlockOntoQueue();
 
+  // Positions 'index_iter_' on the block containing the first deltas of row
+  // 'idx', discarding the queued blocks.
+  Status SeekIndexToRow(rowid_t idx);
+
   Status AddDeltas(rowid_t start_row, rowid_t stop_row);
 
   // Log a FATAL error message about a bad delta.
@@ -358,6 +392,17 @@ class DeltaFileIterator : public DeltaIterator {
   bool exhausted_;
   bool initted_;
 
+  // Whether the delta file may have deltas to apply to the projection, i.e.
+  // updates to a projected column or deletes and reinserts. Set from the
+  // delta stats on SeekToOrdinal(). If not, PrepareBatch() doesn't read any
+  // block for batches prepared only for applying.
+  bool may_have_deltas_for_apply_;
+
+  // Whether PrepareBatch() skipped reading blocks thanks to the timestamp
+  // index of the file, in which case 'index_iter_' must be positioned anew
+  // before reading the blocks of the next batch.
+  bool needs_index_seek_;
+
   // After PrepareBatch(), the set of delta blocks in the delta file
   // which correspond to prepared_block_.
   std::deque<PreparedDeltaBlock> delta_blocks_;
@@ -51,6 +51,7 @@
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/compaction.h"
 #include "kudu/tablet/delta_key.h"
 #include "kudu/tablet/delta_stats.h"
 #include "kudu/tablet/delta_store.h"
@@ -214,13 +215,53 @@ TEST_F(TestDeltaMemStore, TestUpdateCount) {
   ASSERT_OK(fs.CreateNewBlock({}, &block));
   DeltaFileWriter dfw(std::move(block));
   ASSERT_OK(dfw.Start());
-  dms_->FlushToFile(&dfw);
+  ASSERT_OK(dms_->FlushToFile(&dfw));
   unique_ptr<DeltaStats> stats = dfw.release_delta_stats();
 
   ASSERT_EQ(n_rows / 2, stats->update_count_for_col_id(schema_.column_id(kIntColumn)));
   ASSERT_EQ(n_rows / 4, stats->update_count_for_col_id(schema_.column_id(kStringColumn)));
 }
 
+// Test that the ancient updates of a row are coalesced when flushing the DMS,
+// but not the more recent ones.
+TEST_F(TestDeltaMemStore, TestFlushCoalescesAncientUpdates) {
+  faststring update_buf;
+  RowChangeListEncoder update(&update_buf);
+  const auto update_int = [&](int64_t ts, rowid_t row_idx) {
+    update.Reset();
+    uint32_t new_val = ts;
+    update.AddColumnUpdate(schema_.column(kIntColumn), schema_.column_id(kIntColumn), &new_val);
+    return dms_->Update(Timestamp(ts), row_idx, RowChangeList(update_buf), op_id_);
+  };
+  ASSERT_OK(update_int(1, 0));
+  ASSERT_OK(update_int(2, 1));
+  ASSERT_OK(update_int(3, 0));
+  update.Reset();
+  Slice s("ancient");
+  update.AddColumnUpdate(schema_.column(kStringColumn), schema_.column_id(kStringColumn), &s);
+  ASSERT_OK(dms_->Update(Timestamp(4), 0, RowChangeList(update_buf), op_id_));
+  ASSERT_OK(update_int(5, 0));
+  ASSERT_OK(update_int(6, 0));
+  ASSERT_EQ(6, dms_->Count());
+
+  FsManager fs(env_, FsManagerOpts(GetTestPath("fs_root")));
+  ASSERT_OK(fs.CreateInitialFileSystemLayout());
+  ASSERT_OK(fs.Open());
+  unique_ptr<WritableBlock> block;
+  ASSERT_OK(fs.CreateNewBlock({}, &block));
+  DeltaFileWriter dfw(std::move(block));
+  ASSERT_OK(dfw.Start());
+  ASSERT_OK(dms_->FlushToFile(&dfw, HistoryGcOpts::Enabled(Timestamp(5))));
+  unique_ptr<DeltaStats> stats = dfw.release_delta_stats();
+
+  // The updates of row 0 at timestamps 1, 3 and 4 are merged into one, which
+  // still updates both columns.
+  ASSERT_EQ(4, stats->update_count_for_col_id(schema_.column_id(kIntColumn)));
+  ASSERT_EQ(1, stats->update_count_for_col_id(schema_.column_id(kStringColumn)));
+  ASSERT_EQ(Timestamp(2), stats->min_timestamp());
+  ASSERT_EQ(Timestamp(6), stats->max_timestamp());
+}
+
 TEST_F(TestDeltaMemStore, TestDMSSparseUpdates) {
 
   int n_rows = 1000;
@@ -580,6 +621,46 @@ TEST_F(TestDeltaMemStore, TestIteratorDoesUpdates) {
   }
 }
 
+// The cells of the rows filtered out by the selection vector aren't written.
+TEST_F(TestDeltaMemStore, TestApplyUpdatesSkipsFilteredRows) {
+  unordered_set<uint32_t> to_update;
+  for (uint32_t i = 0; i < 100; i++) {
+    to_update.insert(i);
+  }
+  UpdateIntsAtIndexes(to_update);
+
+  RowIteratorOptions opts;
+  opts.projection = &schema_;
+  opts.snap_to_include = MvccSnapshot(mvcc_);
+  unique_ptr<DeltaIterator> iter;
+  ASSERT_OK(dms_->NewDeltaIterator(opts, &iter));
+  ASSERT_OK(iter->Init(nullptr));
+  ASSERT_OK(iter->SeekToOrdinal(0));
+
+  ScopedColumnBlock<UINT32> block(100);
+  for (int i = 0; i < block.nrows(); i++) {
+    block[i] = 1;
+  }
+  ASSERT_OK(iter->PrepareBatch(block.nrows(), DeltaIterator::PREPARE_FOR_APPLY));
+  SelectionVector sv(block.nrows());
+  sv.SetAllFalse();
+  for (int i = 0; i < block.nrows(); i += 2) {
+    sv.SetRowSelected(i);
+  }
+  ASSERT_OK(iter->ApplyUpdates(kIntColumn, &block, sv));
+  for (int i = 0; i < block.nrows(); i++) {
+    ASSERT_EQ(i % 2 == 0 ? i * 10 : 1, block[i]) << "at row " << i;
+  }
+
+  // Nothing is written if no row is selected.
+  ASSERT_OK(iter->PrepareBatch(block.nrows(), DeltaIterator::PREPARE_FOR_APPLY));
+  sv.SetAllFalse();
+  ASSERT_OK(iter->ApplyUpdates(kIntColumn, &block, sv));
+  for (int i = 0; i < block.nrows(); i++) {
+    ASSERT_EQ(i % 2 == 0 ? i * 10 : 1, block[i]) << "at row " << i;
+  }
+}
+
 TEST_F(TestDeltaMemStore, TestCollectMutations) {
   Arena arena(1024);
 
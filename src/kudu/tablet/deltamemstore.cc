@@ -28,6 +28,7 @@
 #include "kudu/consensus/opid.pb.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/compaction.h"
 #include "kudu/tablet/delta_key.h"
 #include "kudu/tablet/deltafile.h"
 #include "kudu/tablet/rowset.h"
@@ -36,6 +37,7 @@
 #include "kudu/util/memory/memory.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
+#include "kudu/util/trace.h"
 
 using kudu::fs::IOContext;
 using kudu::log::LogAnchorRegistry;
@@ -74,13 +76,16 @@ DeltaMemStore::DeltaMemStore(int64_t id,
     creation_time_(MonoTime::Now()),
     highest_timestamp_(Timestamp::kMin),
     allocator_(new MemoryTrackingBufferAllocator(
-        HeapBufferAllocator::Get(), std::move(parent_tracker))),
+        HugePageBufferAllocator::GetForLargeArenas(), std::move(parent_tracker))),
     arena_(new ThreadSafeMemoryTrackingArena(kInitialArenaSize, allocator_)),
     tree_(arena_),
     anchorer_(log_anchor_registry,
               Substitute("Rowset-$0/DeltaMemStore-$1", rs_id_, id_)),
     disambiguator_sequence_number_(0),
     deleted_row_count_(0) {
+  if (HugePageBufferAllocator::GetForLargeArenas() == HugePageBufferAllocator::Get()) {
+    arena_->SetMaxBufferSize(HugePageBufferAllocator::kHugePageSize);
+  }
 }
 
 Status DeltaMemStore::Init(const IOContext* /*io_context*/) {
@@ -127,8 +132,25 @@ Status DeltaMemStore::Update(Timestamp timestamp,
   return Status::OK();
 }
 
-Status DeltaMemStore::FlushToFile(DeltaFileWriter *dfw) {
+Status DeltaMemStore::FlushToFile(DeltaFileWriter* dfw) {
+  return FlushToFile(dfw, HistoryGcOpts::Disabled());
+}
+
+Status DeltaMemStore::FlushToFile(DeltaFileWriter* dfw, const HistoryGcOpts& history_gc_opts) {
   unique_ptr<DeltaStats> stats(new DeltaStats());
+  const auto append = [&](const DeltaKey& key, const RowChangeList& rcl) {
+    RETURN_NOT_OK_PREPEND(dfw->AppendDelta<REDO>(key, rcl), "Failed to append delta");
+    stats->UpdateStats(key.timestamp(), rcl);
+    return Status::OK();
+  };
+
+  // The ancient UPDATE which is held back from the file, for the following
+  // ancient UPDATEs of the same row to be merged into it.
+  bool has_pending = false;
+  DeltaKey pending_key;
+  faststring pending_buf;
+  faststring merged_buf;
+  int64_t coalesced_count = 0;
 
   unique_ptr<DMSTreeIter> iter(tree_.NewIterator());
   iter->SeekToStart();
@@ -139,10 +161,39 @@ Status DeltaMemStore::FlushToFile(DeltaFileWriter *dfw) {
     DeltaKey key;
     RETURN_NOT_OK(key.DecodeFrom(&key_slice));
     RowChangeList rcl(val);
-    RETURN_NOT_OK_PREPEND(dfw->AppendDelta<REDO>(key, rcl), "Failed to append delta");
-    stats->UpdateStats(key.timestamp(), rcl);
     iter->Next();
+
+    // No snapshot older than the ancient history mark may be read, so none
+    // can observe the versions between ancient updates of a row: they can be
+    // merged into one at the timestamp of the latest.
+    const bool coalescible = history_gc_opts.IsAncientHistory(key.timestamp()) &&
+                             !rcl.is_delete() && !rcl.is_reinsert();
+    if (has_pending && coalescible && key.row_idx() == pending_key.row_idx()) {
+      merged_buf.clear();
+      RowChangeListEncoder merged(&merged_buf);
+      RETURN_NOT_OK(RowChangeListDecoder::MergeUpdates(
+          RowChangeList(pending_buf), rcl, &merged));
+      pending_buf.assign_copy(merged_buf.data(), merged_buf.size());
+      pending_key = key;
+      coalesced_count++;
+      continue;
+    }
+    if (has_pending) {
+      RETURN_NOT_OK(append(pending_key, RowChangeList(pending_buf)));
+      has_pending = false;
+    }
+    if (coalescible) {
+      pending_key = key;
+      pending_buf.assign_copy(rcl.slice().data(), rcl.slice().size());
+      has_pending = true;
+      continue;
+    }
+    RETURN_NOT_OK(append(key, rcl));
+  }
+  if (has_pending) {
+    RETURN_NOT_OK(append(pending_key, RowChangeList(pending_buf)));
   }
+  TRACE_COUNTER_INCREMENT("coalesced_update_count", coalesced_count);
   dfw->WriteDeltaStats(std::move(stats));
   return Status::OK();
 }
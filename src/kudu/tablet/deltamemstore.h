@@ -61,6 +61,7 @@ struct IOContext;
 namespace tablet {
 
 class DeltaFileWriter;
+class HistoryGcOpts;
 class Mutation;
 struct RowIteratorOptions;
 
@@ -109,6 +110,10 @@ class DeltaMemStore : public DeltaStore,
   // Flush the DMS to the given file writer.
   Status FlushToFile(DeltaFileWriter* dfw);
 
+  // Same as above, but successive UPDATEs of a row which are all ancient per
+  // 'history_gc_opts' are coalesced into one, at the timestamp of the latest.
+  Status FlushToFile(DeltaFileWriter* dfw, const HistoryGcOpts& history_gc_opts);
+
   // Create an iterator for applying deltas from this DMS.
   //
   // The projection passed in 'opts' must be the same as the schema of any
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -66,6 +67,7 @@
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/random.h"
+#include "kudu/util/random_util.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
@@ -82,11 +84,17 @@ DEFINE_double(update_fraction, 0.1f, "fraction of rows to update");
 DECLARE_bool(cfile_lazy_open);
 DECLARE_bool(crash_on_eio);
 DECLARE_int32(cfile_default_block_size);
+DECLARE_int32(rowset_writer_parallel_min_columns);
 DECLARE_double(env_inject_eio);
 DECLARE_int32(tablet_history_max_age_sec);
+DECLARE_bool(rowset_in_memory_key_filters);
 DECLARE_bool(rowset_metadata_store_keys);
+DECLARE_int32(rowset_split_key_max_samples);
+DECLARE_int64(rowset_split_key_sample_bytes);
 DECLARE_double(tablet_delta_store_major_compact_min_ratio);
 DECLARE_int32(tablet_delta_store_minor_compact_max);
+DECLARE_int32(major_delta_compaction_inject_failure_after_chunks);
+DECLARE_int64(major_delta_compaction_chunk_size_mb);
 
 using std::is_sorted;
 using std::make_tuple;
@@ -186,7 +194,123 @@ TEST_F(TestRowSet, TestRowSetRoundTrip) {
   }
 }
 
+// Test round-trip writing and reading back a rowset whose columns are
+// appended in parallel.
+TEST_F(TestRowSet, TestRowSetRoundTripParallelColumns) {
+  FLAGS_rowset_writer_parallel_min_columns = 1;
+  WriteTestRowSet();
+
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+  IterateProjection(*rs, schema_, n_rows_);
+}
+
 // Test writing a rowset, and then updating some rows in it.
+// Test that the presence of keys is checked against the in-memory key filter
+// of a freshly written rowset, which filters out absent keys without a key
+// lookup.
+TEST_F(TestRowSet, TestInMemoryKeyFilter) {
+  FLAGS_rowset_in_memory_key_filters = true;
+  WriteTestRowSet();
+  ASSERT_NE(nullptr, rowset_meta_->key_filter());
+
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+  Schema pk = schema_.CreateKeyProjection();
+  ProbeStats stats;
+  for (size_t i = 0; i < n_rows_; i += 10) {
+    char buf[256];
+    FormatKey(i, buf, sizeof(buf));
+    // Keys which are present, and keys in between which aren't.
+    for (const auto& key : { string(buf), string(buf) + "x" }) {
+      Arena arena(64);
+      RowBuilder rb(&pk);
+      rb.AddString(Slice(key));
+      RowSetKeyProbe probe(rb.row(), &arena);
+      bool present;
+      ASSERT_OK(rs->CheckRowPresent(probe, nullptr, &present, &stats));
+      ASSERT_EQ(key == buf, present) << key;
+    }
+  }
+  const int num_probes = static_cast<int>(2 * ((n_rows_ + 9) / 10));
+  ASSERT_EQ(num_probes, stats.blooms_consulted);
+  // Only present keys and the few false positives of the filter are looked up.
+  ASSERT_LT(stats.keys_consulted, num_probes / 2 + num_probes / 20);
+}
+
+// Test that the keys sampled from a rowset are evenly spaced among its rows,
+// and start and end with its bounds.
+TEST_F(TestRowSet, TestKeySamples) {
+  FLAGS_rowset_split_key_sample_bytes = 1;
+  FLAGS_rowset_split_key_max_samples = 16;
+  WriteTestRowSet();
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+
+  shared_ptr<const vector<string>> samples;
+  ASSERT_OK(rs->GetKeySamples(nullptr, &samples));
+  const size_t num_samples = std::min<size_t>(16, n_rows_);
+  ASSERT_EQ(num_samples, samples->size());
+  for (size_t i = 0; i < num_samples; i++) {
+    char buf[256];
+    FormatKey(num_samples == 1 ? 0 : i * (n_rows_ - 1) / (num_samples - 1), buf, sizeof(buf));
+    ASSERT_EQ(buf, (*samples)[i]);
+  }
+  string min_key;
+  string max_key;
+  ASSERT_OK(rs->GetBounds(&min_key, &max_key));
+  ASSERT_EQ(min_key, samples->front());
+  ASSERT_EQ(max_key, samples->back());
+
+  // The samples are only read once.
+  shared_ptr<const vector<string>> samples_again;
+  ASSERT_OK(rs->GetKeySamples(nullptr, &samples_again));
+  ASSERT_EQ(samples.get(), samples_again.get());
+}
+
+// Test that checking the presence of a sorted batch of keys agrees with
+// checking them one at a time, for present, absent and deleted rows.
+TEST_F(TestRowSet, TestCheckRowsPresent) {
+  WriteTestRowSet();
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+  OperationResultPB result;
+  ASSERT_OK(DeleteRow(rs.get(), 20, &result));
+
+  Schema pk = schema_.CreateKeyProjection();
+  Arena arena(1024);
+  // The probes reference the rows of their builders.
+  vector<unique_ptr<RowBuilder>> builders;
+  vector<unique_ptr<RowSetKeyProbe>> probes;
+  for (int i = 0; i < 50; i += 5) {
+    char buf[256];
+    FormatKey(i, buf, sizeof(buf));
+    for (const auto& key : { string(buf), string(buf) + "x" }) {
+      builders.emplace_back(new RowBuilder(&pk));
+      builders.back()->AddString(Slice(key));
+      probes.emplace_back(new RowSetKeyProbe(builders.back()->row(), &arena));
+    }
+  }
+  vector<const RowSetKeyProbe*> probe_ptrs;
+  vector<ProbeStats> stats(probes.size());
+  vector<ProbeStats*> stats_ptrs;
+  for (int i = 0; i < probes.size(); i++) {
+    probe_ptrs.push_back(probes[i].get());
+    stats_ptrs.push_back(&stats[i]);
+  }
+  vector<bool> present;
+  ASSERT_OK(rs->CheckRowsPresent(probe_ptrs, nullptr, &present, stats_ptrs));
+  ASSERT_EQ(probes.size(), present.size());
+  for (int i = 0; i < probes.size(); i++) {
+    bool expected;
+    ProbeStats unused;
+    ASSERT_OK(rs->CheckRowPresent(*probes[i], nullptr, &expected, &unused));
+    ASSERT_EQ(expected, present[i]) << probes[i]->encoded_key_slice().ToDebugString();
+    // Only the present keys and the deleted one are in the base data.
+    ASSERT_EQ(i % 2 == 0 && i != 8, present[i]);
+  }
+}
+
 TEST_F(TestRowSet, TestRowSetUpdate) {
   Arena arena(64);
 
@@ -1076,5 +1200,161 @@ TEST_P(DiffScanRowSetTest, TestFuzz) {
                              make_tuple(3, 400, 9, true) }));
 }
 
+class ChunkedMajorDeltaCompactionTest : public KuduRowSetTest {
+ public:
+  ChunkedMajorDeltaCompactionTest()
+      : KuduRowSetTest(CreateTestSchema()),
+        op_id_(consensus::MaximumOpId()),
+        clock_(Timestamp::kInitialTimestamp),
+        log_anchor_registry_(new log::LogAnchorRegistry()) {
+  }
+
+ protected:
+  static constexpr int kNumRows = 12000;
+
+  static Schema CreateTestSchema() {
+    SchemaBuilder builder;
+    CHECK_OK(builder.AddKeyColumn("key", UINT32));
+    CHECK_OK(builder.AddColumn("val0", STRING));
+    CHECK_OK(builder.AddColumn("val1", STRING));
+    CHECK_OK(builder.AddColumn("val2", STRING));
+    return builder.BuildWithoutIds();
+  }
+
+  // Writes a rowset with 'meta', whose values are random so that the base
+  // data of each column is larger than 1 MiB, then updates all the columns of
+  // every tenth row and flushes the updates.
+  void WriteRowSetWithUpdates(const shared_ptr<RowSetMetadata>& meta,
+                              shared_ptr<DiskRowSet>* rs) {
+    Random prng(1234);
+    {
+      DiskRowSetWriter drsw(meta.get(), &schema_,
+                            BloomFilterSizing::BySizeAndFPRate(32 * 1024, 0.01f));
+      ASSERT_OK(drsw.Open());
+      RowBuilder rb(&schema_);
+      for (int i = 0; i < kNumRows; i++) {
+        rb.Reset();
+        rb.AddUint32(i);
+        for (int col = 1; col < schema_.num_columns(); col++) {
+          rb.AddString(RandomString(100, &prng));
+        }
+        ASSERT_OK(WriteRow(rb.data(), &drsw));
+      }
+      ASSERT_OK(drsw.Finish());
+    }
+    ASSERT_OK(DiskRowSet::Open(meta, log_anchor_registry_.get(), TabletMemTrackers(),
+                               nullptr, rs));
+
+    const Schema key_schema = schema_.CreateKeyProjection();
+    for (int i = 0; i < kNumRows; i += 10) {
+      vector<string> vals;
+      faststring buf;
+      RowChangeListEncoder enc(&buf);
+      for (int col = 1; col < schema_.num_columns(); col++) {
+        vals.emplace_back(Substitute("updated $0 $1", i, col));
+      }
+      vector<Slice> slices(vals.begin(), vals.end());
+      for (int col = 1; col < schema_.num_columns(); col++) {
+        enc.AddColumnUpdate(schema_.column(col), schema_.column_id(col), &slices[col - 1]);
+      }
+      RowBuilder rb(&key_schema);
+      rb.AddUint32(i);
+      Arena arena(64);
+      RowSetKeyProbe probe(rb.row(), &arena);
+      ScopedOp op(&mvcc_, clock_.Now());
+      op.StartApplying();
+      ProbeStats stats;
+      OperationResultPB result;
+      ASSERT_OK((*rs)->MutateRow(op.timestamp(), probe, enc.as_changelist(), op_id_,
+                                 nullptr, &stats, &result));
+      op.FinishApplying();
+    }
+    ASSERT_OK((*rs)->FlushDeltas(nullptr));
+  }
+
+  void Scan(DiskRowSet* rs, vector<string>* rows) {
+    RowIteratorOptions opts;
+    opts.projection = &schema_;
+    opts.snap_to_include = MvccSnapshot(mvcc_);
+    unique_ptr<RowwiseIterator> iter;
+    ASSERT_OK(rs->NewRowIterator(opts, &iter));
+    ASSERT_OK(iter->Init(nullptr));
+    ASSERT_OK(IterateToStringList(iter.get(), rows));
+    ASSERT_EQ(kNumRows, rows->size());
+  }
+
+  static size_t NumColumnsToCompact(DiskRowSet* rs) {
+    vector<ColumnId> col_ids;
+    rs->delta_tracker().GetColumnIdsToCompact(&col_ids);
+    return col_ids.size();
+  }
+
+  consensus::OpId op_id_;
+  clock::LogicalClock clock_;
+  MvccManager mvcc_;
+  scoped_refptr<log::LogAnchorRegistry> log_anchor_registry_;
+};
+
+// Test that a major delta compaction in chunks of columns yields the same rows
+// as one compacting all the columns at once.
+TEST_F(ChunkedMajorDeltaCompactionTest, TestMatchesUnchunkedCompaction) {
+  FLAGS_major_delta_compaction_chunk_size_mb = 0;
+  shared_ptr<DiskRowSet> unchunked;
+  NO_FATALS(WriteRowSetWithUpdates(rowset_meta_, &unchunked));
+  vector<string> before;
+  NO_FATALS(Scan(unchunked.get(), &before));
+  ASSERT_EQ(3, NumColumnsToCompact(unchunked.get()));
+  ASSERT_OK(unchunked->MajorCompactDeltaStores(nullptr, HistoryGcOpts::Disabled()));
+  ASSERT_EQ(0, NumColumnsToCompact(unchunked.get()));
+  vector<string> unchunked_rows;
+  NO_FATALS(Scan(unchunked.get(), &unchunked_rows));
+  ASSERT_EQ(before, unchunked_rows);
+
+  // Each column is larger than a chunk, so it's compacted on its own.
+  FLAGS_major_delta_compaction_chunk_size_mb = 1;
+  shared_ptr<RowSetMetadata> meta;
+  ASSERT_OK(tablet()->metadata()->CreateRowSet(&meta));
+  shared_ptr<DiskRowSet> chunked;
+  NO_FATALS(WriteRowSetWithUpdates(meta, &chunked));
+  ASSERT_OK(chunked->MajorCompactDeltaStores(nullptr, HistoryGcOpts::Disabled()));
+  ASSERT_EQ(0, NumColumnsToCompact(chunked.get()));
+  vector<string> chunked_rows;
+  NO_FATALS(Scan(chunked.get(), &chunked_rows));
+  ASSERT_EQ(unchunked_rows, chunked_rows);
+}
+
+// Test that each chunk of a major delta compaction is committed on its own, so
+// that a compaction interrupted in between chunks resumes with the columns it
+// didn't compact, even once the rowset is reopened.
+TEST_F(ChunkedMajorDeltaCompactionTest, TestInterruptedCompactionResumes) {
+  FLAGS_major_delta_compaction_chunk_size_mb = 1;
+  shared_ptr<DiskRowSet> rs;
+  NO_FATALS(WriteRowSetWithUpdates(rowset_meta_, &rs));
+  vector<string> before;
+  NO_FATALS(Scan(rs.get(), &before));
+
+  FLAGS_major_delta_compaction_inject_failure_after_chunks = 1;
+  Status s = rs->MajorCompactDeltaStores(nullptr, HistoryGcOpts::Disabled());
+  ASSERT_TRUE(s.IsIOError()) << s.ToString();
+  ASSERT_EQ(2, NumColumnsToCompact(rs.get()));
+  vector<string> rows;
+  NO_FATALS(Scan(rs.get(), &rows));
+  ASSERT_EQ(before, rows);
+
+  // Reopen the rowset from its metadata, as after a restart.
+  rs.reset();
+  ASSERT_OK(DiskRowSet::Open(rowset_meta_, log_anchor_registry_.get(), TabletMemTrackers(),
+                             nullptr, &rs));
+  ASSERT_EQ(2, NumColumnsToCompact(rs.get()));
+  NO_FATALS(Scan(rs.get(), &rows));
+  ASSERT_EQ(before, rows);
+
+  FLAGS_major_delta_compaction_inject_failure_after_chunks = -1;
+  ASSERT_OK(rs->MajorCompactDeltaStores(nullptr, HistoryGcOpts::Disabled()));
+  ASSERT_EQ(0, NumColumnsToCompact(rs.get()));
+  NO_FATALS(Scan(rs.get(), &rows));
+  ASSERT_EQ(before, rows);
+}
+
 } // namespace tablet
 } // namespace kudu
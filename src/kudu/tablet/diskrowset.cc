@@ -18,7 +18,9 @@
 #include "kudu/tablet/diskrowset.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <vector>
@@ -33,6 +35,7 @@
 #include "kudu/common/common.pb.h"
 #include "kudu/common/generic_iterators.h"
 #include "kudu/common/iterator.h"
+#include "kudu/common/row_checksum.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
@@ -40,9 +43,11 @@
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/fs/io_context.h"
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/tablet/cfile_set.h"
+#include "kudu/tablet/column_stats.h"
 #include "kudu/tablet/compaction.h"
 #include "kudu/tablet/delta_compaction.h"
 #include "kudu/tablet/delta_stats.h"
@@ -53,9 +58,12 @@
 #include "kudu/tablet/mutation.h"
 #include "kudu/tablet/mvcc.h"
 #include "kudu/tablet/rowset_metadata.h"
+#include "kudu/util/block_bloom_filter.h"
+#include "kudu/util/bloom_filter.h"
 #include "kudu/util/compression/compression.pb.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/hash.pb.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/monotime.h"
@@ -63,6 +71,9 @@
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
+DECLARE_double(tablet_bloom_target_fp_rate);
+DECLARE_int32(file_cache_prefetch_threads);
+
 DEFINE_int32(tablet_delta_store_minor_compact_max, 1000,
              "How many delta stores are required before forcing a minor delta compaction "
              "(Advanced option)");
@@ -82,6 +93,60 @@ DEFINE_bool(rowset_metadata_store_keys, false,
             "metadata. If false, keys will be read from the data blocks.");
 TAG_FLAG(rowset_metadata_store_keys, experimental);
 
+DEFINE_bool(tablet_compute_column_stats, false,
+            "Whether flushes and compactions compute the statistics of the "
+            "columns of the DiskRowSets they write, i.e. their null counts, "
+            "approximate numbers of distinct values and the minimum and maximum "
+            "values of their fixed-length columns, storing them in the rowset "
+            "metadata. The statistics are reported to the master, which "
+            "aggregates them per table for GetTableStatistics.");
+TAG_FLAG(tablet_compute_column_stats, experimental);
+TAG_FLAG(tablet_compute_column_stats, runtime);
+
+DEFINE_bool(tablet_compute_rowset_checksums, true,
+            "Whether flushes and compactions compute the checksums of the base "
+            "data of the DiskRowSets they write, storing them in the rowset "
+            "metadata. Checksum scans of the rowsets which weren't mutated since "
+            "then use the stored checksums rather than reading the rowsets.");
+TAG_FLAG(tablet_compute_rowset_checksums, advanced);
+TAG_FLAG(tablet_compute_rowset_checksums, runtime);
+
+DEFINE_bool(tablet_reclaim_dropped_column_blocks, true,
+            "Whether the major delta compactions of a rowset remove the base "
+            "data blocks of the columns dropped from the schema, and are "
+            "scheduled for the rowsets with such blocks even if they have no "
+            "deltas to compact. Otherwise, the space of the dropped columns "
+            "is only reclaimed once their rowsets are compacted.");
+TAG_FLAG(tablet_reclaim_dropped_column_blocks, advanced);
+TAG_FLAG(tablet_reclaim_dropped_column_blocks, runtime);
+
+DEFINE_bool(rowset_in_memory_key_filters, false,
+            "Whether flushes and compactions build an in-memory filter of the "
+            "keys of every DiskRowSet they write, so that checks for the "
+            "presence of a key don't read the rowset's bloom file. The filters "
+            "have the false positive rate of the bloom files, and are tracked "
+            "by the bloomfile memory trackers. Rowsets opened from disk "
+            "keep using their bloom file.");
+TAG_FLAG(rowset_in_memory_key_filters, advanced);
+TAG_FLAG(rowset_in_memory_key_filters, experimental);
+
+DEFINE_int64(major_delta_compaction_chunk_size_mb, 256,
+             "The maximum size, in MiB, of the base data of the columns a major delta "
+             "compaction rewrites at once. The columns of larger rowsets are compacted "
+             "in chunks, each of which is committed as soon as it is written, so that "
+             "a restart in the middle of the compaction only loses the progress of the "
+             "current chunk. If 0, all the columns are compacted at once.");
+TAG_FLAG(major_delta_compaction_chunk_size_mb, advanced);
+TAG_FLAG(major_delta_compaction_chunk_size_mb, experimental);
+TAG_FLAG(major_delta_compaction_chunk_size_mb, runtime);
+
+DEFINE_int32(major_delta_compaction_inject_failure_after_chunks, -1,
+             "The number of committed chunks after which major delta compactions "
+             "fail with an injected error, when more chunks remain. Used in tests "
+             "only. If negative, no failure is injected.");
+TAG_FLAG(major_delta_compaction_inject_failure_after_chunks, unsafe);
+TAG_FLAG(major_delta_compaction_inject_failure_after_chunks, hidden);
+
 using kudu::cfile::BloomFileWriter;
 using kudu::fs::BlockManager;
 using kudu::fs::BlockCreationTransaction;
@@ -110,12 +175,16 @@ const char *DiskRowSet::kMaxKeyMetaEntryName = "max_key";
 
 DiskRowSetWriter::DiskRowSetWriter(RowSetMetadata* rowset_metadata,
                                    const Schema* schema,
-                                   BloomFilterSizing bloom_sizing)
+                                   BloomFilterSizing bloom_sizing,
+                                   fs::BlockTemperature temperature)
     : rowset_metadata_(rowset_metadata),
       schema_(schema),
       bloom_sizing_(bloom_sizing),
+      temperature_(temperature),
       finished_(false),
-      written_count_(0) {
+      written_count_(0),
+      checksum_(0),
+      checksum_schema_version_(0) {
   CHECK(schema->has_column_ids());
 }
 
@@ -124,7 +193,7 @@ Status DiskRowSetWriter::Open() {
 
   FsManager* fs = rowset_metadata_->fs_manager();
   const string& tablet_id = rowset_metadata_->tablet_metadata()->tablet_id();
-  col_writer_.reset(new MultiColumnWriter(fs, schema_, tablet_id));
+  col_writer_.reset(new MultiColumnWriter(fs, schema_, tablet_id, temperature_));
   RETURN_NOT_OK(col_writer_->Open());
 
   // Open bloom filter.
@@ -135,6 +204,21 @@ Status DiskRowSetWriter::Open() {
     RETURN_NOT_OK(InitAdHocIndexWriter());
   }
 
+  if (FLAGS_tablet_compute_column_stats) {
+    column_stats_.reset(new ColumnStatsCollector(schema_));
+  }
+
+  // The checksum only holds for the schema it's computed with, so it's only
+  // computed if the rows are written with the current schema of the tablet.
+  if (FLAGS_tablet_compute_rowset_checksums) {
+    const auto* tablet_metadata = rowset_metadata_->tablet_metadata();
+    const uint32_t schema_version = tablet_metadata->schema_version();
+    if (*tablet_metadata->schema() == *schema_) {
+      checksummer_.reset(new RowChecksummer);
+      checksum_schema_version_ = schema_version;
+    }
+  }
+
   return Status::OK();
 }
 
@@ -143,7 +227,7 @@ Status DiskRowSetWriter::InitBloomFileWriter() {
   unique_ptr<WritableBlock> block;
   FsManager* fs = rowset_metadata_->fs_manager();
   const string& tablet_id = rowset_metadata_->tablet_metadata()->tablet_id();
-  RETURN_NOT_OK_PREPEND(fs->CreateNewBlock(CreateBlockOptions({ tablet_id }),
+  RETURN_NOT_OK_PREPEND(fs->CreateNewBlock(CreateBlockOptions({ tablet_id, temperature_ }),
                                            &block),
                         "Couldn't allocate a block for bloom filter");
   rowset_metadata_->set_bloom_block(block->id());
@@ -158,7 +242,7 @@ Status DiskRowSetWriter::InitAdHocIndexWriter() {
   unique_ptr<WritableBlock> block;
   FsManager* fs = rowset_metadata_->fs_manager();
   const string& tablet_id = rowset_metadata_->tablet_metadata()->tablet_id();
-  RETURN_NOT_OK_PREPEND(fs->CreateNewBlock(CreateBlockOptions({ tablet_id }),
+  RETURN_NOT_OK_PREPEND(fs->CreateNewBlock(CreateBlockOptions({ tablet_id, temperature_ }),
                                            &block),
                         "Couldn't allocate a block for compoound index");
 
@@ -203,6 +287,14 @@ Status DiskRowSetWriter::AppendBlock(const RowBlock &block, int live_row_count)
 
   // Write the batch to each of the columns
   RETURN_NOT_OK(col_writer_->AppendBlock(block));
+  if (column_stats_) {
+    column_stats_->AddBlock(block);
+  }
+  if (checksummer_) {
+    for (size_t i = 0; i < block.nrows(); i++) {
+      checksum_ += checksummer_->RowCrc32(*schema_, block.row(i));
+    }
+  }
 
   // Increase the live row count if necessary.
   rowset_metadata_->IncrementLiveRows(live_row_count);
@@ -223,6 +315,9 @@ Status DiskRowSetWriter::AppendBlock(const RowBlock &block, int live_row_count)
     // Insert the encoded key into the bloom.
     Slice enc_key = schema_->EncodeComparableKey(row, &last_encoded_key_);
     RETURN_NOT_OK(bloom_writer_->AppendKeys(&enc_key, 1));
+    if (FLAGS_rowset_in_memory_key_filters) {
+      key_hashes_.push_back(BloomKeyProbe(enc_key).initial_hash());
+    }
 
     // Write the batch to the ad hoc index if we're using one
     if (ad_hoc_index_writer_ != nullptr) {
@@ -280,6 +375,16 @@ Status DiskRowSetWriter::FinishAndReleaseBlocks(BlockCreationTransaction* transa
   std::map<ColumnId, BlockId> flushed_blocks;
   col_writer_->GetFlushedBlocksByColumnId(&flushed_blocks);
   rowset_metadata_->SetColumnDataBlocks(flushed_blocks);
+  if (column_stats_) {
+    rowset_metadata_->set_column_stats(column_stats_->GetStats());
+  }
+  if (checksummer_) {
+    RowSetChecksumPB checksum;
+    checksum.set_checksum(checksum_);
+    checksum.set_num_rows(written_count_);
+    checksum.set_schema_version(checksum_schema_version_);
+    rowset_metadata_->set_base_data_checksum(std::move(checksum));
+  }
 
   if (ad_hoc_index_writer_ != nullptr) {
     Status s = ad_hoc_index_writer_->FinishAndReleaseBlock(transaction);
@@ -296,6 +401,19 @@ Status DiskRowSetWriter::FinishAndReleaseBlocks(BlockCreationTransaction* transa
     return s;
   }
 
+  if (!key_hashes_.empty()) {
+    auto key_filter = std::make_shared<BlockBloomFilter>(
+        DefaultBlockBloomFilterBufferAllocator::GetSingleton());
+    RETURN_NOT_OK(key_filter->Init(
+        BlockBloomFilter::MinLogSpace(key_hashes_.size(), FLAGS_tablet_bloom_target_fp_rate),
+        CITY_HASH, /*hash_seed=*/0));
+    for (uint32_t hash : key_hashes_) {
+      key_filter->Insert(hash);
+    }
+    rowset_metadata_->set_key_filter(std::move(key_filter));
+    vector<uint32_t>().swap(key_hashes_);
+  }
+
   finished_ = true;
   return Status::OK();
 }
@@ -327,12 +445,14 @@ DiskRowSetWriter::~DiskRowSetWriter() {
 
 RollingDiskRowSetWriter::RollingDiskRowSetWriter(
     TabletMetadata* tablet_metadata, const Schema& schema,
-    BloomFilterSizing bloom_sizing, size_t target_rowset_size)
+    BloomFilterSizing bloom_sizing, size_t target_rowset_size,
+    fs::BlockTemperature temperature)
     : state_(kInitialized),
       tablet_metadata_(DCHECK_NOTNULL(tablet_metadata)),
       schema_(schema),
       bloom_sizing_(bloom_sizing),
       target_rowset_size_(target_rowset_size),
+      temperature_(temperature),
       row_idx_in_cur_drs_(0),
       can_roll_(false),
       written_count_(0),
@@ -358,16 +478,16 @@ Status RollingDiskRowSetWriter::RollWriter() {
 
   RETURN_NOT_OK(tablet_metadata_->CreateRowSet(&cur_drs_metadata_));
 
-  cur_writer_.reset(new DiskRowSetWriter(cur_drs_metadata_.get(), &schema_, bloom_sizing_));
+  cur_writer_.reset(new DiskRowSetWriter(cur_drs_metadata_.get(), &schema_, bloom_sizing_,
+                                         temperature_));
   RETURN_NOT_OK(cur_writer_->Open());
 
   FsManager* fs = tablet_metadata_->fs_manager();
   unique_ptr<WritableBlock> undo_data_block;
   unique_ptr<WritableBlock> redo_data_block;
-  RETURN_NOT_OK(fs->CreateNewBlock(CreateBlockOptions({ tablet_metadata_->tablet_id() }),
-                                   &undo_data_block));
-  RETURN_NOT_OK(fs->CreateNewBlock(CreateBlockOptions({ tablet_metadata_->tablet_id() }),
-                                   &redo_data_block));
+  const CreateBlockOptions block_opts({ tablet_metadata_->tablet_id(), temperature_ });
+  RETURN_NOT_OK(fs->CreateNewBlock(block_opts, &undo_data_block));
+  RETURN_NOT_OK(fs->CreateNewBlock(block_opts, &redo_data_block));
   cur_undo_ds_block_id_ = undo_data_block->id();
   cur_redo_ds_block_id_ = redo_data_block->id();
   cur_undo_writer_.reset(new DeltaFileWriter(std::move(undo_data_block)));
@@ -454,6 +574,15 @@ Status RollingDiskRowSetWriter::FinishCurrentWriter() {
     RETURN_NOT_OK(writer_status);
     CHECK_GT(cur_writer_->written_count(), 0);
 
+    // The UNDOs of the rowset hold the timestamps of the inserts and mutations
+    // folded into its base data: record the newest one, which stays known even
+    // once the UNDOs are GCed. If no UNDOs were written (e.g. since all history
+    // is ancient), it's left unknown.
+    if (cur_undo_delta_stats_->max_timestamp() != Timestamp::kMin) {
+      cur_drs_metadata_->set_newest_base_timestamp(cur_undo_delta_stats_->max_timestamp());
+    }
+    cur_drs_metadata_->set_cold(temperature_ == fs::BlockTemperature::COLD);
+
     cur_undo_writer_->WriteDeltaStats(std::move(cur_undo_delta_stats_));
     cur_redo_writer_->WriteDeltaStats(std::move(cur_redo_delta_stats_));
 
@@ -534,6 +663,7 @@ Status DiskRowSet::Open(const IOContext* io_context) {
   RETURN_NOT_OK(CFileSet::Open(rowset_metadata_,
                                mem_trackers_.bloomfile_tracker,
                                mem_trackers_.cfile_reader_tracker,
+                               mem_trackers_.block_cache_attribution,
                                io_context,
                                &base_data_));
 
@@ -549,8 +679,13 @@ Status DiskRowSet::Open(const IOContext* io_context) {
 }
 
 Status DiskRowSet::FlushDeltas(const IOContext* io_context) {
+  return FlushDeltas(io_context, HistoryGcOpts::Disabled());
+}
+
+Status DiskRowSet::FlushDeltas(const IOContext* io_context,
+                               const HistoryGcOpts& history_gc_opts) {
   TRACE_EVENT0("tablet", "DiskRowSet::FlushDeltas");
-  return delta_tracker_->Flush(io_context, DeltaTracker::FLUSH_METADATA);
+  return delta_tracker_->Flush(io_context, history_gc_opts, DeltaTracker::FLUSH_METADATA);
 }
 
 Status DiskRowSet::MinorCompactDeltaStores(const IOContext* io_context) {
@@ -560,6 +695,10 @@ Status DiskRowSet::MinorCompactDeltaStores(const IOContext* io_context) {
 
 Status DiskRowSet::MajorCompactDeltaStores(const IOContext* io_context,
                                            HistoryGcOpts history_gc_opts) {
+  if (FLAGS_tablet_reclaim_dropped_column_blocks) {
+    RETURN_NOT_OK(RemoveDroppedColumnBlocks(io_context));
+  }
+
   vector<ColumnId> col_ids;
   delta_tracker_->GetColumnIdsToCompact(&col_ids);
 
@@ -568,7 +707,28 @@ Status DiskRowSet::MajorCompactDeltaStores(const IOContext* io_context,
     return Status::OK();
   }
 
-  return MajorCompactDeltaStoresWithColumnIds(col_ids, io_context, std::move(history_gc_opts));
+  // Each chunk of columns is committed on its own, and its columns no longer
+  // have REDO deltas afterwards: if the compaction is interrupted, the next
+  // major delta compaction of the rowset goes on with the remaining columns.
+  const int64_t chunk_size = FLAGS_major_delta_compaction_chunk_size_mb * 1024 * 1024;
+  vector<ColumnId> chunk;
+  int64_t chunk_data_size = 0;
+  int num_chunks = 0;
+  for (const auto& col_id : col_ids) {
+    const int64_t col_data_size = OnDiskBaseDataColumnSize(col_id);
+    if (chunk_size > 0 && !chunk.empty() && chunk_data_size + col_data_size > chunk_size) {
+      RETURN_NOT_OK(MajorCompactDeltaStoresWithColumnIds(chunk, io_context, history_gc_opts));
+      if (PREDICT_FALSE(++num_chunks ==
+                        FLAGS_major_delta_compaction_inject_failure_after_chunks)) {
+        return Status::IOError("injected failure of major delta compaction");
+      }
+      chunk.clear();
+      chunk_data_size = 0;
+    }
+    chunk.emplace_back(col_id);
+    chunk_data_size += col_data_size;
+  }
+  return MajorCompactDeltaStoresWithColumnIds(chunk, io_context, std::move(history_gc_opts));
 }
 
 Status DiskRowSet::MajorCompactDeltaStoresWithColumnIds(const vector<ColumnId>& col_ids,
@@ -607,6 +767,7 @@ Status DiskRowSet::MajorCompactDeltaStoresWithColumnIds(const vector<ColumnId>&
   RETURN_NOT_OK(CFileSet::Open(rowset_metadata_,
                                mem_trackers_.bloomfile_tracker,
                                mem_trackers_.cfile_reader_tracker,
+                               mem_trackers_.block_cache_attribution,
                                io_context,
                                &new_base));
   {
@@ -627,6 +788,60 @@ Status DiskRowSet::MajorCompactDeltaStoresWithColumnIds(const vector<ColumnId>&
   return rowset_metadata_->Flush();
 }
 
+vector<ColumnId> DiskRowSet::GetDroppedColumnIds() const {
+  const SchemaPtr schema_ptr = rowset_metadata_->tablet_schema();
+  vector<ColumnId> col_ids;
+  for (const auto& e : rowset_metadata_->GetColumnBlocksById()) {
+    if (schema_ptr->find_column_by_id(e.first) == Schema::kColumnNotFound) {
+      col_ids.emplace_back(e.first);
+    }
+  }
+  return col_ids;
+}
+
+Status DiskRowSet::RemoveDroppedColumnBlocks(const IOContext* io_context) {
+  std::lock_guard<Mutex> l(*mutable_delta_tracker()->compact_flush_lock());
+  RETURN_NOT_OK(mutable_delta_tracker()->CheckWritableUnlocked());
+
+  const auto col_ids = GetDroppedColumnIds();
+  if (col_ids.empty()) {
+    return Status::OK();
+  }
+  VLOG_WITH_PREFIX(1) << "Removing the blocks of dropped columns (cols: " << col_ids << ")";
+  TRACE_EVENT0("tablet", "DiskRowSet::RemoveDroppedColumnBlocks");
+
+  RowSetDataPB original_pb;
+  rowset_metadata_->ToProtobuf(&original_pb);
+  auto revert_metadata_update = MakeScopedCleanup([&] {
+    LOG_WITH_PREFIX(WARNING) << "Error removing dropped columns! Rolling back rowset metadata";
+    rowset_metadata_->LoadFromPB(original_pb);
+  });
+
+  RowSetMetadataUpdate update;
+  for (const auto& col_id : col_ids) {
+    update.RemoveColumnId(col_id);
+  }
+  BlockIdContainer removed_blocks;
+  rowset_metadata_->CommitUpdate(update, &removed_blocks);
+
+  // The scans in progress keep reading the previous base data, which is
+  // why the removed blocks are only orphaned rather than deleted.
+  shared_ptr<CFileSet> new_base;
+  RETURN_NOT_OK(CFileSet::Open(rowset_metadata_,
+                               mem_trackers_.bloomfile_tracker,
+                               mem_trackers_.cfile_reader_tracker,
+                               mem_trackers_.block_cache_attribution,
+                               io_context,
+                               &new_base));
+  {
+    std::lock_guard<rw_spinlock> lock(component_lock_);
+    base_data_.swap(new_base);
+  }
+  rowset_metadata_->AddOrphanedBlocks(removed_blocks);
+  revert_metadata_update.cancel();
+  return rowset_metadata_->Flush();
+}
+
 Status DiskRowSet::NewMajorDeltaCompaction(const vector<ColumnId>& col_ids,
                                            HistoryGcOpts history_gc_opts,
                                            const IOContext* io_context,
@@ -660,6 +875,23 @@ Status DiskRowSet::NewRowIterator(const RowIteratorOptions& opts,
   DCHECK(open_);
   shared_lock<rw_spinlock> l(component_lock_);
 
+  // The iterators of all the rowsets of a scan are created upfront, so the
+  // files of the rowsets read later are reopened while the earlier ones are
+  // being read, if they were evicted from the file cache.
+  if (FLAGS_file_cache_prefetch_threads > 0 && opts.projection->has_column_ids()) {
+    const auto blocks_by_col_id = rowset_metadata_->GetColumnBlocksById();
+    vector<BlockId> block_ids = rowset_metadata_->redo_delta_blocks();
+    const vector<BlockId> undo_block_ids = rowset_metadata_->undo_delta_blocks();
+    block_ids.insert(block_ids.end(), undo_block_ids.begin(), undo_block_ids.end());
+    for (size_t i = 0; i < opts.projection->num_columns(); i++) {
+      const BlockId* block_id = FindOrNull(blocks_by_col_id, opts.projection->column_id(i));
+      if (block_id) {
+        block_ids.emplace_back(*block_id);
+      }
+    }
+    rowset_metadata_->fs_manager()->block_manager()->PrefetchBlocks(block_ids);
+  }
+
   shared_ptr<CFileSet::Iterator> base_iter(base_data_->NewIterator(opts.projection,
                                                                    opts.io_context));
   unique_ptr<ColumnwiseIterator> col_iter;
@@ -738,6 +970,28 @@ Status DiskRowSet::CheckRowPresent(const RowSetKeyProbe &probe,
   return Status::OK();
 }
 
+Status DiskRowSet::CheckRowsPresent(const vector<const RowSetKeyProbe*>& probes,
+                                    const IOContext* io_context,
+                                    vector<bool>* present,
+                                    const vector<ProbeStats*>& stats) const {
+  DCHECK(open_);
+  shared_lock<rw_spinlock> l(component_lock_);
+
+  vector<optional<rowid_t>> row_idxs;
+  RETURN_NOT_OK(base_data_->FindRows(probes, io_context, &row_idxs, stats));
+  present->assign(probes.size(), false);
+  for (size_t i = 0; i < probes.size(); i++) {
+    if (!row_idxs[i]) {
+      continue;
+    }
+    // The row might be in the base data but deleted.
+    bool deleted = false;
+    RETURN_NOT_OK(delta_tracker_->CheckRowDeleted(*row_idxs[i], io_context, &deleted, stats[i]));
+    (*present)[i] = !deleted;
+  }
+  return Status::OK();
+}
+
 Status DiskRowSet::CountRows(const IOContext* io_context, rowid_t *count) const {
   DCHECK(open_);
   rowid_t num_rows = num_rows_.load();
@@ -775,6 +1029,13 @@ Status DiskRowSet::GetBounds(std::string* min_encoded_key,
   return base_data_->GetBounds(min_encoded_key, max_encoded_key);
 }
 
+Status DiskRowSet::GetKeySamples(const IOContext* io_context,
+                                 shared_ptr<const vector<string>>* keys) const {
+  DCHECK(open_);
+  shared_lock<rw_spinlock> l(component_lock_);
+  return base_data_->GetKeySamples(io_context, keys);
+}
+
 void DiskRowSet::GetDiskRowSetSpaceUsage(DiskRowSetSpace* drss) const {
   DCHECK(open_);
   shared_lock<rw_spinlock> l(component_lock_);
@@ -854,8 +1115,21 @@ double DiskRowSet::DeltaStoresCompactionPerfImprovementScore(DeltaCompactionType
   double perf_improv = 0;
   size_t store_count = CountDeltaStores();
 
+  // A major delta compaction first reclaims the space of the dropped columns,
+  // which is worth it even without deltas to compact.
+  if (type == RowSet::MAJOR_DELTA_COMPACTION && FLAGS_tablet_reclaim_dropped_column_blocks) {
+    uint64_t dropped_size = 0;
+    for (const auto& col_id : GetDroppedColumnIds()) {
+      dropped_size += OnDiskBaseDataColumnSize(col_id);
+    }
+    const uint64_t base_data_size = OnDiskBaseDataSize();
+    if (dropped_size > 0 && base_data_size > 0) {
+      perf_improv = static_cast<double>(dropped_size) / base_data_size;
+    }
+  }
+
   if (store_count == 0) {
-    return perf_improv;
+    return std::min(1.0, perf_improv);
   }
 
   if (type == RowSet::MAJOR_DELTA_COMPACTION) {
@@ -865,7 +1139,7 @@ double DiskRowSet::DeltaStoresCompactionPerfImprovementScore(DeltaCompactionType
       GetDiskRowSetSpaceUsage(&drss);
       double ratio = static_cast<double>(drss.redo_deltas_size) / drss.base_data_size;
       if (ratio >= FLAGS_tablet_delta_store_major_compact_min_ratio) {
-        perf_improv = ratio;
+        perf_improv = std::max(perf_improv, ratio);
       }
     }
   } else if (type == RowSet::MINOR_DELTA_COMPACTION) {
@@ -907,6 +1181,33 @@ Status DiskRowSet::IsDeletedAndFullyAncient(Timestamp ancient_history_mark,
   return Status::OK();
 }
 
+Status DiskRowSet::IsFullyOlderThan(Timestamp timestamp, bool* older) {
+  // Rowsets whose newest base data is unknown are never considered older.
+  const auto newest_base_timestamp = rowset_metadata_->newest_base_timestamp();
+  *older = newest_base_timestamp && *newest_base_timestamp < timestamp &&
+      delta_tracker_->EstimateNoRedosSince(timestamp);
+  return Status::OK();
+}
+
+bool DiskRowSet::GetKnownChecksum(const MvccSnapshot& snap, RowSetChecksum* checksum) {
+  // The stored checksum is that of the base data: it only holds if the rows
+  // weren't mutated since, and if 'snap' includes all the inserts and
+  // mutations folded into them. The deltas are checked for first: a major
+  // delta compaction clears the stored checksum before removing the deltas.
+  if (delta_tracker_->CountRedoDeltaStores() > 0 || !delta_tracker_->DeltaMemStoreEmpty()) {
+    return false;
+  }
+  const auto known = rowset_metadata_->base_data_checksum();
+  const auto newest_base_timestamp = rowset_metadata_->newest_base_timestamp();
+  if (!known || !newest_base_timestamp || !snap.IsApplied(*newest_base_timestamp) ||
+      known->schema_version() != rowset_metadata_->tablet_metadata()->schema_version()) {
+    return false;
+  }
+  checksum->checksum = known->checksum();
+  checksum->num_rows = known->num_rows();
+  return true;
+}
+
 Status DiskRowSet::InitUndoDeltas(Timestamp ancient_history_mark,
                                   MonoTime deadline,
                                   const IOContext* io_context,
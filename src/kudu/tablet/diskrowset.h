@@ -35,6 +35,7 @@
 #include "kudu/common/rowid.h"
 #include "kudu/common/schema.h"
 #include "kudu/fs/block_id.h"
+#include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -54,6 +55,7 @@ namespace kudu {
 class MonoTime;
 class RowBlock;
 class RowChangeList;
+class RowChecksummer;
 class RowwiseIterator;
 class Timestamp;
 
@@ -93,6 +95,7 @@ Status DumpRowSetInternal(const fs::IOContext& ctx,
 namespace tablet {
 
 class CFileSet;
+class ColumnStatsCollector;
 class CompactionInput;
 class DeltaFileWriter;
 class DeltaStats;
@@ -105,8 +108,11 @@ class OperationResultPB;
 class DiskRowSetWriter {
  public:
   // TODO: document ownership of rowset_metadata
+  //
+  // The blocks are placed as per 'temperature'.
   DiskRowSetWriter(RowSetMetadata* rowset_metadata, const Schema* schema,
-                   BloomFilterSizing bloom_sizing);
+                   BloomFilterSizing bloom_sizing,
+                   fs::BlockTemperature temperature = fs::BlockTemperature::DEFAULT);
 
   ~DiskRowSetWriter();
 
@@ -159,6 +165,7 @@ class DiskRowSetWriter {
   const Schema* const schema_;
 
   BloomFilterSizing bloom_sizing_;
+  const fs::BlockTemperature temperature_;
 
   bool finished_;
   rowid_t written_count_;
@@ -166,8 +173,21 @@ class DiskRowSetWriter {
   std::unique_ptr<cfile::BloomFileWriter> bloom_writer_;
   std::unique_ptr<cfile::CFileWriter> ad_hoc_index_writer_;
 
+  // Collects the statistics of the columns written, if computed.
+  std::unique_ptr<ColumnStatsCollector> column_stats_;
+
+  // Computes the checksum of the rows written, if computed, with the version
+  // of the tablet schema they're written with.
+  std::unique_ptr<RowChecksummer> checksummer_;
+  uint64_t checksum_;
+  uint32_t checksum_schema_version_;
+
   // The last encoded key written.
   faststring last_encoded_key_;
+
+  // The bloom hashes of the keys written, from which the rowset's in-memory
+  // key filter is built on Finish(). Empty if the filter isn't built.
+  std::vector<uint32_t> key_hashes_;
 };
 
 
@@ -180,10 +200,12 @@ class RollingDiskRowSetWriter {
  public:
   // Create a new rolling writer. The given 'tablet_metadata' must stay valid
   // for the lifetime of this writer, and is used to construct the new rowsets
-  // that this RollingDiskRowSetWriter creates.
+  // that this RollingDiskRowSetWriter creates. The blocks of the rowsets are
+  // placed as per 'temperature'.
   RollingDiskRowSetWriter(TabletMetadata* tablet_metadata, const Schema& schema,
                           BloomFilterSizing bloom_sizing,
-                          size_t target_rowset_size);
+                          size_t target_rowset_size,
+                          fs::BlockTemperature temperature = fs::BlockTemperature::DEFAULT);
   ~RollingDiskRowSetWriter();
 
   Status Open();
@@ -262,6 +284,7 @@ class RollingDiskRowSetWriter {
   std::shared_ptr<RowSetMetadata> cur_drs_metadata_;
   const BloomFilterSizing bloom_sizing_;
   const size_t target_rowset_size_;
+  const fs::BlockTemperature temperature_;
 
   std::unique_ptr<DiskRowSetWriter> cur_writer_;
 
@@ -344,6 +367,10 @@ class DiskRowSet :
   // Flush all accumulated delta data to disk.
   Status FlushDeltas(const fs::IOContext* io_context) override;
 
+  // Same as above, but the updates of each row which are ancient per
+  // 'history_gc_opts' are coalesced in the flushed delta file.
+  Status FlushDeltas(const fs::IOContext* io_context, const HistoryGcOpts& history_gc_opts);
+
   // Perform delta store minor compaction.
   // This compacts the delta files down to a single one.
   // If there is already only a single delta file, this does nothing.
@@ -372,6 +399,13 @@ class DiskRowSet :
                          const fs::IOContext* io_context,
                          bool *present, ProbeStats* stats) const override;
 
+  // Probes the bloom filter for all of the keys before looking up any of them
+  // in the key index.
+  Status CheckRowsPresent(const std::vector<const RowSetKeyProbe*>& probes,
+                          const fs::IOContext* io_context,
+                          std::vector<bool>* present,
+                          const std::vector<ProbeStats*>& stats) const override;
+
   ////////////////////
   // Read functions.
   ////////////////////
@@ -398,6 +432,10 @@ class DiskRowSet :
   Status GetBounds(std::string* min_encoded_key,
                    std::string* max_encoded_key) const override;
 
+  // See RowSet::GetKeySamples(...)
+  Status GetKeySamples(const fs::IOContext* io_context,
+                       std::shared_ptr<const std::vector<std::string>>* keys) const override;
+
   void GetDiskRowSetSpaceUsage(DiskRowSetSpace* drss) const;
 
   uint64_t OnDiskSize() const override;
@@ -428,6 +466,10 @@ class DiskRowSet :
   Status IsDeletedAndFullyAncient(Timestamp ancient_history_mark,
                                   bool* deleted_and_ancient) override;
 
+  Status IsFullyOlderThan(Timestamp timestamp, bool* older) override;
+
+  bool GetKnownChecksum(const MvccSnapshot& snap, RowSetChecksum* checksum) override;
+
   Status InitUndoDeltas(Timestamp ancient_history_mark,
                         MonoTime deadline,
                         const fs::IOContext* io_context,
@@ -437,9 +479,14 @@ class DiskRowSet :
   Status DeleteAncientUndoDeltas(Timestamp ancient_history_mark, const fs::IOContext* io_context,
                                  int64_t* blocks_deleted, int64_t* bytes_deleted) override;
 
-  // Major compacts all the delta files for all the columns.
+  // Major compacts all the delta files for all the columns. The blocks of the
+  // columns dropped from the schema are removed first, if enabled.
   Status MajorCompactDeltaStores(const fs::IOContext* io_context, HistoryGcOpts history_gc_opts);
 
+  // Removes the base data blocks of the columns dropped from the schema of the
+  // tablet, without rewriting the blocks of the other columns nor the deltas.
+  Status RemoveDroppedColumnBlocks(const fs::IOContext* io_context);
+
   std::mutex *compact_flush_lock() override {
     return &compact_flush_lock_;
   }
@@ -499,6 +546,10 @@ class DiskRowSet :
 
   Status Open(const fs::IOContext* io_context);
 
+  // Returns the IDs of the columns with base data, but no longer in the schema
+  // of the tablet.
+  std::vector<ColumnId> GetDroppedColumnIds() const;
+
   // Create a new major delta compaction object to compact the specified columns.
   Status NewMajorDeltaCompaction(const std::vector<ColumnId>& col_ids,
                                  HistoryGcOpts history_gc_opts,
@@ -117,6 +117,45 @@ TEST_F(LockManagerTest, TestLockBatch) {
   }
 }
 
+// Batches may contain the same key more than once.
+TEST_F(LockManagerTest, TestLockBatchWithDuplicates) {
+  vector<Slice> keys = {"a", "b", "a", "c", "b"};
+  {
+    ScopedRowLock l(&lock_manager_, kFakeTransaction, keys, LockManager::LOCK_EXCLUSIVE);
+    for (const auto& k : keys) {
+      VerifyAlreadyLocked(k);
+    }
+  }
+  ScopedRowLock l(&lock_manager_, kFakeTransaction, keys, LockManager::LOCK_EXCLUSIVE);
+  ASSERT_TRUE(l.acquired());
+}
+
+// Batches of overlapping keys given in different orders don't deadlock, since
+// the keys of each batch are locked in a consistent order.
+TEST_F(LockManagerTest, TestOverlappingBatchesInAnyOrder) {
+  vector<string> key_strs;
+  for (int i = 0; i < 64; i++) {
+    key_strs.push_back(StringPrintf("key%03d", i));
+  }
+  vector<thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      const OpState* op = reinterpret_cast<OpState*>(t + 1);
+      vector<Slice> keys(key_strs.begin(), key_strs.end());
+      if (t % 2 == 1) {
+        std::reverse(keys.begin(), keys.end());
+      }
+      for (int i = 0; i < FLAGS_num_iterations; i++) {
+        ScopedRowLock l(&lock_manager_, op, keys, LockManager::LOCK_EXCLUSIVE);
+        CHECK(l.acquired());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
 TEST_F(LockManagerTest, TestRelockSameRow) {
   Slice key_a[] = {"a"};
   ScopedRowLock row_lock(&lock_manager_, kFakeTransaction, key_a, LockManager::LOCK_EXCLUSIVE);
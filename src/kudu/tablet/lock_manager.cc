@@ -17,6 +17,7 @@
 
 #include "kudu/tablet/lock_manager.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 #include <memory>
@@ -47,7 +48,6 @@
 
 using kudu::tserver::TabletServerErrorPB;
 using std::string;
-using std::unique_lock;
 using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
@@ -61,14 +61,18 @@ namespace tablet {
 
 // The entry returned to a thread which has taken a lock.
 // Callers should generally use ScopedRowLock (see below).
+//
+// Entries are pooled by the LockTable, and reused for other keys once they
+// are released.
 class LockEntry {
  public:
-  explicit LockEntry(const Slice& key)
+  LockEntry()
   : sem(1),
-    recursion_(0) {
-    key_hash_ = util_hash::CityHash64(reinterpret_cast<const char *>(key.data()), key.size());
-    key_ = key;
-    refs_ = 1;
+    recursion_(0),
+    ht_next_(nullptr),
+    key_hash_(0),
+    refs_(0),
+    holder_(nullptr) {
   }
 
   bool Equals(const Slice& key, uint64_t hash) const {
@@ -93,12 +97,18 @@ class LockEntry {
   friend class LockTable;
   friend class LockManager;
 
-  void CopyKey() {
-    key_buf_.assign_copy(key_.data(), key_.size());
+  // Sets the key of the entry, copying it into 'key_buf_'. Since the buffer
+  // is kept when the entry is pooled, this doesn't allocate for keys which
+  // aren't longer than the keys the entry was used for before.
+  void Reset(const Slice& key, uint64_t hash) {
+    key_hash_ = hash;
+    key_buf_.assign_copy(key.data(), key.size());
     key_ = Slice(key_buf_);
+    refs_ = 1;
   }
 
-  // Pointer to the next entry in the same hash table bucket
+  // Pointer to the next entry in the same hash table bucket, or in the pool
+  // of free entries.
   LockEntry *ht_next_;
 
   // Hash of the key, used to lookup the hash table bucket
@@ -110,124 +120,224 @@ class LockEntry {
   // number of users that are referencing this object
   uint64_t refs_;
 
-  // buffer of the key, allocated on insertion by CopyKey()
+  // buffer of the key
   faststring key_buf_;
 
   // The op currently holding the lock
   const OpState* holder_;
 };
 
+// A hash table of the locked keys, split into shards with their own lock so
+// that ops locking unrelated rows rarely contend on it.
 class LockTable {
+ public:
+  LockTable() {
+    for (auto& shard : shards_) {
+      shard.Resize();
+    }
+  }
+
+  ~LockTable() = default;
+
+  // Returns the entries of the given keys, creating them if needed. The
+  // entries are returned ordered by their key hash, then by their key, which
+  // is the order in which they must be locked so that concurrent batches
+  // don't deadlock. Each shard's lock is taken at most once.
+  vector<LockEntry*> GetLockEntries(ArrayView<Slice> keys);
+  LockEntry* GetLockEntry(Slice key);
+
+  // Releases the given entries, which must be ordered as returned by
+  // GetLockEntries().
+  void ReleaseLockEntries(ArrayView<LockEntry*> entries);
+
+  static uint64_t HashKey(const Slice& key) {
+    return util_hash::CityHash64(reinterpret_cast<const char *>(key.data()), key.size());
+  }
+
  private:
+  // The number of shards is a power of two, and shards are picked by the
+  // high bits of the key hashes while buckets are picked by the low ones.
+  static constexpr int kNumShardBits = 4;
+  static constexpr int kNumShards = 1 << kNumShardBits;
+
+  // The maximum number of free entries pooled by each shard.
+  static constexpr int kMaxFreeEntriesPerShard = 128;
+
   struct Bucket {
     // First entry chained from this bucket, or NULL if the bucket is empty.
     LockEntry *chain_head;
     Bucket() : chain_head(nullptr) {}
   };
 
- public:
-  LockTable() : mask_(0), size_(0), item_count_(0) {
-    Resize();
-  }
+  class Shard {
+   public:
+    Shard() : mask_(0), size_(0), item_count_(0), free_head_(nullptr), free_count_(0) {}
 
-  ~LockTable() {
-    // Sanity checks: The table shouldn't be destructed when there are any entries in it.
-    DCHECK_EQ(0, item_count_) << "There are some unreleased locks";
-    for (size_t i = 0; i < size_; ++i) {
-      for (LockEntry *p = buckets_[i].chain_head; p != nullptr; p = p->ht_next_) {
-        DCHECK(p == nullptr) << "The entry " << p->ToString() << " was not released";
+    ~Shard() {
+      // Sanity checks: The table shouldn't be destructed when there are any entries in it.
+      DCHECK_EQ(0, item_count_) << "There are some unreleased locks";
+      for (size_t i = 0; i < size_; ++i) {
+        for (LockEntry *p = buckets_[i].chain_head; p != nullptr; p = p->ht_next_) {
+          DCHECK(p == nullptr) << "The entry " << p->ToString() << " was not released";
+        }
+      }
+      while (free_head_) {
+        auto* tmp = free_head_;
+        free_head_ = free_head_->ht_next_;
+        delete tmp;
       }
     }
-  }
 
-  vector<LockEntry*> GetLockEntries(ArrayView<Slice> keys);
-  LockEntry* GetLockEntry(Slice key);
+    // Returns the entry for 'key', creating it if needed. Requires 'lock_'.
+    LockEntry* GetLockEntryUnlocked(const Slice& key, uint64_t hash);
 
-  void ReleaseLockEntries(ArrayView<LockEntry*> entries);
+    // Drops a reference to 'entry', removing it from the table if that was
+    // the last one. Entries which don't fit in the pool are chained to
+    // '*to_delete'. Requires 'lock_'.
+    void ReleaseLockEntryUnlocked(LockEntry* entry, LockEntry** to_delete);
 
- private:
-  Bucket *FindBucket(uint64_t hash) const {
-    return &(buckets_[hash & mask_]);
-  }
+    Bucket *FindBucket(uint64_t hash) const {
+      return &(buckets_[hash & mask_]);
+    }
+
+    void Resize();
+
+    simple_spinlock lock_;
 
-  // Return a pointer to slot that points to a lock entry that
-  // matches key/hash. If there is no such lock entry, return a
-  // pointer to the trailing slot in the corresponding linked list.
-  LockEntry **FindSlot(Bucket *bucket, const Slice& key, uint64_t hash) const {
-    LockEntry **node = &(bucket->chain_head);
-    while (*node && !(*node)->Equals(key, hash)) {
-      node = &((*node)->ht_next_);
+   private:
+    // Return a pointer to slot that points to a lock entry that
+    // matches key/hash. If there is no such lock entry, return a
+    // pointer to the trailing slot in the corresponding linked list.
+    LockEntry **FindSlot(Bucket *bucket, const Slice& key, uint64_t hash) const {
+      LockEntry **node = &(bucket->chain_head);
+      while (*node && !(*node)->Equals(key, hash)) {
+        node = &((*node)->ht_next_);
+      }
+      return node;
     }
-    return node;
-  }
 
-  // Return a pointer to slot that points to a lock entry that
-  // matches the specified 'entry'.
-  // If there is no such lock entry, NULL is returned.
-  LockEntry **FindEntry(Bucket *bucket, LockEntry *entry) const {
-    for (LockEntry **node = &(bucket->chain_head); *node != nullptr; node = &((*node)->ht_next_)) {
-      if (*node == entry) {
-        return node;
+    // Return a pointer to slot that points to a lock entry that
+    // matches the specified 'entry'.
+    // If there is no such lock entry, NULL is returned.
+    LockEntry **FindEntry(Bucket *bucket, LockEntry *entry) const {
+      for (LockEntry **node = &(bucket->chain_head); *node != nullptr;
+           node = &((*node)->ht_next_)) {
+        if (*node == entry) {
+          return node;
+        }
       }
+      return nullptr;
     }
-    return nullptr;
+
+    // size - 1 used to lookup the bucket (hash & mask_)
+    uint64_t mask_;
+    // number of buckets in the table
+    uint64_t size_;
+    // number of items in the table
+    int64_t item_count_;
+    // table buckets
+    unique_ptr<Bucket[]> buckets_;
+
+    // Pool of free entries, chained through their 'ht_next_' pointers.
+    LockEntry* free_head_;
+    int free_count_;
+
+    DISALLOW_COPY_AND_ASSIGN(Shard);
+  };
+
+  static int ShardIndex(uint64_t hash) {
+    return static_cast<int>(hash >> (64 - kNumShardBits));
   }
 
-  void Resize();
+  Shard shards_[kNumShards];
 
- private:
-  simple_spinlock lock_;
-  // size - 1 used to lookup the bucket (hash & mask_)
-  uint64_t mask_;
-  // number of buckets in the table
-  uint64_t size_;
-  // number of items in the table
-  int64_t item_count_;
-  // table buckets
-  unique_ptr<Bucket[]> buckets_;
+  DISALLOW_COPY_AND_ASSIGN(LockTable);
 };
 
-vector<LockEntry*> LockTable::GetLockEntries(ArrayView<Slice> keys) {
-  vector<LockEntry*> entries(keys.size());
-  for (auto i = 0; i < keys.size(); ++i) {
-    entries[i] = new LockEntry(keys[i]);
+LockEntry* LockTable::Shard::GetLockEntryUnlocked(const Slice& key, uint64_t hash) {
+  DCHECK(lock_.is_locked());
+  Bucket* bucket = FindBucket(hash);
+  LockEntry **node = FindSlot(bucket, key, hash);
+  LockEntry* entry = *node;
+  if (PREDICT_FALSE(entry != nullptr)) {
+    entry->refs_++;
+    return entry;
+  }
+  if (PREDICT_TRUE(free_head_ != nullptr)) {
+    entry = free_head_;
+    free_head_ = entry->ht_next_;
+    free_count_--;
+  } else {
+    entry = new LockEntry();
   }
+  entry->Reset(key, hash);
+  entry->ht_next_ = nullptr;
+  *node = entry;
+  ++item_count_;
 
-  vector<LockEntry*> to_delete;
+  if (PREDICT_FALSE(item_count_ > size_)) {
+    Resize();
+  }
+  return entry;
+}
 
-  // TODO(todd) prefetch the hash buckets
-  {
-    unique_lock<simple_spinlock> l(lock_);
-    for (int i = 0; i < entries.size(); i++) {
-      LockEntry* new_entry = entries[i];
-      Bucket* bucket = FindBucket(new_entry->key_hash_);
-      LockEntry **node = FindSlot(bucket, new_entry->key_, new_entry->key_hash_);
-      LockEntry* old_entry = *node;
-      if (PREDICT_FALSE(old_entry != nullptr)) {
-        old_entry->refs_++;
-        to_delete.push_back(entries[i]);
-        entries[i] = old_entry;
-      } else {
-        new_entry->ht_next_ = nullptr;
-        new_entry->CopyKey();
-        *node = new_entry;
-        ++item_count_;
-
-        if (PREDICT_FALSE(item_count_ > size_)) {
-          Resize();
-        }
-      }
-    }
+void LockTable::Shard::ReleaseLockEntryUnlocked(LockEntry* entry, LockEntry** to_delete) {
+  DCHECK(lock_.is_locked());
+  LockEntry** node = FindEntry(FindBucket(entry->key_hash_), entry);
+  if (PREDICT_FALSE(node == nullptr)) {
+    LOG(DFATAL) << "Unable to find LockEntry on release";
+    return;
+  }
+  if (--entry->refs_ > 0) return;
+
+  *node = entry->ht_next_;
+  item_count_--;
+  if (free_count_ < kMaxFreeEntriesPerShard) {
+    entry->ht_next_ = free_head_;
+    free_head_ = entry;
+    free_count_++;
+  } else {
+    entry->ht_next_ = *to_delete;
+    *to_delete = entry;
   }
+}
 
-  for (auto* e : to_delete) delete e;
+vector<LockEntry*> LockTable::GetLockEntries(ArrayView<Slice> keys) {
+  struct HashedKey {
+    uint64_t hash;
+    Slice key;
+  };
+  vector<HashedKey> hashed_keys;
+  hashed_keys.reserve(keys.size());
+  for (const auto& key : keys) {
+    hashed_keys.push_back({ HashKey(key), key });
+  }
+  if (hashed_keys.size() > 1) {
+    std::sort(hashed_keys.begin(), hashed_keys.end(),
+              [](const HashedKey& a, const HashedKey& b) {
+                if (a.hash != b.hash) return a.hash < b.hash;
+                return a.key.compare(b.key) < 0;
+              });
+  }
 
+  // Since the keys are sorted by hash, the keys of each shard are contiguous.
+  vector<LockEntry*> entries(hashed_keys.size());
+  for (size_t i = 0; i < hashed_keys.size();) {
+    const int shard_idx = ShardIndex(hashed_keys[i].hash);
+    Shard* shard = &shards_[shard_idx];
+    std::lock_guard<simple_spinlock> l(shard->lock_);
+    for (; i < hashed_keys.size() && ShardIndex(hashed_keys[i].hash) == shard_idx; i++) {
+      entries[i] = shard->GetLockEntryUnlocked(hashed_keys[i].key, hashed_keys[i].hash);
+    }
+  }
   return entries;
 }
 
 LockEntry* LockTable::GetLockEntry(Slice key) {
-  vector<LockEntry*> entries = GetLockEntries({&key, 1});
-  return entries[0];
+  const uint64_t hash = HashKey(key);
+  Shard* shard = &shards_[ShardIndex(hash)];
+  std::lock_guard<simple_spinlock> l(shard->lock_);
+  return shard->GetLockEntryUnlocked(key, hash);
 }
 
 void LockTable::ReleaseLockEntries(ArrayView<LockEntry*> entries) {
@@ -235,49 +345,19 @@ void LockTable::ReleaseLockEntries(ArrayView<LockEntry*> entries) {
   // to keep track of which objects need to be deleted.
   LockEntry* removed_head = nullptr;
 
-  const auto& RemoveEntryFromBucket = [&](Bucket* bucket, LockEntry* entry) {
-    LockEntry** node = FindEntry(bucket, entry);
-    if (PREDICT_TRUE(node != nullptr)) {
-      if (--entry->refs_ > 0) return;
-
-      *node = entry->ht_next_;
-      entry->ht_next_ = removed_head;
-      removed_head = entry;
-      item_count_--;
-    } else {
-      LOG(DFATAL) << "Unable to find LockEntry on release";
+  for (size_t i = 0; i < entries.size();) {
+    const int shard_idx = ShardIndex(entries[i]->key_hash_);
+    Shard* shard = &shards_[shard_idx];
+    size_t end = i;
+    while (end < entries.size() && ShardIndex(entries[end]->key_hash_) == shard_idx) {
+      prefetch(reinterpret_cast<const char*>(shard->FindBucket(entries[end]->key_hash_)),
+               PREFETCH_HINT_T0);
+      end++;
     }
-  };
-
-  {
-    unique_lock<simple_spinlock> l(lock_);
-
-    auto it = entries.begin();
-    int rem = entries.size();
-
-    // Manually block the loop into a series of constant-sized batches
-    // followed by one last variable-sized batch for the remainder.
-    //
-    // The batch size was experimentally determined.
-    static constexpr int kBatchSize = 16;
-    LockEntry* batch[kBatchSize];
-    Bucket* buckets[kBatchSize];
-    const auto& ProcessBatch = [&](int n) {
-      for (int i = 0; i < n; i++) {
-        batch[i] = *it++;
-        buckets[i] = FindBucket(batch[i]->key_hash_);
-        prefetch(reinterpret_cast<const char*>(buckets[i]), PREFETCH_HINT_T0);
-      }
-      for (int i = 0; i < n; i++) {
-        RemoveEntryFromBucket(buckets[i], batch[i]);
-      }
-    };
-
-    while (rem >= kBatchSize) {
-      ProcessBatch(kBatchSize);
-      rem -= kBatchSize;
+    std::lock_guard<simple_spinlock> l(shard->lock_);
+    for (; i < end; i++) {
+      shard->ReleaseLockEntryUnlocked(entries[i], &removed_head);
     }
-    ProcessBatch(rem);
   }
 
   // Actually free the memory outside the lock.
@@ -288,7 +368,7 @@ void LockTable::ReleaseLockEntries(ArrayView<LockEntry*> entries) {
   }
 }
 
-void LockTable::Resize() {
+void LockTable::Shard::Resize() {
   // Calculate a new table size
   size_t new_size = 16;
   while (new_size < item_count_) {
@@ -536,6 +616,8 @@ PartitionLockState* LockManager::WaitUntilAcquiredPartitionLock(const TxnId& txn
 }
 
 std::vector<LockEntry*> LockManager::LockBatch(ArrayView<Slice> keys, const OpState* op) {
+  // The entries are ordered consistently across batches, so locking them in
+  // that order can't deadlock with another batch.
   vector<LockEntry*> entries = locks_->GetLockEntries(keys);
 
   for (auto* e : entries) {
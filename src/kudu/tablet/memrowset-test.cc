@@ -17,6 +17,7 @@
 
 #include "kudu/tablet/memrowset.h"
 
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
 #include <initializer_list>
@@ -24,6 +25,7 @@
 #include <optional>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <vector>
@@ -46,6 +48,7 @@
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/strcat.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/mvcc.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/tablet-test-util.h"
@@ -79,6 +82,7 @@ using std::string;
 using std::unique_ptr;
 using std::unordered_set;
 using std::vector;
+using strings::Substitute;
 
 namespace kudu {
 namespace tablet {
@@ -653,6 +657,173 @@ TEST_F(TestMemRowSet, TestUpdateMVCC) {
   }
 }
 
+// Test that folding the mutations of a row into it doesn't change what scans
+// return, and that the snapshots of open iterators are respected.
+TEST_F(TestMemRowSet, TestCompactMutations) {
+  shared_ptr<MemRowSet> mrs;
+  ASSERT_OK(MemRowSet::Create(0, schema_, log_anchor_registry_.get(),
+                              MemTracker::GetRootTracker(), &mrs));
+  ASSERT_OK(InsertRow(mrs.get(), "my row", 0));
+  const MvccSnapshot after_insert(mvcc_);
+  for (uint32_t i = 1; i <= 5; i++) {
+    OperationResultPB result;
+    ASSERT_OK(UpdateRow(mrs.get(), "my row", i, &result));
+  }
+  ASSERT_EQ(5, mrs->num_mutations_to_compact());
+
+  // An open iterator whose snapshot doesn't include the updates prevents them
+  // from being folded.
+  RowIteratorOptions opts;
+  opts.projection = &schema_;
+  opts.snap_to_include = after_insert;
+  int64_t folded;
+  {
+    unique_ptr<MemRowSet::Iterator> iter(mrs->NewIterator(opts));
+    ASSERT_OK(mrs->CompactMutations(clock_.Now(), &folded));
+    ASSERT_EQ(0, folded);
+    ASSERT_OK(iter->Init(nullptr));
+    vector<string> rows;
+    ASSERT_OK(IterateToStringList(iter.get(), &rows));
+    ASSERT_EQ(vector<string>{ R"((string key="my row", uint32 val=0))" }, rows);
+  }
+
+  // All the updates but the last one are folded.
+  ASSERT_OK(mrs->CompactMutations(clock_.Now(), &folded));
+  ASSERT_EQ(4, folded);
+  ASSERT_EQ(0, mrs->num_mutations_to_compact());
+  NO_FATALS(CheckValue(mrs, "my row", R"((string key="my row", uint32 val=5))"));
+
+  // Mutations at or after the bound aren't folded.
+  const Timestamp before_updates = clock_.Now();
+  for (uint32_t i = 6; i <= 8; i++) {
+    OperationResultPB result;
+    ASSERT_OK(UpdateRow(mrs.get(), "my row", i, &result));
+  }
+  ASSERT_OK(mrs->CompactMutations(before_updates, &folded));
+  ASSERT_EQ(1, folded);
+  NO_FATALS(CheckValue(mrs, "my row", R"((string key="my row", uint32 val=8))"));
+
+  // A deleted row stays deleted.
+  OperationResultPB result;
+  ASSERT_OK(DeleteRow(mrs.get(), "my row", &result));
+  ASSERT_OK(mrs->CompactMutations(clock_.Now(), &folded));
+  ASSERT_EQ(3, folded);
+  opts.snap_to_include = MvccSnapshot(mvcc_);
+  ASSERT_EQ(0, ScanAndCount(mrs.get(), opts));
+}
+
+// Test that scans concurrent with the compaction of the mutations of rows with
+// STRING columns never read torn values.
+TEST_F(TestMemRowSet, TestCompactMutationsConcurrentWithScans) {
+  SchemaBuilder builder;
+  ASSERT_OK(builder.AddKeyColumn("key", STRING));
+  ASSERT_OK(builder.AddColumn("val", STRING));
+  const Schema schema = builder.Build();
+  const Schema key_schema = schema.CreateKeyProjection();
+  shared_ptr<MemRowSet> mrs;
+  ASSERT_OK(MemRowSet::Create(0, schema, log_anchor_registry_.get(),
+                              MemTracker::GetRootTracker(), &mrs));
+
+  // Each value is made of a single character, repeated a number of times
+  // which depends on it, so that scans can tell whether a value is torn.
+  const auto value = [](int i) {
+    const char c = 'a' + i % 26;
+    return string(10 + c - 'a', c);
+  };
+  constexpr int kNumRows = 100;
+  const auto row_key = [](int i) { return StringPrintf("row %03d", i); };
+  for (int i = 0; i < kNumRows; i++) {
+    ScopedOp op(&mvcc_, clock_.Now());
+    RowBuilder rb(&schema);
+    rb.AddString(row_key(i));
+    rb.AddString(value(0));
+    op.StartApplying();
+    ASSERT_OK(mrs->Insert(op.timestamp(), rb.row(), op_id_));
+    op.FinishApplying();
+  }
+
+  std::atomic<bool> done(false);
+  vector<std::thread> threads;
+  threads.emplace_back([&] {
+    faststring buf;
+    for (int round = 1; round <= 200; round++) {
+      for (int i = 0; i < kNumRows; i++) {
+        ScopedOp op(&mvcc_, clock_.Now());
+        op.StartApplying();
+        const string new_value = value(round + i);
+        const Slice new_slice(new_value);
+        buf.clear();
+        RowChangeListEncoder update(&buf);
+        update.AddColumnUpdate(schema.column(1), schema.column_id(1), &new_slice);
+        RowBuilder rb(&key_schema);
+        rb.AddString(row_key(i));
+        Arena arena(64);
+        RowSetKeyProbe probe(rb.row(), &arena);
+        ProbeStats stats;
+        OperationResultPB result;
+        CHECK_OK(mrs->MutateRow(op.timestamp(), probe, RowChangeList(buf), op_id_,
+                                nullptr, &stats, &result));
+        op.FinishApplying();
+      }
+    }
+    done = true;
+  });
+  threads.emplace_back([&] {
+    while (!done) {
+      int64_t folded;
+      CHECK_OK(mrs->CompactMutations(mvcc_.GetCleanTimestamp(), &folded));
+    }
+  });
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&] {
+      RowBlockMemory mem(1024);
+      RowBlock block(&schema, 100, &mem);
+      while (!done) {
+        RowIteratorOptions opts;
+        opts.projection = &schema;
+        opts.snap_to_include = MvccSnapshot(mvcc_);
+        unique_ptr<MemRowSet::Iterator> iter(mrs->NewIterator(opts));
+        CHECK_OK(iter->Init(nullptr));
+        int rows = 0;
+        while (iter->HasNext()) {
+          mem.Reset();
+          CHECK_OK(iter->NextBlock(&block));
+          for (int i = 0; i < block.nrows(); i++) {
+            if (!block.selection_vector()->IsRowSelected(i)) {
+              continue;
+            }
+            rows++;
+            const Slice* val = reinterpret_cast<const Slice*>(block.row(i).cell_ptr(1));
+            CHECK_GE(val->size(), 10);
+            const char c = val->data()[0];
+            CHECK_EQ(string(10 + c - 'a', c), val->ToString());
+          }
+        }
+        CHECK_EQ(kNumRows, rows);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The compactions folded the updates without losing the last ones.
+  int64_t folded;
+  ASSERT_OK(mrs->CompactMutations(mvcc_.GetCleanTimestamp(), &folded));
+  RowIteratorOptions opts;
+  opts.projection = &schema;
+  opts.snap_to_include = MvccSnapshot(mvcc_);
+  unique_ptr<MemRowSet::Iterator> iter(mrs->NewIterator(opts));
+  ASSERT_OK(iter->Init(nullptr));
+  vector<string> rows;
+  ASSERT_OK(IterateToStringList(iter.get(), &rows));
+  ASSERT_EQ(kNumRows, rows.size());
+  for (int i = 0; i < kNumRows; i++) {
+    ASSERT_EQ(Substitute(R"((string key="$0", string val="$1"))", row_key(i), value(200 + i)),
+              rows[i]);
+  }
+}
+
 class ParameterizedTestMemRowSet : public TestMemRowSet,
                                    public ::testing::WithParamInterface<std::tuple<bool, bool>> {
 };
@@ -17,7 +17,10 @@
 
 #include "kudu/tablet/memrowset.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -28,13 +31,16 @@
 #include <glog/logging.h>
 
 #include "kudu/codegen/compilation_manager.h"
+#include "kudu/codegen/predicate_evaluator.h"
 #include "kudu/codegen/row_projector.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/row.h"
 #include "kudu/common/row_changelist.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/scan_spec.h"
+#include "kudu/common/types.h"
 #include "kudu/consensus/log_anchor_registry.h"
 #include "kudu/consensus/opid.pb.h"
 #include "kudu/gutil/dynamic_annotations.h"
@@ -53,6 +59,11 @@ DEFINE_bool(mrs_use_codegen, true, "whether the memrowset should use code "
             "generation for iteration");
 TAG_FLAG(mrs_use_codegen, hidden);
 
+DEFINE_bool(mrs_use_codegen_predicates, true, "whether memrowset scans evaluate "
+            "their predicates with a single code-generated function, when the "
+            "predicates allow it and --mrs_use_codegen is set");
+TAG_FLAG(mrs_use_codegen_predicates, hidden);
+
 using kudu::consensus::OpId;
 using kudu::fs::IOContext;
 using kudu::log::LogAnchorRegistry;
@@ -90,6 +101,16 @@ shared_ptr<MemTracker> CreateMemTrackerForMemRowSet(
   return MemTracker::CreateTracker(-1, mem_tracker_id, std::move(parent_tracker));
 }
 
+// Returns the bound below which the snapshots of an iterator with the given
+// options consider all ops applied.
+Timestamp IteratorSnapshotBound(const RowIteratorOptions& opts) {
+  Timestamp bound = opts.snap_to_include.all_applied_before();
+  if (opts.snap_to_exclude) {
+    bound = std::min(bound, opts.snap_to_exclude->all_applied_before());
+  }
+  return bound;
+}
+
 } // anonymous namespace
 
 Status MemRowSet::Create(int64_t id,
@@ -130,7 +151,7 @@ MemRowSet::MemRowSet(int64_t id,
     txn_id_(txn_id),
     txn_metadata_(std::move(txn_metadata)),
     allocator_(new MemoryTrackingBufferAllocator(
-        HeapBufferAllocator::Get(),
+        HugePageBufferAllocator::GetForLargeArenas(),
         CreateMemTrackerForMemRowSet(id, std::move(parent_tracker)))),
     arena_(new ThreadSafeMemoryTrackingArena(kInitialArenaSize, allocator_)),
     tree_(arena_),
@@ -139,10 +160,14 @@ MemRowSet::MemRowSet(int64_t id,
     anchorer_(log_anchor_registry, Substitute("MemRowSet-$0$1", id_, txn_id_ ?
                                               Substitute("(txn_id=$0)", *txn_id) : "")),
     has_been_compacted_(false),
-    live_row_count_(0) {
+    live_row_count_(0),
+    num_mutations_to_compact_(0) {
   CHECK(schema.has_column_ids());
   ANNOTATE_BENIGN_RACE(&debug_insert_count_, "insert count isnt accurate");
   ANNOTATE_BENIGN_RACE(&debug_update_count_, "update count isnt accurate");
+  if (HugePageBufferAllocator::GetForLargeArenas() == HugePageBufferAllocator::Get()) {
+    arena_->SetMaxBufferSize(HugePageBufferAllocator::kHugePageSize);
+  }
 }
 
 MemRowSet::~MemRowSet() {
@@ -288,12 +313,117 @@ Status MemRowSet::MutateRow(Timestamp timestamp,
 
   anchorer_.AnchorIfMinimum(op_id.index());
   debug_update_count_++;
+  num_mutations_to_compact_++;
   if (delta.is_delete()) {
     live_row_count_.IncrementBy(-1);
   }
   return Status::OK();
 }
 
+Status MemRowSet::CompactMutations(Timestamp fold_before, int64_t* folded) {
+  *folded = 0;
+  // Mutations to transactional MemRowSets are only applied once the
+  // transaction commits, which mutation timestamps don't reflect.
+  if (txn_id_) {
+    return Status::OK();
+  }
+  const int64_t num_mutations = num_mutations_to_compact_.load();
+  {
+    std::lock_guard<simple_spinlock> l(iterators_lock_);
+    if (!iterator_snapshots_.empty()) {
+      fold_before = std::min(fold_before, Timestamp(*iterator_snapshots_.begin()));
+    }
+  }
+  unique_ptr<MSBTIter> iter(tree_.NewIterator());
+  iter->SeekToStart();
+  while (iter->IsValid()) {
+    // Only lock the rows which have mutations to fold, as of the snapshot of
+    // the iterator: the mutations appended since are folded next time.
+    MRSRow row(this, iter->GetCurrentValue());
+    const Mutation* head = row.acquire_redo_head();
+    if (head != nullptr && head->acquire_next() != nullptr &&
+        head->timestamp() < fold_before) {
+      RETURN_NOT_OK(CompactRowMutations(iter->GetCurrentKey(), fold_before, folded));
+    }
+    iter->Next();
+  }
+  num_mutations_to_compact_ -= num_mutations;
+  return Status::OK();
+}
+
+Status MemRowSet::CompactRowMutations(const Slice& key, Timestamp fold_before, int64_t* folded) {
+  // Lock the row, so that writers don't append to its mutations while it's
+  // replaced.
+  btree::PreparedMutation<MSBTreeTraits> mutation(key);
+  mutation.Prepare(&tree_);
+  DCHECK(mutation.exists());
+  const Slice current = mutation.leaf()->GetValue(mutation.idx()).as_slice();
+  MRSRow row(this, current);
+
+  // Concurrent scans may be reading the current row, so the mutations are
+  // folded into a copy of it, which replaces it.
+  DEFINE_MRSROW_ON_STACK(this, folded_row, folded_row_slice);
+  DCHECK_EQ(current.size(), folded_row_slice.size());
+  memcpy(folded_row_slice.mutable_data(), current.data(), current.size());
+
+  Mutation* const head = row.acquire_redo_head();
+  Mutation* new_head = head;
+  for (Mutation* mut = head; mut != nullptr;) {
+    Mutation* next = mut->acquire_next();
+    if (next == nullptr || mut->timestamp() >= fold_before) {
+      break;
+    }
+    RowChangeListDecoder decoder(mut->changelist());
+    RETURN_NOT_OK(decoder.Init());
+    if (!decoder.is_update()) {
+      break;
+    }
+    while (decoder.HasNext()) {
+      RowChangeListDecoder::DecodedUpdate update;
+      RETURN_NOT_OK(decoder.DecodeNext(&update));
+      int col_idx;
+      const void* value;
+      RETURN_NOT_OK(update.Validate(schema_, &col_idx, &value));
+      if (col_idx == Schema::kColumnNotFound) {
+        continue;
+      }
+      const ColumnSchema& col = schema_.column(col_idx);
+      if (col.is_nullable()) {
+        folded_row.set_null(col_idx, value == nullptr);
+      }
+      if (value != nullptr) {
+        // The indirect data of BINARY values stays in the mutation, which lives
+        // in the arena as long as the row.
+        memcpy(folded_row.mutable_cell_ptr(col_idx), value, col.type_info()->size());
+      }
+    }
+    new_head = next;
+    (*folded)++;
+    mut = next;
+  }
+  if (new_head != head) {
+    // Scans which read the replaced row walk its whole list of mutations, and
+    // scans which read the folded row walk the mutations after the folded
+    // ones. The last mutation is never folded, so the mutations appended
+    // later on are in both lists.
+    folded_row.header_->redo_head = new_head;
+    mutation.ReplaceValue(folded_row_slice);
+  }
+  return Status::OK();
+}
+
+void MemRowSet::RegisterIteratorSnapshot(Timestamp bound) const {
+  std::lock_guard<simple_spinlock> l(iterators_lock_);
+  iterator_snapshots_.insert(bound.value());
+}
+
+void MemRowSet::UnregisterIteratorSnapshot(Timestamp bound) const {
+  std::lock_guard<simple_spinlock> l(iterators_lock_);
+  auto it = iterator_snapshots_.find(bound.value());
+  DCHECK(it != iterator_snapshots_.end());
+  iterator_snapshots_.erase(it);
+}
+
 Status MemRowSet::CheckRowPresent(const RowSetKeyProbe &probe, const IOContext* /*io_context*/,
                                   bool* present, ProbeStats* stats) const {
   // Use a PreparedMutation here even though we don't plan to mutate. Even though
@@ -430,7 +560,9 @@ MemRowSet::Iterator::Iterator(const std::shared_ptr<const MemRowSet>& mrs,
           GenerateAppropriateProjector(&mrs->schema_nonvirtual(), opts_.projection)),
       delta_projector_(&mrs->schema_nonvirtual(), opts_.projection),
       projection_vc_is_deleted_idx_(opts_.projection->first_is_deleted_virtual_column_idx()),
+      snapshot_bound_(IteratorSnapshotBound(opts_)),
       state_(kUninitialized) {
+  memrowset_->RegisterIteratorSnapshot(snapshot_bound_);
   // TODO(todd): various code assumes that a newly constructed iterator
   // is pointed at the beginning of the dataset. This causes a redundant
   // seek. Could make this lazy instead, or change the semantics so that
@@ -438,7 +570,9 @@ MemRowSet::Iterator::Iterator(const std::shared_ptr<const MemRowSet>& mrs,
   iter_->SeekToStart();
 }
 
-MemRowSet::Iterator::~Iterator() {}
+MemRowSet::Iterator::~Iterator() {
+  memrowset_->UnregisterIteratorSnapshot(snapshot_bound_);
+}
 
 Status MemRowSet::Iterator::Init(ScanSpec *spec) {
   DCHECK_EQ(state_, kUninitialized);
@@ -462,6 +596,32 @@ Status MemRowSet::Iterator::Init(ScanSpec *spec) {
         spec->exclusive_upper_bound_key()->encoded_key());
   }
 
+  // Take over the predicates that can be evaluated by compiled code. If the
+  // code isn't ready yet, they're left to be evaluated one by one by the
+  // caller, as the others.
+  if (spec && FLAGS_mrs_use_codegen && FLAGS_mrs_use_codegen_predicates) {
+    vector<codegen::PredicateEvaluator::ColumnIdxAndPredicate> preds;
+    for (const auto& col_pred : spec->predicates()) {
+      const ColumnPredicate& pred = col_pred.second;
+      int col_idx = opts_.projection->find_column(col_pred.first);
+      if (col_idx != Schema::kColumnNotFound &&
+          codegen::PredicateEvaluator::CanCompile(pred)) {
+        preds.emplace_back(col_idx, pred);
+      }
+    }
+    // Order the predicates by column, so that the same predicates share the
+    // same code regardless of the order of the spec's map.
+    std::sort(preds.begin(), preds.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    if (!preds.empty() &&
+        codegen::CompilationManager::GetSingleton()->RequestPredicateEvaluator(
+            preds, &predicate_evaluator_)) {
+      for (const auto& col_idx_and_pred : predicate_evaluator_->predicates()) {
+        spec->RemovePredicate(col_idx_and_pred.second.column().name());
+      }
+    }
+  }
+
   state_ = kScanning;
   return Status::OK();
 }
@@ -517,6 +677,10 @@ Status MemRowSet::Iterator::NextBlock(RowBlock *dst) {
   // Clear unreached bits by resizing
   dst->Resize(fetched);
 
+  if (predicate_evaluator_) {
+    predicate_evaluator_->Evaluate(dst);
+  }
+
   return Status::OK();
 }
 
@@ -563,11 +727,12 @@ Status MemRowSet::Iterator::FetchRows(RowBlock* dst, size_t* fetched) {
     if (insert_excluded ||
         (txn_meta ? opts_.snap_to_include.IsCommitted(*txn_meta.get()) :
                     opts_.snap_to_include.IsApplied(row.insertion_timestamp()))) {
+      // CompactMutations() never modifies the rows in place, but replaces
+      // them with folded copies whose lists start after the folded mutations.
+      Mutation* redo_head = row.acquire_redo_head();
       RETURN_NOT_OK(projector_->ProjectRowForRead(row, &dst_row, dst->arena()));
 
       // Roll-forward MVCC for committed updates.
-      Mutation* redo_head = reinterpret_cast<Mutation*>(
-          base::subtle::Acquire_Load(reinterpret_cast<AtomicWord*>(&row.header_->redo_head)));
       RETURN_NOT_OK(ApplyMutationsToProjectedRow(
           redo_head, &dst_row, dst->arena(), insert_excluded, &apply_status));
       unset_in_sel_vector = (apply_status == APPLIED_AND_DELETED && !opts_.include_deleted_rows) ||
@@ -728,7 +893,7 @@ Status MemRowSet::Iterator::GetCurrentRow(RowBlockRow* dst_row,
 
     Mutation *prev_redo = nullptr;
     *redo_head = nullptr;
-    for (const Mutation *mut = src_row.redo_head();
+    for (const Mutation *mut = src_row.acquire_redo_head();
          mut != nullptr;
          mut = mut->acquire_next()) {
 
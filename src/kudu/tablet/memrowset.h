@@ -23,6 +23,7 @@
 #include <mutex>
 #include <optional>
 #include <ostream>
+#include <set>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -45,6 +46,7 @@
 #include "kudu/tablet/rowset_metadata.h"
 #include "kudu/util/atomic.h"
 #include "kudu/util/faststring.h"
+#include "kudu/util/locks.h"
 #include "kudu/util/make_shared.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/monotime.h"
@@ -68,6 +70,10 @@ namespace tablet {
 class MvccSnapshot;
 }  // namespace tablet
 
+namespace codegen {
+class PredicateEvaluator;
+}  // namespace codegen
+
 namespace consensus {
 class OpId;
 }  // namespace consensus
@@ -319,6 +325,32 @@ class MemRowSet : public RowSet,
                          const fs::IOContext* io_context,
                          bool* present, ProbeStats* stats) const override;
 
+  // Folds the mutations of the rows into the rows themselves, so that scans
+  // don't have to walk them. For each row, this folds the longest prefix of its
+  // mutation list made of updates with timestamps lower than 'fold_before' and
+  // than the snapshots of the iterators open on this MemRowSet. The last
+  // mutation of each row is always kept in its list, so that concurrent
+  // writers can keep appending to it.
+  //
+  // 'fold_before' must be such that no iterator opened from now on may have a
+  // snapshot which doesn't consider the ops before it applied, i.e. it must be
+  // at or below the tablet's ancient history mark and clean time. Concurrent
+  // scans and writes are safe, but calls to this method must be serialized,
+  // e.g. by 'compact_flush_lock()'. Sets 'folded' to the number of folded
+  // mutations.
+  //
+  // The rows aren't updated in place, since concurrent scans may be reading
+  // them: each compacted row is replaced by a copy of it with its mutations
+  // folded. The replaced rows and the folded mutations stay allocated in the
+  // arena until this MemRowSet is flushed.
+  Status CompactMutations(Timestamp fold_before, int64_t* folded);
+
+  // Returns the number of mutations appended to the rows since their mutations
+  // were last compacted.
+  int64_t num_mutations_to_compact() const {
+    return num_mutations_to_compact_.load();
+  }
+
   // Return the memory footprint of this memrowset.
   // Note that this may be larger than the sum of the data
   // inserted into the memrowset, due to arena and data structure
@@ -429,6 +461,17 @@ class MemRowSet : public RowSet,
     return Status::OK();
   }
 
+  Status IsFullyOlderThan(Timestamp /*timestamp*/, bool* older) override {
+    DCHECK(older);
+    *older = false;
+    return Status::OK();
+  }
+
+  bool GetKnownChecksum(const MvccSnapshot& /*snap*/,
+                        RowSetChecksum* /*checksum*/) override {
+    return false;
+  }
+
   Status InitUndoDeltas(Timestamp /*ancient_history_mark*/,
                         MonoTime /*deadline*/,
                         const fs::IOContext* /*io_context*/,
@@ -471,6 +514,15 @@ class MemRowSet : public RowSet,
 
   Status DebugDumpImpl(int64_t* rows_left, std::vector<std::string>* lines) override;
 
+  // Folds the updates of the row with the encoded key 'key' as described in
+  // CompactMutations(), replacing the row in the tree with a folded copy of it.
+  Status CompactRowMutations(const Slice& key, Timestamp fold_before, int64_t* folded);
+
+  // Registers and unregisters the snapshot bound of an open iterator, below
+  // which it considers all ops applied.
+  void RegisterIteratorSnapshot(Timestamp bound) const;
+  void UnregisterIteratorSnapshot(Timestamp bound) const;
+
   typedef btree::CBTree<MSBTreeTraits> MSBTree;
 
   int64_t id_;
@@ -501,6 +553,15 @@ class MemRowSet : public RowSet,
   // and thus should not be scheduled for further compactions.
   std::atomic<bool> has_been_compacted_;
 
+  // The number of mutations appended to the rows since their mutations were
+  // last compacted.
+  std::atomic<int64_t> num_mutations_to_compact_;
+
+  // The snapshot bounds of the open iterators. Mutations at or above the lowest
+  // one aren't compacted, since some iterator may not apply them.
+  mutable simple_spinlock iterators_lock_;
+  mutable std::multiset<Timestamp::val_type> iterator_snapshots_;
+
   // Number of live rows in this MRS.
   AtomicInt<uint64_t> live_row_count_;
 
@@ -651,6 +712,10 @@ class MemRowSet::Iterator : public RowwiseIterator {
   // or kColumnNotFound if one doesn't exist.
   const int projection_vc_is_deleted_idx_;
 
+  // The bound below which the snapshots of this iterator consider all ops
+  // applied, as registered with the MemRowSet.
+  const Timestamp snapshot_bound_;
+
   // Temporary buffer used for RowChangeList projection.
   faststring delta_buf_;
 
@@ -665,6 +730,11 @@ class MemRowSet::Iterator : public RowwiseIterator {
 
   // Pushed down encoded upper bound key, if any
   std::optional<const Slice> exclusive_upper_bound_;
+
+  // Evaluates the predicates of the scan which could be compiled together,
+  // if their code was ready when the iterator was initialized. These
+  // predicates are removed from the scan spec.
+  std::unique_ptr<codegen::PredicateEvaluator> predicate_evaluator_;
 };
 
 inline const Schema* MRSRow::schema() const {
@@ -19,6 +19,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "kudu/common/timestamp.h"
@@ -153,6 +154,17 @@ class MockRowSet : public RowSet {
     return Status::OK();
   }
 
+  Status IsFullyOlderThan(Timestamp /*timestamp*/, bool* /*older*/) override {
+    LOG(FATAL) << "Unimplemented";
+    return Status::OK();
+  }
+
+  bool GetKnownChecksum(const MvccSnapshot& /*snap*/,
+                        RowSetChecksum* /*checksum*/) override {
+    LOG(FATAL) << "Unimplemented";
+    return false;
+  }
+
   Status EstimateBytesInPotentiallyAncientUndoDeltas(Timestamp /*ancient_history_mark*/,
                                                      EstimateType /*estimate_type*/,
                                                      int64_t* /*bytes*/) override {
@@ -199,6 +211,20 @@ class MockDiskRowSet : public MockRowSet {
     return Status::OK();
   }
 
+  // Makes GetKeySamples() return 'key_samples'.
+  void set_key_samples(std::vector<std::string> key_samples) {
+    key_samples_ = std::make_shared<const std::vector<std::string>>(std::move(key_samples));
+  }
+
+  Status GetKeySamples(const fs::IOContext* /*io_context*/,
+                       std::shared_ptr<const std::vector<std::string>>* keys) const override {
+    if (!key_samples_) {
+      return Status::NotSupported("no key samples");
+    }
+    *keys = key_samples_;
+    return Status::OK();
+  }
+
   uint64_t OnDiskSize() const override {
     return size_;
   }
@@ -226,6 +252,7 @@ class MockDiskRowSet : public MockRowSet {
   const std::string last_key_;
   const uint64_t size_;
   const uint64_t column_size_;
+  std::shared_ptr<const std::vector<std::string>> key_samples_;
 };
 
 // Mock which acts like a MemRowSet and has no known bounds.
@@ -17,10 +17,14 @@
 
 #include "kudu/tablet/multi_column_writer.h"
 
+#include <algorithm>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
 
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h"
@@ -30,8 +34,26 @@
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/dynamic_annotations.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_int32(rowset_writer_column_threads, 4,
+             "Number of threads shared by all the rowset writers of the process "
+             "(on flushes and compactions) to encode and compress the columns of "
+             "wide rowsets in parallel. If 0, each writer encodes all of its "
+             "columns on its own thread.");
+TAG_FLAG(rowset_writer_column_threads, advanced);
+TAG_FLAG(rowset_writer_column_threads, experimental);
+
+DEFINE_int32(rowset_writer_parallel_min_columns, 32,
+             "Minimum number of columns of a rowset for its writer to encode "
+             "the columns in parallel. See --rowset_writer_column_threads.");
+TAG_FLAG(rowset_writer_parallel_min_columns, advanced);
+TAG_FLAG(rowset_writer_parallel_min_columns, experimental);
 
 namespace kudu {
 namespace tablet {
@@ -41,14 +63,37 @@ using fs::BlockCreationTransaction;
 using fs::CreateBlockOptions;
 using fs::WritableBlock;
 using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+// Returns the pool encoding the columns of the writers. It's shared by all
+// the writers, so that the number of threads doesn't grow with the number of
+// concurrent flushes and compactions, and lives for the whole process.
+ThreadPool* ColumnWriterPool() {
+  static ThreadPool* pool = []() {
+    unique_ptr<ThreadPool> pool;
+    CHECK_OK(ThreadPoolBuilder("rowset-col-writer")
+             .set_min_threads(0)
+             .set_max_threads(FLAGS_rowset_writer_column_threads)
+             .Build(&pool));
+    ANNOTATE_LEAKING_OBJECT_PTR(pool.get());
+    return pool.release();
+  }();
+  return pool;
+}
+
+} // anonymous namespace
 
 MultiColumnWriter::MultiColumnWriter(FsManager* fs,
                                      const Schema* schema,
-                                     std::string tablet_id)
+                                     std::string tablet_id,
+                                     fs::BlockTemperature temperature)
   : fs_(fs),
     schema_(schema),
     finished_(false),
-    tablet_id_(std::move(tablet_id)) {
+    tablet_id_(std::move(tablet_id)),
+    temperature_(temperature) {
 }
 
 MultiColumnWriter::~MultiColumnWriter() {
@@ -59,7 +104,7 @@ Status MultiColumnWriter::Open() {
   CHECK(cfile_writers_.empty());
 
   // Open columns.
-  const CreateBlockOptions block_opts({ tablet_id_ });
+  const CreateBlockOptions block_opts({ tablet_id_, temperature_ });
   for (int i = 0; i < schema_->num_columns(); i++) {
     const ColumnSchema &col = schema_->column(i);
 
@@ -77,6 +122,14 @@ Status MultiColumnWriter::Open() {
       opts.write_validx = true;
     }
 
+    // Key columns are already pruned by the rowset's key bounds; keep
+    // per-block statistics for the other columns.
+    opts.write_zone_map = i >= schema_->num_key_columns();
+    opts.write_bloom_filter =
+        col.attributes().bloom_filter && i >= schema_->num_key_columns();
+    opts.write_secondary_index =
+        col.attributes().secondary_index && i >= schema_->num_key_columns();
+
     // Open file for write.
     unique_ptr<WritableBlock> block;
     RETURN_NOT_OK_PREPEND(fs_->CreateNewBlock(block_opts, &block),
@@ -98,11 +151,54 @@ Status MultiColumnWriter::Open() {
   VLOG(1) << strings::Substitute("Opened CFile writers for $0 column(s)",
                                  cfile_writers_.size());
 
+  if (FLAGS_rowset_writer_column_threads > 0 &&
+      schema_->num_columns() >= FLAGS_rowset_writer_parallel_min_columns) {
+    pool_token_ = ColumnWriterPool()->NewToken(ThreadPool::ExecutionMode::CONCURRENT);
+  }
+
   return Status::OK();
 }
 
 Status MultiColumnWriter::AppendBlock(const RowBlock& block) {
-  for (int i = 0; i < schema_->num_columns(); i++) {
+  const size_t num_columns = schema_->num_columns();
+  if (!pool_token_) {
+    return AppendColumns(block, 0, num_columns);
+  }
+
+  // Split the columns into one contiguous range per thread, the first of
+  // which is appended on this thread. This waits for all of them, so the
+  // memory used doesn't grow beyond the writers' own buffers, and each
+  // column gets its entries in the same order as when appended serially.
+  const size_t num_ranges = std::min<size_t>(num_columns,
+                                             FLAGS_rowset_writer_column_threads + 1);
+  const size_t range_size = (num_columns + num_ranges - 1) / num_ranges;
+  vector<Status> statuses(num_ranges);
+  for (size_t r = 1; r < num_ranges; r++) {
+    const size_t begin = r * range_size;
+    const size_t end = std::min(begin + range_size, num_columns);
+    if (begin >= end) {
+      break;
+    }
+    Status* status = &statuses[r];
+    Status s = pool_token_->Submit([this, &block, begin, end, status]() {
+      *status = AppendColumns(block, begin, end);
+    });
+    if (PREDICT_FALSE(!s.ok())) {
+      // The pool is shutting down: append the range here.
+      *status = AppendColumns(block, begin, end);
+    }
+  }
+  statuses[0] = AppendColumns(block, 0, std::min(range_size, num_columns));
+  pool_token_->Wait();
+
+  for (const auto& s : statuses) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
+Status MultiColumnWriter::AppendColumns(const RowBlock& block, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
     ColumnBlock column = block.column_block(i);
     if (column.is_nullable()) {
       RETURN_NOT_OK(cfile_writers_[i]->AppendNullableEntries(column.non_null_bitmap(),
@@ -19,12 +19,14 @@
 
 #include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <glog/logging.h>
 
 #include "kudu/fs/block_id.h"
+#include "kudu/fs/block_manager.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/util/status.h"
 
@@ -33,6 +35,7 @@ namespace kudu {
 class FsManager;
 class RowBlock;
 class Schema;
+class ThreadPoolToken;
 struct ColumnId;
 
 namespace cfile {
@@ -46,12 +49,18 @@ class BlockCreationTransaction;
 namespace tablet {
 
 // Wrapper which writes several columns in parallel corresponding to some
-// Schema. Written blocks will fall in the tablet_id's data dir group.
+// Schema. Written blocks will fall in the tablet_id's data dir group, placed
+// as per 'temperature'.
+//
+// The columns of wide schemas are encoded and compressed on a pool shared by
+// all the writers of the process, each block being appended to all the
+// columns before AppendBlock() returns. See --rowset_writer_column_threads.
 class MultiColumnWriter {
  public:
   MultiColumnWriter(FsManager* fs,
                     const Schema* schema,
-                    std::string tablet_id);
+                    std::string tablet_id,
+                    fs::BlockTemperature temperature = fs::BlockTemperature::DEFAULT);
 
   virtual ~MultiColumnWriter();
 
@@ -81,16 +90,24 @@ class MultiColumnWriter {
   void GetFlushedBlocksByColumnId(std::map<ColumnId, BlockId>* ret) const;
 
  private:
+  // Appends the columns of 'block' in [begin, end) to their writers.
+  Status AppendColumns(const RowBlock& block, size_t begin, size_t end);
+
   FsManager* const fs_;
   const Schema* const schema_;
 
   bool finished_;
 
   const std::string tablet_id_;
+  const fs::BlockTemperature temperature_;
 
   std::vector<cfile::CFileWriter *> cfile_writers_;
   std::vector<BlockId> block_ids_;
 
+  // The token of this writer on the shared column pool, or null if the
+  // columns are appended on the calling thread.
+  std::unique_ptr<ThreadPoolToken> pool_token_;
+
   DISALLOW_COPY_AND_ASSIGN(MultiColumnWriter);
 };
 
@@ -17,9 +17,14 @@
 
 #include "kudu/tablet/mvcc.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <ostream>
+#include <random>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -660,6 +665,35 @@ TEST_F(MvccTest, TestAutomaticCleanTimeMoveToSafeTimeOnApply) {
   ASSERT_EQ(mgr.cur_snap_.ToString(), "MvccSnapshot[applied={T|T < 15 or (T in {15})}]");
 }
 
+// Test that the clean time follows the earliest op in flight as concurrently
+// applied ops finish in any order.
+TEST_F(MvccTest, TestCleanTimeWithOpsFinishingInAnyOrder) {
+  constexpr int kNumOps = 100;
+  MvccManager mgr;
+  vector<unique_ptr<ScopedOp>> ops;
+  for (int i = 1; i <= kNumOps; i++) {
+    ops.emplace_back(new ScopedOp(&mgr, Timestamp(i)));
+  }
+  mgr.AdjustNewOpLowerBound(Timestamp(kNumOps));
+  for (auto& op : ops) {
+    op->StartApplying();
+  }
+
+  vector<int> order(kNumOps);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937 gen(SeedRandom());
+  std::shuffle(order.begin(), order.end(), gen);
+  std::set<int> in_flight(order.begin(), order.end());
+  for (int idx : order) {
+    ops[idx]->FinishApplying();
+    in_flight.erase(idx);
+    const Timestamp expected_clean_time =
+        in_flight.empty() ? Timestamp(kNumOps) : Timestamp(*in_flight.begin() + 1);
+    ASSERT_EQ(expected_clean_time, mgr.GetCleanTimestamp());
+    ASSERT_TRUE(mgr.cur_snap_.IsApplied(Timestamp(idx + 1)));
+  }
+}
+
 // Various death tests which ensure that we can only transition in one of the following
 // valid ways:
 //
@@ -784,6 +818,64 @@ TEST_F(MvccTest, TestCorrectInitWithNoOps) {
   EXPECT_EQ(snap2.applied_timestamps_.size(), 0);
 }
 
+// Snapshots taken while the MVCC state doesn't change share a copy of it,
+// which must be replaced as soon as the state changes.
+TEST_F(MvccTest, TestSnapshotsTrackStateChanges) {
+  MvccManager mgr;
+  mgr.AdjustNewOpLowerBound(clock_.Now());
+  const MvccSnapshot snap1(mgr);
+  ASSERT_EQ(snap1, MvccSnapshot(mgr));
+
+  Timestamp ts = clock_.Now();
+  ScopedOp op(&mgr, ts);
+  op.StartApplying();
+  ASSERT_FALSE(MvccSnapshot(mgr).IsApplied(ts));
+  op.FinishApplying();
+  const MvccSnapshot snap2(mgr);
+  ASSERT_TRUE(snap2.IsApplied(ts));
+  ASSERT_EQ(snap2, MvccSnapshot(mgr));
+
+  mgr.AdjustNewOpLowerBound(ts);
+  const MvccSnapshot snap3(mgr);
+  ASSERT_FALSE(snap2 == snap3);
+  ASSERT_EQ(ts, snap3.all_applied_before());
+  ASSERT_EQ(snap3.all_applied_before(), mgr.GetCleanTimestamp());
+}
+
+// Snapshots taken concurrently with ops applying must include every op which
+// finished applying before they were taken.
+TEST_F(MvccTest, TestConcurrentSnapshotsIncludeAppliedOps) {
+  MvccManager mgr;
+  constexpr int kNumOps = 1000;
+  std::atomic<Timestamp::val_type> last_applied(Timestamp::kMin.value());
+  std::atomic<bool> done(false);
+  vector<thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&] {
+      while (!done) {
+        const Timestamp ts(last_applied.load());
+        const MvccSnapshot snap(mgr);
+        if (ts != Timestamp::kMin) {
+          CHECK(snap.IsApplied(ts)) << ts.ToString() << " " << snap.ToString();
+        }
+        CHECK_LE(ts, mgr.GetCleanTimestamp());
+      }
+    });
+  }
+  for (int i = 0; i < kNumOps; i++) {
+    Timestamp ts = clock_.Now();
+    ScopedOp op(&mgr, ts);
+    mgr.AdjustNewOpLowerBound(ts);
+    op.StartApplying();
+    op.FinishApplying();
+    last_applied = ts.value();
+  }
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+}
+
 class TransactionMvccTest : public MvccTest {
  public:
   // Simulates successfully committing the given transaction by starting an MVCC
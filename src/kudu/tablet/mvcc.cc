@@ -18,6 +18,7 @@
 #include "kudu/tablet/mvcc.h"
 
 #include <algorithm>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <utility>
@@ -50,6 +51,8 @@ using strings::Substitute;
 MvccManager::MvccManager()
   : new_op_timestamp_exc_lower_bound_(Timestamp::kMin),
     earliest_op_in_flight_(Timestamp::kMax),
+    cur_snap_version_(0),
+    clean_time_(Timestamp::kInitialTimestamp.value()),
     open_(true) {
   cur_snap_.type_ = MvccSnapshot::kLatest;
   cur_snap_.all_applied_before_ = Timestamp::kInitialTimestamp;
@@ -173,6 +176,7 @@ void MvccManager::ApplyOpUnlocked(Timestamp timestamp,
 
   // Add to snapshot's applied list
   cur_snap_.AddAppliedTimestamp(timestamp);
+  SnapshotChangedUnlocked();
 
   // If we're applying the earliest op that was in flight, update our cached
   // value.
@@ -185,11 +189,16 @@ void MvccManager::AdvanceEarliestInFlightTimestamp() {
   if (ops_in_flight_.empty()) {
     earliest_op_in_flight_ = Timestamp::kMax;
   } else {
-    earliest_op_in_flight_ = Timestamp(std::min_element(ops_in_flight_.begin(),
-                                                     ops_in_flight_.end())->first);
+    earliest_op_in_flight_ = Timestamp(ops_in_flight_.begin()->first);
   }
 }
 
+void MvccManager::SnapshotChangedUnlocked() {
+  DCHECK(lock_.is_locked());
+  clean_time_.store(cur_snap_.all_applied_before_.value());
+  cur_snap_version_.fetch_add(1);
+}
+
 void MvccManager::AdjustNewOpLowerBound(Timestamp timestamp) {
   std::lock_guard<LockType> l(lock_);
   // No more ops will start with a timestamp that is lower than or
@@ -271,6 +280,7 @@ void MvccManager::AdjustCleanTimeUnlocked() {
   if (cur_snap_.applied_timestamps_.empty()) {
     cur_snap_.none_applied_at_or_after_ = cur_snap_.all_applied_before_;
   }
+  SnapshotChangedUnlocked();
 
   // it may also have unblocked some waiters.
   // Check if someone is waiting for ops to be applied.
@@ -359,16 +369,22 @@ bool MvccManager::AreAllOpsAppliedUnlocked(Timestamp ts) const {
 bool MvccManager::AnyApplyingAtOrBeforeUnlocked(Timestamp ts) const {
   // TODO(todd) this is not actually checking on the applying ops, it's checking on
   // _all in-flight_. Is this a bug?
-  for (const auto& entry : ops_in_flight_) {
-    if (entry.first <= ts.value()) {
-      return true;
-    }
-  }
-  return false;
+  return !ops_in_flight_.empty() && ops_in_flight_.begin()->first <= ts.value();
 }
 
 void MvccManager::TakeSnapshot(MvccSnapshot *snap) const {
+  // If 'cur_snap_' didn't change since it was last published, the published
+  // copy is as recent as any snapshot taken under the lock: an op which
+  // finished applying before this call changed the version before returning.
+  auto published = std::atomic_load(&published_snap_);
+  if (published && published->version == cur_snap_version_.load()) {
+    *snap = published->snap;
+    return;
+  }
   std::lock_guard<LockType> l(lock_);
+  published = std::make_shared<const PublishedSnapshot>(
+      PublishedSnapshot{ cur_snap_version_.load(), cur_snap_ });
+  std::atomic_store(&published_snap_, published);
   *snap = cur_snap_;
 }
 
@@ -408,8 +424,7 @@ Status MvccManager::WaitForApplyingOpsToApply() const {
 }
 
 Timestamp MvccManager::GetCleanTimestamp() const {
-  std::lock_guard<LockType> l(lock_);
-  return cur_snap_.all_applied_before_;
+  return Timestamp(clean_time_.load());
 }
 
 void MvccManager::GetApplyingOpsTimestamps(std::vector<Timestamp>* timestamps) const {
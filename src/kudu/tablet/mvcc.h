@@ -18,10 +18,12 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <glog/logging.h>
@@ -149,6 +151,12 @@ class MvccSnapshot {
     return applied_timestamps_.empty();
   }
 
+  // Returns the timestamp before which all ops are considered applied. For a
+  // clean snapshot, this is the timestamp which determines it.
+  Timestamp all_applied_before() const {
+    return all_applied_before_;
+  }
+
   // Consider the given list of timestamps to be applied in this snapshot,
   // even if they weren't when the snapshot was constructed.
   // This is used in the flush path, where the set of applied ops going into a
@@ -366,6 +374,9 @@ class MvccManager {
 
   // Take a snapshot of the current MVCC state, which indicates which ops have
   // been applied at the time of this call.
+  //
+  // This doesn't take 'lock_' unless the current state changed since the last
+  // snapshot was taken: snapshots taken in between share a copy of it.
   void TakeSnapshot(MvccSnapshot *snapshot) const;
 
   bool InitOpUnlocked(const Timestamp& timestamp);
@@ -427,6 +438,10 @@ class MvccManager {
   // finishes applying or aborts.
   void AdvanceEarliestInFlightTimestamp();
 
+  // Invalidates the published copy of 'cur_snap_' and updates 'clean_time_'.
+  // Must be called with lock_ held, after any change to 'cur_snap_'.
+  void SnapshotChangedUnlocked();
+
   typedef simple_spinlock LockType;
   mutable LockType lock_;
 
@@ -434,8 +449,28 @@ class MvccManager {
   // start and complete through the lifespan of this MvccManager.
   MvccSnapshot cur_snap_;
 
+  // A copy of 'cur_snap_' shared by the snapshots taken while 'cur_snap_'
+  // doesn't change, along with the version of 'cur_snap_' it was copied at.
+  struct PublishedSnapshot {
+    uint64_t version;
+    MvccSnapshot snap;
+  };
+
+  // Incremented whenever 'cur_snap_' changes. Only written with lock_ held.
+  std::atomic<uint64_t> cur_snap_version_;
+
+  // The last published copy of 'cur_snap_'. Only published with lock_ held,
+  // and read with std::atomic_load() without it.
+  mutable std::shared_ptr<const PublishedSnapshot> published_snap_;
+
+  // The value of 'cur_snap_.all_applied_before_', which may be read without
+  // lock_.
+  std::atomic<Timestamp::val_type> clean_time_;
+
   // The set of timestamps corresponding to currently in-flight ops.
-  typedef std::unordered_map<Timestamp::val_type, OpState> InFlightOpsMap;
+  // Ordered, so that the earliest op in flight is found in constant time as
+  // the ops of a busy tablet, which are applied concurrently, finish applying.
+  typedef std::map<Timestamp::val_type, OpState> InFlightOpsMap;
   InFlightOpsMap ops_in_flight_;
 
   // An op timestamp at and below which no new ops can be
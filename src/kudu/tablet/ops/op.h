@@ -116,6 +116,13 @@ class Op {
   // side-effects.
   virtual Status Prepare() = 0;
 
+  // Does the parts of the prepare phase which don't depend on the other ops
+  // of the tablet, on the thread submitting a LEADER op, before its Prepare()
+  // is queued behind those of the other ops of the tablet. This must not take
+  // any lock of the tablet, and Prepare() must check that the work done here
+  // still applies.
+  virtual void PrepareConcurrently() {}
+
   // Aborts the prepare phase.
   virtual void AbortPrepare() {}
 
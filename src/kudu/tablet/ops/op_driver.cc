@@ -49,6 +49,7 @@
 #include "kudu/util/logging.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/profiler_tag.h"
 #include "kudu/util/status_callback.h"
 #include "kudu/util/threadpool.h"
 #include "kudu/util/trace.h"
@@ -70,6 +71,17 @@ namespace tablet {
 
 static const char* kTimestampFieldName = "timestamp";
 
+// Returns the name of the type of ops the CPU time of their apply is
+// attributed to by the continuous profiler.
+static const char* OpTypeName(Op::OpType type) {
+  switch (type) {
+    case Op::WRITE_OP: return "write";
+    case Op::ALTER_SCHEMA_OP: return "alter_schema";
+    case Op::PARTICIPANT_OP: return "participant";
+  }
+  return "unknown";
+}
+
 class FollowerOpCompletionCallback : public OpCompletionCallback {
  public:
   FollowerOpCompletionCallback(const RequestIdPB& request_id,
@@ -224,6 +236,9 @@ void OpDriver::ExecuteAsync() {
     // We're a leader op. Before submitting, check that we are the leader and
     // determine the current term.
     s = consensus_->CheckLeadershipAndBindTerm(mutable_state()->consensus_round());
+    if (s.ok()) {
+      op_->PrepareConcurrently();
+    }
   }
 
   if (s.ok()) {
@@ -523,6 +538,9 @@ void OpDriver::ApplyTask() {
   scoped_refptr<OpDriver> ref(this);
 
   {
+    ScopedProfilerTag tag(Substitute("tablet=$0;op=$1",
+                                     state()->tablet_replica()->tablet_id(),
+                                     OpTypeName(op_type())));
     CommitMsg* commit_msg;
     Status s = op_->Apply(&commit_msg);
     if (PREDICT_FALSE(!s.ok())) {
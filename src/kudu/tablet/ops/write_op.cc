@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cinttypes>
 #include <cstdint>
 #include <ctime>
 #include <new>
@@ -45,6 +46,7 @@
 #include "kudu/gutil/dynamic_annotations.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/walltime.h"
 #include "kudu/rpc/rpc_header.pb.h"
@@ -78,6 +80,13 @@ DEFINE_int32(tablet_inject_latency_on_prepare_write_op_ms, 0,
 TAG_FLAG(tablet_inject_latency_on_prepare_write_op_ms, unsafe);
 TAG_FLAG(tablet_inject_latency_on_prepare_write_op_ms, runtime);
 
+DEFINE_bool(tablet_decode_writes_before_prepare, true,
+            "Whether the operations of the writes a tablet leads are decoded on "
+            "the threads of their RPCs, concurrently, rather than when they are "
+            "prepared, one write of the tablet at a time.");
+TAG_FLAG(tablet_decode_writes_before_prepare, advanced);
+TAG_FLAG(tablet_decode_writes_before_prepare, runtime);
+
 DECLARE_bool(enable_txn_partition_lock);
 
 using std::optional;
@@ -87,6 +96,12 @@ using std::vector;
 using strings::Substitute;
 
 namespace kudu {
+
+namespace cfile {
+extern const char* CFILE_CACHE_MISS_BYTES_METRIC_NAME;
+extern const char* CFILE_CACHE_HIT_BYTES_METRIC_NAME;
+}
+
 namespace tablet {
 
 using consensus::CommitMsg;
@@ -259,6 +274,20 @@ Status WriteOp::Prepare() {
   return Status::OK();
 }
 
+void WriteOp::PrepareConcurrently() {
+  if (!FLAGS_tablet_decode_writes_before_prepare) {
+    return;
+  }
+  TRACE_EVENT0("op", "WriteOp::PrepareConcurrently");
+  // Prepare() reports the errors, if any.
+  Schema client_schema;
+  if (!SchemaFromPB(state_->request()->schema(), &client_schema).ok() ||
+      client_schema.has_column_ids()) {
+    return;
+  }
+  state()->tablet_replica()->tablet()->PredecodeWriteOperations(&client_schema, state());
+}
+
 void WriteOp::AbortPrepare() {
   state()->ReleaseMvccTxn(OpResult::ABORTED);
 }
@@ -335,6 +364,17 @@ void WriteOp::Finish(OpResult result) {
 
   DCHECK_EQ(result, Op::APPLIED);
 
+  // Log the trace of the ops of the writes sampled by the clients, on the
+  // leader as on the followers, so that their latency can be broken down
+  // across the replicas by grepping their logs for the trace id.
+  if (PREDICT_FALSE(state()->request()->has_trace_id())) {
+    const Trace* trace = Trace::CurrentTrace();
+    LOG(INFO) << Substitute("Sampled write $0 applied by $1 replica of tablet $2: $3",
+                            StringPrintf("%016" PRIx64, state()->request()->trace_id()),
+                            DriverType_Name(type()), state()->tablet_replica()->tablet_id(),
+                            trace ? trace->DumpToString() : "<no trace>");
+  }
+
   TRACE("FINISH: Updating metrics");
 
   if (auto* metrics = state_->tablet_replica()->tablet()->metrics();
@@ -469,6 +509,25 @@ void WriteOpState::SetRowOps(vector<DecodedRowOperation> decoded_ops) {
   }
 }
 
+void WriteOpState::SetPredecodedOps(SchemaPtr schema,
+                                    vector<DecodedRowOperation> decoded_ops) {
+  std::lock_guard<simple_spinlock> l(op_state_lock_);
+  predecoded_schema_ = std::move(schema);
+  predecoded_ops_ = std::move(decoded_ops);
+}
+
+bool WriteOpState::TakePredecodedOps(const SchemaPtr& schema,
+                                     vector<DecodedRowOperation>* decoded_ops) {
+  std::lock_guard<simple_spinlock> l(op_state_lock_);
+  const bool matches = predecoded_schema_ && predecoded_schema_ == schema;
+  if (matches) {
+    *decoded_ops = std::move(predecoded_ops_);
+  }
+  predecoded_schema_.reset();
+  predecoded_ops_.clear();
+  return matches;
+}
+
 void WriteOpState::StartApplying() {
   CHECK_NOTNULL(mvcc_op_.get())->StartApplying();
 }
@@ -673,6 +732,8 @@ void WriteOpState::ResetRpcFields() {
     op->~RowOp();
   }
   row_ops_.clear();
+  predecoded_schema_.reset();
+  predecoded_ops_.clear();
 }
 
 string WriteOpState::ToString() const {
@@ -718,6 +779,14 @@ void WriteOpState::FillResponseMetrics(consensus::DriverType type) {
   resp_metrics->set_update_ignore_errors(op_m.update_ignore_errors);
   resp_metrics->set_successful_deletes(op_m.successful_deletes);
   resp_metrics->set_delete_ignore_errors(op_m.delete_ignore_errors);
+  // The blocks read to look up the keys of the rows are counted in the trace
+  // of the op.
+  if (const Trace* trace = Trace::CurrentTrace()) {
+    resp_metrics->set_cfile_cache_miss_bytes(
+        trace->metrics().GetMetric(cfile::CFILE_CACHE_MISS_BYTES_METRIC_NAME));
+    resp_metrics->set_cfile_cache_hit_bytes(
+        trace->metrics().GetMetric(cfile::CFILE_CACHE_HIT_BYTES_METRIC_NAME));
+  }
   if (type == consensus::LEADER && external_consistency_mode() == COMMIT_WAIT) {
     resp_metrics->set_commit_wait_duration_usec(op_m.commit_wait_duration_usec);
   }
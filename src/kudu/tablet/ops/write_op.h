@@ -246,6 +246,16 @@ class WriteOpState : public OpState {
   // Set the 'row_ops' member based on the given decoded operations.
   void SetRowOps(std::vector<DecodedRowOperation> decoded_ops);
 
+  // Keeps the operations decoded against 'schema' before the op is prepared,
+  // for TakePredecodedOps() to return.
+  void SetPredecodedOps(SchemaPtr schema, std::vector<DecodedRowOperation> decoded_ops);
+
+  // If operations were decoded before the op was prepared, against 'schema',
+  // moves them to 'decoded_ops' and returns true. Otherwise, or if they were
+  // decoded against another schema, returns false.
+  bool TakePredecodedOps(const SchemaPtr& schema,
+                         std::vector<DecodedRowOperation>* decoded_ops);
+
   void UpdateMetricsForOp(const RowOp& op);
 
   // Resets this OpState, releasing all locks, destroying all prepared writes,
@@ -329,6 +339,11 @@ class WriteOpState : public OpState {
   // protect schema_at_decode_time_
   SchemaPtr schema_ptr_at_decode_time_;
 
+  // The operations decoded before the op was prepared, and the schema they
+  // were decoded against. See WriteOp::PrepareConcurrently().
+  SchemaPtr predecoded_schema_;
+  std::vector<DecodedRowOperation> predecoded_ops_;
+
   // Lock that protects access to various fields of WriteOpState.
   mutable simple_spinlock op_state_lock_;
 
@@ -362,6 +377,11 @@ class WriteOp : public Op {
   // or isn't authorized.
   Status Prepare() override;
 
+  // Decodes the operations of the request against the current schema of the
+  // tablet, so that the RPC threads of the writes of a busy tablet decode
+  // them concurrently, rather than one at a time in Prepare().
+  void PrepareConcurrently() override;
+
   void AbortPrepare() override;
 
   // Actually starts the Mvcc op and assigns a timestamp to this op.
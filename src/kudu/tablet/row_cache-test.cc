@@ -0,0 +1,192 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tablet/row_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <gtest/gtest.h>
+
+#include "kudu/clock/clock.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/iterator.h"
+#include "kudu/common/partial_row.h"
+#include "kudu/common/scan_spec.h"
+#include "kudu/common/schema.h"
+#include "kudu/tablet/local_tablet_writer.h"
+#include "kudu/tablet/mvcc.h"
+#include "kudu/tablet/rowset.h"
+#include "kudu/tablet/tablet-test-util.h"
+#include "kudu/tablet/tablet.h"
+#include "kudu/tablet/tablet_metrics.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/test_macros.h"
+
+DECLARE_int64(tablet_row_cache_capacity_mb);
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+namespace tablet {
+
+class TabletRowCacheTest : public KuduTabletTest {
+ public:
+  TabletRowCacheTest()
+      : KuduTabletTest(Schema({ ColumnSchema("key", INT32),
+                                ColumnSchema("val", INT32),
+                                ColumnSchema("str", STRING) }, 1)) {
+  }
+
+  void SetUp() override {
+    FLAGS_tablet_row_cache_capacity_mb = 1;
+    KuduTabletTest::SetUp();
+  }
+
+ protected:
+  void Write(RowOperationsPB::Type type, int32_t key, int32_t val, const string& str) {
+    LocalTabletWriter writer(tablet().get(), &client_schema_);
+    KuduPartialRow row(&client_schema_);
+    ASSERT_OK(row.SetInt32(0, key));
+    if (type != RowOperationsPB::DELETE) {
+      ASSERT_OK(row.SetInt32(1, val));
+      ASSERT_OK(row.SetStringCopy(2, str));
+    }
+    ASSERT_OK(writer.Write(type, row));
+  }
+
+  // Looks up 'key' at 'snap', returning the rows found.
+  vector<string> LookUp(int32_t key, const MvccSnapshot& snap, const Schema& projection) {
+    ScanSpec spec;
+    spec.AddPredicate(ColumnPredicate::Equality(schema_.column(0), &key));
+    Arena arena(128);
+    spec.OptimizeScan(schema_, &arena, true);
+
+    RowIteratorOptions opts;
+    opts.projection = &projection;
+    opts.snap_to_include = snap;
+    unique_ptr<RowwiseIterator> iter;
+    CHECK_OK(tablet()->NewRowIterator(std::move(opts), &iter));
+    CHECK_OK(iter->Init(&spec));
+    vector<string> rows;
+    CHECK_OK(IterateToStringList(iter.get(), &rows));
+    return rows;
+  }
+
+  vector<string> LookUp(int32_t key) {
+    return LookUp(key, MvccSnapshot(clock()->Now()), client_schema_);
+  }
+
+  int64_t hits() {
+    return tablet()->metrics()->row_cache_hits->value();
+  }
+
+  int64_t misses() {
+    return tablet()->metrics()->row_cache_misses->value();
+  }
+};
+
+TEST_F(TabletRowCacheTest, TestHitsAndInvalidation) {
+  NO_FATALS(Write(RowOperationsPB::INSERT, 1, 10, "a"));
+  const vector<string> expected = { R"((int32 key=1, int32 val=10, string str="a"))" };
+  ASSERT_EQ(expected, LookUp(1));
+  ASSERT_EQ(0, hits());
+  ASSERT_EQ(1, misses());
+  ASSERT_EQ(expected, LookUp(1));
+  ASSERT_EQ(1, hits());
+
+  // The cached row may be projected.
+  const Schema projection({ ColumnSchema("str", STRING) }, 0);
+  const vector<string> expected_projected = { R"((string str="a"))" };
+  ASSERT_EQ(expected_projected, LookUp(1, MvccSnapshot(clock()->Now()), projection));
+  ASSERT_EQ(2, hits());
+
+  // Writes erase the rows.
+  const MvccSnapshot before_update(clock()->Now());
+  NO_FATALS(Write(RowOperationsPB::UPDATE, 1, 20, "b"));
+  const vector<string> expected_updated = { R"((int32 key=1, int32 val=20, string str="b"))" };
+  ASSERT_EQ(expected_updated, LookUp(1));
+  ASSERT_EQ(2, hits());
+  ASSERT_EQ(expected_updated, LookUp(1));
+  ASSERT_EQ(3, hits());
+
+  // The cached row isn't valid for snapshots older than the update.
+  ASSERT_EQ(expected, LookUp(1, before_update, client_schema_));
+  ASSERT_EQ(3, hits());
+
+  // Absent rows aren't cached.
+  NO_FATALS(Write(RowOperationsPB::DELETE, 1, 0, ""));
+  ASSERT_TRUE(LookUp(1).empty());
+  ASSERT_TRUE(LookUp(1).empty());
+  ASSERT_EQ(3, hits());
+  NO_FATALS(Write(RowOperationsPB::INSERT, 1, 30, "c"));
+  const vector<string> expected_reinserted = { R"((int32 key=1, int32 val=30, string str="c"))" };
+  ASSERT_EQ(expected_reinserted, LookUp(1));
+  ASSERT_EQ(expected_reinserted, LookUp(1));
+  ASSERT_EQ(4, hits());
+}
+
+// Rows read at snapshots which may not include the last write to their stripe
+// aren't cached.
+TEST_F(TabletRowCacheTest, TestStaleReadsNotCached) {
+  const MvccSnapshot before_insert(clock()->Now());
+  NO_FATALS(Write(RowOperationsPB::INSERT, 1, 10, "a"));
+  const MvccSnapshot before_update(clock()->Now());
+  NO_FATALS(Write(RowOperationsPB::UPDATE, 1, 20, "b"));
+  ASSERT_TRUE(LookUp(1, before_insert, client_schema_).empty());
+
+  const vector<string> expected = { R"((int32 key=1, int32 val=10, string str="a"))" };
+  ASSERT_EQ(expected, LookUp(1, before_update, client_schema_));
+  ASSERT_EQ(expected, LookUp(1, before_update, client_schema_));
+  ASSERT_EQ(0, hits());
+
+  const vector<string> expected_updated = { R"((int32 key=1, int32 val=20, string str="b"))" };
+  ASSERT_EQ(expected_updated, LookUp(1));
+  ASSERT_EQ(expected_updated, LookUp(1));
+  ASSERT_EQ(1, hits());
+}
+
+// Scans which aren't point lookups don't go through the cache.
+TEST_F(TabletRowCacheTest, TestRangeScansBypassCache) {
+  NO_FATALS(Write(RowOperationsPB::INSERT, 1, 10, "a"));
+  NO_FATALS(Write(RowOperationsPB::INSERT, 2, 20, "b"));
+  int32_t lower = 1;
+  int32_t upper = 3;
+  ScanSpec spec;
+  spec.AddPredicate(ColumnPredicate::Range(schema_.column(0), &lower, &upper));
+  Arena arena(128);
+  spec.OptimizeScan(schema_, &arena, true);
+  unique_ptr<RowwiseIterator> iter;
+  ASSERT_OK(tablet()->NewRowIterator(client_schema_, &iter));
+  ASSERT_OK(iter->Init(&spec));
+  vector<string> rows;
+  ASSERT_OK(IterateToStringList(iter.get(), &rows));
+  ASSERT_EQ(2, rows.size());
+  ASSERT_EQ(0, hits());
+  ASSERT_EQ(0, misses());
+}
+
+} // namespace tablet
+} // namespace kudu
@@ -0,0 +1,180 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tablet/row_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/encoded_key.h"
+#include "kudu/common/key_util.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/scan_spec.h"
+#include "kudu/common/types.h"
+#include "kudu/tablet/mvcc.h"
+#include "kudu/util/hash_util.h"
+#include "kudu/util/memory/arena.h"
+
+using std::string;
+
+namespace kudu {
+namespace tablet {
+
+namespace {
+
+// A cached row is laid out as the timestamp of the snapshot it was read at,
+// followed by the row in the schema of the cache, followed by its indirect
+// data.
+constexpr size_t kHeaderSize = sizeof(Timestamp::val_type);
+
+// Relocates the indirect data of a row right after it in its entry.
+class EntryAllocator {
+ public:
+  explicit EntryAllocator(uint8_t* data)
+      : pos_(data) {
+  }
+
+  bool RelocateSlice(const Slice& src, Slice* dst) {
+    memcpy(pos_, src.data(), src.size());
+    *dst = Slice(pos_, src.size());
+    pos_ += src.size();
+    return true;
+  }
+
+ private:
+  uint8_t* pos_;
+};
+
+} // anonymous namespace
+
+RowCacheHandle::RowCacheHandle()
+    : row_(nullptr, nullptr) {
+}
+
+RowCache::RowCache(SchemaPtr schema, size_t capacity_bytes, Timestamp now, const string& id)
+    : schema_(std::move(schema)),
+      cache_(NewCache<Cache::EvictionPolicy::LRU>(capacity_bytes, id)) {
+  for (auto& stripe : stripes_) {
+    stripe.last_write = now;
+  }
+}
+
+bool RowCache::Lookup(const Slice& key, const MvccSnapshot& snap, RowCacheHandle* handle) {
+  DCHECK(snap.is_clean());
+  auto h(cache_->Lookup(key, Cache::EXPECT_IN_CACHE));
+  if (!h) {
+    return false;
+  }
+  const Slice value = cache_->Value(h);
+  Timestamp::val_type read_timestamp;
+  memcpy(&read_timestamp, value.data(), kHeaderSize);
+  // Writes applied before the row was read didn't erase it, so it's only
+  // valid for snapshots which include them.
+  if (snap.all_applied_before() < Timestamp(read_timestamp)) {
+    return false;
+  }
+  handle->row_ = ConstContiguousRow(schema_.get(), value.data() + kHeaderSize);
+  handle->handle_ = std::move(h);
+  return true;
+}
+
+void RowCache::Insert(const Slice& key, const MvccSnapshot& snap, const RowBlockRow& row) {
+  DCHECK(snap.is_clean());
+  DCHECK_EQ(schema_.get(), row.schema());
+  const Timestamp read_timestamp = snap.all_applied_before();
+
+  size_t indirect_size = 0;
+  for (size_t i = 0; i < schema_->num_columns(); i++) {
+    const ColumnSchema& col = schema_->column(i);
+    if (col.type_info()->physical_type() == BINARY &&
+        !(col.is_nullable() && row.is_null(i))) {
+      indirect_size += reinterpret_cast<const Slice*>(row.cell_ptr(i))->size();
+    }
+  }
+  const size_t row_size = ContiguousRowHelper::row_size(*schema_);
+
+  Stripe* stripe = StripeFor(key);
+  // The stripe lock is held until the row is inserted, so that a write
+  // racing with this insert either makes it fail or erases the row after it.
+  std::lock_guard<simple_spinlock> l(stripe->lock);
+  if (read_timestamp <= stripe->last_write) {
+    // The snapshot may not include a write to this row.
+    return;
+  }
+  auto pending(cache_->Allocate(key, kHeaderSize + row_size + indirect_size));
+  if (!pending) {
+    return;
+  }
+  uint8_t* value = cache_->MutableValue(&pending);
+  const Timestamp::val_type read_timestamp_val = read_timestamp.value();
+  memcpy(value, &read_timestamp_val, kHeaderSize);
+  ContiguousRow dst(schema_.get(), value + kHeaderSize);
+  EntryAllocator allocator(value + kHeaderSize + row_size);
+  CHECK_OK(CopyRow(row, &dst, &allocator));
+  cache_->Insert(std::move(pending), nullptr);
+}
+
+void RowCache::Invalidate(const Slice& key, Timestamp timestamp) {
+  Stripe* stripe = StripeFor(key);
+  {
+    std::lock_guard<simple_spinlock> l(stripe->lock);
+    stripe->last_write = std::max(stripe->last_write, timestamp);
+  }
+  // Any insert of the row after this point sees the new timestamp, so any
+  // cached version of the row is erased for good.
+  cache_->Erase(key);
+}
+
+bool RowCache::IsPointLookup(const Schema& schema, const ScanSpec& spec, Arena* arena) {
+  const EncodedKey* lower = spec.lower_bound_key();
+  const EncodedKey* upper = spec.exclusive_upper_bound_key();
+  if (lower == nullptr || upper == nullptr || !spec.predicates().empty() ||
+      spec.CanShortCircuit() || lower->raw_keys().size() != schema.num_key_columns()) {
+    return false;
+  }
+
+  // The scan selects a single row if its exclusive upper bound is the
+  // successor of its lower bound.
+  uint8_t* buf = static_cast<uint8_t*>(
+      arena->AllocateBytes(ContiguousRowHelper::row_size(schema)));
+  if (buf == nullptr) {
+    return false;
+  }
+  ContiguousRow row(&schema, buf);
+  for (size_t i = 0; i < schema.num_key_columns(); i++) {
+    memcpy(row.mutable_cell_ptr(i), lower->raw_keys()[i], schema.column(i).type_info()->size());
+  }
+  if (!key_util::IncrementPrimaryKey(&row, arena)) {
+    return false;
+  }
+  const EncodedKey* successor = EncodedKey::FromContiguousRow(ConstContiguousRow(row), arena);
+  return successor->encoded_key() == upper->encoded_key();
+}
+
+RowCache::Stripe* RowCache::StripeFor(const Slice& key) {
+  return &stripes_[HashUtil::FastHash64(key.data(), key.size(), 0) % kNumStripes];
+}
+
+} // namespace tablet
+} // namespace kudu
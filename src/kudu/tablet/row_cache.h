@@ -0,0 +1,127 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "kudu/common/row.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/timestamp.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/cache.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/slice.h"
+
+namespace kudu {
+
+class Arena;
+class RowBlockRow;
+class ScanSpec;
+
+namespace tablet {
+
+class MvccSnapshot;
+
+// A reference to a row held by a RowCache. The row remains valid for as long
+// as the handle is alive.
+class RowCacheHandle {
+ public:
+  RowCacheHandle();
+
+  const ConstContiguousRow& row() const {
+    return row_;
+  }
+
+ private:
+  friend class RowCache;
+
+  Cache::UniqueHandle handle_;
+  ConstContiguousRow row_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowCacheHandle);
+};
+
+// A cache of the rows of a tablet, keyed by their encoded primary key, which
+// serves point lookups of hot rows without going through the rowsets.
+//
+// Each cached row is tagged with the timestamp T of the clean snapshot it was
+// read at, and is valid for any clean snapshot at or after T: writes to the
+// row erase it before they're applied so, as long as it's cached, nothing
+// changed it since T.
+//
+// A read racing with a write to the same row could still cache a stale row
+// after the write erased it. To prevent that, the keys are hashed into stripes
+// which record the highest timestamp written to any of their keys, and rows
+// read at snapshots which don't include that timestamp aren't cached.
+//
+// Only rows which exist are cached, so the inserts of new rows don't need to
+// be tracked.
+class RowCache {
+ public:
+  // Creates a cache of 'capacity_bytes' for rows of 'schema'. 'now' must be
+  // at or after the timestamp of any write already applied to the tablet.
+  RowCache(SchemaPtr schema, size_t capacity_bytes, Timestamp now, const std::string& id);
+
+  // The schema of the cached rows.
+  const SchemaPtr& schema() const {
+    return schema_;
+  }
+
+  // Looks up the row whose encoded primary key is 'key', as of the clean
+  // snapshot 'snap'. Returns true and sets 'handle' if the cache has a row
+  // which is valid for 'snap'.
+  bool Lookup(const Slice& key, const MvccSnapshot& snap, RowCacheHandle* handle);
+
+  // Caches 'row', read at the clean snapshot 'snap' with the schema of the
+  // cache. The row isn't cached if a write to a key of the same stripe may
+  // have been applied at or after the timestamp of 'snap'.
+  void Insert(const Slice& key, const MvccSnapshot& snap, const RowBlockRow& row);
+
+  // Erases the row whose encoded primary key is 'key', which is about to be
+  // written at 'timestamp'. Must be called before the write is applied in MVCC.
+  void Invalidate(const Slice& key, Timestamp timestamp);
+
+  // Returns true if 'spec' selects exactly the row whose encoded primary key
+  // is the lower bound of the scan, with no other predicate.
+  static bool IsPointLookup(const Schema& schema, const ScanSpec& spec, Arena* arena);
+
+ private:
+  // The number of stripes the keys are hashed into.
+  static constexpr size_t kNumStripes = 256;
+
+  struct Stripe {
+    simple_spinlock lock;
+
+    // The highest timestamp of a write to any key of the stripe.
+    Timestamp last_write;
+  };
+
+  Stripe* StripeFor(const Slice& key);
+
+  const SchemaPtr schema_;
+
+  std::unique_ptr<Cache> cache_;
+
+  Stripe stripes_[kNumStripes];
+
+  DISALLOW_COPY_AND_ASSIGN(RowCache);
+};
+
+} // namespace tablet
+} // namespace kudu
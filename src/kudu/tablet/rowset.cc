@@ -47,12 +47,29 @@ RowIteratorOptions::RowIteratorOptions()
     : projection(nullptr),
       snap_to_include(MvccSnapshot::CreateSnapshotIncludingAllOps()),
       order(OrderMode::UNORDERED),
-      include_deleted_rows(false) {}
+      include_deleted_rows(false),
+      scan_pool(nullptr),
+      max_parallelism(1),
+      known_rowset_checksums(nullptr) {}
 
 Status RowSet::DebugDump(std::vector<std::string>* lines) {
   return DebugDumpImpl(nullptr /* rows_left */, lines);
 }
 
+Status RowSet::CheckRowsPresent(const vector<const RowSetKeyProbe*>& probes,
+                                const IOContext* io_context,
+                                vector<bool>* present,
+                                const vector<ProbeStats*>& stats) const {
+  DCHECK_EQ(probes.size(), stats.size());
+  present->resize(probes.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    bool row_present;
+    RETURN_NOT_OK(CheckRowPresent(*probes[i], io_context, &row_present, stats[i]));
+    (*present)[i] = row_present;
+  }
+  return Status::OK();
+}
+
 Status RowSet::NewRowIteratorWithBounds(const RowIteratorOptions& opts,
                                         IterWithBounds* out) const {
   // Get the iterator.
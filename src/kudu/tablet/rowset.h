@@ -46,6 +46,7 @@ class RowChangeList;
 class RowwiseIterator;
 class Schema;
 class Slice;
+class ThreadPool;
 struct ColumnId;
 struct IterWithBounds;
 
@@ -65,6 +66,13 @@ class RowSetKeyProbe;
 class RowSetMetadata;
 struct ProbeStats;
 
+// The checksum of a set of rows, as computed by the checksum scans of the
+// tablet servers (see RowChecksummer), and the number of rows.
+struct RowSetChecksum {
+  uint64_t checksum = 0;
+  int64_t num_rows = 0;
+};
+
 // Encapsulates all options passed to row-based Iterators.
 struct RowIteratorOptions {
   RowIteratorOptions();
@@ -101,6 +109,23 @@ struct RowIteratorOptions {
   //
   // Defaults to false.
   bool include_deleted_rows;
+
+  // The pool to read from several rowsets at once on, in an UNORDERED
+  // iteration over a tablet, and the maximum number of rowsets read from at
+  // once. Rowsets are read one after the other if unset or if
+  // 'max_parallelism' is 1.
+  //
+  // Defaults to nullptr and 1.
+  ThreadPool* scan_pool;
+  int max_parallelism;
+
+  // If not null, an iteration over a tablet leaves out the rowsets whose
+  // checksums as of 'snap_to_include' are known without reading them (see
+  // RowSet::GetKnownChecksum()), adding their checksums to it instead. Only
+  // for checksum scans of all the rows and columns of a tablet.
+  //
+  // Defaults to nullptr.
+  RowSetChecksum* known_rowset_checksums;
 };
 
 class RowSet {
@@ -132,6 +157,16 @@ class RowSet {
   virtual Status CheckRowPresent(const RowSetKeyProbe &probe, const fs::IOContext* io_context,
                                  bool *present, ProbeStats* stats) const = 0;
 
+  // Like CheckRowPresent(), for each of 'probes', which must be sorted by
+  // increasing key. Sets the i-th entry of 'present' for the i-th probe,
+  // accounting its work in 'stats[i]'.
+  //
+  // The default implementation checks the keys one at a time.
+  virtual Status CheckRowsPresent(const std::vector<const RowSetKeyProbe*>& probes,
+                                  const fs::IOContext* io_context,
+                                  std::vector<bool>* present,
+                                  const std::vector<ProbeStats*>& stats) const;
+
   // Update/delete a row in this rowset.
   // The 'update_schema' is the client schema used to encode the 'update' RowChangeList.
   //
@@ -184,6 +219,18 @@ class RowSet {
   virtual Status GetBounds(std::string* min_encoded_key,
                            std::string* max_encoded_key) const = 0;
 
+  // Sets 'keys' to encoded keys sampled at evenly spaced row ordinals of this
+  // RowSet, in increasing order, including its first and last keys. These
+  // approximate the distribution of the rows over the key range, e.g. to
+  // split it into chunks of similar sizes.
+  //
+  // Returns Status::NotSupported if the RowSet can't be sampled (e.g. if it's
+  // still mutable).
+  virtual Status GetKeySamples(const fs::IOContext* /*io_context*/,
+                               std::shared_ptr<const std::vector<std::string>>* /*keys*/) const {
+    return Status::NotSupported("key samples not supported for this rowset");
+  }
+
   // Return a displayable string for this rowset.
   virtual std::string ToString() const = 0;
 
@@ -242,6 +289,19 @@ class RowSet {
   virtual Status IsDeletedAndFullyAncient(Timestamp ancient_history_mark,
                                           bool* deleted_and_ancient) = 0;
 
+  // Returns whether all the data of the rowset is older than 'timestamp', i.e.
+  // its newest insert and its newest update both are.
+  //
+  // This may return false negatives, but should not return false positives.
+  virtual Status IsFullyOlderThan(Timestamp timestamp, bool* older) = 0;
+
+  // Returns whether the checksum of the rows of the rowset as of 'snap', with
+  // all the columns of the tablet schema as their projection, is known without
+  // reading them, setting 'checksum' to it if so.
+  //
+  // This may return false negatives, but should not return false positives.
+  virtual bool GetKnownChecksum(const MvccSnapshot& snap, RowSetChecksum* checksum) = 0;
+
   // Estimate the number of bytes in ancient undo delta stores. This may be an
   // overestimate or an underestimate depending on 'estimate_type,. The argument
   // 'ancient_history_mark' must be valid: it must not be equal to
@@ -505,6 +565,17 @@ class DuplicatingRowSet : public RowSet {
     return Status::OK();
   }
 
+  Status IsFullyOlderThan(Timestamp /*timestamp*/, bool* older) override {
+    DCHECK(older);
+    *older = false;
+    return Status::OK();
+  }
+
+  bool GetKnownChecksum(const MvccSnapshot& /*snap*/,
+                        RowSetChecksum* /*checksum*/) override {
+    return false;
+  }
+
   Status InitUndoDeltas(Timestamp /*ancient_history_mark*/,
                         MonoTime /*deadline*/,
                         const fs::IOContext* /*io_context*/,
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -183,6 +184,47 @@ double StringFractionInRange(const RowSetInfo* rsi,
   return static_cast<double>(imax_int - imin_int) / (max_int - min_int);
 }
 
+// Returns how far between 'min' and 'max' the key 'k' falls, as a fraction
+// of the keyspace between them.
+// Requires that 'k' is contained in [min, max].
+double KeyPositionInRange(const Slice& min, const Slice& max, const Slice& k) {
+  int common_prefix = CommonPrefix(min, max);
+  uint64_t min_int = SliceTailToInt(min, common_prefix);
+  uint64_t max_int = SliceTailToInt(max, common_prefix);
+  uint64_t k_int = SliceTailToInt(k, common_prefix);
+  if (min_int >= max_int) return 0;
+  k_int = std::min(std::max(k_int, min_int), max_int);
+  return static_cast<double>(k_int - min_int) / (max_int - min_int);
+}
+
+// Returns the estimated rank of 'k' among 'samples', i.e. the number of
+// sampled keys before it, interpolated between adjacent samples.
+double RankInSamples(const vector<string>& samples, const Slice& k) {
+  DCHECK_GE(samples.size(), 2);
+  if (k <= Slice(samples.front())) return 0;
+  if (k >= Slice(samples.back())) return samples.size() - 1;
+  auto it = std::upper_bound(samples.begin(), samples.end(), k,
+                             [](const Slice& a, const string& b) { return a < Slice(b); });
+  size_t j = std::distance(samples.begin(), it) - 1;
+  return j + KeyPositionInRange(samples[j], samples[j + 1], k);
+}
+
+// Finds the fraction of the data of the rowset which (imin, imax) contains.
+// If keys were sampled from the rowset, this follows the distribution of the
+// samples. Otherwise, the data is assumed to be spread uniformly over the key
+// range of the rowset: see StringFractionInRange().
+// Requires that (imin, imax) is contained in rs->GetBounds().
+double FractionInRange(const RowSetInfo* rsi,
+                       const Slice& imin,
+                       const Slice& imax) {
+  const vector<string>* samples = rsi->key_samples();
+  if (!samples) {
+    return StringFractionInRange(rsi, imin, imax);
+  }
+  return (RankInSamples(*samples, imax) - RankInSamples(*samples, imin)) /
+      (samples->size() - 1);
+}
+
 // Computes the "width" of an interval [prev, next] according to the amount
 // of data estimated to be inside the interval, where this is calculated by
 // multiplying the fraction that the interval takes up in the keyspace of
@@ -194,7 +236,7 @@ double WidthByDataSize(const Slice& prev, const Slice& next,
   double weight = 0;
 
   for (const auto& rs_rsi : active) {
-    double fraction = StringFractionInRange(rs_rsi.second, prev, next);
+    double fraction = FractionInRange(rs_rsi.second, prev, next);
     weight += rs_rsi.second->base_and_redos_size_bytes() * fraction;
   }
 
@@ -208,7 +250,7 @@ double WidthByDataSize(const Slice& prev, const Slice& next,
   double weight = 0;
 
   for (const auto& rs_rsi : active) {
-    double fraction = StringFractionInRange(rs_rsi.second, prev, next);
+    double fraction = FractionInRange(rs_rsi.second, prev, next);
     for (const auto& col_id : col_ids) {
       weight += rs_rsi.second->size_bytes(col_id) * fraction;
     }
@@ -382,7 +424,9 @@ void RowSetInfo::SplitKeyRange(const RowSetTree& tree,
                                Slice stop_key,
                                const std::vector<ColumnId>& col_ids,
                                uint64_t target_chunk_size,
-                               vector<KeyRange>* ranges) {
+                               vector<KeyRange>* ranges,
+                               bool sample_keys,
+                               const fs::IOContext* io_context) {
   // check start_key greater than stop_key
   CHECK(stop_key.empty() || start_key <= stop_key);
 
@@ -400,6 +444,10 @@ void RowSetInfo::SplitKeyRange(const RowSetTree& tree,
   // The algorithm keeps track of its state - a "sliding window"
   // across the keyspace - by maintaining the previous key and current
   // value of the total data size traversed over the intervals.
+  //
+  // If keys were sampled from the rowsets, the samples of the active rowsets
+  // which fall between two endpoints split the interval between them further,
+  // so that chunks may end within rowsets.
   vector<RowSetInfo> active_rsi;
   active_rsi.reserve(tree.all_rowsets().size());
   unordered_map<RowSet*, RowSetInfo*> active;
@@ -407,6 +455,27 @@ void RowSetInfo::SplitKeyRange(const RowSetTree& tree,
   Slice last_bound = start_key;
   Slice prev = start_key;
   Slice next;
+  vector<Slice> sampled_keys;
+
+  // Moves the window across the interval [prev, to].
+  const auto advance = [&](const Slice& to) {
+    uint64_t interval_size = 0;
+    if (col_ids.empty()) {
+      interval_size = WidthByDataSize(prev, to, active);
+    } else {
+      interval_size = WidthByDataSize(prev, to, active, col_ids);
+    }
+
+    if (chunk_size != 0 && chunk_size + interval_size / 2 >= target_chunk_size) {
+      // Select the interval closest to the target chunk size
+      ranges->push_back(KeyRange(
+          last_bound.ToString(), prev.ToString(), chunk_size));
+      last_bound = prev;
+      chunk_size = 0;
+    }
+    chunk_size += interval_size;
+    prev = to;
+  };
 
   for (const auto& rse : tree.key_endpoints()) {
     RowSet* rs = rse.rowset_;
@@ -418,22 +487,27 @@ void RowSetInfo::SplitKeyRange(const RowSetTree& tree,
         next = stop_key;
       }
 
-      uint64_t interval_size = 0;
-      if (col_ids.empty()) {
-        interval_size = WidthByDataSize(prev, next, active);
-      } else {
-        interval_size = WidthByDataSize(prev, next, active, col_ids);
-      }
-
-      if (chunk_size != 0 && chunk_size + interval_size / 2 >= target_chunk_size) {
-        // Select the interval closest to the target chunk size
-        ranges->push_back(KeyRange(
-            last_bound.ToString(), prev.ToString(), chunk_size));
-        last_bound = prev;
-        chunk_size = 0;
+      if (sample_keys) {
+        sampled_keys.clear();
+        for (const auto& rs_rsi : active) {
+          const vector<string>* samples = rs_rsi.second->key_samples();
+          if (!samples) continue;
+          auto first = std::upper_bound(
+              samples->begin(), samples->end(), prev,
+              [](const Slice& a, const string& b) { return a < Slice(b); });
+          auto last = std::lower_bound(
+              first, samples->end(), next,
+              [](const string& a, const Slice& b) { return Slice(a) < b; });
+          sampled_keys.insert(sampled_keys.end(), first, last);
+        }
+        std::sort(sampled_keys.begin(), sampled_keys.end());
+        sampled_keys.erase(std::unique(sampled_keys.begin(), sampled_keys.end()),
+                           sampled_keys.end());
+        for (const Slice& key : sampled_keys) {
+          advance(key);
+        }
       }
-      chunk_size += interval_size;
-      prev = next;
+      advance(next);
     }
 
     if (!stop_key.empty() && prev >= stop_key) {
@@ -444,7 +518,12 @@ void RowSetInfo::SplitKeyRange(const RowSetTree& tree,
     if (rse.endpoint_ == RowSetTree::START) {
       // Store reference from vector. This is safe b/c of reserve() above.
       active_rsi.push_back(RowSetInfo(rs, 0));
-      active.insert(std::make_pair(rs, &active_rsi.back()));
+      RowSetInfo* rsi = &active_rsi.back();
+      if (sample_keys && rsi->has_bounds() &&
+          (start_key.empty() || Slice(rsi->max_key()) > start_key)) {
+        rsi->LoadKeySamples(io_context);
+      }
+      active.insert(std::make_pair(rs, rsi));
     } else if (rse.endpoint_ == RowSetTree::STOP) {
       CHECK_EQ(active.erase(rs), 1);
     } else {
@@ -477,6 +556,22 @@ RowSetInfo::RowSetInfo(RowSet* rs, double init_cdf)
                                   kMinSizeMb);
 }
 
+void RowSetInfo::LoadKeySamples(const fs::IOContext* io_context) {
+  shared_ptr<const vector<string>> samples;
+  Status s = extra_->rowset->GetKeySamples(io_context, &samples);
+  if (!s.ok()) {
+    if (!s.IsNotSupported()) {
+      KLOG_EVERY_N_SECS(WARNING, 60) << "Could not sample the keys of "
+                                     << extra_->rowset->ToString() << ": " << s.ToString();
+    }
+    return;
+  }
+  // A single sample says nothing about the distribution of the keys.
+  if (samples->size() >= 2) {
+    extra_->key_samples = std::move(samples);
+  }
+}
+
 uint64_t RowSetInfo::size_bytes(const ColumnId& col_id) const {
   return extra_->rowset->OnDiskBaseDataColumnSize(col_id);
 }
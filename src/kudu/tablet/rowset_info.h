@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -32,6 +33,10 @@ namespace kudu {
 class KeyRange;
 struct ColumnId;
 
+namespace fs {
+struct IOContext;
+} // namespace fs
+
 namespace tablet {
 
 class RowSet;
@@ -71,12 +76,20 @@ class RowSetInfo {
   // If col_ids specified, then the size estimate used for 'target_chunk_size'
   // should only include these columns. This can be used if a query will
   // only scan a certain subset of the columns.
+  //
+  // If 'sample_keys' is true, the keys sampled from the rowsets (see
+  // RowSet::GetKeySamples()) estimate how their data is distributed over
+  // their key ranges, and are candidate split points within the rowsets.
+  // Otherwise, the data of each rowset is assumed to be spread uniformly over
+  // its key range, and the ranges are only split at the bounds of rowsets.
   static void SplitKeyRange(const RowSetTree& tree,
                             Slice start_key,
                             Slice stop_key,
                             const std::vector<ColumnId>& col_ids,
                             uint64 target_chunk_size,
-                            std::vector<KeyRange>* ranges);
+                            std::vector<KeyRange>* ranges,
+                            bool sample_keys = false,
+                            const fs::IOContext* io_context = nullptr);
 
   // Current implementation of CompactRowSetsOp loads all the rowset's delta
   // data into the memory. Doing so, it unpacks and decodes the data that
@@ -122,6 +135,12 @@ class RowSetInfo {
 
   RowSet* rowset() const { return extra_->rowset; }
 
+  // The keys sampled from the rowset, or nullptr if not loaded. See
+  // RowSet::GetKeySamples().
+  const std::vector<std::string>* key_samples() const {
+    return extra_->key_samples.get();
+  }
+
   std::string ToString() const;
 
   // Return true if this candidate overlaps the other candidate in
@@ -136,6 +155,9 @@ class RowSetInfo {
 
   static void FinalizeCDFVector(double quot, std::vector<RowSetInfo>* vec);
 
+  // Loads the keys sampled from the rowset, if it supports it.
+  void LoadKeySamples(const fs::IOContext* io_context);
+
   // The size of the base data and redos in MB, already clamped so that all
   // rowsets have size at least 1MB. This is cached to avoid the branch during
   // the selection hot path.
@@ -175,6 +197,9 @@ class RowSetInfo {
 
     // The original RowSet that this RowSetInfo was constructed from.
     RowSet* rowset;
+
+    // The keys sampled from the rowset, only loaded when splitting key ranges.
+    std::shared_ptr<const std::vector<std::string>> key_samples;
   };
   const scoped_refptr<ExtraData> extra_;
 };
@@ -75,6 +75,7 @@ Status RowSetMetadata::InitFromPB(const RowSetDataPB& pb) {
 
 void RowSetMetadata::LoadFromPB(const RowSetDataPB& pb) {
   std::lock_guard<LockType> l(lock_);
+  version_++;
   id_ = pb.id();
 
   // Load the min/max keys.
@@ -123,6 +124,19 @@ void RowSetMetadata::LoadFromPB(const RowSetDataPB& pb) {
   if (tablet_metadata_->supports_live_row_count()) {
     live_row_count_ = pb.live_row_count();
   }
+
+  newest_base_timestamp_.reset();
+  if (pb.has_newest_base_timestamp()) {
+    newest_base_timestamp_ = Timestamp(pb.newest_base_timestamp());
+  }
+  cold_ = pb.cold();
+
+  column_stats_.assign(pb.column_stats().begin(), pb.column_stats().end());
+
+  base_data_checksum_.reset();
+  if (pb.has_base_data_checksum()) {
+    base_data_checksum_ = pb.base_data_checksum();
+  }
 }
 
 void RowSetMetadata::ToProtobuf(RowSetDataPB *pb) {
@@ -173,6 +187,19 @@ void RowSetMetadata::ToProtobuf(RowSetDataPB *pb) {
   if (tablet_metadata_->supports_live_row_count()) {
     pb->set_live_row_count(live_row_count_);
   }
+
+  if (newest_base_timestamp_) {
+    pb->set_newest_base_timestamp(newest_base_timestamp_->value());
+  }
+  if (cold_) {
+    pb->set_cold(true);
+  }
+  for (const auto& stats : column_stats_) {
+    *pb->add_column_stats() = stats;
+  }
+  if (base_data_checksum_) {
+    *pb->mutable_base_data_checksum() = *base_data_checksum_;
+  }
 }
 
 const std::string RowSetMetadata::ToString() const {
@@ -184,6 +211,7 @@ void RowSetMetadata::SetColumnDataBlocks(const std::map<ColumnId, BlockId>& bloc
   new_map.shrink_to_fit();
   std::lock_guard<LockType> l(lock_);
   blocks_by_col_id_ = std::move(new_map);
+  version_++;
 }
 
 void RowSetMetadata::CommitRedoDeltaDataBlock(int64_t dms_id,
@@ -193,11 +221,13 @@ void RowSetMetadata::CommitRedoDeltaDataBlock(int64_t dms_id,
   last_durable_redo_dms_id_ = dms_id;
   redo_delta_blocks_.push_back(block_id);
   IncrementLiveRowsUnlocked(-num_deleted_rows);
+  version_++;
 }
 
 void RowSetMetadata::CommitUndoDeltaDataBlock(const BlockId& block_id) {
   std::lock_guard<LockType> l(lock_);
   undo_delta_blocks_.push_back(block_id);
+  version_++;
 }
 
 void RowSetMetadata::CommitUpdate(const RowSetMetadataUpdate& update,
@@ -205,6 +235,7 @@ void RowSetMetadata::CommitUpdate(const RowSetMetadataUpdate& update,
   removed->clear();
   {
     std::lock_guard<LockType> l(lock_);
+    version_++;
 
     // Find the exact sequence of blocks to remove.
     for (const auto& rep : update.replace_redo_blocks_) {
@@ -258,6 +289,11 @@ void RowSetMetadata::CommitUpdate(const RowSetMetadataUpdate& update,
       undo_delta_blocks_.insert(undo_delta_blocks_.begin(), update.new_undo_block_);
     }
 
+    // The checksum of the base data doesn't hold once the deltas are folded
+    // into it.
+    if (!update.cols_to_replace_.empty()) {
+      base_data_checksum_.reset();
+    }
     for (const ColumnIdToBlockIdMap::value_type& e : update.cols_to_replace_) {
       // If we are major-compacting deltas into a column which previously had no
       // base-data (e.g. because it was newly added), then there will be no original
@@ -282,6 +318,7 @@ void RowSetMetadata::IncrementLiveRowsUnlocked(int64_t row_count) {
   if (tablet_metadata_->supports_live_row_count() && row_count != 0) {
     live_row_count_ += row_count;
     DCHECK_GE(live_row_count_, 0);
+    version_++;
   }
 }
 
@@ -32,19 +32,22 @@
 #include <glog/logging.h>
 
 #include "kudu/common/schema.h"
+#include "kudu/common/timestamp.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
+#include "kudu/tablet/metadata.pb.h"
 #include "kudu/tablet/tablet_metadata.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
 
+class BlockBloomFilter;
+
 namespace tablet {
 
-class RowSetDataPB;
 class RowSetMetadataUpdate;
 
 // Keeps track of the RowSet data blocks.
@@ -108,12 +111,14 @@ class RowSetMetadata {
     std::lock_guard<LockType> l(lock_);
     DCHECK(bloom_block_.IsNull());
     bloom_block_ = block_id;
+    version_++;
   }
 
   void set_adhoc_index_block(const BlockId& block_id) {
     std::lock_guard<LockType> l(lock_);
     DCHECK(adhoc_index_block_.IsNull());
     adhoc_index_block_ = block_id;
+    version_++;
   }
 
   void SetColumnDataBlocks(const std::map<ColumnId, BlockId>& blocks_by_col_id);
@@ -138,11 +143,13 @@ class RowSetMetadata {
   void set_min_encoded_key(std::string min_encoded_key) {
     std::lock_guard<LockType> l(lock_);
     min_encoded_key_ = std::move(min_encoded_key);
+    version_++;
   }
 
   void set_max_encoded_key(std::string max_encoded_key) {
     std::lock_guard<LockType> l(lock_);
     max_encoded_key_ = std::move(max_encoded_key);
+    version_++;
   }
 
   std::string min_encoded_key() const {
@@ -157,6 +164,36 @@ class RowSetMetadata {
     return *max_encoded_key_;
   }
 
+  // Sets the statistics of the columns of the rowset, computed when it was
+  // written.
+  void set_column_stats(std::vector<ColumnStatsPB> column_stats) {
+    std::lock_guard<LockType> l(lock_);
+    column_stats_ = std::move(column_stats);
+    version_++;
+  }
+
+  // Returns the statistics of the columns of the rowset, or an empty vector
+  // if they weren't computed.
+  std::vector<ColumnStatsPB> column_stats() const {
+    std::lock_guard<LockType> l(lock_);
+    return column_stats_;
+  }
+
+  // Sets the checksum of the base data of the rowset, computed when it was
+  // written.
+  void set_base_data_checksum(RowSetChecksumPB checksum) {
+    std::lock_guard<LockType> l(lock_);
+    base_data_checksum_ = std::move(checksum);
+    version_++;
+  }
+
+  // Returns the checksum of the base data of the rowset, unless it wasn't
+  // computed or the base data was rewritten since.
+  std::optional<RowSetChecksumPB> base_data_checksum() const {
+    std::lock_guard<LockType> l(lock_);
+    return base_data_checksum_;
+  }
+
   BlockId bloom_block() const {
     std::lock_guard<LockType> l(lock_);
     return bloom_block_;
@@ -192,6 +229,19 @@ class RowSetMetadata {
     return undo_delta_blocks_;
   }
 
+  // The in-memory filter of the rowset's keys built by the DiskRowSetWriter
+  // which wrote the rowset, if any. It isn't persisted, so rowsets read from
+  // disk don't have one.
+  std::shared_ptr<const BlockBloomFilter> key_filter() const {
+    std::lock_guard<LockType> l(lock_);
+    return key_filter_;
+  }
+
+  void set_key_filter(std::shared_ptr<const BlockBloomFilter> key_filter) {
+    std::lock_guard<LockType> l(lock_);
+    key_filter_ = std::move(key_filter);
+  }
+
   TabletMetadata *tablet_metadata() const { return tablet_metadata_; }
 
   int64_t last_durable_redo_dms_id() const {
@@ -202,6 +252,7 @@ class RowSetMetadata {
   void SetLastDurableRedoDmsIdForTests(int64_t redo_dms_id) {
     std::lock_guard<LockType> l(lock_);
     last_durable_redo_dms_id_ = redo_dms_id;
+    version_++;
   }
 
   bool HasDataForColumnIdForTests(ColumnId col_id) const {
@@ -227,6 +278,14 @@ class RowSetMetadata {
 
   void ToProtobuf(RowSetDataPB *pb);
 
+  // Returns the version of the persisted state of the rowset metadata, which
+  // changes every time that state does, so that the tablet metadata may tell
+  // which rowsets changed since it was last flushed.
+  int64_t version() const {
+    std::lock_guard<LockType> l(lock_);
+    return version_;
+  }
+
   BlockIdContainer GetAllBlocks() const;
 
   BlockId GetMaxLiveBlockId() const;
@@ -240,6 +299,31 @@ class RowSetMetadata {
   // Returns the number of live rows in this metadata.
   int64_t live_row_count() const;
 
+  // The timestamp of the newest insert or mutation folded into the base data
+  // when the rowset was written, if known.
+  std::optional<Timestamp> newest_base_timestamp() const {
+    std::lock_guard<LockType> l(lock_);
+    return newest_base_timestamp_;
+  }
+
+  void set_newest_base_timestamp(Timestamp timestamp) {
+    std::lock_guard<LockType> l(lock_);
+    newest_base_timestamp_ = timestamp;
+    version_++;
+  }
+
+  // Whether the blocks of the rowset were written as cold data.
+  bool cold() const {
+    std::lock_guard<LockType> l(lock_);
+    return cold_;
+  }
+
+  void set_cold(bool cold) {
+    std::lock_guard<LockType> l(lock_);
+    cold_ = cold;
+    version_++;
+  }
+
  private:
   friend class TabletMetadata;
 
@@ -249,7 +333,9 @@ class RowSetMetadata {
     : tablet_metadata_(tablet_metadata),
       initted_(false),
       last_durable_redo_dms_id_(kNoDurableMemStore),
-      live_row_count_(0) {
+      live_row_count_(0),
+      cold_(false),
+      version_(0) {
   }
 
   RowSetMetadata(TabletMetadata *tablet_metadata,
@@ -258,7 +344,9 @@ class RowSetMetadata {
       initted_(true),
       id_(id),
       last_durable_redo_dms_id_(kNoDurableMemStore),
-      live_row_count_(0) {
+      live_row_count_(0),
+      cold_(false),
+      version_(0) {
   }
 
   Status InitFromPB(const RowSetDataPB& pb);
@@ -289,6 +377,20 @@ class RowSetMetadata {
   // Number of live rows on disk, excluding those in [MRS/DMS].
   int64_t live_row_count_;
 
+  std::optional<Timestamp> newest_base_timestamp_;
+  bool cold_;
+
+  // The statistics of the columns, as of when the rowset was written.
+  std::vector<ColumnStatsPB> column_stats_;
+
+  // The checksum of the base data, as of when the rowset was written.
+  std::optional<RowSetChecksumPB> base_data_checksum_;
+
+  std::shared_ptr<const BlockBloomFilter> key_filter_;
+
+  // Incremented with every change of the fields above which are persisted.
+  int64_t version_;
+
   DISALLOW_COPY_AND_ASSIGN(RowSetMetadata);
 };
 
@@ -214,6 +214,48 @@ TEST_F(TestRowSetTree, TestTree) {
   ASSERT_EQ(vec[2].get(), out[3]);
 }
 
+// Keys past the max keys of all the rowsets with known bounds, as when
+// appending rows with increasing keys, are only matched to the MemRowSet.
+TEST_F(TestRowSetTree, TestKeysPastBoundedRowSets) {
+  RowSetVector vec;
+  vec.push_back(make_shared<MockDiskRowSet>("0", "5"));
+  vec.push_back(make_shared<MockDiskRowSet>("3", "7"));
+  vec.push_back(make_shared<MockMemRowSet>());
+
+  RowSetTree tree;
+  ASSERT_OK(tree.Reset(vec));
+  ASSERT_FALSE(tree.IsPastBoundedRowSets("6"));
+  ASSERT_FALSE(tree.IsPastBoundedRowSets("7"));
+  ASSERT_TRUE(tree.IsPastBoundedRowSets("70"));
+  ASSERT_TRUE(tree.IsPastBoundedRowSets("8"));
+
+  vector<RowSet*> out;
+  tree.FindRowSetsWithKeyInRange("8", &out);
+  ASSERT_EQ(1, out.size());
+  ASSERT_EQ(vec[2].get(), out[0]);
+
+  vector<std::pair<RowSet*, int>> matches;
+  tree.ForEachRowSetContainingKeys({ "6", "7", "8", "9" }, [&](RowSet* rs, int idx) {
+    matches.emplace_back(rs, idx);
+  });
+  // All of the keys are in the MemRowSet, and only the first two may be in
+  // the second DiskRowSet.
+  ASSERT_EQ(6, matches.size());
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ(vec[2].get(), matches[i].first);
+    ASSERT_EQ(i, matches[i].second);
+  }
+  ASSERT_EQ(vec[1].get(), matches[4].first);
+  ASSERT_EQ(0, matches[4].second);
+  ASSERT_EQ(vec[1].get(), matches[5].first);
+  ASSERT_EQ(1, matches[5].second);
+
+  // Without rowsets with known bounds, every key is past them.
+  RowSetTree mrs_only_tree;
+  ASSERT_OK(mrs_only_tree.Reset({ vec[2] }));
+  ASSERT_TRUE(mrs_only_tree.IsPastBoundedRowSets("0"));
+}
+
 TEST_F(TestRowSetTree, TestTreeRandomized) {
   enum BoundOperator {
     BOUND_LESS_THAN,
@@ -278,6 +320,86 @@ TEST_F(TestRowSetTree, TestTreeRandomized) {
   }
 }
 
+// Test the lookups against a brute force scan of the rowsets, with keys long
+// and short enough for both their prefixes and their full bytes to matter.
+TEST_F(TestRowSetTree, TestLookupsMatchBruteForce) {
+  SeedRandom();
+  const auto& RandomKey = [] {
+    return StringPrintf("prefixes%02d", rand() % 20).substr(0, 6 + rand() % 5);
+  };
+  RowSetVector vec;
+  for (int i = 0; i < 200; i++) {
+    string a = RandomKey();
+    string b = RandomKey();
+    vec.push_back(make_shared<MockDiskRowSet>(std::min(a, b), std::max(a, b)));
+  }
+  RowSetTree tree;
+  ASSERT_OK(tree.Reset(vec));
+
+  const auto& Bounds = [](RowSet* rs) {
+    string min, max;
+    CHECK_OK(rs->GetBounds(&min, &max));
+    return std::make_pair(min, max);
+  };
+  vector<string> keys;
+  for (int i = 0; i < 100; i++) {
+    keys.emplace_back(RandomKey());
+  }
+  std::sort(keys.begin(), keys.end());
+  vector<Slice> key_slices(keys.begin(), keys.end());
+
+  int expected_batch_matches = 0;
+  for (const auto& key : keys) {
+    vector<RowSet*> out;
+    tree.FindRowSetsWithKeyInRange(key, &out);
+    unordered_set<RowSet*> expected;
+    for (const auto& rs : vec) {
+      const auto bounds = Bounds(rs.get());
+      if (bounds.first <= key && key <= bounds.second) {
+        expected.insert(rs.get());
+      }
+    }
+    ASSERT_EQ(expected, unordered_set<RowSet*>(out.begin(), out.end())) << key;
+    ASSERT_EQ(expected.size(), out.size());
+    expected_batch_matches += out.size();
+
+    const string upper = RandomKey();
+    out.clear();
+    tree.FindRowSetsIntersectingInterval(Slice(key), Slice(upper), &out);
+    expected.clear();
+    for (const auto& rs : vec) {
+      const auto bounds = Bounds(rs.get());
+      if (bounds.first < upper && bounds.second >= key) {
+        expected.insert(rs.get());
+      }
+    }
+    ASSERT_EQ(expected, unordered_set<RowSet*>(out.begin(), out.end()))
+        << "[" << key << ", " << upper << ")";
+    ASSERT_EQ(expected.size(), out.size());
+  }
+
+  // The batch lookup finds the same rowsets, and reports each rowset's keys
+  // consecutively and in order.
+  int batch_matches = 0;
+  unordered_set<RowSet*> done;
+  RowSet* cur = nullptr;
+  int prev_idx = -1;
+  tree.ForEachRowSetContainingKeys(key_slices, [&](RowSet* rs, int idx) {
+    batch_matches++;
+    const auto bounds = Bounds(rs);
+    EXPECT_LE(bounds.first, keys[idx]);
+    EXPECT_GE(bounds.second, keys[idx]);
+    if (rs != cur) {
+      EXPECT_TRUE(InsertIfNotPresent(&done, rs));
+      cur = rs;
+    } else {
+      EXPECT_LT(prev_idx, idx);
+    }
+    prev_idx = idx;
+  });
+  ASSERT_EQ(expected_batch_matches, batch_matches);
+}
+
 class TestRowSetTreePerformance : public TestRowSetTree,
                                   public testing::WithParamInterface<std::tuple<int, int>> {
 };
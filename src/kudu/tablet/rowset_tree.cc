@@ -19,6 +19,8 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <ostream>
@@ -28,11 +30,10 @@
 
 #include <glog/logging.h>
 
+#include "kudu/gutil/endian.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"  // IWYU pragma: keep
-#include "kudu/util/interval_tree-inl.h"
-#include "kudu/util/interval_tree.h"
 #include "kudu/util/slice.h"
 
 using std::function;
@@ -58,72 +59,152 @@ bool RSEndpointBySliceCompare(const RowSetTree::RSEndpoint& a,
   return false;
 }
 
-// Wrapper used when making batch queries into the interval tree.
-struct QueryStruct {
-  // The slice of the operation performing the query.
-  Slice slice;
-  // The original index of this slice in the incoming batch.
+// Returns the first 8 bytes of 'key' as a big-endian integer, padded with
+// zeros, so that comparing the prefixes of two keys orders them like the keys
+// unless the prefixes are equal.
+uint64_t KeyPrefix(const Slice& key) {
+  uint8_t buf[sizeof(uint64_t)] = { 0 };
+  memcpy(buf, key.data(), std::min(key.size(), sizeof(buf)));
+  return BigEndian::Load64(buf);
+}
+
+// A key along with its prefix.
+struct PrefixedKey {
+  explicit PrefixedKey(const Slice& key)
+      : prefix(KeyPrefix(key)),
+        key(key) {
+  }
+
+  uint64_t prefix;
+  Slice key;
+};
+
+int Compare(const PrefixedKey& a, const PrefixedKey& b) {
+  if (a.prefix != b.prefix) {
+    return a.prefix < b.prefix ? -1 : 1;
+  }
+  return a.key.compare(b.key);
+}
+
+// A query key of a batch, along with its index in the batch.
+struct BatchKey {
+  PrefixedKey key;
   int idx;
 };
 
 } // anonymous namespace
 
-// Entry for use in the interval tree.
+// Entry for the rowsets with known bounds, owning their bounds.
 struct RowSetWithBounds {
   string min_key;
   string max_key;
-
-  // NOTE: the ordering of struct fields here is purposeful: we access
-  // min_key and max_key frequently, so putting them first in the struct
-  // ensures they fill a single 64-byte cache line (each is 32 bytes).
-  // The 'rowset' pointer is accessed comparitively rarely.
   RowSet *rowset;
 };
 
-// Traits struct for IntervalTree.
-struct RowSetIntervalTraits {
-  typedef Slice point_type;
-  typedef RowSetWithBounds *interval_type;
-
-  static Slice get_left(const RowSetWithBounds *rs) {
-    return Slice(rs->min_key);
-  }
+// A node of the flat interval tree.
+//
+// The nodes are the rowsets sorted by their min keys: the subtree over the
+// nodes [lo, hi) is rooted at the node in the middle, whose left and right
+// subtrees span the nodes on either side. Each node records the largest max
+// key of its subtree, so that lookups can skip the subtrees which end before
+// the keys they look for, and the nodes at or after a min key past those
+// keys. Laying the tree out in a single array and comparing the bounds by
+// their prefixes first keeps the lookups mostly within a few cache lines
+// per level, instead of chasing pointers to the bounds of every node.
+struct RowSetTreeNode {
+  PrefixedKey subtree_max_key;
+  PrefixedKey min_key;
+  PrefixedKey max_key;
+  RowSet* rowset;
+};
 
-  static Slice get_right(const RowSetWithBounds *rs) {
-    return Slice(rs->max_key);
-  }
+namespace {
 
-  static int compare(const Slice &a, const Slice &b) {
-    return a.compare(b);
+// Sets the largest max key of the subtree over 'nodes[lo, hi)' and of all of
+// its own subtrees, returning it.
+PrefixedKey ComputeSubtreeMaxKeys(vector<RowSetTreeNode>* nodes, int lo, int hi) {
+  DCHECK_LT(lo, hi);
+  const int mid = lo + (hi - lo) / 2;
+  RowSetTreeNode* node = &(*nodes)[mid];
+  PrefixedKey subtree_max = node->max_key;
+  if (lo < mid) {
+    PrefixedKey left_max = ComputeSubtreeMaxKeys(nodes, lo, mid);
+    if (Compare(left_max, subtree_max) > 0) {
+      subtree_max = left_max;
+    }
   }
-
-  static int compare(const Slice &a, const QueryStruct &b) {
-    return a.compare(b.slice);
+  if (mid + 1 < hi) {
+    PrefixedKey right_max = ComputeSubtreeMaxKeys(nodes, mid + 1, hi);
+    if (Compare(right_max, subtree_max) > 0) {
+      subtree_max = right_max;
+    }
   }
+  node->subtree_max_key = subtree_max;
+  return subtree_max;
+}
 
-  static int compare(const QueryStruct &a, const Slice &b) {
-    return -compare(b, a);
+// Calls 'cb(rowset)' for each rowset of 'nodes[lo, hi)' whose bounds
+// intersect [lower_bound, upper_bound), in order of their min keys.
+//
+// A bound which is std::nullopt is infinite.
+template<class Callback>
+void ForEachIntersectingNode(const vector<RowSetTreeNode>& nodes, int lo, int hi,
+                             const optional<PrefixedKey>& lower_bound,
+                             const optional<PrefixedKey>& upper_bound,
+                             const Callback& cb) {
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    const RowSetTreeNode& node = nodes[mid];
+    if (lower_bound && Compare(node.subtree_max_key, *lower_bound) < 0) {
+      // The whole subtree ends before the interval.
+      return;
+    }
+    ForEachIntersectingNode(nodes, lo, mid, lower_bound, upper_bound, cb);
+    if (upper_bound && Compare(node.min_key, *upper_bound) >= 0) {
+      // This node and the right subtree start after the interval.
+      return;
+    }
+    if (!lower_bound || Compare(node.max_key, *lower_bound) >= 0) {
+      cb(node.rowset);
+    }
+    lo = mid + 1;
   }
+}
 
-  // When 'a' is std::nullopt:
-  //  (1)'a' is +OO when 'positive_direction' is true;
-  //  (2)'a' is -OO when 'positive_direction' is false.
-  static int compare(const optional<Slice>& a,
-                     const Slice& b,
-                     const EndpointIfNone& type) {
-    if (!a) {
-      return ((POSITIVE_INFINITY == type) ? 1 : -1);
+// Calls 'cb(rowset, idx)' for each rowset of 'nodes[lo, hi)' and each of the
+// sorted keys in [begin, end) within its bounds. The calls for each rowset are
+// consecutive, in increasing key order.
+template<class Callback>
+void ForEachNodeContainingKeys(const vector<RowSetTreeNode>& nodes, int lo, int hi,
+                               const BatchKey* begin, const BatchKey* end,
+                               const Callback& cb) {
+  while (lo < hi && begin != end) {
+    const int mid = lo + (hi - lo) / 2;
+    const RowSetTreeNode& node = nodes[mid];
+    // Drop the keys past the end of the whole subtree.
+    end = std::partition_point(begin, end, [&](const BatchKey& k) {
+      return Compare(k.key, node.subtree_max_key) <= 0;
+    });
+    if (begin == end) {
+      return;
     }
-
-    return compare(*a, b);
+    ForEachNodeContainingKeys(nodes, lo, mid, begin, end, cb);
+    // The keys before the start of this node are also before the start of
+    // the right subtree.
+    begin = std::partition_point(begin, end, [&](const BatchKey& k) {
+      return Compare(k.key, node.min_key) < 0;
+    });
+    const BatchKey* node_end = std::partition_point(begin, end, [&](const BatchKey& k) {
+      return Compare(k.key, node.max_key) <= 0;
+    });
+    for (const BatchKey* k = begin; k != node_end; ++k) {
+      cb(node.rowset, k->idx);
+    }
+    lo = mid + 1;
   }
+}
 
-  static int compare(const Slice& a,
-                     const optional<Slice>& b,
-                     const EndpointIfNone& type) {
-    return -compare(b, a, type);
-  }
-};
+} // anonymous namespace
 
 RowSetTree::RowSetTree()
   : initted_(false) {
@@ -176,10 +257,27 @@ Status RowSetTree::Reset(const RowSetVector &rowsets) {
   // Sort endpoints
   std::sort(endpoints.begin(), endpoints.end(), RSEndpointBySliceCompare);
 
+  // Lay out the flat interval tree.
+  vector<RowSetWithBounds*> by_min_key(entries);
+  std::stable_sort(by_min_key.begin(), by_min_key.end(),
+                   [](const RowSetWithBounds* a, const RowSetWithBounds* b) {
+                     return a->min_key < b->min_key;
+                   });
+  vector<RowSetTreeNode> nodes;
+  nodes.reserve(by_min_key.size());
+  for (const RowSetWithBounds* e : by_min_key) {
+    PrefixedKey min_key(e->min_key);
+    PrefixedKey max_key(e->max_key);
+    nodes.push_back({ max_key, min_key, max_key, e->rowset });
+  }
+  if (!nodes.empty()) {
+    ComputeSubtreeMaxKeys(&nodes, 0, nodes.size());
+  }
+
   // Install the vectors into the object.
   entries_.swap(entries);
   unbounded_rowsets_.swap(unbounded);
-  tree_.reset(new IntervalTree<RowSetIntervalTraits>(entries_));
+  nodes_.swap(nodes);
   key_endpoints_.swap(endpoints);
   all_rowsets_.assign(rowsets.begin(), rowsets.end());
 
@@ -206,13 +304,16 @@ void RowSetTree::FindRowSetsIntersectingInterval(const optional<Slice>& lower_bo
     rowsets->push_back(rs.get());
   }
 
-  vector<RowSetWithBounds *> from_tree;
-  from_tree.reserve(all_rowsets_.size());
-  tree_->FindIntersectingInterval(lower_bound, upper_bound, &from_tree);
-  rowsets->reserve(rowsets->size() + from_tree.size());
-  for (RowSetWithBounds *rs : from_tree) {
-    rowsets->push_back(rs->rowset);
+  optional<PrefixedKey> lower;
+  if (lower_bound) {
+    lower.emplace(*lower_bound);
+  }
+  optional<PrefixedKey> upper;
+  if (upper_bound) {
+    upper.emplace(*upper_bound);
   }
+  ForEachIntersectingNode(nodes_, 0, nodes_.size(), lower, upper,
+                          [&](RowSet* rs) { rowsets->push_back(rs); });
 }
 
 void RowSetTree::FindRowSetsWithKeyInRange(const Slice &encoded_key,
@@ -224,15 +325,15 @@ void RowSetTree::FindRowSetsWithKeyInRange(const Slice &encoded_key,
     rowsets->push_back(rs.get());
   }
 
+  if (IsPastBoundedRowSets(encoded_key)) {
+    return;
+  }
+
   // Query the interval tree to efficiently find rowsets with known bounds
   // whose ranges overlap the probe key.
-  vector<RowSetWithBounds *> from_tree;
-  from_tree.reserve(all_rowsets_.size());
-  tree_->FindContainingPoint(encoded_key, &from_tree);
-  rowsets->reserve(rowsets->size() + from_tree.size());
-  for (RowSetWithBounds *rs : from_tree) {
-    rowsets->push_back(rs->rowset);
-  }
+  const BatchKey key = { PrefixedKey(encoded_key), 0 };
+  ForEachNodeContainingKeys(nodes_, 0, nodes_.size(), &key, &key + 1,
+                            [&](RowSet* rs, int /*idx*/) { rowsets->push_back(rs); });
 }
 
 void RowSetTree::ForEachRowSetContainingKeys(
@@ -248,20 +349,24 @@ void RowSetTree::ForEachRowSetContainingKeys(
     }
   }
 
-  // The interval tree batch query callback would naturally just give us back
-  // the matching Slices, but that won't allow us to easily tell the caller
-  // which specific operation _index_ matched the RowSet. So, we make a vector
-  // of QueryStructs to pair the Slice with its original index.
-  vector<QueryStruct> queries(encoded_keys.size());
-  for (auto i = 0; i < encoded_keys.size(); ++i) {
-    queries[i] = {encoded_keys[i], i};
+  // The keys past all the rowsets with known bounds, which are all of them
+  // when appending rows with increasing keys, don't need to be looked up.
+  const auto num_keys = std::partition_point(
+      encoded_keys.cbegin(), encoded_keys.cend(),
+      [&](const Slice& k) { return !IsPastBoundedRowSets(k); }) - encoded_keys.cbegin();
+  if (num_keys == 0) {
+    return;
   }
 
-  tree_->ForEachIntervalContainingPoints(
-      queries,
-      [&](const QueryStruct& qs, RowSetWithBounds* rs) {
-        cb(rs->rowset, qs.idx);
-      });
+  // Pair each key with its prefix, and with its index in the batch so that
+  // the caller can tell which operation matched the rowset.
+  vector<BatchKey> keys;
+  keys.reserve(num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back({ PrefixedKey(encoded_keys[i]), i });
+  }
+  ForEachNodeContainingKeys(nodes_, 0, nodes_.size(),
+                            keys.data(), keys.data() + keys.size(), cb);
 }
 
 
@@ -29,13 +29,9 @@
 #include "kudu/util/status.h"
 
 namespace kudu {
-
-template<class Traits>
-class IntervalTree;
-
 namespace tablet {
 
-struct RowSetIntervalTraits;
+struct RowSetTreeNode;
 struct RowSetWithBounds;
 
 // Class which encapsulates the set of rowsets which are active for a given
@@ -78,8 +74,8 @@ class RowSetTree {
   // Call 'cb(rowset, index)' for each (rowset, index) pair such that
   // 'encoded_keys[index]' may be within the bounds of 'rowset'.
   //
-  // See IntervalTree::ForEachIntervalContainingPoints for additional
-  // information on the particular order in which the callback will be called.
+  // The callbacks for each rowset are consecutive, with the indexes of its
+  // keys in increasing order.
   //
   // REQUIRES: 'encoded_keys' must be in sorted order.
   void ForEachRowSetContainingKeys(const std::vector<Slice>& encoded_keys,
@@ -102,24 +98,32 @@ class RowSetTree {
     return FindPtrOrNull(drs_by_id_, drs_id);
   }
 
+  // Returns whether 'encoded_key' is past the max keys of all the rowsets with
+  // known bounds, e.g. the key of a row appended to a tablet whose keys only
+  // increase. Such a key may only be in the rowsets with unknown bounds.
+  bool IsPastBoundedRowSets(const Slice& encoded_key) const {
+    return key_endpoints_.empty() || encoded_key.compare(key_endpoints_.back().slice_) > 0;
+  }
+
   // Iterates over RowSetTree::RSEndpoint, guaranteed to be ordered and for
   // any rowset to appear exactly twice, once at its start slice and once at
   // its stop slice, equivalent to its GetBounds() values.
   const std::vector<RSEndpoint>& key_endpoints() const { return key_endpoints_; }
 
  private:
-  // Interval tree of the rowsets. Used to efficiently find rowsets which might contain
-  // a probe row.
-  std::unique_ptr<IntervalTree<RowSetIntervalTraits>> tree_;
+  // Interval tree of the rowsets with known bounds, laid out flat in a
+  // single array. Used to efficiently find rowsets which might contain a
+  // probe row.
+  std::vector<RowSetTreeNode> nodes_;
 
   // Ordered map of all the interval endpoints, holding the implicit contiguous
   // intervals
   // TODO map to usage statistics as well. See KUDU-???
   std::vector<RSEndpoint> key_endpoints_;
 
-  // Container for all of the entries in tree_. IntervalTree does
-  // not itself manage memory, so this provides a simple way to enumerate
-  // all the entry structs and free them in the destructor.
+  // Container for the bounds of the rowsets in nodes_, which only reference
+  // them. This provides a simple way to enumerate all the entry structs and
+  // free them in the destructor.
   std::vector<RowSetWithBounds *> entries_;
 
   // All of the rowsets which were put in this RowSetTree.
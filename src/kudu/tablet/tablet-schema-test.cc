@@ -31,6 +31,8 @@
 #include "kudu/common/schema.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/local_tablet_writer.h"
+#include "kudu/tablet/rowset.h"
+#include "kudu/tablet/rowset_metadata.h"
 #include "kudu/tablet/tablet-test-util.h"
 #include "kudu/tablet/tablet.h"
 #include "kudu/tablet/tablet_metadata.h"
@@ -274,6 +276,34 @@ TEST_F(TestTabletSchema, TestDeleteAndReAddColumn) {
   VerifyTabletRows(s2, keys);
 }
 
+// Verify that the major delta compactions remove the blocks of dropped columns
+// without affecting the other columns.
+TEST_F(TestTabletSchema, TestRemoveDroppedColumnBlocks) {
+  const size_t kNumRows = 10;
+  for (size_t i = 0; i < kNumRows; ++i) {
+    InsertRow(client_schema_, i);
+  }
+  ASSERT_OK(tablet()->Flush());
+  ASSERT_EQ(1, tablet()->metadata()->rowsets().size());
+  const auto rowset_metadata = tablet()->metadata()->rowsets()[0];
+  ASSERT_EQ(2, rowset_metadata->GetColumnBlocksById().size());
+
+  SchemaBuilder builder(*tablet()->metadata()->schema());
+  ASSERT_OK(builder.RemoveColumn("c1"));
+  ASSERT_OK(builder.AddNullableColumn("c2", INT32));
+  AlterSchema(builder.Build());
+  Schema s2 = builder.BuildWithoutIds();
+
+  // The rowset has no deltas, but its dropped column is worth reclaiming.
+  ASSERT_OK(tablet()->CompactWorstDeltas(RowSet::MAJOR_DELTA_COMPACTION));
+  ASSERT_EQ(1, rowset_metadata->GetColumnBlocksById().size());
+
+  vector<string> rows;
+  ASSERT_OK(DumpTablet(*tablet(), s2, &rows));
+  ASSERT_EQ(kNumRows, rows.size());
+  EXPECT_EQ("(int32 key=0, int32 c2=NULL)", rows[0]);
+}
+
 // Verify modifying an empty MemRowSet
 TEST_F(TestTabletSchema, TestModifyEmptyMemRowSet) {
   std::vector<std::pair<string, string> > keys;
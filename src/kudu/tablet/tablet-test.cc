@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <ctime>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -39,6 +40,7 @@
 #include "kudu/common/iterator.h"
 #include "kudu/common/key_range.h"
 #include "kudu/common/partial_row.h"
+#include "kudu/common/row_operations.h"
 #include "kudu/common/row_operations.pb.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/rowblock_memory.h"
@@ -55,6 +57,7 @@
 #include "kudu/tablet/local_tablet_writer.h"
 #include "kudu/tablet/mock-rowsets.h"
 #include "kudu/tablet/mvcc.h"
+#include "kudu/tablet/ops/write_op.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"
 #include "kudu/tablet/rowset_tree.h" // IWYU pragma: keep
@@ -63,6 +66,7 @@
 #include "kudu/tablet/tablet.pb.h"
 #include "kudu/tablet/tablet_metadata.h"
 #include "kudu/tablet/tablet_metrics.h" // IWYU pragma: keep
+#include "kudu/tserver/tserver.pb.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/jsonwriter.h"
 #include "kudu/util/memory/arena.h"
@@ -71,6 +75,9 @@
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 
+DECLARE_bool(tablet_split_key_range_by_key_samples);
+DECLARE_int32(tablet_delta_maintenance_parallel_rowsets);
+
 DEFINE_int32(testflush_num_inserts, 1000,
              "Number of rows inserted in TestFlush");
 DEFINE_int32(testiterator_num_inserts, 1000,
@@ -800,6 +807,44 @@ TYPED_TEST(TestTablet, TestInsertIgnore) {
   EXPECT_EQ(vector<string>{ this->setup_.FormatDebugRow(0, 1011, false) }, rows);
 }
 
+// Test that the operations decoded before a write is prepared are used, unless
+// they were decoded against another schema.
+TYPED_TEST(TestTablet, TestPredecodedWriteOperations) {
+  KuduPartialRow row(&this->client_schema_);
+  this->setup_.BuildRow(&row, 0, 1000);
+  tserver::WriteRequestPB req;
+  RowOperationsPBEncoder enc(req.mutable_row_operations());
+  enc.Add(RowOperationsPB::INSERT, row);
+  enc.Add(RowOperationsPB::DELETE, row);
+
+  {
+    WriteOpState state(nullptr, &req, nullptr);
+    this->tablet()->PredecodeWriteOperations(&this->client_schema_, &state);
+    vector<DecodedRowOperation> ops;
+    ASSERT_TRUE(state.TakePredecodedOps(this->tablet()->schema(), &ops));
+    ASSERT_EQ(2, ops.size());
+    EXPECT_EQ(RowOperationsPB::INSERT, ops[0].type);
+    EXPECT_EQ(RowOperationsPB::DELETE, ops[1].type);
+    // They can only be taken once.
+    ASSERT_FALSE(state.TakePredecodedOps(this->tablet()->schema(), &ops));
+  }
+
+  {
+    WriteOpState state(nullptr, &req, nullptr);
+    this->tablet()->PredecodeWriteOperations(&this->client_schema_, &state);
+    ASSERT_OK(this->tablet()->DecodeWriteOperations(&this->client_schema_, &state));
+    ASSERT_EQ(2, state.row_ops().size());
+  }
+
+  {
+    // Operations decoded against a stale schema are ignored.
+    WriteOpState state(nullptr, &req, nullptr);
+    state.SetPredecodedOps(make_shared<Schema>(*this->tablet()->schema()), {});
+    ASSERT_OK(this->tablet()->DecodeWriteOperations(&this->client_schema_, &state));
+    ASSERT_EQ(2, state.row_ops().size());
+  }
+}
+
 TYPED_TEST(TestTablet, TestUpdateIgnore) {
   LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
   KuduPartialRow row(&this->client_schema_);
@@ -1031,6 +1076,58 @@ TYPED_TEST(TestTablet, TestMultipleUpdates) {
   ASSERT_EQ(this->setup_.FormatDebugRow(1, 0, false), out_rows[1]);
 }
 
+// Delta flushes and minor delta compactions process several rowsets at once
+// with --tablet_delta_maintenance_parallel_rowsets.
+TYPED_TEST(TestTablet, TestParallelDeltaMaintenance) {
+  FLAGS_tablet_delta_maintenance_parallel_rowsets = 3;
+  const int kNumRowSets = 4;
+  LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+  for (int i = 0; i < kNumRowSets; i++) {
+    ASSERT_OK(this->InsertTestRow(&writer, i, 0));
+    ASSERT_OK(this->tablet()->Flush());
+  }
+  ASSERT_EQ(kNumRowSets, this->tablet()->num_rowsets());
+
+  vector<shared_ptr<RowSet>> rowsets;
+  this->tablet()->GetRowSetsForTests(&rowsets);
+  const auto count_rowsets = [&](const std::function<bool(const RowSet&)>& pred) {
+    return std::count_if(rowsets.begin(), rowsets.end(),
+                         [&](const shared_ptr<RowSet>& rs) { return pred(*rs); });
+  };
+  const auto has_dms = [](const RowSet& rs) { return !rs.DeltaMemStoreEmpty(); };
+  const auto needs_minor_compaction = [](const RowSet& rs) {
+    return rs.DeltaStoresCompactionPerfImprovementScore(RowSet::MINOR_DELTA_COMPACTION) > 0;
+  };
+
+  // The DMSs of three of the rowsets are flushed at once, then the last one.
+  for (int i = 0; i < kNumRowSets; i++) {
+    ASSERT_OK(this->UpdateTestRow(&writer, i, 1));
+  }
+  ASSERT_EQ(kNumRowSets, count_rowsets(has_dms));
+  ASSERT_OK(this->tablet()->FlushBestDMS({}));
+  ASSERT_EQ(1, count_rowsets(has_dms));
+  ASSERT_OK(this->tablet()->FlushBestDMS({}));
+  ASSERT_EQ(0, count_rowsets(has_dms));
+
+  // Same for the minor compactions of the two REDO files of each rowset.
+  for (int i = 0; i < kNumRowSets; i++) {
+    ASSERT_OK(this->UpdateTestRow(&writer, i, 2));
+  }
+  ASSERT_OK(this->tablet()->FlushAllDMSForTests());
+  ASSERT_EQ(kNumRowSets, count_rowsets(needs_minor_compaction));
+  ASSERT_OK(this->tablet()->CompactWorstDeltas(RowSet::MINOR_DELTA_COMPACTION));
+  ASSERT_EQ(1, count_rowsets(needs_minor_compaction));
+  ASSERT_OK(this->tablet()->CompactWorstDeltas(RowSet::MINOR_DELTA_COMPACTION));
+  ASSERT_EQ(0, count_rowsets(needs_minor_compaction));
+
+  vector<string> out_rows;
+  ASSERT_OK(this->IterateToStringList(&out_rows));
+  ASSERT_EQ(kNumRowSets, out_rows.size());
+  for (int i = 0; i < kNumRowSets; i++) {
+    ASSERT_EQ(this->setup_.FormatDebugRow(i, 2, true), out_rows[i]);
+  }
+}
+
 TYPED_TEST(TestTablet, TestCompaction) {
   uint64_t max_rows = this->ClampRowCount(FLAGS_testcompaction_num_rows);
 
@@ -1645,6 +1742,77 @@ TEST_F(TestTabletStringKey, TestSplitKeyRangeWithMinimumValueRowSet) {
   }
 }
 
+// Test for split key range, with keys sampled from a rowset whose data isn't
+// spread uniformly over its key range.
+TEST_F(TestTabletStringKey, TestSplitKeyRangeWithKeySamples) {
+  Tablet* tablet = this->mutable_tablet();
+
+  scoped_refptr<TabletComponents> comps;
+  tablet->GetComponents(&comps);
+  RowSetVector old_rowset = comps->rowsets->all_rowsets();
+  // Four fifths of the rows have keys in [0, 5].
+  auto skewed = make_shared<MockDiskRowSet>("0", "9", 10000, 100);
+  skewed->set_key_samples({ "0", "1", "2", "3", "5", "9" });
+  RowSetVector new_rowset = {
+    skewed,
+    make_shared<MockDiskRowSet>("2", "5", 3000, 30)
+  };
+  tablet->AtomicSwapRowSets(old_rowset, new_rowset);
+  {
+    vector<KeyRange> result = {
+      KeyRange("", "2", 4000),
+      KeyRange("2", "3", 3000),
+      KeyRange("3", "5", 4000),
+      KeyRange("5", "", 2000)
+    };
+    vector<ColumnId> col_ids;
+    vector<KeyRange> range;
+    tablet->SplitKeyRange(nullptr, nullptr, col_ids, 3500, &range);
+    AssertChunks(result, range);
+  }
+  // Without the samples, the rowset is only split at the bounds of the other.
+  {
+    FLAGS_tablet_split_key_range_by_key_samples = false;
+    vector<KeyRange> result = {
+      KeyRange("", "2", 2222),
+      KeyRange("2", "5", 6333),
+      KeyRange("5", "", 4444)
+    };
+    vector<ColumnId> col_ids;
+    vector<KeyRange> range;
+    tablet->SplitKeyRange(nullptr, nullptr, col_ids, 3500, &range);
+    AssertChunks(result, range);
+  }
+}
+
+// Test for finding the key which splits the data of a tablet in two halves.
+TEST_F(TestTabletStringKey, TestFindSplitKey) {
+  Tablet* tablet = this->mutable_tablet();
+
+  scoped_refptr<TabletComponents> comps;
+  tablet->GetComponents(&comps);
+  RowSetVector old_rowset = comps->rowsets->all_rowsets();
+  // Without data, there's no split key.
+  ASSERT_EQ("", tablet->FindSplitKey(0));
+
+  // The data is chunked as [min, 2), [2, 5), [5, 6) and [6, max), of 2000,
+  // 6000, 2000 and 3000 bytes: splitting at 5 leaves 8000 and 5000 bytes on
+  // either side, which is the closest to halves.
+  RowSetVector new_rowset = {
+    make_shared<MockDiskRowSet>("0", "9", 9000, 90),
+    make_shared<MockDiskRowSet>("2", "5", 3000, 30),
+    make_shared<MockDiskRowSet>("5", "6", 1000, 10)
+  };
+  tablet->AtomicSwapRowSets(old_rowset, new_rowset);
+  ASSERT_EQ("5", tablet->FindSplitKey(13000));
+
+  // A single chunk can't be split.
+  old_rowset = new_rowset;
+  new_rowset = { make_shared<MockDiskRowSet>("0", "9", 9000, 90) };
+  tablet->AtomicSwapRowSets(old_rowset, new_rowset);
+  ASSERT_EQ("", tablet->FindSplitKey(9000));
+}
+
 TYPED_TEST(TestTablet, TestDiffScanUnobservableOperations) {
   LocalTabletWriter writer(this->tablet().get(), &this->client_schema());
   vector<LocalTabletWriter::RowOp> ops;
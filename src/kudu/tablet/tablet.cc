@@ -18,6 +18,7 @@
 #include "kudu/tablet/tablet.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <ctime>
 #include <functional>
 #include <iterator>
@@ -35,13 +36,16 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <google/protobuf/arena.h>
+#include <google/protobuf/repeated_field.h>
 
+#include "kudu/cfile/block_cache.h"
 #include "kudu/clock/clock.h"
 #include "kudu/clock/hybrid_clock.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/generic_iterators.h"
 #include "kudu/common/iterator.h"
+#include "kudu/common/key_range.h"
 #include "kudu/common/partition.h"
 #include "kudu/common/row.h"
 #include "kudu/common/row_changelist.h"
@@ -53,16 +57,20 @@
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
+#include "kudu/common/types.h"
 #include "kudu/consensus/log_anchor_registry.h"
 #include "kudu/consensus/opid.pb.h"
 #include "kudu/fs/block_manager.h"
+#include "kudu/fs/data_dirs.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/fs/io_context.h"
+#include "kudu/gutil/basictypes.h"
 #include "kudu/gutil/casts.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/strings/human_readable.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/threading/thread_collision_warner.h"
+#include "kudu/tablet/column_stats.h"
 #include "kudu/tablet/compaction.h"
 #include "kudu/tablet/compaction_policy.h"
 #include "kudu/tablet/delta_tracker.h"
@@ -71,6 +79,7 @@
 #include "kudu/tablet/ops/alter_schema_op.h"
 #include "kudu/tablet/ops/participant_op.h"
 #include "kudu/tablet/ops/write_op.h"
+#include "kudu/tablet/row_cache.h"
 #include "kudu/tablet/row_op.h"
 #include "kudu/tablet/rowset_info.h"
 #include "kudu/tablet/rowset_tree.h"
@@ -97,6 +106,8 @@
 #include "kudu/util/slice.h"
 #include "kudu/util/status_callback.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/string_case.h"
+#include "kudu/util/thread.h"
 #include "kudu/util/throttler.h"
 #include "kudu/util/trace.h"
 #include "kudu/util/url-coding.h"
@@ -115,6 +126,15 @@ DEFINE_int32(tablet_compaction_budget_mb, 128,
              "Budget for a single compaction");
 TAG_FLAG(tablet_compaction_budget_mb, experimental);
 
+DEFINE_string(tablet_compaction_policy, "budgeted",
+              "The policy selecting the rowsets to compact, for tables which "
+              "don't set one in their extra configuration. One of 'budgeted', "
+              "which minimizes the tablets' height within a budget of I/O per "
+              "compaction, or 'size_tiered', which merges rowsets of similar "
+              "sizes to bound the write amplification of ingest-heavy tables.");
+TAG_FLAG(tablet_compaction_policy, advanced);
+TAG_FLAG(tablet_compaction_policy, experimental);
+
 DEFINE_int32(tablet_bloom_block_size, 4096,
              "Block size of the bloom filters used for tablet keys.");
 TAG_FLAG(tablet_bloom_block_size, advanced);
@@ -232,6 +252,59 @@ DEFINE_bool(enable_gc_deleted_rowsets_without_live_row_count, false,
             "cluster, just ignore this flag.");
 TAG_FLAG(enable_gc_deleted_rowsets_without_live_row_count, advanced);
 
+DEFINE_int32(tablet_compaction_parallel_ranges, 1,
+             "Maximum number of key ranges a rowset merge compaction is split "
+             "into, each range being merged on its own thread into separate "
+             "output rowsets. Ranges hold at least the target size of an output "
+             "rowset. If 1, compactions run on a single thread.");
+TAG_FLAG(tablet_compaction_parallel_ranges, advanced);
+TAG_FLAG(tablet_compaction_parallel_ranges, experimental);
+
+DEFINE_int32(tablet_delta_maintenance_parallel_rowsets, 1,
+             "Maximum number of rowsets whose DeltaMemStores a delta flush, or "
+             "whose REDO delta stores a minor delta compaction, processes in "
+             "parallel, each rowset on its own thread. The rowsets are picked "
+             "in the order of their scores, as long as the total size of their "
+             "deltas stays within --tablet_delta_maintenance_budget_mb. If 1, "
+             "these operations process a single rowset.");
+TAG_FLAG(tablet_delta_maintenance_parallel_rowsets, advanced);
+TAG_FLAG(tablet_delta_maintenance_parallel_rowsets, experimental);
+
+DEFINE_int32(tablet_delta_maintenance_budget_mb, 256,
+             "Budget in MiB shared by the rowsets processed by a delta flush or "
+             "a minor delta compaction of multiple rowsets, for the size of the "
+             "DeltaMemStores it flushes or of the REDO delta stores it "
+             "compacts. The rowset with the best score is processed even if "
+             "its deltas exceed the budget.");
+TAG_FLAG(tablet_delta_maintenance_budget_mb, advanced);
+TAG_FLAG(tablet_delta_maintenance_budget_mb, experimental);
+
+DEFINE_int64(tablet_row_cache_capacity_mb, 0,
+             "The capacity of the cache of each tablet for the rows of hot "
+             "primary keys, in MiB. Scans looking up a single row by its "
+             "primary key, with no other predicate, are served by the cache "
+             "when they read at a snapshot including the last write to the "
+             "row. If 0, the row cache is disabled.");
+TAG_FLAG(tablet_row_cache_capacity_mb, experimental);
+
+DEFINE_bool(tablet_split_key_range_by_key_samples, true,
+            "Whether to use keys sampled from the rowsets of a tablet to split "
+            "its key range by size, e.g. for scan tokens. The samples follow the "
+            "actual distribution of the rows, and allow splitting within "
+            "rowsets. Otherwise, the rows of each rowset are assumed to be spread "
+            "uniformly over its key range.");
+TAG_FLAG(tablet_split_key_range_by_key_samples, advanced);
+TAG_FLAG(tablet_split_key_range_by_key_samples, runtime);
+
+DEFINE_int32(tablet_cold_rowset_age_days, 0,
+             "The age, in days, past which the data of a rowset is migrated to "
+             "cold storage: the flushed rowsets whose newest insert and update are "
+             "older than that are rewritten as cold data, away from the data "
+             "directories on fast media (see --fs_data_dirs_fast_media). If 0, "
+             "aged rowsets aren't migrated.");
+TAG_FLAG(tablet_cold_rowset_age_days, experimental);
+TAG_FLAG(tablet_cold_rowset_age_days, runtime);
+
 DECLARE_bool(enable_undo_delta_block_gc);
 DECLARE_uint32(rowset_compaction_estimate_min_deltas_size_mb);
 
@@ -277,6 +350,7 @@ using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::unordered_map;
 using std::unordered_set;
 using std::vector;
 using strings::Substitute;
@@ -311,6 +385,24 @@ bool ValidateRowsetCompactionGuard() {
 }
 GROUP_FLAG_VALIDATOR(rowset_compaction, &ValidateRowsetCompactionGuard);
 
+bool ParseCompactionPolicy(const string& name, kudu::TableExtraConfigPB::CompactionPolicy* policy) {
+  string policy_name;
+  kudu::ToUpperCase(name, &policy_name);
+  return kudu::TableExtraConfigPB::CompactionPolicy_Parse(policy_name, policy) &&
+      *policy != kudu::TableExtraConfigPB::UNKNOWN_COMPACTION_POLICY;
+}
+
+bool ValidateCompactionPolicy(const char* flag, const string& value) {
+  kudu::TableExtraConfigPB::CompactionPolicy policy;
+  if (!ParseCompactionPolicy(value, &policy)) {
+    LOG(ERROR) << Substitute("$0: invalid value for --$1 flag, should be one of "
+                             "'budgeted' or 'size_tiered'", value, flag);
+    return false;
+  }
+  return true;
+}
+DEFINE_validator(tablet_compaction_policy, &ValidateCompactionPolicy);
+
 } // anonymous namespace
 
 namespace kudu {
@@ -366,6 +458,8 @@ Tablet::Tablet(scoped_refptr<TabletMetadata> metadata,
                                                                             *schema());
     metric_entity_ = METRIC_ENTITY_tablet.Instantiate(metric_registry, tablet_id(), attrs);
     metrics_.reset(new TabletMetrics(metric_entity_));
+    mem_trackers_.block_cache_attribution = new cfile::BlockCacheAttribution(
+        metrics_->block_cache_hits, metrics_->block_cache_misses, metrics_->block_cache_usage);
     METRIC_memrowset_size.InstantiateFunctionGauge(
         metric_entity_, [this]() { return this->MemRowSetSize(); })
         ->AutoDetach(&metric_detacher_);
@@ -385,8 +479,9 @@ Tablet::Tablet(scoped_refptr<TabletMetadata> metadata,
         ->AutoDetach(&metric_detacher_);
   }
 
-  compaction_policy_.reset(new BudgetedCompactionPolicy(
+  budgeted_compaction_policy_.reset(new BudgetedCompactionPolicy(
       FLAGS_tablet_compaction_budget_mb, metrics_.get()));
+  size_tiered_compaction_policy_.reset(new SizeTieredCompactionPolicy());
 
   if (FLAGS_tablet_throttler_rpc_per_sec > 0 || FLAGS_tablet_throttler_bytes_per_sec > 0) {
     throttler_.reset(new Throttler(MonoTime::Now(),
@@ -394,6 +489,8 @@ Tablet::Tablet(scoped_refptr<TabletMetadata> metadata,
                                    FLAGS_tablet_throttler_bytes_per_sec,
                                    FLAGS_tablet_throttler_burst_factor));
   }
+
+  ResetRowCache();
 }
 
 Tablet::~Tablet() {
@@ -611,8 +708,34 @@ void Tablet::SplitKeyRange(const EncodedKey* start_key,
   if (stop_key != nullptr) {
     stop = stop_key->encoded_key();
   }
+  const IOContext io_context({ tablet_id() });
   RowSetInfo::SplitKeyRange(*rowsets_copy, start, stop,
-                            column_ids, target_chunk_size, key_range_info);
+                            column_ids, target_chunk_size, key_range_info,
+                            FLAGS_tablet_split_key_range_by_key_samples, &io_context);
+}
+
+string Tablet::FindSplitKey(uint64_t size_bytes) {
+  // Chunk the data finely enough for one of the boundaries between the
+  // chunks to be close to halfway through it.
+  constexpr int kNumChunks = 16;
+  vector<KeyRange> ranges;
+  SplitKeyRange(nullptr, nullptr, {}, std::max<uint64_t>(size_bytes / kNumChunks, 1), &ranges);
+  int64_t total_size = 0;
+  for (const auto& r : ranges) {
+    total_size += r.size_bytes();
+  }
+  string split_key;
+  int64_t size_before = 0;
+  int64_t min_imbalance = total_size;
+  for (int i = 0; i + 1 < ranges.size(); ++i) {
+    size_before += ranges[i].size_bytes();
+    const int64_t imbalance = std::abs(2 * size_before - total_size);
+    if (imbalance < min_imbalance && !ranges[i].stop_primary_key().empty()) {
+      min_imbalance = imbalance;
+      split_key = ranges[i].stop_primary_key();
+    }
+  }
+  return split_key;
 }
 
 Status Tablet::NewRowIterator(const Schema& projection,
@@ -664,12 +787,17 @@ Status Tablet::DecodeWriteOperations(const Schema* client_schema,
   vector<DecodedRowOperation> ops;
 
   SchemaPtr schema_ptr = schema();
-  // Decode the ops
-  RowOperationsPBDecoder dec(&op_state->request()->row_operations(),
-                             client_schema,
-                             schema_ptr.get(),
-                             op_state->arena());
-  RETURN_NOT_OK(dec.DecodeOperations<DecoderMode::WRITE_OPS>(&ops, &auto_incrementing_counter_));
+  if (op_state->TakePredecodedOps(schema_ptr, &ops)) {
+    TRACE("Using the operations decoded before prepare");
+  } else {
+    // Decode the ops
+    RowOperationsPBDecoder dec(&op_state->request()->row_operations(),
+                               client_schema,
+                               schema_ptr.get(),
+                               op_state->arena());
+    RETURN_NOT_OK(dec.DecodeOperations<DecoderMode::WRITE_OPS>(&ops,
+                                                               &auto_incrementing_counter_));
+  }
   TRACE_COUNTER_INCREMENT("num_ops", ops.size());
 
   // Important to set the schema before the ops -- we need the
@@ -680,6 +808,25 @@ Status Tablet::DecodeWriteOperations(const Schema* client_schema,
   return Status::OK();
 }
 
+void Tablet::PredecodeWriteOperations(const Schema* client_schema,
+                                      WriteOpState* op_state) {
+  TRACE_EVENT0("tablet", "Tablet::PredecodeWriteOperations");
+  SchemaPtr schema_ptr = schema();
+  // Decoding assigns the values of auto-incrementing columns, which has to
+  // happen in the order the ops are prepared.
+  if (schema_ptr->has_auto_incrementing()) {
+    return;
+  }
+  vector<DecodedRowOperation> ops;
+  RowOperationsPBDecoder dec(&op_state->request()->row_operations(),
+                             client_schema,
+                             schema_ptr.get(),
+                             op_state->arena());
+  if (dec.DecodeOperations<DecoderMode::WRITE_OPS>(&ops).ok()) {
+    op_state->SetPredecodedOps(std::move(schema_ptr), std::move(ops));
+  }
+}
+
 Status Tablet::AcquireRowLocks(WriteOpState* op_state) {
   TRACE_EVENT1("tablet", "Tablet::AcquireRowLocks",
                "num_locks", op_state->row_ops().size());
@@ -1161,12 +1308,25 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
   // Run all of the ops through the RowSetTree.
   vector<pair<Slice, int>> keys_and_indexes;
   keys_and_indexes.reserve(num_ops);
+  // Whether the keys of the batch strictly increase, as they do when writing
+  // rows with sequential keys.
+  bool keys_ascend = true;
   for (int i = 0; i < num_ops; i++) {
     RowOp* op = row_ops_base[i];
     // If the op already failed in validation, or if we've got the original result
     // filled in already during replay, then we don't need to consult the RowSetTree.
     if (op->has_result() || op->orig_result_from_log) continue;
-    keys_and_indexes.emplace_back(op->key_probe->encoded_key_slice(), i);
+    // The key of a row just assigned an auto-incrementing value can't be
+    // present in any rowset, so there's nothing to look up.
+    if (op->decoded_op.auto_incrementing_value_assigned) {
+      op->checked_present = true;
+      continue;
+    }
+    const Slice& key = op->key_probe->encoded_key_slice();
+    if (keys_ascend && !keys_and_indexes.empty()) {
+      keys_ascend = keys_and_indexes.back().first < key;
+    }
+    keys_and_indexes.emplace_back(key, i);
   }
 
   // Sort the query points by their probe keys, retaining the equivalent indexes.
@@ -1178,23 +1338,25 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
   // TODO(todd): benchmark stable_sort vs using sort() and falling back to
   // comparing 'a.second' when a.first == b.first. Some microbenchmarks
   // seem to indicate stable_sort is actually faster.
-  // TODO(todd): could also consider weaving in a check in the loop above to
-  // see if the incoming batch is already totally-ordered and in that case
-  // skip this sort and std::unique call.
-  std::stable_sort(keys_and_indexes.begin(), keys_and_indexes.end(),
-                   [](const pair<Slice, int>& a,
-                      const pair<Slice, int>& b) {
-                     return a.first < b.first;
-                   });
-  // If the batch has more than one operation for the same row, then we can't
-  // use the up-front presence optimization on those operations, since the
-  // first operation may change the result of the later presence-checks.
-  keys_and_indexes.erase(std::unique(
-      keys_and_indexes.begin(), keys_and_indexes.end(),
-      [](const pair<Slice, int>& a,
-         const pair<Slice, int>& b) {
-        return a.first == b.first;
-      }), keys_and_indexes.end());
+  //
+  // A batch whose keys already strictly increase needs neither the sort nor
+  // the std::unique call.
+  if (!keys_ascend) {
+    std::stable_sort(keys_and_indexes.begin(), keys_and_indexes.end(),
+                     [](const pair<Slice, int>& a,
+                        const pair<Slice, int>& b) {
+                       return a.first < b.first;
+                     });
+    // If the batch has more than one operation for the same row, then we can't
+    // use the up-front presence optimization on those operations, since the
+    // first operation may change the result of the later presence-checks.
+    keys_and_indexes.erase(std::unique(
+        keys_and_indexes.begin(), keys_and_indexes.end(),
+        [](const pair<Slice, int>& a,
+           const pair<Slice, int>& b) {
+          return a.first == b.first;
+        }), keys_and_indexes.end());
+  }
 
   // Unzip the keys into a separate array (since the RowSetTree API just wants a vector of
   // Slices)
@@ -1236,6 +1398,12 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
   // 'pending_group' and then calls 'ProcessPendingGroup' when the next group
   // begins.
   vector<pair<RowSet*, int>> pending_group;
+  // The ops of the pending group which still need to be checked, along with
+  // their probes and stats. Reused across groups.
+  vector<RowOp*> group_ops;
+  vector<const RowSetKeyProbe*> group_probes;
+  vector<ProbeStats*> group_stats;
+  vector<bool> group_present;
   Status s;
   const auto& ProcessPendingGroup = [&]() {
     if (pending_group.empty() || !s.ok()) return;
@@ -1247,6 +1415,9 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
                             return keys[a.second] < keys[b.second];
                           }));
     RowSet* rs = pending_group[0].first;
+    group_ops.clear();
+    group_probes.clear();
+    group_stats.clear();
     for (auto it = pending_group.begin(); it != pending_group.end(); ++it) {
       DCHECK_EQ(it->first, rs) << "All results within a group should be for the same RowSet";
       int op_idx = keys_and_indexes[it->second].second;
@@ -1255,20 +1426,28 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
         // Already found this op present somewhere.
         continue;
       }
+      group_ops.push_back(op);
+      group_probes.push_back(op->key_probe);
+      group_stats.push_back(op_state->mutable_op_stats(op_idx));
+    }
+    pending_group.clear();
+    if (group_ops.empty()) {
+      return;
+    }
 
-      bool present = false;
-      s = rs->CheckRowPresent(*op->key_probe, io_context,
-                              &present, op_state->mutable_op_stats(op_idx));
-      if (PREDICT_FALSE(!s.ok())) {
-        LOG(WARNING) << Substitute("Tablet $0 failed to check row presence for op $1: $2",
-            tablet_id(), op->ToString(key_schema_), s.ToString());
-        return;
-      }
-      if (present) {
-        op->present_in_rowset = rs;
+    // Check the whole group at once, so the rowset can probe its bloom filter
+    // for all of the keys before seeking to any of them in its key index.
+    s = rs->CheckRowsPresent(group_probes, io_context, &group_present, group_stats);
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG(WARNING) << Substitute("Tablet $0 failed to check row presence in $1: $2",
+          tablet_id(), rs->ToString(), s.ToString());
+      return;
+    }
+    for (size_t i = 0; i < group_ops.size(); i++) {
+      if (group_present[i]) {
+        group_ops[i]->present_in_rowset = rs;
       }
     }
-    pending_group.clear();
   };
   comps->rowsets->ForEachRowSetContainingKeys(
       keys,
@@ -1365,6 +1544,18 @@ Status Tablet::ApplyRowOperations(WriteOpState* op_state) {
   const size_t num_ops = op_state->row_ops().size();
   StartApplying(op_state);
 
+  // Erase the rows about to be written from the row cache. This must happen
+  // before the op is applied in MVCC, i.e. before any snapshot including the
+  // writes could be taken.
+  shared_ptr<RowCache> rc = row_cache();
+  if (rc) {
+    for (const RowOp* row_op : op_state->row_ops()) {
+      if (!row_op->has_result()) {
+        rc->Invalidate(row_op->key_probe->encoded_key_slice(), op_state->timestamp());
+      }
+    }
+  }
+
   TRACE("starting BulkCheckPresence");
   IOContext io_context({ tablet_id() });
   RETURN_NOT_OK(BulkCheckPresence(&io_context, op_state));
@@ -1549,9 +1740,58 @@ bool Tablet::GetTabletAncientHistoryMark(Timestamp* ancient_history_mark) const
   return true;
 }
 
+bool Tablet::GetRowExpiry(ColumnId* ttl_col_id, int64_t* expired_before_micros) const {
+  const auto& extra_config = metadata_->extra_config();
+  if (!extra_config || !extra_config->has_row_ttl_column() || !extra_config->has_row_ttl_sec()) {
+    return false;
+  }
+  // The age of the rows is only known with the HybridClock.
+  if (!clock_->HasPhysicalComponent()) {
+    return false;
+  }
+  const SchemaPtr schema_ptr = schema();
+  const int idx = schema_ptr->find_column(extra_config->row_ttl_column());
+  if (idx == Schema::kColumnNotFound) {
+    return false;
+  }
+  const ColumnSchema& col = schema_ptr->column(idx);
+  if (col.type_info()->type() != UNIXTIME_MICROS || col.is_nullable()) {
+    KLOG_EVERY_N_SECS(WARNING, 60) << LogPrefix() << Substitute(
+        "ignoring row TTL: column $0 is not a non-nullable UNIXTIME_MICROS column",
+        col.name());
+    return false;
+  }
+  const int64_t now_micros = HybridClock::GetPhysicalValueMicros(clock_->Now());
+  *ttl_col_id = schema_ptr->column_id(idx);
+  *expired_before_micros = now_micros - extra_config->row_ttl_sec() * 1000000LL;
+  return true;
+}
+
+bool Tablet::GetColdRowSetCutoff(Timestamp* cutoff) const {
+  const int32_t age_days = FLAGS_tablet_cold_rowset_age_days;
+  if (age_days <= 0 || !clock_->HasPhysicalComponent()) {
+    return false;
+  }
+  const Timestamp now = clock_->Now();
+  const uint64_t now_micros = HybridClock::GetPhysicalValueMicros(now);
+  const uint64_t age_micros = age_days * 24ULL * 60 * 60 * 1000000;
+  if (age_micros > now_micros) {
+    return false;
+  }
+  *cutoff = HybridClock::TimestampFromMicrosecondsAndLogicalValue(
+      now_micros - age_micros, HybridClock::GetLogicalValue(now));
+  return true;
+}
+
 HistoryGcOpts Tablet::GetHistoryGcOpts() const {
   Timestamp ancient_history_mark;
   if (GetTabletAncientHistoryMark(&ancient_history_mark)) {
+    ColumnId ttl_col_id;
+    int64_t expired_before_micros;
+    if (GetRowExpiry(&ttl_col_id, &expired_before_micros)) {
+      return HistoryGcOpts::Enabled(ancient_history_mark).WithRowExpiry(
+          ttl_col_id, expired_before_micros);
+    }
     return HistoryGcOpts::Enabled(ancient_history_mark);
   }
   return HistoryGcOpts::Disabled();
@@ -1728,6 +1968,8 @@ Status Tablet::AlterSchema(AlterSchemaOpState* op_state) {
                         << " version " << op_state->schema_version();
   DCHECK(schema_lock_.is_locked());
   metadata_->SetSchema(op_state->schema(), op_state->schema_version());
+  // The cached rows have the old schema.
+  ResetRowCache();
   if (op_state->has_new_table_name()) {
     metadata_->SetTableName(op_state->new_table_name());
     if (metric_entity_) {
@@ -1758,6 +2000,7 @@ Status Tablet::RewindSchemaForBootstrap(const Schema& new_schema,
 
   SchemaPtr schema = std::make_shared<Schema>(new_schema);
   metadata_->SetSchema(schema, schema_version);
+  ResetRowCache();
   {
     std::lock_guard<rw_spinlock> lock(component_lock_);
 
@@ -1774,6 +2017,16 @@ Status Tablet::RewindSchemaForBootstrap(const Schema& new_schema,
   return Status::OK();
 }
 
+void Tablet::ResetRowCache() {
+  if (FLAGS_tablet_row_cache_capacity_mb <= 0) {
+    return;
+  }
+  auto rc = make_shared<RowCache>(schema(), FLAGS_tablet_row_cache_capacity_mb * 1024 * 1024,
+                                  clock_->Now(), "tablet_row_cache");
+  std::lock_guard<rw_spinlock> l(component_lock_);
+  row_cache_ = std::move(rc);
+}
+
 void Tablet::SetCompactionHooksForTests(
   const shared_ptr<Tablet::CompactionFaultHooks> &hooks) {
   compaction_hooks_ = hooks;
@@ -1828,10 +2081,10 @@ Status Tablet::PickRowSetsToCompact(RowSetsInCompaction *picked,
   } else {
     // Let the policy decide which rowsets to compact.
     double quality = 0.0;
-    RETURN_NOT_OK(compaction_policy_->PickRowSets(*rowsets_copy,
-                                                  &picked_set,
-                                                  &quality,
-                                                  /*log=*/nullptr));
+    RETURN_NOT_OK(compaction_policy()->PickRowSets(*rowsets_copy,
+                                                   &picked_set,
+                                                   &quality,
+                                                   /*log=*/nullptr));
     VLOG_WITH_PREFIX(2) << "Compaction quality: " << quality;
   }
 
@@ -1899,6 +2152,20 @@ bool Tablet::compaction_enabled() const {
   return true;
 }
 
+CompactionPolicy* Tablet::compaction_policy() const {
+  const auto& extra_config = metadata_->extra_config();
+  TableExtraConfigPB::CompactionPolicy policy;
+  if (extra_config && extra_config->has_compaction_policy()) {
+    policy = extra_config->compaction_policy();
+  } else {
+    CHECK(ParseCompactionPolicy(FLAGS_tablet_compaction_policy, &policy));
+  }
+  if (policy == TableExtraConfigPB::SIZE_TIERED) {
+    return size_tiered_compaction_policy_.get();
+  }
+  return budgeted_compaction_policy_.get();
+}
+
 void Tablet::GetRowSetsForTests(RowSetVector* out) {
   shared_ptr<RowSetTree> rowsets_copy;
   {
@@ -1937,6 +2204,9 @@ void Tablet::RegisterMaintenanceOps(MaintenanceManager* maint_mgr) {
   maintenance_ops.emplace_back(new UndoDeltaBlockGCOp(this));
   maint_mgr->RegisterOp(maintenance_ops.back().get());
 
+  maintenance_ops.emplace_back(new CompactMemRowSetMutationsOp(this));
+  maint_mgr->RegisterOp(maintenance_ops.back().get());
+
   // The deleted rowset GC operation relies on live rowset counting. If this
   // tablet doesn't support such counting, do not register the op.
   if (metadata_->supports_live_row_count()
@@ -1945,6 +2215,9 @@ void Tablet::RegisterMaintenanceOps(MaintenanceManager* maint_mgr) {
     maint_mgr->RegisterOp(maintenance_ops.back().get());
   }
 
+  maintenance_ops.emplace_back(new MigrateColdRowSetsOp(this));
+  maint_mgr->RegisterOp(maintenance_ops.back().get());
+
   std::lock_guard<simple_spinlock> l(state_lock_);
   maintenance_ops_ = std::move(maintenance_ops);
 }
@@ -2030,45 +2303,53 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
                           "PostTakeMvccSnapshot hook failed");
   }
 
-  shared_ptr<CompactionInput> merge;
   const SchemaPtr schema_ptr = schema();
-  RETURN_NOT_OK(input.CreateCompactionInput(flush_snap, schema_ptr.get(), &io_context, &merge));
-
-  RollingDiskRowSetWriter drsw(metadata_.get(), merge->schema(), DefaultBloomSizing(),
-                               compaction_policy_->target_rowset_size());
-  RETURN_NOT_OK_PREPEND(drsw.Open(), "Failed to open DiskRowSet for flush");
-
   HistoryGcOpts history_gc_opts = GetHistoryGcOpts();
-  RETURN_NOT_OK_PREPEND(
-      FlushCompactionInput(
-          tid, metadata_->fs_manager()->block_manager()->error_manager(),
-          merge.get(), flush_snap, history_gc_opts, &drsw),
-      "Flush to disk failed");
-  RETURN_NOT_OK_PREPEND(drsw.Finish(), "Failed to finish DRS writer");
+  vector<unique_ptr<RollingDiskRowSetWriter>> drsws;
+  size_t peak_mem_usage_ph1 = 0;
+  RETURN_NOT_OK(WriteCompactionOrFlushOutput(
+      input, mrs_being_flushed != TabletMetadata::kNoMrsFlushed, flush_snap, history_gc_opts,
+      schema_ptr.get(), &io_context, &drsws, &peak_mem_usage_ph1));
 
   if (common_hooks_) {
     RETURN_NOT_OK_PREPEND(common_hooks_->PostWriteSnapshot(),
                           "PostWriteSnapshot hook failed");
   }
 
+  // The writers wrote out one or more RowSets as the output, in key order.
+  int64_t rows_written = 0;
+  int64_t drs_written = 0;
+  uint64_t bytes_written = 0;
+  RowSetMetadataVector new_drs_metas;
+  for (const auto& drsw : drsws) {
+    rows_written += drsw->rows_written_count();
+    drs_written += drsw->drs_written_count();
+    bytes_written += drsw->written_size();
+    RowSetMetadataVector metas;
+    drsw->GetWrittenRowSetMetadata(&metas);
+    new_drs_metas.insert(new_drs_metas.end(), metas.begin(), metas.end());
+  }
+
   // Though unlikely, it's possible that no rows were written because all of
   // the input rows were GCed in this compaction. In that case, we don't
   // actually want to reopen.
-  if (drsw.rows_written_count() == 0) {
+  if (rows_written == 0) {
     LOG_WITH_PREFIX(INFO) << op_name << " resulted in no output rows (all input rows "
                           << "were GCed!)  Removing all input rowsets.";
     return HandleEmptyCompactionOrFlush(input.rowsets(), mrs_being_flushed,
                                         txns_being_flushed);
   }
 
-  // The RollingDiskRowSet writer wrote out one or more RowSets as the
-  // output. Open these into 'new_rowsets'.
-  RowSetMetadataVector new_drs_metas;
-  drsw.GetWrittenRowSetMetadata(&new_drs_metas);
+  // Open the output RowSets into 'new_rowsets'.
   CHECK(!new_drs_metas.empty());
 
   if (metrics_) {
-    metrics_->bytes_flushed->IncrementBy(drsw.written_size());
+    metrics_->bytes_flushed->IncrementBy(bytes_written);
+    if (mrs_being_flushed == TabletMetadata::kNoMrsFlushed) {
+      metrics_->compact_rs_bytes_written->IncrementBy(bytes_written);
+    } else {
+      metrics_->flush_mrs_bytes_written->IncrementBy(bytes_written);
+    }
   }
 
   vector<shared_ptr<RowSet>> new_disk_rowsets;
@@ -2173,15 +2454,13 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
                           "PostSwapInDuplicatingRowSet hook failed");
   }
 
-  // Store the stats on the max memory used for compaction phase 1.
-  const size_t peak_mem_usage_ph1 = merge->memory_footprint();
-
   // Phase 2. Here we re-scan the compaction input, copying those missed updates into the
   // new rowset's DeltaTracker.
   VLOG_WITH_PREFIX(1) << Substitute("$0: Phase 2: carrying over any updates "
                                     "which arrived during Phase 1. Snapshot: $1",
                                     op_name, non_duplicated_ops_snap.ToString());
   const SchemaPtr schema_ptr2 = schema();
+  shared_ptr<CompactionInput> merge;
   RETURN_NOT_OK_PREPEND(
       input.CreateCompactionInput(non_duplicated_ops_snap, schema_ptr2.get(), &io_context, &merge),
           Substitute("Failed to create $0 inputs", op_name).c_str());
@@ -2256,9 +2535,6 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
     }
   }
 
-  const auto rows_written = drsw.rows_written_count();
-  const auto drs_written = drsw.drs_written_count();
-  const auto bytes_written = drsw.written_size();
   TRACE_COUNTER_INCREMENT("rows_written", rows_written);
   TRACE_COUNTER_INCREMENT("drs_written", drs_written);
   TRACE_COUNTER_INCREMENT("bytes_written", bytes_written);
@@ -2277,6 +2553,101 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
   return Status::OK();
 }
 
+Status Tablet::WriteCompactionOrFlushOutput(
+    const RowSetsInCompaction& input,
+    bool is_flush,
+    const MvccSnapshot& snap,
+    const HistoryGcOpts& history_gc_opts,
+    const Schema* schema,
+    const IOContext* io_context,
+    vector<unique_ptr<RollingDiskRowSetWriter>>* writers,
+    size_t* peak_mem_usage) {
+  const uint64_t target_rowset_size = compaction_policy()->target_rowset_size();
+
+  // Split compactions into key ranges holding about the same amount of data,
+  // each at least the size of an output rowset. Flushes aren't split: their
+  // input is made of MemRowSets, which aren't worth splitting.
+  vector<KeyRange> ranges;
+  if (!is_flush && FLAGS_tablet_compaction_parallel_ranges > 1) {
+    uint64_t total_size = 0;
+    for (const auto& rs : input.rowsets()) {
+      total_size += rs->OnDiskBaseDataSizeWithRedos();
+    }
+    if (total_size >= 2 * target_rowset_size) {
+      RowSetTree tree;
+      RETURN_NOT_OK(tree.Reset(input.rowsets()));
+      RowSetInfo::SplitKeyRange(
+          tree, Slice(), Slice(), {},
+          std::max<uint64_t>(total_size / FLAGS_tablet_compaction_parallel_ranges,
+                             target_rowset_size),
+          &ranges);
+    }
+    if (ranges.size() <= 1) {
+      ranges.clear();
+    }
+  }
+  const size_t num_ranges = std::max<size_t>(ranges.size(), 1);
+
+  writers->clear();
+  writers->resize(num_ranges);
+  vector<Status> statuses(num_ranges);
+  vector<size_t> mem_usages(num_ranges, 0);
+  const auto write_range = [&](size_t i) -> Status {
+    shared_ptr<CompactionInput> merge;
+    if (ranges.empty()) {
+      RETURN_NOT_OK(input.CreateCompactionInput(snap, schema, io_context, &merge));
+    } else {
+      RETURN_NOT_OK(input.CreateCompactionInput(snap, schema, io_context,
+                                                ranges[i].start_primary_key(),
+                                                ranges[i].stop_primary_key(),
+                                                &merge));
+    }
+    auto& drsw = (*writers)[i];
+    // The output of flushes is likely to be compacted soon, unlike the output
+    // of compactions.
+    drsw.reset(new RollingDiskRowSetWriter(metadata_.get(), merge->schema(),
+                                           DefaultBloomSizing(), target_rowset_size,
+                                           is_flush ? fs::BlockTemperature::HOT
+                                                    : fs::BlockTemperature::COLD));
+    RETURN_NOT_OK_PREPEND(drsw->Open(), "Failed to open DiskRowSet for flush");
+    RETURN_NOT_OK_PREPEND(
+        FlushCompactionInput(
+            tablet_id(), metadata_->fs_manager()->block_manager()->error_manager(),
+            merge.get(), snap, history_gc_opts, drsw.get()),
+        "Flush to disk failed");
+    RETURN_NOT_OK_PREPEND(drsw->Finish(), "Failed to finish DRS writer");
+    mem_usages[i] = merge->memory_footprint();
+    return Status::OK();
+  };
+
+  // The first range is written on this thread, the others each on their own.
+  if (num_ranges > 1) {
+    VLOG_WITH_PREFIX(1) << Substitute("Compaction split into $0 key ranges", num_ranges);
+  }
+  vector<scoped_refptr<Thread>> threads;
+  for (size_t i = 1; i < num_ranges; i++) {
+    scoped_refptr<Thread> thread;
+    Status s = Thread::Create("tablet", Substitute("compaction-range-$0", i),
+                              [&, i]() { statuses[i] = write_range(i); }, &thread);
+    if (PREDICT_FALSE(!s.ok())) {
+      statuses[i] = std::move(s);
+      continue;
+    }
+    threads.emplace_back(std::move(thread));
+  }
+  statuses[0] = write_range(0);
+  for (const auto& thread : threads) {
+    thread->Join();
+  }
+
+  *peak_mem_usage = 0;
+  for (size_t i = 0; i < num_ranges; i++) {
+    RETURN_NOT_OK(statuses[i]);
+    *peak_mem_usage += mem_usages[i];
+  }
+  return Status::OK();
+}
+
 Status Tablet::HandleEmptyCompactionOrFlush(const RowSetVector& rowsets,
                                             int mrs_being_flushed,
                                             const vector<TxnInfoBeingFlushed>& txns_being_flushed) {
@@ -2358,7 +2729,7 @@ void Tablet::UpdateCompactionStats(MaintenanceOpStats* stats) {
 
   {
     std::lock_guard<std::mutex> compact_lock(compact_select_lock_);
-    WARN_NOT_OK(compaction_policy_->PickRowSets(*rowsets_copy, &picked, &quality, nullptr),
+    WARN_NOT_OK(compaction_policy()->PickRowSets(*rowsets_copy, &picked, &quality, nullptr),
                 Substitute("Couldn't determine compaction quality for $0", tablet_id()));
   }
 
@@ -2370,7 +2741,11 @@ void Tablet::UpdateCompactionStats(MaintenanceOpStats* stats) {
   // all the rowsets picked for this rowset compaction.
   int64_t ancient_undos_total_size = 0;
 
+  // The picked rowsets are read and rewritten.
+  int64_t io_bytes = 0;
+
   for (const auto* rs : picked) {
+    io_bytes += 2 * rs->OnDiskSize();
     const auto* drs = down_cast<const DiskRowSet*>(rs);
     const auto& dt = drs->delta_tracker();
 
@@ -2423,6 +2798,7 @@ void Tablet::UpdateCompactionStats(MaintenanceOpStats* stats) {
 
   stats->set_runnable(!much_of_ancient_data && quality >= 0);
   stats->set_perf_improvement(quality);
+  stats->set_io_bytes(io_bytes);
 }
 
 
@@ -2496,6 +2872,12 @@ Status Tablet::CaptureConsistentIterators(
   // If there are no encoded predicates of the primary keys, then
   // fall back to grabbing all rowset iterators.
   for (const shared_ptr<RowSet>& rs : components_->rowsets->all_rowsets()) {
+    RowSetChecksum checksum;
+    if (opts.known_rowset_checksums && rs->GetKnownChecksum(opts.snap_to_include, &checksum)) {
+      opts.known_rowset_checksums->checksum += checksum.checksum;
+      opts.known_rowset_checksums->num_rows += checksum.num_rows;
+      continue;
+    }
     IterWithBounds iwb;
     RETURN_NOT_OK_PREPEND(rs->NewRowIteratorWithBounds(opts, &iwb),
                           Substitute("Could not create iterator for rowset $0",
@@ -2551,6 +2933,39 @@ Status Tablet::CountLiveRows(uint64_t* count) const {
   return Status::OK();
 }
 
+int64_t Tablet::MemRowSetMutationsToCompact() const {
+  scoped_refptr<TabletComponents> comps;
+  GetComponentsOrNull(&comps);
+  return comps ? comps->memrowset->num_mutations_to_compact() : 0;
+}
+
+Status Tablet::CompactMemRowSetMutations() {
+  RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
+  Timestamp fold_before;
+  if (!GetTabletAncientHistoryMark(&fold_before)) {
+    // Scans may read at any time, so they may need any mutation.
+    return Status::OK();
+  }
+  fold_before = std::min(fold_before, mvcc_.GetCleanTimestamp());
+
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+  const shared_ptr<MemRowSet>& mrs = comps->memrowset;
+  std::unique_lock<std::mutex> l(*mrs->compact_flush_lock(), std::try_to_lock);
+  if (!l.owns_lock()) {
+    // The MRS is being flushed: its mutations are about to be compacted anyway.
+    return Status::OK();
+  }
+  const MonoTime start_time = MonoTime::Now();
+  int64_t folded = 0;
+  RETURN_NOT_OK_PREPEND(mrs->CompactMutations(fold_before, &folded),
+                        "failed to compact the mutations of the MRS");
+  VLOG_WITH_PREFIX(1) << Substitute("Folded $0 mutations into the rows of MRS $1 in $2",
+                                    folded, mrs->mrs_id(),
+                                    (MonoTime::Now() - start_time).ToString());
+  return Status::OK();
+}
+
 size_t Tablet::MemRowSetSize() const {
   scoped_refptr<TabletComponents> comps;
   GetComponentsOrNull(&comps);
@@ -2574,6 +2989,12 @@ bool Tablet::MemRowSetEmpty() const {
       [] (const shared_ptr<MemRowSet>& mrs) { return mrs->empty(); });
 }
 
+size_t Tablet::num_committed_txn_memrowsets() const {
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+  return comps->txn_memrowsets.size();
+}
+
 size_t Tablet::MemRowSetLogReplaySize(const ReplaySizeMap& replay_size_map) const {
   scoped_refptr<TabletComponents> comps;
   GetComponents(&comps);
@@ -2595,6 +3016,41 @@ size_t Tablet::MemRowSetLogReplaySize(const ReplaySizeMap& replay_size_map) cons
   return GetReplaySizeForIndex(min_index, replay_size_map);
 }
 
+Status Tablet::GetColumnStats(vector<ColumnStatsPB>* stats) const {
+  scoped_refptr<TabletComponents> comps;
+  GetComponentsOrNull(&comps);
+  if (!comps) {
+    return Status::RuntimeError("The tablet has been shut down");
+  }
+
+  const SchemaPtr schema_ptr = schema();
+  const auto& rowsets = comps->rowsets->all_rowsets();
+  stats->clear();
+  if (rowsets.empty()) {
+    return Status::OK();
+  }
+  unordered_map<int32_t, ColumnStatsPB> stats_by_column_id;
+  unordered_map<int32_t, int> num_merged_by_column_id;
+  for (const auto& rowset : rowsets) {
+    google::protobuf::RepeatedPtrField<ColumnStatsPB> rowset_stats;
+    for (auto& column_stats : rowset->metadata()->column_stats()) {
+      *rowset_stats.Add() = std::move(column_stats);
+    }
+    RETURN_NOT_OK(MergeColumnStats(rowset_stats, *schema_ptr,
+                                   &stats_by_column_id, &num_merged_by_column_id));
+  }
+
+  for (size_t col_idx = 0; col_idx < schema_ptr->num_columns(); ++col_idx) {
+    const int32_t column_id = schema_ptr->column_id(col_idx);
+    const int num_merged = FindWithDefault(num_merged_by_column_id, column_id, 0);
+    if (num_merged != static_cast<int>(rowsets.size())) {
+      continue;
+    }
+    stats->emplace_back(std::move(stats_by_column_id[column_id]));
+  }
+  return Status::OK();
+}
+
 size_t Tablet::OnDiskSize() const {
   scoped_refptr<TabletComponents> comps;
   GetComponentsOrNull(&comps);
@@ -2622,6 +3078,13 @@ size_t Tablet::OnDiskDataSize() const {
   return ret;
 }
 
+vector<string> Tablet::DataDirs() const {
+  vector<string> data_dirs;
+  ignore_result(metadata_->fs_manager()->dd_manager()->FindDataDirsByTabletId(tablet_id(),
+                                                                              &data_dirs));
+  return data_dirs;
+}
+
 uint64_t Tablet::LastReadElapsedSeconds() const {
   shared_lock<rw_spinlock> l(last_rw_time_lock_);
   DCHECK(last_read_time_.Initialized());
@@ -2706,14 +3169,114 @@ bool Tablet::DeltaMemRowSetEmpty() const {
   return true;
 }
 
+namespace {
+
+// Runs 'f' on each of 'rowsets', on this thread for the first one and on a
+// thread of its own for each of the others. Returns the first error.
+Status ForEachRowSetInParallel(const RowSetVector& rowsets, const string& thread_name,
+                               const std::function<Status(RowSet*)>& f) {
+  vector<Status> statuses(rowsets.size());
+  vector<scoped_refptr<Thread>> threads;
+  for (size_t i = 1; i < rowsets.size(); i++) {
+    scoped_refptr<Thread> thread;
+    Status s = Thread::Create("tablet", Substitute("$0-$1", thread_name, i),
+                              [&, i]() { statuses[i] = f(rowsets[i].get()); }, &thread);
+    if (PREDICT_FALSE(!s.ok())) {
+      statuses[i] = std::move(s);
+      continue;
+    }
+    threads.emplace_back(std::move(thread));
+  }
+  if (!rowsets.empty()) {
+    statuses[0] = f(rowsets[0].get());
+  }
+  for (const auto& thread : threads) {
+    thread->Join();
+  }
+  for (const auto& s : statuses) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
+// To facilitate memory-based flushing when under memory pressure, the score
+// of a DMS is part memory and part WAL retention bytes.
+double DMSFlushScore(size_t dms_size_bytes, int64_t replay_size_bytes, double mem_weight) {
+  return dms_size_bytes * mem_weight + replay_size_bytes * (100 - mem_weight);
+}
+
+// A RowSet to process in a delta flush or a minor delta compaction of
+// multiple RowSets, along with its score and the size of its deltas.
+struct DeltaMaintenanceCandidate {
+  double score;
+  uint64_t size_bytes;
+  shared_ptr<RowSet> rowset;
+};
+
+// Returns the RowSets of 'candidates' with the best scores, as many as
+// --tablet_delta_maintenance_parallel_rowsets and
+// --tablet_delta_maintenance_budget_mb allow.
+RowSetVector PickDeltaMaintenanceCandidates(vector<DeltaMaintenanceCandidate> candidates) {
+  std::sort(candidates.begin(), candidates.end(),
+            [](const DeltaMaintenanceCandidate& a, const DeltaMaintenanceCandidate& b) {
+              return a.score > b.score || (a.score == b.score && a.size_bytes > b.size_bytes);
+            });
+  const size_t max_rowsets = std::max(FLAGS_tablet_delta_maintenance_parallel_rowsets, 1);
+  const uint64_t budget_bytes =
+      static_cast<uint64_t>(std::max(FLAGS_tablet_delta_maintenance_budget_mb, 0)) * 1024 * 1024;
+  RowSetVector rowsets;
+  uint64_t total_size_bytes = 0;
+  for (auto& candidate : candidates) {
+    if (rowsets.size() == max_rowsets ||
+        (!rowsets.empty() && total_size_bytes + candidate.size_bytes > budget_bytes)) {
+      break;
+    }
+    total_size_bytes += candidate.size_bytes;
+    rowsets.emplace_back(std::move(candidate.rowset));
+  }
+  return rowsets;
+}
+
+} // anonymous namespace
+
 Status Tablet::FlushBestDMS(const ReplaySizeMap &replay_size_map) const {
   RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
-  shared_ptr<RowSet> rowset = FindBestDMSToFlush(replay_size_map);
-  if (rowset) {
-    IOContext io_context({ tablet_id() });
-    return rowset->FlushDeltas(&io_context);
+  RowSetVector rowsets;
+  if (FLAGS_tablet_delta_maintenance_parallel_rowsets > 1) {
+    rowsets = FindBestDMSsToFlush(replay_size_map);
+  } else if (auto rowset = FindBestDMSToFlush(replay_size_map)) {
+    rowsets.emplace_back(std::move(rowset));
   }
-  return Status::OK();
+  if (rowsets.size() > 1) {
+    VLOG_WITH_PREFIX(1) << Substitute("Flushing the DMSs of $0 rowsets", rowsets.size());
+  }
+  IOContext io_context({ tablet_id() });
+  const HistoryGcOpts history_gc_opts = GetHistoryGcOpts();
+  return ForEachRowSetInParallel(rowsets, "flush-dms", [&](RowSet* rowset) {
+    // Only DiskRowSets have a DMS to pick for flushing.
+    return down_cast<DiskRowSet*>(rowset)->FlushDeltas(&io_context, history_gc_opts);
+  });
+}
+
+RowSetVector Tablet::FindBestDMSsToFlush(const ReplaySizeMap& replay_size_map) const {
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+  double mem_weight = 0;
+  process_memory::UnderMemoryPressure(&mem_weight);
+
+  vector<DeltaMaintenanceCandidate> candidates;
+  for (const shared_ptr<RowSet>& rowset : comps->rowsets->all_rowsets()) {
+    size_t dms_size_bytes;
+    MonoTime creation_time;
+    if (!rowset->DeltaMemStoreInfo(&dms_size_bytes, &creation_time)) {
+      continue;
+    }
+    int64_t replay_size_bytes = GetReplaySizeForIndex(rowset->MinUnflushedLogIndex(),
+                                                      replay_size_map);
+    candidates.push_back({ DMSFlushScore(dms_size_bytes, replay_size_bytes, mem_weight),
+                           dms_size_bytes, rowset });
+  }
+  return PickDeltaMaintenanceCandidates(std::move(candidates));
 }
 
 shared_ptr<RowSet> Tablet::FindBestDMSToFlush(const ReplaySizeMap& replay_size_map,
@@ -2741,9 +3304,7 @@ shared_ptr<RowSet> Tablet::FindBestDMSToFlush(const ReplaySizeMap& replay_size_m
     earliest_creation_time = std::min(earliest_creation_time, creation_time);
     int64_t replay_size_bytes = GetReplaySizeForIndex(rowset->MinUnflushedLogIndex(),
                                                       replay_size_map);
-    // To facilitate memory-based flushing when under memory pressure, we
-    // define a score that's part memory and part WAL retention bytes.
-    double score = dms_size_bytes * mem_weight + replay_size_bytes * (100 - mem_weight);
+    double score = DMSFlushScore(dms_size_bytes, replay_size_bytes, mem_weight);
     if ((score > max_score) ||
         // If the score is close to the max, as a tie-breaker, just look at the
         // DMS size.
@@ -2798,16 +3359,21 @@ Status Tablet::FlushBiggestDMSForTests() {
   return biggest_drs ? biggest_drs->FlushDeltas(nullptr) : Status::OK();
 }
 
-Status Tablet::FlushAllDMSForTests() {
+Status Tablet::FlushAllDMS() {
   RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
   scoped_refptr<TabletComponents> comps;
   GetComponents(&comps);
+  IOContext io_context({ tablet_id() });
   for (const auto& rowset : comps->rowsets->all_rowsets()) {
-    RETURN_NOT_OK(rowset->FlushDeltas(nullptr));
+    RETURN_NOT_OK(rowset->FlushDeltas(&io_context));
   }
   return Status::OK();
 }
 
+Status Tablet::FlushAllDMSForTests() {
+  return FlushAllDMS();
+}
+
 Status Tablet::MajorCompactAllDeltaStoresForTests() {
   LOG_WITH_PREFIX(INFO) << "Major compacting all delta stores, for tests";
   RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
@@ -2827,37 +3393,70 @@ Status Tablet::MajorCompactAllDeltaStoresForTests() {
 
 Status Tablet::CompactWorstDeltas(RowSet::DeltaCompactionType type) {
   RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
-  shared_ptr<RowSet> rs;
+  RowSetVector rowsets;
 
-  // We're required to grab the rowset's compact_flush_lock under the compact_select_lock_.
-  std::unique_lock<std::mutex> lock;
-  double perf_improv;
+  // We're required to grab the rowsets' compact_flush_lock under the compact_select_lock_.
+  vector<std::unique_lock<std::mutex>> locks;
   {
     // We only want to keep the selection lock during the time we look at rowsets to compact.
-    // The returned rowset is guaranteed to be available to lock since locking must be done
+    // The returned rowsets are guaranteed to be available to lock since locking must be done
     // under this lock.
     std::lock_guard<std::mutex> compact_lock(compact_select_lock_);
-    perf_improv = GetPerfImprovementForBestDeltaCompactUnlocked(type, &rs);
-    if (!rs) {
-      return Status::OK();
+    if (type == RowSet::MINOR_DELTA_COMPACTION &&
+        FLAGS_tablet_delta_maintenance_parallel_rowsets > 1) {
+      rowsets = FindWorstDeltasToMinorCompactUnlocked();
+    } else {
+      shared_ptr<RowSet> rs;
+      double perf_improv = GetPerfImprovementForBestDeltaCompactUnlocked(type, &rs);
+      if (rs) {
+        DCHECK(perf_improv != 0);
+        rowsets.emplace_back(std::move(rs));
+      }
+    }
+    for (const auto& rs : rowsets) {
+      locks.emplace_back(*rs->compact_flush_lock(), std::try_to_lock);
+      CHECK(locks.back().owns_lock());
     }
-    lock = std::unique_lock<std::mutex>(*rs->compact_flush_lock(), std::try_to_lock);
-    CHECK(lock.owns_lock());
   }
 
   // We just released compact_select_lock_ so other compactions can select and run, but the
-  // rowset is ours.
-  DCHECK(perf_improv != 0);
+  // rowsets are ours.
+  if (rowsets.size() > 1) {
+    VLOG_WITH_PREFIX(1) << Substitute("Compacting the deltas of $0 rowsets", rowsets.size());
+  }
   IOContext io_context({ tablet_id() });
-  if (type == RowSet::MINOR_DELTA_COMPACTION) {
-    RETURN_NOT_OK_PREPEND(rs->MinorCompactDeltaStores(&io_context),
-                          "Failed minor delta compaction on " + rs->ToString());
-  } else if (type == RowSet::MAJOR_DELTA_COMPACTION) {
-    RETURN_NOT_OK_PREPEND(
-        down_cast<DiskRowSet*>(rs.get())->MajorCompactDeltaStores(&io_context, GetHistoryGcOpts()),
-        "Failed major delta compaction on " + rs->ToString());
+  return ForEachRowSetInParallel(rowsets, "delta-compaction", [&](RowSet* rs) -> Status {
+    if (type == RowSet::MINOR_DELTA_COMPACTION) {
+      RETURN_NOT_OK_PREPEND(rs->MinorCompactDeltaStores(&io_context),
+                            "Failed minor delta compaction on " + rs->ToString());
+    } else if (type == RowSet::MAJOR_DELTA_COMPACTION) {
+      RETURN_NOT_OK_PREPEND(
+          down_cast<DiskRowSet*>(rs)->MajorCompactDeltaStores(&io_context, GetHistoryGcOpts()),
+          "Failed major delta compaction on " + rs->ToString());
+    }
+    return Status::OK();
+  });
+}
+
+RowSetVector Tablet::FindWorstDeltasToMinorCompactUnlocked() const {
+  std::unique_lock<std::mutex> cs_lock(compact_select_lock_, std::try_to_lock);
+  DCHECK(!cs_lock.owns_lock());
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+  vector<DeltaMaintenanceCandidate> candidates;
+  for (const auto& rowset : comps->rowsets->all_rowsets()) {
+    if (!rowset->IsAvailableForCompaction()) {
+      continue;
+    }
+    double perf_improv =
+        rowset->DeltaStoresCompactionPerfImprovementScore(RowSet::MINOR_DELTA_COMPACTION);
+    if (perf_improv > 0) {
+      candidates.push_back({ perf_improv,
+                             rowset->OnDiskBaseDataSizeWithRedos() - rowset->OnDiskBaseDataSize(),
+                             rowset });
+    }
   }
-  return Status::OK();
+  return PickDeltaMaintenanceCandidates(std::move(candidates));
 }
 
 double Tablet::GetPerfImprovementForBestDeltaCompact(RowSet::DeltaCompactionType type,
@@ -3064,6 +3663,84 @@ Status Tablet::DeleteAncientDeletedRowsets() {
   return Status::OK();
 }
 
+Status Tablet::GetBytesInColdRowSetCandidates(int64_t* bytes) {
+  Timestamp cutoff;
+  if (!GetColdRowSetCutoff(&cutoff)) {
+    *bytes = 0;
+    return Status::OK();
+  }
+
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+  int64_t total_bytes = 0;
+  {
+    std::lock_guard<std::mutex> csl(compact_select_lock_);
+    for (const auto& rowset : comps->rowsets->all_rowsets()) {
+      if (!rowset->IsAvailableForCompaction() || rowset->metadata()->cold()) {
+        continue;
+      }
+      bool older = false;
+      RETURN_NOT_OK(rowset->IsFullyOlderThan(cutoff, &older));
+      if (older) {
+        total_bytes += rowset->OnDiskSize();
+      }
+    }
+  }
+  *bytes = total_bytes;
+  return Status::OK();
+}
+
+Status Tablet::MigrateColdRowSets() {
+  RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
+  const MonoTime start_time = MonoTime::Now();
+  Timestamp cutoff;
+  if (!GetColdRowSetCutoff(&cutoff)) {
+    return Status::OK();
+  }
+
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+
+  // Like for a compaction, take the rowsets' locks so no other compaction
+  // selects them while they're rewritten.
+  RowSetsInCompaction input;
+  const int64_t budget_bytes = FLAGS_tablet_compaction_budget_mb * 1024LL * 1024;
+  int64_t bytes_migrated = 0;
+  {
+    std::lock_guard<std::mutex> csl(compact_select_lock_);
+    for (const auto& rowset : comps->rowsets->all_rowsets()) {
+      if (!rowset->IsAvailableForCompaction() || rowset->metadata()->cold()) {
+        continue;
+      }
+      bool older = false;
+      RETURN_NOT_OK(rowset->IsFullyOlderThan(cutoff, &older));
+      if (!older) {
+        continue;
+      }
+      // Always migrate at least one rowset, however large.
+      const int64_t rowset_bytes = rowset->OnDiskSize();
+      if (input.num_rowsets() > 0 && bytes_migrated + rowset_bytes > budget_bytes) {
+        break;
+      }
+      std::unique_lock<std::mutex> l(*rowset->compact_flush_lock(), std::try_to_lock);
+      CHECK(l.owns_lock());
+      input.AddRowSet(rowset, std::move(l));
+      bytes_migrated += rowset_bytes;
+    }
+  }
+  if (input.num_rowsets() == 0) {
+    return Status::OK();
+  }
+  VLOG_WITH_PREFIX(1) << Substitute("Migrating $0 rowsets ($1 bytes) to cold data",
+                                    input.num_rowsets(), bytes_migrated);
+  // The output of a compaction is written as cold data.
+  RETURN_NOT_OK(DoMergeCompactionOrFlush(input, TabletMetadata::kNoMrsFlushed, {}));
+  metrics_->cold_rowset_migration_bytes->IncrementBy(bytes_migrated);
+  metrics_->cold_rowset_migration_duration->Increment(
+      (MonoTime::Now() - start_time).ToMilliseconds());
+  return Status::OK();
+}
+
 Status Tablet::DeleteAncientUndoDeltas(int64_t* blocks_deleted, int64_t* bytes_deleted) {
   RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
   MonoTime tablet_delete_start = MonoTime::Now();
@@ -3165,7 +3842,7 @@ void Tablet::PrintRSLayout(ostream* o) {
   vector<string> log;
   unordered_set<const RowSet*> picked;
   double quality;
-  Status s = compaction_policy_->PickRowSets(*rowsets_copy, &picked, &quality, &log);
+  Status s = compaction_policy()->PickRowSets(*rowsets_copy, &picked, &quality, &log);
   if (!s.ok()) {
     out << "<b>Error:</b> " << EscapeForHtmlToString(s.ToString());
     return;
@@ -3280,7 +3957,8 @@ Tablet::Iterator::Iterator(const Tablet* tablet,
     : tablet_(tablet),
       io_context_({ tablet->tablet_id() }),
       projection_(*CHECK_NOTNULL(opts.projection)),
-      opts_(std::move(opts)) {
+      opts_(std::move(opts)),
+      row_cache_row_pending_(false) {
   opts_.io_context = &io_context_;
   opts_.projection = &projection_;
 }
@@ -3293,6 +3971,12 @@ Status Tablet::Iterator::Init(ScanSpec *spec) {
 
   RETURN_NOT_OK(tablet_->GetMappedReadProjection(projection_, &projection_));
 
+  bool served = false;
+  RETURN_NOT_OK(InitFromRowCache(spec, &served));
+  if (served) {
+    return Status::OK();
+  }
+
   vector<IterWithBounds> iters;
   RETURN_NOT_OK(tablet_->CaptureConsistentIterators(opts_, spec, &iters));
   TRACE_COUNTER_INCREMENT("rowset_iterators", iters.size());
@@ -3303,7 +3987,13 @@ Status Tablet::Iterator::Init(ScanSpec *spec) {
       break;
     case UNORDERED:
     default:
-      iter_ = NewUnionIterator(std::move(iters));
+      if (opts_.scan_pool && opts_.max_parallelism > 1 && iters.size() > 1) {
+        const int parallelism = std::min<int>(opts_.max_parallelism, iters.size());
+        TRACE_COUNTER_INCREMENT("parallel_rowset_iterators", parallelism);
+        iter_ = NewParallelUnionIterator(std::move(iters), opts_.scan_pool, parallelism);
+      } else {
+        iter_ = NewUnionIterator(std::move(iters));
+      }
       break;
   }
 
@@ -3311,12 +4001,97 @@ Status Tablet::Iterator::Init(ScanSpec *spec) {
   return Status::OK();
 }
 
+Status Tablet::Iterator::InitFromRowCache(ScanSpec* spec, bool* served) {
+  shared_ptr<RowCache> rc = tablet_->row_cache();
+  // Only clean snapshots can be checked against the timestamps of the cached
+  // rows. The cache has no notion of deleted rows, nor of rows from older
+  // schemas.
+  if (!rc || spec == nullptr ||
+      !opts_.snap_to_include.is_clean() || opts_.snap_to_exclude ||
+      opts_.include_deleted_rows ||
+      projection_.first_is_deleted_virtual_column_idx() != Schema::kColumnNotFound ||
+      rc->schema().get() != tablet_->schema().get()) {
+    return Status::OK();
+  }
+  Arena arena(256);
+  if (!RowCache::IsPointLookup(*rc->schema(), *spec, &arena)) {
+    return Status::OK();
+  }
+  unique_ptr<RowProjector> projector(new RowProjector(rc->schema().get(), &projection_));
+  if (!projector->Init().ok()) {
+    // The projection was mapped with a schema older than the cache's.
+    return Status::OK();
+  }
+
+  const Slice key = spec->lower_bound_key()->encoded_key();
+  unique_ptr<RowCacheHandle> handle(new RowCacheHandle);
+  if (rc->Lookup(key, opts_.snap_to_include, handle.get())) {
+    if (tablet_->metrics_) {
+      tablet_->metrics_->row_cache_hits->Increment();
+    }
+    cached_row_ = std::move(handle);
+  } else {
+    if (tablet_->metrics_) {
+      tablet_->metrics_->row_cache_misses->Increment();
+    }
+    // Read the whole row, so that it can be cached for any projection.
+    RowIteratorOptions opts = opts_;
+    opts.projection = rc->schema().get();
+    vector<IterWithBounds> iters;
+    RETURN_NOT_OK(tablet_->CaptureConsistentIterators(opts, spec, &iters));
+    TRACE_COUNTER_INCREMENT("rowset_iterators", iters.size());
+    iter_ = NewUnionIterator(std::move(iters));
+    RETURN_NOT_OK(iter_->Init(spec));
+
+    miss_memory_.reset(new RowBlockMemory);
+    miss_block_.reset(new RowBlock(rc->schema().get(), 1, miss_memory_.get()));
+    while (iter_->HasNext()) {
+      RETURN_NOT_OK(iter_->NextBlock(miss_block_.get()));
+      if (miss_block_->nrows() > 0 && miss_block_->selection_vector()->IsRowSelected(0)) {
+        break;
+      }
+      miss_block_->Resize(0);
+    }
+    if (miss_block_->nrows() == 0) {
+      // The row doesn't exist. Absent rows aren't cached: the inserts of new
+      // rows don't go through the cache.
+      miss_block_.reset();
+    } else {
+      rc->Insert(key, opts_.snap_to_include, miss_block_->row(0));
+    }
+  }
+  row_cache_row_pending_ = cached_row_ || miss_block_;
+  row_cache_projector_ = std::move(projector);
+  row_cache_ = std::move(rc);
+  *served = true;
+  return Status::OK();
+}
+
 bool Tablet::Iterator::HasNext() const {
+  if (row_cache_) {
+    return row_cache_row_pending_;
+  }
   DCHECK(iter_.get() != nullptr) << "Not initialized!";
   return iter_->HasNext();
 }
 
 Status Tablet::Iterator::NextBlock(RowBlock *dst) {
+  if (row_cache_) {
+    DCHECK(row_cache_row_pending_);
+    DCHECK_GT(dst->row_capacity(), 0);
+    dst->Resize(1);
+    dst->selection_vector()->SetAllTrue();
+    RowBlockRow dst_row = dst->row(0);
+    if (cached_row_) {
+      RETURN_NOT_OK(row_cache_projector_->ProjectRowForRead(
+          cached_row_->row(), &dst_row, dst->arena()));
+    } else {
+      RETURN_NOT_OK(row_cache_projector_->ProjectRowForRead(
+          miss_block_->row(0), &dst_row, dst->arena()));
+    }
+    row_cache_row_pending_ = false;
+    return Status::OK();
+  }
   DCHECK(iter_.get() != nullptr) << "Not initialized!";
   return iter_->NextBlock(dst);
 }
@@ -3324,7 +4099,9 @@ Status Tablet::Iterator::NextBlock(RowBlock *dst) {
 string Tablet::Iterator::ToString() const {
   string s;
   s.append("tablet iterator: ");
-  if (iter_.get() == nullptr) {
+  if (row_cache_ && !iter_) {
+    s.append("row cache hit");
+  } else if (iter_.get() == nullptr) {
     s.append("NULL");
   } else {
     s.append(iter_->ToString());
@@ -3337,7 +4114,26 @@ const Schema& Tablet::Iterator::schema() const {
 }
 
 void Tablet::Iterator::GetIteratorStats(vector<IteratorStats>* stats) const {
-  iter_->GetIteratorStats(stats);
+  if (!row_cache_) {
+    iter_->GetIteratorStats(stats);
+    return;
+  }
+  // 'iter_', if any, reads with the schema of the row cache: map its stats
+  // to the columns of the projection.
+  stats->clear();
+  stats->resize(projection_.num_columns());
+  if (!iter_) {
+    return;
+  }
+  vector<IteratorStats> iter_stats;
+  iter_->GetIteratorStats(&iter_stats);
+  const Schema& rc_schema = *row_cache_->schema();
+  for (size_t i = 0; i < projection_.num_columns(); i++) {
+    const int idx = rc_schema.find_column_by_id(projection_.column_id(i));
+    if (idx != Schema::kColumnNotFound) {
+      (*stats)[i] = iter_stats[idx];
+    }
+  }
 }
 
 } // namespace tablet
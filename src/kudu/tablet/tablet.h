@@ -64,11 +64,13 @@ class EncodedKey;
 class KeyRange;
 class MemTracker;
 class RowBlock;
+class RowProjector;
 class ScanSpec;
 class Throttler;
 class Timestamp;
 struct IterWithBounds;
 struct IteratorStats;
+struct RowBlockMemory;
 
 namespace consensus {
 class OpId;
@@ -89,10 +91,14 @@ class TabletServerTest_SetEncodedKeysWhenStartingUp_Test;
 namespace tablet {
 
 class AlterSchemaOpState;
+class ColumnStatsPB;
 class CompactionPolicy;
 class HistoryGcOpts;
 class MemRowSet;
 class ParticipantOpState;
+class RollingDiskRowSetWriter;
+class RowCache;
+class RowCacheHandle;
 class RowSetTree;
 class RowSetsInCompaction;
 class TxnMetadata;
@@ -166,6 +172,14 @@ class Tablet {
   Status DecodeWriteOperations(const Schema* client_schema,
                                WriteOpState* op_state);
 
+  // Decode the Write operations of a user's request against the current
+  // schema of the tablet, without taking the schema lock, so that this may
+  // happen before the op is prepared. DecodeWriteOperations() then uses the
+  // decoded operations unless the schema changed in the meantime. Does
+  // nothing on error, leaving DecodeWriteOperations() to report it.
+  void PredecodeWriteOperations(const Schema* client_schema,
+                                WriteOpState* op_state);
+
   // Acquire locks for each of the operations in the given write op.
   // This also sets the row op's RowSetKeyProbe.
   Status AcquireRowLocks(WriteOpState* op_state);
@@ -314,6 +328,22 @@ class Tablet {
   // This method takes a read lock on component_lock_ and is thread-safe.
   bool MemRowSetEmpty() const;
 
+  // Returns the number of MRSs of committed transactions, waiting to be
+  // flushed along with the main MRS.
+  // This method takes a read lock on component_lock_ and is thread-safe.
+  size_t num_committed_txn_memrowsets() const;
+
+  // Returns the number of mutations appended to the rows of the MRS since they
+  // were last folded into the rows by CompactMemRowSetMutations().
+  // This method takes a read lock on component_lock_ and is thread-safe.
+  int64_t MemRowSetMutationsToCompact() const;
+
+  // Folds the mutations of the MRS rows which no scan may need to skip, i.e.
+  // which are older than the ancient history mark, the clean time and the
+  // snapshots of the scans open on the MRS, into the rows themselves. Does
+  // nothing if the MRS is being flushed, or if history isn't garbage collected.
+  Status CompactMemRowSetMutations();
+
   // Returns the size in bytes of WALs that would need to be replayed to restore
   // the current MRS.
   size_t MemRowSetLogReplaySize(const ReplaySizeMap& replay_size_map) const;
@@ -326,18 +356,26 @@ class Tablet {
   // Excludes all metadata (both tablet metadata and the metadata of this tablet's rowsets).
   size_t OnDiskDataSize() const;
 
+  // Returns the data directories holding this tablet's data, or none if they
+  // can't be found, e.g. if the tablet failed.
+  std::vector<std::string> DataDirs() const;
+
   // Get the total size of all the DMS
   size_t DeltaMemStoresSize() const;
 
   // Same as MemRowSetEmpty(), but for the DMS.
   bool DeltaMemRowSetEmpty() const;
 
-  // Flushes the DMS with the highest retention.
+  // Flushes the DMS with the highest retention, or the DMSs with the highest
+  // retention in parallel if --tablet_delta_maintenance_parallel_rowsets > 1.
   Status FlushBestDMS(const ReplaySizeMap &replay_size_map) const;
 
   // Flush only the biggest DMS. Only used for tests.
   Status FlushBiggestDMSForTests();
 
+  // Flush all delta memstores.
+  Status FlushAllDMS();
+
   // Flush all delta memstores. Only used for tests.
   Status FlushAllDMSForTests();
 
@@ -346,7 +384,8 @@ class Tablet {
   Status MajorCompactAllDeltaStoresForTests();
 
   // Finds the RowSet which has the most separate delta files and
-  // issues a delta compaction.
+  // issues a delta compaction. Minor delta compactions compact the worst
+  // RowSets in parallel if --tablet_delta_maintenance_parallel_rowsets > 1.
   Status CompactWorstDeltas(RowSet::DeltaCompactionType type);
 
   // Get the highest performance improvement that would come from compacting the delta stores
@@ -398,6 +437,17 @@ class Tablet {
   // state is change.
   Status DeleteAncientDeletedRowsets();
 
+  // Returns the number of bytes in rowsets which weren't written as cold data,
+  // and whose data is all older than --tablet_cold_rowset_age_days (see
+  // RowSet::IsFullyOlderThan()). These are the flushed rowsets of data which
+  // no later compaction rewrote.
+  Status GetBytesInColdRowSetCandidates(int64_t* bytes);
+
+  // Rewrites the rowsets counted by GetBytesInColdRowSetCandidates() as cold
+  // data, up to --tablet_compaction_budget_mb of them per call, so that their
+  // blocks move away from the data directories on fast media.
+  Status MigrateColdRowSets();
+
   // Counts the number of deltas in the tablet. Only used for tests.
   int64_t CountUndoDeltasForTests() const;
   int64_t CountRedoDeltasForTests() const;
@@ -413,6 +463,13 @@ class Tablet {
   // Count the number of live rows in this tablet.
   Status CountLiveRows(uint64_t* count) const;
 
+  // Merges the statistics of the columns of the DiskRowSets of the tablet
+  // into 'stats', one per column of the current schema whose statistics were
+  // computed for every DiskRowSet. The rows in the MemRowSets, and the
+  // updates and deletes since the DiskRowSets were written, aren't accounted
+  // for: the statistics are approximate.
+  Status GetColumnStats(std::vector<ColumnStatsPB>* stats) const;
+
   // Verbosely dump this entire tablet to the logs. This is only
   // really useful when debugging unit tests failures where the tablet
   // has a very small number of rows.
@@ -462,6 +519,17 @@ class Tablet {
   // Otherwise, returns false.
   bool GetTabletAncientHistoryMark(Timestamp* ancient_history_mark) const WARN_UNUSED_RESULT;
 
+  // Returns true iff the rows of the tablet expire, per the row TTL of its
+  // table, setting the id of the column holding the row times in
+  // 'ttl_col_id', and the time before which the rows expired in
+  // 'expired_before_micros'. As for history GC, requires a HybridClock.
+  bool GetRowExpiry(ColumnId* ttl_col_id, int64_t* expired_before_micros) const WARN_UNUSED_RESULT;
+
+  // Returns true iff the migration of aged rowsets to cold data is enabled
+  // (see --tablet_cold_rowset_age_days), setting the timestamp before which
+  // data is aged in 'cutoff'. As for history GC, requires a HybridClock.
+  bool GetColdRowSetCutoff(Timestamp* cutoff) const WARN_UNUSED_RESULT;
+
   // Calculates history GC options based on properties of the Clock implementation.
   HistoryGcOpts GetHistoryGcOpts() const;
 
@@ -514,6 +582,10 @@ class Tablet {
   // otherwise return 'false'.
   bool compaction_enabled() const;
 
+  // Return the compaction policy configured for the tablet's table, or by
+  // --tablet_compaction_policy if the table doesn't set one.
+  CompactionPolicy* compaction_policy() const;
+
   // Return the default bloom filter sizing parameters, configured by server flags.
   static BloomFilterSizing DefaultBloomSizing();
 
@@ -528,6 +600,11 @@ class Tablet {
                      uint64 target_chunk_size,
                      std::vector<KeyRange>* ranges);
 
+  // Returns an encoded primary key splitting the data of the tablet, of about
+  // 'size_bytes' bytes, in two parts of about the same size, or an empty
+  // string if there is no such key, e.g. if the tablet has no data.
+  std::string FindSplitKey(uint64_t size_bytes);
+
   // Update the last read operation timestamp.
   void UpdateLastReadTime();
 
@@ -564,6 +641,8 @@ class Tablet {
   FRIEND_TEST(TestTabletStringKey, TestSplitKeyRangeWithOneRowSet);
   FRIEND_TEST(TestTabletStringKey, TestSplitKeyRangeWithNonOverlappingRowSets);
   FRIEND_TEST(TestTabletStringKey, TestSplitKeyRangeWithMinimumValueRowSet);
+  FRIEND_TEST(TestTabletStringKey, TestSplitKeyRangeWithKeySamples);
+  FRIEND_TEST(TestTabletStringKey, TestFindSplitKey);
   FRIEND_TEST(TxnParticipantTest, TestFlushMultipleMRSs);
   FRIEND_TEST(tserver::TabletServerTest, SetEncodedKeysWhenStartingUp);
 
@@ -615,6 +694,16 @@ class Tablet {
   // Sets *cur_state to the current state, which may be useful for later assertions.
   Status CheckHasNotBeenStopped(State* cur_state = nullptr) const;
 
+  // Returns the RowSets whose DMSs a flush of multiple DMSs flushes: up to
+  // --tablet_delta_maintenance_parallel_rowsets of them, in the order of the
+  // scores of FindBestDMSToFlush(), within --tablet_delta_maintenance_budget_mb.
+  RowSetVector FindBestDMSsToFlush(const ReplaySizeMap& replay_size_map) const;
+
+  // Same as above, but for the RowSets whose REDO delta stores a minor delta
+  // compaction of multiple RowSets compacts. The caller must hold
+  // 'compact_select_lock_'.
+  RowSetVector FindWorstDeltasToMinorCompactUnlocked() const;
+
   Status FlushUnlocked();
 
   // Validate the contents of 'op' and return a bad Status if it is invalid.
@@ -686,6 +775,20 @@ class Tablet {
                                   int64_t mrs_being_flushed,
                                   const std::vector<TxnInfoBeingFlushed>& txns_being_flushed);
 
+  // Phase 1 of DoMergeCompactionOrFlush(): writes the rows of 'input' as of
+  // 'snap' into new rowsets. Compactions of large enough inputs are split
+  // into key ranges written in parallel, one writer per range, in key order.
+  // Sets 'peak_mem_usage' to the memory used by the compaction inputs.
+  Status WriteCompactionOrFlushOutput(
+      const RowSetsInCompaction& input,
+      bool is_flush,
+      const MvccSnapshot& snap,
+      const HistoryGcOpts& history_gc_opts,
+      const Schema* schema,
+      const fs::IOContext* io_context,
+      std::vector<std::unique_ptr<RollingDiskRowSetWriter>>* writers,
+      size_t* peak_mem_usage);
+
   // Handle the case in which a compaction or flush yielded no output rows.
   // In this case, we just need to remove the rowsets in 'rowsets' from the
   // metadata and flush it.
@@ -727,6 +830,16 @@ class Tablet {
     *comps = components_;
   }
 
+  // Returns the row cache of the tablet, or nullptr if it's disabled.
+  std::shared_ptr<RowCache> row_cache() const {
+    shared_lock<rw_spinlock> l(component_lock_);
+    return row_cache_;
+  }
+
+  // Replaces the row cache of the tablet, if enabled, with an empty one for
+  // the current schema.
+  void ResetRowCache();
+
   // Create a new MemRowSet, replacing the current committed one(s).
   // 'old_mrss' will be populated to the current committed MemRowSet(s) set
   // before the replacement. If any MemRowSet is not empty it will be added to
@@ -799,6 +912,10 @@ class Tablet {
   // should always be read or swapped under the component_lock.
   scoped_refptr<TabletComponents> components_;
 
+  // Caches the rows of hot primary keys. Like 'components_', read or swapped
+  // under the component_lock.
+  std::shared_ptr<RowCache> row_cache_;
+
   // Uncommitted transaction state.
   std::unordered_map<int64_t, scoped_refptr<TxnRowSets>> uncommitted_rowsets_by_txn_id_;
 
@@ -830,7 +947,9 @@ class Tablet {
   // The same goes for locks and the LockManager.
   TxnParticipant txn_participant_;
 
-  std::unique_ptr<CompactionPolicy> compaction_policy_;
+  // The policies selecting the rowsets to compact: see compaction_policy().
+  std::unique_ptr<CompactionPolicy> budgeted_compaction_policy_;
+  std::unique_ptr<CompactionPolicy> size_tiered_compaction_policy_;
 
   // Lock protecting the selection of rowsets for compaction.
   // Only one thread may run the compaction selection algorithm at a time
@@ -941,11 +1060,30 @@ class Tablet::Iterator : public RowwiseIterator {
   Iterator(const Tablet* tablet,
            RowIteratorOptions opts);
 
+  // Serves the scan with the tablet's row cache if it's a point lookup which
+  // the cache can serve, setting 'served' if so.
+  Status InitFromRowCache(ScanSpec* spec, bool* served);
+
   const Tablet* tablet_;
   fs::IOContext io_context_;
   Schema projection_;
   RowIteratorOptions opts_;
   std::unique_ptr<RowwiseIterator> iter_;
+
+  // Set if the scan is served by the row cache. When missing the cache,
+  // 'iter_' reads the row with the schema of the cache.
+  std::shared_ptr<RowCache> row_cache_;
+  std::unique_ptr<RowProjector> row_cache_projector_;
+
+  // The row found in the cache, if any.
+  std::unique_ptr<RowCacheHandle> cached_row_;
+
+  // The row read by 'iter_' on a cache miss, if it exists.
+  std::unique_ptr<RowBlockMemory> miss_memory_;
+  std::unique_ptr<RowBlock> miss_block_;
+
+  // Whether the row served from the row cache is yet to be returned.
+  bool row_cache_row_pending_;
 };
 
 // Structure which represents the components of the tablet's storage.
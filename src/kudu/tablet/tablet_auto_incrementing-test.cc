@@ -26,10 +26,15 @@
 #include "kudu/common/common.pb.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/partial_row.h"
+#include "kudu/common/row_operations.pb.h"
 #include "kudu/common/schema.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/local_tablet_writer.h"
 #include "kudu/tablet/tablet-test-util.h"
+#include "kudu/tablet/tablet.h"
+#include "kudu/tablet/tablet_metrics.h"
+#include "kudu/util/metrics.h"
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 
@@ -47,6 +52,15 @@ Schema CreateAutoIncrementingTestSchema() {
                               /*is_auto_incrementing*/ true, nullptr, nullptr, {}, {}, ""),
                  ColumnSchema("val", INT32, true) }, 1);
 }
+
+// A schema with a non-unique primary key made of 'key' and the
+// auto-incrementing column.
+Schema CreateNonUniqueKeyTestSchema() {
+  return Schema({ColumnSchema("key", INT32),
+                 ColumnSchema(Schema::GetAutoIncrementingColumnName(), INT64, false, false,
+                              /*is_auto_incrementing*/ true, nullptr, nullptr, {}, {}, ""),
+                 ColumnSchema("val", INT32, true) }, 2);
+}
 } // anonymous namespace
 
 // Creates a table with single tablet with an auto incrementing column
@@ -64,6 +78,19 @@ class AutoIncrementingTabletTest : public KuduTabletTest {
   unique_ptr<LocalTabletWriter> writer_;
 };
 
+class NonUniqueKeyTabletTest : public KuduTabletTest {
+ public:
+  NonUniqueKeyTabletTest()
+      : KuduTabletTest(CreateNonUniqueKeyTestSchema()) {}
+
+  void SetUp() override {
+    KuduTabletTest::SetUp();
+    writer_.reset(new LocalTabletWriter(tablet().get(), &client_schema_));
+  }
+ protected:
+  unique_ptr<LocalTabletWriter> writer_;
+};
+
 TEST_F(AutoIncrementingTabletTest, TestInsertOp) {
   // Insert rows into the tablet populating only non auto-incrementing columns.
   for (int i = 0; i < 10; i++) {
@@ -233,5 +260,36 @@ TEST_F(AutoIncrementingTabletTest, TestNegatives) {
   }
 }
 
+// Inserts into a table with a non-unique primary key don't look up the keys
+// of the new rows in the disk rowsets, even if the rowsets cover them.
+TEST_F(NonUniqueKeyTabletTest, TestInsertsSkipPresenceChecks) {
+  const auto insert_rows = [&] {
+    vector<LocalTabletWriter::RowOp> ops;
+    vector<unique_ptr<KuduPartialRow>> rows;
+    for (int i = 0; i < 10; i++) {
+      rows.emplace_back(new KuduPartialRow(&client_schema_));
+      RETURN_NOT_OK(rows.back()->SetInt32("key", i));
+      RETURN_NOT_OK(rows.back()->SetInt32("val", 1337));
+      ops.emplace_back(RowOperationsPB::INSERT, rows.back().get());
+    }
+    return writer_->WriteBatch(ops);
+  };
+  ASSERT_OK(insert_rows());
+  ASSERT_OK(tablet()->Flush());
+
+  // The keys of the new rows are within the bounds of the flushed rowset.
+  const auto& bloom_lookups = tablet()->metrics()->bloom_lookups;
+  const auto lookups_before = bloom_lookups->value();
+  ASSERT_OK(insert_rows());
+  ASSERT_EQ(lookups_before, bloom_lookups->value());
+
+  unique_ptr<RowwiseIterator> iter;
+  ASSERT_OK(tablet()->NewRowIterator(schema_.CopyWithoutColumnIds(), &iter));
+  ASSERT_OK(iter->Init(nullptr));
+  vector<string> out;
+  IterateToStringList(iter.get(), &out);
+  ASSERT_EQ(20, out.size());
+}
+
 } // namespace tablet
 } // namespace kudu
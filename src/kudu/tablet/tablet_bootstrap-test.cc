@@ -240,6 +240,27 @@ TEST_F(BootstrapTest, TestBootstrap) {
   ASSERT_EQ(1, results.size());
 }
 
+// Tests a bootstrap replaying several log segments, which are read ahead of
+// their replay.
+TEST_F(BootstrapTest, TestBootstrapMultipleSegments) {
+  constexpr int kNumSegments = 5;
+  constexpr int kEntriesPerSegment = 10;
+  ASSERT_OK(BuildLog());
+  for (int i = 0; i < kNumSegments; i++) {
+    ASSERT_OK(AppendReplicateBatchAndCommitEntryPairsToLog(kEntriesPerSegment));
+    ASSERT_OK(RollLog());
+  }
+
+  shared_ptr<Tablet> tablet;
+  ConsensusBootstrapInfo boot_info;
+  ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+  ASSERT_EQ(kNumSegments * kEntriesPerSegment, boot_info.last_committed_id.index());
+
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(kNumSegments * kEntriesPerSegment, results.size());
+}
+
 // Test that we don't overflow opids. Regression test for KUDU-1933.
 TEST_F(BootstrapTest, TestBootstrapHighOpIdIndex) {
   // Start appending with a log index 3 under the int32 max value.
@@ -95,6 +95,7 @@
 #include "kudu/util/pb_util.h"
 #include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/thread.h"
 
 DECLARE_bool(prevent_kudu_2233_corruption);
 DECLARE_int32(group_commit_queue_size_bytes);
@@ -105,6 +106,13 @@ DEFINE_double(fault_crash_during_log_replay, 0.0,
               "(For testing only!)");
 TAG_FLAG(fault_crash_during_log_replay, unsafe);
 
+DEFINE_bool(tablet_bootstrap_prefetch_log_segments, true,
+            "Whether tablet bootstrap reads and decodes the entries of the next log "
+            "segment in a separate thread while replaying the current one. This "
+            "keeps the decoded entries of up to two log segments in memory.");
+TAG_FLAG(tablet_bootstrap_prefetch_log_segments, advanced);
+TAG_FLAG(tablet_bootstrap_prefetch_log_segments, runtime);
+
 DECLARE_int32(max_clock_sync_error_usec);
 
 using kudu::clock::Clock;
@@ -1215,6 +1223,32 @@ void TabletBootstrap::DumpReplayStateToLog(const ReplayState& state) {
   }
 }
 
+namespace {
+
+// The entries of a log segment, read ahead of their replay.
+struct SegmentEntries {
+  std::vector<unique_ptr<LogEntryPB>> entries;
+
+  // The status of reading the entry following the last one of 'entries':
+  // EndOfFile if the whole segment was read.
+  Status status;
+};
+
+void ReadSegmentEntries(const ReadableLogSegment* segment, SegmentEntries* out) {
+  log::LogEntryReader reader(segment);
+  while (true) {
+    unique_ptr<LogEntryPB> entry;
+    Status s = reader.ReadNextEntry(&entry);
+    if (!s.ok()) {
+      out->status = std::move(s);
+      return;
+    }
+    out->entries.emplace_back(std::move(entry));
+  }
+}
+
+} // anonymous namespace
+
 Status TabletBootstrap::PlaySegments(const IOContext* io_context,
                                      ConsensusBootstrapInfo* consensus_info) {
   ReplayState state;
@@ -1244,14 +1278,57 @@ Status TabletBootstrap::PlaySegments(const IOContext* io_context,
   const auto kStatusUpdateInterval = MonoDelta::FromSeconds(5);
   int segment_count = 0;
 
-  for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
+  // Reading and decoding the entries of the segments is pipelined with their
+  // replay: while a segment is replayed, the entries of the next one are read
+  // by 'prefetch_thread' into 'next_entries'.
+  const bool prefetch = FLAGS_tablet_bootstrap_prefetch_log_segments;
+  SegmentEntries cur_entries;
+  SegmentEntries next_entries;
+  scoped_refptr<Thread> prefetch_thread;
+  SCOPED_CLEANUP({
+    if (prefetch_thread) {
+      prefetch_thread->Join();
+    }
+  });
+  if (prefetch && !segments.empty()) {
+    ReadSegmentEntries(segments[0].get(), &next_entries);
+  }
+
+  for (int i = 0; i < segments.size(); i++) {
+    const scoped_refptr<ReadableLogSegment>& segment = segments[i];
     log::LogEntryReader reader(segment.get());
+    if (prefetch) {
+      if (prefetch_thread) {
+        prefetch_thread->Join();
+        prefetch_thread.reset();
+      }
+      cur_entries = std::move(next_entries);
+      next_entries = SegmentEntries();
+      if (i + 1 < segments.size()) {
+        const ReadableLogSegment* next_segment = segments[i + 1].get();
+        SegmentEntries* next = &next_entries;
+        RETURN_NOT_OK(Thread::Create("tablet", "bootstrap-log-prefetch",
+                                     [next_segment, next]() {
+                                       ReadSegmentEntries(next_segment, next);
+                                     },
+                                     &prefetch_thread));
+      }
+    }
 
     int entry_count = 0;
     while (true) {
       {
         unique_ptr<LogEntryPB> entry;
-        Status s = reader.ReadNextEntry(&entry);
+        Status s;
+        if (prefetch) {
+          if (entry_count < cur_entries.entries.size()) {
+            entry = std::move(cur_entries.entries[entry_count]);
+          } else {
+            s = cur_entries.status;
+          }
+        } else {
+          s = reader.ReadNextEntry(&entry);
+        }
         if (PREDICT_FALSE(!s.ok())) {
           if (s.IsEndOfFile()) {
             break;
@@ -1280,12 +1357,14 @@ Status TabletBootstrap::PlaySegments(const IOContext* io_context,
 
       const auto now = MonoTime::Now();
       if (now - last_status_update > kStatusUpdateInterval) {
+        const string progress = prefetch ?
+            Substitute("$0/$1 entries", entry_count, cur_entries.entries.size()) :
+            Substitute("$0/$1", HumanReadableNumBytes::ToString(reader.offset()),
+                       HumanReadableNumBytes::ToString(reader.read_up_to_offset()));
         SetStatusMessage(Substitute("Bootstrap replaying log segment $0/$1 "
-                                    "($2/$3 this segment, stats: $4)",
+                                    "($2 this segment, stats: $3)",
                                     segment_count + 1, log_reader_->num_segments(),
-                                    HumanReadableNumBytes::ToString(reader.offset()),
-                                    HumanReadableNumBytes::ToString(reader.read_up_to_offset()),
-                                    stats_.ToString()));
+                                    progress, stats_.ToString()));
         last_status_update = now;
       }
     }
@@ -34,6 +34,7 @@
 #include "kudu/clock/hybrid_clock.h"
 #include "kudu/clock/mock_ntp.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/iterator.h"
 #include "kudu/common/partial_row.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
@@ -61,10 +62,12 @@ DECLARE_bool(enable_maintenance_manager);
 DECLARE_int32(tablet_history_max_age_sec);
 DECLARE_string(time_source);
 DECLARE_bool(enable_gc_deleted_rowsets_without_live_row_count);
+DECLARE_int32(tablet_cold_rowset_age_days);
 
 using kudu::clock::HybridClock;
 using std::nullopt;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
 
@@ -689,6 +692,53 @@ TEST_F(TabletHistoryGcNoMaintMgrTest, TestUndoDeltaBlockGc) {
   ASSERT_EQ(1, tablet()->metrics()->undo_delta_block_gc_delete_duration->TotalCount());
 }
 
+// Test that the rowsets whose data aged past --tablet_cold_rowset_age_days are
+// rewritten as cold data, and only those.
+TEST_F(TabletHistoryGcNoMaintMgrTest, TestMigrateColdRowSets) {
+  FLAGS_tablet_cold_rowset_age_days = 1;
+  NO_FATALS(InsertOriginalRows(kNumRowsets, rows_per_rowset_));
+  vector<std::shared_ptr<RowSet>> rowsets;
+  tablet()->GetRowSetsForTests(&rowsets);
+  ASSERT_EQ(kNumRowsets, rowsets.size());
+  for (const auto& rs : rowsets) {
+    ASSERT_FALSE(rs->metadata()->cold());
+    ASSERT_TRUE(rs->metadata()->newest_base_timestamp());
+  }
+
+  // Nothing is old enough yet.
+  int64_t bytes = 0;
+  ASSERT_OK(tablet()->GetBytesInColdRowSetCandidates(&bytes));
+  ASSERT_EQ(0, bytes);
+
+  // Move the clock past the age of cold data, and update the rows of the first
+  // rowset, so it's the only one with recent data.
+  NO_FATALS(AddTimeToHybridClock(MonoDelta::FromSeconds(24 * 60 * 60 + 1)));
+  UpsertTestRows(kStartRow, rows_per_rowset_, /*val*/1);
+  ASSERT_OK(tablet()->FlushAllDMSForTests());
+  ASSERT_OK(tablet()->GetBytesInColdRowSetCandidates(&bytes));
+  ASSERT_GT(bytes, 0);
+
+  ASSERT_OK(tablet()->MigrateColdRowSets());
+  const auto* metrics = tablet()->metrics();
+  ASSERT_EQ(bytes, metrics->cold_rowset_migration_bytes->value());
+  ASSERT_EQ(1, metrics->cold_rowset_migration_duration->TotalCount());
+
+  // The two aged rowsets were rewritten into a single cold rowset.
+  rowsets.clear();
+  tablet()->GetRowSetsForTests(&rowsets);
+  ASSERT_EQ(2, rowsets.size());
+  int num_cold = 0;
+  for (const auto& rs : rowsets) {
+    num_cold += rs->metadata()->cold() ? 1 : 0;
+  }
+  ASSERT_EQ(1, num_cold);
+  ASSERT_OK(tablet()->GetBytesInColdRowSetCandidates(&bytes));
+  ASSERT_EQ(0, bytes);
+  const int64_t rows_per_rowset = rows_per_rowset_;
+  NO_FATALS(VerifyTestRowsWithVerifier(kStartRow, TotalNumRows(),
+      [=](int32_t key, int32_t val) { return val == (key < rows_per_rowset ? 1 : 0); }));
+}
+
 class TabletDeletedRowsetGcTest : public TabletHistoryGcNoMaintMgrTest,
                                   public ::testing::WithParamInterface<bool> {
 public:
@@ -787,5 +837,74 @@ TEST_P(TabletDeletedRowsetGcTest, TestGCDeletedRowsetsAfterMajorCompaction) {
   NO_FATALS(TryRunningDeletedRowsetGC());
 }
 
+class TabletRowTtlTest : public KuduTabletTest {
+ public:
+  TabletRowTtlTest()
+      : KuduTabletTest(Schema({ ColumnSchema("key", INT64),
+                                ColumnSchema("ts", UNIXTIME_MICROS) }, 1),
+                       TabletHarness::Options::HYBRID_CLOCK) {
+    FLAGS_time_source = "mock";
+  }
+
+  void SetUp() override {
+    NO_FATALS(KuduTabletTest::SetUp());
+    auto* hybrid_clock = down_cast<HybridClock*>(clock());
+    auto* ntp = down_cast<clock::MockNtp*>(hybrid_clock->time_service());
+    now_micros_ = GetCurrentTimeMicros();
+    ntp->SetMockClockWallTimeForTests(now_micros_);
+  }
+
+ protected:
+  // Inserts the rows of keys [first_key, first_key + num_rows), every other
+  // one of which is two hours old.
+  void InsertRows(int64_t first_key, int64_t num_rows) {
+    LocalTabletWriter writer(tablet().get(), &client_schema_);
+    KuduPartialRow row(&client_schema_);
+    for (int64_t key = first_key; key < first_key + num_rows; key++) {
+      ASSERT_OK(row.SetInt64(0, key));
+      const int64_t age_micros = key % 2 == 0 ? 2 * 3600 * 1000000LL : 0;
+      ASSERT_OK(row.SetUnixTimeMicros(1, now_micros_ - age_micros));
+      ASSERT_OK(writer.Insert(row));
+    }
+  }
+
+  int64_t now_micros_;
+};
+
+// Rows past the TTL of the table are dropped by flushes and compactions.
+TEST_F(TabletRowTtlTest, TestExpiredRowsDropped) {
+  // Rows flushed before the table has a TTL are kept.
+  NO_FATALS(InsertRows(0, 10));
+  ASSERT_OK(tablet()->Flush());
+  uint64_t count;
+  ASSERT_OK(tablet()->CountRows(&count));
+  ASSERT_EQ(10, count);
+
+  TableExtraConfigPB extra_config;
+  extra_config.set_row_ttl_column("ts");
+  extra_config.set_row_ttl_sec(3600);
+  tablet()->metadata()->SetExtraConfig(std::move(extra_config));
+
+  // The expired rows of the MRS are dropped when it's flushed.
+  NO_FATALS(InsertRows(10, 10));
+  ASSERT_OK(tablet()->Flush());
+  ASSERT_OK(tablet()->CountRows(&count));
+  ASSERT_EQ(15, count);
+
+  // The compaction drops the remaining expired rows.
+  ASSERT_OK(tablet()->Compact(Tablet::FORCE_COMPACT_ALL));
+  ASSERT_OK(tablet()->CountRows(&count));
+  ASSERT_EQ(10, count);
+  unique_ptr<RowwiseIterator> iter;
+  ASSERT_OK(tablet()->NewRowIterator(client_schema_, &iter));
+  ASSERT_OK(iter->Init(nullptr));
+  vector<string> rows;
+  ASSERT_OK(IterateToStringList(iter.get(), &rows));
+  ASSERT_EQ(10, rows.size());
+  for (const auto& row : rows) {
+    ASSERT_STR_NOT_CONTAINS(row, "key=0,");
+  }
+}
+
 } // namespace tablet
 } // namespace kudu
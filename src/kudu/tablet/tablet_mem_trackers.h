@@ -19,6 +19,8 @@
 #include <memory>
 #include <string>
 
+#include "kudu/cfile/block_cache.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/mem_tracker.h"
 
@@ -52,6 +54,11 @@ struct TabletMemTrackers {
   std::shared_ptr<MemTracker> bloomfile_tracker;
   std::shared_ptr<MemTracker> cfile_reader_tracker;
   std::shared_ptr<MemTracker> dms_tracker;
+
+  // The attribution of the block cache usage of the tablet's files, if any.
+  // The block cache has a memory tracker of its own, so this isn't a tracker:
+  // the bytes of the tablet's cached blocks are only reported as a metric.
+  scoped_refptr<cfile::BlockCacheAttribution> block_cache_attribution;
 };
 
 } // namespace tablet
@@ -39,6 +39,7 @@
 #include "kudu/common/wire_protocol-test-util.h"
 #include "kudu/consensus/log_anchor_registry.h"
 #include "kudu/fs/block_id.h"
+#include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/tablet/local_tablet_writer.h"
@@ -47,6 +48,7 @@
 #include "kudu/tablet/tablet-harness.h"
 #include "kudu/tablet/tablet-test-util.h"
 #include "kudu/tablet/txn_metadata.h"
+#include "kudu/util/env.h"
 #include "kudu/util/pb_util.h"
 #include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
@@ -55,10 +57,14 @@
 DEFINE_int64(test_row_set_count, 1000, "");
 DEFINE_int64(test_block_count_per_rs, 1000, "");
 
+DECLARE_int32(tablet_metadata_max_edits);
+
 using kudu::log::LogAnchorRegistry;
 using kudu::log::MinLogIndexAnchorer;
 using std::map;
+using std::optional;
 using std::shared_ptr;
+using std::string;
 using std::unique_ptr;
 using std::unordered_set;
 
@@ -204,6 +210,105 @@ TEST_F(TestTabletMetadata, TestOnDiskSize) {
   ASSERT_GE(final_size, superblock_pb.ByteSizeLong());
 }
 
+// Test that the flushes of the metadata append edits to the superblock, and
+// that loading the superblock applies them.
+TEST_F(TestTabletMetadata, TestSuperBlockEdits) {
+  constexpr int kMaxEdits = 4;
+  FLAGS_tablet_metadata_max_edits = kMaxEdits;
+  TabletMetadata* meta = harness_->tablet()->metadata();
+  const string path = harness_->fs_manager()->GetTabletMetadataPath(meta->tablet_id());
+  Env* env = harness_->fs_manager()->GetEnv();
+
+  // Checks that the persisted superblock has the in-memory rowsets, and that
+  // it has 'expected_edits' edits.
+  const auto check_superblock = [&] (optional<int> expected_edits) {
+    TabletSuperBlockPB expected;
+    ASSERT_OK(meta->ToSuperBlock(&expected));
+    TabletSuperBlockPB persisted;
+    optional<int> num_edits;
+    ASSERT_OK(TabletMetadata::ReadSuperBlockFromPath(env, path, &persisted, &num_edits));
+    ASSERT_EQ(expected_edits, num_edits);
+    ASSERT_FALSE(persisted.is_edit());
+    ASSERT_EQ(0, persisted.removed_rowset_ids_size());
+    ASSERT_EQ(expected.last_durable_mrs_id(), persisted.last_durable_mrs_id());
+    ASSERT_EQ(expected.rowsets_size(), persisted.rowsets_size());
+    for (int i = 0; i < expected.rowsets_size(); i++) {
+      ASSERT_EQ(expected.rowsets(i).SerializeAsString(),
+                persisted.rowsets(i).SerializeAsString())
+          << pb_util::SecureDebugString(expected.rowsets(i))
+          << pb_util::SecureDebugString(persisted.rowsets(i));
+    }
+  };
+
+  // Adds a rowset with a block for each column.
+  int64_t next_block_id = 1000000;
+  const auto add_rowset = [&] (const RowSetMetadataIds& to_remove) {
+    shared_ptr<RowSetMetadata> rowset;
+    ASSERT_OK(meta->CreateRowSet(&rowset));
+    map<ColumnId, BlockId> block_by_column;
+    for (int i = 0; i < 3; i++) {
+      block_by_column[ColumnId(i)] = BlockId(next_block_id++);
+    }
+    rowset->SetColumnDataBlocks(block_by_column);
+    ASSERT_OK(meta->UpdateAndFlush(to_remove, { rowset }, TabletMetadata::kNoMrsFlushed));
+  };
+
+  // The tablet metadata was written in full on creation: the flushes adding
+  // rowsets append edits.
+  for (int i = 0; i < 3; i++) {
+    NO_FATALS(add_rowset({}));
+  }
+  NO_FATALS(check_superblock(3));
+
+  // So do those removing rowsets.
+  NO_FATALS(add_rowset({ meta->rowsets()[0]->id() }));
+  NO_FATALS(check_superblock(kMaxEdits));
+
+  // Once the maximum number of edits is reached, the next flush writes the
+  // superblock in full.
+  meta->rowsets()[1]->CommitUndoDeltaDataBlock(BlockId(next_block_id++));
+  ASSERT_OK(meta->Flush());
+  NO_FATALS(check_superblock(0));
+
+  // The edit of a flush only has the rowsets which changed.
+  uint64_t size_before;
+  ASSERT_OK(env->GetFileSize(path, &size_before));
+  meta->rowsets()[1]->CommitUndoDeltaDataBlock(BlockId(next_block_id++));
+  ASSERT_OK(meta->Flush());
+  NO_FATALS(check_superblock(1));
+  uint64_t size_after;
+  ASSERT_OK(env->GetFileSize(path, &size_after));
+  ASSERT_LT(size_after - size_before, size_before);
+
+  // Edits keep being appended once the metadata is reloaded.
+  {
+    scoped_refptr<TabletMetadata> new_meta;
+    ASSERT_OK(TabletMetadata::Load(harness_->fs_manager(), meta->tablet_id(), &new_meta));
+    ASSERT_OK(new_meta->Flush());
+    NO_FATALS(check_superblock(2));
+  }
+
+  // A partial edit at the end of the file is ignored, and the next flush
+  // writes the superblock in full.
+  ASSERT_OK(env->GetFileSize(path, &size_after));
+  {
+    RWFileOptions opts;
+    opts.mode = Env::MUST_EXIST;
+    opts.is_sensitive = true;
+    unique_ptr<RWFile> file;
+    ASSERT_OK(env->NewRWFile(opts, path, &file));
+    ASSERT_OK(file->Truncate(size_after - 1));
+    ASSERT_OK(file->Close());
+  }
+  NO_FATALS(check_superblock(std::nullopt));
+  {
+    scoped_refptr<TabletMetadata> new_meta;
+    ASSERT_OK(TabletMetadata::Load(harness_->fs_manager(), meta->tablet_id(), &new_meta));
+    ASSERT_OK(new_meta->Flush());
+    NO_FATALS(check_superblock(0));
+  }
+}
+
 TEST_F(TestTabletMetadata, BenchmarkCollectBlockIds) {
   auto tablet_meta = harness_->tablet()->metadata();
   RowSetMetadataVector rs_metas;
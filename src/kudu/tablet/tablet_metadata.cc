@@ -28,6 +28,7 @@
 #include <utility>
 
 #include <gflags/gflags.h>
+#include <google/protobuf/repeated_field.h>
 
 #include "kudu/common/common.pb.h"
 #include "kudu/common/schema.h"
@@ -71,6 +72,18 @@ DEFINE_int32(tablet_metadata_load_inject_latency_ms, 0,
              "Only for testing.");
 TAG_FLAG(tablet_metadata_load_inject_latency_ms, hidden);
 
+DEFINE_int32(tablet_metadata_max_edits, 0,
+             "Maximum number of edits appended to the tablet metadata file by "
+             "flushes of the metadata before the next flush rewrites the file in "
+             "full. An edit only has the rowsets added or changed since the "
+             "previous flush, so that the flushes of tablets with many rowsets "
+             "don't each write all of them. If 0, every flush rewrites the file "
+             "in full. Note: versions of Kudu which don't support edits ignore "
+             "them, so they must not be enabled on servers which may be "
+             "downgraded to such versions.");
+TAG_FLAG(tablet_metadata_max_edits, experimental);
+TAG_FLAG(tablet_metadata_max_edits, runtime);
+
 using base::subtle::Barrier_AtomicIncrement;
 using kudu::consensus::MinimumOpId;
 using kudu::consensus::OpId;
@@ -94,6 +107,44 @@ using strings::Substitute;
 namespace kudu {
 namespace tablet {
 
+namespace {
+
+// Applies the superblock edit 'edit' to 'superblock', leaving 'edit' in an
+// unspecified state. The rowsets changed by the edit keep their position,
+// while those it added follow the others, as in TabletMetadata::UpdateUnlocked().
+void ApplySuperBlockEdit(TabletSuperBlockPB* edit, TabletSuperBlockPB* superblock) {
+  const unordered_set<int64_t> removed_ids(edit->removed_rowset_ids().begin(),
+                                           edit->removed_rowset_ids().end());
+  unordered_map<int64_t, RowSetDataPB*> changed;
+  for (auto& rowset : *edit->mutable_rowsets()) {
+    EmplaceOrDie(&changed, rowset.id(), &rowset);
+  }
+  google::protobuf::RepeatedPtrField<RowSetDataPB> rowsets;
+  for (auto& rowset : *superblock->mutable_rowsets()) {
+    if (ContainsKey(removed_ids, rowset.id())) {
+      continue;
+    }
+    RowSetDataPB* const* changed_rowset = FindOrNull(changed, rowset.id());
+    if (changed_rowset) {
+      rowsets.Add()->Swap(*changed_rowset);
+      changed.erase(rowset.id());
+    } else {
+      rowsets.Add()->Swap(&rowset);
+    }
+  }
+  for (auto& rowset : *edit->mutable_rowsets()) {
+    if (ContainsKey(changed, rowset.id())) {
+      rowsets.Add()->Swap(&rowset);
+    }
+  }
+  edit->mutable_rowsets()->Swap(&rowsets);
+  edit->clear_is_edit();
+  edit->clear_removed_rowset_ids();
+  superblock->Swap(edit);
+}
+
+} // anonymous namespace
+
 // ============================================================================
 //  Tablet Metadata
 // ============================================================================
@@ -337,6 +388,7 @@ TabletMetadata::TabletMetadata(FsManager* fs_manager, string tablet_id,
       num_flush_pins_(0),
       needs_flush_(false),
       flush_count_for_tests_(0),
+      num_superblock_edits_(0),
       pre_flush_callback_(&DoNothingStatusClosure),
       supports_live_row_count_(supports_live_row_count) {
   CHECK(schema_->has_column_ids());
@@ -354,6 +406,7 @@ TabletMetadata::TabletMetadata(FsManager* fs_manager, string tablet_id)
       num_flush_pins_(0),
       needs_flush_(false),
       flush_count_for_tests_(0),
+      num_superblock_edits_(0),
       pre_flush_callback_(&DoNothingStatusClosure),
       supports_live_row_count_(false) {}
 
@@ -364,10 +417,24 @@ Status TabletMetadata::LoadFromDisk() {
   CHECK_EQ(state_, kNotLoadedYet);
 
   TabletSuperBlockPB superblock;
-  RETURN_NOT_OK(ReadSuperBlockFromDisk(&superblock));
+  optional<int> num_edits;
+  RETURN_NOT_OK(ReadSuperBlockFromPath(fs_manager_->GetEnv(),
+                                       fs_manager_->GetTabletMetadataPath(tablet_id_),
+                                       &superblock, &num_edits));
   RETURN_NOT_OK_PREPEND(LoadFromSuperBlock(superblock),
                         "Failed to load data from superblock protobuf");
   RETURN_NOT_OK(UpdateOnDiskSize());
+  // Unless the file ends with a partial edit, which further edits can't
+  // follow, the next flush may append an edit to the superblock just loaded.
+  if (num_edits) {
+    MutexLock l_flush(flush_lock_);
+    std::lock_guard<LockType> l(data_lock_);
+    persisted_rowset_versions_.emplace();
+    for (const auto& rowset : rowsets_) {
+      EmplaceOrDie(&*persisted_rowset_versions_, rowset->id(), rowset->version());
+    }
+    num_superblock_edits_ = *num_edits;
+  }
   state_ = kInitialized;
   return Status::OK();
 }
@@ -614,7 +681,10 @@ Status TabletMetadata::Flush() {
   MutexLock l_flush(flush_lock_);
   BlockIdContainer orphaned;
   TabletSuperBlockPB pb;
+  RowSetVersions versions;
   vector<unique_ptr<MinLogIndexAnchorer>> anchors_needing_flush;
+  bool full = !persisted_rowset_versions_ ||
+      num_superblock_edits_ >= FLAGS_tablet_metadata_max_edits;
   {
     std::lock_guard<LockType> l(data_lock_);
     CHECK_GE(num_flush_pins_, 0);
@@ -625,7 +695,7 @@ Status TabletMetadata::Flush() {
     }
     needs_flush_ = false;
 
-    RETURN_NOT_OK(ToSuperBlockUnlocked(&pb, rowsets_));
+    RETURN_NOT_OK(ToSuperBlockOrEditUnlocked(full, &pb, &versions));
 
     // Make a copy of the orphaned blocks list which corresponds to the superblock
     // that we're writing. It's important to take this local copy to avoid a race
@@ -637,7 +707,27 @@ Status TabletMetadata::Flush() {
     anchors_needing_flush = std::move(anchors_needing_flush_);
   }
   pre_flush_callback_();
-  RETURN_NOT_OK(ReplaceSuperBlockUnlocked(pb));
+  if (!full) {
+    Status s = AppendSuperBlockEditUnlocked(pb);
+    if (!s.ok()) {
+      // The file may now end with a partial edit: rewrite it in full instead.
+      // The superblock written may be more recent than 'orphaned' and the
+      // anchors, but they don't outlive the state they protect either way.
+      LOG_WITH_PREFIX(WARNING) << "Failed to append an edit to the tablet metadata, "
+                               << "rewriting it in full: " << s.ToString();
+      persisted_rowset_versions_.reset();
+      full = true;
+      std::lock_guard<LockType> l(data_lock_);
+      RETURN_NOT_OK(ToSuperBlockOrEditUnlocked(full, &pb, &versions));
+    }
+  }
+  if (full) {
+    RETURN_NOT_OK(ReplaceSuperBlockUnlocked(pb));
+    num_superblock_edits_ = 0;
+  } else {
+    num_superblock_edits_++;
+  }
+  persisted_rowset_versions_ = std::move(versions);
   TRACE("Metadata flushed");
   l_flush.Unlock();
 
@@ -695,6 +785,9 @@ Status TabletMetadata::ReplaceSuperBlock(const TabletSuperBlockPB &pb) {
     MutexLock l(flush_lock_);
     RETURN_NOT_OK_PREPEND(ReplaceSuperBlockUnlocked(pb), "Unable to replace superblock");
     fs_manager_->dd_manager()->DeleteDataDirGroup(tablet_id_);
+    // The rowsets are replaced below: the next flush writes them in full.
+    persisted_rowset_versions_.reset();
+    num_superblock_edits_ = 0;
   }
 
   RETURN_NOT_OK_PREPEND(LoadFromSuperBlock(pb),
@@ -710,7 +803,8 @@ Status TabletMetadata::ReplaceSuperBlockUnlocked(const TabletSuperBlockPB &pb) {
   RETURN_NOT_OK_PREPEND(pb_util::WritePBContainerToPath(
                             fs_manager_->GetEnv(), path, pb,
                             pb_util::OVERWRITE, pb_util::SYNC,
-                            pb_util::SENSITIVE),
+                            pb_util::SENSITIVE,
+                            fs_manager_->tablet_metadata_dir_syncer()),
                         Substitute("Failed to write tablet metadata $0", tablet_id_));
   flush_count_for_tests_++;
   RETURN_NOT_OK(UpdateOnDiskSize());
@@ -718,6 +812,31 @@ Status TabletMetadata::ReplaceSuperBlockUnlocked(const TabletSuperBlockPB &pb) {
   return Status::OK();
 }
 
+Status TabletMetadata::AppendSuperBlockEditUnlocked(const TabletSuperBlockPB& pb) {
+  flush_lock_.AssertAcquired();
+  DCHECK(pb.is_edit());
+
+  string path = fs_manager_->GetTabletMetadataPath(tablet_id_);
+  RWFileOptions opts;
+  opts.mode = Env::MUST_EXIST;
+  opts.is_sensitive = true;
+  unique_ptr<RWFile> file;
+  RETURN_NOT_OK_PREPEND(fs_manager_->GetEnv()->NewRWFile(opts, path, &file),
+                        Substitute("Failed to open tablet metadata $0", tablet_id_));
+  pb_util::WritablePBContainerFile pb_file(std::move(file));
+  RETURN_NOT_OK_PREPEND(pb_file.OpenExisting(),
+                        Substitute("Failed to open tablet metadata $0", tablet_id_));
+  RETURN_NOT_OK_PREPEND(pb_file.Append(pb),
+                        Substitute("Failed to write tablet metadata $0", tablet_id_));
+  RETURN_NOT_OK_PREPEND(pb_file.Sync(),
+                        Substitute("Failed to write tablet metadata $0", tablet_id_));
+  RETURN_NOT_OK(pb_file.Close());
+  flush_count_for_tests_++;
+  RETURN_NOT_OK(UpdateOnDiskSize());
+
+  return Status::OK();
+}
+
 void TabletMetadata::SetPreFlushCallback(StatusClosure callback) {
   MutexLock l_flush(flush_lock_);
   pre_flush_callback_ = std::move(callback);
@@ -729,10 +848,55 @@ std::optional<consensus::OpId> TabletMetadata::tombstone_last_logged_opid() cons
 }
 
 Status TabletMetadata::ReadSuperBlockFromDisk(TabletSuperBlockPB* superblock) const {
-  string path = fs_manager_->GetTabletMetadataPath(tablet_id_);
-  RETURN_NOT_OK_PREPEND(
-      pb_util::ReadPBContainerFromPath(fs_manager_->GetEnv(), path, superblock, pb_util::SENSITIVE),
-      Substitute("Could not load tablet metadata from $0", path));
+  return ReadSuperBlockFromPath(fs_manager_->GetEnv(),
+                                fs_manager_->GetTabletMetadataPath(tablet_id_),
+                                superblock);
+}
+
+Status TabletMetadata::ReadSuperBlockFromPath(Env* env,
+                                              const string& path,
+                                              TabletSuperBlockPB* superblock,
+                                              optional<int>* num_edits) {
+  const string error_prefix = Substitute("Could not load tablet metadata from $0", path);
+  unique_ptr<RandomAccessFile> file;
+  RandomAccessFileOptions opts;
+  opts.is_sensitive = true;
+  RETURN_NOT_OK_PREPEND(env->NewRandomAccessFile(opts, path, &file), error_prefix);
+  pb_util::ReadablePBContainerFile pb_file(std::move(file));
+  RETURN_NOT_OK_PREPEND(pb_file.Open(), error_prefix);
+  RETURN_NOT_OK_PREPEND(pb_file.ReadNextPB(superblock), error_prefix);
+  if (superblock->is_edit()) {
+    return Status::Corruption(error_prefix, "file begins with a superblock edit");
+  }
+
+  int edits = 0;
+  bool complete = true;
+  TabletSuperBlockPB edit;
+  while (true) {
+    Status s = pb_file.ReadNextPB(&edit);
+    if (s.IsEndOfFile()) {
+      break;
+    }
+    if (s.IsIncomplete()) {
+      // The flush appending the last edit didn't complete, so the superblock
+      // is the one preceding the edit.
+      LOG(WARNING) << Substitute("$0: ignoring a partial superblock edit: $1",
+                                 path, s.ToString());
+      complete = false;
+      break;
+    }
+    RETURN_NOT_OK_PREPEND(s, error_prefix);
+    if (!edit.is_edit()) {
+      return Status::Corruption(error_prefix,
+                                Substitute("superblock $0 isn't an edit", edits + 1));
+    }
+    ApplySuperBlockEdit(&edit, superblock);
+    edits++;
+  }
+  RETURN_NOT_OK_PREPEND(pb_file.Close(), error_prefix);
+  if (num_edits) {
+    *num_edits = complete ? make_optional(edits) : nullopt;
+  }
   return Status::OK();
 }
 
@@ -742,6 +906,41 @@ Status TabletMetadata::ToSuperBlock(TabletSuperBlockPB* super_block) const {
   return ToSuperBlockUnlocked(super_block, rowsets_);
 }
 
+Status TabletMetadata::ToSuperBlockOrEditUnlocked(bool full,
+                                                  TabletSuperBlockPB* super_block,
+                                                  RowSetVersions* versions) const {
+  flush_lock_.AssertAcquired();
+  DCHECK(data_lock_.is_locked());
+  DCHECK(full || persisted_rowset_versions_);
+
+  // The versions are read before the rowsets are serialized, so that a rowset
+  // changing in the meantime is written again by the next flush.
+  versions->clear();
+  RowSetMetadataVector rowsets;
+  for (const auto& rowset : rowsets_) {
+    const int64_t version = rowset->version();
+    EmplaceOrDie(versions, rowset->id(), version);
+    if (full) {
+      rowsets.push_back(rowset);
+      continue;
+    }
+    const int64_t* persisted_version = FindOrNull(*persisted_rowset_versions_, rowset->id());
+    if (!persisted_version || *persisted_version != version) {
+      rowsets.push_back(rowset);
+    }
+  }
+  RETURN_NOT_OK(ToSuperBlockUnlocked(super_block, rowsets));
+  if (!full) {
+    super_block->set_is_edit(true);
+    for (const auto& id_and_version : *persisted_rowset_versions_) {
+      if (!ContainsKey(*versions, id_and_version.first)) {
+        super_block->add_removed_rowset_ids(id_and_version.first);
+      }
+    }
+  }
+  return Status::OK();
+}
+
 Status TabletMetadata::ToSuperBlockUnlocked(TabletSuperBlockPB* super_block,
                                             const RowSetMetadataVector& rowsets) const {
   DCHECK(data_lock_.is_locked());
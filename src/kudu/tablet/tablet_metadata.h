@@ -45,6 +45,7 @@
 namespace kudu {
 
 class BlockIdPB;
+class Env;
 class FsManager;
 class Timestamp;
 
@@ -311,6 +312,16 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   // Loads the currently-flushed superblock from disk into the given protobuf.
   Status ReadSuperBlockFromDisk(TabletSuperBlockPB* superblock) const;
 
+  // Loads the superblock persisted in the tablet metadata file at 'path',
+  // applying the edits following its full superblock, if any.
+  //
+  // If not null, 'num_edits' is set to the number of edits applied, or to
+  // none if the file ends with a partially written edit, which is ignored.
+  static Status ReadSuperBlockFromPath(Env* env,
+                                       const std::string& path,
+                                       TabletSuperBlockPB* superblock,
+                                       std::optional<int>* num_edits = nullptr);
+
   // Sets *super_block to the serialized form of the current metadata.
   Status ToSuperBlock(TabletSuperBlockPB* super_block) const;
 
@@ -386,6 +397,10 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   // Requires 'flush_lock_'.
   Status ReplaceSuperBlockUnlocked(const TabletSuperBlockPB& pb);
 
+  // Appends the superblock edit 'pb' to the tablet metadata file.
+  // Requires 'flush_lock_'.
+  Status AppendSuperBlockEditUnlocked(const TabletSuperBlockPB& pb);
+
   // Requires 'data_lock_'.
   Status UpdateUnlocked(const RowSetMetadataIds& to_remove,
                         const RowSetMetadataVector& to_add,
@@ -396,6 +411,17 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   Status ToSuperBlockUnlocked(TabletSuperBlockPB* super_block,
                               const RowSetMetadataVector& rowsets) const;
 
+  // The versions of rowsets, keyed by their IDs.
+  typedef std::unordered_map<int64_t, int64_t> RowSetVersions;
+
+  // Serializes the current metadata into 'super_block', in full if 'full' is
+  // true and as an edit of the last persisted superblock otherwise, and sets
+  // 'versions' to the versions of the rowsets it reflects.
+  // Requires 'flush_lock_' and 'data_lock_'.
+  Status ToSuperBlockOrEditUnlocked(bool full,
+                                    TabletSuperBlockPB* super_block,
+                                    RowSetVersions* versions) const;
+
   // Requires 'data_lock_'.
   void AddOrphanedBlocksUnlocked(const BlockIdContainer& block_ids);
 
@@ -480,6 +506,15 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   // The number of times metadata has been flushed to disk
   int flush_count_for_tests_;
 
+  // The versions of the rowsets as of the last superblock persisted, or none
+  // if the next flush must write the superblock in full, e.g. because the
+  // persisted one isn't known. Protected by 'flush_lock_'.
+  std::optional<RowSetVersions> persisted_rowset_versions_;
+
+  // The number of edits appended to the tablet metadata file since its full
+  // superblock was written. Protected by 'flush_lock_'.
+  int num_superblock_edits_;
+
   // A callback that, if set, is called before this metadata is flushed
   // to disk. Protected by the 'flush_lock_'.
   StatusClosure pre_flush_callback_;
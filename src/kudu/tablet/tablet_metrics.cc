@@ -169,10 +169,46 @@ METRIC_DEFINE_counter(tablet, mrs_lookups, "MemRowSet Lookups",
                       kudu::MetricUnit::kProbes,
                       "Number of times a MemRowSet was consulted.",
                       kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, row_cache_hits, "Row Cache Hits",
+                      kudu::MetricUnit::kCacheHits,
+                      "Number of primary key lookups served by the row cache.",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, row_cache_misses, "Row Cache Misses",
+                      kudu::MetricUnit::kCacheQueries,
+                      "Number of primary key lookups eligible for the row cache "
+                      "which weren't served by it.",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, block_cache_hits, "Block Cache Hits",
+                      kudu::MetricUnit::kCacheHits,
+                      "Number of lookups of blocks of this tablet's files which "
+                      "were found in the block cache.",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, block_cache_misses, "Block Cache Misses",
+                      kudu::MetricUnit::kCacheQueries,
+                      "Number of lookups of blocks of this tablet's files which "
+                      "weren't found in the block cache.",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_gauge_int64(tablet, block_cache_usage, "Block Cache Usage",
+                          kudu::MetricUnit::kBytes,
+                          "Number of bytes of the blocks of this tablet's files "
+                          "held by the block cache. Not tracked for the data "
+                          "blocks in a tiered block cache.",
+                          kudu::MetricLevel::kDebug);
 METRIC_DEFINE_counter(tablet, bytes_flushed, "Bytes Flushed",
                       kudu::MetricUnit::kBytes,
                       "Amount of data that has been flushed to disk by this tablet.",
                       kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, flush_mrs_bytes_written, "MemRowSet Flush Bytes Written",
+                      kudu::MetricUnit::kBytes,
+                      "Amount of data written to disk by MemRowSet flushes of this tablet, "
+                      "i.e. the amount of data ingested on disk.",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, compact_rs_bytes_written, "RowSet Compaction Bytes Written",
+                      kudu::MetricUnit::kBytes,
+                      "Amount of data rewritten to disk by RowSet compactions of this tablet. "
+                      "Divided by flush_mrs_bytes_written, this gives the number of bytes "
+                      "rewritten by compactions per byte ingested.",
+                      kudu::MetricLevel::kDebug);
 
 METRIC_DEFINE_counter(tablet, undo_delta_block_gc_bytes_deleted,
                       "Undo Delta Block GC Bytes Deleted",
@@ -188,6 +224,12 @@ METRIC_DEFINE_counter(tablet, deleted_rowset_gc_bytes_deleted,
                       "Number of bytes deleted by garbage-collecting deleted rowsets.",
                       kudu::MetricLevel::kDebug);
 
+METRIC_DEFINE_counter(tablet, cold_rowset_migration_bytes,
+                      "Cold Rowset Migration Bytes",
+                      kudu::MetricUnit::kBytes,
+                      "Number of bytes of aged rowsets rewritten as cold data.",
+                      kudu::MetricLevel::kDebug);
+
 METRIC_DEFINE_counter(tablet, ops_timed_out_in_prepare_queue,
                       "Number of Requests Timed Out In Prepare Queue",
                       kudu::MetricUnit::kRequests,
@@ -301,6 +343,18 @@ METRIC_DEFINE_gauge_uint32(tablet, deleted_rowset_gc_running,
   "Number of deleted rowset GC operations currently running.",
   kudu::MetricLevel::kDebug);
 
+METRIC_DEFINE_gauge_uint32(tablet, cold_rowset_migration_running,
+  "Cold Rowset Migration Running",
+  kudu::MetricUnit::kMaintenanceOperations,
+  "Number of cold rowset migration operations currently running.",
+  kudu::MetricLevel::kDebug);
+
+METRIC_DEFINE_gauge_uint32(tablet, compact_mrs_mutations_running,
+  "MemRowSet Mutation Compactions Running",
+  kudu::MetricUnit::kMaintenanceOperations,
+  "Number of compactions of the mutations of MemRowSet rows currently running.",
+  kudu::MetricLevel::kDebug);
+
 METRIC_DEFINE_gauge_int64(tablet, deleted_rowset_estimated_retained_bytes,
   "Estimated Deletable Bytes Retained in Deleted Rowsets",
   kudu::MetricUnit::kBytes,
@@ -378,6 +432,13 @@ METRIC_DEFINE_histogram(tablet, compact_rs_mem_usage_to_deltas_size_ratio,
   kudu::MetricLevel::kInfo,
   60000LU, 1);
 
+METRIC_DEFINE_histogram(tablet, compact_mrs_mutations_duration,
+  "MemRowSet Mutation Compaction Duration",
+  kudu::MetricUnit::kMilliseconds,
+  "Time spent folding the mutations of MemRowSet rows into the rows.",
+  kudu::MetricLevel::kInfo,
+  60000LU, 1);
+
 METRIC_DEFINE_histogram(tablet, deleted_rowset_gc_duration,
   "Deleted Rowset GC Duration",
   kudu::MetricUnit::kMilliseconds,
@@ -385,6 +446,14 @@ METRIC_DEFINE_histogram(tablet, deleted_rowset_gc_duration,
   kudu::MetricLevel::kInfo,
   60000LU, 1);
 
+METRIC_DEFINE_histogram(tablet, cold_rowset_migration_duration,
+  "Cold Rowset Migration Duration",
+  kudu::MetricUnit::kMilliseconds,
+  "Time spent running the maintenance operation to rewrite aged rowsets as "
+  "cold data.",
+  kudu::MetricLevel::kInfo,
+  60000LU, 1);
+
 METRIC_DEFINE_counter(tablet, leader_memory_pressure_rejections,
   "Leader Memory Pressure Rejections",
   kudu::MetricUnit::kRequests,
@@ -430,8 +499,16 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(key_file_lookups),
     MINIT(delta_file_lookups),
     MINIT(mrs_lookups),
+    MINIT(row_cache_hits),
+    MINIT(row_cache_misses),
+    MINIT(block_cache_hits),
+    MINIT(block_cache_misses),
+    GINIT(block_cache_usage),
     MINIT(bytes_flushed),
+    MINIT(flush_mrs_bytes_written),
+    MINIT(compact_rs_bytes_written),
     MINIT(deleted_rowset_gc_bytes_deleted),
+    MINIT(cold_rowset_migration_bytes),
     MINIT(undo_delta_block_gc_bytes_deleted),
     MINIT(ops_timed_out_in_prepare_queue),
     MINIT(bloom_lookups_per_op),
@@ -444,8 +521,10 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     GINIT(flush_dms_running),
     GINIT(flush_mrs_running),
     GINIT(compact_rs_running),
+    GINIT(compact_mrs_mutations_running),
     GINIT(deleted_rowset_estimated_retained_bytes),
     GINIT(deleted_rowset_gc_running),
+    GINIT(cold_rowset_migration_running),
     GINIT(delta_minor_compact_rs_running),
     GINIT(delta_major_compact_rs_running),
     GINIT(undo_delta_block_gc_running),
@@ -453,7 +532,9 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(flush_dms_duration),
     MINIT(flush_mrs_duration),
     MINIT(compact_rs_duration),
+    MINIT(compact_mrs_mutations_duration),
     MINIT(deleted_rowset_gc_duration),
+    MINIT(cold_rowset_migration_duration),
     MINIT(delta_minor_compact_rs_duration),
     MINIT(delta_major_compact_rs_duration),
     MINIT(undo_delta_block_gc_init_duration),
@@ -72,9 +72,21 @@ struct TabletMetrics {
   scoped_refptr<Counter> delta_file_lookups;
   scoped_refptr<Counter> mrs_lookups;
 
+  // Row cache stats.
+  scoped_refptr<Counter> row_cache_hits;
+  scoped_refptr<Counter> row_cache_misses;
+
+  // Block cache stats of the tablet's files.
+  scoped_refptr<Counter> block_cache_hits;
+  scoped_refptr<Counter> block_cache_misses;
+  scoped_refptr<AtomicGauge<int64_t>> block_cache_usage;
+
   // Operation stats.
   scoped_refptr<Counter> bytes_flushed;
+  scoped_refptr<Counter> flush_mrs_bytes_written;
+  scoped_refptr<Counter> compact_rs_bytes_written;
   scoped_refptr<Counter> deleted_rowset_gc_bytes_deleted;
+  scoped_refptr<Counter> cold_rowset_migration_bytes;
   scoped_refptr<Counter> undo_delta_block_gc_bytes_deleted;
   scoped_refptr<Counter> ops_timed_out_in_prepare_queue;
 
@@ -90,8 +102,10 @@ struct TabletMetrics {
   scoped_refptr<AtomicGauge<uint32_t> > flush_dms_running;
   scoped_refptr<AtomicGauge<uint32_t> > flush_mrs_running;
   scoped_refptr<AtomicGauge<uint32_t> > compact_rs_running;
+  scoped_refptr<AtomicGauge<uint32_t> > compact_mrs_mutations_running;
   scoped_refptr<AtomicGauge<int64_t> > deleted_rowset_estimated_retained_bytes;
   scoped_refptr<AtomicGauge<uint32_t> > deleted_rowset_gc_running;
+  scoped_refptr<AtomicGauge<uint32_t> > cold_rowset_migration_running;
   scoped_refptr<AtomicGauge<uint32_t> > delta_minor_compact_rs_running;
   scoped_refptr<AtomicGauge<uint32_t> > delta_major_compact_rs_running;
   scoped_refptr<AtomicGauge<uint32_t> > undo_delta_block_gc_running;
@@ -100,7 +114,9 @@ struct TabletMetrics {
   scoped_refptr<Histogram> flush_dms_duration;
   scoped_refptr<Histogram> flush_mrs_duration;
   scoped_refptr<Histogram> compact_rs_duration;
+  scoped_refptr<Histogram> compact_mrs_mutations_duration;
   scoped_refptr<Histogram> deleted_rowset_gc_duration;
+  scoped_refptr<Histogram> cold_rowset_migration_duration;
   scoped_refptr<Histogram> delta_minor_compact_rs_duration;
   scoped_refptr<Histogram> delta_major_compact_rs_duration;
   scoped_refptr<Histogram> undo_delta_block_gc_init_duration;
@@ -17,11 +17,14 @@
 
 #include "kudu/tablet/tablet_mm_ops.h"
 
+#include <algorithm>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <ostream>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -83,6 +86,13 @@ DEFINE_bool(enable_deleted_rowset_gc, true,
     "considered ancient history (see --tablet_history_max_age_sec) are deleted.");
 TAG_FLAG(enable_deleted_rowset_gc, runtime);
 
+DEFINE_int64(memrowset_mutation_compaction_min_mutations, 100000,
+    "The number of mutations to be appended to the rows of a MemRowSet before "
+    "the ones which are older than the ancient history mark are folded into "
+    "the rows, so that scans don't have to walk them. Set to 0 to disable it.");
+TAG_FLAG(memrowset_mutation_compaction_min_mutations, experimental);
+TAG_FLAG(memrowset_mutation_compaction_min_mutations, runtime);
+
 DEFINE_bool(enable_workload_score_for_perf_improvement_ops, false,
             "Whether to enable prioritization of maintenance operations based on "
             "whether there are on-going workloads, favoring ops of 'hot' tablets.");
@@ -95,7 +105,9 @@ DEFINE_int32(update_stats_log_throttling_interval_sec, 600,
 TAG_FLAG(update_stats_log_throttling_interval_sec, runtime);
 TAG_FLAG(update_stats_log_throttling_interval_sec, experimental);
 
+using std::shared_ptr;
 using std::string;
+using std::vector;
 using strings::Substitute;
 
 namespace kudu {
@@ -123,6 +135,10 @@ bool TabletOpBase::compaction_enabled() const {
   return tablet_->compaction_enabled();
 }
 
+vector<string> TabletOpBase::DataDirs() const {
+  return tablet_->DataDirs();
+}
+
 ////////////////////////////////////////////////////////////
 // CompactRowSetsOp
 ////////////////////////////////////////////////////////////
@@ -172,6 +188,7 @@ void CompactRowSetsOp::UpdateStats(MaintenanceOpStats* stats) {
   }
 
   tablet_->UpdateCompactionStats(&prev_stats_);
+  prev_stats_.set_cpu_seconds(MeanDurationSeconds());
   prev_stats_.set_workload_score(workload_score);
   *stats = prev_stats_;
 }
@@ -254,8 +271,15 @@ void MinorDeltaCompactionOp::UpdateStats(MaintenanceOpStats* stats) {
     last_num_rs_minor_delta_compacted_ = new_num_rs_minor_delta_compacted;
   }
 
+  shared_ptr<RowSet> rs;
   double perf_improv = tablet_->GetPerfImprovementForBestDeltaCompact(
-      RowSet::MINOR_DELTA_COMPACTION, nullptr);
+      RowSet::MINOR_DELTA_COMPACTION, &rs);
+  // The REDO deltas of the rowset are read and rewritten.
+  if (rs) {
+    prev_stats_.set_io_bytes(
+        2 * (rs->OnDiskBaseDataSizeWithRedos() - rs->OnDiskBaseDataSize()));
+  }
+  prev_stats_.set_cpu_seconds(MeanDurationSeconds());
   prev_stats_.set_perf_improvement(perf_improv);
   prev_stats_.set_runnable(perf_improv > 0);
   prev_stats_.set_workload_score(workload_score);
@@ -342,8 +366,14 @@ void MajorDeltaCompactionOp::UpdateStats(MaintenanceOpStats* stats) {
     last_num_rs_major_delta_compacted_ = new_num_rs_major_delta_compacted;
   }
 
+  shared_ptr<RowSet> rs;
   double perf_improv = tablet_->GetPerfImprovementForBestDeltaCompact(
-      RowSet::MAJOR_DELTA_COMPACTION, nullptr);
+      RowSet::MAJOR_DELTA_COMPACTION, &rs);
+  // At most the base data and REDO deltas of the rowset are read and rewritten.
+  if (rs) {
+    prev_stats_.set_io_bytes(2 * rs->OnDiskBaseDataSizeWithRedos());
+  }
+  prev_stats_.set_cpu_seconds(MeanDurationSeconds());
   prev_stats_.set_perf_improvement(perf_improv);
   prev_stats_.set_runnable(perf_improv > 0);
   prev_stats_.set_workload_score(workload_score);
@@ -431,6 +461,48 @@ std::string UndoDeltaBlockGCOp::LogPrefix() const {
   return tablet_->LogPrefix();
 }
 
+////////////////////////////////////////////////////////////
+// CompactMemRowSetMutationsOp
+////////////////////////////////////////////////////////////
+
+CompactMemRowSetMutationsOp::CompactMemRowSetMutationsOp(Tablet* tablet)
+    : TabletOpBase(Substitute("CompactMemRowSetMutationsOp($0)", tablet->tablet_id()),
+                   MaintenanceOp::LOW_IO_USAGE, tablet),
+      running_(false) {
+}
+
+void CompactMemRowSetMutationsOp::UpdateStats(MaintenanceOpStats* stats) {
+  const int64_t min_mutations = FLAGS_memrowset_mutation_compaction_min_mutations;
+  if (min_mutations <= 0 || running_.load()) {
+    stats->set_runnable(false);
+    return;
+  }
+  const int64_t num_mutations = tablet_->MemRowSetMutationsToCompact();
+  if (num_mutations < min_mutations) {
+    stats->set_runnable(false);
+    return;
+  }
+  // Walking the mutations is about as costly for a scan as folding them once,
+  // so this is only worth a fraction of the improvement of a rowset compaction.
+  stats->set_runnable(true);
+  stats->set_perf_improvement(std::min(1.0, 0.1 * num_mutations / min_mutations));
+  stats->set_cpu_seconds(MeanDurationSeconds());
+}
+
+void CompactMemRowSetMutationsOp::Perform() {
+  WARN_NOT_OK(tablet_->CompactMemRowSetMutations(),
+              Substitute("$0Compaction of MRS mutations failed", LogPrefix()));
+  running_.store(false);
+}
+
+scoped_refptr<Histogram> CompactMemRowSetMutationsOp::DurationHistogram() const {
+  return tablet_->metrics()->compact_mrs_mutations_duration;
+}
+
+scoped_refptr<AtomicGauge<uint32_t>> CompactMemRowSetMutationsOp::RunningGauge() const {
+  return tablet_->metrics()->compact_mrs_mutations_running;
+}
+
 DeletedRowsetGCOp::DeletedRowsetGCOp(Tablet* tablet)
     : TabletOpBase(Substitute("DeletedRowSetGCOp($0)", tablet->tablet_id()),
                    MaintenanceOp::HIGH_IO_USAGE, tablet),
@@ -472,5 +544,46 @@ std::string DeletedRowsetGCOp::LogPrefix() const {
   return tablet_->LogPrefix();
 }
 
+////////////////////////////////////////////////////////////
+// MigrateColdRowSetsOp
+////////////////////////////////////////////////////////////
+
+MigrateColdRowSetsOp::MigrateColdRowSetsOp(Tablet* tablet)
+    : TabletOpBase(Substitute("MigrateColdRowSetsOp($0)", tablet->tablet_id()),
+                   MaintenanceOp::HIGH_IO_USAGE, tablet),
+      running_(false) {
+}
+
+void MigrateColdRowSetsOp::UpdateStats(MaintenanceOpStats* stats) {
+  if (running_.load()) {
+    VLOG(1) << LogPrefix() << " not updating stats: already running";
+    stats->set_runnable(false);
+    return;
+  }
+  int64_t bytes = 0;
+  WARN_NOT_OK(tablet_->GetBytesInColdRowSetCandidates(&bytes),
+              "Unable to count bytes in rowsets to migrate to cold data");
+  stats->set_data_retained_bytes(bytes);
+  stats->set_runnable(bytes > 0);
+}
+
+void MigrateColdRowSetsOp::Perform() {
+  WARN_NOT_OK(tablet_->MigrateColdRowSets(),
+              Substitute("$0Migration of rowsets to cold data failed", LogPrefix()));
+  running_.store(false);
+}
+
+scoped_refptr<Histogram> MigrateColdRowSetsOp::DurationHistogram() const {
+  return tablet_->metrics()->cold_rowset_migration_duration;
+}
+
+scoped_refptr<AtomicGauge<uint32_t>> MigrateColdRowSetsOp::RunningGauge() const {
+  return tablet_->metrics()->cold_rowset_migration_running;
+}
+
+std::string MigrateColdRowSetsOp::LogPrefix() const {
+  return tablet_->LogPrefix();
+}
+
 } // namespace tablet
 } // namespace kudu
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
@@ -45,6 +46,8 @@ class TabletOpBase : public MaintenanceOp {
   // otherwise return 'false'.
   bool compaction_enabled() const;
 
+  std::vector<std::string> DataDirs() const override;
+
  protected:
   int32_t priority() const override;
 
@@ -164,6 +167,32 @@ class UndoDeltaBlockGCOp : public TabletOpBase {
   DISALLOW_COPY_AND_ASSIGN(UndoDeltaBlockGCOp);
 };
 
+// Folds the mutations of the MemRowSet rows into the rows, once enough of them
+// accumulated, so that scans don't have to walk them.
+class CompactMemRowSetMutationsOp : public TabletOpBase {
+ public:
+  explicit CompactMemRowSetMutationsOp(Tablet* tablet);
+
+  void UpdateStats(MaintenanceOpStats* stats) override;
+
+  // If this op is already running, we shouldn't run it again.
+  bool Prepare() override {
+    bool false_ref = false;
+    return running_.compare_exchange_strong(false_ref, true);
+  }
+
+  void Perform() override;
+
+  scoped_refptr<Histogram> DurationHistogram() const override;
+
+  scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+
+ private:
+  std::atomic<bool> running_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactMemRowSetMutationsOp);
+};
+
 // MaintenanceOp to garbage-collect entire rowsets that are fully deleted and
 // older than the ancient history mark.
 class DeletedRowsetGCOp : public TabletOpBase {
@@ -197,6 +226,35 @@ class DeletedRowsetGCOp : public TabletOpBase {
   DISALLOW_COPY_AND_ASSIGN(DeletedRowsetGCOp);
 };
 
+// MaintenanceOp to rewrite the rowsets whose data is older than
+// --tablet_cold_rowset_age_days as cold data, moving their blocks away from
+// the data directories on fast media.
+class MigrateColdRowSetsOp : public TabletOpBase {
+ public:
+  explicit MigrateColdRowSetsOp(Tablet* tablet);
+
+  // Estimate the number of bytes in rowsets to migrate, which are reported as
+  // retained: they hold space on fast media.
+  void UpdateStats(MaintenanceOpStats* stats) override;
+
+  // If this op is already running, we shouldn't run it again.
+  bool Prepare() override {
+    bool false_ref = false;
+    return running_.compare_exchange_strong(false_ref, true);
+  }
+
+  void Perform() override;
+
+  scoped_refptr<Histogram> DurationHistogram() const override;
+  scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+ private:
+  std::string LogPrefix() const;
+
+  std::atomic<bool> running_;
+
+  DISALLOW_COPY_AND_ASSIGN(MigrateColdRowSetsOp);
+};
+
 } // namespace tablet
 } // namespace kudu
 
@@ -18,6 +18,7 @@
 #include "kudu/tablet/tablet_replica.h"
 
 #include <algorithm>
+#include <cmath>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -82,6 +83,14 @@ DEFINE_uint32(tablet_max_pending_txn_write_ops, 2,
 TAG_FLAG(tablet_max_pending_txn_write_ops, experimental);
 TAG_FLAG(tablet_max_pending_txn_write_ops, runtime);
 
+DEFINE_uint64(tablet_split_key_min_size_mb, 1024,
+              "Minimum on-disk size in MiB of a tablet for its leader replica to "
+              "report a key splitting its data in two halves to the master, which "
+              "uses it to find the tablets worth splitting. If 0, no split key is "
+              "reported.");
+TAG_FLAG(tablet_split_key_min_size_mb, experimental);
+TAG_FLAG(tablet_split_key_min_size_mb, runtime);
+
 METRIC_DEFINE_histogram(tablet, op_prepare_queue_length, "Operation Prepare Queue Length",
                         kudu::MetricUnit::kTasks,
                         "Number of operations waiting to be prepared within this tablet. "
@@ -170,6 +179,7 @@ TabletReplica::TabletReplica(
       cmeta_manager_(DCHECK_NOTNULL(std::move(cmeta_manager))),
       local_peer_pb_(std::move(local_peer_pb)),
       log_anchor_registry_(new LogAnchorRegistry),
+      change_subscriptions_(new ChangeSubscriptions(log_anchor_registry_)),
       apply_pool_(apply_pool),
       reload_txn_status_tablet_pool_(reload_txn_status_tablet_pool),
       txn_coordinator_(meta_->table_type() &&
@@ -748,8 +758,12 @@ log::RetentionIndexes TabletReplica::GetRetentionIndexes() const {
   // If we never have written to the log, no need to proceed.
   if (ret.for_durability == 0) return ret;
 
-  // Next, we interrogate the anchor registry.
+  // Next, we interrogate the anchor registry, once the change subscriptions
+  // which expired released their anchors.
   // Returns OK if minimum known, NotFound if no anchors are registered.
+  if (change_subscriptions_) {
+    change_subscriptions_->RemoveExpired();
+  }
   {
     int64_t min_anchor_index;
     Status s = log_anchor_registry_->GetEarliestRegisteredLogIndex(&min_anchor_index);
@@ -1026,12 +1040,27 @@ uint64_t TabletReplica::CountLiveRowsNoFail() const {
   return live_row_count;
 }
 
+namespace {
+
+// Whether a rate changed enough since it was last reported for the tablet
+// to be reported again: the rates fluctuate between updates of the stats.
+bool RateChangedSignificantly(double reported_rate, double rate) {
+  return std::abs(rate - reported_rate) > std::max(1.0, 0.25 * std::max(rate, reported_rate));
+}
+
+} // anonymous namespace
+
 void TabletReplica::UpdateTabletStats(vector<string>* dirty_tablets) {
   // It's necessary to check the state before visiting the "consensus_".
   if (RUNNING != state()) {
     return;
   }
 
+  // We cannot hold 'lock_' while calling RaftConsensus::role() because
+  // it may invoke TabletReplica::StartFollowerOp() and lead to
+  // a deadlock.
+  RaftPeerPB::Role role = consensus_->role();
+
   ReportedTabletStatsPB pb;
   pb.set_on_disk_size(OnDiskSize());
   uint64_t live_row_count;
@@ -1039,15 +1068,67 @@ void TabletReplica::UpdateTabletStats(vector<string>* dirty_tablets) {
   if (s.ok()) {
     pb.set_live_row_count(live_row_count);
   }
+  shared_ptr<Tablet> tablet = shared_tablet();
+  if (tablet) {
+    pb.set_num_rowsets(tablet->num_rowsets());
+    if (const auto* metrics = tablet->metrics(); metrics) {
+      const MonoTime now = MonoTime::Now();
+      const int64_t rows_mutated = metrics->rows_inserted->value() +
+                                   metrics->rows_upserted->value() +
+                                   metrics->rows_updated->value() +
+                                   metrics->rows_deleted->value();
+      const int64_t scans_started = metrics->scans_started->value();
+      if (last_stats_update_time_.Initialized()) {
+        const double elapsed_secs = (now - last_stats_update_time_).ToSeconds();
+        if (elapsed_secs > 0) {
+          pb.set_write_rate((rows_mutated - last_rows_mutated_) / elapsed_secs);
+          pb.set_scan_rate((scans_started - last_scans_started_) / elapsed_secs);
+        }
+      }
+      last_stats_update_time_ = now;
+      last_rows_mutated_ = rows_mutated;
+      last_scans_started_ = scans_started;
+    }
 
-  // We cannot hold 'lock_' while calling RaftConsensus::role() because
-  // it may invoke TabletReplica::StartFollowerOp() and lead to
-  // a deadlock.
-  RaftPeerPB::Role role = consensus_->role();
+    // Only the stats of leader replicas are reported to the master, so only
+    // leaders need to find the split key.
+    const uint64_t min_split_size = FLAGS_tablet_split_key_min_size_mb * 1024 * 1024;
+    if (role == RaftPeerPB::LEADER &&
+        min_split_size > 0 && pb.on_disk_size() >= min_split_size) {
+      // Finding the split key may read the key indexes of the rowsets: only
+      // do it again once the size of the tablet changed noticeably.
+      if (pb.on_disk_size() > split_key_on_disk_size_ * 1.1 ||
+          pb.on_disk_size() < split_key_on_disk_size_ * 0.9) {
+        split_key_ = tablet->FindSplitKey(pb.on_disk_size());
+        split_key_on_disk_size_ = pb.on_disk_size();
+      }
+      if (!split_key_.empty()) {
+        pb.set_split_key(split_key_);
+      }
+    }
+
+    // The statistics of the columns only change along with the rowsets, in
+    // which case the size of the tablet or its number of rowsets changes too,
+    // marking the tablet dirty.
+    vector<ColumnStatsPB> column_stats;
+    s = tablet->GetColumnStats(&column_stats);
+    if (s.ok()) {
+      for (auto& stats : column_stats) {
+        *pb.add_column_stats() = std::move(stats);
+      }
+    } else {
+      KLOG_EVERY_N_SECS(WARNING, 60) << LogPrefix() << "failed to get the column statistics: "
+                                     << s.ToString();
+    }
+  }
 
   std::lock_guard<simple_spinlock> l(lock_);
   if (stats_pb_.on_disk_size() != pb.on_disk_size() ||
-      stats_pb_.live_row_count() != pb.live_row_count()) {
+      stats_pb_.live_row_count() != pb.live_row_count() ||
+      stats_pb_.num_rowsets() != pb.num_rowsets() ||
+      stats_pb_.split_key() != pb.split_key() ||
+      RateChangedSignificantly(stats_pb_.write_rate(), pb.write_rate()) ||
+      RateChangedSignificantly(stats_pb_.scan_rate(), pb.scan_rate())) {
     if (consensus::RaftPeerPB_Role_LEADER == role) {
       dirty_tablets->emplace_back(tablet_id());
     }
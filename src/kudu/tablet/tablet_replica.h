@@ -36,6 +36,7 @@
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/tablet/change_subscriptions.h"
 #include "kudu/tablet/metadata.pb.h"
 #include "kudu/tablet/op_order_verifier.h"
 #include "kudu/tablet/ops/op.h"
@@ -307,6 +308,11 @@ class TabletReplica : public RefCountedThreadSafe<TabletReplica>,
     return log_anchor_registry_;
   }
 
+  // The subscriptions to the changes of this replica, which anchor its log.
+  ChangeSubscriptions* change_subscriptions() const {
+    return change_subscriptions_.get();
+  }
+
   const std::string& tablet_id() const { return meta_->tablet_id(); }
 
   // Convenience method to return the permanent_uuid of this peer.
@@ -544,6 +550,7 @@ class TabletReplica : public RefCountedThreadSafe<TabletReplica>,
 
   const consensus::RaftPeerPB local_peer_pb_;
   scoped_refptr<log::LogAnchorRegistry> log_anchor_registry_; // Assigned in tablet_replica-test
+  const std::unique_ptr<ChangeSubscriptions> change_subscriptions_;
 
   // Pool that executes apply tasks for ops. This is a multi-threaded pool,
   // constructor-injected by either the Master (for system tables) or the
@@ -621,6 +628,18 @@ class TabletReplica : public RefCountedThreadSafe<TabletReplica>,
   // Cached stats for the tablet replica.
   ReportedTabletStatsPB stats_pb_;
 
+  // The counters of rows written and scans started at the last update of the
+  // stats, to measure their rates. Only accessed by UpdateTabletStats().
+  MonoTime last_stats_update_time_;
+  int64_t last_rows_mutated_ = 0;
+  int64_t last_scans_started_ = 0;
+
+  // The last key found to split the data of the tablet in two, and the
+  // on-disk size of the tablet when it was found. Only accessed by
+  // UpdateTabletStats().
+  std::string split_key_;
+  uint64_t split_key_on_disk_size_ = 0;
+
   // NOTE: it's important that this is the first member to be destructed. This
   // ensures we do not attempt to collect metrics while calling the destructor.
   FunctionGaugeDetacher metric_detacher_;
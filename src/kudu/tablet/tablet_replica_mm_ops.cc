@@ -18,12 +18,14 @@
 #include "kudu/tablet/tablet_replica_mm_ops.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -82,6 +84,17 @@ DEFINE_int32(flush_upper_bound_ms, 60 * 60 * 1000,
 TAG_FLAG(flush_upper_bound_ms, experimental);
 TAG_FLAG(flush_upper_bound_ms, runtime);
 
+DEFINE_int32(flush_threshold_txn_memrowsets, 64,
+             "Number of MemRowSets of committed transactions of a tablet at which "
+             "flushing the MemRowSets of the tablet is prioritized, regardless of "
+             "their size: every write checks the presence of its keys in all of "
+             "them, and every scan iterates over all of them, so many concurrent "
+             "small transactions would otherwise slow down the tablet until the "
+             "MemRowSets grow large or old enough to be flushed. If 0, the "
+             "number of MemRowSets isn't accounted for.");
+TAG_FLAG(flush_threshold_txn_memrowsets, experimental);
+TAG_FLAG(flush_threshold_txn_memrowsets, runtime);
+
 DECLARE_bool(enable_workload_score_for_perf_improvement_ops);
 
 METRIC_DEFINE_gauge_uint32(tablet, log_gc_running,
@@ -154,6 +167,10 @@ int32_t TabletReplicaOpBase::priority() const {
   return priority;
 }
 
+std::vector<std::string> TabletReplicaOpBase::DataDirs() const {
+  return tablet_replica_->tablet()->DataDirs();
+}
+
 //
 // FlushMRSOp.
 //
@@ -181,6 +198,9 @@ void FlushMRSOp::UpdateStats(MaintenanceOpStats* stats) {
   }
 
   stats->set_ram_anchored(tablet_replica_->tablet()->MemRowSetSize());
+  // The MRS is written out about as large as it is in memory.
+  stats->set_io_bytes(stats->ram_anchored());
+  stats->set_cpu_seconds(MeanDurationSeconds());
   stats->set_logs_retained_bytes(
       tablet_replica_->tablet()->MemRowSetLogReplaySize(replay_size_map));
 
@@ -193,6 +213,15 @@ void FlushMRSOp::UpdateStats(MaintenanceOpStats* stats) {
   FlushOpPerfImprovementPolicy::SetPerfImprovementForFlush(
       stats,
       time_since_flush_.elapsed().wall_millis());
+
+  // As with the size of the MRSs, consider the improvement to be 1 for every
+  // transactional MRS over the threshold (at least 1).
+  const int64_t threshold_txn_mrss = FLAGS_flush_threshold_txn_memrowsets;
+  const int64_t num_txn_mrss = tablet_replica_->tablet()->num_committed_txn_memrowsets();
+  if (threshold_txn_mrss > 0 && num_txn_mrss >= threshold_txn_mrss) {
+    stats->set_perf_improvement(std::max(
+        stats->perf_improvement(), std::max<double>(1.0, num_txn_mrss - threshold_txn_mrss)));
+  }
 }
 
 bool FlushMRSOp::Prepare() {
@@ -256,6 +285,8 @@ void FlushDeltaMemStoresOp::UpdateStats(MaintenanceOpStats* stats) {
                                                 &earliest_dms_time);
 
   stats->set_ram_anchored(dms_size);
+  stats->set_io_bytes(dms_size);
+  stats->set_cpu_seconds(MeanDurationSeconds());
   stats->set_runnable(true);
   stats->set_logs_retained_bytes(retention_size);
 
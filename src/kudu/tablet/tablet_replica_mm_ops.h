@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stringprintf.h"
@@ -50,6 +51,13 @@ class TabletReplicaOpBase : public MaintenanceOp {
  public:
   explicit TabletReplicaOpBase(std::string name, IOUsage io_usage, TabletReplica* tablet_replica);
 
+  std::vector<std::string> DataDirs() const override;
+
+  // Flushes and log GC release memory and WAL retention.
+  bool releases_memory() const override {
+    return true;
+  }
+
  protected:
   int32_t priority() const override;
 
@@ -63,11 +63,13 @@
 #include "kudu/tablet/tablet_metrics.h"
 #include "kudu/tablet/tablet_replica-test-base.h"
 #include "kudu/tablet/tablet_replica.h"
+#include "kudu/tablet/tablet_replica_mm_ops.h"
 #include "kudu/tablet/txn_metadata.h"
 #include "kudu/tablet/txn_participant-test-util.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/tserver/tserver_admin.pb.h"
 #include "kudu/util/countdown_latch.h"
+#include "kudu/util/maintenance_manager.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/pb_util.h"
@@ -94,6 +96,7 @@ using strings::Substitute;
 
 DECLARE_bool(enable_maintenance_manager);
 DECLARE_bool(enable_txn_partition_lock);
+DECLARE_int32(flush_threshold_txn_memrowsets);
 DECLARE_bool(log_preallocate_segments);
 DECLARE_bool(log_async_preallocate_segments);
 
@@ -1373,6 +1376,34 @@ TEST_F(TxnParticipantTest, TestLiveRowCountAccountsForTransactionalMRSs) {
   ASSERT_EQ(1, tablet_replica_->CountLiveRowsNoFail());
 }
 
+// Test that flushing the MRSs is prioritized once there are many transactional
+// MRSs, however small.
+TEST_F(TxnParticipantTest, TestFlushPrioritizedWithManyTransactionalMRSs) {
+  // Disable the partition lock as there are concurrent transactions.
+  FLAGS_enable_txn_partition_lock = false;
+  FLAGS_flush_threshold_txn_memrowsets = 5;
+  Tablet* tablet = tablet_replica_->tablet();
+  FlushMRSOp op(tablet_replica_.get());
+  for (int t = 0; t < FLAGS_flush_threshold_txn_memrowsets; t++) {
+    MaintenanceOpStats stats;
+    op.UpdateStats(&stats);
+    ASSERT_GT(1.0, stats.perf_improvement());
+
+    ASSERT_OK(CallParticipantOpCheckResp(t, ParticipantOpPB::BEGIN_TXN, kDummyCommitTimestamp));
+    ASSERT_OK(Write(t, t));
+    ASSERT_OK(CallParticipantOpCheckResp(t, ParticipantOpPB::BEGIN_COMMIT, kDummyCommitTimestamp));
+    ASSERT_OK(CallParticipantOpCheckResp(t, ParticipantOpPB::FINALIZE_COMMIT,
+                                         clock()->Now().value()));
+    ASSERT_EQ(t + 1, tablet->num_committed_txn_memrowsets());
+  }
+  MaintenanceOpStats stats;
+  op.UpdateStats(&stats);
+  ASSERT_LE(1.0, stats.perf_improvement());
+
+  ASSERT_OK(tablet->Flush());
+  ASSERT_EQ(0, tablet->num_committed_txn_memrowsets());
+}
+
 // Test that the MRS size metrics account for transactional MRSs.
 TEST_F(TxnParticipantTest, TestSizeAccountsForTransactionalMRS) {
   // Disable the partition lock as there are concurrent transactions.
@@ -1197,7 +1197,7 @@ TEST_F(CreateTableToolTest, TestCreateTable) {
                       "column_type": "INT32",
                       "is_nullable": false,
                       "default_value": "1",
-                      "encoding": 4
+                      "encoding": 2
                   },
                   {
                       "column_name": "name",
@@ -1222,7 +1222,7 @@ TEST_F(CreateTableToolTest, TestCreateTable) {
           }
       }
   )";
-  err = "encoding DICT_ENCODING not supported for type INT32";
+  err = "encoding PREFIX_ENCODING not supported for type INT32";
   NO_FATALS(check_bad_input(encoding_type_conflict, master_addr, err));
 
   // Create a table with encoding type errors,
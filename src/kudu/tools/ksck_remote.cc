@@ -75,6 +75,11 @@ DECLARE_int32(fetch_info_concurrency);
 DECLARE_int64(timeout_ms); // defined in tool_action_common
 
 DEFINE_bool(checksum_cache_blocks, false, "Should the checksum scanners cache the read blocks.");
+DEFINE_bool(checksum_use_rowset_checksums, true,
+            "Whether the checksum scans may use the checksums of the rowsets "
+            "the tablet servers computed when writing them, rather than reading "
+            "the rowsets which weren't mutated since. The resulting checksums "
+            "are the same; disable this to read all the data of the replicas.");
 DEFINE_bool(quiescing_info, true,
             "Whether to display the quiescing-related information of each tablet server, "
             "e.g. number of tablet leaders per server, the number of active scanners "
@@ -449,6 +454,7 @@ class ChecksumStepper {
         req_.mutable_new_request()->mutable_projected_columns()->CopyFrom(cols_);
         req_.mutable_new_request()->set_tablet_id(tablet_id_);
         req_.mutable_new_request()->set_cache_blocks(FLAGS_checksum_cache_blocks);
+        req_.set_use_known_rowset_checksums(FLAGS_checksum_use_rowset_checksums);
         if (options_.use_snapshot) {
           req_.mutable_new_request()->set_read_mode(READ_AT_SNAPSHOT);
           req_.mutable_new_request()->set_snap_timestamp(options_.snapshot_timestamp);
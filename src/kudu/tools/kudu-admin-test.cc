@@ -3687,6 +3687,109 @@ TEST_F(AdminCliTest, AddAndDropRangeWithCustomHashSchema) {
   });
 }
 
+TEST_F(AdminCliTest, RebucketRangePartition) {
+  FLAGS_num_tablet_servers = 1;
+  FLAGS_num_replicas = 1;
+
+  NO_FATALS(BuildAndStart());
+
+  const string& master_addr = cluster_->master()->bound_rpc_addr().ToString();
+  constexpr const char* const kTestTableName = "rebucketed";
+  constexpr const char* const kC0 = "c0";
+  constexpr const char* const kC1 = "c1";
+  constexpr const char* const kC2 = "c2";
+
+  // Create a table with the ranges [0, 1) and [1, 2), hashed into 2 buckets.
+  {
+    KuduSchemaBuilder builder;
+    builder.AddColumn(kC0)->Type(KuduColumnSchema::INT8)->NotNull();
+    builder.AddColumn(kC1)->Type(KuduColumnSchema::INT16)->NotNull();
+    builder.AddColumn(kC2)->Type(KuduColumnSchema::STRING);
+    builder.SetPrimaryKey({ kC0, kC1 });
+    KuduSchema schema;
+    ASSERT_OK(builder.Build(&schema));
+
+    unique_ptr<KuduTableCreator> table_creator(client_->NewTableCreator());
+    table_creator->table_name(kTestTableName)
+        .schema(&schema)
+        .set_range_partition_columns({ kC0 })
+        .add_hash_partitions({ kC1 }, 2)
+        .num_replicas(FLAGS_num_replicas);
+    for (int8_t i = 0; i < 2; i++) {
+      unique_ptr<KuduPartialRow> l(schema.NewRow());
+      unique_ptr<KuduPartialRow> u(schema.NewRow());
+      ASSERT_OK(l->SetInt8(kC0, i));
+      ASSERT_OK(u->SetInt8(kC0, i + 1));
+      table_creator->add_range_partition(l.release(), u.release());
+    }
+    ASSERT_OK(table_creator->Create());
+  }
+
+  // Insert 10 rows into each range.
+  client::sp::shared_ptr<KuduTable> table;
+  ASSERT_OK(client_->OpenTable(kTestTableName, &table));
+  {
+    auto session = client_->NewSession();
+    for (int8_t c0 = 0; c0 < 2; c0++) {
+      for (int16_t c1 = 0; c1 < 10; c1++) {
+        unique_ptr<KuduInsert> insert(table->NewInsert());
+        auto* row = insert->mutable_row();
+        ASSERT_OK(row->SetInt8(kC0, c0));
+        ASSERT_OK(row->SetInt16(kC1, c1));
+        ASSERT_OK(row->SetString(kC2, Substitute("$0-$1", c0, c1)));
+        ASSERT_OK(session->Apply(insert.release()));
+      }
+    }
+    ASSERT_OK(session->Flush());
+  }
+
+  string stdout;
+  string stderr;
+  {
+    // There's no such range.
+    const auto s = RunKuduTool({
+      "table",
+      "rebucket_range_partition",
+      master_addr,
+      kTestTableName,
+      "[0]",
+      "[2]",
+      R"(--hash_schema={ "hash_schema": [ { "columns": ["c1"], "num_buckets": 5 } ] })",
+    }, &stdout, &stderr);
+    ASSERT_TRUE(s.IsRuntimeError()) << ToolRunInfo(s, stdout, stderr);
+    ASSERT_STR_CONTAINS(stderr, "has no range partition");
+  }
+  {
+    const auto s = RunKuduTool({
+      "table",
+      "rebucket_range_partition",
+      master_addr,
+      kTestTableName,
+      "[0]",
+      "[1]",
+      R"(--hash_schema={ "hash_schema": [ { "columns": ["c1"], "num_buckets": 5 } ] })",
+    }, &stdout, &stderr);
+    ASSERT_TRUE(s.ok()) << ToolRunInfo(s, stdout, stderr);
+  }
+  {
+    const auto s = RunKuduTool({
+      "table",
+      "describe",
+      master_addr,
+      kTestTableName,
+    }, &stdout, &stderr);
+    ASSERT_TRUE(s.ok()) << ToolRunInfo(s, stdout, stderr);
+    ASSERT_STR_CONTAINS(stdout, "PARTITION 0 <= VALUES < 1 HASH(c1) PARTITIONS 5");
+  }
+
+  // The rows of both ranges are still there, and the staging table is gone.
+  ASSERT_OK(client_->OpenTable(kTestTableName, &table));
+  ASSERT_EQ(20, CountTableRows(table.get()));
+  client::sp::shared_ptr<KuduTable> staging_table;
+  ASSERT_TRUE(client_->OpenTable(Substitute("$0__rebucket", kTestTableName),
+                                 &staging_table).IsNotFound());
+}
+
 namespace {
 constexpr const char* kPrincipal = "oryx";
 
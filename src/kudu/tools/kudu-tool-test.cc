@@ -539,6 +539,7 @@ class ToolTest : public KuduTest {
     TableCopyMode mode;
     int32_t create_table_replication_factor;
     string create_table_hash_bucket_nums;
+    string extra_flags;
   };
 
   void RunCopyTableCheck(const RunCopyTableCheckArgs& args) {
@@ -615,7 +616,7 @@ class ToolTest : public KuduTest {
     Status s = RunActionStdoutStderrString(
                 Substitute("table copy $0 $1 $2 -dst_table=$3 -predicates=$4 -write_type=$5 "
                            "-create_table=$6 -create_table_replication_factor=$7 "
-                           "-create_table_hash_bucket_nums=$8",
+                           "-create_table_hash_bucket_nums=$8 $9",
                            cluster_->master()->bound_rpc_addr().ToString(),
                            args.src_table_name,
                            cluster_->master()->bound_rpc_addr().ToString(),
@@ -624,7 +625,8 @@ class ToolTest : public KuduTest {
                            write_type,
                            create_table,
                            args.create_table_replication_factor,
-                           args.create_table_hash_bucket_nums),
+                           args.create_table_hash_bucket_nums,
+                           args.extra_flags),
                 &stdout, &stderr);
     if (args.create_table_hash_bucket_nums == "10,aa") {
       ASSERT_STR_CONTAINS(stderr, "cannot parse the number of hash buckets.");
@@ -862,7 +864,8 @@ enum RunCopyTableCheckArgsType {
   kTestCopyUnpartitionedTable,
   kTestCopyTablePredicates,
   kTestCopyTableWithStringBounds,
-  kTestCopyTableAutoIncrementingColumn
+  kTestCopyTableAutoIncrementingColumn,
+  kTestCopyTableSplitTokens
 };
 // Subclass of ToolTest that allows running individual test cases with different parameters to run
 // 'kudu table copy' CLI tool.
@@ -940,6 +943,13 @@ class ToolTestCopyTableParameterized :
         args.mode = TableCopyMode::INSERT_TO_NEW_TABLE;
         args.columns = kAutoIncrementingSchemaColumns;
         return { args };
+      case kTestCopyTableSplitTokens:
+        // Split the tablets into several ranges scanned by more threads than
+        // tablets, writing through small session buffers.
+        args.mode = TableCopyMode::INSERT_TO_NEW_TABLE;
+        args.extra_flags = "-split_size_bytes=1024 -num_threads=8 "
+                           "-write_buffer_space_bytes=4096";
+        return { args };
       case kTestCopyTableInsertIgnore:
         args.mode = TableCopyMode::INSERT_IGNORE_TO_EXISTING_TABLE;
         return { args };
@@ -1263,7 +1273,8 @@ INSTANTIATE_TEST_SUITE_P(CopyTableParameterized,
                                            kTestCopyUnpartitionedTable,
                                            kTestCopyTablePredicates,
                                            kTestCopyTableWithStringBounds,
-                                           kTestCopyTableAutoIncrementingColumn));
+                                           kTestCopyTableAutoIncrementingColumn,
+                                           kTestCopyTableSplitTokens));
 
 void ToolTest::StartExternalMiniCluster(ExternalMiniClusterOptions opts) {
   cluster_.reset(new ExternalMiniCluster(std::move(opts)));
@@ -1403,6 +1414,7 @@ TEST_F(ToolTest, TestModeHelp) {
     const vector<string> kLocalReplicaModeRegexes = {
         "cmeta.*Operate on a local tablet replica's consensus",
         "tmeta.*Edit a local tablet metadata",
+        "compact.*Compact tablet replicas in the local filesystem",
         "data_size.*Summarize the data size",
         "dump.*Dump a Kudu filesystem",
         "copy_from_remote.*Copy tablet replicas from a remote server",
@@ -1510,8 +1522,10 @@ TEST_F(ToolTest, TestModeHelp) {
     const string kCmd = "perf";
     const vector<string> kPerfRegexes = {
         "loadgen.*Run load generation with optional scan afterwards",
+        "replay.*Replay the write and scan requests captured by tablet servers",
         "table_scan.*Show row count and scanning time cost of tablets in a table",
         "tablet_scan.*Show row count of a local tablet",
+        "ycsb.*Run a YCSB workload of point reads, updates, inserts and scans",
     };
     NO_FATALS(RunTestHelp(kCmd, kPerfRegexes));
     NO_FATALS(RunTestHelpRpcFlags(kCmd, {"loadgen", "table_scan"}));
@@ -1559,6 +1573,7 @@ TEST_F(ToolTest, TestModeHelp) {
         "list_in_flight.*List tables in flight",
         "locate_row.*Locate which tablet a row belongs to",
         "recall.*Recall a deleted but still reserved table",
+        "rebucket_range_partition.*Change the hash schema of a range partition of a table",
         "rename_column.*Rename a column",
         "rename_table.*Rename a table",
         "scan.*Scan rows from a table",
@@ -3422,7 +3437,7 @@ TEST_F(ToolTest, TestLocalReplicaOps) {
                 Substitute("KuduTableTest,$0,$1,column,key,BIT_SHUFFLE,10",
                            kTestTablet, rowset_idx));
       EXPECT_EQ(stdout[rowset_idx * 5 + 1],
-                Substitute("KuduTableTest,$0,$1,column,int_val,BIT_SHUFFLE,10",
+                Substitute("KuduTableTest,$0,$1,column,int_val,DICT_ENCODING,10",
                            kTestTablet, rowset_idx));
       EXPECT_EQ(stdout[rowset_idx * 5 + 2],
                 Substitute("KuduTableTest,$0,$1,column,string_val,DICT_ENCODING,10",
@@ -4055,6 +4070,55 @@ TEST_F(ToolTest, TestNonRandomWorkloadLoadgen) {
   ASSERT_EQ(0, bloom_lookups);
 }
 
+TEST_F(ToolTest, TestPerfReplay) {
+  const string kCapturePath = GetTestPath("capture");
+  {
+    ExternalMiniClusterOptions opts;
+    opts.extra_tserver_flags = {
+      Substitute("--request_capture_path=$0", kCapturePath),
+      "--request_capture_sampling_rate=1",
+    };
+    NO_FATALS(StartExternalMiniCluster(std::move(opts)));
+  }
+  ASSERT_OK(RunKuduTool({
+    "perf", "loadgen",
+    cluster_->master()->bound_rpc_addr().ToString(),
+    "--keep_auto_table",
+    "--num_rows_per_thread=100",
+    "--run_scan",
+  }));
+  ASSERT_OK(cluster_->SetFlag(cluster_->tablet_server(0), "request_capture_path", ""));
+
+  // The rows replayed by the writes were all inserted already.
+  string out;
+  string err;
+  Status s = RunTool(Substitute("perf replay $0 $1 --replay_speed=0 --format=csv",
+                                cluster_->master()->bound_rpc_addr().ToString(), kCapturePath),
+                     &out, &err);
+  ASSERT_TRUE(s.ok()) << s.ToString() << ": " << err;
+  ASSERT_STR_MATCHES(out, "Replayed [1-9][0-9]* requests");
+  ASSERT_STR_MATCHES(out, "write,[1-9][0-9]*,0,[1-9][0-9]*,");
+  ASSERT_STR_MATCHES(out, "scan,[1-9][0-9]*,0,0,");
+}
+
+TEST_F(ToolTest, TestPerfYcsb) {
+  NO_FATALS(StartExternalMiniCluster());
+  for (const auto& workload : { "A", "D", "E", "F" }) {
+    SCOPED_TRACE(workload);
+    string out;
+    string err;
+    Status s = RunTool(Substitute("perf ycsb $0 --ycsb_workload=$1 --ycsb_record_count=500 "
+                                  "--ycsb_operation_count=500 --format=csv",
+                                  cluster_->master()->bound_rpc_addr().ToString(), workload),
+                       &out, &err);
+    ASSERT_TRUE(s.ok()) << s.ToString() << ": " << err;
+    ASSERT_STR_CONTAINS(out, "Loaded 500 records");
+    ASSERT_STR_MATCHES(out, Substitute("Ran 500 operations of workload $0", workload));
+    // None of the operations failed.
+    ASSERT_STR_NOT_MATCHES(out, "\n[a-z-]+,[0-9]+,[1-9]");
+  }
+}
+
 TEST_F(ToolTest, TestPerfTableScan) {
   constexpr const char* const kTableName = "perf.table_scan";
   NO_FATALS(RunLoadgen(1, { "--run_scan" }, kTableName));
@@ -9703,6 +9767,66 @@ TEST_F(ToolTest, TestLocalReplicaTmeta) {
   });
 }
 
+TEST_F(ToolTest, TestLocalReplicaCompact) {
+  constexpr const char* const kTableName = "kudu.local_replica.compact";
+  const int kNumTablets = 4;
+
+  // Flush often, so that the tablets have several rowsets to merge, yet keep
+  // rows of the last seconds of the workload in the WALs only.
+  FLAGS_flush_threshold_mb = 1;
+  FLAGS_flush_threshold_secs = 1;
+  NO_FATALS(StartMiniCluster());
+
+  TestWorkload workload(mini_cluster_.get());
+  workload.set_num_tablets(kNumTablets);
+  workload.set_num_replicas(1);
+  workload.set_table_name(kTableName);
+  workload.Setup();
+  workload.Start();
+  SleepFor(MonoDelta::FromSeconds(3));
+  workload.StopAndJoin();
+  const int64_t total_row_count = workload.rows_inserted();
+
+  MiniTabletServer* ts = mini_cluster_->mini_tablet_server(0);
+  string encryption_args;
+  if (env_->IsEncryptionEnabled()) {
+    encryption_args = GetEncryptionArgs() + " --instance_file=" +
+        JoinPathSegments(ts->options()->fs_opts.wal_root, "instance");
+  }
+  const string& flags = Substitute("-fs_wal_dir=$0 --fs_data_dirs=$1 $2",
+                                   ts->options()->fs_opts.wal_root,
+                                   JoinStrings(ts->options()->fs_opts.data_roots, ","),
+                                   encryption_args);
+  vector<string> tablet_ids;
+  NO_FATALS(RunActionStdoutLines(Substitute("local_replica list $0", flags), &tablet_ids));
+  ASSERT_EQ(kNumTablets, tablet_ids.size());
+  const string metadata_path = ts->server()->fs_manager()->GetTabletMetadataDir();
+
+  // The tablet server must be shut down first.
+  string stderr;
+  Status s = RunActionStderrString(Substitute("local_replica compact * $0", flags), &stderr);
+  ASSERT_TRUE(s.IsRuntimeError()) << s.ToString();
+  mini_cluster_->Shutdown();
+
+  ASSERT_OK(RunActionStderrString(
+      Substitute("local_replica compact * $0 --num_threads=$1", flags, kNumTablets),
+      &stderr));
+  ASSERT_STR_CONTAINS(stderr, Substitute("compacted $0 tablet replicas", kNumTablets));
+
+  // Each tablet is left with a single rowset, holding the rows of the WAL too.
+  for (const auto& tablet_id : tablet_ids) {
+    set<int64_t> rowset_ids;
+    ASSERT_OK(ListTabletRowsetIds(metadata_path, tablet_id, encryption_args, &rowset_ids));
+    ASSERT_GE(1, rowset_ids.size()) << tablet_id;
+  }
+
+  ASSERT_OK(mini_cluster_->Start());
+  ASSERT_EVENTUALLY([&] {
+    ClusterVerifier v(mini_cluster_.get());
+    NO_FATALS(v.CheckRowCount(kTableName, ClusterVerifier::EXACTLY, total_row_count));
+  });
+}
+
 class SetFlagForAllTest :
     public ToolTest,
     public ::testing::WithParamInterface<bool> {
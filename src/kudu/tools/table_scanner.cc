@@ -25,11 +25,11 @@
 #include <iomanip>
 #include <iostream>
 #include <iterator>
-#include <map>
 #include <memory>
 #include <optional>
 #include <set>
 #include <type_traits>
+#include <utility>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -79,7 +79,6 @@ using kudu::client::KuduWriteOperation;
 using kudu::iequals;
 using std::endl;
 using std::function;
-using std::map;
 using std::nullopt;
 using std::optional;
 using std::ostream;
@@ -137,8 +136,22 @@ DEFINE_string(write_type, "insert",
               "creating the destination table without copying the data.");
 DEFINE_string(replica_selection, "CLOSEST",
               "Replica selection for scan operations. Acceptable values are: "
-              "CLOSEST, LEADER (maps into KuduClient::CLOSEST_REPLICA and "
-              "KuduClient::LEADER_ONLY correspondingly).");
+              "CLOSEST, LEADER, LEAST_LOADED (maps into "
+              "KuduClient::CLOSEST_REPLICA, KuduClient::LEADER_ONLY and "
+              "KuduClient::LEAST_LOADED_REPLICA correspondingly).");
+DEFINE_int64(split_size_bytes, 0,
+             "If positive, the scan of every tablet is split into ranges of "
+             "about this many bytes of on-disk data, so that the rows of large "
+             "tablets are scanned by several threads. In any case, the threads "
+             "pick up the next tablet or range to scan as they become idle; "
+             "with this flag set, the ranges estimated to be the largest are "
+             "scanned first.");
+DEFINE_int32(write_buffer_space_bytes, 32 * 1024 * 1024,
+             "Size of the buffer of the session each thread writes the rows "
+             "to the destination table through, in bytes. The rows are flushed "
+             "in the background as the buffer fills up, and scanning stalls "
+             "while the buffer is full, so that the source table is never "
+             "scanned faster than the destination table is written to.");
 
 DECLARE_bool(row_count_only);
 DECLARE_int32(num_threads);
@@ -188,6 +201,7 @@ bool ValidateWriteType(const char* flag_name,
 constexpr const char* const kReplicaSelectionClosest = "closest";
 constexpr const char* const kReplicaSelectionFirst = "first";
 constexpr const char* const kReplicaSelectionLeader = "leader";
+constexpr const char* const kReplicaSelectionLeastLoaded = "least_loaded";
 
 bool ValidateReplicaSelection(const char* flag_name,
                               const string& flag_value) {
@@ -195,6 +209,7 @@ bool ValidateReplicaSelection(const char* flag_name,
     kReplicaSelectionClosest,
     kReplicaSelectionFirst,
     kReplicaSelectionLeader,
+    kReplicaSelectionLeastLoaded,
   };
   return IsFlagValueAcceptable(flag_name, flag_value, kReplicaSelections);
 }
@@ -203,6 +218,20 @@ bool ValidateReplicaSelection(const char* flag_name,
 
 DEFINE_validator(write_type, &ValidateWriteType);
 DEFINE_validator(replica_selection, &ValidateReplicaSelection);
+DEFINE_validator(split_size_bytes, [](const char* flag_name, int64_t value) {
+  if (value < 0) {
+    LOG(ERROR) << Substitute("--$0 must not be negative", flag_name);
+    return false;
+  }
+  return true;
+});
+DEFINE_validator(write_buffer_space_bytes, [](const char* flag_name, int32_t value) {
+  if (value <= 0) {
+    LOG(ERROR) << Substitute("--$0 must be positive", flag_name);
+    return false;
+  }
+  return true;
+});
 
 namespace kudu {
 namespace tools {
@@ -564,6 +593,7 @@ TableScanner::TableScanner(
     optional<client::sp::shared_ptr<client::KuduClient>> dst_client,
     optional<std::string> dst_table_name)
     : total_count_(0),
+      next_token_idx_(0),
       client_(std::move(client)),
       table_name_(std::move(table_name)),
       dst_client_(std::move(dst_client)),
@@ -574,8 +604,13 @@ TableScanner::TableScanner(
 }
 
 Status TableScanner::ScanData(const vector<KuduScanToken*>& tokens,
-                              const function<Status(const KuduScanBatch& batch)>& cb) {
-  for (const auto* token : tokens) {
+                              const function<Status(const KuduScanBatch& batch)>& cb,
+                              const function<Status()>& token_done_cb) {
+  // The tokens are shared by all the threads: each one picks up the next
+  // token once done with the previous one, so that the threads scanning the
+  // smaller tablets don't stay idle while the others scan the larger ones.
+  for (size_t idx = next_token_idx_++; idx < tokens.size(); idx = next_token_idx_++) {
+    const auto* token = tokens[idx];
     Stopwatch sw(Stopwatch::THIS_THREAD);
     sw.start();
 
@@ -595,6 +630,9 @@ Status TableScanner::ScanData(const vector<KuduScanToken*>& tokens,
       ++next_batch_calls;
       RETURN_NOT_OK(cb(batch));
     }
+    if (token_done_cb) {
+      RETURN_NOT_OK(token_done_cb());
+    }
     sw.stop();
 
     if (FLAGS_report_scanner_stats && out_) {
@@ -639,7 +677,9 @@ void TableScanner::CopyTask(const vector<KuduScanToken*>& tokens, Status* thread
   DCHECK(thread_status);
   KuduWriteOperation::Type op_type;
   const auto& op_type_str = FLAGS_write_type;
-  if (op_type_str == kWriteTypeInsert) {
+  if (write_type_) {
+    op_type = *write_type_;
+  } else if (op_type_str == kWriteTypeInsert) {
     op_type = KuduWriteOperation::INSERT;
   } else if (op_type_str == kWriteTypeInsertIgnore) {
     op_type = KuduWriteOperation::INSERT_IGNORE;
@@ -660,22 +700,28 @@ void TableScanner::CopyTask(const vector<KuduScanToken*>& tokens, Status* thread
   client::sp::shared_ptr<KuduSession> session((*dst_client_)->NewSession());
   TASK_RET_NOT_OK(session->SetFlushMode(KuduSession::AUTO_FLUSH_BACKGROUND));
   TASK_RET_NOT_OK(session->SetErrorBufferSpace(1024 * 1024));
+  TASK_RET_NOT_OK(session->SetMutationBufferSpace(FLAGS_write_buffer_space_bytes));
   session->SetTimeoutMillis(FLAGS_timeout_ms);
 
-  // The callback's lambda of ScanData() keeps references to the session and
-  // the destination table objects, making sure they are alive when the callback
-  // is invoked.
+  // The rows of a batch are written in the background while the next batch
+  // is scanned: Apply() only blocks once the buffer of the session is full.
+  // The callbacks' lambdas of ScanData() keep references to the session and
+  // the destination table objects, making sure they are alive when the
+  // callbacks are invoked.
+  auto* s_ptr = session.get();
   *thread_status = ScanData(tokens, [table = std::move(dst_table),
-                                     session = std::move(session),
+                                     s_ptr,
                                      op_type] (const KuduScanBatch& batch) {
-    auto* s_ptr = session.get();
     auto* t_ptr = table.get();
     for (const auto& row : batch) {
       RETURN_NOT_OK(AddRow(s_ptr, t_ptr, row, op_type));
     }
-    // Flush the session to make sure all write operations have been sent
-    // to the server. If any error happens, CheckPendingErrors() will report
-    // on them.
+    return Status::OK();
+  }, [session = std::move(session)]() {
+    // Flush the session once a token is scanned to make sure all write
+    // operations have been sent to the server. If any error happens,
+    // CheckPendingErrors() will report on them.
+    auto* s_ptr = session.get();
     auto s = s_ptr->Flush();
     CheckPendingErrors(s_ptr);
     return s;
@@ -703,6 +749,14 @@ void TableScanner::SetScanBatchSize(int32_t scan_batch_size) {
   scan_batch_size_ = scan_batch_size;
 }
 
+void TableScanner::SetTabletIds(set<string> tablet_ids) {
+  tablet_ids_ = std::move(tablet_ids);
+}
+
+void TableScanner::SetWriteType(KuduWriteOperation::Type write_type) {
+  write_type_ = write_type;
+}
+
 Status TableScanner::StartWork(WorkType work_type) {
   client::sp::shared_ptr<KuduTable> src_table;
   RETURN_NOT_OK(client_->OpenTable(table_name_, &src_table));
@@ -710,7 +764,7 @@ Status TableScanner::StartWork(WorkType work_type) {
   // Create destination table if needed.
   if (work_type == WorkType::kCopy) {
     RETURN_NOT_OK(CreateDstTableIfNeeded(src_table, *dst_client_, *dst_table_name_));
-    if (FLAGS_write_type.empty()) {
+    if (!write_type_ && FLAGS_write_type.empty()) {
       // Create table only.
       return Status::OK();
     }
@@ -774,6 +828,10 @@ Status TableScanner::StartWork(WorkType work_type) {
   // Set predicates.
   RETURN_NOT_OK(AddPredicates(src_table, &builder));
 
+  if (FLAGS_split_size_bytes > 0) {
+    builder.SetSplitSizeBytes(FLAGS_split_size_bytes);
+  }
+
   vector<KuduScanToken*> tokens;
   ElementDeleter deleter(&tokens);
   RETURN_NOT_OK(builder.Build(&tokens));
@@ -781,14 +839,24 @@ Status TableScanner::StartWork(WorkType work_type) {
   const int num_threads = FLAGS_num_threads;
 
   // Set tablet filter.
-  const set<string>& tablet_id_filters = Split(FLAGS_tablets, ",", strings::SkipWhitespace());
-  map<int, vector<KuduScanToken*>> thread_tokens;
-  int i = 0;
+  const set<string>& tablet_id_filters =
+      tablet_ids_ ? *tablet_ids_ : Split(FLAGS_tablets, ",", strings::SkipWhitespace());
+  vector<KuduScanToken*> filtered_tokens;
   for (auto* token : tokens) {
     if (tablet_id_filters.empty() || ContainsKey(tablet_id_filters, token->tablet().id())) {
-      thread_tokens[i++ % num_threads].emplace_back(token);
+      filtered_tokens.emplace_back(token);
     }
   }
+  if (FLAGS_split_size_bytes > 0) {
+    // Scan the largest ranges first, so that no thread is left scanning a
+    // large range once the others are done. The ranges with no estimate
+    // (i.e. -1) are scanned last.
+    std::stable_sort(filtered_tokens.begin(), filtered_tokens.end(),
+                     [](const KuduScanToken* a, const KuduScanToken* b) {
+                       return a->EstimatedOnDiskSize() > b->EstimatedOnDiskSize();
+                     });
+  }
+  next_token_idx_ = 0;
 
   RETURN_NOT_OK(ThreadPoolBuilder("table_scan_pool")
                   .set_max_threads(num_threads)
@@ -800,8 +868,8 @@ Status TableScanner::StartWork(WorkType work_type) {
 
   Stopwatch sw(Stopwatch::THIS_THREAD);
   sw.start();
-  for (i = 0; i < num_threads; ++i) {
-    auto* t_tokens = &thread_tokens[i];
+  const auto* t_tokens = &filtered_tokens;
+  for (int i = 0; i < num_threads; ++i) {
     auto* t_status = &thread_statuses[i];
     if (work_type == WorkType::kScan) {
       RETURN_NOT_OK(thread_pool_->Submit([this, t_tokens, t_status]()
@@ -911,6 +979,8 @@ Status TableScanner::ParseReplicaSelection(
     *selection = KuduClient::ReplicaSelection::LEADER_ONLY;
   } else if (iequals(kReplicaSelectionFirst, selection_str)) {
     *selection = KuduClient::ReplicaSelection::FIRST_REPLICA;
+  } else if (iequals(kReplicaSelectionLeastLoaded, selection_str)) {
+    *selection = KuduClient::ReplicaSelection::LEAST_LOADED_REPLICA;
   } else {
     return Status::InvalidArgument("invalid replica selection", selection_str);
   }
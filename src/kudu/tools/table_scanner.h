@@ -18,11 +18,13 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -61,6 +63,14 @@ class TableScanner {
   // --scanner_default_batch_size_bytes flag.
   void SetScanBatchSize(int32_t scan_batch_size);
 
+  // Restrict the scan to the tablets with the given ids, instead of those of
+  // the --tablets flag.
+  void SetTabletIds(std::set<std::string> tablet_ids);
+
+  // Set the type of the write operations of a copy, instead of the one of the
+  // --write_type flag.
+  void SetWriteType(client::KuduWriteOperation::Type write_type);
+
   Status StartScan();
   Status StartCopy();
 
@@ -86,14 +96,21 @@ class TableScanner {
       client::KuduClient::ReplicaSelection* selection);
 
   Status StartWork(WorkType work_type);
+
+  // Scan the tokens not picked up by other threads yet, one at a time,
+  // calling 'cb' on every batch of rows and 'token_done_cb', unless empty,
+  // once all the rows of a token are scanned.
   Status ScanData(const std::vector<client::KuduScanToken*>& tokens,
-                  const std::function<Status(const client::KuduScanBatch& batch)>& cb);
+                  const std::function<Status(const client::KuduScanBatch& batch)>& cb,
+                  const std::function<Status()>& token_done_cb = nullptr);
   void ScanTask(const std::vector<client::KuduScanToken*>& tokens,
                 Status* thread_status);
   void CopyTask(const std::vector<client::KuduScanToken*>& tokens,
                 Status* thread_status);
 
   std::atomic<uint64_t> total_count_;
+  // The index of the next token to scan.
+  std::atomic<size_t> next_token_idx_;
   std::optional<client::KuduScanner::ReadMode> mode_;
   client::sp::shared_ptr<client::KuduClient> client_;
   std::string table_name_;
@@ -101,6 +118,8 @@ class TableScanner {
   std::optional<client::sp::shared_ptr<client::KuduClient>> dst_client_;
   std::optional<std::string> dst_table_name_;
   int32_t scan_batch_size_;
+  std::optional<std::set<std::string>> tablet_ids_;
+  std::optional<client::KuduWriteOperation::Type> write_type_;
   std::unique_ptr<ThreadPool> thread_pool_;
 
   // Protects output to 'out_' so that rows don't get interleaved.
@@ -414,6 +414,7 @@ unique_ptr<Mode> BuildClusterMode() {
         .AddOptionalParameter("checksum_scan_concurrency")
         .AddOptionalParameter("checksum_snapshot")
         .AddOptionalParameter("checksum_timeout_sec")
+        .AddOptionalParameter("checksum_use_rowset_checksums")
         .AddOptionalParameter("color")
         .AddOptionalParameter("consensus")
         .AddOptionalParameter("fetch_info_concurrency")
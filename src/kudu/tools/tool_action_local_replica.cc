@@ -36,16 +36,19 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/clock/logical_clock.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/partition.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/rowblock_memory.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/timestamp.h"
 #include "kudu/common/wire_protocol.h"
 #include "kudu/consensus/consensus.pb.h"
 #include "kudu/consensus/consensus_meta.h"
 #include "kudu/consensus/consensus_meta_manager.h"
+#include "kudu/consensus/log.h"
 #include "kudu/consensus/log.pb.h"
 #include "kudu/consensus/log_anchor_registry.h"
 #include "kudu/consensus/log_index.h"
@@ -53,6 +56,7 @@
 #include "kudu/consensus/log_util.h"
 #include "kudu/consensus/metadata.pb.h"
 #include "kudu/consensus/opid.pb.h"
+#include "kudu/consensus/raft_consensus.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/data_dirs.h"
@@ -75,6 +79,8 @@
 #include "kudu/tablet/metadata.pb.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"
+#include "kudu/tablet/tablet.h"
+#include "kudu/tablet/tablet_bootstrap.h"
 #include "kudu/tablet/tablet_mem_trackers.h"
 #include "kudu/tablet/tablet_metadata.h"
 #include "kudu/tablet/tablet_replica.h"
@@ -131,6 +137,10 @@ DEFINE_bool(ignore_nonexistent, false,
             "Whether to ignore non-existent tablet replicas when deleting: if "
             "set to 'true', the tool does not report an error if the requested "
             "tablet replica to remove is not found");
+DEFINE_bool(compact_all_rowsets, true,
+            "Whether to merge all the rowsets of each local replica into a new "
+            "set of non-overlapping rowsets when compacting it. If false, only "
+            "the major delta compactions of the rowsets are run.");
 DEFINE_string(src_fs_wal_dir, "",
               "Source: Directory with write-ahead logs.");
 DEFINE_string(src_fs_data_dirs, "",
@@ -161,6 +171,8 @@ DECLARE_bool(tablet_copy_support_download_superblock_in_batch);
 DECLARE_int32(tablet_copy_download_threads_nums_per_session);
 DECLARE_string(tables);
 
+using kudu::clock::LogicalClock;
+using kudu::consensus::ConsensusBootstrapInfo;
 using kudu::consensus::ConsensusMetadata;
 using kudu::consensus::ConsensusMetadataManager;
 using kudu::consensus::OpId;
@@ -168,6 +180,8 @@ using kudu::consensus::RaftConfigPB;
 using kudu::consensus::RaftPeerPB;
 using kudu::fs::IOContext;
 using kudu::fs::ReadableBlock;
+using kudu::log::Log;
+using kudu::log::LogAnchorRegistry;
 using kudu::log::LogEntryPB;
 using kudu::log::LogEntryReader;
 using kudu::log::LogReader;
@@ -176,8 +190,10 @@ using kudu::log::SegmentSequence;
 using kudu::rpc::Messenger;
 using kudu::tablet::DiskRowSet;
 using kudu::tablet::RowIteratorOptions;
+using kudu::tablet::RowSet;
 using kudu::tablet::RowSetMetadata;
 using kudu::tablet::RowSetMetadataIds;
+using kudu::tablet::Tablet;
 using kudu::tablet::TabletDataState;
 using kudu::tablet::TabletMetadata;
 using kudu::tablet::TabletReplica;
@@ -820,6 +836,133 @@ Status DeleteLocalReplicas(const RunnerContext& context) {
   return Status::OK();
 }
 
+// Compacts the local replica of the tablet 'tablet_id' as the maintenance
+// manager of a tablet server would, but all at once: the replica is
+// bootstrapped first, so that the operations in its WAL which haven't been
+// flushed yet are replayed into its memory stores rather than considered
+// flushed once the rowsets they mutated are compacted away. The memory stores
+// are then flushed, the rowsets merged, and the deltas of the rowsets left
+// major compacted.
+Status CompactLocalReplica(const string& tablet_id,
+                           FsManager* fs_manager,
+                           const scoped_refptr<ConsensusMetadataManager>& cmeta_manager) {
+  scoped_refptr<TabletMetadata> tmeta;
+  RETURN_NOT_OK(TabletMetadata::Load(fs_manager, tablet_id, &tmeta));
+  if (tmeta->tablet_data_state() != TabletDataState::TABLET_DATA_READY) {
+    LOG(INFO) << Substitute("skipping tablet $0 in state $1", tablet_id,
+                            tablet::TabletDataState_Name(tmeta->tablet_data_state()));
+    return Status::OK();
+  }
+  scoped_refptr<ConsensusMetadata> cmeta;
+  RETURN_NOT_OK(cmeta_manager->Load(tablet_id, &cmeta));
+
+  // The history isn't garbage collected by the compactions with a logical
+  // clock: that's left to the tablet server, which knows the current time.
+  LogicalClock clock(Timestamp::kInitialTimestamp);
+  RETURN_NOT_OK(clock.Init());
+
+  shared_ptr<Tablet> tablet;
+  scoped_refptr<Log> log;
+  ConsensusBootstrapInfo cbi;
+  RETURN_NOT_OK_PREPEND(tablet::BootstrapTablet(std::move(tmeta),
+                                                cmeta->CommittedConfig(),
+                                                &clock,
+                                                /*mem_tracker=*/ nullptr,
+                                                /*result_tracker=*/ nullptr,
+                                                /*metric_registry=*/ nullptr,
+                                                /*file_cache=*/ nullptr,
+                                                /*tablet_replica=*/ nullptr,
+                                                new LogAnchorRegistry(),
+                                                &tablet,
+                                                &log,
+                                                &cbi),
+                        "could not bootstrap tablet");
+  const auto num_rowsets_before = tablet->num_rowsets();
+  Status s = tablet->Flush().AndThen([&] {
+    return tablet->FlushAllDMS();
+  }).AndThen([&] {
+    return FLAGS_compact_all_rowsets ? tablet->Compact(Tablet::FORCE_COMPACT_ALL)
+                                     : Status::OK();
+  }).AndThen([&] {
+    // Each major delta compaction takes care of a different rowset, so there
+    // may be as many of them as there are rowsets.
+    const auto num_rowsets = tablet->num_rowsets();
+    for (size_t i = 0; i < num_rowsets; i++) {
+      shared_ptr<RowSet> rs;
+      if (tablet->GetPerfImprovementForBestDeltaCompact(
+              RowSet::MAJOR_DELTA_COMPACTION, &rs) <= 0 || !rs) {
+        break;
+      }
+      RETURN_NOT_OK(tablet->CompactWorstDeltas(RowSet::MAJOR_DELTA_COMPACTION));
+    }
+    return Status::OK();
+  });
+  if (s.ok()) {
+    LOG(INFO) << Substitute("compacted tablet $0 from $1 to $2 rowsets",
+                            tablet_id, num_rowsets_before, tablet->num_rowsets());
+  }
+  tablet->Shutdown();
+  WARN_NOT_OK(log->Close(), Substitute("could not close the WAL of tablet $0", tablet_id));
+  return s;
+}
+
+Status CompactLocalReplicas(const RunnerContext& context) {
+  const string& tablet_ids_str = FindOrDie(context.required_args, kTabletIdsGlobArg);
+  vector<string> tablet_id_patterns = strings::Split(tablet_ids_str, ",", strings::SkipEmpty());
+  if (tablet_id_patterns.empty()) {
+    return Status::InvalidArgument("no tablet identifiers provided");
+  }
+
+  // The tablets are bootstrapped, which rewrites their WALs and requires a
+  // read-write FsManager.
+  FsManager fs_manager(Env::Default(), {});
+  RETURN_NOT_OK(fs_manager.Open());
+
+  vector<string> tablets;
+  RETURN_NOT_OK(GetTabletIdsByTableName(&fs_manager, &tablets));
+  set<string> tablet_ids;
+  for (const auto& tablet_id : tablets) {
+    if (MatchesAnyPattern(tablet_id_patterns, tablet_id)) {
+      tablet_ids.insert(tablet_id);
+    }
+  }
+  if (tablet_ids.empty()) {
+    return Status::NotFound(
+        "specified tablet id (pattern) does not exist or does not match "
+        "table name patterns specified in --tables flag.");
+  }
+
+  scoped_refptr<ConsensusMetadataManager> cmeta_manager(new ConsensusMetadataManager(&fs_manager));
+  unique_ptr<ThreadPool> pool;
+  RETURN_NOT_OK(ThreadPoolBuilder("tool-tablet-compact-pool")
+                .set_min_threads(FLAGS_num_threads)
+                .set_max_threads(FLAGS_num_threads)
+                .Build(&pool));
+  simple_spinlock lock;
+  vector<string> failed_tablet_ids;
+  for (const auto& tablet_id : tablet_ids) {
+    RETURN_NOT_OK(pool->Submit([&, tablet_id]() {
+      Status s = CompactLocalReplica(tablet_id, &fs_manager, cmeta_manager);
+      if (!s.ok()) {
+        LOG(ERROR) << Substitute("could not compact tablet $0: $1", tablet_id, s.ToString());
+        std::lock_guard<simple_spinlock> l(lock);
+        failed_tablet_ids.emplace_back(tablet_id);
+      }
+    }));
+  }
+  pool->Wait();
+  pool->Shutdown();
+
+  if (!failed_tablet_ids.empty()) {
+    std::sort(failed_tablet_ids.begin(), failed_tablet_ids.end());
+    return Status::RuntimeError(Substitute("could not compact $0 of $1 tablet replicas: $2",
+                                           failed_tablet_ids.size(), tablet_ids.size(),
+                                           JoinStrings(failed_tablet_ids, ",")));
+  }
+  LOG(INFO) << Substitute("compacted $0 tablet replicas.", tablet_ids.size());
+  return Status::OK();
+}
+
 Status SummarizeSize(FsManager* fs,
                      const vector<BlockId>& blocks,
                      StringPiece block_type,
@@ -1358,6 +1501,23 @@ unique_ptr<Mode> BuildLocalReplicaMode() {
       .AddAction(std::move(delete_rowsets))
       .Build();
 
+  unique_ptr<Action> compact =
+      ActionBuilder("compact", &CompactLocalReplicas)
+      .Description("Compact tablet replicas in the local filesystem")
+      .ExtraDescription("Flushes the in-memory stores of the replicas, merges their "
+          "rowsets and runs the major delta compactions of their rowsets, compacting as "
+          "many replicas in parallel as --num_threads. The replicas are bootstrapped "
+          "first, replaying their WALs. Before using this tool, you MUST stop the "
+          "tablet server the replicas belong to.")
+      .AddRequiredParameter({ kTabletIdsGlobArg, kTabletIdsGlobArgDesc })
+      .AddOptionalParameter("compact_all_rowsets")
+      .AddOptionalParameter("fs_data_dirs")
+      .AddOptionalParameter("fs_metadata_dir")
+      .AddOptionalParameter("fs_wal_dir")
+      .AddOptionalParameter("num_threads")
+      .AddOptionalParameter("tables")
+      .Build();
+
   unique_ptr<Action> copy_from_remote =
       ActionBuilder("copy_from_remote", &CopyFromRemote)
       .Description("Copy tablet replicas from a remote server")
@@ -1423,6 +1583,7 @@ unique_ptr<Mode> BuildLocalReplicaMode() {
       .Description("Operate on local tablet replicas via the local filesystem")
       .AddMode(std::move(cmeta))
       .AddMode(std::move(tmeta))
+      .AddAction(std::move(compact))
       .AddAction(std::move(copy_from_local))
       .AddAction(std::move(copy_from_remote))
       .AddAction(std::move(data_size))
@@ -164,12 +164,16 @@
 //      v  +---------+         v
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -183,8 +187,11 @@
 #include <glog/logging.h>
 
 #include "kudu/client/client.h"
+#include "kudu/client/scan_batch.h"
+#include "kudu/client/scan_predicate.h"
 #include "kudu/client/schema.h"
 #include "kudu/client/shared_ptr.h" // IWYU pragma: keep
+#include "kudu/client/value.h"
 #include "kudu/client/write_op.h"
 #include "kudu/clock/logical_clock.h"
 #include "kudu/common/common.pb.h"
@@ -195,18 +202,25 @@
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
 #include "kudu/common/types.h"
+#include "kudu/common/wire_protocol.h"
+#include "kudu/common/wire_protocol.pb.h"
 #include "kudu/consensus/consensus_meta.h"
 #include "kudu/consensus/consensus_meta_manager.h"
 #include "kudu/consensus/log.h"
 #include "kudu/consensus/log_anchor_registry.h"
+#include "kudu/consensus/metadata.pb.h"
 #include "kudu/consensus/raft_consensus.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stl_util.h"
+#include "kudu/gutil/strings/split.h"
 #include "kudu/gutil/strings/strcat.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/master/master.pb.h"
+#include "kudu/master/master.proxy.h"
 #include "kudu/rpc/result_tracker.h"
+#include "kudu/rpc/rpc_controller.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/tablet_bootstrap.h"
 #include "kudu/tablet/tablet_metadata.h"
@@ -214,15 +228,25 @@
 #include "kudu/tools/table_scanner.h"
 #include "kudu/tools/tool_action.h"
 #include "kudu/tools/tool_action_common.h"
+#include "kudu/tserver/tablet_server.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/tserver/tserver_service.proxy.h"
 #include "kudu/util/decimal_util.h"
 #include "kudu/util/env.h"
 #include "kudu/util/flag_validators.h"
+#include "kudu/util/hash_util.h"
+#include "kudu/util/hdr_histogram.h"
 #include "kudu/util/int128.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/net/net_util.h"
 #include "kudu/util/oid_generator.h"
+#include "kudu/util/pb_util.h"
 #include "kudu/util/random.h"
+#include "kudu/util/random_util.h"
 #include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/threadpool.h"
 
 namespace kudu {
 namespace tablet {
@@ -237,6 +261,9 @@ using kudu::TypeInfo;
 using kudu::client::KuduClient;
 using kudu::client::KuduColumnSchema;
 using kudu::client::KuduError;
+using kudu::client::KuduInsert;
+using kudu::client::KuduPredicate;
+using kudu::client::KuduScanBatch;
 using kudu::client::KuduScanner;
 using kudu::client::KuduSchema;
 using kudu::client::KuduSchemaBuilder;
@@ -244,6 +271,8 @@ using kudu::client::KuduSession;
 using kudu::client::KuduTable;
 using kudu::client::KuduTableCreator;
 using kudu::client::KuduTransaction;
+using kudu::client::KuduUpdate;
+using kudu::client::KuduValue;
 using kudu::client::KuduWriteOperation;
 using kudu::client::sp::shared_ptr;
 using kudu::clock::LogicalClock;
@@ -251,20 +280,35 @@ using kudu::consensus::ConsensusBootstrapInfo;
 using kudu::consensus::ConsensusMetadata;
 using kudu::consensus::ConsensusMetadataManager;
 using kudu::log::Log;
+using kudu::master::GetTableLocationsRequestPB;
+using kudu::master::GetTableLocationsResponsePB;
+using kudu::master::MasterServiceProxy;
+using kudu::master::TSInfoPB;
+using kudu::pb_util::ReadablePBContainerFile;
+using kudu::rpc::RpcController;
 using kudu::log::LogAnchorRegistry;
 using kudu::tablet::RowIteratorOptions;
 using kudu::tablet::Tablet;
 using kudu::tablet::TabletMetadata;
+using kudu::tserver::CapturedRequestPB;
+using kudu::tserver::ScanRequestPB;
+using kudu::tserver::ScanResponsePB;
+using kudu::tserver::TabletServerServiceProxy;
+using kudu::tserver::WriteRequestPB;
+using kudu::tserver::WriteResponsePB;
 using std::cerr;
 using std::cout;
 using std::endl;
 using std::lock_guard;
 using std::mutex;
+using std::map;
 using std::numeric_limits;
+using std::ostream;
 using std::ostringstream;
 using std::string;
 using std::thread;
 using std::unique_ptr;
+using std::unordered_map;
 using std::vector;
 using strings::Substitute;
 using strings::SubstituteAndAppend;
@@ -386,8 +430,44 @@ DEFINE_bool(txn_rollback, false,
             "the inserted rows. Setting --txn_rollback=true implies setting "
             "--txn_start=true as well.");
 
+DEFINE_string(ycsb_workload, "A",
+              "The YCSB workload to run: A (50% reads, 50% updates), B (95% "
+              "reads, 5% updates), C (reads only), D (95% reads of the latest "
+              "records, 5% inserts), E (95% short scans, 5% inserts) or F (50% "
+              "reads, 50% read-modify-writes).");
+DEFINE_int64(ycsb_record_count, 100000,
+             "The number of records the YCSB workload is run against, inserted "
+             "first if --ycsb_load is set.");
+DEFINE_int64(ycsb_operation_count, 100000,
+             "The number of operations of the YCSB workload to run, split among "
+             "--num_threads threads.");
+DEFINE_string(ycsb_request_distribution, "",
+              "The distribution of the records accessed by the YCSB workload: "
+              "uniform, zipfian or latest. If empty, the default distribution "
+              "of the workload is used: latest for workload D, zipfian for the "
+              "others.");
+DEFINE_int32(ycsb_field_count, 10,
+             "The number of STRING fields of the records of the YCSB workload, "
+             "besides their key.");
+DEFINE_int32(ycsb_field_length, 100,
+             "The length of the values of the fields of the records of the YCSB "
+             "workload.");
+DEFINE_int32(ycsb_max_scan_length, 100,
+             "The maximum number of records returned by the scans of the YCSB "
+             "workload E, the number of each scan being uniformly distributed.");
+DEFINE_bool(ycsb_load, true,
+            "Whether to insert --ycsb_record_count records before running the "
+            "YCSB workload. If not set, the records must have been inserted "
+            "already into the table specified with --table_name.");
+
+DEFINE_double(replay_speed, 1.0,
+              "The speed at which to replay the captured requests, relative to "
+              "the speed at which they were received: e.g. 2 replays them twice "
+              "as fast. If 0, they're replayed as fast as possible.");
+
 DECLARE_bool(show_values);
 DECLARE_int32(num_threads);
+DECLARE_int64(timeout_ms);
 DECLARE_int32(scan_batch_size);
 DECLARE_string(replica_selection);
 DECLARE_string(table_name);
@@ -397,6 +477,8 @@ namespace tools {
 
 namespace {
 
+constexpr const char* const kCapturePathsArg = "capture_paths";
+
 bool ValidatePartitionFlags() {
   int num_tablets = FLAGS_table_num_hash_partitions * FLAGS_table_num_range_partitions;
   if (num_tablets < 1) {
@@ -1017,6 +1099,707 @@ Status TabletScan(const RunnerContext& context) {
   return Status::OK();
 }
 
+// The tablet the requests captured from a tablet of the same partition are
+// replayed against.
+struct ReplayTablet {
+  string tablet_id;
+  TabletServerServiceProxy* leader;
+};
+
+// The statistics of the replayed requests of one type.
+struct ReplayStats {
+  ReplayStats()
+      : latency_us(60 * 1000 * 1000, 2),
+        errors(0),
+        row_errors(0) {
+  }
+
+  // The latencies of the requests, from the time they were due to be sent to
+  // the time they completed, in microseconds.
+  HdrHistogram latency_us;
+  std::atomic<int64_t> errors;
+  std::atomic<int64_t> row_errors;
+};
+
+// Replays captured requests against the leaders of the tablets of a cluster.
+// The requests are sent as captured, after the tablet ids are rewritten.
+class RequestReplayer {
+ public:
+  explicit RequestReplayer(LeaderMasterProxy* master)
+      : master_(master) {
+  }
+
+  // Looks up the tablets, and their leaders, the captured requests of the
+  // tables named in 'requests' are replayed against.
+  Status Prepare(const vector<CapturedRequestPB>& requests) {
+    for (const auto& request : requests) {
+      if (!ContainsKey(tablets_, request.table_name())) {
+        RETURN_NOT_OK_PREPEND(LookupTablets(request.table_name()),
+                              Substitute("could not look up table $0", request.table_name()));
+      }
+    }
+    return Status::OK();
+  }
+
+  // Replays 'request', which was due to be sent at 'due'.
+  void Replay(const CapturedRequestPB& request, MonoTime due) {
+    ReplayStats* stats = request.has_write() ? &write_stats_ : &scan_stats_;
+    const ReplayTablet* tablet = FindOrNull(FindOrDie(tablets_, request.table_name()),
+                                            request.partition().partition_key_start());
+    Status s;
+    if (!tablet) {
+      s = Status::NotFound("no tablet with the partition of the captured request");
+    } else if (request.has_write()) {
+      s = ReplayWrite(*tablet, request.write(), stats);
+    } else {
+      s = ReplayScan(*tablet, request.scan());
+    }
+    stats->latency_us.Increment(std::min<int64_t>((MonoTime::Now() - due).ToMicroseconds(),
+                                                  stats->latency_us.highest_trackable_value()));
+    if (!s.ok()) {
+      stats->errors++;
+      KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("could not replay request to table $0: $1",
+                                                  request.table_name(), s.ToString());
+    }
+  }
+
+  Status PrintStats(MonoDelta elapsed, ostream& out) const {
+    DataTable table({ "type", "requests", "errors", "row errors", "requests/sec",
+                      "p50 (us)", "p95 (us)", "p99 (us)", "max (us)" });
+    const auto add_row = [&](const string& type, const ReplayStats& stats) {
+      const auto& latency = stats.latency_us;
+      table.AddRow({ type,
+                     std::to_string(latency.TotalCount()),
+                     std::to_string(stats.errors.load()),
+                     std::to_string(stats.row_errors.load()),
+                     Substitute("$0", latency.TotalCount() / elapsed.ToSeconds()),
+                     std::to_string(latency.ValueAtPercentile(50)),
+                     std::to_string(latency.ValueAtPercentile(95)),
+                     std::to_string(latency.ValueAtPercentile(99)),
+                     std::to_string(latency.MaxValue()) });
+    };
+    add_row("write", write_stats_);
+    add_row("scan", scan_stats_);
+    return table.PrintTo(out);
+  }
+
+ private:
+  // Looks up the tablets of the table named 'table_name', keying them by the
+  // start of their partition keys.
+  Status LookupTablets(const string& table_name) {
+    auto& tablets = tablets_[table_name];
+    // Page through the locations with the legacy partition key bounds, which
+    // the master only supports for tables with a table-wide hash schema.
+    string key_start;
+    while (true) {
+      GetTableLocationsRequestPB req;
+      req.mutable_table()->set_table_name(table_name);
+      req.set_partition_key_start(key_start);
+      req.set_max_returned_locations(100);
+      req.set_intern_ts_infos_in_response(true);
+      GetTableLocationsResponsePB resp;
+      RETURN_NOT_OK((master_->SyncRpc<GetTableLocationsRequestPB, GetTableLocationsResponsePB>(
+          req, &resp, "GetTableLocations", &MasterServiceProxy::GetTableLocationsAsync)));
+      if (resp.has_error()) {
+        return StatusFromPB(resp.error().status());
+      }
+      for (const auto& location : resp.tablet_locations()) {
+        const TSInfoPB* leader = nullptr;
+        for (const auto& replica : location.interned_replicas()) {
+          if (replica.role() == consensus::RaftPeerPB::LEADER) {
+            leader = &resp.ts_infos(replica.ts_info_idx());
+          }
+        }
+        if (!leader || leader->rpc_addresses_size() == 0) {
+          return Status::ServiceUnavailable(
+              Substitute("tablet $0 has no leader", location.tablet_id()));
+        }
+        const string address = HostPortFromPB(leader->rpc_addresses(0)).ToString();
+        auto& proxy = proxies_[address];
+        if (!proxy) {
+          RETURN_NOT_OK(BuildProxy(address, tserver::TabletServer::kDefaultPort, &proxy));
+        }
+        tablets.emplace(location.partition().partition_key_start(),
+                        ReplayTablet{ location.tablet_id(), proxy.get() });
+      }
+      if (resp.tablet_locations().empty()) {
+        break;
+      }
+      key_start = resp.tablet_locations().rbegin()->partition().partition_key_end();
+      if (key_start.empty()) {
+        break;
+      }
+    }
+    return Status::OK();
+  }
+
+  static Status ReplayWrite(const ReplayTablet& tablet,
+                            const WriteRequestPB& captured,
+                            ReplayStats* stats) {
+    WriteRequestPB req = captured;
+    req.set_tablet_id(tablet.tablet_id);
+    WriteResponsePB resp;
+    RpcController rpc;
+    rpc.set_timeout(MonoDelta::FromMilliseconds(FLAGS_timeout_ms));
+    RETURN_NOT_OK(tablet.leader->Write(req, &resp, &rpc));
+    if (resp.has_error()) {
+      return StatusFromPB(resp.error().status());
+    }
+    // The rows of the replayed writes may well not match those of the target
+    // table, e.g. when replaying inserts twice.
+    stats->row_errors += resp.per_row_errors_size();
+    return Status::OK();
+  }
+
+  static Status ReplayScan(const ReplayTablet& tablet, const ScanRequestPB& captured) {
+    ScanRequestPB req = captured;
+    req.mutable_new_scan_request()->set_tablet_id(tablet.tablet_id);
+    uint32_t call_seq_id = 0;
+    while (true) {
+      ScanResponsePB resp;
+      RpcController rpc;
+      rpc.set_timeout(MonoDelta::FromMilliseconds(FLAGS_timeout_ms));
+      RETURN_NOT_OK(tablet.leader->Scan(req, &resp, &rpc));
+      if (resp.has_error()) {
+        return StatusFromPB(resp.error().status());
+      }
+      if (!resp.has_more_results()) {
+        return Status::OK();
+      }
+      req.Clear();
+      req.set_scanner_id(resp.scanner_id());
+      req.set_call_seq_id(++call_seq_id);
+      if (captured.has_batch_size_bytes()) {
+        req.set_batch_size_bytes(captured.batch_size_bytes());
+      }
+    }
+  }
+
+  LeaderMasterProxy* const master_;
+
+  // The tablets of the tables, keyed by the names of the tables, then by the
+  // start of the partition keys of the tablets.
+  unordered_map<string, map<string, ReplayTablet>> tablets_;
+
+  // The proxies to the leaders, keyed by their addresses.
+  unordered_map<string, unique_ptr<TabletServerServiceProxy>> proxies_;
+
+  ReplayStats write_stats_;
+  ReplayStats scan_stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestReplayer);
+};
+
+// Reads the requests captured into the file at 'path' into 'requests'.
+Status ReadCapturedRequests(const string& path, vector<CapturedRequestPB>* requests) {
+  RandomAccessFileOptions opts;
+  opts.is_sensitive = true;
+  unique_ptr<RandomAccessFile> file;
+  RETURN_NOT_OK(Env::Default()->NewRandomAccessFile(opts, path, &file));
+  ReadablePBContainerFile reader(std::move(file));
+  RETURN_NOT_OK(reader.Open());
+  while (true) {
+    CapturedRequestPB request;
+    Status s = reader.ReadNextPB(&request);
+    if (s.IsEndOfFile() || s.IsIncomplete()) {
+      // The last record of a file still being captured into may be partial.
+      break;
+    }
+    RETURN_NOT_OK(s);
+    if (request.has_write() || request.has_scan()) {
+      requests->emplace_back(std::move(request));
+    }
+  }
+  return reader.Close();
+}
+
+Status ReplayRequests(const RunnerContext& context) {
+  const string& capture_paths = FindOrDie(context.required_args, kCapturePathsArg);
+  vector<CapturedRequestPB> requests;
+  for (const auto& path : strings::Split(capture_paths, ",", strings::SkipEmpty())) {
+    RETURN_NOT_OK_PREPEND(ReadCapturedRequests(path, &requests),
+                          Substitute("could not read captured requests from $0", path));
+  }
+  if (requests.empty()) {
+    cout << "No requests to replay" << endl;
+    return Status::OK();
+  }
+  // Merge the requests captured by different tablet servers.
+  std::stable_sort(requests.begin(), requests.end(),
+                   [](const CapturedRequestPB& a, const CapturedRequestPB& b) {
+                     return a.received_unix_micros() < b.received_unix_micros();
+                   });
+
+  LeaderMasterProxy master;
+  RETURN_NOT_OK(master.Init(context));
+  RequestReplayer replayer(&master);
+  RETURN_NOT_OK(replayer.Prepare(requests));
+
+  unique_ptr<ThreadPool> pool;
+  RETURN_NOT_OK(ThreadPoolBuilder("replay")
+                .set_min_threads(FLAGS_num_threads)
+                .set_max_threads(FLAGS_num_threads)
+                .Build(&pool));
+  const uint64_t first_micros = requests.front().received_unix_micros();
+  const MonoTime start = MonoTime::Now();
+  for (const auto& request : requests) {
+    MonoTime due = MonoTime::Now();
+    if (FLAGS_replay_speed > 0) {
+      due = start + MonoDelta::FromMicroseconds(
+          (request.received_unix_micros() - first_micros) / FLAGS_replay_speed);
+      const MonoTime now = MonoTime::Now();
+      if (due > now) {
+        SleepFor(due - now);
+      }
+    }
+    RETURN_NOT_OK(pool->Submit([&replayer, &request, due]() {
+      replayer.Replay(request, due);
+    }));
+  }
+  pool->Wait();
+  const MonoDelta elapsed = MonoTime::Now() - start;
+  pool->Shutdown();
+
+  cout << Substitute("Replayed $0 requests in $1 seconds", requests.size(),
+                     elapsed.ToSeconds()) << endl;
+  return replayer.PrintStats(elapsed, cout);
+}
+
+// Generates integers in [0, n) following a Zipfian distribution, 0 being the
+// most popular, with the algorithm of "Quickly Generating Billion-Record
+// Synthetic Databases" by Gray et al. which YCSB uses as well.
+class ZipfianGenerator {
+ public:
+  // The skew of the distribution YCSB uses.
+  static constexpr double kTheta = 0.99;
+
+  explicit ZipfianGenerator(int64_t n)
+      : n_(n),
+        alpha_(1 / (1 - kTheta)),
+        zetan_(Zeta(n)),
+        eta_((1 - pow(2.0 / n, 1 - kTheta)) / (1 - Zeta(2) / zetan_)) {
+    DCHECK_GT(n, 0);
+  }
+
+  int64_t Next(Random* rng) const {
+    const double u = rng->NextDoubleFraction();
+    const double uz = u * zetan_;
+    if (uz < 1) {
+      return 0;
+    }
+    if (uz < 1 + pow(0.5, kTheta)) {
+      return std::min<int64_t>(1, n_ - 1);
+    }
+    return std::min<int64_t>(n_ * pow(eta_ * u - eta_ + 1, alpha_), n_ - 1);
+  }
+
+ private:
+  static double Zeta(int64_t n) {
+    double sum = 0;
+    for (int64_t i = 1; i <= n; i++) {
+      sum += 1 / pow(i, kTheta);
+    }
+    return sum;
+  }
+
+  const int64_t n_;
+  const double alpha_;
+  const double zetan_;
+  const double eta_;
+};
+
+// The operations of the YCSB workloads.
+enum YcsbOp {
+  YCSB_READ,
+  YCSB_UPDATE,
+  YCSB_INSERT,
+  YCSB_SCAN,
+  YCSB_READ_MODIFY_WRITE,
+  YCSB_NUM_OPS
+};
+
+const char* const kYcsbOpNames[YCSB_NUM_OPS] = {
+  "read", "update", "insert", "scan", "read-modify-write"
+};
+
+constexpr const char* const kYcsbKeyColumn = "key";
+
+// The proportions of the operations of a YCSB workload, and the default
+// distribution of the keys it accesses.
+struct YcsbWorkload {
+  double proportions[YCSB_NUM_OPS];
+  const char* distribution;
+};
+
+Status GetYcsbWorkload(const string& name, YcsbWorkload* workload) {
+  //                                 read  update insert scan  rmw
+  static const YcsbWorkload kA = { { 0.5,  0.5,   0,     0,    0   }, "zipfian" };
+  static const YcsbWorkload kB = { { 0.95, 0.05,  0,     0,    0   }, "zipfian" };
+  static const YcsbWorkload kC = { { 1,    0,     0,     0,    0   }, "zipfian" };
+  static const YcsbWorkload kD = { { 0.95, 0,     0.05,  0,    0   }, "latest" };
+  static const YcsbWorkload kE = { { 0,    0,     0.05,  0.95, 0   }, "zipfian" };
+  static const YcsbWorkload kF = { { 0.5,  0,     0,     0,    0.5 }, "zipfian" };
+  if (name.size() == 1) {
+    switch (toupper(name[0])) {
+      case 'A': *workload = kA; return Status::OK();
+      case 'B': *workload = kB; return Status::OK();
+      case 'C': *workload = kC; return Status::OK();
+      case 'D': *workload = kD; return Status::OK();
+      case 'E': *workload = kE; return Status::OK();
+      case 'F': *workload = kF; return Status::OK();
+      default: break;
+    }
+  }
+  return Status::InvalidArgument("unknown YCSB workload, expected one of A to F", name);
+}
+
+// Runs a YCSB workload against a table with a STRING primary key column named
+// 'key' and --ycsb_field_count STRING columns named 'field0', 'field1', etc.
+//
+// As in YCSB, the keys are the hashes of the record numbers so that their
+// popularity doesn't follow their order, and all the operations are sent
+// synchronously, each thread running one at a time.
+class YcsbDriver {
+ public:
+  YcsbDriver(shared_ptr<KuduClient> client, shared_ptr<KuduTable> table,
+             const YcsbWorkload& workload, string distribution)
+      : client_(std::move(client)),
+        table_(std::move(table)),
+        workload_(workload),
+        distribution_(std::move(distribution)),
+        zipfian_(std::max<int64_t>(FLAGS_ycsb_record_count, 1)),
+        num_records_(FLAGS_ycsb_record_count),
+        next_record_(FLAGS_ycsb_record_count) {
+  }
+
+  // Inserts the records the run phase accesses, with 'num_threads' threads.
+  Status Load(int num_threads) {
+    vector<Status> statuses(num_threads);
+    vector<thread> threads;
+    const int64_t per_thread = (FLAGS_ycsb_record_count + num_threads - 1) / num_threads;
+    for (int i = 0; i < num_threads; i++) {
+      const int64_t start = i * per_thread;
+      const int64_t end = std::min<int64_t>(start + per_thread, FLAGS_ycsb_record_count);
+      threads.emplace_back([this, i, start, end, &statuses]() {
+        statuses[i] = LoadRecords(start, end);
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    for (const auto& s : statuses) {
+      RETURN_NOT_OK(s);
+    }
+    return Status::OK();
+  }
+
+  // Runs --ycsb_operation_count operations of the workload, split among
+  // 'num_threads' threads.
+  Status Run(int num_threads) {
+    vector<Status> statuses(num_threads);
+    vector<thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      const int64_t num_ops = FLAGS_ycsb_operation_count / num_threads +
+          (i < FLAGS_ycsb_operation_count % num_threads ? 1 : 0);
+      threads.emplace_back([this, i, num_ops, &statuses]() {
+        statuses[i] = RunOps(num_ops, GetRandomSeed32());
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    for (const auto& s : statuses) {
+      RETURN_NOT_OK(s);
+    }
+    return Status::OK();
+  }
+
+  Status PrintStats(MonoDelta elapsed, ostream& out) const {
+    DataTable table({ "operation", "count", "errors", "ops/sec",
+                      "p50 (us)", "p95 (us)", "p99 (us)", "max (us)" });
+    for (int op = 0; op < YCSB_NUM_OPS; op++) {
+      const auto& latency = stats_[op].latency_us;
+      if (latency.TotalCount() == 0) {
+        continue;
+      }
+      table.AddRow({ kYcsbOpNames[op],
+                     std::to_string(latency.TotalCount()),
+                     std::to_string(stats_[op].errors.load()),
+                     Substitute("$0", latency.TotalCount() / elapsed.ToSeconds()),
+                     std::to_string(latency.ValueAtPercentile(50)),
+                     std::to_string(latency.ValueAtPercentile(95)),
+                     std::to_string(latency.ValueAtPercentile(99)),
+                     std::to_string(latency.MaxValue()) });
+    }
+    return table.PrintTo(out);
+  }
+
+ private:
+  // The latencies and errors of the operations of one type.
+  struct OpStats {
+    OpStats()
+        : latency_us(60 * 1000 * 1000, 2),
+          errors(0) {
+    }
+    HdrHistogram latency_us;
+    std::atomic<int64_t> errors;
+  };
+
+  static string Key(int64_t record) {
+    return Substitute("user$0", HashUtil::FastHash64(&record, sizeof(record), 0));
+  }
+
+  static string FieldName(int field) {
+    return Substitute("field$0", field);
+  }
+
+  static string FieldValue(Random* rng) {
+    string value(FLAGS_ycsb_field_length, ' ');
+    for (auto& c : value) {
+      c = 'a' + rng->Uniform(26);
+    }
+    return value;
+  }
+
+  Status SetFields(KuduPartialRow* row, Random* rng) const {
+    for (int i = 0; i < FLAGS_ycsb_field_count; i++) {
+      RETURN_NOT_OK(row->SetString(FieldName(i), FieldValue(rng)));
+    }
+    return Status::OK();
+  }
+
+  Status LoadRecords(int64_t start, int64_t end) {
+    Random rng(GetRandomSeed32());
+    shared_ptr<KuduSession> session = client_->NewSession();
+    RETURN_NOT_OK(session->SetFlushMode(KuduSession::AUTO_FLUSH_BACKGROUND));
+    for (int64_t record = start; record < end; record++) {
+      unique_ptr<KuduInsert> insert(table_->NewInsert());
+      RETURN_NOT_OK(insert->mutable_row()->SetString(kYcsbKeyColumn, Key(record)));
+      RETURN_NOT_OK(SetFields(insert->mutable_row(), &rng));
+      RETURN_NOT_OK(session->Apply(insert.release()));
+    }
+    Status s = session->Flush();
+    if (session->CountPendingErrors() > 0) {
+      vector<KuduError*> errors;
+      ElementDeleter d(&errors);
+      session->GetPendingErrors(&errors, nullptr);
+      return errors.front()->status().CloneAndPrepend(
+          Substitute("$0 errors loading the records, first", errors.size()));
+    }
+    return s;
+  }
+
+  // Returns the record the next operation accesses, other than an insert.
+  int64_t NextRecord(Random* rng) const {
+    const int64_t num_records = num_records_;
+    if (distribution_ == "uniform") {
+      return rng->Uniform64(num_records);
+    }
+    if (distribution_ == "latest") {
+      // The Zipfian distribution is over the records loaded at first, but the
+      // most popular records remain the latest ones inserted.
+      return std::max<int64_t>(num_records - 1 - zipfian_.Next(rng), 0);
+    }
+    return std::min(zipfian_.Next(rng), num_records - 1);
+  }
+
+  YcsbOp NextOp(Random* rng) const {
+    double p = rng->NextDoubleFraction();
+    for (int op = 0; op < YCSB_NUM_OPS; op++) {
+      p -= workload_.proportions[op];
+      if (p < 0) {
+        return static_cast<YcsbOp>(op);
+      }
+    }
+    return YCSB_READ;
+  }
+
+  Status Read(int64_t record) const {
+    KuduScanner scanner(table_.get());
+    RETURN_NOT_OK(scanner.AddConjunctPredicate(table_->NewComparisonPredicate(
+        kYcsbKeyColumn, KuduPredicate::EQUAL, KuduValue::CopyString(Key(record)))));
+    return ConsumeScan(&scanner);
+  }
+
+  Status Scan(int64_t record, Random* rng) const {
+    KuduScanner scanner(table_.get());
+    RETURN_NOT_OK(scanner.AddConjunctPredicate(table_->NewComparisonPredicate(
+        kYcsbKeyColumn, KuduPredicate::GREATER_EQUAL, KuduValue::CopyString(Key(record)))));
+    RETURN_NOT_OK(scanner.SetLimit(1 + rng->Uniform(FLAGS_ycsb_max_scan_length)));
+    return ConsumeScan(&scanner);
+  }
+
+  static Status ConsumeScan(KuduScanner* scanner) {
+    RETURN_NOT_OK(scanner->Open());
+    KuduScanBatch batch;
+    while (scanner->HasMoreRows()) {
+      RETURN_NOT_OK(scanner->NextBatch(&batch));
+    }
+    return Status::OK();
+  }
+
+  Status Update(KuduSession* session, int64_t record, Random* rng) const {
+    // Update a single field, as YCSB does by default.
+    unique_ptr<KuduUpdate> update(table_->NewUpdate());
+    RETURN_NOT_OK(update->mutable_row()->SetString(kYcsbKeyColumn, Key(record)));
+    RETURN_NOT_OK(update->mutable_row()->SetString(
+        FieldName(rng->Uniform(FLAGS_ycsb_field_count)), FieldValue(rng)));
+    return session->Apply(update.release());
+  }
+
+  Status Insert(KuduSession* session, Random* rng) {
+    const int64_t record = next_record_++;
+    unique_ptr<KuduInsert> insert(table_->NewInsert());
+    RETURN_NOT_OK(insert->mutable_row()->SetString(kYcsbKeyColumn, Key(record)));
+    RETURN_NOT_OK(SetFields(insert->mutable_row(), rng));
+    RETURN_NOT_OK(session->Apply(insert.release()));
+    // The records inserted concurrently may be acknowledged out of order, in
+    // which case the latest ones are briefly missing for the reads.
+    num_records_++;
+    return Status::OK();
+  }
+
+  Status RunOps(int64_t num_ops, uint32_t seed) {
+    Random rng(seed);
+    shared_ptr<KuduSession> session = client_->NewSession();
+    RETURN_NOT_OK(session->SetFlushMode(KuduSession::AUTO_FLUSH_SYNC));
+    for (int64_t i = 0; i < num_ops; i++) {
+      const YcsbOp op = NextOp(&rng);
+      MonoTime start = MonoTime::Now();
+      Status s;
+      switch (op) {
+        case YCSB_READ:
+          s = Read(NextRecord(&rng));
+          break;
+        case YCSB_UPDATE:
+          s = Update(session.get(), NextRecord(&rng), &rng);
+          break;
+        case YCSB_INSERT:
+          s = Insert(session.get(), &rng);
+          break;
+        case YCSB_SCAN:
+          s = Scan(NextRecord(&rng), &rng);
+          break;
+        case YCSB_READ_MODIFY_WRITE: {
+          const int64_t record = NextRecord(&rng);
+          s = Read(record);
+          if (s.ok()) {
+            s = Update(session.get(), record, &rng);
+          }
+          break;
+        }
+        default:
+          LOG(FATAL) << "unknown YCSB operation " << op;
+      }
+      auto& stats = stats_[op];
+      stats.latency_us.Increment(std::min<int64_t>((MonoTime::Now() - start).ToMicroseconds(),
+                                                   stats.latency_us.highest_trackable_value()));
+      if (!s.ok()) {
+        stats.errors++;
+        vector<KuduError*> errors;
+        ElementDeleter d(&errors);
+        session->GetPendingErrors(&errors, nullptr);
+        KLOG_EVERY_N_SECS(WARNING, 1) << Substitute(
+            "$0 failed: $1", kYcsbOpNames[op],
+            errors.empty() ? s.ToString() : errors.front()->status().ToString());
+      }
+    }
+    return Status::OK();
+  }
+
+  const shared_ptr<KuduClient> client_;
+  const shared_ptr<KuduTable> table_;
+  const YcsbWorkload workload_;
+  const string distribution_;
+  const ZipfianGenerator zipfian_;
+
+  // The number of records the reads and updates may access, and the record
+  // the next insert inserts.
+  std::atomic<int64_t> num_records_;
+  std::atomic<int64_t> next_record_;
+
+  OpStats stats_[YCSB_NUM_OPS];
+
+  DISALLOW_COPY_AND_ASSIGN(YcsbDriver);
+};
+
+Status CreateYcsbTable(KuduClient* client, const string& table_name) {
+  KuduSchema schema;
+  KuduSchemaBuilder b;
+  b.AddColumn(kYcsbKeyColumn)->Type(KuduColumnSchema::STRING)->NotNull()->PrimaryKey();
+  for (int i = 0; i < FLAGS_ycsb_field_count; i++) {
+    b.AddColumn(Substitute("field$0", i))->Type(KuduColumnSchema::STRING);
+  }
+  RETURN_NOT_OK(b.Build(&schema));
+
+  unique_ptr<KuduTableCreator> table_creator(client->NewTableCreator());
+  table_creator->table_name(table_name)
+      .schema(&schema)
+      .set_range_partition_columns({});
+  if (FLAGS_table_num_replicas > 0) {
+    table_creator->num_replicas(FLAGS_table_num_replicas);
+  }
+  if (FLAGS_table_num_hash_partitions > 1) {
+    table_creator->add_hash_partitions({ kYcsbKeyColumn }, FLAGS_table_num_hash_partitions);
+  }
+  return table_creator->Create();
+}
+
+Status Ycsb(const RunnerContext& context) {
+  YcsbWorkload workload;
+  RETURN_NOT_OK(GetYcsbWorkload(FLAGS_ycsb_workload, &workload));
+  const string distribution = FLAGS_ycsb_request_distribution.empty() ?
+      workload.distribution : FLAGS_ycsb_request_distribution;
+  if (distribution != "uniform" && distribution != "zipfian" && distribution != "latest") {
+    return Status::InvalidArgument("unknown request distribution", distribution);
+  }
+  if (FLAGS_ycsb_record_count <= 0) {
+    return Status::InvalidArgument("--ycsb_record_count must be positive");
+  }
+
+  shared_ptr<KuduClient> client;
+  RETURN_NOT_OK(CreateKuduClient(context, &client));
+  string table_name = FLAGS_table_name;
+  const bool is_auto_table = table_name.empty();
+  if (is_auto_table) {
+    ObjectIdGenerator oid_generator;
+    table_name = Substitute("$0ycsb_auto_$1",
+        FLAGS_auto_database.empty() ? "" : FLAGS_auto_database + ".",
+        oid_generator.Next());
+    RETURN_NOT_OK(CreateYcsbTable(client.get(), table_name));
+  }
+  cout << "Using " << (is_auto_table ? "auto-created " : "")
+       << "table '" << table_name << "'" << endl;
+  shared_ptr<KuduTable> table;
+  RETURN_NOT_OK(client->OpenTable(table_name, &table));
+
+  YcsbDriver driver(client, table, workload, distribution);
+  if (FLAGS_ycsb_load) {
+    MonoTime start = MonoTime::Now();
+    RETURN_NOT_OK_PREPEND(driver.Load(FLAGS_num_threads), "could not load the records");
+    const MonoDelta elapsed = MonoTime::Now() - start;
+    cout << Substitute("Loaded $0 records in $1 seconds ($2 records/sec)",
+                       FLAGS_ycsb_record_count, elapsed.ToSeconds(),
+                       FLAGS_ycsb_record_count / elapsed.ToSeconds()) << endl;
+  }
+
+  MonoTime start = MonoTime::Now();
+  RETURN_NOT_OK(driver.Run(FLAGS_num_threads));
+  const MonoDelta elapsed = MonoTime::Now() - start;
+  cout << Substitute("Ran $0 operations of workload $1 with a $2 distribution in $3 seconds "
+                     "($4 ops/sec)",
+                     FLAGS_ycsb_operation_count, FLAGS_ycsb_workload, distribution,
+                     elapsed.ToSeconds(), FLAGS_ycsb_operation_count / elapsed.ToSeconds())
+       << endl;
+  RETURN_NOT_OK(driver.PrintStats(elapsed, cout));
+
+  if (is_auto_table && !FLAGS_keep_auto_table) {
+    cout << "Dropping auto-created table '" << table_name << "'" << endl;
+    RETURN_NOT_OK(client->DeleteTable(table_name));
+  }
+  return Status::OK();
+}
+
 } // anonymous namespace
 
 unique_ptr<Mode> BuildPerfMode() {
@@ -1071,6 +1854,61 @@ unique_ptr<Mode> BuildPerfMode() {
       .AddOptionalParameter("use_upsert")
       .Build();
 
+  unique_ptr<Action> replay =
+      ClusterActionBuilder("replay", &ReplayRequests)
+      .Description("Replay the write and scan requests captured by tablet servers")
+      .ExtraDescription(
+          "Replay the write and scan requests captured by tablet servers with "
+          "the --request_capture_path flag, at the speed they were received "
+          "at scaled by --replay_speed, against the tablets of the same "
+          "partitions of the tables with the same names, schemas and "
+          "partitioning. The requests are sent to the leaders of the tablets "
+          "as captured, without authorization tokens, so fine-grained "
+          "authorization must not be enforced by the tablet servers. Reports "
+          "the throughput of the requests and the percentiles of their "
+          "latencies, measured from the time they were due to be sent.")
+      .AddRequiredParameter({ kCapturePathsArg,
+                              "Comma-separated list of the files the requests were captured "
+                              "into, e.g. one per tablet server" })
+      .AddOptionalParameter("format")
+      .AddOptionalParameter("num_threads")
+      .AddOptionalParameter("replay_speed")
+      .Build();
+
+  unique_ptr<Action> ycsb =
+      ClusterActionBuilder("ycsb", &Ycsb)
+      .Description("Run a YCSB workload of point reads, updates, inserts and scans")
+      .ExtraDescription(
+          "Run one of the core workloads of the Yahoo! Cloud Serving Benchmark, "
+          "A to F, loading the records first. The keys of the operations follow "
+          "a uniform, Zipfian or latest distribution, and each thread sends "
+          "its operations one at a time. Reports the throughput of each type "
+          "of operation and the percentiles of their latencies. Unless "
+          "--table_name is set, the records are inserted into an auto-created "
+          "table, dropped once done unless --keep_auto_table is set.")
+      .AddOptionalParameter("auto_database")
+      .AddOptionalParameter("format")
+      .AddOptionalParameter("keep_auto_table")
+      .AddOptionalParameter("num_threads")
+      .AddOptionalParameter(
+          "table_name",
+          std::nullopt,
+          string("Name of an existing table to run the workload against, with a "
+                 "STRING primary key column named 'key' and --ycsb_field_count "
+                 "STRING columns named 'field0', 'field1', etc. If left empty, "
+                 "the table is auto-created."))
+      .AddOptionalParameter("table_num_hash_partitions")
+      .AddOptionalParameter("table_num_replicas")
+      .AddOptionalParameter("ycsb_field_count")
+      .AddOptionalParameter("ycsb_field_length")
+      .AddOptionalParameter("ycsb_load")
+      .AddOptionalParameter("ycsb_max_scan_length")
+      .AddOptionalParameter("ycsb_operation_count")
+      .AddOptionalParameter("ycsb_record_count")
+      .AddOptionalParameter("ycsb_request_distribution")
+      .AddOptionalParameter("ycsb_workload")
+      .Build();
+
   unique_ptr<Action> table_scan =
       ClusterActionBuilder("table_scan", &TableScan)
       .Description("Show row count and scanning time cost of tablets in a table")
@@ -1104,8 +1942,10 @@ unique_ptr<Mode> BuildPerfMode() {
   return ModeBuilder("perf")
       .Description("Measure the performance of a Kudu cluster")
       .AddAction(std::move(loadgen))
+      .AddAction(std::move(replay))
       .AddAction(std::move(table_scan))
       .AddAction(std::move(tablet_scan))
+      .AddAction(std::move(ycsb))
       .Build();
 }
 
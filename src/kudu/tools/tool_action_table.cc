@@ -39,6 +39,7 @@
 
 #include "kudu/client/client-internal.h"
 #include "kudu/client/client.h"
+#include "kudu/client/client.pb.h"
 #include "kudu/client/replica_controller-internal.h"
 #include "kudu/client/scan_batch.h"
 #include "kudu/client/scan_predicate.h"
@@ -46,6 +47,7 @@
 #include "kudu/client/shared_ptr.h" // IWYU pragma: keep
 #include "kudu/client/table_alterer-internal.h"
 #include "kudu/client/value.h"
+#include "kudu/client/write_op.h"
 #include "kudu/common/partial_row.h"
 #include "kudu/common/partition.h"
 #include "kudu/common/schema.h"
@@ -87,6 +89,8 @@ using kudu::client::KuduTableAlterer;
 using kudu::client::KuduTableCreator;
 using kudu::client::KuduTableStatistics;
 using kudu::client::KuduValue;
+using kudu::client::KuduWriteOperation;
+using kudu::client::ScanTokenPB;
 using kudu::client::internal::ReplicaController;
 using kudu::iequals;
 using kudu::master::ListInFlightTablesRequestPB;
@@ -196,6 +200,10 @@ DEFINE_string(hash_schema, "",
               "String representation of range-specific hash schema as a JSON "
               "object, e.g. "
               "{\"hash_schema\": [{\"columns\": [\"c0\"], \"num_buckets\": 5}]}");
+DEFINE_string(staging_table, "",
+              "Name of the table the rows of the range partition are copied to "
+              "while it's replaced. Defaults to the name of the table followed "
+              "by '__rebucket'.");
 DEFINE_int32(scan_batch_size, -1,
              "The size for scan results batches, in bytes. A negative value "
              "means the server-side default is used, where the server-side "
@@ -217,10 +225,11 @@ DECLARE_bool(show_scanner_stats);
 
 DEFINE_string(encoding_type, "AUTO_ENCODING",
               "Type of encoding for the column including AUTO_ENCODING, PLAIN_ENCODING, "
-              "PREFIX_ENCODING, RLE, DICT_ENCODING, BIT_SHUFFLE, GROUP_VARINT");
+              "PREFIX_ENCODING, RLE, DICT_ENCODING, BIT_SHUFFLE, FRAME_OF_REFERENCE, "
+              "ADAPTIVE_ENCODING, XOR_ENCODING, GROUP_VARINT");
 DEFINE_string(compression_type, "DEFAULT_COMPRESSION",
               "Type of compression for the column including DEFAULT_COMPRESSION, "
-              "NO_COMPRESSION, SNAPPY, LZ4, ZLIB");
+              "NO_COMPRESSION, SNAPPY, LZ4, ZLIB, ZSTD");
 DEFINE_string(default_value, "", "Default value for this column.");
 DEFINE_string(comment, "", "Comment for this column.");
 
@@ -1112,12 +1121,78 @@ Status ConvertToKuduPartialRow(
   return Status::OK();
 }
 
-Status ModifyRangePartition(const RunnerContext& context, PartitionAction action) {
-  const string& table_name = FindOrDie(context.required_args, kTableNameArg);
+// Parses the bounds of the range partition in the arguments of 'context' into
+// rows of the schema of 'table'.
+Status ParseRangeBounds(const RunnerContext& context,
+                        const KuduTable& table,
+                        unique_ptr<KuduPartialRow>* lower_bound,
+                        unique_ptr<KuduPartialRow>* upper_bound) {
   const string& table_range_lower_bound = FindOrDie(context.required_args,
                                                     kTableRangeLowerBoundArg);
   const string& table_range_upper_bound = FindOrDie(context.required_args,
                                                     kTableRangeUpperBoundArg);
+  const auto& schema = table.schema();
+  lower_bound->reset(schema.NewRow());
+  upper_bound->reset(schema.NewRow());
+
+  vector<pair<string, KuduColumnSchema::DataType>> range_col_names_and_types;
+  const Schema& schema_tmp = KuduSchema::ToSchema(schema);
+  const auto& partition_schema = table.partition_schema();
+  vector<int32_t> key_indexes;
+  RETURN_NOT_OK(partition_schema.GetRangeSchemaColumnIndexes(schema_tmp, &key_indexes));
+  for (int i = 0; i < key_indexes.size(); i++) {
+    const auto key_index = key_indexes[i];
+    const auto& column = schema.Column(key_index);
+    range_col_names_and_types.emplace_back(std::make_pair(column.name(),
+                                           column.type()));
+  }
+  RETURN_NOT_OK(ConvertToKuduPartialRow(range_col_names_and_types,
+                                        table_range_lower_bound,
+                                        lower_bound->get()));
+  return ConvertToKuduPartialRow(range_col_names_and_types,
+                                 table_range_upper_bound,
+                                 upper_bound->get());
+}
+
+// Parses the range-specific hash schema of --hash_schema into 'hash_schema'.
+Status ParseHashSchema(PartitionPB::HashSchemaPB* hash_schema) {
+  const auto& hash_schema_str = FLAGS_hash_schema;
+  JsonParseOptions opts;
+  opts.case_insensitive_enum_parsing = true;
+  if (const auto& s = JsonStringToMessage(
+        hash_schema_str, hash_schema, opts); !s.ok()) {
+    return Status::InvalidArgument(
+        Substitute("unable to parse JSON: $0", hash_schema_str),
+                   s.error_message().ToString());
+  }
+  return Status::OK();
+}
+
+// Returns a range partition with the bounds 'lower_bound' and 'upper_bound',
+// and the hash schema 'hash_schema'.
+unique_ptr<KuduRangePartition> NewRangePartition(
+    unique_ptr<KuduPartialRow> lower_bound,
+    unique_ptr<KuduPartialRow> upper_bound,
+    KuduTableCreator::RangePartitionBound lower_bound_type,
+    KuduTableCreator::RangePartitionBound upper_bound_type,
+    const PartitionPB::HashSchemaPB& hash_schema) {
+  auto p = make_unique<KuduRangePartition>(lower_bound.release(),
+                                           upper_bound.release(),
+                                           lower_bound_type,
+                                           upper_bound_type);
+  for (const auto& dimension_pb : hash_schema.hash_schema()) {
+    vector<string> columns;
+    for (const auto& column : dimension_pb.columns()) {
+      columns.emplace_back(column);
+    }
+    p->add_hash_partitions(
+        columns, dimension_pb.num_buckets(), dimension_pb.seed());
+  }
+  return p;
+}
+
+Status ModifyRangePartition(const RunnerContext& context, PartitionAction action) {
+  const string& table_name = FindOrDie(context.required_args, kTableNameArg);
 
   const auto convert_bounds_type = [&] (const string& range_bound,
                                         const string& flags_range_bound_type,
@@ -1143,28 +1218,10 @@ Status ModifyRangePartition(const RunnerContext& context, PartitionAction action
   client::sp::shared_ptr<KuduTable> table;
   RETURN_NOT_OK(CreateKuduClient(context, &client));
   RETURN_NOT_OK(client->OpenTable(table_name, &table));
-  const auto& schema = table->schema();
 
-  unique_ptr<KuduPartialRow> lower_bound(schema.NewRow());
-  unique_ptr<KuduPartialRow> upper_bound(schema.NewRow());
-
-  vector<pair<string, KuduColumnSchema::DataType>> range_col_names_and_types;
-  const Schema& schema_tmp = KuduSchema::ToSchema(schema);
-  const auto& partition_schema = table->partition_schema();
-  vector<int32_t> key_indexes;
-  RETURN_NOT_OK(partition_schema.GetRangeSchemaColumnIndexes(schema_tmp, &key_indexes));
-  for (int i = 0; i < key_indexes.size(); i++) {
-    const auto key_index = key_indexes[i];
-    const auto& column = schema.Column(key_index);
-    range_col_names_and_types.emplace_back(std::make_pair(column.name(),
-                                           column.type()));
-  }
-  RETURN_NOT_OK(ConvertToKuduPartialRow(range_col_names_and_types,
-                                        table_range_lower_bound,
-                                        lower_bound.get()));
-  RETURN_NOT_OK(ConvertToKuduPartialRow(range_col_names_and_types,
-                                        table_range_upper_bound,
-                                        upper_bound.get()));
+  unique_ptr<KuduPartialRow> lower_bound;
+  unique_ptr<KuduPartialRow> upper_bound;
+  RETURN_NOT_OK(ParseRangeBounds(context, *table, &lower_bound, &upper_bound));
 
   KuduTableCreator::RangePartitionBound lower_bound_type;
   RETURN_NOT_OK(convert_bounds_type(
@@ -1177,14 +1234,7 @@ Status ModifyRangePartition(const RunnerContext& context, PartitionAction action
   const auto& hash_schema_str = FLAGS_hash_schema;
   PartitionPB::HashSchemaPB hash_schema;
   if (!hash_schema_str.empty()) {
-    JsonParseOptions opts;
-    opts.case_insensitive_enum_parsing = true;
-    if (const auto& s = JsonStringToMessage(
-          hash_schema_str, &hash_schema, opts); !s.ok()) {
-      return Status::InvalidArgument(
-          Substitute("unable to parse JSON: $0", hash_schema_str),
-                     s.error_message().ToString());
-    }
+    RETURN_NOT_OK(ParseHashSchema(&hash_schema));
   }
 
   unique_ptr<KuduTableAlterer> alterer(client->NewTableAlterer(table_name));
@@ -1198,18 +1248,8 @@ Status ModifyRangePartition(const RunnerContext& context, PartitionAction action
     }
 
     // Add range partition with custom hash schema.
-    auto p = make_unique<KuduRangePartition>(lower_bound.release(),
-                                             upper_bound.release(),
-                                             lower_bound_type,
-                                             upper_bound_type);
-    for (const auto& dimension_pb : hash_schema.hash_schema()) {
-      vector<string> columns;
-      for (const auto& column : dimension_pb.columns()) {
-        columns.emplace_back(column);
-      }
-      p->add_hash_partitions(
-          columns, dimension_pb.num_buckets(), dimension_pb.seed());
-    }
+    auto p = NewRangePartition(std::move(lower_bound), std::move(upper_bound),
+                               lower_bound_type, upper_bound_type, hash_schema);
     return alterer->AddRangePartition(p.release())->Alter();
   }
 
@@ -1228,6 +1268,138 @@ Status AddRangePartition(const RunnerContext& context) {
   return ModifyRangePartition(context, PartitionAction::ADD);
 }
 
+// Collects into 'tablet_ids' the ids of the tablets of 'table' whose range is
+// [lower_bound, upper_bound).
+Status GetRangeTabletIds(KuduTable* table,
+                         const KuduPartialRow& lower_bound,
+                         const KuduPartialRow& upper_bound,
+                         set<string>* tablet_ids) {
+  const Schema& schema = KuduSchema::ToSchema(table->schema());
+  const auto& partition_schema = table->partition_schema();
+  string lower_key;
+  string upper_key;
+  RETURN_NOT_OK(partition_schema.EncodeRangeKey(lower_bound, schema, &lower_key));
+  RETURN_NOT_OK(partition_schema.EncodeRangeKey(upper_bound, schema, &upper_key));
+
+  vector<KuduScanToken*> tokens;
+  ElementDeleter deleter(&tokens);
+  KuduScanTokenBuilder builder(table);
+  RETURN_NOT_OK(builder.IncludeTabletMetadata(true));
+  RETURN_NOT_OK(builder.Build(&tokens));
+  for (const auto* token : tokens) {
+    string buf;
+    RETURN_NOT_OK(token->Serialize(&buf));
+    ScanTokenPB token_pb;
+    if (!token_pb.ParseFromString(buf)) {
+      return Status::Corruption("unable to parse the scan token");
+    }
+    Partition partition;
+    Partition::FromPB(token_pb.tablet_metadata().partition(), &partition);
+    if (partition.begin().range_key() == lower_key &&
+        partition.end().range_key() == upper_key) {
+      tablet_ids->emplace(token->tablet().id());
+    }
+  }
+  return Status::OK();
+}
+
+Status RebucketRangePartition(const RunnerContext& context) {
+  const string& table_name = FindOrDie(context.required_args, kTableNameArg);
+  const string staging_table_name = FLAGS_staging_table.empty()
+      ? Substitute("$0__rebucket", table_name) : FLAGS_staging_table;
+  if (FLAGS_hash_schema.empty()) {
+    return Status::InvalidArgument("--hash_schema is required");
+  }
+  PartitionPB::HashSchemaPB hash_schema;
+  RETURN_NOT_OK(ParseHashSchema(&hash_schema));
+
+  client::sp::shared_ptr<KuduClient> client;
+  client::sp::shared_ptr<KuduTable> table;
+  RETURN_NOT_OK(CreateKuduClient(context, &client));
+  RETURN_NOT_OK(client->OpenTable(table_name, &table));
+  const auto& schema = table->schema();
+  if (schema.GetAutoIncrementingColumnIndex() != -1) {
+    // Copying the rows would assign them new auto-incrementing values.
+    return Status::NotSupported("tables with an auto-incrementing column can't be rebucketed");
+  }
+
+  unique_ptr<KuduPartialRow> lower_bound;
+  unique_ptr<KuduPartialRow> upper_bound;
+  RETURN_NOT_OK(ParseRangeBounds(context, *table, &lower_bound, &upper_bound));
+  set<string> tablet_ids;
+  RETURN_NOT_OK(GetRangeTabletIds(table.get(), *lower_bound, *upper_bound, &tablet_ids));
+  if (tablet_ids.empty()) {
+    return Status::NotFound(Substitute(
+        "table $0 has no range partition with bounds $1 and $2", table_name,
+        FindOrDie(context.required_args, kTableRangeLowerBoundArg),
+        FindOrDie(context.required_args, kTableRangeUpperBoundArg)));
+  }
+
+  // Create the staging table, which holds the rows of the range while it's
+  // replaced. It's partitioned as the range will be.
+  {
+    vector<string> range_columns;
+    const Schema& schema_internal = KuduSchema::ToSchema(schema);
+    for (const auto& column_id : table->partition_schema().range_schema().column_ids) {
+      range_columns.emplace_back(
+          schema_internal.column(schema_internal.find_column_by_id(column_id)).name());
+    }
+    unique_ptr<KuduTableCreator> creator(client->NewTableCreator());
+    creator->table_name(staging_table_name)
+        .schema(&schema)
+        .set_range_partition_columns(range_columns)
+        .add_custom_range_partition(NewRangePartition(
+            make_unique<KuduPartialRow>(*lower_bound), make_unique<KuduPartialRow>(*upper_bound),
+            KuduTableCreator::INCLUSIVE_BOUND, KuduTableCreator::EXCLUSIVE_BOUND,
+            hash_schema).release())
+        .num_replicas(table->num_replicas());
+    RETURN_NOT_OK_PREPEND(creator->Create(),
+                          Substitute("unable to create staging table $0", staging_table_name));
+  }
+
+  // Copy the rows of the range into the staging table.
+  cout << "Copying the rows of the range to staging table " << staging_table_name << endl;
+  {
+    TableScanner scanner(client, table_name, client, staging_table_name);
+    scanner.SetOutput(&cout);
+    scanner.SetScanBatchSize(FLAGS_scan_batch_size);
+    scanner.SetTabletIds(tablet_ids);
+    scanner.SetWriteType(KuduWriteOperation::INSERT);
+    RETURN_NOT_OK_PREPEND(scanner.StartCopy(), "unable to copy the rows of the range");
+  }
+
+  // Replace the range with one with the new hash schema in a single alteration,
+  // so that the writes to the range never fail. The rows of the range are
+  // missing from the table until they're copied back.
+  cout << "Replacing the range partition" << endl;
+  {
+    unique_ptr<KuduTableAlterer> alterer(client->NewTableAlterer(table_name));
+    alterer->DropRangePartition(new KuduPartialRow(*lower_bound),
+                                new KuduPartialRow(*upper_bound));
+    alterer->AddRangePartition(NewRangePartition(
+        std::move(lower_bound), std::move(upper_bound),
+        KuduTableCreator::INCLUSIVE_BOUND, KuduTableCreator::EXCLUSIVE_BOUND,
+        hash_schema).release());
+    RETURN_NOT_OK_PREPEND(alterer->Alter(), "unable to replace the range partition");
+  }
+
+  // Copy the rows back. The rows written to the range since it was replaced
+  // are more recent than those of the staging table, so they're kept.
+  cout << "Copying the rows of the range back from staging table "
+       << staging_table_name << endl;
+  {
+    TableScanner scanner(client, staging_table_name, client, table_name);
+    scanner.SetOutput(&cout);
+    scanner.SetScanBatchSize(FLAGS_scan_batch_size);
+    // All the tablets of the staging table, regardless of --tablets.
+    scanner.SetTabletIds({});
+    scanner.SetWriteType(KuduWriteOperation::INSERT_IGNORE);
+    RETURN_NOT_OK_PREPEND(scanner.StartCopy(), Substitute(
+        "unable to copy the rows of the range back: they're kept in $0", staging_table_name));
+  }
+  return client->DeleteTable(staging_table_name);
+}
+
 Status ParseValueOfType(const string& default_value,
                         KuduColumnSchema::DataType type,
                         KuduValue** value) {
@@ -1546,6 +1718,15 @@ Status ToClientEncodingType(
     case ColumnPB::BIT_SHUFFLE :
       *type = KuduColumnStorageAttributes::BIT_SHUFFLE;
       break;
+    case ColumnPB::FRAME_OF_REFERENCE :
+      *type = KuduColumnStorageAttributes::FRAME_OF_REFERENCE;
+      break;
+    case ColumnPB::ADAPTIVE_ENCODING :
+      *type = KuduColumnStorageAttributes::ADAPTIVE_ENCODING;
+      break;
+    case ColumnPB::XOR_ENCODING :
+      *type = KuduColumnStorageAttributes::XOR_ENCODING;
+      break;
     default :
       s = Status::InvalidArgument(Substitute("Unexpected encoding type: $0", type_pb));
   }
@@ -1572,6 +1753,9 @@ Status ToClientCompressionType(
     case ColumnPB::ZLIB :
       *type = KuduColumnStorageAttributes::ZLIB;
       break;
+    case ColumnPB::ZSTD :
+      *type = KuduColumnStorageAttributes::ZSTD;
+      break;
     default :
       s = Status::InvalidArgument(Substitute("Unexpected compression type: $0", type_pb));
   }
@@ -1942,6 +2126,7 @@ unique_ptr<Mode> BuildTableMode() {
       .AddOptionalParameter("predicates")
       .AddOptionalParameter("tablets")
       .AddOptionalParameter("replica_selection")
+      .AddOptionalParameter("split_size_bytes")
       .Build();
 
   unique_ptr<Action> copy_table =
@@ -1963,7 +2148,9 @@ unique_ptr<Mode> BuildTableMode() {
       .AddOptionalParameter("num_threads")
       .AddOptionalParameter("predicates")
       .AddOptionalParameter("scan_batch_size")
+      .AddOptionalParameter("split_size_bytes")
       .AddOptionalParameter("tablets")
+      .AddOptionalParameter("write_buffer_space_bytes")
       .AddOptionalParameter("write_type")
       .Build();
 
@@ -2016,6 +2203,33 @@ unique_ptr<Mode> BuildTableMode() {
       .AddOptionalParameter("hash_schema")
       .Build();
 
+  unique_ptr<Action> rebucket_range_partition =
+      ClusterActionBuilder("rebucket_range_partition", &RebucketRangePartition)
+      .Description("Change the hash schema of a range partition of a table")
+      .ExtraDescription("Replace a range partition of a table with one with the hash "
+                        "schema of --hash_schema, e.g. to spread the writes to a hot "
+                        "range over more buckets, keeping its rows. The rows of the "
+                        "range are copied to a staging table, then the range is replaced "
+                        "and the rows are copied back, keeping the rows written to the "
+                        "new range in the meantime. The writes to the range made while "
+                        "the rows are copied to the staging table are lost, so they should "
+                        "be paused for that time, and the scans of the range miss rows "
+                        "until they're copied back. The bounds of the range are inclusive "
+                        "and exclusive, as by default for add_range_partition.")
+      .AddRequiredParameter({ kTableNameArg, "Name of the table" })
+      .AddRequiredParameter({ kTableRangeLowerBoundArg,
+                              "String representation of lower bound of "
+                              "the table range partition as a JSON array" })
+      .AddRequiredParameter({ kTableRangeUpperBoundArg,
+                              "String representation of upper bound of "
+                              "the table range partition as a JSON array" })
+      .AddOptionalParameter("hash_schema")
+      .AddOptionalParameter("num_threads")
+      .AddOptionalParameter("scan_batch_size")
+      .AddOptionalParameter("staging_table")
+      .AddOptionalParameter("write_buffer_space_bytes")
+      .Build();
+
   unique_ptr<Action> column_set_default =
       ClusterActionBuilder("column_set_default", &ColumnSetDefault)
       .Description("Set write_default value for a column")
@@ -2145,6 +2359,7 @@ unique_ptr<Mode> BuildTableMode() {
       .AddAction(std::move(list_tables))
       .AddAction(std::move(locate_row))
       .AddAction(std::move(recall))
+      .AddAction(std::move(rebucket_range_partition))
       .AddAction(std::move(rename_column))
       .AddAction(std::move(rename_table))
       .AddAction(std::move(scan_table))
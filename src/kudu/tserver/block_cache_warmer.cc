@@ -0,0 +1,220 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/tserver/block_cache_warmer.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_cache.h"
+#include "kudu/cfile/cfile_reader.h"
+#include "kudu/fs/block_id.h"
+#include "kudu/fs/block_manager.h"
+#include "kudu/fs/fs_manager.h"
+#include "kudu/fs/io_context.h"
+#include "kudu/gutil/map-util.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/tablet_metadata.h"
+#include "kudu/tablet/tablet_replica.h"
+#include "kudu/tserver/ts_tablet_manager.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/thread.h"
+
+DEFINE_bool(block_cache_warmup_enabled, false,
+            "Whether to save the keys of the blocks in the block cache into a "
+            "manifest under --fs_metadata_dir, and to read those blocks back "
+            "into the block cache after the tablet server restarts, once its "
+            "tablets are bootstrapped.");
+TAG_FLAG(block_cache_warmup_enabled, experimental);
+
+DEFINE_int32(block_cache_manifest_save_interval_secs, 600,
+             "How often to save the block cache manifest, in seconds, if "
+             "--block_cache_warmup_enabled is set. The manifest is also saved "
+             "when the tablet server shuts down. If 0, the manifest is only "
+             "saved at shutdown.");
+TAG_FLAG(block_cache_manifest_save_interval_secs, experimental);
+
+DEFINE_int32(block_cache_warmup_max_mb_per_sec, 50,
+             "The maximum rate, in MB of data blocks per second, at which the "
+             "block cache is warmed up after a restart. If 0, the rate isn't "
+             "limited.");
+TAG_FLAG(block_cache_warmup_max_mb_per_sec, experimental);
+TAG_FLAG(block_cache_warmup_max_mb_per_sec, runtime);
+
+using kudu::cfile::BlockCache;
+using kudu::cfile::CFileReader;
+using kudu::cfile::ReaderOptions;
+using kudu::fs::IOContext;
+using kudu::fs::ReadableBlock;
+using kudu::tablet::TabletReplica;
+using std::string;
+using std::unique_ptr;
+using std::unordered_map;
+using std::unordered_set;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tserver {
+
+BlockCacheWarmer::BlockCacheWarmer(FsManager* fs_manager, TSTabletManager* tablet_manager)
+    : fs_manager_(fs_manager),
+      tablet_manager_(tablet_manager),
+      shutdown_latch_(1),
+      warmed_up_(false),
+      warmup_bytes_(0) {
+}
+
+BlockCacheWarmer::~BlockCacheWarmer() {
+  Shutdown();
+}
+
+Status BlockCacheWarmer::Start() {
+  return Thread::Create("tserver", "block-cache-warmer",
+                        [this]() { this->Run(); }, &thread_);
+}
+
+void BlockCacheWarmer::Shutdown() {
+  if (!thread_) {
+    return;
+  }
+  shutdown_latch_.CountDown();
+  CHECK_OK(ThreadJoiner(thread_.get()).Join());
+  thread_.reset();
+  if (warmed_up_) {
+    WARN_NOT_OK(SaveManifest(), "unable to save the block cache manifest");
+  }
+}
+
+void BlockCacheWarmer::Run() {
+  const Status s = WarmUp();
+  if (s.IsAborted()) {
+    return;
+  }
+  WARN_NOT_OK(s, "unable to warm up the block cache");
+  warmed_up_ = true;
+
+  if (FLAGS_block_cache_manifest_save_interval_secs <= 0) {
+    return;
+  }
+  const MonoDelta interval =
+      MonoDelta::FromSeconds(FLAGS_block_cache_manifest_save_interval_secs);
+  while (!shutdown_latch_.WaitFor(interval)) {
+    WARN_NOT_OK(SaveManifest(), "unable to save the block cache manifest");
+  }
+}
+
+Status BlockCacheWarmer::WarmUp() {
+  // Don't compete with the bootstrap for I/O: it's what makes the tablets
+  // available in the first place. Whether or not it succeeded, the tablets
+  // which did bootstrap are worth warming up.
+  ignore_result(tablet_manager_->WaitForAllBootstrapsToFinish());
+
+  vector<BlockCache::CacheKey> keys;
+  const string path = fs_manager_->GetBlockCacheManifestPath();
+  Status s = BlockCache::LoadManifest(fs_manager_->GetEnv(), path, &keys);
+  if (s.IsNotFound()) {
+    return Status::OK();
+  }
+  RETURN_NOT_OK_PREPEND(s, Substitute("unable to load block cache manifest $0", path));
+
+  // Only warm up the blocks which still belong to a tablet: the others were
+  // deleted since the manifest was saved, e.g. by compactions. The tablet
+  // is needed anyway to handle the corruption of a block.
+  unordered_map<BlockId, string, BlockIdHash> tablet_by_block;
+  vector<scoped_refptr<TabletReplica>> replicas;
+  tablet_manager_->GetTabletReplicas(&replicas);
+  for (const auto& replica : replicas) {
+    for (const auto& block_id : replica->tablet_metadata()->CollectBlockIds()) {
+      tablet_by_block.emplace(block_id, replica->tablet_id());
+    }
+  }
+
+  // Group the offsets by file, keeping the files in the manifest's order.
+  vector<BlockId> files;
+  unordered_map<BlockId, unordered_set<uint64_t>, BlockIdHash> offsets_by_file;
+  for (const auto& key : keys) {
+    const BlockId block_id(key.file_id_);
+    if (!ContainsKey(tablet_by_block, block_id)) {
+      continue;
+    }
+    auto& offsets = offsets_by_file[block_id];
+    if (offsets.empty()) {
+      files.push_back(block_id);
+    }
+    offsets.insert(key.offset_);
+  }
+
+  LOG(INFO) << Substitute("Warming up the block cache with $0 blocks from $1 files",
+                          keys.size(), files.size());
+  warmup_start_ = MonoTime::Now();
+  for (const auto& block_id : files) {
+    unique_ptr<ReadableBlock> block;
+    s = fs_manager_->OpenBlock(block_id, &block);
+    if (s.IsNotFound()) {
+      continue;
+    }
+    RETURN_NOT_OK(s);
+    unique_ptr<CFileReader> reader;
+    RETURN_NOT_OK(CFileReader::OpenNoInit(std::move(block), ReaderOptions(), &reader));
+    const IOContext io_context({ FindOrDie(tablet_by_block, block_id) });
+    s = reader->WarmBlockCache(&io_context, FindOrDie(offsets_by_file, block_id),
+                               [this](size_t size) { return this->Throttle(size); });
+    if (s.IsAborted()) {
+      return s;
+    }
+    WARN_NOT_OK(s, Substitute("unable to warm up the block cache with block $0",
+                              block_id.ToString()));
+  }
+  LOG(INFO) << Substitute("Warmed up the block cache with $0 bytes of data blocks in $1",
+                          warmup_bytes_, (MonoTime::Now() - warmup_start_).ToString());
+  return Status::OK();
+}
+
+Status BlockCacheWarmer::Throttle(size_t size) {
+  if (shutdown_latch_.count() == 0) {
+    return Status::Aborted("tablet server is shutting down");
+  }
+  warmup_bytes_ += size;
+  const int32_t max_mb_per_sec = FLAGS_block_cache_warmup_max_mb_per_sec;
+  if (max_mb_per_sec <= 0) {
+    return Status::OK();
+  }
+  const MonoDelta budget = MonoDelta::FromSeconds(
+      static_cast<double>(warmup_bytes_) / (max_mb_per_sec * 1024 * 1024));
+  const MonoDelta elapsed = MonoTime::Now() - warmup_start_;
+  if (elapsed < budget && shutdown_latch_.WaitFor(budget - elapsed)) {
+    return Status::Aborted("tablet server is shutting down");
+  }
+  return Status::OK();
+}
+
+Status BlockCacheWarmer::SaveManifest() {
+  return BlockCache::GetSingleton()->SaveManifest(fs_manager_->GetEnv(),
+                                                  fs_manager_->GetBlockCacheManifestPath());
+}
+
+} // namespace tserver
+} // namespace kudu
@@ -0,0 +1,86 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class FsManager;
+class Thread;
+
+namespace tserver {
+
+class TSTabletManager;
+
+// Keeps the block cache warm across restarts of the tablet server.
+//
+// The keys of the cached blocks are saved into a manifest periodically and
+// at shutdown. On startup, once the tablets are bootstrapped, the blocks
+// listed in the manifest which still belong to a tablet are read back into
+// the block cache in the background, at a limited rate so that the reads
+// don't compete with the serving workload.
+class BlockCacheWarmer {
+ public:
+  BlockCacheWarmer(FsManager* fs_manager, TSTabletManager* tablet_manager);
+  ~BlockCacheWarmer();
+
+  // Starts the thread warming up the block cache, then saving its manifest.
+  Status Start();
+
+  // Stops the thread, and saves the manifest unless the block cache wasn't
+  // done warming up.
+  void Shutdown();
+
+ private:
+  void Run();
+
+  // Reads the blocks listed in the manifest into the block cache.
+  Status WarmUp();
+
+  // Waits as needed to keep the warm-up under its maximum rate, accounting
+  // for 'size' more bytes. Returns Aborted if shutting down.
+  Status Throttle(size_t size);
+
+  Status SaveManifest();
+
+  FsManager* const fs_manager_;
+  TSTabletManager* const tablet_manager_;
+
+  scoped_refptr<Thread> thread_;
+  CountDownLatch shutdown_latch_;
+
+  // Whether the block cache is done warming up, after which the manifest may
+  // be overwritten.
+  std::atomic<bool> warmed_up_;
+
+  // The start of the warm-up, and the bytes it has read since then.
+  MonoTime warmup_start_;
+  size_t warmup_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockCacheWarmer);
+};
+
+} // namespace tserver
+} // namespace kudu
@@ -406,6 +406,12 @@ int Heartbeater::Thread::GetMinimumHeartbeatMillis() const {
 }
 
 int Heartbeater::Thread::GetMillisUntilNextHeartbeat() const {
+  // If the master deferred our full tablet report, it's busy processing the
+  // reports of other tablet servers: don't add to its load.
+  if (last_hb_response_.tablet_report_deferred()) {
+    return FLAGS_heartbeat_interval_ms;
+  }
+
   // If the master needs something from us, we should immediately
   // send another heartbeat with that info, rather than waiting for the interval.
   if (last_hb_response_.needs_reregister() ||
@@ -493,7 +499,7 @@ Status Heartbeater::Thread::DoHeartbeat(MasterErrorPB* error,
     // full tablet report. As such, send_full_tablet_report_ is only reset
     // after all error checking is complete.
   } else if (last_hb_response_.needs_full_tablet_report()) {
-    LOG(INFO) << Substitute(
+    LOG_IF(INFO, !last_hb_response_.tablet_report_deferred()) << Substitute(
         "Master $0 requested a full tablet report, sending...",
         master_address_.ToString());
     GenerateFullTabletReport(req.mutable_tablet_report());
@@ -578,7 +584,11 @@ Status Heartbeater::Thread::DoHeartbeat(MasterErrorPB* error,
         "failed to import token signing public keys from master heartbeat");
   }
 
-  MarkTabletReportAcknowledged(req.tablet_report());
+  // A deferred report wasn't processed: the tablets it includes are still to
+  // be reported.
+  if (!last_hb_response_.tablet_report_deferred()) {
+    MarkTabletReportAcknowledged(req.tablet_report());
+  }
   return Status::OK();
 }
 
@@ -0,0 +1,99 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/tserver/quota_manager.h"
+
+#include <cstdint>
+
+#include <gflags/gflags_declare.h>
+#include <gtest/gtest.h>
+
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_int64(table_quota_scan_bytes_per_sec);
+DECLARE_int64(user_quota_write_ops_per_sec);
+
+METRIC_DECLARE_counter(quota_scan_rejections);
+METRIC_DECLARE_counter(quota_write_rejections);
+
+namespace kudu {
+namespace tserver {
+
+class QuotaManagerTest : public KuduTest {
+ public:
+  QuotaManagerTest()
+      : metric_entity_(METRIC_ENTITY_server.Instantiate(&registry_, "quota_manager-test")) {
+  }
+
+ protected:
+  int64_t CounterValue(const CounterPrototype& proto) {
+    return proto.Instantiate(metric_entity_)->value();
+  }
+
+  MetricRegistry registry_;
+  scoped_refptr<MetricEntity> metric_entity_;
+};
+
+TEST_F(QuotaManagerTest, TestUnlimited) {
+  QuotaManager quotas(metric_entity_);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(quotas.ChargeWrite("alice", "table"));
+    ASSERT_OK(quotas.ChargeScan("alice", "table", 1 << 20));
+  }
+}
+
+// With 10 writes per second, a user may write once per 100ms refill period.
+TEST_F(QuotaManagerTest, TestUserWriteQuota) {
+  FLAGS_user_quota_write_ops_per_sec = 10;
+  QuotaManager quotas(metric_entity_);
+  ASSERT_OK(quotas.ChargeWrite("alice", "table"));
+  Status s = quotas.ChargeWrite("alice", "other-table");
+  ASSERT_TRUE(s.IsServiceUnavailable()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "user alice");
+  ASSERT_EQ(1, CounterValue(METRIC_quota_write_rejections));
+
+  // Other users have their own quota.
+  ASSERT_OK(quotas.ChargeWrite("bob", "table"));
+
+  // The quota is refilled over time.
+  ASSERT_EVENTUALLY([&] {
+    ASSERT_OK(quotas.ChargeWrite("alice", "table"));
+  });
+}
+
+TEST_F(QuotaManagerTest, TestTableScanQuota) {
+  FLAGS_table_quota_scan_bytes_per_sec = 10 * 1024;
+  QuotaManager quotas(metric_entity_);
+
+  // A batch bigger than the bucket takes the full bucket, rather than never
+  // being allowed.
+  ASSERT_OK(quotas.ChargeScan("alice", "table", 1 << 20));
+  Status s = quotas.ChargeScan("bob", "table", 1);
+  ASSERT_TRUE(s.IsServiceUnavailable()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "table quota exceeded");
+  ASSERT_EQ(1, CounterValue(METRIC_quota_scan_rejections));
+  ASSERT_EQ(0, CounterValue(METRIC_quota_write_rejections));
+
+  // Other tables have their own quota.
+  ASSERT_OK(quotas.ChargeScan("bob", "other-table", 1024));
+}
+
+} // namespace tserver
+} // namespace kudu
@@ -0,0 +1,151 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/tserver/quota_manager.h"
+
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/logging.h"
+
+DEFINE_int64(user_quota_write_ops_per_sec, 0,
+             "Maximum number of write RPCs per second that a user may send to "
+             "the tablets of a tablet server. Writes beyond it are rejected as "
+             "too busy and retried by the clients. 0 means no limit.");
+TAG_FLAG(user_quota_write_ops_per_sec, experimental);
+
+DEFINE_int64(table_quota_write_ops_per_sec, 0,
+             "Maximum number of write RPCs per second that the tablets of a "
+             "table hosted by a tablet server may receive, from all users. "
+             "Writes beyond it are rejected as too busy and retried by the "
+             "clients. 0 means no limit.");
+TAG_FLAG(table_quota_write_ops_per_sec, experimental);
+
+DEFINE_int64(user_quota_scan_bytes_per_sec, 0,
+             "Maximum number of bytes per second that a user may scan from the "
+             "tablets of a tablet server, as sized by the scan batches. Scan "
+             "requests beyond it are rejected as too busy and retried by the "
+             "clients. 0 means no limit.");
+TAG_FLAG(user_quota_scan_bytes_per_sec, experimental);
+
+DEFINE_int64(table_quota_scan_bytes_per_sec, 0,
+             "Maximum number of bytes per second that may be scanned from the "
+             "tablets of a table hosted by a tablet server, by all users, as "
+             "sized by the scan batches. Scan requests beyond it are rejected "
+             "as too busy and retried by the clients. 0 means no limit.");
+TAG_FLAG(table_quota_scan_bytes_per_sec, experimental);
+
+DEFINE_double(quota_burst_factor, 1.0,
+              "Burst factor of the per-user and per-table quotas: the amount "
+              "allowed within one 100ms refill period is the per-second quota "
+              "times this factor, divided by 10.");
+TAG_FLAG(quota_burst_factor, experimental);
+
+METRIC_DEFINE_counter(server, quota_write_rejections,
+                      "Writes Rejected by Quotas",
+                      kudu::MetricUnit::kRequests,
+                      "Number of write requests rejected because their user or "
+                      "table exceeded its write quota",
+                      kudu::MetricLevel::kWarn);
+
+METRIC_DEFINE_counter(server, quota_scan_rejections,
+                      "Scans Rejected by Quotas",
+                      kudu::MetricUnit::kRequests,
+                      "Number of scan requests rejected because their user or "
+                      "table exceeded its scan quota",
+                      kudu::MetricLevel::kWarn);
+
+using std::string;
+using strings::Substitute;
+
+namespace kudu {
+namespace tserver {
+
+QuotaManager::QuotaManager(const scoped_refptr<MetricEntity>& metric_entity)
+    : user_write_ops_(FLAGS_user_quota_write_ops_per_sec),
+      table_write_ops_(FLAGS_table_quota_write_ops_per_sec),
+      user_scan_bytes_(FLAGS_user_quota_scan_bytes_per_sec),
+      table_scan_bytes_(FLAGS_table_quota_scan_bytes_per_sec),
+      write_rejections_(METRIC_quota_write_rejections.Instantiate(metric_entity)),
+      scan_rejections_(METRIC_quota_scan_rejections.Instantiate(metric_entity)) {
+}
+
+bool QuotaManager::Take(Quota* quota, const string& key, int64_t amount, MonoTime now) {
+  if (quota->rate <= 0) {
+    return true;
+  }
+  Throttler* throttler;
+  {
+    std::lock_guard<simple_spinlock> l(quota->lock);
+    auto& t = quota->throttlers[key];
+    if (!t) {
+      t.reset(new Throttler(now, 0, quota->rate, FLAGS_quota_burst_factor));
+    }
+    throttler = t.get();
+  }
+  // Same as the maximum number of tokens of the throttler's bucket.
+  const int64_t refill = quota->rate /
+      (MonoTime::kMicrosecondsPerSecond / Throttler::kRefillPeriodMicros);
+  const int64_t max_amount = std::max<int64_t>(
+      1, static_cast<int64_t>(refill * FLAGS_quota_burst_factor));
+  return throttler->Take(now, 0, std::min(amount, max_amount));
+}
+
+Status QuotaManager::ChargeWrite(const string& user, const string& table_id) {
+  MonoTime now = MonoTime::Now();
+  const char* exceeded = nullptr;
+  if (!Take(&user_write_ops_, user, 1, now)) {
+    exceeded = "user";
+  } else if (!Take(&table_write_ops_, table_id, 1, now)) {
+    exceeded = "table";
+  }
+  if (PREDICT_TRUE(exceeded == nullptr)) {
+    return Status::OK();
+  }
+  write_rejections_->Increment();
+  string msg = Substitute("write of user $0 to table $1 rejected: $2 write quota exceeded",
+                          user, table_id, exceeded);
+  KLOG_EVERY_N_SECS(WARNING, 1) << msg << THROTTLE_MSG;
+  return Status::ServiceUnavailable(msg);
+}
+
+Status QuotaManager::ChargeScan(const string& user, const string& table_id,
+                                int64_t num_bytes) {
+  MonoTime now = MonoTime::Now();
+  const char* exceeded = nullptr;
+  if (!Take(&user_scan_bytes_, user, num_bytes, now)) {
+    exceeded = "user";
+  } else if (!Take(&table_scan_bytes_, table_id, num_bytes, now)) {
+    exceeded = "table";
+  }
+  if (PREDICT_TRUE(exceeded == nullptr)) {
+    return Status::OK();
+  }
+  scan_rejections_->Increment();
+  string msg = Substitute("scan of user $0 on table $1 rejected: $2 scan quota exceeded",
+                          user, table_id, exceeded);
+  KLOG_EVERY_N_SECS(WARNING, 1) << msg << THROTTLE_MSG;
+  return Status::ServiceUnavailable(msg);
+}
+
+} // namespace tserver
+} // namespace kudu
@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/status.h"
+#include "kudu/util/throttler.h"
+
+namespace kudu {
+namespace tserver {
+
+// Enforces the per-user and per-table resource quotas of a tablet server, set
+// with the --user_quota_* and --table_quota_* flags, using a token bucket for
+// each user and each table. The quotas apply to each tablet server on its own,
+// to the tablets it hosts.
+//
+// This class is thread-safe.
+class QuotaManager {
+ public:
+  explicit QuotaManager(const scoped_refptr<MetricEntity>& metric_entity);
+
+  // Charges a write RPC of 'user' to table 'table_id' against their quotas.
+  // Returns ServiceUnavailable if either is exceeded, in which case the write
+  // must be rejected and retried later.
+  Status ChargeWrite(const std::string& user, const std::string& table_id);
+
+  // Charges a scan batch of up to 'num_bytes' of 'user' on table 'table_id'
+  // against their quotas. Returns ServiceUnavailable if either is exceeded, in
+  // which case the batch must not be scanned.
+  Status ChargeScan(const std::string& user, const std::string& table_id,
+                    int64_t num_bytes);
+
+ private:
+  typedef std::unordered_map<std::string, std::unique_ptr<Throttler>> ThrottlerMap;
+
+  // A quota on some resource, with a bucket per user or per table.
+  struct Quota {
+    explicit Quota(int64_t rate) : rate(rate) {}
+
+    // The allowed amount of the resource per second, or 0 if unlimited.
+    const int64_t rate;
+
+    // Protects 'throttlers'.
+    simple_spinlock lock;
+    ThrottlerMap throttlers;
+  };
+
+  // Takes 'amount' from the bucket of 'key' in 'quota'. An amount bigger than
+  // a bucket may ever hold takes the full bucket.
+  static bool Take(Quota* quota, const std::string& key, int64_t amount, MonoTime now);
+
+  Quota user_write_ops_;
+  Quota table_write_ops_;
+  Quota user_scan_bytes_;
+  Quota table_scan_bytes_;
+
+  scoped_refptr<Counter> write_rejections_;
+  scoped_refptr<Counter> scan_rejections_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuotaManager);
+};
+
+} // namespace tserver
+} // namespace kudu
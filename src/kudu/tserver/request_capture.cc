@@ -0,0 +1,153 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/tserver/request_capture.h"
+
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/partition.h"
+#include "kudu/gutil/walltime.h"
+#include "kudu/tablet/tablet_metadata.h"
+#include "kudu/tablet/tablet_replica.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/env.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/pb_util.h"
+#include "kudu/util/random_util.h"
+#include "kudu/util/status.h"
+
+DEFINE_string(request_capture_path, "",
+              "Path of the file into which to capture a sample of the write and "
+              "scan requests received by the tablet server, to replay them later "
+              "on with 'kudu perf replay'. The file is created anew whenever "
+              "this changes. If empty, no requests are captured.");
+TAG_FLAG(request_capture_path, experimental);
+TAG_FLAG(request_capture_path, runtime);
+
+DEFINE_double(request_capture_sampling_rate, 0,
+              "The fraction of the write and scan requests captured into "
+              "--request_capture_path. If 0, no requests are captured.");
+TAG_FLAG(request_capture_sampling_rate, experimental);
+TAG_FLAG(request_capture_sampling_rate, runtime);
+
+using kudu::pb_util::WritablePBContainerFile;
+using kudu::tablet::TabletReplica;
+using std::string;
+using std::unique_ptr;
+
+namespace kudu {
+namespace tserver {
+
+RequestCapture::RequestCapture(Env* env)
+    : env_(env),
+      rng_(GetRandomSeed32()) {
+}
+
+RequestCapture::~RequestCapture() {
+  if (file_) {
+    WARN_NOT_OK(file_->Close(), "could not close the request capture file");
+  }
+}
+
+bool RequestCapture::ShouldSample() {
+  const double rate = FLAGS_request_capture_sampling_rate;
+  return PREDICT_FALSE(rate > 0) && (rate >= 1 || rng_.NextDoubleFraction() < rate);
+}
+
+void RequestCapture::MaybeCaptureWrite(const TabletReplica& replica, const WriteRequestPB& req) {
+  // The writes of multi-row transactions can't be replayed without their
+  // transactions.
+  if (!ShouldSample() || req.has_txn_id()) {
+    return;
+  }
+  CapturedRequestPB captured;
+  WriteRequestPB* write = captured.mutable_write();
+  *write = req;
+  write->clear_authz_token();
+  write->clear_propagated_timestamp();
+  write->clear_trace_id();
+  Append(replica, &captured);
+}
+
+void RequestCapture::MaybeCaptureScan(const TabletReplica& replica, const ScanRequestPB& req) {
+  if (!ShouldSample()) {
+    return;
+  }
+  CapturedRequestPB captured;
+  ScanRequestPB* scan = captured.mutable_scan();
+  *scan = req;
+  // Let the cluster the scan is replayed against pick the timestamps of the
+  // scan, since those of this one might be outside of its history.
+  NewScanRequestPB* new_scan = scan->mutable_new_scan_request();
+  new_scan->clear_authz_token();
+  new_scan->clear_propagated_timestamp();
+  new_scan->clear_snap_timestamp();
+  new_scan->clear_snap_start_timestamp();
+  Append(replica, &captured);
+}
+
+void RequestCapture::Append(const TabletReplica& replica, CapturedRequestPB* captured) {
+  captured->set_received_unix_micros(GetCurrentTimeMicros());
+  captured->set_table_name(replica.tablet_metadata()->table_name());
+  replica.tablet_metadata()->partition().ToPB(captured->mutable_partition());
+
+  std::lock_guard<Mutex> l(lock_);
+  const string& path = FLAGS_request_capture_path;
+  if (path != path_) {
+    if (file_) {
+      WARN_NOT_OK(file_->Close(), "could not close the request capture file");
+      file_.reset();
+    }
+    path_ = path;
+    if (path_.empty()) {
+      return;
+    }
+    RWFileOptions opts;
+    opts.is_sensitive = true;
+    unique_ptr<RWFile> rwf;
+    Status s = env_->NewRWFile(opts, path_, &rwf);
+    unique_ptr<WritablePBContainerFile> file;
+    if (s.ok()) {
+      file.reset(new WritablePBContainerFile(std::move(rwf)));
+      s = file->CreateNew(*captured);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "could not create request capture file " << path_ << ": " << s.ToString();
+      return;
+    }
+    LOG(INFO) << "capturing requests into " << path_;
+    file_ = std::move(file);
+  }
+  if (!file_) {
+    return;
+  }
+  Status s = file_->Append(*captured);
+  if (!s.ok()) {
+    // Stop capturing until the path changes rather than leaving a gap.
+    LOG(WARNING) << "could not capture request into " << path_ << ": " << s.ToString();
+    WARN_NOT_OK(file_->Close(), "could not close the request capture file");
+    file_.reset();
+  }
+}
+
+} // namespace tserver
+} // namespace kudu
@@ -0,0 +1,88 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/mutex.h"
+#include "kudu/util/random.h"
+
+namespace kudu {
+
+class Env;
+
+namespace pb_util {
+class WritablePBContainerFile;
+} // namespace pb_util
+
+namespace tablet {
+class TabletReplica;
+} // namespace tablet
+
+namespace tserver {
+
+class CapturedRequestPB;
+class ScanRequestPB;
+class WriteRequestPB;
+
+// Captures a sample of the write and scan requests received by a tablet
+// server into a PB container file of CapturedRequestPB, so that the workload
+// can be replayed against another cluster with 'kudu perf replay'.
+//
+// The capture is controlled at runtime with --request_capture_path and
+// --request_capture_sampling_rate: the file is created anew whenever the
+// path changes.
+//
+// This class is thread-safe.
+class RequestCapture {
+ public:
+  explicit RequestCapture(Env* env);
+  ~RequestCapture();
+
+  // Captures 'req', sent to 'replica', if it's sampled.
+  void MaybeCaptureWrite(const tablet::TabletReplica& replica, const WriteRequestPB& req);
+
+  // Captures the new scan request 'req', sent to 'replica', if it's sampled.
+  void MaybeCaptureScan(const tablet::TabletReplica& replica, const ScanRequestPB& req);
+
+ private:
+  // Returns whether the next request should be captured.
+  bool ShouldSample();
+
+  // Appends 'captured' to the file, creating the file first if the flags
+  // point to a new one.
+  void Append(const tablet::TabletReplica& replica, CapturedRequestPB* captured);
+
+  Env* const env_;
+  ThreadSafeRandom rng_;
+
+  // Protects the fields below.
+  Mutex lock_;
+
+  // The path of the file being written, or which failed to be written.
+  std::string path_;
+
+  // The file being written, or null if it failed to be written.
+  std::unique_ptr<pb_util::WritablePBContainerFile> file_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestCapture);
+};
+
+} // namespace tserver
+} // namespace kudu
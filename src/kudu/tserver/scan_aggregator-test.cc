@@ -0,0 +1,218 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tserver/scan_aggregator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/row.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/wire_protocol.h"
+#include "kudu/common/wire_protocol.pb.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+namespace tserver {
+
+class ScanAggregatorTest : public KuduTest {
+ public:
+  ScanAggregatorTest()
+      : schema_({ ColumnSchema("key", INT32),
+                  ColumnSchema("grp", STRING, /*is_nullable=*/true),
+                  ColumnSchema("val", INT64, /*is_nullable=*/true) }, 1) {
+  }
+
+ protected:
+  static void AddAggregate(AggregationSpecPB* spec, AggregatePB::Type type, int col_idx = -1) {
+    AggregatePB* agg = spec->add_aggregates();
+    agg->set_type(type);
+    if (col_idx >= 0) {
+      agg->set_column_idx(col_idx);
+    }
+  }
+
+  // Aggregates 'num_rows' rows whose key is their index, whose group is
+  // "g<key % 3>" (or null if key % 3 == 2), and whose value is the key (or
+  // null if key % 5 == 4). Only the rows with an even key are selected.
+  void AggregateRows(ScanAggregator* aggregator, int num_rows) {
+    RowBlockMemory mem;
+    RowBlock block(&schema_, num_rows, &mem);
+    const string groups[] = { "g0", "g1" };
+    for (int i = 0; i < num_rows; i++) {
+      RowBlockRow row = block.row(i);
+      *reinterpret_cast<int32_t*>(row.mutable_cell_ptr(0)) = i;
+      const bool grp_null = i % 3 == 2;
+      row.cell(1).set_null(grp_null);
+      if (!grp_null) {
+        *reinterpret_cast<Slice*>(row.mutable_cell_ptr(1)) = Slice(groups[i % 3]);
+      }
+      const bool val_null = i % 5 == 4;
+      row.cell(2).set_null(val_null);
+      if (!val_null) {
+        *reinterpret_cast<int64_t*>(row.mutable_cell_ptr(2)) = i;
+      }
+      if (i % 2 == 1) {
+        block.selection_vector()->SetRowUnselected(i);
+      }
+    }
+    aggregator->AddRowBlock(block);
+  }
+
+  // Serializes the results of 'aggregator' and returns them as strings.
+  static vector<string> Results(ScanAggregator* aggregator) {
+    faststring rows_data;
+    faststring indirect_data;
+    RowwiseRowBlockPB pb;
+    pb.set_num_rows(aggregator->SerializeResults(&rows_data, &indirect_data));
+    Slice rows_slice(rows_data);
+    vector<const uint8_t*> rows;
+    CHECK_OK(ExtractRowsFromRowBlockPB(aggregator->result_schema(), pb, indirect_data,
+                                       &rows_slice, &rows));
+    vector<string> results;
+    for (const uint8_t* row : rows) {
+      results.emplace_back(aggregator->result_schema().DebugRow(
+          ConstContiguousRow(&aggregator->result_schema(), row)));
+    }
+    std::sort(results.begin(), results.end());
+    return results;
+  }
+
+  const Schema schema_;
+};
+
+TEST_F(ScanAggregatorTest, TestAggregatesWithoutGroupBy) {
+  AggregationSpecPB spec;
+  AddAggregate(&spec, AggregatePB::COUNT);
+  AddAggregate(&spec, AggregatePB::COUNT, 2);
+  AddAggregate(&spec, AggregatePB::SUM, 2);
+  AddAggregate(&spec, AggregatePB::MIN, 2);
+  AddAggregate(&spec, AggregatePB::MAX, 2);
+  unique_ptr<ScanAggregator> aggregator;
+  ASSERT_OK(ScanAggregator::Create(spec, schema_, schema_, &aggregator));
+  ASSERT_EQ(5, aggregator->result_schema().num_columns());
+
+  // Even keys in [0, 10) are 0, 2, 4, 6, 8, of which 4 has a null value.
+  NO_FATALS(AggregateRows(aggregator.get(), 10));
+  ASSERT_EQ(1, aggregator->num_groups());
+  const vector<string> expected = {
+    "(int64 count(*)=5, int64 count(val)=4, decimal sum(val)=16, "
+    "int64 min(val)=0, int64 max(val)=8)" };
+  ASSERT_EQ(expected, Results(aggregator.get()));
+
+  // Without any row, the aggregates still have a result row.
+  const vector<string> expected_empty = {
+    "(int64 count(*)=0, int64 count(val)=0, decimal sum(val)=NULL, "
+    "int64 min(val)=NULL, int64 max(val)=NULL)" };
+  ASSERT_EQ(expected_empty, Results(aggregator.get()));
+}
+
+TEST_F(ScanAggregatorTest, TestGroupBy) {
+  AggregationSpecPB spec;
+  spec.add_group_by_column_idx(1);
+  AddAggregate(&spec, AggregatePB::COUNT);
+  AddAggregate(&spec, AggregatePB::SUM, 2);
+  AddAggregate(&spec, AggregatePB::MIN, 1);
+  AddAggregate(&spec, AggregatePB::MAX, 1);
+  unique_ptr<ScanAggregator> aggregator;
+  ASSERT_OK(ScanAggregator::Create(spec, schema_, schema_, &aggregator));
+
+  // The selected keys in [0, 12) are 0, 6 in "g0", 4, 10 in "g1", and 2, 8 in
+  // the null group.
+  NO_FATALS(AggregateRows(aggregator.get(), 12));
+  ASSERT_EQ(3, aggregator->num_groups());
+  const vector<string> expected = {
+    R"((string grp="g0", int64 count(*)=2, decimal sum(val)=6, )"
+    R"(string min(grp)="g0", string max(grp)="g0"))",
+    R"((string grp="g1", int64 count(*)=2, decimal sum(val)=10, )"
+    R"(string min(grp)="g1", string max(grp)="g1"))",
+    R"((string grp=NULL, int64 count(*)=2, decimal sum(val)=10, )"
+    R"(string min(grp)=NULL, string max(grp)=NULL))" };
+  ASSERT_EQ(expected, Results(aggregator.get()));
+
+  // With grouping, no row means no group.
+  ASSERT_EQ(0, aggregator->num_groups());
+  ASSERT_TRUE(Results(aggregator.get()).empty());
+}
+
+TEST_F(ScanAggregatorTest, TestStringMinMaxAcrossBlocks) {
+  AggregationSpecPB spec;
+  AddAggregate(&spec, AggregatePB::MIN, 1);
+  AddAggregate(&spec, AggregatePB::MAX, 1);
+  unique_ptr<ScanAggregator> aggregator;
+  ASSERT_OK(ScanAggregator::Create(spec, schema_, schema_, &aggregator));
+
+  // The values of the first block must remain valid after it's gone.
+  NO_FATALS(AggregateRows(aggregator.get(), 1));
+  NO_FATALS(AggregateRows(aggregator.get(), 10));
+  const vector<string> expected = {
+    R"((string min(grp)="g0", string max(grp)="g1"))" };
+  ASSERT_EQ(expected, Results(aggregator.get()));
+}
+
+TEST_F(ScanAggregatorTest, TestInvalidSpecs) {
+  unique_ptr<ScanAggregator> aggregator;
+  {
+    AggregationSpecPB spec;
+    ASSERT_TRUE(ScanAggregator::Create(spec, schema_, schema_, &aggregator).IsInvalidArgument());
+  }
+  {
+    AggregationSpecPB spec;
+    AddAggregate(&spec, AggregatePB::SUM);
+    ASSERT_TRUE(ScanAggregator::Create(spec, schema_, schema_, &aggregator).IsInvalidArgument());
+  }
+  {
+    AggregationSpecPB spec;
+    AddAggregate(&spec, AggregatePB::SUM, 1);
+    ASSERT_TRUE(ScanAggregator::Create(spec, schema_, schema_, &aggregator).IsInvalidArgument());
+  }
+  {
+    AggregationSpecPB spec;
+    AddAggregate(&spec, AggregatePB::MIN, 3);
+    ASSERT_TRUE(ScanAggregator::Create(spec, schema_, schema_, &aggregator).IsInvalidArgument());
+  }
+  {
+    AggregationSpecPB spec;
+    spec.add_group_by_column_idx(-1);
+    AddAggregate(&spec, AggregatePB::COUNT);
+    ASSERT_TRUE(ScanAggregator::Create(spec, schema_, schema_, &aggregator).IsInvalidArgument());
+  }
+  {
+    AggregationSpecPB spec;
+    AddAggregate(&spec, AggregatePB::UNKNOWN_AGGREGATE, 0);
+    ASSERT_TRUE(ScanAggregator::Create(spec, schema_, schema_, &aggregator).IsInvalidArgument());
+  }
+}
+
+} // namespace tserver
+} // namespace kudu
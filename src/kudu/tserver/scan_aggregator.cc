@@ -0,0 +1,412 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tserver/scan_aggregator.h"
+
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/row.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/types.h"
+#include "kudu/common/wire_protocol.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/decimal_util.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tserver {
+
+namespace {
+
+// The approximate size of the bookkeeping of a group, in bytes.
+constexpr size_t kGroupOverhead = 64;
+
+// Returns the name of the result column of 'agg', which aggregates the column
+// 'col', if any.
+string AggregateName(const AggregatePB& agg, const ColumnSchema* col) {
+  const string arg = col ? col->name() : "*";
+  switch (agg.type()) {
+    case AggregatePB::COUNT: return Substitute("count($0)", arg);
+    case AggregatePB::SUM: return Substitute("sum($0)", arg);
+    case AggregatePB::MIN: return Substitute("min($0)", arg);
+    case AggregatePB::MAX: return Substitute("max($0)", arg);
+    default: LOG(FATAL) << "unexpected aggregate type " << agg.type();
+  }
+  return "";
+}
+
+// Sets 'result' to the schema of the result column of 'agg' over 'col'.
+Status AggregateResultColumn(const AggregatePB& agg, const ColumnSchema* col,
+                             std::optional<ColumnSchema>* result) {
+  const string name = AggregateName(agg, col);
+  if (agg.type() == AggregatePB::COUNT) {
+    result->emplace(name, INT64);
+    return Status::OK();
+  }
+  DCHECK(col);
+  const DataType type = col->type_info()->type();
+  if (agg.type() == AggregatePB::MIN || agg.type() == AggregatePB::MAX) {
+    if (type == IS_DELETED) {
+      return Status::InvalidArgument("can't aggregate virtual column", col->name());
+    }
+    result->emplace(name, type, /*is_nullable=*/true, false, false, nullptr, nullptr,
+                    ColumnStorageAttributes(), col->type_attributes());
+    return Status::OK();
+  }
+  DCHECK_EQ(AggregatePB::SUM, agg.type());
+  switch (type) {
+    case INT8:
+    case INT16:
+    case INT32:
+    case INT64:
+      result->emplace(name, DECIMAL128, /*is_nullable=*/true, false, false, nullptr, nullptr,
+                      ColumnStorageAttributes(),
+                      ColumnTypeAttributes(kMaxDecimal128Precision, 0));
+      return Status::OK();
+    case DECIMAL32:
+    case DECIMAL64:
+      result->emplace(name, DECIMAL128, /*is_nullable=*/true, false, false, nullptr, nullptr,
+                      ColumnStorageAttributes(),
+                      ColumnTypeAttributes(kMaxDecimal128Precision,
+                                           col->type_attributes().scale));
+      return Status::OK();
+    case FLOAT:
+    case DOUBLE:
+      result->emplace(name, DOUBLE, /*is_nullable=*/true);
+      return Status::OK();
+    default:
+      return Status::InvalidArgument("can't sum column of this type", col->ToString());
+  }
+}
+
+} // anonymous namespace
+
+Status ScanAggregator::Create(const AggregationSpecPB& spec,
+                              const Schema& block_schema,
+                              const Schema& client_schema,
+                              unique_ptr<ScanAggregator>* aggregator) {
+  if (spec.aggregates_size() == 0) {
+    return Status::InvalidArgument("no aggregate specified");
+  }
+  unique_ptr<ScanAggregator> agg(new ScanAggregator);
+  agg->block_schema_ = block_schema;
+
+  // Maps the index of a column in 'client_schema' to its index in the blocks.
+  auto to_block_col_idx = [&](int32_t col_idx, int* block_col_idx) {
+    if (col_idx < 0 || col_idx >= client_schema.num_columns()) {
+      return Status::InvalidArgument(Substitute(
+          "column index $0 out of range for projection of $1 columns",
+          col_idx, client_schema.num_columns()));
+    }
+    *block_col_idx = block_schema.find_column(client_schema.column(col_idx).name());
+    DCHECK_NE(Schema::kColumnNotFound, *block_col_idx);
+    return Status::OK();
+  };
+
+  vector<ColumnSchema> result_cols;
+  for (int32_t col_idx : spec.group_by_column_idx()) {
+    int block_col_idx;
+    RETURN_NOT_OK(to_block_col_idx(col_idx, &block_col_idx));
+    const ColumnSchema& col = block_schema.column(block_col_idx);
+    if (col.type_info()->type() == IS_DELETED) {
+      return Status::InvalidArgument("can't group by virtual column", col.name());
+    }
+    agg->group_by_block_col_idxs_.emplace_back(block_col_idx);
+    result_cols.emplace_back(col.name(), col.type_info()->type(), col.is_nullable(),
+                             false, false, nullptr, nullptr, ColumnStorageAttributes(),
+                             col.type_attributes());
+  }
+  for (const auto& agg_pb : spec.aggregates()) {
+    if (agg_pb.type() != AggregatePB::COUNT && agg_pb.type() != AggregatePB::SUM &&
+        agg_pb.type() != AggregatePB::MIN && agg_pb.type() != AggregatePB::MAX) {
+      return Status::InvalidArgument("unknown aggregate type", AggregatePB::Type_Name(agg_pb.type()));
+    }
+    Aggregate a { agg_pb.type(), -1, nullptr };
+    const ColumnSchema* col = nullptr;
+    if (agg_pb.has_column_idx()) {
+      RETURN_NOT_OK(to_block_col_idx(agg_pb.column_idx(), &a.block_col_idx));
+      col = &block_schema.column(a.block_col_idx);
+      a.type_info = col->type_info();
+    } else if (agg_pb.type() != AggregatePB::COUNT) {
+      return Status::InvalidArgument("aggregate requires a column",
+                                     AggregatePB::Type_Name(agg_pb.type()));
+    }
+    std::optional<ColumnSchema> result_col;
+    RETURN_NOT_OK(AggregateResultColumn(agg_pb, col, &result_col));
+    result_cols.emplace_back(std::move(*result_col));
+    agg->aggregates_.emplace_back(a);
+  }
+  RETURN_NOT_OK(agg->result_schema_.Reset(std::move(result_cols), 0));
+  agg->Reset();
+  *aggregator = std::move(agg);
+  return Status::OK();
+}
+
+void ScanAggregator::Reset() {
+  groups_.clear();
+  group_keys_.clear();
+  states_.clear();
+  indirect_size_ = 0;
+  if (group_by_block_col_idxs_.empty()) {
+    // The aggregates of all the rows are returned even if there's none.
+    FindOrAddGroup("");
+  }
+}
+
+size_t ScanAggregator::FindOrAddGroup(const string& key) {
+  auto it = groups_.find(key);
+  if (it != groups_.end()) {
+    return it->second;
+  }
+  const size_t idx = group_keys_.size();
+  auto inserted = groups_.emplace(key, idx).first;
+  group_keys_.emplace_back(&inserted->first);
+  states_.resize(states_.size() + aggregates_.size());
+  indirect_size_ += key.size();
+  return idx;
+}
+
+void ScanAggregator::FindGroups(const RowBlock& block, const vector<uint16_t>& rows) {
+  if (group_by_block_col_idxs_.empty()) {
+    for (uint16_t row : rows) {
+      group_of_row_[row] = 0;
+    }
+    return;
+  }
+  // The key of a group is made of each of its group-by cells, preceded by
+  // whether it's null if the column is nullable, and by its length if it's
+  // variable-length.
+  for (uint16_t row : rows) {
+    key_buf_.clear();
+    for (int col_idx : group_by_block_col_idxs_) {
+      const ColumnBlock& col = block.column_block(col_idx);
+      if (col.is_nullable()) {
+        const bool is_null = col.is_null(row);
+        key_buf_.push_back(is_null ? 0 : 1);
+        if (is_null) {
+          continue;
+        }
+      }
+      if (col.type_info()->physical_type() == BINARY) {
+        const Slice* cell = reinterpret_cast<const Slice*>(col.cell_ptr(row));
+        const uint32_t size = cell->size();
+        key_buf_.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        key_buf_.append(reinterpret_cast<const char*>(cell->data()), cell->size());
+      } else {
+        key_buf_.append(reinterpret_cast<const char*>(col.cell_ptr(row)),
+                        col.type_info()->size());
+      }
+    }
+    group_of_row_[row] = FindOrAddGroup(key_buf_);
+  }
+}
+
+template<class T>
+void ScanAggregator::AddToSums(int agg_idx, const RowBlock& block, int col_idx,
+                               const vector<uint16_t>& rows) {
+  const ColumnBlock& col = block.column_block(col_idx);
+  const bool is_nullable = col.is_nullable();
+  for (uint16_t row : rows) {
+    if (is_nullable && col.is_null(row)) {
+      continue;
+    }
+    const T val = UnalignedLoad<T>(col.cell_ptr(row));
+    State* s = state(group_of_row_[row], agg_idx);
+    s->has_value = true;
+    if constexpr (std::is_floating_point<T>::value) {
+      s->double_sum += val;
+    } else {
+      s->int_sum += val;
+    }
+  }
+}
+
+void ScanAggregator::UpdateAggregate(int agg_idx, const RowBlock& block,
+                                     const vector<uint16_t>& rows) {
+  const Aggregate& agg = aggregates_[agg_idx];
+  if (agg.block_col_idx < 0) {
+    DCHECK_EQ(AggregatePB::COUNT, agg.type);
+    for (uint16_t row : rows) {
+      state(group_of_row_[row], agg_idx)->count++;
+    }
+    return;
+  }
+
+  const ColumnBlock& col = block.column_block(agg.block_col_idx);
+  const bool is_nullable = col.is_nullable();
+  switch (agg.type) {
+    case AggregatePB::COUNT:
+      for (uint16_t row : rows) {
+        if (!is_nullable || !col.is_null(row)) {
+          state(group_of_row_[row], agg_idx)->count++;
+        }
+      }
+      return;
+    case AggregatePB::SUM:
+      switch (agg.type_info->physical_type()) {
+        case INT8: AddToSums<int8_t>(agg_idx, block, agg.block_col_idx, rows); return;
+        case INT16: AddToSums<int16_t>(agg_idx, block, agg.block_col_idx, rows); return;
+        case INT32: AddToSums<int32_t>(agg_idx, block, agg.block_col_idx, rows); return;
+        case INT64: AddToSums<int64_t>(agg_idx, block, agg.block_col_idx, rows); return;
+        case FLOAT: AddToSums<float>(agg_idx, block, agg.block_col_idx, rows); return;
+        case DOUBLE: AddToSums<double>(agg_idx, block, agg.block_col_idx, rows); return;
+        default:
+          LOG(FATAL) << "unexpected type for sum: " << agg.type_info->name();
+      }
+      return;
+    case AggregatePB::MIN:
+    case AggregatePB::MAX: {
+      const int sign = agg.type == AggregatePB::MIN ? 1 : -1;
+      const bool is_binary = agg.type_info->physical_type() == BINARY;
+      const size_t size = agg.type_info->size();
+      for (uint16_t row : rows) {
+        if (is_nullable && col.is_null(row)) {
+          continue;
+        }
+        const void* cell = col.cell_ptr(row);
+        State* s = state(group_of_row_[row], agg_idx);
+        if (is_binary) {
+          const Slice* val = reinterpret_cast<const Slice*>(cell);
+          if (s->has_value && sign * val->compare(Slice(s->binary)) >= 0) {
+            continue;
+          }
+          indirect_size_ += val->size();
+          indirect_size_ -= s->binary.size();
+          s->binary.assign(reinterpret_cast<const char*>(val->data()), val->size());
+        } else {
+          if (s->has_value && sign * agg.type_info->Compare(cell, s->value) >= 0) {
+            continue;
+          }
+          memcpy(s->value, cell, size);
+        }
+        s->has_value = true;
+      }
+      return;
+    }
+    default:
+      LOG(FATAL) << "unexpected aggregate type " << agg.type;
+  }
+}
+
+void ScanAggregator::AddRowBlock(const RowBlock& block) {
+  DCHECK_SCHEMA_EQ(block_schema_, *block.schema());
+  const vector<uint16_t> rows = block.selection_vector()->GetSelectedRows().ToRowIndexes();
+  if (rows.empty()) {
+    return;
+  }
+  group_of_row_.resize(block.nrows());
+  FindGroups(block, rows);
+  for (int i = 0; i < aggregates_.size(); i++) {
+    UpdateAggregate(i, block, rows);
+  }
+}
+
+size_t ScanAggregator::ResultSize() const {
+  return group_keys_.size() * (result_schema_.byte_size() + kGroupOverhead) + indirect_size_;
+}
+
+void ScanAggregator::WriteResult(const Aggregate& agg, const State& state, int col_idx,
+                                 RowBlockRow* row) const {
+  ColumnBlock col = row->column_block(col_idx);
+  const size_t row_idx = row->row_index();
+  if (agg.type == AggregatePB::COUNT) {
+    memcpy(col.mutable_cell_ptr(row_idx), &state.count, sizeof(state.count));
+    return;
+  }
+  col.SetCellIsNull(row_idx, !state.has_value);
+  if (!state.has_value) {
+    return;
+  }
+  if (agg.type == AggregatePB::SUM) {
+    if (col.type_info()->physical_type() == DOUBLE) {
+      memcpy(col.mutable_cell_ptr(row_idx), &state.double_sum, sizeof(state.double_sum));
+    } else {
+      memcpy(col.mutable_cell_ptr(row_idx), &state.int_sum, sizeof(state.int_sum));
+    }
+    return;
+  }
+  if (col.type_info()->physical_type() == BINARY) {
+    // The cell points into 'state', which outlives the serialization of the
+    // results.
+    const Slice cell(state.binary);
+    memcpy(col.mutable_cell_ptr(row_idx), &cell, sizeof(cell));
+    return;
+  }
+  memcpy(col.mutable_cell_ptr(row_idx), state.value, col.type_info()->size());
+}
+
+int ScanAggregator::SerializeResults(faststring* rows_data, faststring* indirect_data) {
+  const size_t num_rows = group_keys_.size();
+  if (num_rows == 0) {
+    return 0;
+  }
+  RowBlockMemory mem;
+  RowBlock block(&result_schema_, num_rows, &mem);
+  block.selection_vector()->SetAllTrue();
+  const int num_group_by = group_by_block_col_idxs_.size();
+  for (size_t g = 0; g < num_rows; g++) {
+    RowBlockRow row = block.row(g);
+
+    // Decode the group-by cells from the key of the group. BINARY cells point
+    // into the key, which outlives the serialization of the results.
+    const uint8_t* key = reinterpret_cast<const uint8_t*>(group_keys_[g]->data());
+    for (int i = 0; i < num_group_by; i++) {
+      ColumnBlock col = row.column_block(i);
+      if (col.is_nullable()) {
+        const bool is_null = *key++ == 0;
+        col.SetCellIsNull(g, is_null);
+        if (is_null) {
+          continue;
+        }
+      }
+      if (col.type_info()->physical_type() == BINARY) {
+        const uint32_t size = UnalignedLoad<uint32_t>(key);
+        key += sizeof(size);
+        const Slice cell(key, size);
+        memcpy(col.mutable_cell_ptr(g), &cell, sizeof(cell));
+        key += size;
+      } else {
+        memcpy(col.mutable_cell_ptr(g), key, col.type_info()->size());
+        key += col.type_info()->size();
+      }
+    }
+    for (int i = 0; i < aggregates_.size(); i++) {
+      WriteResult(aggregates_[i], states_[g * aggregates_.size() + i], num_group_by + i, &row);
+    }
+  }
+  const int num_serialized = SerializeRowBlock(block, nullptr, rows_data, indirect_data);
+  Reset();
+  return num_serialized;
+}
+
+} // namespace tserver
+} // namespace kudu
@@ -0,0 +1,165 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kudu/common/schema.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/int128.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class RowBlock;
+class RowBlockRow;
+class TypeInfo;
+class faststring;
+
+namespace tserver {
+
+// Computes the aggregates of an AggregationSpecPB over the rows of a scan, as
+// they're read in RowBlocks. The rows are grouped by the group-by columns in a
+// hash table, so this is meant for columns with few distinct values; each
+// call to SerializeResults() returns the aggregates of the rows added since
+// the previous one, so the caller may bound the size of the table.
+//
+// See AggregationSpecPB for the schema of the results.
+class ScanAggregator {
+ public:
+  // Creates an aggregator of RowBlocks of 'block_schema'. The column indexes
+  // of 'spec' refer to 'client_schema', whose columns must all be in
+  // 'block_schema'.
+  static Status Create(const AggregationSpecPB& spec,
+                       const Schema& block_schema,
+                       const Schema& client_schema,
+                       std::unique_ptr<ScanAggregator>* aggregator);
+
+  // Aggregates the selected rows of 'block'.
+  void AddRowBlock(const RowBlock& block);
+
+  // The schema of the results.
+  const Schema& result_schema() const {
+    return result_schema_;
+  }
+
+  // Returns the number of result rows which are pending.
+  size_t num_groups() const {
+    return group_keys_.size();
+  }
+
+  // Returns the approximate size of the serialized pending results.
+  size_t ResultSize() const;
+
+  // Serializes the pending results as rows of result_schema(), the same way
+  // as SerializeRowBlock(), and starts over with no row aggregated. Returns
+  // the number of rows serialized.
+  int SerializeResults(faststring* rows_data, faststring* indirect_data);
+
+ private:
+  // An aggregate to compute.
+  struct Aggregate {
+    AggregatePB::Type type;
+
+    // The index in the RowBlocks of the aggregated column, or -1 to count
+    // the rows.
+    int block_col_idx;
+
+    // The type of the aggregated column, if any.
+    const TypeInfo* type_info;
+  };
+
+  // The state of an aggregate of a group.
+  struct State {
+    // Whether a non-null cell was aggregated.
+    bool has_value = false;
+
+    // The number of rows or cells counted.
+    int64_t count = 0;
+
+    // The sum of the cells aggregated by SUM.
+    int128_t int_sum = 0;
+    double double_sum = 0;
+
+    // The current minimum or maximum, in 'binary' for BINARY columns.
+    uint8_t value[16];
+    std::string binary;
+  };
+
+  ScanAggregator() = default;
+
+  // Sets 'group_of_row_' to the index of the group of each selected row of
+  // 'block', adding the new groups.
+  void FindGroups(const RowBlock& block, const std::vector<uint16_t>& rows);
+
+  // Returns the index of the group whose encoded key is 'key', adding it if
+  // it doesn't exist yet.
+  size_t FindOrAddGroup(const std::string& key);
+
+  // Updates the aggregate 'agg_idx' of the groups of 'rows' of 'block'.
+  void UpdateAggregate(int agg_idx, const RowBlock& block, const std::vector<uint16_t>& rows);
+
+  // Adds the cells 'rows' of the column 'col_idx' of 'block' to the sums of
+  // aggregate 'agg_idx', as 'T' values.
+  template<class T>
+  void AddToSums(int agg_idx, const RowBlock& block, int col_idx,
+                 const std::vector<uint16_t>& rows);
+
+  // Writes the result of 'state' for 'agg' into the cell 'col_idx' of 'row'.
+  void WriteResult(const Aggregate& agg, const State& state, int col_idx, RowBlockRow* row) const;
+
+  // Starts over with no row aggregated.
+  void Reset();
+
+  State* state(size_t group_idx, int agg_idx) {
+    return &states_[group_idx * aggregates_.size() + agg_idx];
+  }
+
+  std::vector<Aggregate> aggregates_;
+
+  // The indexes in the RowBlocks of the group-by columns.
+  std::vector<int> group_by_block_col_idxs_;
+
+  Schema block_schema_;
+  Schema result_schema_;
+
+  // The groups, keyed by the encoded values of their group-by columns, with
+  // their index. The keys are listed in the order of the indexes.
+  std::unordered_map<std::string, size_t> groups_;
+  std::vector<const std::string*> group_keys_;
+
+  // The states of the aggregates of the groups, group by group.
+  std::vector<State> states_;
+
+  // The total size of the BINARY cells of the results.
+  size_t indirect_size_ = 0;
+
+  // Scratch space for AddRowBlock().
+  std::vector<size_t> group_of_row_;
+  std::string key_buf_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScanAggregator);
+};
+
+} // namespace tserver
+} // namespace kudu
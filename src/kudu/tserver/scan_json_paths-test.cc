@@ -0,0 +1,202 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/tserver/scan_json_paths.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/schema.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+namespace tserver {
+
+class ScanJsonPathsTest : public KuduTest {
+ public:
+  ScanJsonPathsTest()
+      : schema_({ ColumnSchema("key", INT32),
+                  ColumnSchema("doc", JSON, /*is_nullable=*/true) }, 1),
+        docs_({ R"({"a": {"b": 1}, "c": [1, 2]})",
+                R"({"a": {"b": 2.0}, "c": "x"})",
+                R"({"a": {"b": {"y": 1, "x": 2}}})",
+                R"({"c": null})",
+                "" }) {
+  }
+
+ protected:
+  // Applies 'json_paths' to a block of the documents of 'docs_', the last one
+  // of which is null, and returns the selected rows as "<key>: <doc>".
+  vector<string> Apply(const ScanJsonPaths& json_paths) {
+    RowBlockMemory mem;
+    RowBlock block(&schema_, docs_.size(), &mem);
+    for (size_t i = 0; i < docs_.size(); i++) {
+      RowBlockRow row = block.row(i);
+      *reinterpret_cast<int32_t*>(row.mutable_cell_ptr(0)) = i;
+      const bool is_null = i == docs_.size() - 1;
+      row.cell(1).set_null(is_null);
+      if (!is_null) {
+        *reinterpret_cast<Slice*>(row.mutable_cell_ptr(1)) = Slice(docs_[i]);
+      }
+    }
+    CHECK_OK(json_paths.Apply(&block));
+    vector<string> results;
+    for (size_t i = 0; i < block.nrows(); i++) {
+      if (!block.selection_vector()->IsRowSelected(i)) {
+        continue;
+      }
+      const RowBlockRow row = block.row(i);
+      results.emplace_back(std::to_string(i) + ": " + (
+          row.is_null(1) ? "NULL"
+                         : reinterpret_cast<const Slice*>(row.cell_ptr(1))->ToString()));
+    }
+    return results;
+  }
+
+  const Schema schema_;
+  const vector<string> docs_;
+};
+
+TEST_F(ScanJsonPathsTest, TestProjection) {
+  NewScanRequestPB scan_pb;
+  auto* proj = scan_pb.add_json_path_projections();
+  proj->set_column_idx(1);
+  proj->set_path("$.a.b");
+  unique_ptr<ScanJsonPaths> json_paths;
+  ASSERT_OK(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths));
+  const vector<string> expected = {
+    "0: 1",
+    "1: 2.0",
+    R"(2: {"y":1,"x":2})",
+    "3: null",
+    "4: NULL" };
+  ASSERT_EQ(expected, Apply(*json_paths));
+}
+
+TEST_F(ScanJsonPathsTest, TestPredicates) {
+  unique_ptr<ScanJsonPaths> json_paths;
+  {
+    // Numbers are compared by value.
+    NewScanRequestPB scan_pb;
+    auto* pred = scan_pb.add_json_path_predicates();
+    pred->set_column_idx(1);
+    pred->set_path("$.a.b");
+    pred->set_value("2");
+    ASSERT_OK(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths));
+    const vector<string> expected = { R"(1: {"a": {"b": 2.0}, "c": "x"})" };
+    ASSERT_EQ(expected, Apply(*json_paths));
+  }
+  {
+    // Objects are compared regardless of the order of their members.
+    NewScanRequestPB scan_pb;
+    auto* pred = scan_pb.add_json_path_predicates();
+    pred->set_column_idx(1);
+    pred->set_path("$.a.b");
+    pred->set_value(R"({"x": 2, "y": 1})");
+    ASSERT_OK(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths));
+    const vector<string> expected = { R"(2: {"a": {"b": {"y": 1, "x": 2}}})" };
+    ASSERT_EQ(expected, Apply(*json_paths));
+  }
+  {
+    // Without a value, the path must exist, even if its value is null. The
+    // predicates are evaluated on the documents rather than the projection.
+    NewScanRequestPB scan_pb;
+    auto* pred = scan_pb.add_json_path_predicates();
+    pred->set_column_idx(1);
+    pred->set_path("$.c");
+    auto* proj = scan_pb.add_json_path_projections();
+    proj->set_column_idx(1);
+    proj->set_path("$.a");
+    ASSERT_OK(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths));
+    const vector<string> expected = {
+      R"(0: {"b":1})",
+      R"(1: {"b":2.0})",
+      "3: null" };
+    ASSERT_EQ(expected, Apply(*json_paths));
+  }
+}
+
+TEST_F(ScanJsonPathsTest, TestInvalidSpecs) {
+  unique_ptr<ScanJsonPaths> json_paths;
+  {
+    NewScanRequestPB scan_pb;
+    ASSERT_OK(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths));
+    ASSERT_EQ(nullptr, json_paths);
+  }
+  {
+    // Not a JSON column.
+    NewScanRequestPB scan_pb;
+    auto* proj = scan_pb.add_json_path_projections();
+    proj->set_column_idx(0);
+    proj->set_path("$");
+    ASSERT_TRUE(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths)
+                .IsInvalidArgument());
+  }
+  {
+    // Not a column.
+    NewScanRequestPB scan_pb;
+    auto* pred = scan_pb.add_json_path_predicates();
+    pred->set_column_idx(2);
+    pred->set_path("$");
+    ASSERT_TRUE(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths)
+                .IsInvalidArgument());
+  }
+  {
+    NewScanRequestPB scan_pb;
+    auto* pred = scan_pb.add_json_path_predicates();
+    pred->set_column_idx(1);
+    pred->set_path("a.b");
+    ASSERT_TRUE(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths)
+                .IsInvalidArgument());
+  }
+  {
+    NewScanRequestPB scan_pb;
+    auto* pred = scan_pb.add_json_path_predicates();
+    pred->set_column_idx(1);
+    pred->set_path("$.a");
+    pred->set_value("{");
+    ASSERT_TRUE(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths).IsCorruption());
+  }
+  {
+    NewScanRequestPB scan_pb;
+    for (int i = 0; i < 2; i++) {
+      auto* proj = scan_pb.add_json_path_projections();
+      proj->set_column_idx(1);
+      proj->set_path("$.a");
+    }
+    ASSERT_TRUE(ScanJsonPaths::Create(scan_pb, schema_, schema_, &json_paths)
+                .IsInvalidArgument());
+  }
+}
+
+} // namespace tserver
+} // namespace kudu
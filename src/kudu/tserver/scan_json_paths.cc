@@ -0,0 +1,164 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/tserver/scan_json_paths.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/slice.h"
+
+using std::string;
+using std::unique_ptr;
+using strings::Substitute;
+
+namespace kudu {
+namespace tserver {
+
+Status ScanJsonPaths::Create(const NewScanRequestPB& scan_pb,
+                             const Schema& block_schema,
+                             const Schema& client_schema,
+                             unique_ptr<ScanJsonPaths>* json_paths) {
+  if (scan_pb.json_path_predicates().empty() && scan_pb.json_path_projections().empty()) {
+    json_paths->reset();
+    return Status::OK();
+  }
+  unique_ptr<ScanJsonPaths> p(new ScanJsonPaths);
+  for (const auto& pred_pb : scan_pb.json_path_predicates()) {
+    Column* column;
+    RETURN_NOT_OK(p->GetColumn(block_schema, client_schema, pred_pb.column_idx(), &column));
+    Predicate pred;
+    RETURN_NOT_OK(JsonPath::Parse(pred_pb.path(), &pred.path));
+    if (pred_pb.has_value()) {
+      pred.value.reset(new rapidjson::Document);
+      RETURN_NOT_OK_PREPEND(ParseJson(pred_pb.value(), pred.value.get()),
+                            "invalid JSON path predicate value");
+    }
+    column->predicates.emplace_back(std::move(pred));
+  }
+  for (const auto& proj_pb : scan_pb.json_path_projections()) {
+    Column* column;
+    RETURN_NOT_OK(p->GetColumn(block_schema, client_schema, proj_pb.column_idx(), &column));
+    if (column->projection) {
+      return Status::InvalidArgument(Substitute(
+          "more than one JSON path projection of column $0",
+          client_schema.column(proj_pb.column_idx()).name()));
+    }
+    JsonPath path;
+    RETURN_NOT_OK(JsonPath::Parse(proj_pb.path(), &path));
+    column->projection = std::move(path);
+  }
+  *json_paths = std::move(p);
+  return Status::OK();
+}
+
+Status ScanJsonPaths::GetColumn(const Schema& block_schema,
+                                const Schema& client_schema,
+                                int col_idx,
+                                Column** column) {
+  if (col_idx < 0 || col_idx >= client_schema.num_columns()) {
+    return Status::InvalidArgument(Substitute(
+        "invalid JSON path column index $0 for projection of $1 columns",
+        col_idx, client_schema.num_columns()));
+  }
+  const ColumnSchema& col = client_schema.column(col_idx);
+  if (col.type_info()->type() != JSON) {
+    return Status::InvalidArgument("JSON path on a column which is not a JSON column",
+                                   col.name());
+  }
+  const int block_col_idx = block_schema.find_column(col.name());
+  DCHECK_NE(Schema::kColumnNotFound, block_col_idx);
+  for (auto& c : columns_) {
+    if (c.block_col_idx == block_col_idx) {
+      *column = &c;
+      return Status::OK();
+    }
+  }
+  columns_.emplace_back();
+  Column* c = &columns_.back();
+  c->block_col_idx = block_col_idx;
+  c->nullable = col.is_nullable();
+  *column = c;
+  return Status::OK();
+}
+
+Status ScanJsonPaths::Apply(RowBlock* block) const {
+  SelectionVector* sel = block->selection_vector();
+  rapidjson::Document doc;
+  string projected;
+  for (size_t row = 0; row < block->nrows(); row++) {
+    if (!sel->IsRowSelected(row)) {
+      continue;
+    }
+    for (const auto& c : columns_) {
+      ColumnBlock cells = block->column_block(c.block_col_idx);
+      if (c.nullable && cells.is_null(row)) {
+        // Null documents have no values at any path, and are projected as is.
+        if (!c.predicates.empty()) {
+          sel->SetRowUnselected(row);
+          break;
+        }
+        continue;
+      }
+      const Slice* cell = reinterpret_cast<const Slice*>(cells.cell_ptr(row));
+      // The documents were validated when written.
+      RETURN_NOT_OK_PREPEND(ParseJson(*cell, &doc),
+                            Substitute("unable to parse the JSON document of row $0", row));
+      bool passes = true;
+      for (const auto& pred : c.predicates) {
+        const rapidjson::Value* value = pred.path.Find(doc);
+        if (value == nullptr || (pred.value && *value != *pred.value)) {
+          passes = false;
+          break;
+        }
+      }
+      if (!passes) {
+        sel->SetRowUnselected(row);
+        break;
+      }
+      if (c.projection) {
+        const rapidjson::Value* value = c.projection->Find(doc);
+        projected.clear();
+        if (value) {
+          AppendJson(*value, &projected);
+        } else {
+          projected = "null";
+        }
+        Slice projected_cell;
+        if (PREDICT_FALSE(!block->arena()->RelocateSlice(projected, &projected_cell))) {
+          return Status::RuntimeError("unable to allocate the projected JSON value");
+        }
+        cells.SetCellValue(row, &projected_cell);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+} // namespace tserver
+} // namespace kudu
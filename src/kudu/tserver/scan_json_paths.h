@@ -0,0 +1,89 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/json_path.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class RowBlock;
+class Schema;
+
+namespace tserver {
+
+class NewScanRequestPB;
+
+// Evaluates the JSON path predicates and projections of a scan, as specified
+// by the JsonPathPredicatePB and JsonPathProjectionPB of a NewScanRequestPB,
+// on the rows it reads in RowBlocks.
+//
+// The document of each JSON column involved is parsed once per row, for all
+// the predicates and the projection of the column.
+class ScanJsonPaths {
+ public:
+  // Creates the JSON paths of 'scan_pb' for RowBlocks of 'block_schema', or
+  // sets 'json_paths' to null if the scan has none. The column indexes refer
+  // to 'client_schema', whose columns must all be in 'block_schema'.
+  static Status Create(const NewScanRequestPB& scan_pb,
+                       const Schema& block_schema,
+                       const Schema& client_schema,
+                       std::unique_ptr<ScanJsonPaths>* json_paths);
+
+  // Deselects the selected rows of 'block' which don't pass the predicates,
+  // and replaces the projected cells of the others with their values at the
+  // paths, allocated from the arena of the block.
+  Status Apply(RowBlock* block) const;
+
+ private:
+  struct Predicate {
+    JsonPath path;
+    // The value at the path, unless the path must merely exist.
+    std::unique_ptr<rapidjson::Document> value;
+  };
+
+  // The predicates and the projection of a JSON column.
+  struct Column {
+    int block_col_idx;
+    bool nullable;
+    std::vector<Predicate> predicates;
+    std::optional<JsonPath> projection;
+  };
+
+  ScanJsonPaths() = default;
+
+  // Returns the paths of the column of 'client_schema' with index 'col_idx',
+  // adding them if needed.
+  Status GetColumn(const Schema& block_schema,
+                   const Schema& client_schema,
+                   int col_idx,
+                   Column** column);
+
+  std::vector<Column> columns_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScanJsonPaths);
+};
+
+} // namespace tserver
+} // namespace kudu
@@ -0,0 +1,173 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tserver/scan_top_n.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/schema.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_int64(scanner_top_n_max_limit);
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tserver {
+
+class ScanTopNTest : public KuduTest {
+ public:
+  ScanTopNTest()
+      : schema_({ ColumnSchema("key", INT32),
+                  ColumnSchema("val", INT64, /*is_nullable=*/true),
+                  ColumnSchema("str", STRING) }, 1) {
+  }
+
+ protected:
+  // Adds the rows with keys in ['first_key', 'first_key' + 'num_rows') to
+  // 'top_n'. The value of a row is (key * 7) % 100, or null if key % 10 == 3,
+  // and its string is "s<key>".
+  void AddRows(ScanTopN* top_n, int first_key, int num_rows) {
+    RowBlockMemory mem;
+    RowBlock block(&schema_, num_rows, &mem);
+    vector<string> strs(num_rows);
+    for (int i = 0; i < num_rows; i++) {
+      const int32_t key = first_key + i;
+      RowBlockRow row = block.row(i);
+      *reinterpret_cast<int32_t*>(row.mutable_cell_ptr(0)) = key;
+      const bool is_null = key % 10 == 3;
+      row.cell(1).set_null(is_null);
+      if (!is_null) {
+        *reinterpret_cast<int64_t*>(row.mutable_cell_ptr(1)) = (key * 7) % 100;
+      }
+      strs[i] = Substitute("s$0", key);
+      *reinterpret_cast<Slice*>(row.mutable_cell_ptr(2)) = Slice(strs[i]);
+    }
+    top_n->AddRowBlock(block);
+  }
+
+  static vector<string> Results(ScanTopN* top_n) {
+    const RowBlock& block = top_n->Finish();
+    vector<string> results;
+    for (size_t i = 0; i < block.nrows(); i++) {
+      results.emplace_back(block.schema()->DebugRow(block.row(i)));
+    }
+    return results;
+  }
+
+  const Schema schema_;
+};
+
+TEST_F(ScanTopNTest, TestAscending) {
+  TopNSpecPB spec;
+  spec.set_column_idx(1);
+  spec.set_limit(3);
+  unique_ptr<ScanTopN> top_n;
+  ASSERT_OK(ScanTopN::Create(spec, schema_, schema_, &top_n));
+
+  // The smallest values of keys in [0, 100) are 0 (key 0), 1 (key 43, whose
+  // value is null), 2 (key 86) and 3 (key 29). The rows of the first block
+  // must remain valid once it's gone.
+  NO_FATALS(AddRows(top_n.get(), 0, 50));
+  NO_FATALS(AddRows(top_n.get(), 50, 50));
+  ASSERT_EQ(3, top_n->num_rows());
+  const vector<string> expected = {
+    R"((int32 key=0, int64 val=0, string str="s0"))",
+    R"((int32 key=86, int64 val=2, string str="s86"))",
+    R"((int32 key=29, int64 val=3, string str="s29"))" };
+  ASSERT_EQ(expected, Results(top_n.get()));
+}
+
+TEST_F(ScanTopNTest, TestDescending) {
+  TopNSpecPB spec;
+  spec.set_column_idx(1);
+  spec.set_limit(2);
+  spec.set_descending(true);
+  unique_ptr<ScanTopN> top_n;
+  ASSERT_OK(ScanTopN::Create(spec, schema_, schema_, &top_n));
+
+  // The largest values of keys in [0, 100) are 99 (key 57) and 98 (key 14).
+  NO_FATALS(AddRows(top_n.get(), 0, 100));
+  const vector<string> expected = {
+    R"((int32 key=57, int64 val=99, string str="s57"))",
+    R"((int32 key=14, int64 val=98, string str="s14"))" };
+  ASSERT_EQ(expected, Results(top_n.get()));
+}
+
+// Rows whose sort column is null come last, in either direction.
+TEST_F(ScanTopNTest, TestNullsLast) {
+  for (bool descending : { false, true }) {
+    SCOPED_TRACE(descending);
+    TopNSpecPB spec;
+    spec.set_column_idx(1);
+    spec.set_limit(5);
+    spec.set_descending(descending);
+    unique_ptr<ScanTopN> top_n;
+    ASSERT_OK(ScanTopN::Create(spec, schema_, schema_, &top_n));
+
+    // Keys 0 to 4 have values 0, 7, 14, null and 28.
+    NO_FATALS(AddRows(top_n.get(), 0, 5));
+    const vector<string> results = Results(top_n.get());
+    ASSERT_EQ(5, results.size());
+    ASSERT_EQ(R"((int32 key=3, int64 val=NULL, string str="s3"))", results.back());
+  }
+}
+
+TEST_F(ScanTopNTest, TestInvalidSpecs) {
+  unique_ptr<ScanTopN> top_n;
+  {
+    TopNSpecPB spec;
+    spec.set_limit(1);
+    ASSERT_TRUE(ScanTopN::Create(spec, schema_, schema_, &top_n).IsInvalidArgument());
+  }
+  {
+    TopNSpecPB spec;
+    spec.set_column_idx(3);
+    spec.set_limit(1);
+    ASSERT_TRUE(ScanTopN::Create(spec, schema_, schema_, &top_n).IsInvalidArgument());
+  }
+  {
+    TopNSpecPB spec;
+    spec.set_column_idx(0);
+    ASSERT_TRUE(ScanTopN::Create(spec, schema_, schema_, &top_n).IsInvalidArgument());
+  }
+  {
+    TopNSpecPB spec;
+    spec.set_column_idx(0);
+    spec.set_limit(FLAGS_scanner_top_n_max_limit + 1);
+    ASSERT_TRUE(ScanTopN::Create(spec, schema_, schema_, &top_n).IsInvalidArgument());
+  }
+}
+
+} // namespace tserver
+} // namespace kudu
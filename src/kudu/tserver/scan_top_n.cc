@@ -0,0 +1,181 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tserver/scan_top_n.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/row.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/slice.h"
+
+DEFINE_int64(scanner_top_n_max_limit, 100000,
+             "The maximum number of rows a Top-N scan may return per tablet. The rows "
+             "are kept in memory by the tablet server until the end of the scan.");
+TAG_FLAG(scanner_top_n_max_limit, advanced);
+TAG_FLAG(scanner_top_n_max_limit, runtime);
+
+using std::unique_ptr;
+using strings::Substitute;
+
+namespace kudu {
+namespace tserver {
+
+namespace {
+
+// Relocates the indirect data of a row right after it in its buffer.
+class RowAllocator {
+ public:
+  explicit RowAllocator(uint8_t* data)
+      : pos_(data) {
+  }
+
+  bool RelocateSlice(const Slice& src, Slice* dst) {
+    memcpy(pos_, src.data(), src.size());
+    *dst = Slice(pos_, src.size());
+    pos_ += src.size();
+    return true;
+  }
+
+ private:
+  uint8_t* pos_;
+};
+
+} // anonymous namespace
+
+Status ScanTopN::Create(const TopNSpecPB& spec,
+                        const Schema& block_schema,
+                        const Schema& client_schema,
+                        unique_ptr<ScanTopN>* top_n) {
+  if (!spec.has_column_idx() || spec.column_idx() < 0 ||
+      spec.column_idx() >= client_schema.num_columns()) {
+    return Status::InvalidArgument(Substitute(
+        "invalid Top-N column index $0 for projection of $1 columns",
+        spec.column_idx(), client_schema.num_columns()));
+  }
+  if (spec.limit() <= 0 || spec.limit() > FLAGS_scanner_top_n_max_limit) {
+    return Status::InvalidArgument(Substitute(
+        "Top-N limit must be between 1 and $0, got $1",
+        FLAGS_scanner_top_n_max_limit, spec.limit()));
+  }
+  const ColumnSchema& col = client_schema.column(spec.column_idx());
+  if (col.type_info()->type() == IS_DELETED) {
+    return Status::InvalidArgument("can't sort by virtual column", col.name());
+  }
+  unique_ptr<ScanTopN> t(new ScanTopN);
+  t->schema_ = block_schema;
+  t->sort_col_idx_ = block_schema.find_column(col.name());
+  DCHECK_NE(Schema::kColumnNotFound, t->sort_col_idx_);
+  t->sort_type_info_ = col.type_info();
+  t->sort_col_nullable_ = col.is_nullable();
+  t->descending_ = spec.descending();
+  t->limit_ = spec.limit();
+  *top_n = std::move(t);
+  return Status::OK();
+}
+
+bool ScanTopN::Before(bool a_null, const void* a, bool b_null, const void* b) const {
+  if (a_null || b_null) {
+    return !a_null && b_null;
+  }
+  const int c = sort_type_info_->Compare(a, b);
+  return descending_ ? c > 0 : c < 0;
+}
+
+bool ScanTopN::RowBefore(const faststring& a, const faststring& b) const {
+  const ConstContiguousRow a_row(&schema_, a.data());
+  const ConstContiguousRow b_row(&schema_, b.data());
+  return Before(sort_col_nullable_ && a_row.is_null(sort_col_idx_),
+                a_row.cell_ptr(sort_col_idx_),
+                sort_col_nullable_ && b_row.is_null(sort_col_idx_),
+                b_row.cell_ptr(sort_col_idx_));
+}
+
+void ScanTopN::CopyRow(const RowBlock& block, size_t row_idx, faststring* dst) const {
+  const RowBlockRow row = block.row(row_idx);
+  size_t indirect_size = 0;
+  for (size_t i = 0; i < schema_.num_columns(); i++) {
+    const ColumnSchema& col = schema_.column(i);
+    if (col.type_info()->physical_type() == BINARY &&
+        !(col.is_nullable() && row.is_null(i))) {
+      indirect_size += reinterpret_cast<const Slice*>(row.cell_ptr(i))->size();
+    }
+  }
+  const size_t row_size = ContiguousRowHelper::row_size(schema_);
+  dst->resize(row_size + indirect_size);
+  ContiguousRow dst_row(&schema_, dst->data());
+  RowAllocator allocator(dst->data() + row_size);
+  CHECK_OK(kudu::CopyRow(row, &dst_row, &allocator));
+}
+
+void ScanTopN::AddRowBlock(const RowBlock& block) {
+  DCHECK(!result_);
+  const auto cmp = [this](const unique_ptr<faststring>& a, const unique_ptr<faststring>& b) {
+    return RowBefore(*a, *b);
+  };
+  const ColumnBlock sort_col = block.column_block(sort_col_idx_);
+  block.selection_vector()->GetSelectedRows().ForEachIndex([&](size_t i) {
+    if (rows_.size() < limit_) {
+      rows_.emplace_back(new faststring);
+      CopyRow(block, i, rows_.back().get());
+      std::push_heap(rows_.begin(), rows_.end(), cmp);
+      return;
+    }
+    // The row is only kept if it comes before the last row kept, which it
+    // then replaces.
+    const ConstContiguousRow last(&schema_, rows_.front()->data());
+    if (!Before(sort_col_nullable_ && sort_col.is_null(i), sort_col.cell_ptr(i),
+                sort_col_nullable_ && last.is_null(sort_col_idx_),
+                last.cell_ptr(sort_col_idx_))) {
+      return;
+    }
+    std::pop_heap(rows_.begin(), rows_.end(), cmp);
+    CopyRow(block, i, rows_.back().get());
+    std::push_heap(rows_.begin(), rows_.end(), cmp);
+  });
+}
+
+const RowBlock& ScanTopN::Finish() {
+  DCHECK(!result_);
+  std::sort_heap(rows_.begin(), rows_.end(),
+                 [this](const unique_ptr<faststring>& a, const unique_ptr<faststring>& b) {
+                   return RowBefore(*a, *b);
+                 });
+  result_.reset(new RowBlock(&schema_, rows_.size(), &result_mem_));
+  result_->selection_vector()->SetAllTrue();
+  for (size_t i = 0; i < rows_.size(); i++) {
+    // The indirect data of the result points into the rows kept.
+    const ConstContiguousRow src(&schema_, rows_[i]->data());
+    RowBlockRow dst = result_->row(i);
+    CHECK_OK(kudu::CopyRow(src, &dst, static_cast<Arena*>(nullptr)));
+  }
+  return *result_;
+}
+
+} // namespace tserver
+} // namespace kudu
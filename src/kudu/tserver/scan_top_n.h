@@ -0,0 +1,104 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/schema.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class RowBlock;
+class TypeInfo;
+
+namespace tserver {
+
+// Keeps the first rows of a scan along a column, as specified by a
+// TopNSpecPB, as the rows are read in RowBlocks.
+//
+// The rows kept are in a max-heap whose top is the last of them, which is
+// the threshold a new row must come before to be kept once the heap is full.
+// Most rows of a large scan are thus rejected by a single comparison of their
+// sort cell, without being copied.
+class ScanTopN {
+ public:
+  // Creates a Top-N of RowBlocks of 'block_schema'. The column index of
+  // 'spec' refers to 'client_schema', whose columns must all be in
+  // 'block_schema'.
+  static Status Create(const TopNSpecPB& spec,
+                       const Schema& block_schema,
+                       const Schema& client_schema,
+                       std::unique_ptr<ScanTopN>* top_n);
+
+  // Keeps the selected rows of 'block' which are among the first rows so far.
+  void AddRowBlock(const RowBlock& block);
+
+  // Returns the number of rows kept.
+  size_t num_rows() const {
+    return rows_.size();
+  }
+
+  // Returns the rows kept, in order, in a block of the schema of the
+  // RowBlocks. The block is only valid until the Top-N is destroyed, and no
+  // row may be added afterwards.
+  const RowBlock& Finish();
+
+ private:
+  ScanTopN() = default;
+
+  // Returns true if the sort cell 'a' comes before the sort cell 'b'.
+  bool Before(bool a_null, const void* a, bool b_null, const void* b) const;
+
+  // Returns true if the kept row 'a' comes before the kept row 'b'.
+  bool RowBefore(const faststring& a, const faststring& b) const;
+
+  // Copies the row 'row_idx' of 'block' into 'dst', with its indirect data.
+  void CopyRow(const RowBlock& block, size_t row_idx, faststring* dst) const;
+
+  // The schema of the RowBlocks and of the rows kept.
+  Schema schema_;
+
+  // The index of the sort column in 'schema_', and its type.
+  int sort_col_idx_;
+  const TypeInfo* sort_type_info_;
+  bool sort_col_nullable_;
+
+  bool descending_;
+  size_t limit_;
+
+  // The rows kept as contiguous rows of 'schema_' followed by their indirect
+  // data, as a max-heap along the sort column. They're held by pointer so
+  // that the indirect data doesn't move with the heap.
+  std::vector<std::unique_ptr<faststring>> rows_;
+
+  // The result of Finish(), if it was called.
+  RowBlockMemory result_mem_;
+  std::unique_ptr<RowBlock> result_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScanTopN);
+};
+
+} // namespace tserver
+} // namespace kudu
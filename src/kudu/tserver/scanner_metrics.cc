@@ -25,6 +25,13 @@ METRIC_DEFINE_counter(server, scanners_expired,
                       "Number of scanners that have expired due to inactivity since service start",
                       kudu::MetricLevel::kWarn);
 
+METRIC_DEFINE_counter(server, scanner_batches_prefetched,
+                      "Scanner Batches Prefetched",
+                      kudu::MetricUnit::kUnits,
+                      "Number of batches of scan results computed while the previous batch "
+                      "was on the wire, ahead of the requests for them",
+                      kudu::MetricLevel::kDebug);
+
 METRIC_DEFINE_histogram(server, scanner_duration,
                         "Scanner Duration",
                         kudu::MetricUnit::kMicroseconds,
@@ -39,6 +46,7 @@ namespace tserver {
 ScannerMetrics::ScannerMetrics(const scoped_refptr<MetricEntity>& metric_entity)
     : scanners_expired(
           METRIC_scanners_expired.Instantiate(metric_entity)),
+      batches_prefetched(METRIC_scanner_batches_prefetched.Instantiate(metric_entity)),
       scanner_duration(METRIC_scanner_duration.Instantiate(metric_entity)) {
 }
 
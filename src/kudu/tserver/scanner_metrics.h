@@ -39,6 +39,10 @@ struct ScannerMetrics {
   // expired since the start of service.
   scoped_refptr<Counter> scanners_expired;
 
+  // Keeps track of the number of batches computed ahead of the requests
+  // for them.
+  scoped_refptr<Counter> batches_prefetched;
+
   // Keeps track of the duration of scanners.
   scoped_refptr<Histogram> scanner_duration;
 };
@@ -40,15 +40,21 @@
 #include "kudu/rpc/remote_user.h"
 #include "kudu/tablet/tablet_metadata.h"
 #include "kudu/tablet/tablet_metrics.h"
+#include "kudu/tserver/scan_json_paths.h"
+#include "kudu/tserver/scan_top_n.h"
 #include "kudu/tserver/scanner_metrics.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/mem_tracker.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/thread.h"
+#include "kudu/util/threadpool.h"
+#include "kudu/util/trace.h"
+#include "kudu/util/trace_metrics.h"
 
 DEFINE_int32(scanner_ttl_ms, 60000,
              "Number of milliseconds of inactivity allowed for a scanner "
@@ -83,6 +89,28 @@ DEFINE_int32(slow_scan_history_count, 10,
              "threshold for a slow scan is defined with --slow_scanner_threshold_ms.");
 TAG_FLAG(slow_scan_history_count, experimental);
 
+DEFINE_int32(scanner_prefetch_threads, 4,
+             "Maximum number of threads computing the next batches of the scanners "
+             "ahead of the requests for them. See --scanner_prefetch_batches.");
+TAG_FLAG(scanner_prefetch_threads, experimental);
+
+DEFINE_int32(scanner_parallel_scan_threads, 8,
+             "Maximum number of threads reading from the rowsets of unordered scans "
+             "in parallel. See --scanner_max_rowset_parallelism.");
+TAG_FLAG(scanner_parallel_scan_threads, experimental);
+
+DEFINE_int64(scanner_prefetch_max_scanner_memory_bytes, 16 * 1024 * 1024,
+             "Maximum amount of memory a single scanner may use for the batch "
+             "computed ahead of the request for it. The next batch isn't prefetched "
+             "if it may take more than that. See --scanner_prefetch_batches.");
+TAG_FLAG(scanner_prefetch_max_scanner_memory_bytes, experimental);
+TAG_FLAG(scanner_prefetch_max_scanner_memory_bytes, runtime);
+
+DEFINE_int64(scanner_prefetch_memory_limit_mb, 1024,
+             "Maximum amount of memory, in MiB, all the batches computed ahead of the "
+             "requests for them may use. See --scanner_prefetch_batches.");
+TAG_FLAG(scanner_prefetch_memory_limit_mb, experimental);
+
 DECLARE_int32(rpc_default_keepalive_time_ms);
 
 METRIC_DEFINE_gauge_size(server, active_scanners,
@@ -100,6 +128,7 @@ METRIC_DEFINE_gauge_size(server, slow_scans,
 
 using kudu::rpc::RemoteUser;
 using kudu::tablet::TabletReplica;
+using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::unordered_map;
@@ -128,8 +157,63 @@ GROUP_FLAG_VALIDATOR(idle_intervals, ValidateScannerAndRpcConnectionIdleTimes);
 } // anonymous namespace
 
 namespace kudu {
+
+namespace cfile {
+extern const char* CFILE_CACHE_MISS_BYTES_METRIC_NAME;
+extern const char* CFILE_CACHE_HIT_BYTES_METRIC_NAME;
+extern const char* CFILE_DECODE_NANOS_METRIC_NAME;
+}
+
+extern const char* PREDICATE_EVAL_NANOS_METRIC_NAME;
+
+namespace tablet {
+extern const char* DELTA_APPLY_NANOS_METRIC_NAME;
+}
+
 namespace tserver {
 
+ScanResourceStats ScanResourceStats::FromTrace(const Trace* trace) {
+  ScanResourceStats stats;
+  if (!trace) {
+    return stats;
+  }
+  const TraceMetrics& metrics = trace->metrics();
+  stats.cfile_cache_hit_bytes = metrics.GetMetric(cfile::CFILE_CACHE_HIT_BYTES_METRIC_NAME);
+  stats.cfile_cache_miss_bytes = metrics.GetMetric(cfile::CFILE_CACHE_MISS_BYTES_METRIC_NAME);
+  stats.cfile_decode_nanos = metrics.GetMetric(cfile::CFILE_DECODE_NANOS_METRIC_NAME);
+  stats.delta_apply_nanos = metrics.GetMetric(tablet::DELTA_APPLY_NANOS_METRIC_NAME);
+  stats.predicate_eval_nanos = metrics.GetMetric(PREDICATE_EVAL_NANOS_METRIC_NAME);
+  return stats;
+}
+
+ScanResourceStats& ScanResourceStats::operator+=(const ScanResourceStats& other) {
+  cfile_cache_hit_bytes += other.cfile_cache_hit_bytes;
+  cfile_cache_miss_bytes += other.cfile_cache_miss_bytes;
+  cfile_decode_nanos += other.cfile_decode_nanos;
+  delta_apply_nanos += other.delta_apply_nanos;
+  predicate_eval_nanos += other.predicate_eval_nanos;
+  return *this;
+}
+
+ScanResourceStats ScanResourceStats::operator-(const ScanResourceStats& other) const {
+  ScanResourceStats diff;
+  diff.cfile_cache_hit_bytes = cfile_cache_hit_bytes - other.cfile_cache_hit_bytes;
+  diff.cfile_cache_miss_bytes = cfile_cache_miss_bytes - other.cfile_cache_miss_bytes;
+  diff.cfile_decode_nanos = cfile_decode_nanos - other.cfile_decode_nanos;
+  diff.delta_apply_nanos = delta_apply_nanos - other.delta_apply_nanos;
+  diff.predicate_eval_nanos = predicate_eval_nanos - other.predicate_eval_nanos;
+  return diff;
+}
+
+PrefetchedScanBatch::PrefetchedScanBatch(shared_ptr<MemTracker> mem_tracker, int64_t memory)
+    : mem_tracker_(std::move(mem_tracker)),
+      memory_(memory) {
+}
+
+PrefetchedScanBatch::~PrefetchedScanBatch() {
+  mem_tracker_->Release(memory_);
+}
+
 ScannerManager::ScannerManager(const scoped_refptr<MetricEntity>& metric_entity)
     : shutdown_(false),
       shutdown_cv_(&shutdown_lock_),
@@ -155,9 +239,19 @@ ScannerManager::ScannerManager(const scoped_refptr<MetricEntity>& metric_entity)
   if (FLAGS_slow_scan_history_count > 0) {
     slow_scans_.reserve(FLAGS_slow_scan_history_count);
   }
+
+  CHECK_OK(ThreadPoolBuilder("scan-prefetch")
+               .set_max_threads(FLAGS_scanner_prefetch_threads)
+               .Build(&prefetch_pool_));
+  CHECK_OK(ThreadPoolBuilder("scan-parallel")
+               .set_max_threads(FLAGS_scanner_parallel_scan_threads)
+               .Build(&parallel_scan_pool_));
+  prefetch_mem_tracker_ = MemTracker::CreateTracker(
+      FLAGS_scanner_prefetch_memory_limit_mb * 1024 * 1024, "scanner-prefetch");
 }
 
 ScannerManager::~ScannerManager() {
+  Shutdown();
   {
     MutexLock l(shutdown_lock_);
     shutdown_ = true;
@@ -196,6 +290,23 @@ void ScannerManager::RunCollectAndRemovalThread() {
   }
 }
 
+Status ScannerManager::SubmitPrefetch(std::function<void()> task) {
+  return prefetch_pool_->Submit(std::move(task));
+}
+
+bool ScannerManager::TryReservePrefetchMemory(int64_t bytes) {
+  if (bytes > FLAGS_scanner_prefetch_max_scanner_memory_bytes) {
+    return false;
+  }
+  return prefetch_mem_tracker_->TryConsume(bytes);
+}
+
+void ScannerManager::Shutdown() {
+  // The prefetches may wait for parallel reads.
+  prefetch_pool_->Shutdown();
+  parallel_scan_pool_->Shutdown();
+}
+
 ScannerManager::ScannerMapStripe& ScannerManager::GetStripeByScannerId(const string& scanner_id) {
   size_t slot = HashStringThoroughly(scanner_id.data(), scanner_id.size()) % kNumScannerMapStripes;
   return *scanner_maps_[slot];
@@ -500,6 +611,7 @@ Scanner::Scanner(string id, const scoped_refptr<TabletReplica>& tablet_replica,
       arena_(256),
       last_access_time_(start_time_),
       call_seq_id_(0),
+      prefetched_call_seq_id_(0),
       num_rows_returned_(0) {
   if (tablet_replica_) {
     auto tablet = tablet_replica->shared_tablet();
@@ -510,6 +622,8 @@ Scanner::Scanner(string id, const scoped_refptr<TabletReplica>& tablet_replica,
 }
 
 Scanner::~Scanner() {
+  // The prefetched batch may refer to the iterator and the schemas.
+  prefetched_batch_.reset();
   if (tablet_replica_) {
     auto tablet = tablet_replica_->shared_tablet();
     if (tablet && tablet->metrics()) {
@@ -526,6 +640,51 @@ void Scanner::AddTimings(const CpuTimes& elapsed) {
   cpu_times_.Add(elapsed);
 }
 
+void Scanner::AddResourceStats(const ScanResourceStats& used) {
+  std::unique_lock<RWMutex> l(cpu_times_lock_);
+  resource_stats_ += used;
+}
+
+void Scanner::SetPrefetchedBatch(uint32_t call_seq_id,
+                                 unique_ptr<PrefetchedScanBatch> batch) {
+  lock_.AssertAcquired();
+  DCHECK(!prefetched_batch_);
+  prefetched_call_seq_id_ = call_seq_id;
+  prefetched_batch_ = std::move(batch);
+  if (metrics_) {
+    metrics_->batches_prefetched->Increment();
+  }
+}
+
+unique_ptr<PrefetchedScanBatch> Scanner::TakePrefetchedBatch(uint32_t call_seq_id) {
+  lock_.AssertAcquired();
+  if (!prefetched_batch_ || prefetched_call_seq_id_ != call_seq_id) {
+    return nullptr;
+  }
+  return std::move(prefetched_batch_);
+}
+
+void Scanner::AddRuntimeFilter(int col_idx, ColumnPredicate filter) {
+  lock_.AssertAcquired();
+  for (auto& f : runtime_filters_) {
+    if (f.first == col_idx) {
+      f.second.Merge(filter);
+      return;
+    }
+  }
+  runtime_filters_.emplace_back(col_idx, std::move(filter));
+}
+
+void Scanner::set_top_n(unique_ptr<ScanTopN> top_n) {
+  lock_.AssertAcquired();
+  top_n_ = std::move(top_n);
+}
+
+void Scanner::set_json_paths(unique_ptr<ScanJsonPaths> json_paths) {
+  lock_.AssertAcquired();
+  json_paths_ = std::move(json_paths);
+}
+
 void Scanner::Init(unique_ptr<RowwiseIterator> iter,
                    unique_ptr<ScanSpec> spec,
                    unique_ptr<Schema> client_projection) {
@@ -602,6 +761,7 @@ SharedScanDescriptor Scanner::Descriptor() const {
   descriptor->last_call_seq_id = ANNOTATE_UNPROTECTED_READ(call_seq_id_);
   descriptor->last_access_time = last_access_time_.load(std::memory_order_relaxed);
   descriptor->cpu_times = cpu_times();
+  descriptor->resource_stats = resource_stats();
 
   return descriptor;
 }
@@ -611,5 +771,10 @@ CpuTimes Scanner::cpu_times() const {
   return cpu_times_;
 }
 
+ScanResourceStats Scanner::resource_stats() const {
+  shared_lock<RWMutex> l(cpu_times_lock_);
+  return resource_stats_;
+}
+
 } // namespace tserver
 } // namespace kudu
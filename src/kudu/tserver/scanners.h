@@ -19,8 +19,10 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -29,6 +31,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest_prod.h>
 
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/iterator_stats.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/gutil/macros.h"
@@ -46,16 +49,21 @@
 #include "kudu/util/oid_generator.h"
 #include "kudu/util/rw_mutex.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/trace.h"
 
 namespace kudu {
 
+class MemTracker;
 class RowwiseIterator;
 class Schema;
 class Status;
 class Thread;
+class ThreadPool;
 
 namespace tserver {
 
+class ScanJsonPaths;
+class ScanTopN;
 class Scanner;
 
 enum class ScanState;
@@ -65,6 +73,47 @@ struct ScannerMetrics;
 typedef std::shared_ptr<Scanner> SharedScanner;
 typedef scoped_refptr<ScanDescriptor> SharedScanDescriptor;
 
+// The resources used by the RPCs of a scan beyond CPU time, as counted in
+// their traces.
+struct ScanResourceStats {
+  // Bytes of CFile blocks read from the block cache or, on a miss, from disk.
+  int64_t cfile_cache_hit_bytes = 0;
+  int64_t cfile_cache_miss_bytes = 0;
+
+  // Time spent decoding CFile blocks, applying deltas and evaluating
+  // predicates, in nanoseconds.
+  int64_t cfile_decode_nanos = 0;
+  int64_t delta_apply_nanos = 0;
+  int64_t predicate_eval_nanos = 0;
+
+  // Returns the stats counted so far in 'trace', which may be null.
+  static ScanResourceStats FromTrace(const Trace* trace);
+
+  ScanResourceStats& operator+=(const ScanResourceStats& other);
+  ScanResourceStats operator-(const ScanResourceStats& other) const;
+};
+
+// A batch of the results of a scanner, computed while the previous batch was
+// on the wire, ahead of the request for it (see --scanner_prefetch_batches).
+//
+// The memory of the prefetched batches is budgeted by the ScannerManager: the
+// memory reserved for a batch is released when it's destroyed.
+class PrefetchedScanBatch {
+ public:
+  virtual ~PrefetchedScanBatch();
+
+ protected:
+  // 'memory' bytes must have been reserved with
+  // ScannerManager::TryReservePrefetchMemory().
+  PrefetchedScanBatch(std::shared_ptr<MemTracker> mem_tracker, int64_t memory);
+
+ private:
+  const std::shared_ptr<MemTracker> mem_tracker_;
+  const int64_t memory_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrefetchedScanBatch);
+};
+
 // Manages the live scanners within a Tablet Server.
 //
 // When a scanner is created by a client, it is assigned a unique scanner ID.
@@ -132,6 +181,31 @@ class ScannerManager {
   // Collect slow scanners whose scan times exceed the threshold.
   void CollectSlowScanners();
 
+  // Runs 'task', which computes the next batch of a scanner ahead of the
+  // request for it, on the prefetching thread pool.
+  Status SubmitPrefetch(std::function<void()> task);
+
+  // Reserves 'bytes' of memory for a prefetched batch, returning false if
+  // that's over the budget of a scanner or of all the scanners
+  // (see --scanner_prefetch_max_scanner_memory_bytes and
+  // --scanner_prefetch_memory_limit_mb).
+  bool TryReservePrefetchMemory(int64_t bytes);
+
+  // Returns the tracker of the memory of the prefetched batches.
+  const std::shared_ptr<MemTracker>& prefetch_mem_tracker() const {
+    return prefetch_mem_tracker_;
+  }
+
+  // Returns the pool the unordered scans read from several rowsets at once on
+  // (see --scanner_max_rowset_parallelism).
+  ThreadPool* parallel_scan_pool() const {
+    return parallel_scan_pool_.get();
+  }
+
+  // Waits for the prefetches and the parallel reads in progress, and stops
+  // running new ones.
+  void Shutdown();
+
  private:
   FRIEND_TEST(ScannerTest, TestExpire);
 
@@ -193,6 +267,15 @@ class ScannerManager {
   // Thread to remove expired scanners.
   scoped_refptr<kudu::Thread> removal_thread_;
 
+  // Computes the prefetched batches.
+  std::unique_ptr<ThreadPool> prefetch_pool_;
+
+  // Reads from the rowsets of unordered scans in parallel.
+  std::unique_ptr<ThreadPool> parallel_scan_pool_;
+
+  // Tracks the memory of the prefetched batches.
+  std::shared_ptr<MemTracker> prefetch_mem_tracker_;
+
   FunctionGaugeDetacher metric_detacher_;
 
   DISALLOW_COPY_AND_ASSIGN(ScannerManager);
@@ -307,6 +390,9 @@ class Scanner {
   // Add the timings in 'elapsed' to the total timings for this scanner.
   void AddTimings(const CpuTimes& elapsed);
 
+  // Add the resources in 'used' to the total resources used by this scanner.
+  void AddResourceStats(const ScanResourceStats& used);
+
   Arena* arena() {
     lock_.AssertAcquired();
     return &arena_;
@@ -338,6 +424,21 @@ class Scanner {
     call_seq_id_++;
   }
 
+  // Keeps 'batch', computed ahead of the request with the call sequence ID
+  // 'call_seq_id'. Requires there's no prefetched batch already.
+  void SetPrefetchedBatch(uint32_t call_seq_id, std::unique_ptr<PrefetchedScanBatch> batch);
+
+  // Returns the batch prefetched for the request with the call sequence ID
+  // 'call_seq_id', or null if there's none. Its rows were consumed from the
+  // iterator, so it must be returned if there's one.
+  std::unique_ptr<PrefetchedScanBatch> TakePrefetchedBatch(uint32_t call_seq_id);
+
+  // Returns true if a batch was prefetched and not taken yet.
+  bool has_prefetched_batch() const {
+    lock_.AssertAcquired();
+    return prefetched_batch_ != nullptr;
+  }
+
   // Return the delta from the last time this scan was updated to 'now'.
   MonoDelta TimeSinceLastAccess(const MonoTime& now) const {
     std::unique_lock<Mutex> l(lock_, std::try_to_lock);
@@ -369,6 +470,51 @@ class Scanner {
     return row_format_flags_;
   }
 
+  // Sets the aggregates computed instead of returning the rows.
+  void set_aggregation(AggregationSpecPB aggregation) {
+    lock_.AssertAcquired();
+    aggregation_ = std::move(aggregation);
+  }
+
+  // Returns the aggregates computed instead of returning the rows, or null if
+  // the rows are returned.
+  const AggregationSpecPB* aggregation() const {
+    lock_.AssertAcquired();
+    return aggregation_ ? &*aggregation_ : nullptr;
+  }
+
+  // Adds a filter on the rows returned from now on, which is evaluated on the
+  // column 'col_idx' of the blocks of the iterator. It's merged with the
+  // previous filter on the same column, if any.
+  void AddRuntimeFilter(int col_idx, ColumnPredicate filter);
+
+  // Returns the filters added with AddRuntimeFilter(), with the index of
+  // their column in the blocks of the iterator.
+  const std::vector<std::pair<int, ColumnPredicate>>& runtime_filters() const {
+    lock_.AssertAcquired();
+    return runtime_filters_;
+  }
+
+  // Sets the Top-N which keeps the rows returned at the end of the scan.
+  void set_top_n(std::unique_ptr<ScanTopN> top_n);
+
+  // Returns the Top-N which keeps the rows returned at the end of the scan,
+  // or null if the rows are returned as they're scanned.
+  ScanTopN* top_n() const {
+    lock_.AssertAcquired();
+    return top_n_.get();
+  }
+
+  // Sets the JSON path predicates and projections of the scan.
+  void set_json_paths(std::unique_ptr<ScanJsonPaths> json_paths);
+
+  // Returns the JSON path predicates and projections applied to the rows
+  // scanned, or null if there are none.
+  const ScanJsonPaths* json_paths() const {
+    lock_.AssertAcquired();
+    return json_paths_.get();
+  }
+
   void add_num_rows_returned(int64_t num_rows_added) {
     lock_.AssertAcquired();
     num_rows_returned_ += num_rows_added;
@@ -395,6 +541,10 @@ class Scanner {
   // Does not require the AccessLock.
   CpuTimes cpu_times() const;
 
+  // Returns the resources used by this scanner so far.
+  // Does not require the AccessLock.
+  ScanResourceStats resource_stats() const;
+
  private:
   friend class ScannerManager;
 
@@ -423,6 +573,19 @@ class Scanner {
   // The row format flags the client passed, if any.
   const uint64_t row_format_flags_;
 
+  // The aggregates the client asked for, if any.
+  std::optional<AggregationSpecPB> aggregation_;
+
+  // The Top-N of the scan, if any.
+  std::unique_ptr<ScanTopN> top_n_;
+
+  // The JSON path predicates and projections of the scan, if any.
+  std::unique_ptr<ScanJsonPaths> json_paths_;
+
+  // The filters added while the scan runs, with the index of their column
+  // in the blocks of the iterator. Their values are allocated in 'arena_'.
+  std::vector<std::pair<int, ColumnPredicate>> runtime_filters_;
+
   // (Optional) scanner metrics struct, for recording scanner's duration.
   ScannerMetrics* metrics_;
 
@@ -456,6 +619,12 @@ class Scanner {
   // Only modified under lock_ but can be read outside.
   uint32_t call_seq_id_;
 
+  // The batch computed ahead of the request with the call sequence ID
+  // 'prefetched_call_seq_id_', if any.
+  // Protected by lock_.
+  std::unique_ptr<PrefetchedScanBatch> prefetched_batch_;
+  uint32_t prefetched_call_seq_id_;
+
   // A summary of the statistics already reported to the metrics system
   // for this scanner. This allows us to report the metrics incrementally
   // as the scanner proceeds.
@@ -467,9 +636,10 @@ class Scanner {
   int64_t num_rows_returned_;
 
   // The cumulative amounts of wall, user cpu, and system cpu time spent on
-  // this scanner, in seconds.
+  // this scanner, in seconds, and of the other resources it used.
   mutable RWMutex cpu_times_lock_;
   CpuTimes cpu_times_;
+  ScanResourceStats resource_stats_;
 
   DISALLOW_COPY_AND_ASSIGN(Scanner);
 };
@@ -518,6 +688,9 @@ struct ScanDescriptor : public RefCountedThreadSafe<ScanDescriptor> {
   // The cumulative amounts of wall, user cpu, and system cpu time spent on
   // this scanner, in seconds.
   CpuTimes cpu_times;
+
+  // The cumulative amounts of the other resources used by this scanner.
+  ScanResourceStats resource_stats;
 };
 
 // RAII wrapper to update a scanner with timing information upon scope exit.
@@ -529,7 +702,8 @@ class ScopedAddScannerTiming {
   explicit ScopedAddScannerTiming(Scanner* scanner, CpuTimes* cpu_times)
       : stopped_(false),
         scanner_(scanner),
-        cpu_times_(cpu_times) {
+        cpu_times_(cpu_times),
+        start_resource_stats_(ScanResourceStats::FromTrace(Trace::CurrentTrace())) {
     sw_.start();
   }
 
@@ -544,12 +718,15 @@ class ScopedAddScannerTiming {
     stopped_ = true;
     sw_.stop();
     scanner_->AddTimings(sw_.elapsed());
+    scanner_->AddResourceStats(
+        ScanResourceStats::FromTrace(Trace::CurrentTrace()) - start_resource_stats_);
     *cpu_times_ = scanner_->cpu_times();
   }
 
   bool stopped_;
   Scanner* scanner_;
   CpuTimes* cpu_times_;
+  const ScanResourceStats start_resource_stats_;
   Stopwatch sw_;
 
   DISALLOW_COPY_AND_ASSIGN(ScopedAddScannerTiming);
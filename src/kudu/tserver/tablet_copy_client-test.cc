@@ -491,13 +491,13 @@ TEST_P(TabletCopyClientBasicTest, TestVerifyData) {
   valid_chunk.set_total_data_length(kDataTotalLen);
 
   // Make sure we work on the happy case.
-  ASSERT_OK(client_->VerifyData(kGoodOffset, valid_chunk));
+  ASSERT_OK(client_->VerifyData(kGoodOffset, valid_chunk, valid_chunk.data()));
 
   // Test unexpected offset.
   DataChunkPB bad_offset = valid_chunk;
   bad_offset.set_offset(kBadOffset);
   Status s;
-  s = client_->VerifyData(kGoodOffset, bad_offset);
+  s = client_->VerifyData(kGoodOffset, bad_offset, bad_offset.data());
   ASSERT_TRUE(s.IsInvalidArgument()) << "Bad offset expected: " << s.ToString();
   ASSERT_STR_CONTAINS(s.ToString(), "Offset did not match");
   LOG(INFO) << "Expected error returned: " << s.ToString();
@@ -505,7 +505,7 @@ TEST_P(TabletCopyClientBasicTest, TestVerifyData) {
   // Test bad checksum.
   DataChunkPB bad_checksum = valid_chunk;
   bad_checksum.set_data(bad);
-  s = client_->VerifyData(kGoodOffset, bad_checksum);
+  s = client_->VerifyData(kGoodOffset, bad_checksum, bad_checksum.data());
   ASSERT_TRUE(s.IsCorruption()) << "Invalid checksum expected: " << s.ToString();
   ASSERT_STR_CONTAINS(s.ToString(), "CRC32 does not match");
   LOG(INFO) << "Expected error returned: " << s.ToString();
@@ -921,6 +921,7 @@ Status RemoteTabletCopyClient::DownloadSuperBlock(string* superblock_path) {
   req.set_session_id(session_id_);
   req.mutable_data_id()->CopyFrom(data_id);
   req.set_max_length(FLAGS_tablet_copy_transfer_chunk_size_bytes);
+  req.set_data_in_sidecar(true);
 
   // Create a temporary file to store the superblock.
   string tmpl = "super_block.tmp.XXXXXX";
@@ -940,15 +941,19 @@ Status RemoteTabletCopyClient::DownloadSuperBlock(string* superblock_path) {
         return proxy_->FetchData(req, &resp, &controller);
     }), "unable to fetch data from remote");
 
+    Slice data;
+    RETURN_NOT_OK_PREPEND(GetChunkData(resp.chunk(), controller, &data),
+                          "unable to fetch data from remote");
+
     // Sanity-check for corruption.
-    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk()),
+    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk(), data),
                           Substitute("error validating data item $0",
                                      pb_util::SecureShortDebugString(data_id)));
 
     // Write the data.
-    RETURN_NOT_OK(tmp_file->Write(offset, resp.chunk().data()));
+    RETURN_NOT_OK(tmp_file->Write(offset, data));
 
-    auto chunk_size = resp.chunk().data().size();
+    auto chunk_size = data.size();
     done = offset + chunk_size == resp.chunk().total_data_length();
     offset += chunk_size;
   }
@@ -966,6 +971,7 @@ Status RemoteTabletCopyClient::DownloadFile(const DataIdPB& data_id,
   req.set_session_id(session_id_);
   req.mutable_data_id()->CopyFrom(data_id);
   req.set_max_length(FLAGS_tablet_copy_transfer_chunk_size_bytes);
+  req.set_data_in_sidecar(true);
 
   bool done = false;
   while (!done) {
@@ -977,13 +983,17 @@ Status RemoteTabletCopyClient::DownloadFile(const DataIdPB& data_id,
         return proxy_->FetchData(req, &resp, &controller);
     }), "unable to fetch data from remote");
 
+    Slice data;
+    RETURN_NOT_OK_PREPEND(GetChunkData(resp.chunk(), controller, &data),
+                          "unable to fetch data from remote");
+
     // Sanity-check for corruption.
-    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk()),
+    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk(), data),
                           Substitute("Error validating data item $0",
                                      pb_util::SecureShortDebugString(data_id)));
 
     // Write the data.
-    RETURN_NOT_OK(appendable->Append(resp.chunk().data()));
+    RETURN_NOT_OK(appendable->Append(data));
 
     if (PREDICT_FALSE(FLAGS_tablet_copy_download_file_inject_latency_ms > 0)) {
       LOG_WITH_PREFIX(INFO) << "Injecting latency into file download: " <<
@@ -991,7 +1001,7 @@ Status RemoteTabletCopyClient::DownloadFile(const DataIdPB& data_id,
       SleepFor(MonoDelta::FromMilliseconds(FLAGS_tablet_copy_download_file_inject_latency_ms));
     }
 
-    auto chunk_size = resp.chunk().data().size();
+    auto chunk_size = data.size();
     done = offset + chunk_size == resp.chunk().total_data_length();
     offset += chunk_size;
     if (dst_tablet_copy_metrics_) {
@@ -1002,7 +1012,18 @@ Status RemoteTabletCopyClient::DownloadFile(const DataIdPB& data_id,
   return Status::OK();
 }
 
-Status TabletCopyClient::VerifyData(uint64_t offset, const DataChunkPB& chunk) {
+Status TabletCopyClient::GetChunkData(const DataChunkPB& chunk,
+                                      const rpc::RpcController& controller,
+                                      Slice* data) {
+  if (!chunk.has_data_sidecar_idx()) {
+    *data = chunk.data();
+    return Status::OK();
+  }
+  return controller.GetInboundSidecar(chunk.data_sidecar_idx(), data);
+}
+
+Status TabletCopyClient::VerifyData(uint64_t offset, const DataChunkPB& chunk,
+                                    const Slice& data) {
   // Verify the offset is what we expected.
   if (offset != chunk.offset()) {
     return Status::InvalidArgument("Offset did not match what was asked for",
@@ -1010,17 +1031,17 @@ Status TabletCopyClient::VerifyData(uint64_t offset, const DataChunkPB& chunk) {
   }
 
   // Verify that the chunk does not overflow the total data length.
-  if (offset + chunk.data().length() > chunk.total_data_length()) {
+  if (offset + data.size() > chunk.total_data_length()) {
     return Status::InvalidArgument("Chunk exceeds total block data length",
-        Substitute("$0 vs $1", offset + chunk.data().length(), chunk.total_data_length()));
+        Substitute("$0 vs $1", offset + data.size(), chunk.total_data_length()));
   }
 
   // Verify the checksum.
-  uint32_t crc32 = crc::Crc32c(chunk.data().data(), chunk.data().length());
+  uint32_t crc32 = crc::Crc32c(data.data(), data.size());
   if (PREDICT_FALSE(crc32 != chunk.crc32())) {
     return Status::Corruption(
         Substitute("CRC32 does not match at offset $0 size $1: $2 vs $3",
-          offset, chunk.data().size(), crc32, chunk.crc32()));
+          offset, data.size(), crc32, chunk.crc32()));
   }
   return Status::OK();
 }
@@ -39,6 +39,7 @@ class BlockIdPB;
 class FsManager;
 class HostPort;
 class Schema;
+class Slice;
 class ThreadPool;
 class WritableFile;
 
@@ -260,7 +261,14 @@ class TabletCopyClient {
   virtual Status TransferFile(const DataIdPB& data_id, fs::WritableBlock* appendable) = 0;
   virtual Status TransferFile(const DataIdPB& data_id, WritableFile* appendable) = 0;
 
-  Status VerifyData(uint64_t offset, const DataChunkPB& chunk);
+  // Sets 'data' to the bytes of 'chunk', which are either in the chunk itself
+  // or in a sidecar of the response received through 'controller'.
+  static Status GetChunkData(const DataChunkPB& chunk,
+                             const rpc::RpcController& controller,
+                             Slice* data);
+
+  // Verifies that 'data' are the bytes of 'chunk' expected at 'offset'.
+  Status VerifyData(uint64_t offset, const DataChunkPB& chunk, const Slice& data);
 
   // Runs the provided functor, which must send an RPC and return the result
   // status, until it succeeds, times out, or fails with a non-retriable error.
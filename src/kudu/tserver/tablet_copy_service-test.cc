@@ -49,6 +49,7 @@
 #include "kudu/tserver/tablet_copy.pb.h"
 #include "kudu/tserver/tablet_copy.proxy.h"
 #include "kudu/tserver/tablet_server.h"
+#include "kudu/util/crc.h"
 #include "kudu/util/env.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/monotime.h"
@@ -61,6 +62,7 @@
 DECLARE_bool(crash_on_eio);
 DECLARE_double(env_inject_eio);
 DECLARE_uint64(tablet_copy_idle_timeout_sec);
+DECLARE_uint64(tablet_copy_max_bytes_per_sec);
 DECLARE_uint64(tablet_copy_timeout_poll_period_ms);
 
 using kudu::log::ReadableLogSegment;
@@ -449,6 +451,71 @@ TEST_F(TabletCopyServiceTest, TestFetchBlockIncrementally) {
   }
 }
 
+// Test that we are able to fetch a block whose data is sent in a sidecar.
+TEST_F(TabletCopyServiceTest, TestFetchBlockInSidecar) {
+  string session_id;
+  tablet::TabletSuperBlockPB superblock;
+  ASSERT_OK(DoBeginValidTabletCopySession(&session_id, &superblock));
+
+  BlockId block_id = FirstColumnBlockId(superblock);
+  Slice local_data;
+  faststring scratch;
+  ASSERT_OK(ReadLocalBlockFile(mini_server_->server()->fs_manager(), block_id,
+                               &scratch, &local_data));
+
+  FetchDataRequestPB req;
+  req.set_session_id(session_id);
+  req.mutable_data_id()->CopyFrom(AsDataTypeId(block_id));
+  req.set_data_in_sidecar(true);
+  FetchDataResponsePB resp;
+  RpcController controller;
+  controller.set_timeout(MonoDelta::FromSeconds(1.0));
+  ASSERT_OK(tablet_copy_proxy_->FetchData(req, &resp, &controller));
+
+  ASSERT_TRUE(resp.chunk().has_data_sidecar_idx());
+  ASSERT_TRUE(resp.chunk().data().empty());
+  Slice remote_data;
+  ASSERT_OK(controller.GetInboundSidecar(resp.chunk().data_sidecar_idx(), &remote_data));
+  ASSERT_EQ(local_data, remote_data);
+  ASSERT_EQ(crc::Crc32c(local_data.data(), local_data.size()), resp.chunk().crc32());
+}
+
+class TabletCopyServiceThrottledTest : public TabletCopyServiceTest {
+ public:
+  TabletCopyServiceThrottledTest() {
+    // Allow 1000 bytes per throttler refill period.
+    FLAGS_tablet_copy_max_bytes_per_sec = 10000;
+  }
+};
+
+// Test that the source server limits the rate at which it sends data, both by
+// shrinking the chunks and by rejecting the requests beyond its rate.
+TEST_F(TabletCopyServiceThrottledTest, TestFetchBlockThrottled) {
+  string session_id;
+  tablet::TabletSuperBlockPB superblock;
+  ASSERT_OK(DoBeginValidTabletCopySession(&session_id, &superblock));
+  BlockId block_id = FirstColumnBlockId(superblock);
+
+  int num_fetched = 0;
+  int num_throttled = 0;
+  for (int i = 0; i < 10; i++) {
+    FetchDataResponsePB resp;
+    RpcController controller;
+    Status s = DoFetchData(session_id, AsDataTypeId(block_id), nullptr, nullptr,
+                           &resp, &controller);
+    if (s.ok()) {
+      ASSERT_LE(resp.chunk().data().size(), 1000);
+      num_fetched++;
+    } else {
+      ASSERT_TRUE(s.IsRemoteError()) << s.ToString();
+      ASSERT_EQ(ErrorStatusPB::ERROR_SERVER_TOO_BUSY, controller.error_response()->code());
+      num_throttled++;
+    }
+  }
+  ASSERT_GT(num_fetched, 0);
+  ASSERT_GT(num_throttled, 0);
+}
+
 // Test that we are able to fetch log segments.
 TEST_F(TabletCopyServiceTest, TestFetchLog) {
   string session_id;
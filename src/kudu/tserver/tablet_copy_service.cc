@@ -16,6 +16,7 @@
 // under the License.
 #include "kudu/tserver/tablet_copy_service.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <ostream>
@@ -37,6 +38,8 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/rpc/rpc_context.h"
+#include "kudu/rpc/rpc_header.pb.h"
+#include "kudu/rpc/rpc_sidecar.h"
 #include "kudu/rpc/transfer.h"
 #include "kudu/server/server_base.h"
 #include "kudu/tablet/metadata.pb.h"
@@ -83,6 +86,15 @@ DEFINE_double(tablet_copy_early_session_timeout_prob, 0,
 TAG_FLAG(tablet_copy_early_session_timeout_prob, runtime);
 TAG_FLAG(tablet_copy_early_session_timeout_prob, unsafe);
 
+DEFINE_uint64(tablet_copy_max_bytes_per_sec, 0,
+              "Maximum rate, in bytes per second, at which this server sends "
+              "data to all of its tablet copy clients combined. FetchData() "
+              "requests beyond that rate are rejected as too busy and retried "
+              "by the clients after a backoff, which leaves the server's disk "
+              "and network bandwidth to the foreground traffic. 0 means no limit.");
+TAG_FLAG(tablet_copy_max_bytes_per_sec, advanced);
+TAG_FLAG(tablet_copy_max_bytes_per_sec, experimental);
+
 using std::string;
 using std::vector;
 using strings::Substitute;
@@ -112,6 +124,10 @@ TabletCopyServiceImpl::TabletCopyServiceImpl(
       rand_(GetRandomSeed32()),
       shutdown_latch_(1),
       tablet_copy_metrics_(server->metric_entity()) {
+  if (FLAGS_tablet_copy_max_bytes_per_sec > 0) {
+    throttler_.reset(new Throttler(MonoTime::Now(), 0,
+                                   FLAGS_tablet_copy_max_bytes_per_sec, 1.0));
+  }
   CHECK_OK(Thread::Create("tablet-copy", "tc-session-exp",
                           [this]() { this->EndExpiredSessions(); },
                           &session_expiration_thread_));
@@ -299,8 +315,28 @@ void TabletCopyServiceImpl::FetchData(const FetchDataRequestPB* req,
   RPC_RETURN_NOT_OK(ValidateFetchRequestDataId(data_id, &error_code),
                     error_code, "Invalid DataId", context);
 
+  if (throttler_) {
+    // The throttler never grants more than a refill period's worth of bytes
+    // at once, so don't send bigger chunks.
+    const int64_t max_chunk_len = std::max<int64_t>(
+        1, FLAGS_tablet_copy_max_bytes_per_sec * Throttler::kRefillPeriodMicros /
+           MonoTime::kMicrosecondsPerSecond);
+    if (client_maxlen <= 0 || client_maxlen > max_chunk_len) {
+      client_maxlen = max_chunk_len;
+    }
+    if (!throttler_->Take(MonoTime::Now(), 0, client_maxlen)) {
+      context->RespondRpcFailure(
+          rpc::ErrorStatusPB::ERROR_SERVER_TOO_BUSY,
+          Status::ServiceUnavailable("tablet copy rate limit exceeded, try again later"));
+      return;
+    }
+  }
+
   DataChunkPB* data_chunk = resp->mutable_chunk();
-  string* data = data_chunk->mutable_data();
+  // If the client supports it, the data is read into a buffer that is sent as
+  // a sidecar, saving the copy into the serialized response.
+  string sidecar_data;
+  string* data = req->data_in_sidecar() ? &sidecar_data : data_chunk->mutable_data();
   int64_t total_data_length = 0;
   if (data_id.type() == DataIdPB::BLOCK) {
     // Fetching a data block chunk.
@@ -323,12 +359,21 @@ void TabletCopyServiceImpl::FetchData(const FetchDataRequestPB* req,
   data_chunk->set_total_data_length(total_data_length);
   data_chunk->set_offset(offset);
 
-  tablet_copy_metrics_.bytes_sent->IncrementBy(resp->chunk().data().size());
+  tablet_copy_metrics_.bytes_sent->IncrementBy(data->size());
 
   // Calculate checksum.
   uint32_t crc32 = Crc32c(data->data(), data->length());
   data_chunk->set_crc32(crc32);
 
+  if (req->data_in_sidecar()) {
+    int sidecar_idx;
+    RPC_RETURN_NOT_OK(context->AddOutboundSidecar(
+                          rpc::RpcSidecar::FromString(std::move(sidecar_data)), &sidecar_idx),
+                      TabletCopyErrorPB::UNKNOWN_ERROR, "Unable to add data sidecar", context);
+    data_chunk->set_data("");
+    data_chunk->set_data_sidecar_idx(sidecar_idx);
+  }
+
   context->RespondSuccess();
 }
 
@@ -17,6 +17,7 @@
 #ifndef KUDU_TSERVER_TABLET_COPY_SERVICE_H_
 #define KUDU_TSERVER_TABLET_COPY_SERVICE_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -30,6 +31,7 @@
 #include "kudu/util/random.h"
 #include "kudu/util/status.h"
 #include "kudu/util/thread.h"
+#include "kudu/util/throttler.h"
 
 namespace google {
 namespace protobuf {
@@ -133,6 +135,10 @@ class TabletCopyServiceImpl : public TabletCopyServiceIf {
   scoped_refptr<Thread> session_expiration_thread_;
 
   TabletCopySourceMetrics tablet_copy_metrics_;
+
+  // Limits the rate at which data is sent to the tablet copy clients, shared
+  // by all the sessions. Null if --tablet_copy_max_bytes_per_sec is 0.
+  std::unique_ptr<Throttler> throttler_;
 };
 
 } // namespace tserver
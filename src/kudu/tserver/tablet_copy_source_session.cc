@@ -519,8 +519,7 @@ Status LocalTabletCopySourceSession::InitOnce() {
   // Read the SuperBlock from disk.
   string path = fs_manager_->GetTabletMetadataPath(tablet_id_);
   RETURN_NOT_OK_PREPEND(
-      pb_util::ReadPBContainerFromPath(fs_manager_->GetEnv(), path, &tablet_superblock_,
-                                       pb_util::SENSITIVE),
+      TabletMetadata::ReadSuperBlockFromPath(fs_manager_->GetEnv(), path, &tablet_superblock_),
       Substitute("Unable to access superblock for tablet $0", tablet_id_));
 
   // Open the data blocks and add them to the cache.
@@ -0,0 +1,291 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Benchmarks of the tablet server RPCs on the hot paths, sent to a running
+// tablet server with the shapes of real workloads: writes of large batches of
+// rows, scans returning large row sidecars and consensus updates carrying
+// batches of replicated writes.
+//
+// The TLS encryption, the number of client connections and the number of
+// client and server reactors are controlled by flags, e.g.:
+//
+//   tablet_server-rpc-bench --bench_enable_encryption --bench_client_connections=4 \
+//       --bench_client_reactors=2 --num_reactor_threads=8
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/wire_protocol-test-util.h"
+#include "kudu/common/wire_protocol.h"
+#include "kudu/common/wire_protocol.pb.h"
+#include "kudu/consensus/consensus.pb.h"
+#include "kudu/consensus/consensus.proxy.h"
+#include "kudu/consensus/opid.pb.h"
+#include "kudu/rpc/messenger.h"
+#include "kudu/rpc/rpc_controller.h"
+#include "kudu/tserver/mini_tablet_server.h"
+#include "kudu/tserver/tablet_server-test-base.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/tserver/tserver_service.proxy.h"
+#include "kudu/util/hdr_histogram.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/net/sockaddr.h"
+#include "kudu/util/status.h"
+#include "kudu/util/stopwatch.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DEFINE_int32(bench_run_seconds, 1, "Seconds to run each benchmark for");
+DEFINE_int32(bench_client_threads, 8,
+             "Number of client threads, each with a single outstanding call at a time");
+DEFINE_int32(bench_client_connections, 1,
+             "Number of connections to the tablet server the client threads are spread "
+             "across. Each connection is opened by a messenger of its own.");
+DEFINE_int32(bench_client_reactors, 1, "Number of reactor threads of each client messenger");
+DEFINE_bool(bench_enable_encryption, false,
+            "Whether to encrypt the connections to the tablet server with TLS");
+DEFINE_int32(bench_write_batch_rows, 1000, "Number of rows of each Write call");
+DEFINE_int32(bench_scan_rows, 100000, "Number of rows in the tablet scanned by the Scan calls");
+DEFINE_int32(bench_scan_batch_bytes, 1024 * 1024,
+             "Size of the row data returned by each Scan call");
+DEFINE_int32(bench_replicate_batch_ops, 16,
+             "Number of replicated ops of each UpdateConsensus call");
+DEFINE_int32(bench_replicate_op_rows, 100, "Number of rows of each replicated write op");
+
+DECLARE_bool(rpc_encrypt_loopback_connections);
+DECLARE_int32(num_reactor_threads);
+DECLARE_int32(rpc_timeout);
+
+using kudu::consensus::ConsensusRequestPB;
+using kudu::consensus::ConsensusResponsePB;
+using kudu::consensus::ConsensusServiceProxy;
+using kudu::consensus::ReplicateMsg;
+using kudu::rpc::Messenger;
+using kudu::rpc::MessengerBuilder;
+using kudu::rpc::RpcController;
+using std::atomic;
+using std::shared_ptr;
+using std::string;
+using std::thread;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+namespace tserver {
+
+// The highest latency tracked by the histograms: 60 seconds, in microseconds.
+static constexpr uint64_t kMaxLatencyUs = 60 * 1000 * 1000;
+
+class TabletServerRpcBench : public TabletServerTestBase {
+ public:
+  void SetUp() override {
+    OverrideFlagForSlowTests("bench_run_seconds", "10");
+    FLAGS_rpc_encrypt_loopback_connections = FLAGS_bench_enable_encryption;
+
+    NO_FATALS(TabletServerTestBase::SetUp());
+    NO_FATALS(StartTabletServer(/*num_data_dirs=*/1));
+
+    for (int i = 0; i < FLAGS_bench_client_connections; i++) {
+      MessengerBuilder bld("BenchClient");
+      bld.set_num_reactors(FLAGS_bench_client_reactors);
+      shared_ptr<Messenger> messenger;
+      ASSERT_OK(bld.Build(&messenger));
+      client_messengers_.emplace_back(std::move(messenger));
+    }
+  }
+
+ protected:
+  // The proxies of a client thread.
+  struct ClientProxies {
+    unique_ptr<TabletServerServiceProxy> tserver;
+    unique_ptr<ConsensusServiceProxy> consensus;
+  };
+
+  // Issues one call of the benchmarked RPC through the proxies of a client
+  // thread. 'thread_idx' is the index of the thread and 'call_idx' that of the
+  // call among the calls of the thread.
+  typedef std::function<void(const ClientProxies& proxies,
+                             int thread_idx,
+                             int64_t call_idx)> CallFunc;
+
+  // Runs 'call' in a loop from each client thread for --bench_run_seconds,
+  // then logs the throughput and the latency percentiles of the calls.
+  void RunBenchmark(const string& name, const CallFunc& call) {
+    atomic<bool> should_run(true);
+    vector<unique_ptr<HdrHistogram>> histograms;
+    vector<thread> threads;
+    for (int i = 0; i < FLAGS_bench_client_threads; i++) {
+      histograms.emplace_back(new HdrHistogram(kMaxLatencyUs, 2));
+    }
+
+    Stopwatch sw(Stopwatch::ALL_THREADS);
+    sw.start();
+    for (int i = 0; i < FLAGS_bench_client_threads; i++) {
+      threads.emplace_back([&, i]() {
+        const auto& messenger = client_messengers_[i % client_messengers_.size()];
+        const Sockaddr& addr = mini_server_->bound_rpc_addr();
+        ClientProxies proxies;
+        proxies.tserver.reset(new TabletServerServiceProxy(messenger, addr, addr.host()));
+        proxies.consensus.reset(new ConsensusServiceProxy(messenger, addr, addr.host()));
+        HdrHistogram* hist = histograms[i].get();
+        for (int64_t call_idx = 0; should_run; call_idx++) {
+          MonoTime start = MonoTime::Now();
+          call(proxies, i, call_idx);
+          hist->Increment((MonoTime::Now() - start).ToMicroseconds());
+        }
+      });
+    }
+    SleepFor(MonoDelta::FromSeconds(FLAGS_bench_run_seconds));
+    should_run = false;
+    for (auto& t : threads) {
+      t.join();
+    }
+    sw.stop();
+
+    HdrHistogram latency(kMaxLatencyUs, 2);
+    for (const auto& hist : histograms) {
+      latency.MergeFrom(*hist);
+    }
+    const auto total_calls = latency.TotalCount();
+    const CpuTimes elapsed = sw.elapsed();
+
+    LOG(INFO) << "Benchmark:          " << name;
+    LOG(INFO) << "Client threads:     " << FLAGS_bench_client_threads;
+    LOG(INFO) << "Client connections: " << FLAGS_bench_client_connections;
+    LOG(INFO) << "Client reactors:    " << FLAGS_bench_client_reactors;
+    LOG(INFO) << "Server reactors:    " << FLAGS_num_reactor_threads;
+    LOG(INFO) << "Encryption:         " << FLAGS_bench_enable_encryption;
+    LOG(INFO) << "----------------------------------";
+    LOG(INFO) << "Calls:              " << total_calls;
+    LOG(INFO) << "Calls/sec:          " << total_calls / elapsed.wall_seconds();
+    LOG(INFO) << "CPU per call:       "
+              << (elapsed.user + elapsed.system) / 1000.0 / total_calls << "us";
+    LOG(INFO) << "Latency mean:       " << latency.MeanValue() << "us";
+    LOG(INFO) << "Latency p50:        " << latency.ValueAtPercentile(50) << "us";
+    LOG(INFO) << "Latency p95:        " << latency.ValueAtPercentile(95) << "us";
+    LOG(INFO) << "Latency p99:        " << latency.ValueAtPercentile(99) << "us";
+    LOG(INFO) << "Latency p99.9:      " << latency.ValueAtPercentile(99.9) << "us";
+    LOG(INFO) << "Latency max:        " << latency.MaxValue() << "us";
+  }
+
+  vector<shared_ptr<Messenger>> client_messengers_;
+};
+
+// Upserts batches of --bench_write_batch_rows rows, each thread into a key
+// range of its own.
+TEST_F(TabletServerRpcBench, BenchmarkWrite) {
+  const int32_t kKeysPerThread = 1000000;
+  RunBenchmark("Write", [&](const ClientProxies& proxies, int thread_idx, int64_t call_idx) {
+    WriteRequestPB req;
+    req.set_tablet_id(kTabletId);
+    CHECK_OK(SchemaToPB(schema_, req.mutable_schema()));
+    const int64_t first_row = call_idx * FLAGS_bench_write_batch_rows;
+    for (int32_t i = 0; i < FLAGS_bench_write_batch_rows; i++) {
+      int32_t key = thread_idx * kKeysPerThread +
+                    static_cast<int32_t>((first_row + i) % kKeysPerThread);
+      AddTestRowToPB(RowOperationsPB::UPSERT, schema_, key, key, "bench row",
+                     req.mutable_row_operations());
+    }
+
+    WriteResponsePB resp;
+    RpcController controller;
+    controller.set_timeout(MonoDelta::FromSeconds(FLAGS_rpc_timeout));
+    CHECK_OK(proxies.tserver->Write(req, &resp, &controller));
+    CHECK(!resp.has_error()) << resp.error().ShortDebugString();
+    CHECK_EQ(0, resp.per_row_errors_size());
+  });
+}
+
+// Scans the first --bench_scan_batch_bytes of row data of the tablet, which is
+// returned in a sidecar.
+TEST_F(TabletServerRpcBench, BenchmarkScan) {
+  NO_FATALS(InsertTestRowsDirect(0, FLAGS_bench_scan_rows));
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+
+  RunBenchmark("Scan", [&](const ClientProxies& proxies, int /*thread_idx*/,
+                           int64_t /*call_idx*/) {
+    ScanRequestPB req;
+    CHECK_OK(FillNewScanRequest(READ_LATEST, req.mutable_new_scan_request()));
+    req.set_batch_size_bytes(FLAGS_bench_scan_batch_bytes);
+    req.set_close_scanner(true);
+
+    ScanResponsePB resp;
+    RpcController controller;
+    controller.set_timeout(MonoDelta::FromSeconds(FLAGS_rpc_timeout));
+    CHECK_OK(proxies.tserver->Scan(req, &resp, &controller));
+    CHECK(!resp.has_error()) << resp.error().ShortDebugString();
+    CHECK_GT(resp.data().num_rows(), 0);
+  });
+}
+
+// Sends consensus updates carrying --bench_replicate_batch_ops replicated
+// writes each.
+//
+// The updates are sent for a tablet which doesn't exist: a single tablet
+// server has no follower to replicate to, and updates for its own leader
+// replica would be rejected and logged. So this measures the RPC paths of such
+// updates (serialization, transfer, parsing and dispatching of the large
+// requests) but not their handling by the follower replica.
+TEST_F(TabletServerRpcBench, BenchmarkUpdateConsensus) {
+  ConsensusRequestPB req;
+  req.set_dest_uuid(mini_server_->uuid());
+  req.set_tablet_id("bench_missing_tablet");
+  req.set_caller_uuid("bench_leader");
+  req.set_caller_term(1);
+  req.mutable_preceding_id()->set_term(1);
+  req.mutable_preceding_id()->set_index(0);
+  req.set_committed_index(0);
+  for (int i = 0; i < FLAGS_bench_replicate_batch_ops; i++) {
+    ReplicateMsg* op = req.add_ops();
+    op->mutable_id()->set_term(1);
+    op->mutable_id()->set_index(i + 1);
+    op->set_timestamp(i + 1);
+    op->set_op_type(consensus::WRITE_OP);
+    WriteRequestPB* write = op->mutable_write_request();
+    write->set_tablet_id(kTabletId);
+    ASSERT_OK(SchemaToPB(schema_, write->mutable_schema()));
+    for (int32_t j = 0; j < FLAGS_bench_replicate_op_rows; j++) {
+      int32_t key = i * FLAGS_bench_replicate_op_rows + j;
+      AddTestRowToPB(RowOperationsPB::INSERT, schema_, key, key, "bench row",
+                     write->mutable_row_operations());
+    }
+  }
+
+  RunBenchmark("UpdateConsensus", [&](const ClientProxies& proxies, int /*thread_idx*/,
+                                      int64_t /*call_idx*/) {
+    ConsensusResponsePB resp;
+    RpcController controller;
+    controller.set_timeout(MonoDelta::FromSeconds(FLAGS_rpc_timeout));
+    CHECK_OK(proxies.consensus->UpdateConsensus(req, &resp, &controller));
+    CHECK(resp.has_error());
+    CHECK_EQ(TabletServerErrorPB::TABLET_NOT_FOUND, resp.error().code());
+  });
+}
+
+} // namespace tserver
+} // namespace kudu
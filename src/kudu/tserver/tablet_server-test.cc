@@ -45,6 +45,7 @@
 
 #include "kudu/clock/clock.h"
 #include "kudu/clock/hybrid_clock.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/partial_row.h"
@@ -58,6 +59,7 @@
 #include "kudu/common/wire_protocol.pb.h"
 #include "kudu/consensus/log-test-base.h"
 #include "kudu/consensus/log.h"
+#include "kudu/consensus/log_reader.h"
 #include "kudu/consensus/metadata.pb.h"
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
@@ -81,6 +83,7 @@
 #include "kudu/server/rpc_server.h"
 #include "kudu/server/server_base.pb.h"
 #include "kudu/server/server_base.proxy.h"
+#include "kudu/tablet/change_subscriptions.h"
 #include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/local_tablet_writer.h"
 #include "kudu/tablet/metadata.pb.h"
@@ -182,12 +185,14 @@ DECLARE_bool(enable_rowset_compaction);
 DECLARE_bool(enable_workload_score_for_perf_improvement_ops);
 DECLARE_bool(fail_dns_resolution);
 DECLARE_bool(rowset_metadata_store_keys);
+DECLARE_bool(scanner_prefetch_batches);
 DECLARE_bool(scanner_unregister_on_invalid_seq_id);
 DECLARE_bool(show_slow_scans);
 DECLARE_double(cfile_inject_corruption);
 DECLARE_double(env_inject_eio);
 DECLARE_double(env_inject_full);
 DECLARE_double(tablet_inject_kudu_2233);
+DECLARE_double(tserver_inject_soft_memory_limit_excess);
 DECLARE_double(workload_score_upper_bound);
 DECLARE_int32(flush_threshold_mb);
 DECLARE_int32(flush_threshold_secs);
@@ -207,8 +212,10 @@ DECLARE_int32(scanner_inject_latency_on_each_batch_ms);
 DECLARE_int32(scanner_ttl_ms);
 DECLARE_int32(slow_scanner_threshold_ms);
 DECLARE_int32(tablet_bootstrap_inject_latency_ms);
+DECLARE_int32(tablet_flush_on_shutdown_budget_ms);
 DECLARE_int32(tablet_inject_latency_on_apply_write_op_ms);
 DECLARE_int32(tablet_inject_latency_on_prepare_write_op_ms);
+DECLARE_int32(tserver_tablets_page_cache_ttl_ms);
 DECLARE_int32(workload_stats_rate_collection_min_interval_ms);
 DECLARE_int32(workload_stats_metric_collection_interval_ms);
 DECLARE_string(block_manager);
@@ -216,16 +223,20 @@ DECLARE_string(env_inject_eio_globs);
 DECLARE_string(env_inject_full_globs);
 DECLARE_string(webserver_doc_root);
 DECLARE_uint32(tablet_apply_pool_overload_threshold_ms);
+DECLARE_uint32(tserver_memory_pressure_max_write_delay_ms);
 
 // Declare these metrics prototypes for simpler unit testing of their behavior.
 METRIC_DECLARE_counter(block_manager_total_bytes_read);
+METRIC_DECLARE_counter(leader_memory_pressure_rejections);
 METRIC_DECLARE_counter(log_block_manager_holes_punched);
+METRIC_DECLARE_counter(memory_pressure_write_delays);
 METRIC_DECLARE_counter(ops_timed_out_in_prepare_queue);
 METRIC_DECLARE_counter(rows_inserted);
 METRIC_DECLARE_counter(rows_updated);
 METRIC_DECLARE_counter(rows_deleted);
 METRIC_DECLARE_counter(rpcs_queue_overflow);
 METRIC_DECLARE_counter(rpcs_timed_out_in_queue);
+METRIC_DECLARE_counter(scanner_batches_prefetched);
 METRIC_DECLARE_counter(scanners_expired);
 METRIC_DECLARE_gauge_int32(startup_progress_steps_remaining);
 METRIC_DECLARE_gauge_int64(startup_progress_time_elapsed);
@@ -533,6 +544,15 @@ TEST_F(TabletServerTest, TestWebPages) {
   ASSERT_STR_CONTAINS(buf.ToString(), kTabletId);
   ASSERT_STR_CONTAINS(buf.ToString(), "RANGE (key) PARTITION UNBOUNDED");
 
+  // So should its cached rendering, unless it isn't in the requested page.
+  FLAGS_tserver_tablets_page_cache_ttl_ms = 60 * 1000;
+  ASSERT_OK(c.FetchURL(Substitute("http://$0/tablets", addr), &buf));
+  ASSERT_STR_CONTAINS(buf.ToString(), kTabletId);
+  ASSERT_OK(c.FetchURL(Substitute("http://$0/tablets?offset=1", addr), &buf));
+  ASSERT_STR_NOT_CONTAINS(buf.ToString(), kTabletId);
+  ASSERT_STR_CONTAINS(buf.ToString(), "Showing replicas none of 1");
+  FLAGS_tserver_tablets_page_cache_ttl_ms = 0;
+
   // Tablet page should include the schema.
   ASSERT_OK(c.FetchURL(Substitute("http://$0/tablet?id=$1", addr, kTabletId),
                        &buf));
@@ -1400,6 +1420,86 @@ TEST_F(TabletServerTest, TestInsert) {
   ASSERT_GE(now_after.value(), now_before.value());
 }
 
+// Test that writes arriving while the memory consumption is between the soft
+// and hard limits are delayed rather than rejected.
+TEST_F(TabletServerTest, TestWritesDelayedUnderMemoryPressure) {
+  constexpr int kNumRows = 10;
+  // Halfway between the limits, each write is delayed by half of
+  // --tserver_memory_pressure_max_write_delay_ms.
+  FLAGS_tserver_inject_soft_memory_limit_excess = 0.5;
+  const auto kExpectedDelay = MonoDelta::FromMilliseconds(
+      FLAGS_tserver_memory_pressure_max_write_delay_ms / 2);
+
+  scoped_refptr<TabletReplica> replica;
+  ASSERT_TRUE(mini_server_->server()->tablet_manager()->LookupTablet(kTabletId, &replica));
+  scoped_refptr<Counter> delays = METRIC_memory_pressure_write_delays.Instantiate(
+      mini_server_->server()->metric_entity());
+  scoped_refptr<Counter> rejections = METRIC_leader_memory_pressure_rejections.Instantiate(
+      replica->tablet()->GetMetricEntity());
+
+  const MonoTime start = MonoTime::Now();
+  NO_FATALS(InsertTestRowsRemote(0, kNumRows));
+  ASSERT_GE((MonoTime::Now() - start).ToMilliseconds(),
+            kExpectedDelay.ToMilliseconds() * kNumRows);
+  ASSERT_EQ(kNumRows, delays->value());
+  ASSERT_EQ(0, rejections->value());
+  uint64_t num_rows;
+  ASSERT_OK(replica->tablet()->CountRows(&num_rows));
+  ASSERT_EQ(kNumRows, num_rows);
+
+  // A write whose deadline doesn't allow for the delay is handled right away.
+  FLAGS_tserver_memory_pressure_max_write_delay_ms = 10000;
+  WriteRequestPB req;
+  WriteResponsePB resp;
+  RpcController controller;
+  req.set_tablet_id(kTabletId);
+  ASSERT_OK(SchemaToPB(schema_, req.mutable_schema()));
+  AddTestRowToPB(RowOperationsPB::INSERT, schema_, kNumRows, 0, "", req.mutable_row_operations());
+  controller.set_timeout(MonoDelta::FromSeconds(2));
+  ASSERT_OK(proxy_->Write(req, &resp, &controller));
+  ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp);
+  ASSERT_EQ(kNumRows, delays->value());
+}
+
+// Test writing to several tablets in a single MultiWrite call, each write
+// getting its own response.
+TEST_F(TabletServerTest, TestMultiWrite) {
+  MultiWriteRequestPB req;
+  for (int key : { 1, 2 }) {
+    WriteRequestPB* write = req.add_writes();
+    write->set_tablet_id(kTabletId);
+    ASSERT_OK(SchemaToPB(schema_, write->mutable_schema()));
+    AddTestRowToPB(RowOperationsPB::INSERT, schema_, key, key, "hello",
+                   write->mutable_row_operations());
+  }
+  // Write the same row again and to a tablet that doesn't exist, which should
+  // only fail these writes.
+  WriteRequestPB* dup_write = req.add_writes();
+  *dup_write = req.writes(0);
+  WriteRequestPB* missing_write = req.add_writes();
+  *missing_write = req.writes(0);
+  missing_write->set_tablet_id("missing-tablet");
+
+  MultiWriteResponsePB resp;
+  RpcController controller;
+  ASSERT_OK(proxy_->MultiWrite(req, &resp, &controller));
+  SCOPED_TRACE(SecureDebugString(resp));
+  ASSERT_EQ(4, resp.responses_size());
+  ASSERT_FALSE(resp.responses(1).has_error());
+  ASSERT_TRUE(resp.responses(3).has_error());
+  ASSERT_EQ(TabletServerErrorPB::TABLET_NOT_FOUND, resp.responses(3).error().code());
+
+  // The writes of row 1 are applied concurrently: exactly one of them fails.
+  int num_dup_errors = 0;
+  for (int i : { 0, 2 }) {
+    const auto& write_resp = resp.responses(i);
+    ASSERT_FALSE(write_resp.has_error());
+    num_dup_errors += write_resp.per_row_errors_size();
+  }
+  ASSERT_EQ(1, num_dup_errors);
+  VerifyRows(schema_, { KeyValue(1, 1), KeyValue(2, 2) });
+}
+
 TEST_F(TabletServerTest, TestExternalConsistencyModes_ClientPropagated) {
   WriteRequestPB req;
   req.set_tablet_id(kTabletId);
@@ -1903,6 +2003,163 @@ TEST_F(TabletServerTest, TestRecoveryWithMutationsWhileFlushing) {
                         KeyValue(7, 7) });
 }
 
+// Test that the in-memory stores are flushed upon shutdown if requested, so
+// that nothing is left to replay on the next start.
+TEST_F(TabletServerTest, TestFlushOnShutdown) {
+  FLAGS_tablet_flush_on_shutdown_budget_ms = 60 * 1000;
+  InsertTestRowsRemote(1, 5);
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+  NO_FATALS(UpdateTestRowRemote(1, 100));
+  InsertTestRowsRemote(6, 5);
+  ASSERT_FALSE(tablet_replica_->tablet()->MemRowSetEmpty());
+  ASSERT_FALSE(tablet_replica_->tablet()->DeltaMemRowSetEmpty());
+
+  NO_FATALS(ShutdownAndRebuildTablet());
+  ASSERT_TRUE(tablet_replica_->tablet()->MemRowSetEmpty());
+  ASSERT_TRUE(tablet_replica_->tablet()->DeltaMemRowSetEmpty());
+  VerifyRows(schema_, { KeyValue(1, 100),
+                        KeyValue(2, 2),
+                        KeyValue(3, 3),
+                        KeyValue(4, 4),
+                        KeyValue(5, 5),
+                        KeyValue(6, 6),
+                        KeyValue(7, 7),
+                        KeyValue(8, 8),
+                        KeyValue(9, 9),
+                        KeyValue(10, 10) });
+}
+
+// Test that the committed writes of a tablet are streamed from its log, and
+// that the subscription reading them anchors the log until it's removed.
+TEST_F(TabletServerTest, TestGetChanges) {
+  InsertTestRowsRemote(1, 3, 3);
+
+  GetChangesRequestPB req;
+  GetChangesResponsePB resp;
+  req.set_tablet_id(kTabletId);
+  req.set_subscription_id("test");
+  // The commits of the writes are logged asynchronously, and the writes are
+  // only streamed once they are.
+  ASSERT_EVENTUALLY([&] {
+    RpcController rpc;
+    resp.Clear();
+    ASSERT_OK(proxy_->GetChanges(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp);
+    // The op the leader replicated when elected isn't a write, so it's skipped.
+    ASSERT_EQ(3, resp.changes_size());
+  });
+  for (int i = 0; i < resp.changes_size(); i++) {
+    const auto& change = resp.changes(i);
+    ASSERT_FALSE(change.write_request().row_operations().rows().empty());
+    if (i > 0) {
+      ASSERT_GT(change.op_index(), resp.changes(i - 1).op_index());
+    }
+  }
+  const int64_t last_op_index = resp.last_op_index();
+  ASSERT_EQ(resp.changes(2).op_index(), last_op_index);
+  ASSERT_EQ(1, tablet_replica_->change_subscriptions()->size());
+
+  // Nothing was written since the last response.
+  req.set_after_op_index(last_op_index);
+  resp.Clear();
+  {
+    RpcController rpc;
+    ASSERT_OK(proxy_->GetChanges(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp);
+  }
+  ASSERT_EQ(0, resp.changes_size());
+  ASSERT_EQ(last_op_index, resp.last_op_index());
+
+  req.set_unsubscribe(true);
+  resp.Clear();
+  {
+    RpcController rpc;
+    ASSERT_OK(proxy_->GetChanges(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp);
+  }
+  ASSERT_EQ(0, tablet_replica_->change_subscriptions()->size());
+}
+
+// Test that the row operations of a streamed write which failed to apply are
+// marked as such.
+TEST_F(TabletServerTest, TestGetChangesMarksFailedRowOps) {
+  InsertTestRowsRemote(1, 1);
+  {
+    WriteRequestPB req;
+    WriteResponsePB resp;
+    req.set_tablet_id(kTabletId);
+    ASSERT_OK(SchemaToPB(schema_, req.mutable_schema()));
+    RowOperationsPB* data = req.mutable_row_operations();
+    AddTestRowToPB(RowOperationsPB::INSERT, schema_, 2, 2, "not a dupe", data);
+    AddTestRowToPB(RowOperationsPB::INSERT, schema_, 1, 1, "a dupe", data);
+    AddTestRowToPB(RowOperationsPB::UPDATE, schema_, 3, 3, "missing", data);
+    AddTestRowToPB(RowOperationsPB::INSERT, schema_, 4, 4, "not a dupe", data);
+    RpcController rpc;
+    ASSERT_OK(proxy_->Write(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp);
+    ASSERT_EQ(2, resp.per_row_errors_size());
+  }
+
+  GetChangesRequestPB req;
+  GetChangesResponsePB resp;
+  req.set_tablet_id(kTabletId);
+  req.set_subscription_id("test");
+  ASSERT_EVENTUALLY([&] {
+    RpcController rpc;
+    resp.Clear();
+    ASSERT_OK(proxy_->GetChanges(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp);
+    ASSERT_EQ(2, resp.changes_size());
+  });
+  ASSERT_EQ(0, resp.changes(0).failed_row_op_indexes_size());
+  const auto& failed = resp.changes(1).failed_row_op_indexes();
+  ASSERT_EQ(vector<int32_t>({ 1, 2 }), vector<int32_t>(failed.begin(), failed.end()));
+}
+
+// Test that a consumer whose checkpoint is no longer retained, as when it
+// reads from a new leader which didn't anchor its log for the subscription,
+// is told where to resume from once it read a snapshot of the tablet.
+TEST_F(TabletServerTest, TestGetChangesAfterLogGC) {
+  InsertTestRowsRemote(1, 3);
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+  ASSERT_OK(tablet_replica_->log()->AllocateSegmentAndRollOverForTests());
+  InsertTestRowsRemote(4, 1);
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+  ASSERT_OK(tablet_replica_->log()->AllocateSegmentAndRollOverForTests());
+  ASSERT_OK(tablet_replica_->RunLogGC());
+  const int64_t first_retained = tablet_replica_->log()->reader()->GetMinReplicateIndex();
+  ASSERT_GT(first_retained, 1);
+
+  GetChangesRequestPB req;
+  GetChangesResponsePB resp;
+  req.set_tablet_id(kTabletId);
+  req.set_subscription_id("test");
+  {
+    RpcController rpc;
+    ASSERT_OK(proxy_->GetChanges(req, &resp, &rpc));
+    ASSERT_TRUE(resp.has_error());
+    Status s = StatusFromPB(resp.error().status());
+    ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+    ASSERT_EQ(first_retained, resp.first_retained_op_index());
+  }
+
+  // Checkpointing right before the first retained op resumes the stream, the
+  // rows written before it being read from a snapshot.
+  req.set_after_op_index(resp.first_retained_op_index() - 1);
+  InsertTestRowsRemote(5, 1);
+  ASSERT_EVENTUALLY([&] {
+    RpcController rpc;
+    resp.Clear();
+    ASSERT_OK(proxy_->GetChanges(req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error()) << SecureShortDebugString(resp);
+    ASSERT_FALSE(resp.changes().empty());
+    ASSERT_EQ(resp.changes(resp.changes_size() - 1).op_index(), resp.last_op_index());
+  });
+  for (const auto& change : resp.changes()) {
+    ASSERT_GE(change.op_index(), first_retained);
+  }
+}
+
 // Tests performing mutations that are going to a DMS or to the following
 // DMS, when the initial one is flushed.
 TEST_F(TabletServerTest, TestRecoveryWithMutationsWhileFlushingAndCompacting) {
@@ -2568,6 +2825,44 @@ TEST_F(TabletServerTest, TestSnapshotScan_WithoutSnapshotTimestamp) {
   ASSERT_GT(resp.propagated_timestamp(), resp.snap_timestamp());
 }
 
+// Tests bounded staleness snapshot scans: the scan reads at a timestamp no
+// older than the bound, which includes the writes acknowledged beforehand, and
+// the bound can't be combined with an explicit snapshot timestamp.
+TEST_F(TabletServerTest, TestSnapshotScan_BoundedStaleness) {
+  vector<uint64_t> write_timestamps_collector;
+  InsertTestRowsRemote(0, 1, 1, nullptr, kTabletId, &write_timestamps_collector);
+
+  ScanRequestPB req;
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+  req.set_call_seq_id(0);
+  scan->set_read_mode(READ_AT_SNAPSHOT);
+  scan->set_max_staleness_usec(60 * 1000 * 1000);
+  {
+    ScanResponsePB resp;
+    RpcController rpc;
+    const Timestamp pre_scan_ts = mini_server_->server()->clock()->Now();
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_GE(resp.snap_timestamp(), write_timestamps_collector[0]);
+    ASSERT_GE(resp.snap_timestamp(), HybridClock::AddPhysicalTimeToTimestamp(
+        pre_scan_ts, MonoDelta::FromSeconds(-60)).ToUint64());
+    ASSERT_EQ(1, resp.data().num_rows());
+  }
+
+  scan->set_snap_timestamp(write_timestamps_collector[0]);
+  {
+    ScanResponsePB resp;
+    RpcController rpc;
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_TRUE(resp.has_error());
+    ASSERT_EQ(TabletServerErrorPB::INVALID_SCAN_SPEC, resp.error().code());
+  }
+}
+
 // Tests that a snapshot in the future (beyond the current time plus maximum
 // synchronization error) fails as an invalid snapshot.
 TEST_F(TabletServerTest, TestSnapshotScan_SnapshotInTheFutureFails) {
@@ -3229,6 +3524,100 @@ TEST_F(TabletServerTest, TestScanWithEncodedPredicates) {
             results.back());
 }
 
+TEST_F(TabletServerTest, TestScanWithRuntimeFilters) {
+  InsertTestRowsDirect(0, 100);
+
+  ScanRequestPB req;
+  ScanResponsePB resp;
+  RpcController rpc;
+
+  // The filters of the first request prune the scan: 10 <= key.
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  req.set_batch_size_bytes(0); // so it won't return data right away
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+  const int32_t lower_key = 10;
+  ColumnPredicateToPB(ColumnPredicate::Range(schema_.column(0), &lower_key, nullptr),
+                      req.add_runtime_filters());
+  {
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    ASSERT_TRUE(resp.has_more_results());
+  }
+
+  // The filters of the next requests narrow down the rows returned from then
+  // on: int_val < 40, i.e. key < 20.
+  ScanRequestPB continue_req;
+  continue_req.set_scanner_id(resp.scanner_id());
+  continue_req.set_call_seq_id(1);
+  const int32_t upper_val = 40;
+  ColumnPredicateToPB(ColumnPredicate::Range(schema_.column(1), nullptr, &upper_val),
+                      continue_req.add_runtime_filters());
+  vector<string> results;
+  {
+    rpc.Reset();
+    SCOPED_TRACE(SecureDebugString(continue_req));
+    ASSERT_OK(proxy_->Scan(continue_req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    NO_FATALS(StringifyRowsFromResponse(schema_, rpc, &resp, &results));
+  }
+  if (resp.has_more_results()) {
+    NO_FATALS(DrainScannerToStrings(resp.scanner_id(), schema_, &results, nullptr, 2));
+  }
+  ASSERT_EQ(10, results.size());
+  EXPECT_EQ(R"((int32 key=10, int32 int_val=20, string string_val="hello 10"))",
+            results.front());
+  EXPECT_EQ(R"((int32 key=19, int32 int_val=38, string string_val="hello 19"))",
+            results.back());
+}
+
+// Test that the batches computed ahead of the requests for them are returned
+// in order, without rows missing.
+TEST_F(TabletServerTest, TestScanWithPrefetching) {
+  FLAGS_scanner_prefetch_batches = true;
+  const int kNumRows = 1000;
+  InsertTestRowsDirect(0, kNumRows);
+  scoped_refptr<Counter> batches_prefetched = METRIC_scanner_batches_prefetched.Instantiate(
+      mini_server_->server()->metric_entity());
+
+  ScanResponsePB resp;
+  NO_FATALS(OpenScannerWithAllColumns(&resp));
+  ASSERT_TRUE(resp.has_more_results());
+
+  ScanRequestPB req;
+  req.set_scanner_id(resp.scanner_id());
+  req.set_batch_size_bytes(1000);
+  RpcController rpc;
+  vector<string> results;
+  int64_t num_batches = 0;
+  do {
+    rpc.Reset();
+    req.set_call_seq_id(num_batches + 1);
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+    NO_FATALS(StringifyRowsFromResponse(schema_, rpc, &resp, &results));
+    num_batches++;
+    if (resp.has_more_results()) {
+      // Wait for the next batch to be prefetched before asking for it.
+      ASSERT_EVENTUALLY([&]() {
+        ASSERT_EQ(num_batches, batches_prefetched->value());
+      });
+    }
+  } while (resp.has_more_results());
+  ASSERT_GT(num_batches, 2);
+
+  ASSERT_EQ(kNumRows, results.size());
+  for (int i = 0; i < kNumRows; i++) {
+    KuduPartialRow row(&schema_);
+    BuildTestRow(i, &row);
+    ASSERT_EQ("(" + row.ToString() + ")", results[i]);
+  }
+}
+
 TEST_F(TabletServerTest, TestScanWithSimplifiablePredicates) {
   int num_rows = AllowSlowTests() ? 10000 : 1000;
   InsertTestRowsDirect(0, num_rows);
@@ -4373,6 +4762,53 @@ TEST_F(TabletServerTest, TestChecksumScan) {
   ASSERT_FALSE(resp.has_more_results());
 }
 
+// Test that checksum scans using the checksums of the rowsets computed when
+// they were written only read the rowsets mutated since, with the same result.
+TEST_F(TabletServerTest, TestChecksumScanWithKnownRowSetChecksums) {
+  // Two flushed rowsets and a few rows in the MRS.
+  InsertTestRowsRemote(0, 10);
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+  InsertTestRowsRemote(10, 10);
+  ASSERT_OK(tablet_replica_->tablet()->Flush());
+  InsertTestRowsRemote(20, 5);
+  uint64_t total_crc = 0;
+  for (int32_t key = 0; key < 25; key++) {
+    total_crc += CalcTestRowChecksum(key);
+  }
+
+  ChecksumRequestPB req;
+  req.mutable_new_request()->set_tablet_id(kTabletId);
+  req.mutable_new_request()->set_read_mode(READ_LATEST);
+  req.set_call_seq_id(0);
+  req.set_use_known_rowset_checksums(true);
+  ASSERT_OK(SchemaToColumnPBs(schema_, req.mutable_new_request()->mutable_projected_columns(),
+                              SCHEMA_PB_WITHOUT_IDS));
+  const auto& rows_scanned = tablet_replica_->tablet()->metrics()->scanner_rows_scanned;
+  const auto checksum = [&](int64_t expected_rows_scanned) {
+    const int64_t rows_scanned_before = rows_scanned->value();
+    ChecksumResponsePB resp;
+    RpcController controller;
+    ASSERT_OK(proxy_->Checksum(req, &resp, &controller));
+    ASSERT_FALSE(resp.has_error()) << SecureDebugString(resp.error());
+    ASSERT_FALSE(resp.has_more_results());
+    ASSERT_EQ(total_crc, resp.checksum());
+    ASSERT_EQ(expected_rows_scanned, rows_scanned->value() - rows_scanned_before);
+  };
+
+  // Only the MRS is read.
+  NO_FATALS(checksum(5));
+
+  // Once a row of the first rowset is deleted, it's read too. The rows read
+  // include the deleted one.
+  NO_FATALS(DeleteTestRowsRemote(0, 1));
+  total_crc -= CalcTestRowChecksum(0);
+  NO_FATALS(checksum(10 + 5));
+
+  // Without the known checksums, all the rowsets are read.
+  req.set_use_known_rowset_checksums(false);
+  NO_FATALS(checksum(10 + 10 + 5));
+}
+
 class DelayFsyncLogHook : public log::LogFaultHooks {
  public:
   DelayFsyncLogHook() : log_latch1_(1), test_latch1_(1) {}
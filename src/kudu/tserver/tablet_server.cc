@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 
 #include "kudu/cfile/block_cache.h"
@@ -35,7 +36,9 @@
 #include "kudu/server/rpc_server.h"
 #include "kudu/server/startup_path_handler.h"
 #include "kudu/transactions/txn_system_client.h"
+#include "kudu/tserver/block_cache_warmer.h"
 #include "kudu/tserver/heartbeater.h"
+#include "kudu/tserver/quota_manager.h"
 #include "kudu/tserver/scanners.h"
 #include "kudu/tserver/tablet_copy_service.h"
 #include "kudu/tserver/tablet_service.h"
@@ -46,6 +49,8 @@
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/status.h"
 
+DECLARE_bool(block_cache_warmup_enabled);
+
 namespace kudu {
 class Timer;
 } // namespace kudu
@@ -68,6 +73,7 @@ TabletServer::TabletServer(const TabletServerOptions& opts)
       opts_(opts),
       tablet_manager_(new TSTabletManager(this)),
       scanner_manager_(new ScannerManager(metric_entity())),
+      quota_manager_(new QuotaManager(metric_entity())),
       path_handlers_(new TabletServerPathHandlers(this)) {
 }
 
@@ -165,6 +171,10 @@ Status TabletServer::Start() {
 
   RETURN_NOT_OK(heartbeater_->Start());
   RETURN_NOT_OK(maintenance_manager_->Start());
+  if (FLAGS_block_cache_warmup_enabled) {
+    block_cache_warmer_.reset(new BlockCacheWarmer(fs_manager_.get(), tablet_manager_.get()));
+    RETURN_NOT_OK(block_cache_warmer_->Start());
+  }
 
   google::FlushLogFiles(google::INFO); // Flush the startup messages.
 
@@ -181,10 +191,14 @@ void TabletServer::ShutdownImpl() {
     UnregisterAllServices();
 
     // 2. Shut down the tserver's subsystems.
+    if (block_cache_warmer_) {
+      block_cache_warmer_->Shutdown();
+    }
     maintenance_manager_->Shutdown();
     WARN_NOT_OK(heartbeater_->Stop(), "Failed to stop TS Heartbeat thread");
     fs_manager_->UnsetErrorNotificationCb(ErrorHandlerType::DISK_ERROR);
     fs_manager_->UnsetErrorNotificationCb(ErrorHandlerType::CFILE_CORRUPTION);
+    scanner_manager_->Shutdown();
     tablet_manager_->Shutdown();
 
     client_initializer_->Shutdown();
@@ -37,7 +37,9 @@ class TxnSystemClientInitializer;
 
 namespace tserver {
 
+class BlockCacheWarmer;
 class Heartbeater;
+class QuotaManager;
 class ScannerManager;
 class TSTabletManager;
 class TabletServerPathHandlers;
@@ -73,6 +75,8 @@ class TabletServer : public kserver::KuduServer {
 
   ScannerManager* scanner_manager() { return scanner_manager_.get(); }
 
+  QuotaManager* quota_manager() { return quota_manager_.get(); }
+
   Heartbeater* heartbeater() { return heartbeater_.get(); }
 
   void set_fail_heartbeats_for_tests(bool fail_heartbeats_for_tests) {
@@ -131,6 +135,9 @@ class TabletServer : public kserver::KuduServer {
   // dependencies.
   std::unique_ptr<ScannerManager> scanner_manager_;
 
+  // Enforces the per-user and per-table quotas. This is always non-NULL.
+  std::unique_ptr<QuotaManager> quota_manager_;
+
   // Thread that initializes a TxnSystemClient.
   std::unique_ptr<transactions::TxnSystemClientInitializer> client_initializer_;
 
@@ -140,6 +147,9 @@ class TabletServer : public kserver::KuduServer {
   // Webserver path handlers.
   std::unique_ptr<TabletServerPathHandlers> path_handlers_;
 
+  // Warms the block cache up across restarts, if enabled.
+  std::unique_ptr<BlockCacheWarmer> block_cache_warmer_;
+
   // The maintenance manager for this tablet server
   std::shared_ptr<MaintenanceManager> maintenance_manager_;
 
@@ -27,6 +27,7 @@
 #include <ostream>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -34,6 +35,7 @@
 #include <glog/logging.h>
 
 #include "kudu/clock/clock.h"
+#include "kudu/clock/hybrid_clock.h"
 #include "kudu/common/column_predicate.h"
 #include "kudu/common/columnar_serialization.h"
 #include "kudu/common/columnblock.h"
@@ -43,6 +45,7 @@
 #include "kudu/common/iterator_stats.h"
 #include "kudu/common/key_range.h"
 #include "kudu/common/partition.h"
+#include "kudu/common/row_checksum.h"
 #include "kudu/common/row_operations.pb.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/rowblock_memory.h"
@@ -53,9 +56,12 @@
 #include "kudu/common/wire_protocol.h"
 #include "kudu/common/wire_protocol.pb.h"
 #include "kudu/consensus/consensus.pb.h"
+#include "kudu/consensus/log.h"
+#include "kudu/consensus/log_reader.h"
 #include "kudu/consensus/metadata.pb.h"
 #include "kudu/consensus/opid.pb.h"
 #include "kudu/consensus/raft_consensus.h"
+#include "kudu/consensus/ref_counted_replicate.h"
 #include "kudu/consensus/replica_management.pb.h"
 #include "kudu/consensus/time_manager.h"
 #include "kudu/fs/fs_manager.h"
@@ -69,6 +75,7 @@
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/template_util.h"
 #include "kudu/rpc/inbound_call.h"
+#include "kudu/rpc/messenger.h"
 #include "kudu/rpc/remote_user.h"
 #include "kudu/rpc/rpc_context.h"
 #include "kudu/rpc/rpc_header.pb.h"
@@ -77,6 +84,7 @@
 #include "kudu/security/token.pb.h"
 #include "kudu/security/token_verifier.h"
 #include "kudu/server/server_base.h"
+#include "kudu/tablet/change_subscriptions.h"
 #include "kudu/tablet/compaction.h"
 #include "kudu/tablet/metadata.pb.h"
 #include "kudu/tablet/mvcc.h"
@@ -93,6 +101,10 @@
 #include "kudu/tablet/txn_coordinator.h"
 #include "kudu/transactions/transactions.pb.h"
 #include "kudu/transactions/txn_status_manager.h"
+#include "kudu/tserver/quota_manager.h"
+#include "kudu/tserver/scan_aggregator.h"
+#include "kudu/tserver/scan_json_paths.h"
+#include "kudu/tserver/scan_top_n.h"
 #include "kudu/tserver/scanners.h"
 #include "kudu/tserver/tablet_replica_lookup.h"
 #include "kudu/tserver/tablet_server.h"
@@ -100,12 +112,12 @@
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/tserver/tserver_admin.pb.h"
 #include "kudu/tserver/tserver_service.pb.h"
-#include "kudu/util/crc.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/fault_injection.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/mem_tracker.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
@@ -149,6 +161,23 @@ DEFINE_int32(scanner_max_wait_ms, 1000,
 TAG_FLAG(scanner_max_wait_ms, advanced);
 TAG_FLAG(scanner_max_wait_ms, runtime);
 
+DEFINE_bool(scanner_prefetch_batches, false,
+            "Whether to compute the next batch of a scan while the previous batch is "
+            "on the wire, so that it's ready when the client asks for it. The memory "
+            "of the batches computed ahead is bounded by "
+            "--scanner_prefetch_max_scanner_memory_bytes per scanner and by "
+            "--scanner_prefetch_memory_limit_mb overall.");
+TAG_FLAG(scanner_prefetch_batches, experimental);
+TAG_FLAG(scanner_prefetch_batches, runtime);
+
+DEFINE_int32(scanner_max_rowset_parallelism, 1,
+             "Maximum number of rowsets an unordered scan of a tablet reads from at "
+             "once, on a pool of --scanner_parallel_scan_threads threads shared by all "
+             "the scans. The rows of the rowsets are then returned in the order they're "
+             "read. If 1, the rowsets are read one after the other.");
+TAG_FLAG(scanner_max_rowset_parallelism, experimental);
+TAG_FLAG(scanner_max_rowset_parallelism, runtime);
+
 // Fault injection flags.
 DEFINE_int32(scanner_inject_latency_on_each_batch_ms, 0,
              "If set, the scanner will pause the specified number of milliesconds "
@@ -181,7 +210,28 @@ DEFINE_bool(tserver_txn_write_op_handling_enabled, true,
             "in the context of multi-row transactions");
 TAG_FLAG(tserver_txn_write_op_handling_enabled, hidden);
 
+DEFINE_uint32(tserver_memory_pressure_max_write_delay_ms, 100,
+              "Maximum time in milliseconds the admission of a write is delayed "
+              "while the memory consumption of the process is between its soft "
+              "and hard limits. The delay grows in proportion to how close the "
+              "consumption is to the hard limit, pacing the clients as memory is "
+              "released rather than rejecting their writes and having them retry "
+              "with backoff. Writes are still rejected over the hard limit, or if "
+              "their deadline doesn't allow for the delay. If 0, the writes are "
+              "rejected between the limits with a probability growing with the "
+              "consumption, rather than delayed.");
+TAG_FLAG(tserver_memory_pressure_max_write_delay_ms, advanced);
+TAG_FLAG(tserver_memory_pressure_max_write_delay_ms, runtime);
+
+DEFINE_double(tserver_inject_soft_memory_limit_excess, -1,
+              "If non-negative, the write admission delay treats the memory "
+              "consumption of the process as being this fraction of the way "
+              "from its soft limit to its hard limit. Used for tests.");
+TAG_FLAG(tserver_inject_soft_memory_limit_excess, hidden);
+TAG_FLAG(tserver_inject_soft_memory_limit_excess, runtime);
+
 DECLARE_bool(enable_txn_system_client_init);
+DECLARE_bool(raft_enable_leader_leases);
 DECLARE_bool(raft_prepare_replacement_before_eviction);
 DECLARE_int32(memory_limit_warn_threshold_percentage);
 DECLARE_int32(tablet_history_max_age_sec);
@@ -195,7 +245,17 @@ METRIC_DEFINE_counter(
     "Number of rejected write requests due to overloaded op apply queue",
     kudu::MetricLevel::kWarn);
 
+METRIC_DEFINE_counter(
+    server,
+    memory_pressure_write_delays,
+    "Number of Write Requests Delayed Due to Memory Pressure",
+    kudu::MetricUnit::kRequests,
+    "Number of write requests whose admission was delayed because the memory "
+    "consumption of the process exceeded its soft limit",
+    kudu::MetricLevel::kInfo);
+
 using google::protobuf::RepeatedPtrField;
+using kudu::clock::HybridClock;
 using kudu::consensus::BulkChangeConfigRequestPB;
 using kudu::consensus::ChangeConfigRequestPB;
 using kudu::consensus::ChangeConfigResponsePB;
@@ -210,6 +270,7 @@ using kudu::consensus::LeaderStepDownResponsePB;
 using kudu::consensus::OpId;
 using kudu::consensus::RaftConsensus;
 using kudu::consensus::RaftPeerPB;
+using kudu::consensus::ReplicateRefPtr;
 using kudu::consensus::RunLeaderElectionRequestPB;
 using kudu::consensus::RunLeaderElectionResponsePB;
 using kudu::consensus::StartTabletCopyRequestPB;
@@ -230,6 +291,7 @@ using kudu::security::TokenPB;
 using kudu::security::TokenVerifier;
 using kudu::server::ServerBase;
 using kudu::tablet::AlterSchemaOpState;
+using kudu::tablet::ChangeSubscriptions;
 using kudu::tablet::MvccSnapshot;
 using kudu::tablet::OpCompletionCallback;
 using kudu::tablet::ParticipantOpState;
@@ -250,23 +312,34 @@ using std::optional;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::unordered_map;
 using std::unordered_set;
 using std::vector;
 using strings::Substitute;
 
 namespace kudu {
-
-namespace cfile {
-extern const char* CFILE_CACHE_MISS_BYTES_METRIC_NAME;
-extern const char* CFILE_CACHE_HIT_BYTES_METRIC_NAME;
-}
-
 namespace tserver {
 
 const char* SCANNER_BYTES_READ_METRIC_NAME = "scanner_bytes_read";
 
 namespace {
 
+// Returns how far the memory consumption of the process is past its soft
+// limit, as in process_memory::SoftLimitExcess().
+double SoftMemoryLimitExcess(double* current_capacity_pct) {
+  const double injected = FLAGS_tserver_inject_soft_memory_limit_excess;
+  if (PREDICT_FALSE(injected >= 0)) {
+    if (current_capacity_pct) {
+      const double soft_limit = process_memory::SoftLimit();
+      const double hard_limit = process_memory::HardLimit();
+      *current_capacity_pct =
+          (soft_limit + injected * (hard_limit - soft_limit)) / hard_limit * 100;
+    }
+    return injected;
+  }
+  return process_memory::SoftLimitExcess(current_capacity_pct);
+}
+
 // Lookup the given tablet, only ensuring that it exists.
 // If it does not, responds to the RPC associated with 'context' after setting
 // resp->mutable_error() to indicate the failure reason.
@@ -294,24 +367,34 @@ bool LookupTabletReplicaOrRespond(TabletReplicaLookupIf* tablet_manager,
   return true;
 }
 
-template<class RespClass>
-void RespondTabletNotRunning(const scoped_refptr<TabletReplica>& replica,
+// Returns the error to respond with for 'replica' not being RUNNING, along with
+// its code in 'error_code'.
+Status TabletNotRunningError(const scoped_refptr<TabletReplica>& replica,
                              TabletStatePB tablet_state,
-                             RespClass* resp,
-                             RpcContext* context) {
+                             TabletServerErrorPB::Code* error_code) {
   Status s = Status::IllegalState("Tablet not RUNNING",
                                   tablet::TabletStatePB_Name(tablet_state));
-  auto error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+  *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
   if (replica->tablet_metadata()->tablet_data_state() == TABLET_DATA_TOMBSTONED ||
       replica->tablet_metadata()->tablet_data_state() == TABLET_DATA_DELETED) {
     // Treat tombstoned tablets as if they don't exist for most purposes.
     // This takes precedence over failed, since we don't reset the failed
     // status of a TabletReplica when deleting it. Only tablet copy does that.
-    error_code = TabletServerErrorPB::TABLET_NOT_FOUND;
+    *error_code = TabletServerErrorPB::TABLET_NOT_FOUND;
   } else if (tablet_state == tablet::FAILED) {
     s = s.CloneAndAppend(replica->error().ToString());
-    error_code = TabletServerErrorPB::TABLET_FAILED;
+    *error_code = TabletServerErrorPB::TABLET_FAILED;
   }
+  return s;
+}
+
+template<class RespClass>
+void RespondTabletNotRunning(const scoped_refptr<TabletReplica>& replica,
+                             TabletStatePB tablet_state,
+                             RespClass* resp,
+                             RpcContext* context) {
+  TabletServerErrorPB::Code error_code;
+  Status s = TabletNotRunningError(replica, tablet_state, &error_code);
   SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
 }
 
@@ -349,6 +432,25 @@ bool LookupRunningTabletReplicaOrRespond(TabletReplicaLookupIf* tablet_manager,
   return true;
 }
 
+// Like LookupRunningTabletReplicaOrRespond(), but returns the failure and its
+// code in 'error_code' instead of responding.
+Status LookupRunningTabletReplica(TabletReplicaLookupIf* tablet_manager,
+                                  const string& tablet_id,
+                                  scoped_refptr<TabletReplica>* replica,
+                                  TabletServerErrorPB::Code* error_code) {
+  Status s = tablet_manager->GetTabletReplica(tablet_id, replica);
+  if (PREDICT_FALSE(!s.ok())) {
+    *error_code = s.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                           : TabletServerErrorPB::TABLET_NOT_FOUND;
+    return s;
+  }
+  TabletStatePB state = (*replica)->state();
+  if (PREDICT_FALSE(state != tablet::RUNNING)) {
+    return TabletNotRunningError(*replica, state, error_code);
+  }
+  return Status::OK();
+}
+
 template<class ReqClass, class RespClass>
 bool CheckUuidMatchOrRespond(TabletReplicaLookupIf* tablet_manager,
                              const char* method_name,
@@ -647,6 +749,48 @@ static bool VerifyAuthzTokenOrRespond(const TokenVerifier& token_verifier,
   return true;
 }
 
+// Verifies the authorization token of the write 'req' to 'replica' and returns
+// the privileges it grants in 'authz_context'. Returns false and sends an
+// appropriate response if the write isn't authorized.
+static bool AuthorizeWriteOrRespond(const TokenVerifier& token_verifier,
+                                    const WriteRequestPB& req,
+                                    const TabletReplica& replica,
+                                    RpcContext* context,
+                                    optional<WriteAuthorizationContext>* authz_context) {
+  TokenPB token;
+  if (!VerifyAuthzTokenOrRespond(token_verifier, req, context, &token)) {
+    return false;
+  }
+  const auto& privilege = token.authz().table_privilege();
+  if (!CheckMatchingTableIdOrRespond(privilege, replica.tablet_metadata()->table_id(),
+                                     "Write", context)) {
+    return false;
+  }
+  WritePrivileges privileges;
+  if (privilege.insert_privilege()) {
+    InsertOrDie(&privileges, WritePrivilegeType::INSERT);
+  }
+  if (privilege.update_privilege()) {
+    InsertOrDie(&privileges, WritePrivilegeType::UPDATE);
+  }
+  if (privilege.delete_privilege()) {
+    InsertOrDie(&privileges, WritePrivilegeType::DELETE);
+  }
+  if (privileges.empty()) {
+    // If we know there are no write-related privileges outright, we can
+    // short-circuit further checking and reject the request immediately.
+    // Otherwise, we'll defer the checking to the prepare phase of the
+    // op after decoding the operations.
+    LOG(WARNING) << Substitute("rejecting Write request from $0: no write privileges",
+                               context->requestor_string());
+    context->RespondRpcFailure(ErrorStatusPB::FATAL_UNAUTHORIZED,
+        Status::NotAuthorized("not authorized to write"));
+    return false;
+  }
+  *authz_context = WriteAuthorizationContext{ privileges, /*requested_op_types=*/{} };
+  return true;
+}
+
 static void SetupErrorAndRespond(TabletServerErrorPB* error,
                                  const Status& s,
                                  TabletServerErrorPB::Code code,
@@ -709,6 +853,59 @@ class RpcOpCompletionCallback : public OpCompletionCallback {
   Response* response_;
 };
 
+// Responds to a MultiWrite call once all of its writes are done.
+class MultiWriteTracker {
+ public:
+  MultiWriteTracker(RpcContext* context, int num_writes)
+      : context_(context),
+        num_pending_(num_writes) {
+    DCHECK_GT(num_writes, 0);
+  }
+
+  void WriteDone() {
+    if (num_pending_.fetch_sub(1) == 1) {
+      context_->RespondSuccess();
+    }
+  }
+
+ private:
+  RpcContext* context_;
+  std::atomic<int> num_pending_;
+};
+
+// Sets the error of a write sent within a MultiWrite call. Like with
+// SetupErrorAndRespond(), generic "service unavailable" errors are reported
+// as THROTTLED, so that the client retries the write later.
+void SetupWriteError(const Status& s, TabletServerErrorPB::Code code, WriteResponsePB* resp) {
+  if (code == TabletServerErrorPB::UNKNOWN_ERROR && s.IsServiceUnavailable()) {
+    code = TabletServerErrorPB::THROTTLED;
+  }
+  StatusToPB(s, resp->mutable_error()->mutable_status());
+  resp->mutable_error()->set_code(code);
+}
+
+// An op completion callback for a write sent within a MultiWrite call, which
+// sets the error of the write, if any, and lets the call respond once all of
+// its writes complete.
+class MultiWriteCompletionCallback : public OpCompletionCallback {
+ public:
+  MultiWriteCompletionCallback(shared_ptr<MultiWriteTracker> tracker,
+                               WriteResponsePB* response)
+      : tracker_(std::move(tracker)),
+        response_(response) {}
+
+  void OpCompleted() override {
+    if (!status_.ok()) {
+      SetupWriteError(status_, code_, response_);
+    }
+    tracker_->WriteDone();
+  }
+
+ private:
+  const shared_ptr<MultiWriteTracker> tracker_;
+  WriteResponsePB* response_;
+};
+
 class TxnWriteCompletionCallback : public RpcOpCompletionCallback<WriteResponsePB> {
  public:
   TxnWriteCompletionCallback(RpcContext* context, WriteResponsePB* response,
@@ -727,6 +924,8 @@ class TxnWriteCompletionCallback : public RpcOpCompletionCallback<WriteResponseP
   std::function<Status(void)> abort_func_;
 };
 
+class ScanResultCopier;
+
 // Generic interface to handle scan results.
 class ScanResultCollector {
  public:
@@ -739,7 +938,8 @@ class ScanResultCollector {
   // Return the number of rows actually returned to the client.
   virtual int64_t NumRowsReturned() const = 0;
 
-  // Initialize the serializer with the given row format flags.
+  // Initialize the serializer with the given row format flags and, if not null,
+  // the aggregates to compute instead of returning the rows.
   //
   // This is a separate function instead of a constructor argument passed to specific
   // collector implementations because, currently, the collector is built before the
@@ -747,11 +947,37 @@ class ScanResultCollector {
   //
   // Does nothing by default.
   virtual Status InitSerializer(uint64_t /* row_format_flags */,
+                                const AggregationSpecPB* /* aggregation */,
                                 const Schema& /* scanner_schema */,
                                 const Schema& /* client_schema */) {
     return Status::OK();
   }
 
+  // Returns true if the batch may be computed ahead of the request for it,
+  // in which case it's taken over with TakeResultsFrom().
+  //
+  // Returns false by default.
+  virtual bool SupportsPrefetching() const {
+    return false;
+  }
+
+  // Takes over the results collected by 'prefetched' for this request.
+  //
+  // REQUIRES: SupportsPrefetching().
+  virtual void TakeResultsFrom(ScanResultCopier* /* prefetched */) {
+    LOG(FATAL) << "prefetching is not supported";
+  }
+
+  // Returns where to add the checksums of the rowsets which a scan of all the
+  // rows of a tablet may leave out, their checksums being known without
+  // reading them (see RowSet::GetKnownChecksum()), or null if the collector
+  // needs all the rows.
+  //
+  // Returns null by default.
+  virtual tablet::RowSetChecksum* known_rowset_checksums() {
+    return nullptr;
+  }
+
   CpuTimes* cpu_times() {
     return &cpu_times_;
   }
@@ -930,6 +1156,65 @@ class ColumnarResultSerializer : public ResultSerializer {
   bool done_ = false;
 };
 
+// Aggregates the rows instead of returning them, and returns the aggregates
+// as rows in the rowwise format.
+class AggregatingResultSerializer : public ResultSerializer {
+ public:
+  static Status Create(uint64_t flags,
+                       const AggregationSpecPB& aggregation,
+                       const Schema& scanner_schema,
+                       const Schema& client_schema,
+                       unique_ptr<ResultSerializer>* serializer) {
+    if (flags != RowFormatFlags::NO_FLAGS) {
+      return Status::InvalidArgument("Row format flags not supported with aggregation");
+    }
+    unique_ptr<ScanAggregator> aggregator;
+    RETURN_NOT_OK(ScanAggregator::Create(aggregation, scanner_schema, client_schema,
+                                         &aggregator));
+    serializer->reset(new AggregatingResultSerializer(std::move(aggregator)));
+    return Status::OK();
+  }
+
+  // No row is returned as such, so this always returns 0.
+  int SerializeRowBlock(const RowBlock& row_block,
+                        const Schema* /* unused */) override {
+    aggregator_->AddRowBlock(row_block);
+    return 0;
+  }
+
+  size_t ResponseSize() const override {
+    return aggregator_->ResultSize();
+  }
+
+  void SetupResponse(RpcContext* context, ScanResponsePB* resp) override {
+    CHECK(!done_);
+    done_ = true;
+
+    faststring rows_data;
+    faststring indirect_data;
+    RowwiseRowBlockPB* data = resp->mutable_data();
+    data->set_num_rows(aggregator_->SerializeResults(&rows_data, &indirect_data));
+    int rows_idx;
+    CHECK_OK(context->AddOutboundSidecar(
+        RpcSidecar::FromFaststring(std::move(rows_data)), &rows_idx));
+    data->set_rows_sidecar(rows_idx);
+    if (indirect_data.size() > 0) {
+      int indirect_idx;
+      CHECK_OK(context->AddOutboundSidecar(
+          RpcSidecar::FromFaststring(std::move(indirect_data)), &indirect_idx));
+      data->set_indirect_data_sidecar(indirect_idx);
+    }
+  }
+
+ private:
+  explicit AggregatingResultSerializer(unique_ptr<ScanAggregator> aggregator)
+      : aggregator_(std::move(aggregator)) {
+  }
+
+  unique_ptr<ScanAggregator> aggregator_;
+  bool done_ = false;
+};
+
 } // anonymous namespace
 
 // Copies the scan result to the given row block PB and data buffers.
@@ -954,8 +1239,9 @@ class ScanResultCopier : public ScanResultCollector {
     if (num_selected > 0) {
       num_rows_returned_ += num_selected;
       scanner->add_num_rows_returned(num_selected);
-      SetLastRow(row_block, &last_primary_key_);
     }
+    // Aggregated rows aren't returned, but resuming the scan must skip them.
+    SetLastRow(row_block, &last_primary_key_);
   }
 
   // Returns number of bytes buffered to return.
@@ -968,6 +1254,7 @@ class ScanResultCopier : public ScanResultCollector {
   }
 
   Status InitSerializer(uint64_t row_format_flags,
+                        const AggregationSpecPB* aggregation,
                         const Schema& scanner_schema,
                         const Schema& client_schema) override {
     if (serializer_) {
@@ -975,6 +1262,10 @@ class ScanResultCopier : public ScanResultCollector {
       // which is a bit ugly. Refactor to avoid!
       return Status::OK();
     }
+    if (aggregation) {
+      return AggregatingResultSerializer::Create(
+          row_format_flags, *aggregation, scanner_schema, client_schema, &serializer_);
+    }
     if (row_format_flags & COLUMNAR_LAYOUT) {
       return ColumnarResultSerializer::Create(
           row_format_flags, batch_size_bytes_, scanner_schema, client_schema, &serializer_);
@@ -983,6 +1274,16 @@ class ScanResultCopier : public ScanResultCollector {
     return Status::OK();
   }
 
+  bool SupportsPrefetching() const override {
+    return true;
+  }
+
+  void TakeResultsFrom(ScanResultCopier* prefetched) override {
+    num_rows_returned_ = prefetched->num_rows_returned_;
+    last_primary_key_ = std::move(prefetched->last_primary_key_);
+    serializer_ = std::move(prefetched->serializer_);
+  }
+
   void SetupResponse(RpcContext* context, ScanResponsePB* resp) {
     if (serializer_) {
       serializer_->SetupResponse(context, resp);
@@ -1009,8 +1310,8 @@ class ScanResultCopier : public ScanResultCollector {
 // Checksums the scan result.
 class ScanResultChecksummer : public ScanResultCollector {
  public:
-  ScanResultChecksummer()
-      : crc_(crc::GetCrc32cInstance()),
+  explicit ScanResultChecksummer(bool use_known_rowset_checksums)
+      : use_known_rowset_checksums_(use_known_rowset_checksums),
         agg_checksum_(0),
         rows_checksummed_(0) {
   }
@@ -1026,7 +1327,7 @@ class ScanResultChecksummer : public ScanResultCollector {
     size_t nrows = row_block.nrows();
     for (size_t i = 0; i < nrows; i++) {
       if (!row_block.selection_vector()->IsRowSelected(i)) continue;
-      uint32_t row_crc = CalcRowCrc32(*client_projection_schema, row_block.row(i));
+      uint32_t row_crc = checksummer_.RowCrc32(*client_projection_schema, row_block.row(i));
       agg_checksum_ += row_crc;
       rows_checksummed_++;
     }
@@ -1041,48 +1342,29 @@ class ScanResultChecksummer : public ScanResultCollector {
     return 0;
   }
 
+  tablet::RowSetChecksum* known_rowset_checksums() override {
+    return use_known_rowset_checksums_ ? &known_rowset_checksums_ : nullptr;
+  }
+
   int64_t rows_checksummed() const {
-    return rows_checksummed_;
+    return rows_checksummed_ + known_rowset_checksums_.num_rows;
   }
 
   // Accessors for initializing / setting the checksum.
   void set_agg_checksum(uint64_t value) { agg_checksum_ = value; }
-  uint64_t agg_checksum() const { return agg_checksum_; }
+  uint64_t agg_checksum() const { return agg_checksum_ + known_rowset_checksums_.checksum; }
 
  private:
-  // Calculates a CRC32C for the given row.
-  uint32_t CalcRowCrc32(const Schema& projection, const RowBlockRow& row) {
-    tmp_buf_.clear();
-
-    for (size_t j = 0; j < projection.num_columns(); j++) {
-      uint32_t col_index = static_cast<uint32_t>(j);  // For the CRC.
-      tmp_buf_.append(&col_index, sizeof(col_index));
-      ColumnBlockCell cell = row.cell(j);
-      if (cell.is_nullable()) {
-        uint8_t is_defined = cell.is_null() ? 0 : 1;
-        tmp_buf_.append(&is_defined, sizeof(is_defined));
-        if (!is_defined) continue;
-      }
-      if (cell.typeinfo()->physical_type() == BINARY) {
-        const Slice* data = reinterpret_cast<const Slice *>(cell.ptr());
-        tmp_buf_.append(data->data(), data->size());
-      } else {
-        tmp_buf_.append(cell.ptr(), cell.size());
-      }
-    }
-
-    uint64_t row_crc = 0;
-    crc_->Compute(tmp_buf_.data(), tmp_buf_.size(), &row_crc, nullptr);
-    return static_cast<uint32_t>(row_crc); // CRC32 only uses the lower 32 bits.
-  }
-
-
-  faststring tmp_buf_;
-  crc::Crc* const crc_;
+  const bool use_known_rowset_checksums_;
+  RowChecksummer checksummer_;
   uint64_t agg_checksum_;
   int64_t rows_checksummed_;
   faststring encoded_last_row_;
 
+  // The checksums of the rowsets the scan left out, their checksums being
+  // known from their metadata.
+  tablet::RowSetChecksum known_rowset_checksums_;
+
   DISALLOW_COPY_AND_ASSIGN(ScanResultChecksummer);
 };
 
@@ -1102,9 +1384,15 @@ static size_t GetMaxBatchSizeBytesHint(const ScanRequestPB* req) {
 TabletServiceImpl::TabletServiceImpl(TabletServer* server)
     : TabletServerServiceIf(server->metric_entity(), server->result_tracker()),
       server_(server),
-      rng_(GetRandomSeed32()) {
+      rng_(GetRandomSeed32()),
+      request_capture_(server->fs_manager()->env()) {
   num_op_apply_queue_rejections_ = server_->metric_entity()->FindOrCreateCounter(
       &METRIC_op_apply_queue_overload_rejections);
+  num_memory_pressure_write_delays_ = server_->metric_entity()->FindOrCreateCounter(
+      &METRIC_memory_pressure_write_delays);
+  unique_ptr<ThreadPool> delayed_write_pool;
+  CHECK_OK(ThreadPoolBuilder("delayed-write").Build(&delayed_write_pool));
+  delayed_write_pool_ = std::move(delayed_write_pool);
 }
 
 bool TabletServiceImpl::AuthorizeClientOrServiceUser(const google::protobuf::Message* /*req*/,
@@ -1123,6 +1411,15 @@ bool TabletServiceImpl::AuthorizeListTablets(const google::protobuf::Message* re
   return AuthorizeClient(req, resp, context);
 }
 
+bool TabletServiceImpl::AuthorizeGetChanges(const google::protobuf::Message* req,
+                                            google::protobuf::Message* resp,
+                                            RpcContext* context) {
+  if (FLAGS_tserver_enforce_access_control) {
+    return server_->Authorize(context, ServerBase::SUPER_USER);
+  }
+  return AuthorizeClient(req, resp, context);
+}
+
 bool TabletServiceImpl::AuthorizeClient(const google::protobuf::Message* /*req*/,
                                         google::protobuf::Message* /*resp*/,
                                         RpcContext* context) {
@@ -1535,78 +1832,30 @@ void TabletServiceAdminImpl::DeleteTablet(const DeleteTabletRequestPB* req,
                                                response_callback);
 }
 
-void TabletServiceImpl::Write(const WriteRequestPB* req,
-                              WriteResponsePB* resp,
-                              RpcContext* context) {
-  const auto& tablet_id = req->tablet_id();
-  TRACE_EVENT1("tserver", "TabletServiceImpl::Write",
-               "tablet_id", tablet_id);
-  DVLOG(3) << Substitute("Received Write RPC: $0, requestor: $1, request id: $2",
-                        SecureDebugString(*req), context->requestor_string(),
-                        context->request_id() == nullptr ?
-                        "" : SecureDebugString(*context->request_id()));
-  scoped_refptr<TabletReplica> replica;
-  if (!LookupRunningTabletReplicaOrRespond(
-        server_->tablet_manager(), tablet_id, resp, context, &replica)) {
-    return;
-  }
-  optional<WriteAuthorizationContext> authz_context;
-  if (FLAGS_tserver_enforce_access_control) {
-    TokenPB token;
-    if (!VerifyAuthzTokenOrRespond(server_->token_verifier(), *req, context, &token)) {
-      return;
-    }
-    const auto& privilege = token.authz().table_privilege();
-    if (!CheckMatchingTableIdOrRespond(privilege, replica->tablet_metadata()->table_id(),
-                                       "Write", context)) {
-      return;
-    }
-    WritePrivileges privileges;
-    if (privilege.insert_privilege()) {
-      InsertOrDie(&privileges, WritePrivilegeType::INSERT);
-    }
-    if (privilege.update_privilege()) {
-      InsertOrDie(&privileges, WritePrivilegeType::UPDATE);
-    }
-    if (privilege.delete_privilege()) {
-      InsertOrDie(&privileges, WritePrivilegeType::DELETE);
-    }
-    if (privileges.empty()) {
-      // If we know there are no write-related privileges outright, we can
-      // short-circuit further checking and reject the request immediately.
-      // Otherwise, we'll defer the checking to the prepare phase of the
-      // op after decoding the operations.
-      LOG(WARNING) << Substitute("rejecting Write request from $0: no write privileges",
-                                 context->requestor_string());
-      context->RespondRpcFailure(ErrorStatusPB::FATAL_UNAUTHORIZED,
-          Status::NotAuthorized("not authorized to write"));
-      return;
-    }
-    authz_context = WriteAuthorizationContext{ privileges, /*requested_op_types=*/{} };
+Status TabletServiceImpl::CheckWriteAdmission(const WriteRequestPB& req,
+                                              TabletReplica* replica,
+                                              Tablet* tablet,
+                                              const RpcContext* context,
+                                              bool memory_pressure_delayed,
+                                              TabletServerErrorPB::Code* error_code) {
+  uint64_t bytes = req.row_operations().rows().size() +
+      req.row_operations().indirect_data().size();
+  if (!tablet->ShouldThrottleAllow(bytes)) {
+    *error_code = TabletServerErrorPB::THROTTLED;
+    return Status::ServiceUnavailable("Rejecting Write request: throttled");
   }
-
-  shared_ptr<Tablet> tablet;
-  TabletServerErrorPB::Code error_code;
-  Status s = GetTabletRef(replica, &tablet, &error_code);
+  Status s = server_->quota_manager()->ChargeWrite(context->remote_user().username(),
+                                                   replica->tablet_metadata()->table_id());
   if (PREDICT_FALSE(!s.ok())) {
-    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
-    return;
-  }
-
-  uint64_t bytes = req->row_operations().rows().size() +
-      req->row_operations().indirect_data().size();
-  if (!tablet->ShouldThrottleAllow(bytes)) {
-    SetupErrorAndRespond(resp->mutable_error(),
-                         Status::ServiceUnavailable("Rejecting Write request: throttled"),
-                         TabletServerErrorPB::THROTTLED,
-                         context);
-    return;
+    *error_code = TabletServerErrorPB::THROTTLED;
+    return s;
   }
 
   // Check for memory pressure; don't bother doing any additional work if we've
   // exceeded the limit.
   double capacity_pct;
-  if (process_memory::SoftLimitExceeded(&capacity_pct)) {
+  if (memory_pressure_delayed ? SoftMemoryLimitExcess(&capacity_pct) >= 1
+                              : process_memory::SoftLimitExceeded(&capacity_pct)) {
     tablet->metrics()->leader_memory_pressure_rejections->Increment();
     string msg = StringPrintf("Soft memory limit exceeded (at %.2f%% of capacity)", capacity_pct);
     if (capacity_pct >= FLAGS_memory_limit_warn_threshold_percentage) {
@@ -1614,19 +1863,14 @@ void TabletServiceImpl::Write(const WriteRequestPB* req,
     } else {
       KLOG_EVERY_N_SECS(INFO, 1) << "Rejecting Write request: " << msg << THROTTLE_MSG;
     }
-    SetupErrorAndRespond(resp->mutable_error(), Status::ServiceUnavailable(msg),
-                         TabletServerErrorPB::UNKNOWN_ERROR,
-                         context);
-    return;
+    *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+    return Status::ServiceUnavailable(msg);
   }
 
-  if (!server_->clock()->SupportsExternalConsistencyMode(req->external_consistency_mode())) {
-    Status s = Status::NotSupported("The configured clock does not support the"
+  if (!server_->clock()->SupportsExternalConsistencyMode(req.external_consistency_mode())) {
+    *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+    return Status::NotSupported("The configured clock does not support the"
         " required consistency mode.");
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::UNKNOWN_ERROR,
-                         context);
-    return;
   }
 
   // If the apply queue is overloaded, the write request might be rejected.
@@ -1645,12 +1889,98 @@ void TabletServiceImpl::Write(const WriteRequestPB* req,
       static const Status kStatus = Status::ServiceUnavailable(
           "op apply queue is overloaded");
       num_op_apply_queue_rejections_->Increment();
-      return SetupErrorAndRespond(resp->mutable_error(),
-                                  kStatus,
-                                  TabletServerErrorPB::THROTTLED,
-                                  context);
+      *error_code = TabletServerErrorPB::THROTTLED;
+      return kStatus;
     }
   }
+  return Status::OK();
+}
+
+bool TabletServiceImpl::MaybeDelayWrite(RpcContext* context,
+                                        std::function<void()> handle_write) {
+  const auto max_delay_ms = FLAGS_tserver_memory_pressure_max_write_delay_ms;
+  if (max_delay_ms == 0) {
+    return false;
+  }
+  // Over the hard limit, the write is rejected right away.
+  const double excess = SoftMemoryLimitExcess(nullptr);
+  if (excess <= 0 || excess >= 1) {
+    return false;
+  }
+  const auto delay = MonoDelta::FromMicroseconds(
+      static_cast<int64_t>(excess * max_delay_ms * 1000));
+  if (MonoTime::Now() + delay >= context->GetClientDeadline()) {
+    return false;
+  }
+  num_memory_pressure_write_delays_->Increment();
+  TRACE("Delaying write admission by $0 under memory pressure", delay.ToString());
+  server_->messenger()->ScheduleOnReactor(
+      [pool = delayed_write_pool_, context, handle_write = std::move(handle_write)](
+          const Status& s) {
+        // The task is aborted if the messenger shuts down, and the pool refuses
+        // new tasks once the service shut down. Either way, respond right away
+        // rather than handling the write.
+        Status submit_s = s.ok() ? pool->Submit(handle_write) : s;
+        if (PREDICT_FALSE(!submit_s.ok())) {
+          context->RespondRpcFailure(
+              ErrorStatusPB::ERROR_SERVER_TOO_BUSY,
+              Status::ServiceUnavailable("unable to handle the delayed write",
+                                         submit_s.ToString()));
+        }
+      },
+      delay);
+  return true;
+}
+
+void TabletServiceImpl::Write(const WriteRequestPB* req,
+                              WriteResponsePB* resp,
+                              RpcContext* context) {
+  if (MaybeDelayWrite(context, [this, req, resp, context]() {
+        HandleWrite(req, resp, context, /*memory_pressure_delayed=*/true);
+      })) {
+    return;
+  }
+  HandleWrite(req, resp, context, /*memory_pressure_delayed=*/false);
+}
+
+void TabletServiceImpl::HandleWrite(const WriteRequestPB* req,
+                                    WriteResponsePB* resp,
+                                    RpcContext* context,
+                                    bool memory_pressure_delayed) {
+  const auto& tablet_id = req->tablet_id();
+  TRACE_EVENT1("tserver", "TabletServiceImpl::Write",
+               "tablet_id", tablet_id);
+  DVLOG(3) << Substitute("Received Write RPC: $0, requestor: $1, request id: $2",
+                        SecureDebugString(*req), context->requestor_string(),
+                        context->request_id() == nullptr ?
+                        "" : SecureDebugString(*context->request_id()));
+  scoped_refptr<TabletReplica> replica;
+  if (!LookupRunningTabletReplicaOrRespond(
+        server_->tablet_manager(), tablet_id, resp, context, &replica)) {
+    return;
+  }
+  optional<WriteAuthorizationContext> authz_context;
+  if (FLAGS_tserver_enforce_access_control &&
+      !AuthorizeWriteOrRespond(server_->token_verifier(), *req, *replica, context,
+                               &authz_context)) {
+    return;
+  }
+
+  shared_ptr<Tablet> tablet;
+  TabletServerErrorPB::Code error_code;
+  Status s = GetTabletRef(replica, &tablet, &error_code);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
+    return;
+  }
+
+  s = CheckWriteAdmission(*req, replica.get(), tablet.get(), context,
+                          memory_pressure_delayed, &error_code);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
+    return;
+  }
+  request_capture_.MaybeCaptureWrite(*replica, *req);
 
   unique_ptr<WriteOpState> op_state(new WriteOpState(
       replica.get(),
@@ -1710,10 +2040,98 @@ void TabletServiceImpl::Write(const WriteRequestPB* req,
     VLOG(2) << Substitute("submitting txn write op: $0", s.ToString());
   }
 
-  // Check that we could submit the write
-  if (PREDICT_FALSE(!s.ok())) {
-    return SetupErrorAndRespond(
-        resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR, context);
+  // Check that we could submit the write
+  if (PREDICT_FALSE(!s.ok())) {
+    return SetupErrorAndRespond(
+        resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR, context);
+  }
+}
+
+void TabletServiceImpl::MultiWrite(const MultiWriteRequestPB* req,
+                                   MultiWriteResponsePB* resp,
+                                   RpcContext* context) {
+  if (MaybeDelayWrite(context, [this, req, resp, context]() {
+        HandleMultiWrite(req, resp, context, /*memory_pressure_delayed=*/true);
+      })) {
+    return;
+  }
+  HandleMultiWrite(req, resp, context, /*memory_pressure_delayed=*/false);
+}
+
+void TabletServiceImpl::HandleMultiWrite(const MultiWriteRequestPB* req,
+                                         MultiWriteResponsePB* resp,
+                                         RpcContext* context,
+                                         bool memory_pressure_delayed) {
+  TRACE_EVENT1("tserver", "TabletServiceImpl::MultiWrite",
+               "num_writes", req->writes_size());
+  const int num_writes = req->writes_size();
+  if (num_writes == 0) {
+    context->RespondSuccess();
+    return;
+  }
+
+  // Look up the replicas and authorize all the writes before submitting any of
+  // them: an invalid authz token fails the whole call, so that the client may
+  // retry it as is once it got new tokens.
+  vector<scoped_refptr<TabletReplica>> replicas(num_writes);
+  vector<optional<WriteAuthorizationContext>> authz_contexts(num_writes);
+  for (int i = 0; i < num_writes; i++) {
+    const auto& write = req->writes(i);
+    auto* write_resp = resp->add_responses();
+    TabletServerErrorPB::Code error_code;
+    Status s = LookupRunningTabletReplica(server_->tablet_manager(), write.tablet_id(),
+                                          &replicas[i], &error_code);
+    if (PREDICT_TRUE(s.ok()) && write.has_txn_id()) {
+      s = Status::NotSupported("transactional writes can't be sent with MultiWrite");
+      error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+    }
+    if (PREDICT_FALSE(!s.ok())) {
+      SetupWriteError(s, error_code, write_resp);
+      replicas[i].reset();
+      continue;
+    }
+    if (FLAGS_tserver_enforce_access_control &&
+        !AuthorizeWriteOrRespond(server_->token_verifier(), write, *replicas[i], context,
+                                 &authz_contexts[i])) {
+      return;
+    }
+  }
+
+  const auto deadline = context->GetClientDeadline();
+  auto tracker = std::make_shared<MultiWriteTracker>(context, num_writes);
+  for (int i = 0; i < num_writes; i++) {
+    const auto& replica = replicas[i];
+    if (!replica) {
+      tracker->WriteDone();
+      continue;
+    }
+    const auto& write = req->writes(i);
+    auto* write_resp = resp->mutable_responses(i);
+    shared_ptr<Tablet> tablet;
+    TabletServerErrorPB::Code error_code;
+    Status s = GetTabletRef(replica, &tablet, &error_code);
+    if (PREDICT_TRUE(s.ok())) {
+      s = CheckWriteAdmission(write, replica.get(), tablet.get(), context,
+                              memory_pressure_delayed, &error_code);
+    }
+    if (PREDICT_TRUE(s.ok()) && write.has_propagated_timestamp()) {
+      s = server_->clock()->Update(Timestamp(write.propagated_timestamp()));
+      error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+    }
+    if (PREDICT_TRUE(s.ok())) {
+      request_capture_.MaybeCaptureWrite(*replica, write);
+      unique_ptr<WriteOpState> op_state(new WriteOpState(
+          replica.get(), &write, /*request_id=*/nullptr, write_resp,
+          std::move(authz_contexts[i])));
+      op_state->set_completion_callback(unique_ptr<OpCompletionCallback>(
+          new MultiWriteCompletionCallback(tracker, write_resp)));
+      s = replica->SubmitWrite(std::move(op_state), deadline);
+      error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+    }
+    if (PREDICT_FALSE(!s.ok())) {
+      SetupWriteError(s, error_code, write_resp);
+      tracker->WriteDone();
+    }
   }
 }
 
@@ -2129,10 +2547,12 @@ namespace {
 void SetResourceMetrics(const RpcContext* context,
                         const CpuTimes* cpu_times,
                         ResourceMetricsPB* metrics) {
-  metrics->set_cfile_cache_miss_bytes(
-    context->trace()->metrics()->GetMetric(cfile::CFILE_CACHE_MISS_BYTES_METRIC_NAME));
-  metrics->set_cfile_cache_hit_bytes(
-    context->trace()->metrics()->GetMetric(cfile::CFILE_CACHE_HIT_BYTES_METRIC_NAME));
+  const ScanResourceStats stats = ScanResourceStats::FromTrace(context->trace());
+  metrics->set_cfile_cache_miss_bytes(stats.cfile_cache_miss_bytes);
+  metrics->set_cfile_cache_hit_bytes(stats.cfile_cache_hit_bytes);
+  metrics->set_cfile_decode_nanos(stats.cfile_decode_nanos);
+  metrics->set_delta_apply_nanos(stats.delta_apply_nanos);
+  metrics->set_predicate_eval_nanos(stats.predicate_eval_nanos);
 
   metrics->set_bytes_read(
     context->trace()->metrics()->GetMetric(SCANNER_BYTES_READ_METRIC_NAME));
@@ -2210,11 +2630,19 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
                                              context, &replica)) {
       return;
     }
+    Status s = server_->quota_manager()->ChargeScan(context->remote_user().username(),
+                                                    replica->tablet_metadata()->table_id(),
+                                                    GetMaxBatchSizeBytesHint(req));
+    if (PREDICT_FALSE(!s.ok())) {
+      SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::THROTTLED, context);
+      return;
+    }
+    request_capture_.MaybeCaptureScan(*replica, *req);
     string scanner_id;
     Timestamp scan_timestamp;
-    Status s = HandleNewScanRequest(replica.get(), req, context,
-                                    &collector, &scanner_id, &scan_timestamp, &has_more_results,
-                                    &error_code);
+    s = HandleNewScanRequest(replica.get(), req, context,
+                             &collector, &scanner_id, &scan_timestamp, &has_more_results,
+                             &error_code);
     if (PREDICT_FALSE(!s.ok())) {
       SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
       return;
@@ -2441,6 +2869,108 @@ void TabletServiceImpl::SplitKeyRange(const SplitKeyRangeRequestPB* req,
   context->RespondSuccess();
 }
 
+void TabletServiceImpl::GetChanges(const GetChangesRequestPB* req,
+                                   GetChangesResponsePB* resp,
+                                   RpcContext* context) {
+  TRACE_EVENT1("tserver", "TabletServiceImpl::GetChanges",
+               "tablet_id", req->tablet_id());
+  DVLOG(3) << "Received GetChanges RPC: " << SecureDebugString(*req);
+
+  scoped_refptr<TabletReplica> replica;
+  if (!LookupRunningTabletReplicaOrRespond(server_->tablet_manager(), req->tablet_id(), resp,
+                                           context, &replica)) {
+    return;
+  }
+  if (PREDICT_FALSE(!req->has_subscription_id())) {
+    SetupErrorAndRespond(resp->mutable_error(),
+                         Status::InvalidArgument("GetChanges requires a subscription id"),
+                         TabletServerErrorPB::UNKNOWN_ERROR,
+                         context);
+    return;
+  }
+  ChangeSubscriptions* subscriptions = replica->change_subscriptions();
+  if (req->unsubscribe()) {
+    Status s = subscriptions->Remove(req->subscription_id());
+    if (PREDICT_FALSE(!s.ok())) {
+      SetupErrorAndRespond(resp->mutable_error(), s,
+                           TabletServerErrorPB::UNKNOWN_ERROR, context);
+      return;
+    }
+    context->RespondSuccess();
+    return;
+  }
+
+  shared_ptr<RaftConsensus> consensus;
+  if (!GetConsensusOrRespond(replica, resp, context, &consensus)) {
+    return;
+  }
+  // Only the leader knows which of the ops of its log are committed without
+  // waiting for the next heartbeat, so the changes are only read from it.
+  if (consensus->role() != RaftPeerPB::LEADER) {
+    SetupErrorAndRespond(resp->mutable_error(),
+                         Status::IllegalState("replica is not the leader of the tablet",
+                                              replica->permanent_uuid()),
+                         TabletServerErrorPB::NOT_THE_LEADER,
+                         context);
+    return;
+  }
+
+  // Anchor the log following the checkpoint before reading it, so that it's
+  // not garbage collected in between.
+  Status s = subscriptions->Checkpoint(req->subscription_id(), req->after_op_index());
+  vector<ReplicateRefPtr> ops;
+  if (PREDICT_TRUE(s.ok())) {
+    s = consensus->ReadCommittedOps(req->after_op_index(), req->max_bytes(), &ops);
+  }
+  // The results of the row operations of the writes are only logged in their
+  // commits, once they're applied.
+  unordered_map<int64_t, consensus::CommitMsg> commits;
+  if (PREDICT_TRUE(s.ok()) && !ops.empty()) {
+    s = replica->log()->reader()->ReadCommitsInRange(
+        ops.front()->get()->id().index(), ops.back()->get()->id().index(), &commits);
+  }
+  if (PREDICT_FALSE(!s.ok())) {
+    // The ops following the checkpoint may have been garbage collected, if
+    // the subscription expired or never existed, or if this replica became
+    // the leader after the consumer last read from another one.
+    if (s.IsNotFound()) {
+      resp->set_first_retained_op_index(replica->log()->reader()->GetMinReplicateIndex());
+    }
+    SetupErrorAndRespond(resp->mutable_error(), s,
+                         TabletServerErrorPB::UNKNOWN_ERROR, context);
+    return;
+  }
+
+  int64_t last_op_index = req->after_op_index();
+  for (const auto& op : ops) {
+    const auto& msg = *op->get();
+    // Writes of transactions are only applied once their transaction
+    // commits, which isn't streamed yet: they're skipped with the other ops.
+    if (msg.op_type() != consensus::WRITE_OP || msg.write_request().has_txn_id()) {
+      last_op_index = msg.id().index();
+      continue;
+    }
+    // The write is still being applied: it's read again by the next request.
+    const auto* commit = FindOrNull(commits, msg.id().index());
+    if (!commit) {
+      break;
+    }
+    last_op_index = msg.id().index();
+    auto* change = resp->add_changes();
+    change->set_op_term(msg.id().term());
+    change->set_op_index(msg.id().index());
+    change->set_timestamp(msg.timestamp());
+    *change->mutable_write_request() = msg.write_request();
+    for (int i = 0; i < commit->result().ops_size(); i++) {
+      if (commit->result().ops(i).has_failed_status()) {
+        change->add_failed_row_op_indexes(i);
+      }
+    }
+  }
+  resp->set_last_op_index(last_op_index);
+  context->RespondSuccess();
+}
+
 void TabletServiceImpl::Checksum(const ChecksumRequestPB* req,
                                  ChecksumResponsePB* resp,
                                  RpcContext* context) {
@@ -2461,7 +2991,7 @@ void TabletServiceImpl::Checksum(const ChecksumRequestPB* req,
   if (req->has_batch_size_bytes()) scan_req.set_batch_size_bytes(req->batch_size_bytes());
   if (req->has_close_scanner()) scan_req.set_close_scanner(req->close_scanner());
 
-  ScanResultChecksummer collector;
+  ScanResultChecksummer collector(req->use_known_rowset_checksums());
   bool has_more = false;
   TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
   // TODO(KUDU-2870): the CLI tool doesn't currently fetch authz tokens when
@@ -2556,6 +3086,9 @@ bool TabletServiceImpl::SupportsFeature(uint32_t feature) const {
     case TabletServerFeatures::QUIESCING:
     case TabletServerFeatures::BLOOM_FILTER_PREDICATE_V2:
     case TabletServerFeatures::COLUMNAR_LAYOUT_FEATURE:
+    case TabletServerFeatures::SCAN_AGGREGATION:
+    case TabletServerFeatures::SCAN_TOP_N:
+    case TabletServerFeatures::SCAN_RUNTIME_FILTERS:
       return true;
     default:
       return false;
@@ -2563,6 +3096,7 @@ bool TabletServiceImpl::SupportsFeature(uint32_t feature) const {
 }
 
 void TabletServiceImpl::Shutdown() {
+  delayed_write_pool_->Shutdown();
 }
 
 // Extract a void* pointer suitable for use in a ColumnRangePredicate from the
@@ -2741,6 +3275,40 @@ Status VerifyLegalSnapshotTimestamps(Tablet* tablet, ReadMode read_mode,
   }
   return Status::OK();
 }
+
+// Sets the options of an iteration to read from several rowsets at once, if
+// enabled with --scanner_max_rowset_parallelism. Only unordered iterations do.
+void SetRowsetParallelism(ScannerManager* manager, tablet::RowIteratorOptions* opts) {
+  if (FLAGS_scanner_max_rowset_parallelism > 1) {
+    opts->scan_pool = manager->parallel_scan_pool();
+    opts->max_parallelism = FLAGS_scanner_max_rowset_parallelism;
+  }
+}
+
+// Returns whether a scan reads all the rows of a tablet and all its columns,
+// in the order of the tablet schema, so that the checksums of its rowsets
+// computed when they were written may stand for reading them.
+bool ScanReadsAllRowsAndColumns(const NewScanRequestPB& scan_pb,
+                                const ScanSpec& spec,
+                                const vector<ColumnSchema>& missing_cols,
+                                const Schema& client_projection,
+                                const Schema& tablet_schema) {
+  if (scan_pb.has_snap_start_timestamp() || scan_pb.has_limit() ||
+      scan_pb.has_aggregation() || scan_pb.has_top_n() ||
+      scan_pb.json_path_predicates_size() > 0 || scan_pb.json_path_projections_size() > 0 ||
+      !spec.predicates().empty() || spec.lower_bound_key() ||
+      spec.exclusive_upper_bound_key() || !missing_cols.empty() ||
+      client_projection.num_columns() != tablet_schema.num_columns()) {
+    return false;
+  }
+  for (int i = 0; i < tablet_schema.num_columns(); i++) {
+    if (!client_projection.column(i).Equals(tablet_schema.column(i),
+                                            ColumnSchema::COMPARE_NAME_AND_TYPE)) {
+      return false;
+    }
+  }
+  return true;
+}
 } // anonymous namespace
 
 // Start a new scan.
@@ -2811,6 +3379,30 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
     return s;
   }
 
+  // The runtime filters known when the scan starts prune it like its predicates.
+  for (const ColumnPredicatePB& pred_pb : req->runtime_filters()) {
+    optional<ColumnPredicate> predicate;
+    RETURN_NOT_OK_EVAL(ColumnPredicateFromPB(tablet_schema, scanner->arena(), pred_pb, &predicate),
+                       *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC);
+    spec.AddPredicate(std::move(*predicate));
+  }
+
+  // Filter out the expired rows which compactions haven't dropped yet. Like
+  // any predicate, this adds the TTL column to the scan's projection if needed.
+  {
+    const shared_ptr<Tablet> tablet = replica->shared_tablet();
+    ColumnId ttl_col_id;
+    int64_t expired_before_micros;
+    if (tablet && tablet->GetRowExpiry(&ttl_col_id, &expired_before_micros)) {
+      const int ttl_col_idx = tablet_schema.find_column_by_id(ttl_col_id);
+      if (ttl_col_idx != Schema::kColumnNotFound) {
+        const int64_t* lower = scanner->arena()->NewObject<int64_t>(expired_before_micros);
+        spec.AddPredicate(ColumnPredicate::Range(tablet_schema.column(ttl_col_idx),
+                                                 lower, nullptr));
+      }
+    }
+  }
+
   VLOG(3) << "Before optimizing scan spec: " << spec.ToString(tablet_schema);
   spec.PruneInlistValuesIfPossible(tablet_schema,
                                    replica->tablet_metadata()->partition(),
@@ -2871,7 +3463,33 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
   projection = projection_builder.BuildWithoutIds();
   VLOG(3) << "Scan projection: " << projection.ToString(Schema::BASE_INFO);
 
+  const AggregationSpecPB* aggregation =
+      scan_pb.has_aggregation() ? &scan_pb.aggregation() : nullptr;
+  if (aggregation) {
+    if (scan_pb.has_limit() || scan_pb.has_snap_start_timestamp()) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return Status::InvalidArgument("Aggregation is not supported with a limit or a diff scan");
+    }
+    scanner->set_aggregation(*aggregation);
+  }
+  if (scan_pb.has_top_n()) {
+    if (aggregation || scan_pb.has_limit() || scan_pb.has_snap_start_timestamp() ||
+        scan_pb.order_mode() == ORDERED) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return Status::InvalidArgument(
+          "Top-N is not supported with a limit, an aggregation, a diff scan or an ORDERED scan");
+    }
+    unique_ptr<ScanTopN> top_n;
+    RETURN_NOT_OK_EVAL(ScanTopN::Create(scan_pb.top_n(), projection, *client_projection, &top_n),
+                       *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC);
+    scanner->set_top_n(std::move(top_n));
+  }
+  unique_ptr<ScanJsonPaths> json_paths;
+  RETURN_NOT_OK_EVAL(ScanJsonPaths::Create(scan_pb, projection, *client_projection, &json_paths),
+                     *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC);
+  scanner->set_json_paths(std::move(json_paths));
   s = result_collector->InitSerializer(scan_pb.row_format_flags(),
+                                       aggregation,
                                        projection,
                                        *client_projection);
   if (!s.ok()) {
@@ -2885,6 +3503,13 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
     return Status::OK();
   }
 
+  tablet::RowSetChecksum* known_rowset_checksums = result_collector->known_rowset_checksums();
+  if (known_rowset_checksums &&
+      !ScanReadsAllRowsAndColumns(scan_pb, spec, missing_cols, *client_projection,
+                                  tablet_schema)) {
+    known_rowset_checksums = nullptr;
+  }
+
   // It's important to keep the reference to the tablet for the case when the
   // tablet replica's shutdown is run concurrently with the code below.
   shared_ptr<Tablet> tablet;
@@ -2919,14 +3544,32 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
           return Status::InvalidArgument("scan start timestamp is only supported "
                                          "in READ_AT_SNAPSHOT read mode");
         }
-        s = tablet->NewRowIterator(projection, &iter);
+        // With leader leases, the leader only reads the latest data once it's
+        // certain that no newer leader may have accepted writes, so the scans
+        // it serves are linearizable.
+        if (FLAGS_raft_enable_leader_leases) {
+          shared_ptr<RaftConsensus> consensus = replica->shared_consensus();
+          if (consensus && consensus->role() == RaftPeerPB::LEADER) {
+            Status lease_s = consensus->WaitForLeaderLease(rpc_context->GetClientDeadline());
+            if (PREDICT_FALSE(!lease_s.ok())) {
+              *error_code = TabletServerErrorPB::NOT_THE_LEADER;
+              return lease_s;
+            }
+          }
+        }
+        tablet::RowIteratorOptions opts;
+        opts.projection = &projection;
+        opts.snap_to_include = MvccSnapshot(*tablet->mvcc_manager());
+        opts.known_rowset_checksums = known_rowset_checksums;
+        SetRowsetParallelism(server_->scanner_manager(), &opts);
+        s = tablet->NewRowIterator(std::move(opts), &iter);
         break;
       }
       case READ_YOUR_WRITES: // Fallthrough intended
       case READ_AT_SNAPSHOT: {
         s = HandleScanAtSnapshot(
             scan_pb, rpc_context, projection, tablet.get(), replica->time_manager(),
-            &iter, &snap_start_timestamp, snap_timestamp, error_code);
+            known_rowset_checksums, &iter, &snap_start_timestamp, snap_timestamp, error_code);
         break;
       }
     }
@@ -3020,6 +3663,7 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
     // from the first half that is no longer executed in this codepath.
     ScanRequestPB continue_req(*req);
     continue_req.set_scanner_id(scanner->id());
+    continue_req.clear_runtime_filters();
     scanner_lock.Unlock();
     return HandleContinueScanRequest(
         &continue_req, rpc_context, result_collector, has_more_results, error_code);
@@ -3031,6 +3675,173 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
   return Status::OK();
 }
 
+namespace {
+
+// Returns true if a filter added while the scan runs can't match any row,
+// which ends the scan.
+bool IsFilteredOut(Scanner* scanner) {
+  const auto& runtime_filters = scanner->runtime_filters();
+  return std::any_of(runtime_filters.begin(), runtime_filters.end(), [](const auto& f) {
+    return f.second.predicate_type() == PredicateType::None;
+  });
+}
+
+// Returns true if 'scanner' has rows left to return.
+bool HasMoreRows(Scanner* scanner) {
+  return !IsFilteredOut(scanner) && scanner->iter()->HasNext() &&
+      !scanner->has_fulfilled_limit();
+}
+
+// Scans the next batch of rows of 'scanner', of about 'batch_size_bytes',
+// into 'result_collector', whose serializer must be initialized. Sets
+// 'rows_scanned' to the number of rows read from the iterator, regardless of
+// the predicates or the deletions.
+Status ScanNextBatch(Scanner* scanner,
+                     size_t batch_size_bytes,
+                     bool close_scanner,
+                     ScanResultCollector* result_collector,
+                     int64_t* rows_scanned,
+                     TabletServerErrorPB::Code* error_code) {
+  RowwiseIterator* iter = scanner->iter();
+  const auto& runtime_filters = scanner->runtime_filters();
+  const bool filtered_out = IsFilteredOut(scanner);
+
+  // The rows of a Top-N scan are only returned once the whole tablet is scanned.
+  ScanTopN* top_n = scanner->top_n();
+  const ScanJsonPaths* json_paths = scanner->json_paths();
+
+  // TODO(todd): could size the RowBlock based on the user's requested batch size?
+  // If people had really large indirect objects, we would currently overshoot
+  // their requested batch size by a lot.
+  RowBlockMemory mem(32 * 1024);
+  RowBlock block(&iter->schema(), FLAGS_scanner_batch_size_rows, &mem);
+
+  // TODO(todd): in the future, use the client timeout to set a budget. For now,
+  // just use a half second, which should be plenty to amortize call overhead.
+  int budget_ms = 500;
+  MonoTime deadline = MonoTime::Now() + MonoDelta::FromMilliseconds(budget_ms);
+
+  *rows_scanned = 0;
+  while (!filtered_out && iter->HasNext() && !scanner->has_fulfilled_limit()) {
+    if (PREDICT_FALSE(FLAGS_scanner_inject_latency_on_each_batch_ms > 0)) {
+      SleepFor(MonoDelta::FromMilliseconds(FLAGS_scanner_inject_latency_on_each_batch_ms));
+    }
+
+    Status s = iter->NextBlock(&block);
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG(WARNING) << "Copying rows from internal iterator for scanner " << scanner->id();
+      *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+      return s;
+    }
+
+    if (PREDICT_TRUE(block.nrows() > 0)) {
+      // Count the number of rows scanned, regardless of predicates or deletions.
+      // The collector will separately count the number of rows actually returned to
+      // the client.
+      *rows_scanned += block.nrows();
+      for (const auto& f : runtime_filters) {
+        f.second.Evaluate(block.column_block(f.first), block.selection_vector());
+      }
+      if (json_paths) {
+        s = json_paths->Apply(&block);
+        if (PREDICT_FALSE(!s.ok())) {
+          *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+          return s;
+        }
+      }
+      if (scanner->spec().has_limit()) {
+        int64_t rows_left = scanner->spec().limit() - scanner->num_rows_returned();
+        DCHECK_GT(rows_left, 0);  // Guaranteed by has_fulfilled_limit()
+        block.selection_vector()->ClearToSelectAtMost(static_cast<size_t>(rows_left));
+      }
+      if (top_n) {
+        top_n->AddRowBlock(block);
+      } else {
+        result_collector->HandleRowBlock(scanner, block);
+      }
+    }
+
+    int64_t response_size = result_collector->ResponseSize();
+
+    if (VLOG_IS_ON(2)) {
+      // This may be fairly expensive if row block size is small
+      TRACE("Copied block (nrows=$0), new size=$1", block.nrows(), response_size);
+    }
+
+    // TODO: should check if RPC got cancelled, once we implement RPC cancellation.
+    if (PREDICT_FALSE(MonoTime::Now() >= deadline)) {
+      TRACE("Deadline expired - responding early");
+      break;
+    }
+
+    if (response_size >= batch_size_bytes) {
+      break;
+    }
+  }
+
+  if (top_n && !iter->HasNext() && !close_scanner) {
+    result_collector->HandleRowBlock(scanner, top_n->Finish());
+  }
+  return Status::OK();
+}
+
+// A batch of rows copied ahead of the request for it.
+class PrefetchedBatch : public PrefetchedScanBatch {
+ public:
+  PrefetchedBatch(shared_ptr<MemTracker> mem_tracker, int64_t memory, size_t batch_size_bytes)
+      : PrefetchedScanBatch(std::move(mem_tracker), memory),
+        collector(batch_size_bytes),
+        rows_scanned(0),
+        error_code(TabletServerErrorPB::UNKNOWN_ERROR) {
+  }
+
+  ScanResultCopier collector;
+  int64_t rows_scanned;
+
+  // The result of the scan of the batch, returned to the request for it.
+  Status status;
+  TabletServerErrorPB::Code error_code;
+};
+
+// Copies the batch of 'scanner' for the request with the call sequence ID
+// 'call_seq_id' ahead of it, unless the request comes first.
+void PrefetchBatch(ScannerManager* manager,
+                   const SharedScanner& scanner,
+                   uint32_t call_seq_id,
+                   size_t batch_size_bytes) {
+  // A batch overshoots its size by up to a block, and its rows and their
+  // indirect data are buffered separately.
+  const int64_t memory = 2 * batch_size_bytes;
+  if (!manager->TryReservePrefetchMemory(memory)) {
+    VLOG(2) << "Not prefetching the next batch of scanner " << scanner->id()
+            << ": over the memory budget";
+    return;
+  }
+  unique_ptr<PrefetchedBatch> batch(
+      new PrefetchedBatch(manager->prefetch_mem_tracker(), memory, batch_size_bytes));
+
+  auto scanner_lock = scanner->LockForAccess();
+  if (scanner->call_seq_id() != call_seq_id || scanner->has_prefetched_batch() ||
+      !HasMoreRows(scanner.get())) {
+    return;
+  }
+  ScopedAddScannerTiming scanner_timer(scanner.get(), batch->collector.cpu_times());
+  RowwiseIterator* iter = scanner->iter();
+  batch->status = batch->collector.InitSerializer(scanner->row_format_flags(),
+                                                  scanner->aggregation(),
+                                                  iter->schema(),
+                                                  *scanner->client_projection_schema());
+  if (batch->status.ok()) {
+    batch->status = ScanNextBatch(scanner.get(), batch_size_bytes, /*close_scanner=*/false,
+                                  &batch->collector, &batch->rows_scanned, &batch->error_code);
+  } else {
+    batch->error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+  }
+  scanner->SetPrefetchedBatch(call_seq_id, std::move(batch));
+}
+
+} // anonymous namespace
+
 // Continue an existing scan request.
 Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
                                                     const RpcContext* rpc_context,
@@ -3069,6 +3880,18 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
                                       "--scanner_inject_service_unavailable_on_continue_scan");
   }
 
+  // Charge the batch before the scanner's call sequence moves forward, so that
+  // a rejected request may be retried as is.
+  if (batch_size_bytes > 0) {
+    const auto& table_id = scanner->tablet_replica()->tablet_metadata()->table_id();
+    s = server_->quota_manager()->ChargeScan(scanner->remote_user().username(),
+                                             table_id, batch_size_bytes);
+    if (PREDICT_FALSE(!s.ok())) {
+      *error_code = TabletServerErrorPB::THROTTLED;
+      return s;
+    }
+  }
+
   // If we early-exit out of this function, automatically unregister the scanner.
   ScopedUnregisterScanner unreg_scanner(server_->scanner_manager(), scanner->id());
   ScopedAddScannerTiming scanner_timer(scanner.get(), result_collector->cpu_times());
@@ -3094,8 +3917,33 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
 
   RowwiseIterator* iter = scanner->iter();
 
+  // The iterators were set up with the predicates known when the scan
+  // started, so the filters added since are evaluated on the rows read.
+  if (req->runtime_filters_size() > 0) {
+    if (scanner->top_n()) {
+      // The rows kept so far would have to be filtered, and replaced.
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return Status::InvalidArgument("runtime filters can't be added to a Top-N scan");
+    }
+    const SchemaPtr tablet_schema = scanner->tablet_replica()->tablet_metadata()->schema();
+    for (const ColumnPredicatePB& pred_pb : req->runtime_filters()) {
+      optional<ColumnPredicate> predicate;
+      RETURN_NOT_OK_EVAL(
+          ColumnPredicateFromPB(*tablet_schema, scanner->arena(), pred_pb, &predicate),
+          *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC);
+      const int col_idx = iter->schema().find_column(predicate->column().name());
+      if (col_idx == Schema::kColumnNotFound) {
+        *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+        return Status::InvalidArgument("runtime filter on a column not in the projection",
+                                       predicate->column().name());
+      }
+      scanner->AddRuntimeFilter(col_idx, std::move(*predicate));
+    }
+  }
+
   // Set the row format flags on the ScanResultCollector.
   s = result_collector->InitSerializer(scanner->row_format_flags(),
+                                       scanner->aggregation(),
                                        iter->schema(),
                                        *scanner->client_projection_schema());
   if (!s.ok()) {
@@ -3103,60 +3951,27 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
     return s;
   }
 
-  // TODO(todd): could size the RowBlock based on the user's requested batch size?
-  // If people had really large indirect objects, we would currently overshoot
-  // their requested batch size by a lot.
-  RowBlockMemory mem(32 * 1024);
-  RowBlock block(&iter->schema(), FLAGS_scanner_batch_size_rows, &mem);
-
-  // TODO(todd): in the future, use the client timeout to set a budget. For now,
-  // just use a half second, which should be plenty to amortize call overhead.
-  int budget_ms = 500;
-  MonoTime deadline = MonoTime::Now() + MonoDelta::FromMilliseconds(budget_ms);
-
   int64_t rows_scanned = 0;
-  while (iter->HasNext() && !scanner->has_fulfilled_limit()) {
-    if (PREDICT_FALSE(FLAGS_scanner_inject_latency_on_each_batch_ms > 0)) {
-      SleepFor(MonoDelta::FromMilliseconds(FLAGS_scanner_inject_latency_on_each_batch_ms));
-    }
-
-    Status s = iter->NextBlock(&block);
-    if (PREDICT_FALSE(!s.ok())) {
-      LOG(WARNING) << "Copying rows from internal iterator for request "
-                   << SecureShortDebugString(*req);
+  // The rows of the batch computed ahead of this request were consumed from
+  // the iterator already, so they must be returned. The runtime filters of
+  // this request only apply to the following batches.
+  unique_ptr<PrefetchedScanBatch> prefetched = scanner->TakePrefetchedBatch(req->call_seq_id());
+  if (prefetched) {
+    if (PREDICT_FALSE(!result_collector->SupportsPrefetching())) {
       *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
-      return s;
-    }
-
-    if (PREDICT_TRUE(block.nrows() > 0)) {
-      // Count the number of rows scanned, regardless of predicates or deletions.
-      // The collector will separately count the number of rows actually returned to
-      // the client.
-      rows_scanned += block.nrows();
-      if (scanner->spec().has_limit()) {
-        int64_t rows_left = scanner->spec().limit() - scanner->num_rows_returned();
-        DCHECK_GT(rows_left, 0);  // Guaranteed by has_fulfilled_limit()
-        block.selection_vector()->ClearToSelectAtMost(static_cast<size_t>(rows_left));
-      }
-      result_collector->HandleRowBlock(scanner.get(), block);
-    }
-
-    int64_t response_size = result_collector->ResponseSize();
-
-    if (VLOG_IS_ON(2)) {
-      // This may be fairly expensive if row block size is small
-      TRACE("Copied block (nrows=$0), new size=$1", block.nrows(), response_size);
-    }
-
-    // TODO: should check if RPC got cancelled, once we implement RPC cancellation.
-    if (PREDICT_FALSE(MonoTime::Now() >= deadline)) {
-      TRACE("Deadline expired - responding early");
-      break;
+      return Status::IllegalState("scanner has a prefetched batch for another kind of request");
     }
-
-    if (response_size >= batch_size_bytes) {
-      break;
+    TRACE("Using the prefetched batch");
+    auto* batch = down_cast<PrefetchedBatch*>(prefetched.get());
+    if (PREDICT_FALSE(!batch->status.ok())) {
+      *error_code = batch->error_code;
+      return batch->status;
     }
+    result_collector->TakeResultsFrom(&batch->collector);
+    rows_scanned = batch->rows_scanned;
+  } else {
+    RETURN_NOT_OK(ScanNextBatch(scanner.get(), batch_size_bytes, req->close_scanner(),
+                                result_collector, &rows_scanned, error_code));
   }
 
   scoped_refptr<TabletReplica> replica = scanner->tablet_replica();
@@ -3197,10 +4012,19 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
     tablet->UpdateLastReadTime();
   }
 
-  *has_more_results = !req->close_scanner() && iter->HasNext() &&
-      !scanner->has_fulfilled_limit();
+  *has_more_results = !req->close_scanner() && HasMoreRows(scanner.get());
   if (*has_more_results) {
     unreg_scanner.Cancel();
+    if (FLAGS_scanner_prefetch_batches && result_collector->SupportsPrefetching()) {
+      // The batch is computed once this request releases the scanner, while
+      // its response is on the wire.
+      ScannerManager* manager = server_->scanner_manager();
+      const uint32_t call_seq_id = scanner->call_seq_id();
+      WARN_NOT_OK(manager->SubmitPrefetch([manager, scanner, call_seq_id, batch_size_bytes]() {
+                    PrefetchBatch(manager, scanner, call_seq_id, batch_size_bytes);
+                  }),
+                  "could not prefetch the next batch of scanner " + scanner->id());
+    }
   } else {
     VLOG(2) << "Scanner " << scanner->id() << " complete: removing...";
   }
@@ -3226,6 +4050,7 @@ Status TabletServiceImpl::HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
                                                const Schema& projection,
                                                Tablet* tablet,
                                                TimeManager* time_manager,
+                                               tablet::RowSetChecksum* known_rowset_checksums,
                                                unique_ptr<RowwiseIterator>* iter,
                                                optional<Timestamp>* snap_start_timestamp,
                                                Timestamp* snap_timestamp,
@@ -3256,6 +4081,22 @@ Status TabletServiceImpl::HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
     }
   }
 
+  if (scan_pb.has_max_staleness_usec()) {
+    if (read_mode != READ_AT_SNAPSHOT ||
+        scan_pb.has_snap_timestamp() ||
+        scan_pb.has_snap_start_timestamp()) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return Status::InvalidArgument("bounded staleness is only supported in "
+                                     "READ_AT_SNAPSHOT read mode without a "
+                                     "snapshot timestamp");
+    }
+    if (!server_->clock()->HasPhysicalComponent()) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return Status::NotSupported("bounded staleness requires a clock with "
+                                  "a physical component");
+    }
+  }
+
   // Based on the read mode, pick a timestamp and verify it.
   Timestamp tmp_snap_timestamp;
   Status s = PickAndVerifyTimestamp(scan_pb, tablet, &tmp_snap_timestamp);
@@ -3264,6 +4105,22 @@ Status TabletServiceImpl::HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
     return s.CloneAndPrepend("cannot verify timestamp");
   }
 
+  // With bounded staleness, read at the safe time if it's recent enough,
+  // rather than waiting for the safe time to reach the current time: on a
+  // follower, that might take up to a heartbeat period.
+  if (scan_pb.has_max_staleness_usec()) {
+    const uint64_t staleness_usec = std::min<uint64_t>(
+        scan_pb.max_staleness_usec(),
+        HybridClock::GetPhysicalValueMicros(tmp_snap_timestamp));
+    const Timestamp oldest_allowed = HybridClock::AddPhysicalTimeToTimestamp(
+        tmp_snap_timestamp,
+        MonoDelta::FromMicroseconds(-static_cast<int64_t>(staleness_usec)));
+    const Timestamp safe_time = time_manager->GetSafeTime();
+    tmp_snap_timestamp = std::min(tmp_snap_timestamp, std::max(safe_time, oldest_allowed));
+    TRACE("Picked bounded staleness snapshot timestamp $0",
+          server_->clock()->Stringify(tmp_snap_timestamp));
+  }
+
   // Reduce the client's deadline by a few msecs to allow for overhead.
   const MonoTime client_deadline =
       rpc_context->GetClientDeadline() - MonoDelta::FromMilliseconds(10);
@@ -3311,6 +4168,8 @@ Status TabletServiceImpl::HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
   opts.projection = &projection;
   opts.snap_to_include = snap;
   opts.order = scan_pb.order_mode();
+  opts.known_rowset_checksums = known_rowset_checksums;
+  SetRowsetParallelism(server_->scanner_manager(), &opts);
 
   optional<Timestamp> tmp_snap_start_timestamp;
   if (scan_pb.has_snap_start_timestamp()) {
@@ -17,12 +17,14 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include "kudu/consensus/consensus.service.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/tserver/request_capture.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/tserver/tserver_admin.service.h"
 #include "kudu/tserver/tserver_service.service.h"
@@ -40,6 +42,7 @@ namespace kudu {
 class RowwiseIterator;
 class Schema;
 class Status;
+class ThreadPool;
 class Timestamp;
 
 namespace server {
@@ -78,6 +81,7 @@ class RpcContext;
 namespace tablet {
 class Tablet;
 class TabletReplica;
+struct RowSetChecksum;
 } // namespace tablet
 
 namespace tserver {
@@ -92,6 +96,8 @@ class CreateTabletRequestPB;
 class CreateTabletResponsePB;
 class DeleteTabletRequestPB;
 class DeleteTabletResponsePB;
+class GetChangesRequestPB;
+class GetChangesResponsePB;
 class ParticipantRequestPB;
 class ParticipantResponsePB;
 class QuiesceTabletServerRequestPB;
@@ -121,6 +127,13 @@ class TabletServiceImpl : public TabletServerServiceIf {
                             google::protobuf::Message* resp,
                             rpc::RpcContext* context) override;
 
+  // GetChanges returns every column of the rows written to a tablet, so if
+  // enforcing access control, we require the super-user role rather than
+  // checking table privileges, and authorize as a client otherwise.
+  bool AuthorizeGetChanges(const google::protobuf::Message* req,
+                           google::protobuf::Message* resp,
+                           rpc::RpcContext* context) override;
+
   void Ping(const PingRequestPB* req,
             PingResponsePB* resp,
             rpc::RpcContext* context) override;
@@ -128,6 +141,9 @@ class TabletServiceImpl : public TabletServerServiceIf {
   void Write(const WriteRequestPB* req, WriteResponsePB* resp,
              rpc::RpcContext* context) override;
 
+  void MultiWrite(const MultiWriteRequestPB* req, MultiWriteResponsePB* resp,
+                  rpc::RpcContext* context) override;
+
   void Scan(const ScanRequestPB* req,
             ScanResponsePB* resp,
             rpc::RpcContext* context) override;
@@ -148,11 +164,44 @@ class TabletServiceImpl : public TabletServerServiceIf {
                 ChecksumResponsePB* resp,
                 rpc::RpcContext* context) override;
 
+  void GetChanges(const GetChangesRequestPB* req,
+                  GetChangesResponsePB* resp,
+                  rpc::RpcContext* context) override;
+
   bool SupportsFeature(uint32_t feature) const override;
 
   void Shutdown() override;
 
  private:
+  // Checks whether the write 'req' to 'replica' may be admitted, given the
+  // throttling, quotas, memory pressure and load of the server. Returns
+  // ServiceUnavailable if it should be retried later.
+  //
+  // If 'memory_pressure_delayed' is true, the admission of the write was
+  // already delayed by MaybeDelayWrite(), and it is only rejected for memory
+  // pressure if the hard memory limit is exceeded.
+  Status CheckWriteAdmission(const WriteRequestPB& req,
+                             tablet::TabletReplica* replica,
+                             tablet::Tablet* tablet,
+                             const rpc::RpcContext* context,
+                             bool memory_pressure_delayed,
+                             TabletServerErrorPB::Code* error_code);
+
+  // If the memory consumption of the process is between its soft and hard
+  // limits, schedules 'handle_write' to run on 'delayed_write_pool_' once the
+  // admission delay for that consumption passed, and returns true. Returns
+  // false if the write should be handled right away, e.g. if its deadline
+  // doesn't allow for the delay. If the server shuts down in the meantime, the
+  // write is responded to with an error instead.
+  bool MaybeDelayWrite(rpc::RpcContext* context, std::function<void()> handle_write);
+
+  // Handle the Write and MultiWrite RPCs, once MaybeDelayWrite() delayed them
+  // or not, as indicated by 'memory_pressure_delayed'.
+  void HandleWrite(const WriteRequestPB* req, WriteResponsePB* resp,
+                   rpc::RpcContext* context, bool memory_pressure_delayed);
+  void HandleMultiWrite(const MultiWriteRequestPB* req, MultiWriteResponsePB* resp,
+                        rpc::RpcContext* context, bool memory_pressure_delayed);
+
   Status HandleNewScanRequest(tablet::TabletReplica* tablet_replica,
                               const ScanRequestPB* req,
                               const rpc::RpcContext* rpc_context,
@@ -170,12 +219,15 @@ class TabletServiceImpl : public TabletServerServiceIf {
 
   // Handle READ_AT_SNAPSHOT and READ_YOUR_WRITES scans.
   // Returns the opened row iterator, the start timestamp of a snapshot scan,
-  // if applicable, and the ending timestamp of a scan.
+  // if applicable, and the ending timestamp of a scan. The iterator adds the
+  // checksums of the rowsets it leaves out to 'known_rowset_checksums', if
+  // not null (see tablet::RowIteratorOptions).
   Status HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
                               const rpc::RpcContext* rpc_context,
                               const Schema& projection,
                               tablet::Tablet* tablet,
                               consensus::TimeManager* time_manager,
+                              tablet::RowSetChecksum* known_rowset_checksums,
                               std::unique_ptr<RowwiseIterator>* iter,
                               std::optional<Timestamp>* snap_start_timestamp,
                               Timestamp* snap_timestamp,
@@ -201,6 +253,18 @@ class TabletServiceImpl : public TabletServerServiceIf {
   // Counter to track number of rejected write requests while op apply queue
   // was overloaded.
   scoped_refptr<Counter> num_op_apply_queue_rejections_;
+
+  // Counter to track number of write requests whose admission was delayed
+  // under memory pressure.
+  scoped_refptr<Counter> num_memory_pressure_write_delays_;
+
+  // Handles the writes delayed under memory pressure once their delay passed,
+  // so that they don't run on the reactor threads. Shared with the reactor
+  // tasks scheduling them, which may outlive the service.
+  std::shared_ptr<ThreadPool> delayed_write_pool_;
+
+  // Captures a sample of the write and scan requests, if enabled.
+  RequestCapture request_capture_;
 };
 
 class TabletServiceAdminImpl : public TabletServerAdminServiceIf {
@@ -38,6 +38,7 @@
 #include "kudu/consensus/metadata.pb.h"
 #include "kudu/consensus/opid_util.h"
 #include "kudu/consensus/raft_consensus.h"
+#include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/master/master.pb.h"
@@ -50,6 +51,8 @@
 #include "kudu/tserver/heartbeater.h"
 #include "kudu/tserver/mini_tablet_server.h"
 #include "kudu/tserver/tablet_server.h"
+#include "kudu/util/env.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/net/net_util.h"
@@ -90,9 +93,6 @@ using std::vector;
 using strings::Substitute;
 
 namespace kudu {
-
-class FsManager;
-
 namespace tserver {
 
 class TsTabletManagerTest : public KuduTest {
@@ -223,6 +223,30 @@ TEST_F(TsTabletManagerTest, TestCreateTablet) {
   ASSERT_EQ(7200, replica2->tablet()->metadata()->extra_config()->history_max_age_sec());
 }
 
+// Test that the tablets accessed before a restart are saved to be opened first,
+// and that they remain saved until accessed again.
+TEST_F(TsTabletManagerTest, TestHotTablets) {
+  scoped_refptr<TabletReplica> replica;
+  ASSERT_OK(CreateNewTablet("tablet-1", schema_, true, nullopt, nullopt, nullptr));
+  ASSERT_OK(CreateNewTablet("tablet-2", schema_, true, nullopt, nullopt, &replica));
+  NO_FATALS(InsertTestRows(replica->tablet(), 10));
+  replica.reset();
+
+  const string path = fs_manager_->GetHotTabletsPath();
+  for (int i = 0; i < 2; i++) {
+    mini_server_->Shutdown();
+    faststring contents;
+    ASSERT_OK(ReadFileToString(env_, path, &contents));
+    ASSERT_EQ("tablet-2\n", contents.ToString());
+
+    mini_server_.reset(new MiniTabletServer(GetTestPath("TsTabletManagerTest-fsroot"),
+                                            HostPort("127.0.0.1", 0)));
+    ASSERT_OK(mini_server_->Start());
+    ASSERT_OK(mini_server_->WaitStarted());
+    fs_manager_ = mini_server_->server()->fs_manager();
+  }
+}
+
 static void AssertMonotonicReportSeqno(int64_t* report_seqno,
                                        const TabletReportPB &report) {
   ASSERT_LT(*report_seqno, report.sequence_number());
@@ -17,15 +17,19 @@
 
 #include "kudu/tserver/ts_tablet_manager.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <optional>
 #include <ostream>
 #include <set>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -50,13 +54,16 @@
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/split.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/master/master.pb.h"
 #include "kudu/rpc/result_tracker.h"
 #include "kudu/server/rpc_server.h"
 #include "kudu/tablet/metadata.pb.h"
+#include "kudu/tablet/tablet.h"
 #include "kudu/tablet/tablet_bootstrap.h"
 #include "kudu/tablet/tablet_metadata.h"
+#include "kudu/tablet/tablet_metrics.h"
 #include "kudu/tablet/tablet_replica.h"
 #include "kudu/tablet/txn_coordinator.h"
 #include "kudu/transactions/txn_status_manager.h"
@@ -64,6 +71,8 @@
 #include "kudu/tserver/heartbeater.h"
 #include "kudu/tserver/tablet_server.h"
 #include "kudu/util/debug/trace_event.h"
+#include "kudu/util/env.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/fault_injection.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
@@ -76,12 +85,6 @@
 #include "kudu/util/timer.h"
 #include "kudu/util/trace.h"
 
-namespace kudu {
-namespace tablet {
-class Tablet;
-}  // namespace tablet
-}  // namespace kudu
-
 DEFINE_int32(num_tablets_to_copy_simultaneously, 10,
              "Number of threads available to copy tablets from remote servers.");
 TAG_FLAG(num_tablets_to_copy_simultaneously, advanced);
@@ -120,6 +123,18 @@ DEFINE_int32(txn_participant_registration_pool_num_threads, 10,
 TAG_FLAG(txn_participant_registration_pool_num_threads, advanced);
 TAG_FLAG(txn_participant_registration_pool_num_threads, experimental);
 
+DEFINE_int32(hot_tablets_history_size, 1000,
+             "The number of tablets most recently read or written to the tablet server "
+             "saves the ids of under --fs_metadata_dir, to open them first after it "
+             "restarts. If 0, the tablets are opened starting with those with the "
+             "largest WALs only.");
+TAG_FLAG(hot_tablets_history_size, advanced);
+
+DEFINE_int32(hot_tablets_save_interval_secs, 600,
+             "How often to save the ids of the tablets most recently read or written "
+             "to, in seconds. They're also saved when the tablet server shuts down.");
+TAG_FLAG(hot_tablets_save_interval_secs, advanced);
+
 DEFINE_int32(tablet_start_warn_threshold_ms, 500,
              "If a tablet takes more than this number of millis to start, issue "
              "a warning with a trace.");
@@ -191,6 +206,16 @@ DEFINE_int32(txn_participant_registration_inject_latency_ms, 0,
 TAG_FLAG(txn_participant_registration_inject_latency_ms, runtime);
 TAG_FLAG(txn_participant_registration_inject_latency_ms, unsafe);
 
+DEFINE_int32(tablet_flush_on_shutdown_budget_ms, 0,
+             "If positive, upon shutdown the tablet server flushes the in-memory "
+             "stores of its tablets and garbage-collects their WALs for up to this "
+             "many milliseconds before shutting the tablets down, so that the next "
+             "start has less to replay from the WALs. The tablets with the most data "
+             "in memory are flushed first. Flushes in progress once the budget runs "
+             "out are completed.");
+TAG_FLAG(tablet_flush_on_shutdown_budget_ms, advanced);
+TAG_FLAG(tablet_flush_on_shutdown_budget_ms, runtime);
+
 DEFINE_bool(tablet_bootstrap_skip_opening_tablet_for_testing, false,
             "Whether to skip opening tablet when bootstrap. "
             "Only for testing.");
@@ -301,6 +326,8 @@ using std::optional;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unordered_map;
+using std::unordered_set;
 using std::vector;
 using strings::Substitute;
 
@@ -318,6 +345,29 @@ bool ValidateUpdateTabletStatsInterval() {
 
   return true;
 }
+
+// Returns the seconds since the tablet of 'replica' was last read or written
+// to, or nullopt if it wasn't since it was opened.
+optional<uint64_t> SecondsSinceLastAccess(const TabletReplica& replica) {
+  const shared_ptr<Tablet> tablet = replica.shared_tablet();
+  if (!tablet || !tablet->metrics()) {
+    return nullopt;
+  }
+  const auto* metrics = tablet->metrics();
+  const bool read = metrics->scans_started->value() > 0;
+  const bool written = metrics->rows_inserted->value() + metrics->rows_upserted->value() +
+                       metrics->rows_updated->value() + metrics->rows_deleted->value() > 0;
+  if (read && written) {
+    return std::min(tablet->LastReadElapsedSeconds(), tablet->LastWriteElapsedSeconds());
+  }
+  if (read) {
+    return tablet->LastReadElapsedSeconds();
+  }
+  if (written) {
+    return tablet->LastWriteElapsedSeconds();
+  }
+  return nullopt;
+}
 } // anonymous namespace
 
 GROUP_FLAG_VALIDATOR(update_tablet_stats_interval_ms, ValidateUpdateTabletStatsInterval);
@@ -495,6 +545,9 @@ Status TSTabletManager::Init(Timer* start_tablets,
   InitLocalRaftPeerPB();
 
   vector<scoped_refptr<TabletMetadata>> metas(tablet_ids.size());
+  // The on-disk size of the WAL of each tablet, to bootstrap the tablets with
+  // the most to replay first.
+  vector<uint64_t> wal_sizes(tablet_ids.size());
 
   // First, load all of the tablet metadata. We do this before we start
   // submitting the actual OpenTablet() tasks so that we don't have to compete
@@ -512,7 +565,7 @@ Status TSTabletManager::Init(Timer* start_tablets,
       }
 
       RETURN_NOT_OK(open_tablet_pool_->Submit([this, i, tablet_ids, &total_loaded_count,
-                                               &success_loaded_count, &metas,
+                                               &success_loaded_count, &metas, &wal_sizes,
                                                &seen_error, &first_error]() {
         const string& tablet_id = tablet_ids[i];
         Status s;
@@ -539,6 +592,12 @@ Status TSTabletManager::Init(Timer* start_tablets,
 
           success_loaded_count++;
           metas[i] = meta;
+
+          const Status size_s = fs_manager_->env()->GetFileSizeOnDiskRecursively(
+              fs_manager_->GetTabletWalDir(tablet_id), &wal_sizes[i]);
+          if (PREDICT_FALSE(!size_s.ok() && !size_s.IsNotFound())) {
+            WARN_NOT_OK(size_s, Substitute("could not get WAL size of tablet $0", tablet_id));
+          }
         } while (false);
 
         if (!s.ok()) {
@@ -559,13 +618,48 @@ Status TSTabletManager::Init(Timer* start_tablets,
     *tablets_total = success_loaded_count.load();
   }
 
-  // Now submit the "Open" task for each.
+  // Now submit the "Open" task for each, starting with the tablets which were
+  // the most recently accessed before the restart, so that the serving
+  // workload resumes first. The others follow starting with the tablets with
+  // the largest WALs: their bootstrap takes the longest, so starting them last
+  // would delay the end of the whole startup.
   METRIC_tablets_num_total_startup.Instantiate(server_->metric_entity(), *tablets_total);
   *tablets_processed = 0;
   int registered_count = 0;
   if (PREDICT_TRUE(!FLAGS_tablet_bootstrap_skip_opening_tablet_for_testing)) {
     SCOPED_LOG_TIMING(INFO, Substitute("register tablets"));
-    for (const auto& meta : metas) {
+    unordered_map<string, size_t> hot_ranks;
+    {
+      std::lock_guard<std::mutex> l(hot_tablets_lock_);
+      WARN_NOT_OK(LoadHotTabletsUnlocked(), "unable to load the ids of the hot tablets");
+      for (size_t i = 0; i < hot_tablets_.size(); i++) {
+        hot_ranks.emplace(hot_tablets_[i], i);
+      }
+    }
+    {
+      // The tablets accessed shortly after the restart aren't representative.
+      std::lock_guard<rw_spinlock> l(lock_update_);
+      next_hot_tablets_save_time_ = MonoTime::Now() +
+          MonoDelta::FromSeconds(std::max(FLAGS_hot_tablets_save_interval_secs, 0));
+    }
+    vector<size_t> hot_rank_by_idx(metas.size(), hot_ranks.size());
+    for (size_t i = 0; i < metas.size(); i++) {
+      if (metas[i].get()) {
+        hot_rank_by_idx[i] = FindWithDefault(hot_ranks, metas[i]->tablet_id(),
+                                             hot_ranks.size());
+      }
+    }
+    vector<size_t> open_order(metas.size());
+    std::iota(open_order.begin(), open_order.end(), 0);
+    std::stable_sort(open_order.begin(), open_order.end(),
+                     [&hot_rank_by_idx, &wal_sizes](size_t a, size_t b) {
+      if (hot_rank_by_idx[a] != hot_rank_by_idx[b]) {
+        return hot_rank_by_idx[a] < hot_rank_by_idx[b];
+      }
+      return wal_sizes[a] > wal_sizes[b];
+    });
+    for (size_t idx : open_order) {
+      const auto& meta = metas[idx];
       if (!meta.get()) {
         continue;
       }
@@ -1452,6 +1546,7 @@ void TSTabletManager::IncrementTabletsProcessed(int tablets_total,
 }
 
 void TSTabletManager::Shutdown() {
+  bool was_running = false;
   {
     std::lock_guard<RWMutex> lock(lock_);
     switch (state_) {
@@ -1466,6 +1561,7 @@ void TSTabletManager::Shutdown() {
       case MANAGER_INITIALIZING:
       case MANAGER_RUNNING: {
         LOG(INFO) << "Shutting down tablet manager...";
+        was_running = state_ == MANAGER_RUNNING;
         state_ = MANAGER_QUIESCING;
         break;
       }
@@ -1475,6 +1571,11 @@ void TSTabletManager::Shutdown() {
     }
   }
 
+  // Save the hot tablets while they're still running.
+  if (was_running) {
+    WARN_NOT_OK(SaveHotTablets(), "unable to save the ids of the hot tablets");
+  }
+
   // Stop copying tablets.
   // TODO(mpercy): Cancel all outstanding tablet copy tasks (KUDU-1795).
   if (tablet_copy_pool_ != nullptr) {
@@ -1509,6 +1610,11 @@ void TSTabletManager::Shutdown() {
   vector<scoped_refptr<TabletReplica>> replicas_to_shutdown;
   GetTabletReplicasImpl(&replicas_to_shutdown);
 
+  if (FLAGS_tablet_flush_on_shutdown_budget_ms > 0) {
+    FlushTabletsForShutdown(replicas_to_shutdown,
+                            MonoDelta::FromMilliseconds(FLAGS_tablet_flush_on_shutdown_budget_ms));
+  }
+
   for (const scoped_refptr<TabletReplica>& replica : replicas_to_shutdown) {
     replica->Shutdown();
   }
@@ -1539,6 +1645,79 @@ void TSTabletManager::Shutdown() {
   }
 }
 
+void TSTabletManager::FlushTabletsForShutdown(
+    const vector<scoped_refptr<TabletReplica>>& replicas, const MonoDelta& budget) {
+  const MonoTime deadline = MonoTime::Now() + budget;
+  LOG_TIMING(INFO, Substitute("flushing tablets for shutdown")) {
+    // Flush the tablets with the most to replay first.
+    vector<std::pair<size_t, scoped_refptr<TabletReplica>>> to_flush;
+    for (const auto& replica : replicas) {
+      const auto tablet = replica->shared_tablet();
+      if (replica->state() != tablet::RUNNING || !tablet) {
+        continue;
+      }
+      const size_t mem_size = tablet->MemRowSetSize() + tablet->DeltaMemStoresSize();
+      if (!tablet->MemRowSetEmpty() || !tablet->DeltaMemRowSetEmpty()) {
+        to_flush.emplace_back(mem_size, replica);
+      }
+    }
+    std::stable_sort(to_flush.begin(), to_flush.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    int max_threads = FLAGS_num_tablets_to_open_simultaneously;
+    if (max_threads == 0) {
+      max_threads = fs_manager_->GetDataRootDirs().size();
+    }
+    unique_ptr<ThreadPool> flush_pool;
+    Status s = ThreadPoolBuilder("tablet-shutdown-flush")
+        .set_max_threads(max_threads)
+        .Build(&flush_pool);
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG(WARNING) << "could not start the threads flushing tablets for shutdown: "
+                   << s.ToString();
+      return;
+    }
+    std::atomic<int> num_flushed = 0;
+    for (const auto& entry : to_flush) {
+      const auto& replica = entry.second;
+      s = flush_pool->Submit([replica, deadline, &num_flushed]() {
+        if (MonoTime::Now() >= deadline) {
+          return;
+        }
+        const auto tablet = replica->shared_tablet();
+        if (!tablet) {
+          return;
+        }
+        Status flush_s = tablet->Flush();
+        if (flush_s.ok()) {
+          flush_s = tablet->FlushAllDMS();
+        }
+        if (flush_s.ok()) {
+          flush_s = replica->RunLogGC();
+        }
+        if (flush_s.ok()) {
+          num_flushed++;
+        } else {
+          LOG(WARNING) << LogPrefix(replica->tablet_id())
+                       << "could not flush for shutdown: " << flush_s.ToString();
+        }
+      });
+      if (PREDICT_FALSE(!s.ok())) {
+        LOG(WARNING) << "could not schedule the flush of a tablet for shutdown: "
+                     << s.ToString();
+        break;
+      }
+    }
+    if (!flush_pool->WaitUntil(deadline)) {
+      LOG(WARNING) << "ran out of time flushing tablets for shutdown";
+    }
+    // Only the flushes in progress are completed by the shutdown.
+    flush_pool->Shutdown();
+    LOG(INFO) << Substitute("Flushed $0/$1 tablets for shutdown",
+                            num_flushed.load(), to_flush.size());
+  }
+}
+
 void TSTabletManager::RegisterTablet(const string& tablet_id,
                                      const scoped_refptr<TabletReplica>& replica,
                                      RegisterTabletReplicaMode mode) {
@@ -2018,6 +2197,13 @@ void TSTabletManager::UpdateTabletStatsIfNecessary() {
   }
   next_update_time_ = MonoTime::Now() +
       MonoDelta::FromMilliseconds(FLAGS_update_tablet_stats_interval_ms);
+  bool save_hot_tablets = false;
+  if (FLAGS_hot_tablets_save_interval_secs > 0 &&
+      MonoTime::Now() >= next_hot_tablets_save_time_) {
+    next_hot_tablets_save_time_ = MonoTime::Now() +
+        MonoDelta::FromSeconds(FLAGS_hot_tablets_save_interval_secs);
+    save_hot_tablets = true;
+  }
   try_lock.unlock();
 
   // Update the tablet stats and collect the dirty tablets.
@@ -2031,6 +2217,82 @@ void TSTabletManager::UpdateTabletStatsIfNecessary() {
   if (!dirty_tablets.empty()) {
     MarkTabletsDirty(dirty_tablets, "The tablet statistics have been changed");
   }
+
+  if (save_hot_tablets) {
+    WARN_NOT_OK(SaveHotTablets(), "unable to save the ids of the hot tablets");
+  }
+}
+
+Status TSTabletManager::LoadHotTabletsUnlocked() {
+  hot_tablets_.clear();
+  if (FLAGS_hot_tablets_history_size <= 0) {
+    return Status::OK();
+  }
+  faststring contents;
+  const string path = fs_manager_->GetHotTabletsPath();
+  Status s = ReadFileToString(fs_manager_->GetEnv(), path, &contents);
+  if (s.IsNotFound()) {
+    return Status::OK();
+  }
+  RETURN_NOT_OK_PREPEND(s, Substitute("unable to read $0", path));
+  vector<string> hot_tablets = strings::Split(contents.ToString(), "\n", strings::SkipEmpty());
+  hot_tablets_ = std::move(hot_tablets);
+  return Status::OK();
+}
+
+Status TSTabletManager::SaveHotTablets() {
+  if (FLAGS_hot_tablets_history_size <= 0) {
+    return Status::OK();
+  }
+  vector<scoped_refptr<TabletReplica>> replicas;
+  GetTabletReplicas(&replicas);
+  vector<std::pair<uint64_t, string>> accessed;
+  unordered_set<string> tablet_ids;
+  for (const auto& replica : replicas) {
+    tablet_ids.emplace(replica->tablet_id());
+    const auto secs = SecondsSinceLastAccess(*replica);
+    if (secs) {
+      accessed.emplace_back(*secs, replica->tablet_id());
+    }
+  }
+  std::sort(accessed.begin(), accessed.end());
+
+  std::lock_guard<std::mutex> l(hot_tablets_lock_);
+  // The tablets accessed since the restart come first, followed by those hot
+  // before it which weren't accessed yet, so that the history isn't lost if
+  // the tablet server restarts again shortly.
+  vector<string> hot_tablets;
+  unordered_set<string> saved;
+  const size_t max_size = FLAGS_hot_tablets_history_size;
+  for (const auto& [secs, tablet_id] : accessed) {
+    if (hot_tablets.size() == max_size) {
+      break;
+    }
+    hot_tablets.emplace_back(tablet_id);
+    saved.emplace(tablet_id);
+  }
+  for (const auto& tablet_id : hot_tablets_) {
+    if (hot_tablets.size() == max_size) {
+      break;
+    }
+    if (ContainsKey(tablet_ids, tablet_id) && !ContainsKey(saved, tablet_id)) {
+      hot_tablets.emplace_back(tablet_id);
+    }
+  }
+
+  faststring contents;
+  for (const auto& tablet_id : hot_tablets) {
+    contents.append(tablet_id);
+    contents.push_back('\n');
+  }
+  Env* env = fs_manager_->GetEnv();
+  const string path = fs_manager_->GetHotTabletsPath();
+  const string tmp_path = path + ".tmp";
+  RETURN_NOT_OK_PREPEND(WriteStringToFileSync(env, contents, tmp_path),
+                        Substitute("unable to write $0", tmp_path));
+  RETURN_NOT_OK(env->RenameFile(tmp_path, path));
+  hot_tablets_ = std::move(hot_tablets);
+  return Status::OK();
 }
 
 Status TSTabletManager::SchedulePreliminaryTasksForTxnWrite(
@@ -22,6 +22,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -295,6 +296,14 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
       MonoTime deadline,
       tablet::RegisteredTxnCallback began_txn_cb);
 
+  // Flushes the in-memory stores of 'replicas' and garbage-collects their WALs,
+  // starting with the replicas with the most data in memory, so that the next
+  // start has less to replay. No flush starts past 'budget'. Used upon
+  // shutdown if --tablet_flush_on_shutdown_budget_ms is set.
+  void FlushTabletsForShutdown(
+      const std::vector<scoped_refptr<tablet::TabletReplica>>& replicas,
+      const MonoDelta& budget);
+
   // Returns Status::OK() iff state_ == MANAGER_RUNNING.
   Status CheckRunningUnlocked(TabletServerErrorPB::Code* error_code) const;
 
@@ -374,6 +383,15 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   void CreateReportedTabletPB(const scoped_refptr<tablet::TabletReplica>& replica,
                               master::ReportedTabletPB* reported_tablet) const;
 
+  // Loads the ids of the tablets most recently accessed before the restart,
+  // hottest first, into 'hot_tablets_'.
+  Status LoadHotTabletsUnlocked();
+
+  // Saves the ids of the tablets most recently accessed, hottest first,
+  // keeping those of 'hot_tablets_' which weren't accessed yet after them,
+  // up to --hot_tablets_history_size.
+  Status SaveHotTablets();
+
   // Handle the case on startup where we find a tablet that is not in
   // TABLET_DATA_READY state. Generally, we tombstone the replica.
   Status HandleNonReadyTabletOnStartup(const scoped_refptr<tablet::TabletMetadata>& meta);
@@ -490,6 +508,15 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   mutable rw_spinlock lock_update_;
   MonoTime next_update_time_;
 
+  // When to next save the hot tablets. Protected by 'lock_update_'.
+  MonoTime next_hot_tablets_save_time_;
+
+  // Protects 'hot_tablets_', and serializes the saving of the hot tablets.
+  std::mutex hot_tablets_lock_;
+
+  // The ids of the hot tablets, as last loaded or saved in order.
+  std::vector<std::string> hot_tablets_;
+
   // Keep track of number of tablets opened/attempted to be opened
   // during server startup
   scoped_refptr<AtomicGauge<uint32_t>> tablets_num_opened_startup_;
@@ -30,8 +30,9 @@
 #include <utility>
 #include <vector>
 
-#include <gflags/gflags_declare.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <rapidjson/document.h>
 
 #include "kudu/common/common.pb.h"
 #include "kudu/common/iterator_stats.h"
@@ -62,6 +63,7 @@
 #include "kudu/tserver/tablet_server.h"
 #include "kudu/tserver/ts_tablet_manager.h"
 #include "kudu/util/easy_json.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/maintenance_manager.h"
 #include "kudu/util/maintenance_manager.pb.h"
 #include "kudu/util/monotime.h"
@@ -90,12 +92,21 @@ using kudu::tablet::TabletStatusPB;
 using kudu::tablet::Op;
 using std::endl;
 using std::map;
+using std::pair;
 using std::ostringstream;
 using std::shared_ptr;
 using std::string;
 using std::vector;
 using strings::Substitute;
 
+DEFINE_int32(tserver_tablets_page_cache_ttl_ms, 0,
+             "How long the /tablets page of the web UI is served from a cached "
+             "rendering, in milliseconds, rather than rendered anew by visiting "
+             "every tablet replica for each request. Useful on servers with many "
+             "replicas whose web UI is scraped frequently. 0 disables the cache.");
+TAG_FLAG(tserver_tablets_page_cache_ttl_ms, advanced);
+TAG_FLAG(tserver_tablets_page_cache_ttl_ms, runtime);
+
 DECLARE_int32(completed_scan_history_count);
 DECLARE_int32(slow_scan_history_count);
 namespace kudu {
@@ -191,6 +202,43 @@ bool LoadTablet(TabletServer* tserver,
       !TabletBootstrapping(*replica, *tablet_id, resp);
 }
 
+// Returns the range of the indexes of the replicas to show out of 'size'
+// ones, given the 'offset' and 'limit' arguments of the /tablets page.
+pair<size_t, size_t> PageRange(size_t size, int64_t offset, int64_t limit) {
+  const size_t begin = std::min<size_t>(std::max<int64_t>(offset, 0), size);
+  const size_t end = limit < 0 ? size : std::min<size_t>(begin + limit, size);
+  return { begin, end };
+}
+
+// Sets the range of the replicas shown out of the 'size' ones of a
+// list of the /tablets page, unless they're all shown.
+// Note the range is set to "none" if no replica is shown.
+void SetPageRange(size_t size, pair<size_t, size_t> range, EasyJson* replicas_json) {
+  if (range.first == range.second) {
+    (*replicas_json)["page_range"] = "none";
+  } else if (range.first != 0 || range.second != size) {
+    (*replicas_json)["page_range"] = Substitute("$0-$1", range.first + 1, range.second);
+  }
+}
+
+// Trims the details of the replicas of the lists of the /tablets page
+// rendered in 'output' to the specified page of them.
+void TrimTabletsPage(int64_t offset, int64_t limit, EasyJson* output) {
+  for (const char* list : { "live_replicas", "tombstoned_replicas" }) {
+    auto& root = output->value();
+    if (!root.IsObject() || !root.HasMember(list)) {
+      continue;
+    }
+    auto& replicas = root[list]["replicas"];
+    const size_t size = replicas.Size();
+    const auto range = PageRange(size, offset, limit);
+    replicas.Erase(replicas.Begin() + range.second, replicas.End());
+    replicas.Erase(replicas.Begin(), replicas.Begin() + range.first);
+    EasyJson replicas_json = (*output)[list];
+    SetPageRange(size, range, &replicas_json);
+  }
+}
+
 } // anonymous namespace
 
 TabletServerPathHandlers::~TabletServerPathHandlers() {
@@ -318,9 +366,24 @@ void TabletServerPathHandlers::HandleTransactionsPage(const Webserver::WebReques
   }
 }
 
-void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& /*req*/,
+void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& req,
                                                  Webserver::WebResponse* resp) {
-  EasyJson* output = &resp->output;
+  // The details of the replicas can be requested page by page.
+  const int64_t offset = ParseLeadingInt64Value(
+      FindWithDefault(req.parsed_args, "offset", "0").c_str(), 0);
+  const int64_t limit = ParseLeadingInt64Value(
+      FindWithDefault(req.parsed_args, "limit", "-1").c_str(), -1);
+  const int32_t cache_ttl_ms = FLAGS_tserver_tablets_page_cache_ttl_ms;
+  if (cache_ttl_ms <= 0) {
+    RenderTabletsPage(offset, limit, &resp->output);
+    return;
+  }
+  tablets_page_cache_.Get(MonoDelta::FromMilliseconds(cache_ttl_ms), &resp->output);
+  TrimTabletsPage(offset, limit, &resp->output);
+}
+
+void TabletServerPathHandlers::RenderTabletsPage(int64_t offset, int64_t limit,
+                                                 EasyJson* output) {
   vector<scoped_refptr<TabletReplica>> replicas;
   tserver_->tablet_manager()->GetTabletReplicas(&replicas);
 
@@ -341,8 +404,8 @@ void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& /*
   // in 'replicas'
   const auto& local_uuid = tserver_->instance_pb().permanent_uuid();
   auto make_replicas_json =
-      [&local_uuid](const vector<scoped_refptr<TabletReplica>>& replicas,
-                    EasyJson* replicas_json) {
+      [&local_uuid, offset, limit](const vector<scoped_refptr<TabletReplica>>& replicas,
+                                   EasyJson* replicas_json) {
     map<string, int> statuses;
     for (const scoped_refptr<TabletReplica>& replica : replicas) {
       statuses[TabletStatePB_Name(replica->state())]++;
@@ -357,8 +420,11 @@ void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& /*
     }
     (*replicas_json)["total_count"] = std::to_string(replicas.size());
 
+    const auto range = PageRange(replicas.size(), offset, limit);
+    SetPageRange(replicas.size(), range, replicas_json);
     EasyJson details_json = replicas_json->Set("replicas", EasyJson::kArray);
-    for (const scoped_refptr<TabletReplica>& replica : replicas) {
+    for (size_t i = range.first; i < range.second; i++) {
+      const auto& replica = replicas[i];
       EasyJson replica_json = details_json.PushBack(EasyJson::kObject);
       const auto& tmeta = replica->tablet_metadata();
       const SchemaPtr schema_ptr = tmeta->schema();
@@ -580,6 +646,17 @@ void ScanToJson(const SharedScanDescriptor& scan, EasyJson* json) {
   json->Set("sys_secs",
             HumanReadableElapsedTime::ToShortString(cpu_times.system_cpu_seconds()));
 
+  const auto& resources = scan->resource_stats;
+  json->Set("cache_hit_bytes", HumanReadableNumBytes::ToString(resources.cfile_cache_hit_bytes));
+  json->Set("cache_miss_bytes",
+            HumanReadableNumBytes::ToString(resources.cfile_cache_miss_bytes));
+  json->Set("decode_secs",
+            HumanReadableElapsedTime::ToShortString(resources.cfile_decode_nanos / 1e9));
+  json->Set("delta_apply_secs",
+            HumanReadableElapsedTime::ToShortString(resources.delta_apply_nanos / 1e9));
+  json->Set("predicate_eval_secs",
+            HumanReadableElapsedTime::ToShortString(resources.predicate_eval_nanos / 1e9));
+
   json->Set("duration_title", duration.ToSeconds());
   json->Set("time_since_start_title", time_since_start.ToSeconds());
 
@@ -595,11 +672,16 @@ const char* kLongTimingTitle = "wall time, user cpu time, and system cpu time "
     "the scanner was (or is so far) open, but possibly dormant waiting for the "
     "client to request to continue the scan.";
 
+const char* kResourcesTitle = "bytes of CFile blocks read from the block cache and, "
+    "on a miss, from disk, and time spent decoding CFile blocks, applying deltas, "
+    "and evaluating predicates which couldn't be pushed down to the decoders.";
+
 void TabletServerPathHandlers::HandleScansPage(const Webserver::WebRequest& /*req*/,
                                                Webserver::WebResponse* resp) {
   EasyJson* output = &resp->output;
   (*output)["completed_scan_history_count"] = FLAGS_completed_scan_history_count;
   output->Set("timing_title", kLongTimingTitle);
+  output->Set("resources_title", kResourcesTitle);
   EasyJson completed_scans = output->Set("completed_scans", EasyJson::kArray);
   vector<SharedScanDescriptor> descriptors = tserver_->scanner_manager()->ListScans();
 
@@ -17,11 +17,17 @@
 #ifndef KUDU_TSERVER_TSERVER_PATH_HANDLERS_H
 #define KUDU_TSERVER_TSERVER_PATH_HANDLERS_H
 
+#include <cstdint>
+
 #include "kudu/gutil/macros.h"
+#include "kudu/server/web_page_cache.h"
 #include "kudu/server/webserver.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
+
+class EasyJson;
+
 namespace tserver {
 
 class TabletServer;
@@ -29,7 +35,10 @@ class TabletServer;
 class TabletServerPathHandlers {
  public:
   explicit TabletServerPathHandlers(TabletServer* tserver)
-    : tserver_(tserver) {
+    : tserver_(tserver),
+      tablets_page_cache_([this](EasyJson* output) {
+        this->RenderTabletsPage(0, -1, output);
+      }) {
   }
 
   ~TabletServerPathHandlers();
@@ -41,6 +50,10 @@ class TabletServerPathHandlers {
                        Webserver::WebResponse* resp);
   void HandleTabletsPage(const Webserver::WebRequest& req,
                          Webserver::WebResponse* resp);
+  // Renders the /tablets page into 'output', with the details of the
+  // replicas of each list from index 'offset' on, at most 'limit' of them
+  // unless 'limit' is negative.
+  void RenderTabletsPage(int64_t offset, int64_t limit, EasyJson* output);
   void HandleTabletPage(const Webserver::WebRequest& req,
                         Webserver::WebResponse* resp);
   void HandleTransactionsPage(const Webserver::WebRequest& req,
@@ -58,6 +71,9 @@ class TabletServerPathHandlers {
 
   TabletServer* tserver_;
 
+  // The /tablets page, cached for --tserver_tablets_page_cache_ttl_ms.
+  WebPageCache tablets_page_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(TabletServerPathHandlers);
 };
 
@@ -57,6 +57,86 @@ METRIC_DEFINE_gauge_uint64(server, block_cache_usage, "Block Cache Memory Usage"
                            "Memory consumed by the block cache",
                            kudu::MetricLevel::kInfo);
 
+METRIC_DEFINE_counter(server, block_cache_index_inserts,
+                      "Block Cache Index Partition Inserts", kudu::MetricUnit::kBlocks,
+                      "Number of blocks inserted in the index partition of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_index_lookups,
+                      "Block Cache Index Partition Lookups", kudu::MetricUnit::kBlocks,
+                      "Number of blocks looked up from the index partition of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_index_evictions,
+                      "Block Cache Index Partition Evictions", kudu::MetricUnit::kBlocks,
+                      "Number of blocks evicted from the index partition of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_index_misses,
+                      "Block Cache Index Partition Misses", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the index partition of the cache that "
+                      "didn't yield a block",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_index_misses_caching,
+                      "Block Cache Index Partition Misses (Caching)", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the index partition of the cache that were "
+                      "expecting a block that didn't yield one",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_index_hits,
+                      "Block Cache Index Partition Hits", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the index partition of the cache that "
+                      "found a block",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_index_hits_caching,
+                      "Block Cache Index Partition Hits (Caching)", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the index partition of the cache that were "
+                      "expecting a block that found one",
+                      kudu::MetricLevel::kDebug);
+
+METRIC_DEFINE_gauge_uint64(server, block_cache_index_usage,
+                           "Block Cache Index Partition Memory Usage",
+                           kudu::MetricUnit::kBytes,
+                           "Memory consumed by the index partition of the block cache",
+                           kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_counter(server, block_cache_compressed_inserts,
+                      "Block Cache Compressed Partition Inserts", kudu::MetricUnit::kBlocks,
+                      "Number of blocks inserted in the compressed partition of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_lookups,
+                      "Block Cache Compressed Partition Lookups", kudu::MetricUnit::kBlocks,
+                      "Number of blocks looked up from the compressed partition of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_evictions,
+                      "Block Cache Compressed Partition Evictions", kudu::MetricUnit::kBlocks,
+                      "Number of blocks evicted from the compressed partition of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_misses,
+                      "Block Cache Compressed Partition Misses", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed partition of the cache that "
+                      "didn't yield a block",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_misses_caching,
+                      "Block Cache Compressed Partition Misses (Caching)",
+                      kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed partition of the cache that were "
+                      "expecting a block that didn't yield one",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_hits,
+                      "Block Cache Compressed Partition Hits", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed partition of the cache that "
+                      "found a block",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_hits_caching,
+                      "Block Cache Compressed Partition Hits (Caching)",
+                      kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed partition of the cache that were "
+                      "expecting a block that found one",
+                      kudu::MetricLevel::kDebug);
+
+METRIC_DEFINE_gauge_uint64(server, block_cache_compressed_usage,
+                           "Block Cache Compressed Partition Memory Usage",
+                           kudu::MetricUnit::kBytes,
+                           "Memory consumed by the compressed partition of the block cache",
+                           kudu::MetricLevel::kInfo);
+
 namespace kudu {
 
 #define MINIT(member, x) member = METRIC_##x.Instantiate(entity)
@@ -71,6 +151,29 @@ BlockCacheMetrics::BlockCacheMetrics(const scoped_refptr<MetricEntity>& entity)
   MINIT(cache_misses_caching, block_cache_misses_caching);
   GINIT(cache_usage, block_cache_usage);
 }
+
+IndexBlockCacheMetrics::IndexBlockCacheMetrics(const scoped_refptr<MetricEntity>& entity) {
+  MINIT(inserts, block_cache_index_inserts);
+  MINIT(lookups, block_cache_index_lookups);
+  MINIT(evictions, block_cache_index_evictions);
+  MINIT(cache_hits, block_cache_index_hits);
+  MINIT(cache_hits_caching, block_cache_index_hits_caching);
+  MINIT(cache_misses, block_cache_index_misses);
+  MINIT(cache_misses_caching, block_cache_index_misses_caching);
+  GINIT(cache_usage, block_cache_index_usage);
+}
+
+CompressedBlockCacheMetrics::CompressedBlockCacheMetrics(
+    const scoped_refptr<MetricEntity>& entity) {
+  MINIT(inserts, block_cache_compressed_inserts);
+  MINIT(lookups, block_cache_compressed_lookups);
+  MINIT(evictions, block_cache_compressed_evictions);
+  MINIT(cache_hits, block_cache_compressed_hits);
+  MINIT(cache_hits_caching, block_cache_compressed_hits_caching);
+  MINIT(cache_misses, block_cache_compressed_misses);
+  MINIT(cache_misses_caching, block_cache_compressed_misses_caching);
+  GINIT(cache_usage, block_cache_compressed_usage);
+}
 #undef MINIT
 #undef GINIT
 
@@ -28,4 +28,16 @@ struct BlockCacheMetrics : public CacheMetrics {
   explicit BlockCacheMetrics(const scoped_refptr<MetricEntity>& entity);
 };
 
+// Metrics for the partition of the block cache holding index blocks, if the
+// block cache is configured with one.
+struct IndexBlockCacheMetrics : public CacheMetrics {
+  explicit IndexBlockCacheMetrics(const scoped_refptr<MetricEntity>& entity);
+};
+
+// Metrics for the partition of the block cache holding compressed blocks, if
+// the block cache is configured with one.
+struct CompressedBlockCacheMetrics : public CacheMetrics {
+  explicit CompressedBlockCacheMetrics(const scoped_refptr<MetricEntity>& entity);
+};
+
 } // namespace kudu
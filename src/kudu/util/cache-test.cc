@@ -4,10 +4,12 @@
 
 #include "kudu/util/cache.h"
 
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -39,6 +41,7 @@ DECLARE_double(cache_memtracker_approximation_ratio);
 using std::make_tuple;
 using std::tuple;
 using std::shared_ptr;
+using std::thread;
 using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
@@ -146,6 +149,24 @@ class CacheBaseTest : public KuduTest,
         }
         MemTracker::FindTracker("cache_test-sharded_lru_cache", &mem_tracker_);
         break;
+      case Cache::EvictionPolicy::SLRU:
+        if (mem_type != Cache::MemoryType::DRAM) {
+          FAIL() << "SLRU cache can only be of DRAM type";
+        }
+        cache_.reset(NewCache<Cache::EvictionPolicy::SLRU,
+                              Cache::MemoryType::DRAM>(cache_size(),
+                                                       "cache_test"));
+        MemTracker::FindTracker("cache_test-sharded_slru_cache", &mem_tracker_);
+        break;
+      case Cache::EvictionPolicy::CLOCK:
+        if (mem_type != Cache::MemoryType::DRAM) {
+          FAIL() << "CLOCK cache can only be of DRAM type";
+        }
+        cache_.reset(NewCache<Cache::EvictionPolicy::CLOCK,
+                              Cache::MemoryType::DRAM>(cache_size(),
+                                                       "cache_test"));
+        MemTracker::FindTracker("cache_test-sharded_clock_cache", &mem_tracker_);
+        break;
       default:
         FAIL() << "unrecognized cache eviction policy";
         break;
@@ -213,6 +234,18 @@ INSTANTIATE_TEST_SUITE_P(
                    ShardingPolicy::MultiShard),
         make_tuple(Cache::MemoryType::NVM,
                    Cache::EvictionPolicy::LRU,
+                   ShardingPolicy::SingleShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::SLRU,
+                   ShardingPolicy::MultiShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::SLRU,
+                   ShardingPolicy::SingleShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::CLOCK,
+                   ShardingPolicy::MultiShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::CLOCK,
                    ShardingPolicy::SingleShard)));
 
 TEST_P(CacheTest, TrackMemory) {
@@ -533,4 +566,142 @@ TEST_P(LRUCacheTest, EvictionPolicy) {
   ASSERT_EQ(-1, Lookup(200));
 }
 
+// This class is dedicated for scenarios specific for SLRU cache.
+// The scenarios use a single-shard cache for simpler logic.
+class SLRUCacheTest : public CacheBaseTest {
+ public:
+  SLRUCacheTest()
+      : CacheBaseTest(16 * 1024 * 1024) {
+  }
+
+  void SetUp() override {
+    SetupWithParameters(Cache::MemoryType::DRAM,
+                        Cache::EvictionPolicy::SLRU,
+                        ShardingPolicy::SingleShard);
+  }
+};
+
+// Verify that entries which are inserted but never looked up again (as
+// happens during a large scan) don't evict the frequently accessed entries.
+TEST_F(SLRUCacheTest, ScanResistance) {
+  static constexpr int kNumElems = 1000;
+  const int size_per_elem = cache_size() / kNumElems;
+
+  // The working set takes half of the cache, and is accessed repeatedly.
+  static constexpr int kNumHot = kNumElems / 2;
+  for (int i = 0; i < kNumHot; i++) {
+    Insert(i, i, size_per_elem);
+    ASSERT_EQ(i, Lookup(i));
+  }
+
+  // Scan through twice the capacity of the cache.
+  for (int i = 0; i < 2 * kNumElems; i++) {
+    Insert(kNumElems + i, kNumElems + i, size_per_elem);
+  }
+  ASSERT_GE(evicted_keys_.size(), kNumElems);
+
+  // The working set should still be in the cache.
+  for (int i = 0; i < kNumHot; i++) {
+    SCOPED_TRACE(Substitute("working set: index $0", i));
+    ASSERT_EQ(i, Lookup(i));
+  }
+  // The scanned entries made room for each other.
+  ASSERT_EQ(-1, Lookup(kNumElems));
+  ASSERT_EQ(3 * kNumElems - 1, Lookup(3 * kNumElems - 1));
+}
+
+// Verify that the protected segment doesn't grow past its share of the
+// capacity: the least recently used protected entries are demoted, and
+// become eligible for eviction again.
+TEST_F(SLRUCacheTest, ProtectedSegmentIsBounded) {
+  static constexpr int kNumElems = 1000;
+  const int size_per_elem = cache_size() / kNumElems;
+
+  // Access every entry twice, so each one gets promoted.
+  for (int i = 0; i < 2 * kNumElems; i++) {
+    Insert(i, i, size_per_elem);
+    ASSERT_EQ(i, Lookup(i));
+  }
+  // The earliest promoted entries were demoted and then evicted, while the
+  // most recently accessed ones remain.
+  ASSERT_EQ(-1, Lookup(0));
+  ASSERT_EQ(2 * kNumElems - 1, Lookup(2 * kNumElems - 1));
+  ASSERT_GE(evicted_keys_.size(), kNumElems);
+}
+
+// This class is dedicated for scenarios specific for CLOCK cache.
+// The scenarios use a single-shard cache for simpler logic.
+class CLOCKCacheTest : public CacheBaseTest {
+ public:
+  CLOCKCacheTest()
+      : CacheBaseTest(16 * 1024 * 1024) {
+  }
+
+  void SetUp() override {
+    SetupWithParameters(Cache::MemoryType::DRAM,
+                        Cache::EvictionPolicy::CLOCK,
+                        ShardingPolicy::SingleShard);
+  }
+};
+
+TEST_F(CLOCKCacheTest, EvictionPolicy) {
+  static constexpr int kNumElems = 1000;
+  const int size_per_elem = cache_size() / kNumElems;
+
+  Insert(100, 101);
+  Insert(200, 201);
+
+  // Loop adding and looking up new entries, but repeatedly accessing key 101.
+  // This frequently-used entry should get a second chance every time it
+  // comes up for eviction.
+  for (int i = 0; i < kNumElems + 1000; i++) {
+    Insert(1000+i, 2000+i, size_per_elem);
+    ASSERT_EQ(101, Lookup(100));
+  }
+  ASSERT_EQ(101, Lookup(100));
+  // Since '200' wasn't accessed in the loop above, it should have
+  // been evicted.
+  ASSERT_EQ(-1, Lookup(200));
+}
+
+// Concurrent lookups share the shard lock: run them alongside inserts to
+// give TSAN a chance to catch races in the deferred recency updates.
+TEST_F(CLOCKCacheTest, ConcurrentLookups) {
+  static constexpr int kNumElems = 1000;
+  static constexpr int kNumThreads = 8;
+  const int size_per_elem = cache_size() / kNumElems;
+
+  // Entries may be freed by the readers when they release their handles,
+  // so don't register the (non-thread-safe) eviction callback.
+  const auto insert = [&](int key) {
+    const std::string key_str = EncodeInt(key);
+    auto handle(cache_->Allocate(key_str, key_str.size(), size_per_elem));
+    memcpy(cache_->MutableValue(&handle), key_str.data(), key_str.size());
+    cache_->Insert(std::move(handle), nullptr);
+  };
+  for (int i = 0; i < kNumElems / 2; i++) {
+    insert(i);
+  }
+
+  std::atomic<bool> done(false);
+  vector<thread> readers;
+  for (int t = 0; t < kNumThreads; t++) {
+    readers.emplace_back([&]() {
+      while (!done) {
+        for (int i = 0; i < kNumElems / 2; i++) {
+          const int val = Lookup(i);
+          CHECK(val == i || val == -1);
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 4 * kNumElems; i++) {
+    insert(kNumElems + i);
+  }
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+}
+
 }  // namespace kudu
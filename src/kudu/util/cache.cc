@@ -7,6 +7,7 @@
 #include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <initializer_list>
 #include <memory>
 #include <mutex>
 #include <ostream>
@@ -45,6 +46,23 @@ DEFINE_double(cache_memtracker_approximation_ratio, 0.01,
               "this ratio to improve performance. For tests.");
 TAG_FLAG(cache_memtracker_approximation_ratio, hidden);
 
+DEFINE_double(cache_slru_protected_ratio, 0.8,
+              "For caches using the segmented LRU eviction policy, the fraction "
+              "of the cache capacity reserved for the protected segment, i.e. for "
+              "entries which have been looked up at least once since they were "
+              "inserted.");
+TAG_FLAG(cache_slru_protected_ratio, advanced);
+
+static bool ValidateSLRUProtectedRatio(const char* flagname, double value) {
+  if (value < 0 || value > 1) {
+    LOG(ERROR) << strings::Substitute("$0 must be between 0 and 1 (got $1)",
+                                      flagname, value);
+    return false;
+  }
+  return true;
+}
+DEFINE_validator(cache_slru_protected_ratio, &ValidateSLRUProtectedRatio);
+
 using std::atomic;
 using std::shared_ptr;
 using std::string;
@@ -68,7 +86,7 @@ const Cache::IterationFunc Cache::kIterateOverAllEntriesFunc = [](
 
 namespace {
 
-// Recency list cache implementations (FIFO, LRU, etc.)
+// Recency list cache implementations (FIFO, LRU, SLRU, CLOCK, etc.)
 
 // Recency list handle. An entry is a variable length heap-allocated structure.
 // Entries are kept in a circular doubly linked list ordered by some recency
@@ -83,6 +101,8 @@ struct RLHandle {
   uint32_t val_length;
   std::atomic<int32_t> refs;
   uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
+  bool in_protected_segment; // SLRU only: whether in the protected segment
+  std::atomic<bool> referenced; // CLOCK only: looked up since last considered
 
   // The storage for the key/value pair itself. The data is stored as:
   //   [key bytes ...] [padding up to 8-byte boundary] [value bytes ...]
@@ -198,6 +218,10 @@ string ToString(Cache::EvictionPolicy p) {
       return "fifo";
     case Cache::EvictionPolicy::LRU:
       return "lru";
+    case Cache::EvictionPolicy::SLRU:
+      return "slru";
+    case Cache::EvictionPolicy::CLOCK:
+      return "clock";
     default:
       LOG(FATAL) << "unexpected cache eviction policy: " << static_cast<int>(p);
       break;
@@ -205,6 +229,22 @@ string ToString(Cache::EvictionPolicy p) {
   return "unknown";
 }
 
+// The lock protecting a cache shard, and the guard held while looking up
+// an entry in the shard.
+template<Cache::EvictionPolicy policy>
+struct ShardLocking {
+  typedef simple_spinlock Mutex;
+  typedef std::lock_guard<Mutex> LookupGuard;
+};
+
+// The CLOCK policy doesn't modify the recency list on lookups, so lookups
+// need only exclude the operations which do.
+template<>
+struct ShardLocking<Cache::EvictionPolicy::CLOCK> {
+  typedef rw_spinlock Mutex;
+  typedef shared_lock<Mutex> LookupGuard;
+};
+
 // A single shard of sharded cache.
 template<Cache::EvictionPolicy policy>
 class CacheShard {
@@ -215,6 +255,7 @@ class CacheShard {
   // Separate from constructor so caller can easily make an array of CacheShard
   void SetCapacity(size_t capacity) {
     capacity_ = capacity;
+    protected_capacity_ = capacity * FLAGS_cache_slru_protected_ratio;
     max_deferred_consumption_ = capacity * FLAGS_cache_memtracker_approximation_ratio;
   }
 
@@ -229,8 +270,15 @@ class CacheShard {
 
  private:
   void RL_Remove(RLHandle* e);
+  // Make 'e' the newest entry of the recency list (for SLRU, of the
+  // probationary segment).
   void RL_Append(RLHandle* e);
-  // Update the recency list after a lookup operation.
+  // SLRU only: make 'e' the newest entry of the protected segment.
+  void RL_AppendProtected(RLHandle* e);
+  // Return the entry to evict next, or nullptr if there are no entries.
+  RLHandle* RL_EvictionCandidate();
+  // Update the recency list after a lookup operation. Called while holding
+  // the lookup guard, which for CLOCK is shared with other lookups.
   void RL_UpdateAfterLookup(RLHandle* e);
   // Just reduce the reference count by 1.
   // Return true if last reference
@@ -264,15 +312,23 @@ class CacheShard {
 
   // Initialized before use.
   size_t capacity_;
+  // SLRU only: the part of 'capacity_' available to the protected segment.
+  size_t protected_capacity_;
 
   // mutex_ protects the following state.
-  simple_spinlock mutex_;
+  typename ShardLocking<policy>::Mutex mutex_;
   size_t usage_;
 
   // Dummy head of recency list.
   // rl.prev is newest entry, rl.next is oldest entry.
   RLHandle rl_;
 
+  // SLRU only: dummy head of the protected segment's recency list, ordered
+  // the same way as 'rl_', which holds the probationary segment. Empty for
+  // the other policies.
+  RLHandle protected_rl_;
+  size_t protected_usage_;
+
   HandleTable table_;
 
   MemTracker* mem_tracker_;
@@ -288,23 +344,28 @@ class CacheShard {
 template<Cache::EvictionPolicy policy>
 CacheShard<policy>::CacheShard(MemTracker* tracker)
     : usage_(0),
+      protected_usage_(0),
       mem_tracker_(tracker),
       metrics_(nullptr) {
-  // Make empty circular linked list.
+  // Make empty circular linked lists.
   rl_.next = &rl_;
   rl_.prev = &rl_;
+  protected_rl_.next = &protected_rl_;
+  protected_rl_.prev = &protected_rl_;
 }
 
 template<Cache::EvictionPolicy policy>
 CacheShard<policy>::~CacheShard() {
-  for (RLHandle* e = rl_.next; e != &rl_; ) {
-    RLHandle* next = e->next;
-    DCHECK_EQ(e->refs.load(std::memory_order_relaxed), 1)
-        << "caller has an unreleased handle";
-    if (Unref(e)) {
-      FreeEntry(e);
+  for (RLHandle* head : { &rl_, &protected_rl_ }) {
+    for (RLHandle* e = head->next; e != head; ) {
+      RLHandle* next = e->next;
+      DCHECK_EQ(e->refs.load(std::memory_order_relaxed), 1)
+          << "caller has an unreleased handle";
+      if (Unref(e)) {
+        FreeEntry(e);
+      }
+      e = next;
     }
-    e = next;
   }
   mem_tracker_->Consume(deferred_consumption_);
 }
@@ -367,6 +428,10 @@ void CacheShard<policy>::RL_Remove(RLHandle* e) {
   e->prev->next = e->next;
   DCHECK_GE(usage_, e->charge);
   usage_ -= e->charge;
+  if (e->in_protected_segment) {
+    DCHECK_GE(protected_usage_, e->charge);
+    protected_usage_ -= e->charge;
+  }
 }
 
 template<Cache::EvictionPolicy policy>
@@ -376,7 +441,52 @@ void CacheShard<policy>::RL_Append(RLHandle* e) {
   e->prev = rl_.prev;
   e->prev->next = e;
   e->next->prev = e;
+  e->in_protected_segment = false;
+  e->referenced.store(false, std::memory_order_relaxed);
+  usage_ += e->charge;
+}
+
+template<Cache::EvictionPolicy policy>
+void CacheShard<policy>::RL_AppendProtected(RLHandle* e) {
+  DCHECK(policy == Cache::EvictionPolicy::SLRU);
+  e->next = &protected_rl_;
+  e->prev = protected_rl_.prev;
+  e->prev->next = e;
+  e->next->prev = e;
+  e->in_protected_segment = true;
   usage_ += e->charge;
+  protected_usage_ += e->charge;
+}
+
+template<Cache::EvictionPolicy policy>
+RLHandle* CacheShard<policy>::RL_EvictionCandidate() {
+  // The protected segment is only drawn from when the probationary one is
+  // empty: this way newly inserted entries can't displace entries which
+  // have proven to be useful.
+  if (rl_.next != &rl_) {
+    return rl_.next;
+  }
+  if (protected_rl_.next != &protected_rl_) {
+    return protected_rl_.next;
+  }
+  return nullptr;
+}
+
+template<>
+RLHandle* CacheShard<Cache::EvictionPolicy::CLOCK>::RL_EvictionCandidate() {
+  // Entries looked up since they were last considered get a second chance:
+  // they move to the newest end of the list rather than being evicted. This
+  // terminates since lookups can't mark entries while the shard is locked
+  // exclusively.
+  while (rl_.next != &rl_) {
+    RLHandle* e = rl_.next;
+    if (!e->referenced.load(std::memory_order_relaxed)) {
+      return e;
+    }
+    RL_Remove(e);
+    RL_Append(e);
+  }
+  return nullptr;
 }
 
 template<>
@@ -389,13 +499,34 @@ void CacheShard<Cache::EvictionPolicy::LRU>::RL_UpdateAfterLookup(RLHandle* e) {
   RL_Append(e);
 }
 
+template<>
+void CacheShard<Cache::EvictionPolicy::CLOCK>::RL_UpdateAfterLookup(RLHandle* e) {
+  // Avoid dirtying the entry's cache line if it's already marked.
+  if (!e->referenced.load(std::memory_order_relaxed)) {
+    e->referenced.store(true, std::memory_order_relaxed);
+  }
+}
+
+template<>
+void CacheShard<Cache::EvictionPolicy::SLRU>::RL_UpdateAfterLookup(RLHandle* e) {
+  RL_Remove(e);
+  RL_AppendProtected(e);
+  // Demote the oldest protected entries back to the probationary segment
+  // if the protected segment outgrew its share of the capacity.
+  while (protected_usage_ > protected_capacity_ && protected_rl_.next != e) {
+    RLHandle* old = protected_rl_.next;
+    RL_Remove(old);
+    RL_Append(old);
+  }
+}
+
 template<Cache::EvictionPolicy policy>
 Cache::Handle* CacheShard<policy>::Lookup(const Slice& key,
                                           uint32_t hash,
                                           bool caching) {
   RLHandle* e;
   {
-    std::lock_guard<decltype(mutex_)> l(mutex_);
+    typename ShardLocking<policy>::LookupGuard l(mutex_);
     e = table_.Lookup(key, hash);
     if (e != nullptr) {
       e->refs.fetch_add(1, std::memory_order_relaxed);
@@ -448,8 +579,11 @@ Cache::Handle* CacheShard<policy>::Insert(
       }
     }
 
-    while (usage_ > capacity_ && rl_.next != &rl_) {
-      RLHandle* old = rl_.next;
+    while (usage_ > capacity_) {
+      RLHandle* old = RL_EvictionCandidate();
+      if (old == nullptr) {
+        break;
+      }
       RL_Remove(old);
       table_.Remove(old->key(), old->hash);
       if (Unref(old)) {
@@ -498,28 +632,31 @@ size_t CacheShard<policy>::Invalidate(const Cache::InvalidationControl& ctl) {
   {
     std::lock_guard<decltype(mutex_)> l(mutex_);
 
-    // rl_.next is the oldest (a.k.a. least relevant) entry in the recency list.
-    RLHandle* h = rl_.next;
-    while (h != nullptr && h != &rl_ &&
-           ctl.iteration_func(valid_entry_count, invalid_entry_count)) {
-      if (ctl.validity_func(h->key(), h->value())) {
-        // Continue iterating over the list.
+    // The list heads are visited in eviction order, and the 'next' of a list
+    // head is the oldest (a.k.a. least relevant) entry in its recency list.
+    for (RLHandle* head : { &rl_, &protected_rl_ }) {
+      RLHandle* h = head->next;
+      while (h != nullptr && h != head &&
+             ctl.iteration_func(valid_entry_count, invalid_entry_count)) {
+        if (ctl.validity_func(h->key(), h->value())) {
+          // Continue iterating over the list.
+          h = h->next;
+          ++valid_entry_count;
+          continue;
+        }
+        // Copy the handle slated for removal.
+        RLHandle* h_to_remove = h;
+        // Prepare for next iteration of the cycle.
         h = h->next;
-        ++valid_entry_count;
-        continue;
-      }
-      // Copy the handle slated for removal.
-      RLHandle* h_to_remove = h;
-      // Prepare for next iteration of the cycle.
-      h = h->next;
-
-      RL_Remove(h_to_remove);
-      table_.Remove(h_to_remove->key(), h_to_remove->hash);
-      if (Unref(h_to_remove)) {
-        h_to_remove->next = to_remove_head;
-        to_remove_head = h_to_remove;
+
+        RL_Remove(h_to_remove);
+        table_.Remove(h_to_remove->key(), h_to_remove->hash);
+        if (Unref(h_to_remove)) {
+          h_to_remove->next = to_remove_head;
+          to_remove_head = h_to_remove;
+        }
+        ++invalid_entry_count;
       }
-      ++invalid_entry_count;
     }
   }
   // Once removed from the lookup table and the recency list, the entries
@@ -695,6 +832,18 @@ Cache* NewCache<Cache::EvictionPolicy::LRU,
   return new ShardedCache<Cache::EvictionPolicy::LRU>(capacity, id);
 }
 
+template<>
+Cache* NewCache<Cache::EvictionPolicy::SLRU,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id) {
+  return new ShardedCache<Cache::EvictionPolicy::SLRU>(capacity, id);
+}
+
+template<>
+Cache* NewCache<Cache::EvictionPolicy::CLOCK,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id) {
+  return new ShardedCache<Cache::EvictionPolicy::CLOCK>(capacity, id);
+}
+
 std::ostream& operator<<(std::ostream& os, Cache::MemoryType mem_type) {
   switch (mem_type) {
     case Cache::MemoryType::DRAM:
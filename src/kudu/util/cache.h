@@ -49,6 +49,21 @@ class Cache {
 
     // The least-recently-used items are evicted.
     LRU,
+
+    // Segmented LRU: new items enter a probationary segment, and are only
+    // promoted into the protected segment once they're looked up again.
+    // Items are evicted from the probationary segment first, so a stream of
+    // items which are never re-accessed (e.g., a large scan) can't push the
+    // frequently accessed items out of the cache.
+    SLRU,
+
+    // CLOCK (a.k.a. second chance): approximates LRU without updating the
+    // recency list on lookups. A lookup only marks the item as referenced,
+    // and the marked items are given another pass through the list instead
+    // of being evicted. Since lookups don't modify the shared state, they
+    // don't exclude each other, which suits read-mostly caches under heavy
+    // concurrency.
+    CLOCK,
   };
 
   // Callback interface which is called when an entry is evicted from the
@@ -373,6 +388,19 @@ template<>
 Cache* NewCache<Cache::EvictionPolicy::LRU,
                 Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
 
+// Create a new segmented LRU cache with a fixed size capacity. This
+// implementation of Cache uses the scan-resistant segmented LRU eviction
+// policy and stored in DRAM.
+template<>
+Cache* NewCache<Cache::EvictionPolicy::SLRU,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
+
+// Create a new CLOCK cache with a fixed size capacity. This implementation
+// of Cache uses the CLOCK (second chance) eviction policy and stored in DRAM.
+template<>
+Cache* NewCache<Cache::EvictionPolicy::CLOCK,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
+
 // A helper method to output cache memory type into ostream.
 std::ostream& operator<<(std::ostream& os, Cache::MemoryType mem_type);
 
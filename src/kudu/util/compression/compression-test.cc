@@ -27,12 +27,14 @@
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <zstd.h>
 
 #include "kudu/util/compression/compression.pb.h"
 #include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/random.h"
 #include "kudu/util/random_util.h"
 #include "kudu/util/slice.h"
+#include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
@@ -148,16 +150,62 @@ TEST_F(TestCompression, TestNoCompressionCodec) {
 }
 
 TEST_F(TestCompression, TestSnappyCompressionCodec) {
-  for (auto type : { SNAPPY, LZ4, ZLIB }) {
+  for (auto type : { SNAPPY, LZ4, ZLIB, ZSTD }) {
     NO_FATALS(TestCompressionCodec(type));
   }
 }
 
 TEST_F(TestCompression, TestSimpleBenchmark) {
   Random r(SeedRandom());
-  for (auto type : { SNAPPY, LZ4, ZLIB }) {
+  for (auto type : { SNAPPY, LZ4, ZLIB, ZSTD }) {
     NO_FATALS(Benchmark(r, type));
   }
 }
 
+TEST_F(TestCompression, TestZstdCompressionLevels) {
+  constexpr int kInputSize = 4096;
+  Random r(SeedRandom());
+  string input = RandomString(kInputSize / 4, &r);
+  while (input.size() < kInputSize) {
+    input += input;
+  }
+  input.resize(kInputSize);
+
+  for (int level : { 0, 1, 3, 19 }) {
+    SCOPED_TRACE(level);
+    const CompressionCodec* codec;
+    ASSERT_OK(GetCompressionCodec(ZSTD, level, &codec));
+    ASSERT_EQ(ZSTD, codec->type());
+
+    unique_ptr<uint8_t[]> cbuffer(new uint8_t[codec->MaxCompressedLength(kInputSize)]);
+    size_t compressed;
+    ASSERT_OK(codec->Compress(Slice(input), cbuffer.get(), &compressed));
+    ASSERT_LT(compressed, kInputSize);
+
+    string output(kInputSize, '\0');
+    ASSERT_OK(codec->Uncompress(Slice(cbuffer.get(), compressed),
+                                reinterpret_cast<uint8_t*>(&output[0]), kInputSize));
+    ASSERT_EQ(input, output);
+
+    // Uncompressing with a short output buffer must fail cleanly.
+    ASSERT_FALSE(codec->Uncompress(Slice(cbuffer.get(), compressed),
+                                   reinterpret_cast<uint8_t*>(&output[0]),
+                                   kInputSize - 1).ok());
+  }
+
+  const CompressionCodec* codec;
+  Status s = GetCompressionCodec(ZSTD, 1000, &codec);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  s = GetCompressionCodec(ZSTD, -1, &codec);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+
+  ASSERT_OK(ValidateCompressionLevel(ZSTD, 0));
+  ASSERT_OK(ValidateCompressionLevel(ZSTD, ZSTD_maxCLevel()));
+  ASSERT_OK(ValidateCompressionLevel(LZ4, 1000));
+  s = ValidateCompressionLevel(ZSTD, ZSTD_maxCLevel() + 1);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  s = ValidateCompressionLevel(DEFAULT_COMPRESSION, -1);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+}
+
 } // namespace kudu
@@ -17,24 +17,47 @@
 
 #include "kudu/util/compression/compression_codec.h"
 
+#include <memory>
 #include <ostream>
 #include <string>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <lz4.h>
 #include <snappy-sinksource.h>
 #include <snappy.h>
 #include <zlib.h>
+#include <zstd.h>
 
 #include "kudu/gutil/singleton.h"
 #include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/faststring.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/string_case.h"
 
+DEFINE_int32(zstd_default_compression_level, ZSTD_CLEVEL_DEFAULT,
+             "The compression level used by the ZSTD codec when a column or "
+             "log does not specify one. Higher levels trade compression speed "
+             "for a better compression ratio; decompression speed is roughly "
+             "independent of the level.");
+TAG_FLAG(zstd_default_compression_level, advanced);
+
+static bool ValidateZstdCompressionLevel(const char* flagname, int32_t value) {
+  if (value >= 1 && value <= ZSTD_maxCLevel()) {
+    return true;
+  }
+  LOG(ERROR) << strings::Substitute("$0 must be between 1 and $1, value $2 is invalid",
+                                    flagname, ZSTD_maxCLevel(), value);
+  return false;
+}
+DEFINE_validator(zstd_default_compression_level, &ValidateZstdCompressionLevel);
+
 namespace kudu {
 
+using std::unique_ptr;
 using std::vector;
 
 CompressionCodec::CompressionCodec() {
@@ -243,7 +266,159 @@ class ZlibCodec : public CompressionCodec {
   }
 };
 
+class ZstdCodec : public CompressionCodec {
+ public:
+  // Returns the codec for the given compression level, which must be in
+  // the range [1, ZSTD_maxCLevel()].
+  static const ZstdCodec* GetInstance(int level) {
+    static const vector<unique_ptr<ZstdCodec>>* const kCodecs = []() {
+      auto* codecs = new vector<unique_ptr<ZstdCodec>>();
+      for (int l = 0; l <= ZSTD_maxCLevel(); l++) {
+        codecs->emplace_back(new ZstdCodec(l));
+      }
+      return codecs;
+    }();
+    DCHECK_GE(level, 1);
+    DCHECK_LE(level, ZSTD_maxCLevel());
+    return (*kCodecs)[level].get();
+  }
+
+  Status Compress(const Slice& input,
+                  uint8_t *compressed, size_t *compressed_length) const override {
+    ZSTD_CCtx* cctx;
+    RETURN_NOT_OK(GetThreadLocalCCtx(&cctx));
+    size_t n = ZSTD_compressCCtx(cctx,
+                                 compressed, MaxCompressedLength(input.size()),
+                                 input.data(), input.size(), level_);
+    if (ZSTD_isError(n)) {
+      return Status::RuntimeError("unable to compress the buffer", ZSTD_getErrorName(n));
+    }
+    *compressed_length = n;
+    return Status::OK();
+  }
+
+  Status Compress(const vector<Slice>& input_slices,
+                  uint8_t *compressed, size_t *compressed_length) const override {
+    if (input_slices.empty()) {
+      return Compress(Slice(), compressed, compressed_length);
+    }
+    if (input_slices.size() == 1) {
+      return Compress(input_slices[0], compressed, compressed_length);
+    }
+
+    // Feed the slices through the streaming API rather than concatenating
+    // them into a temporary buffer first: the WAL compresses batches made of
+    // many small slices.
+    size_t total_size = 0;
+    for (const Slice& s : input_slices) {
+      total_size += s.size();
+    }
+    ZSTD_CCtx* cctx;
+    RETURN_NOT_OK(GetThreadLocalCCtx(&cctx));
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+    size_t err = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level_);
+    if (ZSTD_isError(err)) {
+      return Status::RuntimeError("unable to set the compression level",
+                                  ZSTD_getErrorName(err));
+    }
+    err = ZSTD_CCtx_setPledgedSrcSize(cctx, total_size);
+    if (ZSTD_isError(err)) {
+      return Status::RuntimeError("unable to set the pledged source size",
+                                  ZSTD_getErrorName(err));
+    }
+    ZSTD_outBuffer out = { compressed, MaxCompressedLength(total_size), 0 };
+    for (size_t i = 0; i < input_slices.size(); i++) {
+      const Slice& s = input_slices[i];
+      ZSTD_inBuffer in = { s.data(), s.size(), 0 };
+      ZSTD_EndDirective mode = i == input_slices.size() - 1 ? ZSTD_e_end : ZSTD_e_continue;
+      size_t remaining;
+      do {
+        remaining = ZSTD_compressStream2(cctx, &out, &in, mode);
+        if (ZSTD_isError(remaining)) {
+          return Status::RuntimeError("unable to compress the buffer",
+                                      ZSTD_getErrorName(remaining));
+        }
+      } while (mode == ZSTD_e_end ? remaining != 0 : in.pos != in.size);
+    }
+    *compressed_length = out.pos;
+    return Status::OK();
+  }
+
+  Status Uncompress(const Slice& compressed,
+                    uint8_t *uncompressed,
+                    size_t uncompressed_length) const override {
+    ZSTD_DCtx* dctx;
+    RETURN_NOT_OK(GetThreadLocalDCtx(&dctx));
+    size_t n = ZSTD_decompressDCtx(dctx,
+                                   uncompressed, uncompressed_length,
+                                   compressed.data(), compressed.size());
+    if (ZSTD_isError(n)) {
+      return Status::Corruption("unable to uncompress the buffer", ZSTD_getErrorName(n));
+    }
+    if (n != uncompressed_length) {
+      return Status::Corruption(
+          strings::Substitute("unable to uncompress the buffer: expected $0 bytes, got $1",
+                              uncompressed_length, n));
+    }
+    return Status::OK();
+  }
+
+  size_t MaxCompressedLength(size_t source_bytes) const override {
+    return ZSTD_compressBound(source_bytes);
+  }
+
+  CompressionType type() const override {
+    return ZSTD;
+  }
+
+ private:
+  explicit ZstdCodec(int level) : level_(level) {}
+
+  // Compression and decompression contexts are expensive to set up, and
+  // the codec instances are shared, so keep one of each per thread.
+  struct CCtxDeleter {
+    void operator()(ZSTD_CCtx* ctx) const { ZSTD_freeCCtx(ctx); }
+  };
+  struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); }
+  };
+
+  // Context creation only fails on allocation failure; in that case the
+  // next call on the same thread tries again.
+  static Status GetThreadLocalCCtx(ZSTD_CCtx** ctx) {
+    static thread_local unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx;
+    if (!cctx) {
+      cctx.reset(ZSTD_createCCtx());
+      if (!cctx) {
+        return Status::RuntimeError("unable to create a ZSTD compression context");
+      }
+    }
+    *ctx = cctx.get();
+    return Status::OK();
+  }
+
+  static Status GetThreadLocalDCtx(ZSTD_DCtx** ctx) {
+    static thread_local unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx;
+    if (!dctx) {
+      dctx.reset(ZSTD_createDCtx());
+      if (!dctx) {
+        return Status::RuntimeError("unable to create a ZSTD decompression context");
+      }
+    }
+    *ctx = dctx.get();
+    return Status::OK();
+  }
+
+  const int level_;
+};
+
+Status GetCompressionCodec(CompressionType compression,
+                           const CompressionCodec** codec) {
+  return GetCompressionCodec(compression, 0, codec);
+}
+
 Status GetCompressionCodec(CompressionType compression,
+                           int compression_level,
                            const CompressionCodec** codec) {
   switch (compression) {
     case NO_COMPRESSION:
@@ -258,12 +433,32 @@ Status GetCompressionCodec(CompressionType compression,
     case ZLIB:
       *codec = ZlibCodec::GetSingleton();
       break;
+    case ZSTD:
+      if (compression_level == 0) {
+        compression_level = FLAGS_zstd_default_compression_level;
+      }
+      RETURN_NOT_OK(ValidateCompressionLevel(ZSTD, compression_level));
+      *codec = ZstdCodec::GetInstance(compression_level);
+      break;
     default:
       return Status::NotFound("bad compression type");
   }
   return Status::OK();
 }
 
+Status ValidateCompressionLevel(CompressionType compression, int compression_level) {
+  if (compression_level == 0 ||
+      (compression != ZSTD && compression != DEFAULT_COMPRESSION)) {
+    return Status::OK();
+  }
+  if (compression_level < 1 || compression_level > ZSTD_maxCLevel()) {
+    return Status::InvalidArgument(strings::Substitute(
+        "invalid ZSTD compression level $0: must be between 1 and $1",
+        compression_level, ZSTD_maxCLevel()));
+  }
+  return Status::OK();
+}
+
 CompressionType GetCompressionCodecType(const std::string& name) {
   std::string uname;
   ToUpperCase(name, &uname);
@@ -274,6 +469,8 @@ CompressionType GetCompressionCodecType(const std::string& name) {
     return LZ4;
   if (uname == "ZLIB")
     return ZLIB;
+  if (uname == "ZSTD")
+    return ZSTD;
   if (uname == "NO_COMPRESSION")
     return NO_COMPRESSION;
 
@@ -70,6 +70,21 @@ class CompressionCodec {
 Status GetCompressionCodec(CompressionType compression,
                            const CompressionCodec** codec);
 
+// Same as above, but for codecs which support it (currently only ZSTD) uses
+// the given compression level. A level of 0 selects the codec's default
+// level; other codecs ignore the level.
+//
+// Returns InvalidArgument if the level is out of range for the codec.
+Status GetCompressionCodec(CompressionType compression,
+                           int compression_level,
+                           const CompressionCodec** codec);
+
+// Returns InvalidArgument if 'compression_level' can't be used by a column
+// compressed with 'compression'. A level of 0 is always valid. Since the
+// server-side default codec may be ZSTD, levels set on DEFAULT_COMPRESSION
+// columns are held to ZSTD's range as well.
+Status ValidateCompressionLevel(CompressionType compression, int compression_level);
+
 // Returns the compression codec type given the name
 CompressionType GetCompressionCodecType(const std::string& name);
 
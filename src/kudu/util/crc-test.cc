@@ -82,6 +82,29 @@ TEST_F(CrcTest, TestCRC32C) {
   ASSERT_EQ(kExpectedCrc, data_crc3);
 }
 
+// The CRCs computed by the helpers, which may use other instructions, should
+// be those computed by crcutil, whatever the length and alignment of the data.
+TEST_F(CrcTest, TestHelpersMatchCrcutil) {
+  unique_ptr<uint8_t[]> buf;
+  size_t buflen;
+  GenerateBenchmarkData(&buf, &buflen);
+  Crc* crc32c = GetCrc32cInstance();
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t length = 0; length < 100; length++) {
+      SCOPED_TRACE(Substitute("offset $0, length $1", offset, length));
+      uint64_t expected_crc = 0;
+      crc32c->Compute(buf.get() + offset, length, &expected_crc);
+      ASSERT_EQ(expected_crc, Crc32c(buf.get() + offset, length));
+
+      // Extending a CRC should be the same as computing it at once.
+      const size_t half_length = length / 2;
+      uint32_t crc = Crc32c(buf.get() + offset, half_length);
+      crc = Crc32c(buf.get() + offset + half_length, length - half_length, crc);
+      ASSERT_EQ(expected_crc, crc);
+    }
+  }
+}
+
 // Simple benchmark of CRC32C throughput.
 // We should expect about 8 bytes per cycle in throughput on a single core.
 TEST_F(CrcTest, BenchmarkCRC32C) {
@@ -16,9 +16,20 @@
 // under the License.
 #include "kudu/util/crc.h"
 
+#if defined(__aarch64__)
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+#include <cstring>
+
 #include <crcutil/interface.h>
 
 #include "kudu/gutil/once.h"
+#include "kudu/gutil/port.h"
 #include "kudu/util/debug/leakcheck_disabler.h"
 
 namespace kudu {
@@ -40,13 +51,62 @@ Crc* GetCrc32cInstance() {
   return crc32c_instance;
 }
 
+#if defined(__aarch64__)
+// crcutil uses the CRC32 instruction of SSE4.2 on x86, but has no such
+// acceleration on ARM: there, use the CRC32C instructions of ARMv8 instead,
+// if the CPU has them (they are optional before ARMv8.1).
+static bool HasArmv8Crc32() {
+#if defined(__linux__)
+  return getauxval(AT_HWCAP) & HWCAP_CRC32;
+#else
+  return true;
+#endif
+}
+
+static const bool kUseArmv8Crc32 = HasArmv8Crc32();
+
+// Same as Crc32c(), but with the ARMv8 instructions.
+__attribute__((target("+crc")))
+static uint32_t Crc32cArmv8(const void* data, size_t length, uint32_t prev_crc32) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  // As crcutil's canonical CRCs, the CRC is inverted before and after.
+  uint32_t crc = ~prev_crc32;
+  for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t), p += sizeof(uint64_t)) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    crc = __crc32cd(crc, v);
+  }
+  if (length >= sizeof(uint32_t)) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    crc = __crc32cw(crc, v);
+    length -= sizeof(uint32_t);
+    p += sizeof(uint32_t);
+  }
+  if (length >= sizeof(uint16_t)) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    crc = __crc32ch(crc, v);
+    length -= sizeof(uint16_t);
+    p += sizeof(uint16_t);
+  }
+  if (length > 0) {
+    crc = __crc32cb(crc, *p);
+  }
+  return ~crc;
+}
+#endif
+
 uint32_t Crc32c(const void* data, size_t length) {
-  uint64_t crc32 = 0;
-  GetCrc32cInstance()->Compute(data, length, &crc32);
-  return static_cast<uint32_t>(crc32); // Only uses lower 32 bits.
+  return Crc32c(data, length, 0);
 }
 
 uint32_t Crc32c(const void* data, size_t length, uint32_t prev_crc32) {
+#if defined(__aarch64__)
+  if (PREDICT_TRUE(kUseArmv8Crc32)) {
+    return Crc32cArmv8(data, length, prev_crc32);
+  }
+#endif
   uint64_t crc_tmp = static_cast<uint64_t>(prev_crc32);
   GetCrc32cInstance()->Compute(data, length, &crc_tmp);
   return static_cast<uint32_t>(crc_tmp); // Only uses lower 32 bits.
@@ -0,0 +1,84 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/dir_syncer.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "kudu/util/env.h"
+#include "kudu/util/path_util.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+using std::string;
+using std::thread;
+using std::vector;
+
+namespace kudu {
+
+class DirSyncerTest : public KuduTest {
+};
+
+// Test that sequential syncs each fsync the directory.
+TEST_F(DirSyncerTest, TestSequentialSyncs) {
+  DirSyncer syncer(env_, test_dir_);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(syncer.Sync());
+    ASSERT_EQ(i + 1, syncer.num_syncs());
+  }
+}
+
+// Test that concurrent syncs share fsyncs of the directory.
+TEST_F(DirSyncerTest, TestConcurrentSyncs) {
+  constexpr int kNumThreads = 16;
+  constexpr int kSyncsPerThread = 100;
+  DirSyncer syncer(env_, test_dir_);
+  vector<thread> threads;
+  vector<Status> statuses(kNumThreads);
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < kSyncsPerThread && statuses[i].ok(); j++) {
+        statuses[i] = syncer.Sync();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (const auto& s : statuses) {
+    ASSERT_OK(s);
+  }
+  // The calls of a thread each need a fsync of their own, but the concurrent
+  // calls of the threads may share theirs.
+  ASSERT_GE(syncer.num_syncs(), kSyncsPerThread);
+  ASSERT_LE(syncer.num_syncs(), kNumThreads * kSyncsPerThread);
+}
+
+// Test that the failures of the fsyncs are returned.
+TEST_F(DirSyncerTest, TestSyncFailure) {
+  DirSyncer syncer(env_, JoinPathSegments(test_dir_, "missing"));
+  Status s = syncer.Sync();
+  ASSERT_FALSE(s.ok());
+  ASSERT_TRUE(s.IsIOError() || s.IsNotFound()) << s.ToString();
+}
+
+} // namespace kudu
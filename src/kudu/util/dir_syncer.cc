@@ -0,0 +1,69 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/dir_syncer.h"
+
+#include <utility>
+
+#include "kudu/util/debug/trace_event.h"
+#include "kudu/util/env.h"
+
+using std::string;
+
+namespace kudu {
+
+DirSyncer::DirSyncer(Env* env, string dir)
+    : env_(env),
+      dir_(std::move(dir)),
+      num_requests_(0),
+      synced_request_(0),
+      syncing_(false),
+      num_syncs_(0) {
+}
+
+Status DirSyncer::Sync() {
+  TRACE_EVENT1("io", "DirSyncer::Sync", "path", dir_);
+  std::unique_lock<std::mutex> l(lock_);
+  const int64_t request = ++num_requests_;
+  while (synced_request_ < request) {
+    if (syncing_) {
+      // The fsync in progress may have begun before this call: wait for it,
+      // and unless it covered this call after all, issue the next one.
+      cond_.wait(l);
+      continue;
+    }
+    // Issue a fsync on behalf of all the calls so far.
+    syncing_ = true;
+    const int64_t last_request = num_requests_;
+    num_syncs_++;
+    l.unlock();
+    Status s = env_->SyncDir(dir_);
+    l.lock();
+    syncing_ = false;
+    synced_request_ = last_request;
+    sync_status_ = std::move(s);
+    cond_.notify_all();
+  }
+  return sync_status_;
+}
+
+int64_t DirSyncer::num_syncs() const {
+  std::lock_guard<std::mutex> l(lock_);
+  return num_syncs_;
+}
+
+} // namespace kudu
@@ -0,0 +1,79 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class Env;
+
+// Groups the fsyncs of a directory issued by concurrent threads, e.g. after
+// they each renamed a file into the directory, so that a single fsync makes
+// all their changes durable.
+//
+// Sync() waits for the fsync in progress, if any, since it may have started
+// before the changes of the caller, and then issues a fsync on behalf of all
+// the threads which called Sync() in the meantime.
+//
+// This class is thread-safe.
+class DirSyncer {
+ public:
+  DirSyncer(Env* env, std::string dir);
+
+  // Returns once a fsync of the directory which began after the call
+  // completed, returning the status of the last such fsync.
+  Status Sync();
+
+  const std::string& dir() const {
+    return dir_;
+  }
+
+  // Returns the number of fsyncs of the directory issued so far.
+  int64_t num_syncs() const;
+
+ private:
+  Env* const env_;
+  const std::string dir_;
+
+  mutable std::mutex lock_;
+  std::condition_variable cond_;
+
+  // The number of calls to Sync() so far: the sequence number of the last
+  // one.
+  int64_t num_requests_;
+
+  // The sequence number of the last call to Sync() covered by a completed
+  // fsync, and the status of that fsync.
+  int64_t synced_request_;
+  Status sync_status_;
+
+  // Whether a thread is currently fsyncing the directory.
+  bool syncing_;
+
+  int64_t num_syncs_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirSyncer);
+};
+
+} // namespace kudu
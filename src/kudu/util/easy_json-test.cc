@@ -103,4 +103,15 @@ TEST_F(EasyJsonTest, TestAllocatorLifetime) {
   ASSERT_EQ(child.value()["child_attr"].GetInt(), 1);
 }
 
+TEST_F(EasyJsonTest, TestCopyFrom) {
+  EasyJson copy;
+  {
+    EasyJson ej;
+    ej["a"] = "abc";
+    ej["b"].PushBack(1);
+    copy["child"].CopyFrom(ej);
+  }
+  ASSERT_EQ("{\"child\":{\"a\":\"abc\",\"b\":[1]}}", copy.ToString());
+}
+
 } // namespace kudu
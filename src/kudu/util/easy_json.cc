@@ -196,6 +196,11 @@ template<> EasyJson EasyJson::PushBack(EasyJson::ComplexTypeInitializer val) {
   return EasyJson(&(*value_)[value_->Size() - 1], alloc_);
 }
 
+EasyJson& EasyJson::CopyFrom(const EasyJson& other) {
+  value_->CopyFrom(other.value(), alloc_->allocator());
+  return *this;
+}
+
 string EasyJson::ToString() const {
   rapidjson::StringBuffer buffer;
   rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
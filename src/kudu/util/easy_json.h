@@ -151,6 +151,10 @@ class EasyJson {
   template<typename T>
   EasyJson PushBack(T val);
 
+  // Overwrites the underlying Value with a deep copy of the Value of 'other',
+  // allocated with the allocator of this EasyJson.
+  EasyJson& CopyFrom(const EasyJson& other);
+
   // Returns a reference to the underlying Value.
   rapidjson::Value& value() const { return *value_; }
 
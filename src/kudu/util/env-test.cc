@@ -77,6 +77,7 @@ DECLARE_bool(never_fsync);
 DECLARE_bool(crash_on_eio);
 DECLARE_bool(encrypt_data_at_rest);
 DECLARE_double(env_inject_eio);
+DECLARE_int32(env_encrypted_write_buffer_bytes);
 DECLARE_int32(env_inject_short_read_bytes);
 DECLARE_int32(env_inject_short_write_bytes);
 DECLARE_int32(encryption_key_length);
@@ -1372,4 +1373,27 @@ TEST_P(TestEncryptedEnv, TestEncryptionMultipleSlices) {
   ASSERT_EQ("foobarhelloworld", result);
 }
 
+// Test that the writes larger than the encryption buffer are encrypted in
+// chunks, including at offsets not aligned with the cipher blocks.
+TEST_P(TestEncryptedEnv, TestEncryptionChunkedWrites) {
+  FLAGS_env_encrypted_write_buffer_bytes = 16;
+  const string kFile = JoinPathSegments(test_dir_, "encrypted_file");
+  unique_ptr<RWFile> rw;
+  RWFileOptions opts;
+  opts.is_sensitive = true;
+  ASSERT_OK(env_->NewRWFile(opts, kFile, &rw));
+
+  const string kPrefix = "abc";
+  const string kLong = string(50, 'x') + "the quick brown fox";
+  vector<Slice> data = {"foo", kLong, "", "hello world, this is a test"};
+  ASSERT_OK(rw->Write(env_->GetEncryptionHeaderSize(), kPrefix));
+  ASSERT_OK(rw->WriteV(env_->GetEncryptionHeaderSize() + kPrefix.size(), data));
+
+  const string expected = kPrefix + "foo" + kLong + "hello world, this is a test";
+  unique_ptr<uint8_t[]> scratch(new uint8_t[expected.size()]);
+  Slice result(scratch.get(), expected.size());
+  ASSERT_OK(rw->Read(env_->GetEncryptionHeaderSize(), result));
+  ASSERT_EQ(expected, result);
+}
+
 }  // namespace kudu
@@ -21,6 +21,16 @@ Env::~Env() {
 File::~File() {
 }
 
+Status RandomAccessFile::Map(uint64_t /* offset */, size_t /* length */,
+                             unique_ptr<MappedFileRange>* /* range */) const {
+  return Status::NotSupported("mapping is not supported", filename());
+}
+
+Status RWFile::Map(uint64_t /* offset */, size_t /* length */,
+                   unique_ptr<MappedFileRange>* /* range */) const {
+  return Status::NotSupported("mapping is not supported", filename());
+}
+
 FileLock::~FileLock() {
 }
 
@@ -28,6 +28,7 @@ namespace kudu {
 class faststring;
 class Fifo;
 class FileLock;
+class MappedFileRange;
 class RandomAccessFile;
 class RWFile;
 class SequentialFile;
@@ -193,6 +194,11 @@ class Env {
   // Synchronize the entry for a specific directory.
   virtual Status SyncDir(const std::string& dirname) = 0;
 
+  // Synchronize all the files of the filesystem containing 'path', with a
+  // single syncfs(2) call. Only supported on Linux: writeback errors are only
+  // reported since Linux 5.8.
+  virtual Status SyncFileSystem(const std::string& path) = 0;
+
   // Recursively delete the specified directory.
   // This should operate safely, not following any symlinks, etc.
   virtual Status DeleteRecursively(const std::string &dirname) = 0;
@@ -506,11 +512,34 @@ class RandomAccessFile : public File {
   // Returns the size of the file
   virtual Status Size(uint64_t *size) const = 0;
 
+  // Maps 'length' bytes of the file beginning at 'offset' into memory, so that
+  // they may be read in place rather than copied. The range must be within the
+  // file, whose data it shares with the page cache: it stays mapped until
+  // 'range' is destroyed, even if the file is closed.
+  //
+  // Returns Status::NotSupported if the file can't be mapped, e.g. because it
+  // is encrypted.
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual Status Map(uint64_t offset, size_t length,
+                     std::unique_ptr<MappedFileRange>* range) const;
+
   // Returns the approximate memory usage of this RandomAccessFile including
   // the object itself.
   virtual size_t memory_footprint() const = 0;
 };
 
+// A range of a file mapped into memory by RandomAccessFile::Map(), which is
+// unmapped once destroyed.
+class MappedFileRange {
+ public:
+  virtual ~MappedFileRange() = default;
+
+  // Returns the data of the range. Reading it may block to fault the pages of
+  // the file in.
+  virtual Slice data() const = 0;
+};
+
 // Creation-time options for WritableFile
 struct WritableFileOptions {
   // Call Sync() during Close().
@@ -696,6 +725,14 @@ class RWFile : public File {
   // return a meaningful status.
   virtual Status Flush(FlushMode mode, uint64_t offset, size_t length) = 0;
 
+  // Advises the OS that the range of data given by 'offset' and 'length' won't
+  // be read soon, so that it drops the clean pages of the range from its page
+  // cache. If length is 0, the range goes to the end of the file.
+  //
+  // Dirty pages aren't dropped: the range should be flushed synchronously or
+  // synced first. A no-op on platforms without posix_fadvise(2).
+  virtual Status DropCache(uint64_t offset, size_t length) = 0;
+
   // Synchronously flushes all dirty file data and metadata to disk. Upon
   // returning successfully, all previously issued file changes have been
   // made durable.
@@ -710,6 +747,11 @@ class RWFile : public File {
   // Retrieves the file's size.
   virtual Status Size(uint64_t* size) const = 0;
 
+  // Maps a range of the file into memory, as per RandomAccessFile::Map(). The
+  // mapping doesn't reflect writes past the end of the range.
+  virtual Status Map(uint64_t offset, size_t length,
+                     std::unique_ptr<MappedFileRange>* range) const;
+
   virtual bool IsEncrypted() const = 0;
 
   // Retrieve a map of the file's live extents.
@@ -10,6 +10,7 @@
 #include <openssl/rand.h>
 #include <openssl/ssl.h>
 #include <pthread.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -59,12 +60,12 @@
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
 #include "kudu/util/flags.h"
+#include "kudu/util/io_uring.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/malloc.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/openssl_util.h"
 #include "kudu/util/path_util.h"
-#include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
@@ -168,6 +169,16 @@ DEFINE_bool(env_use_ioctl_hole_punch_on_xfs, true,
 TAG_FLAG(env_use_ioctl_hole_punch_on_xfs, advanced);
 TAG_FLAG(env_use_ioctl_hole_punch_on_xfs, experimental);
 
+DEFINE_bool(env_use_io_uring, false,
+            "Issue the positional reads and writes of files through a per-thread "
+            "io_uring(7) instead of preadv(2) and pwritev(2), batching the "
+            "requests of large vectored operations into a single system call. "
+            "Falls back to the regular system calls if the kernel doesn't "
+            "support io_uring. Only supported on Linux.");
+TAG_FLAG(env_use_io_uring, advanced);
+TAG_FLAG(env_use_io_uring, experimental);
+TAG_FLAG(env_use_io_uring, runtime);
+
 DEFINE_bool(crash_on_eio, false,
             "Kill the process if an I/O operation results in EIO. If false, "
             "I/O resulting in EIOs will return the status IOError and leave "
@@ -203,6 +214,13 @@ DEFINE_string(env_inject_lock_failure_globs, "",
               "will fail.");
 TAG_FLAG(env_inject_lock_failure_globs, hidden);
 
+DEFINE_int32(env_encrypted_write_buffer_bytes, 1024 * 1024,
+             "Maximum number of bytes of the data written to an encrypted file "
+             "that are encrypted at once. Larger writes are encrypted and "
+             "written in chunks of this size, bounding the memory they use.");
+TAG_FLAG(env_encrypted_write_buffer_bytes, advanced);
+TAG_FLAG(env_encrypted_write_buffer_bytes, runtime);
+
 DEFINE_bool(encrypt_data_at_rest, false,
             "Whether sensitive files should be encrypted on the file system.");
 DEFINE_int32(encryption_key_length, 128, "Encryption key length.");
@@ -584,6 +602,69 @@ Status DoOpen(const string& filename, Env::OpenMode mode, int* fd) {
   return Status::OK();
 }
 
+#if !defined(__APPLE__)
+// Returns the io_uring positional I/O should use, or nullptr if it should use
+// the regular system calls.
+IoUring* RingForPositionalIO() {
+  return FLAGS_env_use_io_uring ? IoUring::ForCurrentThread() : nullptr;
+}
+
+// Reads or writes 'iov_count' buffers of 'iov' at 'offset' of 'fd' through
+// 'ring', submitting the chunks of IOV_MAX buffers as a single batch.
+//
+// Like preadv(2) and pwritev(2), returns the number of bytes transferred from
+// 'offset' onwards, which may be short, or -1 with errno set on failure.
+ssize_t RingTransferV(IoUring* ring, IoUring::Op::Type type, int fd,
+                      const struct iovec* iov, size_t iov_count, uint64_t offset) {
+  const size_t num_ops = (iov_count + IOV_MAX - 1) / IOV_MAX;
+  IoUring::Op ops[num_ops];
+  size_t op_bytes[num_ops];
+  uint64_t op_offset = offset;
+  for (size_t i = 0; i < num_ops; i++) {
+    IoUring::Op& op = ops[i];
+    op.type = type;
+    op.fd = fd;
+    op.offset = op_offset;
+    op.iov = iov + i * IOV_MAX;
+    op.iov_count = std::min(iov_count - i * IOV_MAX, static_cast<size_t>(IOV_MAX));
+    op_bytes[i] = 0;
+    for (int j = 0; j < op.iov_count; j++) {
+      op_bytes[i] += op.iov[j].iov_len;
+    }
+    op_offset += op_bytes[i];
+  }
+  while (true) {
+    Status s = ring->SubmitAndWait(ArrayView<IoUring::Op>(ops, num_ops));
+    if (PREDICT_FALSE(!s.ok())) {
+      errno = s.posix_code() > 0 ? s.posix_code() : EIO;
+      return -1;
+    }
+    ssize_t total = 0;
+    size_t i = 0;
+    for (; i < num_ops; i++) {
+      const int64_t res = ops[i].result;
+      if (PREDICT_FALSE(res < 0)) {
+        break;
+      }
+      total += res;
+      if (static_cast<size_t>(res) < op_bytes[i]) {
+        // The following chunks may have been transferred, but not contiguously.
+        return total;
+      }
+    }
+    if (i == num_ops || total > 0) {
+      return total;
+    }
+    const int err = -ops[i].result;
+    if (err != EINTR && err != EAGAIN) {
+      errno = err;
+      return -1;
+    }
+    // The first chunk was interrupted before it transferred anything: retry.
+  }
+}
+#endif
+
 Status DoReadV(
     int fd,
     const string& filename,
@@ -607,6 +688,9 @@ Status DoReadV(
   uint64_t cur_offset = offset;
   size_t completed_iov = 0;
   size_t rem = bytes_req;
+#if !defined(__APPLE__)
+  IoUring* ring = RingForPositionalIO();
+#endif
   while (rem > 0) {
     // Never request more than IOV_MAX in one request
     size_t iov_count = std::min(iov_size - completed_iov, static_cast<size_t>(IOV_MAX));
@@ -614,7 +698,12 @@ Status DoReadV(
 #if defined(__APPLE__)
     RETRY_ON_EINTR(r, preadvsim(fd, iov + completed_iov, iov_count, cur_offset));
 #else
-    RETRY_ON_EINTR(r, preadv(fd, iov + completed_iov, iov_count, cur_offset));
+    if (ring) {
+      r = RingTransferV(ring, IoUring::Op::READV, fd, iov + completed_iov,
+                        iov_size - completed_iov, cur_offset);
+    } else {
+      RETRY_ON_EINTR(r, preadv(fd, iov + completed_iov, iov_count, cur_offset));
+    }
 #endif
     // Fake a short read for testing
     if (PREDICT_FALSE(FLAGS_env_inject_short_read_bytes > 0 && rem == bytes_req)) {
@@ -667,6 +756,12 @@ Status DoReadV(
   return Status::OK();
 }
 
+Status DoEncryptAndWriteV(int fd,
+                          const string& filename,
+                          uint64_t offset,
+                          ArrayView<const Slice> data,
+                          const EncryptionHeader* eh);
+
 Status DoWriteV(
     int fd,
     const string& filename,
@@ -676,42 +771,27 @@ Status DoWriteV(
   MAYBE_RETURN_EIO(filename, IOError(Env::kInjectedFailureStatusMsg, EIO));
   ThreadRestrictions::AssertIOAllowed();
 
+  if (eh) {
+    return DoEncryptAndWriteV(fd, filename, offset, data, eh);
+  }
+
   // Convert the results into the iovec vector to request
   // and calculate the total bytes requested.
   size_t bytes_req = 0;
   size_t iov_size = data.size();
   struct iovec iov[iov_size];
-  std::vector<Slice> encrypted_data(iov_size);
-  SCOPED_CLEANUP({
-    if (eh) {
-      delete[] encrypted_data[0].mutable_data();
-    }
-  });
-  if (eh) {
-    for (size_t i = 0; i < iov_size; i++) {
-      bytes_req += data[i].size();
-    }
-    unique_ptr<unsigned char[]> encrypted_buf(new unsigned char[bytes_req]);
-    size_t buffer_offset = 0;
-    for (size_t i = 0; i < iov_size; i++) {
-      size_t size = data[i].size();
-      encrypted_data[i] = Slice(&encrypted_buf[buffer_offset], size);
-      buffer_offset += size;
-      iov[i] = {const_cast<uint8_t*>(encrypted_data[i].data()), size};
-    }
-    RETURN_NOT_OK(DoEncryptV(eh, offset, data, encrypted_data));
-    encrypted_buf.release();
-  } else {
-    for (size_t i = 0; i < iov_size; i++) {
-      const Slice& result = data[i];
-      bytes_req += result.size();
-      iov[i] = {const_cast<uint8_t*>(result.data()), result.size()};
-    }
+  for (size_t i = 0; i < iov_size; i++) {
+    const Slice& result = data[i];
+    bytes_req += result.size();
+    iov[i] = {const_cast<uint8_t*>(result.data()), result.size()};
   }
 
   uint64_t cur_offset = offset;
   size_t completed_iov = 0;
   size_t rem = bytes_req;
+#if !defined(__APPLE__)
+  IoUring* ring = RingForPositionalIO();
+#endif
   while (rem > 0) {
     // Never request more than IOV_MAX in one request.
     size_t iov_count = std::min(iov_size - completed_iov, static_cast<size_t>(IOV_MAX));
@@ -719,7 +799,12 @@ Status DoWriteV(
 #if defined(__APPLE__)
     RETRY_ON_EINTR(w, pwritevsim(fd, iov + completed_iov, iov_count, cur_offset));
 #else
-    RETRY_ON_EINTR(w, pwritev(fd, iov + completed_iov, iov_count, cur_offset));
+    if (ring) {
+      w = RingTransferV(ring, IoUring::Op::WRITEV, fd, iov + completed_iov,
+                        iov_size - completed_iov, cur_offset);
+    } else {
+      RETRY_ON_EINTR(w, pwritev(fd, iov + completed_iov, iov_count, cur_offset));
+    }
 #endif
     // Fake a short write for testing.
     if (PREDICT_FALSE(FLAGS_env_inject_short_write_bytes > 0 && rem == bytes_req)) {
@@ -760,6 +845,58 @@ Status DoWriteV(
   return Status::OK();
 }
 
+// Encrypts the data in 'data' and writes it at 'offset' in the file. At most
+// --env_encrypted_write_buffer_bytes are encrypted and written at once, so
+// that large writes don't need a ciphertext copy of all their data.
+Status DoEncryptAndWriteV(int fd,
+                          const string& filename,
+                          uint64_t offset,
+                          ArrayView<const Slice> data,
+                          const EncryptionHeader* eh) {
+  DCHECK(eh);
+  size_t bytes_req = 0;
+  for (const auto& s : data) {
+    bytes_req += s.size();
+  }
+  const size_t buffer_size = std::min<size_t>(
+      bytes_req, std::max<size_t>(FLAGS_env_encrypted_write_buffer_bytes,
+                                  kEncryptionBlockSize));
+  unique_ptr<uint8_t[]> buffer(new uint8_t[buffer_size]);
+
+  // The slices of cleartext to encrypt into the buffer, and where into.
+  vector<Slice> cleartext;
+  vector<Slice> ciphertext;
+  uint64_t chunk_offset = offset;
+  size_t chunk_size = 0;
+  size_t slice_idx = 0;
+  size_t slice_pos = 0;
+  while (slice_idx < data.size()) {
+    const Slice& s = data[slice_idx];
+    const size_t n = std::min(s.size() - slice_pos, buffer_size - chunk_size);
+    if (n > 0) {
+      cleartext.emplace_back(s.data() + slice_pos, n);
+      ciphertext.emplace_back(buffer.get() + chunk_size, n);
+      chunk_size += n;
+      slice_pos += n;
+    }
+    if (slice_pos == s.size()) {
+      ++slice_idx;
+      slice_pos = 0;
+    }
+    if (chunk_size > 0 && (chunk_size == buffer_size || slice_idx == data.size())) {
+      RETURN_NOT_OK(DoEncryptV(eh, chunk_offset, cleartext, ciphertext));
+      const Slice chunk(buffer.get(), chunk_size);
+      RETURN_NOT_OK(DoWriteV(fd, filename, chunk_offset, ArrayView<const Slice>(&chunk, 1),
+                             nullptr));
+      chunk_offset += chunk_size;
+      chunk_size = 0;
+      cleartext.clear();
+      ciphertext.clear();
+    }
+  }
+  return Status::OK();
+}
+
 Status GenerateHeader(EncryptionHeader* eh) {
   switch (FLAGS_encryption_key_length) {
     case 128:
@@ -1020,6 +1157,51 @@ class PosixSequentialFile: public SequentialFile {
 };
 
 // pread() based random-access
+// A range of a file mapped by PosixRandomAccessFile::Map().
+class PosixMappedFileRange : public MappedFileRange {
+ public:
+  PosixMappedFileRange(void* mapping, size_t mapping_size, Slice data)
+      : mapping_(mapping),
+        mapping_size_(mapping_size),
+        data_(data) {}
+
+  ~PosixMappedFileRange() {
+    if (munmap(mapping_, mapping_size_) != 0) {
+      PLOG(WARNING) << "failed to unmap file range";
+    }
+  }
+
+  Slice data() const override { return data_; }
+
+ private:
+  void* const mapping_;
+  const size_t mapping_size_;
+  const Slice data_;
+
+  DISALLOW_COPY_AND_ASSIGN(PosixMappedFileRange);
+};
+
+Status DoMap(int fd, const string& filename, uint64_t offset, size_t length,
+             unique_ptr<MappedFileRange>* range) {
+  MAYBE_RETURN_EIO(filename, IOError(Env::kInjectedFailureStatusMsg, EIO));
+  TRACE_EVENT1("io", "DoMap", "path", filename);
+  ThreadRestrictions::AssertIOAllowed();
+  if (PREDICT_FALSE(length == 0)) {
+    return Status::InvalidArgument("cannot map an empty range", filename);
+  }
+  // The offset of a mapping must be a multiple of the page size.
+  static const uint64_t kPageSize = sysconf(_SC_PAGESIZE);
+  const uint64_t page_offset = offset % kPageSize;
+  const size_t mapping_size = length + page_offset;
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, offset - page_offset);
+  if (mapping == MAP_FAILED) {
+    return IOError(filename, errno);
+  }
+  range->reset(new PosixMappedFileRange(
+      mapping, mapping_size, Slice(static_cast<uint8_t*>(mapping) + page_offset, length)));
+  return Status::OK();
+}
+
 class PosixRandomAccessFile: public RandomAccessFile {
  private:
   const string filename_;
@@ -1061,6 +1243,14 @@ class PosixRandomAccessFile: public RandomAccessFile {
     return Status::OK();
   }
 
+  Status Map(uint64_t offset, size_t length,
+             unique_ptr<MappedFileRange>* range) const override {
+    if (encrypted_) {
+      return Status::NotSupported("cannot map encrypted file", filename_);
+    }
+    return DoMap(fd_, filename_, offset, length, range);
+  }
+
   const string& filename() const override { return filename_; }
 
   size_t GetEncryptionHeaderSize() const override {
@@ -1368,6 +1558,18 @@ class PosixRWFile : public RWFile {
     return Status::OK();
   }
 
+  Status DropCache(uint64_t offset, size_t length) override {
+    TRACE_EVENT1("io", "PosixRWFile::DropCache", "path", filename_);
+    ThreadRestrictions::AssertIOAllowed();
+#if defined(__linux__)
+    int err = posix_fadvise(fd_, offset, length, POSIX_FADV_DONTNEED);
+    if (err != 0) {
+      return IOError(filename_, err);
+    }
+#endif
+    return Status::OK();
+  }
+
   Status Sync() override {
     TRACE_EVENT1("io", "PosixRWFile::Sync", "path", filename_);
     ThreadRestrictions::AssertIOAllowed();
@@ -1417,6 +1619,14 @@ class PosixRWFile : public RWFile {
     return Status::OK();
   }
 
+  Status Map(uint64_t offset, size_t length,
+             unique_ptr<MappedFileRange>* range) const override {
+    if (encrypted_) {
+      return Status::NotSupported("cannot map encrypted file", filename_);
+    }
+    return DoMap(fd_, filename_, offset, length, range);
+  }
+
   Status GetExtentMap(ExtentMap* out) const override {
 #if !defined(__linux__)
     return Status::NotSupported("GetExtentMap not supported on this platform");
@@ -1787,6 +1997,27 @@ class PosixEnv : public Env {
     return Status::OK();
   }
 
+  Status SyncFileSystem(const string& path) override {
+    TRACE_EVENT1("io", "SyncFileSystem", "path", path);
+    MAYBE_RETURN_EIO(path, IOError(Env::kInjectedFailureStatusMsg, EIO));
+    ThreadRestrictions::AssertIOAllowed();
+    if (FLAGS_never_fsync) return Status::OK();
+#if defined(__linux__)
+    int fd;
+    RETRY_ON_EINTR(fd, open(path.c_str(), O_RDONLY));
+    if (fd < 0) {
+      return IOError(path, errno);
+    }
+    ScopedFdCloser fd_closer(fd);
+    if (syncfs(fd) != 0) {
+      return IOError(path, errno);
+    }
+    return Status::OK();
+#else
+    return Status::NotSupported("syncfs is not supported on this platform");
+#endif
+  }
+
   Status DeleteRecursively(const string &name) override {
     return Walk(
         name, POST_ORDER,
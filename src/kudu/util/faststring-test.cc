@@ -171,6 +171,13 @@ TEST_F(FaststringTest, TestMoveAssignment) {
     ASSERT_EQ(test_str, f1.ToString()); // NOLINT(*)
     f1.CheckInvariants(); // NOLINT(*)
     f2.CheckInvariants(); // NOLINT(*)
+
+    // Move to a string which allocated its own buffer, which must not leak.
+    faststring f3;
+    f3.append(string(faststring::kInitialCapacity + 1, 'b'));
+    f3 = std::move(f1);
+    ASSERT_EQ(test_str, f3.ToString());
+    f3.CheckInvariants();
   }
 }
 
@@ -70,6 +70,9 @@ class faststring {
       assign_copy(other.data(), other.size());
       other.clear();
     } else {
+      if (data_ != initial_data_) {
+        delete[] data_;
+      }
       len_ = other.len_;
       capacity_ = other.capacity_;
       data_ = other.release();
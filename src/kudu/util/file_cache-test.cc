@@ -279,6 +279,29 @@ TYPED_TEST(FileCacheTest, TestInvalidation) {
   ASSERT_EQ(kData2.size(), size - kHeaderSize);
 }
 
+TYPED_TEST(FileCacheTest, TestPrefetch) {
+  const string kFile1 = this->GetTestPath("foo");
+  const string kFile2 = this->GetTestPath("bar");
+  ASSERT_OK(this->WriteTestFile(kFile1, "test data 1"));
+  ASSERT_OK(this->WriteTestFile(kFile2, "test data 2"));
+
+  // Opening the second file evicts the first one.
+  shared_ptr<TypeParam> f1;
+  ASSERT_OK(this->cache_->template OpenFile<Env::MUST_EXIST>(kFile1, &f1));
+  shared_ptr<TypeParam> f2;
+  ASSERT_OK(this->cache_->template OpenFile<Env::MUST_EXIST>(kFile2, &f2));
+  ASSERT_STR_NOT_CONTAINS(this->cache_->ToDebugString(), kFile1 + " (SO)");
+
+  // Prefetching reopens the first file in the background. Files without a
+  // descriptor are ignored.
+  this->cache_->Prefetch({ kFile1, this->GetTestPath("baz") });
+  this->cache_->WaitForPrefetchesForTests();
+  const string debug_str = this->cache_->ToDebugString();
+  ASSERT_STR_CONTAINS(debug_str, kFile1 + " (SO)");
+  ASSERT_STR_NOT_CONTAINS(debug_str, kFile2 + " (SO)");
+  NO_FATALS(this->AssertFdsAndDescriptors(1, 2));
+}
+
 
 TYPED_TEST(FileCacheTest, TestHeavyReads) {
   const int kNumFiles = 20;
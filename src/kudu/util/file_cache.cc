@@ -33,6 +33,7 @@
 
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
+#include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/array_view.h"
@@ -48,11 +49,24 @@
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/thread.h"
+#include "kudu/util/threadpool.h"
 
 DEFINE_int32(file_cache_expiry_period_ms, 60 * 1000,
              "Period of time (in ms) between removing expired file cache descriptors");
 TAG_FLAG(file_cache_expiry_period_ms, advanced);
 
+DEFINE_int32(file_cache_prefetch_threads, 2,
+             "The number of threads of each file cache reopening evicted files "
+             "in the background, ahead of their use. If 0, evicted files are "
+             "only reopened when they're next used.");
+TAG_FLAG(file_cache_prefetch_threads, advanced);
+
+DEFINE_int32(file_cache_max_pending_prefetches, 1024,
+             "The maximum number of files of each file cache waiting to be "
+             "reopened in the background. Files handed for prefetching while "
+             "this many are pending are reopened when they're next used.");
+TAG_FLAG(file_cache_max_pending_prefetches, advanced);
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -118,7 +132,7 @@ class BaseDescriptor {
 
     // The (now expired) weak_ptr remains in 'descriptors_', to be removed by
     // the next call to RunDescriptorExpiry(). Removing it here would risk a
-    // deadlock on recursive acquisition of 'lock_'.
+    // deadlock on recursive acquisition of the shard's lock.
   }
 
   // Insert a pointer to an open file object into the file cache with the
@@ -287,6 +301,12 @@ class Descriptor<RWFile> : public RWFile {
     return opened.file()->Flush(mode, offset, length);
   }
 
+  Status DropCache(uint64_t offset, size_t length) override {
+    ScopedOpenedDescriptor<RWFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary<Env::MUST_EXIST>(&opened));
+    return opened.file()->DropCache(offset, length);
+  }
+
   Status Sync() override {
     ScopedOpenedDescriptor<RWFile> opened(&base_);
     RETURN_NOT_OK(ReopenFileIfNecessary<Env::MUST_EXIST>(&opened));
@@ -298,12 +318,25 @@ class Descriptor<RWFile> : public RWFile {
     return Status::OK();
   }
 
+  // Reopens the file if it was evicted from the cache.
+  Status Prefetch() const {
+    return ReopenFileIfNecessary<Env::MUST_EXIST>(nullptr);
+  }
+
   Status Size(uint64_t* size) const override {
     ScopedOpenedDescriptor<RWFile> opened(&base_);
     RETURN_NOT_OK(ReopenFileIfNecessary<Env::MUST_EXIST>(&opened));
     return opened.file()->Size(size);
   }
 
+  // The range stays mapped even if the file is evicted from the cache.
+  Status Map(uint64_t offset, size_t length,
+             unique_ptr<MappedFileRange>* range) const override {
+    ScopedOpenedDescriptor<RWFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary<Env::MUST_EXIST>(&opened));
+    return opened.file()->Map(offset, length, range);
+  }
+
   Status GetExtentMap(ExtentMap* out) const override {
     ScopedOpenedDescriptor<RWFile> opened(&base_);
     RETURN_NOT_OK(ReopenFileIfNecessary<Env::MUST_EXIST>(&opened));
@@ -396,6 +429,14 @@ class Descriptor<RandomAccessFile> : public RandomAccessFile {
     return opened.file()->Size(size);
   }
 
+  // The range stays mapped even if the file is evicted from the cache.
+  Status Map(uint64_t offset, size_t length,
+             unique_ptr<MappedFileRange>* range) const override {
+    ScopedOpenedDescriptor<RandomAccessFile> opened(&base_);
+    RETURN_NOT_OK(ReopenFileIfNecessary(&opened));
+    return opened.file()->Map(offset, length, range);
+  }
+
   const string& filename() const override {
     return base_.filename();
   }
@@ -404,6 +445,11 @@ class Descriptor<RandomAccessFile> : public RandomAccessFile {
     return base_.env()->GetEncryptionHeaderSize();
   }
 
+  // Reopens the file if it was evicted from the cache.
+  Status Prefetch() const {
+    return ReopenFileIfNecessary(nullptr);
+  }
+
   size_t memory_footprint() const override {
     // Normally we would use kudu_malloc_usable_size(this). However, that's
     // not safe because 'this' was allocated via std::make_shared(), which
@@ -494,6 +540,10 @@ FileCache::FileCache(const string& cache_name,
 }
 
 FileCache::~FileCache() {
+  // The prefetches hold descriptors, which refer to the cache.
+  if (prefetch_pool_) {
+    prefetch_pool_->Shutdown();
+  }
   running_.CountDown();
   if (descriptor_expiry_thread_) {
     descriptor_expiry_thread_->Join();
@@ -501,6 +551,13 @@ FileCache::~FileCache() {
 }
 
 Status FileCache::Init() {
+  if (FLAGS_file_cache_prefetch_threads > 0) {
+    RETURN_NOT_OK(ThreadPoolBuilder(Substitute("$0-prefetch", cache_name_))
+                  .set_min_threads(0)
+                  .set_max_threads(FLAGS_file_cache_prefetch_threads)
+                  .set_max_queue_size(FLAGS_file_cache_max_pending_prefetches)
+                  .Build(&prefetch_pool_));
+  }
   return Thread::Create("cache", Substitute("$0-evict", cache_name_),
                         [this]() { this->RunDescriptorExpiry(); },
                         &descriptor_expiry_thread_);
@@ -513,9 +570,10 @@ Status FileCache::DoOpenFile(const string& file_name,
   shared_ptr<internal::Descriptor<RWFile>> d;
   bool cd;
   {
-    std::lock_guard<simple_spinlock> l(lock_);
+    DescriptorShard* shard = ShardFor(file_name);
+    std::lock_guard<simple_spinlock> l(shard->lock);
     d = FindDescriptorUnlocked(file_name, FindMode::CREATE_IF_NOT_EXIST,
-                               &rwf_descs_, &cd);
+                               &shard->rwf_descs, &cd);
     DCHECK(d);
 
 #ifndef NDEBUG
@@ -523,7 +581,7 @@ Status FileCache::DoOpenFile(const string& file_name,
     // descriptor at a time. This is expensive so it's only done in DEBUG mode.
     bool ignored;
     CHECK(!FindDescriptorUnlocked(file_name, FindMode::DONT_CREATE,
-                                  &raf_descs_, &ignored));
+                                  &shard->raf_descs, &ignored));
 #endif
   }
   if (d->base_.deleted()) {
@@ -541,9 +599,10 @@ Status FileCache::DoOpenFile(const string& file_name,
   shared_ptr<internal::Descriptor<RandomAccessFile>> d;
   bool cd;
   {
-    std::lock_guard<simple_spinlock> l(lock_);
+    DescriptorShard* shard = ShardFor(file_name);
+    std::lock_guard<simple_spinlock> l(shard->lock);
     d = FindDescriptorUnlocked(file_name, FindMode::CREATE_IF_NOT_EXIST,
-                               &raf_descs_, &cd);
+                               &shard->raf_descs, &cd);
     DCHECK(d);
 
 #ifndef NDEBUG
@@ -551,7 +610,7 @@ Status FileCache::DoOpenFile(const string& file_name,
     // descriptor at a time. This is expensive so it's only done in DEBUG mode.
     bool ignored;
     CHECK(!FindDescriptorUnlocked(file_name, FindMode::DONT_CREATE,
-                                  &rwf_descs_, &ignored));
+                                  &shard->rwf_descs, &ignored));
 #endif
   }
   if (d->base_.deleted()) {
@@ -623,11 +682,12 @@ Status FileCache::DeleteFile(const string& file_name) {
   // descriptor per file name, we can short circuit the search if we find a
   // descriptor in the first map.
   {
-    std::lock_guard<simple_spinlock> l(lock_);
+    DescriptorShard* shard = ShardFor(file_name);
+    std::lock_guard<simple_spinlock> l(shard->lock);
     bool ignored;
     {
       auto d = FindDescriptorUnlocked(file_name, FindMode::DONT_CREATE,
-                                      &rwf_descs_, &ignored);
+                                      &shard->rwf_descs, &ignored);
       if (d) {
         if (d->base_.deleted()) {
           return Status::NotFound(kAlreadyDeleted, file_name);
@@ -638,7 +698,7 @@ Status FileCache::DeleteFile(const string& file_name) {
     }
     {
       auto d = FindDescriptorUnlocked(file_name, FindMode::DONT_CREATE,
-                                      &raf_descs_, &ignored);
+                                      &shard->raf_descs, &ignored);
       if (d) {
         if (d->base_.deleted()) {
           return Status::NotFound(kAlreadyDeleted, file_name);
@@ -667,16 +727,17 @@ void FileCache::Invalidate(const string& file_name) {
   // occurs before the client trips on the broken invariant.
   shared_ptr<internal::Descriptor<RWFile>> rwf_desc;
   shared_ptr<internal::Descriptor<RandomAccessFile>> raf_desc;
+  DescriptorShard* shard = ShardFor(file_name);
   {
-    std::lock_guard<simple_spinlock> l(lock_);
+    std::lock_guard<simple_spinlock> l(shard->lock);
     bool ignored;
     rwf_desc = FindDescriptorUnlocked(file_name, FindMode::CREATE_IF_NOT_EXIST,
-                                      &rwf_descs_, &ignored);
+                                      &shard->rwf_descs, &ignored);
     DCHECK(rwf_desc);
     rwf_desc->base_.MarkInvalidated();
 
     raf_desc = FindDescriptorUnlocked(file_name, FindMode::CREATE_IF_NOT_EXIST,
-                                      &raf_descs_, &ignored);
+                                      &shard->raf_descs, &ignored);
     DCHECK(raf_desc);
     raf_desc->base_.MarkInvalidated();
   }
@@ -691,15 +752,49 @@ void FileCache::Invalidate(const string& file_name) {
   // duration of this method, and no other methods erase strong references from
   // the maps.
   {
-    std::lock_guard<simple_spinlock> l(lock_);
-    CHECK_EQ(1, rwf_descs_.erase(file_name));
-    CHECK_EQ(1, raf_descs_.erase(file_name));
+    std::lock_guard<simple_spinlock> l(shard->lock);
+    CHECK_EQ(1, shard->rwf_descs.erase(file_name));
+    CHECK_EQ(1, shard->raf_descs.erase(file_name));
+  }
+}
+
+void FileCache::Prefetch(const vector<string>& file_names) {
+  if (!prefetch_pool_) {
+    return;
+  }
+  for (const auto& file_name : file_names) {
+    // Skip the files which are still open.
+    if (cache_->Lookup(file_name, Cache::NO_EXPECT_IN_CACHE)) {
+      continue;
+    }
+    {
+      std::lock_guard<simple_spinlock> l(prefetch_lock_);
+      if (!prefetches_in_flight_.insert(file_name).second) {
+        continue;
+      }
+    }
+    if (PREDICT_FALSE(!prefetch_pool_->Submit(
+            [this, file_name]() { this->DoPrefetch(file_name); }).ok())) {
+      // The queue is full: the file is reopened when next used.
+      std::lock_guard<simple_spinlock> l(prefetch_lock_);
+      prefetches_in_flight_.erase(file_name);
+    }
+  }
+}
+
+void FileCache::WaitForPrefetchesForTests() {
+  if (prefetch_pool_) {
+    prefetch_pool_->Wait();
   }
 }
 
 size_t FileCache::NumDescriptorsForTests() const {
-  std::lock_guard<simple_spinlock> l(lock_);
-  return rwf_descs_.size() + raf_descs_.size();
+  size_t num_descriptors = 0;
+  for (const auto& shard : shards_) {
+    std::lock_guard<simple_spinlock> l(shard.lock);
+    num_descriptors += shard.rwf_descs.size() + shard.raf_descs.size();
+  }
+  return num_descriptors;
 }
 
 string FileCache::ToDebugString() const {
@@ -707,20 +802,26 @@ string FileCache::ToDebugString() const {
 
   // We need to iterate through the descriptor maps, so make temporary copies
   // of them.
-  DescriptorMap<RWFile> rwfs_copy;
-  DescriptorMap<RandomAccessFile> rafs_copy;
-  {
-    std::lock_guard<simple_spinlock> l(lock_);
-    rwfs_copy = rwf_descs_;
-    rafs_copy = raf_descs_;
-  }
+  for (const auto& shard : shards_) {
+    DescriptorMap<RWFile> rwfs_copy;
+    DescriptorMap<RandomAccessFile> rafs_copy;
+    {
+      std::lock_guard<simple_spinlock> l(shard.lock);
+      rwfs_copy = shard.rwf_descs;
+      rafs_copy = shard.raf_descs;
+    }
 
-  // Dump the contents of the copies.
-  ret += MapToDebugString(rwfs_copy, "rwf");
-  ret += MapToDebugString(rafs_copy, "raf");
+    // Dump the contents of the copies.
+    ret += MapToDebugString(rwfs_copy, "rwf");
+    ret += MapToDebugString(rafs_copy, "raf");
+  }
   return ret;
 }
 
+FileCache::DescriptorShard* FileCache::ShardFor(const string& file_name) const {
+  return &shards_[std::hash<string>()(file_name) % kNumDescriptorShards];
+}
+
 template <class FileType>
 string FileCache::MapToDebugString(const DescriptorMap<FileType>& descs,
                                    const string& prefix) {
@@ -756,7 +857,7 @@ shared_ptr<internal::Descriptor<FileType>> FileCache::FindDescriptorUnlocked(
     FindMode mode,
     DescriptorMap<FileType>* descs,
     bool* created_desc) {
-  DCHECK(lock_.is_locked());
+  DCHECK(ShardFor(file_name)->lock.is_locked());
 
   shared_ptr<internal::Descriptor<FileType>> d;
   auto it = descs->find(file_name);
@@ -800,9 +901,48 @@ void FileCache::ExpireDescriptorsFromMap(DescriptorMap<FileType>* descs) {
 void FileCache::RunDescriptorExpiry() {
   while (!running_.WaitFor(MonoDelta::FromMilliseconds(
       FLAGS_file_cache_expiry_period_ms))) {
-    std::lock_guard<simple_spinlock> l(lock_);
-    ExpireDescriptorsFromMap(&rwf_descs_);
-    ExpireDescriptorsFromMap(&raf_descs_);
+    for (auto& shard : shards_) {
+      std::lock_guard<simple_spinlock> l(shard.lock);
+      ExpireDescriptorsFromMap(&shard.rwf_descs);
+      ExpireDescriptorsFromMap(&shard.raf_descs);
+    }
+  }
+}
+
+void FileCache::DoPrefetch(const string& file_name) {
+  shared_ptr<internal::Descriptor<RWFile>> rwf_desc;
+  shared_ptr<internal::Descriptor<RandomAccessFile>> raf_desc;
+  {
+    // Unlike FindDescriptorUnlocked(), tolerate invalidated descriptors: the
+    // prefetch may race with the invalidation, and is simply skipped.
+    DescriptorShard* shard = ShardFor(file_name);
+    std::lock_guard<simple_spinlock> l(shard->lock);
+    auto rwf_it = shard->rwf_descs.find(file_name);
+    if (rwf_it != shard->rwf_descs.end()) {
+      rwf_desc = rwf_it->second.lock();
+    }
+    auto raf_it = shard->raf_descs.find(file_name);
+    if (raf_it != shard->raf_descs.end()) {
+      raf_desc = raf_it->second.lock();
+    }
+  }
+  PrefetchDescriptor(rwf_desc);
+  PrefetchDescriptor(raf_desc);
+
+  std::lock_guard<simple_spinlock> l(prefetch_lock_);
+  prefetches_in_flight_.erase(file_name);
+}
+
+template <class FileType>
+void FileCache::PrefetchDescriptor(
+    const shared_ptr<internal::Descriptor<FileType>>& desc) {
+  if (!desc || desc->base_.invalidated() || desc->base_.deleted()) {
+    return;
+  }
+  // A failure here will surface again on the next operation on the file.
+  Status s = desc->Prefetch();
+  if (PREDICT_FALSE(!s.ok())) {
+    VLOG(1) << "Could not prefetch " << desc->filename() << ": " << s.ToString();
   }
 }
 
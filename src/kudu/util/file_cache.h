@@ -21,6 +21,8 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest_prod.h>
 
@@ -45,6 +47,7 @@ class Descriptor;
 
 class MetricEntity;
 class Thread;
+class ThreadPool;
 
 // Cache of open files.
 //
@@ -90,6 +93,13 @@ class Thread;
 // descriptor are dropped is the file actually deleted. If there is no open
 // descriptor, the file is deleted immediately.
 //
+// The descriptor maps are sharded by file name, so that concurrent opens of
+// different files seldom contend.
+//
+// Reopening an evicted file on the I/O path stalls the I/O. When clients know
+// ahead of time which files they'll use, they can hand them to Prefetch() to
+// have the ones that were evicted reopened in the background.
+//
 // Every public method in the file cache is thread safe.
 class FileCache {
  public:
@@ -167,6 +177,22 @@ class FileCache {
   // from multiple threads.
   void Invalidate(const std::string& file_name);
 
+  // Reopens in the background those of the given files which have an
+  // outstanding descriptor but were evicted from the cache, so that the next
+  // operations on them don't have to. Other files are ignored.
+  //
+  // This is only a hint: reopens which fail or can't be scheduled are left to
+  // the next operation on the file.
+  void Prefetch(const std::vector<std::string>& file_names);
+
+  // Returns whether Prefetch() reopens files at all.
+  bool prefetch_enabled() const {
+    return prefetch_pool_ != nullptr;
+  }
+
+  // Waits for the scheduled reopens to finish. For tests.
+  void WaitForPrefetchesForTests();
+
   // Returns the number of entries in the descriptor maps.
   //
   // Only intended for unit tests.
@@ -183,6 +209,21 @@ class FileCache {
   using DescriptorMap = std::unordered_map<std::string,
                                            std::weak_ptr<internal::Descriptor<FileType>>>;
 
+  // A subset of the descriptors, together with the lock protecting them.
+  struct DescriptorShard {
+    mutable simple_spinlock lock;
+
+    // Maps filenames to descriptors.
+    DescriptorMap<RWFile> rwf_descs;
+    DescriptorMap<RandomAccessFile> raf_descs;
+  };
+
+  // The number of shards of the descriptor maps.
+  static constexpr size_t kNumDescriptorShards = 16;
+
+  // Returns the shard holding the descriptors of 'file_name'.
+  DescriptorShard* ShardFor(const std::string& file_name) const;
+
   template <class FileType>
   FRIEND_TEST(FileCacheTest, TestBasicOperations);
 
@@ -200,7 +241,7 @@ class FileCache {
   // The value of 'created_desc' will be set in accordance with whether a new
   // descriptor was created.
   //
-  // Must be called with 'lock_' held.
+  // Must be called with the lock of the shard of 'file_name' held.
   enum class FindMode {
     // Only return an existing descriptor from the map; don't create a new one.
     DONT_CREATE,
@@ -218,6 +259,14 @@ class FileCache {
   // Periodically removes expired descriptors from the descriptor maps.
   void RunDescriptorExpiry();
 
+  // Reopens 'file_name' if it has an outstanding descriptor and was evicted.
+  void DoPrefetch(const std::string& file_name);
+
+  // Reopens the file behind 'desc', if any, unless it's already opened.
+  template <class FileType>
+  static void PrefetchDescriptor(
+      const std::shared_ptr<internal::Descriptor<FileType>>& desc);
+
   // Actually opens the file as per OpenFile. Used to encapsulate the bulk of
   // OpenFile because C++ prohibits partial specialization of template functions.
   template <class FileType>
@@ -241,12 +290,16 @@ class FileCache {
   // Underlying cache instance. Caches opened files.
   std::unique_ptr<Cache> cache_;
 
-  // Protects the descriptor map.
-  mutable simple_spinlock lock_;
+  // The descriptor maps, sharded by file name.
+  mutable DescriptorShard shards_[kNumDescriptorShards];
+
+  // Runs the reopens scheduled by Prefetch(). Unset if prefetching is
+  // disabled.
+  std::unique_ptr<ThreadPool> prefetch_pool_;
 
-  // Maps filenames to descriptors.
-  DescriptorMap<RWFile> rwf_descs_;
-  DescriptorMap<RandomAccessFile> raf_descs_;
+  // The files for which a reopen is scheduled.
+  simple_spinlock prefetch_lock_;
+  std::unordered_set<std::string> prefetches_in_flight_;
 
   // Calls RunDescriptorExpiry() in a loop until 'running_' isn't set.
   scoped_refptr<Thread> descriptor_expiry_thread_;
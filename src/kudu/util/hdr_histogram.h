@@ -55,6 +55,7 @@
 #include "kudu/gutil/atomicops.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
+#include "kudu/util/striped64.h"
 
 namespace kudu {
 
@@ -105,10 +106,10 @@ class HdrHistogram {
   int SubBucketIndex(uint64_t value, int bucket_index) const;
 
   // Count of all events recorded.
-  uint64_t TotalCount() const { return base::subtle::NoBarrier_Load(&total_count_); }
+  uint64_t TotalCount() const { return total_count_.Value(); }
 
   // Sum of all events recorded.
-  uint64_t TotalSum() const { return base::subtle::NoBarrier_Load(&total_sum_); }
+  uint64_t TotalSum() const { return total_sum_.Value(); }
 
   // Return number of items at index.
   uint64_t CountAt(int bucket_index, int sub_bucket_index) const;
@@ -198,9 +199,12 @@ class HdrHistogram {
   int sub_bucket_half_count_;
   uint32_t sub_bucket_mask_;
 
-  // Also hot.
-  base::subtle::Atomic64 total_count_;
-  base::subtle::Atomic64 total_sum_;
+  // Also hot. Every recorded value updates the total count and sum, which
+  // are striped so that the threads recording values concurrently don't all
+  // contend on the same cache lines. The counts of the buckets are spread
+  // out by the values, and the min and max are only written when exceeded.
+  LongAdder total_count_;
+  LongAdder total_sum_;
   base::subtle::Atomic64 min_value_;
   base::subtle::Atomic64 max_value_;
   std::unique_ptr<base::subtle::Atomic64[]> counts_;
@@ -0,0 +1,86 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/hyperloglog.h"
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "kudu/util/hash_util.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+
+using std::string;
+
+namespace kudu {
+
+namespace {
+
+uint64_t HashInt(int64_t v) {
+  return HashUtil::FastHash64(&v, sizeof(v), /*seed=*/0);
+}
+
+} // anonymous namespace
+
+TEST(HyperLogLogTest, Empty) {
+  HyperLogLog hll;
+  EXPECT_EQ(0, hll.Estimate());
+}
+
+TEST(HyperLogLogTest, Estimate) {
+  for (int64_t num_values : { 10, 1000, 100000, 1000000 }) {
+    SCOPED_TRACE(num_values);
+    HyperLogLog hll;
+    // Add every value twice: duplicates don't count.
+    for (int i = 0; i < 2; ++i) {
+      for (int64_t v = 0; v < num_values; ++v) {
+        hll.AddHash(HashInt(v));
+      }
+    }
+    // Allow for 4 times the standard error of the default precision.
+    const int64_t estimate = hll.Estimate();
+    EXPECT_NEAR(num_values, estimate, 0.26 * num_values);
+  }
+}
+
+TEST(HyperLogLogTest, MergeAndSerialize) {
+  HyperLogLog evens;
+  HyperLogLog odds;
+  for (int64_t v = 0; v < 100000; ++v) {
+    (v % 2 ? odds : evens).AddHash(HashInt(v));
+  }
+  HyperLogLog copy;
+  ASSERT_OK(HyperLogLog::FromRegisters(evens.registers(), &copy));
+  EXPECT_EQ(evens.Estimate(), copy.Estimate());
+  ASSERT_OK(copy.Merge(odds));
+  EXPECT_NEAR(100000, copy.Estimate(), 26000);
+
+  // Merging with itself or a subset changes nothing.
+  const int64_t estimate = copy.Estimate();
+  ASSERT_OK(copy.Merge(evens));
+  EXPECT_EQ(estimate, copy.Estimate());
+
+  HyperLogLog precise(12);
+  Status s = copy.Merge(precise);
+  EXPECT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  s = HyperLogLog::FromRegisters(string(100, '\0'), &copy);
+  EXPECT_TRUE(s.IsCorruption()) << s.ToString();
+}
+
+} // namespace kudu
@@ -0,0 +1,102 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/hyperloglog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/gutil/strings/substitute.h"
+
+using std::string;
+using strings::Substitute;
+
+namespace kudu {
+
+HyperLogLog::HyperLogLog(int precision)
+    : precision_(precision),
+      registers_(1 << precision, '\0') {
+  DCHECK_GE(precision, kMinPrecision);
+  DCHECK_LE(precision, kMaxPrecision);
+}
+
+Status HyperLogLog::FromRegisters(string registers, HyperLogLog* hll) {
+  const auto num_registers = registers.size();
+  for (int precision = kMinPrecision; precision <= kMaxPrecision; ++precision) {
+    if (num_registers == (static_cast<size_t>(1) << precision)) {
+      hll->precision_ = precision;
+      hll->registers_ = std::move(registers);
+      return Status::OK();
+    }
+  }
+  return Status::Corruption(
+      Substitute("invalid number of HyperLogLog registers: $0", num_registers));
+}
+
+void HyperLogLog::AddHash(uint64_t hash) {
+  // The first bits of the hash select the register, which keeps the largest
+  // position of the first set bit among the remaining bits of the hashes.
+  const uint64_t idx = hash >> (64 - precision_);
+  const uint64_t rest = hash << precision_;
+  const uint8_t rank = rest == 0 ? 64 - precision_ + 1 : __builtin_clzll(rest) + 1;
+  auto& reg = reinterpret_cast<uint8_t&>(registers_[idx]);
+  reg = std::max(reg, rank);
+}
+
+Status HyperLogLog::Merge(const HyperLogLog& other) {
+  if (other.precision_ != precision_) {
+    return Status::InvalidArgument(Substitute(
+        "cannot merge HyperLogLog sketches of precisions $0 and $1",
+        precision_, other.precision_));
+  }
+  for (size_t i = 0; i < registers_.size(); ++i) {
+    registers_[i] = std::max<uint8_t>(registers_[i], other.registers_[i]);
+  }
+  return Status::OK();
+}
+
+int64_t HyperLogLog::Estimate() const {
+  const double m = registers_.size();
+  double sum = 0;
+  int num_zeros = 0;
+  for (uint8_t reg : registers_) {
+    sum += std::ldexp(1.0, -reg);
+    if (reg == 0) {
+      ++num_zeros;
+    }
+  }
+  double alpha;
+  switch (registers_.size()) {
+    case 16: alpha = 0.673; break;
+    case 32: alpha = 0.697; break;
+    case 64: alpha = 0.709; break;
+    default: alpha = 0.7213 / (1 + 1.079 / m); break;
+  }
+  double estimate = alpha * m * m / sum;
+  if (estimate <= 2.5 * m && num_zeros > 0) {
+    // Small range correction: count the empty registers instead.
+    estimate = m * std::log(m / num_zeros);
+  }
+  // With 64-bit hashes, no large range correction is necessary.
+  return std::llround(estimate);
+}
+
+} // namespace kudu
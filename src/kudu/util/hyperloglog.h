@@ -0,0 +1,75 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+// A HyperLogLog sketch [1] estimating the number of distinct values among the
+// values whose hashes are added to it. Sketches with the same precision can be
+// merged, estimating the number of distinct values of the union of their sets
+// of values.
+//
+// The sketch has 2^precision one-byte registers, and the standard error of its
+// estimates is about 1.04 / sqrt(2^precision): 6.5% with the default precision.
+//
+// [1] Flajolet et al., "HyperLogLog: the analysis of a near-optimal
+//     cardinality estimation algorithm", 2007.
+//
+// This class is not thread-safe.
+class HyperLogLog {
+ public:
+  static constexpr int kDefaultPrecision = 8;
+  static constexpr int kMinPrecision = 4;
+  static constexpr int kMaxPrecision = 16;
+
+  explicit HyperLogLog(int precision = kDefaultPrecision);
+
+  // Creates a sketch from the 'registers' of another sketch, as returned by
+  // registers(). Returns Status::Corruption if their number isn't a valid
+  // number of registers.
+  static Status FromRegisters(std::string registers, HyperLogLog* hll);
+
+  // Adds a value by its 64-bit hash, which must be uniformly distributed.
+  void AddHash(uint64_t hash);
+
+  // Merges 'other' into this sketch. Returns Status::InvalidArgument if the
+  // sketches have different precisions.
+  Status Merge(const HyperLogLog& other);
+
+  // Returns the estimated number of distinct values added to the sketch.
+  int64_t Estimate() const;
+
+  // The registers of the sketch, to be persisted or sent over the wire.
+  const std::string& registers() const {
+    return registers_;
+  }
+
+  int precision() const {
+    return precision_;
+  }
+
+ private:
+  int precision_;
+  std::string registers_;
+};
+
+} // namespace kudu
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -26,7 +27,9 @@
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/slice.h"
 
+using std::string;
 using std::unique_ptr;
+using std::vector;
 
 namespace kudu {
 
@@ -87,4 +90,35 @@ TEST(TestInlineSlice, Test16ByteInline) {
   DoTest<16>();
 }
 
+// Compares slices of data sharing prefixes of various lengths, some of which
+// are stored inline and some indirectly along with their prefix.
+template<size_t N>
+static void DoCompareTest() {
+  Arena arena(1024);
+  const vector<string> data = {
+    "", "a", string("a\0", 2), "abcdefg", "abcdefgh", string("abcdefgh\0", 9),
+    "abcdefghi", "abcdefghij", "abcdefghijklmnopq", "abcdefghijklmnopr",
+    "abcdefgi", "b", "bcdefghijklmnopqrstuvwxyz", "\xff\xff\xff\xff\xff\xff\xff\xff\xff",
+  };
+  for (const auto& a : data) {
+    InlineSlice<N, true> slice;
+    slice.set(Slice(a), &arena);
+    for (const auto& b : data) {
+      const Slice other(b);
+      const int expected = Slice(a).compare(other);
+      const int actual = slice.compare(other, InlineSlice<N, true>::Prefix(other));
+      ASSERT_EQ(expected < 0, actual < 0) << a << " vs " << b;
+      ASSERT_EQ(expected > 0, actual > 0) << a << " vs " << b;
+    }
+  }
+}
+
+TEST(TestInlineSlice, TestCompare8Byte) {
+  DoCompareTest<8>();
+}
+
+TEST(TestInlineSlice, TestCompare16ByteWithPrefix) {
+  DoCompareTest<16>();
+}
+
 } // namespace kudu
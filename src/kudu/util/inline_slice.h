@@ -17,8 +17,13 @@
 #ifndef KUDU_UTIL_INLINE_SLICE_H
 #define KUDU_UTIL_INLINE_SLICE_H
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 #include "kudu/gutil/atomicops.h"
 #include "kudu/gutil/casts.h"
+#include "kudu/gutil/endian.h"
 #include "kudu/util/memory/arena.h"
 
 namespace kudu {
@@ -38,9 +43,11 @@ namespace kudu {
 //   buf_[1..1 + buf_[0]] == inline data
 // If buf_[0] == 0xff:
 //   buf_[1..sizeof(uint8_t *)] == pointer to indirect data, minus the MSB.
-//   buf_[sizeof(uint8_t *)..] = unused
-//     TODO: we could store a prefix of the indirect data in this unused space
-//     in the future, which might be able to short-circuit some comparisons
+//   buf_[sizeof(uint8_t *)..] = unused, unless there is room for a uint64_t:
+//   then, buf_[sizeof(uint8_t *)..sizeof(uint8_t *) + 8] == the first 8 bytes
+//   of the indirect data, zero-padded and loaded as a big-endian integer (see
+//   Prefix()). This allows compare() to order most slices without following
+//   the pointer to their data.
 //
 // The indirect data which is pointed to is stored as a 4 byte length followed by
 // the actual data.
@@ -64,7 +71,8 @@ class InlineSlice {
   enum {
     kPointerByteWidth = sizeof(uintptr_t),
     kPointerBitWidth = kPointerByteWidth * 8,
-    kMaxInlineData = STORAGE_SIZE - 1
+    kMaxInlineData = STORAGE_SIZE - 1,
+    kStoresPrefix = STORAGE_SIZE >= kPointerByteWidth + sizeof(uint64_t)
   };
 
   static_assert(STORAGE_SIZE >= kPointerByteWidth,
@@ -89,6 +97,32 @@ class InlineSlice {
     return Slice(&buf_[1], len);
   }
 
+  // Returns the first 8 bytes of 'key', zero-padded and loaded as a big-endian
+  // integer, so that comparing the prefixes of two slices as integers orders
+  // them as comparing their data would, ties aside.
+  static uint64_t Prefix(const Slice& key) {
+    uint8_t buf[sizeof(uint64_t)] = { 0 };
+    memcpy(buf, key.data(), std::min(key.size(), sizeof(buf)));
+    return BigEndian::Load64(buf);
+  }
+
+  // Compares the data of this slice with 'other', whose prefix as returned by
+  // Prefix() is 'other_prefix'. If this slice stores the prefix of its indirect
+  // data, the data is only read when the prefixes are equal.
+  int compare(const Slice& other, uint64_t other_prefix) const {
+    if (kStoresPrefix) {
+      DiscriminatedPointer dptr = LoadValue();
+      if (dptr.is_indirect()) {
+        uint64_t prefix;
+        memcpy(&prefix, &buf_[kPointerByteWidth], sizeof(prefix));
+        if (prefix != other_prefix) {
+          return prefix < other_prefix ? -1 : 1;
+        }
+      }
+    }
+    return as_slice().compare(other);
+  }
+
   template<class ArenaType>
   void set(const Slice &src, ArenaType *alloc_arena) {
     set(src.data(), src.size(), alloc_arena);
@@ -122,6 +156,13 @@ class InlineSlice {
       void *in_arena = CHECK_NOTNULL(alloc_arena->AllocateBytes(len + sizeof(uint32_t)));
       *reinterpret_cast<uint32_t *>(in_arena) = len;
       memcpy(reinterpret_cast<uint8_t *>(in_arena) + sizeof(uint32_t), src, len);
+      if (kStoresPrefix) {
+        // Stored before the pointer, so that it is visible to the readers who
+        // see the pointer. Readers who race with this may compare with a stale
+        // prefix, which is the kind of bad data the ATOMIC semantics allow.
+        uint64_t prefix = Prefix(Slice(src, len));
+        memcpy(&buf_[kPointerByteWidth], &prefix, sizeof(prefix));
+      }
       set_ptr(in_arena);
     }
   }
@@ -0,0 +1,163 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/io_uring.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/util/array_view.h"
+#include "kudu/util/env.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_bool(env_use_io_uring);
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+
+class IoUringTest : public KuduTest {
+ protected:
+  // Returns false if the tests can't use io_uring, e.g. because the kernel
+  // doesn't support it or it's disabled in the sandbox running the tests.
+  static bool IoUringAvailable() {
+    unique_ptr<IoUring> ring;
+    Status s = IoUring::Create(8, &ring);
+    if (!s.ok()) {
+      LOG(WARNING) << "Skipping test: " << s.ToString();
+      return false;
+    }
+    return true;
+  }
+};
+
+TEST_F(IoUringTest, TestBatchedReadsAndWrites) {
+  if (!IoUringAvailable()) {
+    GTEST_SKIP();
+  }
+  unique_ptr<IoUring> ring;
+  // A ring smaller than the batches, so that they take several rounds.
+  ASSERT_OK(IoUring::Create(4, &ring));
+  ASSERT_GE(ring->entries(), 4u);
+
+  const string path = GetTestPath("file");
+  int fd = open(path.c_str(), O_CREAT | O_RDWR, 0644);
+  ASSERT_GE(fd, 0);
+
+  const int kNumOps = 3 * ring->entries() + 1;
+  vector<string> data;
+  vector<struct iovec> iovs(kNumOps);
+  vector<IoUring::Op> ops(kNumOps);
+  for (int i = 0; i < kNumOps; i++) {
+    data.emplace_back(100, 'a' + i % 26);
+  }
+  for (int i = 0; i < kNumOps; i++) {
+    iovs[i] = { &data[i][0], data[i].size() };
+    ops[i].type = IoUring::Op::WRITEV;
+    ops[i].fd = fd;
+    ops[i].offset = i * 100;
+    ops[i].iov = &iovs[i];
+    ops[i].iov_count = 1;
+  }
+  ASSERT_OK(ring->SubmitAndWait(ops));
+  for (const auto& op : ops) {
+    ASSERT_EQ(100, op.result);
+  }
+
+  // Read the chunks back in reverse, along with a read past the end.
+  vector<string> read(kNumOps + 1, string(100, '\0'));
+  vector<IoUring::Op> read_ops(kNumOps + 1);
+  vector<struct iovec> read_iovs(kNumOps + 1);
+  for (int i = 0; i <= kNumOps; i++) {
+    read_iovs[i] = { &read[i][0], read[i].size() };
+    read_ops[i].type = IoUring::Op::READV;
+    read_ops[i].fd = fd;
+    read_ops[i].offset = (kNumOps - i) * 100;
+    read_ops[i].iov = &read_iovs[i];
+    read_ops[i].iov_count = 1;
+  }
+  ASSERT_OK(ring->SubmitAndWait(read_ops));
+  ASSERT_EQ(0, read_ops[0].result);
+  for (int i = 1; i <= kNumOps; i++) {
+    ASSERT_EQ(100, read_ops[i].result);
+    ASSERT_EQ(data[kNumOps - i], read[i]);
+  }
+
+  // Failures are reported in the results.
+  IoUring::Op bad_op;
+  bad_op.type = IoUring::Op::READV;
+  bad_op.fd = -1;
+  bad_op.iov = &read_iovs[0];
+  bad_op.iov_count = 1;
+  ASSERT_OK(ring->SubmitAndWait(ArrayView<IoUring::Op>(&bad_op, 1)));
+  ASSERT_EQ(-EBADF, bad_op.result);
+  close(fd);
+}
+
+// Vectored Env operations go through the ring when enabled, including those
+// with more than IOV_MAX slices.
+TEST_F(IoUringTest, TestEnvVectoredIO) {
+  if (!IoUringAvailable()) {
+    GTEST_SKIP();
+  }
+  FLAGS_env_use_io_uring = true;
+  const string path = GetTestPath("file");
+  unique_ptr<RWFile> file;
+  ASSERT_OK(env_->NewRWFile(path, &file));
+
+  const int kNumSlices = IOV_MAX * 2 + 3;
+  vector<string> data;
+  for (int i = 0; i < kNumSlices; i++) {
+    data.emplace_back(10, 'a' + i % 26);
+  }
+  vector<Slice> slices(data.begin(), data.end());
+  ASSERT_OK(file->WriteV(0, slices));
+  ASSERT_OK(file->Sync());
+
+  vector<string> read(kNumSlices, string(10, '\0'));
+  vector<Slice> results;
+  for (auto& r : read) {
+    results.emplace_back(&r[0], r.size());
+  }
+  ASSERT_OK(file->ReadV(0, results));
+  ASSERT_EQ(data, read);
+
+  // Reading past the end is still reported.
+  string past_end(20, '\0');
+  Slice past_end_slice(&past_end[0], past_end.size());
+  ASSERT_TRUE(file->Read(kNumSlices * 10 - 10, past_end_slice).IsEndOfFile());
+  ASSERT_OK(file->Close());
+}
+
+} // namespace kudu
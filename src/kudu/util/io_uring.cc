@@ -0,0 +1,248 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/io_uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define KUDU_HAS_IO_URING 1
+#endif
+#endif
+
+#if defined(KUDU_HAS_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+
+#include <glog/logging.h>
+
+#include "kudu/util/errno.h"
+
+using std::unique_ptr;
+
+namespace kudu {
+
+namespace {
+
+// The number of operations in flight in the ring of each thread.
+constexpr uint32_t kThreadRingEntries = 64;
+
+} // anonymous namespace
+
+IoUring::IoUring()
+    : ring_fd_(-1),
+      sq_ring_(nullptr),
+      sq_ring_size_(0),
+      cq_ring_(nullptr),
+      cq_ring_size_(0),
+      sqes_(nullptr),
+      sqes_size_(0),
+      sq_head_(nullptr),
+      sq_tail_(nullptr),
+      sq_mask_(nullptr),
+      sq_array_(nullptr),
+      sq_entries_(0),
+      cq_head_(nullptr),
+      cq_tail_(nullptr),
+      cq_mask_(nullptr),
+      cqes_(nullptr) {
+}
+
+#if defined(KUDU_HAS_IO_URING)
+
+IoUring::~IoUring() {
+  if (sqes_) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+Status IoUring::Create(uint32_t entries, unique_ptr<IoUring>* ring) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0) {
+    int err = errno;
+    if (err == ENOSYS) {
+      return Status::NotSupported("io_uring isn't supported by the kernel");
+    }
+    return Status::IOError("unable to set up an io_uring", ErrnoToString(err), err);
+  }
+  unique_ptr<IoUring> r(new IoUring());
+  r->ring_fd_ = fd;
+
+  r->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  r->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    r->sq_ring_size_ = std::max(r->sq_ring_size_, r->cq_ring_size_);
+    r->cq_ring_size_ = r->sq_ring_size_;
+  }
+  void* sq_ring = mmap(nullptr, r->sq_ring_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    int err = errno;
+    return Status::IOError("unable to map the io_uring submission queue",
+                           ErrnoToString(err), err);
+  }
+  r->sq_ring_ = sq_ring;
+  if (single_mmap) {
+    r->cq_ring_ = sq_ring;
+  } else {
+    void* cq_ring = mmap(nullptr, r->cq_ring_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      int err = errno;
+      return Status::IOError("unable to map the io_uring completion queue",
+                             ErrnoToString(err), err);
+    }
+    r->cq_ring_ = cq_ring;
+  }
+  r->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, r->sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    int err = errno;
+    return Status::IOError("unable to map the io_uring submission queue entries",
+                           ErrnoToString(err), err);
+  }
+  r->sqes_ = sqes;
+
+  uint8_t* sq = static_cast<uint8_t*>(r->sq_ring_);
+  r->sq_head_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+  r->sq_tail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+  r->sq_mask_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+  r->sq_array_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+  r->sq_entries_ = params.sq_entries;
+  uint8_t* cq = static_cast<uint8_t*>(r->cq_ring_);
+  r->cq_head_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+  r->cq_tail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+  r->cq_mask_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+  r->cqes_ = cq + params.cq_off.cqes;
+
+  *ring = std::move(r);
+  return Status::OK();
+}
+
+Status IoUring::SubmitAndWait(ArrayView<Op> ops) {
+  for (size_t begin = 0; begin < ops.size(); begin += sq_entries_) {
+    RETURN_NOT_OK(SubmitRound(ops, begin, std::min<size_t>(ops.size(), begin + sq_entries_)));
+  }
+  return Status::OK();
+}
+
+Status IoUring::SubmitRound(ArrayView<Op> ops, size_t begin, size_t end) {
+  DCHECK_LE(end - begin, sq_entries_);
+  // Only this thread moves the tail of the submission queue and the head of
+  // the completion queue, the kernel moves the others.
+  uint32_t tail = *sq_tail_;
+  const uint32_t sq_mask = *sq_mask_;
+  auto* sqes = static_cast<struct io_uring_sqe*>(sqes_);
+  for (size_t i = begin; i < end; i++) {
+    const Op& op = ops[i];
+    const uint32_t idx = tail & sq_mask;
+    struct io_uring_sqe* sqe = &sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = op.fd;
+    sqe->user_data = i;
+    sqe->opcode = op.type == Op::READV ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->off = op.offset;
+    sqe->addr = reinterpret_cast<uint64_t>(op.iov);
+    sqe->len = op.iov_count;
+    sq_array_[idx] = idx;
+    tail++;
+  }
+  __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+  size_t remaining = end - begin;
+  const uint32_t cq_mask = *cq_mask_;
+  auto* cqes = static_cast<struct io_uring_cqe*>(cqes_);
+  while (remaining > 0) {
+    // The entries which the kernel hasn't consumed yet, if an earlier call
+    // was interrupted.
+    const uint32_t to_submit = tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    int ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit, remaining,
+                      IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (ret < 0 && errno != EINTR) {
+      int err = errno;
+      return Status::IOError("unable to submit io_uring operations", ErrnoToString(err), err);
+    }
+    uint32_t head = *cq_head_;
+    const uint32_t cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != cq_tail) {
+      const struct io_uring_cqe& cqe = cqes[head & cq_mask];
+      DCHECK_LT(cqe.user_data, end);
+      ops[cqe.user_data].result = cqe.res;
+      head++;
+      remaining--;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+  return Status::OK();
+}
+
+#else
+
+IoUring::~IoUring() {
+}
+
+Status IoUring::Create(uint32_t /*entries*/, unique_ptr<IoUring>* /*ring*/) {
+  return Status::NotSupported("io_uring isn't supported on this platform");
+}
+
+Status IoUring::SubmitAndWait(ArrayView<Op> /*ops*/) {
+  LOG(FATAL) << "io_uring isn't supported on this platform";
+  return Status::OK();
+}
+
+Status IoUring::SubmitRound(ArrayView<Op> /*ops*/, size_t /*begin*/, size_t /*end*/) {
+  LOG(FATAL) << "io_uring isn't supported on this platform";
+  return Status::OK();
+}
+
+#endif // defined(KUDU_HAS_IO_URING)
+
+IoUring* IoUring::ForCurrentThread() {
+  static thread_local unique_ptr<IoUring> ring;
+  static thread_local bool created = false;
+  if (!created) {
+    created = true;
+    Status s = Create(kThreadRingEntries, &ring);
+    if (!s.ok()) {
+      LOG_FIRST_N(WARNING, 1) << "Unable to create an io_uring, falling back to "
+                              << "regular system calls: " << s.ToString();
+    }
+  }
+  return ring.get();
+}
+
+} // namespace kudu
@@ -0,0 +1,115 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/array_view.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+// An io_uring(7) submission and completion queue pair, which submits batches
+// of file operations with a single system call.
+//
+// The ring is set up with raw system calls, so it doesn't depend on liburing.
+// On platforms or kernels without io_uring, no ring can be created and the
+// callers are expected to fall back to the regular system calls.
+//
+// A ring isn't thread-safe: each thread uses its own, see ForCurrentThread().
+class IoUring {
+ public:
+  // An operation on a file.
+  struct Op {
+    enum Type {
+      // Reads into 'iov' at 'offset'.
+      READV,
+      // Writes 'iov' at 'offset'.
+      WRITEV,
+    };
+
+    Type type;
+    int fd;
+    uint64_t offset = 0;
+    const struct iovec* iov = nullptr;
+    int iov_count = 0;
+
+    // Set when the operation completes: the number of bytes transferred, or
+    // the negated errno of the failure.
+    int64_t result = 0;
+  };
+
+  ~IoUring();
+
+  // Creates a ring with room for at least 'entries' operations in flight.
+  // Returns NotSupported if the platform or the kernel has no io_uring.
+  static Status Create(uint32_t entries, std::unique_ptr<IoUring>* ring);
+
+  // Returns the ring of the calling thread, creating it on the first call,
+  // or nullptr if no ring can be created.
+  static IoUring* ForCurrentThread();
+
+  // Submits 'ops' and waits for all of them to complete, setting their
+  // results. Batches larger than the ring are submitted in several rounds.
+  //
+  // Only failures of the ring itself are returned: the failures of the
+  // operations are in their results.
+  Status SubmitAndWait(ArrayView<Op> ops);
+
+  // The number of operations the ring holds.
+  uint32_t entries() const {
+    return sq_entries_;
+  }
+
+ private:
+  IoUring();
+
+  // Submits the operations [begin, end) of 'ops', which fit in the ring.
+  Status SubmitRound(ArrayView<Op> ops, size_t begin, size_t end);
+
+  int ring_fd_;
+
+  // The mappings of the rings and of the submission queue entries.
+  void* sq_ring_;
+  size_t sq_ring_size_;
+  void* cq_ring_;
+  size_t cq_ring_size_;
+  void* sqes_;
+  size_t sqes_size_;
+
+  // Pointers into the submission queue ring.
+  uint32_t* sq_head_;
+  uint32_t* sq_tail_;
+  uint32_t* sq_mask_;
+  uint32_t* sq_array_;
+  uint32_t sq_entries_;
+
+  // Pointers into the completion queue ring.
+  uint32_t* cq_head_;
+  uint32_t* cq_tail_;
+  uint32_t* cq_mask_;
+  void* cqes_;
+
+  DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+
+} // namespace kudu
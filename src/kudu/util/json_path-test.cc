@@ -0,0 +1,91 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/util/json_path.h"
+
+#include <string>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <rapidjson/document.h>
+
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+
+using std::string;
+
+namespace kudu {
+
+namespace {
+
+// Returns the JSON text of the value at 'path' in 'json', or "<none>".
+string Find(const string& json, const string& path) {
+  rapidjson::Document doc;
+  CHECK_OK(ParseJson(json, &doc));
+  JsonPath json_path;
+  CHECK_OK(JsonPath::Parse(path, &json_path));
+  const rapidjson::Value* value = json_path.Find(doc);
+  if (value == nullptr) {
+    return "<none>";
+  }
+  string str;
+  AppendJson(*value, &str);
+  return str;
+}
+
+} // anonymous namespace
+
+TEST(JsonPathTest, TestFind) {
+  const string kDoc = R"({"a": {"b": [1, {"c": "x"}], "d e": null}, "f": true})";
+  EXPECT_EQ(R"({"a":{"b":[1,{"c":"x"}],"d e":null},"f":true})", Find(kDoc, "$"));
+  EXPECT_EQ(R"([1,{"c":"x"}])", Find(kDoc, "$.a.b"));
+  EXPECT_EQ("1", Find(kDoc, "$.a.b[0]"));
+  EXPECT_EQ(R"("x")", Find(kDoc, "$.a.b[1].c"));
+  EXPECT_EQ(R"("x")", Find(kDoc, R"($["a"]['b'][1]["c"])"));
+  EXPECT_EQ("null", Find(kDoc, "$.a['d e']"));
+  EXPECT_EQ("true", Find(kDoc, "$.f"));
+
+  // Missing members, out of bounds subscripts and mismatched types.
+  EXPECT_EQ("<none>", Find(kDoc, "$.g"));
+  EXPECT_EQ("<none>", Find(kDoc, "$.a.b[2]"));
+  EXPECT_EQ("<none>", Find(kDoc, "$.a[0]"));
+  EXPECT_EQ("<none>", Find(kDoc, "$.a.b.c"));
+  EXPECT_EQ("<none>", Find(kDoc, "$.f.g"));
+}
+
+TEST(JsonPathTest, TestParse) {
+  JsonPath path;
+  ASSERT_OK(JsonPath::Parse(R"($.a["b c"][3]['it\'s'])", &path));
+  ASSERT_EQ(R"($.a['b c'][3]['it\'s'])", path.ToString());
+
+  for (const char* bad : { "", "a.b", "$.", "$..a", "$[", "$[]", "$[x]", "$['a'", "$[1",
+                           "$a", "$[99999999999]" }) {
+    Status s = JsonPath::Parse(bad, &path);
+    ASSERT_TRUE(s.IsInvalidArgument()) << bad << ": " << s.ToString();
+  }
+}
+
+TEST(JsonPathTest, TestValidate) {
+  ASSERT_OK(ValidateJson(R"({"a": [1, 2.5, "x", null]})"));
+  ASSERT_OK(ValidateJson("3"));
+  for (const char* bad : { "", "{", R"({"a": })", "[1,]", "nul", "{} {}", "\"\xff\"" }) {
+    Status s = ValidateJson(bad);
+    ASSERT_TRUE(s.IsCorruption()) << bad << ": " << s.ToString();
+  }
+}
+
+} // namespace kudu
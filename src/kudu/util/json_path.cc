@@ -0,0 +1,185 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/util/json_path.h"
+
+#include <cctype>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+
+#include <rapidjson/encodings.h>
+#include <rapidjson/error/en.h>
+#include <rapidjson/rapidjson.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "kudu/gutil/strings/substitute.h"
+
+using std::string;
+using strings::Substitute;
+
+namespace kudu {
+
+Status ParseJson(const Slice& json, rapidjson::Document* doc) {
+  doc->Parse<rapidjson::kParseValidateEncodingFlag>(
+      reinterpret_cast<const char*>(json.data()), json.size());
+  if (doc->HasParseError()) {
+    return Status::Corruption(Substitute("invalid JSON at offset $0",
+                                         doc->GetErrorOffset()),
+                              rapidjson::GetParseError_En(doc->GetParseError()));
+  }
+  return Status::OK();
+}
+
+Status ValidateJson(const Slice& json) {
+  rapidjson::Document doc;
+  return ParseJson(json, &doc);
+}
+
+void AppendJson(const rapidjson::Value& value, string* dst) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  value.Accept(writer);
+  dst->append(buffer.GetString(), buffer.GetSize());
+}
+
+namespace {
+
+// Returns true if 'name' may be written as '.name' in a path.
+bool IsPlainMember(const string& name) {
+  if (name.empty()) {
+    return false;
+  }
+  for (char c : name) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+Status JsonPath::Parse(const string& path, JsonPath* json_path) {
+  const auto invalid = [&](const string& reason) {
+    return Status::InvalidArgument(Substitute("invalid JSON path '$0': $1", path, reason));
+  };
+  if (path.empty() || path[0] != '$') {
+    return invalid("must start with '$'");
+  }
+  JsonPath result;
+  size_t pos = 1;
+  while (pos < path.size()) {
+    Step step;
+    if (path[pos] == '.') {
+      const size_t begin = ++pos;
+      while (pos < path.size() && path[pos] != '.' && path[pos] != '[') {
+        pos++;
+      }
+      if (pos == begin) {
+        return invalid(Substitute("empty member name at offset $0", begin));
+      }
+      step.member = path.substr(begin, pos - begin);
+    } else if (path[pos] == '[') {
+      pos++;
+      if (pos < path.size() && (path[pos] == '\'' || path[pos] == '"')) {
+        const char quote = path[pos++];
+        while (pos < path.size() && path[pos] != quote) {
+          if (path[pos] == '\\' && pos + 1 < path.size()) {
+            pos++;
+          }
+          step.member.push_back(path[pos++]);
+        }
+        if (pos == path.size()) {
+          return invalid("unterminated member name");
+        }
+        pos++;
+      } else {
+        const size_t begin = pos;
+        uint64_t index = 0;
+        while (pos < path.size() && isdigit(static_cast<unsigned char>(path[pos]))) {
+          index = index * 10 + (path[pos++] - '0');
+          if (index > std::numeric_limits<uint32_t>::max()) {
+            return invalid(Substitute("array index out of range at offset $0", begin));
+          }
+        }
+        if (pos == begin) {
+          return invalid(Substitute("expected an array index at offset $0", begin));
+        }
+        step.is_index = true;
+        step.index = static_cast<uint32_t>(index);
+      }
+      if (pos == path.size() || path[pos] != ']') {
+        return invalid(Substitute("expected ']' at offset $0", pos));
+      }
+      pos++;
+    } else {
+      return invalid(Substitute("unexpected '$0' at offset $1", path[pos], pos));
+    }
+    result.steps_.emplace_back(std::move(step));
+  }
+  *json_path = std::move(result);
+  return Status::OK();
+}
+
+const rapidjson::Value* JsonPath::Find(const rapidjson::Value& doc) const {
+  const rapidjson::Value* value = &doc;
+  for (const auto& step : steps_) {
+    if (step.is_index) {
+      if (!value->IsArray() || step.index >= value->Size()) {
+        return nullptr;
+      }
+      value = &(*value)[step.index];
+    } else {
+      if (!value->IsObject()) {
+        return nullptr;
+      }
+      const auto it = value->FindMember(rapidjson::StringRef(step.member.data(),
+                                                             step.member.size()));
+      if (it == value->MemberEnd()) {
+        return nullptr;
+      }
+      value = &it->value;
+    }
+  }
+  return value;
+}
+
+string JsonPath::ToString() const {
+  string str = "$";
+  for (const auto& step : steps_) {
+    if (step.is_index) {
+      str.append(Substitute("[$0]", step.index));
+    } else if (IsPlainMember(step.member)) {
+      str.push_back('.');
+      str.append(step.member);
+    } else {
+      str.append("['");
+      for (char c : step.member) {
+        if (c == '\'' || c == '\\') {
+          str.push_back('\\');
+        }
+        str.push_back(c);
+      }
+      str.append("']");
+    }
+  }
+  return str;
+}
+
+} // namespace kudu
@@ -0,0 +1,68 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+// Parses the JSON document 'json' into 'doc', returning Status::Corruption if
+// it isn't a valid UTF-8 JSON document.
+Status ParseJson(const Slice& json, rapidjson::Document* doc);
+
+// Returns an error unless 'json' is a valid UTF-8 JSON document.
+Status ValidateJson(const Slice& json);
+
+// Serializes 'value' as compact JSON, appending it to 'dst'.
+void AppendJson(const rapidjson::Value& value, std::string* dst);
+
+// A path to a value of a JSON document, in the usual dollar notation: the
+// path starts with '$', the root of the document, followed by any number of
+// member accesses ('.name' or "['name']") and array subscripts ('[2]'),
+// e.g. "$.a.b[2]" or "$['first name']".
+class JsonPath {
+ public:
+  JsonPath() = default;
+
+  // Parses 'path' into 'json_path', returning Status::InvalidArgument if it
+  // isn't a valid path.
+  static Status Parse(const std::string& path, JsonPath* json_path);
+
+  // Returns the value at the path in 'doc', or nullptr if there's none.
+  const rapidjson::Value* Find(const rapidjson::Value& doc) const;
+
+  std::string ToString() const;
+
+ private:
+  // A member access, or an array subscript if 'is_index' is set.
+  struct Step {
+    bool is_index = false;
+    std::string member;
+    uint32_t index = 0;
+  };
+
+  std::vector<Step> steps_;
+};
+
+} // namespace kudu
@@ -44,6 +44,7 @@
 #include "kudu/util/maintenance_manager_metrics.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
+#include "kudu/util/mutex.h"
 #include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
@@ -70,6 +71,7 @@ METRIC_DEFINE_histogram(test, maintenance_op_duration,
 
 DECLARE_bool(enable_maintenance_manager);
 DECLARE_int64(log_target_replay_size_mb);
+DECLARE_int64(maintenance_manager_io_budget_per_dir_mb);
 DECLARE_double(maintenance_op_multiplier);
 DECLARE_int32(max_priority_range);
 namespace kudu {
@@ -100,6 +102,8 @@ class TestMaintenanceOp : public MaintenanceOp {
       update_stats_time_(MonoDelta::FromSeconds(0)),
       priority_(priority),
       workload_score_(0),
+      io_bytes_(0),
+      releases_memory_(false),
       update_stats_count_(0) {
   }
 
@@ -155,6 +159,7 @@ class TestMaintenanceOp : public MaintenanceOp {
     stats->set_logs_retained_bytes(logs_retained_bytes_);
     stats->set_perf_improvement(perf_improvement_);
     stats->set_workload_score(workload_score_);
+    stats->set_io_bytes(io_bytes_);
 
     ++update_stats_count_;
   }
@@ -194,6 +199,29 @@ class TestMaintenanceOp : public MaintenanceOp {
     workload_score_ = workload_score;
   }
 
+  void set_io_bytes(int64_t io_bytes) {
+    std::lock_guard<simple_spinlock> guard(lock_);
+    io_bytes_ = io_bytes;
+  }
+
+  void set_data_dirs(vector<string> data_dirs) {
+    std::lock_guard<simple_spinlock> guard(lock_);
+    data_dirs_ = std::move(data_dirs);
+  }
+
+  void set_releases_memory(bool releases_memory) {
+    releases_memory_ = releases_memory;
+  }
+
+  bool releases_memory() const override {
+    return releases_memory_;
+  }
+
+  vector<string> DataDirs() const override {
+    std::lock_guard<simple_spinlock> guard(lock_);
+    return data_dirs_;
+  }
+
   scoped_refptr<Histogram> DurationHistogram() const override {
     return maintenance_op_duration_;
   }
@@ -257,6 +285,11 @@ class TestMaintenanceOp : public MaintenanceOp {
 
   double workload_score_;
 
+  int64_t io_bytes_;
+  vector<string> data_dirs_;
+
+  std::atomic<bool> releases_memory_;
+
   // Number of times the 'UpdateStats()' method is called on this instance.
   uint64_t update_stats_count_;
 
@@ -400,6 +433,43 @@ TEST_F(MaintenanceManagerTest, TestNewOpsDontGetScheduledDuringUnregister) {
   ASSERT_LE(op1.DurationHistogram()->TotalCount(), 2);
 }
 
+// Test that the ops releasing memory run on the reserved threads while long
+// ops keep all the other threads busy, but that the other ops don't.
+TEST_F(MaintenanceManagerTest, TestReservedThreads) {
+  StopManager();
+  StartManager(1);
+  ASSERT_EQ(1, manager_->num_reserved_threads_);
+
+  TestMaintenanceOp long_op("long_op", MaintenanceOp::HIGH_IO_USAGE);
+  long_op.set_perf_improvement(10);
+  long_op.set_sleep_time(MonoDelta::FromSeconds(1));
+  manager_->RegisterOp(&long_op);
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_EQ(1, long_op.RunningGauge()->value());
+  });
+
+  TestMaintenanceOp other_op("other_op", MaintenanceOp::HIGH_IO_USAGE);
+  other_op.set_perf_improvement(1);
+  TestMaintenanceOp flush_op("flush_op", MaintenanceOp::HIGH_IO_USAGE);
+  flush_op.set_perf_improvement(1);
+  flush_op.set_releases_memory(true);
+  manager_->RegisterOp(&other_op);
+  manager_->RegisterOp(&flush_op);
+
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_EQ(0, other_op.remaining_runs());
+    ASSERT_EQ(0, long_op.remaining_runs());
+    ASSERT_EQ(0, flush_op.remaining_runs());
+    ASSERT_EQ(0, manager_->running_ops_);
+  });
+  ASSERT_LT(flush_op.completed_at(), long_op.completed_at());
+  ASSERT_GE(other_op.completed_at(), long_op.completed_at());
+
+  manager_->UnregisterOp(&long_op);
+  manager_->UnregisterOp(&other_op);
+  manager_->UnregisterOp(&flush_op);
+}
+
 // Test that we'll run an operation that doesn't improve performance when memory
 // pressure gets high.
 TEST_F(MaintenanceManagerTest, TestMemoryPressurePrioritizesMemory) {
@@ -495,6 +565,60 @@ TEST_F(MaintenanceManagerTest, TestLogRetentionPrioritization) {
   manager_->UnregisterOp(&op2);
 }
 
+// Test that ops which would exceed the I/O budget of their data directories
+// are deferred in favor of ops on other directories.
+TEST_F(MaintenanceManagerTest, TestIoBudgetPerDataDir) {
+  const int64_t kMB = 1024 * 1024;
+  FLAGS_maintenance_manager_io_budget_per_dir_mb = 100;
+
+  StopManager();
+
+  TestMaintenanceOp op1("op1", MaintenanceOp::HIGH_IO_USAGE);
+  op1.set_perf_improvement(10);
+  op1.set_io_bytes(60 * kMB);
+  op1.set_data_dirs({ "/data/a" });
+
+  TestMaintenanceOp op2("op2", MaintenanceOp::HIGH_IO_USAGE);
+  op2.set_perf_improvement(1);
+  op2.set_io_bytes(60 * kMB);
+  op2.set_data_dirs({ "/data/b" });
+
+  manager_->RegisterOp(&op1);
+  manager_->RegisterOp(&op2);
+
+  auto op_and_why = manager_->FindBestOp();
+  ASSERT_EQ(&op1, op_and_why.first);
+
+  // While an instance of op1 runs on its data directory, another one would
+  // exceed its budget, so op2 is preferred.
+  MaintenanceManager::ResourceCharge charge;
+  charge.data_dirs = { "/data/a" };
+  charge.io_bytes = 60 * kMB;
+  {
+    std::lock_guard<Mutex> guard(manager_->running_instances_lock_);
+    manager_->ChargeResourcesUnlocked(charge);
+  }
+  op_and_why = manager_->FindBestOp();
+  ASSERT_EQ(&op2, op_and_why.first);
+
+  // With a larger budget, op1 fits again.
+  FLAGS_maintenance_manager_io_budget_per_dir_mb = 200;
+  op_and_why = manager_->FindBestOp();
+  ASSERT_EQ(&op1, op_and_why.first);
+
+  // Once the running instance completes, op1 fits any budget.
+  FLAGS_maintenance_manager_io_budget_per_dir_mb = 1;
+  {
+    std::lock_guard<Mutex> guard(manager_->running_instances_lock_);
+    manager_->ReleaseResourcesUnlocked(charge);
+  }
+  op_and_why = manager_->FindBestOp();
+  ASSERT_EQ(&op1, op_and_why.first);
+
+  manager_->UnregisterOp(&op1);
+  manager_->UnregisterOp(&op2);
+}
+
 // Test that ops are prioritized correctly when under memory pressure.
 TEST_F(MaintenanceManagerTest, TestPrioritizeLogRetentionUnderMemoryPressure) {
   StopManager();
@@ -41,11 +41,13 @@
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/debug/trace_logging.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/hdr_histogram.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/maintenance_manager.pb.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/process_memory.h"
+#include "kudu/util/profiler_tag.h"
 #include "kudu/util/random_util.h"
 #include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/stopwatch.h"
@@ -67,6 +69,17 @@ TAG_FLAG(maintenance_manager_num_threads, stable);
 DEFINE_validator(maintenance_manager_num_threads,
                  [](const char* /*n*/, int32 v) { return v > 0; });
 
+DEFINE_int32(maintenance_manager_num_reserved_threads, 1,
+             "Number of threads of the maintenance manager, on top of "
+             "--maintenance_manager_num_threads, which are reserved for the "
+             "operations releasing memory and WAL retention, like flushes and "
+             "log GC. This prevents urgent flushes from waiting behind long "
+             "compactions when all the other threads are busy.");
+TAG_FLAG(maintenance_manager_num_reserved_threads, advanced);
+TAG_FLAG(maintenance_manager_num_reserved_threads, experimental);
+DEFINE_validator(maintenance_manager_num_reserved_threads,
+                 [](const char* /*n*/, int32 v) { return v >= 0; });
+
 DEFINE_int32(maintenance_manager_polling_interval_ms, 250,
              "Polling interval for the maintenance manager scheduler, "
              "in milliseconds.");
@@ -116,6 +129,31 @@ TAG_FLAG(max_priority_range, advanced);
 TAG_FLAG(max_priority_range, experimental);
 TAG_FLAG(max_priority_range, runtime);
 
+DEFINE_int64(maintenance_manager_io_budget_per_dir_mb, 0,
+             "The maximum estimated I/O, in mebibytes, of the maintenance "
+             "operations running concurrently on any data directory. An operation "
+             "which would exceed the budget of one of its data directories is "
+             "deferred until operations running there complete, so that flushes "
+             "and compactions spread across the data directories instead of "
+             "saturating one of them. An operation is never deferred if no other "
+             "operation runs on its data directories. If 0, the I/O isn't budgeted.");
+TAG_FLAG(maintenance_manager_io_budget_per_dir_mb, advanced);
+TAG_FLAG(maintenance_manager_io_budget_per_dir_mb, experimental);
+TAG_FLAG(maintenance_manager_io_budget_per_dir_mb, runtime);
+DEFINE_validator(maintenance_manager_io_budget_per_dir_mb,
+                 [](const char* /*n*/, int64 v) { return v >= 0; });
+
+DEFINE_double(maintenance_manager_cpu_budget_seconds, 0,
+              "The maximum total estimated CPU time, in seconds, of the maintenance "
+              "operations running concurrently. An operation which would exceed the "
+              "budget is deferred until some running operations complete, unless no "
+              "other operation is running. If 0, the CPU time isn't budgeted.");
+TAG_FLAG(maintenance_manager_cpu_budget_seconds, advanced);
+TAG_FLAG(maintenance_manager_cpu_budget_seconds, experimental);
+TAG_FLAG(maintenance_manager_cpu_budget_seconds, runtime);
+DEFINE_validator(maintenance_manager_cpu_budget_seconds,
+                 [](const char* /*n*/, double v) { return v >= 0; });
+
 DEFINE_int32(maintenance_manager_inject_latency_ms, 0,
              "Injects latency into maintenance thread. For use in tests only.");
 TAG_FLAG(maintenance_manager_inject_latency_ms, runtime);
@@ -135,6 +173,8 @@ void MaintenanceOpStats::Clear() {
   data_retained_bytes_ = 0;
   perf_improvement_ = 0;
   workload_score_ = 0;
+  io_bytes_ = 0;
+  cpu_seconds_ = 0;
   last_modified_ = MonoTime();
 }
 
@@ -155,6 +195,15 @@ void MaintenanceOp::Unregister() {
   manager_->UnregisterOp(this);
 }
 
+double MaintenanceOp::MeanDurationSeconds() const {
+  const auto histogram = DurationHistogram();
+  if (histogram->TotalCount() == 0) {
+    return 0;
+  }
+  // The duration histograms of the ops are in milliseconds.
+  return histogram->histogram()->MeanValue() / 1000;
+}
+
 MaintenanceManagerStatusPB_OpInstancePB OpInstance::DumpToPB() const {
   MaintenanceManagerStatusPB_OpInstancePB pb;
   pb.set_thread_id(thread_id);
@@ -181,6 +230,7 @@ MaintenanceManager::MaintenanceManager(
       num_threads_(options.num_threads > 0
                    ? options.num_threads
                    : FLAGS_maintenance_manager_num_threads),
+      num_reserved_threads_(FLAGS_maintenance_manager_num_reserved_threads),
       polling_interval_(MonoDelta::FromMilliseconds(
           options.polling_interval_ms > 0
               ? options.polling_interval_ms
@@ -188,6 +238,7 @@ MaintenanceManager::MaintenanceManager(
       cond_(&lock_),
       shutdown_(false),
       running_ops_(0),
+      running_unreserved_ops_(0),
       completed_ops_(options.history_size
                          ? options.history_size
                          : FLAGS_maintenance_manager_history_size),
@@ -196,8 +247,8 @@ MaintenanceManager::MaintenanceManager(
       memory_pressure_func_(&process_memory::UnderMemoryPressure),
       metrics_(CHECK_NOTNULL(metric_entity)) {
   CHECK_OK(ThreadPoolBuilder("MaintenanceMgr")
-               .set_min_threads(num_threads_)
-               .set_max_threads(num_threads_)
+               .set_min_threads(num_threads_ + num_reserved_threads_)
+               .set_max_threads(num_threads_ + num_reserved_threads_)
                .Build(&thread_pool_));
 }
 
@@ -322,6 +373,7 @@ void MaintenanceManager::RunSchedulerThread() {
     }
     MaintenanceOp* op = nullptr;
     string op_note;
+    ResourceCharge charge;
     {
       std::unique_lock<Mutex> guard(lock_);
       // Upon each iteration, we should have dropped and reacquired 'lock_'.
@@ -368,6 +420,8 @@ void MaintenanceManager::RunSchedulerThread() {
           continue;
         }
         IncreaseOpCount(op);
+        charge = ChargeFor(op, FindOrDie(ops_, op));
+        ChargeResourcesUnlocked(charge);
         prev_iter_found_no_work = false;
       } else {
         VLOG_AND_TRACE_WITH_PREFIX("maintenance", 2)
@@ -384,6 +438,7 @@ void MaintenanceManager::RunSchedulerThread() {
                             << ". Re-running scheduler.";
       metrics_.SubmitOpPrepareFailed();
       std::lock_guard<Mutex> guard(running_instances_lock_);
+      ReleaseResourcesUnlocked(charge);
       DecreaseOpCountAndNotifyWaiters(op);
       continue;
     }
@@ -391,7 +446,9 @@ void MaintenanceManager::RunSchedulerThread() {
     LOG_AND_TRACE_WITH_PREFIX("maintenance", INFO)
         << Substitute("Scheduling $0: $1", op->name(), op_note);
     // Submit the maintenance operation to be run on the "MaintenanceMgr" pool.
-    CHECK_OK(thread_pool_->Submit([this, op]() { this->LaunchOp(op); }));
+    CHECK_OK(thread_pool_->Submit([this, op, charge = std::move(charge)]() {
+      this->LaunchOp(op, charge);
+    }));
   }
 }
 
@@ -409,6 +466,12 @@ void MaintenanceManager::RunSchedulerThread() {
 // - Finally, if there's nothing else that we really need to do, we run the Op
 //   that will improve performance the most.
 //
+// Ops which don't release memory can't run on the threads reserved for those
+// which do.
+//
+// Ops which would exceed the I/O budget of one of their data directories, or
+// the CPU budget, aren't considered until some running ops complete.
+//
 // In general, we want to prioritize limiting the amount of expensive resources
 // we hold onto. Low IO ops that free WAL disk space are preferred, followed by
 // ops that free memory, then ops that free data disk space, then ops that
@@ -438,6 +501,15 @@ pair<MaintenanceOp*, string> MaintenanceManager::FindBestOp() {
 
   double best_perf_improvement = 0;
   MaintenanceOp* best_perf_improvement_op = nullptr;
+
+  // If only reserved threads are free, only the ops releasing memory may run.
+  const bool has_free_unreserved_threads = HasFreeUnreservedThreads();
+
+  ResourceUsage usage;
+  {
+    std::lock_guard<Mutex> guard(running_instances_lock_);
+    usage = running_usage_;
+  }
   for (auto& val : ops_) {
     MaintenanceOp* op(val.first);
     MaintenanceOpStats& stats(val.second);
@@ -448,6 +520,15 @@ pair<MaintenanceOp*, string> MaintenanceManager::FindBestOp() {
     if (op->cancelled() || !stats.valid() || !stats.runnable()) {
       continue;
     }
+    if (!has_free_unreserved_threads && !op->releases_memory()) {
+      continue;
+    }
+    if (!FitsBudgets(ChargeFor(op, stats), usage)) {
+      VLOG_AND_TRACE_WITH_PREFIX("maintenance", 2)
+          << Substitute("Op $0 deferred: its I/O or CPU would exceed the budget",
+                        op->name());
+      continue;
+    }
 
     const auto logs_retained_bytes = stats.logs_retained_bytes();
     if (op->io_usage() == MaintenanceOp::LOW_IO_USAGE &&
@@ -560,7 +641,52 @@ double MaintenanceManager::AdjustedPerfScore(double perf_improvement,
   return perf_score * std::pow(FLAGS_maintenance_op_multiplier, priority);
 }
 
-void MaintenanceManager::LaunchOp(MaintenanceOp* op) {
+MaintenanceManager::ResourceCharge MaintenanceManager::ChargeFor(
+    const MaintenanceOp* op, const MaintenanceOpStats& stats) {
+  ResourceCharge charge;
+  charge.io_bytes = stats.io_bytes();
+  charge.cpu_seconds = stats.cpu_seconds();
+  if (charge.io_bytes > 0 && FLAGS_maintenance_manager_io_budget_per_dir_mb > 0) {
+    charge.data_dirs = op->DataDirs();
+  }
+  return charge;
+}
+
+bool MaintenanceManager::FitsBudgets(const ResourceCharge& charge, const ResourceUsage& usage) {
+  const int64_t io_budget = FLAGS_maintenance_manager_io_budget_per_dir_mb * 1024 * 1024;
+  for (const auto& dir : charge.data_dirs) {
+    const int64_t* io_bytes = FindOrNull(usage.io_bytes_by_dir, dir);
+    if (io_bytes && *io_bytes > 0 && *io_bytes + charge.io_bytes > io_budget) {
+      return false;
+    }
+  }
+  const double cpu_budget = FLAGS_maintenance_manager_cpu_budget_seconds;
+  return cpu_budget <= 0 || usage.cpu_seconds <= 0 ||
+      usage.cpu_seconds + charge.cpu_seconds <= cpu_budget;
+}
+
+void MaintenanceManager::ChargeResourcesUnlocked(const ResourceCharge& charge) {
+  running_instances_lock_.AssertAcquired();
+  for (const auto& dir : charge.data_dirs) {
+    running_usage_.io_bytes_by_dir[dir] += charge.io_bytes;
+  }
+  running_usage_.cpu_seconds += charge.cpu_seconds;
+}
+
+void MaintenanceManager::ReleaseResourcesUnlocked(const ResourceCharge& charge) {
+  running_instances_lock_.AssertAcquired();
+  for (const auto& dir : charge.data_dirs) {
+    auto it = running_usage_.io_bytes_by_dir.find(dir);
+    DCHECK(it != running_usage_.io_bytes_by_dir.end());
+    it->second -= charge.io_bytes;
+    if (it->second <= 0) {
+      running_usage_.io_bytes_by_dir.erase(it);
+    }
+  }
+  running_usage_.cpu_seconds = std::max(0.0, running_usage_.cpu_seconds - charge.cpu_seconds);
+}
+
+void MaintenanceManager::LaunchOp(MaintenanceOp* op, const ResourceCharge& charge) {
   const auto thread_id = Thread::CurrentThreadId();
   OpInstance op_instance;
   op_instance.thread_id = thread_id;
@@ -586,6 +712,7 @@ void MaintenanceManager::LaunchOp(MaintenanceOp* op) {
       op_instance.duration = now - op_instance.start_mono_time;
       op->DurationHistogram()->Increment(op_instance.duration.ToMilliseconds());
 
+      ReleaseResourcesUnlocked(charge);
       DecreaseOpCountAndNotifyWaiters(op);
     }
     cond_.Signal(); // wake up the scheduler
@@ -606,6 +733,7 @@ void MaintenanceManager::LaunchOp(MaintenanceOp* op) {
     ADOPT_TRACE(trace.get());
     TRACE_EVENT1("maintenance", "MaintenanceManager::LaunchOp",
                  "name", op->name());
+    ScopedProfilerTag tag(Substitute("maintenance=$0", op->name()));
     op->Perform();
     sw.stop();
   }
@@ -633,6 +761,8 @@ void MaintenanceManager::GetMaintenanceManagerStatusDump(
       op_pb->set_perf_improvement(stats.perf_improvement());
       op_pb->set_workload_score(stats.workload_score());
       op_pb->set_data_retained_bytes(stats.data_retained_bytes());
+      op_pb->set_io_bytes(stats.io_bytes());
+      op_pb->set_cpu_seconds(stats.cpu_seconds());
     } else {
       op_pb->set_runnable(false);
       op_pb->set_ram_anchored_bytes(0);
@@ -640,6 +770,8 @@ void MaintenanceManager::GetMaintenanceManagerStatusDump(
       op_pb->set_perf_improvement(0.0);
       op_pb->set_workload_score(0.0);
       op_pb->set_data_retained_bytes(0);
+      op_pb->set_io_bytes(0);
+      op_pb->set_cpu_seconds(0.0);
     }
   }
 
@@ -672,7 +804,11 @@ string MaintenanceManager::LogPrefix() const {
 }
 
 bool MaintenanceManager::HasFreeThreads() {
-  return num_threads_ > running_ops_;
+  return num_threads_ + num_reserved_threads_ > running_ops_;
+}
+
+bool MaintenanceManager::HasFreeUnreservedThreads() {
+  return num_threads_ > running_unreserved_ops_;
 }
 
 bool MaintenanceManager::CouldNotLaunchNewOp(bool prev_iter_found_no_work) {
@@ -683,12 +819,18 @@ bool MaintenanceManager::CouldNotLaunchNewOp(bool prev_iter_found_no_work) {
 void MaintenanceManager::IncreaseOpCount(MaintenanceOp* op) {
   running_instances_lock_.AssertAcquired();
   ++running_ops_;
+  if (!op->releases_memory()) {
+    ++running_unreserved_ops_;
+  }
   ++op->running_;
 }
 
 void MaintenanceManager::DecreaseOpCountAndNotifyWaiters(MaintenanceOp* op) {
   running_instances_lock_.AssertAcquired();
   --running_ops_;
+  if (!op->releases_memory()) {
+    --running_unreserved_ops_;
+  }
   --op->running_;
   op->cond_->Signal();
 }
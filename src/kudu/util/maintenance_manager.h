@@ -122,6 +122,26 @@ class MaintenanceOpStats {
     workload_score_ = workload_score;
   }
 
+  int64_t io_bytes() const {
+    DCHECK(valid_);
+    return io_bytes_;
+  }
+
+  void set_io_bytes(int64_t io_bytes) {
+    UpdateLastModified();
+    io_bytes_ = io_bytes;
+  }
+
+  double cpu_seconds() const {
+    DCHECK(valid_);
+    return cpu_seconds_;
+  }
+
+  void set_cpu_seconds(double cpu_seconds) {
+    UpdateLastModified();
+    cpu_seconds_ = cpu_seconds;
+  }
+
   const MonoTime& last_modified() const {
     DCHECK(valid_);
     return last_modified_;
@@ -164,6 +184,13 @@ class MaintenanceOpStats {
 
   double workload_score_;
 
+  // The approximate number of bytes this operation would read and write, on
+  // the data directories returned by MaintenanceOp::DataDirs(). May be 0.
+  int64_t io_bytes_;
+
+  // The approximate CPU time this operation would take, in seconds. May be 0.
+  double cpu_seconds_;
+
   // The last time that the stats were modified.
   MonoTime last_modified_;
 };
@@ -231,12 +258,26 @@ class MaintenanceOp {
   // Returns the gauge for this op that tracks when this op is running. Cannot be NULL.
   virtual scoped_refptr<AtomicGauge<uint32_t>> RunningGauge() const = 0;
 
+  // Returns the data directories this op reads and writes, so that the I/O of
+  // the ops can be budgeted per directory. Only called when the op's stats
+  // estimate some I/O, while the maintenance manager lock is held.
+  virtual std::vector<std::string> DataDirs() const {
+    return {};
+  }
+
   uint32_t running() const { return running_; }
 
   const std::string& name() const { return name_; }
 
   IOUsage io_usage() const { return io_usage_; }
 
+  // Returns true if this op releases memory or WAL retention, like flushes
+  // do. Such ops may also run on the threads the maintenance manager reserves
+  // for them, so that they don't wait behind long compactions.
+  virtual bool releases_memory() const {
+    return false;
+  }
+
   // Return true if the operation has been cancelled due to a pending Unregister().
   bool cancelled() const {
     return cancel_;
@@ -255,6 +296,10 @@ class MaintenanceOp {
 
   virtual int32_t priority() const = 0;
 
+  // Returns the mean duration of the previous runs of this op, in seconds, or
+  // 0 if it never ran. Suitable as an estimate of its CPU time.
+  double MeanDurationSeconds() const;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(MaintenanceOp);
 
@@ -341,10 +386,26 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   FRIEND_TEST(MaintenanceManagerTest, TestPrioritizeLogRetentionUnderMemoryPressure);
   FRIEND_TEST(MaintenanceManagerTest, TestOpFactors);
   FRIEND_TEST(MaintenanceManagerTest, VerifyMetrics);
+  FRIEND_TEST(MaintenanceManagerTest, TestIoBudgetPerDataDir);
+  FRIEND_TEST(MaintenanceManagerTest, TestReservedThreads);
 
   typedef std::map<MaintenanceOp*, MaintenanceOpStats,
           MaintenanceOpComparator> OpMapType;
 
+  // The resources an instance of an op was estimated to use when it was
+  // launched, which are released once it completes.
+  struct ResourceCharge {
+    std::vector<std::string> data_dirs;
+    int64_t io_bytes = 0;
+    double cpu_seconds = 0;
+  };
+
+  // The estimated resources used by the running op instances.
+  struct ResourceUsage {
+    std::unordered_map<std::string, int64_t> io_bytes_by_dir;
+    double cpu_seconds = 0;
+  };
+
   // Return true if tests have currently disabled the maintenance
   // manager by way of changing the gflags at runtime.
   bool disabled_for_tests() const;
@@ -361,12 +422,34 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   // and the table's priority.
   static double AdjustedPerfScore(double perf_improvement, double workload_score, int32_t priority);
 
-  void LaunchOp(MaintenanceOp* op);
+  // Returns the resources an instance of 'op', whose stats are 'stats', is
+  // estimated to use. The data directories are only looked up if the I/O of
+  // the ops is budgeted.
+  static ResourceCharge ChargeFor(const MaintenanceOp* op, const MaintenanceOpStats& stats);
+
+  // Returns true if an op instance using the resources of 'charge' fits the
+  // I/O budget of each of its data directories and the CPU budget, on top of
+  // the running op instances using 'usage'. An instance always fits the
+  // budget of a resource no running instance uses, so that no op can be
+  // deferred forever.
+  static bool FitsBudgets(const ResourceCharge& charge, const ResourceUsage& usage);
+
+  // Adds or removes the resources of 'charge' from 'running_usage_'. Must be
+  // called while 'running_instances_lock_' is held.
+  void ChargeResourcesUnlocked(const ResourceCharge& charge);
+  void ReleaseResourcesUnlocked(const ResourceCharge& charge);
+
+  void LaunchOp(MaintenanceOp* op, const ResourceCharge& charge);
 
   std::string LogPrefix() const;
 
+  // Returns true if some op may be launched: some thread is free, at least
+  // one of the reserved ones.
   bool HasFreeThreads();
 
+  // Returns true if an op which doesn't release memory may be launched.
+  bool HasFreeUnreservedThreads();
+
   bool CouldNotLaunchNewOp(bool prev_iter_found_no_work);
 
   void IncreaseOpCount(MaintenanceOp *op);
@@ -378,6 +461,9 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
 
   const std::string server_uuid_;
   const int32_t num_threads_;
+  // The number of threads on top of 'num_threads_' which only run the ops
+  // that release memory.
+  const int32_t num_reserved_threads_;
   const MonoDelta polling_interval_;
 
   // Ops for which RegisterOp() has been called, but that have not yet been
@@ -408,6 +494,9 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   // This field is atomic because it's written under 'running_instances_lock_'
   // and read when the latter lock isn't held.
   std::atomic<int32_t> running_ops_;
+  // Same as 'running_ops_', but only counts the ops which don't release
+  // memory.
+  std::atomic<int32_t> running_unreserved_ops_;
 
   // Lock to guard access to 'completed_ops_' and 'completed_ops_count_'.
   simple_spinlock completed_ops_lock_;
@@ -437,6 +526,11 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   // Protected by running_instances_lock_;
   std::unordered_map<int64_t, OpInstance*> running_instances_;
 
+  // The estimated resources used by the running instances.
+  //
+  // Protected by running_instances_lock_;
+  ResourceUsage running_usage_;
+
   // MM-specific metrics.
   MaintenanceManagerMetrics metrics_;
 
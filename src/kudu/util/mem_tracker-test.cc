@@ -380,6 +380,36 @@ TEST(MemTrackerTest, CollisionDetection) {
 #endif
 }
 
+// Threads batch their changes of the consumption of the root tracker, which
+// must add up once they exit.
+TEST(MemTrackerTest, TestMultiThreadedRootConsumption) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumConsumptions = 10000;
+  constexpr int64_t kBytes = 100;
+  constexpr int64_t kRetainedBytes = kNumConsumptions / 2 * kBytes;
+  shared_ptr<MemTracker> root = MemTracker::GetRootTracker();
+  shared_ptr<MemTracker> t = MemTracker::CreateTracker(-1, "t");
+  const int64_t root_consumption = root->consumption();
+  vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&t] {
+      for (int j = 0; j < kNumConsumptions; j++) {
+        t->Consume(kBytes);
+      }
+      t->Release(kNumConsumptions * kBytes - kRetainedBytes);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(kNumThreads * kRetainedBytes, t->consumption());
+  ASSERT_EQ(root_consumption + kNumThreads * kRetainedBytes, root->consumption());
+
+  t->Release(kNumThreads * kRetainedBytes);
+  ASSERT_EQ(0, t->consumption());
+  ASSERT_EQ(root_consumption, root->consumption());
+}
+
 TEST(MemTrackerTest, TestMultiThreadedRegisterAndDestroy) {
   std::atomic<bool> done(false);
   vector<std::thread> threads;
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdlib>
 #include <deque>
 #include <limits>
 #include <list>
@@ -53,6 +54,19 @@ using strings::Substitute;
 static shared_ptr<MemTracker> root_tracker;
 static GoogleOnceType root_tracker_once = GOOGLE_ONCE_INIT;
 
+// The changes of the consumption of the root tracker each thread accumulates
+// before adding them to it. The consumption of the root seen by other threads
+// is off by at most this many bytes per thread.
+static const int64_t kRootConsumptionBatchBytes = 64 * 1024;
+
+thread_local MemTracker::ThreadRootConsumption MemTracker::ThreadRootConsumption::instance;
+
+MemTracker::ThreadRootConsumption::~ThreadRootConsumption() {
+  if (pending != 0 && root_tracker) {
+    root_tracker->consumption_.IncrementBy(pending);
+  }
+}
+
 void MemTracker::CreateRootTracker() {
   root_tracker.reset(new MemTracker(-1, "root", shared_ptr<MemTracker>()));
   root_tracker->Init();
@@ -231,7 +245,7 @@ void MemTracker::Consume(int64_t bytes) {
     return;
   }
   for (auto& tracker : all_trackers_) {
-    tracker->consumption_.IncrementBy(bytes);
+    tracker->IncrementConsumption(bytes);
   }
 }
 
@@ -246,7 +260,7 @@ bool MemTracker::TryConsume(int64_t bytes) {
   for (i = all_trackers_.size() - 1; i >= 0; --i) {
     MemTracker *tracker = all_trackers_[i];
     if (tracker->limit_ < 0) {
-      tracker->consumption_.IncrementBy(bytes);
+      tracker->IncrementConsumption(bytes);
     } else {
       if (!tracker->consumption_.TryIncrementBy(bytes, tracker->limit_)) {
         break;
@@ -264,7 +278,7 @@ bool MemTracker::TryConsume(int64_t bytes) {
   // for error reporting so this is probably okay. Rolling those back is
   // pretty hard; we'd need something like 2PC.
   for (int j = all_trackers_.size() - 1; j > i; --j) {
-    all_trackers_[j]->consumption_.IncrementBy(-bytes);
+    all_trackers_[j]->IncrementConsumption(-bytes);
   }
   return false;
 }
@@ -287,11 +301,38 @@ void MemTracker::Release(int64_t bytes) {
   }
 
   for (auto& tracker : all_trackers_) {
-    tracker->consumption_.IncrementBy(-bytes);
+    tracker->IncrementConsumption(-bytes);
   }
   process_memory::MaybeGCAfterRelease(bytes);
 }
 
+void MemTracker::IncrementConsumption(int64_t bytes) {
+  if (PREDICT_TRUE(parent_)) {
+    consumption_.IncrementBy(bytes);
+  } else {
+    IncrementRootConsumption(bytes);
+  }
+}
+
+void MemTracker::IncrementRootConsumption(int64_t bytes) {
+  DCHECK(!parent_);
+  DCHECK(!has_limit());
+  int64_t& pending = ThreadRootConsumption::instance.pending;
+  pending += bytes;
+  // Also add the changes right away if they may make for a new peak, so that
+  // the peak consumption stays accurate.
+  if (std::abs(pending) >= kRootConsumptionBatchBytes ||
+      (pending > 0 && consumption_.current_value() + pending > consumption_.max_value())) {
+    consumption_.IncrementBy(pending);
+    pending = 0;
+  }
+}
+
+int64_t MemTracker::RootConsumption() const {
+  DCHECK(!parent_);
+  return consumption_.current_value() + ThreadRootConsumption::instance.pending;
+}
+
 bool MemTracker::AnyLimitExceeded() {
   for (const auto& tracker : limit_trackers_) {
     if (tracker->LimitExceeded()) {
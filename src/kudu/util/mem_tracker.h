@@ -55,6 +55,12 @@ class MemTrackerPB;
 // Memory consumption is tracked via calls to Consume()/Release(), either to
 // the tracker itself or to one of its descendants.
 //
+// Since every such call updates the root tracker, which has no limit, each
+// thread batches its changes of the consumption of the root before adding
+// them to it, so that its counter doesn't bounce between cores. The
+// consumption of the root is thus only exact as seen by the thread changing
+// it; that of the other trackers, and so their limit checks, are exact.
+//
 // This class is thread-safe.
 class MemTracker : public std::enable_shared_from_this<MemTracker> {
  public:
@@ -145,7 +151,7 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
 
   // Returns the memory consumed in bytes.
   int64_t consumption() const {
-    return consumption_.current_value();
+    return parent_ ? consumption_.current_value() : RootConsumption();
   }
 
   int64_t peak_consumption() const { return consumption_.max_value(); }
@@ -177,6 +183,27 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
   // Creates the root tracker.
   static void CreateRootTracker();
 
+  // Adds 'bytes', which may be negative, to the consumption of this tracker.
+  void IncrementConsumption(int64_t bytes);
+
+  // Same as above for the root tracker, batching the changes of the calling
+  // thread.
+  void IncrementRootConsumption(int64_t bytes);
+
+  // Returns the consumption of the root tracker, including the changes the
+  // calling thread has yet to add to it.
+  int64_t RootConsumption() const;
+
+  // The changes of the consumption of the root tracker a thread has yet to
+  // add to it, which are added once the thread exits.
+  struct ThreadRootConsumption {
+    ~ThreadRootConsumption();
+
+    int64_t pending = 0;
+
+    static thread_local ThreadRootConsumption instance;
+  };
+
   int64_t limit_;
   const std::string id_;
   const std::string descr_;
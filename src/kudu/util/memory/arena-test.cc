@@ -273,4 +273,48 @@ TEST(TestArena, TestSTLAllocator) {
   }
 }
 
+TEST(TestArena, TestHugePageBufferAllocator) {
+  HugePageBufferAllocator* allocator = HugePageBufferAllocator::Get();
+  constexpr size_t kHugePageSize = HugePageBufferAllocator::kHugePageSize;
+
+  // Small buffers come from the heap and aren't rounded up.
+  std::unique_ptr<Buffer> small(allocator->Allocate(1024));
+  ASSERT_NE(nullptr, small);
+  ASSERT_EQ(1024, small->size());
+  memset(small->data(), 'a', small->size());
+
+  // Large buffers are mapped, rounded up to a multiple of the huge page size
+  // and aligned on it.
+  std::unique_ptr<Buffer> large(allocator->Allocate(kHugePageSize + 1));
+  ASSERT_NE(nullptr, large);
+  ASSERT_EQ(2 * kHugePageSize, large->size());
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(large->data()) % kHugePageSize);
+  memset(large->data(), 'b', large->size());
+
+  // Reallocations between the heap and mappings preserve the contents.
+  ASSERT_TRUE(allocator->Reallocate(kHugePageSize, small.get()));
+  ASSERT_EQ(kHugePageSize, small->size());
+  ASSERT_EQ('a', static_cast<char*>(small->data())[1023]);
+  ASSERT_TRUE(allocator->Reallocate(1024, large.get()));
+  ASSERT_EQ(1024, large->size());
+  ASSERT_EQ('b', static_cast<char*>(large->data())[1023]);
+}
+
+TEST(TestArena, TestArenaWithHugePages) {
+  shared_ptr<MemTracker> mem_tracker = MemTracker::CreateTracker(-1, "arena-test-tracker");
+  shared_ptr<MemoryTrackingBufferAllocator> allocator(
+      new MemoryTrackingBufferAllocator(HugePageBufferAllocator::Get(), mem_tracker));
+  ThreadSafeMemoryTrackingArena arena(16, allocator);
+  arena.SetMaxBufferSize(HugePageBufferAllocator::kHugePageSize);
+  vector<void*> ptrs;
+  const string to_write(1024, 'x');
+  for (int i = 0; i < 10 * 1024; i++) {
+    NO_FATALS(AllocateBytesAndWrite(&arena, to_write, &ptrs));
+  }
+  for (const auto* p : ptrs) {
+    ASSERT_EQ(0, memcmp(p, to_write.data(), to_write.size()));
+  }
+  ASSERT_GE(mem_tracker->consumption(), 10 * 1024 * 1024);
+}
+
 } // namespace kudu
@@ -59,7 +59,8 @@ ArenaBase<THREADSAFE>::ArenaBase(size_t initial_buffer_size)
 
 template <bool THREADSAFE>
 void ArenaBase<THREADSAFE>::SetMaxBufferSize(size_t size) {
-  DCHECK_LE(size, kMaxTcmallocFastAllocation);
+  DCHECK_LE(size, std::max<size_t>(kMaxTcmallocFastAllocation,
+                                   HugePageBufferAllocator::kHugePageSize));
   max_buffer_size_ = size;
 }
 
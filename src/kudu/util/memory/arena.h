@@ -96,7 +96,10 @@ class ArenaBase {
   explicit ArenaBase(size_t initial_buffer_size);
 
   // Set the maximum buffer size allocated for this arena.
-  // The maximum buffer size allowed is slightly less than ~1MB (8192 * 127 bytes).
+  // The maximum buffer size allowed is slightly less than ~1MB (8192 * 127 bytes),
+  // except for arenas backed by a HugePageBufferAllocator, which doesn't
+  // allocate its large buffers from tcmalloc: those may use buffers of up to
+  // HugePageBufferAllocator::kHugePageSize.
   //
   // Consider the following pros/cons of large buffer sizes:
   //
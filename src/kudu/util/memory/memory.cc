@@ -27,16 +27,22 @@
 #include <mm_malloc.h>
 #endif //__aarch64__
 
+#include <sys/mman.h>
+
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 
 #include <gflags/gflags.h>
 
+#include "kudu/gutil/basictypes.h"
 #include "kudu/util/alignment.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/mem_tracker.h"
 #include "kudu/util/memory/overwrite.h"
+#include "kudu/util/string_case.h"
 
 using std::copy;
 using std::min;
@@ -49,6 +55,21 @@ DEFINE_bool(allocator_aligned_mode, false,
             "unless explicitly specified otherwise - to boost SIMD");
 TAG_FLAG(allocator_aligned_mode, hidden);
 
+DEFINE_string(arena_huge_pages, "none",
+              "How to back the chunks of at least 2MB of the arenas of "
+              "MemRowSets and DeltaMemStores. 'none' allocates them from the "
+              "heap. 'transparent' maps them with transparent huge pages. "
+              "'explicit' maps them from the pool of reserved huge pages "
+              "(see vm.nr_hugepages), falling back to transparent huge pages "
+              "when it is exhausted. Mapped chunks are placed on the NUMA node "
+              "of the thread which first writes to them.");
+TAG_FLAG(arena_huge_pages, experimental);
+DEFINE_validator(arena_huge_pages, [](const char* /*flagname*/, const std::string& value) {
+  return kudu::iequals(value, "none") ||
+      kudu::iequals(value, "transparent") ||
+      kudu::iequals(value, "explicit");
+});
+
 namespace kudu {
 
 namespace {
@@ -173,6 +194,119 @@ void* HeapBufferAllocator::Realloc(void* previous_data, size_t previous_size,
   }
 }
 
+BufferAllocator* HugePageBufferAllocator::GetForLargeArenas() {
+  if (iequals(FLAGS_arena_huge_pages, "none")) {
+    return HeapBufferAllocator::Get();
+  }
+  return Get();
+}
+
+Buffer* HugePageBufferAllocator::AllocateInternal(
+    const size_t requested,
+    const size_t minimal,
+    BufferAllocator* const originator) {
+  DCHECK_LE(minimal, requested);
+  void* data;
+  size_t size;
+  if (!AllocateData(requested, minimal, &data, &size)) {
+    return nullptr;
+  }
+  return CreateBuffer(data, size, originator);
+}
+
+bool HugePageBufferAllocator::ReallocateInternal(
+    const size_t requested,
+    const size_t minimal,
+    Buffer* const buffer,
+    BufferAllocator* const originator) {
+  DCHECK_LE(minimal, requested);
+  if (!IsMapped(buffer->size()) && !IsMapped(requested)) {
+    return DelegateReallocate(HeapBufferAllocator::Get(), requested, minimal,
+                              buffer, originator);
+  }
+  void* data;
+  size_t size;
+  if (!AllocateData(requested, minimal, &data, &size)) {
+    return false;
+  }
+  memcpy(data, buffer->data(), min(buffer->size(), size));
+  FreeData(buffer->data(), buffer->size());
+  UpdateBuffer(data, size, buffer);
+  return true;
+}
+
+void HugePageBufferAllocator::FreeInternal(Buffer* buffer) {
+  FreeData(buffer->data(), buffer->size());
+}
+
+bool HugePageBufferAllocator::AllocateData(size_t requested, size_t minimal,
+                                           void** data, size_t* size) {
+  size_t attempted = requested;
+  while (true) {
+    if (IsMapped(attempted)) {
+      *size = KUDU_ALIGN_UP(attempted, kHugePageSize);
+      *data = Map(*size);
+    } else {
+      *size = attempted;
+      *data = (attempted == 0) ? &dummy_buffer[0] : malloc(attempted);
+    }
+    if (*data != nullptr) {
+      return true;
+    }
+    if (attempted == minimal) return false;
+    attempted = minimal + (attempted - minimal - 1) / 2;
+  }
+}
+
+void HugePageBufferAllocator::FreeData(void* data, size_t size) {
+  if (IsMapped(size)) {
+    PCHECK(munmap(data, size) == 0);
+  } else if (size > 0) {
+    free(data);
+  }
+}
+
+void* HugePageBufferAllocator::Map(size_t size) {
+  DCHECK_EQ(0, size % kHugePageSize);
+  constexpr int kProt = PROT_READ | PROT_WRITE;
+  constexpr int kFlags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(__linux__)
+  if (iequals(FLAGS_arena_huge_pages, "explicit")) {
+    // Mappings of explicit huge pages are aligned on the huge page size. They
+    // fail if the pool of reserved huge pages is exhausted.
+    void* data = mmap(nullptr, size, kProt, kFlags | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      return data;
+    }
+  }
+#endif
+  // Over-map by a huge page so that the mapping can be trimmed to be aligned
+  // on the huge page size: otherwise its first and last huge pages could only
+  // be backed by regular pages.
+  const size_t mapped_size = size + kHugePageSize;
+  void* mapped = mmap(nullptr, mapped_size, kProt, kFlags, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  const uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+  const uintptr_t aligned_start = KUDU_ALIGN_UP(start, kHugePageSize);
+  if (aligned_start > start) {
+    PCHECK(munmap(mapped, aligned_start - start) == 0);
+  }
+  const uintptr_t end = start + mapped_size;
+  const uintptr_t aligned_end = aligned_start + size;
+  if (end > aligned_end) {
+    PCHECK(munmap(reinterpret_cast<void*>(aligned_end), end - aligned_end) == 0);
+  }
+  void* data = reinterpret_cast<void*>(aligned_start);
+#if defined(MADV_HUGEPAGE)
+  // This is best effort: if transparent huge pages are disabled, the mapping
+  // is just backed by regular pages.
+  ignore_result(madvise(data, size, MADV_HUGEPAGE));
+#endif
+  return data;
+}
+
 Buffer* ClearingBufferAllocator::AllocateInternal(size_t requested,
                                                   size_t minimal,
                                                   BufferAllocator* originator) {
@@ -282,6 +282,70 @@ class HeapBufferAllocator : public BufferAllocator {
   DISALLOW_COPY_AND_ASSIGN(HeapBufferAllocator);
 };
 
+// Allocates buffers of at least kHugePageSize by mapping anonymous memory
+// backed by 2MB huge pages, rounding the requests up to a multiple of
+// kHugePageSize. Smaller buffers are allocated from the heap, since they would
+// waste most of a huge page.
+//
+// The mapped pages are faulted in by the thread which first touches them, so
+// with the kernel's default memory policy they are allocated on that thread's
+// NUMA node rather than wherever the heap happened to have free memory.
+class HugePageBufferAllocator : public BufferAllocator {
+ public:
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  ~HugePageBufferAllocator() override = default;
+
+  // Returns a singleton instance of the huge page allocator.
+  static HugePageBufferAllocator* Get() {
+    return Singleton<HugePageBufferAllocator>::get();
+  }
+
+  // Returns the allocator to back the large, long-lived arenas with (e.g. the
+  // ones of MemRowSets), as configured by --arena_huge_pages: either this
+  // allocator or the heap one.
+  static BufferAllocator* GetForLargeArenas();
+
+  size_t Available() const override {
+    return std::numeric_limits<size_t>::max();
+  }
+
+ private:
+  friend class Singleton<HugePageBufferAllocator>;
+
+  HugePageBufferAllocator() = default;
+
+  Buffer* AllocateInternal(size_t requested,
+                           size_t minimal,
+                           BufferAllocator* originator) override;
+
+  bool ReallocateInternal(size_t requested,
+                          size_t minimal,
+                          Buffer* buffer,
+                          BufferAllocator* originator) override;
+
+  void FreeInternal(Buffer* buffer) override;
+
+  // Allocates between 'minimal' and 'requested' bytes, setting 'data' and
+  // 'size' to the allocated memory. Returns false on OOM.
+  static bool AllocateData(size_t requested, size_t minimal, void** data, size_t* size);
+
+  // Frees memory allocated by AllocateData().
+  static void FreeData(void* data, size_t size);
+
+  // Maps 'size' bytes, which must be a multiple of kHugePageSize, aligned on
+  // kHugePageSize. Returns NULL on failure.
+  static void* Map(size_t size);
+
+  // Returns true if a buffer of 'size' bytes is mapped rather than allocated
+  // from the heap.
+  static bool IsMapped(size_t size) {
+    return size >= kHugePageSize;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(HugePageBufferAllocator);
+};
+
 // Wrapper around the delegate allocator, that clears all newly allocated
 // (and reallocated) memory.
 class ClearingBufferAllocator : public BufferAllocator {
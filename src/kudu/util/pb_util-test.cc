@@ -29,6 +29,7 @@
 #include <gflags/gflags.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/message.h>
 #include <gtest/gtest.h>
 
 #include "kudu/util/env.h"
@@ -518,6 +519,89 @@ TEST_P(TestPBContainerVersions, TestMultipleMessages) {
   ASSERT_OK(pb_reader.Close());
 }
 
+TEST_P(TestPBContainerVersions, TestAppendBatch) {
+  ProtoContainerTestPB pb;
+  pb.set_name("foo");
+  pb.set_note("bar");
+
+  unique_ptr<WritablePBContainerFile> pb_writer;
+  ASSERT_OK(NewPBCWriter(version_, RWFileOptions(), &pb_writer));
+  ASSERT_OK(pb_writer->CreateNew(pb));
+
+  // Batches are read back as if their messages were appended one by one.
+  pb.set_value(0);
+  ASSERT_OK(pb_writer->Append(pb));
+  vector<ProtoContainerTestPB> batch(10, pb);
+  vector<const google::protobuf::Message*> msgs;
+  for (int i = 0; i < 10; i++) {
+    batch[i].set_value(i + 1);
+    msgs.emplace_back(&batch[i]);
+  }
+  ASSERT_OK(pb_writer->AppendBatch(msgs));
+  ASSERT_OK(pb_writer->AppendBatch({}));
+  ASSERT_OK(pb_writer->Close());
+
+  int pbs_read = 0;
+  unique_ptr<RandomAccessFile> reader;
+  ASSERT_OK(env_->NewRandomAccessFile(path_, &reader));
+  ReadablePBContainerFile pb_reader(std::move(reader));
+  ASSERT_OK(pb_reader.Open());
+  for (int i = 0;; i++) {
+    ProtoContainerTestPB read_pb;
+    Status s = pb_reader.ReadNextPB(&read_pb);
+    if (s.IsEndOfFile()) {
+      break;
+    }
+    ASSERT_OK(s);
+    ASSERT_EQ(i, read_pb.value());
+    pbs_read++;
+  }
+  ASSERT_EQ(11, pbs_read);
+  ASSERT_OK(pb_reader.Close());
+}
+
+TEST_P(TestPBContainerVersions, TestSeek) {
+  ProtoContainerTestPB pb;
+  pb.set_name("foo");
+  pb.set_note("bar");
+
+  unique_ptr<WritablePBContainerFile> pb_writer;
+  ASSERT_OK(NewPBCWriter(version_, RWFileOptions(), &pb_writer));
+  ASSERT_OK(pb_writer->CreateNew(pb));
+  for (int i = 0; i < 10; i++) {
+    pb.set_value(i);
+    ASSERT_OK(pb_writer->Append(pb));
+  }
+  ASSERT_OK(pb_writer->Close());
+
+  unique_ptr<RandomAccessFile> reader;
+  ASSERT_OK(env_->NewRandomAccessFile(path_, &reader));
+  ReadablePBContainerFile pb_reader(std::move(reader));
+  ASSERT_OK(pb_reader.Open());
+  const uint64_t first_record_offset = pb_reader.offset();
+  ASSERT_TRUE(pb_reader.Seek(first_record_offset - 1).IsInvalidArgument());
+
+  // Note where the 6th record begins, then read to the end.
+  ProtoContainerTestPB read_pb;
+  for (int i = 0; i < 5; i++) {
+    ASSERT_OK(pb_reader.ReadNextPB(&read_pb));
+  }
+  const uint64_t offset = pb_reader.offset();
+  while (pb_reader.ReadNextPB(&read_pb).ok()) {}
+
+  // Reading resumes from where the offset points to.
+  ASSERT_OK(pb_reader.Seek(offset));
+  for (int i = 5; i < 10; i++) {
+    ASSERT_OK(pb_reader.ReadNextPB(&read_pb));
+    ASSERT_EQ(i, read_pb.value());
+  }
+  ASSERT_TRUE(pb_reader.ReadNextPB(&read_pb).IsEndOfFile());
+  ASSERT_OK(pb_reader.Seek(first_record_offset));
+  ASSERT_OK(pb_reader.ReadNextPB(&read_pb));
+  ASSERT_EQ(0, read_pb.value());
+  ASSERT_OK(pb_reader.Close());
+}
+
 TEST_P(TestPBContainerVersions, TestInterleavedReadWrite) {
   ProtoContainerTestPB pb;
   pb.set_name("foo");
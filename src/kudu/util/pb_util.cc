@@ -61,6 +61,7 @@
 #include "kudu/util/crc.h"
 #include "kudu/util/debug/sanitizer_scopes.h"
 #include "kudu/util/debug/trace_event.h"
+#include "kudu/util/dir_syncer.h"
 #include "kudu/util/env.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/jsonwriter.h"
@@ -758,6 +759,19 @@ Status WritablePBContainerFile::Append(const Message& msg) {
   return Status::OK();
 }
 
+Status WritablePBContainerFile::AppendBatch(const vector<const Message*>& msgs) {
+  DCHECK_EQ(FileState::OPEN, state_);
+
+  faststring buf;
+  for (const auto* msg : msgs) {
+    RETURN_NOT_OK_PREPEND(AppendMsgToBuffer(*msg, &buf),
+                          "Failed to prepare buffer for writing");
+  }
+  RETURN_NOT_OK_PREPEND(AppendBytes(buf), "Failed to append data to file");
+
+  return Status::OK();
+}
+
 Status WritablePBContainerFile::Flush() {
   DCHECK_EQ(FileState::OPEN, state_);
 
@@ -890,6 +904,7 @@ ReadablePBContainerFile::ReadablePBContainerFile(shared_ptr<RandomAccessFile> re
   : state_(FileState::NOT_INITIALIZED),
     version_(kPBContainerInvalidVersion),
     offset_(reader->GetEncryptionHeaderSize()),
+    first_record_offset_(0),
     reader_(std::move(reader)) {
 }
 
@@ -905,6 +920,7 @@ Status ReadablePBContainerFile::Open() {
                                        &offset_, &sup_header));
   protos_.reset(sup_header.release_protos());
   pb_type_ = sup_header.pb_type();
+  first_record_offset_ = offset_;
   state_ = FileState::OPEN;
   return Status::OK();
 }
@@ -1045,6 +1061,17 @@ uint64_t ReadablePBContainerFile::offset() const {
   return offset_;
 }
 
+Status ReadablePBContainerFile::Seek(uint64_t offset) {
+  DCHECK_EQ(FileState::OPEN, state_);
+  if (PREDICT_FALSE(offset < first_record_offset_)) {
+    return Status::InvalidArgument(Substitute(
+        "cannot seek to offset $0 of $1: the records start at offset $2",
+        offset, reader_->filename(), first_record_offset_));
+  }
+  offset_ = offset;
+  return Status::OK();
+}
+
 Status ReadPBContainerFromPath(Env* env, const std::string& path,
                                Message* msg, SensitivityMode sensitivity_mode) {
   unique_ptr<RandomAccessFile> file;
@@ -1062,7 +1089,8 @@ Status WritePBContainerToPath(Env* env, const std::string& path,
                               const Message& msg,
                               CreateMode create,
                               SyncMode sync,
-                              SensitivityMode sensitivity_mode) {
+                              SensitivityMode sensitivity_mode,
+                              DirSyncer* dir_syncer) {
   TRACE_EVENT2("io", "WritePBContainerToPath",
                "path", path,
                "msg_type", msg.GetTypeName());
@@ -1093,7 +1121,8 @@ Status WritePBContainerToPath(Env* env, const std::string& path,
                         "Failed to rename tmp file to " + path);
   tmp_deleter.cancel();
   if (sync == pb_util::SYNC) {
-    RETURN_NOT_OK_PREPEND(env->SyncDir(DirName(path)),
+    DCHECK(!dir_syncer || dir_syncer->dir() == DirName(path));
+    RETURN_NOT_OK_PREPEND(dir_syncer ? dir_syncer->Sync() : env->SyncDir(DirName(path)),
                           "Failed to SyncDir() parent of " + path);
   }
   return Status::OK();
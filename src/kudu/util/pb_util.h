@@ -25,6 +25,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include <google/protobuf/message.h>
 #include <gtest/gtest_prod.h>
@@ -45,6 +46,7 @@ class SimpleDescriptorDatabase;
 
 namespace kudu {
 
+class DirSyncer;
 class Env;
 class RWFile;
 class RandomAccessFile;
@@ -306,6 +308,10 @@ class WritablePBContainerFile {
   // must be called prior to calling Append(), i.e. the file must be open.
   Status Append(const google::protobuf::Message& msg);
 
+  // Like Append(), but writes all of 'msgs' to the container with a single
+  // write. On failure, a prefix of the messages may have been written.
+  Status AppendBatch(const std::vector<const google::protobuf::Message*>& msgs);
+
   // Asynchronously flushes all dirty container data to the filesystem.
   // The file must be open.
   Status Flush();
@@ -443,11 +449,21 @@ class ReadablePBContainerFile {
   // File must be open.
   uint64_t offset() const;
 
+  // Moves the read offset to 'offset', which must be where a record begins,
+  // e.g. as returned by offset() after reading the records preceding it.
+  // File must be open.
+  //
+  // Returns Status::InvalidArgument if 'offset' lies within the headers.
+  Status Seek(uint64_t offset);
+
  private:
   FileState state_;
   int version_;
   uint64_t offset_;
 
+  // The offset of the first record, past the headers.
+  uint64_t first_record_offset_;
+
   // The size of the file we are reading, or 'none' if it hasn't yet been
   // read.
   std::optional<uint64_t> cached_file_size_;
@@ -479,12 +495,16 @@ Status ReadPBContainerFromPath(Env* env, const std::string& path,
 // Serialize a "containerized" protobuf to the given path.
 //
 // If create == NO_OVERWRITE and 'path' already exists, the function will fail.
-// If sync == SYNC, the newly created file will be fsynced before returning.
+// If sync == SYNC, the newly created file will be fsynced before returning,
+// as will its parent directory: with 'dir_syncer' if not null, which must
+// sync that directory, so that the writers of concurrent files share the
+// fsyncs of the directory.
 Status WritePBContainerToPath(Env* env, const std::string& path,
                               const google::protobuf::Message& msg,
                               CreateMode create,
                               SyncMode sync,
-                              SensitivityMode sensitivity_mode);
+                              SensitivityMode sensitivity_mode,
+                              DirSyncer* dir_syncer = nullptr);
 
 // Wrapper for a protobuf message which lazily converts to JSON when
 // the trace buffer is dumped.
@@ -281,6 +281,18 @@ bool SoftLimitExceeded(double* current_capacity_pct) {
   return false;
 }
 
+double SoftLimitExcess(double* current_capacity_pct) {
+  InitLimits();
+  int64_t consumption = CurrentConsumption();
+  if (current_capacity_pct) {
+    *current_capacity_pct = static_cast<double>(consumption) / g_hard_limit * 100;
+  }
+  if (g_hard_limit == g_soft_limit) {
+    return consumption > g_hard_limit ? 1 : 0;
+  }
+  return static_cast<double>(consumption - g_soft_limit) / (g_hard_limit - g_soft_limit);
+}
+
 void MaybeGCAfterRelease(int64_t released_bytes) {
 #ifdef TCMALLOC_ENABLED
   int64_t now_released = base::subtle::NoBarrier_AtomicIncrement(
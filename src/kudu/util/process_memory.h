@@ -27,6 +27,15 @@ namespace process_memory {
 // of the hard limit consumed is written to it.
 bool SoftLimitExceeded(double* current_capacity_pct);
 
+// Returns how far the process-wide memory consumption is between the soft and
+// the hard limits, as a fraction: 0 or less under the soft limit, 1 or more
+// over the hard limit. If no soft limit is defined, returns 1 over the hard
+// limit and 0 otherwise.
+//
+// If 'current_capacity_pct' is not NULL, the percentage of the hard limit
+// consumed is written to it.
+double SoftLimitExcess(double* current_capacity_pct);
+
 // Return true if we are under memory pressure (i.e if we are nearing the point at which
 // SoftLimitExceeded will begin to return true).
 //
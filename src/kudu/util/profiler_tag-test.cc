@@ -0,0 +1,76 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/util/profiler_tag.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/test_util.h"
+#include "kudu/util/thread.h"
+
+using std::string;
+using std::thread;
+
+namespace kudu {
+
+class ProfilerTagTest : public KuduTest {};
+
+TEST_F(ProfilerTagTest, TestNestedTags) {
+  const int64_t tid = Thread::CurrentThreadId();
+  string tag;
+  {
+    ScopedProfilerTag outer("rpc=Write");
+    ASSERT_TRUE(ScopedProfilerTag::GetTagOfThread(tid, &tag));
+    ASSERT_EQ("rpc=Write", tag);
+    {
+      ScopedProfilerTag inner("tablet=abc");
+      ASSERT_TRUE(ScopedProfilerTag::GetTagOfThread(tid, &tag));
+      ASSERT_EQ("rpc=Write;tablet=abc", tag);
+    }
+    ASSERT_TRUE(ScopedProfilerTag::GetTagOfThread(tid, &tag));
+    ASSERT_EQ("rpc=Write", tag);
+  }
+  ASSERT_TRUE(ScopedProfilerTag::GetTagOfThread(tid, &tag));
+  ASSERT_EQ("", tag);
+}
+
+TEST_F(ProfilerTagTest, TestTagsOfOtherThreads) {
+  CountDownLatch tagged(1);
+  CountDownLatch done(1);
+  int64_t tid = 0;
+  thread t([&]() {
+    tid = Thread::CurrentThreadId();
+    ScopedProfilerTag tag("op=FlushMRSOp");
+    tagged.CountDown();
+    done.Wait();
+  });
+  tagged.Wait();
+  string tag;
+  ASSERT_TRUE(ScopedProfilerTag::GetTagOfThread(tid, &tag));
+  ASSERT_EQ("op=FlushMRSOp", tag);
+  done.CountDown();
+  t.join();
+
+  // The threads which exited have no tag.
+  ASSERT_FALSE(ScopedProfilerTag::GetTagOfThread(tid, &tag));
+}
+
+} // namespace kudu
@@ -0,0 +1,129 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#include "kudu/util/profiler_tag.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "kudu/gutil/map-util.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/thread.h"
+
+using std::string;
+using std::unique_ptr;
+using std::unordered_map;
+
+namespace kudu {
+
+namespace {
+
+// The tag of a thread, readable by the other threads.
+struct TagSlot {
+  simple_spinlock lock;
+  string tag;
+};
+
+// The slots of the threads which set a tag, by system thread ID.
+class TagRegistry {
+ public:
+  static TagRegistry* Get() {
+    static TagRegistry* registry = new TagRegistry();
+    return registry;
+  }
+
+  void Register(int64_t tid, TagSlot* slot) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    slots_[tid] = slot;
+  }
+
+  void Unregister(int64_t tid) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    slots_.erase(tid);
+  }
+
+  bool GetTag(int64_t tid, string* tag) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    TagSlot* slot = FindPtrOrNull(slots_, tid);
+    if (!slot) {
+      return false;
+    }
+    std::lock_guard<simple_spinlock> slot_lock(slot->lock);
+    *tag = slot->tag;
+    return true;
+  }
+
+ private:
+  // Protects 'slots_', and the slots from being destroyed while read.
+  simple_spinlock lock_;
+  unordered_map<int64_t, TagSlot*> slots_;
+};
+
+// The slot of the current thread, registered on first use.
+class ThreadTag {
+ public:
+  ThreadTag()
+      : tid_(Thread::CurrentThreadId()) {
+    TagRegistry::Get()->Register(tid_, &slot_);
+  }
+
+  ~ThreadTag() {
+    TagRegistry::Get()->Unregister(tid_);
+  }
+
+  string Swap(string tag) {
+    std::lock_guard<simple_spinlock> l(slot_.lock);
+    std::swap(slot_.tag, tag);
+    return tag;
+  }
+
+  const string& tag() const {
+    // Only the current thread writes the tag.
+    return slot_.tag;
+  }
+
+ private:
+  const int64_t tid_;
+  TagSlot slot_;
+};
+
+ThreadTag* CurrentThreadTag() {
+  static thread_local unique_ptr<ThreadTag> thread_tag;
+  if (!thread_tag) {
+    thread_tag.reset(new ThreadTag());
+  }
+  return thread_tag.get();
+}
+
+} // anonymous namespace
+
+ScopedProfilerTag::ScopedProfilerTag(const string& tag) {
+  ThreadTag* thread_tag = CurrentThreadTag();
+  const string& prev = thread_tag->tag();
+  prev_tag_ = thread_tag->Swap(prev.empty() ? tag : prev + ";" + tag);
+}
+
+ScopedProfilerTag::~ScopedProfilerTag() {
+  CurrentThreadTag()->Swap(std::move(prev_tag_));
+}
+
+bool ScopedProfilerTag::GetTagOfThread(int64_t tid, string* tag) {
+  return TagRegistry::Get()->GetTag(tid, tag);
+}
+
+} // namespace kudu
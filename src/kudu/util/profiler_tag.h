@@ -0,0 +1,58 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "kudu/gutil/macros.h"
+
+namespace kudu {
+
+// Tags the work done by the current thread while in scope, e.g. with the
+// tablet or the RPC method it's done for, so that the samples of the
+// continuous profiler attribute the CPU time of the thread to it.
+//
+// The tags are nested: a tag created while another is in scope is appended
+// to it, separated by ';', and the outer tag is restored once the inner one
+// goes out of scope.
+//
+// Setting a tag takes an uncontended spinlock, so tags are meant to be set at
+// the granularity of RPCs or of ops rather than in tight loops.
+//
+// Example:
+//   {
+//     ScopedProfilerTag tag(Substitute("tablet=$0", tablet_id));
+//     ...
+//   }
+class ScopedProfilerTag {
+ public:
+  explicit ScopedProfilerTag(const std::string& tag);
+  ~ScopedProfilerTag();
+
+  // Copies the current tag of the thread with system thread ID 'tid' into
+  // 'tag'. Returns false if the thread never set a tag or has exited.
+  static bool GetTagOfThread(int64_t tid, std::string* tag);
+
+ private:
+  // The tag of the thread before this one was set.
+  std::string prev_tag_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedProfilerTag);
+};
+
+} // namespace kudu
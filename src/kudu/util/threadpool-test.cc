@@ -1046,6 +1046,47 @@ TEST_F(ThreadPoolTest, TestTokenSubmitsProcessedSerially) {
   ASSERT_EQ("abcde", result);
 }
 
+// Test that the tasks of a SERIAL token taken in batches are run in order, and
+// dropped if the token is shut down while its batch is running.
+TEST_F(ThreadPoolTest, TestSerialTokenBatches) {
+  ASSERT_OK(RebuildPoolWithBuilder(ThreadPoolBuilder(kDefaultPoolName)
+                                   .set_max_threads(1)
+                                   .set_max_serial_batch_size(4)));
+  {
+    unique_ptr<ThreadPoolToken> t = pool_->NewToken(ThreadPool::ExecutionMode::SERIAL);
+    CountDownLatch latch(1);
+    ASSERT_OK(t->Submit([&latch]() { latch.Wait(); }));
+    string result;
+    for (char c = 'a'; c < 'k'; c++) {
+      ASSERT_OK(t->Submit([&result, c]() { result += c; }));
+    }
+    latch.CountDown();
+    t->Wait();
+    ASSERT_EQ("abcdefghij", result);
+  }
+  {
+    unique_ptr<ThreadPoolToken> t = pool_->NewToken(ThreadPool::ExecutionMode::SERIAL);
+    CountDownLatch started(1);
+    CountDownLatch latch(1);
+    atomic<int> num_run(0);
+    ASSERT_OK(t->Submit([&]() {
+      started.CountDown();
+      latch.Wait();
+    }));
+    for (int i = 0; i < 3; i++) {
+      ASSERT_OK(t->Submit([&num_run]() { num_run++; }));
+    }
+    // Whether batched with the running task or still queued, the other tasks
+    // are dropped once the token is shut down.
+    started.Wait();
+    thread shutdown_thread([&t]() { t->Shutdown(); });
+    SleepFor(MonoDelta::FromMilliseconds(100));
+    latch.CountDown();
+    shutdown_thread.join();
+    ASSERT_EQ(0, num_run);
+  }
+}
+
 TEST_P(ThreadPoolTestTokenTypes, TestTokenSubmitsProcessedConcurrently) {
   const int kNumTokens = 5;
   ASSERT_OK(RebuildPoolWithBuilder(ThreadPoolBuilder(kDefaultPoolName)
@@ -17,6 +17,7 @@
 
 #include "kudu/util/threadpool.h"
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <limits>
@@ -102,6 +103,12 @@ ThreadPoolBuilder& ThreadPoolBuilder::set_schedule_period_ms(uint32_t schedule_p
   return *this;
 }
 
+ThreadPoolBuilder& ThreadPoolBuilder::set_max_serial_batch_size(int max_serial_batch_size) {
+  CHECK_GT(max_serial_batch_size, 0);
+  max_serial_batch_size_ = max_serial_batch_size;
+  return *this;
+}
+
 ThreadPoolBuilder& ThreadPoolBuilder::set_queue_overload_threshold(
     const MonoDelta& threshold) {
   queue_overload_threshold_ = threshold;
@@ -184,6 +191,7 @@ ThreadPoolToken::ThreadPoolToken(ThreadPool* pool,
       metrics_(std::move(metrics)),
       pool_(pool),
       state_(State::IDLE),
+      quiescing_(false),
       not_running_cond_(&pool->lock_),
       active_threads_(0) {
 }
@@ -324,6 +332,9 @@ void ThreadPoolToken::Transition(State new_state) {
   }
 #endif
 
+  quiescing_.store(new_state == State::QUIESCING || new_state == State::QUIESCED,
+                   std::memory_order_release);
+
   // Take actions based on the state we're entering.
   switch (new_state) {
     case State::IDLE:
@@ -357,6 +368,7 @@ ThreadPool::ThreadPool(const ThreadPoolBuilder& builder)
       max_threads_(builder.max_threads_),
       max_queue_size_(builder.max_queue_size_),
       idle_timeout_(builder.idle_timeout_),
+      max_serial_batch_size_(builder.max_serial_batch_size_),
       pool_status_(Status::Uninitialized("The pool was not initialized.")),
       idle_cond_(&lock_),
       no_threads_cond_(&lock_),
@@ -745,54 +757,41 @@ void ThreadPool::DispatchThread() {
     --total_queued_tasks_;
     ++active_threads_;
 
+    // Take more tasks of a SERIAL token at once, if allowed: no other thread
+    // runs the token's tasks until it's queued again below.
+    std::deque<Task> batch;
+    if (token->mode() == ExecutionMode::SERIAL) {
+      while (static_cast<int>(batch.size()) + 1 < max_serial_batch_size_ &&
+             !token->entries_.empty()) {
+        batch.emplace_back(std::move(token->entries_.front()));
+        token->entries_.pop_front();
+        --total_queued_tasks_;
+      }
+    }
+
     const MonoTime now(MonoTime::Now());
     const MonoDelta queue_time = now - task.submit_time;
     NotifyLoadMeterUnlocked(queue_time);
 
     unique_lock.Unlock();
 
-    // Release the reference which was held by the queued item.
-    ADOPT_TRACE(task.trace);
-    if (task.trace) {
-      task.trace->Release();
-    }
-
-    // Update metrics.
-    const int64_t queue_time_us = queue_time.ToMicroseconds();
-    TRACE_COUNTER_INCREMENT(queue_time_trace_metric_name_, queue_time_us);
-    if (metrics_.queue_time_us_histogram) {
-      metrics_.queue_time_us_histogram->Increment(queue_time_us);
-    }
-    if (token->metrics_.queue_time_us_histogram) {
-      token->metrics_.queue_time_us_histogram->Increment(queue_time_us);
-    }
-
-    // Execute the task
-    {
-      MicrosecondsInt64 start_wall_us = GetMonoTimeMicros();
-      MicrosecondsInt64 start_cpu_us = GetThreadCpuTimeMicros();
-
-      task.func();
-
-      int64_t wall_us = GetMonoTimeMicros() - start_wall_us;
-      int64_t cpu_us = GetThreadCpuTimeMicros() - start_cpu_us;
-
-      if (metrics_.run_time_us_histogram) {
-        metrics_.run_time_us_histogram->Increment(wall_us);
-      }
-      if (token->metrics_.run_time_us_histogram) {
-        token->metrics_.run_time_us_histogram->Increment(wall_us);
+    RunTask(token, &task, queue_time);
+    while (!batch.empty()) {
+      // The tasks left in the batch are dropped once the token is shut down,
+      // as they would have been if still queued.
+      if (token->quiescing_.load(std::memory_order_acquire)) {
+        for (auto& t : batch) {
+          if (t.trace) {
+            t.trace->Release();
+          }
+        }
+        batch.clear();
+        break;
       }
-      TRACE_COUNTER_INCREMENT(run_wall_time_trace_metric_name_, wall_us);
-      TRACE_COUNTER_INCREMENT(run_cpu_time_trace_metric_name_, cpu_us);
+      Task batched_task = std::move(batch.front());
+      batch.pop_front();
+      RunTask(token, &batched_task, MonoTime::Now() - batched_task.submit_time);
     }
-    // Destruct the task while we do not hold the lock.
-    //
-    // The task's destructor may be expensive if it has a lot of bound
-    // objects, and we don't want to block submission of the threadpool.
-    // In the worst case, the destructor might even try to do something
-    // with this threadpool, and produce a deadlock.
-    task.func = nullptr;
     unique_lock.Lock();
 
     // Possible states:
@@ -857,6 +856,51 @@ void ThreadPool::CheckNotPoolThreadUnlocked() {
   }
 }
 
+void ThreadPool::RunTask(ThreadPoolToken* token, Task* task, const MonoDelta& queue_time) {
+  // Release the reference which was held by the queued item.
+  ADOPT_TRACE(task->trace);
+  if (task->trace) {
+    task->trace->Release();
+  }
+
+  // Update metrics.
+  const int64_t queue_time_us = queue_time.ToMicroseconds();
+  TRACE_COUNTER_INCREMENT(queue_time_trace_metric_name_, queue_time_us);
+  if (metrics_.queue_time_us_histogram) {
+    metrics_.queue_time_us_histogram->Increment(queue_time_us);
+  }
+  if (token->metrics_.queue_time_us_histogram) {
+    token->metrics_.queue_time_us_histogram->Increment(queue_time_us);
+  }
+
+  // Execute the task
+  {
+    MicrosecondsInt64 start_wall_us = GetMonoTimeMicros();
+    MicrosecondsInt64 start_cpu_us = GetThreadCpuTimeMicros();
+
+    task->func();
+
+    int64_t wall_us = GetMonoTimeMicros() - start_wall_us;
+    int64_t cpu_us = GetThreadCpuTimeMicros() - start_cpu_us;
+
+    if (metrics_.run_time_us_histogram) {
+      metrics_.run_time_us_histogram->Increment(wall_us);
+    }
+    if (token->metrics_.run_time_us_histogram) {
+      token->metrics_.run_time_us_histogram->Increment(wall_us);
+    }
+    TRACE_COUNTER_INCREMENT(run_wall_time_trace_metric_name_, wall_us);
+    TRACE_COUNTER_INCREMENT(run_cpu_time_trace_metric_name_, cpu_us);
+  }
+  // Destruct the task while we do not hold the lock.
+  //
+  // The task's destructor may be expensive if it has a lot of bound
+  // objects, and we don't want to block submission of the threadpool.
+  // In the worst case, the destructor might even try to do something
+  // with this threadpool, and produce a deadlock.
+  task->func = nullptr;
+}
+
 void ThreadPool::NotifyLoadMeterUnlocked(const MonoDelta& queue_time) {
   if (!load_meter_) {
     return;
@@ -0,0 +1,146 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/tiered_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <gflags/gflags_declare.h>
+#include <gtest/gtest.h>
+
+#include "kudu/util/cache.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_bool(cache_force_single_shard);
+
+using std::string;
+using std::unique_ptr;
+
+namespace kudu {
+
+class TieredCacheTest : public KuduTest {
+ public:
+  static constexpr int kEntrySize = 1024;
+  static constexpr int kUpperEntries = 10;
+  static constexpr int kLowerEntries = 100;
+
+  void SetUp() override {
+    KuduTest::SetUp();
+    // Single-shard tiers make the capacity of each tier exact.
+    FLAGS_cache_force_single_shard = true;
+    upper_ = NewCache<Cache::EvictionPolicy::LRU>(kUpperEntries * kEntrySize,
+                                                  "tiered_cache_test_upper");
+    lower_ = NewCache<Cache::EvictionPolicy::LRU>(kLowerEntries * kEntrySize,
+                                                  "tiered_cache_test_lower");
+    cache_.reset(new TieredCache(unique_ptr<Cache>(upper_), unique_ptr<Cache>(lower_)));
+  }
+
+ protected:
+  static string EncodeInt(int k) {
+    faststring result;
+    PutFixed32(&result, k);
+    return result.ToString();
+  }
+
+  // Inserts an entry of 'kEntrySize' bytes for 'key', whose value starts
+  // with the key.
+  void Insert(int key) {
+    const string key_str = EncodeInt(key);
+    auto pending(cache_->Allocate(key_str, kEntrySize));
+    ASSERT_TRUE(pending);
+    uint8_t* val = cache_->MutableValue(&pending);
+    memset(val, 0, kEntrySize);
+    memcpy(val, key_str.data(), key_str.size());
+    cache_->Insert(std::move(pending), nullptr);
+  }
+
+  // Looks up 'key', returning the tier it was found in, or nullptr.
+  Cache* Lookup(int key) {
+    const string key_str = EncodeInt(key);
+    auto h(cache_->Lookup(key_str, Cache::EXPECT_IN_CACHE));
+    if (!h) {
+      return nullptr;
+    }
+    CHECK(cache_->Value(h).starts_with(key_str));
+    return h.get_deleter().cache();
+  }
+
+  // Returns true if either tier holds 'key'. Unlike Lookup(), doesn't
+  // promote the entry.
+  bool IsCached(int key) {
+    const string key_str = EncodeInt(key);
+    return upper_->Lookup(key_str, Cache::NO_EXPECT_IN_CACHE) ||
+        lower_->Lookup(key_str, Cache::NO_EXPECT_IN_CACHE);
+  }
+
+  // Owned by 'cache_'.
+  Cache* upper_;
+  Cache* lower_;
+
+  unique_ptr<TieredCache> cache_;
+};
+
+// Entries evicted from the upper tier are found in the lower tier, and are
+// promoted back into the upper tier once looked up.
+TEST_F(TieredCacheTest, DemoteAndPromote) {
+  for (int i = 0; i < 2 * kUpperEntries; i++) {
+    Insert(i);
+  }
+  // The latest entries are in the upper tier, the earliest ones in the lower.
+  ASSERT_EQ(upper_, Lookup(2 * kUpperEntries - 1));
+  ASSERT_EQ(lower_, Lookup(0));
+
+  // The lookup of '0' scheduled its promotion.
+  cache_->WaitForPromotions();
+  ASSERT_EQ(upper_, Lookup(0));
+  // The tiers are exclusive.
+  ASSERT_FALSE(lower_->Lookup(EncodeInt(0), Cache::NO_EXPECT_IN_CACHE));
+}
+
+// Entries only leave the cache once evicted from the lower tier too.
+TEST_F(TieredCacheTest, Capacity) {
+  constexpr int kNumEntries = 2 * (kUpperEntries + kLowerEntries);
+  for (int i = 0; i < kNumEntries; i++) {
+    Insert(i);
+  }
+  ASSERT_FALSE(IsCached(0));
+  // The charge of each entry includes some overhead on top of 'kEntrySize',
+  // so the tiers hold a bit fewer entries than their nominal sizes.
+  for (int i = kNumEntries - kUpperEntries - kLowerEntries / 2; i < kNumEntries; i++) {
+    SCOPED_TRACE(i);
+    ASSERT_TRUE(IsCached(i));
+  }
+}
+
+TEST_F(TieredCacheTest, Erase) {
+  for (int i = 0; i < 2 * kUpperEntries; i++) {
+    Insert(i);
+  }
+  cache_->Erase(EncodeInt(0));
+  cache_->Erase(EncodeInt(2 * kUpperEntries - 1));
+  ASSERT_EQ(nullptr, Lookup(0));
+  ASSERT_EQ(nullptr, Lookup(2 * kUpperEntries - 1));
+}
+
+} // namespace kudu
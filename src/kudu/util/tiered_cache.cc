@@ -0,0 +1,180 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/tiered_cache.h"
+
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/gutil/port.h"
+#include "kudu/util/cache_metrics.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/status.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_int32(tiered_cache_max_pending_promotions, 1024,
+             "The maximum number of entries of a tiered cache waiting to be "
+             "promoted from its lower tier into its upper tier. Lookups hitting "
+             "the lower tier while this many promotions are pending are served "
+             "without promoting the entry.");
+TAG_FLAG(tiered_cache_max_pending_promotions, advanced);
+
+using std::string;
+using std::unique_ptr;
+
+namespace kudu {
+
+TieredCache::TieredCache(unique_ptr<Cache> upper, unique_ptr<Cache> lower)
+    : upper_(std::move(upper)),
+      lower_(std::move(lower)),
+      shutting_down_(false) {
+  CHECK_OK(ThreadPoolBuilder("tiered-cache-promotion")
+           .set_min_threads(0)
+           .set_max_threads(1)
+           .set_max_queue_size(FLAGS_tiered_cache_max_pending_promotions)
+           .Build(&promotion_pool_));
+}
+
+TieredCache::~TieredCache() {
+  promotion_pool_->Shutdown();
+  shutting_down_ = true;
+  upper_.reset();
+  lower_.reset();
+}
+
+void TieredCache::SetMetrics(unique_ptr<CacheMetrics> metrics,
+                             ExistingMetricsPolicy metrics_policy) {
+  upper_->SetMetrics(std::move(metrics), metrics_policy);
+}
+
+Cache::UniqueHandle TieredCache::Lookup(const Slice& key, CacheBehavior caching) {
+  auto h(upper_->Lookup(key, caching));
+  if (h) {
+    return h;
+  }
+  h = lower_->Lookup(key, NO_EXPECT_IN_CACHE);
+  if (h) {
+    SchedulePromotion(key);
+  }
+  return h;
+}
+
+void TieredCache::Erase(const Slice& key) {
+  // Erasing the entry from the upper tier demotes it, so the lower tier must
+  // go second.
+  upper_->Erase(key);
+  lower_->Erase(key);
+}
+
+Slice TieredCache::Value(const UniqueHandle& handle) const {
+  // The handles returned by this cache belong to the tier holding the entry.
+  return handle.get_deleter().cache()->Value(handle);
+}
+
+Cache::UniquePendingHandle TieredCache::Allocate(Slice key, int val_len, int charge) {
+  // The deleter of the pending handle must refer to this cache, so that the
+  // handle gets inserted through Insert() below.
+  auto h(upper_->Allocate(key, val_len, charge));
+  return UniquePendingHandle(h.release(), PendingHandleDeleter(this));
+}
+
+uint8_t* TieredCache::MutableValue(UniquePendingHandle* handle) {
+  return upper_->MutableValue(handle);
+}
+
+Cache::UniqueHandle TieredCache::Insert(UniquePendingHandle pending,
+                                        EvictionCallback* eviction_callback) {
+  CHECK(eviction_callback == nullptr) << "eviction callbacks are not supported";
+  return upper_->Insert(
+      UniquePendingHandle(pending.release(), PendingHandleDeleter(upper_.get())), this);
+}
+
+size_t TieredCache::Invalidate(const InvalidationControl& ctl) {
+  // Invalidate the lower tier second, since the entries invalidated in the
+  // upper tier are demoted.
+  const size_t upper_count = upper_->Invalidate(ctl);
+  return upper_count + lower_->Invalidate(ctl);
+}
+
+void TieredCache::EvictedEntry(Slice key, Slice value) {
+  if (shutting_down_) {
+    return;
+  }
+  // Replace whatever the lower tier has for the key: the upper tier has the
+  // most recent value.
+  CopyInto(lower_.get(), key, value, nullptr);
+}
+
+void TieredCache::WaitForPromotions() {
+  promotion_pool_->Wait();
+}
+
+void TieredCache::Release(Handle* /* handle */) {
+  LOG(DFATAL) << "handles are released by the tier holding their entry";
+}
+
+void TieredCache::Free(PendingHandle* h) {
+  // Hand the memory back to the tier which allocated it.
+  UniquePendingHandle to_free(h, PendingHandleDeleter(upper_.get()));
+}
+
+void TieredCache::SchedulePromotion(const Slice& key) {
+  string key_str = key.ToString();
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    if (!promotions_in_flight_.insert(key_str).second) {
+      return;
+    }
+  }
+  if (PREDICT_FALSE(!promotion_pool_->Submit([this, key_str]() { Promote(key_str); }).ok())) {
+    // The promotion queue is full: the entry stays in the lower tier until
+    // it's looked up again.
+    std::lock_guard<simple_spinlock> l(lock_);
+    promotions_in_flight_.erase(key_str);
+  }
+}
+
+void TieredCache::Promote(const string& key) {
+  {
+    auto h(lower_->Lookup(key, NO_EXPECT_IN_CACHE));
+    if (h && CopyInto(upper_.get(), key, lower_->Value(h), this)) {
+      // Keep the tiers exclusive, so the lower tier can hold more entries.
+      h.reset();
+      lower_->Erase(key);
+    }
+  }
+  std::lock_guard<simple_spinlock> l(lock_);
+  promotions_in_flight_.erase(key);
+}
+
+bool TieredCache::CopyInto(Cache* cache, Slice key, Slice value,
+                           EvictionCallback* eviction_callback) {
+  auto pending(cache->Allocate(key, value.size()));
+  if (!pending) {
+    return false;
+  }
+  memcpy(cache->MutableValue(&pending), value.data(), value.size());
+  cache->Insert(std::move(pending), eviction_callback);
+  return true;
+}
+
+} // namespace kudu
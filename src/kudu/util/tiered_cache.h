@@ -0,0 +1,119 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/cache.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/slice.h"
+
+namespace kudu {
+
+struct CacheMetrics;
+class ThreadPool;
+
+// A cache made of two tiers: a faster 'upper' tier (e.g. DRAM) backed by a
+// larger 'lower' tier (e.g. NVM).
+//
+// New entries are inserted into the upper tier. Entries leaving the upper
+// tier are written into the lower tier, and lookups which miss the upper tier
+// fall back to the lower one. A hit in the lower tier is served from there,
+// and the entry is moved back into the upper tier in the background, so the
+// lookup doesn't pay for the copy.
+//
+// Entries are demoted whenever they leave the upper tier, so Erase() doesn't
+// remove an entry which is still referenced by a handle: it reappears in the
+// lower tier once the handle is released. This cache is thus only suitable
+// for entries which are never erased while in use, like CFile blocks.
+//
+// Eviction callbacks aren't supported.
+class TieredCache : public Cache,
+                    public Cache::EvictionCallback {
+ public:
+  TieredCache(std::unique_ptr<Cache> upper, std::unique_ptr<Cache> lower);
+  ~TieredCache() override;
+
+  // Sets the metrics of the upper tier: lookups served by the lower tier
+  // count as misses.
+  void SetMetrics(std::unique_ptr<CacheMetrics> metrics,
+                  ExistingMetricsPolicy metrics_policy) override;
+
+  UniqueHandle Lookup(const Slice& key, CacheBehavior caching) override;
+
+  void Erase(const Slice& key) override;
+
+  Slice Value(const UniqueHandle& handle) const override;
+
+  using Cache::Allocate;
+  UniquePendingHandle Allocate(Slice key, int val_len, int charge) override;
+
+  uint8_t* MutableValue(UniquePendingHandle* handle) override;
+
+  UniqueHandle Insert(UniquePendingHandle pending,
+                      EvictionCallback* eviction_callback) override;
+
+  size_t Invalidate(const InvalidationControl& ctl) override;
+
+  // Demotes an entry evicted from the upper tier into the lower one.
+  void EvictedEntry(Slice key, Slice value) override;
+
+  // Waits for the scheduled promotions to finish. For tests.
+  void WaitForPromotions();
+
+ protected:
+  void Release(Handle* handle) override;
+
+  void Free(PendingHandle* h) override;
+
+ private:
+  // Schedules the promotion of 'key' from the lower tier into the upper one,
+  // unless one is already scheduled.
+  void SchedulePromotion(const Slice& key);
+
+  // Copies the entry for 'key' from the lower tier into the upper one.
+  void Promote(const std::string& key);
+
+  // Copies 'value' into a new entry for 'key' in 'cache'. Returns false if
+  // 'cache' couldn't make room for the entry.
+  bool CopyInto(Cache* cache, Slice key, Slice value, EvictionCallback* eviction_callback);
+
+  std::unique_ptr<Cache> upper_;
+  std::unique_ptr<Cache> lower_;
+
+  // Runs the promotions. Has a single thread: promotions are a background
+  // optimization, and shouldn't compete with the lookups for CPU.
+  std::unique_ptr<ThreadPool> promotion_pool_;
+
+  // The keys for which a promotion is scheduled.
+  simple_spinlock lock_;
+  std::unordered_set<std::string> promotions_in_flight_;
+
+  // Set once the cache starts shutting down, after which the entries freed
+  // by the upper tier are no longer demoted.
+  std::atomic<bool> shutting_down_;
+
+  DISALLOW_COPY_AND_ASSIGN(TieredCache);
+};
+
+} // namespace kudu
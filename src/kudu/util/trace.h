@@ -29,6 +29,7 @@
 #include "kudu/gutil/threading/thread_collision_warner.h"
 #include "kudu/gutil/walltime.h"
 #include "kudu/util/locks.h"
+#include "kudu/util/monotime.h"
 #include "kudu/util/trace_metrics.h"
 
 namespace kudu {
@@ -96,6 +97,12 @@ class Trace;
 #define TRACE_COUNTER_SCOPE_LATENCY_US(counter_name) \
   ::kudu::ScopedTraceLatencyCounter _scoped_latency(counter_name)
 
+// Like the above, but counts nanoseconds, for scopes which are too short for
+// microseconds to add up, e.g. the processing of a single block of rows. The
+// clock is read only if the current thread has a trace.
+#define TRACE_COUNTER_SCOPE_LATENCY_NS(counter_name) \
+  ::kudu::ScopedTraceNanosLatencyCounter _scoped_nanos_latency(counter_name)
+
 // Construct a constant C string counter name which acts as a sort of
 // coarse-grained histogram for trace metrics.
 #define BUCKETED_COUNTER_NAME(prefix, duration_us)      \
@@ -287,4 +294,28 @@ class ScopedTraceLatencyCounter {
   DISALLOW_COPY_AND_ASSIGN(ScopedTraceLatencyCounter);
 };
 
+// Implementation for TRACE_COUNTER_SCOPE_LATENCY_NS(...) macro above.
+class ScopedTraceNanosLatencyCounter {
+ public:
+  explicit ScopedTraceNanosLatencyCounter(const char* counter)
+      : counter_(counter),
+        trace_(Trace::CurrentTrace()) {
+    if (trace_) {
+      start_time_ = MonoTime::Now();
+    }
+  }
+
+  ~ScopedTraceNanosLatencyCounter() {
+    if (trace_) {
+      trace_->metrics()->Increment(counter_, (MonoTime::Now() - start_time_).ToNanoseconds());
+    }
+  }
+
+ private:
+  const char* const counter_;
+  Trace* const trace_;
+  MonoTime start_time_;
+  DISALLOW_COPY_AND_ASSIGN(ScopedTraceNanosLatencyCounter);
+};
+
 } // namespace kudu
@@ -619,6 +619,26 @@ build_lz4() {
   popd
 }
 
+build_zstd() {
+  ZSTD_BDIR=$TP_BUILD_DIR/$ZSTD_NAME$MODE_SUFFIX
+  mkdir -p $ZSTD_BDIR
+  pushd $ZSTD_BDIR
+  rm -Rf CMakeCache.txt CMakeFiles/
+  CFLAGS="$EXTRA_CFLAGS -fPIC" \
+    cmake \
+    -DCMAKE_BUILD_TYPE=release \
+    -DZSTD_BUILD_STATIC=On \
+    -DZSTD_BUILD_SHARED=Off \
+    -DZSTD_BUILD_PROGRAMS=Off \
+    -DZSTD_BUILD_TESTS=Off \
+    -DZSTD_MULTITHREAD_SUPPORT=Off \
+    -DCMAKE_INSTALL_PREFIX:PATH=$PREFIX \
+    $EXTRA_CMAKE_FLAGS \
+    $ZSTD_SOURCE/build/cmake
+  ${NINJA:-make} -j$PARALLEL $EXTRA_MAKEFLAGS install
+  popd
+}
+
 build_bitshuffle() {
   BITSHUFFLE_BDIR=$TP_BUILD_DIR/$BITSHUFFLE_NAME$MODE_SUFFIX
   mkdir -p $BITSHUFFLE_BDIR
@@ -72,6 +72,10 @@ LZ4_VERSION=1.9.3
 LZ4_NAME=lz4-$LZ4_VERSION
 LZ4_SOURCE=$TP_SOURCE_DIR/$LZ4_NAME
 
+ZSTD_VERSION=1.5.5
+ZSTD_NAME=zstd-$ZSTD_VERSION
+ZSTD_SOURCE=$TP_SOURCE_DIR/$ZSTD_NAME
+
 # from https://github.com/kiyo-masui/bitshuffle
 BITSHUFFLE_VERSION=0.3.5
 BITSHUFFLE_NAME=bitshuffle-$BITSHUFFLE_VERSION